@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+constexpr enum_mapping<int, line::clock> clock_mapping = {
+	{ GPIOD_LINE_CLOCK_MONOTONIC,		line::clock::MONOTONIC },
+	{ GPIOD_LINE_CLOCK_REALTIME,		line::clock::REALTIME },
+	{ GPIOD_LINE_CLOCK_HTE,			line::clock::HTE },
+};
+
+capture_reader_ptr open_capture_reader(const ::std::filesystem::path& path)
+{
+	capture_reader_ptr reader(::gpiod_capture_reader_open(path.c_str()));
+	if (!reader)
+		throw_from_errno("unable to open the capture file " + path.string());
+
+	return reader;
+}
+
+const capture_record* view_record(const ::gpiod_capture_record* record) noexcept
+{
+	return reinterpret_cast<const capture_record*>(record);
+}
+
+} /* namespace */
+
+static_assert(sizeof(capture_record) == sizeof(::gpiod_capture_record),
+	      "C++ and C capture records must have the same layout");
+static_assert(offsetof(capture_record, reserved) ==
+	      offsetof(::gpiod_capture_record, reserved),
+	      "C++ and C capture records must have the same layout");
+
+capture_reader::impl::impl(const ::std::filesystem::path& path)
+	: reader(open_capture_reader(path))
+{
+
+}
+
+GPIOD_CXX_API capture_reader::capture_reader(const ::std::filesystem::path& path)
+	: _m_priv(new impl(path))
+{
+
+}
+
+GPIOD_CXX_API capture_reader::capture_reader(capture_reader&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API capture_reader::~capture_reader()
+{
+
+}
+
+GPIOD_CXX_API capture_reader& capture_reader::operator=(capture_reader&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API line::clock capture_reader::event_clock() const
+{
+	return clock_mapping.at(::gpiod_capture_reader_get_event_clock(
+						this->_m_priv->reader.get()));
+}
+
+GPIOD_CXX_API ::std::vector<capture_line> capture_reader::lines() const
+{
+	::gpiod_capture_reader* reader = this->_m_priv->reader.get();
+	::std::size_t num_lines = ::gpiod_capture_reader_get_num_lines(reader);
+	::std::vector<capture_line> ret;
+
+	ret.reserve(num_lines);
+
+	for (::std::size_t i = 0; i < num_lines; i++) {
+		const ::gpiod_capture_line* line = ::gpiod_capture_reader_get_line(reader, i);
+
+		ret.push_back({ line->chip_num, line->offset, line->chip_name, line->line_name });
+	}
+
+	return ret;
+}
+
+GPIOD_CXX_API ::std::uint64_t capture_reader::num_records() const noexcept
+{
+	return ::gpiod_capture_reader_get_num_records(this->_m_priv->reader.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t capture_reader::num_lost() const noexcept
+{
+	return ::gpiod_capture_reader_get_num_lost(this->_m_priv->reader.get());
+}
+
+GPIOD_CXX_API const capture_record& capture_reader::get_record(::std::uint64_t index) const
+{
+	const ::gpiod_capture_record* record =
+		::gpiod_capture_reader_get_record(this->_m_priv->reader.get(), index);
+	if (!record)
+		throw ::std::out_of_range("record index out of range");
+
+	return *view_record(record);
+}
+
+GPIOD_CXX_API capture_reader::record_range
+capture_reader::records(::std::uint64_t index) const noexcept
+{
+	const ::gpiod_capture_record* records;
+	::std::size_t num;
+
+	num = ::gpiod_capture_reader_get_records(this->_m_priv->reader.get(), index, &records);
+
+	return record_range(view_record(records), num);
+}
+
+GPIOD_CXX_API ::std::uint64_t capture_reader::find(const timestamp& ts) const noexcept
+{
+	return ::gpiod_capture_reader_find(this->_m_priv->reader.get(), ts.ns());
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const capture_record& record)
+{
+	out << "gpiod::capture_record(timestamp=" << record.timestamp_ns <<
+	       ", chip_num=" << record.chip_num <<
+	       ", offset=" << record.offset <<
+	       ", event_type=" << record.event_type <<
+	       ", global_seqno=" << record.global_seqno <<
+	       ", line_seqno=" << record.line_seqno << ")";
+
+	return out;
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const capture_reader& reader)
+{
+	out << "gpiod::capture_reader(num_records=" << reader.num_records() <<
+	       ", num_lost=" << reader.num_lost() <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2021-2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <cerrno>
 #include <ostream>
 #include <utility>
 
@@ -19,6 +20,27 @@ chip_ptr open_chip(const ::std::filesystem::path& path)
 	return chip;
 }
 
+::std::vector<line_info_ptr> watch_line_infos(::gpiod_chip* chip,
+					      const ::std::vector<unsigned int>* offsets,
+					      ::std::size_t num_lines)
+{
+	::std::vector<::gpiod_line_info*> infos(num_lines);
+	::std::vector<line_info_ptr> ret;
+
+	/* Reserve up front so that taking ownership below can't throw. */
+	ret.reserve(num_lines);
+
+	int status = ::gpiod_chip_watch_line_infos(chip, offsets ? offsets->data() : nullptr,
+						   num_lines, infos.data());
+	if (status < 0)
+		throw_from_errno("unable to start watching GPIO line info changes");
+
+	for (auto& info: infos)
+		ret.emplace_back(info);
+
+	return ret;
+}
+
 } /* namespace */
 
 chip::impl::impl(const ::std::filesystem::path& path)
@@ -97,6 +119,28 @@ GPIOD_CXX_API chip_info chip::get_info() const
 	return ret;
 }
 
+GPIOD_CXX_API stats chip::get_stats() const
+{
+	this->_m_priv->throw_if_closed();
+
+	stats_ptr stats_snapshot(::gpiod_chip_get_stats(this->_m_priv->chip.get()));
+	if (!stats_snapshot)
+		throw_from_errno("failed to retrieve GPIO chip statistics");
+
+	stats ret;
+
+	ret._m_priv->set_stats_ptr(stats_snapshot);
+
+	return ret;
+}
+
+GPIOD_CXX_API void chip::reset_stats()
+{
+	this->_m_priv->throw_if_closed();
+
+	::gpiod_chip_reset_stats(this->_m_priv->chip.get());
+}
+
 GPIOD_CXX_API line_info chip::get_line_info(line::offset offset) const
 {
 	this->_m_priv->throw_if_closed();
@@ -112,6 +156,21 @@ GPIOD_CXX_API line_info chip::get_line_info(line::offset offset) const
 	return ret;
 }
 
+GPIOD_CXX_API line_info_snapshot chip::get_all_line_info() const
+{
+	this->_m_priv->throw_if_closed();
+
+	line_info_snapshot_ptr snapshot(::gpiod_line_info_snapshot_new(this->_m_priv->chip.get()));
+	if (!snapshot)
+		throw_from_errno("unable to retrieve the GPIO line info snapshot");
+
+	line_info_snapshot ret;
+
+	ret._m_priv->set_snapshot_ptr(snapshot);
+
+	return ret;
+}
+
 GPIOD_CXX_API line_info chip::watch_line_info(line::offset offset) const
 {
 	this->_m_priv->throw_if_closed();
@@ -136,6 +195,64 @@ GPIOD_CXX_API void chip::unwatch_line_info(line::offset offset) const
 		throw_from_errno("unable to unwatch line status changes");
 }
 
+GPIOD_CXX_API ::std::vector<line_info>
+chip::watch_line_infos(const line::offsets& offsets) const
+{
+	this->_m_priv->throw_if_closed();
+
+	::std::vector<unsigned int> buf(offsets.begin(), offsets.end());
+	::std::vector<line_info> ret;
+
+	auto infos = gpiod::watch_line_infos(this->_m_priv->chip.get(), &buf, buf.size());
+
+	ret.reserve(infos.size());
+	for (auto& info: infos) {
+		ret.push_back(line_info());
+		ret.back()._m_priv->set_info_ptr(info);
+	}
+
+	return ret;
+}
+
+GPIOD_CXX_API ::std::vector<line_info> chip::watch_all_line_infos() const
+{
+	this->_m_priv->throw_if_closed();
+
+	::std::vector<line_info> ret;
+
+	auto infos = gpiod::watch_line_infos(this->_m_priv->chip.get(), nullptr,
+					     this->get_info().num_lines());
+
+	ret.reserve(infos.size());
+	for (auto& info: infos) {
+		ret.push_back(line_info());
+		ret.back()._m_priv->set_info_ptr(info);
+	}
+
+	return ret;
+}
+
+GPIOD_CXX_API void chip::unwatch_line_infos(const line::offsets& offsets) const
+{
+	this->_m_priv->throw_if_closed();
+
+	::std::vector<unsigned int> buf(offsets.begin(), offsets.end());
+
+	int ret = ::gpiod_chip_unwatch_line_infos(this->_m_priv->chip.get(),
+						  buf.data(), buf.size());
+	if (ret)
+		throw_from_errno("unable to unwatch line status changes");
+}
+
+GPIOD_CXX_API void chip::unwatch_all_line_infos() const
+{
+	this->_m_priv->throw_if_closed();
+
+	int ret = ::gpiod_chip_unwatch_line_infos(this->_m_priv->chip.get(), nullptr, 0);
+	if (ret)
+		throw_from_errno("unable to unwatch line status changes");
+}
+
 GPIOD_CXX_API int chip::fd() const
 {
 	this->_m_priv->throw_if_closed();
@@ -154,6 +271,24 @@ GPIOD_CXX_API bool chip::wait_info_event(const ::std::chrono::nanoseconds& timeo
 	return ret;
 }
 
+GPIOD_CXX_API bool chip::wait_info_event(const ::std::chrono::nanoseconds& timeout,
+					 const wait_cancel& cancel) const
+{
+	this->_m_priv->throw_if_closed();
+
+	int ret = ::gpiod_chip_wait_info_event_cancellable(this->_m_priv->chip.get(),
+							   timeout.count(),
+							   cancel._m_priv->cancel.get());
+	if (ret < 0) {
+		if (errno == ECANCELED)
+			return false;
+
+		throw_from_errno("error waiting for info events");
+	}
+
+	return ret;
+}
+
 GPIOD_CXX_API info_event chip::read_info_event() const
 {
 	this->_m_priv->throw_if_closed();
@@ -185,7 +320,28 @@ GPIOD_CXX_API int chip::get_line_offset_from_name(const ::std::string& name) con
 
 GPIOD_CXX_API request_builder chip::prepare_request()
 {
-	return request_builder(*this);
+	return request_builder(*this, memory_resource_scope::current());
+}
+
+GPIOD_CXX_API request_builder chip::prepare_request(::std::pmr::memory_resource* resource)
+{
+	return request_builder(*this, resource);
+}
+
+GPIOD_CXX_API line_request chip::request_lines(const request_template& tmpl)
+{
+	this->_m_priv->throw_if_closed();
+
+	line_request_ptr request(::gpiod_chip_request_lines_from_template(
+					this->_m_priv->chip.get(),
+					tmpl._m_priv->tmpl.get()));
+	if (!request)
+		throw_from_errno("error requesting GPIO lines");
+
+	line_request ret;
+	ret._m_priv.get()->set_request_ptr(request);
+
+	return ret;
 }
 
 GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const chip& chip)
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2021-2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <ostream>
 #include <utility>
@@ -13,7 +15,8 @@ namespace {
 
 edge_event_buffer_ptr make_edge_event_buffer(unsigned int capacity)
 {
-	edge_event_buffer_ptr buffer(::gpiod_edge_event_buffer_new(capacity));
+	edge_event_buffer_ptr buffer(capacity ? ::gpiod_edge_event_buffer_new(capacity) :
+						::gpiod_edge_event_buffer_new_adaptive());
 	if (!buffer)
 		throw_from_errno("unable to allocate the edge event buffer");
 
@@ -22,36 +25,108 @@ edge_event_buffer_ptr make_edge_event_buffer(unsigned int capacity)
 
 } /* namespace */
 
-edge_event_buffer::impl::impl(unsigned int capacity)
+static_assert(sizeof(edge_event_record) == sizeof(::gpiod_edge_event_record),
+	      "C++ and C edge event records must have the same layout");
+static_assert(offsetof(edge_event_record, line_seqno) ==
+	      offsetof(::gpiod_edge_event_record, line_seqno),
+	      "C++ and C edge event records must have the same layout");
+
+edge_event_buffer::impl::impl(unsigned int capacity, ::std::size_t max_events)
 	: buffer(make_edge_event_buffer(capacity)),
-	  events()
+	  events(),
+	  max_events(0),
+	  num_events(0),
+	  records()
 {
-	events.reserve(capacity);
+	::std::size_t chunk_size = ::gpiod_edge_event_buffer_get_capacity(this->buffer.get());
 
-	for (unsigned int i = 0; i < capacity; i++) {
-		events.push_back(edge_event());
-		events.back()._m_priv.reset(new edge_event::impl_external);
-	}
+	if (max_events > chunk_size)
+		this->max_events = max_events;
+
+	events.assign(chunk_size, edge_event());
 }
 
-int edge_event_buffer::impl::read_events(const line_request_ptr& request, unsigned int max_events)
+::std::size_t edge_event_buffer::impl::read_chunk(const line_request_ptr& request,
+						  ::std::size_t max_events)
 {
 	int ret = ::gpiod_line_request_read_edge_events(request.get(),
 						       this->buffer.get(), max_events);
 	if (ret < 0)
 		throw_from_errno("error reading edge events from file descriptor");
 
-	for (int i = 0; i < ret; i++) {
-		::gpiod_edge_event* event = ::gpiod_edge_event_buffer_get_event(this->buffer.get(), i);
+	while (this->events.size() < this->num_events + ret)
+		this->events.push_back(edge_event());
+
+	/*
+	 * Decode the events once here so that iterating over the buffer and
+	 * copying the events doesn't need to go back to the C objects.
+	 */
+	for (int i = 0; i < ret; i++)
+		decode_event(this->events[this->num_events + i],
+			     ::gpiod_edge_event_buffer_get_event(this->buffer.get(), i));
 
-		dynamic_cast<edge_event::impl_external&>(*this->events[i]._m_priv).event = event;
+	if (this->max_events) {
+		auto records = reinterpret_cast<const edge_event_record*>(
+				::gpiod_edge_event_buffer_get_records(this->buffer.get()));
+
+		this->records.insert(this->records.end(), records, records + ret);
 	}
 
+	this->num_events += ret;
+
 	return ret;
 }
 
+void edge_event_buffer::impl::reload_events()
+{
+	this->num_events = ::gpiod_edge_event_buffer_get_num_events(this->buffer.get());
+
+	while (this->events.size() < this->num_events)
+		this->events.push_back(edge_event());
+
+	for (::std::size_t i = 0; i < this->num_events; i++)
+		decode_event(this->events[i],
+			     ::gpiod_edge_event_buffer_get_event(this->buffer.get(), i));
+}
+
+int edge_event_buffer::impl::read_events(const line_request_ptr& request, unsigned int max_events)
+{
+	::std::size_t chunk_size = ::gpiod_edge_event_buffer_get_capacity(this->buffer.get());
+	::std::size_t limit, want;
+
+	this->num_events = 0;
+	this->records.clear();
+
+	if (!this->max_events)
+		return this->read_chunk(request, max_events);
+
+	limit = ::std::min<::std::size_t>(max_events, this->max_events);
+
+	for (;;) {
+		want = ::std::min(chunk_size, limit - this->num_events);
+		if (this->read_chunk(request, want) < want || this->num_events == limit)
+			break;
+
+		/* Keep draining only for as long as it doesn't block. */
+		int ret = ::gpiod_line_request_wait_edge_events(request.get(), 0);
+		if (ret < 0)
+			throw_from_errno("error waiting for edge events");
+		if (ret == 0)
+			break;
+	}
+
+	return this->num_events;
+}
+
 GPIOD_CXX_API edge_event_buffer::edge_event_buffer(::std::size_t capacity)
-	: _m_priv(new impl(capacity))
+	: _m_priv(new impl(capacity, 0))
+{
+
+}
+
+GPIOD_CXX_API edge_event_buffer::edge_event_buffer(::std::size_t chunk_size,
+						   ::std::size_t max_events)
+	: _m_priv(new impl(chunk_size, max_events))
 {
 
 }
@@ -81,14 +156,32 @@ GPIOD_CXX_API const edge_event& edge_event_buffer::get_event(unsigned int index)
 
 GPIOD_CXX_API ::std::size_t edge_event_buffer::num_events() const
 {
-	return ::gpiod_edge_event_buffer_get_num_events(this->_m_priv->buffer.get());
+	return this->_m_priv->num_events;
 }
 
 GPIOD_CXX_API ::std::size_t edge_event_buffer::capacity() const noexcept
 {
+	if (this->_m_priv->max_events)
+		return this->_m_priv->max_events;
+
 	return ::gpiod_edge_event_buffer_get_capacity(this->_m_priv->buffer.get());
 }
 
+GPIOD_CXX_API bool edge_event_buffer::growable() const noexcept
+{
+	return this->_m_priv->max_events;
+}
+
+GPIOD_CXX_API edge_event_buffer::record_range edge_event_buffer::records() const noexcept
+{
+	if (this->_m_priv->max_events)
+		return record_range(this->_m_priv->records.data(), this->_m_priv->num_events);
+
+	return record_range(reinterpret_cast<const edge_event_record*>(
+			::gpiod_edge_event_buffer_get_records(this->_m_priv->buffer.get())),
+			    this->_m_priv->num_events);
+}
+
 GPIOD_CXX_API edge_event_buffer::const_iterator edge_event_buffer::begin() const noexcept
 {
 	return this->_m_priv->events.begin();
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+edge_event_pipeline_ptr make_edge_event_pipeline()
+{
+	edge_event_pipeline_ptr pipeline(::gpiod_edge_event_pipeline_new());
+	if (!pipeline)
+		throw_from_errno("unable to create the edge event pipeline");
+
+	return pipeline;
+}
+
+} /* namespace */
+
+edge_event_pipeline::impl::impl()
+	: pipeline(make_edge_event_pipeline()),
+	  stages(),
+	  error()
+{
+
+}
+
+::std::size_t edge_event_pipeline::impl::run_stage(::gpiod_edge_event_record* records,
+						   ::std::size_t num_events, void* data)
+{
+	auto stage = static_cast<impl::stage*>(data);
+
+	/* Don't let exceptions unwind through the C library. */
+	if (stage->parent->error)
+		return num_events;
+
+	try {
+		return stage->callback(reinterpret_cast<edge_event_record*>(records),
+				       num_events);
+	} catch (...) {
+		stage->parent->error = ::std::current_exception();
+	}
+
+	return num_events;
+}
+
+GPIOD_CXX_API edge_event_pipeline::edge_event_pipeline()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API edge_event_pipeline::edge_event_pipeline(edge_event_pipeline&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API edge_event_pipeline::~edge_event_pipeline()
+{
+
+}
+
+GPIOD_CXX_API edge_event_pipeline&
+edge_event_pipeline::operator=(edge_event_pipeline&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API edge_event_pipeline& edge_event_pipeline::add_stage(stage_callback callback)
+{
+	if (!callback)
+		throw ::std::invalid_argument("pipeline stage callback must be callable");
+
+	auto& stage = this->_m_priv->stages.emplace_back(
+				impl::stage{ this->_m_priv.get(), ::std::move(callback) });
+
+	int ret = ::gpiod_edge_event_pipeline_add_stage(this->_m_priv->pipeline.get(),
+							impl::run_stage, &stage);
+	if (ret) {
+		this->_m_priv->stages.pop_back();
+		throw_from_errno("unable to add the pipeline stage");
+	}
+
+	return *this;
+}
+
+GPIOD_CXX_API edge_event_pipeline&
+edge_event_pipeline::add_edge_filter(line::offset offset, line::edge keep)
+{
+	int ret = ::gpiod_edge_event_pipeline_add_edge_filter(this->_m_priv->pipeline.get(),
+							      offset,
+							      static_cast<::gpiod_line_edge>(keep));
+	if (ret)
+		throw_from_errno("unable to add the edge filter stage");
+
+	return *this;
+}
+
+GPIOD_CXX_API edge_event_pipeline&
+edge_event_pipeline::add_min_interval(line::offset offset,
+				      const ::std::chrono::nanoseconds& interval)
+{
+	int ret = ::gpiod_edge_event_pipeline_add_min_interval(this->_m_priv->pipeline.get(),
+							       offset, interval.count());
+	if (ret)
+		throw_from_errno("unable to add the minimum interval stage");
+
+	return *this;
+}
+
+GPIOD_CXX_API edge_event_pipeline& edge_event_pipeline::add_pulse_decoder(pulse_decoder& decoder)
+{
+	int ret = ::gpiod_edge_event_pipeline_add_pulse_decoder(
+					this->_m_priv->pipeline.get(),
+					decoder._m_priv->decoder.get());
+	if (ret)
+		throw_from_errno("unable to add the pulse decoder stage");
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t edge_event_pipeline::num_stages() const noexcept
+{
+	return ::gpiod_edge_event_pipeline_get_num_stages(this->_m_priv->pipeline.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t edge_event_pipeline::num_dropped(::std::size_t stage) const
+{
+	if (stage >= this->num_stages())
+		throw ::std::out_of_range("pipeline stage index out of range");
+
+	return ::gpiod_edge_event_pipeline_get_num_dropped(this->_m_priv->pipeline.get(),
+							   stage);
+}
+
+GPIOD_CXX_API void edge_event_pipeline::reset() noexcept
+{
+	::gpiod_edge_event_pipeline_reset(this->_m_priv->pipeline.get());
+}
+
+GPIOD_CXX_API ::std::size_t edge_event_pipeline::process(edge_event_buffer& buffer)
+{
+	if (buffer.growable())
+		throw ::std::invalid_argument("growable edge event buffers can't be processed");
+
+	int ret = ::gpiod_edge_event_pipeline_process(this->_m_priv->pipeline.get(),
+						      buffer._m_priv->buffer.get());
+	if (ret < 0)
+		throw_from_errno("error processing edge events");
+
+	buffer._m_priv->reload_events();
+
+	if (this->_m_priv->error)
+		::std::rethrow_exception(::std::exchange(this->_m_priv->error, nullptr));
+
+	return ret;
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const edge_event_pipeline& pipeline)
+{
+	out << "gpiod::edge_event_pipeline(num_stages=" << pipeline.num_stages() << ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
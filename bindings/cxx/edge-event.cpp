@@ -1,9 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2021-2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
-#include <map>
 #include <ostream>
-#include <utility>
+#include <type_traits>
 
 #include "internal.hpp"
 
@@ -11,116 +10,65 @@ namespace gpiod {
 
 namespace {
 
-const ::std::map<int, edge_event::event_type> event_type_mapping = {
+constexpr enum_mapping<int, edge_event::event_type> event_type_mapping = {
 	{ GPIOD_EDGE_EVENT_RISING_EDGE,		edge_event::event_type::RISING_EDGE },
 	{ GPIOD_EDGE_EVENT_FALLING_EDGE,	edge_event::event_type::FALLING_EDGE },
 };
 
-const ::std::map<edge_event::event_type, ::std::string> event_type_names = {
+constexpr enum_mapping<edge_event::event_type, const char*> event_type_names = {
 	{ edge_event::event_type::RISING_EDGE,		"RISING_EDGE" },
 	{ edge_event::event_type::FALLING_EDGE,		"FALLING_EDGE" },
 };
 
 } /* namespace */
 
-::gpiod_edge_event* edge_event::impl_managed::get_event_ptr() const noexcept
-{
-	return this->event.get();
-}
-
-::std::shared_ptr<edge_event::impl>
-edge_event::impl_managed::copy(const ::std::shared_ptr<impl>& self) const
-{
-	return self;
-}
-
-edge_event::impl_external::impl_external()
-	: impl(),
-	  event(nullptr)
-{
-
-}
-
-::gpiod_edge_event* edge_event::impl_external::get_event_ptr() const noexcept
-{
-	return this->event;
-}
-
-::std::shared_ptr<edge_event::impl>
-edge_event::impl_external::copy(const ::std::shared_ptr<impl>& self GPIOD_CXX_UNUSED) const
-{
-	::std::shared_ptr<impl> ret(new impl_managed);
-	impl_managed& managed = dynamic_cast<impl_managed&>(*ret);
-
-	managed.event.reset(::gpiod_edge_event_copy(this->event));
-	if (!managed.event)
-		throw_from_errno("unable to copy the edge event object");
-
-	return ret;
-}
+static_assert(::std::is_trivially_copyable<edge_event>::value,
+	      "edge events must be copyable without allocating memory");
 
-edge_event::edge_event()
-	: _m_priv()
+edge_event::edge_event() noexcept
+	: _m_type(event_type::RISING_EDGE),
+	  _m_timestamp(0),
+	  _m_line_offset(0),
+	  _m_global_seqno(0),
+	  _m_line_seqno(0)
 {
 
 }
 
-GPIOD_CXX_API edge_event::edge_event(const edge_event& other)
-	: _m_priv(other._m_priv->copy(other._m_priv))
+void edge_event_buffer::impl::decode_event(edge_event& dst, ::gpiod_edge_event* src)
 {
+	int evtype = ::gpiod_edge_event_get_event_type(src);
 
-}
-
-GPIOD_CXX_API edge_event::edge_event(edge_event&& other) noexcept
-	: _m_priv(::std::move(other._m_priv))
-{
-
-}
-
-GPIOD_CXX_API edge_event::~edge_event()
-{
-
-}
-
-GPIOD_CXX_API edge_event& edge_event::operator=(const edge_event& other)
-{
-	this->_m_priv = other._m_priv->copy(other._m_priv);
-
-	return *this;
-}
-
-GPIOD_CXX_API edge_event& edge_event::operator=(edge_event&& other) noexcept
-{
-	this->_m_priv = ::std::move(other._m_priv);
-
-	return *this;
+	dst._m_type = get_mapped_value(evtype, event_type_mapping);
+	dst._m_timestamp = ::gpiod_edge_event_get_timestamp_ns(src);
+	dst._m_line_offset = ::gpiod_edge_event_get_line_offset(src);
+	dst._m_global_seqno = ::gpiod_edge_event_get_global_seqno(src);
+	dst._m_line_seqno = ::gpiod_edge_event_get_line_seqno(src);
 }
 
 GPIOD_CXX_API edge_event::event_type edge_event::type() const
 {
-	int evtype = ::gpiod_edge_event_get_event_type(this->_m_priv->get_event_ptr());
-
-	return get_mapped_value(evtype, event_type_mapping);
+	return this->_m_type;
 }
 
 GPIOD_CXX_API timestamp edge_event::timestamp_ns() const noexcept
 {
-	return ::gpiod_edge_event_get_timestamp_ns(this->_m_priv->get_event_ptr());
+	return this->_m_timestamp;
 }
 
 GPIOD_CXX_API line::offset edge_event::line_offset() const noexcept
 {
-	return ::gpiod_edge_event_get_line_offset(this->_m_priv->get_event_ptr());
+	return this->_m_line_offset;
 }
 
 GPIOD_CXX_API unsigned long edge_event::global_seqno() const noexcept
 {
-	return ::gpiod_edge_event_get_global_seqno(this->_m_priv->get_event_ptr());
+	return this->_m_global_seqno;
 }
 
 GPIOD_CXX_API unsigned long edge_event::line_seqno() const noexcept
 {
-	return ::gpiod_edge_event_get_line_seqno(this->_m_priv->get_event_ptr());
+	return this->_m_line_seqno;
 }
 
 GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const edge_event& event)
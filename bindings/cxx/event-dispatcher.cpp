@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <algorithm>
+#include <cerrno>
+#include <ostream>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+event_loop_ptr make_event_loop(::std::size_t event_buffer_size)
+{
+	event_loop_ptr loop(::gpiod_event_loop_new(event_buffer_size));
+	if (!loop)
+		throw_from_errno("unable to create the event loop");
+
+	return loop;
+}
+
+wait_cancel_ptr make_wait_cancel()
+{
+	wait_cancel_ptr cancel(::gpiod_wait_cancel_new());
+	if (!cancel)
+		throw_from_errno("unable to create the cancellation object");
+
+	return cancel;
+}
+
+} /* namespace */
+
+event_dispatcher::impl::source::source(impl* parent, line_request&& request)
+	: parent(parent),
+	  request(::std::move(request)),
+	  handlers(),
+	  offsets(this->request.offsets())
+{
+	line::offset max_offset = 0;
+
+	for (const auto& offset: this->offsets)
+		max_offset = ::std::max(max_offset, offset);
+
+	this->handlers.resize(static_cast<unsigned int>(max_offset) + 1);
+}
+
+event_dispatcher::impl::impl(::std::size_t event_buffer_size)
+	: sources(),
+	  default_handler(),
+	  loop(make_event_loop(event_buffer_size)),
+	  cancel(make_wait_cancel()),
+	  thread(),
+	  error(),
+	  num_dispatched(0)
+{
+
+}
+
+void event_dispatcher::impl::throw_if_running() const
+{
+	if (this->thread.joinable())
+		throw ::std::logic_error("event dispatcher thread is running");
+}
+
+int event_dispatcher::impl::on_edge_events(::gpiod_line_request* request GPIOD_CXX_UNUSED,
+					   ::gpiod_edge_event_buffer* buffer,
+					   ::std::size_t num_events, void* data)
+{
+	auto src = static_cast<source*>(data);
+	auto& self = *src->parent;
+	edge_event event;
+
+	/* Exceptions must not propagate through the C library. */
+	try {
+		for (::std::size_t i = 0; i < num_events; i++) {
+			edge_event_buffer::impl::decode_event(event,
+					::gpiod_edge_event_buffer_get_event(buffer, i));
+
+			auto offset = static_cast<unsigned int>(event.line_offset());
+			const auto& handler = offset < src->handlers.size() &&
+					      src->handlers[offset] ?
+						src->handlers[offset] : self.default_handler;
+
+			self.num_dispatched++;
+			if (handler)
+				handler(event);
+		}
+	} catch (...) {
+		self.error = ::std::current_exception();
+		return -1;
+	}
+
+	return 0;
+}
+
+::std::size_t event_dispatcher::impl::dispatch(::std::int64_t timeout_ns)
+{
+	this->num_dispatched = 0;
+
+	int ret = ::gpiod_event_loop_wait(this->loop.get(), timeout_ns);
+	if (this->error) {
+		auto error = this->error;
+
+		this->error = nullptr;
+		::std::rethrow_exception(error);
+	}
+	if (ret < 0)
+		throw_from_errno("error dispatching edge events");
+
+	return this->num_dispatched;
+}
+
+void event_dispatcher::impl::run() noexcept
+{
+	::pollfd fds[2];
+
+	fds[0].fd = ::gpiod_event_loop_get_fd(this->loop.get());
+	fds[0].events = POLLIN;
+	fds[1].fd = ::gpiod_wait_cancel_get_fd(this->cancel.get());
+	fds[1].events = POLLIN;
+
+	for (;;) {
+		int ret = ::poll(fds, 2, -1);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			this->error = ::std::make_exception_ptr(
+				::std::system_error(errno, ::std::system_category(),
+						    "error waiting for edge events"));
+			return;
+		}
+
+		if (fds[1].revents)
+			return;
+
+		try {
+			this->dispatch(0);
+		} catch (...) {
+			this->error = ::std::current_exception();
+			return;
+		}
+	}
+}
+
+GPIOD_CXX_API event_dispatcher::event_dispatcher(::std::size_t event_buffer_size)
+	: _m_priv(new impl(event_buffer_size))
+{
+
+}
+
+GPIOD_CXX_API event_dispatcher::event_dispatcher(event_dispatcher&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API event_dispatcher::~event_dispatcher()
+{
+	if (!this->_m_priv || !this->_m_priv->thread.joinable())
+		return;
+
+	/* Errors of the thread are only reported by an explicit stop(). */
+	try {
+		this->stop();
+	} catch (...) {
+
+	}
+}
+
+GPIOD_CXX_API event_dispatcher& event_dispatcher::operator=(event_dispatcher&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t event_dispatcher::add_request(line_request&& request)
+{
+	this->_m_priv->throw_if_running();
+	request._m_priv->throw_if_released();
+
+	::std::unique_ptr<impl::source> src(new impl::source(this->_m_priv.get(),
+							       ::std::move(request)));
+
+	int ret = ::gpiod_event_loop_add_request(this->_m_priv->loop.get(),
+						 src->request._m_priv->request.get(),
+						 impl::on_edge_events, src.get());
+	if (ret) {
+		/* Hand the request back, the caller still owns it on failure. */
+		request = ::std::move(src->request);
+		throw_from_errno("unable to add the request to the event loop");
+	}
+
+	this->_m_priv->sources.push_back(::std::move(src));
+
+	return this->_m_priv->sources.size() - 1;
+}
+
+GPIOD_CXX_API line_request& event_dispatcher::get_request(::std::size_t index)
+{
+	return this->_m_priv->sources.at(index)->request;
+}
+
+GPIOD_CXX_API ::std::size_t event_dispatcher::num_requests() const noexcept
+{
+	return this->_m_priv->sources.size();
+}
+
+GPIOD_CXX_API void event_dispatcher::set_handler(::std::size_t index, line::offset offset,
+						 edge_handler handler)
+{
+	this->_m_priv->throw_if_running();
+
+	auto& src = *this->_m_priv->sources.at(index);
+
+	if (::std::find(src.offsets.begin(), src.offsets.end(), offset) == src.offsets.end())
+		throw ::std::invalid_argument("line is not part of the request");
+
+	src.handlers[static_cast<unsigned int>(offset)] = ::std::move(handler);
+}
+
+GPIOD_CXX_API void event_dispatcher::set_default_handler(edge_handler handler)
+{
+	this->_m_priv->throw_if_running();
+
+	this->_m_priv->default_handler = ::std::move(handler);
+}
+
+GPIOD_CXX_API ::std::size_t event_dispatcher::dispatch(const ::std::chrono::nanoseconds& timeout)
+{
+	this->_m_priv->throw_if_running();
+
+	return this->_m_priv->dispatch(timeout.count());
+}
+
+GPIOD_CXX_API void event_dispatcher::start(int cpu)
+{
+	this->_m_priv->throw_if_running();
+
+	if (::gpiod_wait_cancel_reset(this->_m_priv->cancel.get()))
+		throw_from_errno("unable to reset the cancellation object");
+
+	this->_m_priv->error = nullptr;
+	this->_m_priv->thread = ::std::thread(&impl::run, this->_m_priv.get());
+
+	if (cpu < 0)
+		return;
+
+	::cpu_set_t cpus;
+
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+
+	int ret = ::pthread_setaffinity_np(this->_m_priv->thread.native_handle(),
+					   sizeof(cpus), &cpus);
+	if (ret) {
+		this->stop();
+		throw ::std::system_error(ret, ::std::system_category(),
+					  "unable to pin the event dispatcher thread");
+	}
+}
+
+GPIOD_CXX_API void event_dispatcher::stop()
+{
+	if (!this->_m_priv->thread.joinable())
+		return;
+
+	if (::gpiod_wait_cancel_trigger(this->_m_priv->cancel.get()))
+		throw_from_errno("unable to stop the event dispatcher thread");
+
+	this->_m_priv->thread.join();
+
+	if (this->_m_priv->error) {
+		auto error = this->_m_priv->error;
+
+		this->_m_priv->error = nullptr;
+		::std::rethrow_exception(error);
+	}
+}
+
+GPIOD_CXX_API bool event_dispatcher::running() const noexcept
+{
+	return this->_m_priv->thread.joinable();
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const event_dispatcher& dispatcher)
+{
+	out << "gpiod::event_dispatcher(num_requests=" << dispatcher.num_requests() <<
+	       ", running=" << (dispatcher.running() ? "true" : "false") <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
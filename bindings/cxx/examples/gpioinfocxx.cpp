@@ -17,9 +17,7 @@ void show_chip(const ::gpiod::chip& chip)
 
 	::std::cout << info.name() << " - " << info.num_lines() << " lines:" << ::std::endl;
 
-	for (unsigned int offset = 0; offset < info.num_lines(); offset++) {
-		auto info = chip.get_line_info(offset);
-
+	for (const auto& info: chip.get_all_line_info()) {
 		::std::cout << "\tline ";
 		::std::cout.width(3);
 		::std::cout << info.offset() << ": ";
@@ -0,0 +1,377 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file gpiod-asio.hpp
+ */
+
+#ifndef __LIBGPIOD_GPIOD_ASIO_CXX_HPP__
+#define __LIBGPIOD_GPIOD_ASIO_CXX_HPP__
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef GPIOD_CXX_ASIO_STANDALONE
+#include <asio.hpp>
+#else
+#include <boost/asio.hpp>
+#endif
+
+#include "gpiod.hpp"
+
+namespace gpiod {
+
+/**
+ * @defgroup gpiod_cxx_asio Asio integration
+ * @ingroup gpiod_cxx
+ * @{
+ *
+ * Optional, header-only adapters waiting for chip and line request events
+ * through the reactor of an asio execution context. No threads are created,
+ * any number of chips and requests can share a single io_context.
+ *
+ * Boost.Asio is used unless GPIOD_CXX_ASIO_STANDALONE is defined before
+ * including this header, in which case standalone asio is used instead.
+ *
+ * The adapters follow the asio completion token model so they work with
+ * plain callbacks as well as with C++20 coroutines:
+ *
+ * @code
+ * gpiod::asio::async_line_request stream(co_await net::this_coro::executor, request);
+ * gpiod::edge_event_buffer buffer;
+ *
+ * for (;;) {
+ *	auto num_events = co_await stream.async_read_edge_events(buffer, net::use_awaitable);
+ *	...
+ * }
+ * @endcode
+ */
+
+namespace asio {
+
+#ifdef GPIOD_CXX_ASIO_STANDALONE
+namespace net = ::asio;
+using error_code = ::asio::error_code;
+#else
+namespace net = ::boost::asio;
+using error_code = ::boost::system::error_code;
+#endif
+
+/**
+ * @cond
+ */
+
+namespace detail {
+
+/*
+ * Watches a file descriptor owned by a libgpiod object. The descriptor is
+ * released instead of closed when the watcher goes away.
+ */
+class descriptor
+{
+public:
+	descriptor(const net::any_io_executor& ex, int fd)
+		: _m_desc(ex, fd)
+	{
+
+	}
+
+	descriptor(const descriptor& other) = delete;
+	descriptor(descriptor&& other) = default;
+
+	~descriptor()
+	{
+		if (this->_m_desc.is_open())
+			this->_m_desc.release();
+	}
+
+	descriptor& operator=(const descriptor& other) = delete;
+	descriptor& operator=(descriptor&& other) = delete;
+
+	net::posix::stream_descriptor& get() noexcept
+	{
+		return this->_m_desc;
+	}
+
+private:
+	net::posix::stream_descriptor _m_desc;
+};
+
+inline error_code to_error_code(const ::std::system_error& ex)
+{
+	return error_code(ex.code().value(), net::error::get_system_category());
+}
+
+} /* namespace detail */
+
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Asynchronous access to the edge events of a line request.
+ *
+ * An async_line_request does not own the line request, which must outlive
+ * it and must not be released or moved in the meantime.
+ */
+class async_line_request
+{
+public:
+
+	/**
+	 * @brief Type of the executor used by the object.
+	 */
+	using executor_type = net::any_io_executor;
+
+	/**
+	 * @brief Constructor.
+	 * @param ex Executor of the reactor to wait with.
+	 * @param request Line request to wait for edge events on.
+	 */
+	async_line_request(const executor_type& ex, line_request& request)
+		: _m_request(&request),
+		  _m_desc(ex, request.fd())
+	{
+
+	}
+
+	/**
+	 * @brief Constructor.
+	 * @param ctx Execution context of the reactor to wait with.
+	 * @param request Line request to wait for edge events on.
+	 */
+	template<class execution_context,
+		 class = typename ::std::enable_if<::std::is_convertible<
+				execution_context&, net::execution_context&>::value>::type>
+	async_line_request(execution_context& ctx, line_request& request)
+		: async_line_request(ctx.get_executor(), request)
+	{
+
+	}
+
+	async_line_request(const async_line_request& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	async_line_request(async_line_request&& other) = default;
+
+	~async_line_request() = default;
+
+	async_line_request& operator=(const async_line_request& other) = delete;
+	async_line_request& operator=(async_line_request&& other) = delete;
+
+	/**
+	 * @brief Get the executor used by the object.
+	 * @return Executor.
+	 */
+	executor_type get_executor() noexcept
+	{
+		return this->_m_desc.get().get_executor();
+	}
+
+	/**
+	 * @brief Get the line request associated with the object.
+	 * @return Reference to the line request.
+	 */
+	line_request& request() const noexcept
+	{
+		return *this->_m_request;
+	}
+
+	/**
+	 * @brief Cancel all outstanding asynchronous operations. Their
+	 *        handlers are invoked with net::error::operation_aborted.
+	 */
+	void cancel()
+	{
+		this->_m_desc.get().cancel();
+	}
+
+	/**
+	 * @brief Wait until edge events are ready to be read.
+	 * @param token Completion token, the completion signature is
+	 *              void(error_code).
+	 * @return Depends on the completion token.
+	 */
+	template<class completion_token>
+	auto async_wait_edge_events(completion_token&& token)
+	{
+		return this->_m_desc.get().async_wait(
+				net::posix::descriptor_base::wait_read,
+				::std::forward<completion_token>(token));
+	}
+
+	/**
+	 * @brief Wait for edge events and read them into a buffer.
+	 * @param buffer Edge event buffer to read the events into. It must be
+	 *               kept alive until the operation completes.
+	 * @param token Completion token, the completion signature is
+	 *              void(error_code, std::size_t) with the number of events
+	 *              read.
+	 * @return Depends on the completion token.
+	 */
+	template<class completion_token>
+	auto async_read_edge_events(edge_event_buffer& buffer, completion_token&& token)
+	{
+		return net::async_compose<completion_token, void(error_code, ::std::size_t)>(
+				read_op{ this, &buffer, false }, token, this->_m_desc.get());
+	}
+
+private:
+
+	struct read_op
+	{
+		async_line_request* stream;
+		edge_event_buffer* buffer;
+		bool waited;
+
+		template<class self_type>
+		void operator()(self_type& self, error_code ec = error_code())
+		{
+			::std::size_t num_events = 0;
+
+			if (!ec && !this->waited) {
+				this->waited = true;
+				this->stream->async_wait_edge_events(::std::move(self));
+				return;
+			}
+
+			if (!ec) {
+				try {
+					num_events = this->stream->_m_request->read_edge_events(*this->buffer);
+				} catch (const ::std::system_error& ex) {
+					/* Someone else got the events of a non-blocking request. */
+					if (ex.code().value() == EAGAIN) {
+						this->waited = false;
+						(*this)(self);
+						return;
+					}
+
+					ec = detail::to_error_code(ex);
+				}
+			}
+
+			self.complete(ec, num_events);
+		}
+	};
+
+	line_request* _m_request;
+	detail::descriptor _m_desc;
+};
+
+/**
+ * @brief Asynchronous access to the info events of a chip.
+ *
+ * An async_chip does not own the chip, which must outlive it and must not be
+ * closed or moved in the meantime.
+ */
+class async_chip
+{
+public:
+
+	/**
+	 * @brief Type of the executor used by the object.
+	 */
+	using executor_type = net::any_io_executor;
+
+	/**
+	 * @brief Constructor.
+	 * @param ex Executor of the reactor to wait with.
+	 * @param chip Chip to wait for info events on.
+	 */
+	async_chip(const executor_type& ex, ::gpiod::chip& chip)
+		: _m_chip(&chip),
+		  _m_desc(ex, chip.fd())
+	{
+
+	}
+
+	/**
+	 * @brief Constructor.
+	 * @param ctx Execution context of the reactor to wait with.
+	 * @param chip Chip to wait for info events on.
+	 */
+	template<class execution_context,
+		 class = typename ::std::enable_if<::std::is_convertible<
+				execution_context&, net::execution_context&>::value>::type>
+	async_chip(execution_context& ctx, ::gpiod::chip& chip)
+		: async_chip(ctx.get_executor(), chip)
+	{
+
+	}
+
+	async_chip(const async_chip& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	async_chip(async_chip&& other) = default;
+
+	~async_chip() = default;
+
+	async_chip& operator=(const async_chip& other) = delete;
+	async_chip& operator=(async_chip&& other) = delete;
+
+	/**
+	 * @brief Get the executor used by the object.
+	 * @return Executor.
+	 */
+	executor_type get_executor() noexcept
+	{
+		return this->_m_desc.get().get_executor();
+	}
+
+	/**
+	 * @brief Get the chip associated with the object.
+	 * @return Reference to the chip.
+	 */
+	::gpiod::chip& chip() const noexcept
+	{
+		return *this->_m_chip;
+	}
+
+	/**
+	 * @brief Cancel all outstanding asynchronous operations. Their
+	 *        handlers are invoked with net::error::operation_aborted.
+	 */
+	void cancel()
+	{
+		this->_m_desc.get().cancel();
+	}
+
+	/**
+	 * @brief Wait until an info event is ready to be read with
+	 *        chip::read_info_event.
+	 * @param token Completion token, the completion signature is
+	 *              void(error_code).
+	 * @return Depends on the completion token.
+	 */
+	template<class completion_token>
+	auto async_wait_info_event(completion_token&& token)
+	{
+		return this->_m_desc.get().async_wait(
+				net::posix::descriptor_base::wait_read,
+				::std::forward<completion_token>(token));
+	}
+
+private:
+
+	::gpiod::chip* _m_chip;
+	detail::descriptor _m_desc;
+};
+
+} /* namespace asio */
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_GPIOD_ASIO_CXX_HPP__ */
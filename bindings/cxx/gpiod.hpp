@@ -30,19 +30,33 @@
 #endif
 
 #define __LIBGPIOD_GPIOD_CXX_INSIDE__
+#include "gpiodcxx/capture-reader.hpp"
 #include "gpiodcxx/chip.hpp"
 #include "gpiodcxx/chip-info.hpp"
 #include "gpiodcxx/edge-event.hpp"
 #include "gpiodcxx/edge-event-buffer.hpp"
+#include "gpiodcxx/edge-event-pipeline.hpp"
+#include "gpiodcxx/edge-event-queue.hpp"
+#include "gpiodcxx/event-dispatcher.hpp"
 #include "gpiodcxx/exception.hpp"
 #include "gpiodcxx/info-event.hpp"
 #include "gpiodcxx/line.hpp"
 #include "gpiodcxx/line-config.hpp"
 #include "gpiodcxx/line-info.hpp"
+#include "gpiodcxx/line-info-snapshot.hpp"
 #include "gpiodcxx/line-request.hpp"
 #include "gpiodcxx/line-settings.hpp"
+#include "gpiodcxx/line-subset.hpp"
+#include "gpiodcxx/line-transaction.hpp"
+#include "gpiodcxx/memory-resource.hpp"
+#include "gpiodcxx/multi-request.hpp"
+#include "gpiodcxx/pulse-decoder.hpp"
 #include "gpiodcxx/request-builder.hpp"
 #include "gpiodcxx/request-config.hpp"
+#include "gpiodcxx/request-template.hpp"
+#include "gpiodcxx/static-line-group.hpp"
+#include "gpiodcxx/stats.hpp"
+#include "gpiodcxx/wait-cancel.hpp"
 #undef __LIBGPIOD_GPIOD_CXX_INSIDE__
 
 /**
@@ -0,0 +1,282 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file capture-reader.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_CAPTURE_READER_HPP__
+#define __LIBGPIOD_CXX_CAPTURE_READER_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "line.hpp"
+#include "timestamp.hpp"
+
+namespace gpiod {
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Line recorded in a capture file.
+ */
+struct capture_line
+{
+	/**
+	 * @brief Number of the chip in the order given to gpiomon.
+	 */
+	unsigned int chip_num;
+
+	/**
+	 * @brief Offset of the line on its chip.
+	 */
+	line::offset offset;
+
+	/**
+	 * @brief Name of the chip.
+	 */
+	::std::string chip_name;
+
+	/**
+	 * @brief Name of the line, empty if unnamed.
+	 */
+	::std::string line_name;
+};
+
+/**
+ * @brief Record of an edge event in a capture file.
+ *
+ * Has the same layout as the records stored in the file, which are handed
+ * out in place.
+ */
+struct capture_record
+{
+	/**
+	 * @brief Timestamp of the event in nanoseconds.
+	 */
+	::std::uint64_t timestamp_ns;
+
+	/**
+	 * @brief Number of the chip in the order given to gpiomon.
+	 */
+	::std::uint32_t chip_num;
+
+	/**
+	 * @brief Offset of the line on which the event occurred.
+	 */
+	::std::uint32_t offset;
+
+	/**
+	 * @brief Type of the event.
+	 */
+	::std::uint32_t event_type;
+
+	/**
+	 * @brief Sequence number of the event in the request.
+	 */
+	::std::uint32_t global_seqno;
+
+	/**
+	 * @brief Sequence number of the event on the line.
+	 */
+	::std::uint32_t line_seqno;
+
+	/**
+	 * @brief Reserved for future use.
+	 */
+	::std::uint32_t reserved;
+};
+
+/**
+ * @brief Memory-maps a capture file written by 'gpiomon --capture'.
+ *
+ * Records are indexed in the order they were written, the oldest one still
+ * in the ring being at index 0. They are never copied: the ranges returned
+ * by the reader point into the mapping and stay valid for as long as the
+ * reader exists.
+ */
+class capture_reader final
+{
+public:
+
+	/**
+	 * @brief Contiguous, read-only range of records of a capture.
+	 */
+	class record_range final
+	{
+	public:
+
+		/**
+		 * @brief Get the pointer to the first record.
+		 * @return Pointer to the first record.
+		 */
+		const capture_record* data() const noexcept { return this->_m_data; }
+
+		/**
+		 * @brief Get the number of records in the range.
+		 * @return Number of records.
+		 */
+		::std::size_t size() const noexcept { return this->_m_size; }
+
+		/**
+		 * @brief Check if the range is empty.
+		 * @return True if the range holds no records.
+		 */
+		bool empty() const noexcept { return this->_m_size == 0; }
+
+		/**
+		 * @brief Get the pointer to the first record.
+		 * @return Pointer to the first record.
+		 */
+		const capture_record* begin() const noexcept { return this->_m_data; }
+
+		/**
+		 * @brief Get the pointer past the last record.
+		 * @return Pointer past the last record.
+		 */
+		const capture_record* end() const noexcept
+		{
+			return this->_m_data + this->_m_size;
+		}
+
+		/**
+		 * @brief Access a record without bounds checking.
+		 * @param index Index of the record.
+		 * @return Constant reference to the record.
+		 */
+		const capture_record& operator[](::std::size_t index) const noexcept
+		{
+			return this->_m_data[index];
+		}
+
+	private:
+
+		record_range(const capture_record* data, ::std::size_t size) noexcept
+			: _m_data(data),
+			  _m_size(size)
+		{
+
+		}
+
+		const capture_record* _m_data;
+		::std::size_t _m_size;
+
+		friend capture_reader;
+	};
+
+	/**
+	 * @brief Constructor. Maps a capture file.
+	 * @param path Path of the capture file.
+	 */
+	explicit capture_reader(const ::std::filesystem::path& path);
+
+	capture_reader(const capture_reader& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	capture_reader(capture_reader&& other) noexcept;
+
+	~capture_reader();
+
+	capture_reader& operator=(const capture_reader& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	capture_reader& operator=(capture_reader&& other) noexcept;
+
+	/**
+	 * @brief Get the clock the timestamps of the capture come from.
+	 * @return Event clock of the capture.
+	 */
+	line::clock event_clock() const;
+
+	/**
+	 * @brief Get the lines recorded in the capture.
+	 * @return Vector of lines.
+	 */
+	::std::vector<capture_line> lines() const;
+
+	/**
+	 * @brief Get the number of records in the capture.
+	 * @return Number of records.
+	 */
+	::std::uint64_t num_records() const noexcept;
+
+	/**
+	 * @brief Get the number of records overwritten after the ring wrapped.
+	 * @return Number of lost records.
+	 */
+	::std::uint64_t num_lost() const noexcept;
+
+	/**
+	 * @brief Get a record of the capture.
+	 * @param index Index of the record.
+	 * @return Constant reference to the record.
+	 */
+	const capture_record& get_record(::std::uint64_t index) const;
+
+	/**
+	 * @brief Get the records stored contiguously from an index on.
+	 * @param index Index of the first record.
+	 * @return Range of records. Empty if the index is past the last
+	 *         record, shorter than the rest of the capture if it wraps
+	 *         around the end of the ring.
+	 */
+	record_range records(::std::uint64_t index) const noexcept;
+
+	/**
+	 * @brief Find the first record not older than a timestamp.
+	 * @param ts Timestamp in the clock of the capture.
+	 * @return Index of the record or the number of records if all of them
+	 *         are older.
+	 */
+	::std::uint64_t find(const timestamp& ts) const noexcept;
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+};
+
+/**
+ * @brief Stream insertion operator for capture records.
+ * @param out Output stream to write to.
+ * @param record Record to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const capture_record& record);
+
+/**
+ * @brief Stream insertion operator for capture readers.
+ * @param out Output stream to write to.
+ * @param reader Capture reader to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const capture_reader& reader);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_CAPTURE_READER_HPP__ */
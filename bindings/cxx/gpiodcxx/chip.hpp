@@ -17,6 +17,8 @@
 #include <iostream>
 #include <filesystem>
 #include <memory>
+#include <memory_resource>
+#include <vector>
 
 #include "line.hpp"
 
@@ -26,9 +28,14 @@ class chip_info;
 class info_event;
 class line_config;
 class line_info;
+class line_info_snapshot;
 class line_request;
+class multi_request;
 class request_builder;
 class request_config;
+class request_template;
+class stats;
+class wait_cancel;
 
 /**
  * @ingroup gpiod_cxx
@@ -94,6 +101,17 @@ public:
 	 */
 	chip_info get_info() const;
 
+	/**
+	 * @brief Get the I/O statistics of the chip.
+	 * @return New stats object.
+	 */
+	stats get_stats() const;
+
+	/**
+	 * @brief Zero the I/O statistics of the chip.
+	 */
+	void reset_stats();
+
 	/**
 	 * @brief Retrieve the current snapshot of line information for a
 	 *        single line.
@@ -110,12 +128,51 @@ public:
 	 */
 	line_info watch_line_info(line::offset offset) const;
 
+	/**
+	 * @brief Retrieve the current snapshot of line information for all
+	 *        lines of the chip at once.
+	 * @return New ::gpiod::line_info_snapshot object. Its lines are
+	 *         accessed through lightweight views stored in a single
+	 *         buffer instead of one ::gpiod::line_info object per line.
+	 */
+	line_info_snapshot get_all_line_info() const;
+
 	/**
 	 * @brief Stop watching the line at given offset for info events.
 	 * @param offset Offset of the line to get the info for.
 	 */
 	void unwatch_line_info(line::offset offset) const;
 
+	/**
+	 * @brief Retrieve the line info for a set of lines and start watching
+	 *        all of them for changes.
+	 * @param offsets Offsets of the lines to watch.
+	 * @return Vector of ::gpiod::line_info objects in the order of
+	 *         offsets.
+	 * @note If watching any of the lines fails, none of them remain
+	 *       watched.
+	 */
+	::std::vector<line_info> watch_line_infos(const line::offsets& offsets) const;
+
+	/**
+	 * @brief Retrieve the line info for all lines exposed by this chip and
+	 *        start watching all of them for changes.
+	 * @return Vector of ::gpiod::line_info objects ordered by offset.
+	 */
+	::std::vector<line_info> watch_all_line_infos() const;
+
+	/**
+	 * @brief Stop watching a set of lines for info events.
+	 * @param offsets Offsets of the lines to stop watching.
+	 */
+	void unwatch_line_infos(const line::offsets& offsets) const;
+
+	/**
+	 * @brief Stop watching all lines of this chip for info events. Lines
+	 *        that are not being watched are skipped.
+	 */
+	void unwatch_all_line_infos() const;
+
 	/**
 	 * @brief Get the file descriptor associated with this chip.
 	 * @return File descriptor number.
@@ -131,6 +188,17 @@ public:
 	 */
 	bool wait_info_event(const ::std::chrono::nanoseconds& timeout) const;
 
+	/**
+	 * @brief Wait for line status events, returning early if the wait
+	 *        is cancelled.
+	 * @param timeout Wait time limit in nanoseconds.
+	 * @param cancel Cancellation object watched alongside the chip.
+	 * @return True if at least one event is ready to be read. False if the
+	 *         wait timed out or was cancelled.
+	 */
+	bool wait_info_event(const ::std::chrono::nanoseconds& timeout,
+			     const wait_cancel& cancel) const;
+
 	/**
 	 * @brief Read a single line status change event from this chip.
 	 * @return New info_event object.
@@ -151,6 +219,25 @@ public:
 	 */
 	request_builder prepare_request();
 
+	/**
+	 * @brief Create a request_builder allocating from a memory resource.
+	 * @param resource Memory resource from which the builder and the
+	 *                 configuration it stores are allocated. The resource
+	 *                 must outlive the builder and the configuration
+	 *                 objects obtained from it. The line request returned
+	 *                 by request_builder::do_request() is never allocated
+	 *                 from the resource.
+	 * @return New request_builder object.
+	 */
+	request_builder prepare_request(::std::pmr::memory_resource* resource);
+
+	/**
+	 * @brief Request a set of lines using a precompiled request template.
+	 * @param tmpl Request template to use.
+	 * @return New line_request object.
+	 */
+	line_request request_lines(const request_template& tmpl);
+
 private:
 
 	struct impl;
@@ -159,6 +246,7 @@ private:
 
 	chip(const chip& other);
 
+	friend multi_request;
 	friend request_builder;
 };
 
@@ -13,6 +13,7 @@
 #endif
 
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -20,13 +21,55 @@
 namespace gpiod {
 
 class edge_event;
+class edge_event_pipeline;
+class event_dispatcher;
 class line_request;
+class pulse_decoder;
 
 /**
  * @ingroup gpiod_cxx
  * @{
  */
 
+/**
+ * @brief Packed record of a single edge event.
+ *
+ * Layout of the events as read from the kernel. The event types use the
+ * values of ::gpiod::edge_event::event_type.
+ */
+struct edge_event_record
+{
+	/**
+	 * @brief Timestamp of the event in nanoseconds.
+	 */
+	::std::uint64_t timestamp_ns;
+
+	/**
+	 * @brief Type of the event.
+	 */
+	::std::uint32_t event_type;
+
+	/**
+	 * @brief Offset of the line on which the event occurred.
+	 */
+	::std::uint32_t line_offset;
+
+	/**
+	 * @brief Sequence number of the event in the request.
+	 */
+	::std::uint32_t global_seqno;
+
+	/**
+	 * @brief Sequence number of the event on the line.
+	 */
+	::std::uint32_t line_seqno;
+
+	/**
+	 * @brief Reserved for future use.
+	 */
+	::std::uint32_t reserved[6];
+};
+
 /**
  * @brief Object into which edge events are read for better performance.
  *
@@ -44,12 +87,100 @@ public:
 	 */
 	using const_iterator = ::std::vector<edge_event>::const_iterator;
 
+	/**
+	 * @brief Contiguous range of the packed records of the events stored
+	 *        in the buffer.
+	 *
+	 * The range models a contiguous, sized range so that it can be turned
+	 * into a ``std::span<const edge_event_record>`` or handed to the
+	 * standard algorithms as is.
+	 */
+	class record_range final
+	{
+	public:
+
+		/**
+		 * @brief Get the pointer to the first record.
+		 * @return Pointer to the first record.
+		 */
+		const edge_event_record* data() const noexcept { return this->_m_data; }
+
+		/**
+		 * @brief Get the number of records in the range.
+		 * @return Number of records.
+		 */
+		::std::size_t size() const noexcept { return this->_m_size; }
+
+		/**
+		 * @brief Check if the range is empty.
+		 * @return True if the range holds no records.
+		 */
+		bool empty() const noexcept { return this->_m_size == 0; }
+
+		/**
+		 * @brief Get the pointer to the first record.
+		 * @return Pointer to the first record.
+		 */
+		const edge_event_record* begin() const noexcept { return this->_m_data; }
+
+		/**
+		 * @brief Get the pointer past the last record.
+		 * @return Pointer past the last record.
+		 */
+		const edge_event_record* end() const noexcept
+		{
+			return this->_m_data + this->_m_size;
+		}
+
+		/**
+		 * @brief Access a record without bounds checking.
+		 * @param index Index of the record.
+		 * @return Constant reference to the record.
+		 */
+		const edge_event_record& operator[](::std::size_t index) const noexcept
+		{
+			return this->_m_data[index];
+		}
+
+	private:
+
+		record_range(const edge_event_record* data, ::std::size_t size) noexcept
+			: _m_data(data),
+			  _m_size(size)
+		{
+
+		}
+
+		const edge_event_record* _m_data;
+		::std::size_t _m_size;
+
+		friend edge_event_buffer;
+	};
+
 	/**
 	 * @brief Constructor. Creates a new edge event buffer with given
 	 *        capacity.
-	 * @param capacity Capacity of the new buffer.
+	 * @param capacity Capacity of the new buffer. Clamped to 1024 events
+	 *                 by the core library. If 0, the buffer starts at
+	 *                 ::gpiod::default_event_buffer_capacity() and grows
+	 *                 up to ::gpiod::max_event_buffer_capacity() whenever
+	 *                 a read fills it.
+	 */
+	explicit edge_event_buffer(::std::size_t capacity = 0);
+
+	/**
+	 * @brief Constructor. Creates a new growable edge event buffer.
+	 * @param chunk_size Number of events read from the kernel at once.
+	 *                   Clamped to 1024 events by the core library.
+	 * @param max_events Maximum number of events stored by a single read.
+	 *
+	 * A read into a growable buffer doesn't stop at the first chunk: it
+	 * keeps draining the file descriptor of the request for as long as
+	 * events are pending without blocking, up to max_events. If max_events
+	 * is not greater than the chunk size, the buffer behaves like a fixed
+	 * one.
 	 */
-	explicit edge_event_buffer(::std::size_t capacity = 64);
+	edge_event_buffer(::std::size_t chunk_size, ::std::size_t max_events);
 
 	edge_event_buffer(const edge_event_buffer& other) = delete;
 
@@ -85,10 +216,25 @@ public:
 
 	/**
 	 * @brief Maximum capacity of the buffer.
-	 * @return Buffer capacity.
+	 * @return Buffer capacity. For growable buffers, the maximum number of
+	 *         events a single read can store.
 	 */
 	::std::size_t capacity() const noexcept;
 
+	/**
+	 * @brief Check if the buffer grows beyond a single chunk.
+	 * @return True if the buffer was created as growable.
+	 */
+	bool growable() const noexcept;
+
+	/**
+	 * @brief Get the packed records of the events currently stored in the
+	 *        buffer.
+	 * @return Contiguous range of records. It stays valid until the next
+	 *         read into the buffer.
+	 */
+	record_range records() const noexcept;
+
 	/**
 	 * @brief Get a constant iterator to the first edge event currently
 	 *        stored in the buffer.
@@ -109,7 +255,10 @@ private:
 
 	::std::unique_ptr<impl> _m_priv;
 
+	friend edge_event_pipeline;
+	friend event_dispatcher;
 	friend line_request;
+	friend pulse_decoder;
 };
 
 /**
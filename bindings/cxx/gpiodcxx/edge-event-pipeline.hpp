@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file edge-event-pipeline.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_EDGE_EVENT_PIPELINE_HPP__
+#define __LIBGPIOD_CXX_EDGE_EVENT_PIPELINE_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+
+#include "edge-event-buffer.hpp"
+#include "line.hpp"
+
+namespace gpiod {
+
+class pulse_decoder;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Chain of processing stages applied to edge event buffers in place.
+ *
+ * The stages work on the packed records of the buffer. Each stage may modify
+ * the records and drop some of them by moving the ones it keeps to the front
+ * of the array, the following stages only see the kept records. See the
+ * documentation of the core library for the details of the built-in stages.
+ */
+class edge_event_pipeline final
+{
+public:
+
+	/**
+	 * @brief Callable implementing a user-defined stage. Takes the
+	 *        records kept by the preceding stages and their number and
+	 *        returns the number of records it kept.
+	 */
+	using stage_callback = ::std::function<::std::size_t (edge_event_record* records,
+							      ::std::size_t num_events)>;
+
+	/**
+	 * @brief Create an empty pipeline.
+	 */
+	edge_event_pipeline();
+
+	edge_event_pipeline(const edge_event_pipeline& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	edge_event_pipeline(edge_event_pipeline&& other) noexcept;
+
+	~edge_event_pipeline();
+
+	edge_event_pipeline& operator=(const edge_event_pipeline& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	edge_event_pipeline& operator=(edge_event_pipeline&& other) noexcept;
+
+	/**
+	 * @brief Append a user-defined stage.
+	 * @param callback Callable processing the records. Exceptions thrown
+	 *                 by it are rethrown by process once the remaining
+	 *                 stages have run.
+	 * @return Reference to self.
+	 */
+	edge_event_pipeline& add_stage(stage_callback callback);
+
+	/**
+	 * @brief Append a stage keeping only the selected edges of a line.
+	 * @param offset Offset of the line.
+	 * @param keep Edges of the line to keep.
+	 * @return Reference to self.
+	 */
+	edge_event_pipeline& add_edge_filter(line::offset offset, line::edge keep);
+
+	/**
+	 * @brief Append a stage dropping the events of a line following the
+	 *        last kept one closer than a minimum interval.
+	 * @param offset Offset of the line.
+	 * @param interval Minimum interval between the kept events.
+	 * @return Reference to self.
+	 */
+	edge_event_pipeline& add_min_interval(line::offset offset,
+					      const ::std::chrono::nanoseconds& interval);
+
+	/**
+	 * @brief Append a stage feeding the events to a pulse decoder.
+	 * @param decoder Pulse decoder. Must outlive the pipeline.
+	 * @return Reference to self.
+	 */
+	edge_event_pipeline& add_pulse_decoder(pulse_decoder& decoder);
+
+	/**
+	 * @brief Get the number of stages.
+	 * @return Number of stages of the pipeline.
+	 */
+	::std::size_t num_stages() const noexcept;
+
+	/**
+	 * @brief Get the number of events dropped by a stage.
+	 * @param stage Index of the stage in the order they were added.
+	 * @return Number of events dropped since the pipeline was created or
+	 *         reset.
+	 */
+	::std::uint64_t num_dropped(::std::size_t stage) const;
+
+	/**
+	 * @brief Clear the state of the built-in stages and the drop counters.
+	 */
+	void reset() noexcept;
+
+	/**
+	 * @brief Pass the events stored in a buffer through the pipeline.
+	 * @param buffer Edge event buffer filled by
+	 *               line_request::read_edge_events. Growable buffers are
+	 *               not supported.
+	 * @return Number of events left in the buffer.
+	 */
+	::std::size_t process(edge_event_buffer& buffer);
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+};
+
+/**
+ * @brief Stream insertion operator for edge event pipelines.
+ * @param out Output stream to write to.
+ * @param pipeline Pipeline to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const edge_event_pipeline& pipeline);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_EDGE_EVENT_PIPELINE_HPP__ */
@@ -0,0 +1,357 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file edge-event-queue.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_EDGE_EVENT_QUEUE_HPP__
+#define __LIBGPIOD_CXX_EDGE_EVENT_QUEUE_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "edge-event.hpp"
+#include "edge-event-buffer.hpp"
+
+namespace gpiod {
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Bounded lock-free queue handing edge events over between threads.
+ *
+ * Any number of threads may push and pop events concurrently. No locks are
+ * taken and no memory is allocated after construction, so a realtime thread
+ * reading the events from a request never waits for the threads processing
+ * them. The events are stored by value in a ring of fixed capacity.
+ *
+ * The counters are updated with relaxed atomics. They are exact once all
+ * producers and consumers are done but only approximate while they run.
+ */
+class edge_event_queue final
+{
+public:
+
+	/**
+	 * @brief What happens when an event is pushed into a full queue.
+	 */
+	enum class overflow
+	{
+		BACKPRESSURE = 1,
+		/**< The event is not queued and stays with the producer, which
+		 *   can retry later. */
+		DROP_NEWEST,
+		/**< The pushed event is discarded. */
+		DROP_OLDEST,
+		/**< The oldest queued event is discarded to make room. */
+	};
+
+	/**
+	 * @brief Constructor.
+	 * @param capacity Minimum number of events the queue can hold. Rounded
+	 *                 up to the next power of two.
+	 * @param policy Behavior of the queue when it's full.
+	 * @throw std::invalid_argument if capacity is 0 or too large.
+	 */
+	explicit edge_event_queue(::std::size_t capacity,
+				  overflow policy = overflow::BACKPRESSURE)
+		: _m_mask(round_capacity(capacity) - 1),
+		  _m_policy(policy),
+		  _m_slots(new slot[_m_mask + 1]),
+		  _m_tail(0),
+		  _m_head(0),
+		  _m_num_pushed(0),
+		  _m_num_dropped(0),
+		  _m_num_full(0),
+		  _m_num_popped(0)
+	{
+		for (::std::size_t i = 0; i <= this->_m_mask; i++)
+			this->_m_slots[i].seq.store(i, ::std::memory_order_relaxed);
+	}
+
+	edge_event_queue(const edge_event_queue& other) = delete;
+	edge_event_queue(edge_event_queue&& other) = delete;
+
+	~edge_event_queue() = default;
+
+	edge_event_queue& operator=(const edge_event_queue& other) = delete;
+	edge_event_queue& operator=(edge_event_queue&& other) = delete;
+
+	/**
+	 * @brief Push an event into the queue.
+	 * @param event Event to push.
+	 * @return True if the event was queued, false if it was rejected or
+	 *         dropped because the queue was full.
+	 */
+	bool push(const edge_event& event) noexcept
+	{
+		for (;;) {
+			if (this->try_enqueue(event)) {
+				this->_m_num_pushed.fetch_add(1, ::std::memory_order_relaxed);
+				return true;
+			}
+
+			this->_m_num_full.fetch_add(1, ::std::memory_order_relaxed);
+
+			switch (this->_m_policy) {
+			case overflow::DROP_NEWEST:
+				this->_m_num_dropped.fetch_add(1, ::std::memory_order_relaxed);
+				return false;
+			case overflow::DROP_OLDEST:
+				/* Another consumer may have made room meanwhile. */
+				if (this->try_dequeue())
+					this->_m_num_dropped.fetch_add(1, ::std::memory_order_relaxed);
+				break;
+			default:
+				return false;
+			}
+		}
+	}
+
+	/**
+	 * @brief Push the events stored in an edge event buffer.
+	 * @param buffer Buffer to take the events from.
+	 * @param first Index of the first event to push.
+	 * @return Number of events taken from the buffer. With
+	 *         overflow::BACKPRESSURE the events past the returned count
+	 *         weren't queued and can be pushed again later. With the other
+	 *         policies all events are taken, some of them may have been
+	 *         dropped.
+	 */
+	::std::size_t push(const edge_event_buffer& buffer, ::std::size_t first = 0)
+	{
+		::std::size_t num_events = buffer.num_events(), i;
+
+		for (i = first; i < num_events; i++) {
+			if (!this->push(*(buffer.begin() + i)) &&
+			    this->_m_policy == overflow::BACKPRESSURE)
+				break;
+		}
+
+		return i - first;
+	}
+
+	/**
+	 * @brief Pop the oldest event from the queue.
+	 * @return The event or an empty optional if the queue is empty.
+	 */
+	::std::optional<edge_event> pop() noexcept
+	{
+		auto event = this->try_dequeue();
+
+		if (event)
+			this->_m_num_popped.fetch_add(1, ::std::memory_order_relaxed);
+
+		return event;
+	}
+
+	/**
+	 * @brief Pop events and pass them to a callable one by one.
+	 * @param func Callable taking a const reference to an edge event.
+	 * @param max_events Maximum number of events to pop.
+	 * @return Number of events popped.
+	 */
+	template<class callable>
+	::std::size_t consume(callable&& func, ::std::size_t max_events = SIZE_MAX)
+	{
+		::std::size_t num_events;
+
+		for (num_events = 0; num_events < max_events; num_events++) {
+			auto event = this->pop();
+			if (!event)
+				break;
+
+			func(*event);
+		}
+
+		return num_events;
+	}
+
+	/**
+	 * @brief Get the capacity of the queue.
+	 * @return Maximum number of queued events.
+	 */
+	::std::size_t capacity() const noexcept
+	{
+		return this->_m_mask + 1;
+	}
+
+	/**
+	 * @brief Get the approximate number of queued events.
+	 * @return Number of events.
+	 */
+	::std::size_t size_approx() const noexcept
+	{
+		auto tail = this->_m_tail.load(::std::memory_order_relaxed);
+		auto head = this->_m_head.load(::std::memory_order_relaxed);
+
+		return tail > head ? tail - head : 0;
+	}
+
+	/**
+	 * @brief Get the policy of the queue.
+	 * @return Behavior of the queue when it's full.
+	 */
+	overflow policy() const noexcept
+	{
+		return this->_m_policy;
+	}
+
+	/**
+	 * @brief Get the number of events queued.
+	 * @return Number of events.
+	 */
+	::std::uint64_t num_pushed() const noexcept
+	{
+		return this->_m_num_pushed.load(::std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get the number of events popped by the consumers.
+	 * @return Number of events.
+	 */
+	::std::uint64_t num_popped() const noexcept
+	{
+		return this->_m_num_popped.load(::std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get the number of events discarded by the drop policies.
+	 * @return Number of events.
+	 */
+	::std::uint64_t num_dropped() const noexcept
+	{
+		return this->_m_num_dropped.load(::std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get the number of times a push found the queue full.
+	 * @return Number of overflows.
+	 */
+	::std::uint64_t num_full() const noexcept
+	{
+		return this->_m_num_full.load(::std::memory_order_relaxed);
+	}
+
+private:
+
+	static_assert(::std::is_trivially_copyable<edge_event>::value,
+		      "edge events must be trivially copyable to be queued");
+
+	/* Keeps the producer and consumer positions on separate cache lines. */
+	static constexpr ::std::size_t cacheline_size = 64;
+
+	/*
+	 * The sequence number of a slot tells its owner. It's equal to the
+	 * position of the next push into the slot while the slot is free and
+	 * to that position plus one once the slot holds an event.
+	 */
+	struct slot
+	{
+		::std::atomic<::std::size_t> seq;
+		typename ::std::aligned_storage<sizeof(edge_event),
+						alignof(edge_event)>::type storage;
+	};
+
+	static ::std::size_t round_capacity(::std::size_t capacity)
+	{
+		::std::size_t ret = 1;
+
+		if (capacity == 0 || capacity > (SIZE_MAX >> 2))
+			throw ::std::invalid_argument("invalid edge event queue capacity");
+
+		while (ret < capacity)
+			ret <<= 1;
+
+		return ret;
+	}
+
+	bool try_enqueue(const edge_event& event) noexcept
+	{
+		auto pos = this->_m_tail.load(::std::memory_order_relaxed);
+		slot* cur;
+
+		for (;;) {
+			cur = &this->_m_slots[pos & this->_m_mask];
+			auto seq = cur->seq.load(::std::memory_order_acquire);
+			auto diff = static_cast<::std::intptr_t>(seq - pos);
+
+			if (diff == 0) {
+				if (this->_m_tail.compare_exchange_weak(pos, pos + 1,
+							::std::memory_order_relaxed))
+					break;
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = this->_m_tail.load(::std::memory_order_relaxed);
+			}
+		}
+
+		new (&cur->storage) edge_event(event);
+		cur->seq.store(pos + 1, ::std::memory_order_release);
+
+		return true;
+	}
+
+	::std::optional<edge_event> try_dequeue() noexcept
+	{
+		auto pos = this->_m_head.load(::std::memory_order_relaxed);
+		slot* cur;
+
+		for (;;) {
+			cur = &this->_m_slots[pos & this->_m_mask];
+			auto seq = cur->seq.load(::std::memory_order_acquire);
+			auto diff = static_cast<::std::intptr_t>(seq - (pos + 1));
+
+			if (diff == 0) {
+				if (this->_m_head.compare_exchange_weak(pos, pos + 1,
+							::std::memory_order_relaxed))
+					break;
+			} else if (diff < 0) {
+				return ::std::nullopt;
+			} else {
+				pos = this->_m_head.load(::std::memory_order_relaxed);
+			}
+		}
+
+		::std::optional<edge_event> event(
+				*::std::launder(reinterpret_cast<edge_event*>(&cur->storage)));
+		cur->seq.store(pos + this->_m_mask + 1, ::std::memory_order_release);
+
+		return event;
+	}
+
+	const ::std::size_t _m_mask;
+	const overflow _m_policy;
+	::std::unique_ptr<slot[]> _m_slots;
+
+	alignas(cacheline_size) ::std::atomic<::std::size_t> _m_tail;
+	alignas(cacheline_size) ::std::atomic<::std::size_t> _m_head;
+
+	alignas(cacheline_size) ::std::atomic<::std::uint64_t> _m_num_pushed;
+	::std::atomic<::std::uint64_t> _m_num_dropped;
+	::std::atomic<::std::uint64_t> _m_num_full;
+	alignas(cacheline_size) ::std::atomic<::std::uint64_t> _m_num_popped;
+};
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_EDGE_EVENT_QUEUE_HPP__ */
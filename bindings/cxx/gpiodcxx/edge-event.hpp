@@ -14,13 +14,14 @@
 
 #include <cstdint>
 #include <iostream>
-#include <memory>
 
+#include "line.hpp"
 #include "timestamp.hpp"
 
 namespace gpiod {
 
 class edge_event_buffer;
+class event_dispatcher;
 
 /**
  * @ingroup gpiod_cxx
@@ -29,6 +30,9 @@ class edge_event_buffer;
 
 /**
  * @brief Immutable object containing data about a single edge event.
+ *
+ * The event data is stored inline, copying an event is as cheap as copying
+ * a small struct and doesn't allocate memory.
  */
 class edge_event
 {
@@ -49,29 +53,29 @@ public:
 	 * @brief Copy constructor.
 	 * @param other Object to copy.
 	 */
-	edge_event(const edge_event& other);
+	edge_event(const edge_event& other) noexcept = default;
 
 	/**
 	 * @brief Move constructor.
 	 * @param other Object to move.
 	 */
-	edge_event(edge_event&& other) noexcept;
+	edge_event(edge_event&& other) noexcept = default;
 
-	~edge_event();
+	~edge_event() = default;
 
 	/**
 	 * @brief Copy assignment operator.
 	 * @param other Object to copy.
 	 * @return Reference to self.
 	 */
-	edge_event& operator=(const edge_event& other);
+	edge_event& operator=(const edge_event& other) noexcept = default;
 
 	/**
 	 * @brief Move assignment operator.
 	 * @param other Object to move.
 	 * @return Reference to self.
 	 */
-	edge_event& operator=(edge_event&& other) noexcept;
+	edge_event& operator=(edge_event&& other) noexcept = default;
 
 	/**
 	 * @brief Retrieve the event type.
@@ -109,15 +113,16 @@ public:
 
 private:
 
-	edge_event();
+	edge_event() noexcept;
 
-	struct impl;
-	struct impl_managed;
-	struct impl_external;
-
-	::std::shared_ptr<impl> _m_priv;
+	event_type _m_type;
+	timestamp _m_timestamp;
+	line::offset _m_line_offset;
+	unsigned long _m_global_seqno;
+	unsigned long _m_line_seqno;
 
 	friend edge_event_buffer;
+	friend event_dispatcher;
 };
 
 /**
@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file event-dispatcher.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_EVENT_DISPATCHER_HPP__
+#define __LIBGPIOD_CXX_EVENT_DISPATCHER_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+
+#include "line.hpp"
+
+namespace gpiod {
+
+class edge_event;
+class line_request;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Routes the edge events of many line requests to per-line handlers.
+ *
+ * The dispatcher takes ownership of the line requests added to it and waits
+ * for edge events on all of them at once. Every event is passed to the handler
+ * registered for the line it occurred on, which is looked up by indexing into
+ * a table of the request. Handlers are stored when registered, dispatching an
+ * event doesn't allocate memory.
+ *
+ * Events can be dispatched from the thread calling event_dispatcher::dispatch
+ * or from a dedicated thread started with event_dispatcher::start.
+ */
+class event_dispatcher final
+{
+public:
+
+	/**
+	 * @brief Handler invoked with every event of a line. The event is only
+	 *        valid until the handler returns.
+	 */
+	using edge_handler = ::std::function<void(const edge_event&)>;
+
+	/**
+	 * @brief Constructor.
+	 * @param event_buffer_size Number of events read from a request at
+	 *                          once. If 0, the default size is used.
+	 */
+	explicit event_dispatcher(::std::size_t event_buffer_size = 0);
+
+	event_dispatcher(const event_dispatcher& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 * @note Must not be called while the dispatcher thread is running.
+	 */
+	event_dispatcher(event_dispatcher&& other) noexcept;
+
+	/**
+	 * @brief Destructor. Stops the dispatcher thread if it's running and
+	 *        releases all requests.
+	 */
+	~event_dispatcher();
+
+	event_dispatcher& operator=(const event_dispatcher& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 * @note Must not be called while the dispatcher thread of either object
+	 *       is running.
+	 */
+	event_dispatcher& operator=(event_dispatcher&& other) noexcept;
+
+	/**
+	 * @brief Take ownership of a line request and start watching it.
+	 * @param request Line request to add. Must have edge detection enabled
+	 *                on at least one line to generate events.
+	 * @return Index of the request within the dispatcher.
+	 * @throw std::logic_error if the dispatcher thread is running.
+	 */
+	::std::size_t add_request(line_request&& request);
+
+	/**
+	 * @brief Get one of the requests owned by the dispatcher.
+	 * @param index Index returned by event_dispatcher::add_request.
+	 * @return Reference to the line request.
+	 */
+	line_request& get_request(::std::size_t index);
+
+	/**
+	 * @brief Get the number of requests owned by the dispatcher.
+	 * @return Number of requests.
+	 */
+	::std::size_t num_requests() const noexcept;
+
+	/**
+	 * @brief Set the handler for the events of a single line.
+	 * @param index Index of the request the line belongs to.
+	 * @param offset Offset of the line.
+	 * @param handler Handler to invoke. An empty handler removes the
+	 *                current one.
+	 * @throw std::invalid_argument if the line is not part of the request.
+	 * @throw std::logic_error if the dispatcher thread is running.
+	 */
+	void set_handler(::std::size_t index, line::offset offset, edge_handler handler);
+
+	/**
+	 * @brief Set the handler for the events of lines without a handler of
+	 *        their own.
+	 * @param handler Handler to invoke. An empty handler drops such events.
+	 * @throw std::logic_error if the dispatcher thread is running.
+	 */
+	void set_default_handler(edge_handler handler);
+
+	/**
+	 * @brief Wait for edge events and pass them to their handlers.
+	 * @param timeout Wait time limit. A negative value blocks until events
+	 *                arrive.
+	 * @return Number of events dispatched, 0 if the wait timed out.
+	 * @note Exceptions thrown by the handlers stop the dispatching and are
+	 *       propagated to the caller.
+	 * @throw std::logic_error if the dispatcher thread is running.
+	 */
+	::std::size_t dispatch(const ::std::chrono::nanoseconds& timeout);
+
+	/**
+	 * @brief Start dispatching events from a dedicated thread.
+	 * @param cpu CPU to pin the thread to. If negative, the thread isn't
+	 *            pinned.
+	 * @throw std::logic_error if the thread is already running.
+	 */
+	void start(int cpu = -1);
+
+	/**
+	 * @brief Stop the dispatcher thread and wait for it to exit.
+	 * @note If a handler threw an exception in the dispatcher thread, the
+	 *       thread exited and the exception is rethrown by this function.
+	 *       Nothing happens if the thread isn't running.
+	 */
+	void stop();
+
+	/**
+	 * @brief Check whether the dispatcher thread is running.
+	 * @return True if started and not stopped since, false otherwise.
+	 */
+	bool running() const noexcept;
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+};
+
+/**
+ * @brief Stream insertion operator for event dispatchers.
+ * @param out Output stream to write to.
+ * @param dispatcher Event dispatcher to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const event_dispatcher& dispatcher);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_EVENT_DISPATCHER_HPP__ */
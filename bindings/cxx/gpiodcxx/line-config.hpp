@@ -20,6 +20,7 @@ namespace gpiod {
 class chip;
 class line_request;
 class line_settings;
+class request_template;
 
 /**
  * @ingroup gpiod_cxx
@@ -101,6 +102,7 @@ private:
 
 	friend line_request;
 	friend request_builder;
+	friend request_template;
 };
 
 /**
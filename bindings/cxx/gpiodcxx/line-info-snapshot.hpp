@@ -0,0 +1,233 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file line-info-snapshot.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_LINE_INFO_SNAPSHOT_HPP__
+#define __LIBGPIOD_CXX_LINE_INFO_SNAPSHOT_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "line.hpp"
+
+namespace gpiod {
+
+class chip;
+class line_info_snapshot;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Lightweight view of the info of a single line stored in a
+ *        ::gpiod::line_info_snapshot.
+ *
+ * Views are cheap to copy and own nothing. They must not be used after the
+ * snapshot they were obtained from was destroyed.
+ */
+class line_info_view final
+{
+public:
+
+	/**
+	 * @brief Get the hardware offset of the line.
+	 * @return Offset of the line within the parent chip.
+	 */
+	line::offset offset() const noexcept;
+
+	/**
+	 * @brief Get the GPIO line name.
+	 * @return Name of the line or an empty string if the line is unnamed.
+	 *         The string is stored in the snapshot.
+	 */
+	::std::string_view name() const noexcept;
+
+	/**
+	 * @brief Check if the line is currently in use.
+	 * @return True if the line is in use, false otherwise.
+	 */
+	bool used() const noexcept;
+
+	/**
+	 * @brief Get the name of the consumer of the line.
+	 * @return Name of the consumer or an empty string if the line is unused
+	 *         or its consumer is unnamed. The string is stored in the
+	 *         snapshot.
+	 */
+	::std::string_view consumer() const noexcept;
+
+	/**
+	 * @brief Read the direction of the line.
+	 * @return Returns INPUT or OUTPUT.
+	 */
+	line::direction direction() const;
+
+	/**
+	 * @brief Read the current edge detection setting of the line.
+	 * @return Returns NONE, RISING, FALLING or BOTH.
+	 */
+	line::edge edge_detection() const;
+
+	/**
+	 * @brief Read the current bias setting of the line.
+	 * @return Returns PULL_UP, PULL_DOWN, DISABLED or UNKNOWN.
+	 */
+	line::bias bias() const;
+
+	/**
+	 * @brief Read the current drive setting of the line.
+	 * @return Returns PUSH_PULL, OPEN_DRAIN or OPEN_SOURCE.
+	 */
+	line::drive drive() const;
+
+	/**
+	 * @brief Check if the logical value of the line is inverted.
+	 * @return True if the line is "active-low", false otherwise.
+	 */
+	bool active_low() const noexcept;
+
+	/**
+	 * @brief Check if the line is debounced.
+	 * @return True if the line is debounced, false otherwise.
+	 */
+	bool debounced() const noexcept;
+
+	/**
+	 * @brief Read the current debounce period.
+	 * @return Current debounce period.
+	 */
+	::std::chrono::microseconds debounce_period() const noexcept;
+
+	/**
+	 * @brief Read the current event clock setting used for edge event
+	 *        timestamps.
+	 * @return Returns MONOTONIC, REALTIME or HTE.
+	 */
+	line::clock event_clock() const;
+
+private:
+
+	line_info_view(const void* info) noexcept;
+
+	/* The line info stored in the snapshot. */
+	const void* _m_info;
+
+	friend line_info_snapshot;
+};
+
+/**
+ * @brief Snapshot of the info of all lines of a chip.
+ *
+ * All lines are read at once into a single buffer holding their infos and
+ * strings. Lines are accessed through ::gpiod::line_info_view objects
+ * instead of owning ::gpiod::line_info objects.
+ */
+class line_info_snapshot final
+{
+public:
+
+	/**
+	 * @brief Constant iterator over the line info views.
+	 */
+	using const_iterator = ::std::vector<line_info_view>::const_iterator;
+
+	line_info_snapshot(const line_info_snapshot& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	line_info_snapshot(line_info_snapshot&& other) noexcept;
+
+	~line_info_snapshot();
+
+	line_info_snapshot& operator=(const line_info_snapshot& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	line_info_snapshot& operator=(line_info_snapshot&& other) noexcept;
+
+	/**
+	 * @brief Get the number of lines in the snapshot.
+	 * @return Number of lines of the chip at the time of the snapshot.
+	 */
+	::std::size_t num_lines() const noexcept;
+
+	/**
+	 * @brief Get the view of the info of a line.
+	 * @param offset Offset of the line.
+	 * @return View of the line info. Throws ::std::out_of_range if the
+	 *         offset is not part of the snapshot.
+	 */
+	const line_info_view& get_line_info(line::offset offset) const;
+
+	/**
+	 * @brief Get the size of the buffer holding the snapshot.
+	 * @return Size of the snapshot in bytes.
+	 */
+	::std::size_t size() const noexcept;
+
+	/**
+	 * @brief Get a constant iterator to the view of the first line.
+	 * @return Constant iterator to the first line info view.
+	 */
+	const_iterator begin() const noexcept;
+
+	/**
+	 * @brief Get a constant iterator to the element after the last line
+	 *        info view.
+	 * @return Constant iterator to the element after the last line info
+	 *         view.
+	 */
+	const_iterator end() const noexcept;
+
+private:
+
+	line_info_snapshot();
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+
+	friend chip;
+};
+
+/**
+ * @brief Stream insertion operator for GPIO line info views.
+ * @param out Output stream to write to.
+ * @param info GPIO line info view to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const line_info_view& info);
+
+/**
+ * @brief Stream insertion operator for GPIO line info snapshots.
+ * @param out Output stream to write to.
+ * @param snapshot GPIO line info snapshot to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const line_info_snapshot& snapshot);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_LINE_INFO_SNAPSHOT_HPP__ */
@@ -14,6 +14,7 @@
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 
@@ -24,7 +25,12 @@ namespace gpiod {
 class chip;
 class edge_event;
 class edge_event_buffer;
+class event_dispatcher;
 class line_config;
+class line_subset;
+class multi_request;
+class stats;
+class wait_cancel;
 
 /**
  * @ingroup gpiod_cxx
@@ -33,11 +39,28 @@ class line_config;
 
 /**
  * @brief Stores the context of a set of requested GPIO lines.
+ *
+ * The methods reading and setting line values may be called concurrently from
+ * many threads sharing a request as long as no two threads set the same lines
+ * at the same time. They use no state shared between the calls other than the
+ * atomically updated value shadows of the request. All other methods must not
+ * be called concurrently with any other method of the same request.
  */
 class line_request
 {
 public:
 
+	/**
+	 * @brief Conditions on the values of several lines waited for.
+	 */
+	enum class match
+	{
+		ALL = 1,
+		/**< All lines must have their expected values. */
+		ANY,
+		/**< At least one line must have its expected value. */
+	};
+
 	line_request(const line_request& other) = delete;
 
 	/**
@@ -57,6 +80,8 @@ public:
 	 */
 	line_request& operator=(line_request&& other) noexcept;
 
+	class transaction;
+
 	/**
 	 * @brief Check if this object is valid.
 	 * @return True if this object's methods can be used, false otherwise.
@@ -87,6 +112,15 @@ public:
 	 */
 	line::offsets offsets() const;
 
+	/**
+	 * @brief Get the position of a requested line in the value bitmasks.
+	 * @param offset Offset of the line within the chip.
+	 * @return Bit corresponding to the line in the masks used by
+	 *         line_request::get_values_mask and
+	 *         line_request::set_values_mask.
+	 */
+	::std::size_t offset_bit(line::offset offset) const;
+
 	/**
 	 * @brief Get the value of a single requested line.
 	 * @param offset Offset of the line to read within the chip.
@@ -119,6 +153,20 @@ public:
 	 */
 	void get_values(const line::offsets& offsets, line::values& values);
 
+	/**
+	 * @brief Get the values of a subset of requested lines into an array
+	 *        supplied by the caller.
+	 * @param offsets Array of line offsets.
+	 * @param values Array for storing the values. The indexes of read
+	 *               values will correspond with those in the offsets
+	 *               array.
+	 * @param num_values Number of elements in both arrays.
+	 * @note Neither this nor the single line variants allocate memory so
+	 *       they are suitable for calling in tight loops.
+	 */
+	void get_values(const line::offset* offsets, line::value* values,
+			::std::size_t num_values);
+
 	/**
 	 * @brief Get the values of all requested lines.
 	 * @param values Array in which the values will be stored. Must hold
@@ -151,6 +199,19 @@ public:
 	 */
 	line_request& set_values(const line::offsets& offsets, const line::values& values);
 
+	/**
+	 * @brief Set the values of a subset of requested lines.
+	 * @param offsets Array containing the offsets of lines to set.
+	 * @param values Array containing new values with indexes corresponding
+	 *               with those in the offsets array.
+	 * @param num_values Number of elements in both arrays.
+	 * @return Reference to self.
+	 * @note Neither this nor the single line variants allocate memory so
+	 *       they are suitable for calling in tight loops.
+	 */
+	line_request& set_values(const line::offset* offsets, const line::value* values,
+				 ::std::size_t num_values);
+
 	/**
 	 * @brief Set the values of all requested lines.
 	 * @param values Array of new line values. The size must be equal to
@@ -159,6 +220,34 @@ public:
 	 */
 	line_request& set_values(const line::values& values);
 
+	/**
+	 * @brief Get the values of requested lines identified by a bitmask.
+	 * @param mask Bitmask of the lines to read. Bit N corresponds to the
+	 *             line at index N of the list returned by
+	 *             line_request::offsets.
+	 * @return Bitmap of the values, bits not set in mask are cleared.
+	 */
+	::std::uint64_t get_values_mask(::std::uint64_t mask);
+
+	/**
+	 * @brief Set the values of requested lines identified by a bitmask.
+	 * @param mask Bitmask of the lines to set. Bit N corresponds to the
+	 *             line at index N of the list returned by
+	 *             line_request::offsets.
+	 * @param values Bitmap of the new values, bits not set in mask are
+	 *               ignored.
+	 * @return Reference to self.
+	 */
+	line_request& set_values_mask(::std::uint64_t mask, ::std::uint64_t values);
+
+	/**
+	 * @brief Prepare a subset of requested lines for repeated reads and
+	 *        writes.
+	 * @param offsets Offsets of the lines in the subset.
+	 * @return New line subset object.
+	 */
+	line_subset prepare_subset(const line::offsets& offsets);
+
 	/**
 	 * @brief Apply new config options to requested lines.
 	 * @param config New configuration.
@@ -166,6 +255,15 @@ public:
 	 */
 	line_request& reconfigure_lines(const line_config& config);
 
+	/**
+	 * @brief Apply new config options to a subset of requested lines.
+	 * @param config New configuration of the lines to change. Lines
+	 *               absent from it keep their current settings and
+	 *               output values.
+	 * @return Reference to self.
+	 */
+	line_request& reconfigure_lines_partial(const line_config& config);
+
 	/**
 	 * @brief Get the file descriptor number associated with this line
 	 *        request.
@@ -173,6 +271,17 @@ public:
 	 */
 	int fd() const;
 
+	/**
+	 * @brief Get the I/O statistics of this line request.
+	 * @return New stats object.
+	 */
+	stats get_stats() const;
+
+	/**
+	 * @brief Zero the I/O statistics of this line request.
+	 */
+	void reset_stats();
+
 	/**
 	 * @brief Wait for edge events on any of the lines requested with edge
 	 *        detection enabled.
@@ -182,6 +291,41 @@ public:
 	 */
 	bool wait_edge_events(const ::std::chrono::nanoseconds& timeout) const;
 
+	/**
+	 * @brief Wait for edge events, returning early if the wait is
+	 *        cancelled.
+	 * @param timeout Wait time limit in nanoseconds.
+	 * @param cancel Cancellation object watched alongside the request.
+	 * @return True if at least one event is ready to be read. False if the
+	 *         wait timed out or was cancelled.
+	 */
+	bool wait_edge_events(const ::std::chrono::nanoseconds& timeout,
+			      const wait_cancel& cancel) const;
+
+	/**
+	 * @brief Wait until a single line has the given value.
+	 * @param offset Offset of the line.
+	 * @param value Expected value of the line.
+	 * @param timeout Wait time limit in nanoseconds.
+	 * @return True if the line has the value. False if the wait timed out.
+	 * @note The line must detect the edge leading to the value. Edge events
+	 *       read while waiting are discarded.
+	 */
+	bool wait_for_value(line::offset offset, line::value value,
+			    const ::std::chrono::nanoseconds& timeout);
+
+	/**
+	 * @brief Wait until a set of lines have the given values.
+	 * @param values Vector of offset->expected value mappings.
+	 * @param how Whether all or any of the lines must have their values.
+	 * @param timeout Wait time limit in nanoseconds.
+	 * @return True if the condition is met. False if the wait timed out.
+	 * @note Each line must detect the edge leading to its expected value.
+	 *       Edge events read while waiting are discarded.
+	 */
+	bool wait_for_values(const line::value_mappings& values, match how,
+			     const ::std::chrono::nanoseconds& timeout);
+
 	/**
 	 * @brief Read a number of edge events from this request up to the
 	 *        maximum capacity of the buffer.
@@ -207,6 +351,9 @@ private:
 
 	::std::unique_ptr<impl> _m_priv;
 
+	friend chip;
+	friend event_dispatcher;
+	friend multi_request;
 	friend request_builder;
 };
 
@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file line-subset.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_LINE_SUBSET_HPP__
+#define __LIBGPIOD_CXX_LINE_SUBSET_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "line.hpp"
+
+namespace gpiod {
+
+class line_request;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Prepared subset of the lines of a line request.
+ *
+ * The offsets of the subset are validated and mapped to the positions of the
+ * lines within the parent request once, when the subset is created. Reading
+ * and writing values through the subset is then a single system call without
+ * any further translation.
+ *
+ * @note The subset must not be used after the parent request was released.
+ */
+class line_subset
+{
+public:
+
+	line_subset(const line_subset& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	line_subset(line_subset&& other) noexcept;
+
+	~line_subset();
+
+	line_subset& operator=(const line_subset& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	line_subset& operator=(line_subset&& other) noexcept;
+
+	/**
+	 * @brief Get the number of lines in this subset.
+	 * @return Number of lines.
+	 */
+	::std::size_t num_lines() const noexcept;
+
+	/**
+	 * @brief Get the offsets of the lines in this subset.
+	 * @return Offsets in the order they were passed to
+	 *         line_request::prepare_subset.
+	 */
+	const line::offsets& offsets() const noexcept;
+
+	/**
+	 * @brief Get the request-relative bitmask of the lines in this subset.
+	 * @return Bitmask of the lines.
+	 */
+	::std::uint64_t mask() const noexcept;
+
+	/**
+	 * @brief Read the values of all lines in this subset.
+	 * @return Vector of values with indexes corresponding to those of the
+	 *         subset offsets.
+	 */
+	line::values get_values();
+
+	/**
+	 * @brief Read the values of all lines in this subset into a vector
+	 *        supplied by the caller.
+	 * @param values Vector for storing the values. Its size must be equal
+	 *               to the number of lines in this subset.
+	 */
+	void get_values(line::values& values);
+
+	/**
+	 * @brief Set the values of all lines in this subset.
+	 * @param values Vector of new values with indexes corresponding to
+	 *               those of the subset offsets. Its size must be equal to
+	 *               the number of lines in this subset.
+	 * @return Reference to self.
+	 */
+	line_subset& set_values(const line::values& values);
+
+private:
+
+	line_subset();
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+
+	friend line_request;
+};
+
+/**
+ * @brief Stream insertion operator for line subsets.
+ * @param out Output stream to write to.
+ * @param subset Line subset object to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const line_subset& subset);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_LINE_SUBSET_HPP__ */
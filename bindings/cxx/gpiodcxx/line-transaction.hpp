@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file line-transaction.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_LINE_TRANSACTION_HPP__
+#define __LIBGPIOD_CXX_LINE_TRANSACTION_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "line.hpp"
+#include "line-request.hpp"
+
+namespace gpiod {
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Output changes staged in memory and written to a request in phases.
+ *
+ * Values staged within a phase are written all at once, the last value staged
+ * for a line wins. Phases are committed in the order they were started with
+ * one system call each. Empty phases and phases not changing any line whose
+ * value is known to the request are skipped.
+ *
+ * Changes not committed when the transaction goes out of scope are discarded.
+ *
+ * @note The transaction must not be used after the request was released.
+ */
+class line_request::transaction final
+{
+public:
+
+	/**
+	 * @brief Start a transaction with a single, empty phase.
+	 * @param request Line request to write to.
+	 */
+	explicit transaction(line_request& request);
+
+	transaction(const transaction& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	transaction(transaction&& other) noexcept;
+
+	~transaction();
+
+	transaction& operator=(const transaction& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	transaction& operator=(transaction&& other) noexcept;
+
+	/**
+	 * @brief Stage the value of a single line in the current phase.
+	 * @param offset Offset of the line within the chip.
+	 * @param value New line value.
+	 * @return Reference to self.
+	 */
+	transaction& set_value(line::offset offset, line::value value);
+
+	/**
+	 * @brief Stage the values of a subset of lines in the current phase.
+	 * @param values Vector containing a set of offset->value mappings.
+	 * @return Reference to self.
+	 */
+	transaction& set_values(const line::value_mappings& values);
+
+	/**
+	 * @brief Stage the values of a subset of lines in the current phase.
+	 * @param offsets Vector containing the offsets of lines to set.
+	 * @param values Vector containing new values with indexes
+	 *               corresponding with those in the offsets vector.
+	 * @return Reference to self.
+	 */
+	transaction& set_values(const line::offsets& offsets, const line::values& values);
+
+	/**
+	 * @brief Stage the values of lines identified by a bitmask in the
+	 *        current phase.
+	 * @param mask Bitmask of the lines to set. Bit N corresponds to the
+	 *             line at index N of the list returned by
+	 *             line_request::offsets.
+	 * @param values Bitmap of the new values, bits not set in mask are
+	 *               ignored.
+	 * @return Reference to self.
+	 */
+	transaction& set_values_mask(::std::uint64_t mask, ::std::uint64_t values);
+
+	/**
+	 * @brief Stage the lines identified by a bitmask as active.
+	 * @param mask Bitmask of the lines to set.
+	 * @return Reference to self.
+	 */
+	transaction& set_bits(::std::uint64_t mask);
+
+	/**
+	 * @brief Stage the lines identified by a bitmask as inactive.
+	 * @param mask Bitmask of the lines to clear.
+	 * @return Reference to self.
+	 */
+	transaction& clear_bits(::std::uint64_t mask);
+
+	/**
+	 * @brief Start a new phase, committed after all the previous ones.
+	 * @return Reference to self.
+	 * @note Does nothing if the current phase is empty.
+	 */
+	transaction& next_phase();
+
+	/**
+	 * @brief Get the number of phases with staged values.
+	 * @return Number of non-empty phases.
+	 */
+	::std::size_t num_phases() const;
+
+	/**
+	 * @brief Drop all staged values.
+	 */
+	void discard();
+
+	/**
+	 * @brief Write all staged phases to the request, in order.
+	 * @note On success the transaction is emptied and can be reused. If
+	 *       an exception is thrown, the phases written so far are dropped
+	 *       while the failed phase and the ones following it stay staged.
+	 */
+	void commit();
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+};
+
+/**
+ * @brief Stream insertion operator for line request transactions.
+ * @param out Output stream to write to.
+ * @param tx Transaction object to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const line_request::transaction& tx);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_LINE_TRANSACTION_HPP__ */
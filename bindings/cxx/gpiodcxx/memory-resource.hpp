@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file memory-resource.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_MEMORY_RESOURCE_HPP__
+#define __LIBGPIOD_CXX_MEMORY_RESOURCE_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <memory_resource>
+
+namespace gpiod {
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Scope within which the configuration objects created by the calling
+ *        thread are allocated from a memory resource.
+ *
+ * While the scope is alive, line_settings, line_config, request_config and
+ * request_builder objects created by the calling thread, together with the
+ * C objects backing them, take their memory from the given resource instead
+ * of the heap. Each object returns its memory to the resource it came from
+ * so the objects may outlive the scope but not the resource. Scopes nest,
+ * the previous resource is restored when a scope ends.
+ *
+ * Line requests are never allocated from the resource, so a monotonic
+ * arena can be released as soon as the configuration objects are gone.
+ */
+class memory_resource_scope final
+{
+public:
+
+	/**
+	 * @brief Constructor.
+	 * @param resource Memory resource to use. The resource must outlive
+	 *                 all objects allocated from it. Passing nullptr
+	 *                 selects the default heap for the scope.
+	 */
+	explicit memory_resource_scope(::std::pmr::memory_resource* resource) noexcept;
+
+	memory_resource_scope(const memory_resource_scope& other) = delete;
+	memory_resource_scope(memory_resource_scope&& other) = delete;
+
+	~memory_resource_scope();
+
+	memory_resource_scope& operator=(const memory_resource_scope& other) = delete;
+	memory_resource_scope& operator=(memory_resource_scope&& other) = delete;
+
+	/**
+	 * @brief Get the memory resource used by the calling thread.
+	 * @return Resource of the innermost scope or nullptr if the default
+	 *         heap is in use.
+	 */
+	static ::std::pmr::memory_resource* current() noexcept;
+
+private:
+
+	::std::pmr::memory_resource* _m_prev;
+};
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_MEMORY_RESOURCE_HPP__ */
@@ -12,6 +12,7 @@
 #error "Only gpiod.hpp can be included directly."
 #endif
 
+#include <cstddef>
 #include <string>
 
 namespace gpiod {
@@ -35,6 +36,35 @@ bool is_gpiochip_device(const ::std::filesystem::path& path);
  */
 const ::std::string& api_version();
 
+/**
+ * @brief Set the initial capacity of the edge event buffers created without
+ *        an explicit one, process-wide.
+ * @param capacity New default capacity. Clamped to 1024 events, 0 restores
+ *                 the built-in default of 64 events.
+ */
+void set_default_event_buffer_capacity(::std::size_t capacity) noexcept;
+
+/**
+ * @brief Get the initial capacity of the edge event buffers created without
+ *        an explicit one.
+ * @return Default capacity in events.
+ */
+::std::size_t default_event_buffer_capacity() noexcept;
+
+/**
+ * @brief Set the capacity up to which adaptive edge event buffers grow,
+ *        process-wide.
+ * @param capacity New maximum capacity. Clamped to 1024 events, 0 restores
+ *                 the built-in maximum.
+ */
+void set_max_event_buffer_capacity(::std::size_t capacity) noexcept;
+
+/**
+ * @brief Get the capacity up to which adaptive edge event buffers grow.
+ * @return Maximum capacity in events.
+ */
+::std::size_t max_event_buffer_capacity() noexcept;
+
 /**
  * @}
  */
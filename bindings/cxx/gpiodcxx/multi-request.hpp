@@ -0,0 +1,272 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file multi-request.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_MULTI_REQUEST_HPP__
+#define __LIBGPIOD_CXX_MULTI_REQUEST_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "line.hpp"
+
+namespace gpiod {
+
+class chip;
+class line_request;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Line requests made on several chips driven as one group of lines.
+ *
+ * The multi-request takes ownership of the line requests added to it. Their
+ * lines are numbered consecutively in the order the requests were added and,
+ * within each request, in the order of line_request::offsets(). Operations on
+ * values make one call into the kernel per request. With workers started, the
+ * calls are made in parallel from one helper thread per request, all released
+ * at once, and the skew between them is reported by last_skew().
+ */
+class multi_request final
+{
+public:
+
+	/**
+	 * @brief Values of all lines of all member requests read at once.
+	 */
+	struct snapshot
+	{
+		/**
+		 * @brief Values of the lines of a single member request.
+		 */
+		struct sample
+		{
+			/**
+			 * @brief Monotonic time right before the call into the
+			 *        kernel.
+			 */
+			::std::chrono::nanoseconds before;
+
+			/**
+			 * @brief Monotonic time right after the call returned.
+			 */
+			::std::chrono::nanoseconds after;
+
+			/**
+			 * @brief Bitmap of the lines of the member, in the order
+			 *        of line_request::offsets().
+			 */
+			::std::uint64_t mask;
+
+			/**
+			 * @brief Bitmap of the values, a set bit meaning active.
+			 *        Only valid if error is 0.
+			 */
+			::std::uint64_t values;
+
+			/**
+			 * @brief 0 if the values were read, errno of the failed
+			 *        call otherwise.
+			 */
+			int error;
+		};
+
+		/**
+		 * @brief Middle of the window in which all values were read.
+		 */
+		::std::chrono::nanoseconds timestamp;
+
+		/**
+		 * @brief Time between the earliest and the latest of the
+		 *        samples, bounding the skew between any two values.
+		 */
+		::std::chrono::nanoseconds window;
+
+		/**
+		 * @brief One sample per member, in the order they were added.
+		 */
+		::std::vector<sample> samples;
+	};
+
+	/**
+	 * @brief Constructor. Creates an empty multi-request.
+	 */
+	multi_request();
+
+	multi_request(const multi_request& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	multi_request(multi_request&& other) noexcept;
+
+	/**
+	 * @brief Destructor. Stops the workers and releases all requests.
+	 */
+	~multi_request();
+
+	multi_request& operator=(const multi_request& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	multi_request& operator=(multi_request&& other) noexcept;
+
+	/**
+	 * @brief Add a line request.
+	 * @param request Line request to take over.
+	 * @return Index of the new member.
+	 * @throw std::system_error if the workers are running.
+	 */
+	::std::size_t add_request(line_request&& request);
+
+	/**
+	 * @brief Add a line request, allowing its lines to be found by name.
+	 * @param request Line request to take over.
+	 * @param chip Chip the request was made on.
+	 * @return Index of the new member.
+	 * @throw std::system_error if the workers are running.
+	 */
+	::std::size_t add_request(line_request&& request, chip& chip);
+
+	/**
+	 * @brief Get a member request.
+	 * @param member Index of the member.
+	 * @return Reference to the line request. It must not be released
+	 *         while it's part of the multi-request.
+	 * @throw std::out_of_range if the index is out of range.
+	 */
+	line_request& get_request(::std::size_t member);
+
+	/**
+	 * @brief Get the number of member requests.
+	 * @return Number of requests.
+	 */
+	::std::size_t num_requests() const noexcept;
+
+	/**
+	 * @brief Get the number of lines of all member requests.
+	 * @return Number of lines.
+	 */
+	::std::size_t num_lines() const noexcept;
+
+	/**
+	 * @brief Find a line by its member request and offset.
+	 * @param member Index of the member request.
+	 * @param offset Offset of the line.
+	 * @return Index of the line within the multi-request.
+	 * @throw std::invalid_argument if the line is not part of the request.
+	 */
+	unsigned int find_line(::std::size_t member, line::offset offset) const;
+
+	/**
+	 * @brief Find a line by its name.
+	 * @param name Name of the line.
+	 * @return Index of the first line with this name.
+	 * @throw std::system_error if no line has this name.
+	 */
+	unsigned int find_line(const ::std::string& name) const;
+
+	/**
+	 * @brief Get the values of all lines.
+	 * @return Vector of values, indexed like the lines.
+	 */
+	line::values get_values();
+
+	/**
+	 * @brief Get the values of a subset of lines.
+	 * @param lines Indexes of the lines.
+	 * @return Vector of values, one for every entry in \p lines.
+	 */
+	line::values get_values(const ::std::vector<unsigned int>& lines);
+
+	/**
+	 * @brief Set the values of all lines.
+	 * @param values Values to set, indexed like the lines.
+	 * @return Reference to self.
+	 */
+	multi_request& set_values(const line::values& values);
+
+	/**
+	 * @brief Set the values of a subset of lines.
+	 * @param lines Indexes of the lines.
+	 * @param values Values to set, one for every entry in \p lines.
+	 * @return Reference to self.
+	 */
+	multi_request& set_values(const ::std::vector<unsigned int>& lines,
+				  const line::values& values);
+
+	/**
+	 * @brief Start one helper thread per member request.
+	 * @param cpus CPU to pin the helper of every member to. Negative
+	 *             entries and members past the end of the vector leave
+	 *             the helpers unpinned.
+	 */
+	void start_workers(const ::std::vector<int>& cpus = {});
+
+	/**
+	 * @brief Stop the helper threads. No-op if they're not running.
+	 */
+	void stop_workers();
+
+	/**
+	 * @brief Check if the helper threads are running.
+	 * @return True if the workers are running, false otherwise.
+	 */
+	bool workers_running() const noexcept;
+
+	/**
+	 * @brief Get the skew of the last operation on values.
+	 * @return Time between the first and the last call into the kernel.
+	 */
+	::std::chrono::nanoseconds last_skew() const noexcept;
+
+	/**
+	 * @brief Read the values of all lines of all members, timestamping
+	 *        each member's call.
+	 * @return Snapshot of the values. The calls are made in parallel if
+	 *         the workers are running. Members the values of which couldn't
+	 *         be read are reported through the error of their sample.
+	 */
+	snapshot take_snapshot();
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+};
+
+/**
+ * @brief Stream insertion operator for multi-chip requests.
+ * @param out Output stream to write to.
+ * @param request Multi-request to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const multi_request& request);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_MULTI_REQUEST_HPP__ */
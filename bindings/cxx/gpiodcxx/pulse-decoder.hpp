@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file pulse-decoder.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_PULSE_DECODER_HPP__
+#define __LIBGPIOD_CXX_PULSE_DECODER_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+
+#include "line.hpp"
+#include "timestamp.hpp"
+
+namespace gpiod {
+
+class edge_event_buffer;
+class edge_event_pipeline;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Frame of bits assembled by a pulse decoder.
+ */
+struct pulse_frame
+{
+	/**
+	 * @brief Timing errors seen while the frame was assembled.
+	 */
+	enum error : int
+	{
+		WIDTH = 1,
+		/**< A pulse was outside of the pulse width limits. */
+		INTERVAL = 2,
+		/**< Two pulses started closer than the minimum interval. */
+		OVERLAP = 4,
+		/**< A pulse started while the other line was active. */
+		LOST_EDGE = 8,
+		/**< Two edges of the same type followed each other. */
+		OVERFLOW = 16,
+		/**< The frame had more than 64 bits. */
+	};
+
+	/**
+	 * @brief Bits of the frame, the last bit received being the least
+	 *        significant one.
+	 */
+	::std::uint64_t data;
+
+	/**
+	 * @brief Number of bits of the frame.
+	 */
+	unsigned int num_bits;
+
+	/**
+	 * @brief Bitwise OR of the pulse_frame::error flags of the frame.
+	 */
+	int errors;
+
+	/**
+	 * @brief Timestamp of the start of the frame.
+	 */
+	timestamp start;
+};
+
+/**
+ * @brief Decodes frames of pulse trains, such as Wiegand, from edge events.
+ *
+ * Edge event buffers filled by line_request::read_edge_events are decoded
+ * without going through the edge_event objects. See the documentation of the
+ * core library for the details of the supported encodings.
+ */
+class pulse_decoder final
+{
+public:
+
+	/**
+	 * @brief Create a Wiegand decoder.
+	 * @param data0 Offset of the line whose pulses are 0 bits.
+	 * @param data1 Offset of the line whose pulses are 1 bits.
+	 * @return New pulse decoder.
+	 */
+	static pulse_decoder wiegand(line::offset data0, line::offset data1);
+
+	/**
+	 * @brief Create a pulse width decoder.
+	 * @param offset Offset of the line carrying the pulses.
+	 * @param one_min Shortest pulse decoded as a 1 bit.
+	 * @return New pulse decoder.
+	 */
+	static pulse_decoder pulse_width(line::offset offset,
+					 const ::std::chrono::nanoseconds& one_min);
+
+	pulse_decoder(const pulse_decoder& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	pulse_decoder(pulse_decoder&& other) noexcept;
+
+	~pulse_decoder();
+
+	pulse_decoder& operator=(const pulse_decoder& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	pulse_decoder& operator=(pulse_decoder&& other) noexcept;
+
+	/**
+	 * @brief Set the time without edges ending a frame.
+	 * @param gap Frame gap.
+	 * @return Reference to self.
+	 */
+	pulse_decoder& set_frame_gap(const ::std::chrono::nanoseconds& gap);
+
+	/**
+	 * @brief Set the range of valid pulse widths.
+	 * @param min Shortest valid pulse.
+	 * @param max Longest valid pulse.
+	 * @return Reference to self.
+	 */
+	pulse_decoder& set_pulse_width_limits(const ::std::chrono::nanoseconds& min,
+					      const ::std::chrono::nanoseconds& max);
+
+	/**
+	 * @brief Set the shortest valid interval between the starts of two
+	 *        pulses.
+	 * @param interval Minimum interval.
+	 * @return Reference to self.
+	 */
+	pulse_decoder& set_min_interval(const ::std::chrono::nanoseconds& interval);
+
+	/**
+	 * @brief Decode the edge events stored in a buffer.
+	 * @param buffer Edge event buffer filled by
+	 *               line_request::read_edge_events. Growable buffers
+	 *               are not supported.
+	 * @return Number of complete frames queued in the decoder.
+	 */
+	::std::size_t add_events(const edge_event_buffer& buffer);
+
+	/**
+	 * @brief Complete the frame being assembled if the frame gap has
+	 *        passed.
+	 * @param now Current time on the clock of the event timestamps.
+	 * @return Number of complete frames queued in the decoder.
+	 */
+	::std::size_t flush(const timestamp& now);
+
+	/**
+	 * @brief Get the number of complete frames queued in the decoder.
+	 * @return Number of frames that can be read.
+	 */
+	::std::size_t num_frames() const noexcept;
+
+	/**
+	 * @brief Take the oldest complete frame off the queue.
+	 * @return The frame or an empty optional if the queue is empty.
+	 */
+	::std::optional<pulse_frame> read_frame();
+
+	/**
+	 * @brief Get the number of frames dropped because the queue was full.
+	 * @return Number of lost frames.
+	 */
+	unsigned long num_lost_frames() const noexcept;
+
+	/**
+	 * @brief Drop the frame being assembled and all queued frames.
+	 */
+	void reset() noexcept;
+
+private:
+
+	pulse_decoder();
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+
+	friend edge_event_pipeline;
+};
+
+/**
+ * @brief Stream insertion operator for pulse frames.
+ * @param out Output stream to write to.
+ * @param frame Frame to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const pulse_frame& frame);
+
+/**
+ * @brief Stream insertion operator for pulse decoders.
+ * @param out Output stream to write to.
+ * @param decoder Pulse decoder to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const pulse_decoder& decoder);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_PULSE_DECODER_HPP__ */
@@ -13,6 +13,7 @@
 #endif
 
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 
 namespace gpiod {
@@ -29,6 +30,10 @@ class request_config;
 
 /**
  * @brief Intermediate object storing the configuration for a line request.
+ *
+ * A builder created in a memory_resource_scope, or with an explicit memory
+ * resource, keeps allocating the configuration it stores from that resource
+ * for its whole lifetime.
  */
 class request_builder
 {
@@ -82,6 +87,30 @@ public:
 	 */
 	request_builder& set_event_buffer_size(::std::size_t event_buffer_size) noexcept;
 
+	/**
+	 * @brief Enable or disable the output value shadow in the request
+	 *        config stored by this object.
+	 * @param enabled New output shadow setting.
+	 * @return Reference to self.
+	 */
+	request_builder& set_output_shadow(bool enabled) noexcept;
+
+	/**
+	 * @brief Enable or disable the input value shadow in the request
+	 *        config stored by this object.
+	 * @param enabled New input shadow setting.
+	 * @return Reference to self.
+	 */
+	request_builder& set_input_shadow(bool enabled) noexcept;
+
+	/**
+	 * @brief Make the request non-blocking in the request config stored
+	 *        by this object.
+	 * @param enabled New non-blocking setting.
+	 * @return Reference to self.
+	 */
+	request_builder& set_nonblocking(bool enabled) noexcept;
+
 	/**
 	 * @brief Set the line config for this request.
 	 * @param line_cfg Line config to use.
@@ -124,7 +153,7 @@ private:
 
 	struct impl;
 
-	request_builder(chip& chip);
+	request_builder(chip& chip, ::std::pmr::memory_resource* resource);
 
 	::std::unique_ptr<impl> _m_priv;
 
@@ -22,6 +22,7 @@
 namespace gpiod {
 
 class chip;
+class request_template;
 
 /**
  * @ingroup gpiod_cxx
@@ -86,6 +87,53 @@ public:
 	 */
 	::std::size_t event_buffer_size() const noexcept;
 
+	/**
+	 * @brief Enable or disable the output value shadow.
+	 * @param enabled New output shadow setting.
+	 * @return Reference to self.
+	 * @note With the shadow enabled, reads of push-pull output lines are
+	 *       served from the last values written through the request and
+	 *       writes that don't change any line are skipped.
+	 */
+	request_config& set_output_shadow(bool enabled) noexcept;
+
+	/**
+	 * @brief Check if the output value shadow is enabled.
+	 * @return True if the output shadow is enabled, false otherwise.
+	 */
+	bool output_shadow() const noexcept;
+
+	/**
+	 * @brief Enable or disable the input value shadow.
+	 * @param enabled New input shadow setting.
+	 * @return Reference to self.
+	 * @note With the shadow enabled, reads of input lines with both edges
+	 *       detected are served from the values seen in the edge events
+	 *       read from the request.
+	 */
+	request_config& set_input_shadow(bool enabled) noexcept;
+
+	/**
+	 * @brief Check if the input value shadow is enabled.
+	 * @return True if the input shadow is enabled, false otherwise.
+	 */
+	bool input_shadow() const noexcept;
+
+	/**
+	 * @brief Make the file descriptor of the request non-blocking.
+	 * @param enabled New non-blocking setting.
+	 * @return Reference to self.
+	 * @note Reading edge events from a non-blocking request returns no
+	 *       events instead of blocking if none are queued.
+	 */
+	request_config& set_nonblocking(bool enabled) noexcept;
+
+	/**
+	 * @brief Check if requests made with this config are non-blocking.
+	 * @return True if requests are non-blocking, false otherwise.
+	 */
+	bool nonblocking() const noexcept;
+
 private:
 
 	struct impl;
@@ -95,6 +143,7 @@ private:
 	request_config& operator=(const request_config& other);
 
 	friend request_builder;
+	friend request_template;
 };
 
 /**
@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file request-template.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_REQUEST_TEMPLATE_HPP__
+#define __LIBGPIOD_CXX_REQUEST_TEMPLATE_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+
+namespace gpiod {
+
+class chip;
+class line_config;
+class request_config;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Line and request configuration translated once and usable for many
+ *        line requests.
+ *
+ * Templates are immutable, copies share the same underlying object. A
+ * template can be passed to chip::request_lines() of any number of chips and
+ * reused after the requests made with it are released.
+ */
+class request_template final
+{
+public:
+
+	/**
+	 * @brief Constructor.
+	 * @param line_cfg Line config to translate.
+	 * @throw std::invalid_argument if the line config contains no lines.
+	 */
+	explicit request_template(const line_config& line_cfg);
+
+	/**
+	 * @brief Constructor.
+	 * @param line_cfg Line config to translate.
+	 * @param req_cfg Request config to translate.
+	 * @throw std::invalid_argument if the line config contains no lines.
+	 */
+	request_template(const line_config& line_cfg, const request_config& req_cfg);
+
+	/**
+	 * @brief Copy constructor.
+	 * @param other Object to copy.
+	 */
+	request_template(const request_template& other);
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	request_template(request_template&& other) noexcept;
+
+	~request_template();
+
+	/**
+	 * @brief Copy assignment operator.
+	 * @param other Object to copy.
+	 * @return Reference to self.
+	 */
+	request_template& operator=(const request_template& other);
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	request_template& operator=(request_template&& other) noexcept;
+
+	/**
+	 * @brief Get the number of lines requested by this template.
+	 * @return Number of lines.
+	 */
+	::std::size_t num_lines() const;
+
+private:
+
+	struct impl;
+
+	::std::shared_ptr<impl> _m_priv;
+
+	friend chip;
+};
+
+/**
+ * @brief Stream insertion operator for request_template objects.
+ * @param out Output stream to write to.
+ * @param tmpl request_template to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const request_template& tmpl);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_REQUEST_TEMPLATE_HPP__ */
@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file static-line-group.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_STATIC_LINE_GROUP_HPP__
+#define __LIBGPIOD_CXX_STATIC_LINE_GROUP_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "line-request.hpp"
+
+namespace gpiod {
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Group of requested lines whose offsets are known at compile-time.
+ *
+ * Bit N of the values read and written through the group corresponds to the
+ * N-th offset in the template argument list. The positions of the lines within
+ * the request are looked up once, when the group is bound to the request.
+ * Reading or writing the group is then a single system call on a fixed mask.
+ * If the lines were requested in the order of the group, the values are only
+ * shifted into place instead of being remapped bit by bit.
+ *
+ * @tparam Offsets Offsets of the lines within the chip.
+ * @note The group keeps a reference to the request. It must not be used after
+ *       the request was moved or destroyed.
+ */
+template<unsigned int... Offsets>
+class static_line_group
+{
+public:
+
+	/**
+	 * @brief Number of lines in the group.
+	 */
+	static constexpr ::std::size_t num_lines = sizeof...(Offsets);
+
+	static_assert(num_lines > 0, "line group must not be empty");
+	static_assert(num_lines <= 64, "line group exceeds the maximum size of a request");
+
+	/**
+	 * @brief Values of the lines in the group.
+	 */
+	using bits = ::std::bitset<num_lines>;
+
+	/**
+	 * @brief Offsets of the lines in the group.
+	 */
+	static constexpr ::std::array<unsigned int, num_lines> offsets = { Offsets... };
+
+	/**
+	 * @brief Get the position of a line in the group values.
+	 * @tparam Offset Offset of the line within the chip.
+	 * @return Index of the bit holding the value of the line.
+	 */
+	template<unsigned int Offset>
+	static constexpr ::std::size_t index() noexcept
+	{
+		constexpr ::std::size_t idx = find(Offset);
+
+		static_assert(idx < num_lines, "offset is not part of the line group");
+
+		return idx;
+	}
+
+	/**
+	 * @brief Constructor. Binds the group to a request.
+	 * @param request Request containing all the lines of the group.
+	 * @throw std::invalid_argument if any of the lines is not in the
+	 *        request.
+	 */
+	explicit static_line_group(line_request& request)
+		: _m_request(&request),
+		  _m_bits(),
+		  _m_mask(0),
+		  _m_contiguous(true)
+	{
+		static_assert(unique(), "offsets of a line group must be unique");
+
+		for (::std::size_t i = 0; i < num_lines; i++) {
+			_m_bits[i] = request.offset_bit(offsets[i]);
+			_m_mask |= 1ULL << _m_bits[i];
+
+			if (_m_bits[i] != _m_bits[0] + i)
+				_m_contiguous = false;
+		}
+	}
+
+	/**
+	 * @brief Copy constructor.
+	 * @param other Object to copy.
+	 */
+	static_line_group(const static_line_group& other) = default;
+
+	/**
+	 * @brief Copy assignment operator.
+	 * @param other Object to copy.
+	 * @return Reference to self.
+	 */
+	static_line_group& operator=(const static_line_group& other) = default;
+
+	~static_line_group() = default;
+
+	/**
+	 * @brief Read the values of all lines in the group.
+	 * @return Values of the lines in the order of the template arguments.
+	 */
+	bits get() const
+	{
+		::std::uint64_t values = this->_m_request->get_values_mask(this->_m_mask);
+
+		if (this->_m_contiguous)
+			return bits(values >> this->_m_bits[0]);
+
+		bits ret;
+
+		for (::std::size_t i = 0; i < num_lines; i++)
+			ret[i] = (values >> this->_m_bits[i]) & 1;
+
+		return ret;
+	}
+
+	/**
+	 * @brief Set the values of all lines in the group.
+	 * @param values Values of the lines in the order of the template
+	 *               arguments.
+	 */
+	void set(const bits& values) const
+	{
+		::std::uint64_t mapped = 0;
+
+		if (this->_m_contiguous) {
+			mapped = static_cast<::std::uint64_t>(values.to_ullong()) << this->_m_bits[0];
+		} else {
+			for (::std::size_t i = 0; i < num_lines; i++) {
+				if (values[i])
+					mapped |= 1ULL << this->_m_bits[i];
+			}
+		}
+
+		this->_m_request->set_values_mask(this->_m_mask, mapped);
+	}
+
+	/**
+	 * @brief Get the request-relative bitmask of the lines in the group.
+	 * @return Bitmask of the lines.
+	 */
+	::std::uint64_t mask() const noexcept
+	{
+		return this->_m_mask;
+	}
+
+private:
+
+	static constexpr ::std::size_t find(unsigned int offset) noexcept
+	{
+		for (::std::size_t i = 0; i < num_lines; i++) {
+			if (offsets[i] == offset)
+				return i;
+		}
+
+		return num_lines;
+	}
+
+	static constexpr bool unique() noexcept
+	{
+		for (::std::size_t i = 0; i < num_lines; i++) {
+			if (find(offsets[i]) != i)
+				return false;
+		}
+
+		return true;
+	}
+
+	line_request* _m_request;
+	::std::array<unsigned int, num_lines> _m_bits;
+	::std::uint64_t _m_mask;
+	bool _m_contiguous;
+};
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_STATIC_LINE_GROUP_HPP__ */
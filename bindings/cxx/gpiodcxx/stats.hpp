@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file stats.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_STATS_HPP__
+#define __LIBGPIOD_CXX_STATS_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+namespace gpiod {
+
+class chip;
+class line_request;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Represents an immutable snapshot of the I/O statistics of a chip
+ *        or a line request.
+ */
+class stats
+{
+public:
+
+	/**
+	 * @brief Copy constructor.
+	 * @param other Object to copy.
+	 */
+	stats(const stats& other);
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	stats(stats&& other) noexcept;
+
+	~stats();
+
+	/**
+	 * @brief Assignment operator.
+	 * @param other Object to copy.
+	 * @return Reference to self.
+	 */
+	stats& operator=(const stats& other);
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	stats& operator=(stats&& other) noexcept;
+
+	/**
+	 * @brief Get the number of ioctls reading line values.
+	 * @return Number of calls.
+	 */
+	::std::uint64_t num_get_ioctls() const noexcept;
+
+	/**
+	 * @brief Get the number of ioctls setting line values.
+	 * @return Number of calls.
+	 */
+	::std::uint64_t num_set_ioctls() const noexcept;
+
+	/**
+	 * @brief Get the number of ioctls requesting or reconfiguring lines.
+	 * @return Number of calls.
+	 */
+	::std::uint64_t num_config_ioctls() const noexcept;
+
+	/**
+	 * @brief Get the number of ioctls reading or watching chip and line
+	 *        info.
+	 * @return Number of calls.
+	 */
+	::std::uint64_t num_info_ioctls() const noexcept;
+
+	/**
+	 * @brief Get the number of reads returning events.
+	 * @return Number of calls.
+	 */
+	::std::uint64_t num_reads() const noexcept;
+
+	/**
+	 * @brief Get the number of events read.
+	 * @return Number of events.
+	 */
+	::std::uint64_t num_events_read() const noexcept;
+
+	/**
+	 * @brief Get the number of bytes read.
+	 * @return Number of bytes.
+	 */
+	::std::uint64_t num_bytes_read() const noexcept;
+
+	/**
+	 * @brief Get the total time spent in ioctls.
+	 * @return Cumulative time.
+	 */
+	::std::chrono::nanoseconds ioctl_time() const noexcept;
+
+	/**
+	 * @brief Get the time taken by the slowest ioctl.
+	 * @return Time of the call.
+	 */
+	::std::chrono::nanoseconds max_ioctl_time() const noexcept;
+
+	/**
+	 * @brief Get the total time spent waiting for events.
+	 * @return Cumulative time.
+	 */
+	::std::chrono::nanoseconds wait_time() const noexcept;
+
+private:
+
+	stats();
+
+	struct impl;
+
+	::std::shared_ptr<impl> _m_priv;
+
+	friend chip;
+	friend line_request;
+};
+
+/**
+ * @brief Stream insertion operator for statistics objects.
+ * @param out Output stream to write to.
+ * @param stats Statistics to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const stats& stats);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_STATS_HPP__ */
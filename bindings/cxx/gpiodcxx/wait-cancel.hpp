@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+/**
+ * @file wait-cancel.hpp
+ */
+
+#ifndef __LIBGPIOD_CXX_WAIT_CANCEL_HPP__
+#define __LIBGPIOD_CXX_WAIT_CANCEL_HPP__
+
+#if !defined(__LIBGPIOD_GPIOD_CXX_INSIDE__)
+#error "Only gpiod.hpp can be included directly."
+#endif
+
+#include <memory>
+#include <ostream>
+
+namespace gpiod {
+
+class chip;
+class line_request;
+
+/**
+ * @ingroup gpiod_cxx
+ * @{
+ */
+
+/**
+ * @brief Cancellation object for blocking waits.
+ *
+ * Passing the object to chip::wait_info_event or
+ * line_request::wait_edge_events makes the wait return early once the object
+ * is triggered from any other thread. The object stays triggered until it is
+ * reset.
+ */
+class wait_cancel final
+{
+public:
+
+	wait_cancel();
+
+	wait_cancel(const wait_cancel& other) = delete;
+
+	/**
+	 * @brief Move constructor.
+	 * @param other Object to move.
+	 */
+	wait_cancel(wait_cancel&& other) noexcept;
+
+	~wait_cancel();
+
+	wait_cancel& operator=(const wait_cancel& other) = delete;
+
+	/**
+	 * @brief Move assignment operator.
+	 * @param other Object to move.
+	 * @return Reference to self.
+	 */
+	wait_cancel& operator=(wait_cancel&& other) noexcept;
+
+	/**
+	 * @brief Cancel all current and future waits using this object.
+	 */
+	void trigger();
+
+	/**
+	 * @brief Clear the triggered state of this object.
+	 */
+	void reset();
+
+	/**
+	 * @brief Check whether this object was triggered.
+	 * @return True if triggered and not reset since, false otherwise.
+	 */
+	bool is_triggered() const;
+
+	/**
+	 * @brief Get the file descriptor of this object.
+	 * @return Eventfd that becomes readable once the object is triggered.
+	 */
+	int fd() const;
+
+private:
+
+	struct impl;
+
+	::std::unique_ptr<impl> _m_priv;
+
+	friend chip;
+	friend line_request;
+};
+
+/**
+ * @brief Stream insertion operator for cancellation objects.
+ * @param out Output stream to write to.
+ * @param cancel Cancellation object to insert into the output stream.
+ * @return Reference to out.
+ */
+::std::ostream& operator<<(::std::ostream& out, const wait_cancel& cancel);
+
+/**
+ * @}
+ */
+
+} /* namespace gpiod */
+
+#endif /* __LIBGPIOD_CXX_WAIT_CANCEL_HPP__ */
@@ -4,10 +4,17 @@
 #ifndef __LIBGPIOD_CXX_INTERNAL_HPP__
 #define __LIBGPIOD_CXX_INTERNAL_HPP__
 
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <gpiod.h>
-#include <map>
+#include <initializer_list>
+#include <list>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -18,9 +25,82 @@
 
 namespace gpiod {
 
+/*
+ * The enums of the C and C++ APIs are small and dense so they're mapped onto
+ * each other - and onto their names - by indexing into tables built at
+ * compile-time instead of searching a tree.
+ */
+template<class key_type, class value_type> class enum_mapping
+{
+public:
+	using item = ::std::pair<key_type, value_type>;
+
+	constexpr enum_mapping() noexcept
+		: _m_valid(),
+		  _m_values()
+	{
+
+	}
+
+	constexpr enum_mapping(::std::initializer_list<item> items) noexcept
+		: enum_mapping()
+	{
+		for (const auto& item: items)
+			this->add(item.first, item.second);
+	}
+
+	constexpr bool contains(key_type key) const noexcept
+	{
+		auto idx = index(key);
+
+		return idx < max_values && this->_m_valid[idx];
+	}
+
+	const value_type& at(key_type key) const
+	{
+		if (!this->contains(key))
+			throw ::std::out_of_range("no mapping for this enum value");
+
+		return this->_m_values[index(key)];
+	}
+
+	constexpr enum_mapping<value_type, key_type> reverse() const noexcept
+	{
+		enum_mapping<value_type, key_type> ret;
+
+		for (::std::size_t i = 0; i < max_values; i++) {
+			if (this->_m_valid[i])
+				ret.add(this->_m_values[i], static_cast<key_type>(i));
+		}
+
+		return ret;
+	}
+
+private:
+	/* Enums with larger values fail to compile as constexpr tables. */
+	static constexpr ::std::size_t max_values = 8;
+
+	static constexpr ::std::size_t index(key_type key) noexcept
+	{
+		/* Negative values wrap around and end up out of range. */
+		return static_cast<::std::size_t>(key);
+	}
+
+	constexpr void add(key_type key, value_type value) noexcept
+	{
+		this->_m_valid[index(key)] = true;
+		this->_m_values[index(key)] = value;
+	}
+
+	bool _m_valid[max_values];
+	value_type _m_values[max_values];
+
+	template<class, class> friend class enum_mapping;
+};
+
 template<class cxx_enum_type, class c_enum_type>
 cxx_enum_type get_mapped_value(c_enum_type value,
-			       const ::std::map<c_enum_type, cxx_enum_type>& mapping)
+			       const enum_mapping<c_enum_type, cxx_enum_type>& mapping)
 {
 	try {
 		return mapping.at(value);
@@ -49,10 +129,26 @@ using info_event_deleter = deleter<::gpiod_info_event, ::gpiod_info_event_free>;
 using line_settings_deleter = deleter<::gpiod_line_settings, ::gpiod_line_settings_free>;
 using line_config_deleter = deleter<::gpiod_line_config, ::gpiod_line_config_free>;
 using request_config_deleter = deleter<::gpiod_request_config, ::gpiod_request_config_free>;
+using request_template_deleter = deleter<::gpiod_request_template,
+					 ::gpiod_request_template_free>;
 using line_request_deleter = deleter<::gpiod_line_request, ::gpiod_line_request_release>;
-using edge_event_deleter = deleter<::gpiod_edge_event, ::gpiod_edge_event_free>;
+using line_subset_deleter = deleter<::gpiod_line_subset, ::gpiod_line_subset_free>;
+using line_transaction_deleter = deleter<::gpiod_line_transaction,
+					 ::gpiod_line_transaction_free>;
+using wait_cancel_deleter = deleter<::gpiod_wait_cancel, ::gpiod_wait_cancel_free>;
+using stats_deleter = deleter<::gpiod_stats, ::gpiod_stats_free>;
+using event_loop_deleter = deleter<::gpiod_event_loop, ::gpiod_event_loop_free>;
+using multi_request_deleter = deleter<::gpiod_multi_request, ::gpiod_multi_request_free>;
 using edge_event_buffer_deleter = deleter<::gpiod_edge_event_buffer,
 					  ::gpiod_edge_event_buffer_free>;
+using pulse_decoder_deleter = deleter<::gpiod_pulse_decoder, ::gpiod_pulse_decoder_free>;
+using capture_reader_deleter = deleter<::gpiod_capture_reader, ::gpiod_capture_reader_close>;
+using edge_event_pipeline_deleter = deleter<::gpiod_edge_event_pipeline,
+					    ::gpiod_edge_event_pipeline_free>;
+using line_info_snapshot_deleter = deleter<::gpiod_line_info_snapshot,
+					   ::gpiod_line_info_snapshot_free>;
+using multi_request_snapshot_deleter = deleter<::gpiod_multi_request_snapshot,
+					       ::gpiod_multi_request_snapshot_free>;
 
 using chip_ptr = ::std::unique_ptr<::gpiod_chip, chip_deleter>;
 using chip_info_ptr = ::std::unique_ptr<::gpiod_chip_info, chip_info_deleter>;
@@ -61,10 +157,26 @@ using info_event_ptr = ::std::unique_ptr<::gpiod_info_event, info_event_deleter>
 using line_settings_ptr = ::std::unique_ptr<::gpiod_line_settings, line_settings_deleter>;
 using line_config_ptr = ::std::unique_ptr<::gpiod_line_config, line_config_deleter>;
 using request_config_ptr = ::std::unique_ptr<::gpiod_request_config, request_config_deleter>;
+using request_template_ptr = ::std::unique_ptr<::gpiod_request_template,
+					     request_template_deleter>;
 using line_request_ptr = ::std::unique_ptr<::gpiod_line_request, line_request_deleter>;
-using edge_event_ptr = ::std::unique_ptr<::gpiod_edge_event, edge_event_deleter>;
+using line_subset_ptr = ::std::unique_ptr<::gpiod_line_subset, line_subset_deleter>;
+using line_transaction_ptr = ::std::unique_ptr<::gpiod_line_transaction,
+					     line_transaction_deleter>;
+using wait_cancel_ptr = ::std::unique_ptr<::gpiod_wait_cancel, wait_cancel_deleter>;
+using stats_ptr = ::std::unique_ptr<::gpiod_stats, stats_deleter>;
+using event_loop_ptr = ::std::unique_ptr<::gpiod_event_loop, event_loop_deleter>;
+using multi_request_ptr = ::std::unique_ptr<::gpiod_multi_request, multi_request_deleter>;
 using edge_event_buffer_ptr = ::std::unique_ptr<::gpiod_edge_event_buffer,
 						edge_event_buffer_deleter>;
+using pulse_decoder_ptr = ::std::unique_ptr<::gpiod_pulse_decoder, pulse_decoder_deleter>;
+using capture_reader_ptr = ::std::unique_ptr<::gpiod_capture_reader, capture_reader_deleter>;
+using edge_event_pipeline_ptr = ::std::unique_ptr<::gpiod_edge_event_pipeline,
+					      edge_event_pipeline_deleter>;
+using line_info_snapshot_ptr = ::std::unique_ptr<::gpiod_line_info_snapshot,
+					     line_info_snapshot_deleter>;
+using multi_request_snapshot_ptr = ::std::unique_ptr<::gpiod_multi_request_snapshot,
+						 multi_request_snapshot_deleter>;
 
 struct chip::impl
 {
@@ -92,6 +204,19 @@ struct chip_info::impl
 	chip_info_ptr info;
 };
 
+struct stats::impl
+{
+	impl() = default;
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	void set_stats_ptr(stats_ptr& new_stats);
+
+	stats_ptr stats;
+};
+
 struct line_info::impl
 {
 	impl() = default;
@@ -105,6 +230,20 @@ struct line_info::impl
 	line_info_ptr info;
 };
 
+struct line_info_snapshot::impl
+{
+	impl() = default;
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	void set_snapshot_ptr(line_info_snapshot_ptr& new_snapshot);
+
+	line_info_snapshot_ptr snapshot;
+	::std::vector<line_info_view> lines;
+};
+
 struct info_event::impl
 {
 	impl() = default;
@@ -119,7 +258,18 @@ struct info_event::impl
 	line_info info;
 };
 
-struct line_settings::impl
+/*
+ * Base of the implementations of the configuration objects. Allocates them
+ * from the memory resource of the current memory_resource_scope and hands
+ * them back to the same resource whichever thread destroys them.
+ */
+struct resource_allocated
+{
+	static void* operator new(::std::size_t size);
+	static void operator delete(void* ptr) noexcept;
+};
+
+struct line_settings::impl : public resource_allocated
 {
 	impl();
 	impl(const impl& other);
@@ -130,7 +280,7 @@ struct line_settings::impl
 	line_settings_ptr settings;
 };
 
-struct line_config::impl
+struct line_config::impl : public resource_allocated
 {
 	impl();
 	impl(const impl& other) = delete;
@@ -141,7 +291,7 @@ struct line_config::impl
 	line_config_ptr config;
 };
 
-struct request_config::impl
+struct request_config::impl : public resource_allocated
 {
 	impl();
 	impl(const impl& other) = delete;
@@ -152,84 +302,214 @@ struct request_config::impl
 	request_config_ptr config;
 };
 
-struct line_request::impl
+struct request_template::impl
 {
-	impl() = default;
+	impl(const line_config& line_cfg, const request_config* req_cfg);
 	impl(const impl& other) = delete;
 	impl(impl&& other) = delete;
 	impl& operator=(const impl& other) = delete;
 	impl& operator=(impl&& other) = delete;
 
-	void throw_if_released() const;
-	void set_request_ptr(line_request_ptr& ptr);
-	void fill_offset_buf(const line::offsets& offsets);
+	request_template_ptr tmpl;
+};
 
-	line_request_ptr request;
+struct line_request::impl
+{
+	impl();
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
 
 	/*
 	 * Used when reading/setting the line values in order to avoid
 	 * allocating a new buffer on every call. We're not doing it for
 	 * offsets in the line & request config structures because they don't
 	 * require high performance unlike the set/get value calls.
+	 *
+	 * The buffers live on the stack of the caller and not in the request
+	 * so that threads sharing the request don't overwrite each other's.
 	 */
-	::std::vector<unsigned int> offset_buf;
+	struct value_bufs
+	{
+		/* Maximum number of lines in a single request. */
+		static constexpr ::std::size_t max_lines = 64;
+
+		unsigned int offsets[max_lines];
+		::gpiod_line_value values[max_lines];
+	};
+
+	void throw_if_released() const;
+	void set_request_ptr(line_request_ptr& ptr);
+	void fill_offset_buf(value_bufs& bufs, const line::offset* offsets,
+			     ::std::size_t num_offsets) const;
+	void fill_offset_buf(value_bufs& bufs, const line::offsets& offsets) const;
+	void fill_bufs(value_bufs& bufs, const line::value_mappings& values) const;
+
+	line_request_ptr request;
+	::std::size_t num_lines;
 };
 
-struct edge_event::impl
+struct line_request::transaction::impl
 {
-	impl() = default;
+	explicit impl(line_request::impl& request);
 	impl(const impl& other) = delete;
 	impl(impl&& other) = delete;
-	virtual ~impl() = default;
 	impl& operator=(const impl& other) = delete;
 	impl& operator=(impl&& other) = delete;
 
-	virtual ::gpiod_edge_event* get_event_ptr() const noexcept = 0;
-	virtual ::std::shared_ptr<impl> copy(const ::std::shared_ptr<impl>& self) const = 0;
+	void set_values(const line_request::impl::value_bufs& bufs, ::std::size_t num_values);
+
+	line_request::impl& request;
+	line_transaction_ptr tx;
 };
 
-struct edge_event::impl_managed : public edge_event::impl
+struct line_subset::impl
 {
-	impl_managed() = default;
-	impl_managed(const impl_managed& other) = delete;
-	impl_managed(impl_managed&& other) = delete;
-	virtual ~impl_managed() = default;
-	impl_managed& operator=(const impl_managed& other) = delete;
-	impl_managed& operator=(impl_managed&& other) = delete;
-
-	::gpiod_edge_event* get_event_ptr() const noexcept override;
-	::std::shared_ptr<impl> copy(const ::std::shared_ptr<impl>& self) const override;
+	impl() = default;
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
 
-	edge_event_ptr event;
+	line_subset_ptr subset;
+	line::offsets offsets;
 };
 
-struct edge_event::impl_external : public edge_event::impl
+struct wait_cancel::impl
 {
-	impl_external();
-	impl_external(const impl_external& other) = delete;
-	impl_external(impl_external&& other) = delete;
-	virtual ~impl_external() = default;
-	impl_external& operator=(const impl_external& other) = delete;
-	impl_external& operator=(impl_external&& other) = delete;
-
-	::gpiod_edge_event* get_event_ptr() const noexcept override;
-	::std::shared_ptr<impl> copy(const ::std::shared_ptr<impl>& self) const override;
+	impl();
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
 
-	::gpiod_edge_event *event;
+	wait_cancel_ptr cancel;
 };
 
 struct edge_event_buffer::impl
 {
-	impl(unsigned int capacity);
+	impl(unsigned int capacity, ::std::size_t max_events);
 	impl(const impl& other) = delete;
 	impl(impl&& other) = delete;
 	impl& operator=(const impl& other) = delete;
 	impl& operator=(impl&& other) = delete;
 
 	int read_events(const line_request_ptr& request, unsigned int max_events);
+	::std::size_t read_chunk(const line_request_ptr& request, ::std::size_t max_events);
+	void reload_events();
+	static void decode_event(edge_event& dst, ::gpiod_edge_event* src);
 
 	edge_event_buffer_ptr buffer;
 	::std::vector<edge_event> events;
+	/* Zero for fixed buffers. */
+	::std::size_t max_events;
+	::std::size_t num_events;
+	/* Records of all chunks of the last read, only used by growable buffers. */
+	::std::vector<edge_event_record> records;
+};
+
+struct pulse_decoder::impl
+{
+	impl() = default;
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	pulse_decoder_ptr decoder;
+};
+
+struct capture_reader::impl
+{
+	impl(const ::std::filesystem::path& path);
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	capture_reader_ptr reader;
+};
+
+struct edge_event_pipeline::impl
+{
+	struct stage
+	{
+		impl* parent;
+		stage_callback callback;
+	};
+
+	impl();
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	static ::std::size_t run_stage(::gpiod_edge_event_record* records,
+				       ::std::size_t num_events, void* data);
+
+	edge_event_pipeline_ptr pipeline;
+	/* Needs stable addresses as they're passed to the C callbacks. */
+	::std::list<stage> stages;
+	::std::exception_ptr error;
+};
+
+struct event_dispatcher::impl
+{
+	struct source
+	{
+		source(impl* parent, line_request&& request);
+		source(const source& other) = delete;
+		source(source&& other) = delete;
+		source& operator=(const source& other) = delete;
+		source& operator=(source&& other) = delete;
+
+		impl* parent;
+		line_request request;
+		/* Indexed by line offset, empty slots fall back to the default. */
+		::std::vector<edge_handler> handlers;
+		line::offsets offsets;
+	};
+
+	impl(::std::size_t event_buffer_size);
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	void throw_if_running() const;
+	::std::size_t dispatch(::std::int64_t timeout_ns);
+	void run() noexcept;
+
+	static int on_edge_events(::gpiod_line_request* request,
+				  ::gpiod_edge_event_buffer* buffer,
+				  ::std::size_t num_events, void* data);
+
+	::std::vector<::std::unique_ptr<source>> sources;
+	edge_handler default_handler;
+	/* Destroyed before the sources, the loop doesn't own the requests. */
+	event_loop_ptr loop;
+	wait_cancel_ptr cancel;
+	::std::thread thread;
+	::std::exception_ptr error;
+	::std::size_t num_dispatched;
+};
+
+struct multi_request::impl
+{
+	impl();
+	impl(const impl& other) = delete;
+	impl(impl&& other) = delete;
+	impl& operator=(const impl& other) = delete;
+	impl& operator=(impl&& other) = delete;
+
+	::std::size_t add_request(line_request&& request, ::gpiod_chip* chip);
+
+	/* Outlive the C object so that its workers stop first. */
+	::std::vector<line_request> requests;
+	multi_request_ptr mreq;
+	/* Reused by all snapshots, dropped when a member is added. */
+	multi_request_snapshot_ptr snapshot;
 };
 
 } /* namespace gpiod */
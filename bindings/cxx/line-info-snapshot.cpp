@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+void line_info_snapshot::impl::set_snapshot_ptr(line_info_snapshot_ptr& new_snapshot)
+{
+	::std::size_t num_lines = ::gpiod_line_info_snapshot_get_num_lines(new_snapshot.get());
+
+	this->lines.clear();
+	this->lines.reserve(num_lines);
+
+	for (::std::size_t i = 0; i < num_lines; i++)
+		this->lines.push_back(line_info_view(
+			::gpiod_line_info_snapshot_get_line_info(new_snapshot.get(), i)));
+
+	this->snapshot = ::std::move(new_snapshot);
+}
+
+line_info_snapshot::line_info_snapshot()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API line_info_snapshot::line_info_snapshot(line_info_snapshot&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API line_info_snapshot::~line_info_snapshot()
+{
+
+}
+
+GPIOD_CXX_API line_info_snapshot&
+line_info_snapshot::operator=(line_info_snapshot&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t line_info_snapshot::num_lines() const noexcept
+{
+	return this->_m_priv->lines.size();
+}
+
+GPIOD_CXX_API const line_info_view&
+line_info_snapshot::get_line_info(line::offset offset) const
+{
+	return this->_m_priv->lines.at(offset);
+}
+
+GPIOD_CXX_API ::std::size_t line_info_snapshot::size() const noexcept
+{
+	return ::gpiod_line_info_snapshot_get_size(this->_m_priv->snapshot.get());
+}
+
+GPIOD_CXX_API line_info_snapshot::const_iterator line_info_snapshot::begin() const noexcept
+{
+	return this->_m_priv->lines.begin();
+}
+
+GPIOD_CXX_API line_info_snapshot::const_iterator line_info_snapshot::end() const noexcept
+{
+	return this->_m_priv->lines.end();
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const line_info_snapshot& snapshot)
+{
+	out << "gpiod::line_info_snapshot(num_lines=" << snapshot.num_lines() <<
+	       ", size=" << snapshot.size() <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
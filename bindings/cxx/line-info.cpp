@@ -1,7 +1,6 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2021-2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
-#include <map>
 #include <ostream>
 #include <utility>
 
@@ -11,37 +10,42 @@ namespace gpiod {
 
 namespace {
 
-const ::std::map<int, line::direction> direction_mapping = {
+constexpr enum_mapping<int, line::direction> direction_mapping = {
 	{ GPIOD_LINE_DIRECTION_INPUT,		line::direction::INPUT },
 	{ GPIOD_LINE_DIRECTION_OUTPUT,		line::direction::OUTPUT },
 };
 
-const ::std::map<int, line::bias> bias_mapping = {
+constexpr enum_mapping<int, line::bias> bias_mapping = {
 	{ GPIOD_LINE_BIAS_UNKNOWN,		line::bias::UNKNOWN },
 	{ GPIOD_LINE_BIAS_DISABLED,		line::bias::DISABLED },
 	{ GPIOD_LINE_BIAS_PULL_UP,		line::bias::PULL_UP },
 	{ GPIOD_LINE_BIAS_PULL_DOWN,		line::bias::PULL_DOWN },
 };
 
-const ::std::map<int, line::drive> drive_mapping = {
+constexpr enum_mapping<int, line::drive> drive_mapping = {
 	{ GPIOD_LINE_DRIVE_PUSH_PULL,		line::drive::PUSH_PULL },
 	{ GPIOD_LINE_DRIVE_OPEN_DRAIN,		line::drive::OPEN_DRAIN },
 	{ GPIOD_LINE_DRIVE_OPEN_SOURCE,		line::drive::OPEN_SOURCE },
 };
 
-const ::std::map<int, line::edge> edge_mapping = {
+constexpr enum_mapping<int, line::edge> edge_mapping = {
 	{ GPIOD_LINE_EDGE_NONE,			line::edge::NONE },
 	{ GPIOD_LINE_EDGE_RISING,		line::edge::RISING },
 	{ GPIOD_LINE_EDGE_FALLING,		line::edge::FALLING },
 	{ GPIOD_LINE_EDGE_BOTH,			line::edge::BOTH },
 };
 
-const ::std::map<int, line::clock> clock_mapping = {
+constexpr enum_mapping<int, line::clock> clock_mapping = {
 	{ GPIOD_LINE_CLOCK_MONOTONIC,		line::clock::MONOTONIC },
 	{ GPIOD_LINE_CLOCK_REALTIME,		line::clock::REALTIME },
 	{ GPIOD_LINE_CLOCK_HTE,			line::clock::HTE },
 };
 
+::gpiod_line_info* view_info(const void* info) noexcept
+{
+	return static_cast<::gpiod_line_info*>(const_cast<void*>(info));
+}
+
 } /* namespace */
 
 void line_info::impl::set_info_ptr(line_info_ptr& new_info)
@@ -161,6 +165,87 @@ GPIOD_CXX_API ::std::chrono::microseconds line_info::debounce_period() const  no
 			::gpiod_line_info_get_debounce_period_us(this->_m_priv->info.get()));
 }
 
+line_info_view::line_info_view(const void* info) noexcept
+	: _m_info(info)
+{
+
+}
+
+GPIOD_CXX_API line::offset line_info_view::offset() const noexcept
+{
+	return ::gpiod_line_info_get_offset(view_info(this->_m_info));
+}
+
+GPIOD_CXX_API ::std::string_view line_info_view::name() const noexcept
+{
+	const char* name = ::gpiod_line_info_get_name(view_info(this->_m_info));
+
+	return name ?: "";
+}
+
+GPIOD_CXX_API bool line_info_view::used() const noexcept
+{
+	return ::gpiod_line_info_is_used(view_info(this->_m_info));
+}
+
+GPIOD_CXX_API ::std::string_view line_info_view::consumer() const noexcept
+{
+	const char* consumer = ::gpiod_line_info_get_consumer(view_info(this->_m_info));
+
+	return consumer ?: "";
+}
+
+GPIOD_CXX_API line::direction line_info_view::direction() const
+{
+	int direction = ::gpiod_line_info_get_direction(view_info(this->_m_info));
+
+	return get_mapped_value(direction, direction_mapping);
+}
+
+GPIOD_CXX_API bool line_info_view::active_low() const noexcept
+{
+	return ::gpiod_line_info_is_active_low(view_info(this->_m_info));
+}
+
+GPIOD_CXX_API line::bias line_info_view::bias() const
+{
+	int bias = ::gpiod_line_info_get_bias(view_info(this->_m_info));
+
+	return bias_mapping.at(bias);
+}
+
+GPIOD_CXX_API line::drive line_info_view::drive() const
+{
+	int drive = ::gpiod_line_info_get_drive(view_info(this->_m_info));
+
+	return drive_mapping.at(drive);
+}
+
+GPIOD_CXX_API line::edge line_info_view::edge_detection() const
+{
+	int edge = ::gpiod_line_info_get_edge_detection(view_info(this->_m_info));
+
+	return edge_mapping.at(edge);
+}
+
+GPIOD_CXX_API line::clock line_info_view::event_clock() const
+{
+	int clock = ::gpiod_line_info_get_event_clock(view_info(this->_m_info));
+
+	return clock_mapping.at(clock);
+}
+
+GPIOD_CXX_API bool line_info_view::debounced() const noexcept
+{
+	return ::gpiod_line_info_is_debounced(view_info(this->_m_info));
+}
+
+GPIOD_CXX_API ::std::chrono::microseconds line_info_view::debounce_period() const noexcept
+{
+	return ::std::chrono::microseconds(
+			::gpiod_line_info_get_debounce_period_us(view_info(this->_m_info)));
+}
+
 GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const line_info& info)
 {
 	::std::string name, consumer;
@@ -188,4 +273,36 @@ GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const line_info& i
 	return out;
 }
 
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const line_info_view& info)
+{
+	out << "gpiod::line_info_view(offset=" << info.offset() << ", name=";
+
+	if (info.name().empty())
+		out << "unnamed";
+	else
+		out << "'" << info.name() << "'";
+
+	out << ", used=" << ::std::boolalpha << info.used() << ", consumer=";
+
+	if (info.consumer().empty())
+		out << "unused";
+	else
+		out << "'" << info.consumer() << "'";
+
+	out << ", direction=" << info.direction() <<
+	       ", active_low=" << ::std::boolalpha << info.active_low() <<
+	       ", bias=" << info.bias() <<
+	       ", drive=" << info.drive() <<
+	       ", edge_detection=" << info.edge_detection() <<
+	       ", event_clock=" << info.event_clock() <<
+	       ", debounced=" << ::std::boolalpha << info.debounced();
+
+	if (info.debounced())
+		out << ", debounce_period=" << info.debounce_period().count() << "us";
+
+	out << ")";
+
+	return out;
+}
+
 } /* namespace gpiod */
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2021-2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <cerrno>
 #include <iterator>
 #include <ostream>
 #include <utility>
@@ -9,6 +10,13 @@
 
 namespace gpiod {
 
+line_request::impl::impl()
+	: request(),
+	  num_lines(0)
+{
+
+}
+
 void line_request::impl::throw_if_released() const
 {
 	if (!this->request)
@@ -18,13 +26,33 @@ void line_request::impl::throw_if_released() const
 void line_request::impl::set_request_ptr(line_request_ptr& ptr)
 {
 	this->request = ::std::move(ptr);
-	this->offset_buf.resize(::gpiod_line_request_get_num_requested_lines(this->request.get()));
+	this->num_lines = ::gpiod_line_request_get_num_requested_lines(this->request.get());
+}
+
+void line_request::impl::fill_offset_buf(value_bufs& bufs, const line::offset* offsets,
+					 ::std::size_t num_offsets) const
+{
+	if (num_offsets > this->num_lines)
+		throw ::std::invalid_argument("more offsets than requested lines");
+
+	for (::std::size_t i = 0; i < num_offsets; i++)
+		bufs.offsets[i] = offsets[i];
 }
 
-void line_request::impl::fill_offset_buf(const line::offsets& offsets)
+void line_request::impl::fill_offset_buf(value_bufs& bufs, const line::offsets& offsets) const
 {
-	for (unsigned int i = 0; i < offsets.size(); i++)
-		this->offset_buf[i] = offsets[i];
+	this->fill_offset_buf(bufs, offsets.data(), offsets.size());
+}
+
+void line_request::impl::fill_bufs(value_bufs& bufs, const line::value_mappings& values) const
+{
+	if (values.size() > this->num_lines)
+		throw ::std::invalid_argument("more offsets than requested lines");
+
+	for (::std::size_t i = 0; i < values.size(); i++) {
+		bufs.offsets[i] = values[i].first;
+		bufs.values[i] = static_cast<::gpiod_line_value>(values[i].second);
+	}
 }
 
 line_request::line_request()
@@ -86,9 +114,26 @@ GPIOD_CXX_API line::offsets line_request::offsets() const
 	return offsets;
 }
 
+GPIOD_CXX_API ::std::size_t line_request::offset_bit(line::offset offset) const
+{
+	this->_m_priv->throw_if_released();
+
+	int bit = ::gpiod_line_request_get_offset_bit(this->_m_priv->request.get(), offset);
+	if (bit < 0)
+		throw ::std::invalid_argument("line was not requested");
+
+	return bit;
+}
+
 GPIOD_CXX_API line::value line_request::get_value(line::offset offset)
 {
-	return this->get_values({ offset }).front();
+	this->_m_priv->throw_if_released();
+
+	int ret = ::gpiod_line_request_get_value(this->_m_priv->request.get(), offset);
+	if (ret < 0)
+		throw_from_errno("unable to retrieve line value");
+
+	return static_cast<line::value>(ret);
 }
 
 GPIOD_CXX_API line::values
@@ -103,65 +148,104 @@ line_request::get_values(const line::offsets& offsets)
 
 GPIOD_CXX_API line::values line_request::get_values()
 {
-	return this->get_values(this->offsets());
+	line::values vals(this->num_lines());
+
+	this->get_values(vals);
+
+	return vals;
 }
 
 GPIOD_CXX_API void line_request::get_values(const line::offsets& offsets, line::values& values)
 {
-	this->_m_priv->throw_if_released();
-
 	if (offsets.size() != values.size())
 		throw ::std::invalid_argument("values must have the same size as the offsets");
 
-	this->_m_priv->fill_offset_buf(offsets);
+	this->get_values(offsets.data(), values.data(), offsets.size());
+}
+
+GPIOD_CXX_API void line_request::get_values(const line::offset* offsets, line::value* values,
+					    ::std::size_t num_values)
+{
+	this->_m_priv->throw_if_released();
+
+	impl::value_bufs bufs;
+
+	this->_m_priv->fill_offset_buf(bufs, offsets, num_values);
 
 	int ret = ::gpiod_line_request_get_values_subset(
 					this->_m_priv->request.get(),
-					offsets.size(), this->_m_priv->offset_buf.data(),
-					reinterpret_cast<::gpiod_line_value*>(values.data()));
+					num_values, bufs.offsets,
+					reinterpret_cast<::gpiod_line_value*>(values));
 	if (ret)
 		throw_from_errno("unable to retrieve line values");
 }
 
 GPIOD_CXX_API void line_request::get_values(line::values& values)
 {
-	this->get_values(this->offsets(), values);
+	if (values.size() != this->num_lines())
+		throw ::std::invalid_argument("values must have the same size as the offsets");
+
+	int ret = ::gpiod_line_request_get_values(
+					this->_m_priv->request.get(),
+					reinterpret_cast<::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to retrieve line values");
 }
 
 GPIOD_CXX_API line_request&
 line_request::line_request::set_value(line::offset offset, line::value value)
 {
-	return this->set_values({ offset }, { value });
+	this->_m_priv->throw_if_released();
+
+	int ret = ::gpiod_line_request_set_value(this->_m_priv->request.get(), offset,
+						 static_cast<::gpiod_line_value>(value));
+	if (ret)
+		throw_from_errno("unable to set line value");
+
+	return *this;
 }
 
 GPIOD_CXX_API line_request&
 line_request::set_values(const line::value_mappings& values)
 {
-	line::offsets offsets(values.size());
-	line::values vals(values.size());
+	this->_m_priv->throw_if_released();
 
-	for (unsigned int i = 0; i < values.size(); i++) {
-		offsets[i] = values[i].first;
-		vals[i] = values[i].second;
-	}
+	impl::value_bufs bufs;
 
-	return this->set_values(offsets, vals);
+	this->_m_priv->fill_bufs(bufs, values);
+
+	int ret = ::gpiod_line_request_set_values_subset(
+					this->_m_priv->request.get(),
+					values.size(), bufs.offsets, bufs.values);
+	if (ret)
+		throw_from_errno("unable to set line values");
+
+	return *this;
 }
 
 GPIOD_CXX_API line_request& line_request::set_values(const line::offsets& offsets,
 					    const line::values& values)
 {
-	this->_m_priv->throw_if_released();
-
 	if (offsets.size() != values.size())
 		throw ::std::invalid_argument("values must have the same size as the offsets");
 
-	this->_m_priv->fill_offset_buf(offsets);
+	return this->set_values(offsets.data(), values.data(), offsets.size());
+}
+
+GPIOD_CXX_API line_request& line_request::set_values(const line::offset* offsets,
+						     const line::value* values,
+						     ::std::size_t num_values)
+{
+	this->_m_priv->throw_if_released();
+
+	impl::value_bufs bufs;
+
+	this->_m_priv->fill_offset_buf(bufs, offsets, num_values);
 
 	int ret = ::gpiod_line_request_set_values_subset(
 					this->_m_priv->request.get(),
-					offsets.size(), this->_m_priv->offset_buf.data(),
-					reinterpret_cast<const ::gpiod_line_value*>(values.data()));
+					num_values, bufs.offsets,
+					reinterpret_cast<const ::gpiod_line_value*>(values));
 	if (ret)
 		throw_from_errno("unable to set line values");
 
@@ -170,7 +254,69 @@ GPIOD_CXX_API line_request& line_request::set_values(const line::offsets& offset
 
 GPIOD_CXX_API line_request& line_request::set_values(const line::values& values)
 {
-	return this->set_values(this->offsets(), values);
+	if (values.size() != this->num_lines())
+		throw ::std::invalid_argument("values must have the same size as the offsets");
+
+	int ret = ::gpiod_line_request_set_values(
+					this->_m_priv->request.get(),
+					reinterpret_cast<const ::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to set line values");
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::uint64_t line_request::get_values_mask(::std::uint64_t mask)
+{
+	::std::uint64_t values;
+
+	this->_m_priv->throw_if_released();
+
+	int ret = ::gpiod_line_request_get_values_mask(this->_m_priv->request.get(),
+						       mask, &values);
+	if (ret)
+		throw_from_errno("unable to retrieve line values");
+
+	return values;
+}
+
+GPIOD_CXX_API line_request&
+line_request::set_values_mask(::std::uint64_t mask, ::std::uint64_t values)
+{
+	this->_m_priv->throw_if_released();
+
+	int ret = ::gpiod_line_request_set_values_mask(this->_m_priv->request.get(),
+						       mask, values);
+	if (ret)
+		throw_from_errno("unable to set line values");
+
+	return *this;
+}
+
+GPIOD_CXX_API line_subset line_request::prepare_subset(const line::offsets& offsets)
+{
+	this->_m_priv->throw_if_released();
+
+	if (offsets.size() > this->_m_priv->num_lines)
+		throw ::std::invalid_argument("too many offsets for the line subset");
+
+	impl::value_bufs bufs;
+
+	this->_m_priv->fill_offset_buf(bufs, offsets);
+
+	line_subset_ptr subset(::gpiod_line_request_prepare_subset(
+					this->_m_priv->request.get(),
+					offsets.size(),
+					bufs.offsets));
+	if (!subset)
+		throw_from_errno("unable to prepare the line subset");
+
+	line_subset ret;
+
+	ret._m_priv->subset = ::std::move(subset);
+	ret._m_priv->offsets = offsets;
+
+	return ret;
 }
 
 GPIOD_CXX_API line_request& line_request::reconfigure_lines(const line_config& config)
@@ -185,6 +331,18 @@ GPIOD_CXX_API line_request& line_request::reconfigure_lines(const line_config& c
 	return *this;
 }
 
+GPIOD_CXX_API line_request& line_request::reconfigure_lines_partial(const line_config& config)
+{
+	this->_m_priv->throw_if_released();
+
+	int ret = ::gpiod_line_request_reconfigure_lines_partial(this->_m_priv->request.get(),
+								 config._m_priv->config.get());
+	if (ret)
+		throw_from_errno("unable to reconfigure GPIO lines");
+
+	return *this;
+}
+
 GPIOD_CXX_API int line_request::fd() const
 {
 	this->_m_priv->throw_if_released();
@@ -192,6 +350,28 @@ GPIOD_CXX_API int line_request::fd() const
 	return ::gpiod_line_request_get_fd(this->_m_priv->request.get());
 }
 
+GPIOD_CXX_API stats line_request::get_stats() const
+{
+	this->_m_priv->throw_if_released();
+
+	stats_ptr stats_snapshot(::gpiod_line_request_get_stats(this->_m_priv->request.get()));
+	if (!stats_snapshot)
+		throw_from_errno("failed to retrieve line request statistics");
+
+	stats ret;
+
+	ret._m_priv->set_stats_ptr(stats_snapshot);
+
+	return ret;
+}
+
+GPIOD_CXX_API void line_request::reset_stats()
+{
+	this->_m_priv->throw_if_released();
+
+	::gpiod_line_request_reset_stats(this->_m_priv->request.get());
+}
+
 GPIOD_CXX_API bool line_request::wait_edge_events(const ::std::chrono::nanoseconds& timeout) const
 {
 	this->_m_priv->throw_if_released();
@@ -204,6 +384,52 @@ GPIOD_CXX_API bool line_request::wait_edge_events(const ::std::chrono::nanosecon
 	return ret;
 }
 
+GPIOD_CXX_API bool line_request::wait_edge_events(const ::std::chrono::nanoseconds& timeout,
+						  const wait_cancel& cancel) const
+{
+	this->_m_priv->throw_if_released();
+
+	int ret = ::gpiod_line_request_wait_edge_events_cancellable(
+					this->_m_priv->request.get(),
+					timeout.count(),
+					cancel._m_priv->cancel.get());
+	if (ret < 0) {
+		if (errno == ECANCELED)
+			return false;
+
+		throw_from_errno("error waiting for edge events");
+	}
+
+	return ret;
+}
+
+GPIOD_CXX_API bool line_request::wait_for_value(line::offset offset, line::value value,
+						const ::std::chrono::nanoseconds& timeout)
+{
+	return this->wait_for_values({ { offset, value } }, match::ALL, timeout);
+}
+
+GPIOD_CXX_API bool line_request::wait_for_values(const line::value_mappings& values,
+						 match how,
+						 const ::std::chrono::nanoseconds& timeout)
+{
+	this->_m_priv->throw_if_released();
+
+	impl::value_bufs bufs;
+
+	this->_m_priv->fill_bufs(bufs, values);
+
+	int ret = ::gpiod_line_request_wait_for_values_subset(
+					this->_m_priv->request.get(),
+					values.size(), bufs.offsets, bufs.values,
+					static_cast<::gpiod_line_match>(how),
+					timeout.count());
+	if (ret < 0)
+		throw_from_errno("error waiting for line values");
+
+	return ret;
+}
+
 GPIOD_CXX_API ::std::size_t line_request::read_edge_events(edge_event_buffer& buffer)
 {
 	return this->read_edge_events(buffer, buffer.capacity());
@@ -1,7 +1,6 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
-#include <map>
 #include <ostream>
 
 #include "internal.hpp"
@@ -10,72 +9,60 @@ namespace gpiod {
 
 namespace {
 
-template<class cxx_enum_type, class c_enum_type>
-::std::map<c_enum_type, cxx_enum_type>
-make_reverse_maping(const ::std::map<cxx_enum_type, c_enum_type>& mapping)
-{
-	::std::map<c_enum_type, cxx_enum_type> ret;
-
-	for (const auto &item: mapping)
-		ret[item.second] = item.first;
-
-	return ret;
-}
-
-const ::std::map<line::direction, ::gpiod_line_direction> direction_mapping = {
+constexpr enum_mapping<line::direction, ::gpiod_line_direction> direction_mapping = {
 	{ line::direction::AS_IS,	GPIOD_LINE_DIRECTION_AS_IS },
 	{ line::direction::INPUT,	GPIOD_LINE_DIRECTION_INPUT },
 	{ line::direction::OUTPUT,	GPIOD_LINE_DIRECTION_OUTPUT },
 };
 
-const ::std::map<::gpiod_line_direction, line::direction>
-reverse_direction_mapping = make_reverse_maping(direction_mapping);
+constexpr enum_mapping<::gpiod_line_direction, line::direction>
+reverse_direction_mapping = direction_mapping.reverse();
 
-const ::std::map<line::edge, ::gpiod_line_edge> edge_mapping = {
+constexpr enum_mapping<line::edge, ::gpiod_line_edge> edge_mapping = {
 	{ line::edge::NONE,		GPIOD_LINE_EDGE_NONE },
 	{ line::edge::FALLING,		GPIOD_LINE_EDGE_FALLING },
 	{ line::edge::RISING,		GPIOD_LINE_EDGE_RISING },
 	{ line::edge::BOTH,		GPIOD_LINE_EDGE_BOTH },
 };
 
-const ::std::map<::gpiod_line_edge, line::edge>
-reverse_edge_mapping = make_reverse_maping(edge_mapping);
+constexpr enum_mapping<::gpiod_line_edge, line::edge>
+reverse_edge_mapping = edge_mapping.reverse();
 
-const ::std::map<line::bias, ::gpiod_line_bias> bias_mapping = {
+constexpr enum_mapping<line::bias, ::gpiod_line_bias> bias_mapping = {
 	{ line::bias::AS_IS,		GPIOD_LINE_BIAS_AS_IS },
 	{ line::bias::DISABLED,		GPIOD_LINE_BIAS_DISABLED },
 	{ line::bias::PULL_UP,		GPIOD_LINE_BIAS_PULL_UP },
 	{ line::bias::PULL_DOWN,	GPIOD_LINE_BIAS_PULL_DOWN },
 };
 
-const ::std::map<::gpiod_line_bias, line::bias>
-reverse_bias_mapping = make_reverse_maping(bias_mapping);
+constexpr enum_mapping<::gpiod_line_bias, line::bias>
+reverse_bias_mapping = bias_mapping.reverse();
 
-const ::std::map<line::drive, ::gpiod_line_drive> drive_mapping = {
+constexpr enum_mapping<line::drive, ::gpiod_line_drive> drive_mapping = {
 	{ line::drive::PUSH_PULL,	GPIOD_LINE_DRIVE_PUSH_PULL },
 	{ line::drive::OPEN_DRAIN,	GPIOD_LINE_DRIVE_OPEN_DRAIN },
 	{ line::drive::OPEN_SOURCE,	GPIOD_LINE_DRIVE_OPEN_SOURCE },
 };
 
-const ::std::map<::gpiod_line_drive, line::drive>
-reverse_drive_mapping = make_reverse_maping(drive_mapping);
+constexpr enum_mapping<::gpiod_line_drive, line::drive>
+reverse_drive_mapping = drive_mapping.reverse();
 
-const ::std::map<line::clock, ::gpiod_line_clock> clock_mapping = {
+constexpr enum_mapping<line::clock, ::gpiod_line_clock> clock_mapping = {
 	{ line::clock::MONOTONIC,	GPIOD_LINE_CLOCK_MONOTONIC },
 	{ line::clock::REALTIME,	GPIOD_LINE_CLOCK_REALTIME },
 	{ line::clock::HTE,		GPIOD_LINE_CLOCK_HTE },
 };
 
-const ::std::map<::gpiod_line_clock, line::clock>
-reverse_clock_mapping = make_reverse_maping(clock_mapping);
+constexpr enum_mapping<::gpiod_line_clock, line::clock>
+reverse_clock_mapping = clock_mapping.reverse();
 
-const ::std::map<line::value, ::gpiod_line_value> value_mapping = {
+constexpr enum_mapping<line::value, ::gpiod_line_value> value_mapping = {
 	{ line::value::INACTIVE,	GPIOD_LINE_VALUE_INACTIVE },
 	{ line::value::ACTIVE,		GPIOD_LINE_VALUE_ACTIVE },
 };
 
-const ::std::map<::gpiod_line_value, line::value>
-reverse_value_mapping = make_reverse_maping(value_mapping);
+constexpr enum_mapping<::gpiod_line_value, line::value>
+reverse_value_mapping = value_mapping.reverse();
 
 line_settings_ptr make_line_settings()
 {
@@ -96,7 +83,7 @@ line_settings_ptr copy_line_settings(const line_settings_ptr& ptr)
 }
 
 template<class cxx_enum_type, class c_enum_type>
-c_enum_type do_map_value(cxx_enum_type value, const ::std::map<cxx_enum_type, c_enum_type>& mapping)
+c_enum_type do_map_value(cxx_enum_type value, const enum_mapping<cxx_enum_type, c_enum_type>& mapping)
 try {
 	return get_mapped_value(value, mapping);
 } catch (const bad_mapping& ex) {
@@ -105,7 +92,7 @@ try {
 
 template<class cxx_enum_type, class c_enum_type, int set_func(::gpiod_line_settings*, c_enum_type)>
 void set_mapped_prop(::gpiod_line_settings* settings, cxx_enum_type value,
-		     const ::std::map<cxx_enum_type, c_enum_type>& mapping)
+		     const enum_mapping<cxx_enum_type, c_enum_type>& mapping)
 {
 	c_enum_type mapped_val = do_map_value(value, mapping);
 
@@ -116,7 +103,7 @@ void set_mapped_prop(::gpiod_line_settings* settings, cxx_enum_type value,
 
 template<class cxx_enum_type, class c_enum_type, c_enum_type get_func(::gpiod_line_settings*)>
 cxx_enum_type get_mapped_prop(::gpiod_line_settings* settings,
-			      const ::std::map<c_enum_type, cxx_enum_type>& mapping)
+			      const enum_mapping<c_enum_type, cxx_enum_type>& mapping)
 {
 	auto mapped_val = get_func(settings);
 
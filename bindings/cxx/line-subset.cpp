@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+line_subset::line_subset()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API line_subset::line_subset(line_subset&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API line_subset::~line_subset()
+{
+
+}
+
+GPIOD_CXX_API line_subset& line_subset::operator=(line_subset&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t line_subset::num_lines() const noexcept
+{
+	return this->_m_priv->offsets.size();
+}
+
+GPIOD_CXX_API const line::offsets& line_subset::offsets() const noexcept
+{
+	return this->_m_priv->offsets;
+}
+
+GPIOD_CXX_API ::std::uint64_t line_subset::mask() const noexcept
+{
+	return ::gpiod_line_subset_get_mask(this->_m_priv->subset.get());
+}
+
+GPIOD_CXX_API line::values line_subset::get_values()
+{
+	line::values vals(this->num_lines());
+
+	this->get_values(vals);
+
+	return vals;
+}
+
+GPIOD_CXX_API void line_subset::get_values(line::values& values)
+{
+	if (values.size() != this->num_lines())
+		throw ::std::invalid_argument("values must have the same size as the subset");
+
+	int ret = ::gpiod_line_subset_get_values(this->_m_priv->subset.get(),
+				reinterpret_cast<::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to retrieve line values");
+}
+
+GPIOD_CXX_API line_subset& line_subset::set_values(const line::values& values)
+{
+	if (values.size() != this->num_lines())
+		throw ::std::invalid_argument("values must have the same size as the subset");
+
+	int ret = ::gpiod_line_subset_set_values(this->_m_priv->subset.get(),
+				reinterpret_cast<const ::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to set line values");
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const line_subset& subset)
+{
+	out << "gpiod::line_subset(num_lines=" << subset.num_lines() <<
+	       ", line_offsets=" << subset.offsets() <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+line_request::transaction::impl::impl(line_request::impl& request)
+	: request(request),
+	  tx(::gpiod_line_request_begin_transaction(request.request.get()))
+{
+	if (!this->tx)
+		throw_from_errno("unable to start the transaction");
+}
+
+void line_request::transaction::impl::set_values(const line_request::impl::value_bufs& bufs,
+						 ::std::size_t num_values)
+{
+	int ret = ::gpiod_line_transaction_set_values_subset(this->tx.get(), num_values,
+							     bufs.offsets, bufs.values);
+	if (ret)
+		throw_from_errno("unable to stage line values");
+}
+
+GPIOD_CXX_API line_request::transaction::transaction(line_request& request)
+	: _m_priv()
+{
+	request._m_priv->throw_if_released();
+
+	this->_m_priv.reset(new impl(*request._m_priv));
+}
+
+GPIOD_CXX_API line_request::transaction::transaction(transaction&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API line_request::transaction::~transaction()
+{
+
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::operator=(transaction&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::set_value(line::offset offset, line::value value)
+{
+	int ret = ::gpiod_line_transaction_set_value(this->_m_priv->tx.get(), offset,
+						     static_cast<::gpiod_line_value>(value));
+	if (ret)
+		throw_from_errno("unable to stage line value");
+
+	return *this;
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::set_values(const line::value_mappings& values)
+{
+	line_request::impl::value_bufs bufs;
+
+	this->_m_priv->request.fill_bufs(bufs, values);
+	this->_m_priv->set_values(bufs, values.size());
+
+	return *this;
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::set_values(const line::offsets& offsets, const line::values& values)
+{
+	if (offsets.size() != values.size())
+		throw ::std::invalid_argument("values must have the same size as the offsets");
+
+	line_request::impl::value_bufs bufs;
+
+	this->_m_priv->request.fill_offset_buf(bufs, offsets);
+	for (::std::size_t i = 0; i < values.size(); i++)
+		bufs.values[i] = static_cast<::gpiod_line_value>(values[i]);
+
+	this->_m_priv->set_values(bufs, values.size());
+
+	return *this;
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::set_values_mask(::std::uint64_t mask, ::std::uint64_t values)
+{
+	int ret = ::gpiod_line_transaction_set_values_mask(this->_m_priv->tx.get(),
+							   mask, values);
+	if (ret)
+		throw_from_errno("unable to stage line values");
+
+	return *this;
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::set_bits(::std::uint64_t mask)
+{
+	return this->set_values_mask(mask, mask);
+}
+
+GPIOD_CXX_API line_request::transaction&
+line_request::transaction::clear_bits(::std::uint64_t mask)
+{
+	return this->set_values_mask(mask, 0);
+}
+
+GPIOD_CXX_API line_request::transaction& line_request::transaction::next_phase()
+{
+	int ret = ::gpiod_line_transaction_next_phase(this->_m_priv->tx.get());
+	if (ret)
+		throw_from_errno("unable to start a new phase");
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t line_request::transaction::num_phases() const
+{
+	return ::gpiod_line_transaction_get_num_phases(this->_m_priv->tx.get());
+}
+
+GPIOD_CXX_API void line_request::transaction::discard()
+{
+	::gpiod_line_transaction_discard(this->_m_priv->tx.get());
+}
+
+GPIOD_CXX_API void line_request::transaction::commit()
+{
+	this->_m_priv->request.throw_if_released();
+
+	int ret = ::gpiod_line_transaction_commit(this->_m_priv->tx.get());
+	if (ret)
+		throw_from_errno("unable to commit the transaction");
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out,
+					 const line_request::transaction& tx)
+{
+	out << "gpiod::line_request::transaction(num_phases=" << tx.num_phases() << ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
@@ -11,18 +11,18 @@ namespace line {
 
 namespace {
 
-const ::std::map<line::value, ::std::string> value_names = {
+constexpr enum_mapping<line::value, const char*> value_names = {
 	{ line::value::INACTIVE,	"INACTIVE" },
 	{ line::value::ACTIVE,		"ACTIVE" },
 };
 
-const ::std::map<line::direction, ::std::string> direction_names = {
+constexpr enum_mapping<line::direction, const char*> direction_names = {
 	{ line::direction::AS_IS,	"AS_IS" },
 	{ line::direction::INPUT,	"INPUT" },
 	{ line::direction::OUTPUT,	"OUTPUT" },
 };
 
-const ::std::map<line::bias, ::std::string> bias_names = {
+constexpr enum_mapping<line::bias, const char*> bias_names = {
 	{ line::bias::AS_IS,		"AS_IS" },
 	{ line::bias::UNKNOWN,		"UNKNOWN" },
 	{ line::bias::DISABLED,		"DISABLED" },
@@ -30,20 +30,20 @@ const ::std::map<line::bias, ::std::string> bias_names = {
 	{ line::bias::PULL_DOWN,	"PULL_DOWN" },
 };
 
-const ::std::map<line::drive, ::std::string> drive_names = {
+constexpr enum_mapping<line::drive, const char*> drive_names = {
 	{ line::drive::PUSH_PULL,	"PUSH_PULL" },
 	{ line::drive::OPEN_DRAIN,	"OPEN_DRAIN" },
 	{ line::drive::OPEN_SOURCE,	"OPEN_SOURCE" },
 };
 
-const ::std::map<line::edge, ::std::string> edge_names = {
+constexpr enum_mapping<line::edge, const char*> edge_names = {
 	{ line::edge::NONE,		"NONE" },
 	{ line::edge::RISING,		"RISING_EDGE" },
 	{ line::edge::FALLING,		"FALLING_EDGE" },
 	{ line::edge::BOTH,		"BOTH_EDGES" },
 };
 
-const ::std::map<line::clock, ::std::string> clock_names = {
+constexpr enum_mapping<line::clock, const char*> clock_names = {
 	{ line::clock::MONOTONIC,	"MONOTONIC" },
 	{ line::clock::REALTIME,	"REALTIME" },
 	{ line::clock::HTE,		"HTE" },
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+thread_local ::std::pmr::memory_resource* current_resource = nullptr;
+
+/*
+ * Neither the C release callback nor operator delete get the size of the
+ * block back, so it's stored in front of each block with its resource.
+ */
+struct block_header
+{
+	alignas(::std::max_align_t) ::std::pmr::memory_resource* resource;
+	::std::size_t size;
+};
+
+void* allocate_block(::std::pmr::memory_resource* resource, ::std::size_t size)
+{
+	auto hdr = static_cast<block_header*>(resource->allocate(size + sizeof(block_header),
+								 alignof(block_header)));
+
+	hdr->resource = resource;
+	hdr->size = size;
+
+	return hdr + 1;
+}
+
+void deallocate_block(void* ptr) noexcept
+{
+	auto hdr = static_cast<block_header*>(ptr) - 1;
+
+	hdr->resource->deallocate(hdr, hdr->size + sizeof(block_header),
+				  alignof(block_header));
+}
+
+void* resource_alloc(::std::size_t size, void* data)
+{
+	/* Exceptions must not propagate through the C library. */
+	try {
+		return allocate_block(static_cast<::std::pmr::memory_resource*>(data), size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void resource_free(void* ptr, void* data GPIOD_CXX_UNUSED)
+{
+	deallocate_block(ptr);
+}
+
+void set_resource(::std::pmr::memory_resource* resource) noexcept
+{
+	current_resource = resource;
+
+	if (resource)
+		::gpiod_set_thread_allocator(resource_alloc, resource_free, resource);
+	else
+		::gpiod_set_thread_allocator(nullptr, nullptr, nullptr);
+}
+
+} /* namespace */
+
+void* resource_allocated::operator new(::std::size_t size)
+{
+	return allocate_block(current_resource ?: ::std::pmr::new_delete_resource(), size);
+}
+
+void resource_allocated::operator delete(void* ptr) noexcept
+{
+	if (ptr)
+		deallocate_block(ptr);
+}
+
+GPIOD_CXX_API memory_resource_scope::memory_resource_scope(::std::pmr::memory_resource* resource) noexcept
+	: _m_prev(current_resource)
+{
+	set_resource(resource);
+}
+
+GPIOD_CXX_API memory_resource_scope::~memory_resource_scope()
+{
+	set_resource(this->_m_prev);
+}
+
+GPIOD_CXX_API ::std::pmr::memory_resource* memory_resource_scope::current() noexcept
+{
+	return current_resource;
+}
+
+} /* namespace gpiod */
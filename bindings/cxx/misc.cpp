@@ -17,4 +17,24 @@ GPIOD_CXX_API const ::std::string& api_version()
 	return version;
 }
 
+GPIOD_CXX_API void set_default_event_buffer_capacity(::std::size_t capacity) noexcept
+{
+	::gpiod_set_default_event_buffer_capacity(capacity);
+}
+
+GPIOD_CXX_API ::std::size_t default_event_buffer_capacity() noexcept
+{
+	return ::gpiod_get_default_event_buffer_capacity();
+}
+
+GPIOD_CXX_API void set_max_event_buffer_capacity(::std::size_t capacity) noexcept
+{
+	::gpiod_set_max_event_buffer_capacity(capacity);
+}
+
+GPIOD_CXX_API ::std::size_t max_event_buffer_capacity() noexcept
+{
+	return ::gpiod_get_max_event_buffer_capacity();
+}
+
 } /* namespace gpiod */
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+multi_request_ptr make_multi_request()
+{
+	multi_request_ptr mreq(::gpiod_multi_request_new());
+	if (!mreq)
+		throw_from_errno("unable to create the multi-chip request");
+
+	return mreq;
+}
+
+} /* namespace */
+
+multi_request::impl::impl()
+	: requests(),
+	  mreq(make_multi_request()),
+	  snapshot()
+{
+
+}
+
+::std::size_t multi_request::impl::add_request(line_request&& request, ::gpiod_chip* chip)
+{
+	request._m_priv->throw_if_released();
+
+	/* Make sure storing the request can't fail once the C object has it. */
+	this->requests.reserve(this->requests.size() + 1);
+
+	int ret = ::gpiod_multi_request_add_request(this->mreq.get(), chip,
+						    request._m_priv->request.get());
+	if (ret < 0)
+		throw_from_errno("unable to add the request");
+
+	this->requests.push_back(::std::move(request));
+	this->snapshot.reset();
+
+	return ret;
+}
+
+GPIOD_CXX_API multi_request::multi_request()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API multi_request::multi_request(multi_request&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API multi_request::~multi_request()
+{
+
+}
+
+GPIOD_CXX_API multi_request& multi_request::operator=(multi_request&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t multi_request::add_request(line_request&& request)
+{
+	return this->_m_priv->add_request(::std::move(request), nullptr);
+}
+
+GPIOD_CXX_API ::std::size_t multi_request::add_request(line_request&& request, chip& chip)
+{
+	chip._m_priv->throw_if_closed();
+
+	return this->_m_priv->add_request(::std::move(request), chip._m_priv->chip.get());
+}
+
+GPIOD_CXX_API line_request& multi_request::get_request(::std::size_t member)
+{
+	return this->_m_priv->requests.at(member);
+}
+
+GPIOD_CXX_API ::std::size_t multi_request::num_requests() const noexcept
+{
+	return this->_m_priv->requests.size();
+}
+
+GPIOD_CXX_API ::std::size_t multi_request::num_lines() const noexcept
+{
+	return ::gpiod_multi_request_get_num_lines(this->_m_priv->mreq.get());
+}
+
+GPIOD_CXX_API unsigned int multi_request::find_line(::std::size_t member,
+						    line::offset offset) const
+{
+	int ret = ::gpiod_multi_request_find_line(this->_m_priv->mreq.get(), member, offset);
+	if (ret < 0)
+		throw ::std::invalid_argument("line is not part of the request");
+
+	return ret;
+}
+
+GPIOD_CXX_API unsigned int multi_request::find_line(const ::std::string& name) const
+{
+	int ret = ::gpiod_multi_request_find_line_by_name(this->_m_priv->mreq.get(),
+							  name.c_str());
+	if (ret < 0)
+		throw_from_errno("unable to find the line");
+
+	return ret;
+}
+
+GPIOD_CXX_API line::values multi_request::get_values()
+{
+	line::values values(this->num_lines());
+
+	int ret = ::gpiod_multi_request_get_values(
+					this->_m_priv->mreq.get(),
+					reinterpret_cast<::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to retrieve line values");
+
+	return values;
+}
+
+GPIOD_CXX_API line::values multi_request::get_values(const ::std::vector<unsigned int>& lines)
+{
+	line::values values(lines.size());
+
+	int ret = ::gpiod_multi_request_get_values_subset(
+					this->_m_priv->mreq.get(), lines.size(), lines.data(),
+					reinterpret_cast<::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to retrieve line values");
+
+	return values;
+}
+
+GPIOD_CXX_API multi_request& multi_request::set_values(const line::values& values)
+{
+	if (values.size() != this->num_lines())
+		throw ::std::invalid_argument("values must have the same size as the lines");
+
+	int ret = ::gpiod_multi_request_set_values(
+					this->_m_priv->mreq.get(),
+					reinterpret_cast<const ::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to set line values");
+
+	return *this;
+}
+
+GPIOD_CXX_API multi_request& multi_request::set_values(const ::std::vector<unsigned int>& lines,
+						       const line::values& values)
+{
+	if (values.size() != lines.size())
+		throw ::std::invalid_argument("values must have the same size as the lines");
+
+	int ret = ::gpiod_multi_request_set_values_subset(
+					this->_m_priv->mreq.get(), lines.size(), lines.data(),
+					reinterpret_cast<const ::gpiod_line_value*>(values.data()));
+	if (ret)
+		throw_from_errno("unable to set line values");
+
+	return *this;
+}
+
+GPIOD_CXX_API void multi_request::start_workers(const ::std::vector<int>& cpus)
+{
+	::std::vector<int> pinned(this->num_requests(), -1);
+
+	for (::std::size_t i = 0; i < cpus.size() && i < pinned.size(); i++)
+		pinned[i] = cpus[i];
+
+	int ret = ::gpiod_multi_request_start_workers(this->_m_priv->mreq.get(), pinned.data());
+	if (ret)
+		throw_from_errno("unable to start the workers");
+}
+
+GPIOD_CXX_API void multi_request::stop_workers()
+{
+	if (!this->workers_running())
+		return;
+
+	::gpiod_multi_request_stop_workers(this->_m_priv->mreq.get());
+}
+
+GPIOD_CXX_API bool multi_request::workers_running() const noexcept
+{
+	return ::gpiod_multi_request_workers_running(this->_m_priv->mreq.get());
+}
+
+GPIOD_CXX_API ::std::chrono::nanoseconds multi_request::last_skew() const noexcept
+{
+	return ::std::chrono::nanoseconds(
+			::gpiod_multi_request_get_last_skew_ns(this->_m_priv->mreq.get()));
+}
+
+GPIOD_CXX_API multi_request::snapshot multi_request::take_snapshot()
+{
+	::gpiod_multi_request* mreq = this->_m_priv->mreq.get();
+	snapshot snap;
+
+	if (!this->_m_priv->snapshot) {
+		this->_m_priv->snapshot.reset(::gpiod_multi_request_snapshot_new(mreq));
+		if (!this->_m_priv->snapshot)
+			throw_from_errno("unable to allocate the snapshot");
+	}
+
+	::gpiod_multi_request_snapshot* csnap = this->_m_priv->snapshot.get();
+
+	/* The snapshot is sized for all members so only the reads can fail. */
+	::gpiod_multi_request_take_snapshot(mreq, csnap);
+
+	auto samples = ::gpiod_multi_request_snapshot_get_samples(csnap);
+	auto num_samples = ::gpiod_multi_request_snapshot_get_num_samples(csnap);
+
+	snap.timestamp = ::std::chrono::nanoseconds(
+			::gpiod_multi_request_snapshot_get_timestamp_ns(csnap));
+	snap.window = ::std::chrono::nanoseconds(
+			::gpiod_multi_request_snapshot_get_window_ns(csnap));
+	snap.samples.reserve(num_samples);
+
+	for (::std::size_t i = 0; i < num_samples; i++)
+		snap.samples.push_back({
+			::std::chrono::nanoseconds(samples[i].before_ns),
+			::std::chrono::nanoseconds(samples[i].after_ns),
+			samples[i].mask,
+			samples[i].values,
+			samples[i].error,
+		});
+
+	return snap;
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const multi_request& request)
+{
+	out << "gpiod::multi_request(num_requests=" << request.num_requests() <<
+	       ", num_lines=" << request.num_lines() <<
+	       ", workers_running=" << (request.workers_running() ? "true" : "false") <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
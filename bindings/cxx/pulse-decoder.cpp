@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ios>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+namespace {
+
+pulse_decoder_ptr make_pulse_decoder(::gpiod_pulse_decoder* decoder)
+{
+	if (!decoder)
+		throw_from_errno("unable to create the pulse decoder");
+
+	return pulse_decoder_ptr(decoder);
+}
+
+} /* namespace */
+
+GPIOD_CXX_API pulse_decoder pulse_decoder::wiegand(line::offset data0, line::offset data1)
+{
+	pulse_decoder decoder;
+
+	decoder._m_priv->decoder = make_pulse_decoder(
+			::gpiod_pulse_decoder_new_wiegand(data0, data1));
+
+	return decoder;
+}
+
+GPIOD_CXX_API pulse_decoder pulse_decoder::pulse_width(line::offset offset,
+						       const ::std::chrono::nanoseconds& one_min)
+{
+	pulse_decoder decoder;
+
+	decoder._m_priv->decoder = make_pulse_decoder(
+			::gpiod_pulse_decoder_new_pulse_width(offset, one_min.count()));
+
+	return decoder;
+}
+
+pulse_decoder::pulse_decoder()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API pulse_decoder::pulse_decoder(pulse_decoder&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API pulse_decoder::~pulse_decoder()
+{
+
+}
+
+GPIOD_CXX_API pulse_decoder& pulse_decoder::operator=(pulse_decoder&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API pulse_decoder& pulse_decoder::set_frame_gap(const ::std::chrono::nanoseconds& gap)
+{
+	::gpiod_pulse_decoder_set_frame_gap_ns(this->_m_priv->decoder.get(), gap.count());
+
+	return *this;
+}
+
+GPIOD_CXX_API pulse_decoder&
+pulse_decoder::set_pulse_width_limits(const ::std::chrono::nanoseconds& min,
+				      const ::std::chrono::nanoseconds& max)
+{
+	int ret = ::gpiod_pulse_decoder_set_pulse_width_limits(this->_m_priv->decoder.get(),
+							       min.count(), max.count());
+	if (ret)
+		throw_from_errno("unable to set the pulse width limits");
+
+	return *this;
+}
+
+GPIOD_CXX_API pulse_decoder&
+pulse_decoder::set_min_interval(const ::std::chrono::nanoseconds& interval)
+{
+	::gpiod_pulse_decoder_set_min_interval_ns(this->_m_priv->decoder.get(),
+						  interval.count());
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t pulse_decoder::add_events(const edge_event_buffer& buffer)
+{
+	if (buffer.growable())
+		throw ::std::invalid_argument("growable edge event buffers can't be decoded");
+
+	int ret = ::gpiod_pulse_decoder_add_events(this->_m_priv->decoder.get(),
+						   buffer._m_priv->buffer.get());
+	if (ret < 0)
+		throw_from_errno("error decoding edge events");
+
+	return ret;
+}
+
+GPIOD_CXX_API ::std::size_t pulse_decoder::flush(const timestamp& now)
+{
+	return ::gpiod_pulse_decoder_flush(this->_m_priv->decoder.get(), now.ns());
+}
+
+GPIOD_CXX_API ::std::size_t pulse_decoder::num_frames() const noexcept
+{
+	return ::gpiod_pulse_decoder_get_num_frames(this->_m_priv->decoder.get());
+}
+
+GPIOD_CXX_API ::std::optional<pulse_frame> pulse_decoder::read_frame()
+{
+	::std::uint64_t data, ts;
+	unsigned int num_bits;
+	int errors;
+
+	if (!::gpiod_pulse_decoder_read_frame(this->_m_priv->decoder.get(),
+					      &data, &num_bits, &errors, &ts))
+		return ::std::nullopt;
+
+	return pulse_frame{ data, num_bits, errors, timestamp(ts) };
+}
+
+GPIOD_CXX_API unsigned long pulse_decoder::num_lost_frames() const noexcept
+{
+	return ::gpiod_pulse_decoder_get_num_lost_frames(this->_m_priv->decoder.get());
+}
+
+GPIOD_CXX_API void pulse_decoder::reset() noexcept
+{
+	::gpiod_pulse_decoder_reset(this->_m_priv->decoder.get());
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const pulse_frame& frame)
+{
+	::std::ios_base::fmtflags flags = out.flags();
+
+	out << "gpiod::pulse_frame(data=0x" << ::std::hex << frame.data;
+	out.flags(flags);
+	out << ", num_bits=" << frame.num_bits <<
+	       ", errors=" << frame.errors <<
+	       ", start=" << frame.start.ns() <<
+	       ")";
+
+	return out;
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const pulse_decoder& decoder)
+{
+	out << "gpiod::pulse_decoder(num_frames=" << decoder.num_frames() <<
+	       ", num_lost_frames=" << decoder.num_lost_frames() <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 // SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <memory_resource>
 #include <ostream>
 #include <utility>
 
@@ -8,16 +9,24 @@
 
 namespace gpiod {
 
-struct request_builder::impl
+struct request_builder::impl : public resource_allocated
 {
-	impl(chip& parent)
+	impl(chip& parent, ::std::pmr::memory_resource* resource)
 		: line_cfg(),
 		  req_cfg(),
-		  parent(parent)
+		  parent(parent),
+		  resource(resource)
 	{
 
 	}
 
+	static impl* make(chip& parent, ::std::pmr::memory_resource* resource)
+	{
+		memory_resource_scope scope(resource);
+
+		return new impl(parent, resource);
+	}
+
 	impl(const impl& other) = delete;
 	impl(impl&& other) = delete;
 	impl& operator=(const impl& other) = delete;
@@ -26,10 +35,12 @@ struct request_builder::impl
 	line_config line_cfg;
 	request_config req_cfg;
 	chip parent;
+	::std::pmr::memory_resource* resource;
 };
 
-GPIOD_CXX_API request_builder::request_builder(chip& chip)
-	: _m_priv(new impl(chip))
+GPIOD_CXX_API request_builder::request_builder(chip& chip,
+					       ::std::pmr::memory_resource* resource)
+	: _m_priv(impl::make(chip, resource))
 {
 
 }
@@ -67,6 +78,8 @@ GPIOD_CXX_API const request_config& request_builder::get_request_config() const
 GPIOD_CXX_API request_builder&
 request_builder::set_consumer(const ::std::string& consumer) noexcept
 {
+	memory_resource_scope scope(this->_m_priv->resource);
+
 	this->_m_priv->req_cfg.set_consumer(consumer);
 
 	return *this;
@@ -80,6 +93,27 @@ request_builder::set_event_buffer_size(::std::size_t event_buffer_size) noexcept
 	return *this;
 }
 
+GPIOD_CXX_API request_builder& request_builder::set_output_shadow(bool enabled) noexcept
+{
+	this->_m_priv->req_cfg.set_output_shadow(enabled);
+
+	return *this;
+}
+
+GPIOD_CXX_API request_builder& request_builder::set_input_shadow(bool enabled) noexcept
+{
+	this->_m_priv->req_cfg.set_input_shadow(enabled);
+
+	return *this;
+}
+
+GPIOD_CXX_API request_builder& request_builder::set_nonblocking(bool enabled) noexcept
+{
+	this->_m_priv->req_cfg.set_nonblocking(enabled);
+
+	return *this;
+}
+
 GPIOD_CXX_API request_builder& request_builder::set_line_config(line_config &line_cfg)
 {
 	this->_m_priv->line_cfg = line_cfg;
@@ -101,6 +135,8 @@ request_builder::add_line_settings(line::offset offset, const line_settings& set
 GPIOD_CXX_API request_builder&
 request_builder::add_line_settings(const line::offsets& offsets, const line_settings& settings)
 {
+	memory_resource_scope scope(this->_m_priv->resource);
+
 	this->_m_priv->line_cfg.add_line_settings(offsets, settings);
 
 	return *this;
@@ -108,6 +144,9 @@ request_builder::add_line_settings(const line::offsets& offsets, const line_sett
 
 GPIOD_CXX_API line_request request_builder::do_request()
 {
+	/* The request may outlive the resource, keep it on the heap. */
+	memory_resource_scope scope(nullptr);
+
 	line_request_ptr request(::gpiod_chip_request_lines(
 					this->_m_priv->parent._m_priv->chip.get(),
 					this->_m_priv->req_cfg._m_priv->config.get(),
@@ -87,6 +87,42 @@ GPIOD_CXX_API ::std::size_t request_config::event_buffer_size() const noexcept
 	return ::gpiod_request_config_get_event_buffer_size(this->_m_priv->config.get());
 }
 
+GPIOD_CXX_API request_config& request_config::set_output_shadow(bool enabled) noexcept
+{
+	::gpiod_request_config_set_output_shadow(this->_m_priv->config.get(), enabled);
+
+	return *this;
+}
+
+GPIOD_CXX_API bool request_config::output_shadow() const noexcept
+{
+	return ::gpiod_request_config_get_output_shadow(this->_m_priv->config.get());
+}
+
+GPIOD_CXX_API request_config& request_config::set_input_shadow(bool enabled) noexcept
+{
+	::gpiod_request_config_set_input_shadow(this->_m_priv->config.get(), enabled);
+
+	return *this;
+}
+
+GPIOD_CXX_API bool request_config::input_shadow() const noexcept
+{
+	return ::gpiod_request_config_get_input_shadow(this->_m_priv->config.get());
+}
+
+GPIOD_CXX_API request_config& request_config::set_nonblocking(bool enabled) noexcept
+{
+	::gpiod_request_config_set_nonblocking(this->_m_priv->config.get(), enabled);
+
+	return *this;
+}
+
+GPIOD_CXX_API bool request_config::nonblocking() const noexcept
+{
+	return ::gpiod_request_config_get_nonblocking(this->_m_priv->config.get());
+}
+
 GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const request_config& config)
 {
 	::std::string consumer;
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+request_template::impl::impl(const line_config& line_cfg, const request_config* req_cfg)
+	: tmpl(::gpiod_request_template_new(req_cfg ? req_cfg->_m_priv->config.get() : nullptr,
+					     line_cfg._m_priv->config.get()))
+{
+	if (!this->tmpl)
+		throw_from_errno("unable to create the request template");
+}
+
+GPIOD_CXX_API request_template::request_template(const line_config& line_cfg)
+	: _m_priv(new impl(line_cfg, nullptr))
+{
+
+}
+
+GPIOD_CXX_API request_template::request_template(const line_config& line_cfg,
+						 const request_config& req_cfg)
+	: _m_priv(new impl(line_cfg, &req_cfg))
+{
+
+}
+
+GPIOD_CXX_API request_template::request_template(const request_template& other)
+	: _m_priv(other._m_priv)
+{
+
+}
+
+GPIOD_CXX_API request_template::request_template(request_template&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API request_template::~request_template()
+{
+
+}
+
+GPIOD_CXX_API request_template& request_template::operator=(const request_template& other)
+{
+	this->_m_priv = other._m_priv;
+
+	return *this;
+}
+
+GPIOD_CXX_API request_template& request_template::operator=(request_template&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::size_t request_template::num_lines() const
+{
+	return ::gpiod_request_template_get_num_lines(this->_m_priv->tmpl.get());
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const request_template& tmpl)
+{
+	out << "gpiod::request_template(num_lines=" << tmpl.num_lines() << ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+void stats::impl::set_stats_ptr(stats_ptr& new_stats)
+{
+	this->stats = ::std::move(new_stats);
+}
+
+GPIOD_CXX_API stats::stats()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API stats::stats(const stats& other)
+	: _m_priv(other._m_priv)
+{
+
+}
+
+GPIOD_CXX_API stats::stats(stats&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API stats::~stats()
+{
+
+}
+
+GPIOD_CXX_API stats& stats::operator=(const stats& other)
+{
+	this->_m_priv = other._m_priv;
+
+	return *this;
+}
+
+GPIOD_CXX_API stats& stats::operator=(stats&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_get_ioctls() const noexcept
+{
+	return ::gpiod_stats_get_num_get_ioctls(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_set_ioctls() const noexcept
+{
+	return ::gpiod_stats_get_num_set_ioctls(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_config_ioctls() const noexcept
+{
+	return ::gpiod_stats_get_num_config_ioctls(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_info_ioctls() const noexcept
+{
+	return ::gpiod_stats_get_num_info_ioctls(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_reads() const noexcept
+{
+	return ::gpiod_stats_get_num_reads(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_events_read() const noexcept
+{
+	return ::gpiod_stats_get_num_events_read(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::uint64_t stats::num_bytes_read() const noexcept
+{
+	return ::gpiod_stats_get_num_bytes_read(this->_m_priv->stats.get());
+}
+
+GPIOD_CXX_API ::std::chrono::nanoseconds stats::ioctl_time() const noexcept
+{
+	return ::std::chrono::nanoseconds(
+			::gpiod_stats_get_ioctl_time_ns(this->_m_priv->stats.get()));
+}
+
+GPIOD_CXX_API ::std::chrono::nanoseconds stats::max_ioctl_time() const noexcept
+{
+	return ::std::chrono::nanoseconds(
+			::gpiod_stats_get_max_ioctl_time_ns(this->_m_priv->stats.get()));
+}
+
+GPIOD_CXX_API ::std::chrono::nanoseconds stats::wait_time() const noexcept
+{
+	return ::std::chrono::nanoseconds(
+			::gpiod_stats_get_wait_time_ns(this->_m_priv->stats.get()));
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const stats& stats)
+{
+	out << "gpiod::stats(num_get_ioctls=" << stats.num_get_ioctls() <<
+	       ", num_set_ioctls=" << stats.num_set_ioctls() <<
+	       ", num_config_ioctls=" << stats.num_config_ioctls() <<
+	       ", num_info_ioctls=" << stats.num_info_ioctls() <<
+	       ", num_reads=" << stats.num_reads() <<
+	       ", num_events_read=" << stats.num_events_read() <<
+	       ", num_bytes_read=" << stats.num_bytes_read() <<
+	       ", ioctl_time=" << stats.ioctl_time().count() <<
+	       ", max_ioctl_time=" << stats.max_ioctl_time().count() <<
+	       ", wait_time=" << stats.wait_time().count() << ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
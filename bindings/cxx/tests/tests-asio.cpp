@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <gpiod-asio.hpp>
+#include <gpiod.hpp>
+
+#include "gpiosim.hpp"
+
+using ::gpiosim::make_sim;
+using edge = ::gpiod::line::edge;
+using event_type = ::gpiod::edge_event::event_type;
+using info_event_type = ::gpiod::info_event::event_type;
+using pull = ::gpiosim::chip::pull;
+using error_code = ::gpiod::asio::error_code;
+
+namespace net = ::gpiod::asio::net;
+
+namespace {
+
+TEST_CASE("edge events can be read through the reactor", "[asio][edge-event]")
+{
+	auto sim = make_sim()
+		.set_num_lines(4)
+		.build();
+
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer;
+	net::io_context ctx;
+
+	auto request = chip
+		.prepare_request()
+		.add_line_settings(
+			2,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	::gpiod::asio::async_line_request stream(ctx, request);
+
+	SECTION("events are read once they arrive")
+	{
+		::std::size_t num_read = 0;
+		error_code result;
+
+		stream.async_read_edge_events(buffer,
+			[&](const error_code& ec, ::std::size_t num_events) {
+				result = ec;
+				num_read = num_events;
+			});
+
+		/* Nothing to read yet. */
+		ctx.poll();
+		REQUIRE(num_read == 0);
+
+		sim.set_pull(2, pull::PULL_UP);
+		ctx.run_for(::std::chrono::seconds(1));
+
+		REQUIRE_FALSE(result);
+		REQUIRE(num_read == 1);
+		REQUIRE(buffer.get_event(0).type() == event_type::RISING_EDGE);
+		REQUIRE(buffer.get_event(0).line_offset() == 2);
+	}
+
+	SECTION("pending reads can be cancelled")
+	{
+		error_code result;
+
+		stream.async_read_edge_events(buffer,
+			[&](const error_code& ec, ::std::size_t) {
+				result = ec;
+			});
+
+		stream.cancel();
+		ctx.run_for(::std::chrono::seconds(1));
+
+		REQUIRE(result == net::error::operation_aborted);
+	}
+
+	SECTION("request stays usable after the stream is gone")
+	{
+		{
+			::gpiod::asio::async_line_request other(ctx.get_executor(), request);
+		}
+
+		sim.set_pull(2, pull::PULL_UP);
+		REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+		REQUIRE(request.read_edge_events(buffer) == 1);
+	}
+}
+
+TEST_CASE("info events can be waited for through the reactor", "[asio][info-event]")
+{
+	auto sim = make_sim()
+		.set_num_lines(4)
+		.build();
+
+	::gpiod::chip chip(sim.dev_path());
+	net::io_context ctx;
+	bool ready = false;
+	error_code result;
+
+	chip.watch_line_info(1);
+
+	::gpiod::asio::async_chip stream(ctx, chip);
+
+	stream.async_wait_info_event([&](const error_code& ec) {
+		result = ec;
+		ready = true;
+	});
+
+	ctx.poll();
+	REQUIRE_FALSE(ready);
+
+	auto request = chip
+		.prepare_request()
+		.add_line_settings(1, ::gpiod::line_settings())
+		.do_request();
+
+	ctx.run_for(::std::chrono::seconds(1));
+
+	REQUIRE(ready);
+	REQUIRE_FALSE(result);
+	REQUIRE(chip.read_info_event().type() == info_event_type::LINE_REQUESTED);
+}
+
+} /* namespace */
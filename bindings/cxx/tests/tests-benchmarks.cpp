@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <gpiod.hpp>
+#include <iostream>
+#include <thread>
+
+#include "gpiosim.hpp"
+
+/*
+ * Accessor microbenchmarks. They're hidden from the default run, use:
+ *
+ *   gpiod-cxx-test "[benchmark]"
+ *
+ * and compare the results between revisions.
+ */
+
+using ::gpiosim::make_sim;
+using direction = ::gpiod::line::direction;
+using edge = ::gpiod::line::edge;
+using offsets = ::gpiod::line::offsets;
+using pull = ::gpiosim::chip::pull;
+using value = ::gpiod::line::value;
+using values = ::gpiod::line::values;
+
+namespace {
+
+constexpr int num_iterations = 1024;
+/* Largest edge event queue the kernel allows for a single line. */
+constexpr ::std::size_t edge_event_queue_size = 1024;
+
+TEST_CASE("edge event accessors", "[.][benchmark][edge-event]")
+{
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer;
+
+	auto request = chip
+		.prepare_request()
+		.add_line_settings(
+			0,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	sim.set_pull(0, pull::PULL_UP);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+	sim.set_pull(0, pull::PULL_DOWN);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+
+	REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+	REQUIRE(request.read_edge_events(buffer) == 2);
+
+	BENCHMARK("type() of 1024 events")
+	{
+		unsigned int num_rising = 0;
+
+		for (int i = 0; i < num_iterations / 2; i++) {
+			for (const auto& event: buffer)
+				num_rising += event.type() ==
+					::gpiod::edge_event::event_type::RISING_EDGE;
+		}
+
+		return num_rising;
+	};
+
+	BENCHMARK("copying 1024 events")
+	{
+		::std::uint64_t sum = 0;
+
+		for (int i = 0; i < num_iterations / 2; i++) {
+			for (const auto& event: buffer) {
+				auto copy = event;
+
+				sum += copy.line_seqno();
+			}
+		}
+
+		return sum;
+	};
+}
+
+TEST_CASE("line info accessors", "[.][benchmark][line-info]")
+{
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	auto info = chip.get_line_info(0);
+
+	BENCHMARK("1024 line_info enum getters")
+	{
+		int sum = 0;
+
+		for (int i = 0; i < num_iterations; i++)
+			sum += static_cast<int>(info.direction()) +
+			       static_cast<int>(info.bias()) +
+			       static_cast<int>(info.drive()) +
+			       static_cast<int>(info.edge_detection()) +
+			       static_cast<int>(info.event_clock());
+
+		return sum;
+	};
+}
+
+TEST_CASE("line settings accessors", "[.][benchmark][line-settings]")
+{
+	::gpiod::line_settings settings;
+
+	BENCHMARK("1024 line_settings enum setters and getters")
+	{
+		int sum = 0;
+
+		for (int i = 0; i < num_iterations; i++) {
+			settings.set_edge_detection(i % 2 ? edge::BOTH : edge::NONE);
+			sum += static_cast<int>(settings.edge_detection()) +
+			       static_cast<int>(settings.direction()) +
+			       static_cast<int>(settings.bias()) +
+			       static_cast<int>(settings.output_value());
+		}
+
+		return sum;
+	};
+}
+
+TEST_CASE("line request values", "[.][benchmark][line-request]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	values vals(8, value::INACTIVE);
+
+	auto request = chip
+		.prepare_request()
+		.add_line_settings(
+			offsets({ 0, 1, 2, 3, 4, 5, 6, 7 }),
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+
+	BENCHMARK("get_value() of a single line")
+	{
+		return request.get_value(3);
+	};
+
+	BENCHMARK("get_values() of 8 lines into a reused vector")
+	{
+		request.get_values(vals);
+
+		return vals[0];
+	};
+
+	BENCHMARK("get_values_mask() of 8 lines")
+	{
+		return request.get_values_mask(0xff);
+	};
+
+	BENCHMARK("set_value() of a single line")
+	{
+		return &request.set_value(3, value::ACTIVE);
+	};
+
+	BENCHMARK("set_values() of 8 lines")
+	{
+		return &request.set_values(vals);
+	};
+
+	BENCHMARK("set_values_mask() of 8 lines")
+	{
+		return &request.set_values_mask(0xff, 0x55);
+	};
+}
+
+/*
+ * Events can't be requeued between the runs of a BENCHMARK() so this one is
+ * timed by hand: the kernel queue is filled before reading it empty.
+ */
+TEST_CASE("edge event reading", "[.][benchmark][edge-event]")
+{
+	constexpr int num_rounds = 8;
+
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+
+	auto request = chip
+		.prepare_request()
+		.set_event_buffer_size(edge_event_queue_size)
+		.add_line_settings(
+			0,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	for (auto capacity: { 1, 16, 64, 1024 }) {
+		::gpiod::edge_event_buffer buffer(capacity);
+		::std::chrono::nanoseconds elapsed(0);
+
+		for (int round = 0; round < num_rounds; round++) {
+			for (::std::size_t i = 0; i < edge_event_queue_size; i++)
+				sim.set_pull(0, i % 2 ? pull::PULL_DOWN : pull::PULL_UP);
+
+			auto start = ::std::chrono::steady_clock::now();
+			for (auto pending = edge_event_queue_size; pending; )
+				pending -= request.read_edge_events(buffer);
+			elapsed += ::std::chrono::steady_clock::now() - start;
+		}
+
+		::std::cout << "read_edge_events() with buffer capacity " << capacity
+			    << ": " << elapsed.count() / (num_rounds * edge_event_queue_size)
+			    << " ns per event" << ::std::endl;
+	}
+}
+
+} /* namespace */
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gpiod.hpp>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#include "helpers.hpp"
+
+using clock_type = ::gpiod::line::clock;
+
+namespace {
+
+constexpr ::std::uint64_t checkpoint_interval = 1024;
+
+struct capture_line
+{
+	::std::uint32_t chip_num;
+	::std::uint32_t offset;
+	char chip_name[32];
+	char line_name[32];
+};
+
+/* Header of the capture files written by gpiomon, see tools-common.h. */
+struct capture_header
+{
+	char magic[8];
+	::std::uint32_t version;
+	::std::uint32_t record_size;
+	::std::uint64_t capacity;
+	::std::uint64_t head;
+	::std::uint64_t index_offset;
+	::std::uint64_t records_offset;
+	::std::uint32_t checkpoint_interval;
+	::std::uint32_t num_lines;
+	::std::uint32_t event_clock;
+	::std::uint32_t reserved;
+	capture_line lines[64];
+};
+
+class capture_file
+{
+public:
+	capture_file(::std::uint64_t capacity, ::std::uint64_t num_written)
+		: _m_path(::std::filesystem::temp_directory_path() /
+			  ("gpiod-cxx-test-capture." + ::std::to_string(::getpid())))
+	{
+		::std::uint64_t num_checkpoints = (capacity + checkpoint_interval - 1) /
+						  checkpoint_interval;
+		::std::vector<::gpiod::capture_record> records(capacity);
+		::std::vector<::std::uint64_t> index(num_checkpoints);
+		capture_header hdr;
+
+		for (::std::uint64_t n = 0; n < num_written; n++) {
+			auto slot = n % capacity;
+
+			records[slot].timestamp_ns = 10 * n;
+			records[slot].offset = 4;
+			records[slot].line_seqno = n + 1;
+
+			if (slot % checkpoint_interval == 0)
+				index[slot / checkpoint_interval] = 10 * n;
+		}
+
+		::std::memset(&hdr, 0, sizeof(hdr));
+		::std::memcpy(hdr.magic, "GPIOCAP", 8);
+		hdr.version = 2;
+		hdr.record_size = sizeof(::gpiod::capture_record);
+		hdr.capacity = capacity;
+		hdr.head = num_written;
+		hdr.index_offset = sizeof(hdr);
+		hdr.records_offset = sizeof(hdr) + num_checkpoints * sizeof(::std::uint64_t);
+		hdr.checkpoint_interval = checkpoint_interval;
+		hdr.num_lines = 1;
+		/* GPIOD_LINE_CLOCK_MONOTONIC */
+		hdr.event_clock = 1;
+		hdr.lines[0].offset = 4;
+		::std::strcpy(hdr.lines[0].chip_name, "gpiochip0");
+		::std::strcpy(hdr.lines[0].line_name, "foo");
+
+		::std::ofstream out(this->_m_path, ::std::ios::binary);
+		out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+		out.write(reinterpret_cast<const char*>(index.data()),
+			  index.size() * sizeof(::std::uint64_t));
+		out.write(reinterpret_cast<const char*>(records.data()),
+			  records.size() * sizeof(::gpiod::capture_record));
+	}
+
+	~capture_file()
+	{
+		::std::filesystem::remove(this->_m_path);
+	}
+
+	const ::std::filesystem::path& path() const noexcept
+	{
+		return this->_m_path;
+	}
+
+private:
+	::std::filesystem::path _m_path;
+};
+
+TEST_CASE("capture_reader exposes the header of the capture", "[capture-reader]")
+{
+	capture_file file(2048, 100);
+	::gpiod::capture_reader reader(file.path());
+
+	REQUIRE(reader.event_clock() == clock_type::MONOTONIC);
+	REQUIRE(reader.num_records() == 100);
+	REQUIRE(reader.num_lost() == 0);
+
+	auto lines = reader.lines();
+	REQUIRE(lines.size() == 1);
+	REQUIRE(lines[0].offset == 4);
+	REQUIRE(lines[0].chip_name == "gpiochip0");
+	REQUIRE(lines[0].line_name == "foo");
+
+	REQUIRE(reader.get_record(99).line_seqno == 100);
+	REQUIRE_THROWS_AS(reader.get_record(100), ::std::out_of_range);
+}
+
+TEST_CASE("capture_reader iterates over the wrapped ring in place", "[capture-reader]")
+{
+	capture_file file(3000, 7500);
+	::gpiod::capture_reader reader(file.path());
+	::std::uint64_t index = 0;
+	unsigned int num_ranges = 0;
+
+	REQUIRE(reader.num_records() == 3000);
+	REQUIRE(reader.num_lost() == 4500);
+
+	for (auto range = reader.records(index); !range.empty(); range = reader.records(index)) {
+		for (const auto& record: range)
+			REQUIRE(record.timestamp_ns == 10 * (4500 + index++));
+
+		num_ranges++;
+	}
+
+	REQUIRE(index == 3000);
+	REQUIRE(num_ranges == 2);
+	REQUIRE(&reader.get_record(0) == reader.records(0).data());
+}
+
+TEST_CASE("capture_reader finds records by timestamp", "[capture-reader]")
+{
+	capture_file file(4096, 9000);
+	::gpiod::capture_reader reader(file.path());
+
+	REQUIRE(reader.find(0) == 0);
+	REQUIRE(reader.find(49040) == 0);
+	REQUIRE(reader.find(49041) == 1);
+	REQUIRE(reader.find(70000) == 2096);
+	REQUIRE(reader.find(89990) == 4095);
+	REQUIRE(reader.find(90000) == 4096);
+}
+
+TEST_CASE("capture_reader rejects invalid files", "[capture-reader]")
+{
+	REQUIRE_THROWS_AS(::gpiod::capture_reader("/dev/null"), ::std::invalid_argument);
+	REQUIRE_THROWS_MATCHES(::gpiod::capture_reader("/does/not/exist"), ::std::system_error,
+			       system_error_matcher(ENOENT));
+}
+
+} /* namespace */
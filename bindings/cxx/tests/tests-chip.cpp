@@ -141,6 +141,24 @@ TEST_CASE("line lookup: behavior for duplicate names", "[chip]")
 	REQUIRE(chip.get_line_offset_from_name("bar") == 2);
 }
 
+TEST_CASE("chip statistics count info ioctls", "[chip]")
+{
+	auto sim = make_sim()
+		.set_num_lines(4)
+		.build();
+
+	::gpiod::chip chip(sim.dev_path());
+
+	chip.get_info();
+	chip.get_line_info(0);
+
+	REQUIRE(chip.get_stats().num_info_ioctls() == 2);
+
+	chip.reset_stats();
+
+	REQUIRE(chip.get_stats().num_info_ioctls() == 0);
+}
+
 TEST_CASE("closed chip can no longer be used", "[chip]")
 {
 	auto sim = make_sim().build();
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <gpiod.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using edge = ::gpiod::line::edge;
+using pull = ::gpiosim::chip::pull;
+using event_type = ::gpiod::edge_event::event_type;
+
+namespace {
+
+void toggle_line(::gpiosim::chip& sim, unsigned int offset)
+{
+	sim.set_pull(offset, pull::PULL_UP);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+	sim.set_pull(offset, pull::PULL_DOWN);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+}
+
+TEST_CASE("edge_event_pipeline stages are applied in order", "[edge-event-pipeline]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer(64);
+	::gpiod::edge_event_pipeline pipeline;
+
+	auto request = chip.prepare_request()
+		.add_line_settings(
+			{ 2, 5 },
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	::std::size_t num_seen = 0;
+
+	pipeline
+		.add_edge_filter(2, edge::RISING)
+		.add_stage([&num_seen](::gpiod::edge_event_record* records, ::std::size_t num_events) {
+			::std::size_t num_kept = 0;
+
+			num_seen += num_events;
+
+			for (::std::size_t i = 0; i < num_events; i++) {
+				if (records[i].line_offset != 5)
+					records[num_kept++] = records[i];
+			}
+
+			return num_kept;
+		});
+
+	REQUIRE(pipeline.num_stages() == 2);
+
+	toggle_line(sim, 2);
+	toggle_line(sim, 5);
+	toggle_line(sim, 2);
+
+	REQUIRE(request.read_edge_events(buffer) == 6);
+	REQUIRE(pipeline.process(buffer) == 2);
+	REQUIRE(num_seen == 4);
+	REQUIRE(pipeline.num_dropped(0) == 2);
+	REQUIRE(pipeline.num_dropped(1) == 2);
+	REQUIRE_THROWS_AS(pipeline.num_dropped(2), ::std::out_of_range);
+
+	REQUIRE(buffer.num_events() == 2);
+	REQUIRE(buffer.records().size() == 2);
+
+	for (const auto& event: buffer) {
+		REQUIRE(event.line_offset() == 2);
+		REQUIRE(event.type() == event_type::RISING_EDGE);
+	}
+
+	pipeline.reset();
+	REQUIRE(pipeline.num_dropped(0) == 0);
+}
+
+TEST_CASE("edge_event_pipeline rethrows exceptions of stages", "[edge-event-pipeline]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer(64);
+	::gpiod::edge_event_pipeline pipeline;
+
+	auto request = chip.prepare_request()
+		.add_line_settings(
+			3,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	pipeline
+		.add_stage([](::gpiod::edge_event_record*, ::std::size_t) -> ::std::size_t {
+			throw ::std::runtime_error("stage failed");
+		})
+		.add_min_interval(3, ::std::chrono::seconds(1));
+
+	toggle_line(sim, 3);
+
+	REQUIRE(request.read_edge_events(buffer) == 2);
+	REQUIRE_THROWS_AS(pipeline.process(buffer), ::std::runtime_error);
+	/* The remaining stages still ran. */
+	REQUIRE(buffer.num_events() == 1);
+	REQUIRE(pipeline.num_dropped(1) == 1);
+}
+
+TEST_CASE("edge_event_pipeline validates arguments", "[edge-event-pipeline]")
+{
+	::gpiod::edge_event_pipeline pipeline;
+	::gpiod::edge_event_buffer growable(2, 16);
+
+	REQUIRE_THROWS_AS(pipeline.add_stage(nullptr), ::std::invalid_argument);
+	REQUIRE_THROWS_AS(pipeline.process(growable), ::std::invalid_argument);
+	REQUIRE(pipeline.num_stages() == 0);
+}
+
+TEST_CASE("edge_event_pipeline can be moved", "[edge-event-pipeline]")
+{
+	::gpiod::edge_event_pipeline pipeline;
+
+	pipeline.add_edge_filter(0, edge::FALLING);
+
+	auto moved(::std::move(pipeline));
+
+	REQUIRE(moved.num_stages() == 1);
+
+	::std::stringstream buf;
+
+	buf << moved;
+
+	REQUIRE(buf.str() == "gpiod::edge_event_pipeline(num_stages=1)");
+}
+
+} /* namespace */
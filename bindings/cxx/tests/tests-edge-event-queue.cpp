@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <gpiod.hpp>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using edge = ::gpiod::line::edge;
+using pull = ::gpiosim::chip::pull;
+using overflow = ::gpiod::edge_event_queue::overflow;
+
+namespace {
+
+const unsigned int num_test_events = 4;
+
+/* Fills the buffer with events whose line sequence numbers are 1 to 4. */
+void read_test_events(::gpiosim::chip& sim, ::gpiod::edge_event_buffer& buffer)
+{
+	::gpiod::chip chip(sim.dev_path());
+
+	auto request = chip
+		.prepare_request()
+		.add_line_settings(
+			0,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	for (unsigned int i = 0; i < num_test_events / 2; i++) {
+		sim.set_pull(0, pull::PULL_UP);
+		::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+		sim.set_pull(0, pull::PULL_DOWN);
+		::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+	}
+
+	REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+	REQUIRE(request.read_edge_events(buffer) == num_test_events);
+}
+
+TEST_CASE("edge_event_queue constructor works", "[edge-event-queue]")
+{
+	SECTION("capacity is rounded up to a power of two")
+	{
+		REQUIRE(::gpiod::edge_event_queue(1).capacity() == 1);
+		REQUIRE(::gpiod::edge_event_queue(5).capacity() == 8);
+		REQUIRE(::gpiod::edge_event_queue(64).capacity() == 64);
+	}
+
+	SECTION("the default policy is backpressure")
+	{
+		REQUIRE(::gpiod::edge_event_queue(8).policy() == overflow::BACKPRESSURE);
+		REQUIRE(::gpiod::edge_event_queue(8, overflow::DROP_OLDEST).policy() ==
+			overflow::DROP_OLDEST);
+	}
+
+	SECTION("zero capacity is rejected")
+	{
+		REQUIRE_THROWS_AS(::gpiod::edge_event_queue(0), ::std::invalid_argument);
+	}
+}
+
+TEST_CASE("edge_event_queue hands over events in order", "[edge-event-queue]")
+{
+	auto sim = make_sim().build();
+	::gpiod::edge_event_buffer buffer;
+	::gpiod::edge_event_queue queue(8);
+
+	read_test_events(sim, buffer);
+
+	REQUIRE_FALSE(queue.pop());
+	REQUIRE(queue.push(buffer) == num_test_events);
+	REQUIRE(queue.size_approx() == num_test_events);
+
+	auto event = queue.pop();
+	REQUIRE(event);
+	REQUIRE(event->line_seqno() == 1);
+	REQUIRE(event->line_offset() == 0);
+
+	::std::vector<unsigned long> seqnos;
+	REQUIRE(queue.consume([&seqnos](const ::gpiod::edge_event& ev) {
+		seqnos.push_back(ev.line_seqno());
+	}) == num_test_events - 1);
+	REQUIRE(seqnos == ::std::vector<unsigned long>({ 2, 3, 4 }));
+
+	REQUIRE(queue.size_approx() == 0);
+	REQUIRE(queue.num_pushed() == num_test_events);
+	REQUIRE(queue.num_popped() == num_test_events);
+	REQUIRE(queue.num_dropped() == 0);
+	REQUIRE(queue.num_full() == 0);
+}
+
+TEST_CASE("edge_event_queue overflow policies work", "[edge-event-queue]")
+{
+	auto sim = make_sim().build();
+	::gpiod::edge_event_buffer buffer;
+
+	read_test_events(sim, buffer);
+
+	SECTION("backpressure leaves the events with the producer")
+	{
+		::gpiod::edge_event_queue queue(2, overflow::BACKPRESSURE);
+
+		REQUIRE(queue.push(buffer) == 2);
+		REQUIRE_FALSE(queue.push(buffer.get_event(2)));
+		REQUIRE(queue.num_full() == 2);
+		REQUIRE(queue.num_dropped() == 0);
+
+		REQUIRE(queue.pop()->line_seqno() == 1);
+		REQUIRE(queue.push(buffer, 2) == 1);
+		REQUIRE(queue.pop()->line_seqno() == 2);
+		REQUIRE(queue.pop()->line_seqno() == 3);
+		REQUIRE_FALSE(queue.pop());
+	}
+
+	SECTION("drop newest discards the pushed events")
+	{
+		::gpiod::edge_event_queue queue(2, overflow::DROP_NEWEST);
+
+		REQUIRE(queue.push(buffer) == num_test_events);
+		REQUIRE(queue.num_pushed() == 2);
+		REQUIRE(queue.num_dropped() == 2);
+		REQUIRE(queue.pop()->line_seqno() == 1);
+		REQUIRE(queue.pop()->line_seqno() == 2);
+		REQUIRE_FALSE(queue.pop());
+	}
+
+	SECTION("drop oldest discards the queued events")
+	{
+		::gpiod::edge_event_queue queue(2, overflow::DROP_OLDEST);
+
+		REQUIRE(queue.push(buffer) == num_test_events);
+		REQUIRE(queue.num_pushed() == num_test_events);
+		REQUIRE(queue.num_dropped() == 2);
+		REQUIRE(queue.pop()->line_seqno() == 3);
+		REQUIRE(queue.pop()->line_seqno() == 4);
+		REQUIRE_FALSE(queue.pop());
+	}
+}
+
+TEST_CASE("edge_event_queue works with many consumers", "[edge-event-queue]")
+{
+	static const unsigned int num_events = 100000;
+	static const unsigned int num_consumers = 3;
+
+	auto sim = make_sim().build();
+	::gpiod::edge_event_buffer buffer;
+	::gpiod::edge_event_queue queue(16);
+	::std::atomic<bool> done(false);
+	::std::atomic<unsigned long> seqno_sum(0);
+	::std::vector<::std::thread> consumers;
+
+	read_test_events(sim, buffer);
+
+	for (unsigned int i = 0; i < num_consumers; i++) {
+		consumers.emplace_back([&queue, &done, &seqno_sum]() {
+			for (;;) {
+				/* Checked first so that no push can be missed. */
+				bool finished = done;
+
+				auto event = queue.pop();
+				if (event) {
+					seqno_sum += event->line_seqno();
+					continue;
+				}
+
+				if (finished)
+					break;
+
+				::std::this_thread::yield();
+			}
+		});
+	}
+
+	for (unsigned int i = 0; i < num_events; i++) {
+		while (!queue.push(buffer.get_event(i % num_test_events)))
+			::std::this_thread::yield();
+	}
+
+	done = true;
+	for (auto& consumer: consumers)
+		consumer.join();
+
+	/* Every event was popped exactly once. */
+	REQUIRE(queue.num_pushed() == num_events);
+	REQUIRE(queue.num_popped() == num_events);
+	REQUIRE(seqno_sum == (num_events / num_test_events) * (1 + 2 + 3 + 4));
+}
+
+} /* namespace */
@@ -6,6 +6,7 @@
 #include <gpiod.hpp>
 #include <sstream>
 #include <thread>
+#include <type_traits>
 #include <utility>
 
 #include "gpiosim.hpp"
@@ -36,6 +37,17 @@ TEST_CASE("edge_event_buffer capacity settings work", "[edge-event]")
 	{
 		REQUIRE(::gpiod::edge_event_buffer(16 * 64 * 2).capacity() == 1024);
 	}
+
+	SECTION("process-wide default capacity")
+	{
+		::gpiod::set_default_event_buffer_capacity(16);
+		REQUIRE(::gpiod::default_event_buffer_capacity() == 16);
+		REQUIRE(::gpiod::edge_event_buffer().capacity() == 16);
+		REQUIRE(::gpiod::edge_event_buffer(123).capacity() == 123);
+
+		::gpiod::set_default_event_buffer_capacity(0);
+		REQUIRE(::gpiod::default_event_buffer_capacity() == 64);
+	}
 }
 
 TEST_CASE("edge_event wait timeout", "[edge-event]")
@@ -270,6 +282,56 @@ TEST_CASE("reading multiple events", "[edge-event]")
 		REQUIRE(request.read_edge_events(buffer) == 2);
 		REQUIRE(buffer.num_events() == 2);
 	}
+
+	SECTION("records match the events")
+	{
+		::gpiod::edge_event_buffer buffer;
+
+		REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+		REQUIRE(request.read_edge_events(buffer) == 3);
+
+		auto records = buffer.records();
+		REQUIRE(records.size() == 3);
+
+		for (unsigned int i = 0; i < records.size(); i++) {
+			const auto& event = buffer.get_event(i);
+
+			REQUIRE(records[i].timestamp_ns == event.timestamp_ns().ns());
+			REQUIRE(records[i].line_offset == 1);
+			REQUIRE(records[i].line_seqno == event.line_seqno());
+			REQUIRE(records[i].global_seqno == event.global_seqno());
+		}
+	}
+
+	SECTION("growable buffer reads over chunk size")
+	{
+		::gpiod::edge_event_buffer buffer(2, 16);
+
+		REQUIRE(buffer.growable());
+		REQUIRE(buffer.capacity() == 16);
+		REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+		REQUIRE(request.read_edge_events(buffer) == 3);
+		REQUIRE(buffer.num_events() == 3);
+		REQUIRE(buffer.records().size() == 3);
+
+		for (const auto& event: buffer) {
+			REQUIRE(event.line_seqno() == line_seqno++);
+			REQUIRE(event.global_seqno() == global_seqno++);
+		}
+
+		global_seqno = 1;
+		for (const auto& record: buffer.records())
+			REQUIRE(record.global_seqno == global_seqno++);
+	}
+
+	SECTION("growable buffer honors max_events")
+	{
+		::gpiod::edge_event_buffer buffer(2, 16);
+
+		REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+		REQUIRE(request.read_edge_events(buffer, 1) == 1);
+		REQUIRE(buffer.records().size() == 1);
+	}
 }
 
 TEST_CASE("edge_event_buffer can be moved", "[edge-event]")
@@ -380,6 +442,42 @@ TEST_CASE("edge_event can be copied and moved", "[edge-event]")
 	}
 }
 
+TEST_CASE("edge_event is a value type", "[edge-event]")
+{
+	REQUIRE(::std::is_trivially_copyable<::gpiod::edge_event>::value);
+
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer;
+
+	auto request = chip
+		.prepare_request()
+		.add_line_settings(
+			0,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	sim.set_pull(0, pull::PULL_UP);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+	REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+	REQUIRE(request.read_edge_events(buffer) == 1);
+	auto event = buffer.get_event(0);
+
+	/* Copies don't change when the buffer is reused. */
+	sim.set_pull(0, pull::PULL_DOWN);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+	REQUIRE(request.wait_edge_events(::std::chrono::seconds(1)));
+	REQUIRE(request.read_edge_events(buffer) == 1);
+
+	REQUIRE(event.type() == event_type::RISING_EDGE);
+	REQUIRE(event.global_seqno() == 1);
+	REQUIRE(buffer.get_event(0).type() == event_type::FALLING_EDGE);
+	REQUIRE(buffer.get_event(0).global_seqno() == 2);
+	REQUIRE(buffer.get_event(0).timestamp_ns().ns() >= event.timestamp_ns().ns());
+}
+
 TEST_CASE("stream insertion operators work for edge_event and edge_event_buffer", "[edge-event]")
 {
 	/*
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <gpiod.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using edge = ::gpiod::line::edge;
+using offsets = ::gpiod::line::offsets;
+using pull = ::gpiosim::chip::pull;
+using event_type = ::gpiod::edge_event::event_type;
+
+namespace {
+
+::gpiod::line_request request_edges(::gpiod::chip& chip, const offsets& offs)
+{
+	return chip
+		.prepare_request()
+		.add_line_settings(
+			offs,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+}
+
+void pull_up_one_by_one(::gpiosim::chip& sim, const ::std::vector<unsigned int>& offs)
+{
+	for (const auto& offset: offs) {
+		::std::this_thread::sleep_for(::std::chrono::milliseconds(30));
+		sim.set_pull(offset, pull::PULL_UP);
+	}
+}
+
+TEST_CASE("event_dispatcher routes events to line handlers", "[event-dispatcher]")
+{
+	auto sim0 = make_sim().set_num_lines(8).build();
+	auto sim1 = make_sim().set_num_lines(8).build();
+
+	::gpiod::chip chip0(sim0.dev_path());
+	::gpiod::chip chip1(sim1.dev_path());
+	::gpiod::event_dispatcher dispatcher;
+	::std::vector<unsigned int> seen0, seen1, seen_default;
+
+	auto idx0 = dispatcher.add_request(request_edges(chip0, { 2, 5 }));
+	auto idx1 = dispatcher.add_request(request_edges(chip1, { 2 }));
+
+	REQUIRE(dispatcher.num_requests() == 2);
+	REQUIRE(dispatcher.get_request(idx0).offsets() == offsets({ 2, 5 }));
+
+	dispatcher.set_handler(idx0, 2, [&seen0](const ::gpiod::edge_event& event) {
+		REQUIRE(event.type() == event_type::RISING_EDGE);
+		seen0.push_back(event.line_offset());
+	});
+	dispatcher.set_handler(idx1, 2, [&seen1](const ::gpiod::edge_event& event) {
+		seen1.push_back(event.line_offset());
+	});
+	dispatcher.set_default_handler([&seen_default](const ::gpiod::edge_event& event) {
+		seen_default.push_back(event.line_offset());
+	});
+
+	::std::thread thread0(pull_up_one_by_one, ::std::ref(sim0),
+			      ::std::vector<unsigned int>({ 2, 5 }));
+	::std::thread thread1(pull_up_one_by_one, ::std::ref(sim1),
+			      ::std::vector<unsigned int>({ 2 }));
+	thread0.join();
+	thread1.join();
+
+	::std::size_t num_events = 0;
+
+	while (num_events < 3) {
+		auto ret = dispatcher.dispatch(::std::chrono::seconds(1));
+		REQUIRE(ret > 0);
+		num_events += ret;
+	}
+
+	REQUIRE(num_events == 3);
+	REQUIRE(seen0 == ::std::vector<unsigned int>({ 2 }));
+	REQUIRE(seen1 == ::std::vector<unsigned int>({ 2 }));
+	REQUIRE(seen_default == ::std::vector<unsigned int>({ 5 }));
+
+	REQUIRE(dispatcher.dispatch(::std::chrono::milliseconds(10)) == 0);
+}
+
+TEST_CASE("event_dispatcher validates the handled lines", "[event-dispatcher]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::event_dispatcher dispatcher;
+
+	auto idx = dispatcher.add_request(request_edges(chip, { 3 }));
+
+	REQUIRE_THROWS_AS(dispatcher.set_handler(idx, 4, nullptr), ::std::invalid_argument);
+	REQUIRE_THROWS_AS(dispatcher.set_handler(idx, 123, nullptr), ::std::invalid_argument);
+	REQUIRE_THROWS_AS(dispatcher.set_handler(idx + 1, 3, nullptr), ::std::out_of_range);
+}
+
+TEST_CASE("event_dispatcher propagates handler exceptions", "[event-dispatcher]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::event_dispatcher dispatcher;
+
+	auto idx = dispatcher.add_request(request_edges(chip, { 3 }));
+	dispatcher.set_handler(idx, 3, [](const ::gpiod::edge_event&) {
+		throw ::std::runtime_error("handler failed");
+	});
+
+	sim.set_pull(3, pull::PULL_UP);
+
+	REQUIRE_THROWS_AS(dispatcher.dispatch(::std::chrono::seconds(1)), ::std::runtime_error);
+}
+
+TEST_CASE("event_dispatcher can run in a dedicated thread", "[event-dispatcher]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::event_dispatcher dispatcher;
+	::std::atomic<unsigned int> num_events(0);
+
+	auto idx = dispatcher.add_request(request_edges(chip, { 1 }));
+	dispatcher.set_handler(idx, 1, [&num_events](const ::gpiod::edge_event&) {
+		num_events++;
+	});
+
+	SECTION("unpinned")
+	{
+		dispatcher.start();
+	}
+
+	SECTION("pinned to a CPU")
+	{
+		dispatcher.start(0);
+	}
+
+	REQUIRE(dispatcher.running());
+	REQUIRE_THROWS_AS(dispatcher.start(), ::std::logic_error);
+	REQUIRE_THROWS_AS(dispatcher.dispatch(::std::chrono::seconds(0)), ::std::logic_error);
+	REQUIRE_THROWS_AS(dispatcher.set_default_handler(nullptr), ::std::logic_error);
+
+	sim.set_pull(1, pull::PULL_UP);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(30));
+	sim.set_pull(1, pull::PULL_DOWN);
+
+	for (unsigned int i = 0; i < 100 && num_events < 2; i++)
+		::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+
+	dispatcher.stop();
+	REQUIRE_FALSE(dispatcher.running());
+	REQUIRE(num_events == 2);
+
+	/* Stopping again is a no-op. */
+	dispatcher.stop();
+}
+
+TEST_CASE("event_dispatcher stream insertion operator works", "[event-dispatcher]")
+{
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::event_dispatcher dispatcher;
+	::std::stringstream buf;
+
+	dispatcher.add_request(request_edges(chip, { 0 }));
+
+	buf << dispatcher;
+
+	REQUIRE(buf.str() == "gpiod::event_dispatcher(num_requests=1, running=false)");
+}
+
+} /* namespace */
@@ -61,6 +61,37 @@ TEST_CASE("Lines can be watched", "[info-event][chip]")
 		REQUIRE_THROWS_AS(chip.watch_line_info(8), ::std::invalid_argument);
 	}
 
+	SECTION("watch_line_infos() returns line infos in order")
+	{
+		auto infos = chip.watch_line_infos({ 5, 1, 3 });
+		REQUIRE(infos.size() == 3);
+		REQUIRE(infos[0].offset() == 5);
+		REQUIRE(infos[1].offset() == 1);
+		REQUIRE(infos[2].offset() == 3);
+	}
+
+	SECTION("watch_line_infos() watches nothing if any offset is invalid")
+	{
+		REQUIRE_THROWS_AS(chip.watch_line_infos({ 2, 8 }), ::std::invalid_argument);
+		/* Line 2 must have been unwatched again. */
+		REQUIRE(chip.watch_line_info(2).offset() == 2);
+	}
+
+	SECTION("watch_all_line_infos() watches every line")
+	{
+		auto infos = chip.watch_all_line_infos();
+		REQUIRE(infos.size() == 8);
+		REQUIRE(infos[6].offset() == 6);
+
+		chip.unwatch_line_infos({ 0, 6 });
+		chip.unwatch_all_line_infos();
+
+		chip.prepare_request()
+			.add_line_settings(4, ::gpiod::line_settings())
+			.do_request();
+		REQUIRE_FALSE(chip.wait_info_event(::std::chrono::milliseconds(100)));
+	}
+
 	SECTION("waiting for event timeout")
 	{
 		chip.watch_line_info(3);
@@ -151,4 +151,67 @@ TEST_CASE("line_info stream insertion operator works")
 		"active_low=false, bias=UNKNOWN, drive=PUSH_PULL, edge_detection=NONE, event_clock=MONOTONIC, debounced=false)"));
 }
 
+TEST_CASE("get_all_line_info() works", "[chip][line-info]")
+{
+	auto sim = make_sim()
+		.set_num_lines(8)
+		.set_line_name(0, "foobar")
+		.set_line_name(5, "xyz")
+		.set_hog(5, "hog", hog_dir::OUTPUT_LOW)
+		.build();
+
+	::gpiod::chip chip(sim.dev_path());
+
+	auto snapshot = chip.get_all_line_info();
+
+	SECTION("views match the line infos")
+	{
+		REQUIRE(snapshot.num_lines() == 8);
+		REQUIRE(snapshot.size() > 0);
+
+		unsigned int offset = 0;
+		for (const auto& view: snapshot) {
+			auto info = chip.get_line_info(offset);
+
+			REQUIRE(view.offset() == offset);
+			REQUIRE(::std::string(view.name()) == info.name());
+			REQUIRE(view.used() == info.used());
+			REQUIRE(::std::string(view.consumer()) == info.consumer());
+			REQUIRE(view.direction() == info.direction());
+			REQUIRE(view.bias() == info.bias());
+			REQUIRE(view.drive() == info.drive());
+			REQUIRE(view.edge_detection() == info.edge_detection());
+			REQUIRE(view.event_clock() == info.event_clock());
+			offset++;
+		}
+
+		REQUIRE(offset == 8);
+	}
+
+	SECTION("lines can be accessed by offset")
+	{
+		auto& view = snapshot.get_line_info(5);
+
+		REQUIRE(view.name() == "xyz");
+		REQUIRE(view.consumer() == "hog");
+		REQUIRE(view.direction() == direction::OUTPUT);
+		REQUIRE(snapshot.get_line_info(1).name().empty());
+		REQUIRE_THROWS_AS(snapshot.get_line_info(8), ::std::out_of_range);
+	}
+
+	SECTION("views survive moving the snapshot")
+	{
+		auto moved(::std::move(snapshot));
+
+		REQUIRE(moved.get_line_info(0).name() == "foobar");
+	}
+
+	SECTION("stream insertion operator works")
+	{
+		REQUIRE_THAT(snapshot.get_line_info(5), stringify_matcher<::gpiod::line_info_view>(
+			"gpiod::line_info_view(offset=5, name='xyz', used=true, consumer='hog', direction=OUTPUT, "
+			"active_low=false, bias=UNKNOWN, drive=PUSH_PULL, edge_detection=NONE, event_clock=MONOTONIC, debounced=false)"));
+	}
+}
+
 } /* namespace */
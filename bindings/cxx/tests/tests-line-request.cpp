@@ -1,10 +1,12 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <atomic>
 #include <catch2/catch.hpp>
 #include <gpiod.hpp>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "gpiosim.hpp"
@@ -235,6 +237,32 @@ TEST_CASE("values can be read", "[line-request]")
 		REQUIRE_THAT(vals[1], value_matcher(pull::PULL_DOWN));
 		REQUIRE_THAT(vals[2], value_matcher(pull::PULL_UP));
 	}
+
+	SECTION("get a subset of values (array variant)")
+	{
+		const ::gpiod::line::offset subset[] = { 2, 0, 6 };
+		value vals[3];
+
+		request.get_values(subset, vals, 3);
+
+		REQUIRE_THAT(vals[0], value_matcher(pull::PULL_DOWN));
+		REQUIRE_THAT(vals[1], value_matcher(pull::PULL_DOWN));
+		REQUIRE_THAT(vals[2], value_matcher(pull::PULL_UP));
+	}
+
+	SECTION("get_values() throws for more offsets than requested lines")
+	{
+		const offsets too_many({ 7, 1, 0, 6, 2, 7 });
+		values vals(too_many.size());
+
+		REQUIRE_THROWS_AS(request.get_values(too_many, vals),
+				  ::std::invalid_argument);
+	}
+
+	SECTION("get a single value that wasn't requested")
+	{
+		REQUIRE_THROWS_AS(request.get_value(3), ::std::invalid_argument);
+	}
 }
 
 TEST_CASE("output values can be set at request time", "[line-request]")
@@ -336,6 +364,19 @@ TEST_CASE("values can be set after requesting lines", "[line-request]")
 		REQUIRE(sim.get_value(4) == simval::ACTIVE);
 	}
 
+	SECTION("set a subset of values (array variant)")
+	{
+		const ::gpiod::line::offset subset[] = { 4, 3 };
+		const value vals[] = { value::ACTIVE, value::INACTIVE };
+
+		request.set_values(subset, vals, 2);
+
+		REQUIRE(sim.get_value(0) == simval::INACTIVE);
+		REQUIRE(sim.get_value(1) == simval::INACTIVE);
+		REQUIRE(sim.get_value(3) == simval::INACTIVE);
+		REQUIRE(sim.get_value(4) == simval::ACTIVE);
+	}
+
 	SECTION("set a subset of values with mappings")
 	{
 		request.set_values({
@@ -351,6 +392,322 @@ TEST_CASE("values can be set after requesting lines", "[line-request]")
 	}
 }
 
+TEST_CASE("values can be read and set from many threads", "[line-request]")
+{
+	static const unsigned int num_threads = 4;
+	static const unsigned int num_iterations = 200;
+
+	auto sim = make_sim()
+		.set_num_lines(8)
+		.build();
+
+	auto request = ::gpiod::chip(sim.dev_path())
+		.prepare_request()
+		.add_line_settings(
+			offsets({ 0, 1, 2, 3, 4, 5, 6, 7 }),
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+
+	::std::vector<::std::thread> threads;
+	::std::atomic<unsigned int> num_mismatches(0);
+
+	/* Each thread drives a disjoint pair of lines and reads it back. */
+	for (unsigned int i = 0; i < num_threads; i++) {
+		threads.emplace_back([&request, &num_mismatches, i]() {
+			const offsets offs({ i * 2, i * 2 + 1 });
+			values vals(2);
+
+			for (unsigned int j = 0; j < num_iterations; j++) {
+				auto val = j % 2 ? value::ACTIVE : value::INACTIVE;
+
+				request.set_values(offs, { val, val });
+				request.get_values(offs, vals);
+
+				if (vals[0] != val || vals[1] != val)
+					num_mismatches++;
+			}
+		});
+	}
+
+	for (auto& thread: threads)
+		thread.join();
+
+	REQUIRE(num_mismatches == 0);
+
+	/* The last iteration of every thread drove its lines high. */
+	for (unsigned int i = 0; i < 8; i++)
+		REQUIRE(sim.get_value(i) == simval::ACTIVE);
+}
+
+TEST_CASE("prepared line subsets work", "[line-request]")
+{
+	auto sim = make_sim()
+		.set_num_lines(8)
+		.build();
+
+	const offsets offs({ 0, 1, 3, 4 });
+
+	auto request = ::gpiod::chip(sim.dev_path())
+		.prepare_request()
+		.add_line_settings(
+			offs,
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+
+	SECTION("subset can be used to set and read values")
+	{
+		auto subset = request.prepare_subset({ 4, 0 });
+
+		REQUIRE(subset.num_lines() == 2);
+		REQUIRE_THAT(subset.offsets(), Catch::Equals(offsets({ 4, 0 })));
+		REQUIRE(subset.mask() == 0x9);
+
+		subset.set_values({ value::ACTIVE, value::INACTIVE });
+
+		REQUIRE(sim.get_value(0) == simval::INACTIVE);
+		REQUIRE(sim.get_value(1) == simval::INACTIVE);
+		REQUIRE(sim.get_value(3) == simval::INACTIVE);
+		REQUIRE(sim.get_value(4) == simval::ACTIVE);
+
+		REQUIRE_THAT(subset.get_values(),
+			     Catch::Equals(values({ value::ACTIVE, value::INACTIVE })));
+	}
+
+	SECTION("invalid offset")
+	{
+		REQUIRE_THROWS_AS(request.prepare_subset({ 0, 2 }), ::std::invalid_argument);
+	}
+
+	SECTION("get_values(buffer) throws for invalid buffer size")
+	{
+		auto subset = request.prepare_subset({ 1, 3 });
+		values vals(3);
+
+		REQUIRE_THROWS_AS(subset.get_values(vals), ::std::invalid_argument);
+	}
+}
+
+TEST_CASE("static line groups work", "[line-request]")
+{
+	auto sim = make_sim()
+		.set_num_lines(8)
+		.build();
+
+	const offsets offs({ 0, 1, 3, 4 });
+
+	auto request = ::gpiod::chip(sim.dev_path())
+		.prepare_request()
+		.add_line_settings(
+			offs,
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+
+	static_assert(::gpiod::static_line_group<4, 1>::num_lines == 2);
+	static_assert(::gpiod::static_line_group<4, 1>::index<1>() == 1);
+
+	SECTION("lines requested in the same order are only shifted")
+	{
+		::gpiod::static_line_group<1, 3, 4> group(request);
+
+		REQUIRE(group.mask() == 0xe);
+
+		group.set(0x5);
+		REQUIRE(sim.get_value(0) == simval::INACTIVE);
+		REQUIRE(sim.get_value(1) == simval::ACTIVE);
+		REQUIRE(sim.get_value(3) == simval::INACTIVE);
+		REQUIRE(sim.get_value(4) == simval::ACTIVE);
+		REQUIRE(group.get() == 0x5);
+	}
+
+	SECTION("lines in a different order are remapped")
+	{
+		::gpiod::static_line_group<4, 0> group(request);
+
+		REQUIRE(group.mask() == 0x9);
+
+		group.set(0x1);
+		REQUIRE(sim.get_value(0) == simval::INACTIVE);
+		REQUIRE(sim.get_value(4) == simval::ACTIVE);
+		REQUIRE(group.get() == 0x1);
+		REQUIRE(request.get_values_mask(0xf) == 0x8);
+	}
+
+	SECTION("binding to lines that weren't requested fails")
+	{
+		using unrequested = ::gpiod::static_line_group<0, 2>;
+
+		REQUIRE_THROWS_AS(unrequested(request), ::std::invalid_argument);
+	}
+}
+
+TEST_CASE("subset of lines can be reconfigured", "[line-request]")
+{
+	auto sim = make_sim()
+		.set_num_lines(8)
+		.build();
+
+	const offsets offs({ 0, 1, 3, 4 });
+
+	auto request = ::gpiod::chip(sim.dev_path())
+		.prepare_request()
+		.add_line_settings(
+			offs,
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+
+	request.set_values({
+		value::ACTIVE,
+		value::INACTIVE,
+		value::ACTIVE,
+		value::ACTIVE
+	});
+
+	SECTION("only the lines in the config are changed")
+	{
+		request.reconfigure_lines_partial(
+			::gpiod::line_config()
+				.add_line_settings(
+					3,
+					::gpiod::line_settings()
+						.set_direction(direction::INPUT)
+						.set_bias(::gpiod::line::bias::PULL_DOWN)
+				)
+		);
+
+		REQUIRE(sim.get_value(0) == simval::ACTIVE);
+		REQUIRE(sim.get_value(1) == simval::INACTIVE);
+		REQUIRE(sim.get_value(3) == simval::INACTIVE);
+		REQUIRE(sim.get_value(4) == simval::ACTIVE);
+		REQUIRE(request.get_value(3) == value::INACTIVE);
+	}
+
+	SECTION("reconfiguring lines that were not requested fails")
+	{
+		REQUIRE_THROWS_AS(
+			request.reconfigure_lines_partial(
+				::gpiod::line_config()
+					.add_line_settings(
+						2,
+						::gpiod::line_settings()
+					)
+			),
+			::std::invalid_argument
+		);
+	}
+}
+
+TEST_CASE("waiting for line values works", "[line-request]")
+{
+	auto sim = make_sim()
+		.set_num_lines(4)
+		.build();
+
+	auto request = ::gpiod::chip(sim.dev_path())
+		.prepare_request()
+		.add_line_settings(
+			{ 1, 2 },
+			::gpiod::line_settings()
+				.set_direction(direction::INPUT)
+				.set_edge_detection(::gpiod::line::edge::BOTH)
+		)
+		.do_request();
+
+	SECTION("current value satisfies the wait")
+	{
+		REQUIRE(request.wait_for_value(1, value::INACTIVE,
+					       ::std::chrono::nanoseconds(0)));
+	}
+
+	SECTION("wait times out")
+	{
+		REQUIRE_FALSE(request.wait_for_value(1, value::ACTIVE,
+						     ::std::chrono::milliseconds(10)));
+	}
+
+	SECTION("any and all of the lines")
+	{
+		::gpiod::line::value_mappings vals = {
+			{ 1, value::ACTIVE },
+			{ 2, value::ACTIVE },
+		};
+
+		sim.set_pull(1, pull::PULL_UP);
+
+		REQUIRE(request.wait_for_values(vals, ::gpiod::line_request::match::ANY,
+						::std::chrono::seconds(1)));
+		REQUIRE_FALSE(request.wait_for_values(vals,
+						      ::gpiod::line_request::match::ALL,
+						      ::std::chrono::milliseconds(10)));
+
+		sim.set_pull(2, pull::PULL_UP);
+
+		REQUIRE(request.wait_for_values(vals, ::gpiod::line_request::match::ALL,
+						::std::chrono::seconds(1)));
+	}
+
+	SECTION("line without the needed edge detection")
+	{
+		auto falling = ::gpiod::chip(sim.dev_path())
+			.prepare_request()
+			.add_line_settings(
+				3,
+				::gpiod::line_settings()
+					.set_direction(direction::INPUT)
+					.set_edge_detection(::gpiod::line::edge::FALLING)
+			)
+			.do_request();
+
+		REQUIRE_THROWS_AS(falling.wait_for_value(3, value::ACTIVE,
+							 ::std::chrono::nanoseconds(0)),
+				  ::std::invalid_argument);
+	}
+}
+
+TEST_CASE("line_request statistics count calls into the kernel", "[line-request]")
+{
+	auto sim = make_sim()
+		.set_num_lines(4)
+		.build();
+
+	auto request = ::gpiod::chip(sim.dev_path())
+		.prepare_request()
+		.add_line_settings(
+			0,
+			::gpiod::line_settings()
+				.set_direction(direction::INPUT)
+		)
+		.add_line_settings(
+			1,
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+
+	request.get_value(0);
+	request.get_value(0);
+	request.set_value(1, value::ACTIVE);
+
+	auto stats = request.get_stats();
+	REQUIRE(stats.num_get_ioctls() == 2);
+	REQUIRE(stats.num_set_ioctls() == 1);
+	REQUIRE(stats.num_reads() == 0);
+	REQUIRE(stats.ioctl_time() >= stats.max_ioctl_time());
+
+	request.reset_stats();
+
+	/* The snapshot is not affected by later changes. */
+	REQUIRE(stats.num_get_ioctls() == 2);
+	REQUIRE(request.get_stats().num_get_ioctls() == 0);
+}
+
 TEST_CASE("line_request can be moved", "[line-request]")
 {
 	auto sim = make_sim()
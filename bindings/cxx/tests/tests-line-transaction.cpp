@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <gpiod.hpp>
+#include <sstream>
+#include <stdexcept>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using direction = ::gpiod::line::direction;
+using offsets = ::gpiod::line::offsets;
+using value = ::gpiod::line::value;
+using simval = ::gpiosim::chip::value;
+using transaction = ::gpiod::line_request::transaction;
+
+namespace {
+
+::gpiod::line_request request_outputs(::gpiod::chip& chip)
+{
+	return chip
+		.prepare_request()
+		.add_line_settings(
+			offsets({ 0, 1, 2, 3 }),
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+}
+
+TEST_CASE("transactions commit phases in order", "[line-request][transaction]")
+{
+	auto sim = make_sim().set_num_lines(4).build();
+	::gpiod::chip chip(sim.dev_path());
+	auto request = request_outputs(chip);
+
+	transaction tx(request);
+
+	REQUIRE(tx.num_phases() == 0);
+
+	tx.set_value(0, value::ACTIVE)
+	  .next_phase()
+	  .set_values({ { 1, value::ACTIVE }, { 2, value::ACTIVE } })
+	  .set_values({ 1 }, { value::INACTIVE })
+	  .next_phase()
+	  .next_phase()
+	  .set_bits(0x8);
+
+	REQUIRE(tx.num_phases() == 3);
+	REQUIRE(sim.get_value(0) == simval::INACTIVE);
+
+	tx.commit();
+
+	REQUIRE(sim.get_value(0) == simval::ACTIVE);
+	REQUIRE(sim.get_value(1) == simval::INACTIVE);
+	REQUIRE(sim.get_value(2) == simval::ACTIVE);
+	REQUIRE(sim.get_value(3) == simval::ACTIVE);
+	REQUIRE(request.get_stats().num_set_ioctls() == 3);
+	REQUIRE(tx.num_phases() == 0);
+
+	SECTION("transactions can be reused")
+	{
+		tx.clear_bits(0x8).commit();
+
+		REQUIRE(sim.get_value(3) == simval::INACTIVE);
+	}
+}
+
+TEST_CASE("uncommitted changes are discarded", "[line-request][transaction]")
+{
+	auto sim = make_sim().set_num_lines(4).build();
+	::gpiod::chip chip(sim.dev_path());
+	auto request = request_outputs(chip);
+
+	SECTION("going out of scope")
+	{
+		transaction tx(request);
+
+		tx.set_bits(0xf);
+	}
+
+	SECTION("explicitly")
+	{
+		transaction tx(request);
+
+		tx.set_bits(0xf).next_phase().clear_bits(0x1);
+		tx.discard();
+
+		REQUIRE(tx.num_phases() == 0);
+		tx.commit();
+	}
+
+	REQUIRE(sim.get_value(0) == simval::INACTIVE);
+	REQUIRE(request.get_stats().num_set_ioctls() == 0);
+}
+
+TEST_CASE("transactions validate the staged lines", "[line-request][transaction]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	auto request = request_outputs(chip);
+	transaction tx(request);
+
+	REQUIRE_THROWS_AS(tx.set_value(5, value::ACTIVE), ::std::invalid_argument);
+	REQUIRE_THROWS_AS(tx.set_values_mask(0x10, 0x10), ::std::invalid_argument);
+	REQUIRE_THROWS_AS(tx.set_values({ 0, 5 }, { value::ACTIVE, value::ACTIVE }),
+			  ::std::invalid_argument);
+	REQUIRE_THROWS_AS(tx.set_values({ 0, 1 }, { value::ACTIVE }),
+			  ::std::invalid_argument);
+	REQUIRE(tx.num_phases() == 0);
+
+	request.release();
+
+	REQUIRE_THROWS_AS(transaction(request), ::gpiod::request_released);
+}
+
+TEST_CASE("transaction stream insertion operator works", "[line-request][transaction]")
+{
+	auto sim = make_sim().set_num_lines(4).build();
+	::gpiod::chip chip(sim.dev_path());
+	auto request = request_outputs(chip);
+	transaction tx(request);
+	::std::stringstream buf;
+
+	tx.set_bits(0x1).next_phase().set_bits(0x2);
+
+	buf << tx;
+
+	REQUIRE(buf.str() == "gpiod::line_request::transaction(num_phases=2)");
+}
+
+} /* namespace */
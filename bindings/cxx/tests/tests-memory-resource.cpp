@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <gpiod.hpp>
+#include <memory_resource>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using direction = ::gpiod::line::direction;
+using value = ::gpiod::line::value;
+
+namespace {
+
+class counting_resource final : public ::std::pmr::memory_resource
+{
+public:
+	::std::size_t num_allocs = 0;
+	::std::size_t num_deallocs = 0;
+
+private:
+	void* do_allocate(::std::size_t bytes, ::std::size_t alignment) override
+	{
+		this->num_allocs++;
+
+		return this->_m_arena.allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* ptr, ::std::size_t bytes, ::std::size_t alignment) override
+	{
+		this->num_deallocs++;
+
+		this->_m_arena.deallocate(ptr, bytes, alignment);
+	}
+
+	bool do_is_equal(const ::std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	::std::pmr::monotonic_buffer_resource _m_arena;
+};
+
+TEST_CASE("memory_resource_scope works", "[memory-resource]")
+{
+	counting_resource resource;
+
+	REQUIRE(::gpiod::memory_resource_scope::current() == nullptr);
+
+	SECTION("objects created in a scope are allocated from the resource")
+	{
+		{
+			::gpiod::memory_resource_scope scope(&resource);
+
+			REQUIRE(::gpiod::memory_resource_scope::current() == &resource);
+
+			::gpiod::line_settings settings;
+			settings.set_direction(direction::OUTPUT);
+			::gpiod::line_config cfg;
+			cfg.add_line_settings({ 0, 1, 2 }, settings);
+		}
+
+		REQUIRE(resource.num_allocs > 0);
+		REQUIRE(resource.num_deallocs == resource.num_allocs);
+	}
+
+	SECTION("objects may outlive the scope")
+	{
+		::gpiod::line_settings* settings;
+
+		{
+			::gpiod::memory_resource_scope scope(&resource);
+
+			settings = new ::gpiod::line_settings;
+		}
+
+		REQUIRE(::gpiod::memory_resource_scope::current() == nullptr);
+		REQUIRE(resource.num_deallocs < resource.num_allocs);
+		delete settings;
+		REQUIRE(resource.num_deallocs == resource.num_allocs);
+	}
+
+	SECTION("scopes nest")
+	{
+		counting_resource inner;
+		::gpiod::memory_resource_scope outer_scope(&resource);
+
+		{
+			::gpiod::memory_resource_scope inner_scope(&inner);
+
+			REQUIRE(::gpiod::memory_resource_scope::current() == &inner);
+			::gpiod::request_config cfg;
+		}
+
+		REQUIRE(::gpiod::memory_resource_scope::current() == &resource);
+		REQUIRE(inner.num_allocs > 0);
+		REQUIRE(resource.num_allocs == 0);
+	}
+
+	REQUIRE(::gpiod::memory_resource_scope::current() == nullptr);
+}
+
+TEST_CASE("request can be built from a memory resource", "[memory-resource]")
+{
+	auto sim = make_sim().set_num_lines(4).build();
+	::gpiod::chip chip(sim.dev_path());
+	counting_resource resource;
+	::std::size_t num_allocs;
+
+	auto builder = chip.prepare_request(&resource);
+
+	builder
+		.set_consumer("foobar")
+		.add_line_settings(
+			{ 1, 3 },
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		);
+
+	REQUIRE(resource.num_allocs > 0);
+	num_allocs = resource.num_allocs;
+
+	auto request = builder.do_request();
+
+	/* The request itself doesn't come from the resource. */
+	REQUIRE(resource.num_allocs == num_allocs);
+
+	builder = chip.prepare_request();
+	REQUIRE(resource.num_deallocs == resource.num_allocs);
+
+	request.set_value(3, value::ACTIVE);
+	REQUIRE(request.get_value(3) == value::ACTIVE);
+	REQUIRE(sim.get_value(3) == ::gpiosim::chip::value::ACTIVE);
+}
+
+} /* namespace */
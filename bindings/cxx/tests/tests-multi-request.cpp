@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <gpiod.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using direction = ::gpiod::line::direction;
+using offsets = ::gpiod::line::offsets;
+using value = ::gpiod::line::value;
+using values = ::gpiod::line::values;
+using simval = ::gpiosim::chip::value;
+
+namespace {
+
+::gpiod::line_request request_outputs(::gpiod::chip& chip, const offsets& offs)
+{
+	return chip
+		.prepare_request()
+		.add_line_settings(
+			offs,
+			::gpiod::line_settings()
+				.set_direction(direction::OUTPUT)
+		)
+		.do_request();
+}
+
+TEST_CASE("multi_request aggregates lines of many chips", "[multi-request]")
+{
+	auto sim0 = make_sim()
+		.set_num_lines(4)
+		.set_line_name(1, "foo")
+		.build();
+	auto sim1 = make_sim()
+		.set_num_lines(4)
+		.set_line_name(3, "bar")
+		.build();
+
+	::gpiod::chip chip0(sim0.dev_path());
+	::gpiod::chip chip1(sim1.dev_path());
+	::gpiod::multi_request mreq;
+
+	REQUIRE(mreq.add_request(request_outputs(chip0, { 0, 1 }), chip0) == 0);
+	REQUIRE(mreq.add_request(request_outputs(chip1, { 3, 2 }), chip1) == 1);
+
+	REQUIRE(mreq.num_requests() == 2);
+	REQUIRE(mreq.num_lines() == 4);
+	REQUIRE(mreq.get_request(1).offsets() == offsets({ 3, 2 }));
+	REQUIRE_THROWS_AS(mreq.get_request(2), ::std::out_of_range);
+
+	SECTION("lines can be found")
+	{
+		REQUIRE(mreq.find_line(1, 2) == 3);
+		REQUIRE(mreq.find_line("foo") == 1);
+		REQUIRE(mreq.find_line("bar") == 2);
+		REQUIRE_THROWS_AS(mreq.find_line(0, 3), ::std::invalid_argument);
+		REQUIRE_THROWS_AS(mreq.find_line("baz"), ::std::system_error);
+	}
+
+	SECTION("values can be set sequentially")
+	{
+		mreq.set_values({ value::ACTIVE, value::INACTIVE,
+				  value::INACTIVE, value::ACTIVE });
+
+		REQUIRE(sim0.get_value(0) == simval::ACTIVE);
+		REQUIRE(sim0.get_value(1) == simval::INACTIVE);
+		REQUIRE(sim1.get_value(3) == simval::INACTIVE);
+		REQUIRE(sim1.get_value(2) == simval::ACTIVE);
+		REQUIRE_FALSE(mreq.workers_running());
+	}
+
+	SECTION("values can be set from the workers")
+	{
+		mreq.start_workers({ 0 });
+		REQUIRE(mreq.workers_running());
+		REQUIRE_THROWS_AS(mreq.start_workers(), ::std::system_error);
+
+		mreq.set_values({ 1, 2 }, { value::ACTIVE, value::ACTIVE });
+
+		REQUIRE(sim0.get_value(1) == simval::ACTIVE);
+		REQUIRE(sim1.get_value(3) == simval::ACTIVE);
+		REQUIRE(mreq.get_values() ==
+			values({ value::INACTIVE, value::ACTIVE,
+				 value::ACTIVE, value::INACTIVE }));
+		REQUIRE(mreq.get_values({ 2 }) == values({ value::ACTIVE }));
+
+		mreq.stop_workers();
+		REQUIRE_FALSE(mreq.workers_running());
+		mreq.stop_workers();
+	}
+
+	SECTION("snapshots read all lines at once")
+	{
+		mreq.set_values({ value::ACTIVE, value::INACTIVE,
+				  value::INACTIVE, value::ACTIVE });
+		mreq.start_workers();
+
+		auto snap = mreq.take_snapshot();
+
+		REQUIRE(snap.samples.size() == 2);
+		REQUIRE(snap.samples[0].mask == 0x3);
+		REQUIRE(snap.samples[0].values == 0x1);
+		REQUIRE(snap.samples[1].values == 0x2);
+		REQUIRE(snap.samples[1].error == 0);
+		REQUIRE(snap.samples[1].before <= snap.samples[1].after);
+		REQUIRE(snap.samples[0].before >= snap.timestamp - snap.window);
+		REQUIRE(snap.samples[0].after <= snap.timestamp + snap.window);
+	}
+
+	SECTION("skew is zero for a single chip")
+	{
+		mreq.set_values({ 0 }, { value::ACTIVE });
+
+		REQUIRE(mreq.last_skew() == ::std::chrono::nanoseconds(0));
+	}
+
+	SECTION("sizes of values are validated")
+	{
+		REQUIRE_THROWS_AS(mreq.set_values({ value::ACTIVE }), ::std::invalid_argument);
+		REQUIRE_THROWS_AS(mreq.set_values({ 0, 1 }, { value::ACTIVE }),
+				  ::std::invalid_argument);
+		REQUIRE_THROWS_AS(mreq.set_values({ 4 }, { value::ACTIVE }),
+				  ::std::invalid_argument);
+	}
+}
+
+TEST_CASE("multi_request stream insertion operator works", "[multi-request]")
+{
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::multi_request mreq;
+	::std::stringstream buf;
+
+	mreq.add_request(request_outputs(chip, { 0, 1 }));
+
+	buf << mreq;
+
+	REQUIRE(buf.str() ==
+		"gpiod::multi_request(num_requests=1, num_lines=2, workers_running=false)");
+}
+
+} /* namespace */
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <gpiod.hpp>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using edge = ::gpiod::line::edge;
+using pull = ::gpiosim::chip::pull;
+using frame_error = ::gpiod::pulse_frame::error;
+
+namespace {
+
+void send_pulse(::gpiosim::chip& sim, unsigned int offset)
+{
+	sim.set_pull(offset, pull::PULL_UP);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+	sim.set_pull(offset, pull::PULL_DOWN);
+	::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+}
+
+TEST_CASE("pulse_decoder constructors validate arguments", "[pulse-decoder]")
+{
+	REQUIRE_THROWS_AS(::gpiod::pulse_decoder::wiegand(3, 3), ::std::invalid_argument);
+	REQUIRE_THROWS_AS(::gpiod::pulse_decoder::pulse_width(3, ::std::chrono::nanoseconds(0)),
+			  ::std::invalid_argument);
+
+	auto decoder = ::gpiod::pulse_decoder::wiegand(2, 3);
+
+	REQUIRE_THROWS_AS(decoder.set_pulse_width_limits(::std::chrono::microseconds(10),
+							 ::std::chrono::microseconds(5)),
+			  ::std::invalid_argument);
+	REQUIRE_FALSE(decoder.read_frame());
+	REQUIRE(decoder.num_frames() == 0);
+	REQUIRE(decoder.num_lost_frames() == 0);
+}
+
+TEST_CASE("pulse_decoder decodes wiegand frames", "[pulse-decoder]")
+{
+	auto sim = make_sim().set_num_lines(8).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer(64);
+
+	auto request = chip.prepare_request()
+		.add_line_settings(
+			{ 2, 5 },
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	auto decoder = ::gpiod::pulse_decoder::wiegand(2, 5);
+	decoder.set_frame_gap(::std::chrono::seconds(1));
+
+	send_pulse(sim, 5);
+	send_pulse(sim, 2);
+	send_pulse(sim, 5);
+	send_pulse(sim, 5);
+
+	REQUIRE(request.read_edge_events(buffer) == 8);
+	REQUIRE(decoder.add_events(buffer) == 0);
+	REQUIRE(decoder.flush(::std::numeric_limits<::std::uint64_t>::max()) == 1);
+
+	auto frame = decoder.read_frame();
+	REQUIRE(frame);
+	REQUIRE(frame->data == 0xb);
+	REQUIRE(frame->num_bits == 4);
+	REQUIRE(frame->errors == 0);
+	REQUIRE(frame->start.ns() == buffer.get_event(0).timestamp_ns().ns());
+	REQUIRE_FALSE(decoder.read_frame());
+
+	SECTION("stream insertion operator works")
+	{
+		::std::stringstream buf;
+
+		buf << *frame;
+
+		REQUIRE_THAT(buf.str(), Catch::Matchers::StartsWith(
+				"gpiod::pulse_frame(data=0xb, num_bits=4, errors=0"));
+	}
+}
+
+TEST_CASE("pulse_decoder flags timing errors", "[pulse-decoder]")
+{
+	auto sim = make_sim().set_num_lines(4).build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::edge_event_buffer buffer(16);
+
+	auto request = chip.prepare_request()
+		.add_line_settings(
+			{ 0, 1 },
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	auto decoder = ::gpiod::pulse_decoder::wiegand(0, 1);
+	decoder
+		.set_frame_gap(::std::chrono::seconds(1))
+		.set_pulse_width_limits(::std::chrono::nanoseconds(1),
+					::std::chrono::nanoseconds(2));
+
+	send_pulse(sim, 1);
+
+	REQUIRE(request.read_edge_events(buffer) == 2);
+	decoder.add_events(buffer);
+	REQUIRE(decoder.flush(::std::numeric_limits<::std::uint64_t>::max()) == 1);
+
+	auto frame = decoder.read_frame();
+	REQUIRE(frame);
+	REQUIRE(frame->num_bits == 1);
+	REQUIRE(frame->errors & frame_error::WIDTH);
+}
+
+} /* namespace */
@@ -21,6 +21,9 @@ TEST_CASE("request_config constructor works", "[request-config]")
 
 		REQUIRE(cfg.consumer().empty());
 		REQUIRE(cfg.event_buffer_size() == 0);
+		REQUIRE_FALSE(cfg.output_shadow());
+		REQUIRE_FALSE(cfg.input_shadow());
+		REQUIRE_FALSE(cfg.nonblocking());
 	}
 }
 
@@ -63,6 +66,24 @@ TEST_CASE("request_config mutators work", "[request-config]")
 		cfg.set_event_buffer_size(128);
 		REQUIRE(cfg.event_buffer_size() == 128);
 	}
+
+	SECTION("set output_shadow")
+	{
+		cfg.set_output_shadow(true);
+		REQUIRE(cfg.output_shadow());
+	}
+
+	SECTION("set input_shadow")
+	{
+		cfg.set_input_shadow(true);
+		REQUIRE(cfg.input_shadow());
+	}
+
+	SECTION("set nonblocking")
+	{
+		cfg.set_nonblocking(true);
+		REQUIRE(cfg.nonblocking());
+	}
 }
 
 TEST_CASE("request_config stream insertion operator works", "[request-config]")
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <gpiod.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using direction = ::gpiod::line::direction;
+using offsets = ::gpiod::line::offsets;
+using value = ::gpiod::line::value;
+using simval = ::gpiosim::chip::value;
+
+namespace {
+
+::gpiod::line_config make_output_config()
+{
+	::gpiod::line_config line_cfg;
+
+	line_cfg.add_line_settings(
+		{ 1, 3 },
+		::gpiod::line_settings()
+			.set_direction(direction::OUTPUT)
+			.set_output_value(value::ACTIVE)
+	);
+
+	return line_cfg;
+}
+
+TEST_CASE("request_template constructor works", "[request-template]")
+{
+	SECTION("line config only")
+	{
+		::gpiod::request_template tmpl(make_output_config());
+
+		REQUIRE(tmpl.num_lines() == 2);
+	}
+
+	SECTION("empty line config is rejected")
+	{
+		REQUIRE_THROWS_AS(::gpiod::request_template(::gpiod::line_config()),
+				  ::std::invalid_argument);
+	}
+
+	SECTION("copies share the template")
+	{
+		::gpiod::request_template tmpl(make_output_config());
+		auto copy = tmpl;
+
+		REQUIRE(copy.num_lines() == 2);
+	}
+}
+
+TEST_CASE("request_template can be applied to many chips", "[request-template][chip]")
+{
+	auto sim0 = make_sim().set_num_lines(4).build();
+	auto sim1 = make_sim().set_num_lines(4).build();
+	::gpiod::chip chip0(sim0.dev_path());
+	::gpiod::chip chip1(sim1.dev_path());
+
+	::gpiod::request_template tmpl(make_output_config(),
+				       ::gpiod::request_config().set_consumer("foobar"));
+
+	auto request0 = chip0.request_lines(tmpl);
+	auto request1 = chip1.request_lines(tmpl);
+
+	REQUIRE(request0.offsets() == offsets({ 1, 3 }));
+	REQUIRE(request1.offsets() == offsets({ 1, 3 }));
+	REQUIRE(sim0.get_value(3) == simval::ACTIVE);
+	REQUIRE(sim1.get_value(1) == simval::ACTIVE);
+	REQUIRE(sim1.get_value(2) == simval::INACTIVE);
+	REQUIRE(chip1.get_line_info(3).consumer() == "foobar");
+
+	request0.set_value(3, value::INACTIVE);
+	REQUIRE(sim0.get_value(3) == simval::INACTIVE);
+
+	SECTION("requesting the same lines again fails")
+	{
+		REQUIRE_THROWS_AS(chip0.request_lines(tmpl), ::std::system_error);
+	}
+
+	SECTION("template can be reused after release")
+	{
+		request0.release();
+
+		auto request = chip0.request_lines(tmpl);
+		REQUIRE(sim0.get_value(3) == simval::ACTIVE);
+	}
+}
+
+TEST_CASE("request_template stream insertion operator works", "[request-template]")
+{
+	::gpiod::request_template tmpl(make_output_config());
+	::std::stringstream buf;
+
+	buf << tmpl;
+
+	REQUIRE(buf.str() == "gpiod::request_template(num_lines=2)");
+}
+
+} /* namespace */
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <gpiod.hpp>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "gpiosim.hpp"
+#include "helpers.hpp"
+
+using ::gpiosim::make_sim;
+using edge = ::gpiod::line::edge;
+using pull = ::gpiosim::chip::pull;
+
+namespace {
+
+TEST_CASE("wait_cancel can be triggered and reset", "[wait-cancel]")
+{
+	::gpiod::wait_cancel cancel;
+
+	REQUIRE(cancel.fd() >= 0);
+	REQUIRE_FALSE(cancel.is_triggered());
+
+	cancel.trigger();
+	REQUIRE(cancel.is_triggered());
+
+	cancel.reset();
+	REQUIRE_FALSE(cancel.is_triggered());
+}
+
+TEST_CASE("wait_cancel can be moved", "[wait-cancel]")
+{
+	::gpiod::wait_cancel cancel;
+
+	cancel.trigger();
+
+	SECTION("move constructor")
+	{
+		auto moved(::std::move(cancel));
+
+		REQUIRE(moved.is_triggered());
+	}
+
+	SECTION("move assignment operator")
+	{
+		::gpiod::wait_cancel moved;
+
+		moved = ::std::move(cancel);
+
+		REQUIRE(moved.is_triggered());
+	}
+}
+
+TEST_CASE("edge event wait can be cancelled", "[wait-cancel]")
+{
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::wait_cancel cancel;
+
+	auto request = chip.prepare_request()
+		.add_line_settings(
+			2,
+			::gpiod::line_settings()
+				.set_edge_detection(edge::BOTH)
+		)
+		.do_request();
+
+	SECTION("returns false when cancelled from another thread")
+	{
+		::std::thread thread([&cancel]() {
+			::std::this_thread::sleep_for(::std::chrono::milliseconds(30));
+			cancel.trigger();
+		});
+
+		REQUIRE_FALSE(request.wait_edge_events(::std::chrono::seconds(5), cancel));
+		thread.join();
+	}
+
+	SECTION("pending events are reported when not cancelled")
+	{
+		sim.set_pull(2, pull::PULL_UP);
+
+		REQUIRE(request.wait_edge_events(::std::chrono::seconds(1), cancel));
+	}
+}
+
+TEST_CASE("info event wait can be cancelled", "[wait-cancel]")
+{
+	auto sim = make_sim().build();
+	::gpiod::chip chip(sim.dev_path());
+	::gpiod::wait_cancel cancel;
+
+	chip.watch_line_info(0);
+	cancel.trigger();
+
+	REQUIRE_FALSE(chip.wait_info_event(::std::chrono::seconds(5), cancel));
+}
+
+TEST_CASE("wait_cancel stream insertion operator works", "[wait-cancel]")
+{
+	::gpiod::wait_cancel cancel;
+	::std::stringstream buf;
+
+	buf << cancel;
+
+	REQUIRE(buf.str() == "gpiod::wait_cancel(triggered=false)");
+}
+
+} /* namespace */
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <ostream>
+#include <utility>
+
+#include "internal.hpp"
+
+namespace gpiod {
+
+wait_cancel::impl::impl()
+	: cancel(::gpiod_wait_cancel_new())
+{
+	if (!this->cancel)
+		throw_from_errno("unable to create the cancellation object");
+}
+
+GPIOD_CXX_API wait_cancel::wait_cancel()
+	: _m_priv(new impl)
+{
+
+}
+
+GPIOD_CXX_API wait_cancel::wait_cancel(wait_cancel&& other) noexcept
+	: _m_priv(::std::move(other._m_priv))
+{
+
+}
+
+GPIOD_CXX_API wait_cancel::~wait_cancel()
+{
+
+}
+
+GPIOD_CXX_API wait_cancel& wait_cancel::operator=(wait_cancel&& other) noexcept
+{
+	this->_m_priv = ::std::move(other._m_priv);
+
+	return *this;
+}
+
+GPIOD_CXX_API void wait_cancel::trigger()
+{
+	int ret = ::gpiod_wait_cancel_trigger(this->_m_priv->cancel.get());
+	if (ret)
+		throw_from_errno("unable to trigger the cancellation object");
+}
+
+GPIOD_CXX_API void wait_cancel::reset()
+{
+	int ret = ::gpiod_wait_cancel_reset(this->_m_priv->cancel.get());
+	if (ret)
+		throw_from_errno("unable to reset the cancellation object");
+}
+
+GPIOD_CXX_API bool wait_cancel::is_triggered() const
+{
+	return ::gpiod_wait_cancel_is_triggered(this->_m_priv->cancel.get());
+}
+
+GPIOD_CXX_API int wait_cancel::fd() const
+{
+	return ::gpiod_wait_cancel_get_fd(this->_m_priv->cancel.get());
+}
+
+GPIOD_CXX_API ::std::ostream& operator<<(::std::ostream& out, const wait_cancel& cancel)
+{
+	out << "gpiod::wait_cancel(triggered=" <<
+	       (cancel.is_triggered() ? "true" : "false") <<
+	       ")";
+
+	return out;
+}
+
+} /* namespace gpiod */
@@ -9,13 +9,17 @@ This module wraps the native C API of libgpiod in a set of python classes.
 
 from . import _ext
 from . import line
+from .capture_reader import CaptureLine, CaptureReader, CaptureRecord
 from .chip import Chip
 from .chip_info import ChipInfo
-from .edge_event import EdgeEvent
+from .edge_event import EdgeEvent, EdgeEventColumns
 from .exception import ChipClosedError, RequestReleasedError
 from .info_event import InfoEvent
+from .line_group import LineGroup
 from .line_request import LineRequest
 from .line_settings import LineSettings
+from .pulse_decoder import PulseDecoder, PulseFrame
+from .stats import Stats
 from .version import __version__
 
 api_version = _ext.api_version
@@ -35,6 +39,54 @@ def is_gpiochip_device(path: str) -> bool:
     return _ext.is_gpiochip_device(path)
 
 
+def set_default_event_buffer_capacity(capacity: int) -> None:
+    """
+    Set the initial capacity of the edge event buffers of the line requests
+    made without an explicit event_buffer_size, process-wide.
+
+    Args:
+      capacity
+        New default capacity. Clamped to 1024 events, 0 restores the built-in
+        default of 64 events.
+    """
+    _ext.set_default_event_buffer_capacity(capacity)
+
+
+def default_event_buffer_capacity() -> int:
+    """
+    Get the initial capacity of the edge event buffers of the line requests
+    made without an explicit event_buffer_size.
+
+    Returns:
+      Default capacity in events.
+    """
+    return _ext.get_default_event_buffer_capacity()
+
+
+def set_max_event_buffer_capacity(capacity: int) -> None:
+    """
+    Set the capacity up to which the edge event buffers of the line requests
+    made without an explicit event_buffer_size grow when reads fill them,
+    process-wide.
+
+    Args:
+      capacity
+        New maximum capacity. Clamped to 1024 events, 0 restores the built-in
+        maximum.
+    """
+    _ext.set_max_event_buffer_capacity(capacity)
+
+
+def max_event_buffer_capacity() -> int:
+    """
+    Get the capacity up to which adaptive edge event buffers grow.
+
+    Returns:
+      Maximum capacity in events.
+    """
+    return _ext.get_max_event_buffer_capacity()
+
+
 def request_lines(path: str, *args, **kwargs) -> LineRequest:
     """
     Open a GPIO chip pointed to by 'path', request lines according to the
@@ -0,0 +1,234 @@
+# SPDX-License-Identifier: LGPL-2.1-or-later
+# SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+from . import _ext
+from .edge_event import EdgeEvent
+from .line import Clock
+from collections.abc import Iterator
+from dataclasses import dataclass
+from typing import Optional
+
+
+@dataclass(frozen=True, repr=False)
+class CaptureLine:
+    """
+    Line recorded in a capture file.
+    """
+
+    chip_num: int
+    offset: int
+    chip_name: str
+    line_name: str
+
+    def __str__(self):
+        return "<CaptureLine chip_num={} offset={} chip_name='{}' line_name='{}'>".format(
+            self.chip_num, self.offset, self.chip_name, self.line_name
+        )
+
+
+@dataclass(frozen=True, init=False, repr=False)
+class CaptureRecord:
+    """
+    Record of an edge event in a capture file.
+    """
+
+    timestamp_ns: int
+    chip_num: int
+    offset: int
+    event_type: EdgeEvent.Type
+    global_seqno: int
+    line_seqno: int
+
+    def __init__(
+        self,
+        timestamp_ns: int,
+        chip_num: int,
+        offset: int,
+        event_type: int,
+        global_seqno: int,
+        line_seqno: int,
+    ):
+        object.__setattr__(self, "timestamp_ns", timestamp_ns)
+        object.__setattr__(self, "chip_num", chip_num)
+        object.__setattr__(self, "offset", offset)
+        object.__setattr__(self, "event_type", EdgeEvent.Type(event_type))
+        object.__setattr__(self, "global_seqno", global_seqno)
+        object.__setattr__(self, "line_seqno", line_seqno)
+
+    def __str__(self):
+        return "<CaptureRecord timestamp_ns={} chip_num={} offset={} event_type={} global_seqno={} line_seqno={}>".format(
+            self.timestamp_ns,
+            self.chip_num,
+            self.offset,
+            self.event_type,
+            self.global_seqno,
+            self.line_seqno,
+        )
+
+
+class CaptureReader:
+    """
+    Memory-maps a capture file written by 'gpiomon --capture'.
+
+    Records are indexed in the order they were written, the oldest one still
+    in the ring being at index 0. The record views returned by spans() point
+    into the mapping - no data is copied - and keep the capture mapped for as
+    long as they are alive, even after the reader is closed.
+
+    Example:
+
+        with gpiod.CaptureReader("/tmp/capture") as reader:
+            for span in reader.spans(reader.find(start_ns), reader.find(end_ns)):
+                process(span)
+    """
+
+    def __init__(self, path: str):
+        """
+        Open a capture file.
+
+        Args:
+          path:
+            Path of the capture file.
+        """
+        self._reader = _ext.CaptureReader(path)
+
+    def __bool__(self) -> bool:
+        """
+        Boolean conversion for capture readers.
+
+        Returns:
+          True if the reader is open and False if it's closed.
+        """
+        return True if self._reader else False
+
+    def __enter__(self):
+        """
+        Controlled execution enter callback.
+        """
+        self._check_closed()
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback) -> None:
+        """
+        Controlled execution exit callback.
+        """
+        self.close()
+
+    def _check_closed(self) -> None:
+        if not self._reader:
+            raise ValueError("I/O operation on closed capture reader")
+
+    def close(self) -> None:
+        """
+        Close the reader. It must no longer be used after this method is
+        called.
+        """
+        self._check_closed()
+        self._reader = None
+
+    @property
+    def event_clock(self) -> Clock:
+        """
+        Clock the timestamps of the capture come from.
+        """
+        self._check_closed()
+        return Clock(self._reader.event_clock)
+
+    @property
+    def lines(self) -> list[CaptureLine]:
+        """
+        Lines recorded in the capture.
+        """
+        self._check_closed()
+        return [CaptureLine(*line) for line in self._reader.lines]
+
+    @property
+    def num_lost(self) -> int:
+        """
+        Number of records overwritten after the ring wrapped.
+        """
+        self._check_closed()
+        return self._reader.num_lost
+
+    def __len__(self) -> int:
+        """
+        Get the number of records in the capture.
+        """
+        self._check_closed()
+        return self._reader.num_records
+
+    def __getitem__(self, index: int) -> CaptureRecord:
+        """
+        Get a record of the capture. Negative indexes count from the newest
+        record.
+        """
+        self._check_closed()
+
+        if index < 0:
+            index += self._reader.num_records
+            if index < 0:
+                raise IndexError("record index out of range")
+
+        return CaptureRecord(*self._reader.get_record(index))
+
+    def __iter__(self) -> Iterator[CaptureRecord]:
+        """
+        Iterate over all records of the capture, oldest first.
+        """
+        for index in range(len(self)):
+            yield self[index]
+
+    def find(self, timestamp_ns: int) -> int:
+        """
+        Find the first record not older than a timestamp.
+
+        Args:
+          timestamp_ns:
+            Timestamp in the clock of the capture.
+
+        Returns:
+          Index of the record or the number of records if all of them are
+          older.
+        """
+        self._check_closed()
+        return self._reader.find(timestamp_ns)
+
+    def spans(self, start: int = 0, stop: Optional[int] = None) -> Iterator[memoryview]:
+        """
+        Iterate over a range of records without copying them.
+
+        Args:
+          start:
+            Index of the first record.
+          stop:
+            Index following the last record, defaults to the number of
+            records.
+
+        Returns:
+          Iterator over read-only memoryviews of the records, at most two
+          for any range as the ring wraps only once. The records can be
+          decoded with struct.iter_unpack("<QIIIII4x", span) or viewed
+          in place by consumers of the PEP 3118 format of the views, like
+          NumPy.
+        """
+        self._check_closed()
+        reader = self._reader
+
+        if stop is None or stop > reader.num_records:
+            stop = reader.num_records
+
+        while start < stop:
+            span = reader.get_records(start)
+            if len(span) > stop - start:
+                span = span[: stop - start]
+
+            yield span
+            start += len(span)
+
+    def __str__(self):
+        if not self._reader:
+            return "<CaptureReader CLOSED>"
+
+        return "<CaptureReader num_records={} num_lost={}>".format(
+            len(self), self.num_lost
+        )
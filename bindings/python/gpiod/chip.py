@@ -5,13 +5,14 @@ from . import _ext
 from .chip_info import ChipInfo
 from .exception import ChipClosedError
 from .info_event import InfoEvent
-from .internal import poll_fd
+from .internal import poll_fd, read_when_readable
 from .line import Value
 from .line_info import LineInfo
 from .line_settings import LineSettings, _line_settings_to_ext
 from .line_request import LineRequest
+from .stats import Stats
 from collections import Counter
-from collections.abc import Iterable
+from collections.abc import AsyncIterator, Iterable
 from datetime import timedelta
 from errno import ENOENT
 from select import select
@@ -45,17 +46,25 @@ class Chip:
             do_something(chip)
     """
 
-    def __init__(self, path: str):
+    def __init__(self, path: str, name_index: bool = True):
         """
         Open a GPIO device.
 
         Args:
           path:
             Path to the GPIO character device file.
+          name_index:
+            If True, the names of all lines are read in a single pass on the
+            first lookup by name and cached in the chip object. Further lookups,
+            including those made by request_lines() and get_line_info(), don't
+            issue any system calls.
         """
         self._chip = _ext.Chip(path)
         self._info = None
 
+        if name_index:
+            self._chip.set_name_index(True)
+
     def __bool__(self) -> bool:
         """
         Boolean conversion for GPIO chips.
@@ -105,6 +114,40 @@ class Chip:
 
         return self._info
 
+    def get_stats(self) -> Stats:
+        """
+        Get the I/O statistics of the chip.
+
+        Returns:
+          New gpiod.Stats object.
+        """
+        self._check_closed()
+        return self._chip.get_stats()
+
+    def reset_stats(self) -> None:
+        """
+        Zero the I/O statistics of the chip.
+        """
+        self._check_closed()
+        self._chip.reset_stats()
+
+    def refresh_name_index(self) -> None:
+        """
+        Re-read the names of all lines of the chip and rebuild the line name
+        index. Enables the index if it was disabled.
+        """
+        self._check_closed()
+        self._chip.refresh_name_index()
+
+    def invalidate_name_index(self) -> None:
+        """
+        Drop the cached line names so that the index is rebuilt on the next
+        lookup by name. Line names are assigned by the kernel driver and don't
+        normally change while the chip is open.
+        """
+        self._check_closed()
+        self._chip.invalidate_name_index()
+
     def line_offset_from_id(self, id: Union[str, int]) -> int:
         """
         Map a line's identifier to its offset within the chip.
@@ -218,12 +261,58 @@ class Chip:
         self._check_closed()
         return self._chip.read_info_event()
 
+    def read_info_events(self, max_events: Optional[int] = None) -> list[InfoEvent]:
+        """
+        Read all line status change events pending on the chip with a single
+        system call.
+
+        Args:
+          max_events:
+            Maximum number of events to read. If None, as many events as the
+            internal buffer fits are read.
+
+        Returns:
+          List of read InfoEvent objects.
+
+        Note:
+          This function may block if there are no available events in the queue.
+        """
+        self._check_closed()
+        return self._chip.read_info_events(max_events)
+
+    async def info_events(
+        self, max_events: Optional[int] = None
+    ) -> AsyncIterator[list[InfoEvent]]:
+        """
+        Asynchronously iterate over batches of line status change events.
+
+        Args:
+          max_events:
+            Maximum number of events in a batch. See read_info_events().
+
+        Yields:
+          Lists of InfoEvent objects read whenever the chip becomes readable.
+
+        Note:
+          The chip is watched by the reader of the running asyncio event loop
+          so any number of chips and requests can be served by a single loop
+          without threads.
+        """
+        self._check_closed()
+
+        async for events in read_when_readable(
+            self.fd, lambda: self.read_info_events(max_events)
+        ):
+            yield events
+
     def request_lines(
         self,
         config: dict[tuple[Union[int, str]], Optional[LineSettings]],
         consumer: Optional[str] = None,
         event_buffer_size: Optional[int] = None,
         output_values: Optional[dict[tuple[Union[int, str]], Value]] = None,
+        nonblocking: bool = False,
+        input_shadow: bool = False,
     ) -> LineRequest:
         """
         Request a set of lines for exclusive usage.
@@ -237,10 +326,20 @@ class Chip:
             Consumer string to use for this request.
           event_buffer_size:
             Size of the kernel edge event buffer to configure for this request.
+            Also sizes the buffer the events are read into. If not set, that
+            buffer starts at default_event_buffer_capacity() events and grows
+            up to max_event_buffer_capacity() as reads fill it.
           output_values:
             Dictionary mapping offsets or names to line.Value. This can be used
             to set the desired output values globally while reusing LineSettings
             for more lines.
+          nonblocking:
+            If True, the request's file descriptor is non-blocking and
+            reading edge events returns an empty list when none are queued.
+          input_shadow:
+            If True, the values of input lines with both edges detected are
+            read once and then kept current from the edge events read from the
+            request, so reading them doesn't need a system call.
 
         Returns:
           New LineRequest object.
@@ -309,7 +408,9 @@ class Chip:
         if len(global_output_values):
             line_cfg.set_output_values(global_output_values)
 
-        req_internal = self._chip.request_lines(line_cfg, consumer, event_buffer_size)
+        req_internal = self._chip.request_lines(
+            line_cfg, consumer, event_buffer_size, nonblocking, input_shadow
+        )
         request = LineRequest(req_internal)
 
         request._offsets = req_internal.offsets
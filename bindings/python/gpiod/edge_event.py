@@ -44,3 +44,25 @@ class EdgeEvent:
             self.global_seqno,
             self.line_seqno,
         )
+
+
+@dataclass(frozen=True, repr=False)
+class EdgeEventColumns:
+    """
+    Column-wise view of a batch of edge events.
+
+    Each field is a read-only memoryview of the corresponding array kept in the
+    event buffer of the request - no data is copied. The views index the same
+    events in the same order and are overwritten by the next read from the
+    request.
+    """
+
+    timestamp_ns: memoryview
+    line_offset: memoryview
+    event_type: memoryview
+
+    def __len__(self) -> int:
+        return len(self.timestamp_ns)
+
+    def __str__(self):
+        return "<EdgeEventColumns num_events={}>".format(len(self))
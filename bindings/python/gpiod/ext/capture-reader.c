@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include "internal.h"
+
+/*
+ * The reader has no close method: the capture stays mapped until the reader
+ * object and all views of its records are gone.
+ */
+typedef struct {
+	PyObject_HEAD;
+	struct gpiod_capture_reader *reader;
+} capture_reader_object;
+
+/* Read-only buffer exporter for a contiguous span of records. */
+typedef struct {
+	PyObject_HEAD;
+	PyObject *owner;
+	const struct gpiod_capture_record *records;
+	Py_ssize_t len;
+	Py_ssize_t itemsize;
+} capture_span_object;
+
+/*
+ * PEP 3118 description of struct gpiod_capture_record. Consumers
+ * understanding it, like NumPy, can view the records as a structured array.
+ */
+static char capture_record_format[] =
+	"T{Q:timestamp_ns:I:chip_num:I:offset:I:event_type:"
+	"I:global_seqno:I:line_seqno:4x}";
+
+static int capture_span_getbuffer(capture_span_object *self, Py_buffer *view,
+				  int flags)
+{
+	if (flags & PyBUF_WRITABLE) {
+		PyErr_SetString(PyExc_BufferError,
+				"capture files are mapped read-only");
+		view->obj = NULL;
+		return -1;
+	}
+
+	view->obj = (PyObject *)self;
+	Py_INCREF(self);
+	view->buf = (void *)self->records;
+	view->len = self->len * self->itemsize;
+	view->readonly = 1;
+	view->itemsize = self->itemsize;
+	view->format = (flags & PyBUF_FORMAT) ? capture_record_format : NULL;
+	view->ndim = 1;
+	view->shape = (flags & PyBUF_ND) ? &self->len : NULL;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ?
+						&self->itemsize : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+
+	return 0;
+}
+
+static void capture_span_dealloc(capture_span_object *self)
+{
+	Py_XDECREF(self->owner);
+	PyObject_Del(self);
+}
+
+static PyBufferProcs capture_span_buffer_procs = {
+	.bf_getbuffer = (getbufferproc)capture_span_getbuffer,
+};
+
+PyTypeObject capture_span_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "gpiod._ext.CaptureSpan",
+	.tp_basicsize = sizeof(capture_span_object),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)capture_span_dealloc,
+	.tp_as_buffer = &capture_span_buffer_procs,
+};
+
+static int
+capture_reader_init(capture_reader_object *self, PyObject *args,
+		    PyObject *Py_UNUSED(ignored))
+{
+	char *path;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "s", &path);
+	if (!ret)
+		return -1;
+
+	Py_BEGIN_ALLOW_THREADS;
+	self->reader = gpiod_capture_reader_open(path);
+	Py_END_ALLOW_THREADS;
+	if (!self->reader) {
+		PyErr_SetFromErrnoWithFilename(PyExc_OSError, path);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void capture_reader_finalize(capture_reader_object *self)
+{
+	if (self->reader)
+		gpiod_capture_reader_close(self->reader);
+}
+
+static PyObject *
+capture_reader_event_clock(capture_reader_object *self,
+			   void *Py_UNUSED(ignored))
+{
+	return PyLong_FromLong(
+			gpiod_capture_reader_get_event_clock(self->reader));
+}
+
+static PyObject *
+capture_reader_num_records(capture_reader_object *self,
+			   void *Py_UNUSED(ignored))
+{
+	return PyLong_FromUnsignedLongLong(
+			gpiod_capture_reader_get_num_records(self->reader));
+}
+
+static PyObject *
+capture_reader_num_lost(capture_reader_object *self, void *Py_UNUSED(ignored))
+{
+	return PyLong_FromUnsignedLongLong(
+			gpiod_capture_reader_get_num_lost(self->reader));
+}
+
+static PyObject *
+capture_reader_lines(capture_reader_object *self, void *Py_UNUSED(ignored))
+{
+	const struct gpiod_capture_line *line;
+	PyObject *lines, *tuple;
+	size_t num_lines, i;
+
+	num_lines = gpiod_capture_reader_get_num_lines(self->reader);
+
+	lines = PyList_New(num_lines);
+	if (!lines)
+		return NULL;
+
+	for (i = 0; i < num_lines; i++) {
+		line = gpiod_capture_reader_get_line(self->reader, i);
+
+		tuple = Py_BuildValue("(IIss)", line->chip_num, line->offset,
+				      line->chip_name, line->line_name);
+		if (!tuple) {
+			Py_DECREF(lines);
+			return NULL;
+		}
+
+		PyList_SET_ITEM(lines, i, tuple);
+	}
+
+	return lines;
+}
+
+static PyGetSetDef capture_reader_getset[] = {
+	{
+		.name = "event_clock",
+		.get = (getter)capture_reader_event_clock,
+	},
+	{
+		.name = "num_records",
+		.get = (getter)capture_reader_num_records,
+	},
+	{
+		.name = "num_lost",
+		.get = (getter)capture_reader_num_lost,
+	},
+	{
+		.name = "lines",
+		.get = (getter)capture_reader_lines,
+	},
+	{ }
+};
+
+static PyObject *
+capture_reader_get_record(capture_reader_object *self, PyObject *args)
+{
+	const struct gpiod_capture_record *record;
+	unsigned long long index;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &index);
+	if (!ret)
+		return NULL;
+
+	record = gpiod_capture_reader_get_record(self->reader, index);
+	if (!record) {
+		PyErr_SetString(PyExc_IndexError, "record index out of range");
+		return NULL;
+	}
+
+	return Py_BuildValue("(KIIIII)",
+			     (unsigned long long)record->timestamp_ns,
+			     record->chip_num, record->offset,
+			     record->event_type, record->global_seqno,
+			     record->line_seqno);
+}
+
+static PyObject *
+capture_reader_get_records(capture_reader_object *self, PyObject *args)
+{
+	const struct gpiod_capture_record *records;
+	capture_span_object *span;
+	unsigned long long index;
+	PyObject *view;
+	size_t num;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &index);
+	if (!ret)
+		return NULL;
+
+	num = gpiod_capture_reader_get_records(self->reader, index, &records);
+	if (num > PY_SSIZE_T_MAX)
+		num = PY_SSIZE_T_MAX;
+
+	span = PyObject_New(capture_span_object, &capture_span_type);
+	if (!span)
+		return NULL;
+
+	Py_INCREF(self);
+	span->owner = (PyObject *)self;
+	span->records = records;
+	span->len = num;
+	span->itemsize = sizeof(struct gpiod_capture_record);
+
+	view = PyMemoryView_FromObject((PyObject *)span);
+	Py_DECREF(span);
+
+	return view;
+}
+
+static PyObject *capture_reader_find(capture_reader_object *self,
+				     PyObject *args)
+{
+	unsigned long long timestamp;
+	uint64_t index;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &timestamp);
+	if (!ret)
+		return NULL;
+
+	/* Faults on pages of the capture not read yet may block. */
+	Py_BEGIN_ALLOW_THREADS;
+	index = gpiod_capture_reader_find(self->reader, timestamp);
+	Py_END_ALLOW_THREADS;
+
+	return PyLong_FromUnsignedLongLong(index);
+}
+
+static PyMethodDef capture_reader_methods[] = {
+	{
+		.ml_name = "get_record",
+		.ml_meth = (PyCFunction)capture_reader_get_record,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "get_records",
+		.ml_meth = (PyCFunction)capture_reader_get_records,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "find",
+		.ml_meth = (PyCFunction)capture_reader_find,
+		.ml_flags = METH_VARARGS,
+	},
+	{ }
+};
+
+PyTypeObject capture_reader_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "gpiod._ext.CaptureReader",
+	.tp_basicsize = sizeof(capture_reader_object),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = PyType_GenericNew,
+	.tp_init = (initproc)capture_reader_init,
+	.tp_finalize = (destructor)capture_reader_finalize,
+	.tp_dealloc = (destructor)Py_gpiod_dealloc,
+	.tp_getset = capture_reader_getset,
+	.tp_methods = capture_reader_methods,
+};
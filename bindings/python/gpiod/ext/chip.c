@@ -1,13 +1,72 @@
 // SPDX-License-Identifier: LGPL-2.1-or-later
 // SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "internal.h"
 
 typedef struct {
 	PyObject_HEAD;
 	struct gpiod_chip *chip;
+	/*
+	 * Taken with the GIL released around all blocking calls. Reading info
+	 * events and closing the chip need it exclusively.
+	 */
+	pthread_rwlock_t lock;
+	/* Allocated on the first batched read of info events. */
+	struct gpiod_info_event_buffer *buffer;
 } chip_object;
 
+/*
+ * Must be called with the GIL released. Returns false without holding the
+ * lock if the chip was closed.
+ */
+static bool chip_lock(chip_object *self, bool exclusive)
+{
+	if (exclusive)
+		pthread_rwlock_wrlock(&self->lock);
+	else
+		pthread_rwlock_rdlock(&self->lock);
+
+	if (self->chip)
+		return true;
+
+	pthread_rwlock_unlock(&self->lock);
+	return false;
+}
+
+static void chip_unlock(chip_object *self)
+{
+	pthread_rwlock_unlock(&self->lock);
+}
+
+static PyObject *chip_set_closed_error(void)
+{
+	PyObject *type;
+
+	type = Py_gpiod_GetGlobalType("ChipClosedError");
+	if (type)
+		PyErr_SetNone(type);
+	else
+		PyErr_SetString(PyExc_ValueError, "GPIO chip was closed");
+
+	return NULL;
+}
+
+static PyObject *
+chip_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+	chip_object *self;
+
+	self = (chip_object *)PyType_GenericNew(type, args, kwargs);
+	if (self)
+		pthread_rwlock_init(&self->lock, NULL);
+
+	return (PyObject *)self;
+}
+
 static int
 chip_init(chip_object *self, PyObject *args, PyObject *Py_UNUSED(ignored))
 {
@@ -36,16 +95,51 @@ static void chip_finalize(chip_object *self)
 {
 	if (self->chip)
 		PyObject_CallMethod((PyObject *)self, "close", "");
+
+	pthread_rwlock_destroy(&self->lock);
 }
 
 static PyObject *chip_path(chip_object *self, void *Py_UNUSED(ignored))
 {
-	return PyUnicode_FromString(gpiod_chip_get_path(self->chip));
+	PyObject *path;
+	bool locked;
+	char *copy;
+
+	/* The path is freed with the chip, copy it while holding the lock. */
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, false);
+	if (locked) {
+		copy = strdup(gpiod_chip_get_path(self->chip));
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+	if (!copy)
+		return PyErr_NoMemory();
+
+	path = PyUnicode_FromString(copy);
+	free(copy);
+
+	return path;
 }
 
 static PyObject *chip_fd(chip_object *self, void *Py_UNUSED(ignored))
 {
-	return PyLong_FromLong(gpiod_chip_get_fd(self->chip));
+	bool locked;
+	int fd;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, false);
+	if (locked) {
+		fd = gpiod_chip_get_fd(self->chip);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+
+	return PyLong_FromLong(fd);
 }
 
 static PyGetSetDef chip_getset[] = {
@@ -62,10 +156,21 @@ static PyGetSetDef chip_getset[] = {
 
 static PyObject *chip_close(chip_object *self, PyObject *Py_UNUSED(ignored))
 {
+	bool locked;
+
 	Py_BEGIN_ALLOW_THREADS;
-	gpiod_chip_close(self->chip);
+	locked = chip_lock(self, true);
+	if (locked) {
+		gpiod_chip_close(self->chip);
+		self->chip = NULL;
+
+		gpiod_info_event_buffer_free(self->buffer);
+		self->buffer = NULL;
+		chip_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
-	self->chip = NULL;
+	if (!locked)
+		return chip_set_closed_error();
 
 	Py_RETURN_NONE;
 }
@@ -74,12 +179,21 @@ static PyObject *chip_get_info(chip_object *self, PyObject *Py_UNUSED(ignored))
 {
 	struct gpiod_chip_info *info;
 	PyObject *type, *ret;
+	bool locked;
 
 	type = Py_gpiod_GetGlobalType("ChipInfo");
 	if (!type)
 		return NULL;
 
-	info = gpiod_chip_get_info(self->chip);
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, false);
+	if (locked) {
+		info = gpiod_chip_get_info(self->chip);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
 	if (!info)
 		return PyErr_SetFromErrno(PyExc_OSError);
 
@@ -91,6 +205,44 @@ static PyObject *chip_get_info(chip_object *self, PyObject *Py_UNUSED(ignored))
 	 return ret;
 }
 
+static PyObject *chip_get_stats(chip_object *self, PyObject *Py_UNUSED(ignored))
+{
+	struct gpiod_stats *stats;
+	bool locked;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, false);
+	if (locked) {
+		stats = gpiod_chip_get_stats(self->chip);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+	if (!stats)
+		return PyErr_SetFromErrno(PyExc_OSError);
+
+	return Py_gpiod_MakeStats(stats);
+}
+
+static PyObject *
+chip_reset_stats(chip_object *self, PyObject *Py_UNUSED(ignored))
+{
+	bool locked;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, false);
+	if (locked) {
+		gpiod_chip_reset_stats(self->chip);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+
+	Py_RETURN_NONE;
+}
+
 static PyObject *make_line_info(struct gpiod_line_info *info)
 {
 	PyObject *type;
@@ -123,17 +275,24 @@ static PyObject *chip_get_line_info(chip_object *self, PyObject *args)
 	unsigned int offset;
 	PyObject *info_obj;
 	int ret, watch;
+	bool locked;
 
 	ret = PyArg_ParseTuple(args, "Ip", &offset, &watch);
 	if (!ret)
 		return NULL;
 
 	Py_BEGIN_ALLOW_THREADS;
-	if (watch)
-		info = gpiod_chip_watch_line_info(self->chip, offset);
-	else
-		info = gpiod_chip_get_line_info(self->chip, offset);
+	locked = chip_lock(self, false);
+	if (locked) {
+		if (watch)
+			info = gpiod_chip_watch_line_info(self->chip, offset);
+		else
+			info = gpiod_chip_get_line_info(self->chip, offset);
+		chip_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
 	if (!info)
 		return Py_gpiod_SetErrFromErrno();
 
@@ -146,6 +305,7 @@ static PyObject *
 chip_unwatch_line_info(chip_object *self, PyObject *args)
 {
 	unsigned int offset;
+	bool locked;
 	int ret;
 
 	ret = PyArg_ParseTuple(args, "I", &offset);
@@ -153,68 +313,236 @@ chip_unwatch_line_info(chip_object *self, PyObject *args)
 		return NULL;
 
 	Py_BEGIN_ALLOW_THREADS;
-	ret = gpiod_chip_unwatch_line_info(self->chip, offset);
+	locked = chip_lock(self, false);
+	if (locked) {
+		ret = gpiod_chip_unwatch_line_info(self->chip, offset);
+		chip_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
 	if (ret)
 		return Py_gpiod_SetErrFromErrno();
 
 	Py_RETURN_NONE;
 }
 
+static PyObject *make_info_event(PyObject *type, struct gpiod_info_event *event)
+{
+	PyObject *info_obj, *event_obj;
+
+	info_obj = make_line_info(gpiod_info_event_get_line_info(event));
+	if (!info_obj)
+		return NULL;
+
+	event_obj = PyObject_CallFunction(type, "iKO",
+				gpiod_info_event_get_event_type(event),
+				gpiod_info_event_get_timestamp_ns(event),
+				info_obj);
+	Py_DECREF(info_obj);
+	return event_obj;
+}
+
 static PyObject *
 chip_read_info_event(chip_object *self, PyObject *Py_UNUSED(ignored))
 {
-	PyObject *type, *info_obj, *event_obj;
 	struct gpiod_info_event *event;
-	struct gpiod_line_info *info;
+	PyObject *type, *event_obj;
+	bool locked;
 
 	type = Py_gpiod_GetGlobalType("InfoEvent");
 	if (!type)
 		return NULL;
 
 	Py_BEGIN_ALLOW_THREADS;
-	event = gpiod_chip_read_info_event(self->chip);
+	locked = chip_lock(self, true);
+	if (locked) {
+		event = gpiod_chip_read_info_event(self->chip);
+		chip_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
 	if (!event)
 		return Py_gpiod_SetErrFromErrno();
 
-	info = gpiod_info_event_get_line_info(event);
+	event_obj = make_info_event(type, event);
+	gpiod_info_event_free(event);
+	return event_obj;
+}
 
-	info_obj = make_line_info(info);
-	if (!info_obj) {
-		gpiod_info_event_free(event);
+static PyObject *chip_read_info_events(chip_object *self, PyObject *args)
+{
+	PyObject *max_events_obj, *type, *events = NULL, *event_obj;
+	struct gpiod_info_event *event;
+	size_t max_events, num_events, i;
+	bool locked;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "O", &max_events_obj);
+	if (!ret)
 		return NULL;
+
+	if (max_events_obj != Py_None) {
+		max_events = PyLong_AsSize_t(max_events_obj);
+		if (PyErr_Occurred())
+			return NULL;
+	} else {
+		max_events = 0;
 	}
 
-	event_obj = PyObject_CallFunction(type, "iKO",
-				gpiod_info_event_get_event_type(event),
-				gpiod_info_event_get_timestamp_ns(event),
-				info_obj);
-	Py_DECREF(info_obj);
-	gpiod_info_event_free(event);
-	return event_obj;
+	type = Py_gpiod_GetGlobalType("InfoEvent");
+	if (!type)
+		return NULL;
+
+	/* The lock is held on until the buffer is converted. */
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, true);
+	if (locked) {
+		/* Zero means the largest capacity the library supports. */
+		if (!self->buffer)
+			self->buffer = gpiod_info_event_buffer_new(0);
+
+		if (!self->buffer) {
+			ret = -1;
+		} else {
+			if (!max_events)
+				max_events = gpiod_info_event_buffer_get_capacity(
+								self->buffer);
+
+			ret = gpiod_chip_read_info_events(self->chip,
+							  self->buffer,
+							  max_events);
+		}
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+	if (ret < 0) {
+		Py_gpiod_SetErrFromErrno();
+		goto out_unlock;
+	}
+
+	num_events = ret;
+
+	events = PyList_New(num_events);
+	if (!events)
+		goto out_unlock;
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_info_event_buffer_get_event(self->buffer, i);
+		if (!event) {
+			Py_gpiod_SetErrFromErrno();
+			goto out_free_events;
+		}
+
+		event_obj = make_info_event(type, event);
+		if (!event_obj)
+			goto out_free_events;
+
+		PyList_SET_ITEM(events, i, event_obj);
+	}
+
+	chip_unlock(self);
+	return events;
+
+out_free_events:
+	Py_CLEAR(events);
+out_unlock:
+	chip_unlock(self);
+	return events;
 }
 
 static PyObject *chip_line_offset_from_id(chip_object *self, PyObject *args)
 {
 	int ret, offset;
+	bool locked;
 	char *name;
 
 	ret = PyArg_ParseTuple(args, "s", &name);
 	if (!ret)
 		return NULL;
 
+	/* The lookup may build the name index. */
 	Py_BEGIN_ALLOW_THREADS;
-	offset = gpiod_chip_get_line_offset_from_name(self->chip, name);
+	locked = chip_lock(self, true);
+	if (locked) {
+		offset = gpiod_chip_get_line_offset_from_name(self->chip, name);
+		chip_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
 	if (offset < 0)
 		return Py_gpiod_SetErrFromErrno();
 
 	return PyLong_FromLong(offset);
 }
 
+static PyObject *chip_set_name_index(chip_object *self, PyObject *args)
+{
+	int ret, enable;
+	bool locked;
+
+	ret = PyArg_ParseTuple(args, "p", &enable);
+	if (!ret)
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, true);
+	if (locked) {
+		gpiod_chip_set_name_index(self->chip, enable);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+chip_refresh_name_index(chip_object *self, PyObject *Py_UNUSED(ignored))
+{
+	bool locked;
+	int ret;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, true);
+	if (locked) {
+		ret = gpiod_chip_refresh_name_index(self->chip);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+chip_invalidate_name_index(chip_object *self, PyObject *Py_UNUSED(ignored))
+{
+	bool locked;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = chip_lock(self, true);
+	if (locked) {
+		gpiod_chip_invalidate_name_index(self->chip);
+		chip_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return chip_set_closed_error();
+
+	Py_RETURN_NONE;
+}
+
 static struct gpiod_request_config *
-make_request_config(PyObject *consumer_obj, PyObject *event_buffer_size_obj)
+make_request_config(PyObject *consumer_obj, PyObject *event_buffer_size_obj,
+		    int nonblocking, int input_shadow)
 {
 	struct gpiod_request_config *req_cfg;
 	size_t event_buffer_size;
@@ -247,6 +575,9 @@ make_request_config(PyObject *consumer_obj, PyObject *event_buffer_size_obj)
 							   event_buffer_size);
 	}
 
+	gpiod_request_config_set_nonblocking(req_cfg, nonblocking);
+	gpiod_request_config_set_input_shadow(req_cfg, input_shadow);
+
 	return req_cfg;
 }
 
@@ -256,10 +587,12 @@ static PyObject *chip_request_lines(chip_object *self, PyObject *args)
 	struct gpiod_request_config *req_cfg;
 	struct gpiod_line_config *line_cfg;
 	struct gpiod_line_request *request;
-	int ret;
+	int ret, nonblocking, input_shadow;
+	size_t user_buffer_size;
+	bool locked;
 
-	ret = PyArg_ParseTuple(args, "OOO",
-			       &line_config, &consumer, &event_buffer_size);
+	ret = PyArg_ParseTuple(args, "OOOpp", &line_config, &consumer,
+			       &event_buffer_size, &nonblocking, &input_shadow);
 	if (!ret)
 		return NULL;
 
@@ -267,19 +600,27 @@ static PyObject *chip_request_lines(chip_object *self, PyObject *args)
 	if (!line_cfg)
 		return NULL;
 
-	req_cfg = make_request_config(consumer, event_buffer_size);
+	req_cfg = make_request_config(consumer, event_buffer_size, nonblocking,
+				      input_shadow);
 	if (!req_cfg)
 		return NULL;
 
 	Py_BEGIN_ALLOW_THREADS;
-	request = gpiod_chip_request_lines(self->chip, req_cfg, line_cfg);
+	locked = chip_lock(self, false);
+	if (locked) {
+		request = gpiod_chip_request_lines(self->chip, req_cfg,
+						   line_cfg);
+		chip_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	user_buffer_size = gpiod_request_config_get_event_buffer_size(req_cfg);
 	gpiod_request_config_free(req_cfg);
+	if (!locked)
+		return chip_set_closed_error();
 	if (!request)
 		return Py_gpiod_SetErrFromErrno();
 
-	req_obj = Py_gpiod_MakeRequestObject(request,
-			gpiod_request_config_get_event_buffer_size(req_cfg));
+	req_obj = Py_gpiod_MakeRequestObject(request, user_buffer_size);
 	if (!req_obj)
 		gpiod_line_request_release(request);
 
@@ -297,6 +638,16 @@ static PyMethodDef chip_methods[] = {
 		.ml_meth = (PyCFunction)chip_get_info,
 		.ml_flags = METH_NOARGS,
 	},
+	{
+		.ml_name = "get_stats",
+		.ml_meth = (PyCFunction)chip_get_stats,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "reset_stats",
+		.ml_meth = (PyCFunction)chip_reset_stats,
+		.ml_flags = METH_NOARGS,
+	},
 	{
 		.ml_name = "get_line_info",
 		.ml_meth = (PyCFunction)chip_get_line_info,
@@ -312,11 +663,31 @@ static PyMethodDef chip_methods[] = {
 		.ml_meth = (PyCFunction)chip_read_info_event,
 		.ml_flags = METH_NOARGS,
 	},
+	{
+		.ml_name = "read_info_events",
+		.ml_meth = (PyCFunction)chip_read_info_events,
+		.ml_flags = METH_VARARGS,
+	},
 	{
 		.ml_name = "line_offset_from_id",
 		.ml_meth = (PyCFunction)chip_line_offset_from_id,
 		.ml_flags = METH_VARARGS,
 	},
+	{
+		.ml_name = "set_name_index",
+		.ml_meth = (PyCFunction)chip_set_name_index,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "refresh_name_index",
+		.ml_meth = (PyCFunction)chip_refresh_name_index,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "invalidate_name_index",
+		.ml_meth = (PyCFunction)chip_invalidate_name_index,
+		.ml_flags = METH_NOARGS,
+	},
 	{
 		.ml_name = "request_lines",
 		.ml_meth = (PyCFunction)chip_request_lines,
@@ -330,7 +701,7 @@ PyTypeObject chip_type = {
 	.tp_name = "gpiod._ext.Chip",
 	.tp_basicsize = sizeof(chip_object),
 	.tp_flags = Py_TPFLAGS_DEFAULT,
-	.tp_new = PyType_GenericNew,
+	.tp_new = chip_new,
 	.tp_init = (initproc)chip_init,
 	.tp_finalize = (destructor)chip_finalize,
 	.tp_dealloc = (destructor)Py_gpiod_dealloc,
@@ -90,3 +90,29 @@ unsigned int Py_gpiod_PyLongAsUnsignedInt(PyObject *pylong)
 
 	return tmp;
 }
+
+PyObject *Py_gpiod_MakeStats(struct gpiod_stats *stats)
+{
+	PyObject *type, *ret;
+
+	type = Py_gpiod_GetGlobalType("Stats");
+	if (!type) {
+		gpiod_stats_free(stats);
+		return NULL;
+	}
+
+	ret = PyObject_CallFunction(type, "KKKKKKKKKK",
+			gpiod_stats_get_num_get_ioctls(stats),
+			gpiod_stats_get_num_set_ioctls(stats),
+			gpiod_stats_get_num_config_ioctls(stats),
+			gpiod_stats_get_num_info_ioctls(stats),
+			gpiod_stats_get_num_reads(stats),
+			gpiod_stats_get_num_events_read(stats),
+			gpiod_stats_get_num_bytes_read(stats),
+			gpiod_stats_get_ioctl_time_ns(stats),
+			gpiod_stats_get_max_ioctl_time_ns(stats),
+			gpiod_stats_get_wait_time_ns(stats));
+	gpiod_stats_free(stats);
+
+	return ret;
+}
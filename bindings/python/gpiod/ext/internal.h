@@ -13,7 +13,9 @@ unsigned int Py_gpiod_PyLongAsUnsignedInt(PyObject *pylong);
 void Py_gpiod_dealloc(PyObject *self);
 PyObject *Py_gpiod_MakeRequestObject(struct gpiod_line_request *request,
 				     size_t event_buffer_size);
+PyObject *Py_gpiod_MakeStats(struct gpiod_stats *stats);
 struct gpiod_line_config *Py_gpiod_LineConfigGetData(PyObject *obj);
 struct gpiod_line_settings *Py_gpiod_LineSettingsGetData(PyObject *obj);
+struct gpiod_pulse_decoder *Py_gpiod_PulseDecoderGetData(PyObject *obj);
 
 #endif /* __LIBGPIOD_PYTHON_MODULE_H__ */
@@ -110,6 +110,26 @@ static const struct module_const module_constants[] = {
 		.name = "INFO_EVENT_TYPE_LINE_CONFIG_CHANGED",
 		.val = GPIOD_INFO_EVENT_LINE_CONFIG_CHANGED,
 	},
+	{
+		.name = "PULSE_FRAME_ERR_WIDTH",
+		.val = GPIOD_PULSE_FRAME_ERR_WIDTH,
+	},
+	{
+		.name = "PULSE_FRAME_ERR_INTERVAL",
+		.val = GPIOD_PULSE_FRAME_ERR_INTERVAL,
+	},
+	{
+		.name = "PULSE_FRAME_ERR_OVERLAP",
+		.val = GPIOD_PULSE_FRAME_ERR_OVERLAP,
+	},
+	{
+		.name = "PULSE_FRAME_ERR_LOST_EDGE",
+		.val = GPIOD_PULSE_FRAME_ERR_LOST_EDGE,
+	},
+	{
+		.name = "PULSE_FRAME_ERR_OVERFLOW",
+		.val = GPIOD_PULSE_FRAME_ERR_OVERFLOW,
+	},
 	{ }
 };
 
@@ -126,12 +146,92 @@ module_is_gpiochip_device(PyObject *Py_UNUSED(self), PyObject *args)
 	return PyBool_FromLong(gpiod_is_gpiochip_device(path));
 }
 
+static PyObject *
+module_set_default_event_buffer_capacity(PyObject *Py_UNUSED(self),
+					 PyObject *args)
+{
+	Py_ssize_t capacity;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "n", &capacity);
+	if (!ret)
+		return NULL;
+
+	if (capacity < 0) {
+		PyErr_SetString(PyExc_ValueError,
+				"capacity must not be negative");
+		return NULL;
+	}
+
+	gpiod_set_default_event_buffer_capacity(capacity);
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+module_get_default_event_buffer_capacity(PyObject *Py_UNUSED(self),
+					 PyObject *Py_UNUSED(ignored))
+{
+	return PyLong_FromSize_t(gpiod_get_default_event_buffer_capacity());
+}
+
+static PyObject *
+module_set_max_event_buffer_capacity(PyObject *Py_UNUSED(self),
+				     PyObject *args)
+{
+	Py_ssize_t capacity;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "n", &capacity);
+	if (!ret)
+		return NULL;
+
+	if (capacity < 0) {
+		PyErr_SetString(PyExc_ValueError,
+				"capacity must not be negative");
+		return NULL;
+	}
+
+	gpiod_set_max_event_buffer_capacity(capacity);
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+module_get_max_event_buffer_capacity(PyObject *Py_UNUSED(self),
+				     PyObject *Py_UNUSED(ignored))
+{
+	return PyLong_FromSize_t(gpiod_get_max_event_buffer_capacity());
+}
+
 static PyMethodDef module_methods[] = {
 	{
 		.ml_name = "is_gpiochip_device",
 		.ml_meth = (PyCFunction)module_is_gpiochip_device,
 		.ml_flags = METH_VARARGS,
 	},
+	{
+		.ml_name = "set_default_event_buffer_capacity",
+		.ml_meth = (PyCFunction)
+				module_set_default_event_buffer_capacity,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "get_default_event_buffer_capacity",
+		.ml_meth = (PyCFunction)
+				module_get_default_event_buffer_capacity,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "set_max_event_buffer_capacity",
+		.ml_meth = (PyCFunction)module_set_max_event_buffer_capacity,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "get_max_event_buffer_capacity",
+		.ml_meth = (PyCFunction)module_get_max_event_buffer_capacity,
+		.ml_flags = METH_NOARGS,
+	},
 	{ }
 };
 
@@ -141,15 +241,25 @@ static PyModuleDef module_def = {
 	.m_methods = module_methods,
 };
 
+extern PyTypeObject capture_reader_type;
+extern PyTypeObject capture_span_type;
 extern PyTypeObject chip_type;
+extern PyTypeObject edge_event_column_type;
 extern PyTypeObject line_config_type;
 extern PyTypeObject line_settings_type;
+extern PyTypeObject line_subset_type;
+extern PyTypeObject pulse_decoder_type;
 extern PyTypeObject request_type;
 
 static PyTypeObject *types[] = {
+	&capture_reader_type,
+	&capture_span_type,
 	&chip_type,
+	&edge_event_column_type,
 	&line_config_type,
 	&line_settings_type,
+	&line_subset_type,
+	&pulse_decoder_type,
 	&request_type,
 	NULL,
 };
@@ -165,6 +275,11 @@ PyMODINIT_FUNC PyInit__ext(void)
 	if (!module)
 		return NULL;
 
+#ifdef Py_GIL_DISABLED
+	/* Chips and requests serialize access to the library themselves. */
+	PyUnstable_Module_SetGIL(module, Py_MOD_GIL_NOT_USED);
+#endif
+
 	ret = PyModule_AddStringConstant(module, "api_version",
 					 gpiod_api_version());
 	if (ret) {
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include "internal.h"
+
+typedef struct {
+	PyObject_HEAD;
+	struct gpiod_pulse_decoder *decoder;
+} pulse_decoder_object;
+
+static int
+pulse_decoder_init(pulse_decoder_object *self, PyObject *args,
+		   PyObject *Py_UNUSED(ignored))
+{
+	unsigned long long arg;
+	unsigned int offset;
+	int ret, wiegand;
+
+	/* The second argument is the DATA1 offset or the 1 bit threshold. */
+	ret = PyArg_ParseTuple(args, "IKp", &offset, &arg, &wiegand);
+	if (!ret)
+		return -1;
+
+	if (wiegand && arg > UINT_MAX) {
+		PyErr_SetString(PyExc_ValueError, "value exceeding UINT_MAX");
+		return -1;
+	}
+
+	self->decoder = wiegand ?
+		gpiod_pulse_decoder_new_wiegand(offset, arg) :
+		gpiod_pulse_decoder_new_pulse_width(offset, arg);
+	if (!self->decoder) {
+		Py_gpiod_SetErrFromErrno();
+		return -1;
+	}
+
+	return 0;
+}
+
+static void pulse_decoder_finalize(pulse_decoder_object *self)
+{
+	if (self->decoder)
+		gpiod_pulse_decoder_free(self->decoder);
+}
+
+static PyObject *
+pulse_decoder_num_frames(pulse_decoder_object *self,
+			 void *Py_UNUSED(ignored))
+{
+	return PyLong_FromSize_t(
+			gpiod_pulse_decoder_get_num_frames(self->decoder));
+}
+
+static PyObject *
+pulse_decoder_num_lost_frames(pulse_decoder_object *self,
+			      void *Py_UNUSED(ignored))
+{
+	return PyLong_FromUnsignedLong(
+			gpiod_pulse_decoder_get_num_lost_frames(self->decoder));
+}
+
+static PyGetSetDef pulse_decoder_getset[] = {
+	{
+		.name = "num_frames",
+		.get = (getter)pulse_decoder_num_frames,
+	},
+	{
+		.name = "num_lost_frames",
+		.get = (getter)pulse_decoder_num_lost_frames,
+	},
+	{ }
+};
+
+static PyObject *
+pulse_decoder_set_frame_gap_ns(pulse_decoder_object *self, PyObject *args)
+{
+	unsigned long long gap;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &gap);
+	if (!ret)
+		return NULL;
+
+	gpiod_pulse_decoder_set_frame_gap_ns(self->decoder, gap);
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+pulse_decoder_set_pulse_width_limits(pulse_decoder_object *self,
+				     PyObject *args)
+{
+	unsigned long long min, max;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "KK", &min, &max);
+	if (!ret)
+		return NULL;
+
+	ret = gpiod_pulse_decoder_set_pulse_width_limits(self->decoder,
+							 min, max);
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+pulse_decoder_set_min_interval_ns(pulse_decoder_object *self, PyObject *args)
+{
+	unsigned long long interval;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &interval);
+	if (!ret)
+		return NULL;
+
+	gpiod_pulse_decoder_set_min_interval_ns(self->decoder, interval);
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *pulse_decoder_flush(pulse_decoder_object *self,
+				     PyObject *args)
+{
+	unsigned long long now;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &now);
+	if (!ret)
+		return NULL;
+
+	return PyLong_FromLong(gpiod_pulse_decoder_flush(self->decoder, now));
+}
+
+static PyObject *
+pulse_decoder_read_frames(pulse_decoder_object *self,
+			  PyObject *Py_UNUSED(ignored))
+{
+	PyObject *frames, *tuple;
+	uint64_t data, timestamp;
+	unsigned int num_bits;
+	int ret, errors;
+
+	frames = PyList_New(0);
+	if (!frames)
+		return NULL;
+
+	while (gpiod_pulse_decoder_read_frame(self->decoder, &data, &num_bits,
+					      &errors, &timestamp)) {
+		tuple = Py_BuildValue("(KIiK)", (unsigned long long)data,
+				      num_bits, errors,
+				      (unsigned long long)timestamp);
+		if (!tuple) {
+			Py_DECREF(frames);
+			return NULL;
+		}
+
+		ret = PyList_Append(frames, tuple);
+		Py_DECREF(tuple);
+		if (ret) {
+			Py_DECREF(frames);
+			return NULL;
+		}
+	}
+
+	return frames;
+}
+
+static PyObject *pulse_decoder_reset(pulse_decoder_object *self,
+				     PyObject *Py_UNUSED(ignored))
+{
+	gpiod_pulse_decoder_reset(self->decoder);
+
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef pulse_decoder_methods[] = {
+	{
+		.ml_name = "set_frame_gap_ns",
+		.ml_meth = (PyCFunction)pulse_decoder_set_frame_gap_ns,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_pulse_width_limits",
+		.ml_meth = (PyCFunction)pulse_decoder_set_pulse_width_limits,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_min_interval_ns",
+		.ml_meth = (PyCFunction)pulse_decoder_set_min_interval_ns,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "flush",
+		.ml_meth = (PyCFunction)pulse_decoder_flush,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "read_frames",
+		.ml_meth = (PyCFunction)pulse_decoder_read_frames,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "reset",
+		.ml_meth = (PyCFunction)pulse_decoder_reset,
+		.ml_flags = METH_NOARGS,
+	},
+	{ }
+};
+
+PyTypeObject pulse_decoder_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "gpiod._ext.PulseDecoder",
+	.tp_basicsize = sizeof(pulse_decoder_object),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = PyType_GenericNew,
+	.tp_init = (initproc)pulse_decoder_init,
+	.tp_finalize = (destructor)pulse_decoder_finalize,
+	.tp_dealloc = (destructor)Py_gpiod_dealloc,
+	.tp_getset = pulse_decoder_getset,
+	.tp_methods = pulse_decoder_methods,
+};
+
+struct gpiod_pulse_decoder *Py_gpiod_PulseDecoderGetData(PyObject *obj)
+{
+	pulse_decoder_object *decoder;
+	PyObject *type;
+
+	type = PyObject_Type(obj);
+	if (!type)
+		return NULL;
+
+	if ((PyTypeObject *)type != &pulse_decoder_type) {
+		PyErr_SetString(PyExc_TypeError,
+				"not a gpiod._ext.PulseDecoder object");
+		Py_DECREF(type);
+		return NULL;
+	}
+	Py_DECREF(type);
+
+	decoder = (pulse_decoder_object *)obj;
+
+	return decoder->decoder;
+}
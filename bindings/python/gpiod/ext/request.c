@@ -1,17 +1,65 @@
 // SPDX-License-Identifier: LGPL-2.1-or-later
 // SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+#include <pthread.h>
+
 #include "internal.h"
 
+/* Same as GPIO_V2_LINES_MAX, no request holds more lines. */
+#define MAX_LINES	64
+
 typedef struct {
 	PyObject_HEAD;
 	struct gpiod_line_request *request;
-	unsigned int *offsets;
-	enum gpiod_line_value *values;
+	/*
+	 * Reading and setting values may run concurrently as the library
+	 * allows it, all other calls need the request exclusively. With the
+	 * GIL released around all blocking calls - and no GIL at all in the
+	 * free-threaded build - this is what keeps the request safe to use
+	 * from many threads.
+	 */
+	pthread_rwlock_t lock;
 	size_t num_lines;
 	struct gpiod_edge_event_buffer *buffer;
 } request_object;
 
+/*
+ * Must be called with the GIL released: a thread holding the lock may need the
+ * GIL to finish its call. Returns false without holding the lock if the
+ * request was released.
+ */
+static bool request_lock(request_object *self, bool exclusive)
+{
+	if (exclusive)
+		pthread_rwlock_wrlock(&self->lock);
+	else
+		pthread_rwlock_rdlock(&self->lock);
+
+	if (self->request)
+		return true;
+
+	pthread_rwlock_unlock(&self->lock);
+	return false;
+}
+
+static void request_unlock(request_object *self)
+{
+	pthread_rwlock_unlock(&self->lock);
+}
+
+static PyObject *request_set_released_error(void)
+{
+	PyObject *type;
+
+	type = Py_gpiod_GetGlobalType("RequestReleasedError");
+	if (type)
+		PyErr_SetNone(type);
+	else
+		PyErr_SetString(PyExc_ValueError, "line request was released");
+
+	return NULL;
+}
+
 static int request_init(PyObject *Py_UNUSED(ignored0),
 			PyObject *Py_UNUSED(ignored1),
 			PyObject *Py_UNUSED(ignored2))
@@ -27,49 +75,45 @@ static void request_finalize(request_object *self)
 	if (self->request)
 		PyObject_CallMethod((PyObject *)self, "release", "");
 
-	if (self->offsets)
-		PyMem_Free(self->offsets);
-
-	if (self->values)
-		PyMem_Free(self->values);
-
 	if (self->buffer)
 		gpiod_edge_event_buffer_free(self->buffer);
+
+	pthread_rwlock_destroy(&self->lock);
 }
 
 static PyObject *
 request_num_lines(request_object *self, void *Py_UNUSED(ignored))
 {
-	return PyLong_FromUnsignedLong(
-			gpiod_line_request_get_num_requested_lines(self->request));
+	return PyLong_FromSize_t(self->num_lines);
 }
 
 static PyObject *request_offsets(request_object *self, void *Py_UNUSED(ignored))
 {
+	unsigned int offsets[MAX_LINES];
 	PyObject *lines, *line;
-	unsigned int *offsets;
 	size_t num_lines, i;
+	bool locked;
 	int ret;
 
-	num_lines = gpiod_line_request_get_num_requested_lines(self->request);
-
-	offsets = PyMem_Calloc(num_lines, sizeof(unsigned int));
-	if (!offsets)
-		return PyErr_NoMemory();
-
-	gpiod_line_request_get_requested_offsets(self->request, offsets, num_lines);
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		num_lines = gpiod_line_request_get_requested_offsets(
+					self->request, offsets, MAX_LINES);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
 
 	lines = PyList_New(num_lines);
-	if (!lines) {
-		PyMem_Free(offsets);
+	if (!lines)
 		return NULL;
-	}
 
 	for (i = 0; i < num_lines; i++) {
 		line = PyLong_FromUnsignedLong(offsets[i]);
 		if (!line) {
 			Py_DECREF(lines);
-			PyMem_Free(offsets);
 			return NULL;
 		}
 
@@ -77,18 +121,29 @@ static PyObject *request_offsets(request_object *self, void *Py_UNUSED(ignored))
 		if (ret) {
 			Py_DECREF(line);
 			Py_DECREF(lines);
-			PyMem_Free(offsets);
 			return NULL;
 		}
 	}
 
-	PyMem_Free(offsets);
 	return lines;
 }
 
 static PyObject *request_fd(request_object *self, void *Py_UNUSED(ignored))
 {
-	return PyLong_FromLong(gpiod_line_request_get_fd(self->request));
+	bool locked;
+	int fd;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		fd = gpiod_line_request_get_fd(self->request);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+
+	return PyLong_FromLong(fd);
 }
 
 static PyGetSetDef request_getset[] = {
@@ -110,70 +165,128 @@ static PyGetSetDef request_getset[] = {
 static PyObject *
 request_release(request_object *self, PyObject *Py_UNUSED(ignored))
 {
+	bool locked;
+
 	Py_BEGIN_ALLOW_THREADS;
-	gpiod_line_request_release(self->request);
+	locked = request_lock(self, true);
+	if (locked) {
+		gpiod_line_request_release(self->request);
+		self->request = NULL;
+		request_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
-	self->request = NULL;
+	if (!locked)
+		return request_set_released_error();
 
 	Py_RETURN_NONE;
 }
 
-static void clear_buffers(request_object *self)
+/*
+ * Values are staged on the stack of each call so that concurrent calls don't
+ * share any buffers.
+ */
+static int parse_value_mappings(request_object *self, PyObject *values,
+				unsigned int *offsets,
+				enum gpiod_line_value *vals)
 {
-	memset(self->offsets, 0, self->num_lines * sizeof(unsigned int));
-	memset(self->values, 0, self->num_lines * sizeof(int));
-}
+	PyObject *key, *val, *val_stripped;
+	Py_ssize_t pos = 0;
 
-static PyObject *request_get_values(request_object *self, PyObject *args)
-{
-	PyObject *offsets, *values, *val, *type, *iter, *next;
-	Py_ssize_t num_offsets, pos;
-	int ret;
+	if (PyDict_Size(values) > (Py_ssize_t)self->num_lines) {
+		PyErr_SetString(PyExc_ValueError,
+				"more values than requested lines");
+		return -1;
+	}
 
-	ret = PyArg_ParseTuple(args, "OO", &offsets, &values);
-	if (!ret)
-		return NULL;
+	while (PyDict_Next(values, &pos, &key, &val)) {
+		offsets[pos - 1] = Py_gpiod_PyLongAsUnsignedInt(key);
+		if (PyErr_Occurred())
+			return -1;
 
-	num_offsets = PyObject_Size(offsets);
-	if (num_offsets < 0)
-		return NULL;
+		val_stripped = PyObject_GetAttrString(val, "value");
+		if (!val_stripped)
+			return -1;
 
-	type = Py_gpiod_GetGlobalType("Value");
-	if (!type)
-		return NULL;
+		vals[pos - 1] = PyLong_AsLong(val_stripped);
+		Py_DECREF(val_stripped);
+		if (PyErr_Occurred())
+			return -1;
+	}
 
-	iter = PyObject_GetIter(offsets);
-	if (!iter)
-		return NULL;
+	return pos;
+}
 
-	clear_buffers(self);
+static int parse_offsets(request_object *self, PyObject *offsets_obj,
+			 unsigned int *offsets)
+{
+	PyObject *iter, *next;
+	Py_ssize_t pos;
+
+	iter = PyObject_GetIter(offsets_obj);
+	if (!iter)
+		return -1;
 
 	for (pos = 0;; pos++) {
 		next = PyIter_Next(iter);
-		if (!next) {
-			Py_DECREF(iter);
+		if (!next)
+			break;
+
+		if ((size_t)pos == self->num_lines) {
+			Py_DECREF(next);
+			PyErr_SetString(PyExc_ValueError,
+					"more offsets than requested lines");
 			break;
 		}
 
-		self->offsets[pos] = Py_gpiod_PyLongAsUnsignedInt(next);
+		offsets[pos] = Py_gpiod_PyLongAsUnsignedInt(next);
 		Py_DECREF(next);
-		if (PyErr_Occurred()) {
-			Py_DECREF(iter);
-			return NULL;
-		}
+		if (PyErr_Occurred())
+			break;
 	}
 
+	Py_DECREF(iter);
+	if (PyErr_Occurred())
+		return -1;
+
+	return pos;
+}
+
+static PyObject *request_get_values(request_object *self, PyObject *args)
+{
+	enum gpiod_line_value vals[MAX_LINES];
+	unsigned int offsets[MAX_LINES];
+	PyObject *offsets_obj, *values, *val, *type;
+	int ret, num_offsets, pos;
+	bool locked;
+
+	ret = PyArg_ParseTuple(args, "OO", &offsets_obj, &values);
+	if (!ret)
+		return NULL;
+
+	type = Py_gpiod_GetGlobalType("Value");
+	if (!type)
+		return NULL;
+
+	num_offsets = parse_offsets(self, offsets_obj, offsets);
+	if (num_offsets < 0)
+		return NULL;
+
 	Py_BEGIN_ALLOW_THREADS;
-	ret = gpiod_line_request_get_values_subset(self->request,
-						   num_offsets,
-						   self->offsets,
-						   self->values);
+	locked = request_lock(self, false);
+	if (locked) {
+		ret = gpiod_line_request_get_values_subset(self->request,
+							   num_offsets,
+							   offsets, vals);
+		request_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
 	if (ret)
 		return Py_gpiod_SetErrFromErrno();
 
 	for (pos = 0; pos < num_offsets; pos++) {
-		val = PyObject_CallFunction(type, "i", self->values[pos]);
+		val = PyObject_CallFunction(type, "i", vals[pos]);
 		if (!val)
 			return NULL;
 
@@ -189,37 +302,253 @@ static PyObject *request_get_values(request_object *self, PyObject *args)
 
 static PyObject *request_set_values(request_object *self, PyObject *args)
 {
-	PyObject *values, *key, *val, *val_stripped;
-	Py_ssize_t pos = 0;
-	int ret;
+	enum gpiod_line_value vals[MAX_LINES];
+	unsigned int offsets[MAX_LINES];
+	int ret, num_values;
+	PyObject *values;
+	bool locked;
 
 	ret = PyArg_ParseTuple(args, "O", &values);
 	if (!ret)
 		return NULL;
 
-	clear_buffers(self);
+	num_values = parse_value_mappings(self, values, offsets, vals);
+	if (num_values < 0)
+		return NULL;
 
-	while (PyDict_Next(values, &pos, &key, &val)) {
-		self->offsets[pos - 1] = Py_gpiod_PyLongAsUnsignedInt(key);
-		if (PyErr_Occurred())
-			return NULL;
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		ret = gpiod_line_request_set_values_subset(self->request,
+							   num_values,
+							   offsets, vals);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
 
-		val_stripped = PyObject_GetAttrString(val, "value");
-		if (!val_stripped)
-			return NULL;
+	Py_RETURN_NONE;
+}
 
-		self->values[pos - 1] = PyLong_AsLong(val_stripped);
-		Py_DECREF(val_stripped);
-		if (PyErr_Occurred())
+static PyObject *request_get_values_mask(request_object *self, PyObject *args)
+{
+	unsigned long long mask;
+	uint64_t values;
+	bool locked;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &mask);
+	if (!ret)
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		ret = gpiod_line_request_get_values_mask(self->request, mask,
+							 &values);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	return PyLong_FromUnsignedLongLong(values);
+}
+
+static PyObject *request_set_values_mask(request_object *self, PyObject *args)
+{
+	unsigned long long mask, values;
+	bool locked;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "KK", &mask, &values);
+	if (!ret)
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		ret = gpiod_line_request_set_values_mask(self->request, mask,
+							 values);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *request_offsets_to_mask(request_object *self, PyObject *args)
+{
+	unsigned int offsets[MAX_LINES];
+	PyObject *offsets_obj;
+	int ret, num_offsets;
+	uint64_t mask;
+	bool locked;
+
+	ret = PyArg_ParseTuple(args, "O", &offsets_obj);
+	if (!ret)
+		return NULL;
+
+	num_offsets = parse_offsets(self, offsets_obj, offsets);
+	if (num_offsets < 0)
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		ret = gpiod_line_request_offsets_to_mask(self->request,
+							 num_offsets, offsets,
+							 &mask);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	return PyLong_FromUnsignedLongLong(mask);
+}
+
+static PyObject *request_wait_for_values(request_object *self, PyObject *args)
+{
+	enum gpiod_line_value vals[MAX_LINES];
+	unsigned int offsets[MAX_LINES];
+	int ret, match_any, num_values;
+	long long timeout;
+	PyObject *values;
+	bool locked;
+
+	ret = PyArg_ParseTuple(args, "OpL", &values, &match_any, &timeout);
+	if (!ret)
+		return NULL;
+
+	num_values = parse_value_mappings(self, values, offsets, vals);
+	if (num_values < 0)
+		return NULL;
+
+	/* Reads edge events, the request is needed exclusively. */
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, true);
+	if (locked) {
+		ret = gpiod_line_request_wait_for_values_subset(self->request,
+			num_values, offsets, vals,
+			match_any ? GPIOD_LINE_MATCH_ANY : GPIOD_LINE_MATCH_ALL,
+			timeout);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret < 0)
+		return Py_gpiod_SetErrFromErrno();
+
+	return PyBool_FromLong(ret);
+}
+
+/* Each frame is a native-endian pair of 64-bit words: the mask and the bits. */
+#define FRAME_SIZE	(2 * sizeof(uint64_t))
+
+static int sequence_play(request_object *self, const char *frames,
+			 size_t num_frames, uint64_t period_ns)
+{
+	struct gpiod_waveform *waveform;
+	uint64_t mask, bits;
+	size_t i;
+	int ret;
+
+	waveform = gpiod_waveform_new();
+	if (!waveform)
+		return -1;
+
+	/* Played once, the frame i is due at i * period_ns from the start. */
+	for (i = 0; i < num_frames; i++) {
+		memcpy(&mask, frames + i * FRAME_SIZE, sizeof(mask));
+		memcpy(&bits, frames + i * FRAME_SIZE + sizeof(mask),
+		       sizeof(bits));
+
+		ret = gpiod_waveform_add_step(waveform, self->request,
+					      i * period_ns, mask, bits);
+		if (ret) {
+			gpiod_waveform_free(waveform);
+			return -1;
+		}
+	}
+
+	ret = gpiod_waveform_play(waveform);
+	gpiod_waveform_free(waveform);
+
+	return ret;
+}
+
+static PyObject *request_set_values_sequence(request_object *self,
+					     PyObject *args)
+{
+	unsigned long long period_ns;
+	uint64_t valid_mask, mask;
+	size_t num_frames, i;
+	PyObject *frames;
+	Py_buffer view;
+	bool locked;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "OK", &frames, &period_ns);
+	if (!ret)
+		return NULL;
+
+	ret = PyObject_GetBuffer(frames, &view, PyBUF_C_CONTIGUOUS);
+	if (ret)
+		return NULL;
+
+	if (view.len % FRAME_SIZE) {
+		PyErr_Format(PyExc_ValueError,
+			     "frame buffer size must be a multiple of %zu bytes",
+			     FRAME_SIZE);
+		PyBuffer_Release(&view);
+		return NULL;
+	}
+
+	num_frames = view.len / FRAME_SIZE;
+	valid_mask = self->num_lines == MAX_LINES ?
+			UINT64_MAX : (1ULL << self->num_lines) - 1;
+
+	/* Fail before the first write rather than in the middle of playback. */
+	for (i = 0; i < num_frames; i++) {
+		memcpy(&mask, (const char *)view.buf + i * FRAME_SIZE,
+		       sizeof(mask));
+		if (mask & ~valid_mask) {
+			PyErr_Format(PyExc_ValueError,
+				     "mask of frame %zu selects lines outside of the request",
+				     i);
+			PyBuffer_Release(&view);
 			return NULL;
+		}
 	}
 
+	/*
+	 * The buffer stays exported - and so can't be resized - for the entire
+	 * playback which runs without the GIL. Only values are set so other
+	 * threads may keep reading them meanwhile.
+	 */
 	Py_BEGIN_ALLOW_THREADS;
-	ret = gpiod_line_request_set_values_subset(self->request,
-						   pos,
-						   self->offsets,
-						   self->values);
+	locked = request_lock(self, false);
+	if (locked) {
+		ret = sequence_play(self, view.buf, num_frames, period_ns);
+		request_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	PyBuffer_Release(&view);
+	if (!locked)
+		return request_set_released_error();
 	if (ret)
 		return Py_gpiod_SetErrFromErrno();
 
@@ -230,6 +559,7 @@ static PyObject *request_reconfigure_lines(request_object *self, PyObject *args)
 {
 	struct gpiod_line_config *line_cfg;
 	PyObject *line_cfg_obj;
+	bool locked;
 	int ret;
 
 	ret = PyArg_ParseTuple(args, "O", &line_cfg_obj);
@@ -241,56 +571,124 @@ static PyObject *request_reconfigure_lines(request_object *self, PyObject *args)
 		return NULL;
 
 	Py_BEGIN_ALLOW_THREADS;
-	ret = gpiod_line_request_reconfigure_lines(self->request, line_cfg);
+	locked = request_lock(self, true);
+	if (locked) {
+		ret = gpiod_line_request_reconfigure_lines(self->request,
+							   line_cfg);
+		request_unlock(self);
+	}
 	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
 	if (ret)
 		return Py_gpiod_SetErrFromErrno();
 
 	Py_RETURN_NONE;
 }
 
-static PyObject *request_read_edge_events(request_object *self, PyObject *args)
+static PyObject *request_reconfigure_lines_partial(request_object *self,
+						   PyObject *args)
 {
-	PyObject *max_events_obj, *event_obj, *events, *type;
-	size_t max_events, num_events, i;
-	struct gpiod_edge_event *event;
+	struct gpiod_line_config *line_cfg;
+	PyObject *line_cfg_obj;
+	bool locked;
 	int ret;
 
-	ret = PyArg_ParseTuple(args, "O", &max_events_obj);
+	ret = PyArg_ParseTuple(args, "O", &line_cfg_obj);
 	if (!ret)
 		return NULL;
 
+	line_cfg = Py_gpiod_LineConfigGetData(line_cfg_obj);
+	if (!line_cfg)
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, true);
+	if (locked) {
+		ret = gpiod_line_request_reconfigure_lines_partial(
+						self->request, line_cfg);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	Py_RETURN_NONE;
+}
+
+/*
+ * On success, returns with the request locked exclusively so that the buffer
+ * can't change while the caller converts it. The caller must unlock it.
+ */
+static int request_read_into_buffer(request_object *self, PyObject *args)
+{
+	PyObject *max_events_obj;
+	size_t max_events;
+	bool locked;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "O", &max_events_obj);
+	if (!ret)
+		return -1;
+
 	if (max_events_obj != Py_None) {
 		max_events = PyLong_AsSize_t(max_events_obj);
 		if (PyErr_Occurred())
-			return NULL;
+			return -1;
 	} else {
-		max_events = 64;
+		/* Up to the capacity of the buffer, which may grow. */
+		max_events = SIZE_MAX;
+	}
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, true);
+	if (locked) {
+		ret = gpiod_line_request_read_edge_events(self->request,
+							  self->buffer,
+							  max_events);
+		if (ret < 0)
+			request_unlock(self);
 	}
+	Py_END_ALLOW_THREADS;
+	if (!locked) {
+		request_set_released_error();
+		return -1;
+	}
+	if (ret < 0) {
+		Py_gpiod_SetErrFromErrno();
+		return -1;
+	}
+
+	return ret;
+}
+
+static PyObject *request_read_edge_events(request_object *self, PyObject *args)
+{
+	PyObject *event_obj, *events, *type;
+	struct gpiod_edge_event *event;
+	size_t num_events, i;
+	int ret;
 
 	type = Py_gpiod_GetGlobalType("EdgeEvent");
 	if (!type)
 		return NULL;
 
-	Py_BEGIN_ALLOW_THREADS;
-	ret = gpiod_line_request_read_edge_events(self->request,
-						 self->buffer, max_events);
-	Py_END_ALLOW_THREADS;
+	ret = request_read_into_buffer(self, args);
 	if (ret < 0)
-		return Py_gpiod_SetErrFromErrno();
+		return NULL;
 
 	num_events = ret;
 
 	events = PyList_New(num_events);
 	if (!events)
-		return NULL;
+		goto out_unlock;
 
 	for (i = 0; i < num_events; i++) {
 		event = gpiod_edge_event_buffer_get_event(self->buffer, i);
-		if (!event) {
-			Py_DECREF(events);
-			return NULL;
-		}
+		if (!event)
+			goto out_free_events;
 
 		event_obj = PyObject_CallFunction(type, "iKiii",
 				gpiod_edge_event_get_event_type(event),
@@ -298,48 +696,882 @@ static PyObject *request_read_edge_events(request_object *self, PyObject *args)
 				gpiod_edge_event_get_line_offset(event),
 				gpiod_edge_event_get_global_seqno(event),
 				gpiod_edge_event_get_line_seqno(event));
-		if (!event_obj) {
-			Py_DECREF(events);
-			return NULL;
-		}
+		if (!event_obj)
+			goto out_free_events;
 
 		ret = PyList_SetItem(events, i, event_obj);
 		if (ret) {
 			Py_DECREF(event_obj);
-			Py_DECREF(events);
-			return NULL;
+			goto out_free_events;
 		}
 	}
 
+	request_unlock(self);
+	return events;
+
+out_free_events:
+	Py_DECREF(events);
+	events = NULL;
+out_unlock:
+	request_unlock(self);
 	return events;
 }
 
-static PyMethodDef request_methods[] = {
-	{
-		.ml_name = "release",
-		.ml_meth = (PyCFunction)request_release,
-		.ml_flags = METH_NOARGS,
-	},
-	{
-		.ml_name = "get_values",
-		.ml_meth = (PyCFunction)request_get_values,
-		.ml_flags = METH_VARARGS,
-	},
-	{
-		.ml_name = "set_values",
-		.ml_meth = (PyCFunction)request_set_values,
-		.ml_flags = METH_VARARGS,
-	},
-	{
+/* Feed the events of a read into a pulse decoder without converting them. */
+static PyObject *request_decode_pulses(request_object *self, PyObject *args)
+{
+	struct gpiod_pulse_decoder *decoder;
+	PyObject *decoder_obj, *max_events;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "OO", &decoder_obj, &max_events);
+	if (!ret)
+		return NULL;
+
+	decoder = Py_gpiod_PulseDecoderGetData(decoder_obj);
+	if (!decoder)
+		return NULL;
+
+	args = PyTuple_Pack(1, max_events);
+	if (!args)
+		return NULL;
+
+	ret = request_read_into_buffer(self, args);
+	Py_DECREF(args);
+	if (ret < 0)
+		return NULL;
+
+	ret = gpiod_pulse_decoder_add_events(decoder, self->buffer);
+	request_unlock(self);
+	if (ret < 0)
+		return Py_gpiod_SetErrFromErrno();
+
+	return PyLong_FromLong(ret);
+}
+
+static bool watch_accepts(struct gpiod_edge_event *event, int edge,
+			  const unsigned int *offsets, size_t num_offsets)
+{
+	enum gpiod_edge_event_type type;
+	unsigned int offset;
+	size_t i;
+
+	type = gpiod_edge_event_get_event_type(event);
+	if ((type == GPIOD_EDGE_EVENT_RISING_EDGE &&
+	     edge == GPIOD_LINE_EDGE_FALLING) ||
+	    (type == GPIOD_EDGE_EVENT_FALLING_EDGE &&
+	     edge == GPIOD_LINE_EDGE_RISING))
+		return false;
+
+	if (!offsets)
+		return true;
+
+	offset = gpiod_edge_event_get_line_offset(event);
+	for (i = 0; i < num_offsets; i++) {
+		if (offsets[i] == offset)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Turn the filtered events of the last read into a list of tuples. The whole
+ * batch is converted before any callback runs as callbacks are free to read
+ * from the request again, overwriting the buffer.
+ */
+static PyObject *watch_make_batch(request_object *self, size_t num_events,
+				  int edge, const unsigned int *offsets,
+				  size_t num_offsets)
+{
+	struct gpiod_edge_event *event;
+	PyObject *batch, *tuple;
+	size_t i;
+	int ret;
+
+	batch = PyList_New(0);
+	if (!batch)
+		return NULL;
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_edge_event_buffer_get_event(self->buffer, i);
+		if (!event) {
+			Py_DECREF(batch);
+			return Py_gpiod_SetErrFromErrno();
+		}
+
+		if (!watch_accepts(event, edge, offsets, num_offsets))
+			continue;
+
+		tuple = Py_BuildValue("(iKIkk)",
+				      gpiod_edge_event_get_event_type(event),
+				      gpiod_edge_event_get_timestamp_ns(event),
+				      gpiod_edge_event_get_line_offset(event),
+				      gpiod_edge_event_get_global_seqno(event),
+				      gpiod_edge_event_get_line_seqno(event));
+		if (!tuple) {
+			Py_DECREF(batch);
+			return NULL;
+		}
+
+		ret = PyList_Append(batch, tuple);
+		Py_DECREF(tuple);
+		if (ret) {
+			Py_DECREF(batch);
+			return NULL;
+		}
+	}
+
+	return batch;
+}
+
+/* Returns 1 to keep watching, 0 to stop and -1 on error. */
+static int watch_dispatch(PyObject *callback, PyObject *batch, int per_batch,
+			  unsigned long long *num_dispatched)
+{
+	PyObject *ret;
+	Py_ssize_t i;
+
+	if (per_batch) {
+		ret = PyObject_CallOneArg(callback, batch);
+		if (!ret)
+			return -1;
+
+		*num_dispatched += PyList_GET_SIZE(batch);
+		Py_DECREF(ret);
+		return ret == Py_False ? 0 : 1;
+	}
+
+	for (i = 0; i < PyList_GET_SIZE(batch); i++) {
+		ret = PyObject_CallOneArg(callback, PyList_GET_ITEM(batch, i));
+		if (!ret)
+			return -1;
+
+		(*num_dispatched)++;
+		Py_DECREF(ret);
+		if (ret == Py_False)
+			return 0;
+	}
+
+	return 1;
+}
+
+static PyObject *request_watch(request_object *self, PyObject *args)
+{
+	PyObject *callback, *offsets_obj, *max_events_obj, *batch;
+	int ret, num_offsets = 0, num_events, edge, per_batch;
+	unsigned long long num_dispatched = 0;
+	unsigned int offsets[MAX_LINES];
+	int keep_going = 1;
+	long long timeout;
+	size_t max_events;
+	bool locked;
+
+	ret = PyArg_ParseTuple(args, "OOiOpL", &callback, &offsets_obj, &edge,
+			       &max_events_obj, &per_batch, &timeout);
+	if (!ret)
+		return NULL;
+
+	if (!PyCallable_Check(callback)) {
+		PyErr_SetString(PyExc_TypeError, "callback must be callable");
+		return NULL;
+	}
+
+	if (max_events_obj != Py_None) {
+		max_events = PyLong_AsSize_t(max_events_obj);
+		if (PyErr_Occurred())
+			return NULL;
+	} else {
+		/* Up to the capacity of the buffer, which may grow. */
+		max_events = SIZE_MAX;
+	}
+
+	if (offsets_obj != Py_None) {
+		num_offsets = parse_offsets(self, offsets_obj, offsets);
+		if (num_offsets < 0)
+			return NULL;
+	}
+
+	while (keep_going > 0) {
+		num_events = 0;
+
+		/*
+		 * Values may be read and set while waiting, only reading the
+		 * events needs the request exclusively. The lock is held on
+		 * until the batch is converted.
+		 */
+		Py_BEGIN_ALLOW_THREADS;
+		for (;;) {
+			locked = request_lock(self, false);
+			if (!locked)
+				break;
+
+			ret = gpiod_line_request_wait_edge_events(self->request,
+								  timeout);
+			request_unlock(self);
+			if (ret <= 0)
+				break;
+
+			locked = request_lock(self, true);
+			if (!locked)
+				break;
+
+			/*
+			 * Another thread may have read the events in between,
+			 * don't block in read() holding the request.
+			 */
+			ret = gpiod_line_request_wait_edge_events(self->request,
+								  0);
+			if (ret > 0)
+				break;
+
+			request_unlock(self);
+			if (ret < 0)
+				break;
+		}
+		if (locked && ret > 0) {
+			num_events = gpiod_line_request_read_edge_events(
+					self->request, self->buffer, max_events);
+			if (num_events < 0) {
+				request_unlock(self);
+				ret = -1;
+			}
+		}
+		Py_END_ALLOW_THREADS;
+
+		/* Released by the callback or another thread. */
+		if (!locked)
+			break;
+
+		if (ret < 0) {
+			/* Let Python handlers run. KeyboardInterrupt ends the loop. */
+			if (errno == EINTR && PyErr_CheckSignals() == 0)
+				continue;
+
+			if (!PyErr_Occurred())
+				Py_gpiod_SetErrFromErrno();
+			return NULL;
+		}
+
+		/* Timed out. */
+		if (ret == 0)
+			break;
+
+		batch = watch_make_batch(self, num_events, edge,
+					 offsets_obj != Py_None ? offsets : NULL,
+					 num_offsets);
+		request_unlock(self);
+		if (!batch)
+			return NULL;
+
+		if (PyList_GET_SIZE(batch) == 0) {
+			Py_DECREF(batch);
+			continue;
+		}
+
+		keep_going = watch_dispatch(callback, batch, per_batch,
+					    &num_dispatched);
+		Py_DECREF(batch);
+		if (keep_going < 0)
+			return NULL;
+	}
+
+	return PyLong_FromUnsignedLongLong(num_dispatched);
+}
+
+/*
+ * Read-only buffer exporter for a single column or for the packed records of
+ * the edge event buffer. It holds a reference to the request object so that
+ * the memory stays valid for as long as any view of it is alive.
+ */
+typedef struct {
+	PyObject_HEAD;
+	PyObject *owner;
+	void *data;
+	Py_ssize_t len;
+	Py_ssize_t itemsize;
+	const char *format;
+} column_object;
+
+static int column_getbuffer(column_object *self, Py_buffer *view, int flags)
+{
+	if (flags & PyBUF_WRITABLE) {
+		PyErr_SetString(PyExc_BufferError,
+				"edge event buffers are read-only");
+		view->obj = NULL;
+		return -1;
+	}
+
+	view->obj = (PyObject *)self;
+	Py_INCREF(self);
+	view->buf = self->data;
+	view->len = self->len * self->itemsize;
+	view->readonly = 1;
+	view->itemsize = self->itemsize;
+	view->format = (flags & PyBUF_FORMAT) ? (char *)self->format : NULL;
+	view->ndim = 1;
+	view->shape = (flags & PyBUF_ND) ? &self->len : NULL;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ?
+						&self->itemsize : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+
+	return 0;
+}
+
+static void column_dealloc(column_object *self)
+{
+	Py_XDECREF(self->owner);
+	PyObject_Del(self);
+}
+
+static PyBufferProcs column_buffer_procs = {
+	.bf_getbuffer = (getbufferproc)column_getbuffer,
+};
+
+PyTypeObject edge_event_column_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "gpiod._ext.EdgeEventColumn",
+	.tp_basicsize = sizeof(column_object),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)column_dealloc,
+	.tp_as_buffer = &column_buffer_procs,
+};
+
+static PyObject *make_column_view(request_object *owner, const void *data,
+				  size_t num_events, size_t itemsize,
+				  const char *format)
+{
+	column_object *column;
+	PyObject *view;
+
+	if (!data)
+		return Py_gpiod_SetErrFromErrno();
+
+	column = PyObject_New(column_object, &edge_event_column_type);
+	if (!column)
+		return NULL;
+
+	Py_INCREF(owner);
+	column->owner = (PyObject *)owner;
+	column->data = (void *)data;
+	column->len = num_events;
+	column->itemsize = itemsize;
+	column->format = format;
+
+	view = PyMemoryView_FromObject((PyObject *)column);
+	Py_DECREF(column);
+
+	return view;
+}
+
+static PyObject *
+request_read_edge_event_columns(request_object *self, PyObject *args)
+{
+	PyObject *timestamps, *offsets, *types;
+	const enum gpiod_edge_event_type *type_data;
+	const unsigned int *offset_data;
+	const uint64_t *timestamp_data;
+	size_t num_events;
+	int ret, error;
+
+	ret = request_read_into_buffer(self, args);
+	if (ret < 0)
+		return NULL;
+
+	/*
+	 * Decoding the columns writes to the buffer, it must be done before
+	 * another read can start. The views stay valid until the next read.
+	 */
+	timestamp_data = gpiod_edge_event_buffer_get_timestamps_ns(self->buffer);
+	offset_data = gpiod_edge_event_buffer_get_line_offsets(self->buffer);
+	type_data = gpiod_edge_event_buffer_get_event_types(self->buffer);
+	error = errno;
+	request_unlock(self);
+	num_events = ret;
+
+	errno = error;
+	timestamps = make_column_view(self, timestamp_data, num_events,
+				      sizeof(uint64_t), "Q");
+	if (!timestamps)
+		return NULL;
+
+	offsets = make_column_view(self, offset_data, num_events,
+				   sizeof(unsigned int), "I");
+	if (!offsets) {
+		Py_DECREF(timestamps);
+		return NULL;
+	}
+
+	types = make_column_view(self, type_data, num_events,
+				 sizeof(enum gpiod_edge_event_type), "i");
+	if (!types) {
+		Py_DECREF(offsets);
+		Py_DECREF(timestamps);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NNN)", timestamps, offsets, types);
+}
+
+/*
+ * PEP 3118 description of struct gpiod_edge_event_record. Consumers
+ * understanding it, like NumPy, can view the records as a structured array.
+ */
+static const char edge_event_record_format[] =
+	"T{Q:timestamp_ns:I:event_type:I:line_offset:"
+	"I:global_seqno:I:line_seqno:24x}";
+
+static PyObject *
+request_read_edge_events_raw(request_object *self, PyObject *args)
+{
+	const struct gpiod_edge_event_record *records;
+	int ret;
+
+	ret = request_read_into_buffer(self, args);
+	if (ret < 0)
+		return NULL;
+
+	/* Adaptive buffers move their events when growing before a read. */
+	records = gpiod_edge_event_buffer_get_records(self->buffer);
+	request_unlock(self);
+
+	return make_column_view(self, records, ret,
+				sizeof(struct gpiod_edge_event_record),
+				edge_event_record_format);
+}
+
+/*
+ * Prepared subset of the requested lines. Values are passed as bitmasks or as
+ * sequences of the cached Value members so that no Python-level lookups are
+ * needed on every call.
+ */
+typedef struct {
+	PyObject_HEAD;
+	request_object *owner;
+	struct gpiod_line_subset *subset;
+	size_t num_lines;
+	/* Value.INACTIVE and Value.ACTIVE. */
+	PyObject *value_objs[2];
+} subset_object;
+
+static int subset_get(subset_object *self, enum gpiod_line_value *values)
+{
+	bool locked;
+	int ret;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self->owner, false);
+	if (locked) {
+		ret = gpiod_line_subset_get_values(self->subset, values);
+		request_unlock(self->owner);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked) {
+		request_set_released_error();
+		return -1;
+	}
+	if (ret) {
+		Py_gpiod_SetErrFromErrno();
+		return -1;
+	}
+
+	return 0;
+}
+
+static PyObject *subset_get_bits(subset_object *self,
+				 PyObject *Py_UNUSED(ignored))
+{
+	enum gpiod_line_value values[MAX_LINES];
+	unsigned long long bits = 0;
+	size_t i;
+
+	if (subset_get(self, values))
+		return NULL;
+
+	for (i = 0; i < self->num_lines; i++) {
+		if (values[i] == GPIOD_LINE_VALUE_ACTIVE)
+			bits |= 1ULL << i;
+	}
+
+	return PyLong_FromUnsignedLongLong(bits);
+}
+
+static PyObject *subset_get_values(subset_object *self, PyObject *args)
+{
+	enum gpiod_line_value vals[MAX_LINES];
+	PyObject *values, *val;
+	size_t i;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "O", &values);
+	if (!ret)
+		return NULL;
+
+	if (PySequence_Size(values) != (Py_ssize_t)self->num_lines) {
+		if (!PyErr_Occurred())
+			PyErr_SetString(PyExc_ValueError,
+					"sequence must have one item per line");
+		return NULL;
+	}
+
+	if (subset_get(self, vals))
+		return NULL;
+
+	for (i = 0; i < self->num_lines; i++) {
+		val = self->value_objs[vals[i] == GPIOD_LINE_VALUE_ACTIVE];
+
+		ret = PySequence_SetItem(values, i, val);
+		if (ret)
+			return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *subset_set(subset_object *self,
+			    const enum gpiod_line_value *values)
+{
+	bool locked;
+	int ret;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self->owner, false);
+	if (locked) {
+		ret = gpiod_line_subset_set_values(self->subset, values);
+		request_unlock(self->owner);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (ret)
+		return Py_gpiod_SetErrFromErrno();
+
+	Py_RETURN_NONE;
+}
+
+static PyObject *subset_set_bits(subset_object *self, PyObject *args)
+{
+	enum gpiod_line_value values[MAX_LINES];
+	unsigned long long bits;
+	size_t i;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "K", &bits);
+	if (!ret)
+		return NULL;
+
+	if (self->num_lines < 64 && (bits >> self->num_lines)) {
+		PyErr_SetString(PyExc_ValueError,
+				"bits set past the last line of the group");
+		return NULL;
+	}
+
+	for (i = 0; i < self->num_lines; i++)
+		values[i] = (bits >> i) & 1 ? GPIOD_LINE_VALUE_ACTIVE :
+					      GPIOD_LINE_VALUE_INACTIVE;
+
+	return subset_set(self, values);
+}
+
+static PyObject *subset_set_values(subset_object *self, PyObject *args)
+{
+	enum gpiod_line_value vals[MAX_LINES];
+	PyObject *values, *fast, *val, *val_stripped;
+	size_t i;
+	int ret;
+
+	ret = PyArg_ParseTuple(args, "O", &values);
+	if (!ret)
+		return NULL;
+
+	fast = PySequence_Fast(values, "values must be a sequence");
+	if (!fast)
+		return NULL;
+
+	if (PySequence_Fast_GET_SIZE(fast) != (Py_ssize_t)self->num_lines) {
+		Py_DECREF(fast);
+		PyErr_SetString(PyExc_ValueError,
+				"sequence must have one item per line");
+		return NULL;
+	}
+
+	for (i = 0; i < self->num_lines; i++) {
+		val = PySequence_Fast_GET_ITEM(fast, i);
+
+		/* Identity checks catch the common case without a lookup. */
+		if (val == self->value_objs[GPIOD_LINE_VALUE_ACTIVE]) {
+			vals[i] = GPIOD_LINE_VALUE_ACTIVE;
+			continue;
+		} else if (val == self->value_objs[GPIOD_LINE_VALUE_INACTIVE]) {
+			vals[i] = GPIOD_LINE_VALUE_INACTIVE;
+			continue;
+		}
+
+		val_stripped = PyObject_GetAttrString(val, "value");
+		if (!val_stripped) {
+			Py_DECREF(fast);
+			return NULL;
+		}
+
+		vals[i] = PyObject_IsTrue(val_stripped) ?
+						GPIOD_LINE_VALUE_ACTIVE :
+						GPIOD_LINE_VALUE_INACTIVE;
+		Py_DECREF(val_stripped);
+	}
+
+	Py_DECREF(fast);
+
+	return subset_set(self, vals);
+}
+
+static PyObject *subset_num_lines(subset_object *self,
+				  void *Py_UNUSED(ignored))
+{
+	return PyLong_FromSize_t(self->num_lines);
+}
+
+static PyGetSetDef subset_getset[] = {
+	{
+		.name = "num_lines",
+		.get = (getter)subset_num_lines,
+	},
+	{ }
+};
+
+static PyMethodDef subset_methods[] = {
+	{
+		.ml_name = "get_bits",
+		.ml_meth = (PyCFunction)subset_get_bits,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "get_values",
+		.ml_meth = (PyCFunction)subset_get_values,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_bits",
+		.ml_meth = (PyCFunction)subset_set_bits,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_values",
+		.ml_meth = (PyCFunction)subset_set_values,
+		.ml_flags = METH_VARARGS,
+	},
+	{ }
+};
+
+static void subset_dealloc(subset_object *self)
+{
+	gpiod_line_subset_free(self->subset);
+	Py_XDECREF(self->value_objs[0]);
+	Py_XDECREF(self->value_objs[1]);
+	Py_XDECREF(self->owner);
+	PyObject_Del(self);
+}
+
+PyTypeObject line_subset_type = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "gpiod._ext.LineSubset",
+	.tp_basicsize = sizeof(subset_object),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_dealloc = (destructor)subset_dealloc,
+	.tp_getset = subset_getset,
+	.tp_methods = subset_methods,
+};
+
+static PyObject *request_prepare_subset(request_object *self, PyObject *args)
+{
+	unsigned int offsets[MAX_LINES];
+	PyObject *offsets_obj, *type;
+	struct gpiod_line_subset *data;
+	subset_object *subset;
+	int ret, num_offsets;
+	bool locked;
+
+	ret = PyArg_ParseTuple(args, "O", &offsets_obj);
+	if (!ret)
+		return NULL;
+
+	type = Py_gpiod_GetGlobalType("Value");
+	if (!type)
+		return NULL;
+
+	num_offsets = parse_offsets(self, offsets_obj, offsets);
+	if (num_offsets < 0)
+		return NULL;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		data = gpiod_line_request_prepare_subset(self->request,
+							 num_offsets, offsets);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (!data)
+		return Py_gpiod_SetErrFromErrno();
+
+	subset = PyObject_New(subset_object, &line_subset_type);
+	if (!subset) {
+		gpiod_line_subset_free(data);
+		return NULL;
+	}
+
+	Py_INCREF(self);
+	subset->owner = self;
+	subset->subset = data;
+	subset->num_lines = num_offsets;
+	subset->value_objs[0] = subset->value_objs[1] = NULL;
+
+	subset->value_objs[GPIOD_LINE_VALUE_INACTIVE] =
+				PyObject_CallFunction(type, "i",
+						      GPIOD_LINE_VALUE_INACTIVE);
+	subset->value_objs[GPIOD_LINE_VALUE_ACTIVE] =
+				PyObject_CallFunction(type, "i",
+						      GPIOD_LINE_VALUE_ACTIVE);
+	if (!subset->value_objs[0] || !subset->value_objs[1]) {
+		Py_DECREF(subset);
+		return NULL;
+	}
+
+	return (PyObject *)subset;
+}
+
+static PyObject *
+request_get_stats(request_object *self, PyObject *Py_UNUSED(ignored))
+{
+	struct gpiod_stats *stats;
+	bool locked;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		stats = gpiod_line_request_get_stats(self->request);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+	if (!stats)
+		return PyErr_SetFromErrno(PyExc_OSError);
+
+	return Py_gpiod_MakeStats(stats);
+}
+
+static PyObject *
+request_reset_stats(request_object *self, PyObject *Py_UNUSED(ignored))
+{
+	bool locked;
+
+	Py_BEGIN_ALLOW_THREADS;
+	locked = request_lock(self, false);
+	if (locked) {
+		gpiod_line_request_reset_stats(self->request);
+		request_unlock(self);
+	}
+	Py_END_ALLOW_THREADS;
+	if (!locked)
+		return request_set_released_error();
+
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef request_methods[] = {
+	{
+		.ml_name = "release",
+		.ml_meth = (PyCFunction)request_release,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "get_values",
+		.ml_meth = (PyCFunction)request_get_values,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_values",
+		.ml_meth = (PyCFunction)request_set_values,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_values_sequence",
+		.ml_meth = (PyCFunction)request_set_values_sequence,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "get_values_mask",
+		.ml_meth = (PyCFunction)request_get_values_mask,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "set_values_mask",
+		.ml_meth = (PyCFunction)request_set_values_mask,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "offsets_to_mask",
+		.ml_meth = (PyCFunction)request_offsets_to_mask,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "wait_for_values",
+		.ml_meth = (PyCFunction)request_wait_for_values,
+		.ml_flags = METH_VARARGS,
+	},
+	{
 		.ml_name = "reconfigure_lines",
 		.ml_meth = (PyCFunction)request_reconfigure_lines,
 		.ml_flags = METH_VARARGS,
 	},
+	{
+		.ml_name = "reconfigure_lines_partial",
+		.ml_meth = (PyCFunction)request_reconfigure_lines_partial,
+		.ml_flags = METH_VARARGS,
+	},
 	{
 		.ml_name = "read_edge_events",
 		.ml_meth = (PyCFunction)request_read_edge_events,
 		.ml_flags = METH_VARARGS,
 	},
+	{
+		.ml_name = "read_edge_event_columns",
+		.ml_meth = (PyCFunction)request_read_edge_event_columns,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "read_edge_events_raw",
+		.ml_meth = (PyCFunction)request_read_edge_events_raw,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "decode_pulses",
+		.ml_meth = (PyCFunction)request_decode_pulses,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "watch",
+		.ml_meth = (PyCFunction)request_watch,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "prepare_subset",
+		.ml_meth = (PyCFunction)request_prepare_subset,
+		.ml_flags = METH_VARARGS,
+	},
+	{
+		.ml_name = "get_stats",
+		.ml_meth = (PyCFunction)request_get_stats,
+		.ml_flags = METH_NOARGS,
+	},
+	{
+		.ml_name = "reset_stats",
+		.ml_meth = (PyCFunction)request_reset_stats,
+		.ml_flags = METH_NOARGS,
+	},
 	{ }
 };
 
@@ -360,42 +1592,24 @@ PyObject *Py_gpiod_MakeRequestObject(struct gpiod_line_request *request,
 				     size_t event_buffer_size)
 {
 	struct gpiod_edge_event_buffer *buffer;
-	enum gpiod_line_value *values;
 	request_object *req_obj;
-	unsigned int *offsets;
-	size_t num_lines;
 
-	num_lines = gpiod_line_request_get_num_requested_lines(request);
+	buffer = event_buffer_size ?
+			gpiod_edge_event_buffer_new(event_buffer_size) :
+			gpiod_edge_event_buffer_new_adaptive();
+	if (!buffer)
+		return Py_gpiod_SetErrFromErrno();
 
 	req_obj = PyObject_New(request_object, &request_type);
-	if (!req_obj)
-		return NULL;
-
-	offsets = PyMem_Calloc(num_lines, sizeof(unsigned int));
-	if (!offsets) {
-		Py_DECREF(req_obj);
+	if (!req_obj) {
+		gpiod_edge_event_buffer_free(buffer);
 		return NULL;
 	}
 
-	values = PyMem_Calloc(num_lines, sizeof(int));
-	if (!values) {
-		PyMem_Free(offsets);
-		Py_DECREF(req_obj);
-		return NULL;
-	}
-
-	buffer = gpiod_edge_event_buffer_new(event_buffer_size);
-	if (!buffer) {
-		PyMem_Free(values);
-		PyMem_Free(offsets);
-		Py_DECREF(req_obj);
-		return Py_gpiod_SetErrFromErrno();
-	}
-
+	pthread_rwlock_init(&req_obj->lock, NULL);
 	req_obj->request = request;
-	req_obj->offsets = offsets;
-	req_obj->values = values;
-	req_obj->num_lines = num_lines;
+	req_obj->num_lines =
+			gpiod_line_request_get_num_requested_lines(request);
 	req_obj->buffer = buffer;
 
 	return (PyObject *)req_obj;
@@ -1,9 +1,14 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 # SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+import asyncio
+
+from collections.abc import AsyncIterator, Callable
 from datetime import timedelta
 from select import select
-from typing import Optional, Union
+from typing import Optional, TypeVar, Union
+
+T = TypeVar("T")
 
 
 def poll_fd(fd: int, timeout: Optional[Union[timedelta, float]] = None) -> bool:
@@ -17,3 +22,21 @@ def poll_fd(fd: int, timeout: Optional[Union[timedelta, float]] = None) -> bool:
 
     readable, _, _ = select([fd], [], [], sec)
     return True if fd in readable else False
+
+
+async def read_when_readable(fd: int, read: Callable[[], T]) -> AsyncIterator[T]:
+    loop = asyncio.get_running_loop()
+    readable = asyncio.Event()
+
+    loop.add_reader(fd, readable.set)
+    try:
+        while True:
+            await readable.wait()
+            readable.clear()
+
+            # The reader callback may have run again after the last read
+            # drained the queue. The fd is blocking so check before reading.
+            if poll_fd(fd):
+                yield read()
+    finally:
+        loop.remove_reader(fd)
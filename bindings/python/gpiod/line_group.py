@@ -0,0 +1,83 @@
+# SPDX-License-Identifier: LGPL-2.1-or-later
+# SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+from . import _ext
+# Raised by the extension module if the parent request was released.
+from .exception import RequestReleasedError
+from .line import Value
+from collections.abc import MutableSequence, Sequence
+from typing import Optional, Union
+
+
+class LineGroup:
+    """
+    Prepared subset of the lines of a request for repeated reads and writes.
+
+    Line names and offsets are resolved once when the group is created. Values
+    are exchanged either as an integer bitmask in which bit i corresponds to
+    the i-th line of the group or through a sequence holding one value per
+    line.
+    """
+
+    def __init__(self, subset: _ext.LineSubset, lines: list[Union[int, str]]):
+        """
+        DON'T USE
+
+        LineGroup objects can only be instantiated by a LineRequest parent.
+        This is not part of stable API.
+        """
+        self._subset = subset
+        self._lines = lines
+
+    def get(
+        self, out: Optional[MutableSequence[Value]] = None
+    ) -> Union[int, MutableSequence[Value]]:
+        """
+        Read the values of all lines in the group.
+
+        Args:
+          out:
+            Optional preallocated sequence with one item per line of the group.
+            If set, it's filled with the line values.
+
+        Returns:
+          Bitmask of the line values if out is None, out otherwise.
+        """
+        if out is None:
+            return self._subset.get_bits()
+
+        self._subset.get_values(out)
+        return out
+
+    def set(self, values: Union[int, Sequence[Value]]) -> None:
+        """
+        Set the values of all lines in the group.
+
+        Args:
+          values:
+            Either a bitmask in which bit i holds the value of the i-th line of
+            the group or a sequence with one value per line.
+        """
+        if isinstance(values, int):
+            self._subset.set_bits(values)
+        else:
+            self._subset.set_values(values)
+
+    def __len__(self) -> int:
+        """
+        Number of lines in the group.
+        """
+        return self._subset.num_lines
+
+    def __str__(self):
+        """
+        Return a user-friendly, human-readable description of this group.
+        """
+        return "<LineGroup lines={}>".format(self._lines)
+
+    @property
+    def lines(self) -> list[Union[int, str]]:
+        """
+        Lines of the group in the order they were passed to LineRequest.group().
+        """
+        return self._lines
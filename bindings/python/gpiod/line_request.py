@@ -2,14 +2,17 @@
 # SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
 from . import _ext
-from .edge_event import EdgeEvent
+from .edge_event import EdgeEvent, EdgeEventColumns
 from .exception import RequestReleasedError
-from .internal import poll_fd
-from .line import Value
+from .internal import poll_fd, read_when_readable
+from .line import Edge, Value
+from .line_group import LineGroup
 from .line_settings import LineSettings, _line_settings_to_ext
-from collections.abc import Iterable
+from .pulse_decoder import PulseDecoder, PulseFrame
+from .stats import Stats
+from collections.abc import AsyncIterator, Callable, Iterable
 from datetime import timedelta
-from typing import Optional, Union
+from typing import Any, Optional, Union
 
 
 class LineRequest:
@@ -111,6 +114,63 @@ class LineRequest:
         self._req.get_values(offsets, buf)
         return buf
 
+    def get_values_mask(self, mask: Optional[int] = None) -> int:
+        """
+        Get the values of a set of GPIO lines as a bitmask.
+
+        Args:
+          mask:
+            Bitmask of the lines to read in which bit i corresponds to the
+            i-th line in the offsets property - see lines_to_mask(). Can be
+            None in which case all requested lines will be read.
+
+        Returns:
+          Bitmask in which bit i is set if the i-th line is active. Bits not
+          set in mask are cleared.
+        """
+        self._check_released()
+
+        if mask is None:
+            mask = (1 << len(self._lines)) - 1
+
+        return self._req.get_values_mask(mask)
+
+    def set_values_mask(self, mask: int, values: int) -> None:
+        """
+        Set the values of a set of GPIO lines from a bitmask.
+
+        Args:
+          mask:
+            Bitmask of the lines to set in which bit i corresponds to the
+            i-th line in the offsets property - see lines_to_mask().
+          values:
+            Bitmask in which bit i set makes the i-th line active. Bits not
+            set in mask are ignored.
+        """
+        self._check_released()
+        self._req.set_values_mask(mask, values)
+
+    def lines_to_mask(self, lines: Iterable[Union[int, str]]) -> int:
+        """
+        Convert names or offsets of requested lines into a bitmask.
+
+        Args:
+          lines:
+            Names or offsets of the lines to include in the mask.
+
+        Returns:
+          Bitmask suitable for get_values_mask() and set_values_mask(). It
+          can be computed once and reused in polling loops.
+        """
+        self._check_released()
+
+        offsets = [
+            self._name_map[line] if self._check_line_name(line) else line
+            for line in lines
+        ]
+
+        return self._req.offsets_to_mask(offsets)
+
     def set_value(self, line: Union[int, str], value: Value) -> None:
         """
         Set the value of a single GPIO line.
@@ -140,20 +200,130 @@ class LineRequest:
 
         self._req.set_values(mapped)
 
-    def reconfigure_lines(
-        self, config: dict[tuple[Union[int, str]], LineSettings]
-    ) -> None:
+    def set_values_sequence(self, frames: Any, period_ns: int) -> None:
         """
-        Reconfigure requested lines.
+        Write a precomputed sequence of frames to the requested lines.
 
         Args:
-          config
-            Dictionary mapping offsets or names (or tuples thereof) to
-            LineSettings. If None is passed as the value of the mapping,
-            default settings are used.
+          frames:
+            Object supporting the buffer protocol - e.g. bytes, array.array
+            or a C-contiguous numpy.uint64 array of shape (N, 2) - holding
+            pairs of native-endian 64-bit words. The first word of a frame
+            is the mask of lines to set, the second one their values. Bit i
+            of both refers to the i-th line in the offsets property.
+          period_ns:
+            Time between the starts of consecutive frames in nanoseconds.
+
+        Note:
+          The frames are played by the library's waveform engine without
+          holding the GIL. The deadlines are absolute, so timing errors
+          don't accumulate over the sequence. This call blocks until the
+          last frame has been written.
+        """
+        self._check_released()
+
+        if period_ns < 0:
+            raise ValueError("period_ns must not be negative")
+
+        self._req.set_values_sequence(frames, period_ns)
+
+    def group(self, lines: Iterable[Union[int, str]]) -> LineGroup:
+        """
+        Prepare a group of requested lines for repeated reads and writes.
+
+        Args:
+          lines:
+            Names or offsets of the lines to include in the group.
+
+        Returns:
+          New LineGroup object. Line names and offsets are resolved once here
+          so getting and setting values through the group avoids the per-call
+          lookups of get_values() and set_values(). The group must not be
+          used after this request was released.
+        """
+        self._check_released()
+
+        lines = list(lines)
+
+        offsets = [
+            self._name_map[line] if self._check_line_name(line) else line
+            for line in lines
+        ]
+
+        return LineGroup(self._req.prepare_subset(offsets), lines)
+
+    def wait_for_value(
+        self,
+        line: Union[int, str],
+        value: Value,
+        timeout: Optional[Union[timedelta, float]] = None,
+    ) -> bool:
+        """
+        Wait until a single GPIO line has the given value.
+
+        Args:
+          line:
+            Offset or name of the line to watch.
+          value:
+            Expected value.
+          timeout:
+            Wait time limit represented as either a datetime.timedelta object
+            or the number of seconds stored in a float. If set to None, the
+            function blocks until the line has the value.
+
+        Returns:
+          True if the line has the value. False on timeout.
+        """
+        return self.wait_for_values({line: value}, timeout=timeout)
+
+    def wait_for_values(
+        self,
+        values: dict[Union[int, str], Value],
+        match_any: bool = False,
+        timeout: Optional[Union[timedelta, float]] = None,
+    ) -> bool:
+        """
+        Wait until a set of GPIO lines have the given values.
+
+        The values are read first and then again after every batch of edge
+        events, which are read and discarded. A change right after a read
+        always wakes the wait up so none can be missed. Each line must detect
+        the edge leading to its expected value.
+
+        Args:
+          values:
+            Dictionary mapping line offsets or names to expected values.
+          match_any:
+            If True, the wait ends when any of the lines has its expected
+            value. Otherwise all lines must have their values.
+          timeout:
+            Wait time limit represented as either a datetime.timedelta object
+            or the number of seconds stored in a float. If set to None, the
+            function blocks until the condition is met.
+
+        Returns:
+          True if the condition is met. False on timeout.
         """
         self._check_released()
 
+        mapped = {
+            self._name_map[line] if self._check_line_name(line) else line: values[line]
+            for line in values
+        }
+
+        if timeout is None:
+            timeout_ns = -1
+        else:
+            if isinstance(timeout, timedelta):
+                timeout = timeout.total_seconds()
+
+            timeout_ns = max(int(timeout * 1000000000), 0)
+
+        return self._req.wait_for_values(mapped, match_any, timeout_ns)
+
+    def _make_line_config(
+        self, config: dict[tuple[Union[int, str]], LineSettings]
+    ) -> _ext.LineConfig:
         line_cfg = _ext.LineConfig()
 
         for lines, settings in config.items():
@@ -167,7 +337,40 @@ class LineRequest:
 
             line_cfg.add_line_settings(offsets, _line_settings_to_ext(settings))
 
-        self._req.reconfigure_lines(line_cfg)
+        return line_cfg
+
+    def reconfigure_lines(
+        self, config: dict[tuple[Union[int, str]], LineSettings]
+    ) -> None:
+        """
+        Reconfigure requested lines.
+
+        Args:
+          config
+            Dictionary mapping offsets or names (or tuples thereof) to
+            LineSettings. If None is passed as the value of the mapping,
+            default settings are used.
+        """
+        self._check_released()
+
+        self._req.reconfigure_lines(self._make_line_config(config))
+
+    def reconfigure_lines_partial(
+        self, config: dict[tuple[Union[int, str]], LineSettings]
+    ) -> None:
+        """
+        Reconfigure a subset of requested lines.
+
+        Args:
+          config
+            Dictionary mapping offsets or names (or tuples thereof) to
+            LineSettings. If None is passed as the value of the mapping,
+            default settings are used. Requested lines not present in the
+            mapping keep their current settings and output values.
+        """
+        self._check_released()
+
+        self._req.reconfigure_lines_partial(self._make_line_config(config))
 
     def wait_edge_events(
         self, timeout: Optional[Union[timedelta, float]] = None
@@ -202,6 +405,185 @@ class LineRequest:
 
         return self._req.read_edge_events(max_events)
 
+    async def edge_events(
+        self, max_events: Optional[int] = None
+    ) -> AsyncIterator[list[EdgeEvent]]:
+        """
+        Asynchronously iterate over batches of edge events.
+
+        Args:
+          max_events:
+            Maximum number of events in a batch. See read_edge_events().
+
+        Yields:
+          Lists of EdgeEvent objects read whenever the request becomes
+          readable.
+
+        Note:
+          The request is watched by the reader of the running asyncio event
+          loop so any number of requests can be served by a single loop
+          without threads.
+        """
+        self._check_released()
+
+        async for events in read_when_readable(
+            self.fd, lambda: self.read_edge_events(max_events)
+        ):
+            yield events
+
+    def watch(
+        self,
+        callback: Callable[[Any], Optional[bool]],
+        lines: Optional[Iterable[Union[int, str]]] = None,
+        edges: Edge = Edge.BOTH,
+        batch: bool = False,
+        max_events: Optional[int] = None,
+        timeout: Optional[Union[timedelta, float]] = None,
+    ) -> int:
+        """
+        Wait for edge events and dispatch them to a callback in a loop running
+        in the C extension. The GIL is released while the loop is waiting.
+
+        Each event is passed as a tuple of (event_type, timestamp_ns,
+        line_offset, global_seqno, line_seqno) where event_type holds the value
+        of EdgeEvent.Type. The loop stops when the callback returns False,
+        raises an exception or releases the request.
+
+        Args:
+          callback:
+            Callable receiving either a single event tuple or, if batch is
+            True, a list of the event tuples read at once.
+          lines:
+            Names or offsets of the lines to dispatch events for. Events of
+            other lines are dropped. If None, events of all lines are passed.
+          edges:
+            Edges to dispatch events for. Must not be Edge.NONE.
+          batch:
+            If True, the callback is called once per batch of events.
+          max_events:
+            Maximum number of events to read at once.
+          timeout:
+            If no event arrives within this time, the loop stops. Represented
+            as either a datetime.timedelta object or the number of seconds
+            stored in a float. If None, the loop waits indefinitely.
+
+        Returns:
+          Number of events passed to the callback.
+        """
+        self._check_released()
+
+        if not isinstance(edges, Edge) or edges == Edge.NONE:
+            raise ValueError("edges must be one of RISING, FALLING or BOTH")
+
+        offsets = None
+        if lines is not None:
+            offsets = [
+                self._name_map[line] if self._check_line_name(line) else line
+                for line in lines
+            ]
+
+            for offset in offsets:
+                if offset not in self._offsets:
+                    raise ValueError("line {} not requested".format(offset))
+
+        if timeout is None:
+            timeout_ns = -1
+        else:
+            if isinstance(timeout, timedelta):
+                timeout = timeout.total_seconds()
+
+            timeout_ns = max(int(timeout * 1000000000), 0)
+
+        return self._req.watch(
+            callback, offsets, edges.value, max_events, batch, timeout_ns
+        )
+
+    def read_edge_event_columns(
+        self, max_events: Optional[int] = None
+    ) -> EdgeEventColumns:
+        """
+        Read a number of edge events from a line request without creating an
+        EdgeEvent object for each of them.
+
+        Args:
+          max_events:
+            Maximum number of events to read.
+
+        Returns:
+          EdgeEventColumns object with views of the timestamps, line offsets
+          and event types of the read events. The event types use the values
+          of EdgeEvent.Type. The views stay valid until the next read from this
+          request.
+        """
+        self._check_released()
+
+        return EdgeEventColumns(*self._req.read_edge_event_columns(max_events))
+
+    def read_edge_events_raw(self, max_events: Optional[int] = None) -> memoryview:
+        """
+        Read a number of edge events from a line request as packed records.
+
+        Args:
+          max_events:
+            Maximum number of events to read.
+
+        Returns:
+          Read-only, one-dimensional memoryview of the records kept in the
+          event buffer of the request - no data is copied. Each record is
+          itemsize bytes long and holds the fields timestamp_ns (uint64),
+          event_type, line_offset, global_seqno and line_seqno (all uint32)
+          followed by padding. The event types use the values of
+          EdgeEvent.Type. The format of the view describes the fields, so
+          e.g. numpy.asarray() turns it into a structured array without
+          copying. The view stays valid until the next read from this
+          request.
+        """
+        self._check_released()
+
+        return self._req.read_edge_events_raw(max_events)
+
+    def read_pulse_frames(
+        self, decoder: PulseDecoder, max_events: Optional[int] = None
+    ) -> list[PulseFrame]:
+        """
+        Read a number of edge events and decode them into pulse frames.
+
+        Args:
+          decoder:
+            PulseDecoder fed with the events. The events are passed straight
+            from the event buffer of the request, no EdgeEvent objects are
+            created.
+          max_events:
+            Maximum number of events to read.
+
+        Returns:
+          List of the frames completed so far. The frame being assembled when
+          the line goes quiet is only returned once PulseDecoder.flush() is
+          called.
+        """
+        self._check_released()
+
+        self._req.decode_pulses(decoder._decoder, max_events)
+
+        return decoder.read_frames()
+
+    def get_stats(self) -> Stats:
+        """
+        Get the I/O statistics of this request.
+
+        Returns:
+          New gpiod.Stats object.
+        """
+        self._check_released()
+        return self._req.get_stats()
+
+    def reset_stats(self) -> None:
+        """
+        Zero the I/O statistics of this request.
+        """
+        self._check_released()
+        self._req.reset_stats()
+
     def __str__(self):
         """
         Return a user-friendly, human-readable description of this request.
@@ -0,0 +1,164 @@
+# SPDX-License-Identifier: LGPL-2.1-or-later
+# SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+from . import _ext
+from dataclasses import dataclass
+from datetime import timedelta
+from enum import IntFlag
+
+
+def _to_ns(period: timedelta) -> int:
+    return period // timedelta(microseconds=1) * 1000
+
+
+@dataclass(frozen=True, repr=False)
+class PulseFrame:
+    """
+    Frame of bits assembled by a pulse decoder.
+    """
+
+    class Error(IntFlag):
+        """
+        Timing errors seen while the frame was assembled.
+        """
+
+        WIDTH = _ext.PULSE_FRAME_ERR_WIDTH
+        """A pulse was outside of the pulse width limits."""
+        INTERVAL = _ext.PULSE_FRAME_ERR_INTERVAL
+        """Two pulses started closer than the minimum interval."""
+        OVERLAP = _ext.PULSE_FRAME_ERR_OVERLAP
+        """A pulse started while the other line was active."""
+        LOST_EDGE = _ext.PULSE_FRAME_ERR_LOST_EDGE
+        """Two edges of the same type followed each other."""
+        OVERFLOW = _ext.PULSE_FRAME_ERR_OVERFLOW
+        """The frame had more than 64 bits."""
+
+    data: int
+    num_bits: int
+    errors: Error
+    timestamp_ns: int
+
+    def __str__(self):
+        return "<PulseFrame data={:#x} num_bits={} errors={} timestamp_ns={}>".format(
+            self.data, self.num_bits, int(self.errors), self.timestamp_ns
+        )
+
+
+class PulseDecoder:
+    """
+    Decodes frames of pulse trains, such as Wiegand, from edge events.
+
+    Use the wiegand() and pulse_width() class methods to create decoders and
+    feed them with LineRequest.read_pulse_frames().
+    """
+
+    def __init__(self, decoder: _ext.PulseDecoder):
+        """
+        DON'T USE
+
+        Pulse decoders must be created using the wiegand() and pulse_width()
+        class methods.
+        """
+        self._decoder = decoder
+
+    @classmethod
+    def wiegand(cls, data0: int, data1: int) -> "PulseDecoder":
+        """
+        Create a Wiegand decoder.
+
+        Args:
+          data0:
+            Offset of the line whose pulses are 0 bits.
+          data1:
+            Offset of the line whose pulses are 1 bits.
+
+        Returns:
+          New PulseDecoder object.
+        """
+        return cls(_ext.PulseDecoder(data0, data1, True))
+
+    @classmethod
+    def pulse_width(cls, offset: int, one_min: timedelta) -> "PulseDecoder":
+        """
+        Create a pulse width decoder.
+
+        Args:
+          offset:
+            Offset of the line carrying the pulses.
+          one_min:
+            Shortest pulse decoded as a 1 bit.
+
+        Returns:
+          New PulseDecoder object.
+        """
+        return cls(_ext.PulseDecoder(offset, _to_ns(one_min), False))
+
+    def set_frame_gap(self, gap: timedelta) -> None:
+        """
+        Set the time without edges ending a frame. Defaults to 25 ms.
+        """
+        self._decoder.set_frame_gap_ns(_to_ns(gap))
+
+    def set_pulse_width_limits(self, min: timedelta, max: timedelta) -> None:
+        """
+        Set the range of valid pulse widths. Pulses outside of it are still
+        decoded but flag their frame with PulseFrame.Error.WIDTH.
+        """
+        self._decoder.set_pulse_width_limits(_to_ns(min), _to_ns(max))
+
+    def set_min_interval(self, interval: timedelta) -> None:
+        """
+        Set the shortest valid interval between the starts of two pulses.
+        Closer pulses flag their frame with PulseFrame.Error.INTERVAL.
+        """
+        self._decoder.set_min_interval_ns(_to_ns(interval))
+
+    def flush(self, now_ns: int) -> int:
+        """
+        Complete the frame being assembled if the frame gap has passed.
+
+        Args:
+          now_ns:
+            Current time on the clock of the event timestamps.
+
+        Returns:
+          Number of complete frames queued in the decoder.
+        """
+        return self._decoder.flush(now_ns)
+
+    def read_frames(self) -> list[PulseFrame]:
+        """
+        Take all complete frames off the queue of the decoder.
+
+        Returns:
+          List of PulseFrame objects, oldest first.
+        """
+        return [
+            PulseFrame(data, num_bits, PulseFrame.Error(errors), ts)
+            for data, num_bits, errors, ts in self._decoder.read_frames()
+        ]
+
+    def reset(self) -> None:
+        """
+        Drop the frame being assembled and all queued frames.
+        """
+        self._decoder.reset()
+
+    @property
+    def num_frames(self) -> int:
+        """
+        Number of complete frames queued in the decoder.
+        """
+        return self._decoder.num_frames
+
+    @property
+    def num_lost_frames(self) -> int:
+        """
+        Number of frames dropped because the queue was full.
+        """
+        return self._decoder.num_lost_frames
+
+    def __str__(self):
+        return "<PulseDecoder num_frames={} num_lost_frames={}>".format(
+            self.num_frames, self.num_lost_frames
+        )
@@ -0,0 +1,42 @@
+# SPDX-License-Identifier: LGPL-2.1-or-later
+# SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+
+from dataclasses import dataclass
+
+
+@dataclass(frozen=True, repr=False)
+class Stats:
+    """
+    Snapshot of the I/O statistics of a chip or a line request.
+    """
+
+    num_get_ioctls: int
+    num_set_ioctls: int
+    num_config_ioctls: int
+    num_info_ioctls: int
+    num_reads: int
+    num_events_read: int
+    num_bytes_read: int
+    ioctl_time_ns: int
+    max_ioctl_time_ns: int
+    wait_time_ns: int
+
+    def __str__(self):
+        return (
+            "<Stats num_get_ioctls={} num_set_ioctls={} num_config_ioctls={} "
+            "num_info_ioctls={} num_reads={} num_events_read={} "
+            "num_bytes_read={} ioctl_time_ns={} max_ioctl_time_ns={} "
+            "wait_time_ns={}>"
+        ).format(
+            self.num_get_ioctls,
+            self.num_set_ioctls,
+            self.num_config_ioctls,
+            self.num_info_ioctls,
+            self.num_reads,
+            self.num_events_read,
+            self.num_bytes_read,
+            self.ioctl_time_ns,
+            self.max_ioctl_time_ns,
+            self.wait_time_ns,
+        )
@@ -10,11 +10,13 @@ def src(filename):
 gpiod_ext = Extension(
     "gpiod._ext",
     sources=[
+        src("gpiod/ext/capture-reader.c"),
         src("gpiod/ext/chip.c"),
         src("gpiod/ext/common.c"),
         src("gpiod/ext/line-config.c"),
         src("gpiod/ext/line-settings.c"),
         src("gpiod/ext/module.c"),
+        src("gpiod/ext/pulse-decoder.c"),
         src("gpiod/ext/request.c"),
     ],
     define_macros=[("_GNU_SOURCE", "1")],
@@ -4,6 +4,7 @@
 
 import unittest
 
+from .tests_capture_reader import *
 from .tests_chip import *
 from .tests_chip_info import *
 from .tests_edge_event import *
@@ -0,0 +1,102 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+# SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+"""
+Overhead of the bindings on top of the core library, mirroring the gpiod-bench
+program of the C library. Not part of the test-suite, needs root privileges to
+create gpio-sim chips. Run from the bindings/python directory with:
+
+    python3 -m tests.benchmarks
+
+Every result is printed as a single-line JSON object.
+"""
+
+import gpiod
+import json
+import time
+
+from . import gpiosim
+from gpiod.line import Direction, Edge, Value
+
+Pull = gpiosim.Chip.Pull
+
+NUM_LINES = 8
+# Largest edge event queue the kernel allows for a single line.
+EDGE_EVENT_QUEUE_SIZE = 1024
+
+
+def report(name, params, iterations, elapsed_ns):
+    ns_per_op = elapsed_ns / iterations
+
+    print(
+        json.dumps(
+            {
+                "benchmark": name,
+                "params": params,
+                "iterations": iterations,
+                "ns_per_op": round(ns_per_op, 1),
+                "ops_per_sec": round(1000000000 / ns_per_op, 1),
+            }
+        ),
+        flush=True,
+    )
+
+
+def bench_call(name, func, iterations=100000):
+    start = time.perf_counter_ns()
+    for _ in range(iterations):
+        func()
+    report(name, {"num_lines": NUM_LINES}, iterations, time.perf_counter_ns() - start)
+
+
+def bench_values():
+    sim = gpiosim.Chip(num_lines=NUM_LINES)
+    offsets = tuple(range(NUM_LINES))
+    values = {offset: Value.ACTIVE for offset in offsets}
+
+    with gpiod.request_lines(
+        sim.dev_path, {offsets: gpiod.LineSettings(direction=Direction.OUTPUT)}
+    ) as req:
+        bench_call("get_value", lambda: req.get_value(3))
+        bench_call("get_values", req.get_values)
+        bench_call("set_value", lambda: req.set_value(3, Value.ACTIVE))
+        bench_call("set_values", lambda: req.set_values(values))
+
+
+def bench_edge_events(rounds=8):
+    sim = gpiosim.Chip()
+
+    with gpiod.request_lines(
+        sim.dev_path,
+        {0: gpiod.LineSettings(edge_detection=Edge.BOTH)},
+        event_buffer_size=EDGE_EVENT_QUEUE_SIZE,
+    ) as req:
+        for name, read in (
+            ("read_edge_events", req.read_edge_events),
+            ("read_edge_events_raw", req.read_edge_events_raw),
+        ):
+            for capacity in (1, 16, 64, 1024):
+                elapsed = 0
+
+                for _ in range(rounds):
+                    # Generating events is much slower than reading them,
+                    # only the latter is timed.
+                    for i in range(EDGE_EVENT_QUEUE_SIZE):
+                        sim.set_pull(0, Pull.DOWN if i % 2 else Pull.UP)
+
+                    start = time.perf_counter_ns()
+                    pending = EDGE_EVENT_QUEUE_SIZE
+                    while pending:
+                        pending -= len(read(capacity))
+                    elapsed += time.perf_counter_ns() - start
+
+                report(
+                    name,
+                    {"buffer_capacity": capacity},
+                    rounds * EDGE_EVENT_QUEUE_SIZE,
+                    elapsed,
+                )
+
+
+bench_values()
+bench_edge_events()
@@ -0,0 +1,162 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+# SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+import gpiod
+import os
+import struct
+
+from gpiod.line import Clock
+from unittest import TestCase
+
+Type = gpiod.EdgeEvent.Type
+
+CHECKPOINT_INTERVAL = 1024
+RECORD_FORMAT = "<QIIIII4x"
+LINE_FORMAT = "<II32s32s"
+HEADER_FORMAT = "<8sIIQQQQIIII"
+
+
+def write_capture(path, capacity, num_written):
+    """
+    Write a capture as gpiomon would after recording num_written events, the
+    timestamp of the n-th one being 10 * n. See tools-common.h for the layout.
+    """
+    num_checkpoints = (capacity + CHECKPOINT_INTERVAL - 1) // CHECKPOINT_INTERVAL
+    records = [struct.pack(RECORD_FORMAT, 0, 0, 0, 0, 0, 0)] * capacity
+    index = [0] * num_checkpoints
+
+    for n in range(num_written):
+        slot = n % capacity
+        event_type = 2 if n % 2 else 1
+        records[slot] = struct.pack(RECORD_FORMAT, 10 * n, 0, 4, event_type, n + 1, n + 1)
+        if slot % CHECKPOINT_INTERVAL == 0:
+            index[slot // CHECKPOINT_INTERVAL] = 10 * n
+
+    lines = struct.pack(LINE_FORMAT, 0, 4, b"gpiochip0", b"foo")
+    lines += bytes(struct.calcsize(LINE_FORMAT) * 63)
+    header_size = struct.calcsize(HEADER_FORMAT) + len(lines)
+    header = struct.pack(
+        HEADER_FORMAT,
+        b"GPIOCAP",
+        2,
+        struct.calcsize(RECORD_FORMAT),
+        capacity,
+        num_written,
+        header_size,
+        header_size + 8 * num_checkpoints,
+        CHECKPOINT_INTERVAL,
+        1,
+        Clock.REALTIME.value,
+        0,
+    )
+
+    with open(path, "wb") as f:
+        f.write(header)
+        f.write(lines)
+        f.write(struct.pack("<{}Q".format(num_checkpoints), *index))
+        f.write(b"".join(records))
+
+
+class CaptureReaderTestBase(TestCase):
+    def setUp(self):
+        self.path = "/tmp/gpiod-py-test-capture.{}".format(os.getpid())
+
+    def tearDown(self):
+        if os.path.exists(self.path):
+            os.unlink(self.path)
+
+
+class CaptureReaderProperties(CaptureReaderTestBase):
+    def test_header_fields(self):
+        write_capture(self.path, 2048, 100)
+
+        with gpiod.CaptureReader(self.path) as reader:
+            self.assertEqual(reader.event_clock, Clock.REALTIME)
+            self.assertEqual(len(reader), 100)
+            self.assertEqual(reader.num_lost, 0)
+            self.assertEqual(
+                reader.lines, [gpiod.CaptureLine(0, 4, "gpiochip0", "foo")]
+            )
+
+    def test_records_by_index(self):
+        write_capture(self.path, 2048, 100)
+
+        with gpiod.CaptureReader(self.path) as reader:
+            record = reader[-1]
+            self.assertEqual(record.timestamp_ns, 990)
+            self.assertEqual(record.event_type, Type.FALLING_EDGE)
+            self.assertEqual(record.line_seqno, 100)
+            self.assertEqual(reader[0].event_type, Type.RISING_EDGE)
+
+            with self.assertRaises(IndexError):
+                reader[100]
+
+            with self.assertRaises(IndexError):
+                reader[-101]
+
+    def test_use_after_close(self):
+        write_capture(self.path, 2048, 100)
+        reader = gpiod.CaptureReader(self.path)
+        span = next(reader.spans())
+        reader.close()
+
+        self.assertFalse(reader)
+        with self.assertRaises(ValueError):
+            len(reader)
+
+        # Views keep the capture mapped.
+        self.assertEqual(struct.unpack_from(RECORD_FORMAT, span, 32)[0], 10)
+
+    def test_invalid_files(self):
+        with self.assertRaises(OSError):
+            gpiod.CaptureReader("/dev/null")
+
+        with self.assertRaises(FileNotFoundError):
+            gpiod.CaptureReader("/does/not/exist")
+
+
+class CaptureReaderSpans(CaptureReaderTestBase):
+    def test_spans_over_wrapped_ring(self):
+        write_capture(self.path, 3000, 7500)
+
+        with gpiod.CaptureReader(self.path) as reader:
+            self.assertEqual(len(reader), 3000)
+            self.assertEqual(reader.num_lost, 4500)
+
+            spans = list(reader.spans())
+            self.assertEqual(len(spans), 2)
+            self.assertEqual(sum(len(span) for span in spans), 3000)
+
+            timestamps = [
+                record[0]
+                for span in spans
+                for record in struct.iter_unpack(RECORD_FORMAT, span)
+            ]
+            self.assertEqual(timestamps, [10 * n for n in range(4500, 7500)])
+
+            for span in spans:
+                self.assertTrue(span.readonly)
+                self.assertEqual(span.itemsize, 32)
+
+    def test_spans_are_trimmed(self):
+        write_capture(self.path, 3000, 7500)
+
+        with gpiod.CaptureReader(self.path) as reader:
+            spans = list(reader.spans(100, 200))
+            self.assertEqual([len(span) for span in spans], [100])
+            self.assertEqual(list(reader.spans(200, 100)), [])
+
+
+class CaptureReaderFind(CaptureReaderTestBase):
+    def test_find_timestamps(self):
+        write_capture(self.path, 4096, 9000)
+
+        with gpiod.CaptureReader(self.path) as reader:
+            self.assertEqual(reader.find(0), 0)
+            self.assertEqual(reader.find(49040), 0)
+            self.assertEqual(reader.find(49041), 1)
+            self.assertEqual(reader.find(70000), 2096)
+            self.assertEqual(reader.find(90000), 4096)
+
+            start = reader.find(50000)
+            self.assertEqual(reader[start].timestamp_ns, 50000)
@@ -163,6 +163,67 @@ class ChipMapLine(TestCase):
             self.assertEqual(chip.line_offset_from_id("6"), 7)
 
 
+class ChipNameIndex(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8, line_names={1: "foo", 6: "bar"})
+
+    def tearDown(self):
+        del self.sim
+
+    def test_lookups_after_first_use_the_index(self):
+        with gpiod.Chip(self.sim.dev_path) as chip:
+            self.assertEqual(chip.line_offset_from_id("foo"), 1)
+            num_ioctls = chip.get_stats().num_info_ioctls
+
+            self.assertEqual(chip.line_offset_from_id("bar"), 6)
+            with chip.request_lines(config={("foo", "bar"): None}) as request:
+                self.assertEqual(request.offsets, [1, 6])
+            self.assertEqual(chip.get_line_info("bar").offset, 6)
+
+            # Only get_line_info() itself reached the kernel.
+            self.assertEqual(chip.get_stats().num_info_ioctls, num_ioctls + 1)
+
+    def test_invalidate_name_index(self):
+        with gpiod.Chip(self.sim.dev_path) as chip:
+            chip.line_offset_from_id("foo")
+            num_ioctls = chip.get_stats().num_info_ioctls
+
+            chip.invalidate_name_index()
+            self.assertEqual(chip.line_offset_from_id("bar"), 6)
+            self.assertGreater(chip.get_stats().num_info_ioctls, num_ioctls)
+
+    def test_refresh_name_index(self):
+        with gpiod.Chip(self.sim.dev_path, name_index=False) as chip:
+            chip.refresh_name_index()
+            num_ioctls = chip.get_stats().num_info_ioctls
+
+            self.assertEqual(chip.line_offset_from_id("bar"), 6)
+            self.assertEqual(chip.get_stats().num_info_ioctls, num_ioctls)
+
+    def test_lookups_without_index(self):
+        with gpiod.Chip(self.sim.dev_path, name_index=False) as chip:
+            chip.line_offset_from_id("foo")
+            num_ioctls = chip.get_stats().num_info_ioctls
+
+            chip.line_offset_from_id("foo")
+            self.assertGreater(chip.get_stats().num_info_ioctls, num_ioctls)
+
+
+class ChipStats(TestCase):
+    def test_info_ioctls_are_counted(self):
+        sim = gpiosim.Chip(num_lines=4)
+
+        with gpiod.Chip(sim.dev_path) as chip:
+            chip.get_info()
+            chip.get_line_info(0)
+
+            self.assertEqual(chip.get_stats().num_info_ioctls, 2)
+
+            chip.reset_stats()
+
+            self.assertEqual(chip.get_stats().num_info_ioctls, 0)
+
+
 class ClosedChipCannotBeUsed(TestCase):
     def test_close_chip_and_try_to_use_it(self):
         sim = gpiosim.Chip(label="foobar")
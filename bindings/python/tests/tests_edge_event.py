@@ -1,7 +1,9 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 # SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+import asyncio
 import gpiod
+import struct
 import time
 
 from . import gpiosim
@@ -197,6 +199,175 @@ class ReadingMultipleEdgeEvents(TestCase):
             self.global_seqno += 1
 
 
+class ReadingEdgeEventsAsynchronously(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.thread = None
+
+    def tearDown(self):
+        if self.thread:
+            self.thread.join()
+            del self.thread
+        self.sim = None
+
+    def trigger_rising_edges(self, *offsets):
+        time.sleep(0.05)
+        for offset in offsets:
+            self.sim.set_pull(offset, Pull.UP)
+            time.sleep(0.05)
+
+    async def collect(self, req, num_events):
+        events = []
+        async for batch in req.edge_events():
+            events.extend(batch)
+            if len(events) == num_events:
+                return events
+
+    def test_edge_events_async_iterator(self):
+        with gpiod.request_lines(
+            self.sim.dev_path,
+            {(1, 2): gpiod.LineSettings(edge_detection=Edge.RISING)},
+        ) as req:
+            self.thread = Thread(target=partial(self.trigger_rising_edges, 1, 2))
+            self.thread.start()
+
+            events = asyncio.run(asyncio.wait_for(self.collect(req, 2), 5))
+            self.assertEqual([event.line_offset for event in events], [1, 2])
+            self.assertEqual(events[0].event_type, EventType.RISING_EDGE)
+
+    def test_multiple_requests_served_by_one_loop(self):
+        with gpiod.request_lines(
+            self.sim.dev_path, {3: gpiod.LineSettings(edge_detection=Edge.RISING)}
+        ) as req0, gpiod.request_lines(
+            self.sim.dev_path, {5: gpiod.LineSettings(edge_detection=Edge.RISING)}
+        ) as req1:
+            self.thread = Thread(target=partial(self.trigger_rising_edges, 5, 3))
+            self.thread.start()
+
+            async def collect_both():
+                return await asyncio.gather(
+                    self.collect(req0, 1), self.collect(req1, 1)
+                )
+
+            events0, events1 = asyncio.run(asyncio.wait_for(collect_both(), 5))
+            self.assertEqual(events0[0].line_offset, 3)
+            self.assertEqual(events1[0].line_offset, 5)
+
+
+class WatchingEdgeEventsWithCallback(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {(1, 2): gpiod.LineSettings(edge_detection=Edge.BOTH)},
+        )
+        self.thread = None
+
+    def tearDown(self):
+        if self.thread:
+            self.thread.join()
+            del self.thread
+        self.req.release()
+        del self.req
+        self.sim = None
+
+    def trigger_rising_edges(self):
+        time.sleep(0.05)
+        self.sim.set_pull(1, Pull.UP)
+        time.sleep(0.05)
+        self.sim.set_pull(2, Pull.UP)
+
+    def test_callback_per_event(self):
+        events = []
+
+        def callback(event):
+            events.append(event)
+            return len(events) < 2
+
+        self.thread = Thread(target=self.trigger_rising_edges)
+        self.thread.start()
+
+        self.assertEqual(self.req.watch(callback, timeout=5), 2)
+        self.assertEqual([event[2] for event in events], [1, 2])
+        self.assertEqual(events[0][0], EventType.RISING_EDGE.value)
+        self.assertGreater(events[1][1], events[0][1])
+        self.assertGreater(events[1][3], events[0][3])
+
+    def test_callback_per_batch(self):
+        batches = []
+
+        self.sim.set_pull(1, Pull.UP)
+        self.sim.set_pull(2, Pull.UP)
+        time.sleep(0.05)
+
+        self.assertEqual(
+            self.req.watch(batches.append, batch=True, timeout=0.1), 2
+        )
+        self.assertEqual(len(batches), 1)
+        self.assertEqual([event[2] for event in batches[0]], [1, 2])
+
+    def test_filter_lines_and_edges(self):
+        events = []
+
+        self.sim.set_pull(1, Pull.UP)
+        self.sim.set_pull(2, Pull.UP)
+        self.sim.set_pull(2, Pull.DOWN)
+        time.sleep(0.05)
+
+        self.assertEqual(
+            self.req.watch(events.append, lines=[2], edges=Edge.RISING, timeout=0.1),
+            1,
+        )
+        self.assertEqual(events[0][0], EventType.RISING_EDGE.value)
+        self.assertEqual(events[0][2], 2)
+
+    def test_exception_in_callback_ends_the_loop(self):
+        def callback(event):
+            raise RuntimeError("stop")
+
+        self.sim.set_pull(1, Pull.UP)
+
+        with self.assertRaises(RuntimeError):
+            self.req.watch(callback, timeout=1)
+
+    def test_invalid_arguments(self):
+        with self.assertRaises(ValueError):
+            self.req.watch(print, lines=[5])
+
+        with self.assertRaises(ValueError):
+            self.req.watch(print, edges=Edge.NONE)
+
+        with self.assertRaises(TypeError):
+            self.req.watch(None, timeout=0)
+
+
+class ReadingFromNonBlockingRequest(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.request = gpiod.request_lines(
+            self.sim.dev_path,
+            {2: gpiod.LineSettings(edge_detection=Edge.BOTH)},
+            nonblocking=True,
+        )
+
+    def tearDown(self):
+        self.request.release()
+        del self.request
+        del self.sim
+
+    def test_read_without_events_returns_empty_list(self):
+        self.assertEqual(self.request.read_edge_events(), [])
+
+    def test_read_queued_events(self):
+        self.sim.set_pull(2, Pull.UP)
+        time.sleep(0.05)
+
+        events = self.request.read_edge_events()
+        self.assertEqual(len(events), 1)
+        self.assertEqual(events[0].event_type, EventType.RISING_EDGE)
+        self.assertEqual(self.request.read_edge_events(), [])
+
+
 class EdgeEventStringRepresentation(TestCase):
     def test_edge_event_str(self):
         sim = gpiosim.Chip()
@@ -210,3 +381,162 @@ class EdgeEventStringRepresentation(TestCase):
                 str(event),
                 "<EdgeEvent type=Type\.RISING_EDGE timestamp_ns=[0-9]+ line_offset=0 global_seqno=1 line_seqno=1>",
             )
+
+
+class ReadingEdgeEventColumns(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.request = gpiod.request_lines(
+            self.sim.dev_path,
+            {(2, 5): gpiod.LineSettings(edge_detection=Edge.BOTH)},
+        )
+
+    def tearDown(self):
+        if self.request:
+            self.request.release()
+        del self.request
+        del self.sim
+
+    def test_columns_match_events(self):
+        self.sim.set_pull(2, Pull.UP)
+        self.sim.set_pull(5, Pull.UP)
+        self.sim.set_pull(2, Pull.DOWN)
+        time.sleep(0.05)
+
+        cols = self.request.read_edge_event_columns()
+        self.assertEqual(len(cols), 3)
+        self.assertEqual(cols.line_offset.tolist(), [2, 5, 2])
+        self.assertEqual(
+            [EventType(t) for t in cols.event_type],
+            [EventType.RISING_EDGE, EventType.RISING_EDGE, EventType.FALLING_EDGE],
+        )
+        self.assertEqual(cols.timestamp_ns.itemsize, 8)
+        self.assertLessEqual(cols.timestamp_ns[0], cols.timestamp_ns[1])
+        self.assertLessEqual(cols.timestamp_ns[1], cols.timestamp_ns[2])
+
+    def test_columns_are_read_only(self):
+        self.sim.set_pull(2, Pull.UP)
+        time.sleep(0.05)
+
+        cols = self.request.read_edge_event_columns()
+        self.assertTrue(cols.line_offset.readonly)
+        with self.assertRaises(TypeError):
+            cols.line_offset[0] = 3
+
+    def test_columns_outlive_the_request(self):
+        self.sim.set_pull(5, Pull.UP)
+        time.sleep(0.05)
+
+        cols = self.request.read_edge_event_columns()
+        self.request.release()
+        self.assertEqual(cols.line_offset.tolist(), [5])
+
+
+class ReadingRawEdgeEvents(TestCase):
+    RECORD = struct.Struct("=QIIII24x")
+
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.request = gpiod.request_lines(
+            self.sim.dev_path,
+            {(2, 5): gpiod.LineSettings(edge_detection=Edge.BOTH)},
+        )
+
+    def tearDown(self):
+        if self.request:
+            self.request.release()
+        del self.request
+        del self.sim
+
+    def test_records_match_events(self):
+        self.sim.set_pull(2, Pull.UP)
+        self.sim.set_pull(5, Pull.UP)
+        self.sim.set_pull(2, Pull.DOWN)
+        time.sleep(0.05)
+
+        raw = self.request.read_edge_events_raw()
+        self.assertEqual(len(raw), 3)
+        self.assertEqual(raw.itemsize, self.RECORD.size)
+        self.assertEqual(raw.nbytes, 3 * self.RECORD.size)
+        self.assertTrue(raw.format.startswith("T{"))
+
+        records = list(self.RECORD.iter_unpack(raw.tobytes()))
+        self.assertEqual([r[2] for r in records], [2, 5, 2])
+        self.assertEqual(
+            [EventType(r[1]) for r in records],
+            [EventType.RISING_EDGE, EventType.RISING_EDGE, EventType.FALLING_EDGE],
+        )
+        self.assertEqual([r[3] for r in records], [1, 2, 3])
+        self.assertEqual([r[4] for r in records], [1, 1, 2])
+        self.assertLessEqual(records[0][0], records[1][0])
+
+    def test_records_are_read_only(self):
+        self.sim.set_pull(2, Pull.UP)
+        time.sleep(0.05)
+
+        raw = self.request.read_edge_events_raw()
+        self.assertTrue(raw.readonly)
+
+    def test_records_outlive_the_request(self):
+        self.sim.set_pull(5, Pull.UP)
+        time.sleep(0.05)
+
+        raw = self.request.read_edge_events_raw()
+        self.request.release()
+        self.assertEqual(self.RECORD.unpack(raw.tobytes())[2], 5)
+
+
+class ReadingPulseFrames(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.request = gpiod.request_lines(
+            self.sim.dev_path,
+            {(2, 5): gpiod.LineSettings(edge_detection=Edge.BOTH)},
+        )
+
+    def tearDown(self):
+        self.request.release()
+        del self.request
+        del self.sim
+
+    def send_pulse(self, offset):
+        self.sim.set_pull(offset, Pull.UP)
+        time.sleep(0.001)
+        self.sim.set_pull(offset, Pull.DOWN)
+        time.sleep(0.001)
+
+    def test_wiegand_frame_is_decoded(self):
+        decoder = gpiod.PulseDecoder.wiegand(2, 5)
+        decoder.set_frame_gap(timedelta(seconds=1))
+
+        for offset in (5, 2, 5, 5):
+            self.send_pulse(offset)
+
+        self.assertEqual(self.request.read_pulse_frames(decoder), [])
+        self.assertEqual(decoder.flush(2**64 - 1), 1)
+
+        frames = decoder.read_frames()
+        self.assertEqual(len(frames), 1)
+        self.assertEqual(frames[0].data, 0xB)
+        self.assertEqual(frames[0].num_bits, 4)
+        self.assertEqual(frames[0].errors, gpiod.PulseFrame.Error(0))
+        self.assertEqual(decoder.num_frames, 0)
+
+    def test_width_errors_are_flagged(self):
+        decoder = gpiod.PulseDecoder.wiegand(2, 5)
+        decoder.set_frame_gap(timedelta(seconds=1))
+        decoder.set_pulse_width_limits(timedelta(), timedelta(microseconds=1))
+
+        self.send_pulse(2)
+        self.request.read_pulse_frames(decoder)
+        decoder.flush(2**64 - 1)
+
+        (frame,) = decoder.read_frames()
+        self.assertTrue(frame.errors & gpiod.PulseFrame.Error.WIDTH)
+
+    def test_invalid_arguments(self):
+        with self.assertRaises(ValueError):
+            gpiod.PulseDecoder.wiegand(3, 3)
+
+        with self.assertRaises(ValueError):
+            gpiod.PulseDecoder.pulse_width(3, timedelta())
@@ -1,6 +1,7 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 # SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
 
+import asyncio
 import datetime
 import errno
 import gpiod
@@ -174,6 +175,62 @@ class UnwatchingLineInfo(TestCase):
         )
 
 
+class ReadingMultipleInfoEvents(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.chip = gpiod.Chip(self.sim.dev_path)
+        self.chip.watch_line_info(7)
+        self.thread = None
+
+    def tearDown(self):
+        if self.thread:
+            self.thread.join()
+            self.thread = None
+
+        self.chip.close()
+        self.chip = None
+        self.sim = None
+
+    def test_read_info_events_in_one_batch(self):
+        request_reconfigure_release_line(self.chip, 7)
+
+        events = self.chip.read_info_events()
+        self.assertEqual(
+            [event.event_type for event in events],
+            [
+                EventType.LINE_REQUESTED,
+                EventType.LINE_CONFIG_CHANGED,
+                EventType.LINE_RELEASED,
+            ],
+        )
+        self.assertGreater(events[2].timestamp_ns, events[0].timestamp_ns)
+
+    def test_read_info_events_max_events(self):
+        request_reconfigure_release_line(self.chip, 7)
+
+        self.assertEqual(len(self.chip.read_info_events(2)), 2)
+        events = self.chip.read_info_events(2)
+        self.assertEqual(len(events), 1)
+        self.assertEqual(events[0].event_type, EventType.LINE_RELEASED)
+
+    def test_info_events_async_iterator(self):
+        async def collect():
+            events = []
+            async for batch in self.chip.info_events():
+                events.extend(batch)
+                if len(events) == 3:
+                    return events
+
+        self.thread = threading.Thread(
+            target=partial(request_reconfigure_release_line, self.chip, 7)
+        )
+        self.thread.start()
+
+        events = asyncio.run(asyncio.wait_for(collect(), 5))
+        self.assertEqual(events[0].event_type, EventType.LINE_REQUESTED)
+        self.assertEqual(events[2].event_type, EventType.LINE_RELEASED)
+
+
 class InfoEventStringRepresentation(TestCase):
     def test_info_event_str(self):
         sim = gpiosim.Chip()
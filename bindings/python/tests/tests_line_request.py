@@ -3,8 +3,12 @@
 
 import errno
 import gpiod
+import struct
+import time
 
 from . import gpiosim
+from array import array
+from threading import Thread
 from gpiod.line import Direction, Edge, Value
 from unittest import TestCase
 
@@ -203,6 +207,80 @@ class LineRequestGettingValues(TestCase):
             self.req.get_values(True)
 
 
+class LineRequestGettingValuesWithInputShadow(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8)
+        self.sim.set_pull(1, Pull.UP)
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {
+                (0, 1): gpiod.LineSettings(
+                    direction=Direction.INPUT, edge_detection=Edge.BOTH
+                )
+            },
+            input_shadow=True,
+        )
+
+    def tearDown(self):
+        self.req.release()
+        del self.req
+        del self.sim
+
+    def test_values_follow_read_edge_events(self):
+        self.assertEqual(self.req.get_values(), [Value.INACTIVE, Value.ACTIVE])
+
+        self.sim.set_pull(0, Pull.UP)
+        self.sim.set_pull(1, Pull.DOWN)
+        time.sleep(0.05)
+
+        # The shadow only changes once the events have been read.
+        self.assertEqual(self.req.get_values(), [Value.INACTIVE, Value.ACTIVE])
+
+        self.assertEqual(len(self.req.read_edge_events()), 2)
+        self.assertEqual(self.req.get_values(), [Value.ACTIVE, Value.INACTIVE])
+
+
+class LineRequestWaitingForValues(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8, line_names={2: "foo"})
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {
+                (1, "foo"): gpiod.LineSettings(
+                    direction=Direction.INPUT, edge_detection=Edge.BOTH
+                ),
+                3: gpiod.LineSettings(
+                    direction=Direction.INPUT, edge_detection=Edge.FALLING
+                ),
+            },
+        )
+
+    def tearDown(self):
+        self.req.release()
+        del self.req
+        del self.sim
+
+    def test_current_value_satisfies_wait(self):
+        self.assertTrue(self.req.wait_for_value(1, Value.INACTIVE, timeout=0))
+
+    def test_wait_times_out(self):
+        self.assertFalse(self.req.wait_for_value("foo", Value.ACTIVE, 0.01))
+
+    def test_wait_for_any_and_all(self):
+        values = {1: Value.ACTIVE, "foo": Value.ACTIVE}
+
+        self.sim.set_pull(1, Pull.UP)
+        self.assertTrue(self.req.wait_for_values(values, match_any=True, timeout=1))
+        self.assertFalse(self.req.wait_for_values(values, timeout=0.01))
+
+        self.sim.set_pull(2, Pull.UP)
+        self.assertTrue(self.req.wait_for_values(values, timeout=1))
+
+    def test_wait_without_needed_edge_detection(self):
+        with self.assertRaises(ValueError):
+            self.req.wait_for_value(3, Value.ACTIVE, timeout=0)
+
+
 class LineRequestGettingValuesByName(TestCase):
     def setUp(self):
         self.sim = gpiosim.Chip(num_lines=4, line_names={2: "foo", 3: "bar", 1: "baz"})
@@ -291,6 +369,216 @@ class LineRequestSettingValuesByName(TestCase):
             self.req.set_values({"xyz": Value.ACTIVE})
 
 
+class LineRequestValuesMask(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8, line_names={5: "foo"})
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {(1, 3, "foo"): gpiod.LineSettings(direction=Direction.OUTPUT)},
+        )
+
+    def tearDown(self):
+        self.req.release()
+        del self.req
+        del self.sim
+
+    def test_lines_to_mask(self):
+        self.assertEqual(self.req.lines_to_mask([3]), 0b010)
+        self.assertEqual(self.req.lines_to_mask(["foo", 1]), 0b101)
+
+    def test_lines_to_mask_invalid_lines(self):
+        with self.assertRaises(ValueError):
+            self.req.lines_to_mask([0])
+
+        with self.assertRaises(ValueError):
+            self.req.lines_to_mask(["xyz"])
+
+    def test_set_and_get_values_mask(self):
+        self.req.set_values_mask(0b111, 0b101)
+        self.assertEqual(self.sim.get_value(1), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(3), SimVal.INACTIVE)
+        self.assertEqual(self.sim.get_value(5), SimVal.ACTIVE)
+
+        self.assertEqual(self.req.get_values_mask(), 0b101)
+        self.assertEqual(self.req.get_values_mask(0b110), 0b100)
+
+    def test_set_values_mask_ignores_bits_outside_mask(self):
+        self.req.set_values_mask(0b010, 0b111)
+        self.assertEqual(self.sim.get_value(1), SimVal.INACTIVE)
+        self.assertEqual(self.sim.get_value(3), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(5), SimVal.INACTIVE)
+
+    def test_mask_past_last_line(self):
+        with self.assertRaises(ValueError):
+            self.req.get_values_mask(0b1000)
+
+        with self.assertRaises(ValueError):
+            self.req.set_values_mask(0b1000, 0)
+
+
+class LineRequestGroups(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=4, line_names={2: "foo", 3: "bar"})
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {(0, 1, "foo", "bar"): gpiod.LineSettings(direction=Direction.OUTPUT)},
+        )
+
+    def tearDown(self):
+        if self.req:
+            self.req.release()
+        del self.req
+        del self.sim
+
+    def test_set_and_get_bits(self):
+        group = self.req.group(["bar", 0, 1])
+        self.assertEqual(len(group), 3)
+        self.assertEqual(group.lines, ["bar", 0, 1])
+
+        group.set(0b101)
+        self.assertEqual(self.sim.get_value(3), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(0), SimVal.INACTIVE)
+        self.assertEqual(self.sim.get_value(1), SimVal.ACTIVE)
+        self.assertEqual(group.get(), 0b101)
+
+    def test_set_and_get_into_preallocated_sequence(self):
+        group = self.req.group([1, "foo"])
+        group.set([Value.ACTIVE, Value.INACTIVE])
+        self.assertEqual(self.sim.get_value(1), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(2), SimVal.INACTIVE)
+
+        buf = [None] * 2
+        self.assertIs(group.get(buf), buf)
+        self.assertEqual(buf, [Value.ACTIVE, Value.INACTIVE])
+
+    def test_bits_past_last_line(self):
+        group = self.req.group([0, 1])
+        with self.assertRaises(ValueError):
+            group.set(0b100)
+
+    def test_bad_sequence_length(self):
+        group = self.req.group([0, 1])
+        with self.assertRaises(ValueError):
+            group.set([Value.ACTIVE])
+
+        with self.assertRaises(ValueError):
+            group.get([None] * 3)
+
+    def test_invalid_lines(self):
+        with self.assertRaises(ValueError):
+            self.req.group([0, 7])
+
+        with self.assertRaises(ValueError):
+            self.req.group(["xyz"])
+
+    def test_group_cannot_be_used_after_release(self):
+        group = self.req.group([0, 1])
+        self.req.release()
+
+        with self.assertRaises(gpiod.RequestReleasedError):
+            group.get()
+
+        with self.assertRaises(gpiod.RequestReleasedError):
+            group.set(0)
+
+
+class LineRequestValuesSequence(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=4)
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {(0, 1, 2, 3): gpiod.LineSettings(direction=Direction.OUTPUT)},
+        )
+
+    def tearDown(self):
+        if self.req:
+            self.req.release()
+        del self.req
+        del self.sim
+
+    def test_frames_are_written_in_order(self):
+        frames = array("Q", [0b1111, 0b0011, 0b0100, 0b0100, 0b0001, 0b0000])
+
+        start = time.monotonic_ns()
+        self.req.set_values_sequence(frames, 5000000)
+        # The last frame is due two periods after the first one.
+        self.assertGreaterEqual(time.monotonic_ns() - start, 10000000)
+
+        self.assertEqual(self.sim.get_value(0), SimVal.INACTIVE)
+        self.assertEqual(self.sim.get_value(1), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(2), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(3), SimVal.INACTIVE)
+
+    def test_bytes_are_accepted(self):
+        frames = struct.pack("=QQ", 0b1000, 0b1000)
+        self.req.set_values_sequence(frames, 0)
+        self.assertEqual(self.sim.get_value(3), SimVal.ACTIVE)
+
+    def test_empty_sequence(self):
+        self.req.set_values_sequence(b"", 1000)
+
+    def test_truncated_frame(self):
+        with self.assertRaises(ValueError):
+            self.req.set_values_sequence(bytes(12), 1000)
+
+    def test_mask_past_last_line(self):
+        frames = array("Q", [0b0001, 0b0001, 0b10000, 0b10000])
+        with self.assertRaises(ValueError):
+            self.req.set_values_sequence(frames, 0)
+
+        # Nothing is written if any of the frames is invalid.
+        self.assertEqual(self.sim.get_value(0), SimVal.INACTIVE)
+
+    def test_negative_period(self):
+        with self.assertRaises(ValueError):
+            self.req.set_values_sequence(array("Q", [1, 1]), -1)
+
+    def test_sequence_after_release(self):
+        self.req.release()
+        with self.assertRaises(gpiod.RequestReleasedError):
+            self.req.set_values_sequence(array("Q", [1, 1]), 0)
+
+
+class LineRequestUsedFromManyThreads(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=4)
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {(0, 1, 2, 3): gpiod.LineSettings(direction=Direction.OUTPUT)},
+        )
+
+    def tearDown(self):
+        self.req.release()
+        del self.req
+        del self.sim
+
+    def toggle_line(self, offset, mismatches):
+        for i in range(50):
+            value = Value.ACTIVE if i % 2 else Value.INACTIVE
+            self.req.set_value(offset, value)
+            if self.req.get_value(offset) != value:
+                mismatches.append(offset)
+
+        self.req.set_value(offset, Value.ACTIVE)
+
+    def test_concurrent_value_calls_on_different_lines(self):
+        mismatches = []
+        threads = [
+            Thread(target=self.toggle_line, args=(offset, mismatches))
+            for offset in range(4)
+        ]
+
+        for thread in threads:
+            thread.start()
+
+        for thread in threads:
+            thread.join()
+
+        self.assertEqual(mismatches, [])
+        for offset in range(4):
+            self.assertEqual(self.sim.get_value(offset), SimVal.ACTIVE)
+
+
 class LineRequestComplexConfig(TestCase):
     def test_complex_config(self):
         sim = gpiosim.Chip(num_lines=8)
@@ -491,6 +779,88 @@ class ReconfigureRequestedLines(TestCase):
         self.assertEqual(info.direction, Direction.INPUT)
 
 
+class PartiallyReconfigureRequestedLines(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=8, line_names={3: "foo", 4: "bar", 6: "baz"})
+        self.chip = gpiod.Chip(self.sim.dev_path)
+        self.req = self.chip.request_lines(
+            {(0, 2, "foo", "baz"): gpiod.LineSettings(direction=Direction.OUTPUT)}
+        )
+        self.req.set_values({0: Value.ACTIVE, 2: Value.ACTIVE, "baz": Value.ACTIVE})
+
+    def tearDown(self):
+        self.chip.close()
+        del self.chip
+        self.req.release()
+        del self.req
+        del self.sim
+
+    def test_reconfigure_subset_by_offsets(self):
+        self.req.reconfigure_lines_partial(
+            {2: gpiod.LineSettings(direction=Direction.INPUT)}
+        )
+        info = self.chip.get_line_info(2)
+        self.assertEqual(info.direction, Direction.INPUT)
+        info = self.chip.get_line_info(0)
+        self.assertEqual(info.direction, Direction.OUTPUT)
+        self.assertEqual(self.sim.get_value(0), SimVal.ACTIVE)
+        self.assertEqual(self.sim.get_value(3), SimVal.INACTIVE)
+        self.assertEqual(self.sim.get_value(6), SimVal.ACTIVE)
+
+    def test_reconfigure_subset_by_names(self):
+        self.req.reconfigure_lines_partial(
+            {"foo": gpiod.LineSettings(direction=Direction.INPUT)}
+        )
+        info = self.chip.get_line_info(3)
+        self.assertEqual(info.direction, Direction.INPUT)
+        self.assertEqual(self.sim.get_value(2), SimVal.ACTIVE)
+
+    def test_reconfigure_line_not_in_request(self):
+        with self.assertRaises(ValueError):
+            self.req.reconfigure_lines_partial(
+                {1: gpiod.LineSettings(direction=Direction.INPUT)}
+            )
+
+class LineRequestStats(TestCase):
+    def setUp(self):
+        self.sim = gpiosim.Chip(num_lines=4)
+        self.req = gpiod.request_lines(
+            self.sim.dev_path,
+            {
+                0: gpiod.LineSettings(direction=Direction.INPUT),
+                1: gpiod.LineSettings(direction=Direction.OUTPUT),
+            },
+        )
+
+    def tearDown(self):
+        self.req.release()
+        del self.req
+        del self.sim
+
+    def test_calls_into_the_kernel_are_counted(self):
+        self.req.get_value(0)
+        self.req.get_value(0)
+        self.req.set_value(1, Value.ACTIVE)
+
+        stats = self.req.get_stats()
+        self.assertEqual(stats.num_get_ioctls, 2)
+        self.assertEqual(stats.num_set_ioctls, 1)
+        self.assertEqual(stats.num_reads, 0)
+        self.assertGreaterEqual(stats.ioctl_time_ns, stats.max_ioctl_time_ns)
+
+    def test_reset_stats(self):
+        self.req.get_value(0)
+        self.req.reset_stats()
+
+        self.assertEqual(self.req.get_stats().num_get_ioctls, 0)
+
+    def test_stats_are_immutable(self):
+        stats = self.req.get_stats()
+
+        with self.assertRaises(AttributeError):
+            stats.num_reads = 4
+
+
 class ReleasedLineRequestCannotBeUsed(TestCase):
     def test_using_released_line_request(self):
         sim = gpiosim.Chip()
@@ -58,3 +58,23 @@ class VersionString(TestCase):
 
     def test_module_version(self):
         self.assertRegex(gpiod.__version__, VersionString.VERSION_PATTERN)
+
+
+class EventBufferCapacity(TestCase):
+    def tearDown(self):
+        gpiod.set_default_event_buffer_capacity(0)
+        gpiod.set_max_event_buffer_capacity(0)
+
+    def test_defaults(self):
+        self.assertEqual(gpiod.default_event_buffer_capacity(), 64)
+        self.assertEqual(gpiod.max_event_buffer_capacity(), 1024)
+
+    def test_set_and_clamp(self):
+        gpiod.set_default_event_buffer_capacity(16)
+        gpiod.set_max_event_buffer_capacity(4096)
+        self.assertEqual(gpiod.default_event_buffer_capacity(), 16)
+        self.assertEqual(gpiod.max_event_buffer_capacity(), 1024)
+
+    def test_negative_capacity(self):
+        with self.assertRaises(ValueError):
+            gpiod.set_default_event_buffer_capacity(-1)
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+//
+// Overhead of the bindings on top of the core library, mirroring the
+// gpiod-bench program of the C library. Needs root privileges to create
+// gpio-sim chips, run with:
+//
+//   cargo bench
+
+use std::time::{Duration, Instant};
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use gpiosim_sys::{Pull, Sim};
+use libgpiod::{
+    chip::Chip,
+    line::{self, Direction, Edge, Offset, Value},
+    request,
+};
+
+const NGPIO: usize = 8;
+/// Largest edge event queue the kernel allows for a single line.
+const EDGE_EVENT_QUEUE_SIZE: usize = 1024;
+
+fn request_lines(
+    sim: &Sim,
+    offsets: &[Offset],
+    lsettings: line::Settings,
+    event_buffer_size: usize,
+) -> request::Request {
+    let chip = Chip::open(&sim.dev_path()).unwrap();
+    let mut rconfig = request::Config::new().unwrap();
+    let mut lconfig = line::Config::new().unwrap();
+
+    rconfig.set_event_buffer_size(event_buffer_size);
+    lconfig.add_line_settings(offsets, lsettings).unwrap();
+
+    chip.request_lines(Some(&rconfig), &lconfig).unwrap()
+}
+
+fn values(c: &mut Criterion) {
+    let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+    let offsets: Vec<Offset> = (0..NGPIO as Offset).collect();
+    let mut lsettings = line::Settings::new().unwrap();
+
+    lsettings.set_direction(Direction::Output).unwrap();
+    let mut request = request_lines(&sim, &offsets, lsettings, 0);
+    let vals = vec![Value::Active; NGPIO];
+
+    let mut group = c.benchmark_group("values");
+
+    group.bench_function("value", |b| b.iter(|| request.value(black_box(3)).unwrap()));
+    group.bench_function("values", |b| b.iter(|| request.values().unwrap()));
+    group.bench_function("values_mask", |b| {
+        b.iter(|| request.values_mask(black_box(0xff)).unwrap())
+    });
+    group.bench_function("set_value", |b| {
+        b.iter(|| {
+            request.set_value(black_box(3), Value::Active).unwrap();
+        })
+    });
+    group.bench_function("set_values", |b| {
+        b.iter(|| {
+            request.set_values(black_box(&vals)).unwrap();
+        })
+    });
+    group.bench_function("set_values_mask", |b| {
+        b.iter(|| {
+            request.set_values_mask(black_box(0xff), 0x55).unwrap();
+        })
+    });
+
+    group.finish();
+}
+
+fn edge_events(c: &mut Criterion) {
+    let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+    let mut lsettings = line::Settings::new().unwrap();
+
+    lsettings.set_edge_detection(Some(Edge::Both)).unwrap();
+    let request = request_lines(&sim, &[0], lsettings, EDGE_EVENT_QUEUE_SIZE);
+
+    let mut group = c.benchmark_group("read_edge_events");
+    group.throughput(Throughput::Elements(1));
+
+    for capacity in [1, 16, 64, 1024] {
+        let mut buffer = request::Buffer::new(capacity).unwrap();
+
+        group.bench_with_input(BenchmarkId::from_parameter(capacity), &capacity, |b, _| {
+            // Every iteration reads a single event. They're queued in the
+            // kernel in batches before the clock starts, generating them
+            // is orders of magnitude slower than reading.
+            b.iter_custom(|iters| {
+                let mut elapsed = Duration::ZERO;
+                let mut remaining = iters as usize;
+                let mut pull = Pull::Up;
+
+                while remaining > 0 {
+                    let batch = remaining.min(EDGE_EVENT_QUEUE_SIZE);
+
+                    for _ in 0..batch {
+                        sim.set_pull(0, pull).unwrap();
+                        pull = if pull == Pull::Up {
+                            Pull::Down
+                        } else {
+                            Pull::Up
+                        };
+                    }
+
+                    let start = Instant::now();
+                    let mut pending = batch;
+                    while pending > 0 {
+                        pending -= buffer.read_edge_events(&request).unwrap().len();
+                    }
+                    elapsed += start.elapsed();
+
+                    remaining -= batch;
+                }
+
+                elapsed
+            })
+        });
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, values, edge_events);
+criterion_main!(benches);
@@ -8,32 +8,22 @@ use std::env;
 use std::path::Path;
 
 use libgpiod::{
-    chip::Chip,
-    line::{Direction, Offset},
+    inventory::{self, ChipRecord, LineRecord},
+    line::Direction,
     Error, Result,
 };
 
-fn line_info(chip: &Chip, offset: Offset) -> Result<()> {
-    let info = chip.line_info(offset)?;
-    let off = info.offset();
+fn line_info(info: &LineRecord) {
+    let name = info.name.as_deref().unwrap_or("unused");
+    let consumer = info.consumer.as_deref().unwrap_or("unnamed");
 
-    let name = match info.name() {
-        Ok(name) => name,
-        _ => "unused",
-    };
-
-    let consumer = match info.consumer() {
-        Ok(name) => name,
-        _ => "unnamed",
-    };
-
-    let low = if info.is_active_low() {
+    let low = if info.active_low {
         "active-low"
     } else {
         "active-high"
     };
 
-    let dir = match info.direction()? {
+    let dir = match info.direction {
         Direction::AsIs => "None",
         Direction::Input => "Input",
         Direction::Output => "Output",
@@ -45,29 +35,22 @@ fn line_info(chip: &Chip, offset: Offset) -> Result<()> {
               \t{:>10}\
               \t{:>6}\
               \t{:>14}",
-        off, name, consumer, dir, low
+        info.offset, name, consumer, dir, low
     );
-
-    Ok(())
 }
 
-fn chip_info(chip: &Chip) -> Result<()> {
-    let info = chip.info()?;
-    let ngpio = info.num_lines();
-
-    println!("GPIO Chip name: {}", info.name()?);
-    println!("\tlabel: {}", info.label()?);
-    println!("\tpath: {}", chip.path()?);
-    println!("\tngpio: {}\n", ngpio);
+fn chip_info(chip: &ChipRecord) {
+    println!("GPIO Chip name: {}", chip.name);
+    println!("\tlabel: {}", chip.label);
+    println!("\tpath: {}", chip.path.display());
+    println!("\tngpio: {}\n", chip.lines.len());
 
     println!("\tLine information:");
 
-    for offset in 0..ngpio {
-        line_info(chip, offset as Offset)?;
+    for line in chip.lines.iter() {
+        line_info(line);
     }
     println!("\n");
-
-    Ok(())
 }
 
 fn main() -> Result<()> {
@@ -78,8 +61,8 @@ fn main() -> Result<()> {
     }
 
     if args.len() == 1 {
-        for chip in libgpiod::gpiochip_devices(&Path::new("/dev"))? {
-            chip_info(&chip)?;
+        for chip in inventory::chip_records_parallel(&Path::new("/dev"))? {
+            chip_info(&chip);
         }
     } else {
         let index = args[1]
@@ -87,9 +70,7 @@ fn main() -> Result<()> {
             .map_err(|_| Error::InvalidArguments)?;
         let path = format!("/dev/gpiochip{}", index);
         if libgpiod::is_gpiochip_device(&path) {
-            let chip = Chip::open(&path)?;
-
-            chip_info(&chip)?;
+            chip_info(&ChipRecord::read(&path)?);
         }
     }
 
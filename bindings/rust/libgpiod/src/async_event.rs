@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::future;
+use std::os::unix::prelude::{AsRawFd, RawFd};
+use std::pin::Pin;
+use std::task::{Context, Poll};
+use std::time::Duration;
+
+use futures_core::Stream;
+use tokio::io::unix::AsyncFd;
+
+use super::{
+    chip::{info, Chip},
+    request::{Buffer, Event, Events, Request},
+    Error, Result,
+};
+
+/// Asynchronous stream of edge events
+///
+/// Registers the file descriptor of a line request with the tokio reactor and
+/// reads edge events into a buffer reused for the entire lifetime of the
+/// stream. Events are only read from the kernel once all events of the
+/// previous read were consumed, so a slow consumer leaves them queued in the
+/// kernel instead of in an ever-growing queue in user space.
+///
+/// The stream never ends on its own. Must be created from within a tokio
+/// runtime.
+pub struct EdgeEventStream<'a> {
+    request: &'a Request,
+    fd: AsyncFd<RawFd>,
+    buffer: Buffer,
+    num_events: usize,
+    next_event: usize,
+}
+
+impl<'a> EdgeEventStream<'a> {
+    pub(crate) fn new(request: &'a Request, buffer: Buffer) -> Result<Self> {
+        // The descriptor stays owned by the request, AsyncFd never closes it.
+        let fd = AsyncFd::new(request.as_raw_fd()).map_err(|_| Error::IoError)?;
+
+        Ok(Self {
+            request,
+            fd,
+            buffer,
+            num_events: 0,
+            next_event: 0,
+        })
+    }
+
+    fn poll_read_into_buffer(&mut self, cx: &mut Context<'_>) -> Poll<Result<usize>> {
+        loop {
+            let mut guard = match self.fd.poll_read_ready(cx) {
+                Poll::Ready(Ok(guard)) => guard,
+                Poll::Ready(Err(_)) => return Poll::Ready(Err(Error::IoError)),
+                Poll::Pending => return Poll::Pending,
+            };
+
+            // Readiness may be stale, reading must never block the executor.
+            if !self.request.wait_edge_events(Some(Duration::ZERO))? {
+                guard.clear_ready();
+                continue;
+            }
+
+            // Nothing is left to hand out should the read fail.
+            self.next_event = 0;
+            self.num_events = 0;
+            self.num_events = self.buffer.read_edge_events(self.request)?.len();
+
+            return Poll::Ready(Ok(self.num_events));
+        }
+    }
+
+    /// Wait for and read the next batch of edge events.
+    ///
+    /// The events are borrowed from the buffer of the stream without copying.
+    /// Events of a previous batch not yet consumed by the `Stream`
+    /// implementation are discarded.
+    pub async fn read_edge_events(&mut self) -> Result<Events<'_>> {
+        let num_events = future::poll_fn(|cx| self.poll_read_into_buffer(cx)).await?;
+
+        // Everything is handed out at once.
+        self.next_event = self.num_events;
+
+        Ok(Events::new(&mut self.buffer, num_events))
+    }
+
+    /// Get the buffer the events are read into.
+    pub fn buffer(&self) -> &Buffer {
+        &self.buffer
+    }
+}
+
+impl<'a> Stream for EdgeEventStream<'a> {
+    type Item = Result<Event>;
+
+    fn poll_next(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let this = self.get_mut();
+
+        while this.next_event == this.num_events {
+            match this.poll_read_into_buffer(cx) {
+                Poll::Ready(Ok(_)) => {}
+                Poll::Ready(Err(err)) => return Poll::Ready(Some(Err(err))),
+                Poll::Pending => return Poll::Pending,
+            }
+        }
+
+        let index = this.next_event;
+        this.next_event += 1;
+
+        // Items must outlive the next read, hand out copies of the events.
+        Poll::Ready(Some(this.buffer.event(index).and_then(Event::event_clone)))
+    }
+}
+
+/// Asynchronous stream of line status change events
+///
+/// Registers the file descriptor of a chip with the tokio reactor. Events are
+/// read from the kernel one at a time as the stream is polled, pending events
+/// stay queued in the kernel.
+///
+/// The stream never ends on its own. Must be created from within a tokio
+/// runtime.
+pub struct InfoEventStream<'a> {
+    chip: &'a Chip,
+    fd: AsyncFd<RawFd>,
+}
+
+impl<'a> InfoEventStream<'a> {
+    pub(crate) fn new(chip: &'a Chip) -> Result<Self> {
+        // The descriptor stays owned by the chip, AsyncFd never closes it.
+        let fd = AsyncFd::new(chip.as_raw_fd()).map_err(|_| Error::IoError)?;
+
+        Ok(Self { chip, fd })
+    }
+}
+
+impl<'a> Stream for InfoEventStream<'a> {
+    type Item = Result<info::Event>;
+
+    fn poll_next(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let this = self.get_mut();
+
+        loop {
+            let mut guard = match this.fd.poll_read_ready(cx) {
+                Poll::Ready(Ok(guard)) => guard,
+                Poll::Ready(Err(_)) => return Poll::Ready(Some(Err(Error::IoError))),
+                Poll::Pending => return Poll::Pending,
+            };
+
+            // Readiness may be stale, reading must never block the executor.
+            match this.chip.wait_info_event(Some(Duration::ZERO)) {
+                Ok(true) => return Poll::Ready(Some(this.chip.read_info_event())),
+                Ok(false) => guard.clear_ready(),
+                Err(err) => return Poll::Ready(Some(Err(err))),
+            }
+        }
+    }
+}
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::ffi::CStr;
+use std::ops::Range;
+use std::os::raw::c_char;
+use std::path::Path;
+use std::ptr;
+use std::slice;
+use std::time::Duration;
+
+use super::{
+    gpiod,
+    line::{EdgeKind, EventClock, Offset},
+    Error, OperationType, Result,
+};
+
+/// Line recorded in a capture file.
+#[derive(Clone, Debug, Eq, PartialEq)]
+pub struct Line {
+    /// Number of the chip in the order given to gpiomon.
+    pub chip_num: u32,
+    /// Offset of the line on its chip.
+    pub offset: Offset,
+    /// Name of the chip.
+    pub chip_name: String,
+    /// Name of the line, empty if unnamed.
+    pub line_name: String,
+}
+
+/// Record of an edge event in a capture file.
+///
+/// Has the layout of the records as stored in the file, so slices of records
+/// borrow the mapping of the capture in place.
+#[derive(Copy, Clone, Debug)]
+#[repr(transparent)]
+pub struct Record(gpiod::gpiod_capture_record);
+
+impl Record {
+    /// Get the timestamp of the event.
+    pub fn timestamp(&self) -> Duration {
+        Duration::from_nanos(self.0.timestamp_ns)
+    }
+
+    /// Get the number of the chip in the order given to gpiomon.
+    pub fn chip_num(&self) -> u32 {
+        self.0.chip_num
+    }
+
+    /// Get the offset of the line on which the event was triggered.
+    pub fn line_offset(&self) -> Offset {
+        self.0.offset
+    }
+
+    /// Get the event type.
+    pub fn event_type(&self) -> Result<EdgeKind> {
+        EdgeKind::new(self.0.event_type as gpiod::gpiod_edge_event_type)
+    }
+
+    /// Get the global sequence number of the event.
+    pub fn global_seqno(&self) -> usize {
+        self.0.global_seqno as usize
+    }
+
+    /// Get the event sequence number specific to concerned line.
+    pub fn line_seqno(&self) -> usize {
+        self.0.line_seqno as usize
+    }
+}
+
+/// Capture file reader
+///
+/// Memory-maps a capture file written by 'gpiomon --capture'. Records are
+/// indexed in the order they were written, the oldest one still in the ring
+/// being at index 0. They are never copied: the slices returned by the reader
+/// borrow the mapping.
+#[derive(Debug, Eq, PartialEq)]
+pub struct Reader {
+    reader: *mut gpiod::gpiod_capture_reader,
+}
+
+// SAFETY: The reader only reads the mapping after it was opened and is
+// freed when dropped.
+unsafe impl Send for Reader {}
+// SAFETY: None of the methods taking `&self` modify the reader.
+unsafe impl Sync for Reader {}
+
+impl Reader {
+    /// Open a capture file.
+    pub fn open<P: AsRef<Path>>(path: &P) -> Result<Self> {
+        // Null-terminate the string
+        let path = path.as_ref().to_string_lossy() + "\0";
+
+        // SAFETY: The `gpiod_capture_reader` returned by libgpiod is guaranteed to live as
+        // long as the `struct Reader`.
+        let reader = unsafe { gpiod::gpiod_capture_reader_open(path.as_ptr() as *const c_char) };
+        if reader.is_null() {
+            return Err(Error::OperationFailed(
+                OperationType::CaptureReaderOpen,
+                errno::errno(),
+            ));
+        }
+
+        Ok(Self { reader })
+    }
+
+    /// Get the clock the timestamps of the capture come from.
+    pub fn event_clock(&self) -> Result<EventClock> {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        EventClock::new(unsafe { gpiod::gpiod_capture_reader_get_event_clock(self.reader) })
+    }
+
+    /// Get the lines recorded in the capture.
+    pub fn lines(&self) -> Result<Vec<Line>> {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        let num_lines = unsafe { gpiod::gpiod_capture_reader_get_num_lines(self.reader) };
+        let mut lines = Vec::with_capacity(num_lines);
+
+        for index in 0..num_lines {
+            // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here and the index is
+            // in range, the returned line lives as long as the reader.
+            let line = unsafe { &*gpiod::gpiod_capture_reader_get_line(self.reader, index) };
+
+            lines.push(Line {
+                chip_num: line.chip_num,
+                offset: line.offset,
+                chip_name: name(&line.chip_name)?,
+                line_name: name(&line.line_name)?,
+            });
+        }
+
+        Ok(lines)
+    }
+
+    /// Get the number of records in the capture.
+    pub fn num_records(&self) -> u64 {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_capture_reader_get_num_records(self.reader) }
+    }
+
+    /// Get the number of records overwritten after the ring wrapped.
+    pub fn num_lost(&self) -> u64 {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_capture_reader_get_num_lost(self.reader) }
+    }
+
+    /// Get a record of the capture.
+    pub fn record(&self, index: u64) -> Result<&Record> {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here. `Record` has the
+        // representation of `gpiod_capture_record`.
+        let record =
+            unsafe { gpiod::gpiod_capture_reader_get_record(self.reader, index) as *const Record };
+        if record.is_null() {
+            return Err(Error::InvalidArguments);
+        }
+
+        // SAFETY: The record lives in the mapping, which lives as long as the reader.
+        Ok(unsafe { &*record })
+    }
+
+    /// Get the records stored contiguously from an index on.
+    ///
+    /// The slice is empty if the index is past the last record and shorter
+    /// than the rest of the capture if it wraps around the end of the ring.
+    pub fn records(&self, index: u64) -> &[Record] {
+        let mut records = ptr::null();
+
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        let num =
+            unsafe { gpiod::gpiod_capture_reader_get_records(self.reader, index, &mut records) };
+        if num == 0 {
+            return &[];
+        }
+
+        // SAFETY: libgpiod returned `num` contiguous records of the mapping, which lives as
+        // long as the reader. `Record` has the representation of `gpiod_capture_record`.
+        unsafe { slice::from_raw_parts(records as *const Record, num) }
+    }
+
+    /// Get the slices of records covering a range of indexes.
+    ///
+    /// There are at most two of them as the ring wraps only once.
+    pub fn spans(&self, range: Range<u64>) -> Spans<'_> {
+        Spans {
+            reader: self,
+            index: range.start,
+            end: range.end.min(self.num_records()),
+        }
+    }
+
+    /// Find the first record not older than a timestamp.
+    ///
+    /// Returns the number of records if all of them are older.
+    pub fn find(&self, timestamp: Duration) -> u64 {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        unsafe {
+            gpiod::gpiod_capture_reader_find(
+                self.reader,
+                timestamp.as_nanos().try_into().unwrap_or(u64::MAX),
+            )
+        }
+    }
+}
+
+impl Drop for Reader {
+    /// Unmap the capture and release all associated resources.
+    fn drop(&mut self) {
+        // SAFETY: `gpiod_capture_reader` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_capture_reader_close(self.reader) }
+    }
+}
+
+/// Iterator over the contiguous slices of records of a range.
+pub struct Spans<'a> {
+    reader: &'a Reader,
+    index: u64,
+    end: u64,
+}
+
+impl<'a> Iterator for Spans<'a> {
+    type Item = &'a [Record];
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.index >= self.end {
+            return None;
+        }
+
+        let records = self.reader.records(self.index);
+        let len = records
+            .len()
+            .min((self.end - self.index).try_into().unwrap_or(usize::MAX));
+
+        self.index += len as u64;
+        Some(&records[..len])
+    }
+}
+
+fn name(name: &[c_char]) -> Result<String> {
+    // SAFETY: libgpiod null-terminates the names of the lines.
+    unsafe { CStr::from_ptr(name.as_ptr()) }
+        .to_str()
+        .map(String::from)
+        .map_err(Error::StringNotUtf8)
+}
@@ -5,6 +5,9 @@
 pub mod info {
     /// GPIO chip info event related definitions.
     pub use crate::info_event::*;
+
+    #[cfg(feature = "async")]
+    pub use crate::async_event::InfoEventStream;
 }
 
 use std::cmp::Ordering;
@@ -18,8 +21,12 @@ use std::time::Duration;
 
 use super::{
     gpiod,
+    inventory::LineRecord,
     line::{self, Offset},
-    request, Error, OperationType, Result,
+    request,
+    stats::Stats,
+    wait_cancel::WaitCancel,
+    Error, OperationType, Result,
 };
 
 #[derive(Debug, Eq, PartialEq)]
@@ -82,6 +89,21 @@ impl Chip {
         Info::new(self.ichip.clone())
     }
 
+    /// Get a snapshot of the I/O statistics of the chip.
+    pub fn stats(&self) -> Result<Stats> {
+        // SAFETY: `gpiod_chip` is guaranteed to be valid here.
+        Stats::from_raw(
+            unsafe { gpiod::gpiod_chip_get_stats(self.ichip.chip) },
+            OperationType::ChipGetStats,
+        )
+    }
+
+    /// Zero the I/O statistics of the chip.
+    pub fn reset_stats(&self) {
+        // SAFETY: `gpiod_chip` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_chip_reset_stats(self.ichip.chip) }
+    }
+
     /// Get the path used to find the chip.
     pub fn path(&self) -> Result<&str> {
         // SAFETY: The string returned by libgpiod is guaranteed to live as long
@@ -110,6 +132,39 @@ impl Chip {
         line::Info::new(info)
     }
 
+    /// Get owned records of the state of all lines of the chip.
+    ///
+    /// All lines are read in a single snapshot, without creating a line info
+    /// object per line. The records are ordered by offset.
+    pub fn line_records(&self) -> Result<Vec<LineRecord>> {
+        // SAFETY: `gpiod_chip` is guaranteed to be valid here.
+        let snapshot = unsafe { gpiod::gpiod_line_info_snapshot_new(self.ichip.chip) };
+        if snapshot.is_null() {
+            return Err(Error::OperationFailed(
+                OperationType::ChipGetLineInfoSnapshot,
+                errno::errno(),
+            ));
+        }
+
+        // SAFETY: `gpiod_line_info_snapshot` is guaranteed to be valid here.
+        let num_lines = unsafe { gpiod::gpiod_line_info_snapshot_get_num_lines(snapshot) };
+
+        let records = (0..num_lines)
+            .map(|offset| {
+                // SAFETY: The offset is within the snapshot, the line info returned by
+                // libgpiod lives as long as the snapshot.
+                LineRecord::from_raw(unsafe {
+                    gpiod::gpiod_line_info_snapshot_get_line_info(snapshot, offset as Offset)
+                })
+            })
+            .collect();
+
+        // SAFETY: The records don't refer to the snapshot.
+        unsafe { gpiod::gpiod_line_info_snapshot_free(snapshot) };
+
+        records
+    }
+
     /// Get the current snapshot of information about the line at given offset and start watching
     /// it for future changes.
     pub fn watch_line_info(&self, offset: Offset) -> Result<line::Info> {
@@ -155,6 +210,38 @@ impl Chip {
         }
     }
 
+    /// Wait for line status events, returning early if the wait is cancelled.
+    ///
+    /// Returns `Ok(false)` if the wait timed out or `cancel` was triggered.
+    pub fn wait_info_event_cancellable(
+        &self,
+        timeout: Option<Duration>,
+        cancel: &WaitCancel,
+    ) -> Result<bool> {
+        let timeout = match timeout {
+            Some(x) => x.as_nanos() as i64,
+            // Block indefinitely
+            None => -1,
+        };
+
+        // SAFETY: `gpiod_chip` and `gpiod_wait_cancel` are guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_chip_wait_info_event_cancellable(self.ichip.chip, timeout, cancel.cancel)
+        };
+
+        match ret {
+            -1 => match errno::errno() {
+                errno::Errno(libc::ECANCELED) => Ok(false),
+                err => Err(Error::OperationFailed(
+                    OperationType::ChipWaitInfoEvent,
+                    err,
+                )),
+            },
+            0 => Ok(false),
+            _ => Ok(true),
+        }
+    }
+
     /// Read a single line status change event from the chip. If no events are
     /// pending, this function will block.
     pub fn read_info_event(&self) -> Result<info::Event> {
@@ -171,6 +258,14 @@ impl Chip {
         Ok(info::Event::new(event))
     }
 
+    /// Get an asynchronous stream of line status change events.
+    ///
+    /// Must be called from within a tokio runtime.
+    #[cfg(feature = "async")]
+    pub fn info_events(&self) -> Result<info::InfoEventStream<'_>> {
+        info::InfoEventStream::new(self)
+    }
+
     /// Map a GPIO line's name to its offset within the chip.
     pub fn line_offset_from_name(&self, name: &str) -> Result<Offset> {
         let name = CString::new(name).map_err(|_| Error::InvalidString)?;
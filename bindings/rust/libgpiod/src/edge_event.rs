@@ -83,6 +83,42 @@ impl Event {
     }
 }
 
+/// Plain-old-data record of a single edge event
+///
+/// Has the layout of the events as stored in the edge event buffer, so slices
+/// of records borrow the buffer in place and reading their fields involves no
+/// calls into libgpiod.
+#[derive(Copy, Clone, Debug)]
+#[repr(transparent)]
+pub struct Record(gpiod::gpiod_edge_event_record);
+
+impl Record {
+    /// Get the event type.
+    pub fn event_type(&self) -> Result<EdgeKind> {
+        EdgeKind::new(self.0.event_type)
+    }
+
+    /// Get the timestamp of the event.
+    pub fn timestamp(&self) -> Duration {
+        Duration::from_nanos(self.0.timestamp_ns)
+    }
+
+    /// Get the offset of the line on which the event was triggered.
+    pub fn line_offset(&self) -> Offset {
+        self.0.line_offset
+    }
+
+    /// Get the global sequence number of the event.
+    pub fn global_seqno(&self) -> usize {
+        self.0.global_seqno as usize
+    }
+
+    /// Get the event sequence number specific to concerned line.
+    pub fn line_seqno(&self) -> usize {
+        self.0.line_seqno as usize
+    }
+}
+
 impl Drop for Event {
     /// Free the edge event.
     fn drop(&mut self) {
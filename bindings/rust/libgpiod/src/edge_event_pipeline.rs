@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::any::Any;
+use std::os::raw::c_void;
+use std::panic::{self, AssertUnwindSafe};
+use std::slice;
+use std::time::Duration;
+
+use super::{
+    gpiod,
+    line::{Edge, Offset},
+    request::{Buffer, Record},
+    Error, OperationType, Result,
+};
+
+type StageFn = dyn FnMut(&mut [Record]) -> usize;
+
+struct Stage {
+    callback: Box<StageFn>,
+    panic: Option<Box<dyn Any + Send>>,
+}
+
+/// Edge event pipeline
+///
+/// Chains processing stages which are applied in place to the events stored
+/// in an edge event buffer. Each stage may drop some of the records by moving
+/// the ones it keeps to the front of the slice, the following stages only see
+/// the kept records.
+pub struct Pipeline {
+    pipeline: *mut gpiod::gpiod_edge_event_pipeline,
+    // Boxed so that the addresses passed to libgpiod stay valid.
+    #[allow(clippy::vec_box)]
+    stages: Vec<Box<Stage>>,
+}
+
+unsafe extern "C" fn run_stage(
+    records: *mut gpiod::gpiod_edge_event_record,
+    num_events: usize,
+    data: *mut c_void,
+) -> usize {
+    // SAFETY: `data` is the address of a stage owned by the pipeline, which outlives the
+    // processing.
+    let stage = unsafe { &mut *(data as *mut Stage) };
+
+    // Unwinding into libgpiod is undefined, the panic is resumed once the pipeline returns.
+    if stage.panic.is_some() || num_events == 0 {
+        return num_events;
+    }
+
+    // SAFETY: libgpiod passes `num_events` valid records, `Record` has the representation of
+    // `gpiod_edge_event_record`.
+    let records = unsafe { slice::from_raw_parts_mut(records as *mut Record, num_events) };
+
+    match panic::catch_unwind(AssertUnwindSafe(|| (stage.callback)(records))) {
+        Ok(num_kept) => num_kept,
+        Err(payload) => {
+            stage.panic = Some(payload);
+            num_events
+        }
+    }
+}
+
+impl Pipeline {
+    /// Create a new, empty pipeline.
+    pub fn new() -> Result<Self> {
+        // SAFETY: The `gpiod_edge_event_pipeline` returned by libgpiod is guaranteed to live as
+        // long as the `struct Pipeline`.
+        let pipeline = unsafe { gpiod::gpiod_edge_event_pipeline_new() };
+        if pipeline.is_null() {
+            return Err(Error::OperationFailed(
+                OperationType::EdgeEventPipelineNew,
+                errno::errno(),
+            ));
+        }
+
+        Ok(Self {
+            pipeline,
+            stages: Vec::new(),
+        })
+    }
+
+    fn check(&self, ret: i32) -> Result<&Self> {
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::EdgeEventPipelineAddStage,
+                errno::errno(),
+            ))
+        } else {
+            Ok(self)
+        }
+    }
+
+    /// Append a user-defined stage.
+    ///
+    /// The closure is passed the records kept by the preceding stages and
+    /// returns the number of records it kept at the front of the slice.
+    /// Panics are propagated by `process()` once the remaining stages have
+    /// run.
+    pub fn add_stage<F>(&mut self, callback: F) -> Result<&Self>
+    where
+        F: FnMut(&mut [Record]) -> usize + 'static,
+    {
+        let mut stage = Box::new(Stage {
+            callback: Box::new(callback),
+            panic: None,
+        });
+        let data = stage.as_mut() as *mut Stage as *mut c_void;
+
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here and the stage
+        // lives as long as the pipeline.
+        let ret = unsafe {
+            gpiod::gpiod_edge_event_pipeline_add_stage(self.pipeline, Some(run_stage), data)
+        };
+        if ret == 0 {
+            self.stages.push(stage);
+        }
+
+        self.check(ret)
+    }
+
+    /// Append a stage keeping only the selected edges of a line.
+    ///
+    /// `None` drops all events of the line.
+    pub fn add_edge_filter(&mut self, offset: Offset, keep: Option<Edge>) -> Result<&Self> {
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_edge_event_pipeline_add_edge_filter(
+                self.pipeline,
+                offset,
+                Edge::gpiod_edge(keep),
+            )
+        };
+
+        self.check(ret)
+    }
+
+    /// Append a stage dropping the events of a line following the last kept
+    /// one closer than a minimum interval.
+    pub fn add_min_interval(&mut self, offset: Offset, interval: Duration) -> Result<&Self> {
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_edge_event_pipeline_add_min_interval(
+                self.pipeline,
+                offset,
+                interval.as_nanos().try_into().unwrap_or(u64::MAX),
+            )
+        };
+
+        self.check(ret)
+    }
+
+    /// Get the number of stages.
+    pub fn num_stages(&self) -> usize {
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_edge_event_pipeline_get_num_stages(self.pipeline) }
+    }
+
+    /// Get the number of events dropped by a stage since the pipeline was
+    /// created or reset.
+    pub fn num_dropped(&self, stage: usize) -> Result<u64> {
+        if stage >= self.num_stages() {
+            return Err(Error::InvalidArguments);
+        }
+
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here.
+        Ok(unsafe { gpiod::gpiod_edge_event_pipeline_get_num_dropped(self.pipeline, stage) })
+    }
+
+    /// Clear the state of the built-in stages and the drop counters.
+    pub fn reset(&mut self) {
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_edge_event_pipeline_reset(self.pipeline) }
+    }
+
+    /// Pass the events stored in a buffer through the pipeline.
+    ///
+    /// Returns the number of events left in the buffer.
+    pub fn process(&mut self, buffer: &mut Buffer) -> Result<usize> {
+        // SAFETY: `gpiod_edge_event_pipeline` and `gpiod_edge_event_buffer` are guaranteed to
+        // be valid here.
+        let ret = unsafe { gpiod::gpiod_edge_event_pipeline_process(self.pipeline, buffer.buffer) };
+
+        if let Some(payload) = self.stages.iter_mut().find_map(|stage| stage.panic.take()) {
+            panic::resume_unwind(payload);
+        }
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::EdgeEventPipelineProcess,
+                errno::errno(),
+            ))
+        } else {
+            Ok(ret as usize)
+        }
+    }
+}
+
+impl Drop for Pipeline {
+    /// Free the pipeline and release all associated resources.
+    fn drop(&mut self) {
+        // SAFETY: `gpiod_edge_event_pipeline` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_edge_event_pipeline_free(self.pipeline) }
+    }
+}
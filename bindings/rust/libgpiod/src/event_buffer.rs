@@ -3,10 +3,12 @@
 // SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
 
 use std::ptr;
+use std::slice;
 
 use super::{
     gpiod,
-    request::{Event, Request},
+    line::{EdgeKind, Offset},
+    request::{Event, Record, Request},
     Error, OperationType, Result,
 };
 
@@ -68,12 +70,26 @@ pub struct Buffer {
 impl Buffer {
     /// Create a new edge event buffer.
     ///
-    /// If capacity equals 0, it will be set to a default value of 64. If
-    /// capacity is larger than 1024, it will be limited to 1024.
+    /// If capacity equals 0, it will be set to the process-wide default
+    /// capacity, 64 unless changed with `set_default_event_buffer_capacity()`.
+    /// If capacity is larger than 1024, it will be limited to 1024.
     pub fn new(capacity: usize) -> Result<Self> {
         // SAFETY: The `gpiod_edge_event_buffer` returned by libgpiod is guaranteed to live as long
         // as the `struct Buffer`.
-        let buffer = unsafe { gpiod::gpiod_edge_event_buffer_new(capacity) };
+        Self::from_raw(unsafe { gpiod::gpiod_edge_event_buffer_new(capacity) })
+    }
+
+    /// Create a new adaptive edge event buffer.
+    ///
+    /// The buffer starts at the process-wide default capacity and doubles
+    /// every time a read fills it, up to the process-wide maximum capacity.
+    pub fn adaptive() -> Result<Self> {
+        // SAFETY: The `gpiod_edge_event_buffer` returned by libgpiod is guaranteed to live as long
+        // as the `struct Buffer`.
+        Self::from_raw(unsafe { gpiod::gpiod_edge_event_buffer_new_adaptive() })
+    }
+
+    fn from_raw(buffer: *mut gpiod::gpiod_edge_event_buffer) -> Result<Self> {
         if buffer.is_null() {
             return Err(Error::OperationFailed(
                 OperationType::EdgeEventBufferNew,
@@ -95,12 +111,11 @@ impl Buffer {
         self.events.len()
     }
 
-    /// Get edge events from a line request.
-    ///
-    /// This function will block if no event was queued for the line.
-    pub fn read_edge_events(&mut self, request: &Request) -> Result<Events> {
-        for i in 0..self.events.len() {
-            self.events[i] = ptr::null_mut();
+    fn read(&mut self, request: &Request) -> Result<usize> {
+        // Only events of the previous read can have been looked up.
+        let num_events = self.len();
+        for event in &mut self.events[..num_events] {
+            *event = ptr::null_mut();
         }
 
         // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
@@ -120,16 +135,108 @@ impl Buffer {
         } else {
             let ret = ret as usize;
 
+            // SAFETY: `gpiod_edge_event_buffer` is guaranteed to be valid here.
+            let capacity =
+                unsafe { gpiod::gpiod_edge_event_buffer_get_capacity(self.buffer) as usize };
+
+            // Adaptive buffers grow right before reads, let the next one fill the new capacity.
+            if capacity > self.events.len() {
+                self.events.resize(capacity, ptr::null_mut());
+            }
+
             if ret > self.events.len() {
                 Err(Error::TooManyEvents(ret, self.events.len()))
             } else {
-                Ok(Events::new(self, ret))
+                Ok(ret)
             }
         }
     }
 
+    /// Get edge events from a line request.
+    ///
+    /// This function will block if no event was queued for the line.
+    pub fn read_edge_events(&mut self, request: &Request) -> Result<Events> {
+        let num_events = self.read(request)?;
+
+        Ok(Events::new(self, num_events))
+    }
+
+    /// Get edge events from a line request as plain-old-data records.
+    ///
+    /// This function will block if no event was queued for the line. The
+    /// slice borrows the events kept by the buffer in place, reading them
+    /// involves no calls into libgpiod.
+    pub fn read_edge_event_records(&mut self, request: &Request) -> Result<&[Record]> {
+        self.read(request)?;
+        self.records()
+    }
+
+    /// Get the number of events read into the buffer by the last call to
+    /// `read_edge_events()`.
+    pub fn len(&self) -> usize {
+        // SAFETY: `gpiod_edge_event_buffer` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_edge_event_buffer_get_num_events(self.buffer) }
+    }
+
+    /// Check if the buffer holds no events.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    fn column<'a, T>(&'a self, data: *const T) -> Result<&'a [T]> {
+        if data.is_null() {
+            return Err(Error::OperationFailed(
+                OperationType::EdgeEventBufferGetColumn,
+                errno::errno(),
+            ));
+        }
+
+        // SAFETY: libgpiod guarantees the array holds as many elements as there are events in
+        // the buffer and keeps it unchanged until the next read, which requires a mutable
+        // borrow of the buffer.
+        Ok(unsafe { slice::from_raw_parts(data, self.len()) })
+    }
+
+    /// Get the timestamps of all buffered events in nanoseconds.
+    ///
+    /// The slice borrows the array kept by the buffer without copying.
+    pub fn timestamps_ns(&self) -> Result<&[u64]> {
+        // SAFETY: `gpiod_edge_event_buffer` is guaranteed to be valid here.
+        self.column(unsafe { gpiod::gpiod_edge_event_buffer_get_timestamps_ns(self.buffer) })
+    }
+
+    /// Get the line offsets of all buffered events.
+    ///
+    /// The slice borrows the array kept by the buffer without copying.
+    pub fn line_offsets(&self) -> Result<&[Offset]> {
+        // SAFETY: `gpiod_edge_event_buffer` is guaranteed to be valid here.
+        self.column(unsafe { gpiod::gpiod_edge_event_buffer_get_line_offsets(self.buffer) })
+    }
+
+    /// Get the types of all buffered events.
+    ///
+    /// The slice borrows the array kept by the buffer without copying.
+    pub fn event_types(&self) -> Result<&[EdgeKind]> {
+        // SAFETY: `gpiod_edge_event_buffer` is guaranteed to be valid here. `EdgeKind` has the
+        // representation of `gpiod_edge_event_type` and libgpiod only stores valid event types.
+        self.column(unsafe {
+            gpiod::gpiod_edge_event_buffer_get_event_types(self.buffer) as *const EdgeKind
+        })
+    }
+
+    /// Get all buffered events as plain-old-data records.
+    ///
+    /// The slice borrows the events kept by the buffer in place.
+    pub fn records(&self) -> Result<&[Record]> {
+        // SAFETY: `gpiod_edge_event_buffer` is guaranteed to be valid here. `Record` has the
+        // representation of `gpiod_edge_event_record`.
+        self.column(unsafe {
+            gpiod::gpiod_edge_event_buffer_get_records(self.buffer) as *const Record
+        })
+    }
+
     /// Read an event stored in the buffer.
-    fn event<'a>(&mut self, index: usize) -> Result<&'a Event> {
+    pub(crate) fn event<'a>(&mut self, index: usize) -> Result<&'a Event> {
         if self.events[index].is_null() {
             // SAFETY: The `gpiod_edge_event` returned by libgpiod is guaranteed to live as long
             // as the `struct Event`.
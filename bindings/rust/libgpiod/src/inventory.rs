@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::thread;
+use std::time::Duration;
+
+use super::{
+    chip::Chip,
+    gpiod, is_gpiochip_device,
+    line::{self, Bias, Direction, Drive, Edge, EventClock, Offset},
+    Error, Result,
+};
+
+/// Owned record of the state of a line.
+///
+/// Unlike `line::Info`, a record doesn't hold on to any libgpiod object and can
+/// be sent across threads and stored for as long as needed.
+#[derive(Clone, Debug, Eq, PartialEq)]
+pub struct LineRecord {
+    /// Offset of the line within its chip.
+    pub offset: Offset,
+    /// Name of the line, if it has one.
+    pub name: Option<String>,
+    /// Consumer of the line, if it is used and the consumer has a name.
+    pub consumer: Option<String>,
+    /// True if the line is in use.
+    pub used: bool,
+    /// Direction of the line.
+    pub direction: Direction,
+    /// True if the line is active-low.
+    pub active_low: bool,
+    /// Bias setting of the line.
+    pub bias: Option<Bias>,
+    /// Drive setting of the line.
+    pub drive: Drive,
+    /// Edge detection setting of the line.
+    pub edge_detection: Option<Edge>,
+    /// Clock used for the edge event timestamps of the line.
+    pub event_clock: EventClock,
+    /// Debounce period of the line.
+    pub debounce_period: Duration,
+}
+
+impl LineRecord {
+    /// Copy the state of a line info object owned by libgpiod.
+    pub(crate) fn from_raw(info: *mut gpiod::gpiod_line_info) -> Result<Self> {
+        // The info belongs to the caller, don't free it on drop.
+        let info = line::Info::new_from_event(info)?;
+
+        Ok(Self {
+            offset: info.offset(),
+            name: info.name().ok().map(String::from),
+            consumer: info.consumer().ok().map(String::from),
+            used: info.is_used(),
+            direction: info.direction()?,
+            active_low: info.is_active_low(),
+            bias: info.bias()?,
+            drive: info.drive()?,
+            edge_detection: info.edge_detection()?,
+            event_clock: info.event_clock()?,
+            debounce_period: info.debounce_period(),
+        })
+    }
+}
+
+/// Owned record of a chip and all of its lines.
+#[derive(Clone, Debug, Eq, PartialEq)]
+pub struct ChipRecord {
+    /// Path of the character device of the chip.
+    pub path: PathBuf,
+    /// Name of the chip as represented in the kernel.
+    pub name: String,
+    /// Label of the chip as represented in the kernel.
+    pub label: String,
+    /// Records of the lines of the chip, ordered by offset.
+    pub lines: Vec<LineRecord>,
+}
+
+impl ChipRecord {
+    /// Read the records of a chip and all of its lines.
+    pub fn read<P: AsRef<Path>>(path: &P) -> Result<Self> {
+        let chip = Chip::open(path)?;
+        let info = chip.info()?;
+
+        Ok(Self {
+            path: path.as_ref().to_path_buf(),
+            name: info.name()?.to_string(),
+            label: info.label()?.to_string(),
+            lines: chip.line_records()?,
+        })
+    }
+}
+
+fn chip_paths<P: AsRef<Path>>(path: &P) -> Result<Vec<PathBuf>> {
+    Ok(fs::read_dir(path)
+        .map_err(|_| Error::IoError)?
+        .flatten()
+        .map(|entry| entry.path())
+        .filter(|path| is_gpiochip_device(path))
+        .collect())
+}
+
+fn sort_records(mut records: Vec<ChipRecord>) -> Vec<ChipRecord> {
+    // Symbolic links to the same chip are listed once, like gpiochip_devices().
+    records.sort_by(|a, b| a.name.cmp(&b.name));
+    records.dedup_by(|a, b| a.name == b.name);
+
+    records
+}
+
+/// Read the records of all GPIO chips found in a directory.
+///
+/// Returns the records sorted in ascending order of the chip names. All lines
+/// of a chip are read in a single snapshot.
+pub fn chip_records<P: AsRef<Path>>(path: &P) -> Result<Vec<ChipRecord>> {
+    let records = chip_paths(path)?
+        .iter()
+        .map(ChipRecord::read)
+        .collect::<Result<Vec<_>>>()?;
+
+    Ok(sort_records(records))
+}
+
+/// Read the records of all GPIO chips found in a directory in parallel.
+///
+/// Same as `chip_records()` except that every chip is read by its own thread,
+/// so that reading a system with many chips isn't bounded by the latency of
+/// reading them one after another.
+pub fn chip_records_parallel<P: AsRef<Path>>(path: &P) -> Result<Vec<ChipRecord>> {
+    let threads: Vec<_> = chip_paths(path)?
+        .into_iter()
+        .map(|path| thread::spawn(move || ChipRecord::read(&path)))
+        .collect();
+
+    let mut records = Vec::with_capacity(threads.len());
+    for thread in threads {
+        records.push(thread.join().map_err(|_| Error::IoError)??);
+    }
+
+    Ok(sort_records(records))
+}
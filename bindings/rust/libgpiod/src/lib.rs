@@ -48,6 +48,8 @@ use gpiod::{
     gpiod_line_edge_GPIOD_LINE_EDGE_FALLING as GPIOD_LINE_EDGE_FALLING,
     gpiod_line_edge_GPIOD_LINE_EDGE_NONE as GPIOD_LINE_EDGE_NONE,
     gpiod_line_edge_GPIOD_LINE_EDGE_RISING as GPIOD_LINE_EDGE_RISING,
+    gpiod_line_match_GPIOD_LINE_MATCH_ALL as GPIOD_LINE_MATCH_ALL,
+    gpiod_line_match_GPIOD_LINE_MATCH_ANY as GPIOD_LINE_MATCH_ANY,
     gpiod_line_value_GPIOD_LINE_VALUE_ACTIVE as GPIOD_LINE_VALUE_ACTIVE,
     gpiod_line_value_GPIOD_LINE_VALUE_ERROR as GPIOD_LINE_VALUE_ERROR,
     gpiod_line_value_GPIOD_LINE_VALUE_INACTIVE as GPIOD_LINE_VALUE_INACTIVE,
@@ -56,18 +58,25 @@ use gpiod::{
 /// Operation types, used with OperationFailed() Error.
 #[derive(Copy, Clone, Debug, Eq, PartialEq)]
 pub enum OperationType {
+    CaptureReaderOpen,
     ChipOpen,
     ChipWaitInfoEvent,
     ChipGetLine,
     ChipGetLineInfo,
+    ChipGetLineInfoSnapshot,
     ChipGetLineOffsetFromName,
     ChipGetInfo,
+    ChipGetStats,
     ChipReadInfoEvent,
     ChipRequestLines,
     ChipWatchLineInfo,
+    EdgeEventBufferGetColumn,
     EdgeEventBufferGetEvent,
     EdgeEventCopy,
     EdgeEventBufferNew,
+    EdgeEventPipelineNew,
+    EdgeEventPipelineAddStage,
+    EdgeEventPipelineProcess,
     InfoEventGetLineInfo,
     LineConfigNew,
     LineConfigAddSettings,
@@ -76,11 +85,17 @@ pub enum OperationType {
     LineConfigGetSettings,
     LineRequestReconfigLines,
     LineRequestGetVal,
+    LineRequestGetValMask,
     LineRequestGetValSubset,
+    LineRequestOffsetsToMask,
+    LineRequestPrepareSubset,
     LineRequestSetVal,
+    LineRequestSetValMask,
     LineRequestSetValSubset,
+    LineRequestGetStats,
     LineRequestReadEdgeEvent,
     LineRequestWaitEdgeEvent,
+    LineRequestWaitForValues,
     LineSettingsNew,
     LineSettingsCopy,
     LineSettingsGetOutVal,
@@ -92,8 +107,11 @@ pub enum OperationType {
     LineSettingsSetDebouncePeriod,
     LineSettingsSetEventClock,
     LineSettingsSetOutputValue,
+    LineSubsetGetVal,
+    LineSubsetSetVal,
     RequestConfigNew,
     RequestConfigGetConsumer,
+    SharedRequestClaim,
     SimBankGetVal,
     SimBankNew,
     SimBankSetLabel,
@@ -105,6 +123,9 @@ pub enum OperationType {
     SimDevNew,
     SimDevEnable,
     SimDevDisable,
+    WaitCancelNew,
+    WaitCancelReset,
+    WaitCancelTrigger,
 }
 
 impl fmt::Display for OperationType {
@@ -139,26 +160,48 @@ pub enum Error {
 
 mod info_event;
 
+/// Memory-mapped capture files written by gpiomon.
+pub mod capture;
+
 /// GPIO chip related definitions.
 pub mod chip;
 
+#[cfg(feature = "async")]
+mod async_event;
 mod edge_event;
+mod edge_event_pipeline;
 mod event_buffer;
 mod line_request;
+mod line_subset;
 mod request_config;
+mod shared_request;
 
 /// GPIO chip request related definitions.
 pub mod request {
+    #[cfg(feature = "async")]
+    pub use crate::async_event::EdgeEventStream;
     pub use crate::edge_event::*;
+    pub use crate::edge_event_pipeline::*;
     pub use crate::event_buffer::*;
     pub use crate::line_request::*;
+    pub use crate::line_subset::*;
     pub use crate::request_config::*;
+    pub use crate::shared_request::*;
 }
 
 mod line_config;
 mod line_info;
 mod line_settings;
 
+/// Bulk enumeration of chips and lines into owned records.
+pub mod inventory;
+
+/// I/O statistics of chips and line requests.
+pub mod stats;
+
+/// Cancellation of blocking waits.
+pub mod wait_cancel;
+
 /// GPIO chip line related definitions.
 pub mod line {
     pub use crate::line_config::*;
@@ -337,6 +380,24 @@ pub mod line {
         }
     }
 
+    /// Conditions on the values of several lines waited for.
+    #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    pub enum Match {
+        /// All lines must have their expected values.
+        All,
+        /// At least one line must have its expected value.
+        Any,
+    }
+
+    impl Match {
+        pub(crate) fn gpiod_match(&self) -> gpiod::gpiod_line_match {
+            match self {
+                Match::All => GPIOD_LINE_MATCH_ALL,
+                Match::Any => GPIOD_LINE_MATCH_ANY,
+            }
+        }
+    }
+
     /// Line setting kind.
     #[derive(Copy, Clone, Debug, Eq, PartialEq)]
     pub enum SettingKind {
@@ -438,12 +499,16 @@ pub mod line {
     }
 
     /// Edge event types.
+    ///
+    /// The representation matches the one used by libgpiod so that the
+    /// event types column of `request::Buffer` can be borrowed as is.
     #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    #[repr(u32)]
     pub enum EdgeKind {
         /// Rising edge event.
-        Rising,
+        Rising = GPIOD_EDGE_EVENT_RISING_EDGE,
         /// Falling edge event.
-        Falling,
+        Falling = GPIOD_EDGE_EVENT_FALLING_EDGE,
     }
 
     impl EdgeKind {
@@ -496,6 +561,37 @@ pub fn gpiochip_devices<P: AsRef<Path>>(path: &P) -> Result<Vec<chip::Chip>> {
     Ok(devices.into_iter().map(|a| a.0).collect())
 }
 
+/// Set the initial capacity of the edge event buffers created without an
+/// explicit one, process-wide.
+///
+/// The capacity is limited to 1024, 0 restores the default of 64.
+pub fn set_default_event_buffer_capacity(capacity: usize) {
+    // SAFETY: libgpiod stores the setting atomically.
+    unsafe { gpiod::gpiod_set_default_event_buffer_capacity(capacity) }
+}
+
+/// Get the initial capacity of the edge event buffers created without an
+/// explicit one.
+pub fn default_event_buffer_capacity() -> usize {
+    // SAFETY: libgpiod loads the setting atomically.
+    unsafe { gpiod::gpiod_get_default_event_buffer_capacity() }
+}
+
+/// Set the capacity up to which adaptive edge event buffers grow,
+/// process-wide.
+///
+/// The capacity is limited to 1024, 0 restores the default maximum.
+pub fn set_max_event_buffer_capacity(capacity: usize) {
+    // SAFETY: libgpiod stores the setting atomically.
+    unsafe { gpiod::gpiod_set_max_event_buffer_capacity(capacity) }
+}
+
+/// Get the capacity up to which adaptive edge event buffers grow.
+pub fn max_event_buffer_capacity() -> usize {
+    // SAFETY: libgpiod loads the setting atomically.
+    unsafe { gpiod::gpiod_get_max_event_buffer_capacity() }
+}
+
 /// Get the API version of the libgpiod library as a human-readable string.
 pub fn libgpiod_version() -> Result<&'static str> {
     // SAFETY: The string returned by libgpiod is guaranteed to live forever.
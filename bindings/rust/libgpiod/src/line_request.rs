@@ -7,8 +7,11 @@ use std::time::Duration;
 
 use super::{
     gpiod,
-    line::{self, Offset, Value, ValueMap},
-    request, Error, OperationType, Result,
+    line::{self, Match, Offset, Value, ValueMap},
+    request,
+    stats::Stats,
+    wait_cancel::WaitCancel,
+    Error, OperationType, Result,
 };
 
 /// Line request operations
@@ -47,6 +50,21 @@ impl Request {
         offsets
     }
 
+    /// Get a snapshot of the I/O statistics of the request.
+    pub fn stats(&self) -> Result<Stats> {
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        Stats::from_raw(
+            unsafe { gpiod::gpiod_line_request_get_stats(self.request) },
+            OperationType::LineRequestGetStats,
+        )
+    }
+
+    /// Zero the I/O statistics of the request.
+    pub fn reset_stats(&mut self) {
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_line_request_reset_stats(self.request) }
+    }
+
     /// Get the value (0 or 1) of a single line associated with the request.
     pub fn value(&self, offset: Offset) -> Result<Value> {
         // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
@@ -97,6 +115,59 @@ impl Request {
         self.values_subset(&self.offsets())
     }
 
+    /// Convert a set of requested offsets into a request-relative bitmask.
+    ///
+    /// Bit N of the mask corresponds to the line at index N of `offsets()`.
+    /// Converting once allows using the mask-based accessors in hot loops.
+    pub fn offsets_to_mask(&self, offsets: &[Offset]) -> Result<u64> {
+        let mut mask = 0;
+
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_line_request_offsets_to_mask(
+                self.request,
+                offsets.len(),
+                offsets.as_ptr(),
+                &mut mask,
+            )
+        };
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::LineRequestOffsetsToMask,
+                errno::errno(),
+            ))
+        } else {
+            Ok(mask)
+        }
+    }
+
+    /// Get values of the lines identified by a request-relative bitmask.
+    ///
+    /// Bit N of the result is set if the line at index N of `offsets()` is
+    /// active. Bits not set in `mask` are cleared.
+    pub fn values_mask(&self, mask: u64) -> Result<u64> {
+        let mut values = 0;
+
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        let ret =
+            unsafe { gpiod::gpiod_line_request_get_values_mask(self.request, mask, &mut values) };
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::LineRequestGetValMask,
+                errno::errno(),
+            ))
+        } else {
+            Ok(values)
+        }
+    }
+
+    /// Prepare a subset of requested lines for repeated reads and writes.
+    pub fn prepare_subset(&self, offsets: &[Offset]) -> Result<request::Subset<'_>> {
+        request::Subset::new(self, offsets)
+    }
+
     /// Set the value of a single line associated with the request.
     pub fn set_value(&mut self, offset: Offset, value: Value) -> Result<&mut Self> {
         // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
@@ -168,6 +239,24 @@ impl Request {
         }
     }
 
+    /// Set values of the lines identified by a request-relative bitmask.
+    ///
+    /// Bit N of `values` set makes the line at index N of `offsets()` active.
+    /// Bits not set in `mask` are ignored.
+    pub fn set_values_mask(&mut self, mask: u64, values: u64) -> Result<&mut Self> {
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        let ret = unsafe { gpiod::gpiod_line_request_set_values_mask(self.request, mask, values) };
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::LineRequestSetValMask,
+                errno::errno(),
+            ))
+        } else {
+            Ok(self)
+        }
+    }
+
     /// Update the configuration of lines associated with the line request.
     pub fn reconfigure_lines(&mut self, lconfig: &line::Config) -> Result<&mut Self> {
         // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
@@ -184,6 +273,27 @@ impl Request {
         }
     }
 
+    /// Update the configuration of a subset of lines associated with the line
+    /// request.
+    ///
+    /// Only the lines present in the config are reconfigured. All other
+    /// requested lines keep their settings and output values.
+    pub fn reconfigure_lines_partial(&mut self, lconfig: &line::Config) -> Result<&mut Self> {
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_line_request_reconfigure_lines_partial(self.request, lconfig.config)
+        };
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::LineRequestReconfigLines,
+                errno::errno(),
+            ))
+        } else {
+            Ok(self)
+        }
+    }
+
     /// Wait for edge events on any of the lines associated with the request.
     pub fn wait_edge_events(&self, timeout: Option<Duration>) -> Result<bool> {
         let timeout = match timeout {
@@ -205,6 +315,106 @@ impl Request {
         }
     }
 
+    /// Wait until a single line has the given value.
+    ///
+    /// Returns `Ok(false)` if the wait timed out. The line must detect the
+    /// edge leading to the value. Edge events read while waiting are
+    /// discarded.
+    pub fn wait_for_value(
+        &self,
+        offset: Offset,
+        value: Value,
+        timeout: Option<Duration>,
+    ) -> Result<bool> {
+        let mut map = ValueMap::new();
+
+        map.insert(offset.into(), value);
+        self.wait_for_values(&map, Match::All, timeout)
+    }
+
+    /// Wait until a set of lines have the given values.
+    ///
+    /// Returns `Ok(false)` if the wait timed out. Each line must detect the
+    /// edge leading to its expected value. Edge events read while waiting
+    /// are discarded.
+    pub fn wait_for_values(
+        &self,
+        map: &ValueMap,
+        how: Match,
+        timeout: Option<Duration>,
+    ) -> Result<bool> {
+        let mut offsets = Vec::new();
+        let mut values = Vec::new();
+
+        for (offset, value) in map.iter() {
+            offsets.push(*offset as u32);
+            values.push(value.value());
+        }
+
+        let timeout = match timeout {
+            Some(x) => x.as_nanos() as i64,
+            // Block indefinitely
+            None => -1,
+        };
+
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_line_request_wait_for_values_subset(
+                self.request,
+                offsets.len(),
+                offsets.as_ptr(),
+                values.as_ptr(),
+                how.gpiod_match(),
+                timeout,
+            )
+        };
+
+        match ret {
+            -1 => Err(Error::OperationFailed(
+                OperationType::LineRequestWaitForValues,
+                errno::errno(),
+            )),
+            0 => Ok(false),
+            _ => Ok(true),
+        }
+    }
+
+    /// Wait for edge events, returning early if the wait is cancelled.
+    ///
+    /// Returns `Ok(false)` if the wait timed out or `cancel` was triggered.
+    pub fn wait_edge_events_cancellable(
+        &self,
+        timeout: Option<Duration>,
+        cancel: &WaitCancel,
+    ) -> Result<bool> {
+        let timeout = match timeout {
+            Some(x) => x.as_nanos() as i64,
+            // Block indefinitely
+            None => -1,
+        };
+
+        // SAFETY: `gpiod_line_request` and `gpiod_wait_cancel` are guaranteed to be valid here.
+        let ret = unsafe {
+            gpiod::gpiod_line_request_wait_edge_events_cancellable(
+                self.request,
+                timeout,
+                cancel.cancel,
+            )
+        };
+
+        match ret {
+            -1 => match errno::errno() {
+                errno::Errno(libc::ECANCELED) => Ok(false),
+                err => Err(Error::OperationFailed(
+                    OperationType::LineRequestWaitEdgeEvent,
+                    err,
+                )),
+            },
+            0 => Ok(false),
+            _ => Ok(true),
+        }
+    }
+
     /// Get a number of edge events from a line request.
     ///
     /// This function will block if no event was queued for the line.
@@ -214,6 +424,14 @@ impl Request {
     ) -> Result<request::Events> {
         buffer.read_edge_events(self)
     }
+
+    /// Get an asynchronous stream of edge events read into `buffer`.
+    ///
+    /// Must be called from within a tokio runtime.
+    #[cfg(feature = "async")]
+    pub fn edge_events(&self, buffer: request::Buffer) -> Result<request::EdgeEventStream<'_>> {
+        request::EdgeEventStream::new(self, buffer)
+    }
 }
 
 impl AsRawFd for Request {
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::marker::PhantomData;
+
+use super::{
+    gpiod,
+    line::{Offset, Value},
+    request::Request,
+    Error, OperationType, Result,
+};
+
+/// No request holds more lines, see GPIO_V2_LINES_MAX.
+const MAX_LINES: usize = 64;
+
+/// Prepared subset of requested lines
+///
+/// The offsets are validated and mapped to their bit positions in the request
+/// once, reading and writing values through the subset then needs neither
+/// allocations nor lookups. The subset borrows the request it was created
+/// from and so can't outlive it.
+#[derive(Debug, Eq, PartialEq)]
+pub struct Subset<'a> {
+    subset: *mut gpiod::gpiod_line_subset,
+    _request: PhantomData<&'a Request>,
+}
+
+impl<'a> Subset<'a> {
+    pub(crate) fn new(request: &'a Request, offsets: &[Offset]) -> Result<Self> {
+        // SAFETY: The `gpiod_line_subset` returned by libgpiod is guaranteed to live as long
+        // as the `struct Subset`.
+        let subset = unsafe {
+            gpiod::gpiod_line_request_prepare_subset(
+                request.request,
+                offsets.len(),
+                offsets.as_ptr(),
+            )
+        };
+
+        if subset.is_null() {
+            return Err(Error::OperationFailed(
+                OperationType::LineRequestPrepareSubset,
+                errno::errno(),
+            ));
+        }
+
+        Ok(Self {
+            subset,
+            _request: PhantomData,
+        })
+    }
+
+    /// Get the number of lines in the subset.
+    pub fn num_lines(&self) -> usize {
+        // SAFETY: `gpiod_line_subset` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_line_subset_get_num_lines(self.subset) }
+    }
+
+    /// Get the request-relative bitmask of the lines in the subset.
+    ///
+    /// Suitable for `Request::values_mask()` and `Request::set_values_mask()`.
+    pub fn mask(&self) -> u64 {
+        // SAFETY: `gpiod_line_subset` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_line_subset_get_mask(self.subset) }
+    }
+
+    /// Read the values of all lines in the subset into `values`.
+    ///
+    /// `values` must hold an entry for every line, in the order of the offsets
+    /// the subset was created with.
+    pub fn values(&self, values: &mut [Value]) -> Result<()> {
+        let mut raw = [gpiod::gpiod_line_value_GPIOD_LINE_VALUE_INACTIVE; MAX_LINES];
+
+        if values.len() != self.num_lines() {
+            return Err(Error::InvalidArguments);
+        }
+
+        // SAFETY: `gpiod_line_subset` is guaranteed to be valid here and `raw` holds more
+        // entries than there can be lines in the subset.
+        let ret = unsafe { gpiod::gpiod_line_subset_get_values(self.subset, raw.as_mut_ptr()) };
+
+        if ret == -1 {
+            return Err(Error::OperationFailed(
+                OperationType::LineSubsetGetVal,
+                errno::errno(),
+            ));
+        }
+
+        for (value, raw) in values.iter_mut().zip(raw.iter()) {
+            *value = Value::new(*raw)?;
+        }
+
+        Ok(())
+    }
+
+    /// Set the values of all lines in the subset.
+    ///
+    /// `values` must hold an entry for every line, in the order of the offsets
+    /// the subset was created with.
+    pub fn set_values(&mut self, values: &[Value]) -> Result<&mut Self> {
+        let mut raw = [gpiod::gpiod_line_value_GPIOD_LINE_VALUE_INACTIVE; MAX_LINES];
+
+        if values.len() != self.num_lines() {
+            return Err(Error::InvalidArguments);
+        }
+
+        for (raw, value) in raw.iter_mut().zip(values.iter()) {
+            *raw = value.value();
+        }
+
+        // SAFETY: `gpiod_line_subset` is guaranteed to be valid here.
+        let ret = unsafe { gpiod::gpiod_line_subset_set_values(self.subset, raw.as_ptr()) };
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::LineSubsetSetVal,
+                errno::errno(),
+            ))
+        } else {
+            Ok(self)
+        }
+    }
+}
+
+impl<'a> Drop for Subset<'a> {
+    /// Free the subset and release all associated resources.
+    fn drop(&mut self) {
+        // SAFETY: `gpiod_line_subset` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_line_subset_free(self.subset) }
+    }
+}
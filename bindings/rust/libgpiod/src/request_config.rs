@@ -85,6 +85,41 @@ impl Config {
         // SAFETY: `gpiod_request_config` is guaranteed to be valid here.
         unsafe { gpiod::gpiod_request_config_get_event_buffer_size(self.config) as usize }
     }
+
+    /// Make the file descriptor of the request non-blocking.
+    ///
+    /// Reading edge events from a non-blocking request returns no events
+    /// instead of blocking if none are queued.
+    pub fn set_nonblocking(&mut self, enabled: bool) -> &mut Self {
+        // SAFETY: `gpiod_request_config` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_request_config_set_nonblocking(self.config, enabled) }
+
+        self
+    }
+
+    /// Check if requests made with this config are non-blocking.
+    pub fn nonblocking(&self) -> bool {
+        // SAFETY: `gpiod_request_config` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_request_config_get_nonblocking(self.config) }
+    }
+
+    /// Enable or disable the input value shadow.
+    ///
+    /// With the shadow enabled, the values of input lines with both edges
+    /// detected are read once and then kept current from the edge events
+    /// read from the request, so reading them doesn't need a system call.
+    pub fn set_input_shadow(&mut self, enabled: bool) -> &mut Self {
+        // SAFETY: `gpiod_request_config` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_request_config_set_input_shadow(self.config, enabled) }
+
+        self
+    }
+
+    /// Check if the input value shadow is enabled.
+    pub fn input_shadow(&self) -> bool {
+        // SAFETY: `gpiod_request_config` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_request_config_get_input_shadow(self.config) }
+    }
 }
 
 impl Drop for Config {
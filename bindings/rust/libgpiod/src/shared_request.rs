@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+
+use super::{
+    gpiod,
+    line::{Offset, Value},
+    request::Request,
+    Error, OperationType, Result,
+};
+
+#[derive(Debug)]
+struct Internal {
+    request: Request,
+    /// Request-relative bitmask of the lines claimed by a `ClaimedLines`.
+    claimed: AtomicU64,
+}
+
+// SAFETY: Only the value accessors of the request are reachable through `Internal`. libgpiod
+// allows them to run concurrently as long as no two threads set the same lines at the same
+// time, which the claims guarantee.
+unsafe impl Send for Internal {}
+unsafe impl Sync for Internal {}
+
+/// Line request shared between threads
+///
+/// Allows reading the values of any requested lines from many threads at the
+/// same time. To set values, a thread claims a set of lines first. Claims of
+/// different threads can't overlap, so threads driving disjoint lines of the
+/// request never wait for each other. Cloning the handle is cheap and all
+/// clones refer to the same request.
+///
+/// Only value accessors are available, operations needing exclusive access to
+/// the request - such as reading edge events or reconfiguring the lines - are
+/// possible again once the request is taken back with `try_unwrap()`.
+#[derive(Clone, Debug)]
+pub struct SharedRequest {
+    inner: Arc<Internal>,
+}
+
+impl SharedRequest {
+    /// Make a line request shareable between threads.
+    pub fn new(request: Request) -> Self {
+        Self {
+            inner: Arc::new(Internal {
+                request,
+                claimed: AtomicU64::new(0),
+            }),
+        }
+    }
+
+    /// Get the number of lines in the request.
+    pub fn num_lines(&self) -> usize {
+        self.inner.request.num_lines()
+    }
+
+    /// Get the offsets of lines in the request.
+    pub fn offsets(&self) -> Vec<Offset> {
+        self.inner.request.offsets()
+    }
+
+    /// Get the value of a single line associated with the request.
+    pub fn value(&self, offset: Offset) -> Result<Value> {
+        self.inner.request.value(offset)
+    }
+
+    /// Get values of the lines identified by a request-relative bitmask.
+    pub fn values_mask(&self, mask: u64) -> Result<u64> {
+        self.inner.request.values_mask(mask)
+    }
+
+    /// Convert a set of requested offsets into a request-relative bitmask.
+    pub fn offsets_to_mask(&self, offsets: &[Offset]) -> Result<u64> {
+        self.inner.request.offsets_to_mask(offsets)
+    }
+
+    /// Claim a set of lines for setting their values.
+    ///
+    /// Fails with `EBUSY` if any of the lines is claimed already. The lines
+    /// are released when the returned object is dropped.
+    pub fn claim(&self, offsets: &[Offset]) -> Result<ClaimedLines> {
+        let mask = self.offsets_to_mask(offsets)?;
+        let mut claimed = self.inner.claimed.load(Ordering::Relaxed);
+
+        loop {
+            if claimed & mask != 0 {
+                return Err(Error::OperationFailed(
+                    OperationType::SharedRequestClaim,
+                    errno::Errno(libc::EBUSY),
+                ));
+            }
+
+            match self.inner.claimed.compare_exchange_weak(
+                claimed,
+                claimed | mask,
+                Ordering::Acquire,
+                Ordering::Relaxed,
+            ) {
+                Ok(_) => break,
+                Err(current) => claimed = current,
+            }
+        }
+
+        Ok(ClaimedLines {
+            inner: self.inner.clone(),
+            mask,
+        })
+    }
+
+    /// Get the line request back.
+    ///
+    /// Succeeds once all other clones of the handle and all claims were
+    /// dropped, otherwise the handle is returned unchanged.
+    pub fn try_unwrap(self) -> std::result::Result<Request, Self> {
+        match Arc::try_unwrap(self.inner) {
+            Ok(inner) => Ok(inner.request),
+            Err(inner) => Err(Self { inner }),
+        }
+    }
+}
+
+/// Lines of a shared request claimed by a single owner
+///
+/// Values of the claimed lines are set without synchronizing with other
+/// threads using the same request.
+#[derive(Debug)]
+pub struct ClaimedLines {
+    inner: Arc<Internal>,
+    mask: u64,
+}
+
+impl ClaimedLines {
+    /// Get the request-relative bitmask of the claimed lines.
+    pub fn mask(&self) -> u64 {
+        self.mask
+    }
+
+    /// Get the values of the claimed lines as a request-relative bitmap.
+    pub fn values(&self) -> Result<u64> {
+        self.inner.request.values_mask(self.mask)
+    }
+
+    /// Set the values of all claimed lines from a request-relative bitmap.
+    ///
+    /// Bits of lines not claimed are ignored.
+    pub fn set_values(&mut self, values: u64) -> Result<&mut Self> {
+        self.set(self.mask, values)
+    }
+
+    /// Set the values of some of the claimed lines.
+    ///
+    /// `mask` must not select lines which were not claimed.
+    pub fn set_values_mask(&mut self, mask: u64, values: u64) -> Result<&mut Self> {
+        if mask & !self.mask != 0 {
+            return Err(Error::InvalidArguments);
+        }
+
+        self.set(mask, values)
+    }
+
+    fn set(&mut self, mask: u64, values: u64) -> Result<&mut Self> {
+        // SAFETY: `gpiod_line_request` is guaranteed to be valid here. No other thread sets
+        // these lines while they are claimed, see the `Sync` implementation of `Internal`.
+        let ret = unsafe {
+            gpiod::gpiod_line_request_set_values_mask(self.inner.request.request, mask, values)
+        };
+
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::LineRequestSetValMask,
+                errno::errno(),
+            ))
+        } else {
+            Ok(self)
+        }
+    }
+}
+
+impl Drop for ClaimedLines {
+    /// Release the claimed lines.
+    fn drop(&mut self) {
+        self.inner.claimed.fetch_and(!self.mask, Ordering::Release);
+    }
+}
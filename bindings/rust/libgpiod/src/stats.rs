@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::time::Duration;
+
+use super::{gpiod, Error, OperationType, Result};
+
+/// I/O statistics snapshot
+///
+/// Counts the calls a chip or a line request made into the kernel and the
+/// time it spent in them, up to the moment the snapshot was taken.
+#[derive(Copy, Clone, Debug, Default, Eq, PartialEq)]
+pub struct Stats {
+    /// Number of ioctls reading line values.
+    pub num_get_ioctls: u64,
+    /// Number of ioctls setting line values.
+    pub num_set_ioctls: u64,
+    /// Number of ioctls requesting or reconfiguring lines.
+    pub num_config_ioctls: u64,
+    /// Number of ioctls reading or watching chip and line info.
+    pub num_info_ioctls: u64,
+    /// Number of reads returning events.
+    pub num_reads: u64,
+    /// Number of events read.
+    pub num_events_read: u64,
+    /// Number of bytes read.
+    pub num_bytes_read: u64,
+    /// Total time spent in ioctls.
+    pub ioctl_time: Duration,
+    /// Time taken by the slowest ioctl.
+    pub max_ioctl_time: Duration,
+    /// Total time spent waiting for events.
+    pub wait_time: Duration,
+}
+
+impl Stats {
+    /// Convert a snapshot returned by libgpiod, taking its ownership.
+    pub(crate) fn from_raw(stats: *mut gpiod::gpiod_stats, op: OperationType) -> Result<Self> {
+        if stats.is_null() {
+            return Err(Error::OperationFailed(op, errno::errno()));
+        }
+
+        // SAFETY: `gpiod_stats` is guaranteed to be valid here.
+        let ret = unsafe {
+            Self {
+                num_get_ioctls: gpiod::gpiod_stats_get_num_get_ioctls(stats),
+                num_set_ioctls: gpiod::gpiod_stats_get_num_set_ioctls(stats),
+                num_config_ioctls: gpiod::gpiod_stats_get_num_config_ioctls(stats),
+                num_info_ioctls: gpiod::gpiod_stats_get_num_info_ioctls(stats),
+                num_reads: gpiod::gpiod_stats_get_num_reads(stats),
+                num_events_read: gpiod::gpiod_stats_get_num_events_read(stats),
+                num_bytes_read: gpiod::gpiod_stats_get_num_bytes_read(stats),
+                ioctl_time: Duration::from_nanos(gpiod::gpiod_stats_get_ioctl_time_ns(stats)),
+                max_ioctl_time: Duration::from_nanos(gpiod::gpiod_stats_get_max_ioctl_time_ns(
+                    stats,
+                )),
+                wait_time: Duration::from_nanos(gpiod::gpiod_stats_get_wait_time_ns(stats)),
+            }
+        };
+
+        // SAFETY: `gpiod_stats` is guaranteed to be valid here and is no longer used.
+        unsafe { gpiod::gpiod_stats_free(stats) };
+
+        Ok(ret)
+    }
+}
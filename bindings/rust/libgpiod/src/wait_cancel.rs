@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+use std::os::unix::prelude::AsRawFd;
+
+use super::{gpiod, Error, OperationType, Result};
+
+/// Cancellation object for blocking waits
+///
+/// Passing the object to `Chip::wait_info_event_cancellable()` or
+/// `Request::wait_edge_events_cancellable()` makes the wait return early once
+/// the object is triggered, possibly from another thread. The object stays
+/// triggered until it is reset.
+
+#[derive(Debug, Eq, PartialEq)]
+pub struct WaitCancel {
+    pub(crate) cancel: *mut gpiod::gpiod_wait_cancel,
+}
+
+// SAFETY: The object only wraps an eventfd which can be written to and read
+// from any thread.
+unsafe impl Send for WaitCancel {}
+unsafe impl Sync for WaitCancel {}
+
+impl WaitCancel {
+    /// Create a new cancellation object.
+    pub fn new() -> Result<Self> {
+        // SAFETY: The `gpiod_wait_cancel` returned by libgpiod is guaranteed to live as long
+        // as the `struct WaitCancel`.
+        let cancel = unsafe { gpiod::gpiod_wait_cancel_new() };
+        if cancel.is_null() {
+            return Err(Error::OperationFailed(
+                OperationType::WaitCancelNew,
+                errno::errno(),
+            ));
+        }
+
+        Ok(Self { cancel })
+    }
+
+    /// Cancel all current and future waits using this object.
+    pub fn trigger(&self) -> Result<()> {
+        // SAFETY: `gpiod_wait_cancel` is guaranteed to be valid here.
+        let ret = unsafe { gpiod::gpiod_wait_cancel_trigger(self.cancel) };
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::WaitCancelTrigger,
+                errno::errno(),
+            ))
+        } else {
+            Ok(())
+        }
+    }
+
+    /// Clear the triggered state of the object.
+    pub fn reset(&self) -> Result<()> {
+        // SAFETY: `gpiod_wait_cancel` is guaranteed to be valid here.
+        let ret = unsafe { gpiod::gpiod_wait_cancel_reset(self.cancel) };
+        if ret == -1 {
+            Err(Error::OperationFailed(
+                OperationType::WaitCancelReset,
+                errno::errno(),
+            ))
+        } else {
+            Ok(())
+        }
+    }
+
+    /// Check whether the object was triggered and not reset since.
+    pub fn is_triggered(&self) -> bool {
+        // SAFETY: `gpiod_wait_cancel` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_wait_cancel_is_triggered(self.cancel) }
+    }
+}
+
+impl AsRawFd for WaitCancel {
+    /// Get the eventfd that becomes readable once the object is triggered.
+    fn as_raw_fd(&self) -> i32 {
+        // SAFETY: `gpiod_wait_cancel` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_wait_cancel_get_fd(self.cancel) }
+    }
+}
+
+impl Drop for WaitCancel {
+    /// Free the cancellation object and release all associated resources.
+    fn drop(&mut self) {
+        // SAFETY: `gpiod_wait_cancel` is guaranteed to be valid here.
+        unsafe { gpiod::gpiod_wait_cancel_free(self.cancel) }
+    }
+}
@@ -293,5 +293,228 @@ mod edge_event {
             let events = config.request().read_edge_events(&mut buf).unwrap();
             assert_eq!(events.len(), 2);
         }
+
+        #[test]
+        fn columns() {
+            const GPIO: Offset = 2;
+            let mut buf = request::Buffer::new(0).unwrap();
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(None, Some(Edge::Both));
+            config.lconfig_add_settings(&[GPIO]);
+            config.request_lines().unwrap();
+
+            // Generate events
+            trigger_multiple_events(config.sim(), GPIO);
+
+            assert!(config
+                .request()
+                .wait_edge_events(Some(Duration::from_secs(1)))
+                .unwrap());
+
+            let mut kinds = Vec::new();
+            let mut timestamps = Vec::new();
+            for event in config.request().read_edge_events(&mut buf).unwrap() {
+                let event = event.unwrap();
+                kinds.push(event.event_type().unwrap());
+                timestamps.push(event.timestamp().as_nanos() as u64);
+            }
+
+            assert_eq!(buf.len(), 3);
+            assert_eq!(buf.line_offsets().unwrap(), &[GPIO; 3]);
+            assert_eq!(buf.event_types().unwrap(), kinds.as_slice());
+            assert_eq!(buf.timestamps_ns().unwrap(), timestamps.as_slice());
+            assert_eq!(
+                buf.event_types().unwrap(),
+                &[EdgeKind::Rising, EdgeKind::Falling, EdgeKind::Rising]
+            );
+        }
+
+        #[test]
+        fn records() {
+            const GPIO: Offset = 3;
+            let mut buf = request::Buffer::new(0).unwrap();
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(None, Some(Edge::Both));
+            config.lconfig_add_settings(&[GPIO]);
+            config.request_lines().unwrap();
+
+            // Generate events
+            trigger_multiple_events(config.sim(), GPIO);
+
+            assert!(config
+                .request()
+                .wait_edge_events(Some(Duration::from_secs(1)))
+                .unwrap());
+
+            let records = buf.read_edge_event_records(config.request()).unwrap();
+            assert_eq!(records.len(), 3);
+
+            let kinds: Vec<EdgeKind> = records.iter().map(|r| r.event_type().unwrap()).collect();
+            assert_eq!(
+                kinds,
+                [EdgeKind::Rising, EdgeKind::Falling, EdgeKind::Rising]
+            );
+
+            for (i, record) in records.iter().enumerate() {
+                assert_eq!(record.line_offset(), GPIO);
+                assert_eq!(record.global_seqno(), i + 1);
+                assert_eq!(record.line_seqno(), i + 1);
+            }
+
+            assert!(records[0].timestamp() < records[1].timestamp());
+            assert!(records[1].timestamp() < records[2].timestamp());
+
+            // The records and the events describe the same data.
+            let timestamps: Vec<u64> = buf
+                .records()
+                .unwrap()
+                .iter()
+                .map(|r| r.timestamp().as_nanos() as u64)
+                .collect();
+            assert_eq!(buf.timestamps_ns().unwrap(), timestamps.as_slice());
+        }
+
+        #[test]
+        fn pipeline() {
+            const GPIO: Offset = 4;
+            let mut buf = request::Buffer::new(0).unwrap();
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(None, Some(Edge::Both));
+            config.lconfig_add_settings(&[GPIO]);
+            config.request_lines().unwrap();
+
+            let seen = Arc::new(Mutex::new(0));
+            let stage_seen = seen.clone();
+
+            let mut pipeline = request::Pipeline::new().unwrap();
+            pipeline.add_edge_filter(GPIO, Some(Edge::Rising)).unwrap();
+            pipeline
+                .add_stage(move |records: &mut [request::Record]| {
+                    *stage_seen.lock().unwrap() += records.len();
+                    // Keep the first event only.
+                    1
+                })
+                .unwrap();
+            assert_eq!(pipeline.num_stages(), 2);
+
+            // Generate events
+            trigger_multiple_events(config.sim(), GPIO);
+
+            assert!(config
+                .request()
+                .wait_edge_events(Some(Duration::from_secs(1)))
+                .unwrap());
+            assert_eq!(buf.read_edge_events(config.request()).unwrap().len(), 3);
+
+            assert_eq!(pipeline.process(&mut buf).unwrap(), 1);
+            assert_eq!(*seen.lock().unwrap(), 2);
+            assert_eq!(pipeline.num_dropped(0).unwrap(), 1);
+            assert_eq!(pipeline.num_dropped(1).unwrap(), 1);
+            assert_eq!(
+                pipeline.num_dropped(2).unwrap_err(),
+                libgpiod::Error::InvalidArguments
+            );
+
+            let records = buf.records().unwrap();
+            assert_eq!(records.len(), 1);
+            assert_eq!(records[0].event_type().unwrap(), EdgeKind::Rising);
+            assert_eq!(records[0].global_seqno(), 1);
+
+            pipeline.reset();
+            assert_eq!(pipeline.num_dropped(0).unwrap(), 0);
+        }
+
+        #[test]
+        fn pipeline_min_interval() {
+            const GPIO: Offset = 5;
+            let mut buf = request::Buffer::new(0).unwrap();
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(None, Some(Edge::Both));
+            config.lconfig_add_settings(&[GPIO]);
+            config.request_lines().unwrap();
+
+            let mut pipeline = request::Pipeline::new().unwrap();
+            pipeline
+                .add_min_interval(GPIO, Duration::from_secs(1))
+                .unwrap();
+
+            // Generate events
+            trigger_multiple_events(config.sim(), GPIO);
+
+            assert!(config
+                .request()
+                .wait_edge_events(Some(Duration::from_secs(1)))
+                .unwrap());
+            assert_eq!(buf.read_edge_events(config.request()).unwrap().len(), 3);
+            assert_eq!(pipeline.process(&mut buf).unwrap(), 1);
+            assert_eq!(buf.len(), 1);
+        }
+    }
+
+    #[cfg(feature = "async")]
+    mod stream {
+        use super::*;
+        use futures::StreamExt;
+        use std::thread;
+
+        #[tokio::test]
+        async fn events_are_streamed() {
+            const GPIO: Offset = 2;
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(None, Some(Edge::Both));
+            config.lconfig_add_settings(&[GPIO]);
+            config.request_lines().unwrap();
+
+            // Generate events
+            let sim = config.sim();
+            thread::spawn(move || {
+                for pull in [Pull::Up, Pull::Down, Pull::Up] {
+                    thread::sleep(Duration::from_millis(10));
+                    sim.lock().unwrap().set_pull(GPIO, pull).unwrap();
+                }
+            });
+
+            let mut stream = config
+                .request()
+                .edge_events(request::Buffer::new(0).unwrap())
+                .unwrap();
+
+            let mut kinds = Vec::new();
+            for _ in 0..3 {
+                let event = stream.next().await.unwrap().unwrap();
+                assert_eq!(event.line_offset(), GPIO);
+                kinds.push(event.event_type().unwrap());
+            }
+
+            assert_eq!(
+                kinds,
+                [EdgeKind::Rising, EdgeKind::Falling, EdgeKind::Rising]
+            );
+        }
+
+        #[tokio::test]
+        async fn batches_are_read_into_the_buffer() {
+            const GPIO: Offset = 4;
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(None, Some(Edge::Both));
+            config.lconfig_add_settings(&[GPIO]);
+            config.request_lines().unwrap();
+
+            // Generate events
+            for pull in [Pull::Up, Pull::Down, Pull::Up] {
+                config.sim().lock().unwrap().set_pull(GPIO, pull).unwrap();
+            }
+
+            let mut stream = config
+                .request()
+                .edge_events(request::Buffer::new(0).unwrap())
+                .unwrap();
+
+            let events = stream.read_edge_events().await.unwrap();
+            assert_eq!(events.len(), 3);
+
+            assert_eq!(stream.buffer().len(), 3);
+            assert_eq!(stream.buffer().line_offsets().unwrap(), &[GPIO; 3]);
+        }
     }
 }
@@ -163,4 +163,34 @@ mod info_event {
             assert!(ts_rec > ts_req);
         }
     }
+
+    #[cfg(feature = "async")]
+    mod stream {
+        use super::*;
+        use futures::StreamExt;
+        const NGPIO: usize = 8;
+        const GPIO: Offset = 7;
+
+        #[tokio::test]
+        async fn events_are_streamed() {
+            let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+            let chip = Chip::open(&sim.dev_path()).unwrap();
+            chip.watch_line_info(GPIO).unwrap();
+
+            let mut stream = chip.info_events().unwrap();
+
+            // Generate events
+            let mut lconfig = line::Config::new().unwrap();
+            let lsettings = line::Settings::new().unwrap();
+            lconfig.add_line_settings(&[GPIO], lsettings).unwrap();
+            drop(chip.request_lines(None, &lconfig).unwrap());
+
+            let event = stream.next().await.unwrap().unwrap();
+            assert_eq!(event.event_type().unwrap(), InfoChangeKind::LineRequested);
+            assert_eq!(event.line_info().unwrap().offset(), GPIO);
+
+            let event = stream.next().await.unwrap().unwrap();
+            assert_eq!(event.event_type().unwrap(), InfoChangeKind::LineReleased);
+        }
+    }
 }
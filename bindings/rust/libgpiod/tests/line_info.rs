@@ -12,12 +12,59 @@ mod line_info {
     use gpiosim_sys::{Direction as SimDirection, Sim};
     use libgpiod::{
         chip::Chip,
+        inventory::ChipRecord,
         line::{Bias, Direction, Drive, Edge, EventClock},
         Error as ChipError, OperationType,
     };
 
     const NGPIO: usize = 8;
 
+    mod records {
+        use super::*;
+
+        #[test]
+        fn match_line_infos() {
+            let sim = Sim::new(Some(NGPIO), None, false).unwrap();
+            sim.set_line_name(1, "one").unwrap();
+            sim.set_line_name(4, "four").unwrap();
+            sim.hog_line(4, "hog4", SimDirection::OutputLow).unwrap();
+            sim.enable().unwrap();
+
+            let chip = Chip::open(&sim.dev_path()).unwrap();
+            let records = chip.line_records().unwrap();
+            assert_eq!(records.len(), NGPIO);
+
+            for (offset, record) in records.iter().enumerate() {
+                let info = chip.line_info(offset as u32).unwrap();
+
+                assert_eq!(record.offset, info.offset());
+                assert_eq!(record.name.as_deref(), info.name().ok());
+                assert_eq!(record.consumer.as_deref(), info.consumer().ok());
+                assert_eq!(record.used, info.is_used());
+                assert_eq!(record.direction, info.direction().unwrap());
+                assert_eq!(record.drive, info.drive().unwrap());
+                assert_eq!(record.event_clock, info.event_clock().unwrap());
+            }
+
+            assert_eq!(records[0].name, None);
+            assert_eq!(records[4].name.as_deref(), Some("four"));
+            assert_eq!(records[4].consumer.as_deref(), Some("hog4"));
+            assert!(records[4].used);
+            assert_eq!(records[4].direction, Direction::Output);
+        }
+
+        #[test]
+        fn chip_record() {
+            let sim = Sim::new(Some(NGPIO), Some("inventory"), true).unwrap();
+            let record = ChipRecord::read(&sim.dev_path()).unwrap();
+
+            assert_eq!(record.path, sim.dev_path());
+            assert_eq!(record.name, sim.chip_name());
+            assert_eq!(record.label, "inventory");
+            assert_eq!(record.lines.len(), NGPIO);
+        }
+    }
+
     mod properties {
         use super::*;
 
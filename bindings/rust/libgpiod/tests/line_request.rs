@@ -12,7 +12,8 @@ mod line_request {
     use gpiosim_sys::{Pull, Value as SimValue};
     use libgpiod::{
         line::{
-            self, Bias, Direction, Drive, Edge, EventClock, Offset, SettingVal, Value, ValueMap,
+            self, Bias, Direction, Drive, Edge, EventClock, Match, Offset, SettingVal, Value,
+            ValueMap,
         },
         Error as ChipError, OperationType,
     };
@@ -209,6 +210,73 @@ mod line_request {
             assert_eq!(config.sim_val(4).unwrap(), SimValue::InActive);
         }
 
+        #[test]
+        fn values_mask() {
+            let offsets = [0, 1, 3, 4];
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_val(Some(Direction::Output), Some(Value::InActive));
+            config.lconfig_add_settings(&offsets);
+            config.request_lines().unwrap();
+
+            let mask = config.request().offsets_to_mask(&[4, 1]).unwrap();
+            assert_eq!(mask, 0b1010);
+
+            config.request().set_values_mask(mask, 0b1000).unwrap();
+            assert_eq!(config.sim_val(0).unwrap(), SimValue::InActive);
+            assert_eq!(config.sim_val(1).unwrap(), SimValue::InActive);
+            assert_eq!(config.sim_val(3).unwrap(), SimValue::InActive);
+            assert_eq!(config.sim_val(4).unwrap(), SimValue::Active);
+
+            assert_eq!(config.request().values_mask(0b1111).unwrap(), 0b1000);
+            assert_eq!(config.request().values_mask(0b0111).unwrap(), 0);
+
+            assert_eq!(
+                config.request().offsets_to_mask(&[2]).unwrap_err(),
+                ChipError::OperationFailed(
+                    OperationType::LineRequestOffsetsToMask,
+                    errno::Errno(EINVAL)
+                )
+            );
+        }
+
+        #[test]
+        fn prepared_subset() {
+            let offsets = [0, 1, 3, 4];
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_val(Some(Direction::Output), Some(Value::InActive));
+            config.lconfig_add_settings(&offsets);
+            config.request_lines().unwrap();
+
+            let mut subset = config.request().prepare_subset(&[4, 0]).unwrap();
+            assert_eq!(subset.num_lines(), 2);
+            assert_eq!(subset.mask(), 0b1001);
+
+            subset
+                .set_values(&[Value::Active, Value::InActive])
+                .unwrap();
+
+            let mut values = [Value::InActive; 2];
+            subset.values(&mut values).unwrap();
+            assert_eq!(values, [Value::Active, Value::InActive]);
+
+            assert_eq!(
+                subset.set_values(&[Value::Active]).unwrap_err(),
+                ChipError::InvalidArguments
+            );
+            drop(subset);
+
+            assert_eq!(config.sim_val(0).unwrap(), SimValue::InActive);
+            assert_eq!(config.sim_val(4).unwrap(), SimValue::Active);
+
+            assert_eq!(
+                config.request().prepare_subset(&[2]).unwrap_err(),
+                ChipError::OperationFailed(
+                    OperationType::LineRequestPrepareSubset,
+                    errno::Errno(EINVAL)
+                )
+            );
+        }
+
         #[test]
         fn set_bias() {
             let offsets = [3];
@@ -235,6 +303,67 @@ mod line_request {
                 .wait_edge_events(Some(Duration::from_millis(100)))
                 .unwrap());
         }
+
+        #[test]
+        fn wait_for_values() {
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_edge(Some(Direction::Input), Some(Edge::Both));
+            config.lconfig_add_settings(&[1, 2]);
+            config.request_lines().unwrap();
+
+            // Current value satisfies the wait
+            assert!(config
+                .request()
+                .wait_for_value(1, Value::InActive, Some(Duration::ZERO))
+                .unwrap());
+
+            // Wait times out
+            assert!(!config
+                .request()
+                .wait_for_value(1, Value::Active, Some(Duration::from_millis(10)))
+                .unwrap());
+
+            let mut map = ValueMap::new();
+            map.insert(1, Value::Active);
+            map.insert(2, Value::Active);
+
+            config.set_pull(&[1], &[Pull::Up]);
+            assert!(config
+                .request()
+                .wait_for_values(&map, Match::Any, Some(Duration::from_secs(1)))
+                .unwrap());
+            assert!(!config
+                .request()
+                .wait_for_values(&map, Match::All, Some(Duration::from_millis(10)))
+                .unwrap());
+
+            config.set_pull(&[2], &[Pull::Up]);
+            assert!(config
+                .request()
+                .wait_for_values(&map, Match::All, Some(Duration::from_secs(1)))
+                .unwrap());
+        }
+
+        #[test]
+        fn stats() {
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_val(Some(Direction::Input), None);
+            config.lconfig_add_settings(&[0]);
+            config.request_lines().unwrap();
+
+            let request = config.request();
+            request.value(0).unwrap();
+            request.value(0).unwrap();
+
+            let stats = request.stats().unwrap();
+            assert_eq!(stats.num_get_ioctls, 2);
+            assert_eq!(stats.num_set_ioctls, 0);
+            assert_eq!(stats.num_reads, 0);
+            assert!(stats.ioctl_time >= stats.max_ioctl_time);
+
+            request.reset_stats();
+            assert_eq!(request.stats().unwrap().num_get_ioctls, 0);
+        }
     }
 
     mod reconfigure {
@@ -498,5 +627,64 @@ mod line_request {
             assert!(info.is_debounced());
             assert_eq!(info.debounce_period(), Duration::from_millis(100));
         }
+
+        #[test]
+        fn partial() {
+            let offsets = [0, 1, 3, 4];
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_val(Some(Direction::Output), Some(Value::Active));
+            config.lconfig_add_settings(&offsets);
+            config.request_lines().unwrap();
+
+            config.request().set_value(4, Value::InActive).unwrap();
+
+            // Reconfigure a single line
+            let mut lconfig = line::Config::new().unwrap();
+            let mut lsettings = line::Settings::new().unwrap();
+            lsettings
+                .set_prop(&[
+                    SettingVal::Direction(Direction::Input),
+                    SettingVal::Bias(Some(Bias::PullDown)),
+                ])
+                .unwrap();
+            lconfig.add_line_settings(&[1], lsettings).unwrap();
+            config
+                .request()
+                .reconfigure_lines_partial(&lconfig)
+                .unwrap();
+
+            let info = config.chip().line_info(1).unwrap();
+            assert_eq!(info.direction().unwrap(), Direction::Input);
+            assert_eq!(config.sim_val(1).unwrap(), SimValue::InActive);
+
+            // The remaining lines keep their configuration and values
+            let info = config.chip().line_info(3).unwrap();
+            assert_eq!(info.direction().unwrap(), Direction::Output);
+            assert_eq!(config.sim_val(0).unwrap(), SimValue::Active);
+            assert_eq!(config.sim_val(3).unwrap(), SimValue::Active);
+            assert_eq!(config.sim_val(4).unwrap(), SimValue::InActive);
+        }
+
+        #[test]
+        fn partial_unrequested_line() {
+            let mut config = TestConfig::new(NGPIO).unwrap();
+            config.lconfig_add_settings(&[0, 1]);
+            config.request_lines().unwrap();
+
+            let mut lconfig = line::Config::new().unwrap();
+            let lsettings = line::Settings::new().unwrap();
+            lconfig.add_line_settings(&[1, 2], lsettings).unwrap();
+
+            assert_eq!(
+                config
+                    .request()
+                    .reconfigure_lines_partial(&lconfig)
+                    .unwrap_err(),
+                ChipError::OperationFailed(
+                    OperationType::LineRequestReconfigLines,
+                    errno::Errno(EINVAL),
+                )
+            );
+        }
     }
 }
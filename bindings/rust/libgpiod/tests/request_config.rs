@@ -15,6 +15,8 @@ mod request_config {
             let rconfig = request::Config::new().unwrap();
 
             assert_eq!(rconfig.event_buffer_size(), 0);
+            assert!(!rconfig.nonblocking());
+            assert!(!rconfig.input_shadow());
             assert_eq!(
                 rconfig.consumer().unwrap_err(),
                 ChipError::OperationFailed(
@@ -30,8 +32,12 @@ mod request_config {
             let mut rconfig = request::Config::new().unwrap();
             rconfig.set_consumer(CONSUMER).unwrap();
             rconfig.set_event_buffer_size(64);
+            rconfig.set_nonblocking(true);
+            rconfig.set_input_shadow(true);
 
             assert_eq!(rconfig.event_buffer_size(), 64);
+            assert!(rconfig.nonblocking());
+            assert!(rconfig.input_shadow());
             assert_eq!(rconfig.consumer().unwrap(), CONSUMER);
         }
     }
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+mod shared_request {
+    use libc::EBUSY;
+    use std::thread;
+    use std::time::Instant;
+
+    use gpiosim_sys::{Sim, Value as SimValue};
+    use libgpiod::{
+        chip::Chip,
+        line::{self, Direction, Offset, Value},
+        request::{Request, SharedRequest},
+        Error as ChipError, OperationType,
+    };
+
+    const NGPIO: usize = 8;
+
+    fn request_outputs(sim: &Sim, offsets: &[Offset]) -> Request {
+        let chip = Chip::open(&sim.dev_path()).unwrap();
+        let mut lsettings = line::Settings::new().unwrap();
+        let mut lconfig = line::Config::new().unwrap();
+
+        lsettings.set_direction(Direction::Output).unwrap();
+        lconfig.add_line_settings(offsets, lsettings).unwrap();
+
+        chip.request_lines(None, &lconfig).unwrap()
+    }
+
+    #[test]
+    fn claims_are_disjoint() {
+        let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+        let shared = SharedRequest::new(request_outputs(&sim, &[0, 1, 2, 3]));
+
+        let claim = shared.claim(&[1, 2]).unwrap();
+        assert_eq!(claim.mask(), 0b0110);
+
+        assert_eq!(
+            shared.claim(&[2, 3]).unwrap_err(),
+            ChipError::OperationFailed(OperationType::SharedRequestClaim, errno::Errno(EBUSY))
+        );
+
+        // Nothing was claimed by the failed attempt.
+        assert!(shared.claim(&[3]).is_ok());
+
+        drop(claim);
+        assert!(shared.claim(&[2, 3]).is_ok());
+    }
+
+    #[test]
+    fn set_claimed_lines() {
+        let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+        let shared = SharedRequest::new(request_outputs(&sim, &[0, 1, 2, 3]));
+
+        let mut claim = shared.claim(&[0, 3]).unwrap();
+        claim.set_values(0b1111).unwrap();
+        assert_eq!(sim.val(0).unwrap(), SimValue::Active);
+        assert_eq!(sim.val(1).unwrap(), SimValue::InActive);
+        assert_eq!(sim.val(2).unwrap(), SimValue::InActive);
+        assert_eq!(sim.val(3).unwrap(), SimValue::Active);
+
+        claim.set_values_mask(0b1000, 0).unwrap();
+        assert_eq!(sim.val(3).unwrap(), SimValue::InActive);
+        assert_eq!(claim.values().unwrap(), 0b0001);
+        assert_eq!(shared.value(0).unwrap(), Value::Active);
+        assert_eq!(shared.values_mask(0b1111).unwrap(), 0b0001);
+
+        assert_eq!(
+            claim.set_values_mask(0b0010, 0b0010).unwrap_err(),
+            ChipError::InvalidArguments
+        );
+    }
+
+    #[test]
+    fn threads_drive_their_own_lines() {
+        let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+        let offsets: Vec<Offset> = (0..NGPIO as Offset).collect();
+        let shared = SharedRequest::new(request_outputs(&sim, &offsets));
+
+        let handles: Vec<_> = offsets
+            .iter()
+            .map(|&offset| {
+                let mut claim = shared.claim(&[offset]).unwrap();
+
+                thread::spawn(move || {
+                    for i in 0..100 {
+                        claim
+                            .set_values(if i % 2 == 0 { u64::MAX } else { 0 })
+                            .unwrap();
+                    }
+
+                    claim.set_values(u64::MAX).unwrap();
+                })
+            })
+            .collect();
+
+        for handle in handles {
+            handle.join().unwrap();
+        }
+
+        for offset in offsets {
+            assert_eq!(sim.val(offset).unwrap(), SimValue::Active);
+        }
+
+        assert!(shared.try_unwrap().is_ok());
+    }
+
+    #[test]
+    fn try_unwrap_with_claims() {
+        let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+        let shared = SharedRequest::new(request_outputs(&sim, &[0, 1]));
+
+        let claim = shared.claim(&[0]).unwrap();
+        let shared = shared.try_unwrap().unwrap_err();
+
+        drop(claim);
+        assert!(shared.try_unwrap().is_ok());
+    }
+
+    // Scaling of value writes with the number of threads, each setting its own
+    // line of a single shared request. Hidden from the default run, use:
+    //
+    //   cargo test --test shared_request -- --ignored --nocapture
+    #[test]
+    #[ignore]
+    fn benchmark_disjoint_writes() {
+        const WRITES: usize = 100000;
+
+        let sim = Sim::new(Some(NGPIO), None, true).unwrap();
+        let offsets: Vec<Offset> = (0..NGPIO as Offset).collect();
+        let shared = SharedRequest::new(request_outputs(&sim, &offsets));
+
+        let mut num_threads = 1;
+        while num_threads <= NGPIO {
+            let claims: Vec<_> = offsets[..num_threads]
+                .iter()
+                .map(|&offset| shared.claim(&[offset]).unwrap())
+                .collect();
+
+            let start = Instant::now();
+            let handles: Vec<_> = claims
+                .into_iter()
+                .map(|mut claim| {
+                    thread::spawn(move || {
+                        for i in 0..WRITES {
+                            claim
+                                .set_values(if i % 2 == 0 { u64::MAX } else { 0 })
+                                .unwrap();
+                        }
+                    })
+                })
+                .collect();
+
+            for handle in handles {
+                handle.join().unwrap();
+            }
+
+            let elapsed = start.elapsed();
+            println!(
+                "{} thread(s): {:.0} writes/s",
+                num_threads,
+                (WRITES * num_threads) as f64 / elapsed.as_secs_f64()
+            );
+
+            num_threads *= 2;
+        }
+    }
+}
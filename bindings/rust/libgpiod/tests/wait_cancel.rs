@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: Apache-2.0 OR BSD-3-Clause
+// SPDX-FileCopyrightText: 2022 Linaro Ltd.
+// SPDX-FileCopyrightTest: 2022 Viresh Kumar <viresh.kumar@linaro.org>
+
+mod common;
+
+mod wait_cancel {
+    use std::sync::Arc;
+    use std::thread;
+    use std::time::Duration;
+
+    use crate::common::*;
+    use gpiosim_sys::Pull;
+    use libgpiod::{line::Edge, wait_cancel::WaitCancel};
+
+    const NGPIO: usize = 8;
+
+    #[test]
+    fn trigger_and_reset() {
+        let cancel = WaitCancel::new().unwrap();
+        assert!(!cancel.is_triggered());
+
+        cancel.trigger().unwrap();
+        assert!(cancel.is_triggered());
+
+        cancel.reset().unwrap();
+        assert!(!cancel.is_triggered());
+    }
+
+    #[test]
+    fn cancel_edge_event_wait() {
+        let mut config = TestConfig::new(NGPIO).unwrap();
+        config.lconfig_edge(None, Some(Edge::Both));
+        config.lconfig_add_settings(&[2]);
+        config.request_lines().unwrap();
+
+        let cancel = Arc::new(WaitCancel::new().unwrap());
+        let trigger = cancel.clone();
+
+        let handle = thread::spawn(move || {
+            thread::sleep(Duration::from_millis(30));
+            trigger.trigger().unwrap();
+        });
+
+        assert!(!config
+            .request()
+            .wait_edge_events_cancellable(Some(Duration::from_secs(5)), &cancel)
+            .unwrap());
+        handle.join().unwrap();
+
+        cancel.reset().unwrap();
+        config.set_pull(&[2], &[Pull::Up]);
+
+        assert!(config
+            .request()
+            .wait_edge_events_cancellable(Some(Duration::from_secs(1)), &cancel)
+            .unwrap());
+    }
+
+    #[test]
+    fn cancel_info_event_wait() {
+        let mut config = TestConfig::new(NGPIO).unwrap();
+        config.lconfig_add_settings(&[0]);
+        config.request_lines().unwrap();
+
+        let cancel = WaitCancel::new().unwrap();
+        config.chip().watch_line_info(3).unwrap();
+        cancel.trigger().unwrap();
+
+        assert!(!config
+            .chip()
+            .wait_info_event_cancellable(None, &cancel)
+            .unwrap());
+    }
+}
@@ -46,14 +46,48 @@ extern "C" {
 
 struct gpiod_chip;
 struct gpiod_chip_info;
+struct gpiod_chip_list;
+struct gpiod_chip_cache;
 struct gpiod_line_info;
 struct gpiod_line_settings;
 struct gpiod_line_config;
 struct gpiod_request_config;
+struct gpiod_request_template;
 struct gpiod_line_request;
+struct gpiod_line_subset;
+struct gpiod_line_transaction;
+struct gpiod_large_request;
+struct gpiod_multi_request;
+struct gpiod_multi_request_snapshot;
+struct gpiod_write_combiner;
 struct gpiod_info_event;
+struct gpiod_info_event_buffer;
+struct gpiod_line_info_cache;
+struct gpiod_line_info_snapshot;
+struct gpiod_info_event_coalescer;
 struct gpiod_edge_event;
 struct gpiod_edge_event_buffer;
+struct gpiod_waveform;
+struct gpiod_pwm;
+struct gpiod_output_scheduler;
+struct gpiod_pulse_meter;
+struct gpiod_pulse_decoder;
+struct gpiod_edge_event_pipeline;
+struct gpiod_bitbang;
+struct gpiod_bus_sampler;
+struct gpiod_line_monitor;
+struct gpiod_stats;
+struct gpiod_latency_histogram;
+struct gpiod_edge_stats;
+struct gpiod_clock_converter;
+struct gpiod_event_loop;
+struct gpiod_event_merger;
+struct gpiod_event_ring;
+struct gpiod_event_ring_reader;
+struct gpiod_capture_reader;
+struct gpiod_wait_cancel;
+struct gpiod_thread_attr;
+struct gpiod_mock_chip;
 
 /**
  * @defgroup chips GPIO chips
@@ -129,6 +163,42 @@ struct gpiod_line_info *gpiod_chip_watch_line_info(struct gpiod_chip *chip,
  */
 int gpiod_chip_unwatch_line_info(struct gpiod_chip *chip, unsigned int offset);
 
+/**
+ * @brief Get a snapshot of the status of a set of lines and start watching
+ *        them for future changes.
+ * @param chip GPIO chip object.
+ * @param offsets Array of line offsets to watch. If NULL, all lines exposed
+ *                by the chip are watched and \p num_offsets is ignored.
+ * @param num_offsets Number of offsets in the \p offsets array.
+ * @param infos Caller-provided array that is filled with the initial line-info
+ *              objects, in the order of \p offsets. It must be large enough
+ *              to hold an entry for every watched line. Each stored object
+ *              must be freed by the caller using ::gpiod_line_info_free. Can
+ *              be NULL if the initial state is of no interest in which case
+ *              no line-info objects are allocated.
+ * @return Number of lines watched on success, -1 on failure.
+ * @note The operation is all or nothing: if watching any of the lines fails,
+ *       the lines watched by this call are unwatched again before returning.
+ */
+int gpiod_chip_watch_line_infos(struct gpiod_chip *chip,
+				const unsigned int *offsets,
+				size_t num_offsets,
+				struct gpiod_line_info **infos);
+
+/**
+ * @brief Stop watching a set of lines for status changes.
+ * @param chip GPIO chip object.
+ * @param offsets Array of line offsets to unwatch. If NULL, all lines
+ *                exposed by the chip are unwatched and \p num_offsets is
+ *                ignored. In that case lines which are not being watched are
+ *                silently skipped.
+ * @param num_offsets Number of offsets in the \p offsets array.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_chip_unwatch_line_infos(struct gpiod_chip *chip,
+				  const unsigned int *offsets,
+				  size_t num_offsets);
+
 /**
  * @brief Get the file descriptor associated with the chip.
  * @param chip GPIO chip object.
@@ -153,6 +223,21 @@ int gpiod_chip_get_fd(struct gpiod_chip *chip);
  */
 int gpiod_chip_wait_info_event(struct gpiod_chip *chip, int64_t timeout_ns);
 
+/**
+ * @brief Wait for line status change events, aborting early if the wait is
+ *        cancelled.
+ * @param chip GPIO chip object.
+ * @param timeout_ns Wait time limit in nanoseconds. Same semantics as for
+ *                   ::gpiod_chip_wait_info_event.
+ * @param cancel Cancellation object watched alongside the chip.
+ * @return 0 if wait timed out, 1 if an event is pending, -1 if an error
+ *         occurred or if \p cancel was triggered in which case errno is set
+ *         to ECANCELED.
+ */
+int gpiod_chip_wait_info_event_cancellable(struct gpiod_chip *chip,
+					   int64_t timeout_ns,
+					   struct gpiod_wait_cancel *cancel);
+
 /**
  * @brief Read a single line status change event from the chip.
  * @param chip GPIO chip object.
@@ -162,6 +247,21 @@ int gpiod_chip_wait_info_event(struct gpiod_chip *chip, int64_t timeout_ns);
  */
 struct gpiod_info_event *gpiod_chip_read_info_event(struct gpiod_chip *chip);
 
+/**
+ * @brief Read a number of line status change events from the chip.
+ * @param chip GPIO chip object.
+ * @param buffer Info event buffer, sized to hold at least \p max_events.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events read from the file
+ *         descriptor, on failure return -1.
+ * @note If no events are pending, this function will block.
+ * @note Any existing events in the buffer are overwritten. This is not an
+ *       append operation.
+ */
+int gpiod_chip_read_info_events(struct gpiod_chip *chip,
+				struct gpiod_info_event_buffer *buffer,
+				size_t max_events);
+
 /**
  * @brief Map a line's name to its offset within the chip.
  * @param chip GPIO chip object.
@@ -173,6 +273,62 @@ struct gpiod_info_event *gpiod_chip_read_info_event(struct gpiod_chip *chip);
 int gpiod_chip_get_line_offset_from_name(struct gpiod_chip *chip,
 					 const char *name);
 
+/**
+ * @brief Enable or disable the line name index of the chip.
+ * @param chip GPIO chip object.
+ * @param enable New index setting.
+ *
+ * When enabled, the first call to ::gpiod_chip_get_line_offset_from_name
+ * reads the names of all lines in a single pass and caches them in the chip
+ * object. Subsequent lookups are resolved from the cache without issuing any
+ * ioctls. Disabling the index frees the cached names. The index is disabled
+ * by default.
+ */
+void gpiod_chip_set_name_index(struct gpiod_chip *chip, bool enable);
+
+/**
+ * @brief Check if the line name index of the chip is enabled.
+ * @param chip GPIO chip object.
+ * @return True if name lookups are served from the index, false otherwise.
+ */
+bool gpiod_chip_get_name_index(struct gpiod_chip *chip);
+
+/**
+ * @brief Re-read the names of all lines and rebuild the line name index.
+ * @param chip GPIO chip object.
+ * @return 0 on success, -1 on error.
+ * @note This function enables the index if it was disabled.
+ */
+int gpiod_chip_refresh_name_index(struct gpiod_chip *chip);
+
+/**
+ * @brief Drop the cached line names.
+ * @param chip GPIO chip object.
+ *
+ * If the index is enabled, it will be rebuilt on the next lookup. Line names
+ * are assigned by the kernel driver and don't normally change but users who
+ * know otherwise can use this function to force a fresh read.
+ */
+void gpiod_chip_invalidate_name_index(struct gpiod_chip *chip);
+
+/**
+ * @brief Get the I/O statistics of the chip.
+ * @param chip GPIO chip object.
+ * @return Snapshot of the statistics of the calls made on the chip's file
+ *         descriptor or NULL on error. The returned object must be freed by
+ *         the caller using ::gpiod_stats_free.
+ * @note Requesting lines counts as a configuration ioctl of the chip.
+ *       Operations on the line requests are counted by the requests, see
+ *       ::gpiod_line_request_get_stats.
+ */
+struct gpiod_stats *gpiod_chip_get_stats(struct gpiod_chip *chip);
+
+/**
+ * @brief Zero the I/O statistics of the chip.
+ * @param chip GPIO chip object.
+ */
+void gpiod_chip_reset_stats(struct gpiod_chip *chip);
+
 /**
  * @brief Request a set of lines for exclusive usage.
  * @param chip GPIO chip object.
@@ -186,6 +342,45 @@ gpiod_chip_request_lines(struct gpiod_chip *chip,
 			 struct gpiod_request_config *req_cfg,
 			 struct gpiod_line_config *line_cfg);
 
+/**
+ * @brief Request a set of lines using a precompiled request template.
+ * @param chip GPIO chip object.
+ * @param tmpl Request template object.
+ * @return New line request object or NULL if an error occurred. The request
+ *         must be released by the caller using ::gpiod_line_request_release.
+ *
+ * Equivalent to ::gpiod_chip_request_lines called with the configuration the
+ * template was created from but skips translating it for the kernel.
+ */
+struct gpiod_line_request *
+gpiod_chip_request_lines_from_template(struct gpiod_chip *chip,
+				       struct gpiod_request_template *tmpl);
+
+/**
+ * @brief Make many independent line requests in a single call.
+ * @param chip GPIO chip object.
+ * @param req_cfgs Array of request config objects, one per request. Can be
+ *                 NULL for default settings of all requests and any of its
+ *                 entries can be NULL for default settings of that request.
+ * @param line_cfgs Array of line config objects, one per request.
+ * @param num_requests Number of requests to make.
+ * @param requests Array of at least num_requests entries the new requests
+ *                 are stored in. Each must be released by the caller using
+ *                 ::gpiod_line_request_release.
+ * @return 0 on success, -1 on failure.
+ *
+ * Every request gets a file descriptor of its own, as if made with
+ * ::gpiod_chip_request_lines. All configs are translated and checked before
+ * any lines are requested - a line claimed by more than one request of the
+ * batch fails it with errno set to EBUSY. The batch is all or nothing: if any
+ * of the requests can't be made, the ones already made are released.
+ */
+int gpiod_chip_request_lines_batch(struct gpiod_chip *chip,
+				   struct gpiod_request_config *const *req_cfgs,
+				   struct gpiod_line_config *const *line_cfgs,
+				   size_t num_requests,
+				   struct gpiod_line_request **requests);
+
 /**
  * @}
  *
@@ -237,6 +432,133 @@ const char *gpiod_chip_info_get_label(struct gpiod_chip_info *info);
  */
 size_t gpiod_chip_info_get_num_lines(struct gpiod_chip_info *info);
 
+/**
+ * @}
+ *
+ * @defgroup chip_list Chip enumeration
+ * @{
+ *
+ * Functions for finding all GPIO chips present in the system.
+ *
+ * The chips are looked up in a single pass over the GPIO bus in sysfs, none
+ * of the devices is opened for that. If the kernel exposes the label and the
+ * number of lines of the chips in sysfs too, they can be retrieved without
+ * opening the devices as well. Without sysfs, all files in /dev are checked
+ * with ::gpiod_is_gpiochip_device instead.
+ */
+
+/**
+ * @brief Flags controlling the chip enumeration.
+ */
+enum gpiod_chip_list_flag {
+	GPIOD_CHIP_LIST_TRUSTED_PATHS = 1,
+	/**< Don't check that the device file of each chip exists in /dev and
+	 *   refers to the chip. */
+};
+
+/**
+ * @brief Find all GPIO chips present in the system.
+ * @param flags Bitwise OR of the GPIOD_CHIP_LIST_* flags or 0.
+ * @return New chip list object or NULL if an error occurred. The returned
+ *         object must be freed by the caller using ::gpiod_chip_list_free.
+ *
+ * Chips are sorted alphabetically by their names.
+ */
+struct gpiod_chip_list *gpiod_chip_list_new(int flags);
+
+/**
+ * @brief Free the chip list object and release all associated resources.
+ * @param list Chip list object.
+ */
+void gpiod_chip_list_free(struct gpiod_chip_list *list);
+
+/**
+ * @brief Get the number of chips found.
+ * @param list Chip list object.
+ * @return Number of chips in the list.
+ */
+size_t gpiod_chip_list_get_num_chips(struct gpiod_chip_list *list);
+
+/**
+ * @brief Get the path to the device file of a chip.
+ * @param list Chip list object.
+ * @param index Index of the chip in the list.
+ * @return Path that can be passed to ::gpiod_chip_open or NULL if the index
+ *         is out of range. The string lifetime is tied to the chip list
+ *         object so the pointer must not be freed by the caller.
+ */
+const char *gpiod_chip_list_get_path(struct gpiod_chip_list *list,
+				     size_t index);
+
+/**
+ * @brief Get information about a chip.
+ * @param list Chip list object.
+ * @param index Index of the chip in the list.
+ * @return New GPIO chip info object or NULL if an error occurred. The returned
+ *         object must be freed by the caller using ::gpiod_chip_info_free.
+ *
+ * If the information isn't available from sysfs, the chip is opened once to
+ * read it and the result is stored in the list for subsequent calls.
+ */
+struct gpiod_chip_info *gpiod_chip_list_get_info(struct gpiod_chip_list *list,
+						 size_t index);
+
+/**
+ * @}
+ *
+ * @defgroup chip_cache Chip handle cache
+ * @{
+ *
+ * A cache of open chips keyed by the path they were opened with.
+ *
+ * Programs resolving lines first and requesting them later, or requesting
+ * lines from the same chips at several points, can use it to open and
+ * validate each chip device only once. The cache owns the chips and closes
+ * them when freed. It isn't thread-safe.
+ */
+
+/**
+ * @brief Create a new, empty chip cache.
+ * @return New chip cache object or NULL if an error occurred. The returned
+ *         object must be freed by the caller using ::gpiod_chip_cache_free.
+ */
+struct gpiod_chip_cache *gpiod_chip_cache_new(void);
+
+/**
+ * @brief Close all chips in the cache and free it.
+ * @param cache Chip cache object.
+ */
+void gpiod_chip_cache_free(struct gpiod_chip_cache *cache);
+
+/**
+ * @brief Get an open chip from the cache, opening it if needed.
+ * @param cache Chip cache object.
+ * @param path Path to the gpiochip device file.
+ * @return GPIO chip object or NULL if the chip isn't cached and opening it
+ *         failed. The chip is owned by the cache and must not be closed by
+ *         the caller, it stays valid until it's removed from the cache with
+ *         ::gpiod_chip_cache_close or the cache is freed.
+ * @note Paths are compared as strings, different paths referring to the same
+ *       device are cached separately.
+ */
+struct gpiod_chip *gpiod_chip_cache_open(struct gpiod_chip_cache *cache,
+					 const char *path);
+
+/**
+ * @brief Close a chip and remove it from the cache.
+ * @param cache Chip cache object.
+ * @param path Path the chip was opened with. Nothing is done if no chip
+ *             with this path is cached.
+ */
+void gpiod_chip_cache_close(struct gpiod_chip_cache *cache, const char *path);
+
+/**
+ * @brief Get the number of open chips in the cache.
+ * @param cache Chip cache object.
+ * @return Number of chips.
+ */
+size_t gpiod_chip_cache_get_num_chips(struct gpiod_chip_cache *cache);
+
 /**
  * @}
  *
@@ -535,6 +857,330 @@ uint64_t gpiod_info_event_get_timestamp_ns(struct gpiod_info_event *event);
 struct gpiod_line_info *
 gpiod_info_event_get_line_info(struct gpiod_info_event *event);
 
+/**
+ * @brief Create a new info event buffer.
+ * @param capacity Number of events the buffer can store (min = 1, max = 32).
+ * @return New info event buffer or NULL on error.
+ * @note If capacity equals 0, it will be set to a default value of 32. If
+ *       capacity is larger than 32, it will be limited to 32 which is the
+ *       size of the kernel's info event queue.
+ * @note All storage for the events and their line-info snapshots is
+ *       allocated up front. Reading events into the buffer performs no
+ *       memory allocations.
+ */
+struct gpiod_info_event_buffer *
+gpiod_info_event_buffer_new(size_t capacity);
+
+/**
+ * @brief Get the capacity (the max number of events that can be stored) of
+ *        the info event buffer.
+ * @param buffer Info event buffer.
+ * @return The capacity of the buffer.
+ */
+size_t
+gpiod_info_event_buffer_get_capacity(struct gpiod_info_event_buffer *buffer);
+
+/**
+ * @brief Free the info event buffer and release all associated resources.
+ * @param buffer Info event buffer to free.
+ */
+void gpiod_info_event_buffer_free(struct gpiod_info_event_buffer *buffer);
+
+/**
+ * @brief Get an event stored in the buffer.
+ * @param buffer Info event buffer.
+ * @param index Index of the event in the buffer.
+ * @return Pointer to an event stored in the buffer. The lifetime of the
+ *         event is tied to the buffer object. Users must not free the event
+ *         returned by this function.
+ */
+struct gpiod_info_event *
+gpiod_info_event_buffer_get_event(struct gpiod_info_event_buffer *buffer,
+				  unsigned long index);
+
+/**
+ * @brief Get the number of events a buffer has stored.
+ * @param buffer Info event buffer.
+ * @return Number of events stored in the buffer.
+ */
+size_t
+gpiod_info_event_buffer_get_num_events(struct gpiod_info_event_buffer *buffer);
+
+/**
+ * @}
+ *
+ * @defgroup line_info_cache Line info cache
+ * @{
+ *
+ * Chip-wide cache of line-info snapshots kept up to date by line status
+ * watch events.
+ *
+ * The cache loads the state of every line of the chip once and starts
+ * watching all of them. Afterwards it is updated by consuming the info events
+ * queued on the chip's file descriptor, so reading the state of any line
+ * doesn't require an ioctl. Every batch of applied changes bumps the
+ * generation counter of the cache, letting users cheaply check whether
+ * anything changed since they last looked.
+ *
+ * The cache takes over the info event stream of the chip: the chip's lines
+ * must not be watched or unwatched and its info events must not be read by
+ * other means while the cache exists. The chip must outlive the cache.
+ */
+
+/**
+ * @brief Create a line info cache for all lines of a chip.
+ * @param chip GPIO chip object.
+ * @return New line info cache or NULL on error. The cache must be freed by
+ *         the caller using ::gpiod_line_info_cache_free.
+ * @note Fails with EBUSY if any line of the chip is already being watched.
+ */
+struct gpiod_line_info_cache *
+gpiod_line_info_cache_new(struct gpiod_chip *chip);
+
+/**
+ * @brief Free the line info cache and stop watching the chip's lines.
+ * @param cache Line info cache to free.
+ */
+void gpiod_line_info_cache_free(struct gpiod_line_info_cache *cache);
+
+/**
+ * @brief Get the number of lines held by the cache.
+ * @param cache Line info cache object.
+ * @return Number of lines of the associated chip.
+ */
+size_t gpiod_line_info_cache_get_num_lines(struct gpiod_line_info_cache *cache);
+
+/**
+ * @brief Get the generation counter of the cache.
+ * @param cache Line info cache object.
+ * @return Value that changes every time the cached state is modified.
+ */
+uint64_t
+gpiod_line_info_cache_get_generation(struct gpiod_line_info_cache *cache);
+
+/**
+ * @brief Get the cached snapshot of a line's info.
+ * @param cache Line info cache object.
+ * @param offset Offset of the line.
+ * @return Copy of the cached line-info object or NULL on error. The object
+ *         must be freed by the caller using ::gpiod_line_info_free.
+ * @note This function doesn't access the kernel. Call
+ *       ::gpiod_line_info_cache_update first to apply pending changes.
+ */
+struct gpiod_line_info *
+gpiod_line_info_cache_get_line_info(struct gpiod_line_info_cache *cache,
+				    unsigned int offset);
+
+/**
+ * @brief Get the file descriptor signalling pending changes.
+ * @param cache Line info cache object.
+ * @return File descriptor of the associated chip. It becomes readable when
+ *         the cache has pending updates and can be used with poll() and
+ *         similar system calls.
+ */
+int gpiod_line_info_cache_get_fd(struct gpiod_line_info_cache *cache);
+
+/**
+ * @brief Apply all pending line status changes to the cache.
+ * @param cache Line info cache object.
+ * @return Number of applied info events, 0 if there were none or -1 on error.
+ * @note This function never blocks.
+ */
+int gpiod_line_info_cache_update(struct gpiod_line_info_cache *cache);
+
+/**
+ * @brief Re-read the state of all lines from the kernel.
+ * @param cache Line info cache object.
+ * @return 0 on success, -1 on error.
+ *
+ * The kernel may drop info events if they're not read quickly enough. This
+ * function can be used to resynchronize the cache after such a period.
+ */
+int gpiod_line_info_cache_reload(struct gpiod_line_info_cache *cache);
+
+/**
+ * @}
+ *
+ * @defgroup line_info_snapshot Line info snapshots
+ * @{
+ *
+ * Compact snapshot of the info of all lines of a chip.
+ *
+ * Standalone line-info objects are allocated one by one and each carries
+ * room for a full name and consumer string. A snapshot instead stores the
+ * info of every line of a chip in a single memory block, with the strings
+ * interned so that each distinct name or consumer is stored once. This makes
+ * holding the state of many thousands of lines cheap. The line-info objects
+ * it hands out are read with the usual line-info getters.
+ *
+ * A snapshot is never updated, create a new one to see later changes.
+ */
+
+/**
+ * @brief Read the info of all lines of a chip into a new snapshot.
+ * @param chip GPIO chip object.
+ * @return New line info snapshot or NULL on error. The snapshot must be freed
+ *         by the caller using ::gpiod_line_info_snapshot_free.
+ * @note The snapshot doesn't reference the chip which may be closed
+ *       afterwards.
+ */
+struct gpiod_line_info_snapshot *
+gpiod_line_info_snapshot_new(struct gpiod_chip *chip);
+
+/**
+ * @brief Free the line info snapshot and release all associated resources.
+ * @param snapshot Line info snapshot to free.
+ */
+void gpiod_line_info_snapshot_free(struct gpiod_line_info_snapshot *snapshot);
+
+/**
+ * @brief Get the number of lines held by the snapshot.
+ * @param snapshot Line info snapshot object.
+ * @return Number of lines of the chip at the time the snapshot was taken.
+ */
+size_t
+gpiod_line_info_snapshot_get_num_lines(struct gpiod_line_info_snapshot *snapshot);
+
+/**
+ * @brief Get the info of a line stored in the snapshot.
+ * @param snapshot Line info snapshot object.
+ * @param offset Offset of the line.
+ * @return Pointer to the line-info object or NULL if the offset is out of
+ *         range. The lifetime of the object is tied to the snapshot, it must
+ *         not be freed by the caller. Use ::gpiod_line_info_copy to keep it
+ *         around for longer.
+ */
+struct gpiod_line_info *
+gpiod_line_info_snapshot_get_line_info(
+		struct gpiod_line_info_snapshot *snapshot, unsigned int offset);
+
+/**
+ * @brief Get the amount of memory used by the snapshot.
+ * @param snapshot Line info snapshot object.
+ * @return Size of the snapshot in bytes.
+ */
+size_t
+gpiod_line_info_snapshot_get_size(struct gpiod_line_info_snapshot *snapshot);
+
+/**
+ * @}
+ *
+ * @defgroup info_event_coalescer Info event coalescing
+ * @{
+ *
+ * An info event coalescer reads the info events of a chip and merges the
+ * events of every line occurring within a time window into a single one.
+ *
+ * Reconfiguring or re-requesting many lines produces a burst of events, e.g.
+ * a release immediately followed by a request for every line, while most
+ * consumers only care about the resulting state. The window of a line opens
+ * with its first event. Once it elapses, a single event describing the net
+ * change is returned: it carries the line-info snapshot of the last merged
+ * event and its type is derived from whether the line was requested before
+ * the first and after the last merged event. A line requested throughout is
+ * reported as reconfigured. Bursts leaving an unrequested line unrequested
+ * don't change anything and are only counted.
+ *
+ * The coalescer takes over reading the info events of the chip: they must
+ * not be read by other means while it exists. Which lines are watched is
+ * still up to the user. The chip must outlive the coalescer.
+ */
+
+/**
+ * @brief Create a new info event coalescer.
+ * @param chip GPIO chip to read the info events from.
+ * @param window_ns Time window in nanoseconds during which the events of a
+ *                  line are merged, counted from the first of them. If 0,
+ *                  only events read in one go are merged.
+ * @return New info event coalescer or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_info_event_coalescer_free.
+ */
+struct gpiod_info_event_coalescer *
+gpiod_info_event_coalescer_new(struct gpiod_chip *chip, uint64_t window_ns);
+
+/**
+ * @brief Free the info event coalescer and release all associated resources.
+ * @param coalescer Info event coalescer to free.
+ * @note Events still held back are discarded. Use
+ *       ::gpiod_info_event_coalescer_flush_info_events to retrieve them
+ *       first.
+ */
+void
+gpiod_info_event_coalescer_free(struct gpiod_info_event_coalescer *coalescer);
+
+/**
+ * @brief Get the file descriptor of the info event coalescer.
+ * @param coalescer Info event coalescer object.
+ * @return File descriptor which becomes readable when the chip has info
+ *         events pending or when the window of the oldest held back line
+ *         elapses.
+ * @note Readiness doesn't imply that a read returns any events as new events
+ *       may still be inside their window.
+ */
+int
+gpiod_info_event_coalescer_get_fd(struct gpiod_info_event_coalescer *coalescer);
+
+/**
+ * @brief Wait until coalesced info events are ready to be read.
+ * @param coalescer Info event coalescer object.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until events are ready. The
+ *                   timeout has millisecond resolution and is rounded up.
+ * @return 0 if the wait timed out, -1 on error, 1 if events are ready.
+ */
+int gpiod_info_event_coalescer_wait_info_events(
+		struct gpiod_info_event_coalescer *coalescer,
+		int64_t timeout_ns);
+
+/**
+ * @brief Read the coalesced info events whose window elapsed.
+ * @param coalescer Info event coalescer object.
+ * @param buffer Info event buffer the events are stored in.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events read, which may be 0.
+ *         Returns -1 on error.
+ * @note This function never blocks.
+ * @note Events are returned in the order in which the windows of their lines
+ *       were opened. Their timestamps are those of the last merged events.
+ */
+int gpiod_info_event_coalescer_read_info_events(
+		struct gpiod_info_event_coalescer *coalescer,
+		struct gpiod_info_event_buffer *buffer, size_t max_events);
+
+/**
+ * @brief Read the held back info events without waiting for their window to
+ *        elapse.
+ * @param coalescer Info event coalescer object.
+ * @param buffer Info event buffer the events are stored in.
+ * @param max_events Maximum number of events to read.
+ * @return Number of events read or -1 on error.
+ */
+int gpiod_info_event_coalescer_flush_info_events(
+		struct gpiod_info_event_coalescer *coalescer,
+		struct gpiod_info_event_buffer *buffer, size_t max_events);
+
+/**
+ * @brief Get the number of info events merged into an event returned by the
+ *        last read.
+ * @param coalescer Info event coalescer object.
+ * @param index Index of the event in the buffer passed to the last read.
+ * @return Number of events read from the chip which the event stands for or
+ *         0 if the index is out of range.
+ */
+unsigned long gpiod_info_event_coalescer_get_num_merged(
+		struct gpiod_info_event_coalescer *coalescer,
+		unsigned long index);
+
+/**
+ * @brief Get the number of info events which didn't result in any change.
+ * @param coalescer Info event coalescer object.
+ * @return Number of events merged into bursts which left their line
+ *         unrequested and which were therefore never returned.
+ */
+unsigned long gpiod_info_event_coalescer_get_num_suppressed(
+		struct gpiod_info_event_coalescer *coalescer);
+
 /**
  * @}
  *
@@ -900,16 +1546,269 @@ size_t
 gpiod_request_config_get_event_buffer_size(struct gpiod_request_config *config);
 
 /**
- * @}
- *
- * @defgroup request_request Line request operations
- * @{
- *
- * Functions allowing interactions with requested lines.
+ * @brief Let the kernel event buffer of the request grow on demand.
+ * @param config Request config object.
+ * @param max_size Maximum size the event buffer may grow to. If set to 0,
+ *                 which is the default, the buffer size is fixed.
+ * @note The request starts out with the size set by
+ *       ::gpiod_request_config_set_event_buffer_size. Whenever
+ *       ::gpiod_line_request_read_edge_events detects that events were dropped
+ *       or finds the buffer full, the size is doubled up to \p max_size. The
+ *       kernel can't resize the buffer of an existing request so the lines
+ *       are released and requested again with the same configuration and
+ *       output values. Edge events occurring in between are lost and another
+ *       process may claim the lines in the meantime.
+ * @note The file descriptor of the request keeps its number but refers to a
+ *       new file afterwards. Callers watching it with epoll must add it to
+ *       their epoll set again. Event loops take care of it themselves.
+ * @note The buffer only grows once all queued events have been read.
  */
+void gpiod_request_config_set_max_event_buffer_size(
+		struct gpiod_request_config *config, size_t max_size);
 
 /**
- * @brief Release the requested lines and free all associated resources.
+ * @brief Get the maximum size the kernel event buffer may grow to.
+ * @param config Request config object.
+ * @return Maximum event buffer size or 0 if adaptive sizing is disabled.
+ */
+size_t gpiod_request_config_get_max_event_buffer_size(
+		struct gpiod_request_config *config);
+
+/**
+ * @brief Enable or disable the output value shadow for the request.
+ * @param config Request config object.
+ * @param enabled New output shadow setting.
+ * @note With the shadow enabled, the request caches the last value driven on
+ *       each of its push-pull output lines. Reading such lines is served from
+ *       the cache without a system call and writes that would not change any
+ *       line are skipped. This is only correct as long as the lines are
+ *       exclusively driven through this request. Open-drain and open-source
+ *       outputs as well as inputs are always read from the kernel.
+ */
+void
+gpiod_request_config_set_output_shadow(struct gpiod_request_config *config,
+				       bool enabled);
+
+/**
+ * @brief Check if the output value shadow is enabled in the request config.
+ * @param config Request config object.
+ * @return True if the output shadow is enabled, false otherwise.
+ */
+bool
+gpiod_request_config_get_output_shadow(struct gpiod_request_config *config);
+
+/**
+ * @brief Enable or disable the input value shadow for the request.
+ * @param config Request config object.
+ * @param enabled New input shadow setting.
+ * @note With the shadow enabled, the values of input lines with both edges
+ *       detected are read from the kernel once when the lines are requested
+ *       and then kept current from the edge events read from the request.
+ *       Reading such lines is served from the shadow without a system call
+ *       and reflects exactly the events read so far, regardless of how many
+ *       more are still queued in the kernel. Edge events must be read
+ *       regularly for the shadow to stay current.
+ * @note The shadow follows the events as reported by the kernel, before
+ *       software debouncing and edge event filtering are applied.
+ * @note If events were lost or the kernel event buffer was found full, the
+ *       shadowed lines are read back from the kernel on the next read of
+ *       their values. The same happens after the lines are reconfigured or
+ *       the event buffer has grown.
+ */
+void
+gpiod_request_config_set_input_shadow(struct gpiod_request_config *config,
+				      bool enabled);
+
+/**
+ * @brief Check if the input value shadow is enabled in the request config.
+ * @param config Request config object.
+ * @return True if the input shadow is enabled, false otherwise.
+ */
+bool
+gpiod_request_config_get_input_shadow(struct gpiod_request_config *config);
+
+/**
+ * @brief Make the file descriptor of the request non-blocking.
+ * @param config Request config object.
+ * @param enabled New non-blocking setting.
+ * @note The request's file descriptor is opened with O_NONBLOCK and
+ *       ::gpiod_line_request_read_edge_events returns 0 instead of blocking
+ *       if no events are queued. This makes the request usable with
+ *       edge-triggered epoll and busy-polling loops.
+ */
+void
+gpiod_request_config_set_nonblocking(struct gpiod_request_config *config,
+				     bool enabled);
+
+/**
+ * @brief Check if the request config makes requests non-blocking.
+ * @param config Request config object.
+ * @return True if requests are non-blocking, false otherwise.
+ */
+bool
+gpiod_request_config_get_nonblocking(struct gpiod_request_config *config);
+
+/**
+ * @brief Record the latency of edge events in the requests made with this
+ *        config.
+ * @param config Request config object.
+ * @param enabled New latency histogram setting.
+ * @note The latency is the time between the timestamp the kernel gave an event
+ *       and the event being read from the request, measured with the event
+ *       clock of its line. It's recorded in a histogram per line, see
+ *       ::gpiod_line_request_get_latency_histogram.
+ * @note Lines using the hardware timestamping engine are not recorded as
+ *       their timestamps can't be related to any clock user space can read.
+ */
+void
+gpiod_request_config_set_latency_histogram(struct gpiod_request_config *config,
+					   bool enabled);
+
+/**
+ * @brief Check if the request config enables edge event latency histograms.
+ * @param config Request config object.
+ * @return True if latency histograms are enabled, false otherwise.
+ */
+bool
+gpiod_request_config_get_latency_histogram(struct gpiod_request_config *config);
+
+/**
+ * @brief Collect edge statistics of the lines requested with this config.
+ * @param config Request config object.
+ * @param enabled New edge statistics setting.
+ * @note The statistics are updated as edge events are read from the request,
+ *       see ::gpiod_line_request_get_edge_stats.
+ */
+void
+gpiod_request_config_set_edge_stats(struct gpiod_request_config *config,
+				    bool enabled);
+
+/**
+ * @brief Check if the request config enables edge statistics.
+ * @param config Request config object.
+ * @return True if edge statistics are enabled, false otherwise.
+ */
+bool gpiod_request_config_get_edge_stats(struct gpiod_request_config *config);
+
+/**
+ * @}
+ *
+ * @defgroup request_template Request templates
+ * @{
+ *
+ * Request templates store a line and request configuration already
+ * translated into the form passed to the kernel. They're useful when the same
+ * set of lines is requested many times - for example on several identical
+ * chips or again after every release - as the translation is done only once.
+ *
+ * The template doesn't reference the config objects it was created from, they
+ * can be modified or freed right after the template is created.
+ */
+
+/**
+ * @brief Create a new request template.
+ * @param req_cfg Request config object. Can be NULL for default settings.
+ * @param line_cfg Line config object.
+ * @return New request template object or NULL on error. The returned object
+ *         must be freed by the caller using ::gpiod_request_template_free.
+ */
+struct gpiod_request_template *
+gpiod_request_template_new(struct gpiod_request_config *req_cfg,
+			   struct gpiod_line_config *line_cfg);
+
+/**
+ * @brief Free the request template object and release all associated
+ *        resources.
+ * @param tmpl Request template object.
+ */
+void gpiod_request_template_free(struct gpiod_request_template *tmpl);
+
+/**
+ * @brief Get the number of lines requested by the template.
+ * @param tmpl Request template object.
+ * @return Number of lines.
+ */
+size_t gpiod_request_template_get_num_lines(struct gpiod_request_template *tmpl);
+
+/**
+ * @}
+ *
+ * @defgroup request_state Request state snapshots
+ * @{
+ *
+ * The state of a line request can be saved into a compact binary blob and
+ * used to request the same lines again, for instance after a restart of the
+ * process that owns them. The state holds the request config, the settings
+ * of every line and the values the outputs are driven with at the time it
+ * is saved, so the lines are requested back with no glitch on their outputs
+ * and without rebuilding the configuration objects by hand.
+ *
+ * The blob starts with a magic number and a format version and is checked
+ * when loaded. It is stored in host byte order and meant to be loaded on
+ * the machine that saved it.
+ */
+
+/**
+ * @brief Save the state of a line request.
+ * @param request Line request object.
+ * @param buf Buffer to store the state in. Can be NULL if \p size is 0.
+ * @param size Size of the buffer.
+ * @return Size of the state in bytes or -1 on error. If it's larger than
+ *         \p size, nothing is stored and the call must be repeated with a
+ *         larger buffer.
+ * @note The values of the outputs are read from the output shadow if the
+ *       request has one, otherwise from the kernel.
+ */
+int gpiod_line_request_save_state(struct gpiod_line_request *request,
+				  void *buf, size_t size);
+
+/**
+ * @brief Load a saved request state into configuration objects.
+ * @param buf Buffer holding the state.
+ * @param size Size of the buffer.
+ * @param req_cfg Request config object to fill in. Can be NULL if only the
+ *                line config is of interest.
+ * @param line_cfg Line config object to fill in. It's reset first.
+ * @return 0 on success, -1 on failure. Fails with errno set to EINVAL if the
+ *         buffer doesn't hold a valid state of a supported version.
+ */
+int gpiod_request_state_load(const void *buf, size_t size,
+			     struct gpiod_request_config *req_cfg,
+			     struct gpiod_line_config *line_cfg);
+
+/**
+ * @brief Request the lines of a saved request state.
+ * @param chip GPIO chip object.
+ * @param buf Buffer holding the state.
+ * @param size Size of the buffer.
+ * @return New line request object or NULL if an error occurred. The request
+ *         must be released by the caller using ::gpiod_line_request_release.
+ *
+ * Equivalent to loading the state with ::gpiod_request_state_load and
+ * passing the resulting objects to ::gpiod_chip_request_lines.
+ */
+struct gpiod_line_request *
+gpiod_chip_request_lines_from_state(struct gpiod_chip *chip, const void *buf,
+				    size_t size);
+
+/**
+ * @}
+ *
+ * @defgroup request_request Line request operations
+ * @{
+ *
+ * Functions allowing interactions with requested lines.
+ *
+ * The functions reading and setting line values may be called concurrently
+ * from many threads using the same request as long as no two threads set the
+ * same lines at the same time. The value shadows and the statistics of the
+ * request are updated atomically for that purpose. All other operations,
+ * including reading edge events and reconfiguring the lines, must not run
+ * concurrently with any other call using the same request.
+ */
+
+/**
+ * @brief Release the requested lines and free all associated resources.
  * @param request Line request object to release.
  */
 void gpiod_line_request_release(struct gpiod_line_request *request);
@@ -938,6 +1837,37 @@ gpiod_line_request_get_requested_offsets(struct gpiod_line_request *request,
 					 unsigned int *offsets,
 					 size_t max_offsets);
 
+/**
+ * @brief Map the offset of a requested line to its bit position in the request.
+ * @param request Line request object.
+ * @param offset Offset of the line.
+ * @return Bit position of the line in the value masks used by
+ *         ::gpiod_line_request_get_values_mask and
+ *         ::gpiod_line_request_set_values_mask or -1 if the line is not part
+ *         of the request.
+ *
+ * The bit position of a line is the index of its offset in the array filled
+ * by ::gpiod_line_request_get_requested_offsets.
+ */
+int gpiod_line_request_get_offset_bit(struct gpiod_line_request *request,
+				      unsigned int offset);
+
+/**
+ * @brief Convert a set of requested offsets into a request-relative bitmask.
+ * @param request Line request object.
+ * @param num_offsets Number of offsets in \p offsets.
+ * @param offsets Array of offsets of requested lines.
+ * @param mask Location in which the resulting bitmask will be stored.
+ * @return 0 on success, -1 on failure.
+ *
+ * This allows the translation between offsets and bit positions to be done
+ * once, outside of any hot loop using the mask-based getters and setters.
+ */
+int gpiod_line_request_offsets_to_mask(struct gpiod_line_request *request,
+				       size_t num_offsets,
+				       const unsigned int *offsets,
+				       uint64_t *mask);
+
 /**
  * @brief Get the value of a single requested line.
  * @param request Line request object.
@@ -978,6 +1908,20 @@ int gpiod_line_request_get_values_subset(struct gpiod_line_request *request,
 int gpiod_line_request_get_values(struct gpiod_line_request *request,
 				  enum gpiod_line_value *values);
 
+/**
+ * @brief Get the values of requested lines identified by a bitmask.
+ * @param request GPIO line request.
+ * @param mask Bitmask of the lines for which to read values. Bit N
+ *             corresponds to the line at index N of the array filled by
+ *             ::gpiod_line_request_get_requested_offsets.
+ * @param values Location in which the values will be stored. Bit N is set if
+ *               the line at index N is active. Bits not set in \p mask are
+ *               cleared.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_request_get_values_mask(struct gpiod_line_request *request,
+				       uint64_t mask, uint64_t *values);
+
 /**
  * @brief Set the value of a single requested line.
  * @param request Line request object.
@@ -1018,6 +1962,119 @@ int gpiod_line_request_set_values_subset(struct gpiod_line_request *request,
 int gpiod_line_request_set_values(struct gpiod_line_request *request,
 				  const enum gpiod_line_value *values);
 
+/**
+ * @brief Set the values of requested lines identified by a bitmask.
+ * @param request GPIO line request.
+ * @param mask Bitmask of the lines for which to set values. Bit N corresponds
+ *             to the line at index N of the array filled by
+ *             ::gpiod_line_request_get_requested_offsets.
+ * @param values Bitmap of the values to set. Bit N set makes the line at
+ *               index N active. Bits not set in \p mask are ignored.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_request_set_values_mask(struct gpiod_line_request *request,
+				       uint64_t mask, uint64_t values);
+
+/**
+ * @brief Set requested lines identified by a bitmask to active.
+ * @param request GPIO line request.
+ * @param mask Bitmask of the lines to activate. Bit N corresponds to the line
+ *             at index N of the array filled by
+ *             ::gpiod_line_request_get_requested_offsets.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_request_set_bits(struct gpiod_line_request *request,
+				uint64_t mask);
+
+/**
+ * @brief Set requested lines identified by a bitmask to inactive.
+ * @param request GPIO line request.
+ * @param mask Bitmask of the lines to deactivate.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_request_clear_bits(struct gpiod_line_request *request,
+				  uint64_t mask);
+
+/**
+ * @brief Invert the values of requested lines identified by a bitmask.
+ * @param request GPIO line request.
+ * @param mask Bitmask of the lines to toggle.
+ * @return 0 on success, -1 on failure.
+ * @note If the request has the output shadow enabled
+ *       (::gpiod_request_config_set_output_shadow) and it covers all lines in
+ *       \p mask, this is a single system call. Otherwise the current values
+ *       of the lines not covered by the shadow are read back from the kernel
+ *       first.
+ */
+int gpiod_line_request_toggle_bits(struct gpiod_line_request *request,
+				   uint64_t mask);
+
+/**
+ * @brief Prepare a subset of requested lines for repeated reads and writes.
+ * @param request GPIO line request.
+ * @param num_offsets Number of offsets in \p offsets.
+ * @param offsets Array of offsets identifying the subset of requested lines.
+ * @return New line subset object or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_line_subset_free.
+ *
+ * The offsets are validated and mapped to their bit positions in the request
+ * once. Reading and writing values through the subset then costs a single
+ * ioctl plus a scatter or gather of bits.
+ *
+ * @note The subset references the request it was created from and must not be
+ *       used after that request was released.
+ */
+struct gpiod_line_subset *
+gpiod_line_request_prepare_subset(struct gpiod_line_request *request,
+				  size_t num_offsets,
+				  const unsigned int *offsets);
+
+/**
+ * @brief Free a line subset object.
+ * @param subset Line subset to free.
+ */
+void gpiod_line_subset_free(struct gpiod_line_subset *subset);
+
+/**
+ * @brief Get the number of lines in the subset.
+ * @param subset Line subset object.
+ * @return Number of offsets the subset was created with.
+ */
+size_t gpiod_line_subset_get_num_lines(struct gpiod_line_subset *subset);
+
+/**
+ * @brief Get the request-relative bitmask of the lines in the subset.
+ * @param subset Line subset object.
+ * @return Bitmask suitable for ::gpiod_line_request_get_values_mask and
+ *         ::gpiod_line_request_set_values_mask.
+ */
+uint64_t gpiod_line_subset_get_mask(struct gpiod_line_subset *subset);
+
+/**
+ * @brief Read the values of all lines in the subset.
+ * @param subset Line subset object.
+ * @param values Array in which the values will be stored. Must hold the number
+ *               of entries returned by ::gpiod_line_subset_get_num_lines. Each
+ *               value is associated with the line identified by the
+ *               corresponding entry in the offsets array the subset was
+ *               created with.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_subset_get_values(struct gpiod_line_subset *subset,
+				 enum gpiod_line_value *values);
+
+/**
+ * @brief Set the values of all lines in the subset.
+ * @param subset Line subset object.
+ * @param values Array of values to set. Must hold the number of entries
+ *               returned by ::gpiod_line_subset_get_num_lines. Each value is
+ *               associated with the line identified by the corresponding entry
+ *               in the offsets array the subset was created with.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_subset_set_values(struct gpiod_line_subset *subset,
+				 const enum gpiod_line_value *values);
+
 /**
  * @brief Update the configuration of lines associated with a line request.
  * @param request GPIO line request.
@@ -1032,6 +2089,23 @@ int gpiod_line_request_set_values(struct gpiod_line_request *request,
 int gpiod_line_request_reconfigure_lines(struct gpiod_line_request *request,
 					 struct gpiod_line_config *config);
 
+/**
+ * @brief Update the configuration of a subset of lines associated with a line
+ *        request.
+ * @param request GPIO line request.
+ * @param config Line config containing only the lines to change.
+ * @return 0 on success, -1 on failure.
+ * @note The settings of every line present in the config replace its current
+ *       settings. All other requested lines keep their configuration and
+ *       outputs among them keep their current values.
+ * @note All lines in the config must have been requested. Otherwise the
+ *       function fails with errno set to EINVAL and no line is modified.
+ * @note The lines are reconfigured with a single call into the kernel.
+ */
+int gpiod_line_request_reconfigure_lines_partial(
+		struct gpiod_line_request *request,
+		struct gpiod_line_config *config);
+
 /**
  * @brief Get the file descriptor associated with a line request.
  * @param request GPIO line request.
@@ -1059,152 +2133,3999 @@ int gpiod_line_request_wait_edge_events(struct gpiod_line_request *request,
 					int64_t timeout_ns);
 
 /**
- * @brief Read a number of edge events from a line request.
+ * @brief Wait for edge events, aborting early if the wait is cancelled.
  * @param request GPIO line request.
- * @param buffer Edge event buffer, sized to hold at least \p max_events.
- * @param max_events Maximum number of events to read.
- * @return On success returns the number of events read from the file
- *         descriptor, on failure return -1.
- * @note This function will block if no event was queued for the line request.
- * @note Any exising events in the buffer are overwritten. This is not an
- *       append operation.
+ * @param timeout_ns Wait time limit in nanoseconds. Same semantics as for
+ *                   ::gpiod_line_request_wait_edge_events.
+ * @param cancel Cancellation object watched alongside the request.
+ * @return 0 if wait timed out, 1 if an event is pending, -1 if an error
+ *         occurred or if \p cancel was triggered in which case errno is set
+ *         to ECANCELED.
+ * @note The busy-poll budget of the request is not applied to cancellable
+ *       waits.
  */
-int gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
-					struct gpiod_edge_event_buffer *buffer,
-					size_t max_events);
+int gpiod_line_request_wait_edge_events_cancellable(
+		struct gpiod_line_request *request, int64_t timeout_ns,
+		struct gpiod_wait_cancel *cancel);
 
 /**
- * @}
- *
- * @defgroup edge_event Line edge events handling
- * @{
- *
- * Functions and data types for handling edge events.
- *
- * An edge event object contains information about a single line edge event.
- * It contains the event type, timestamp and the offset of the line on which
- * the event occurred as well as two sequence numbers (global for all lines
- * in the associated request and local for this line only).
- *
- * Edge events are stored into an edge-event buffer object to improve
- * performance and to limit the number of memory allocations when a large
- * number of events are being read.
+ * @brief Conditions on the values of several lines waited for.
  */
+enum gpiod_line_match {
+	GPIOD_LINE_MATCH_ALL = 1,
+	/**< All lines must have their expected values. */
+	GPIOD_LINE_MATCH_ANY,
+	/**< At least one line must have its expected value. */
+};
 
 /**
- * @brief Event types.
+ * @brief Wait until requested lines identified by a bitmask have the given
+ *        values.
+ * @param request GPIO line request.
+ * @param mask Bitmask of the lines to watch. Must not be 0.
+ * @param values Bitmask of the expected values of the lines in \p mask.
+ * @param match Whether all or any of the lines must have their values.
+ * @param timeout_ns Wait time limit in nanoseconds. Same semantics as for
+ *                   ::gpiod_line_request_wait_edge_events.
+ * @return 1 if the condition is met, 0 if the wait timed out, -1 if an error
+ *         occurred.
+ * @note The values are read first and the function returns immediately if
+ *       the condition holds. Otherwise it waits for edge events and reads
+ *       the values again after each batch. A change right after a read
+ *       queues an event and ends the wait, so no change is missed between
+ *       reading the values and waiting. Pulses shorter than the time
+ *       between two reads may go unnoticed.
+ * @note Each line must detect the edge leading to its expected value, that
+ *       is rising edges for active and falling edges for inactive. The
+ *       function fails with EINVAL otherwise.
+ * @note The edge events read while waiting are discarded. Lines not being
+ *       waited for should not be relied on for edge events in the meantime.
  */
-enum gpiod_edge_event_type {
-	GPIOD_EDGE_EVENT_RISING_EDGE = 1,
-	/**< Rising edge event. */
-	GPIOD_EDGE_EVENT_FALLING_EDGE,
-	/**< Falling edge event. */
-};
+int gpiod_line_request_wait_for_values_mask(struct gpiod_line_request *request,
+					    uint64_t mask, uint64_t values,
+					    enum gpiod_line_match match,
+					    int64_t timeout_ns);
 
 /**
- * @brief Free the edge event object.
- * @param event Edge event object to free.
+ * @brief Wait until a subset of requested lines have the given values.
+ * @param request GPIO line request.
+ * @param num_values Number of lines to watch.
+ * @param offsets Array of offsets identifying the lines. Must contain at
+ *                least \p num_values elements.
+ * @param values Array of expected values with indexes corresponding to those
+ *               in \p offsets.
+ * @param match Whether all or any of the lines must have their values.
+ * @param timeout_ns Wait time limit in nanoseconds. Same semantics as for
+ *                   ::gpiod_line_request_wait_edge_events.
+ * @return 1 if the condition is met, 0 if the wait timed out, -1 if an error
+ *         occurred.
+ * @note Same as ::gpiod_line_request_wait_for_values_mask.
  */
-void gpiod_edge_event_free(struct gpiod_edge_event *event);
+int gpiod_line_request_wait_for_values_subset(
+		struct gpiod_line_request *request, size_t num_values,
+		const unsigned int *offsets,
+		const enum gpiod_line_value *values,
+		enum gpiod_line_match match, int64_t timeout_ns);
 
 /**
- * @brief Copy the edge event object.
- * @param event Edge event to copy.
- * @return Copy of the edge event or NULL on error. The returned object must
- *         be freed by the caller using ::gpiod_edge_event_free.
+ * @brief Wait until a single requested line has the given value.
+ * @param request GPIO line request.
+ * @param offset Offset of the line.
+ * @param value Expected value of the line.
+ * @param timeout_ns Wait time limit in nanoseconds. Same semantics as for
+ *                   ::gpiod_line_request_wait_edge_events.
+ * @return 1 if the line has the value, 0 if the wait timed out, -1 if an
+ *         error occurred.
+ * @note Same as ::gpiod_line_request_wait_for_values_mask.
  */
-struct gpiod_edge_event *gpiod_edge_event_copy(struct gpiod_edge_event *event);
+int gpiod_line_request_wait_for_value(struct gpiod_line_request *request,
+				      unsigned int offset,
+				      enum gpiod_line_value value,
+				      int64_t timeout_ns);
 
 /**
- * @brief Get the event type.
- * @param event GPIO edge event.
- * @return The event type (::GPIOD_EDGE_EVENT_RISING_EDGE or
- *         ::GPIOD_EDGE_EVENT_FALLING_EDGE).
+ * @brief Make waiting for edge events spin before going to sleep.
+ * @param request GPIO line request.
+ * @param budget_ns Time in nanoseconds ::gpiod_line_request_wait_edge_events
+ *                  spends polling the request without blocking before it
+ *                  blocks for the rest of the timeout. 0 disables busy
+ *                  polling, which is the default.
+ * @note Spinning avoids the latency of waking up a sleeping thread when an
+ *       event arrives within the budget, at the cost of keeping a CPU busy
+ *       for up to the budget on every wait.
  */
-enum gpiod_edge_event_type
-gpiod_edge_event_get_event_type(struct gpiod_edge_event *event);
+void gpiod_line_request_set_busy_poll(struct gpiod_line_request *request,
+				      uint64_t budget_ns);
 
 /**
- * @brief Get the timestamp of the event.
- * @param event GPIO edge event.
- * @return Timestamp in nanoseconds.
- * @note The source clock for the timestamp depends on the event_clock
- *       setting for the line.
+ * @brief Get the busy-poll budget of the request.
+ * @param request GPIO line request.
+ * @return Busy-poll budget in nanoseconds, 0 if disabled.
  */
-uint64_t gpiod_edge_event_get_timestamp_ns(struct gpiod_edge_event *event);
+uint64_t gpiod_line_request_get_busy_poll(struct gpiod_line_request *request);
 
 /**
- * @brief Get the offset of the line which triggered the event.
- * @param event GPIO edge event.
- * @return Line offset.
+ * @brief Get the time waits for edge events spent spinning.
+ * @param request GPIO line request.
+ * @return Cumulative time in nanoseconds spent busy polling by
+ *         ::gpiod_line_request_wait_edge_events.
  */
-unsigned int gpiod_edge_event_get_line_offset(struct gpiod_edge_event *event);
+uint64_t
+gpiod_line_request_get_wait_spin_time_ns(struct gpiod_line_request *request);
 
 /**
- * @brief Get the global sequence number of the event.
- * @param event GPIO edge event.
- * @return Sequence number of the event in the series of events for all lines
- *         in the associated line request.
+ * @brief Get the time waits for edge events spent sleeping.
+ * @param request GPIO line request.
+ * @return Cumulative time in nanoseconds ::gpiod_line_request_wait_edge_events
+ *         spent blocked after the busy-poll budget ran out. Only accounted
+ *         while busy polling is enabled.
  */
-unsigned long gpiod_edge_event_get_global_seqno(struct gpiod_edge_event *event);
+uint64_t
+gpiod_line_request_get_wait_sleep_time_ns(struct gpiod_line_request *request);
 
 /**
- * @brief Get the event sequence number specific to the line.
- * @param event GPIO edge event.
- * @return Sequence number of the event in the series of events only for this
- *         line within the lifetime of the associated line request.
+ * @brief Filter out edge bursts shorter than a period in userspace.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @param period_us Debounce period in microseconds. 0 disables the filter,
+ *                  which is the default.
+ * @return 0 on success, -1 if the line is not part of the request.
+ * @note Meant for lines whose chip doesn't support
+ *       ::gpiod_line_settings_set_debounce_period_us. Edges closer to each
+ *       other than the period form a burst of which only the net change of the
+ *       line state is reported, with the timestamp of the last edge making
+ *       it. A glitch returning the line to its previous state is dropped
+ *       entirely unless it spans two reads, in which case both of its edges
+ *       are reported.
+ * @note The events are filtered in place in the buffer after they've been
+ *       read so ::gpiod_line_request_read_edge_events may return 0 if all
+ *       events were filtered out.
  */
-unsigned long gpiod_edge_event_get_line_seqno(struct gpiod_edge_event *event);
+int gpiod_line_request_set_soft_debounce_period_us(
+		struct gpiod_line_request *request, unsigned int offset,
+		unsigned long period_us);
 
 /**
- * @brief Create a new edge event buffer.
- * @param capacity Number of events the buffer can store (min = 1, max = 1024).
- * @return New edge event buffer or NULL on error.
- * @note If capacity equals 0, it will be set to a default value of 64. If
- *       capacity is larger than 1024, it will be limited to 1024.
- * @note The user space buffer is independent of the kernel buffer
- *       (::gpiod_request_config_set_event_buffer_size). As the user space
- *       buffer is filled from the kernel buffer, there is no benefit making
- *       the user space buffer larger than the kernel buffer.
- *       The default kernel buffer size for each request is (16 * num_lines).
+ * @brief Get the software debounce period of a line.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @return Debounce period in microseconds, 0 if the filter is disabled or -1
+ *         if the line is not part of the request.
  */
-struct gpiod_edge_event_buffer *
-gpiod_edge_event_buffer_new(size_t capacity);
+long gpiod_line_request_get_soft_debounce_period_us(
+		struct gpiod_line_request *request, unsigned int offset);
 
 /**
- * @brief Get the capacity (the max number of events that can be stored) of
- *        the event buffer.
- * @param buffer Edge event buffer.
+ * @brief Select the edge events of some lines that are passed to the user.
+ * @param request GPIO line request.
+ * @param offsets Array of offsets of the lines to set the filter for.
+ * @param num_offsets Number of offsets in the array. If 0, the filter is set
+ *                    for all lines of the request.
+ * @param edge Edges whose events are kept. ::GPIOD_LINE_EDGE_BOTH, the
+ *             default, disables filtering, ::GPIOD_LINE_EDGE_NONE discards
+ *             all events of the lines.
+ * @return 0 on success, -1 if any of the lines is not part of the request or
+ *         the edge is invalid.
+ * @note Unlike ::gpiod_line_request_reconfigure_lines this doesn't touch the
+ *       kernel: edge detection stays configured as requested and the filter
+ *       is applied to the events straight after they've been read. Discarded
+ *       events are still accounted for in the sequence number based drop
+ *       detection. Reads may return 0 if all events were discarded.
+ */
+int gpiod_line_request_set_edge_event_filter(struct gpiod_line_request *request,
+					     const unsigned int *offsets,
+					     size_t num_offsets,
+					     enum gpiod_line_edge edge);
+
+/**
+ * @brief Get the edge events of a line passed to the user.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @return Edges whose events are kept. If the line is not part of the
+ *         request, ::GPIOD_LINE_EDGE_NONE is returned and errno is set to
+ *         EINVAL.
+ */
+enum gpiod_line_edge
+gpiod_line_request_get_edge_event_filter(struct gpiod_line_request *request,
+					 unsigned int offset);
+
+/**
+ * @brief Events kept by the rate limiter once a line is over its budget.
+ */
+enum gpiod_rate_limit_policy {
+	GPIOD_RATE_LIMIT_KEEP_FIRST = 1,
+	/**< Discard the events past the budget until the window ends. */
+	GPIOD_RATE_LIMIT_KEEP_LAST,
+	/**< Each event past the budget replaces the last one kept. */
+};
+
+/**
+ * @brief Limit the number of edge events of a line passed to the user.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @param max_events Maximum number of events kept per window. 0 disables the
+ *                   limit, which is the default.
+ * @param window_us Length of the window in microseconds. Must not be 0 unless
+ *                  the limit is disabled.
+ * @param policy Which events are kept once the budget of a window is used up.
+ * @return 0 on success, -1 if the line is not part of the request or the
+ *         arguments are invalid.
+ * @note A window starts with the first event of the line past the end of the
+ *       previous one and is measured with the event timestamps. With
+ *       ::GPIOD_RATE_LIMIT_KEEP_LAST the latest edge of a line is never lost
+ *       but a read may return one event over the budget if the one it
+ *       replaces was returned by an earlier read.
+ * @note Discarded events are counted by
+ *       ::gpiod_line_request_get_num_rate_limited_events and in the dropped
+ *       event counters of the request. Like the edge event filter, the limit
+ *       is applied after the events have been read so it caps the work done
+ *       by the user but not the space a line takes in the kernel buffer.
+ */
+int gpiod_line_request_set_rate_limit(struct gpiod_line_request *request,
+				      unsigned int offset,
+				      unsigned int max_events,
+				      unsigned long window_us,
+				      enum gpiod_rate_limit_policy policy);
+
+/**
+ * @brief Get the rate limit of a line.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @param max_events Set to the maximum number of events per window, 0 if the
+ *                   limit is disabled. May be NULL.
+ * @param window_us Set to the length of the window in microseconds. May be
+ *                  NULL.
+ * @param policy Set to the policy of the limit. May be NULL.
+ * @return 0 on success, -1 if the line is not part of the request.
+ */
+int gpiod_line_request_get_rate_limit(struct gpiod_line_request *request,
+				      unsigned int offset,
+				      unsigned int *max_events,
+				      unsigned long *window_us,
+				      enum gpiod_rate_limit_policy *policy);
+
+/**
+ * @brief Get the number of edge events of a line discarded by its rate limit.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @return Cumulative number of discarded events or -1 if the line is not part
+ *         of the request.
+ */
+long gpiod_line_request_get_num_rate_limited_events(
+		struct gpiod_line_request *request, unsigned int offset);
+
+/**
+ * @brief Read a number of edge events from a line request.
+ * @param request GPIO line request.
+ * @param buffer Edge event buffer, sized to hold at least \p max_events.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events read from the file
+ *         descriptor, on failure return -1.
+ * @note This function will block if no event was queued for the line request,
+ *       unless the request is non-blocking
+ *       (see ::gpiod_request_config_set_nonblocking) in which case it returns
+ *       0.
+ * @note Any exising events in the buffer are overwritten. This is not an
+ *       append operation.
+ */
+int gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
+					struct gpiod_edge_event_buffer *buffer,
+					size_t max_events);
+
+/**
+ * @brief Read all edge events queued on a line request.
+ * @param request GPIO line request.
+ * @param buffer Edge event buffer. It grows as needed to hold all the events,
+ *               beyond the capacity it was created with.
+ * @param max_events Maximum number of events to read. If 0, the number of
+ *                   events is only limited by the available memory.
+ * @param max_time_ns Time limit for draining in nanoseconds. If 0 or negative,
+ *                    events are read until none are left.
+ * @return Number of events read, which may be 0, or -1 on error.
+ * @note Unlike ::gpiod_line_request_read_edge_events, this function never
+ *       blocks. Reading continues until the kernel buffer is empty so a
+ *       burst of events that arrives while draining is collected in a single
+ *       call. The time limit is checked between reads and may be overrun by
+ *       the duration of one read.
+ * @note The file descriptor of the request is switched to non-blocking mode.
+ *       ::gpiod_line_request_read_edge_events still blocks if no events are
+ *       queued unless the request was made non-blocking.
+ * @note Any existing events in the buffer are overwritten.
+ */
+int gpiod_line_request_drain_edge_events(struct gpiod_line_request *request,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events, int64_t max_time_ns);
+
+/**
+ * @brief Get the I/O statistics of the line request.
+ * @param request GPIO line request.
+ * @return Snapshot of the statistics of the calls made on the request or NULL
+ *         on error. The returned object must be freed by the caller using
+ *         ::gpiod_stats_free.
+ * @note Events read from the request by event loops, event mergers and large
+ *       requests are counted too.
+ */
+struct gpiod_stats *
+gpiod_line_request_get_stats(struct gpiod_line_request *request);
+
+/**
+ * @brief Zero the I/O statistics of the line request.
+ * @param request GPIO line request.
+ */
+void gpiod_line_request_reset_stats(struct gpiod_line_request *request);
+
+/**
+ * @brief Get the edge event latency histogram of a requested line.
+ * @param request GPIO line request.
+ * @param offset Offset of the line.
+ * @return Snapshot of the histogram or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_latency_histogram_free.
+ * @note Fails with ENOTSUP unless the request was made with latency
+ *       histograms enabled in its request config.
+ */
+struct gpiod_latency_histogram *
+gpiod_line_request_get_latency_histogram(struct gpiod_line_request *request,
+					 unsigned int offset);
+
+/**
+ * @brief Clear the edge event latency histograms of all requested lines.
+ * @param request GPIO line request.
+ */
+void
+gpiod_line_request_reset_latency_histograms(struct gpiod_line_request *request);
+
+/**
+ * @brief Get the edge statistics of a requested line.
+ * @param request GPIO line request.
+ * @param offset Offset of the line.
+ * @return Snapshot of the statistics or NULL on error. The returned object
+ *         must be freed by the caller using ::gpiod_edge_stats_free.
+ * @note Fails with ENOTSUP unless the request was made with edge statistics
+ *       enabled in its request config.
+ */
+struct gpiod_edge_stats *
+gpiod_line_request_get_edge_stats(struct gpiod_line_request *request,
+				  unsigned int offset);
+
+/**
+ * @brief Clear the edge statistics of all requested lines.
+ * @param request GPIO line request.
+ */
+void gpiod_line_request_reset_edge_stats(struct gpiod_line_request *request);
+
+/**
+ * @brief Get the number of edge events the kernel dropped on a line request.
+ * @param request GPIO line request.
+ * @return Cumulative number of events missing from the ones read so far.
+ * @note The kernel drops events when the request's event buffer overflows.
+ *       Drops are detected from gaps in the global sequence numbers of the
+ *       events read, so events lost after the last one read are only counted
+ *       once a later event arrives. A steadily growing count means the event
+ *       buffer size (see ::gpiod_request_config_set_event_buffer_size) is too
+ *       small for the rate at which the events are consumed.
+ * @note Also counts the events discarded by rate limits, see
+ *       ::gpiod_line_request_set_rate_limit.
+ */
+unsigned long
+gpiod_line_request_get_num_dropped_events(struct gpiod_line_request *request);
+
+/**
+ * @brief Get the size of the kernel event buffer of the request.
+ * @param request GPIO line request.
+ * @return Number of events the kernel buffers for the request, after the
+ *         kernel's adjustments. Reflects the size picked by adaptive sizing
+ *         (see ::gpiod_request_config_set_max_event_buffer_size).
+ */
+size_t
+gpiod_line_request_get_event_buffer_size(struct gpiod_line_request *request);
+
+/**
+ * @brief Get the number of edge events the kernel dropped for a single line.
+ * @param request GPIO line request.
+ * @param offset The offset of the line.
+ * @return Cumulative number of events of this line missing from the ones read
+ *         so far or -1 if the line is not part of the request.
+ * @note Same as ::gpiod_line_request_get_num_dropped_events but detected from
+ *       the per-line sequence numbers. Includes the events discarded by the
+ *       rate limit of the line.
+ */
+long gpiod_line_request_get_num_dropped_line_events(
+		struct gpiod_line_request *request, unsigned int offset);
+
+/**
+ * @}
+ *
+ * @defgroup line_transaction Transactional output updates
+ * @{
+ *
+ * Transactions stage changes of output values in memory and write them to a
+ * line request in phases.
+ *
+ * Values staged within a phase are written all at once and the last value
+ * staged for a line wins. Phases are committed in the order they were started
+ * with one call into the kernel each. Empty phases and phases not changing
+ * the values of any line known to the request are skipped. This allows to
+ * express sequences like "assert the enables, then the data, then the strobe"
+ * with the minimal number of system calls.
+ *
+ * The transaction must not outlive the request it was started on.
+ */
+
+/**
+ * @brief Start a new transaction on a line request.
+ * @param request Line request object.
+ * @return New transaction object with a single, empty phase or NULL on error.
+ *         The returned object must be freed by the caller using
+ *         ::gpiod_line_transaction_free.
+ */
+struct gpiod_line_transaction *
+gpiod_line_request_begin_transaction(struct gpiod_line_request *request);
+
+/**
+ * @brief Free the transaction, discarding the changes not committed.
+ * @param tx Transaction object.
+ */
+void gpiod_line_transaction_free(struct gpiod_line_transaction *tx);
+
+/**
+ * @brief Stage the value of a single line in the current phase.
+ * @param tx Transaction object.
+ * @param offset The offset of the line to set.
+ * @param value Value to set.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_transaction_set_value(struct gpiod_line_transaction *tx,
+				     unsigned int offset,
+				     enum gpiod_line_value value);
+
+/**
+ * @brief Stage the values of a subset of lines in the current phase.
+ * @param tx Transaction object.
+ * @param num_values Number of lines to set.
+ * @param offsets Array of offsets of the lines to set.
+ * @param values Array of values to set, with indexes corresponding to those
+ *		 of the offsets.
+ * @return 0 on success, -1 on failure. Nothing is staged if any of the
+ *	   offsets is invalid.
+ */
+int gpiod_line_transaction_set_values_subset(struct gpiod_line_transaction *tx,
+					     size_t num_values,
+					     const unsigned int *offsets,
+					     const enum gpiod_line_value *values);
+
+/**
+ * @brief Stage the values of lines selected by a bitmask in the current
+ *	  phase.
+ * @param tx Transaction object.
+ * @param mask Bitmask of lines to set. Bit N corresponds to the line at index
+ *	       N in the array filled by
+ *	       ::gpiod_line_request_get_requested_offsets.
+ * @param values Bitmask of values to set. Bits not set in mask are ignored.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_transaction_set_values_mask(struct gpiod_line_transaction *tx,
+					   uint64_t mask, uint64_t values);
+
+/**
+ * @brief Stage the lines selected by a bitmask as active in the current phase.
+ * @param tx Transaction object.
+ * @param mask Bitmask of lines to set.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_transaction_set_bits(struct gpiod_line_transaction *tx,
+				    uint64_t mask);
+
+/**
+ * @brief Stage the lines selected by a bitmask as inactive in the current
+ *	  phase.
+ * @param tx Transaction object.
+ * @param mask Bitmask of lines to clear.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_line_transaction_clear_bits(struct gpiod_line_transaction *tx,
+				      uint64_t mask);
+
+/**
+ * @brief Start a new phase, committed after all the previous ones.
+ * @param tx Transaction object.
+ * @return 0 on success, -1 on failure.
+ * @note Does nothing if the current phase is empty.
+ */
+int gpiod_line_transaction_next_phase(struct gpiod_line_transaction *tx);
+
+/**
+ * @brief Get the number of phases with staged values.
+ * @param tx Transaction object.
+ * @return Number of non-empty phases.
+ */
+size_t gpiod_line_transaction_get_num_phases(struct gpiod_line_transaction *tx);
+
+/**
+ * @brief Drop all staged values.
+ * @param tx Transaction object.
+ */
+void gpiod_line_transaction_discard(struct gpiod_line_transaction *tx);
+
+/**
+ * @brief Write all staged phases to the line request, in order.
+ * @param tx Transaction object.
+ * @return 0 on success, -1 on failure.
+ * @note On success the transaction is emptied and can be reused. On failure
+ *	 the phases written so far are dropped while the failed phase and
+ *	 the ones following it stay staged so the commit can be retried.
+ */
+int gpiod_line_transaction_commit(struct gpiod_line_transaction *tx);
+
+/**
+ * @}
+ *
+ * @defgroup large_request Large line requests
+ * @{
+ *
+ * Requests spanning more lines than a single kernel request can hold.
+ *
+ * The kernel limits the number of lines in a request to 64. A large request
+ * transparently splits its lines into shards of up to 64 lines, each backed
+ * by a regular line request, and exposes them as a single object. Operations
+ * on values issue one call into the kernel per shard holding any of the
+ * affected lines. Operations spanning several shards are not atomic: when
+ * one of them fails, the shards already processed are not rolled back.
+ *
+ * Edge events of all shards are available from a single file descriptor and
+ * are merged into one stream ordered by timestamp. For the order to be
+ * meaningful, all lines must use the same event clock. The global sequence
+ * numbers of the events are replaced by numbers counting all events read
+ * from the large request.
+ */
+
+/**
+ * @brief Request a set of lines for exclusive usage, splitting it across as
+ *        many kernel requests as needed.
+ * @param chip GPIO chip object.
+ * @param req_cfg Request config object. Can be NULL for default settings.
+ *                Applies to every shard, including the size of the kernel
+ *                event buffer.
+ * @param offsets Array of offsets of the lines to request.
+ * @param num_offsets Number of offsets in \p offsets.
+ * @param settings Array of \p num_offsets line settings objects, one for
+ *                 each offset. Can be NULL to use default settings for all
+ *                 lines. A NULL entry selects default settings for the
+ *                 corresponding line.
+ * @return New large request object or NULL if an error occurred. The request
+ *         must be released by the caller using ::gpiod_large_request_release.
+ * @note Lines are assigned to shards in the order of \p offsets: the first 64
+ *       lines make up the first shard and so on. Lines can be added and
+ *       removed later without releasing the request.
+ */
+struct gpiod_large_request *
+gpiod_chip_request_large(struct gpiod_chip *chip,
+			 struct gpiod_request_config *req_cfg,
+			 const unsigned int *offsets, size_t num_offsets,
+			 struct gpiod_line_settings **settings);
+
+/**
+ * @brief Release all requested lines and free all associated resources.
+ * @param request Large request object to release.
+ */
+void gpiod_large_request_release(struct gpiod_large_request *request);
+
+/**
+ * @brief Get the number of lines in the request.
+ * @param request Large request object.
+ * @return Number of requested lines.
+ */
+size_t
+gpiod_large_request_get_num_requested_lines(struct gpiod_large_request *request);
+
+/**
+ * @brief Get the offsets of the lines in the request.
+ * @param request Large request object.
+ * @param offsets Array to store offsets.
+ * @param max_offsets Number of offsets that can be stored in the offsets array.
+ * @return Number of offsets stored in the offsets array.
+ */
+size_t
+gpiod_large_request_get_requested_offsets(struct gpiod_large_request *request,
+					  unsigned int *offsets,
+					  size_t max_offsets);
+
+/**
+ * @brief Get the number of kernel requests backing the large request.
+ * @param request Large request object.
+ * @return Number of shards.
+ */
+size_t
+gpiod_large_request_get_num_shards(struct gpiod_large_request *request);
+
+/**
+ * @brief Add lines to a live large request.
+ * @param request Large request object.
+ * @param chip GPIO chip object the request was made on.
+ * @param req_cfg Request config object for the new lines. Can be NULL for
+ *                default settings.
+ * @param offsets Array of offsets of the lines to add.
+ * @param num_offsets Number of offsets in \p offsets.
+ * @param settings Array of \p num_offsets line settings objects like for
+ *                 ::gpiod_chip_request_large. Can be NULL.
+ * @return 0 on success, -1 on failure.
+ *
+ * The new lines are requested in shards of their own and appended to the
+ * offsets of the request. The lines already in the request stay in their
+ * kernel requests: their outputs keep being driven and none of their edge
+ * events are lost. Adding a line that is already part of the request fails
+ * with errno set to EINVAL. On failure the request is left unchanged.
+ */
+int gpiod_large_request_add_lines(struct gpiod_large_request *request,
+				  struct gpiod_chip *chip,
+				  struct gpiod_request_config *req_cfg,
+				  const unsigned int *offsets,
+				  size_t num_offsets,
+				  struct gpiod_line_settings **settings);
+
+/**
+ * @brief Remove lines from a live large request.
+ * @param request Large request object.
+ * @param chip GPIO chip object the request was made on.
+ * @param offsets Array of offsets of the lines to remove.
+ * @param num_offsets Number of offsets in \p offsets.
+ * @return 0 on success, -1 on failure.
+ *
+ * Shards left without lines are released, the others keep running. The
+ * kernel can't release some of the lines of a request so the lines sharing
+ * a shard with removed lines are requested anew: their outputs are
+ * requested with the values they have at that point and the edge events
+ * still queued for them are carried over. Lines added together with
+ * ::gpiod_large_request_add_lines share shards only with each other so
+ * removing them again touches no other lines.
+ *
+ * At least one line must stay in the request. The remaining lines keep
+ * their order. Like operations on values, removing lines from several
+ * shards is not atomic: on failure the shards processed so far stay as
+ * they are and a shard whose lines couldn't be requested back is dropped
+ * from the request.
+ */
+int gpiod_large_request_remove_lines(struct gpiod_large_request *request,
+				     struct gpiod_chip *chip,
+				     const unsigned int *offsets,
+				     size_t num_offsets);
+
+/**
+ * @brief Get the value of a single requested line.
+ * @param request Large request object.
+ * @param offset The offset of the line of which the value should be read.
+ * @return Returns 1 or 0 on success and -1 on error.
+ */
+enum gpiod_line_value
+gpiod_large_request_get_value(struct gpiod_large_request *request,
+			      unsigned int offset);
+
+/**
+ * @brief Get the values of a subset of requested lines.
+ * @param request Large request object.
+ * @param num_values Number of lines for which to read values.
+ * @param offsets Array of offsets identifying the subset of requested lines
+ *                from which to read values.
+ * @param values Array in which the values will be stored. Must be sized
+ *               to hold \p num_values entries.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_large_request_get_values_subset(struct gpiod_large_request *request,
+					  size_t num_values,
+					  const unsigned int *offsets,
+					  enum gpiod_line_value *values);
+
+/**
+ * @brief Get the values of all requested lines.
+ * @param request Large request object.
+ * @param values Array in which the values will be stored. Must be sized to
+ *               hold the number of lines filled by
+ *               ::gpiod_large_request_get_num_requested_lines. Each value
+ *               is associated with the line identified by the corresponding
+ *               entry in the offset array filled by
+ *               ::gpiod_large_request_get_requested_offsets.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_large_request_get_values(struct gpiod_large_request *request,
+				   enum gpiod_line_value *values);
+
+/**
+ * @brief Set the value of a single requested line.
+ * @param request Large request object.
+ * @param offset The offset of the line for which the value should be set.
+ * @param value Value to set.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_large_request_set_value(struct gpiod_large_request *request,
+				  unsigned int offset,
+				  enum gpiod_line_value value);
+
+/**
+ * @brief Set the values of a subset of requested lines.
+ * @param request Large request object.
+ * @param num_values Number of lines for which to set values.
+ * @param offsets Array of offsets, containing the number of entries specified
+ *                by \p num_values, identifying the requested lines for
+ *                which to set values.
+ * @param values Array of values to set, containing the number of entries
+ *               specified by \p num_values.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_large_request_set_values_subset(struct gpiod_large_request *request,
+					  size_t num_values,
+					  const unsigned int *offsets,
+					  const enum gpiod_line_value *values);
+
+/**
+ * @brief Set the values of all requested lines.
+ * @param request Large request object.
+ * @param values Array containing the values to set. Must be sized to contain
+ *               the number of lines filled by
+ *               ::gpiod_large_request_get_num_requested_lines.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_large_request_set_values(struct gpiod_large_request *request,
+				   const enum gpiod_line_value *values);
+
+/**
+ * @brief Get the file descriptor signalling edge events on any of the
+ *        requested lines.
+ * @param request Large request object.
+ * @return File descriptor which becomes readable when edge events can be
+ *         read using ::gpiod_large_request_read_edge_events. It can be used
+ *         with poll() and similar system calls but must not be read
+ *         directly or closed by the caller.
+ */
+int gpiod_large_request_get_fd(struct gpiod_large_request *request);
+
+/**
+ * @brief Wait for edge events on any of the requested lines.
+ * @param request Large request object.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until an event becomes
+ *                   available.
+ * @return 0 if wait timed out, -1 if an error occurred, 1 if an event is
+ *         pending.
+ */
+int gpiod_large_request_wait_edge_events(struct gpiod_large_request *request,
+					 int64_t timeout_ns);
+
+/**
+ * @brief Read a number of edge events from a large request.
+ * @param request Large request object.
+ * @param buffer Edge event buffer, sized to hold at least \p max_events.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events read, on failure returns -1.
+ * @note This function will block if no event was queued for any of the
+ *       requested lines.
+ * @note Events pending on all shards are merged in timestamp order. Events
+ *       which don't fit into the buffer are kept by the request and returned
+ *       by the next call.
+ */
+int gpiod_large_request_read_edge_events(struct gpiod_large_request *request,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events);
+
+/**
+ * @}
+ *
+ * @defgroup multi_request Multi-chip requests
+ * @{
+ *
+ * Aggregates of line requests made on different chips, driven as a single
+ * logical group of lines.
+ *
+ * The lines of all member requests are numbered consecutively in the order the
+ * requests were added and, within each request, in the order of the offsets
+ * filled by ::gpiod_line_request_get_requested_offsets. Lines are looked up by
+ * their member and offset or by name.
+ *
+ * Operations on values issue one call into the kernel per member request
+ * holding any of the affected lines. By default the calls are made one after
+ * another from the calling thread. With workers started, each member gets a
+ * helper thread, optionally pinned to a CPU, and all helpers are released at
+ * once so that the calls on different chips overlap. The time between the
+ * first and the last call of an operation is reported as its skew.
+ *
+ * The multi-request doesn't take ownership of the member requests. They must
+ * stay alive for as long as the multi-request exists and must not be used
+ * concurrently with the operations of the multi-request.
+ */
+
+/**
+ * @brief Create a new, empty multi-chip request.
+ * @return New multi-chip request object or NULL on error. The returned object
+ *         must be freed by the caller using ::gpiod_multi_request_free.
+ */
+struct gpiod_multi_request *gpiod_multi_request_new(void);
+
+/**
+ * @brief Free the multi-chip request, stopping its workers first.
+ * @param mreq Multi-chip request object.
+ * @note The member line requests are not released.
+ */
+void gpiod_multi_request_free(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Add a line request to the multi-chip request.
+ * @param mreq Multi-chip request object.
+ * @param chip Chip the request was made on. Used to read the names of the
+ *             lines for ::gpiod_multi_request_find_line_by_name. Can be NULL
+ *             if lines are never looked up by name.
+ * @param request Line request to add.
+ * @return Index of the new member on success, -1 on failure. Fails with
+ *         EBUSY if the workers are running.
+ */
+int gpiod_multi_request_add_request(struct gpiod_multi_request *mreq,
+				    struct gpiod_chip *chip,
+				    struct gpiod_line_request *request);
+
+/**
+ * @brief Get the number of member requests.
+ * @param mreq Multi-chip request object.
+ * @return Number of line requests added to the multi-chip request.
+ */
+size_t gpiod_multi_request_get_num_members(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Get a member request.
+ * @param mreq Multi-chip request object.
+ * @param member Index of the member.
+ * @return Line request or NULL if the index is out of range.
+ */
+struct gpiod_line_request *
+gpiod_multi_request_get_member(struct gpiod_multi_request *mreq,
+			       unsigned int member);
+
+/**
+ * @brief Get the number of lines of all member requests.
+ * @param mreq Multi-chip request object.
+ * @return Number of lines.
+ */
+size_t gpiod_multi_request_get_num_lines(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Find a line by its member request and offset.
+ * @param mreq Multi-chip request object.
+ * @param member Index of the member request.
+ * @param offset Offset of the line on the chip of the member.
+ * @return Index of the line within the multi-chip request or -1 if it's not
+ *         part of it.
+ */
+int gpiod_multi_request_find_line(struct gpiod_multi_request *mreq,
+				  unsigned int member, unsigned int offset);
+
+/**
+ * @brief Find a line by its name.
+ * @param mreq Multi-chip request object.
+ * @param name Name of the line.
+ * @return Index of the first line with this name within the multi-chip
+ *         request or -1 if there's none. Fails with ENOENT if no line has
+ *         this name.
+ */
+int gpiod_multi_request_find_line_by_name(struct gpiod_multi_request *mreq,
+					  const char *name);
+
+/**
+ * @brief Get the values of a subset of lines.
+ * @param mreq Multi-chip request object.
+ * @param num_lines Number of lines for which to read values.
+ * @param lines Array of indexes of the lines within the multi-chip request.
+ * @param values Array in which the values will be stored. Must be sized to
+ *               hold \p num_lines entries.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_multi_request_get_values_subset(struct gpiod_multi_request *mreq,
+					  size_t num_lines,
+					  const unsigned int *lines,
+					  enum gpiod_line_value *values);
+
+/**
+ * @brief Get the values of all lines.
+ * @param mreq Multi-chip request object.
+ * @param values Array in which the values will be stored. Must be sized to
+ *               hold the number of lines returned by
+ *               ::gpiod_multi_request_get_num_lines.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_multi_request_get_values(struct gpiod_multi_request *mreq,
+				   enum gpiod_line_value *values);
+
+/**
+ * @brief Set the values of a subset of lines.
+ * @param mreq Multi-chip request object.
+ * @param num_lines Number of lines for which to set values.
+ * @param lines Array of indexes of the lines within the multi-chip request.
+ * @param values Array of \p num_lines values to set.
+ * @return 0 on success, -1 on failure. If the calls on some of the members
+ *         failed, the others are not rolled back and the error of the first
+ *         failed member is reported.
+ */
+int gpiod_multi_request_set_values_subset(struct gpiod_multi_request *mreq,
+					  size_t num_lines,
+					  const unsigned int *lines,
+					  const enum gpiod_line_value *values);
+
+/**
+ * @brief Set the values of all lines.
+ * @param mreq Multi-chip request object.
+ * @param values Array containing the values to set. Must be sized to contain
+ *               the number of lines returned by
+ *               ::gpiod_multi_request_get_num_lines.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_multi_request_set_values(struct gpiod_multi_request *mreq,
+				   const enum gpiod_line_value *values);
+
+/**
+ * @brief Start one helper thread per member request.
+ * @param mreq Multi-chip request object.
+ * @param cpus Array with one CPU number per member the helper of which is
+ *             pinned to it. A negative entry leaves the corresponding helper
+ *             unpinned. Can be NULL to leave all helpers unpinned.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the workers are
+ *         already running.
+ */
+int gpiod_multi_request_start_workers(struct gpiod_multi_request *mreq,
+				      const int *cpus);
+
+/**
+ * @brief Stop the helper threads.
+ * @param mreq Multi-chip request object.
+ * @return 0 on success, -1 if the workers are not running.
+ */
+int gpiod_multi_request_stop_workers(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Check if the helper threads are running.
+ * @param mreq Multi-chip request object.
+ * @return True if the workers are running, false otherwise.
+ */
+bool gpiod_multi_request_workers_running(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Get the skew of the last operation on values.
+ * @param mreq Multi-chip request object.
+ * @return Time in nanoseconds between the first and the last call into the
+ *         kernel made by the last operation, as measured on the monotonic
+ *         clock right before each call. 0 if it used a single member.
+ */
+uint64_t gpiod_multi_request_get_last_skew_ns(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Values of the lines of a member request captured by a snapshot.
+ *
+ * Samples are stored contiguously, one per member in the order the members
+ * were added, and can be copied out of the snapshot as a whole.
+ */
+struct gpiod_multi_request_sample {
+	uint64_t before_ns;
+	/**< Time on the monotonic clock right before the call into the kernel. */
+	uint64_t after_ns;
+	/**< Time on the monotonic clock right after the call returned. */
+	uint64_t mask;
+	/**< Bitmap of the lines of the member, in the order of the offsets filled
+	 *   by ::gpiod_line_request_get_requested_offsets. */
+	uint64_t values;
+	/**< Bitmap of the values of the lines, a set bit meaning active. Only
+	 *   valid if error is 0. */
+	int32_t error;
+	/**< 0 if the values were read, errno of the failed call otherwise. */
+	uint32_t reserved;
+	/**< Reserved for future use. */
+};
+
+/**
+ * @brief Create a snapshot object sized for the members of a multi-request.
+ * @param mreq Multi-chip request object.
+ * @return New snapshot object or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_multi_request_snapshot_free.
+ *
+ * The object holds no samples until passed to
+ * ::gpiod_multi_request_take_snapshot and can be reused for any number of
+ * snapshots, none of which allocate memory.
+ */
+struct gpiod_multi_request_snapshot *
+gpiod_multi_request_snapshot_new(struct gpiod_multi_request *mreq);
+
+/**
+ * @brief Free the snapshot object.
+ * @param snapshot Snapshot object to free.
+ */
+void
+gpiod_multi_request_snapshot_free(struct gpiod_multi_request_snapshot *snapshot);
+
+/**
+ * @brief Read the values of all lines of all members into a snapshot.
+ * @param mreq Multi-chip request object.
+ * @param snapshot Snapshot object to fill.
+ * @return 0 on success, -1 on failure. Fails with E2BIG if members were added
+ *         after the snapshot object was created. If the calls on some of the
+ *         members failed, the snapshot still holds the samples of all of them
+ *         and the error of the first failed member is reported.
+ *
+ * Like the other operations on values, the calls on different members are
+ * made in parallel if the workers are running. Each member is timestamped on
+ * the monotonic clock right before and after its call so that the window in
+ * which all values were read is known.
+ */
+int gpiod_multi_request_take_snapshot(
+		struct gpiod_multi_request *mreq,
+		struct gpiod_multi_request_snapshot *snapshot);
+
+/**
+ * @brief Get the number of samples in a snapshot.
+ * @param snapshot Snapshot object.
+ * @return Number of members read by the last snapshot, 0 if none was taken.
+ */
+size_t gpiod_multi_request_snapshot_get_num_samples(
+		struct gpiod_multi_request_snapshot *snapshot);
+
+/**
+ * @brief Get the samples of a snapshot.
+ * @param snapshot Snapshot object.
+ * @return Pointer to the array of samples, one per member. Valid until the
+ *         next snapshot is taken or the object is freed.
+ */
+const struct gpiod_multi_request_sample *
+gpiod_multi_request_snapshot_get_samples(
+		struct gpiod_multi_request_snapshot *snapshot);
+
+/**
+ * @brief Get the single timestamp of a snapshot.
+ * @param snapshot Snapshot object.
+ * @return Middle of the window of the snapshot on the monotonic clock, in
+ *         nanoseconds. Every sample was read within half the window of it.
+ */
+uint64_t gpiod_multi_request_snapshot_get_timestamp_ns(
+		struct gpiod_multi_request_snapshot *snapshot);
+
+/**
+ * @brief Get the window of a snapshot.
+ * @param snapshot Snapshot object.
+ * @return Time in nanoseconds between the earliest before_ns and the latest
+ *         after_ns of the samples. Bounds the skew between the values of any
+ *         two lines of the snapshot.
+ */
+uint64_t gpiod_multi_request_snapshot_get_window_ns(
+		struct gpiod_multi_request_snapshot *snapshot);
+
+/**
+ * @}
+ *
+ * @defgroup write_combiner Write combining
+ * @{
+ *
+ * Front end merging the writes of many threads sharing a line request into
+ * fewer calls into the kernel.
+ *
+ * The first writer to arrive opens a batch and waits until the batch gets
+ * old or big enough. Writers arriving meanwhile merge their lines into the
+ * batch, the last write of a line wins. The first writer then sets all lines
+ * of the batch with a single call and every writer of the batch is woken up
+ * with its result. A call setting values returns only once its write has
+ * reached the kernel or failed.
+ *
+ * Batches are written one at a time in the order they were opened. While a
+ * batch is being written, the next one keeps collecting writes even after its
+ * deadline passed.
+ *
+ * The line request must outlive the write combiner. Writes going to the
+ * request directly bypass the combiner and may overtake pending batches.
+ */
+
+/**
+ * @brief Create a new write combiner.
+ * @param request Line request to write to.
+ * @param max_delay_us Maximum time in microseconds the first write of a batch
+ *                     waits for others to join. 0 flushes batches right away,
+ *                     only merging writes arriving while the previous batch
+ *                     is being written.
+ * @param max_batch Number of writes after which a batch is flushed before its
+ *                  deadline. 0 for no limit.
+ * @return New write combiner object or NULL on error. The returned object
+ *         must be freed by the caller using ::gpiod_write_combiner_free.
+ */
+struct gpiod_write_combiner *
+gpiod_write_combiner_new(struct gpiod_line_request *request,
+			 unsigned long max_delay_us, size_t max_batch);
+
+/**
+ * @brief Free the write combiner.
+ * @param wc Write combiner object.
+ * @note No writes must be pending when the combiner is freed. The line
+ *       request is not released.
+ */
+void gpiod_write_combiner_free(struct gpiod_write_combiner *wc);
+
+/**
+ * @brief Set the value of a single line through the write combiner.
+ * @param wc Write combiner object.
+ * @param offset The offset of the line to set.
+ * @param value Value to set.
+ * @return 0 on success, -1 on failure. Fails with the error of the call into
+ *         the kernel which wrote the batch the value was merged into.
+ */
+int gpiod_write_combiner_set_value(struct gpiod_write_combiner *wc,
+				   unsigned int offset,
+				   enum gpiod_line_value value);
+
+/**
+ * @brief Set the values of lines selected by a bitmask through the write
+ *	  combiner.
+ * @param wc Write combiner object.
+ * @param mask Bitmask of lines to set. Bit N corresponds to the line at index
+ *	       N in the array filled by
+ *	       ::gpiod_line_request_get_requested_offsets.
+ * @param values Bitmask of values to set. Bits not set in mask are ignored.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_write_combiner_set_values_mask(struct gpiod_write_combiner *wc,
+					 uint64_t mask, uint64_t values);
+
+/**
+ * @brief Get the number of writes passed to the write combiner.
+ * @param wc Write combiner object.
+ * @return Number of calls setting values.
+ */
+uint64_t gpiod_write_combiner_get_num_writes(struct gpiod_write_combiner *wc);
+
+/**
+ * @brief Get the number of batches the write combiner wrote to the kernel.
+ * @param wc Write combiner object.
+ * @return Number of flushes.
+ */
+uint64_t gpiod_write_combiner_get_num_flushes(struct gpiod_write_combiner *wc);
+
+/**
+ * @}
+ *
+ * @defgroup edge_event Line edge events handling
+ * @{
+ *
+ * Functions and data types for handling edge events.
+ *
+ * An edge event object contains information about a single line edge event.
+ * It contains the event type, timestamp and the offset of the line on which
+ * the event occurred as well as two sequence numbers (global for all lines
+ * in the associated request and local for this line only).
+ *
+ * Edge events are stored into an edge-event buffer object to improve
+ * performance and to limit the number of memory allocations when a large
+ * number of events are being read.
+ */
+
+/**
+ * @brief Event types.
+ */
+enum gpiod_edge_event_type {
+	GPIOD_EDGE_EVENT_RISING_EDGE = 1,
+	/**< Rising edge event. */
+	GPIOD_EDGE_EVENT_FALLING_EDGE,
+	/**< Falling edge event. */
+};
+
+/**
+ * @brief Free the edge event object.
+ * @param event Edge event object to free.
+ */
+void gpiod_edge_event_free(struct gpiod_edge_event *event);
+
+/**
+ * @brief Copy the edge event object.
+ * @param event Edge event to copy.
+ * @return Copy of the edge event or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_edge_event_free.
+ */
+struct gpiod_edge_event *gpiod_edge_event_copy(struct gpiod_edge_event *event);
+
+/**
+ * @brief Get the event type.
+ * @param event GPIO edge event.
+ * @return The event type (::GPIOD_EDGE_EVENT_RISING_EDGE or
+ *         ::GPIOD_EDGE_EVENT_FALLING_EDGE).
+ */
+enum gpiod_edge_event_type
+gpiod_edge_event_get_event_type(struct gpiod_edge_event *event);
+
+/**
+ * @brief Get the timestamp of the event.
+ * @param event GPIO edge event.
+ * @return Timestamp in nanoseconds.
+ * @note The source clock for the timestamp depends on the event_clock
+ *       setting for the line.
+ */
+uint64_t gpiod_edge_event_get_timestamp_ns(struct gpiod_edge_event *event);
+
+/**
+ * @brief Get the offset of the line which triggered the event.
+ * @param event GPIO edge event.
+ * @return Line offset.
+ */
+unsigned int gpiod_edge_event_get_line_offset(struct gpiod_edge_event *event);
+
+/**
+ * @brief Get the global sequence number of the event.
+ * @param event GPIO edge event.
+ * @return Sequence number of the event in the series of events for all lines
+ *         in the associated line request.
+ */
+unsigned long gpiod_edge_event_get_global_seqno(struct gpiod_edge_event *event);
+
+/**
+ * @brief Get the event sequence number specific to the line.
+ * @param event GPIO edge event.
+ * @return Sequence number of the event in the series of events only for this
+ *         line within the lifetime of the associated line request.
+ */
+unsigned long gpiod_edge_event_get_line_seqno(struct gpiod_edge_event *event);
+
+/**
+ * @brief Create a new edge event buffer.
+ * @param capacity Number of events the buffer can store (min = 1, max = 1024).
+ * @return New edge event buffer or NULL on error.
+ * @note If capacity equals 0, it will be set to the default capacity, 64
+ *       unless changed with ::gpiod_set_default_event_buffer_capacity. If
+ *       capacity is larger than 1024, it will be limited to 1024.
+ * @note The user space buffer is independent of the kernel buffer
+ *       (::gpiod_request_config_set_event_buffer_size). As the user space
+ *       buffer is filled from the kernel buffer, there is no benefit making
+ *       the user space buffer larger than the kernel buffer.
+ *       The default kernel buffer size for each request is (16 * num_lines).
+ */
+struct gpiod_edge_event_buffer *
+gpiod_edge_event_buffer_new(size_t capacity);
+
+/**
+ * @brief Create a new edge event buffer sized after the batches read into it.
+ * @return New edge event buffer or NULL on error.
+ *
+ * The buffer starts with the default capacity and doubles it, up to the
+ * maximum capacity (::gpiod_set_max_event_buffer_capacity), before the read
+ * following one that filled it without being limited by the caller's
+ * max_events. It never shrinks. Events read earlier, and the pointers to
+ * them, don't survive the next read so growing is otherwise transparent, but
+ * the capacity must be queried again after every read.
+ */
+struct gpiod_edge_event_buffer *gpiod_edge_event_buffer_new_adaptive(void);
+
+/**
+ * @brief Get the capacity (the max number of events that can be stored) of
+ *        the event buffer.
+ * @param buffer Edge event buffer.
  * @return The capacity of the buffer.
  */
-size_t
-gpiod_edge_event_buffer_get_capacity(struct gpiod_edge_event_buffer *buffer);
+size_t
+gpiod_edge_event_buffer_get_capacity(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Set the initial capacity of adaptive edge event buffers.
+ * @param capacity New default capacity, limited to 1024. 0 restores the
+ *                 built-in default of 64.
+ *
+ * The setting is global to the process and applies to the buffers created
+ * with a capacity of 0 and to the adaptive buffers created afterwards,
+ * including those allocated by the library, the bindings and the tools.
+ */
+void gpiod_set_default_event_buffer_capacity(size_t capacity);
+
+/**
+ * @brief Get the initial capacity of adaptive edge event buffers.
+ * @return Current default capacity.
+ */
+size_t gpiod_get_default_event_buffer_capacity(void);
+
+/**
+ * @brief Set the capacity adaptive edge event buffers may grow to.
+ * @param capacity New maximum capacity, limited to 1024. 0 restores the
+ *                 built-in default of 1024. A value not larger than the
+ *                 default capacity disables growing.
+ *
+ * The setting is global to the process and applies to all adaptive buffers
+ * from their next read on.
+ */
+void gpiod_set_max_event_buffer_capacity(size_t capacity);
+
+/**
+ * @brief Get the capacity adaptive edge event buffers may grow to.
+ * @return Current maximum capacity.
+ */
+size_t gpiod_get_max_event_buffer_capacity(void);
+
+/**
+ * @brief Free the edge event buffer and release all associated resources.
+ * @param buffer Edge event buffer to free.
+ */
+void gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Get an event stored in the buffer.
+ * @param buffer Edge event buffer.
+ * @param index Index of the event in the buffer.
+ * @return Pointer to an event stored in the buffer. The lifetime of the
+ *         event is tied to the buffer object. Users must not free the event
+ *         returned by this function.
+ */
+struct gpiod_edge_event *
+gpiod_edge_event_buffer_get_event(struct gpiod_edge_event_buffer *buffer,
+				  unsigned long index);
+
+/**
+ * @brief Get the number of events a buffer has stored.
+ * @param buffer Edge event buffer.
+ * @return Number of events stored in the buffer.
+ */
+size_t
+gpiod_edge_event_buffer_get_num_events(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Get the number of events the kernel dropped ahead of the buffered
+ *        events.
+ * @param buffer Edge event buffer.
+ * @return Number of events missing from the sequence since the previous read
+ *         from the same request. Non-zero means the batch follows a gap.
+ * @note Only set when the buffer is filled by
+ *       ::gpiod_line_request_read_edge_events or by an event loop. Batches
+ *       combining the events of several requests always report 0 - query the
+ *       requests themselves instead.
+ */
+size_t
+gpiod_edge_event_buffer_get_num_dropped(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Get the timestamps of all events stored in the buffer as an array.
+ * @param buffer Edge event buffer.
+ * @return Pointer to an array of ::gpiod_edge_event_buffer_get_num_events
+ *         timestamps in nanoseconds or NULL if the array could not be
+ *         allocated.
+ * @note The buffered events can also be accessed column-wise for code that
+ *       processes them in bulk. The columns are decoded from the buffered
+ *       events on first access after each read and stay valid until the next
+ *       read into the buffer or until it's freed. They must not be modified.
+ */
+const uint64_t *
+gpiod_edge_event_buffer_get_timestamps_ns(
+		struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Get the line offsets of all events stored in the buffer as an array.
+ * @param buffer Edge event buffer.
+ * @return Pointer to an array of ::gpiod_edge_event_buffer_get_num_events
+ *         offsets or NULL if the array could not be allocated.
+ * @note See ::gpiod_edge_event_buffer_get_timestamps_ns for the lifetime of
+ *       the array.
+ */
+const unsigned int *
+gpiod_edge_event_buffer_get_line_offsets(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Get the types of all events stored in the buffer as an array.
+ * @param buffer Edge event buffer.
+ * @return Pointer to an array of ::gpiod_edge_event_buffer_get_num_events
+ *         event types or NULL if the array could not be allocated.
+ * @note See ::gpiod_edge_event_buffer_get_timestamps_ns for the lifetime of
+ *       the array.
+ */
+const enum gpiod_edge_event_type *
+gpiod_edge_event_buffer_get_event_types(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Packed record of a single edge event.
+ *
+ * Layout of the events as stored in the buffer, which is that of the records
+ * read from the kernel. It's fixed and can be described to other runtimes,
+ * e.g. as a structured array, to process the events in place.
+ */
+struct gpiod_edge_event_record {
+	uint64_t timestamp_ns;
+	/**< Timestamp of the event in nanoseconds. */
+	uint32_t event_type;
+	/**< Value of ::gpiod_edge_event_type. */
+	uint32_t line_offset;
+	/**< Offset of the line on which the event occurred. */
+	uint32_t global_seqno;
+	/**< Sequence number of the event in the request. */
+	uint32_t line_seqno;
+	/**< Sequence number of the event on the line. */
+	uint32_t reserved[6];
+	/**< Reserved for future use. */
+};
+
+/**
+ * @brief Get the events stored in the buffer as an array of packed records.
+ * @param buffer Edge event buffer.
+ * @return Pointer to an array of ::gpiod_edge_event_buffer_get_num_events
+ *         records. Unlike the columns, the records are not copies but the
+ *         events themselves. They stay valid until the next read into the
+ *         buffer or until it's freed and must not be modified.
+ */
+const struct gpiod_edge_event_record *
+gpiod_edge_event_buffer_get_records(struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @}
+ *
+ * @defgroup event_loop Event loop
+ * @{
+ *
+ * An event loop waits for edge events on any number of line requests and for
+ * info events on any number of chips at once. All file descriptors are kept
+ * in a single persistent epoll set so the cost of each wakeup depends only on
+ * the number of sources that are actually ready.
+ *
+ * The loop doesn't take ownership of the registered requests and chips. They
+ * must be removed from the loop before being released.
+ */
+
+/**
+ * @brief Mechanisms the event loop can use to wait for events.
+ */
+enum gpiod_event_loop_backend {
+	GPIOD_EVENT_LOOP_BACKEND_AUTO = 1,
+	/**< Use io_uring if available, epoll otherwise. */
+	GPIOD_EVENT_LOOP_BACKEND_EPOLL,
+	/**< Wait for readiness with epoll and read the events afterwards. */
+	GPIOD_EVENT_LOOP_BACKEND_IO_URING,
+	/**< Keep a read queued on every registered file descriptor with
+	 *   io_uring. Completed reads of all sources are reaped with a single
+	 *   system call, which also resubmits the reads for the next batch. */
+};
+
+/**
+ * @brief Callback invoked with a batch of edge events read from a request.
+ * @param request Line request on which the events occurred.
+ * @param buffer Edge event buffer holding the events. Its contents are only
+ *               valid until the callback returns.
+ * @param num_events Number of events stored in the buffer.
+ * @param user_data Data passed when registering the request.
+ * @return 0 to continue dispatching, a positive value to stop dispatching the
+ *         remaining ready sources or a negative value to stop and make
+ *         ::gpiod_event_loop_wait fail.
+ */
+typedef int (*gpiod_event_loop_edge_cb)(struct gpiod_line_request *request,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t num_events, void *user_data);
+
+/**
+ * @brief Callback invoked with an info event read from a chip.
+ * @param chip GPIO chip on which the event occurred.
+ * @param event Info event. It's freed by the loop once the callback returns.
+ * @param user_data Data passed when registering the chip.
+ * @return Same as for ::gpiod_event_loop_edge_cb.
+ */
+typedef int (*gpiod_event_loop_info_cb)(struct gpiod_chip *chip,
+					 struct gpiod_info_event *event,
+					 void *user_data);
+
+/**
+ * @brief Callback invoked with a batch of info events read from a chip.
+ * @param chip GPIO chip on which the events occurred.
+ * @param buffer Info event buffer holding the events. Its contents are only
+ *               valid until the callback returns.
+ * @param num_events Number of events stored in the buffer.
+ * @param user_data Data passed when registering the chip.
+ * @return Same as for ::gpiod_event_loop_edge_cb.
+ */
+typedef int
+(*gpiod_event_loop_info_batch_cb)(struct gpiod_chip *chip,
+				  struct gpiod_info_event_buffer *buffer,
+				  size_t num_events, void *user_data);
+
+/**
+ * @brief Create a new event loop.
+ * @param event_buffer_size Capacity of the edge event buffer used to read
+ *                          events from requests. If 0, an adaptive buffer
+ *                          is used (::gpiod_edge_event_buffer_new_adaptive).
+ * @return New event loop or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_event_loop_free.
+ */
+struct gpiod_event_loop *gpiod_event_loop_new(size_t event_buffer_size);
+
+/**
+ * @brief Create a new event loop using a specific backend.
+ * @param event_buffer_size Capacity of the edge event buffers. If 0, adaptive
+ *                          buffers are used. With the io_uring backend each
+ *                          registered request gets a buffer of its own.
+ * @param backend Backend to use.
+ * @return New event loop or NULL on error. Fails with ENOTSUP if the io_uring
+ *         backend was explicitly selected but the library was built without
+ *         io_uring support or the running kernel doesn't provide it.
+ * @note ::gpiod_event_loop_new is equivalent to this function called with
+ *       ::GPIOD_EVENT_LOOP_BACKEND_EPOLL.
+ * @note With the io_uring backend, the events are read from the registered
+ *       file descriptors as soon as they arrive. The registered requests and
+ *       chips must not be read from directly while they're in the loop.
+ */
+struct gpiod_event_loop *
+gpiod_event_loop_new_with_backend(size_t event_buffer_size,
+				  enum gpiod_event_loop_backend backend);
+
+/**
+ * @brief Get the backend used by the event loop.
+ * @param loop Event loop object.
+ * @return Backend in use. Never ::GPIOD_EVENT_LOOP_BACKEND_AUTO.
+ */
+enum gpiod_event_loop_backend
+gpiod_event_loop_get_backend(struct gpiod_event_loop *loop);
+
+/**
+ * @brief Free the event loop and release all associated resources.
+ * @param loop Event loop to free.
+ */
+void gpiod_event_loop_free(struct gpiod_event_loop *loop);
+
+/**
+ * @brief Register a line request with the event loop.
+ * @param loop Event loop object.
+ * @param request Line request to watch for edge events.
+ * @param cb Callback to invoke when edge events are available.
+ * @param user_data Data passed to the callback.
+ * @return 0 on success, -1 on failure. Fails with EEXIST if the request is
+ *         already registered.
+ */
+int gpiod_event_loop_add_request(struct gpiod_event_loop *loop,
+				 struct gpiod_line_request *request,
+				 gpiod_event_loop_edge_cb cb, void *user_data);
+
+/**
+ * @brief Unregister a line request from the event loop.
+ * @param loop Event loop object.
+ * @param request Line request to remove.
+ * @return 0 on success, -1 on failure. Fails with ENOENT if the request is
+ *         not registered.
+ * @note It's safe to call this function from within the loop's callbacks.
+ */
+int gpiod_event_loop_remove_request(struct gpiod_event_loop *loop,
+				    struct gpiod_line_request *request);
+
+/**
+ * @brief Register a chip with the event loop.
+ * @param loop Event loop object.
+ * @param chip GPIO chip to watch for info events.
+ * @param cb Callback to invoke when an info event is available.
+ * @param user_data Data passed to the callback.
+ * @return 0 on success, -1 on failure. Fails with EEXIST if the chip is
+ *         already registered.
+ * @note Only lines watched with ::gpiod_chip_watch_line_info generate info
+ *       events.
+ */
+int gpiod_event_loop_add_chip(struct gpiod_event_loop *loop,
+			      struct gpiod_chip *chip,
+			      gpiod_event_loop_info_cb cb, void *user_data);
+
+/**
+ * @brief Register a chip with the event loop, reading its info events in
+ *        batches.
+ * @param loop Event loop object.
+ * @param chip GPIO chip to watch for info events.
+ * @param cb Callback to invoke with the events read at once.
+ * @param user_data Data passed to the callback.
+ * @return 0 on success, -1 on failure. Fails with EEXIST if the chip is
+ *         already registered.
+ *
+ * Unlike ::gpiod_event_loop_add_chip, all pending events - up to the size of
+ * the kernel's info event queue - are read with a single system call into a
+ * preallocated buffer. Programs watching many lines, which may all change at
+ * once, should prefer this variant to keep up with the kernel. The chip is
+ * removed with ::gpiod_event_loop_remove_chip.
+ */
+int gpiod_event_loop_add_chip_batched(struct gpiod_event_loop *loop,
+				      struct gpiod_chip *chip,
+				      gpiod_event_loop_info_batch_cb cb,
+				      void *user_data);
+
+/**
+ * @brief Unregister a chip from the event loop.
+ * @param loop Event loop object.
+ * @param chip GPIO chip to remove.
+ * @return 0 on success, -1 on failure. Fails with ENOENT if the chip is not
+ *         registered.
+ * @note It's safe to call this function from within the loop's callbacks.
+ */
+int gpiod_event_loop_remove_chip(struct gpiod_event_loop *loop,
+				 struct gpiod_chip *chip);
+
+/**
+ * @brief Get the number of sources registered with the event loop.
+ * @param loop Event loop object.
+ * @return Number of registered requests and chips.
+ */
+size_t gpiod_event_loop_get_num_sources(struct gpiod_event_loop *loop);
+
+/**
+ * @brief Get the file descriptor of the event loop.
+ * @param loop Event loop object.
+ * @return File descriptor which becomes readable when any of the registered
+ *         sources has events pending. Allows nesting the loop in another
+ *         poll()-style loop.
+ */
+int gpiod_event_loop_get_fd(struct gpiod_event_loop *loop);
+
+/**
+ * @brief Wait for events and dispatch them to the callbacks.
+ * @param loop Event loop object.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until an event becomes
+ *                   available. The timeout has millisecond resolution and is
+ *                   rounded up. With the epoll backend, timeouts longer than
+ *                   INT_MAX milliseconds (about 24.8 days) are clamped to it
+ *                   and the wait returns 0 once it elapses.
+ * @return Number of sources dispatched (0 if the wait timed out) or -1 on
+ *         failure.
+ */
+int gpiod_event_loop_wait(struct gpiod_event_loop *loop, int64_t timeout_ns);
+
+/**
+ * @brief Set the scheduling attributes of the threads waiting on the loop.
+ * @param loop Event loop object.
+ * @param attr Thread attributes, copied by the loop. NULL disables them.
+ * @return 0 on success, -1 on failure.
+ *
+ * The attributes are applied to the thread calling ::gpiod_event_loop_wait
+ * the first time it waits and remain in effect afterwards. If applying them
+ * fails, the wait fails without waiting.
+ */
+int gpiod_event_loop_set_thread_attr(struct gpiod_event_loop *loop,
+				     struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Set output lines straight from the loop when an input line sees
+ *        an edge.
+ * @param loop Event loop object.
+ * @param input Line request registered with the loop the edge events are read
+ *              from.
+ * @param offset Offset of the input line.
+ * @param edge Edges triggering the reflex: ::GPIOD_LINE_EDGE_RISING,
+ *             ::GPIOD_LINE_EDGE_FALLING or ::GPIOD_LINE_EDGE_BOTH.
+ * @param output Line request whose lines are set. Must stay valid until the
+ *               reflex is removed.
+ * @param mask Bitmask of the output lines to set, see
+ *             ::gpiod_line_request_set_values_mask.
+ * @param values Bitmask of the values to set the lines to.
+ * @return Non-negative identifier of the reflex or -1 on failure. Fails with
+ *         ENOENT if the input request is not registered with the loop and with
+ *         EINVAL if the offset is not part of it.
+ *
+ * Every matching event read by the loop sets the output lines before the
+ * callback of the input request is invoked, without the events going through
+ * the application first. With the epoll backend, ready requests with reflexes
+ * are also read before any other source is dispatched. Reflexes see the
+ * events passed on after software debouncing and edge event filtering.
+ *
+ * If setting the values fails, the remaining reflexes and the callback still
+ * run but ::gpiod_event_loop_wait fails afterwards with the errno of the
+ * failed write.
+ *
+ * The time between the timestamp of the triggering event and the return of
+ * the write is recorded in a latency histogram of the reflex. Its clock is
+ * the event clock configured for the input line when the reflex was added.
+ * Reflexes on lines using ::GPIOD_LINE_CLOCK_HTE don't record latencies.
+ */
+int gpiod_event_loop_add_reflex(struct gpiod_event_loop *loop,
+				struct gpiod_line_request *input,
+				unsigned int offset, enum gpiod_line_edge edge,
+				struct gpiod_line_request *output,
+				uint64_t mask, uint64_t values);
+
+/**
+ * @brief Remove a reflex from the event loop.
+ * @param loop Event loop object.
+ * @param id Identifier returned by ::gpiod_event_loop_add_reflex.
+ * @return 0 on success, -1 on failure. Fails with ENOENT if there is no such
+ *         reflex.
+ * @note Removing the input request from the loop removes its reflexes too.
+ */
+int gpiod_event_loop_remove_reflex(struct gpiod_event_loop *loop, int id);
+
+/**
+ * @brief Get the edge-to-write latency histogram of a reflex.
+ * @param loop Event loop object.
+ * @param id Identifier returned by ::gpiod_event_loop_add_reflex.
+ * @return Snapshot of the histogram or NULL on failure. The returned object
+ *         must be freed by the caller using ::gpiod_latency_histogram_free.
+ *         Fails with ENOENT if there is no such reflex.
+ */
+struct gpiod_latency_histogram *
+gpiod_event_loop_get_reflex_latency_histogram(struct gpiod_event_loop *loop,
+					      int id);
+
+/**
+ * @}
+ *
+ * @defgroup event_merger Merged edge event streams
+ * @{
+ *
+ * An event merger reads edge events from any number of line requests -
+ * possibly on different chips - and returns them as a single stream ordered
+ * by timestamp.
+ *
+ * Each request's events are already ordered but the kernel gives no
+ * guarantee as to when events from different requests become readable
+ * relative to each other. The merger holds every event back for a reorder
+ * window counted from its timestamp, which bounds how late an event from
+ * another request may arrive and still be returned in order. A wider window
+ * tolerates more skew at the cost of latency. Events arriving after a newer
+ * event has already been returned are still delivered but counted as late.
+ *
+ * All registered requests must use the same event clock. The merger doesn't
+ * take ownership of the requests and they must not be read from directly
+ * while they're registered.
+ */
+
+/**
+ * @brief Create a new event merger.
+ * @param clock Event clock used by all the merged requests. The reorder
+ *              window is measured against the matching system clock. With
+ *              ::GPIOD_LINE_CLOCK_HTE, the window instead elapses as newer
+ *              events arrive.
+ * @param window_ns Reorder window in nanoseconds. An event is returned once
+ *                  this much time has passed since its timestamp.
+ * @param capacity Max number of events held back at once. If 0, a default
+ *                 value is used. When the limit is reached, the oldest events
+ *                 are released before their window elapsed.
+ * @return New event merger or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_event_merger_free.
+ */
+struct gpiod_event_merger *
+gpiod_event_merger_new(enum gpiod_line_clock clock, uint64_t window_ns,
+		       size_t capacity);
+
+/**
+ * @brief Free the event merger and release all associated resources.
+ * @param merger Event merger to free.
+ * @note Events still held back are discarded. Use
+ *       ::gpiod_event_merger_flush_edge_events to retrieve them first.
+ */
+void gpiod_event_merger_free(struct gpiod_event_merger *merger);
+
+/**
+ * @brief Add a line request to the merged stream.
+ * @param merger Event merger object.
+ * @param request Line request to read edge events from.
+ * @return 0 on success, -1 on failure. Fails with EEXIST if the request is
+ *         already registered.
+ */
+int gpiod_event_merger_add_request(struct gpiod_event_merger *merger,
+				   struct gpiod_line_request *request);
+
+/**
+ * @brief Remove a line request from the merged stream.
+ * @param merger Event merger object.
+ * @param request Line request to remove.
+ * @return 0 on success, -1 on failure. Fails with ENOENT if the request is
+ *         not registered.
+ * @note Events of this request still held back are discarded.
+ */
+int gpiod_event_merger_remove_request(struct gpiod_event_merger *merger,
+				      struct gpiod_line_request *request);
+
+/**
+ * @brief Get the file descriptor of the event merger.
+ * @param merger Event merger object.
+ * @return File descriptor which becomes readable when any of the registered
+ *         requests has events pending or when the window of the oldest held
+ *         back event elapses.
+ * @note Readiness doesn't imply that a read returns any events as new events
+ *       may still be inside their reorder window.
+ */
+int gpiod_event_merger_get_fd(struct gpiod_event_merger *merger);
+
+/**
+ * @brief Wait until merged edge events are ready to be read.
+ * @param merger Event merger object.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until events are ready. The
+ *                   timeout has millisecond resolution and is rounded up.
+ * @return 0 if the wait timed out, -1 on error, 1 if events are ready.
+ */
+int gpiod_event_merger_wait_edge_events(struct gpiod_event_merger *merger,
+					int64_t timeout_ns);
+
+/**
+ * @brief Read the edge events whose reorder window elapsed.
+ * @param merger Event merger object.
+ * @param buffer Edge event buffer the events are stored in.
+ * @param max_events Maximum number of events to read.
+ * @return On success returns the number of events read, which may be 0.
+ *         Returns -1 on error.
+ * @note This function never blocks.
+ * @note The sequence numbers of the events are those assigned by their
+ *       respective requests.
+ */
+int gpiod_event_merger_read_edge_events(struct gpiod_event_merger *merger,
+					struct gpiod_edge_event_buffer *buffer,
+					size_t max_events);
+
+/**
+ * @brief Read the held back edge events without waiting for their reorder
+ *        window to elapse.
+ * @param merger Event merger object.
+ * @param buffer Edge event buffer the events are stored in.
+ * @param max_events Maximum number of events to read.
+ * @return Number of events read or -1 on error.
+ */
+int gpiod_event_merger_flush_edge_events(struct gpiod_event_merger *merger,
+					 struct gpiod_edge_event_buffer *buffer,
+					 size_t max_events);
+
+/**
+ * @brief Get the request an event returned by the last read came from.
+ * @param merger Event merger object.
+ * @param index Index of the event in the buffer passed to the last read.
+ * @return Line request or NULL if the index is out of range or the request
+ *         was removed since.
+ */
+struct gpiod_line_request *
+gpiod_event_merger_get_event_request(struct gpiod_event_merger *merger,
+				     unsigned long index);
+
+/**
+ * @brief Get the number of events currently held back.
+ * @param merger Event merger object.
+ * @return Number of events read from the requests but not returned yet.
+ */
+size_t
+gpiod_event_merger_get_num_staged_events(struct gpiod_event_merger *merger);
+
+/**
+ * @brief Get the number of events which arrived too late to be ordered.
+ * @param merger Event merger object.
+ * @return Number of events older than an event already returned at the time
+ *         they were read from their request.
+ */
+unsigned long
+gpiod_event_merger_get_num_late_events(struct gpiod_event_merger *merger);
+
+/**
+ * @}
+ *
+ * @defgroup event_ring Shared-memory event rings
+ * @{
+ *
+ * An event ring publishes the edge events of a line request to other
+ * processes on the same machine. Lines can only be requested once, so a
+ * single publisher reads the events and stores them in a file mapped into
+ * memory by every subscriber. Subscribers read the events straight from the
+ * shared mapping, without any system calls.
+ *
+ * The ring has a single producer and any number of readers. Each reader
+ * keeps its own position in the ring and the producer never waits for
+ * readers: a reader that falls behind by more than the capacity of the ring
+ * loses the oldest events, which are reported as overruns.
+ *
+ * Reading never blocks. Readers poll the ring at the rate they need.
+ */
+
+/**
+ * @brief Create a new event ring.
+ * @param path Path of the file backing the ring, typically in /dev/shm. An
+ *             existing file at this path is replaced atomically. Readers
+ *             which opened it before keep their mapping of the old file.
+ * @param capacity Number of events the ring holds, rounded up to a power of
+ *                 two. If 0, a default value is used.
+ * @return New event ring or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_event_ring_free.
+ */
+struct gpiod_event_ring *gpiod_event_ring_create(const char *path,
+						 size_t capacity);
+
+/**
+ * @brief Close the event ring and remove its file.
+ * @param ring Event ring to free.
+ * @note Readers keep their mapping of the ring and may still read the
+ *       events published so far. ::gpiod_event_ring_reader_is_closed returns
+ *       true for them from now on.
+ */
+void gpiod_event_ring_free(struct gpiod_event_ring *ring);
+
+/**
+ * @brief Get the capacity of the event ring.
+ * @param ring Event ring object.
+ * @return Number of events the ring holds.
+ */
+size_t gpiod_event_ring_get_capacity(struct gpiod_event_ring *ring);
+
+/**
+ * @brief Publish the events stored in a buffer.
+ * @param ring Event ring object.
+ * @param buffer Edge event buffer filled by a previous read.
+ * @return Number of events published or -1 on error.
+ * @note This function never blocks and the oldest events in the ring are
+ *       overwritten.
+ */
+int gpiod_event_ring_publish(struct gpiod_event_ring *ring,
+			     struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Read edge events from a line request and publish them.
+ * @param ring Event ring object.
+ * @param request Line request to read the events from.
+ * @param buffer Edge event buffer used for the read.
+ * @param max_events Maximum number of events to read.
+ * @return Number of events published, which may be 0, or -1 on error.
+ * @note Blocks like ::gpiod_line_request_read_edge_events.
+ */
+int gpiod_event_ring_publish_request(struct gpiod_event_ring *ring,
+				     struct gpiod_line_request *request,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events);
+
+/**
+ * @brief Subscribe to an event ring.
+ * @param path Path of the file backing the ring.
+ * @return New reader or NULL on error. Fails with EINVAL if the file is not
+ *         an event ring. The returned object must be freed by the caller
+ *         using ::gpiod_event_ring_reader_close.
+ * @note The reader starts at the end of the ring and only returns events
+ *       published after it was opened.
+ */
+struct gpiod_event_ring_reader *gpiod_event_ring_reader_open(const char *path);
+
+/**
+ * @brief Close the reader and unmap the ring.
+ * @param reader Reader to close.
+ */
+void gpiod_event_ring_reader_close(struct gpiod_event_ring_reader *reader);
+
+/**
+ * @brief Read the events published since the last read.
+ * @param reader Reader object.
+ * @param buffer Edge event buffer the events are stored in.
+ * @param max_events Maximum number of events to read. If 0 or larger than the
+ *                   capacity of the buffer, the capacity is used.
+ * @return Number of events read, which may be 0, or -1 on error.
+ * @note This function never blocks. The events overwritten by the producer
+ *       before the reader got to them are reported by
+ *       ::gpiod_edge_event_buffer_get_num_dropped.
+ */
+int gpiod_event_ring_reader_read(struct gpiod_event_ring_reader *reader,
+				 struct gpiod_edge_event_buffer *buffer,
+				 size_t max_events);
+
+/**
+ * @brief Get the number of events published but not read yet.
+ * @param reader Reader object.
+ * @return Number of events the next reads would return, including those
+ *         already overwritten.
+ */
+size_t
+gpiod_event_ring_reader_get_num_pending(struct gpiod_event_ring_reader *reader);
+
+/**
+ * @brief Get the number of events the reader lost to overruns.
+ * @param reader Reader object.
+ * @return Cumulative number of events overwritten before they were read.
+ */
+unsigned long
+gpiod_event_ring_reader_get_num_overruns(struct gpiod_event_ring_reader *reader);
+
+/**
+ * @brief Check whether the producer closed the ring.
+ * @param reader Reader object.
+ * @return True if the ring was freed by its producer, false otherwise.
+ */
+bool gpiod_event_ring_reader_is_closed(struct gpiod_event_ring_reader *reader);
+
+/**
+ * @}
+ *
+ * @defgroup capture_reader Capture files
+ * @{
+ *
+ * Capture files are written by 'gpiomon --capture': a ring of fixed-size
+ * records in a file allocated up front, preceded by a header describing the
+ * recorded lines and an index of checkpoints holding the timestamp of every
+ * 1024th slot of the ring. Once the ring is full the oldest records are
+ * overwritten.
+ *
+ * A capture reader maps the file into memory and hands out the records in
+ * place, in the order they were written, so that captures of any size can be
+ * sliced without reading them in. Records are numbered from 0, the oldest one
+ * still in the ring. Looking up a timestamp is a binary search of the
+ * checkpoints followed by one of the records between two of them.
+ *
+ * The records are taken as they were when the reader was opened. Lookups
+ * assume the timestamps don't decrease, which holds for captures of a single
+ * chip. The fields of the records are little-endian and opening captures on
+ * big-endian hosts fails with errno set to ENOTSUP.
+ */
+
+/**
+ * @brief Size of the name fields of ::gpiod_capture_line.
+ */
+#define GPIOD_CAPTURE_NAME_SIZE		32
+
+/**
+ * @brief Line recorded in a capture file.
+ */
+struct gpiod_capture_line {
+	uint32_t chip_num;
+	/**< Number of the chip in the order given to gpiomon. */
+	uint32_t offset;
+	/**< Offset of the line on its chip. */
+	char chip_name[GPIOD_CAPTURE_NAME_SIZE];
+	/**< Name of the chip, null-terminated. */
+	char line_name[GPIOD_CAPTURE_NAME_SIZE];
+	/**< Name of the line, null-terminated and empty if unnamed. */
+};
+
+/**
+ * @brief Record of an edge event in a capture file.
+ *
+ * Layout of the records as stored in the file. It's fixed and can be
+ * described to other runtimes to process the records in place.
+ */
+struct gpiod_capture_record {
+	uint64_t timestamp_ns;
+	/**< Timestamp of the event in nanoseconds. */
+	uint32_t chip_num;
+	/**< Number of the chip in the order given to gpiomon. */
+	uint32_t offset;
+	/**< Offset of the line on its chip. */
+	uint32_t event_type;
+	/**< Value of ::gpiod_edge_event_type. */
+	uint32_t global_seqno;
+	/**< Sequence number of the event in the request. */
+	uint32_t line_seqno;
+	/**< Sequence number of the event on the line. */
+	uint32_t reserved;
+	/**< Reserved for future use. */
+};
+
+/**
+ * @brief Open a capture file.
+ * @param path Path of the capture file.
+ * @return New reader or NULL on error. Fails with EINVAL if the file is not
+ *         a capture or is corrupted. The returned object must be freed by the
+ *         caller using ::gpiod_capture_reader_close.
+ */
+struct gpiod_capture_reader *gpiod_capture_reader_open(const char *path);
+
+/**
+ * @brief Close the reader and unmap the capture.
+ * @param reader Reader to close.
+ */
+void gpiod_capture_reader_close(struct gpiod_capture_reader *reader);
+
+/**
+ * @brief Get the clock the timestamps of the capture come from.
+ * @param reader Reader object.
+ * @return Event clock the lines were requested with.
+ */
+enum gpiod_line_clock
+gpiod_capture_reader_get_event_clock(struct gpiod_capture_reader *reader);
+
+/**
+ * @brief Get the number of lines recorded in the capture.
+ * @param reader Reader object.
+ * @return Number of lines.
+ */
+size_t gpiod_capture_reader_get_num_lines(struct gpiod_capture_reader *reader);
+
+/**
+ * @brief Get a recorded line.
+ * @param reader Reader object.
+ * @param index Index of the line, in the order given to gpiomon.
+ * @return Line description owned by the reader or NULL if the index is out of
+ *         range.
+ */
+const struct gpiod_capture_line *
+gpiod_capture_reader_get_line(struct gpiod_capture_reader *reader,
+			      size_t index);
+
+/**
+ * @brief Get the number of records in the capture.
+ * @param reader Reader object.
+ * @return Number of records still in the ring.
+ */
+uint64_t
+gpiod_capture_reader_get_num_records(struct gpiod_capture_reader *reader);
+
+/**
+ * @brief Get the number of records overwritten in the ring.
+ * @param reader Reader object.
+ * @return Number of records written before the oldest one still in the ring.
+ */
+uint64_t gpiod_capture_reader_get_num_lost(struct gpiod_capture_reader *reader);
+
+/**
+ * @brief Get a single record.
+ * @param reader Reader object.
+ * @param index Number of the record, 0 being the oldest.
+ * @return Record in the mapped file or NULL if the index is out of range.
+ *         The record stays valid until the reader is closed.
+ */
+const struct gpiod_capture_record *
+gpiod_capture_reader_get_record(struct gpiod_capture_reader *reader,
+				uint64_t index);
+
+/**
+ * @brief Get the records contiguous in the file, starting from a record.
+ * @param reader Reader object.
+ * @param index Number of the first record.
+ * @param records Set to the first record in the mapped file, or NULL if the
+ *                index is out of range.
+ * @return Number of records stored back-to-back from the first one, 0 if the
+ *         index is out of range.
+ *
+ * The ring wraps at most once, so iterating over a range of records takes at
+ * most two calls. The records stay valid until the reader is closed.
+ */
+size_t
+gpiod_capture_reader_get_records(struct gpiod_capture_reader *reader,
+				 uint64_t index,
+				 const struct gpiod_capture_record **records);
+
+/**
+ * @brief Look up the first record not older than a timestamp.
+ * @param reader Reader object.
+ * @param timestamp_ns Timestamp, in the clock of the capture.
+ * @return Number of the first record with a timestamp equal to or later than
+ *         the one given, or the number of records if there's none.
+ */
+uint64_t gpiod_capture_reader_find(struct gpiod_capture_reader *reader,
+				   uint64_t timestamp_ns);
+
+/**
+ * @}
+ *
+ * @defgroup waveform Timed waveform playback
+ * @{
+ *
+ * A waveform is a table of steps, each of which sets a bitmask of lines of a
+ * line request to given values at a given time offset from the start of the
+ * playback. The deadline of every step is computed from the time at which the
+ * playback started, so scheduling errors don't accumulate over long runs.
+ *
+ * The playback happens in the thread calling ::gpiod_waveform_play. Users
+ * requiring tighter timing should call it from a dedicated thread running
+ * with a realtime scheduling policy.
+ */
+
+/**
+ * @brief Callback invoked after each step of a waveform has been applied.
+ * @param step Index of the step within the waveform.
+ * @param cycle Number of the current cycle, starting at 0.
+ * @param lateness_ns Time in nanoseconds by which the step missed its deadline.
+ * @param user_data Data passed to ::gpiod_waveform_set_step_callback.
+ * @return 0 to continue the playback, any other value to stop it.
+ */
+typedef int (*gpiod_waveform_step_cb)(size_t step, uint64_t cycle,
+				      int64_t lateness_ns, void *user_data);
+
+/**
+ * @brief Create a new, empty waveform.
+ * @return New waveform object or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_waveform_free.
+ */
+struct gpiod_waveform *gpiod_waveform_new(void);
+
+/**
+ * @brief Free the waveform object and release all associated resources.
+ * @param waveform Waveform to free.
+ */
+void gpiod_waveform_free(struct gpiod_waveform *waveform);
+
+/**
+ * @brief Append a step to the waveform.
+ * @param waveform Waveform object.
+ * @param request Line request on which to apply the step. Must outlive the
+ *                waveform or at least any playback of it.
+ * @param time_ns Time offset of the step from the start of the cycle in
+ *                nanoseconds. Must not be lower than the offset of the
+ *                previously added step.
+ * @param mask Bitmask of the lines of \p request to set, as accepted by
+ *             ::gpiod_line_request_set_values_mask.
+ * @param values Bitmap of the values to set.
+ * @return 0 on success, -1 on failure.
+ * @note Steps with equal time offsets are applied back-to-back in the order
+ *       in which they were added. This allows driving lines of several
+ *       requests from a single waveform.
+ */
+int gpiod_waveform_add_step(struct gpiod_waveform *waveform,
+			    struct gpiod_line_request *request,
+			    uint64_t time_ns, uint64_t mask, uint64_t values);
+
+/**
+ * @brief Get the number of steps in the waveform.
+ * @param waveform Waveform object.
+ * @return Number of steps.
+ */
+size_t gpiod_waveform_get_num_steps(struct gpiod_waveform *waveform);
+
+/**
+ * @brief Set the period of the waveform.
+ * @param waveform Waveform object.
+ * @param period_ns Length of a single cycle in nanoseconds. If 0, which is
+ *                  the default, the steps are played only once. Otherwise it
+ *                  must not be lower than the time offset of the last step.
+ */
+void gpiod_waveform_set_period_ns(struct gpiod_waveform *waveform,
+				  uint64_t period_ns);
+
+/**
+ * @brief Get the period of the waveform.
+ * @param waveform Waveform object.
+ * @return Period in nanoseconds.
+ */
+uint64_t gpiod_waveform_get_period_ns(struct gpiod_waveform *waveform);
+
+/**
+ * @brief Set the number of cycles to play for periodic waveforms.
+ * @param waveform Waveform object.
+ * @param num_cycles Number of cycles. If 0, which is the default, a periodic
+ *                   waveform is played until stopped by the step callback.
+ */
+void gpiod_waveform_set_num_cycles(struct gpiod_waveform *waveform,
+				   uint64_t num_cycles);
+
+/**
+ * @brief Get the number of cycles to play.
+ * @param waveform Waveform object.
+ * @return Number of cycles.
+ */
+uint64_t gpiod_waveform_get_num_cycles(struct gpiod_waveform *waveform);
+
+/**
+ * @brief Set the callback invoked after every applied step.
+ * @param waveform Waveform object.
+ * @param cb Callback to invoke or NULL to disable it.
+ * @param user_data Data passed to the callback.
+ */
+void gpiod_waveform_set_step_callback(struct gpiod_waveform *waveform,
+				      gpiod_waveform_step_cb cb,
+				      void *user_data);
+
+/**
+ * @brief Play the waveform.
+ * @param waveform Waveform object.
+ * @return 0 once the playback has completed or was stopped by the step
+ *         callback, -1 on failure.
+ * @note This function blocks for the entire duration of the playback. The
+ *       deadlines are tracked on CLOCK_MONOTONIC using absolute-time sleeps.
+ */
+int gpiod_waveform_play(struct gpiod_waveform *waveform);
+
+/**
+ * @brief Set the scheduling attributes used during the playback.
+ * @param waveform Waveform object.
+ * @param attr Thread attributes, copied by the waveform. NULL disables them.
+ * @return 0 on success, -1 on failure.
+ *
+ * ::gpiod_waveform_play applies the attributes to the calling thread for the
+ * duration of the playback and restores its previous scheduling policy and
+ * CPU affinity afterwards. Locked memory stays locked.
+ */
+int gpiod_waveform_set_thread_attr(struct gpiod_waveform *waveform,
+				   struct gpiod_thread_attr *attr);
+
+/**
+ * @}
+ *
+ * @defgroup pwm Software PWM
+ * @{
+ *
+ * Software pulse-width modulation for lines of chips without PWM hardware.
+ *
+ * A PWM object multiplexes any number of lines, each with its own period and
+ * duty cycle, onto a single timer thread. Each period starts with the line
+ * active and ends with it inactive. All transitions falling due at the same
+ * tick are merged into a single ::gpiod_line_request_set_values_mask call per
+ * request, so the number of system calls depends on the number of distinct
+ * transition times rather than on the number of lines.
+ *
+ * While the PWM is running, the timer thread writes to the line requests the
+ * lines belong to. The caller must not use these requests from other threads
+ * until the PWM is stopped.
+ */
+
+/**
+ * @brief Create a new software PWM object.
+ * @return New PWM object or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_pwm_free.
+ */
+struct gpiod_pwm *gpiod_pwm_new(void);
+
+/**
+ * @brief Free the PWM object, stopping it first if it's running.
+ * @param pwm PWM object.
+ */
+void gpiod_pwm_free(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Add a requested output line to the PWM.
+ * @param pwm PWM object.
+ * @param request Line request the line belongs to.
+ * @param offset Offset of the line.
+ * @param period_ns Period of the signal in nanoseconds. Must not be 0.
+ * @param duty_ns Active time within each period in nanoseconds. Must not be
+ *                greater than \p period_ns.
+ * @return Index of the new PWM channel on success, -1 on failure. Fails with
+ *         EBUSY if the PWM is running.
+ */
+int gpiod_pwm_add_line(struct gpiod_pwm *pwm,
+		       struct gpiod_line_request *request,
+		       unsigned int offset, uint64_t period_ns,
+		       uint64_t duty_ns);
+
+/**
+ * @brief Get the number of lines driven by the PWM.
+ * @param pwm PWM object.
+ * @return Number of PWM channels.
+ */
+size_t gpiod_pwm_get_num_lines(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Change the period and duty cycle of a PWM channel.
+ * @param pwm PWM object.
+ * @param channel Index of the channel returned by ::gpiod_pwm_add_line.
+ * @param period_ns New period in nanoseconds.
+ * @param duty_ns New active time within each period in nanoseconds.
+ * @return 0 on success, -1 on failure.
+ * @note This function may be called while the PWM is running. The new
+ *       settings take effect at the start of the next period of the channel.
+ */
+int gpiod_pwm_set_duty_cycle(struct gpiod_pwm *pwm, unsigned int channel,
+			     uint64_t period_ns, uint64_t duty_ns);
+
+/**
+ * @brief Set the scheduling attributes of the PWM timer thread.
+ * @param pwm PWM object.
+ * @param attr Thread attributes, copied by the PWM. NULL restores the
+ *             default of inheriting them from the thread calling
+ *             ::gpiod_pwm_start.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the PWM is
+ *         running.
+ */
+int gpiod_pwm_set_thread_attr(struct gpiod_pwm *pwm,
+			      struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Start driving the lines from the PWM timer thread.
+ * @param pwm PWM object.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_pwm_start(struct gpiod_pwm *pwm);
+
+/**
+ * @brief Stop the PWM timer thread and set all its lines to inactive.
+ * @param pwm PWM object.
+ * @return 0 on success, -1 on failure. If setting the line values failed in
+ *         the timer thread, the thread exits early and its error is reported
+ *         here.
+ */
+int gpiod_pwm_stop(struct gpiod_pwm *pwm);
+
+/**
+ * @}
+ *
+ * @defgroup output_scheduler Scheduled output updates
+ * @{
+ *
+ * An output scheduler sets lines of requests at given points in time from a
+ * single timer thread, for example 2.5 ms after the timestamp of an edge
+ * event, without the application having to run a sleeping thread for each
+ * pending update.
+ *
+ * Each entry sets the lines in a mask of a request to a set of values, in
+ * the bit layout of ::gpiod_line_request_set_values_mask, once its absolute
+ * deadline has passed. Deadlines are given in the clock of the edge event
+ * timestamps the scheduler was created for. Entries are kept in a heap
+ * ordered by deadline and those due at the same tick are merged into a single
+ * write per request, later entries overriding the lines they share with
+ * earlier ones.
+ *
+ * For every entry run, the scheduler queues a result with the lateness of the
+ * write: the time between its deadline and the return of the ioctl setting the
+ * values. Results that don't fit in the queue are dropped and counted.
+ *
+ * The timer thread sets values on the requests while the scheduler is running.
+ * As with any other thread, it must not set the same lines as other threads at
+ * the same time, see @ref request_request.
+ */
+
+/**
+ * @brief Maximum number of results queued by an output scheduler.
+ */
+#define GPIOD_OUTPUT_SCHEDULER_MAX_RESULTS	256
+
+/**
+ * @brief Create a new output scheduler.
+ * @param clock Clock of the deadlines.
+ * @return New scheduler or NULL on error. Fails with ENOTSUP if the clock is
+ *         ::GPIOD_LINE_CLOCK_HTE as there is no way to sleep on it. The
+ *         returned object must be freed by the caller using
+ *         ::gpiod_output_scheduler_free.
+ */
+struct gpiod_output_scheduler *
+gpiod_output_scheduler_new(enum gpiod_line_clock clock);
+
+/**
+ * @brief Free the scheduler, stopping it first if it's running.
+ * @param sched Output scheduler object.
+ *
+ * Pending entries are dropped.
+ */
+void gpiod_output_scheduler_free(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Get the clock of the deadlines of the scheduler.
+ * @param sched Output scheduler object.
+ * @return Clock the scheduler was created for.
+ */
+enum gpiod_line_clock
+gpiod_output_scheduler_get_clock(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Get the current time on the clock of the scheduler.
+ * @param sched Output scheduler object.
+ * @return Current time in nanoseconds.
+ */
+uint64_t gpiod_output_scheduler_now_ns(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Schedule setting lines of a request.
+ * @param sched Output scheduler object.
+ * @param request Line request the lines belong to. Must stay valid until the
+ *                entry was run or cancelled.
+ * @param deadline_ns Absolute time at which to set the lines, in the clock of
+ *                    the scheduler. Entries whose deadline already passed
+ *                    run as soon as possible.
+ * @param mask Bitmask of the lines to set, see
+ *             ::gpiod_line_request_set_values_mask.
+ * @param values Bitmask of the values to set the lines to.
+ * @param id Set to the identifier of the entry, used to cancel it and to
+ *           match it with its result. May be NULL.
+ * @return 0 on success, -1 on failure.
+ * @note This function may be called from any thread, including while the
+ *       scheduler is running.
+ */
+int gpiod_output_scheduler_schedule(struct gpiod_output_scheduler *sched,
+				    struct gpiod_line_request *request,
+				    uint64_t deadline_ns, uint64_t mask,
+				    uint64_t values, uint64_t *id);
+
+/**
+ * @brief Cancel a pending entry.
+ * @param sched Output scheduler object.
+ * @param id Identifier of the entry set by ::gpiod_output_scheduler_schedule.
+ * @return 0 on success, -1 on failure. Fails with ENOENT if the entry already
+ *         ran or was cancelled.
+ */
+int gpiod_output_scheduler_cancel(struct gpiod_output_scheduler *sched,
+				  uint64_t id);
+
+/**
+ * @brief Cancel all pending entries using a request.
+ * @param sched Output scheduler object.
+ * @param request Line request whose entries to cancel.
+ * @return Number of entries cancelled.
+ * @note To be called before releasing a request with pending entries.
+ */
+size_t
+gpiod_output_scheduler_cancel_request(struct gpiod_output_scheduler *sched,
+				      struct gpiod_line_request *request);
+
+/**
+ * @brief Get the number of pending entries.
+ * @param sched Output scheduler object.
+ * @return Number of entries scheduled and not yet run or cancelled.
+ */
+size_t
+gpiod_output_scheduler_get_num_pending(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Set the scheduling attributes of the timer thread.
+ * @param sched Output scheduler object.
+ * @param attr Thread attributes, copied by the scheduler. NULL restores the
+ *             default of inheriting them from the thread calling
+ *             ::gpiod_output_scheduler_start.
+ * @return 0 on success, -1 on failure. Fails with EBUSY if the scheduler is
+ *         running.
+ */
+int gpiod_output_scheduler_set_thread_attr(struct gpiod_output_scheduler *sched,
+					   struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Start running entries from the timer thread.
+ * @param sched Output scheduler object.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_output_scheduler_start(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Stop the timer thread.
+ * @param sched Output scheduler object.
+ * @return 0 on success, -1 on failure.
+ *
+ * Pending entries stay queued and run once the scheduler is started again.
+ */
+int gpiod_output_scheduler_stop(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Take the oldest result off the queue.
+ * @param sched Output scheduler object.
+ * @param id Set to the identifier of the entry. May be NULL.
+ * @param lateness_ns Set to the time between the deadline of the entry and
+ *                    the return of the write setting its values. May be NULL.
+ * @param error Set to 0 if the values were set or to the errno value of the
+ *              failed write. May be NULL.
+ * @return 1 if a result was read, 0 if the queue is empty.
+ */
+int gpiod_output_scheduler_read_result(struct gpiod_output_scheduler *sched,
+				       uint64_t *id, uint64_t *lateness_ns,
+				       int *error);
+
+/**
+ * @brief Get the number of results dropped because the queue was full.
+ * @param sched Output scheduler object.
+ * @return Number of results lost since the scheduler was created.
+ */
+unsigned long
+gpiod_output_scheduler_get_num_lost_results(struct gpiod_output_scheduler *sched);
+
+/**
+ * @brief Get the highest lateness of the entries run so far.
+ * @param sched Output scheduler object.
+ * @return Highest lateness in nanoseconds.
+ */
+uint64_t
+gpiod_output_scheduler_get_max_lateness_ns(struct gpiod_output_scheduler *sched);
+
+/**
+ * @}
+ *
+ * @defgroup pulse_meter Pulse measurement
+ * @{
+ *
+ * A pulse meter computes the period, frequency, high and low time and the
+ * number of pulses of signals from the timestamps of their edge events.
+ *
+ * Buffers read from line requests are passed to the meter which updates
+ * running sums for each line without allocating memory, so it can be fed
+ * every batch of events at full rate. A meter tracks up to 64 lines which may
+ * come from different requests as long as their offsets don't collide.
+ *
+ * The period is measured between consecutive rising edges, the high time from
+ * a rising to the next falling edge and the low time from a falling to the
+ * next rising edge. Lines must be requested with both edges detected for the
+ * high and low times to be available. Intervals spanning lost events - two
+ * edges of the same type in a row - are not counted.
+ *
+ * With a non-zero window, statistics are gathered over consecutive windows of
+ * fixed length, aligned to the timestamp of the first event seen for the line,
+ * and the getters report the last window that was closed. A window is closed
+ * by the first event past its end or by ::gpiod_pulse_meter_flush. With a
+ * window of 0 the statistics cover all events since the line was first seen.
+ *
+ * All timestamps fed to a meter must come from the same clock.
+ */
+
+/**
+ * @brief Create a new pulse meter.
+ * @param window_ns Length of the measurement window in nanoseconds or 0 to
+ *                  accumulate statistics over all events.
+ * @return New pulse meter or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_pulse_meter_free.
+ */
+struct gpiod_pulse_meter *gpiod_pulse_meter_new(uint64_t window_ns);
+
+/**
+ * @brief Free the pulse meter and release all associated resources.
+ * @param meter Pulse meter to free.
+ */
+void gpiod_pulse_meter_free(struct gpiod_pulse_meter *meter);
+
+/**
+ * @brief Forget all lines and their statistics.
+ * @param meter Pulse meter object.
+ */
+void gpiod_pulse_meter_reset(struct gpiod_pulse_meter *meter);
+
+/**
+ * @brief Update the statistics with a batch of edge events.
+ * @param meter Pulse meter object.
+ * @param buffer Edge event buffer filled by
+ *               ::gpiod_line_request_read_edge_events.
+ * @return 0 on success, -1 on failure. Fails with E2BIG if the events come
+ *         from more than 64 distinct lines, in which case the events preceding
+ *         the first one of the excess line have been accounted.
+ * @note Events must be passed in the order in which they were read.
+ */
+int gpiod_pulse_meter_add_events(struct gpiod_pulse_meter *meter,
+				 struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Close the measurement windows that ended before the given time.
+ * @param meter Pulse meter object.
+ * @param now_ns Current time on the clock of the event timestamps.
+ * @note Without flushing, the statistics of a line that stopped producing
+ *       events keep reporting its last busy window. Does nothing for meters
+ *       without a window.
+ */
+void gpiod_pulse_meter_flush(struct gpiod_pulse_meter *meter, uint64_t now_ns);
+
+/**
+ * @brief Get the number of pulses of a line.
+ * @param meter Pulse meter object.
+ * @param offset Offset of the line.
+ * @return Number of rising edges seen in the window or 0 if the line has
+ *         never been seen.
+ */
+uint64_t gpiod_pulse_meter_get_num_pulses(struct gpiod_pulse_meter *meter,
+					  unsigned int offset);
+
+/**
+ * @brief Get the average period of a line.
+ * @param meter Pulse meter object.
+ * @param offset Offset of the line.
+ * @return Average period in nanoseconds or 0 if no full period was measured.
+ */
+uint64_t gpiod_pulse_meter_get_period_ns(struct gpiod_pulse_meter *meter,
+					 unsigned int offset);
+
+/**
+ * @brief Get the average frequency of a line.
+ * @param meter Pulse meter object.
+ * @param offset Offset of the line.
+ * @return Frequency in millihertz or 0 if no full period was measured.
+ */
+uint64_t
+gpiod_pulse_meter_get_frequency_millihz(struct gpiod_pulse_meter *meter,
+					unsigned int offset);
+
+/**
+ * @brief Get the average high time of a line.
+ * @param meter Pulse meter object.
+ * @param offset Offset of the line.
+ * @return Average time between a rising and the next falling edge in
+ *         nanoseconds or 0 if none was measured.
+ */
+uint64_t gpiod_pulse_meter_get_high_time_ns(struct gpiod_pulse_meter *meter,
+					    unsigned int offset);
+
+/**
+ * @brief Get the average low time of a line.
+ * @param meter Pulse meter object.
+ * @param offset Offset of the line.
+ * @return Average time between a falling and the next rising edge in
+ *         nanoseconds or 0 if none was measured.
+ */
+uint64_t gpiod_pulse_meter_get_low_time_ns(struct gpiod_pulse_meter *meter,
+					   unsigned int offset);
+
+/**
+ * @}
+ *
+ * @defgroup pulse_decoder Pulse train decoding
+ * @{
+ *
+ * A pulse decoder assembles frames of bits sent as pulse trains, such as the
+ * output of Wiegand card readers, from batches of edge events. The events are
+ * decoded in C straight from the buffers read from line requests, so bursts
+ * are decoded without handling every event in the application.
+ *
+ * A pulse starts with a rising edge event and ends with the next falling edge
+ * event of its line. Idle-high signals such as Wiegand must be requested with
+ * the lines active-low and both edges detected. Two encodings are supported:
+ *
+ * - Wiegand: a pulse on the first line is a 0 bit, a pulse on the second line
+ *   a 1 bit.
+ * - Pulse width: pulses on a single line at least a threshold long are 1
+ *   bits, shorter pulses 0 bits.
+ *
+ * A frame ends once no edge was seen for the frame gap. As the end of a frame
+ * is only known when the gap has passed, the frame is completed by the first
+ * pulse of the next one or by ::gpiod_pulse_decoder_flush. Up to 64 bits of a
+ * frame are kept, the first bit received being the most significant one.
+ * Complete frames are queued in the decoder until read, the queue holds the
+ * last 32 frames.
+ *
+ * Frames carry flags describing timing errors seen while they were assembled.
+ * Checking parity bits is left to the user as it depends on the card format.
+ * All timestamps fed to a decoder must come from the same clock.
+ */
+
+/**
+ * @brief Timing errors of a decoded frame.
+ */
+enum gpiod_pulse_frame_error {
+	GPIOD_PULSE_FRAME_ERR_WIDTH = 1 << 0,
+	/**< A pulse was shorter or longer than the pulse width limits. */
+	GPIOD_PULSE_FRAME_ERR_INTERVAL = 1 << 1,
+	/**< Two pulses started closer than the minimum interval. */
+	GPIOD_PULSE_FRAME_ERR_OVERLAP = 1 << 2,
+	/**< A pulse started while a pulse on the other line was active. */
+	GPIOD_PULSE_FRAME_ERR_LOST_EDGE = 1 << 3,
+	/**< Two edges of the same type followed each other on a line. */
+	GPIOD_PULSE_FRAME_ERR_OVERFLOW = 1 << 4,
+	/**< The frame had more than 64 bits, the excess ones were dropped. */
+};
+
+/**
+ * @brief Create a new Wiegand decoder.
+ * @param data0_offset Offset of the line whose pulses are 0 bits.
+ * @param data1_offset Offset of the line whose pulses are 1 bits.
+ * @return New pulse decoder or NULL on error. Fails with EINVAL if both
+ *         offsets are the same. The returned object must be freed by the
+ *         caller using ::gpiod_pulse_decoder_free.
+ */
+struct gpiod_pulse_decoder *
+gpiod_pulse_decoder_new_wiegand(unsigned int data0_offset,
+				unsigned int data1_offset);
+
+/**
+ * @brief Create a new pulse width decoder.
+ * @param offset Offset of the line carrying the pulses.
+ * @param one_min_ns Shortest pulse decoded as a 1 bit, in nanoseconds. Must
+ *                   not be 0.
+ * @return New pulse decoder or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_pulse_decoder_free.
+ */
+struct gpiod_pulse_decoder *
+gpiod_pulse_decoder_new_pulse_width(unsigned int offset, uint64_t one_min_ns);
+
+/**
+ * @brief Free the pulse decoder and release all associated resources.
+ * @param decoder Pulse decoder to free.
+ */
+void gpiod_pulse_decoder_free(struct gpiod_pulse_decoder *decoder);
+
+/**
+ * @brief Drop the frame being assembled and all queued frames.
+ * @param decoder Pulse decoder object.
+ */
+void gpiod_pulse_decoder_reset(struct gpiod_pulse_decoder *decoder);
+
+/**
+ * @brief Set the time without edges ending a frame.
+ * @param decoder Pulse decoder object.
+ * @param gap_ns Frame gap in nanoseconds. Defaults to 25 ms.
+ */
+void gpiod_pulse_decoder_set_frame_gap_ns(struct gpiod_pulse_decoder *decoder,
+					  uint64_t gap_ns);
+
+/**
+ * @brief Set the range of valid pulse widths.
+ * @param decoder Pulse decoder object.
+ * @param min_ns Shortest valid pulse in nanoseconds.
+ * @param max_ns Longest valid pulse in nanoseconds.
+ * @return 0 on success, -1 if the minimum is greater than the maximum.
+ * @note Pulses outside of the range are still decoded but flag their frame
+ *       with ::GPIOD_PULSE_FRAME_ERR_WIDTH. All widths are valid by default.
+ */
+int
+gpiod_pulse_decoder_set_pulse_width_limits(struct gpiod_pulse_decoder *decoder,
+					   uint64_t min_ns, uint64_t max_ns);
+
+/**
+ * @brief Set the shortest valid interval between the starts of two pulses.
+ * @param decoder Pulse decoder object.
+ * @param interval_ns Minimum interval in nanoseconds. Defaults to 0.
+ * @note Closer pulses flag their frame with ::GPIOD_PULSE_FRAME_ERR_INTERVAL.
+ */
+void
+gpiod_pulse_decoder_set_min_interval_ns(struct gpiod_pulse_decoder *decoder,
+					uint64_t interval_ns);
+
+/**
+ * @brief Decode a batch of edge events.
+ * @param decoder Pulse decoder object.
+ * @param buffer Edge event buffer filled by
+ *               ::gpiod_line_request_read_edge_events.
+ * @return Number of complete frames queued in the decoder or -1 on failure.
+ * @note Events of lines other than those of the decoder are ignored. Events
+ *       must be passed in the order in which they were read.
+ */
+int gpiod_pulse_decoder_add_events(struct gpiod_pulse_decoder *decoder,
+				   struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @brief Complete the frame being assembled if the frame gap has passed.
+ * @param decoder Pulse decoder object.
+ * @param now_ns Current time on the clock of the event timestamps.
+ * @return Number of complete frames queued in the decoder.
+ */
+int gpiod_pulse_decoder_flush(struct gpiod_pulse_decoder *decoder,
+			      uint64_t now_ns);
+
+/**
+ * @brief Get the number of complete frames queued in the decoder.
+ * @param decoder Pulse decoder object.
+ * @return Number of frames that can be read.
+ */
+size_t gpiod_pulse_decoder_get_num_frames(struct gpiod_pulse_decoder *decoder);
+
+/**
+ * @brief Take the oldest complete frame off the queue.
+ * @param decoder Pulse decoder object.
+ * @param data Set to the bits of the frame, the last bit received being the
+ *             least significant one. May be NULL.
+ * @param num_bits Set to the number of bits of the frame. May be NULL.
+ * @param errors Set to the bitwise OR of the GPIOD_PULSE_FRAME_ERR_* flags
+ *               of the frame. May be NULL.
+ * @param timestamp_ns Set to the timestamp of the start of the frame. May be
+ *                     NULL.
+ * @return 1 if a frame was read, 0 if the queue is empty.
+ */
+int gpiod_pulse_decoder_read_frame(struct gpiod_pulse_decoder *decoder,
+				   uint64_t *data, unsigned int *num_bits,
+				   int *errors, uint64_t *timestamp_ns);
+
+/**
+ * @brief Get the number of frames dropped because the queue was full.
+ * @param decoder Pulse decoder object.
+ * @return Number of frames lost since the decoder was created or reset.
+ */
+unsigned long
+gpiod_pulse_decoder_get_num_lost_frames(struct gpiod_pulse_decoder *decoder);
+
+/**
+ * @}
+ *
+ * @defgroup edge_event_pipeline Edge event pipelines
+ * @{
+ *
+ * A pipeline chains processing stages which are applied to batches of edge
+ * events in place. The stages are set up once and every batch then passes
+ * through the whole chain while it's still in the cache, without the events
+ * being copied or decoded into separate objects.
+ *
+ * Stages operate on the packed records of the buffer (see
+ * ::gpiod_edge_event_buffer_get_records). Each stage may modify the records
+ * and drop some of them by moving the records it keeps to the front of the
+ * array while preserving their order. The following stages only see the
+ * records kept by the preceding ones. Column-wise views of the buffer reflect
+ * the processed events.
+ *
+ * Apart from the built-in stages, users can add stages of their own. The
+ * pipeline doesn't take ownership of any objects passed to it.
+ */
+
+/**
+ * @brief Callback implementing a pipeline stage.
+ * @param records Records of the events kept by the preceding stages.
+ * @param num_events Number of records.
+ * @param user_data Data passed when adding the stage.
+ * @return Number of records kept, which must be stored at the front of the
+ *         array. Must not be greater than num_events.
+ */
+typedef size_t
+(*gpiod_edge_event_stage_cb)(struct gpiod_edge_event_record *records,
+			     size_t num_events, void *user_data);
+
+/**
+ * @brief Create a new, empty edge event pipeline.
+ * @return New pipeline or NULL on error. The returned object must be freed by
+ *         the caller using ::gpiod_edge_event_pipeline_free.
+ */
+struct gpiod_edge_event_pipeline *gpiod_edge_event_pipeline_new(void);
+
+/**
+ * @brief Free the pipeline and release all associated resources.
+ * @param pipeline Pipeline to free.
+ */
+void gpiod_edge_event_pipeline_free(struct gpiod_edge_event_pipeline *pipeline);
+
+/**
+ * @brief Append a user-defined stage to the pipeline.
+ * @param pipeline Pipeline object.
+ * @param callback Callback processing the records.
+ * @param user_data Data passed to the callback.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if callback is NULL.
+ */
+int gpiod_edge_event_pipeline_add_stage(
+		struct gpiod_edge_event_pipeline *pipeline,
+		gpiod_edge_event_stage_cb callback, void *user_data);
+
+/**
+ * @brief Append a stage keeping only the selected edges of a line.
+ * @param pipeline Pipeline object.
+ * @param offset Offset of the line. Events of other lines are passed on.
+ * @param edge Edges of the line to keep. ::GPIOD_LINE_EDGE_NONE drops all
+ *             events of the line.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the edge value is
+ *         invalid.
+ */
+int gpiod_edge_event_pipeline_add_edge_filter(
+		struct gpiod_edge_event_pipeline *pipeline, unsigned int offset,
+		enum gpiod_line_edge edge);
+
+/**
+ * @brief Append a stage dropping the events of a line following the last
+ *        kept one closer than a minimum interval.
+ * @param pipeline Pipeline object.
+ * @param offset Offset of the line. Events of other lines are passed on.
+ * @param interval_ns Minimum interval between the kept events in nanoseconds.
+ * @return 0 on success, -1 on failure.
+ * @note The timestamp of the last kept event is carried across batches.
+ */
+int gpiod_edge_event_pipeline_add_min_interval(
+		struct gpiod_edge_event_pipeline *pipeline, unsigned int offset,
+		uint64_t interval_ns);
+
+/**
+ * @brief Append a stage feeding the events to a pulse decoder.
+ * @param pipeline Pipeline object.
+ * @param decoder Pulse decoder. It must stay valid for as long as the
+ *                pipeline is used.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if decoder is NULL.
+ * @note All events are passed on to the next stage.
+ */
+int gpiod_edge_event_pipeline_add_pulse_decoder(
+		struct gpiod_edge_event_pipeline *pipeline,
+		struct gpiod_pulse_decoder *decoder);
+
+/**
+ * @brief Get the number of stages of the pipeline.
+ * @param pipeline Pipeline object.
+ * @return Number of stages.
+ */
+size_t gpiod_edge_event_pipeline_get_num_stages(
+		struct gpiod_edge_event_pipeline *pipeline);
+
+/**
+ * @brief Get the number of events dropped by a stage.
+ * @param pipeline Pipeline object.
+ * @param stage Index of the stage in the order they were added.
+ * @return Number of events dropped since the pipeline was created or reset,
+ *         0 if there's no such stage.
+ */
+uint64_t gpiod_edge_event_pipeline_get_num_dropped(
+		struct gpiod_edge_event_pipeline *pipeline, size_t stage);
+
+/**
+ * @brief Clear the state of the built-in stages and the drop counters.
+ * @param pipeline Pipeline object.
+ * @note Pulse decoders fed by the pipeline must be reset separately.
+ */
+void gpiod_edge_event_pipeline_reset(struct gpiod_edge_event_pipeline *pipeline);
+
+/**
+ * @brief Pass the events stored in a buffer through the pipeline.
+ * @param pipeline Pipeline object.
+ * @param buffer Edge event buffer, typically just filled by
+ *               ::gpiod_line_request_read_edge_events. The events dropped by
+ *               the stages are removed from it.
+ * @return Number of events left in the buffer, -1 on failure. Fails with
+ *         EINVAL if buffer is NULL.
+ */
+int gpiod_edge_event_pipeline_process(
+		struct gpiod_edge_event_pipeline *pipeline,
+		struct gpiod_edge_event_buffer *buffer);
+
+/**
+ * @}
+ *
+ * @defgroup bitbang Bit-banged serial output
+ * @{
+ *
+ * A bit-bang engine shifts a byte stream out on lines of a single request
+ * acting as a clock, one or more data lines and an optional latch, as used
+ * by shift registers such as the 74HC595 or by LED drivers.
+ *
+ * Data is set up while the clock is at its idle level and sampled on the
+ * edge leaving it. With several data lines, each clock cycle carries one bit
+ * per line: the n-th data line gets bit n of the cycle, taken from the stream
+ * in transfer order, and the last cycle is padded with zeroes. After the last
+ * cycle, the clock returns to idle and the latch, if any, is pulsed active.
+ *
+ * Each write to the lines is a single ::gpiod_line_request_set_values_mask
+ * call updating the data lines together with the clock, so a transfer takes
+ * at most two system calls per clock cycle plus one or two to finish.
+ *
+ * Line values are logical - the polarity of the data and latch lines is
+ * chosen with the active-low setting of the request. The lines must be
+ * requested as outputs. Writes run in the calling thread; by default the
+ * lines are toggled as fast as the system allows.
+ */
+
+/**
+ * @brief Create a new bit-bang engine.
+ * @param request Line request owning all lines driven by the engine. Must
+ *                outlive the engine.
+ * @return New engine or NULL on error. The returned object must be freed by
+ *         the caller using ::gpiod_bitbang_free.
+ */
+struct gpiod_bitbang *gpiod_bitbang_new(struct gpiod_line_request *request);
+
+/**
+ * @brief Free the bit-bang engine and release all associated resources.
+ * @param bb Bit-bang engine to free.
+ */
+void gpiod_bitbang_free(struct gpiod_bitbang *bb);
+
+/**
+ * @brief Set the clock line.
+ * @param bb Bit-bang engine.
+ * @param offset Offset of the clock line.
+ * @param idle Level of the clock between cycles. Data is sampled on the
+ *             transition to the opposite level.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the line is not
+ *         part of the request.
+ */
+int gpiod_bitbang_set_clock(struct gpiod_bitbang *bb, unsigned int offset,
+			    enum gpiod_line_value idle);
+
+/**
+ * @brief Set the data lines.
+ * @param bb Bit-bang engine.
+ * @param offsets Offsets of the data lines in the order in which they take
+ *                the bits of a clock cycle.
+ * @param num_offsets Number of data lines. Must be between 1 and 63.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if a line is not
+ *         part of the request or is listed twice.
+ */
+int gpiod_bitbang_set_data_lines(struct gpiod_bitbang *bb,
+				 const unsigned int *offsets,
+				 size_t num_offsets);
+
+/**
+ * @brief Set the latch line.
+ * @param bb Bit-bang engine.
+ * @param offset Offset of the latch line.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the line is not
+ *         part of the request.
+ * @note The latch is kept inactive during the transfer and pulsed active
+ *       once after it.
+ */
+int gpiod_bitbang_set_latch(struct gpiod_bitbang *bb, unsigned int offset);
+
+/**
+ * @brief Stop using a latch line.
+ * @param bb Bit-bang engine.
+ */
+void gpiod_bitbang_clear_latch(struct gpiod_bitbang *bb);
+
+/**
+ * @brief Set the order in which the bits of each byte are shifted out.
+ * @param bb Bit-bang engine.
+ * @param lsb_first True to start with the least significant bit, false to
+ *                  start with the most significant one (the default).
+ */
+void gpiod_bitbang_set_lsb_first(struct gpiod_bitbang *bb, bool lsb_first);
+
+/**
+ * @brief Set the minimum time between consecutive writes to the lines.
+ * @param bb Bit-bang engine.
+ * @param interval_ns Interval in nanoseconds, half of the clock period. 0,
+ *                    the default, writes without waiting.
+ * @note Writes are scheduled at multiples of the interval from the start of
+ *       the transfer, so a late write doesn't delay the following ones. The
+ *       interval is a lower bound - the actual timing depends on the
+ *       scheduler.
+ */
+void gpiod_bitbang_set_edge_interval_ns(struct gpiod_bitbang *bb,
+					uint64_t interval_ns);
+
+/**
+ * @brief Get the minimum time between consecutive writes to the lines.
+ * @param bb Bit-bang engine.
+ * @return Interval in nanoseconds.
+ */
+uint64_t gpiod_bitbang_get_edge_interval_ns(struct gpiod_bitbang *bb);
+
+/**
+ * @brief Get the number of line writes needed to transfer a stream.
+ * @param bb Bit-bang engine.
+ * @param num_bytes Length of the stream in bytes.
+ * @return Number of ::gpiod_line_request_set_values_mask calls a transfer
+ *         of this length makes with the current settings. Calls leaving all
+ *         lines unchanged don't reach the kernel, so this is an upper bound
+ *         on the number of system calls.
+ */
+size_t gpiod_bitbang_get_num_writes(struct gpiod_bitbang *bb,
+				    size_t num_bytes);
+
+/**
+ * @brief Shift a byte stream out.
+ * @param bb Bit-bang engine.
+ * @param data Bytes to transfer.
+ * @param num_bytes Number of bytes to transfer.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the clock or the
+ *         data lines are not set or if the roles of the lines overlap. On
+ *         failure, the lines may be left in the middle of the transfer.
+ */
+int gpiod_bitbang_write(struct gpiod_bitbang *bb, const unsigned char *data,
+			size_t num_bytes);
+
+/**
+ * @}
+ *
+ * @defgroup bus_sampler Clocked bus sampling
+ * @{
+ *
+ * A bus sampler receives data from devices driving a parallel or serial bus
+ * together with a clock: the data lines are sampled on each edge of the clock
+ * and the levels are packed into words stored in a ring buffer.
+ *
+ * The clock and the data lines are requested together, the data lines with
+ * both edges detected. The level of the data lines is tracked from their edge
+ * events, interleaved with the clock edges in the event stream, so sampling
+ * takes no system calls beyond reading the events - a single read handles
+ * every clock edge the kernel has buffered. The data lines are only read
+ * directly when the request is made and after the kernel dropped events.
+ *
+ * Bit n of a word is the level of the n-th data line at the time of the clock
+ * edge. A data line changing at about the same time as the clock is sampled
+ * at the level its last event reported before the clock event. Missed clock
+ * edges are detected from the sequence numbers of the clock events.
+ */
+
+/**
+ * @brief Request the lines of a bus for sampling.
+ * @param chip GPIO chip object.
+ * @param req_cfg Request config object. Can be NULL for default settings.
+ *                The size of the kernel event buffer limits the number of
+ *                clock edges buffered between calls to
+ *                ::gpiod_bus_sampler_sample.
+ * @param settings Line settings applied to all lines, such as the bias or
+ *                 the active-low setting. Can be NULL for default settings.
+ *                 The direction and the edge detection are overridden.
+ * @param clock_offset Offset of the clock line.
+ * @param clock_edge Clock edges on which the data lines are sampled.
+ * @param data_offsets Offsets of the data lines in word bit order.
+ * @param num_data Number of data lines. Must be between 1 and 63.
+ * @param ring_size Number of words the ring buffer holds.
+ * @return New bus sampler or NULL on error. The sampler must be released by
+ *         the caller using ::gpiod_bus_sampler_release.
+ */
+struct gpiod_bus_sampler *
+gpiod_chip_request_bus_sampler(struct gpiod_chip *chip,
+			       struct gpiod_request_config *req_cfg,
+			       struct gpiod_line_settings *settings,
+			       unsigned int clock_offset,
+			       enum gpiod_line_edge clock_edge,
+			       const unsigned int *data_offsets,
+			       size_t num_data, size_t ring_size);
+
+/**
+ * @brief Release the lines of the bus and free all associated resources.
+ * @param sampler Bus sampler to release.
+ */
+void gpiod_bus_sampler_release(struct gpiod_bus_sampler *sampler);
+
+/**
+ * @brief Get the file descriptor signalling pending clock edges.
+ * @param sampler Bus sampler object.
+ * @return File descriptor of the underlying line request, suitable for
+ *         polling.
+ */
+int gpiod_bus_sampler_get_fd(struct gpiod_bus_sampler *sampler);
+
+/**
+ * @brief Wait for edge events on the bus lines.
+ * @param sampler Bus sampler object.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks indefinitely until an event becomes
+ *                   available.
+ * @return 0 if wait timed out, -1 if an error occurred, 1 if an event is
+ *         pending.
+ */
+int gpiod_bus_sampler_wait(struct gpiod_bus_sampler *sampler,
+			   int64_t timeout_ns);
+
+/**
+ * @brief Process the edge events buffered by the kernel.
+ * @param sampler Bus sampler object.
+ * @return Number of words sampled and stored in the ring buffer, which may be
+ *         0 if only the data lines changed, or -1 on failure.
+ * @note Blocks until at least one event is available unless the request is
+ *       non-blocking.
+ */
+int gpiod_bus_sampler_sample(struct gpiod_bus_sampler *sampler);
+
+/**
+ * @brief Get the number of words in the ring buffer.
+ * @param sampler Bus sampler object.
+ * @return Number of words available to ::gpiod_bus_sampler_read_words.
+ */
+size_t gpiod_bus_sampler_get_num_words(struct gpiod_bus_sampler *sampler);
+
+/**
+ * @brief Take words out of the ring buffer.
+ * @param sampler Bus sampler object.
+ * @param words Array receiving the words, oldest first.
+ * @param max_words Maximum number of words to take.
+ * @return Number of words stored in \p words.
+ */
+size_t gpiod_bus_sampler_read_words(struct gpiod_bus_sampler *sampler,
+				    uint64_t *words, size_t max_words);
+
+/**
+ * @brief Get the number of clock edges the kernel dropped.
+ * @param sampler Bus sampler object.
+ * @return Cumulative number of clock edges for which no word was sampled.
+ * @note Drops are detected from the next clock event following them. The
+ *       level of data lines whose events were dropped with them is read anew
+ *       and may be off for the words sampled until the lines change again.
+ */
+uint64_t
+gpiod_bus_sampler_get_num_missed_clocks(struct gpiod_bus_sampler *sampler);
+
+/**
+ * @brief Get the number of words lost to a full ring buffer.
+ * @param sampler Bus sampler object.
+ * @return Cumulative number of words overwritten before they were read. A
+ *         full ring drops its oldest words.
+ */
+uint64_t gpiod_bus_sampler_get_num_overruns(struct gpiod_bus_sampler *sampler);
+
+/**
+ * @}
+ *
+ * @defgroup line_monitor Adaptive input monitoring
+ * @{
+ *
+ * A line monitor reports the changes of input lines as a single stream while
+ * choosing, for every line, how the changes are detected. Lines changing
+ * rarely are watched with edge events, which cost nothing while the line is
+ * idle. Lines changing more often than once per sample period are sampled
+ * with a periodic read of their values instead, as a read of all sampled lines
+ * then costs less than the events it replaces. Lines whose edges the chip
+ * can't detect are always sampled.
+ *
+ * The rate of the changes is evaluated over windows of at least 16 sample
+ * periods. A line seeing edge events more than once per sample period on
+ * average is switched to sampling, a sampled line changing less than once per
+ * 4 sample periods is switched back to edge events. Switching reconfigures the
+ * request. The
+ * level of lines switched to edge events is read right away so that changes
+ * made during the switch aren't lost. Changes sampled are timestamped with the
+ * time of the read and changes of less than a sample period may go unnoticed.
+ *
+ * All timestamps come from the monotonic clock.
+ */
+
+/**
+ * @brief Ways the changes of a monitored line are detected.
+ */
+enum gpiod_line_monitor_mode {
+	GPIOD_LINE_MONITOR_MODE_EVENTS = 1,
+	/**< Edge events. */
+	GPIOD_LINE_MONITOR_MODE_SAMPLING,
+	/**< Periodic reads of the line value. */
+};
+
+/**
+ * @brief Change of a monitored line.
+ */
+struct gpiod_line_monitor_change {
+	uint64_t timestamp_ns;
+	/**< Time of the change on the monotonic clock in nanoseconds. */
+	uint32_t offset;
+	/**< Offset of the line. */
+	uint32_t value;
+	/**< Value of ::gpiod_line_value the line changed to. */
+	uint32_t mode;
+	/**< Value of ::gpiod_line_monitor_mode which detected the change. */
+	uint32_t reserved;
+	/**< Reserved for future use. */
+};
+
+/**
+ * @brief Request lines for adaptive monitoring.
+ * @param chip GPIO chip object.
+ * @param req_cfg Request config object. Can be NULL for default settings.
+ * @param settings Line settings applied to all lines, such as the bias, the
+ *                 active-low setting or the debounce period. Can be NULL for
+ *                 default settings. The direction, the edge detection and the
+ *                 event clock are overridden.
+ * @param offsets Offsets of the lines to monitor.
+ * @param num_offsets Number of lines.
+ * @param sample_period_ns Period of the reads of the sampled lines in
+ *                         nanoseconds. Must not be 0.
+ * @param ring_size Number of changes the ring buffer holds.
+ * @return New line monitor or NULL on error. The monitor must be released by
+ *         the caller using ::gpiod_line_monitor_release.
+ * @note All lines start with edge events. If the chip refuses edge detection,
+ *       every line is probed and those whose edges can't be detected are
+ *       sampled.
+ */
+struct gpiod_line_monitor *
+gpiod_chip_request_line_monitor(struct gpiod_chip *chip,
+				struct gpiod_request_config *req_cfg,
+				struct gpiod_line_settings *settings,
+				const unsigned int *offsets, size_t num_offsets,
+				uint64_t sample_period_ns, size_t ring_size);
+
+/**
+ * @brief Release the monitored lines and free all associated resources.
+ * @param monitor Line monitor to release.
+ */
+void gpiod_line_monitor_release(struct gpiod_line_monitor *monitor);
+
+/**
+ * @brief Get the file descriptor signalling pending work.
+ * @param monitor Line monitor object.
+ * @return File descriptor which becomes readable when edge events are pending
+ *         or the sampled lines are due to be read, suitable for polling.
+ */
+int gpiod_line_monitor_get_fd(struct gpiod_line_monitor *monitor);
+
+/**
+ * @brief Wait for edge events or the next sample period.
+ * @param monitor Line monitor object.
+ * @param timeout_ns Wait time limit in nanoseconds. If set to 0, the function
+ *                   returns immediately. If set to a negative number, the
+ *                   function blocks until there is work pending.
+ * @return 0 if wait timed out, -1 if an error occurred, 1 if there is work
+ *         pending.
+ */
+int gpiod_line_monitor_wait(struct gpiod_line_monitor *monitor,
+			    int64_t timeout_ns);
+
+/**
+ * @brief Read the pending edge events and the sampled lines if they're due.
+ * @param monitor Line monitor object.
+ * @return Number of changes stored in the ring buffer or -1 on failure.
+ * @note Never blocks. Lines are switched between edge events and sampling
+ *       from within this function.
+ */
+int gpiod_line_monitor_process(struct gpiod_line_monitor *monitor);
+
+/**
+ * @brief Get the number of changes in the ring buffer.
+ * @param monitor Line monitor object.
+ * @return Number of changes available to ::gpiod_line_monitor_read_changes.
+ */
+size_t gpiod_line_monitor_get_num_changes(struct gpiod_line_monitor *monitor);
+
+/**
+ * @brief Take changes out of the ring buffer.
+ * @param monitor Line monitor object.
+ * @param changes Array receiving the changes, oldest first.
+ * @param max_changes Maximum number of changes to take.
+ * @return Number of changes stored in \p changes.
+ */
+size_t
+gpiod_line_monitor_read_changes(struct gpiod_line_monitor *monitor,
+				struct gpiod_line_monitor_change *changes,
+				size_t max_changes);
+
+/**
+ * @brief Get the way the changes of a line are currently detected.
+ * @param monitor Line monitor object.
+ * @param offset Offset of the line.
+ * @return Current mode of the line or -1 if the line isn't monitored, in which
+ *         case errno is set to EINVAL.
+ */
+int gpiod_line_monitor_get_mode(struct gpiod_line_monitor *monitor,
+				unsigned int offset);
+
+/**
+ * @brief Get the number of times lines were switched between the modes.
+ * @param monitor Line monitor object.
+ * @return Cumulative number of reconfigurations of the request.
+ */
+uint64_t gpiod_line_monitor_get_num_switches(struct gpiod_line_monitor *monitor);
+
+/**
+ * @brief Get the number of changes lost to a full ring buffer.
+ * @param monitor Line monitor object.
+ * @return Cumulative number of changes overwritten before they were read. A
+ *         full ring drops its oldest changes.
+ */
+uint64_t
+gpiod_line_monitor_get_num_overruns(struct gpiod_line_monitor *monitor);
+
+/**
+ * @}
+ *
+ * @defgroup stats I/O statistics
+ * @{
+ *
+ * Chips and line requests count the system calls they make, the amount of
+ * data they read and the time spent in the kernel and waiting for events.
+ * The counters are always on - timing an ioctl takes two reads of the
+ * monotonic clock, which don't enter the kernel on common architectures.
+ *
+ * Statistics are retrieved as snapshots which don't change afterwards. The
+ * ioctls are grouped by type: reading line values, setting line values,
+ * configuring lines - including requesting them - and reading or watching
+ * chip and line info. Failed ioctls are counted and timed as well.
+ */
+
+/**
+ * @brief Free the statistics snapshot.
+ * @param stats Statistics snapshot to free.
+ */
+void gpiod_stats_free(struct gpiod_stats *stats);
 
 /**
- * @brief Free the edge event buffer and release all associated resources.
- * @param buffer Edge event buffer to free.
+ * @brief Get the number of ioctls reading line values.
+ * @param stats Statistics snapshot.
+ * @return Number of calls.
  */
-void gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer);
+uint64_t gpiod_stats_get_num_get_ioctls(struct gpiod_stats *stats);
 
 /**
- * @brief Get an event stored in the buffer.
- * @param buffer Edge event buffer.
- * @param index Index of the event in the buffer.
- * @return Pointer to an event stored in the buffer. The lifetime of the
- *         event is tied to the buffer object. Users must not free the event
- *         returned by this function.
+ * @brief Get the number of ioctls setting line values.
+ * @param stats Statistics snapshot.
+ * @return Number of calls.
  */
-struct gpiod_edge_event *
-gpiod_edge_event_buffer_get_event(struct gpiod_edge_event_buffer *buffer,
-				  unsigned long index);
+uint64_t gpiod_stats_get_num_set_ioctls(struct gpiod_stats *stats);
 
 /**
- * @brief Get the number of events a buffer has stored.
- * @param buffer Edge event buffer.
- * @return Number of events stored in the buffer.
+ * @brief Get the number of ioctls requesting or reconfiguring lines.
+ * @param stats Statistics snapshot.
+ * @return Number of calls.
  */
-size_t
-gpiod_edge_event_buffer_get_num_events(struct gpiod_edge_event_buffer *buffer);
+uint64_t gpiod_stats_get_num_config_ioctls(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the number of ioctls reading or watching chip and line info.
+ * @param stats Statistics snapshot.
+ * @return Number of calls.
+ */
+uint64_t gpiod_stats_get_num_info_ioctls(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the number of reads returning events.
+ * @param stats Statistics snapshot.
+ * @return Number of read() calls which returned edge events for requests or
+ *         info events for chips.
+ */
+uint64_t gpiod_stats_get_num_reads(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the number of events read.
+ * @param stats Statistics snapshot.
+ * @return Number of events.
+ */
+uint64_t gpiod_stats_get_num_events_read(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the number of bytes read.
+ * @param stats Statistics snapshot.
+ * @return Number of bytes.
+ */
+uint64_t gpiod_stats_get_num_bytes_read(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the total time spent in ioctls.
+ * @param stats Statistics snapshot.
+ * @return Cumulative time in nanoseconds.
+ */
+uint64_t gpiod_stats_get_ioctl_time_ns(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the time taken by the slowest ioctl.
+ * @param stats Statistics snapshot.
+ * @return Time in nanoseconds.
+ * @note For line value ioctls, a high value relative to the average usually
+ *       points at a chip behind a slow bus, such as an I2C expander.
+ */
+uint64_t gpiod_stats_get_max_ioctl_time_ns(struct gpiod_stats *stats);
+
+/**
+ * @brief Get the total time spent waiting for events.
+ * @param stats Statistics snapshot.
+ * @return Cumulative time in nanoseconds spent in the functions waiting for
+ *         edge events or info events.
+ */
+uint64_t gpiod_stats_get_wait_time_ns(struct gpiod_stats *stats);
+
+/**
+ * @}
+ *
+ * @defgroup latency_histogram Edge event latency histograms
+ * @{
+ *
+ * Requests made with ::gpiod_request_config_set_latency_histogram record how
+ * long edge events waited between being timestamped by the kernel and being
+ * read, separately for each line. The clocks are read once per batch of events
+ * so the overhead doesn't grow with the number of events read at once.
+ *
+ * The latencies are bucketed by their power of two, each split into four
+ * linear steps. Reported percentiles are the upper bound of their bucket and
+ * are within 25% of the exact value, clamped to the minimum and maximum seen.
+ */
+
+/**
+ * @brief Free the histogram snapshot.
+ * @param hist Histogram snapshot to free.
+ */
+void gpiod_latency_histogram_free(struct gpiod_latency_histogram *hist);
+
+/**
+ * @brief Get the number of recorded events.
+ * @param hist Histogram snapshot.
+ * @return Number of latency samples.
+ */
+uint64_t
+gpiod_latency_histogram_get_num_samples(struct gpiod_latency_histogram *hist);
+
+/**
+ * @brief Get the lowest recorded latency.
+ * @param hist Histogram snapshot.
+ * @return Latency in nanoseconds or 0 if nothing was recorded.
+ */
+uint64_t
+gpiod_latency_histogram_get_min_ns(struct gpiod_latency_histogram *hist);
+
+/**
+ * @brief Get the highest recorded latency.
+ * @param hist Histogram snapshot.
+ * @return Latency in nanoseconds or 0 if nothing was recorded.
+ */
+uint64_t
+gpiod_latency_histogram_get_max_ns(struct gpiod_latency_histogram *hist);
+
+/**
+ * @brief Get the mean of the recorded latencies.
+ * @param hist Histogram snapshot.
+ * @return Latency in nanoseconds or 0 if nothing was recorded.
+ */
+uint64_t
+gpiod_latency_histogram_get_mean_ns(struct gpiod_latency_histogram *hist);
+
+/**
+ * @brief Get a percentile of the recorded latencies.
+ * @param hist Histogram snapshot.
+ * @param percentile Percentile to get, between 0 and 100.
+ * @return Latency in nanoseconds below or at which the given percentage of the
+ *         samples lie, or 0 if nothing was recorded.
+ */
+uint64_t
+gpiod_latency_histogram_get_percentile_ns(struct gpiod_latency_histogram *hist,
+					  double percentile);
+
+/**
+ * @}
+ *
+ * @defgroup edge_stats Edge event statistics
+ * @{
+ *
+ * Requests made with ::gpiod_request_config_set_edge_stats count the edge
+ * events of every line as they are read and keep track of the intervals
+ * between them, so that chattering inputs can be spotted without passing the
+ * events up to the application. Events are counted before any filtering done
+ * by the library, including software debouncing.
+ *
+ * The intervals are measured between the kernel timestamps of consecutive
+ * events on the same line and bucketed by their power of two. The rate is
+ * derived from a moving average of the intervals in which every new interval
+ * has a weight of 1/8.
+ */
+
+/**
+ * @brief Free the edge statistics snapshot.
+ * @param stats Edge statistics snapshot to free.
+ */
+void gpiod_edge_stats_free(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the number of rising edge events.
+ * @param stats Edge statistics snapshot.
+ * @return Number of rising edge events read.
+ */
+uint64_t gpiod_edge_stats_get_num_rising(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the number of falling edge events.
+ * @param stats Edge statistics snapshot.
+ * @return Number of falling edge events read.
+ */
+uint64_t gpiod_edge_stats_get_num_falling(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the number of measured intervals between events.
+ * @param stats Edge statistics snapshot.
+ * @return Number of intervals, one less than the number of events.
+ */
+uint64_t gpiod_edge_stats_get_num_intervals(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the shortest interval between two events.
+ * @param stats Edge statistics snapshot.
+ * @return Interval in nanoseconds or 0 if none was measured.
+ */
+uint64_t gpiod_edge_stats_get_min_interval_ns(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the moving average of the intervals between events.
+ * @param stats Edge statistics snapshot.
+ * @return Interval in nanoseconds or 0 if none was measured.
+ */
+uint64_t gpiod_edge_stats_get_avg_interval_ns(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the recent event rate.
+ * @param stats Edge statistics snapshot.
+ * @return Events per second derived from the moving average of the intervals
+ *         or 0 if no interval was measured.
+ */
+double gpiod_edge_stats_get_rate(struct gpiod_edge_stats *stats);
+
+/**
+ * @brief Get the number of intervals in a histogram bucket.
+ * @param stats Edge statistics snapshot.
+ * @param bucket Bucket index. Bucket N counts the intervals of at least 2^N
+ *               and less than 2^(N+1) nanoseconds, bucket 0 also counts the
+ *               intervals of 0 ns.
+ * @return Number of intervals in the bucket, 0 for indices above 63.
+ */
+uint64_t gpiod_edge_stats_get_interval_count(struct gpiod_edge_stats *stats,
+					     unsigned int bucket);
+
+/**
+ * @}
+ *
+ * @defgroup clock_converter Event clock conversion
+ * @{
+ *
+ * A clock converter maps timestamps taken with one event clock onto another,
+ * for instance monotonic edge event timestamps onto wall-clock time. The
+ * offset between the clocks is measured once and then reused for whole batches
+ * of timestamps, turning every conversion into an addition. The offset is
+ * measured again once it gets older than the refresh interval so that steps
+ * of the realtime clock are picked up.
+ *
+ * The hardware timestamp engine can't be read from user space so the offset
+ * of its timestamps can't be measured this way. Calibrated converters learn
+ * the offset from pairs of timestamps of the same edges instead, taken with
+ * both clocks, for instance on two lines fed the same signal.
+ */
+
+/**
+ * @brief Create a new clock converter.
+ * @param from Clock the timestamps to convert were taken with.
+ * @param to Clock to convert the timestamps to.
+ * @return New clock converter or NULL on error. Fails with ENOTSUP if either
+ *         clock is ::GPIOD_LINE_CLOCK_HTE. The returned object must be freed
+ *         by the caller using ::gpiod_clock_converter_free.
+ * @note The offset is refreshed every second by default.
+ */
+struct gpiod_clock_converter *
+gpiod_clock_converter_new(enum gpiod_line_clock from, enum gpiod_line_clock to);
+
+/**
+ * @brief Create a new clock converter calibrated from pairs of timestamps.
+ * @param from Clock the timestamps to convert were taken with.
+ * @param to Clock to convert the timestamps to.
+ * @return New clock converter or NULL on error. The returned object must be
+ *         freed by the caller using ::gpiod_clock_converter_free.
+ * @note Any clocks, including ::GPIOD_LINE_CLOCK_HTE, are accepted. The
+ *	 clocks are never read: the offset is 0 until the first pair is added
+ *	 with ::gpiod_clock_converter_add_pair and ::gpiod_clock_converter_refresh
+ *	 has no effect.
+ */
+struct gpiod_clock_converter *
+gpiod_clock_converter_new_calibrated(enum gpiod_line_clock from,
+				     enum gpiod_line_clock to);
+
+/**
+ * @brief Free the clock converter.
+ * @param conv Clock converter to free.
+ */
+void gpiod_clock_converter_free(struct gpiod_clock_converter *conv);
+
+/**
+ * @brief Set how old the offset may get before it's measured again.
+ * @param conv Clock converter.
+ * @param interval_ns Refresh interval in nanoseconds. 0 disables the automatic
+ *		      refresh.
+ */
+void gpiod_clock_converter_set_refresh_interval_ns(
+		struct gpiod_clock_converter *conv, uint64_t interval_ns);
+
+/**
+ * @brief Get the refresh interval of the offset.
+ * @param conv Clock converter.
+ * @return Refresh interval in nanoseconds, 0 if disabled.
+ */
+uint64_t gpiod_clock_converter_get_refresh_interval_ns(
+		struct gpiod_clock_converter *conv);
+
+/**
+ * @brief Measure the offset between the clocks now.
+ * @param conv Clock converter.
+ */
+void gpiod_clock_converter_refresh(struct gpiod_clock_converter *conv);
+
+/**
+ * @brief Calibrate the converter with the timestamps of an edge.
+ * @param conv Calibrated clock converter.
+ * @param from_ns Timestamp of the edge taken with the source clock.
+ * @param to_ns Timestamp of the same edge taken with the target clock.
+ * @return 0 on success, -1 on failure. Fails with EINVAL if the converter
+ *	   wasn't created with ::gpiod_clock_converter_new_calibrated.
+ * @note The target timestamps are assumed to be late by a varying latency,
+ *	 as for timestamps taken in software. The smallest difference seen
+ *	 becomes the offset and the spread of the differences the error bound.
+ */
+int gpiod_clock_converter_add_pair(struct gpiod_clock_converter *conv,
+				   uint64_t from_ns, uint64_t to_ns);
+
+/**
+ * @brief Get the number of timestamp pairs the converter was calibrated with.
+ * @param conv Clock converter.
+ * @return Number of pairs added, always 0 for converters measuring the offset
+ *	   by reading the clocks.
+ */
+uint64_t gpiod_clock_converter_get_num_pairs(struct gpiod_clock_converter *conv);
+
+/**
+ * @brief Convert a batch of timestamps.
+ * @param conv Clock converter.
+ * @param timestamps Timestamps to convert, in nanoseconds.
+ * @param converted Buffer for the converted timestamps, may be the same as
+ *		    timestamps to convert in place.
+ * @param num_timestamps Number of timestamps to convert.
+ * @note The offset is refreshed before the conversion if it's older than the
+ *	 refresh interval. All timestamps of a batch use the same offset.
+ */
+void gpiod_clock_converter_convert(struct gpiod_clock_converter *conv,
+				   const uint64_t *timestamps,
+				   uint64_t *converted, size_t num_timestamps);
+
+/**
+ * @brief Convert a single timestamp.
+ * @param conv Clock converter.
+ * @param timestamp Timestamp to convert, in nanoseconds.
+ * @return Converted timestamp in nanoseconds.
+ */
+uint64_t gpiod_clock_converter_convert_one(struct gpiod_clock_converter *conv,
+					   uint64_t timestamp);
+
+/**
+ * @brief Get the offset currently used for the conversion.
+ * @param conv Clock converter.
+ * @return Nanoseconds added to the timestamps.
+ */
+int64_t gpiod_clock_converter_get_offset_ns(struct gpiod_clock_converter *conv);
+
+/**
+ * @brief Get the error bound of the current offset.
+ * @param conv Clock converter.
+ * @return Maximum error of the offset in nanoseconds, as measured at the last
+ *	   refresh or calibrated from the pairs added. Drift between the clocks
+ *	   since then comes on top.
+ */
+uint64_t gpiod_clock_converter_get_error_ns(struct gpiod_clock_converter *conv);
+
+/**
+ * @}
+ *
+ * @defgroup wait_cancel Cancellable waits
+ * @{
+ *
+ * A cancellation object wraps an eventfd that can be watched together with a
+ * chip or a line request by the cancellable wait functions. Triggering it from
+ * any thread, or from a signal handler, wakes up all waits using it. The
+ * object stays triggered until it is reset.
+ */
+
+/**
+ * @brief Create a new cancellation object.
+ * @return New cancellation object or NULL on error. The returned object must
+ *         be freed by the caller using ::gpiod_wait_cancel_free.
+ */
+struct gpiod_wait_cancel *gpiod_wait_cancel_new(void);
+
+/**
+ * @brief Free the cancellation object and release its file descriptor.
+ * @param cancel Cancellation object.
+ */
+void gpiod_wait_cancel_free(struct gpiod_wait_cancel *cancel);
+
+/**
+ * @brief Cancel all current and future waits using this object.
+ * @param cancel Cancellation object.
+ * @return 0 on success, -1 on failure.
+ * @note This function is async-signal-safe.
+ */
+int gpiod_wait_cancel_trigger(struct gpiod_wait_cancel *cancel);
+
+/**
+ * @brief Clear the triggered state of the cancellation object.
+ * @param cancel Cancellation object.
+ * @return 0 on success, -1 on failure.
+ */
+int gpiod_wait_cancel_reset(struct gpiod_wait_cancel *cancel);
+
+/**
+ * @brief Check whether the cancellation object was triggered.
+ * @param cancel Cancellation object.
+ * @return True if triggered and not reset since, false otherwise.
+ */
+bool gpiod_wait_cancel_is_triggered(struct gpiod_wait_cancel *cancel);
+
+/**
+ * @brief Get the file descriptor of the cancellation object.
+ * @param cancel Cancellation object.
+ * @return Eventfd that becomes readable once the object is triggered. The
+ *         file descriptor is owned by the object and must not be closed by
+ *         the caller.
+ */
+int gpiod_wait_cancel_get_fd(struct gpiod_wait_cancel *cancel);
+
+/**
+ * @}
+ *
+ * @defgroup thread_attr Thread scheduling attributes
+ * @{
+ *
+ * Latency-sensitive threads can be made to run with a real-time scheduling
+ * policy, pinned to a CPU and with the process memory locked so that they
+ * aren't preempted by ordinary load or delayed by page faults. A thread
+ * attribute object collects these settings. It can be applied directly to the
+ * calling thread or passed to the event loop, the waveform player and the
+ * software PWM which apply it to the threads they run in.
+ *
+ * Real-time scheduling and memory locking usually require privileges
+ * (CAP_SYS_NICE and CAP_IPC_LOCK respectively) or suitable resource limits.
+ */
+
+/**
+ * @brief Create a new thread attribute object.
+ * @return New thread attribute object or NULL on error. The returned object
+ *         must be freed by the caller using ::gpiod_thread_attr_free.
+ *
+ * By default, none of the settings is changed when the attributes are applied.
+ */
+struct gpiod_thread_attr *gpiod_thread_attr_new(void);
+
+/**
+ * @brief Free the thread attribute object.
+ * @param attr Thread attribute object.
+ */
+void gpiod_thread_attr_free(struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Make the thread run with the SCHED_FIFO policy.
+ * @param attr Thread attribute object.
+ * @param priority Real-time priority or 0 to keep the policy unchanged.
+ * @return 0 on success, -1 if the priority is out of the range supported by
+ *         SCHED_FIFO.
+ */
+int gpiod_thread_attr_set_realtime(struct gpiod_thread_attr *attr,
+				   int priority);
+
+/**
+ * @brief Get the real-time priority.
+ * @param attr Thread attribute object.
+ * @return SCHED_FIFO priority or 0 if the policy is left unchanged.
+ */
+int gpiod_thread_attr_get_realtime(struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Pin the thread to a CPU.
+ * @param attr Thread attribute object.
+ * @param cpu Number of the CPU or a negative number to keep the affinity
+ *            unchanged.
+ * @return 0 on success, -1 if the CPU number is out of range.
+ */
+int gpiod_thread_attr_set_cpu(struct gpiod_thread_attr *attr, int cpu);
+
+/**
+ * @brief Get the CPU the thread is pinned to.
+ * @param attr Thread attribute object.
+ * @return Number of the CPU or -1 if the affinity is left unchanged.
+ */
+int gpiod_thread_attr_get_cpu(struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Lock all current and future memory of the process.
+ * @param attr Thread attribute object.
+ * @param lock True to lock the memory with mlockall() when the attributes
+ *             are applied.
+ */
+void gpiod_thread_attr_set_lock_memory(struct gpiod_thread_attr *attr,
+				       bool lock);
+
+/**
+ * @brief Check whether the memory is locked when the attributes are applied.
+ * @param attr Thread attribute object.
+ * @return True if the memory is locked, false otherwise.
+ */
+bool gpiod_thread_attr_get_lock_memory(struct gpiod_thread_attr *attr);
+
+/**
+ * @brief Apply the attributes to the calling thread.
+ * @param attr Thread attribute object.
+ * @return 0 on success, -1 on failure. Settings applied before the failing
+ *         one stay in effect.
+ */
+int gpiod_thread_attr_apply(struct gpiod_thread_attr *attr);
+
+/**
+ * @}
+ *
+ * @defgroup mock Mock chips
+ * @{
+ *
+ * Mock chips exist only within the process and are served by the library
+ * instead of the kernel. They are meant for measuring the overhead of the
+ * library and of the bindings without gpio-sim. The backend is only compiled
+ * in when the library is configured with --enable-mock-backend, otherwise all
+ * functions creating or modifying mock chips fail with errno set to ENOTSUP.
+ *
+ * A mock chip is opened with ::gpiod_chip_open by its path. Its lines can be
+ * requested, read, driven and reconfigured as usual. The physical level of an
+ * input line is set with ::gpiod_mock_chip_set_value. A line with an event
+ * rate toggles at a fixed interval, starting from the time the rate or the
+ * level was last set. The edge events of the toggles are computed when the
+ * request is read and the file descriptor of the request becomes readable
+ * whenever an event is due, so the events are delivered as if the kernel
+ * queued them. A request falling more than an event buffer's worth of events
+ * behind a line loses the oldest ones, which shows as gaps in the sequence
+ * numbers.
+ *
+ * Bias, drive and debounce settings are accepted and ignored. Line info
+ * watches, hardware timestamps and requests with a maximum event buffer size
+ * are not supported. Lines are unnamed.
+ */
+
+/**
+ * @brief Create a new mock chip.
+ * @param num_lines Number of lines of the chip.
+ * @return New mock chip or NULL on error. The returned object must be freed
+ *         by the caller using ::gpiod_mock_chip_free.
+ *
+ * All lines are inputs at the inactive physical level and don't toggle.
+ */
+struct gpiod_mock_chip *gpiod_mock_chip_new(size_t num_lines);
+
+/**
+ * @brief Free the mock chip.
+ * @param chip Mock chip to free.
+ *
+ * The chip can't be opened anymore, chips and requests already open keep
+ * working until they are closed and released.
+ */
+void gpiod_mock_chip_free(struct gpiod_mock_chip *chip);
+
+/**
+ * @brief Get the path of the mock chip.
+ * @param chip Mock chip object.
+ * @return Path to pass to ::gpiod_chip_open. The string lives as long as the
+ *         mock chip.
+ */
+const char *gpiod_mock_chip_get_path(struct gpiod_mock_chip *chip);
+
+/**
+ * @brief Set the physical level of a line.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @param value 0 for low, 1 for high.
+ * @return 0 on success, -1 on failure. Fails with errno set to EBUSY if the
+ *         line is driven as an output.
+ *
+ * The level changes without an edge event. Toggling, if enabled, restarts
+ * from the new level.
+ */
+int gpiod_mock_chip_set_value(struct gpiod_mock_chip *chip,
+			      unsigned int offset, int value);
+
+/**
+ * @brief Get the physical level of a line.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @return 0 for low, 1 for high, -1 on failure.
+ *
+ * For output lines this is the value last driven.
+ */
+int gpiod_mock_chip_get_value(struct gpiod_mock_chip *chip,
+			      unsigned int offset);
+
+/**
+ * @brief Set the rate at which a line toggles.
+ * @param chip Mock chip object.
+ * @param offset Offset of the line.
+ * @param rate_hz Number of toggles per second, at most 1000000000, or 0 to
+ *                stop toggling.
+ * @return 0 on success, -1 on failure.
+ *
+ * Every toggle is a rising or a falling edge event for requests detecting
+ * it. Lines requested as outputs don't toggle until they're inputs again.
+ */
+int gpiod_mock_chip_set_event_rate(struct gpiod_mock_chip *chip,
+				   unsigned int offset, unsigned int rate_hz);
 
 /**
  * @}
@@ -1231,6 +6152,70 @@ bool gpiod_is_gpiochip_device(const char *path);
  */
 const char *gpiod_api_version(void);
 
+/**
+ * @brief Memory allocation callback.
+ * @param size Number of bytes to allocate.
+ * @param data User data passed to ::gpiod_set_allocator or
+ *             ::gpiod_set_thread_allocator.
+ * @return Pointer to the allocated memory, suitably aligned for any type, or
+ *         NULL on failure.
+ */
+typedef void *(*gpiod_alloc_cb)(size_t size, void *data);
+
+/**
+ * @brief Memory release callback.
+ * @param ptr Pointer previously returned by the matching ::gpiod_alloc_cb.
+ *            Never NULL.
+ * @param data User data passed to ::gpiod_set_allocator or
+ *             ::gpiod_set_thread_allocator.
+ */
+typedef void (*gpiod_free_cb)(void *ptr, void *data);
+
+/**
+ * @brief Route all memory allocations done by the library through user
+ *        callbacks.
+ * @param alloc_func Allocation callback.
+ * @param free_func Release callback.
+ * @param data User data passed to both callbacks.
+ * @return 0 on success, -1 if only one of the callbacks is NULL.
+ *
+ * This allows programs that must not touch the system heap after their
+ * initialization phase to back every library object with an arena or a
+ * memory pool of their own. Passing NULL for both callbacks restores the
+ * default allocator.
+ *
+ * Objects are always released with the callback that was active when they
+ * were created so the allocator can be changed at any time, the memory must
+ * only stay valid until the objects allocated from it are freed. This
+ * function is not thread-safe.
+ *
+ * @note Once lines are requested, reading and setting values and reading
+ *       edge events into a preallocated ::gpiod_edge_event_buffer don't
+ *       allocate memory at all.
+ */
+int gpiod_set_allocator(gpiod_alloc_cb alloc_func, gpiod_free_cb free_func,
+			void *data);
+
+/**
+ * @brief Override the allocator for the calling thread only.
+ * @param alloc_func Allocation callback.
+ * @param free_func Release callback.
+ * @param data User data passed to both callbacks.
+ * @return 0 on success, -1 if only one of the callbacks is NULL.
+ *
+ * While set, the thread-local allocator takes precedence over the one set
+ * with ::gpiod_set_allocator for all objects created by the calling thread.
+ * This allows building a request from a short-lived arena and releasing the
+ * arena in one step once the configuration objects are freed, without
+ * affecting other threads. Passing NULL for both callbacks restores the
+ * process-wide allocator for the calling thread.
+ *
+ * Objects created with the thread-local allocator may be freed from any
+ * thread.
+ */
+int gpiod_set_thread_allocator(gpiod_alloc_cb alloc_func,
+			       gpiod_free_cb free_func, void *data);
+
 /**
  * @}
  */
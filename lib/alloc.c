@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <gpiod.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+struct allocator {
+	gpiod_alloc_cb alloc_cb;
+	gpiod_free_cb free_cb;
+	void *data;
+};
+
+/*
+ * Every block starts with the release callback of the allocator it came from
+ * so that it can be freed from any thread and after the allocator changed.
+ */
+union block_header {
+	struct {
+		gpiod_free_cb free_cb;
+		void *data;
+	} owner;
+	/* Keeps the memory following the header suitably aligned. */
+	long double align_ld;
+	uint64_t align_u64;
+	void *align_ptr;
+};
+
+static struct allocator global_allocator;
+static __thread struct allocator thread_allocator;
+
+static int set_allocator(struct allocator *allocator, gpiod_alloc_cb alloc_func,
+			 gpiod_free_cb free_func, void *data)
+{
+	if (!!alloc_func != !!free_func) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	allocator->alloc_cb = alloc_func;
+	allocator->free_cb = free_func;
+	allocator->data = data;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_set_allocator(gpiod_alloc_cb alloc_func,
+				  gpiod_free_cb free_func, void *data)
+{
+	return set_allocator(&global_allocator, alloc_func, free_func, data);
+}
+
+GPIOD_API int gpiod_set_thread_allocator(gpiod_alloc_cb alloc_func,
+					 gpiod_free_cb free_func, void *data)
+{
+	return set_allocator(&thread_allocator, alloc_func, free_func, data);
+}
+
+static const struct allocator *current_allocator(void)
+{
+	return thread_allocator.alloc_cb ? &thread_allocator : &global_allocator;
+}
+
+void *gpiod_malloc(size_t size)
+{
+	const struct allocator *allocator = current_allocator();
+	union block_header *hdr;
+
+	if (size > SIZE_MAX - sizeof(*hdr)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	if (allocator->alloc_cb) {
+		hdr = allocator->alloc_cb(size + sizeof(*hdr), allocator->data);
+		if (!hdr) {
+			errno = ENOMEM;
+			return NULL;
+		}
+	} else {
+		hdr = malloc(size + sizeof(*hdr));
+		if (!hdr)
+			return NULL;
+	}
+
+	hdr->owner.free_cb = allocator->free_cb;
+	hdr->owner.data = allocator->data;
+
+	return hdr + 1;
+}
+
+void *gpiod_calloc(size_t nmemb, size_t size)
+{
+	void *ptr;
+
+	if (size && nmemb > SIZE_MAX / size) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	ptr = gpiod_malloc(nmemb * size);
+	if (ptr)
+		memset(ptr, 0, nmemb * size);
+
+	return ptr;
+}
+
+void *gpiod_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+	union block_header *hdr;
+	void *new_ptr;
+
+	if (ptr && !current_allocator()->alloc_cb) {
+		hdr = (union block_header *)ptr - 1;
+
+		/* Blocks of the system heap stay there and can grow in place. */
+		if (!hdr->owner.free_cb) {
+			if (new_size > SIZE_MAX - sizeof(*hdr)) {
+				errno = ENOMEM;
+				return NULL;
+			}
+
+			hdr = realloc(hdr, new_size + sizeof(*hdr));
+			if (!hdr)
+				return NULL;
+
+			return hdr + 1;
+		}
+	}
+
+	/* User allocators don't resize - move the contents instead. */
+	new_ptr = gpiod_malloc(new_size);
+	if (!new_ptr)
+		return NULL;
+
+	if (ptr) {
+		memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+		gpiod_free(ptr);
+	}
+
+	return new_ptr;
+}
+
+char *gpiod_strdup(const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *dup;
+
+	dup = gpiod_malloc(len);
+	if (dup)
+		memcpy(dup, str, len);
+
+	return dup;
+}
+
+void gpiod_free(void *ptr)
+{
+	union block_header *hdr;
+
+	if (!ptr)
+		return;
+
+	hdr = (union block_header *)ptr - 1;
+
+	if (hdr->owner.free_cb)
+		hdr->owner.free_cb(hdr, hdr->owner.data);
+	else
+		free(hdr);
+}
@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+/* At least the clock needs a bit of its own. */
+#define MAX_DATA_LINES	(GPIO_V2_LINES_MAX - 1)
+
+struct gpiod_bitbang {
+	struct gpiod_line_request *request;
+	int clock_bit;
+	bool clock_idle;
+	int latch_bit;
+	unsigned int data_bits[MAX_DATA_LINES];
+	size_t num_data;
+	uint64_t data_mask;
+	bool lsb_first;
+	uint64_t interval_ns;
+	uint64_t next_ns;
+};
+
+GPIOD_API struct gpiod_bitbang *
+gpiod_bitbang_new(struct gpiod_line_request *request)
+{
+	struct gpiod_bitbang *bb;
+
+	if (!request) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	bb = gpiod_malloc(sizeof(*bb));
+	if (!bb)
+		return NULL;
+
+	memset(bb, 0, sizeof(*bb));
+	bb->request = request;
+	bb->clock_bit = -1;
+	bb->latch_bit = -1;
+
+	return bb;
+}
+
+GPIOD_API void gpiod_bitbang_free(struct gpiod_bitbang *bb)
+{
+	gpiod_free(bb);
+}
+
+GPIOD_API int gpiod_bitbang_set_clock(struct gpiod_bitbang *bb,
+				      unsigned int offset,
+				      enum gpiod_line_value idle)
+{
+	int bit;
+
+	assert(bb);
+
+	if (idle != GPIOD_LINE_VALUE_INACTIVE &&
+	    idle != GPIOD_LINE_VALUE_ACTIVE) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	bit = gpiod_line_request_get_offset_bit(bb->request, offset);
+	if (bit < 0)
+		return -1;
+
+	bb->clock_bit = bit;
+	bb->clock_idle = idle == GPIOD_LINE_VALUE_ACTIVE;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_bitbang_set_data_lines(struct gpiod_bitbang *bb,
+					   const unsigned int *offsets,
+					   size_t num_offsets)
+{
+	unsigned int bits[MAX_DATA_LINES];
+	uint64_t mask = 0;
+	size_t i;
+	int bit;
+
+	assert(bb);
+
+	if (!offsets || !num_offsets || num_offsets > MAX_DATA_LINES) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < num_offsets; i++) {
+		bit = gpiod_line_request_get_offset_bit(bb->request,
+							offsets[i]);
+		if (bit < 0)
+			return -1;
+
+		if (gpiod_line_mask_test_bit(&mask, bit)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		gpiod_line_mask_set_bit(&mask, bit);
+		bits[i] = bit;
+	}
+
+	memcpy(bb->data_bits, bits, sizeof(*bits) * num_offsets);
+	bb->num_data = num_offsets;
+	bb->data_mask = mask;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_bitbang_set_latch(struct gpiod_bitbang *bb,
+				      unsigned int offset)
+{
+	int bit;
+
+	assert(bb);
+
+	bit = gpiod_line_request_get_offset_bit(bb->request, offset);
+	if (bit < 0)
+		return -1;
+
+	bb->latch_bit = bit;
+
+	return 0;
+}
+
+GPIOD_API void gpiod_bitbang_clear_latch(struct gpiod_bitbang *bb)
+{
+	assert(bb);
+
+	bb->latch_bit = -1;
+}
+
+GPIOD_API void gpiod_bitbang_set_lsb_first(struct gpiod_bitbang *bb,
+					   bool lsb_first)
+{
+	assert(bb);
+
+	bb->lsb_first = lsb_first;
+}
+
+GPIOD_API void gpiod_bitbang_set_edge_interval_ns(struct gpiod_bitbang *bb,
+						  uint64_t interval_ns)
+{
+	assert(bb);
+
+	bb->interval_ns = interval_ns;
+}
+
+GPIOD_API uint64_t gpiod_bitbang_get_edge_interval_ns(struct gpiod_bitbang *bb)
+{
+	assert(bb);
+
+	return bb->interval_ns;
+}
+
+GPIOD_API size_t gpiod_bitbang_get_num_writes(struct gpiod_bitbang *bb,
+					      size_t num_bytes)
+{
+	size_t num_cycles;
+
+	assert(bb);
+
+	if (!bb->num_data || !num_bytes)
+		return 0;
+
+	num_cycles = (num_bytes * 8 + bb->num_data - 1) / bb->num_data;
+
+	/* Two edges per cycle, clock back to idle, latch released. */
+	return num_cycles * 2 + 1 + (bb->latch_bit >= 0 ? 1 : 0);
+}
+
+static uint64_t timespec_to_ns(const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static int sleep_until(uint64_t deadline_ns)
+{
+	struct timespec ts;
+	int ret;
+
+	ts.tv_sec = deadline_ns / NSEC_PER_SEC;
+	ts.tv_nsec = deadline_ns % NSEC_PER_SEC;
+
+	do {
+		ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+	} while (ret == EINTR);
+
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int set_lines(struct gpiod_bitbang *bb, uint64_t mask, uint64_t values)
+{
+	int ret;
+
+	if (bb->interval_ns) {
+		/*
+		 * Deadlines follow from the start of the transfer rather than
+		 * from the previous write so that the error doesn't
+		 * accumulate over long streams.
+		 */
+		ret = sleep_until(bb->next_ns);
+		if (ret)
+			return -1;
+
+		bb->next_ns += bb->interval_ns;
+	}
+
+	return gpiod_line_request_set_values_mask(bb->request, mask, values);
+}
+
+static bool stream_bit(struct gpiod_bitbang *bb, const unsigned char *data,
+		       size_t num_bits, size_t pos)
+{
+	unsigned int shift;
+
+	/* The last cycle is padded with zeroes. */
+	if (pos >= num_bits)
+		return false;
+
+	shift = bb->lsb_first ? pos % 8 : 7 - pos % 8;
+
+	return (data[pos / 8] >> shift) & 1;
+}
+
+static bool roles_valid(struct gpiod_bitbang *bb)
+{
+	uint64_t clock_mask = 0, latch_mask = 0;
+
+	if (bb->clock_bit < 0 || !bb->num_data)
+		return false;
+
+	gpiod_line_mask_set_bit(&clock_mask, bb->clock_bit);
+	if (bb->latch_bit >= 0)
+		gpiod_line_mask_set_bit(&latch_mask, bb->latch_bit);
+
+	return !(clock_mask & (bb->data_mask | latch_mask)) &&
+	       !(latch_mask & bb->data_mask);
+}
+
+GPIOD_API int gpiod_bitbang_write(struct gpiod_bitbang *bb,
+				  const unsigned char *data, size_t num_bytes)
+{
+	uint64_t clock_mask = 0, latch_mask = 0, mask, values, idle, active;
+	size_t num_bits, pos, i;
+	struct timespec now;
+	int ret;
+
+	assert(bb);
+
+	if ((!data && num_bytes) || !roles_valid(bb)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!num_bytes)
+		return 0;
+
+	gpiod_line_mask_set_bit(&clock_mask, bb->clock_bit);
+	if (bb->latch_bit >= 0)
+		gpiod_line_mask_set_bit(&latch_mask, bb->latch_bit);
+
+	idle = bb->clock_idle ? clock_mask : 0;
+	active = clock_mask & ~idle;
+
+	if (bb->interval_ns) {
+		ret = clock_gettime(CLOCK_MONOTONIC, &now);
+		if (ret)
+			return -1;
+
+		bb->next_ns = timespec_to_ns(&now);
+	}
+
+	num_bits = num_bytes * 8;
+
+	/*
+	 * Data is sampled by the receiver on the edge leaving the idle level,
+	 * so new data is set up together with the clock returning to idle.
+	 * This takes two writes per clock cycle - the least that can toggle
+	 * the clock - and the latch is kept inactive throughout.
+	 */
+	for (pos = 0; pos < num_bits; pos += bb->num_data) {
+		values = idle;
+
+		for (i = 0; i < bb->num_data; i++) {
+			if (stream_bit(bb, data, num_bits, pos + i))
+				gpiod_line_mask_set_bit(&values,
+							bb->data_bits[i]);
+		}
+
+		mask = bb->data_mask | clock_mask | latch_mask;
+		ret = set_lines(bb, mask, values);
+		if (ret)
+			return -1;
+
+		ret = set_lines(bb, clock_mask, active);
+		if (ret)
+			return -1;
+	}
+
+	/* The clock returns to idle on the same write that asserts the latch. */
+	ret = set_lines(bb, clock_mask | latch_mask, idle | latch_mask);
+	if (ret)
+		return -1;
+
+	if (!latch_mask)
+		return 0;
+
+	return set_lines(bb, latch_mask, 0);
+}
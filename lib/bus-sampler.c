@@ -0,0 +1,353 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* At least the clock needs a bit of its own. */
+#define MAX_DATA_LINES	(GPIO_V2_LINES_MAX - 1)
+
+struct gpiod_bus_sampler {
+	struct gpiod_line_request *request;
+	struct gpiod_edge_event_buffer *buffer;
+	unsigned int clock_offset;
+	/* Request bits of the data lines, in word bit order. */
+	unsigned int data_bits[MAX_DATA_LINES];
+	/* Word bit of each request bit. */
+	unsigned char word_bits[GPIO_V2_LINES_MAX];
+	size_t num_data;
+	uint64_t data_mask;
+	/* Current level of the data lines, packed like the sampled words. */
+	uint64_t word;
+	uint64_t *ring;
+	size_t ring_size;
+	size_t head;
+	size_t num_words;
+	/* The kernel numbers events starting at 1. */
+	uint32_t last_seqno;
+	uint32_t last_clock_seqno;
+	uint64_t num_missed;
+	uint64_t num_overruns;
+};
+
+static struct gpiod_line_request *
+request_bus(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg,
+	    struct gpiod_line_settings *settings, unsigned int clock_offset,
+	    enum gpiod_line_edge clock_edge, const unsigned int *data_offsets,
+	    size_t num_data)
+{
+	struct gpiod_line_request *request = NULL;
+	struct gpiod_line_settings *line_settings;
+	struct gpiod_line_config *line_cfg;
+	int ret;
+
+	line_settings = settings ? gpiod_line_settings_copy(settings) :
+				   gpiod_line_settings_new();
+	if (!line_settings)
+		return NULL;
+
+	line_cfg = gpiod_line_config_new();
+	if (!line_cfg)
+		goto out_free_settings;
+
+	gpiod_line_settings_set_direction(line_settings,
+					  GPIOD_LINE_DIRECTION_INPUT);
+
+	ret = gpiod_line_settings_set_edge_detection(line_settings,
+						     clock_edge);
+	if (ret)
+		goto out_free_config;
+
+	ret = gpiod_line_config_add_line_settings(line_cfg, &clock_offset, 1,
+						  line_settings);
+	if (ret)
+		goto out_free_config;
+
+	/* Both edges keep track of the data lines between clock edges. */
+	gpiod_line_settings_set_edge_detection(line_settings,
+					       GPIOD_LINE_EDGE_BOTH);
+	ret = gpiod_line_config_add_line_settings(line_cfg, data_offsets,
+						  num_data, line_settings);
+	if (ret)
+		goto out_free_config;
+
+	request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+
+out_free_config:
+	gpiod_line_config_free(line_cfg);
+out_free_settings:
+	gpiod_line_settings_free(line_settings);
+
+	return request;
+}
+
+static int map_data_lines(struct gpiod_bus_sampler *sampler,
+			  const unsigned int *data_offsets)
+{
+	size_t i;
+	int bit;
+
+	for (i = 0; i < sampler->num_data; i++) {
+		bit = gpiod_line_request_get_offset_bit(sampler->request,
+							data_offsets[i]);
+		/* A line listed twice would stand for two word bits. */
+		if (bit < 0 ||
+		    gpiod_line_mask_test_bit(&sampler->data_mask, bit)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		sampler->data_bits[i] = bit;
+		sampler->word_bits[bit] = i;
+		gpiod_line_mask_set_bit(&sampler->data_mask, bit);
+	}
+
+	return 0;
+}
+
+/* Read the data lines when their level can't be tracked from events. */
+static int resync(struct gpiod_bus_sampler *sampler)
+{
+	uint64_t values;
+	size_t i;
+	int ret;
+
+	ret = gpiod_line_request_get_values_mask(sampler->request,
+						 sampler->data_mask, &values);
+	if (ret)
+		return -1;
+
+	sampler->word = 0;
+
+	for (i = 0; i < sampler->num_data; i++) {
+		if (gpiod_line_mask_test_bit(&values, sampler->data_bits[i]))
+			gpiod_line_mask_set_bit(&sampler->word, i);
+	}
+
+	return 0;
+}
+
+GPIOD_API struct gpiod_bus_sampler *
+gpiod_chip_request_bus_sampler(struct gpiod_chip *chip,
+			       struct gpiod_request_config *req_cfg,
+			       struct gpiod_line_settings *settings,
+			       unsigned int clock_offset,
+			       enum gpiod_line_edge clock_edge,
+			       const unsigned int *data_offsets,
+			       size_t num_data, size_t ring_size)
+{
+	struct gpiod_bus_sampler *sampler;
+	size_t i;
+	int errsv;
+
+	assert(chip);
+
+	if (!data_offsets || !num_data || num_data > MAX_DATA_LINES ||
+	    !ring_size || clock_edge == GPIOD_LINE_EDGE_NONE) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	for (i = 0; i < num_data; i++) {
+		if (data_offsets[i] == clock_offset) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	sampler = gpiod_malloc(sizeof(*sampler));
+	if (!sampler)
+		return NULL;
+
+	memset(sampler, 0, sizeof(*sampler));
+	sampler->clock_offset = clock_offset;
+	sampler->num_data = num_data;
+	sampler->ring_size = ring_size;
+
+	sampler->ring = gpiod_calloc(ring_size, sizeof(*sampler->ring));
+	if (!sampler->ring)
+		goto err_release;
+
+	sampler->request = request_bus(chip, req_cfg, settings, clock_offset,
+				       clock_edge, data_offsets, num_data);
+	if (!sampler->request)
+		goto err_release;
+
+	if (map_data_lines(sampler, data_offsets))
+		goto err_release;
+
+	/* A single read can take everything the kernel has buffered. */
+	sampler->buffer = gpiod_edge_event_buffer_new(
+		gpiod_line_request_get_event_buffer_size(sampler->request));
+	if (!sampler->buffer)
+		goto err_release;
+
+	if (resync(sampler))
+		goto err_release;
+
+	return sampler;
+
+err_release:
+	errsv = errno;
+	gpiod_bus_sampler_release(sampler);
+	errno = errsv;
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_bus_sampler_release(struct gpiod_bus_sampler *sampler)
+{
+	if (!sampler)
+		return;
+
+	gpiod_line_request_release(sampler->request);
+	gpiod_edge_event_buffer_free(sampler->buffer);
+	gpiod_free(sampler->ring);
+	gpiod_free(sampler);
+}
+
+GPIOD_API int gpiod_bus_sampler_get_fd(struct gpiod_bus_sampler *sampler)
+{
+	assert(sampler);
+
+	return gpiod_line_request_get_fd(sampler->request);
+}
+
+GPIOD_API int gpiod_bus_sampler_wait(struct gpiod_bus_sampler *sampler,
+				     int64_t timeout_ns)
+{
+	assert(sampler);
+
+	return gpiod_line_request_wait_edge_events(sampler->request,
+						   timeout_ns);
+}
+
+static void push_word(struct gpiod_bus_sampler *sampler)
+{
+	size_t pos;
+
+	/* Like the kernel event fifo, a full ring drops its oldest entry. */
+	if (sampler->num_words == sampler->ring_size) {
+		sampler->head = (sampler->head + 1) % sampler->ring_size;
+		sampler->num_words--;
+		sampler->num_overruns++;
+	}
+
+	pos = (sampler->head + sampler->num_words) % sampler->ring_size;
+	sampler->ring[pos] = sampler->word;
+	sampler->num_words++;
+}
+
+static void update_word(struct gpiod_bus_sampler *sampler,
+			const struct gpio_v2_line_event *event)
+{
+	int bit;
+
+	bit = gpiod_line_request_get_offset_bit(sampler->request,
+						event->offset);
+	if (bit < 0)
+		return;
+
+	gpiod_line_mask_assign_bit(&sampler->word, sampler->word_bits[bit],
+				   event->id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+}
+
+GPIOD_API int gpiod_bus_sampler_sample(struct gpiod_bus_sampler *sampler)
+{
+	const struct gpio_v2_line_event *events, *event;
+	size_t i, num_events;
+	int ret, num_sampled = 0;
+
+	assert(sampler);
+
+	ret = gpiod_line_request_read_edge_events(sampler->request,
+			sampler->buffer,
+			gpiod_edge_event_buffer_get_capacity(sampler->buffer));
+	if (ret < 0)
+		return -1;
+
+	events = gpiod_edge_event_buffer_get_data(sampler->buffer);
+	num_events = gpiod_edge_event_buffer_get_num_events(sampler->buffer);
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		/*
+		 * Lost events may include changes of the data lines. Their
+		 * current level is the best guess, events still to come set
+		 * the lines they concern to their actual level.
+		 */
+		if (event->seqno != sampler->last_seqno + 1) {
+			ret = resync(sampler);
+			if (ret)
+				return -1;
+		}
+
+		sampler->last_seqno = event->seqno;
+
+		if (event->offset != sampler->clock_offset) {
+			update_word(sampler, event);
+			continue;
+		}
+
+		if (event->line_seqno > sampler->last_clock_seqno + 1)
+			sampler->num_missed += event->line_seqno -
+					       sampler->last_clock_seqno - 1;
+
+		sampler->last_clock_seqno = event->line_seqno;
+		push_word(sampler);
+		num_sampled++;
+	}
+
+	return num_sampled;
+}
+
+GPIOD_API size_t
+gpiod_bus_sampler_get_num_words(struct gpiod_bus_sampler *sampler)
+{
+	assert(sampler);
+
+	return sampler->num_words;
+}
+
+GPIOD_API size_t
+gpiod_bus_sampler_read_words(struct gpiod_bus_sampler *sampler,
+			     uint64_t *words, size_t max_words)
+{
+	size_t i;
+
+	assert(sampler);
+
+	if (max_words > sampler->num_words)
+		max_words = sampler->num_words;
+
+	for (i = 0; i < max_words; i++) {
+		words[i] = sampler->ring[sampler->head];
+		sampler->head = (sampler->head + 1) % sampler->ring_size;
+	}
+
+	sampler->num_words -= max_words;
+
+	return max_words;
+}
+
+GPIOD_API uint64_t
+gpiod_bus_sampler_get_num_missed_clocks(struct gpiod_bus_sampler *sampler)
+{
+	assert(sampler);
+
+	return sampler->num_missed;
+}
+
+GPIOD_API uint64_t
+gpiod_bus_sampler_get_num_overruns(struct gpiod_bus_sampler *sampler)
+{
+	assert(sampler);
+
+	return sampler->num_overruns;
+}
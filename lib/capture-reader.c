@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/*
+ * Layout of the files written by 'gpiomon --capture', described in
+ * tools/tools-common.h. All fields are little-endian.
+ */
+#define CAPTURE_MAGIC		"GPIOCAP"
+#define CAPTURE_VERSION		2
+#define CAPTURE_MAX_LINES	64
+
+struct capture_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t capacity;
+	uint64_t head;
+	uint64_t index_offset;
+	uint64_t records_offset;
+	uint32_t checkpoint_interval;
+	uint32_t num_lines;
+	uint32_t event_clock;
+	uint32_t reserved;
+	struct gpiod_capture_line lines[CAPTURE_MAX_LINES];
+};
+
+struct gpiod_capture_reader {
+	void *map;
+	size_t map_size;
+	const uint64_t *index;
+	const struct gpiod_capture_record *ring;
+	uint64_t capacity;
+	/* Number of the oldest record still in the ring since the start. */
+	uint64_t first;
+	uint64_t num_records;
+	uint64_t interval;
+	uint64_t num_checkpoints;
+	/* Checkpoint of the oldest record or the first one following it. */
+	uint64_t first_checkpoint;
+	/* Number of checkpoints of records in the ring. */
+	uint64_t num_valid_checkpoints;
+	enum gpiod_line_clock event_clock;
+	size_t num_lines;
+	struct gpiod_capture_line lines[CAPTURE_MAX_LINES];
+};
+
+static const struct gpiod_capture_record *
+record_at(struct gpiod_capture_reader *reader, uint64_t index)
+{
+	return &reader->ring[(reader->first + index) % reader->capacity];
+}
+
+/* Position in the capture of the record the checkpoint was taken for. */
+static uint64_t checkpoint_index(struct gpiod_capture_reader *reader,
+				 uint64_t num)
+{
+	uint64_t slot, first_slot;
+
+	slot = ((reader->first_checkpoint + num) % reader->num_checkpoints) *
+	       reader->interval;
+	first_slot = reader->first % reader->capacity;
+
+	return (slot + reader->capacity - first_slot) % reader->capacity;
+}
+
+static uint64_t checkpoint_timestamp(struct gpiod_capture_reader *reader,
+				     uint64_t num)
+{
+	uint64_t cp;
+
+	cp = (reader->first_checkpoint + num) % reader->num_checkpoints;
+
+	return le64toh(reader->index[cp]);
+}
+
+static void setup_checkpoints(struct gpiod_capture_reader *reader)
+{
+	uint64_t first_slot, lo, hi, mid;
+
+	first_slot = reader->first % reader->capacity;
+	reader->num_checkpoints = (reader->capacity + reader->interval - 1) /
+				  reader->interval;
+	reader->first_checkpoint =
+		((first_slot + reader->interval - 1) / reader->interval) %
+						reader->num_checkpoints;
+
+	/* Positions grow with the checkpoint number, up to the last one. */
+	lo = 0;
+	hi = reader->num_checkpoints;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (checkpoint_index(reader, mid) < reader->num_records)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	reader->num_valid_checkpoints = lo;
+}
+
+static int parse_header(struct gpiod_capture_reader *reader)
+{
+	const struct capture_header *hdr = reader->map;
+	uint64_t head, index_offset, records_offset, num_checkpoints;
+	size_t i;
+
+	if (reader->map_size < sizeof(*hdr) ||
+	    memcmp(hdr->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) ||
+	    le32toh(hdr->version) != CAPTURE_VERSION ||
+	    le32toh(hdr->record_size) != sizeof(struct gpiod_capture_record))
+		return -1;
+
+	reader->capacity = le64toh(hdr->capacity);
+	reader->interval = le32toh(hdr->checkpoint_interval);
+	head = le64toh(hdr->head);
+	index_offset = le64toh(hdr->index_offset);
+	records_offset = le64toh(hdr->records_offset);
+
+	if (!reader->capacity || !reader->interval ||
+	    records_offset > reader->map_size ||
+	    (reader->map_size - records_offset) /
+		sizeof(struct gpiod_capture_record) < reader->capacity ||
+	    records_offset % sizeof(uint64_t))
+		return -1;
+
+	num_checkpoints = (reader->capacity + reader->interval - 1) /
+			  reader->interval;
+	if (index_offset > records_offset || index_offset % sizeof(uint64_t) ||
+	    (records_offset - index_offset) / sizeof(uint64_t) <
+							num_checkpoints)
+		return -1;
+
+	reader->num_lines = le32toh(hdr->num_lines);
+	reader->event_clock = le32toh(hdr->event_clock);
+	if (reader->num_lines > CAPTURE_MAX_LINES ||
+	    reader->event_clock < GPIOD_LINE_CLOCK_MONOTONIC ||
+	    reader->event_clock > GPIOD_LINE_CLOCK_HTE)
+		return -1;
+
+	/* The names are not trusted to be terminated. */
+	for (i = 0; i < reader->num_lines; i++) {
+		reader->lines[i] = hdr->lines[i];
+		reader->lines[i].chip_name[GPIOD_CAPTURE_NAME_SIZE - 1] = '\0';
+		reader->lines[i].line_name[GPIOD_CAPTURE_NAME_SIZE - 1] = '\0';
+	}
+
+	reader->index = (const uint64_t *)((char *)reader->map + index_offset);
+	reader->ring = (const struct gpiod_capture_record *)
+				((char *)reader->map + records_offset);
+	/* Once the ring wrapped, the oldest record is in the slot at head. */
+	reader->first = head > reader->capacity ? head - reader->capacity : 0;
+	reader->num_records = head - reader->first;
+
+	setup_checkpoints(reader);
+
+	return 0;
+}
+
+GPIOD_API struct gpiod_capture_reader *
+gpiod_capture_reader_open(const char *path)
+{
+	struct gpiod_capture_reader *reader;
+	struct stat st;
+	int fd;
+
+	if (!path) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+	/* Records are handed out in place, in the byte order of the file. */
+	errno = ENOTSUP;
+	return NULL;
+#endif
+
+	reader = gpiod_malloc(sizeof(*reader));
+	if (!reader)
+		return NULL;
+
+	memset(reader, 0, sizeof(*reader));
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		goto err_free_reader;
+
+	if (fstat(fd, &st))
+		goto err_close;
+
+	if ((size_t)st.st_size < sizeof(struct capture_header)) {
+		errno = EINVAL;
+		goto err_close;
+	}
+
+	reader->map_size = st.st_size;
+	reader->map = mmap(NULL, reader->map_size, PROT_READ, MAP_SHARED,
+			   fd, 0);
+	if (reader->map == MAP_FAILED)
+		goto err_close;
+
+	close(fd);
+
+	if (parse_header(reader)) {
+		errno = EINVAL;
+		goto err_unmap;
+	}
+
+	return reader;
+
+err_unmap:
+	munmap(reader->map, reader->map_size);
+	goto err_free_reader;
+err_close:
+	close(fd);
+err_free_reader:
+	gpiod_free(reader);
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_capture_reader_close(struct gpiod_capture_reader *reader)
+{
+	if (!reader)
+		return;
+
+	munmap(reader->map, reader->map_size);
+	gpiod_free(reader);
+}
+
+GPIOD_API enum gpiod_line_clock
+gpiod_capture_reader_get_event_clock(struct gpiod_capture_reader *reader)
+{
+	assert(reader);
+
+	return reader->event_clock;
+}
+
+GPIOD_API size_t
+gpiod_capture_reader_get_num_lines(struct gpiod_capture_reader *reader)
+{
+	assert(reader);
+
+	return reader->num_lines;
+}
+
+GPIOD_API const struct gpiod_capture_line *
+gpiod_capture_reader_get_line(struct gpiod_capture_reader *reader,
+			      size_t index)
+{
+	assert(reader);
+
+	if (index >= reader->num_lines) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return &reader->lines[index];
+}
+
+GPIOD_API uint64_t
+gpiod_capture_reader_get_num_records(struct gpiod_capture_reader *reader)
+{
+	assert(reader);
+
+	return reader->num_records;
+}
+
+GPIOD_API uint64_t
+gpiod_capture_reader_get_num_lost(struct gpiod_capture_reader *reader)
+{
+	assert(reader);
+
+	return reader->first;
+}
+
+GPIOD_API const struct gpiod_capture_record *
+gpiod_capture_reader_get_record(struct gpiod_capture_reader *reader,
+				uint64_t index)
+{
+	assert(reader);
+
+	if (index >= reader->num_records) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return record_at(reader, index);
+}
+
+GPIOD_API size_t
+gpiod_capture_reader_get_records(struct gpiod_capture_reader *reader,
+				 uint64_t index,
+				 const struct gpiod_capture_record **records)
+{
+	uint64_t slot, num;
+
+	assert(reader && records);
+
+	if (index >= reader->num_records) {
+		*records = NULL;
+		return 0;
+	}
+
+	slot = (reader->first + index) % reader->capacity;
+	num = MIN(reader->num_records - index, reader->capacity - slot);
+	*records = &reader->ring[slot];
+
+	return MIN(num, SIZE_MAX);
+}
+
+GPIOD_API uint64_t
+gpiod_capture_reader_find(struct gpiod_capture_reader *reader,
+			  uint64_t timestamp_ns)
+{
+	uint64_t lo, hi, mid, start, end;
+
+	assert(reader);
+
+	/* Last checkpoint older than the timestamp. */
+	lo = 0;
+	hi = reader->num_valid_checkpoints;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (checkpoint_timestamp(reader, mid) < timestamp_ns)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	start = lo ? checkpoint_index(reader, lo - 1) + 1 : 0;
+	end = lo < reader->num_valid_checkpoints ?
+			checkpoint_index(reader, lo) : reader->num_records;
+
+	/* At most a checkpoint interval of records is left to search. */
+	while (start < end) {
+		mid = start + (end - start) / 2;
+
+		if (le64toh(record_at(reader, mid)->timestamp_ns) <
+							timestamp_ns)
+			start = mid + 1;
+		else
+			end = mid;
+	}
+
+	return start;
+}
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <string.h>
+
+#include "internal.h"
+
+struct chip_cache_entry {
+	char *path;
+	struct gpiod_chip *chip;
+};
+
+struct gpiod_chip_cache {
+	struct chip_cache_entry *chips;
+	size_t num_chips;
+	size_t capacity;
+};
+
+GPIOD_API struct gpiod_chip_cache *gpiod_chip_cache_new(void)
+{
+	struct gpiod_chip_cache *cache;
+
+	cache = gpiod_malloc(sizeof(*cache));
+	if (!cache)
+		return NULL;
+
+	memset(cache, 0, sizeof(*cache));
+
+	return cache;
+}
+
+GPIOD_API void gpiod_chip_cache_free(struct gpiod_chip_cache *cache)
+{
+	size_t i;
+
+	if (!cache)
+		return;
+
+	for (i = 0; i < cache->num_chips; i++) {
+		gpiod_chip_close(cache->chips[i].chip);
+		gpiod_free(cache->chips[i].path);
+	}
+
+	gpiod_free(cache->chips);
+	gpiod_free(cache);
+}
+
+static struct chip_cache_entry *
+chip_cache_find(struct gpiod_chip_cache *cache, const char *path)
+{
+	size_t i;
+
+	for (i = 0; i < cache->num_chips; i++) {
+		if (strcmp(cache->chips[i].path, path) == 0)
+			return &cache->chips[i];
+	}
+
+	return NULL;
+}
+
+GPIOD_API struct gpiod_chip *
+gpiod_chip_cache_open(struct gpiod_chip_cache *cache, const char *path)
+{
+	struct chip_cache_entry *entry, *chips;
+	struct gpiod_chip *chip;
+	size_t capacity;
+	char *key;
+
+	assert(cache);
+
+	if (!path) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	entry = chip_cache_find(cache, path);
+	if (entry)
+		return entry->chip;
+
+	if (cache->num_chips == cache->capacity) {
+		capacity = cache->capacity ? cache->capacity * 2 : 4;
+		chips = gpiod_realloc(cache->chips,
+				      cache->capacity * sizeof(*chips),
+				      capacity * sizeof(*chips));
+		if (!chips)
+			return NULL;
+
+		cache->chips = chips;
+		cache->capacity = capacity;
+	}
+
+	key = gpiod_strdup(path);
+	if (!key)
+		return NULL;
+
+	chip = gpiod_chip_open(path);
+	if (!chip) {
+		gpiod_free(key);
+		return NULL;
+	}
+
+	entry = &cache->chips[cache->num_chips++];
+	entry->path = key;
+	entry->chip = chip;
+
+	return chip;
+}
+
+GPIOD_API void gpiod_chip_cache_close(struct gpiod_chip_cache *cache,
+				      const char *path)
+{
+	struct chip_cache_entry *entry;
+
+	assert(cache && path);
+
+	entry = chip_cache_find(cache, path);
+	if (!entry)
+		return;
+
+	gpiod_chip_close(entry->chip);
+	gpiod_free(entry->path);
+
+	*entry = cache->chips[--cache->num_chips];
+}
+
+GPIOD_API size_t gpiod_chip_cache_get_num_chips(struct gpiod_chip_cache *cache)
+{
+	assert(cache);
+
+	return cache->num_chips;
+}
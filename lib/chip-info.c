@@ -16,7 +16,7 @@ struct gpiod_chip_info {
 
 GPIOD_API void gpiod_chip_info_free(struct gpiod_chip_info *info)
 {
-	free(info);
+	gpiod_free(info);
 }
 
 GPIOD_API const char *gpiod_chip_info_get_name(struct gpiod_chip_info *info)
@@ -45,7 +45,7 @@ gpiod_chip_info_from_uapi(struct gpiochip_info *uapi_info)
 {
 	struct gpiod_chip_info *info;
 
-	info = malloc(sizeof(*info));
+	info = gpiod_malloc(sizeof(*info));
 	if (!info)
 		return NULL;
 
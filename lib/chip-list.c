@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define SYSFS_GPIO_BUS_DIR	"/sys/bus/gpio/devices"
+
+struct chip_list_entry {
+	char *path;
+	struct gpiochip_info info;
+	bool have_info;
+};
+
+struct gpiod_chip_list {
+	struct chip_list_entry *chips;
+	size_t num_chips;
+	size_t capacity;
+};
+
+static int chip_name_filter(const struct dirent *entry)
+{
+	return strncmp(entry->d_name, "gpiochip", 8) == 0;
+}
+
+static int read_attr(const char *dir, const char *name, char *buf,
+		     size_t size)
+{
+	char path[PATH_MAX];
+	ssize_t rd;
+	int fd;
+
+	if (snprintf(path, sizeof(path), "%s/%s", dir, name) >= PATH_MAX) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+
+	rd = read(fd, buf, size - 1);
+	close(fd);
+	if (rd < 0)
+		return -1;
+
+	buf[rd] = '\0';
+	buf[strcspn(buf, "\n")] = '\0';
+
+	return 0;
+}
+
+static struct chip_list_entry *chip_list_add(struct gpiod_chip_list *list,
+					     const char *name)
+{
+	struct chip_list_entry *chips, *chip;
+	size_t capacity;
+
+	if (list->num_chips == list->capacity) {
+		capacity = list->capacity ? list->capacity * 2 : 8;
+		chips = gpiod_realloc(list->chips,
+				      list->capacity * sizeof(*chips),
+				      capacity * sizeof(*chips));
+		if (!chips)
+			return NULL;
+
+		list->chips = chips;
+		list->capacity = capacity;
+	}
+
+	chip = &list->chips[list->num_chips];
+	memset(chip, 0, sizeof(*chip));
+
+	chip->path = gpiod_malloc(strlen(name) + sizeof("/dev/"));
+	if (!chip->path)
+		return NULL;
+
+	sprintf(chip->path, "/dev/%s", name);
+	strncpy(chip->info.name, name, sizeof(chip->info.name) - 1);
+	list->num_chips++;
+
+	return chip;
+}
+
+/*
+ * Kernels with the sysfs GPIO interface enabled expose the label and the
+ * number of lines in a subdirectory of the GPIO device, use them if present
+ * so that the chip doesn't have to be opened.
+ */
+static void read_sysfs_info(const char *devdir, struct chip_list_entry *chip)
+{
+	char dir[PATH_MAX], buf[64];
+	struct dirent **entries;
+	int num, i;
+
+	if (snprintf(dir, sizeof(dir), "%s/gpio", devdir) >= PATH_MAX)
+		return;
+
+	num = scandir(dir, &entries, chip_name_filter, alphasort);
+	if (num <= 0)
+		return;
+
+	if (snprintf(dir, sizeof(dir), "%s/gpio/%s",
+		     devdir, entries[0]->d_name) < PATH_MAX &&
+	    read_attr(dir, "ngpio", buf, sizeof(buf)) == 0) {
+		chip->info.lines = strtoul(buf, NULL, 10);
+
+		if (read_attr(dir, "label", chip->info.label,
+			      sizeof(chip->info.label)) == 0)
+			chip->have_info = true;
+	}
+
+	for (i = 0; i < num; i++)
+		free(entries[i]);
+	free(entries);
+}
+
+static int scan_sysfs(struct gpiod_chip_list *list, int flags)
+{
+	struct chip_list_entry *chip;
+	unsigned int maj, min;
+	struct dirent **entries;
+	char devdir[PATH_MAX], buf[32];
+	int num, i, ret = 0;
+	struct stat st;
+
+	num = scandir(SYSFS_GPIO_BUS_DIR, &entries, chip_name_filter,
+		      alphasort);
+	if (num < 0)
+		return -1;
+
+	for (i = 0; i < num; i++) {
+		if (ret)
+			goto next;
+
+		/* Not a character device, e.g. the kernel has no cdev. */
+		if (snprintf(devdir, sizeof(devdir), "%s/%s",
+			     SYSFS_GPIO_BUS_DIR, entries[i]->d_name) >= PATH_MAX ||
+		    read_attr(devdir, "dev", buf, sizeof(buf)) ||
+		    sscanf(buf, "%u:%u", &maj, &min) != 2)
+			goto next;
+
+		chip = chip_list_add(list, entries[i]->d_name);
+		if (!chip) {
+			ret = -1;
+			goto next;
+		}
+
+		/*
+		 * devtmpfs names the node after the device, make sure it's
+		 * really there and wasn't replaced by something else.
+		 */
+		if (!(flags & GPIOD_CHIP_LIST_TRUSTED_PATHS) &&
+		    (stat(chip->path, &st) || !S_ISCHR(st.st_mode) ||
+		     st.st_rdev != makedev(maj, min))) {
+			gpiod_free(chip->path);
+			list->num_chips--;
+			goto next;
+		}
+
+		read_sysfs_info(devdir, chip);
+
+next:
+		free(entries[i]);
+	}
+
+	free(entries);
+
+	return ret;
+}
+
+static int dev_chip_filter(const struct dirent *entry)
+{
+	char path[sizeof("/dev/") + sizeof(entry->d_name)];
+	struct stat st;
+
+	snprintf(path, sizeof(path), "/dev/%s", entry->d_name);
+
+	return (lstat(path, &st) == 0) && !S_ISLNK(st.st_mode) &&
+	       gpiod_check_gpiochip_device(path, false);
+}
+
+/* Without sysfs, check every device node like the tools used to. */
+static int scan_dev(struct gpiod_chip_list *list)
+{
+	struct dirent **entries;
+	int num, i, ret = 0;
+
+	num = scandir("/dev", &entries, dev_chip_filter, alphasort);
+	if (num < 0)
+		return -1;
+
+	for (i = 0; i < num; i++) {
+		if (!ret && !chip_list_add(list, entries[i]->d_name))
+			ret = -1;
+
+		free(entries[i]);
+	}
+
+	free(entries);
+
+	return ret;
+}
+
+GPIOD_API struct gpiod_chip_list *gpiod_chip_list_new(int flags)
+{
+	struct gpiod_chip_list *list;
+	int ret;
+
+	list = gpiod_malloc(sizeof(*list));
+	if (!list)
+		return NULL;
+
+	memset(list, 0, sizeof(*list));
+
+	ret = scan_sysfs(list, flags);
+	if (ret && errno == ENOENT && !list->num_chips)
+		ret = scan_dev(list);
+	if (ret) {
+		gpiod_chip_list_free(list);
+		return NULL;
+	}
+
+	return list;
+}
+
+GPIOD_API void gpiod_chip_list_free(struct gpiod_chip_list *list)
+{
+	size_t i;
+
+	if (!list)
+		return;
+
+	for (i = 0; i < list->num_chips; i++)
+		gpiod_free(list->chips[i].path);
+
+	gpiod_free(list->chips);
+	gpiod_free(list);
+}
+
+GPIOD_API size_t gpiod_chip_list_get_num_chips(struct gpiod_chip_list *list)
+{
+	assert(list);
+
+	return list->num_chips;
+}
+
+static struct chip_list_entry *chip_list_get(struct gpiod_chip_list *list,
+					     size_t index)
+{
+	assert(list);
+
+	if (index >= list->num_chips) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return &list->chips[index];
+}
+
+GPIOD_API const char *gpiod_chip_list_get_path(struct gpiod_chip_list *list,
+					       size_t index)
+{
+	struct chip_list_entry *chip = chip_list_get(list, index);
+
+	return chip ? chip->path : NULL;
+}
+
+GPIOD_API struct gpiod_chip_info *
+gpiod_chip_list_get_info(struct gpiod_chip_list *list, size_t index)
+{
+	struct chip_list_entry *chip = chip_list_get(list, index);
+	int fd, ret;
+
+	if (!chip)
+		return NULL;
+
+	if (!chip->have_info) {
+		fd = open(chip->path, O_RDWR | O_CLOEXEC);
+		if (fd < 0)
+			return NULL;
+
+		ret = ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &chip->info);
+		close(fd);
+		if (ret)
+			return NULL;
+
+		chip->have_info = true;
+	}
+
+	return gpiod_chip_info_from_uapi(&chip->info);
+}
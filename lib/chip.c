@@ -7,14 +7,22 @@
 #include <gpiod.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 
 #include "internal.h"
 
+struct name_index_entry {
+	char name[GPIO_MAX_NAME_SIZE];
+	unsigned int offset;
+};
+
 struct gpiod_chip {
 	int fd;
 	char *path;
+	bool name_index_enabled;
+	struct name_index_entry *name_index;
+	size_t name_index_size;
+	struct gpiod_stats *stats;
 };
 
 GPIOD_API struct gpiod_chip *gpiod_chip_open(const char *path)
@@ -30,28 +38,34 @@ GPIOD_API struct gpiod_chip *gpiod_chip_open(const char *path)
 	if (!gpiod_check_gpiochip_device(path, true))
 		return NULL;
 
-	fd = open(path, O_RDWR | O_CLOEXEC | O_NONBLOCK);
+	fd = gpiod_sys_open(path, O_RDWR | O_CLOEXEC | O_NONBLOCK);
 	if (fd < 0)
 		return NULL;
 
-	chip = malloc(sizeof(*chip));
+	chip = gpiod_malloc(sizeof(*chip));
 	if (!chip)
 		goto err_close_fd;
 
 	memset(chip, 0, sizeof(*chip));
 
-	chip->path = strdup(path);
+	chip->path = gpiod_strdup(path);
 	if (!chip->path)
 		goto err_free_chip;
 
+	chip->stats = gpiod_stats_new();
+	if (!chip->stats)
+		goto err_free_path;
+
 	chip->fd = fd;
 
 	return chip;
 
+err_free_path:
+	gpiod_free(chip->path);
 err_free_chip:
-	free(chip);
+	gpiod_free(chip);
 err_close_fd:
-	close(fd);
+	gpiod_sys_close(fd);
 
 	return NULL;
 }
@@ -61,18 +75,21 @@ GPIOD_API void gpiod_chip_close(struct gpiod_chip *chip)
 	if (!chip)
 		return;
 
-	close(chip->fd);
-	free(chip->path);
-	free(chip);
+	gpiod_sys_close(chip->fd);
+	gpiod_free(chip->name_index);
+	gpiod_free(chip->path);
+	gpiod_stats_free(chip->stats);
+	gpiod_free(chip);
 }
 
-static int read_chip_info(int fd, struct gpiochip_info *info)
+static int read_chip_info(struct gpiod_chip *chip, struct gpiochip_info *info)
 {
 	int ret;
 
 	memset(info, 0, sizeof(*info));
 
-	ret = ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, info);
+	ret = gpiod_stats_ioctl(chip->stats, GPIOD_STATS_IOCTL_INFO, chip->fd,
+				GPIO_GET_CHIPINFO_IOCTL, info);
 	if (ret)
 		return -1;
 
@@ -86,7 +103,7 @@ GPIOD_API struct gpiod_chip_info *gpiod_chip_get_info(struct gpiod_chip *chip)
 
 	assert(chip);
 
-	ret = read_chip_info(chip->fd, &info);
+	ret = read_chip_info(chip, &info);
 	if (ret < 0)
 		return NULL;
 
@@ -100,7 +117,7 @@ GPIOD_API const char *gpiod_chip_get_path(struct gpiod_chip *chip)
 	return chip->path;
 }
 
-static int chip_read_line_info(int fd, unsigned int offset,
+static int chip_read_line_info(struct gpiod_chip *chip, unsigned int offset,
 			       struct gpio_v2_line_info *info, bool watch)
 {
 	int ret, cmd;
@@ -111,13 +128,20 @@ static int chip_read_line_info(int fd, unsigned int offset,
 	cmd = watch ? GPIO_V2_GET_LINEINFO_WATCH_IOCTL :
 		      GPIO_V2_GET_LINEINFO_IOCTL;
 
-	ret = ioctl(fd, cmd, info);
+	ret = gpiod_stats_ioctl(chip->stats, GPIOD_STATS_IOCTL_INFO, chip->fd,
+				cmd, info);
 	if (ret)
 		return -1;
 
 	return 0;
 }
 
+int gpiod_chip_read_line_info(struct gpiod_chip *chip, unsigned int offset,
+			      struct gpio_v2_line_info *info)
+{
+	return chip_read_line_info(chip, offset, info, false);
+}
+
 static struct gpiod_line_info *
 chip_get_line_info(struct gpiod_chip *chip, unsigned int offset, bool watch)
 {
@@ -126,7 +150,7 @@ chip_get_line_info(struct gpiod_chip *chip, unsigned int offset, bool watch)
 
 	assert(chip);
 
-	ret = chip_read_line_info(chip->fd, offset, &info, watch);
+	ret = chip_read_line_info(chip, offset, &info, watch);
 	if (ret)
 		return NULL;
 
@@ -145,12 +169,119 @@ gpiod_chip_watch_line_info(struct gpiod_chip *chip, unsigned int offset)
 	return chip_get_line_info(chip, offset, true);
 }
 
+static int unwatch_line_info(struct gpiod_chip *chip, unsigned int offset)
+{
+	return gpiod_stats_ioctl(chip->stats, GPIOD_STATS_IOCTL_INFO, chip->fd,
+				 GPIO_GET_LINEINFO_UNWATCH_IOCTL, &offset);
+}
+
 GPIOD_API int gpiod_chip_unwatch_line_info(struct gpiod_chip *chip,
 					   unsigned int offset)
 {
 	assert(chip);
 
-	return ioctl(chip->fd, GPIO_GET_LINEINFO_UNWATCH_IOCTL, &offset);
+	return unwatch_line_info(chip, offset);
+}
+
+static int chip_get_num_lines(struct gpiod_chip *chip, size_t *num_lines)
+{
+	struct gpiochip_info info;
+	int ret;
+
+	ret = read_chip_info(chip, &info);
+	if (ret < 0)
+		return -1;
+
+	*num_lines = info.lines;
+
+	return 0;
+}
+
+static unsigned int bulk_offset(const unsigned int *offsets, size_t idx)
+{
+	return offsets ? offsets[idx] : idx;
+}
+
+GPIOD_API int gpiod_chip_watch_line_infos(struct gpiod_chip *chip,
+					  const unsigned int *offsets,
+					  size_t num_offsets,
+					  struct gpiod_line_info **infos)
+{
+	struct gpio_v2_line_info uapi_info;
+	unsigned int offset;
+	int ret, errsv;
+	size_t i;
+
+	assert(chip);
+
+	if (!offsets) {
+		ret = chip_get_num_lines(chip, &num_offsets);
+		if (ret)
+			return -1;
+	}
+
+	for (i = 0; i < num_offsets; i++) {
+		ret = chip_read_line_info(chip, bulk_offset(offsets, i),
+					  &uapi_info, true);
+		if (ret)
+			goto err_unwatch;
+
+		if (infos) {
+			infos[i] = gpiod_line_info_from_uapi(&uapi_info);
+			if (!infos[i]) {
+				/* Undo the watch of this line as well. */
+				i++;
+				goto err_unwatch;
+			}
+		}
+	}
+
+	return num_offsets;
+
+err_unwatch:
+	errsv = errno;
+
+	/* Don't leave a half-watched set of lines behind. */
+	while (i--) {
+		offset = bulk_offset(offsets, i);
+		unwatch_line_info(chip, offset);
+
+		if (infos) {
+			gpiod_line_info_free(infos[i]);
+			infos[i] = NULL;
+		}
+	}
+
+	errno = errsv;
+	return -1;
+}
+
+GPIOD_API int gpiod_chip_unwatch_line_infos(struct gpiod_chip *chip,
+					    const unsigned int *offsets,
+					    size_t num_offsets)
+{
+	unsigned int offset;
+	size_t i;
+	int ret;
+
+	assert(chip);
+
+	if (!offsets) {
+		ret = chip_get_num_lines(chip, &num_offsets);
+		if (ret)
+			return -1;
+	}
+
+	for (i = 0; i < num_offsets; i++) {
+		offset = bulk_offset(offsets, i);
+
+		ret = unwatch_line_info(chip, offset);
+		/* Lines that are not watched are not an error for "all". */
+		if (ret && !(offsets == NULL && errno == EBUSY))
+			return -1;
+	}
+
+	return 0;
 }
 
 GPIOD_API int gpiod_chip_get_fd(struct gpiod_chip *chip)
@@ -163,17 +294,161 @@ GPIOD_API int gpiod_chip_get_fd(struct gpiod_chip *chip)
 GPIOD_API int gpiod_chip_wait_info_event(struct gpiod_chip *chip,
 					 int64_t timeout_ns)
 {
+	uint64_t start;
+	int ret;
+
 	assert(chip);
 
-	return gpiod_poll_fd(chip->fd, timeout_ns);
+	start = gpiod_stats_now();
+	ret = gpiod_poll_fd(chip->fd, timeout_ns);
+	gpiod_stats_add_wait(chip->stats, start);
+
+	return ret;
+}
+
+GPIOD_API int
+gpiod_chip_wait_info_event_cancellable(struct gpiod_chip *chip,
+				       int64_t timeout_ns,
+				       struct gpiod_wait_cancel *cancel)
+{
+	uint64_t start;
+	int ret;
+
+	assert(chip);
+
+	start = gpiod_stats_now();
+	ret = gpiod_poll_fd_cancellable(chip->fd, timeout_ns, cancel);
+	gpiod_stats_add_wait(chip->stats, start);
+
+	return ret;
 }
 
 GPIOD_API struct gpiod_info_event *
 gpiod_chip_read_info_event(struct gpiod_chip *chip)
+{
+	struct gpiod_info_event *event;
+
+	assert(chip);
+
+	event = gpiod_info_event_read_fd(chip->fd);
+	if (event) {
+		gpiod_stats_add_read(chip->stats,
+				     sizeof(struct gpio_v2_line_info_changed), 1);
+		gpiod_trace(read_info_event, chip->fd,
+			gpiod_line_info_get_offset(
+				gpiod_info_event_get_line_info(event)),
+			gpiod_info_event_get_event_type(event));
+	}
+
+	return event;
+}
+
+GPIOD_API int gpiod_chip_read_info_events(struct gpiod_chip *chip,
+					  struct gpiod_info_event_buffer *buffer,
+					  size_t max_events)
+{
+	int ret;
+
+	assert(chip);
+
+	ret = gpiod_info_event_buffer_read_fd(chip->fd, buffer, max_events);
+	if (ret > 0) {
+		gpiod_stats_add_read(chip->stats,
+			ret * sizeof(struct gpio_v2_line_info_changed), ret);
+		gpiod_trace(read_info_events, chip->fd, ret);
+	}
+
+	return ret;
+}
+
+GPIOD_API struct gpiod_stats *gpiod_chip_get_stats(struct gpiod_chip *chip)
+{
+	assert(chip);
+
+	return gpiod_stats_copy(chip->stats);
+}
+
+GPIOD_API void gpiod_chip_reset_stats(struct gpiod_chip *chip)
 {
 	assert(chip);
 
-	return gpiod_info_event_read_fd(chip->fd);
+	gpiod_stats_reset(chip->stats);
+}
+
+static int name_index_entry_cmp(const void *p1, const void *p2)
+{
+	const struct name_index_entry *e1 = p1, *e2 = p2;
+	int ret;
+
+	ret = strcmp(e1->name, e2->name);
+	if (ret)
+		return ret;
+
+	/* Keep duplicates ordered by offset so that the first one wins. */
+	return e1->offset < e2->offset ? -1 : e1->offset > e2->offset;
+}
+
+static int name_index_build(struct gpiod_chip *chip)
+{
+	struct name_index_entry *index;
+	struct gpio_v2_line_info linfo;
+	struct gpiochip_info chinfo;
+	unsigned int offset;
+	int ret;
+
+	ret = read_chip_info(chip, &chinfo);
+	if (ret < 0)
+		return -1;
+
+	/* Allocate at least one entry so that an empty index is not NULL. */
+	index = gpiod_calloc(chinfo.lines > 0 ? chinfo.lines : 1,
+			     sizeof(*index));
+	if (!index)
+		return -1;
+
+	for (offset = 0; offset < chinfo.lines; offset++) {
+		ret = chip_read_line_info(chip, offset, &linfo, false);
+		if (ret) {
+			gpiod_free(index);
+			return -1;
+		}
+
+		memcpy(index[offset].name, linfo.name, sizeof(linfo.name));
+		index[offset].name[GPIO_MAX_NAME_SIZE - 1] = '\0';
+		index[offset].offset = offset;
+	}
+
+	qsort(index, chinfo.lines, sizeof(*index), name_index_entry_cmp);
+
+	gpiod_free(chip->name_index);
+	chip->name_index = index;
+	chip->name_index_size = chinfo.lines;
+
+	return 0;
+}
+
+static int name_index_lookup(struct gpiod_chip *chip, const char *name)
+{
+	size_t lo = 0, hi = chip->name_index_size, mid;
+	int ret;
+
+	/* Lower bound search - returns the lowest offset among duplicates. */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		ret = strcmp(chip->name_index[mid].name, name);
+		if (ret < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < chip->name_index_size &&
+	    strcmp(chip->name_index[lo].name, name) == 0)
+		return chip->name_index[lo].offset;
+
+	errno = ENOENT;
+	return -1;
 }
 
 GPIOD_API int gpiod_chip_get_line_offset_from_name(struct gpiod_chip *chip,
@@ -191,12 +466,22 @@ GPIOD_API int gpiod_chip_get_line_offset_from_name(struct gpiod_chip *chip,
 		return -1;
 	}
 
-	ret = read_chip_info(chip->fd, &chinfo);
+	if (chip->name_index_enabled) {
+		if (!chip->name_index) {
+			ret = name_index_build(chip);
+			if (ret)
+				return -1;
+		}
+
+		return name_index_lookup(chip, name);
+	}
+
+	ret = read_chip_info(chip, &chinfo);
 	if (ret < 0)
 		return -1;
 
 	for (offset = 0; offset < chinfo.lines; offset++) {
-		ret = chip_read_line_info(chip->fd, offset, &linfo, false);
+		ret = chip_read_line_info(chip, offset, &linfo, false);
 		if (ret)
 			return -1;
 
@@ -208,13 +493,120 @@ GPIOD_API int gpiod_chip_get_line_offset_from_name(struct gpiod_chip *chip,
 	return -1;
 }
 
+GPIOD_API void gpiod_chip_set_name_index(struct gpiod_chip *chip, bool enable)
+{
+	assert(chip);
+
+	chip->name_index_enabled = enable;
+	if (!enable)
+		gpiod_chip_invalidate_name_index(chip);
+}
+
+GPIOD_API bool gpiod_chip_get_name_index(struct gpiod_chip *chip)
+{
+	assert(chip);
+
+	return chip->name_index_enabled;
+}
+
+GPIOD_API int gpiod_chip_refresh_name_index(struct gpiod_chip *chip)
+{
+	int ret;
+
+	assert(chip);
+
+	ret = name_index_build(chip);
+	if (ret)
+		return -1;
+
+	chip->name_index_enabled = true;
+
+	return 0;
+}
+
+GPIOD_API void gpiod_chip_invalidate_name_index(struct gpiod_chip *chip)
+{
+	assert(chip);
+
+	gpiod_free(chip->name_index);
+	chip->name_index = NULL;
+	chip->name_index_size = 0;
+}
+
+static struct gpiod_line_request *
+request_lines(struct gpiod_chip *chip, struct gpio_v2_line_request *uapi_req,
+	      struct gpiod_request_config *req_cfg,
+	      struct gpiod_line_config *line_cfg)
+{
+	struct gpiod_line_request *request;
+	int ret;
+
+	ret = gpiod_stats_ioctl(chip->stats, GPIOD_STATS_IOCTL_CONFIG,
+				chip->fd, GPIO_V2_GET_LINE_IOCTL, uapi_req);
+	gpiod_trace(request_lines, chip->fd, ret < 0 ? -1 : uapi_req->fd,
+		    uapi_req->num_lines, uapi_req->offsets,
+		    gpiod_stats_get_last_ioctl_time_ns(chip->stats));
+	if (ret < 0)
+		return NULL;
+
+	request = gpiod_line_request_from_uapi(uapi_req, line_cfg,
+			req_cfg && gpiod_request_config_get_output_shadow(req_cfg));
+	if (!request) {
+		gpiod_sys_close(uapi_req->fd);
+		return NULL;
+	}
+
+	if (req_cfg && gpiod_request_config_get_input_shadow(req_cfg)) {
+		ret = gpiod_line_request_enable_input_shadow(request);
+		if (ret) {
+			gpiod_line_request_release(request);
+			return NULL;
+		}
+	}
+
+	if (req_cfg && gpiod_request_config_get_latency_histogram(req_cfg)) {
+		ret = gpiod_line_request_enable_latency_histogram(request);
+		if (ret) {
+			gpiod_line_request_release(request);
+			return NULL;
+		}
+	}
+
+	if (req_cfg && gpiod_request_config_get_edge_stats(req_cfg)) {
+		ret = gpiod_line_request_enable_edge_stats(request);
+		if (ret) {
+			gpiod_line_request_release(request);
+			return NULL;
+		}
+	}
+
+	if (req_cfg && gpiod_request_config_get_nonblocking(req_cfg)) {
+		ret = gpiod_line_request_set_nonblocking(request);
+		if (ret) {
+			gpiod_line_request_release(request);
+			return NULL;
+		}
+	}
+
+	if (req_cfg && gpiod_request_config_get_max_event_buffer_size(req_cfg)) {
+		ret = gpiod_line_request_enable_adaptive_buffer(request,
+			chip->fd, uapi_req->consumer,
+			gpiod_request_config_get_max_event_buffer_size(req_cfg));
+		if (ret) {
+			gpiod_line_request_release(request);
+			return NULL;
+		}
+	}
+
+	return request;
+}
+
 GPIOD_API struct gpiod_line_request *
 gpiod_chip_request_lines(struct gpiod_chip *chip,
 			 struct gpiod_request_config *req_cfg,
 			 struct gpiod_line_config *line_cfg)
 {
 	struct gpio_v2_line_request uapi_req;
-	struct gpiod_line_request *request;
 	int ret;
 
 	assert(chip);
@@ -233,15 +625,144 @@ gpiod_chip_request_lines(struct gpiod_chip *chip,
 	if (ret)
 		return NULL;
 
-	ret = ioctl(chip->fd, GPIO_V2_GET_LINE_IOCTL, &uapi_req);
-	if (ret < 0)
-		return NULL;
+	return request_lines(chip, &uapi_req, req_cfg, line_cfg);
+}
 
-	request = gpiod_line_request_from_uapi(&uapi_req);
-	if (!request) {
-		close(uapi_req.fd);
-		return NULL;
+GPIOD_API struct gpiod_line_request *
+gpiod_chip_request_lines_from_template(struct gpiod_chip *chip,
+				       struct gpiod_request_template *tmpl)
+{
+	struct gpio_v2_line_request uapi_req;
+
+	assert(chip);
+	assert(tmpl);
+
+	/* The kernel writes the file descriptor back into the structure. */
+	gpiod_request_template_get_uapi(tmpl, &uapi_req);
+
+	return request_lines(chip, &uapi_req,
+			     gpiod_request_template_get_request_config(tmpl),
+			     gpiod_request_template_get_line_config(tmpl));
+}
+
+static int offset_cmp(const void *p1, const void *p2)
+{
+	unsigned int o1 = *(const unsigned int *)p1,
+		     o2 = *(const unsigned int *)p2;
+
+	return o1 < o2 ? -1 : o1 > o2;
+}
+
+/*
+ * The kernel would refuse a line already requested by an earlier request of
+ * the batch - catch it before any lines are requested.
+ */
+static int check_batch_offsets(struct gpio_v2_line_request *uapi_reqs,
+			       size_t num_requests)
+{
+	size_t i, num_offsets = 0;
+	unsigned int *offsets;
+	int ret = 0;
+
+	for (i = 0; i < num_requests; i++)
+		num_offsets += uapi_reqs[i].num_lines;
+
+	offsets = gpiod_calloc(num_offsets, sizeof(*offsets));
+	if (!offsets)
+		return -1;
+
+	for (i = 0, num_offsets = 0; i < num_requests; i++) {
+		memcpy(offsets + num_offsets, uapi_reqs[i].offsets,
+		       uapi_reqs[i].num_lines * sizeof(*offsets));
+		num_offsets += uapi_reqs[i].num_lines;
 	}
 
-	return request;
+	qsort(offsets, num_offsets, sizeof(*offsets), offset_cmp);
+
+	for (i = 1; i < num_offsets; i++) {
+		if (offsets[i] == offsets[i - 1]) {
+			errno = EBUSY;
+			ret = -1;
+			break;
+		}
+	}
+
+	gpiod_free(offsets);
+
+	return ret;
+}
+
+GPIOD_API int
+gpiod_chip_request_lines_batch(struct gpiod_chip *chip,
+			       struct gpiod_request_config *const *req_cfgs,
+			       struct gpiod_line_config *const *line_cfgs,
+			       size_t num_requests,
+			       struct gpiod_line_request **requests)
+{
+	struct gpio_v2_line_request *uapi_reqs;
+	struct gpiod_request_config *req_cfg;
+	size_t i, j;
+	int ret = -1;
+
+	assert(chip);
+
+	if (!line_cfgs || !requests || !num_requests) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < num_requests; i++) {
+		if (!line_cfgs[i]) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	uapi_reqs = gpiod_calloc(num_requests, sizeof(*uapi_reqs));
+	if (!uapi_reqs)
+		return -1;
+
+	/* Translate the whole batch first so that bad configs fail early. */
+	for (i = 0; i < num_requests; i++) {
+		req_cfg = req_cfgs ? req_cfgs[i] : NULL;
+
+		if (req_cfg)
+			gpiod_request_config_to_uapi(req_cfg, &uapi_reqs[i]);
+
+		if (gpiod_line_config_to_uapi(line_cfgs[i], &uapi_reqs[i]))
+			goto out;
+
+		if (!uapi_reqs[i].num_lines) {
+			errno = EINVAL;
+			goto out;
+		}
+	}
+
+	if (check_batch_offsets(uapi_reqs, num_requests))
+		goto out;
+
+	for (i = 0; i < num_requests; i++) {
+		requests[i] = request_lines(chip, &uapi_reqs[i],
+					    req_cfgs ? req_cfgs[i] : NULL,
+					    line_cfgs[i]);
+		if (!requests[i]) {
+			ret = errno;
+
+			for (j = 0; j < i; j++) {
+				gpiod_line_request_release(requests[j]);
+				requests[j] = NULL;
+			}
+
+			errno = ret;
+			ret = -1;
+			goto out;
+		}
+	}
+
+	ret = 0;
+
+out:
+	gpiod_free(uapi_reqs);
+
+	return ret;
 }
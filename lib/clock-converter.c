@@ -0,0 +1,269 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC		1000000000ULL
+#define DEFAULT_REFRESH_NS	NSEC_PER_SEC
+/* Samples taken per refresh, the tightest one wins. */
+#define NUM_SAMPLES		4
+
+struct gpiod_clock_converter {
+	clockid_t from;
+	clockid_t to;
+	/* Added with wraparound so that negative offsets work too. */
+	uint64_t offset_ns;
+	uint64_t error_ns;
+	uint64_t refresh_interval_ns;
+	/* Monotonic time of the last refresh. */
+	uint64_t refreshed_ns;
+	/* Calibrated from pairs of timestamps instead of reading the clocks. */
+	bool calibrated;
+	uint64_t num_pairs;
+	int64_t min_delta_ns;
+	int64_t max_delta_ns;
+};
+
+static int line_clock_to_clockid(enum gpiod_line_clock clock, clockid_t *id)
+{
+	switch (clock) {
+	case GPIOD_LINE_CLOCK_MONOTONIC:
+		*id = CLOCK_MONOTONIC;
+		return 0;
+	case GPIOD_LINE_CLOCK_REALTIME:
+		*id = CLOCK_REALTIME;
+		return 0;
+	case GPIOD_LINE_CLOCK_HTE:
+		/* The timestamp engine can't be read from user space. */
+		errno = ENOTSUP;
+		return -1;
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+static uint64_t read_clock(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+GPIOD_API struct gpiod_clock_converter *
+gpiod_clock_converter_new(enum gpiod_line_clock from, enum gpiod_line_clock to)
+{
+	struct gpiod_clock_converter *conv;
+	clockid_t from_id, to_id;
+
+	if (line_clock_to_clockid(from, &from_id) ||
+	    line_clock_to_clockid(to, &to_id))
+		return NULL;
+
+	conv = gpiod_malloc(sizeof(*conv));
+	if (!conv)
+		return NULL;
+
+	memset(conv, 0, sizeof(*conv));
+	conv->from = from_id;
+	conv->to = to_id;
+	conv->refresh_interval_ns = DEFAULT_REFRESH_NS;
+
+	gpiod_clock_converter_refresh(conv);
+
+	return conv;
+}
+
+GPIOD_API struct gpiod_clock_converter *
+gpiod_clock_converter_new_calibrated(enum gpiod_line_clock from,
+				     enum gpiod_line_clock to)
+{
+	struct gpiod_clock_converter *conv;
+
+	if (from < GPIOD_LINE_CLOCK_MONOTONIC || from > GPIOD_LINE_CLOCK_HTE ||
+	    to < GPIOD_LINE_CLOCK_MONOTONIC || to > GPIOD_LINE_CLOCK_HTE) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	conv = gpiod_malloc(sizeof(*conv));
+	if (!conv)
+		return NULL;
+
+	memset(conv, 0, sizeof(*conv));
+	conv->calibrated = true;
+
+	return conv;
+}
+
+GPIOD_API void gpiod_clock_converter_free(struct gpiod_clock_converter *conv)
+{
+	gpiod_free(conv);
+}
+
+GPIOD_API void
+gpiod_clock_converter_set_refresh_interval_ns(
+		struct gpiod_clock_converter *conv, uint64_t interval_ns)
+{
+	assert(conv);
+
+	conv->refresh_interval_ns = interval_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_clock_converter_get_refresh_interval_ns(
+		struct gpiod_clock_converter *conv)
+{
+	assert(conv);
+
+	return conv->refresh_interval_ns;
+}
+
+GPIOD_API void gpiod_clock_converter_refresh(struct gpiod_clock_converter *conv)
+{
+	uint64_t before, after, from, width, best = UINT64_MAX;
+	int i;
+
+	assert(conv);
+
+	/* There is no clock to read, the offset only changes with new pairs. */
+	if (conv->calibrated)
+		return;
+
+	conv->refreshed_ns = read_clock(CLOCK_MONOTONIC);
+
+	if (conv->from == conv->to) {
+		conv->offset_ns = 0;
+		conv->error_ns = 0;
+		return;
+	}
+
+	/*
+	 * The source clock is read between two reads of the target clock. The
+	 * midpoint of the pair is the best estimate of the target time at the
+	 * source read, off by at most half the width of the pair. Preemption
+	 * only ever widens a pair, so the narrowest one is kept.
+	 */
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		before = read_clock(conv->to);
+		from = read_clock(conv->from);
+		after = read_clock(conv->to);
+
+		width = after - before;
+		if (width >= best)
+			continue;
+
+		best = width;
+		conv->offset_ns = before + width / 2 - from;
+		/* Round up so that the bound holds for odd widths too. */
+		conv->error_ns = (width + 1) / 2;
+	}
+}
+
+GPIOD_API int
+gpiod_clock_converter_add_pair(struct gpiod_clock_converter *conv,
+			       uint64_t from_ns, uint64_t to_ns)
+{
+	int64_t delta;
+
+	assert(conv);
+
+	if (!conv->calibrated) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Wraps around like the offset so that negative differences work. */
+	delta = (int64_t)(to_ns - from_ns);
+
+	if (!conv->num_pairs || delta < conv->min_delta_ns)
+		conv->min_delta_ns = delta;
+	if (!conv->num_pairs || delta > conv->max_delta_ns)
+		conv->max_delta_ns = delta;
+
+	conv->num_pairs++;
+
+	/*
+	 * The reference timestamps are taken in software after the edge, so
+	 * they are only ever late. The pair with the shortest latency comes
+	 * closest to the true offset and the spread of the differences bounds
+	 * how late the other reference timestamps are.
+	 */
+	conv->offset_ns = (uint64_t)conv->min_delta_ns;
+	conv->error_ns = (uint64_t)(conv->max_delta_ns - conv->min_delta_ns);
+
+	return 0;
+}
+
+GPIOD_API uint64_t
+gpiod_clock_converter_get_num_pairs(struct gpiod_clock_converter *conv)
+{
+	assert(conv);
+
+	return conv->num_pairs;
+}
+
+GPIOD_API void
+gpiod_clock_converter_convert(struct gpiod_clock_converter *conv,
+			      const uint64_t *timestamps, uint64_t *converted,
+			      size_t num_timestamps)
+{
+	uint64_t offset;
+	size_t i;
+
+	assert(conv);
+
+	if (!num_timestamps)
+		return;
+
+	/* The age is checked once per batch, not for every timestamp. */
+	if (conv->refresh_interval_ns &&
+	    read_clock(CLOCK_MONOTONIC) - conv->refreshed_ns >=
+						conv->refresh_interval_ns)
+		gpiod_clock_converter_refresh(conv);
+
+	/*
+	 * Keep the loop trivial so that the compiler vectorizes it. The
+	 * buffers may be the same, so they can't be declared restrict, but the
+	 * compiler checks for overlap once and takes the vector path anyway.
+	 */
+	offset = conv->offset_ns;
+	for (i = 0; i < num_timestamps; i++)
+		converted[i] = timestamps[i] + offset;
+}
+
+GPIOD_API uint64_t
+gpiod_clock_converter_convert_one(struct gpiod_clock_converter *conv,
+				  uint64_t timestamp)
+{
+	gpiod_clock_converter_convert(conv, &timestamp, &timestamp, 1);
+
+	return timestamp;
+}
+
+GPIOD_API int64_t
+gpiod_clock_converter_get_offset_ns(struct gpiod_clock_converter *conv)
+{
+	assert(conv);
+
+	return (int64_t)conv->offset_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_clock_converter_get_error_ns(struct gpiod_clock_converter *conv)
+{
+	assert(conv);
+
+	return conv->error_ns;
+}
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+enum stage_type {
+	STAGE_CALLBACK = 1,
+	STAGE_EDGE_FILTER,
+	STAGE_MIN_INTERVAL,
+	STAGE_PULSE_DECODER,
+};
+
+struct pipeline_stage {
+	enum stage_type type;
+	uint64_t num_dropped;
+	gpiod_edge_event_stage_cb callback;
+	void *user_data;
+	struct gpiod_pulse_decoder *decoder;
+	unsigned int offset;
+	/* Event types of the line to keep, indexed by the uAPI event id. */
+	bool keep[3];
+	uint64_t interval_ns;
+	bool seen;
+	uint64_t last_ts_ns;
+};
+
+struct gpiod_edge_event_pipeline {
+	struct pipeline_stage *stages;
+	size_t num_stages;
+};
+
+GPIOD_API struct gpiod_edge_event_pipeline *gpiod_edge_event_pipeline_new(void)
+{
+	struct gpiod_edge_event_pipeline *pipeline;
+
+	pipeline = gpiod_malloc(sizeof(*pipeline));
+	if (!pipeline)
+		return NULL;
+
+	memset(pipeline, 0, sizeof(*pipeline));
+
+	return pipeline;
+}
+
+GPIOD_API void
+gpiod_edge_event_pipeline_free(struct gpiod_edge_event_pipeline *pipeline)
+{
+	if (!pipeline)
+		return;
+
+	gpiod_free(pipeline->stages);
+	gpiod_free(pipeline);
+}
+
+static struct pipeline_stage *
+add_stage(struct gpiod_edge_event_pipeline *pipeline, enum stage_type type)
+{
+	struct pipeline_stage *stages, *stage;
+
+	stages = gpiod_realloc(pipeline->stages,
+			       pipeline->num_stages * sizeof(*stages),
+			       (pipeline->num_stages + 1) * sizeof(*stages));
+	if (!stages)
+		return NULL;
+
+	pipeline->stages = stages;
+	stage = &stages[pipeline->num_stages++];
+	memset(stage, 0, sizeof(*stage));
+	stage->type = type;
+
+	return stage;
+}
+
+GPIOD_API int
+gpiod_edge_event_pipeline_add_stage(struct gpiod_edge_event_pipeline *pipeline,
+				    gpiod_edge_event_stage_cb callback,
+				    void *user_data)
+{
+	struct pipeline_stage *stage;
+
+	assert(pipeline);
+
+	if (!callback) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	stage = add_stage(pipeline, STAGE_CALLBACK);
+	if (!stage)
+		return -1;
+
+	stage->callback = callback;
+	stage->user_data = user_data;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_edge_event_pipeline_add_edge_filter(
+		struct gpiod_edge_event_pipeline *pipeline, unsigned int offset,
+		enum gpiod_line_edge edge)
+{
+	struct pipeline_stage *stage;
+
+	assert(pipeline);
+
+	if (edge < GPIOD_LINE_EDGE_NONE || edge > GPIOD_LINE_EDGE_BOTH) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	stage = add_stage(pipeline, STAGE_EDGE_FILTER);
+	if (!stage)
+		return -1;
+
+	stage->offset = offset;
+	stage->keep[GPIO_V2_LINE_EVENT_RISING_EDGE] =
+		edge == GPIOD_LINE_EDGE_RISING || edge == GPIOD_LINE_EDGE_BOTH;
+	stage->keep[GPIO_V2_LINE_EVENT_FALLING_EDGE] =
+		edge == GPIOD_LINE_EDGE_FALLING || edge == GPIOD_LINE_EDGE_BOTH;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_edge_event_pipeline_add_min_interval(
+		struct gpiod_edge_event_pipeline *pipeline, unsigned int offset,
+		uint64_t interval_ns)
+{
+	struct pipeline_stage *stage;
+
+	assert(pipeline);
+
+	stage = add_stage(pipeline, STAGE_MIN_INTERVAL);
+	if (!stage)
+		return -1;
+
+	stage->offset = offset;
+	stage->interval_ns = interval_ns;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_edge_event_pipeline_add_pulse_decoder(
+		struct gpiod_edge_event_pipeline *pipeline,
+		struct gpiod_pulse_decoder *decoder)
+{
+	struct pipeline_stage *stage;
+
+	assert(pipeline);
+
+	if (!decoder) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	stage = add_stage(pipeline, STAGE_PULSE_DECODER);
+	if (!stage)
+		return -1;
+
+	stage->decoder = decoder;
+
+	return 0;
+}
+
+GPIOD_API size_t gpiod_edge_event_pipeline_get_num_stages(
+		struct gpiod_edge_event_pipeline *pipeline)
+{
+	assert(pipeline);
+
+	return pipeline->num_stages;
+}
+
+GPIOD_API uint64_t gpiod_edge_event_pipeline_get_num_dropped(
+		struct gpiod_edge_event_pipeline *pipeline, size_t stage)
+{
+	assert(pipeline);
+
+	if (stage >= pipeline->num_stages)
+		return 0;
+
+	return pipeline->stages[stage].num_dropped;
+}
+
+GPIOD_API void
+gpiod_edge_event_pipeline_reset(struct gpiod_edge_event_pipeline *pipeline)
+{
+	size_t i;
+
+	assert(pipeline);
+
+	for (i = 0; i < pipeline->num_stages; i++) {
+		pipeline->stages[i].num_dropped = 0;
+		pipeline->stages[i].seen = false;
+		pipeline->stages[i].last_ts_ns = 0;
+	}
+}
+
+static bool keep_event(struct pipeline_stage *stage,
+		       const struct gpiod_edge_event_record *record)
+{
+	if (record->line_offset != stage->offset)
+		return true;
+
+	if (stage->type == STAGE_EDGE_FILTER)
+		return record->event_type < 3 && stage->keep[record->event_type];
+
+	/* The realtime clock may have been stepped back since. */
+	if (stage->seen && record->timestamp_ns >= stage->last_ts_ns &&
+	    record->timestamp_ns - stage->last_ts_ns < stage->interval_ns)
+		return false;
+
+	stage->seen = true;
+	stage->last_ts_ns = record->timestamp_ns;
+
+	return true;
+}
+
+/* Both built-in filters compact the records in a single pass. */
+static size_t filter_records(struct pipeline_stage *stage,
+			     struct gpiod_edge_event_record *records,
+			     size_t num_events)
+{
+	size_t i, num_kept;
+
+	for (i = 0, num_kept = 0; i < num_events; i++) {
+		if (!keep_event(stage, &records[i]))
+			continue;
+
+		if (i != num_kept)
+			records[num_kept] = records[i];
+		num_kept++;
+	}
+
+	return num_kept;
+}
+
+static size_t run_stage(struct pipeline_stage *stage,
+			struct gpiod_edge_event_record *records,
+			size_t num_events)
+{
+	size_t num_kept;
+
+	switch (stage->type) {
+	case STAGE_CALLBACK:
+		num_kept = stage->callback(records, num_events,
+					   stage->user_data);
+		/* Don't let a misbehaving stage expose stale records. */
+		return num_kept < num_events ? num_kept : num_events;
+	case STAGE_EDGE_FILTER:
+	case STAGE_MIN_INTERVAL:
+		return filter_records(stage, records, num_events);
+	case STAGE_PULSE_DECODER:
+		gpiod_pulse_decoder_add_uapi_events(stage->decoder,
+			(const struct gpio_v2_line_event *)records, num_events);
+		return num_events;
+	}
+
+	return num_events;
+}
+
+GPIOD_API int
+gpiod_edge_event_pipeline_process(struct gpiod_edge_event_pipeline *pipeline,
+				  struct gpiod_edge_event_buffer *buffer)
+{
+	struct gpiod_edge_event_record *records;
+	size_t i, num_events, num_kept, num_dropped;
+
+	assert(pipeline);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	records = gpiod_edge_event_buffer_get_data(buffer);
+	num_events = gpiod_edge_event_buffer_get_num_events(buffer);
+	num_dropped = gpiod_edge_event_buffer_get_num_dropped(buffer);
+
+	for (i = 0; i < pipeline->num_stages && num_events; i++) {
+		num_kept = run_stage(&pipeline->stages[i], records, num_events);
+		pipeline->stages[i].num_dropped += num_events - num_kept;
+		num_events = num_kept;
+	}
+
+	/* Drops the stale columns but keeps the count of lost events. */
+	gpiod_edge_event_buffer_set_num_events(buffer, num_events);
+	gpiod_edge_event_buffer_set_num_dropped(buffer, num_dropped);
+
+	return num_events;
+}
@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <gpiod.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -12,25 +13,69 @@
 
 /* As defined in the kernel. */
 #define EVENT_BUFFER_MAX_CAPACITY (GPIO_V2_LINES_MAX * 16)
-
+/*
+ * Reads from a few busy lines complete in batches of tens of events - start
+ * there and let buffers seeing full batches grow up to what the kernel can
+ * queue for a request. See the edge_event_read results of gpiod-bench.
+ */
+#define EVENT_BUFFER_DEFAULT_CAPACITY		64
+#define EVENT_BUFFER_DEFAULT_MAX_CAPACITY	EVENT_BUFFER_MAX_CAPACITY
+
+/* Process-wide sizing of the buffers created with a capacity of 0. */
+static size_t default_capacity = EVENT_BUFFER_DEFAULT_CAPACITY;
+static size_t default_max_capacity = EVENT_BUFFER_DEFAULT_MAX_CAPACITY;
+
+/*
+ * The edge event is a thin wrapper around the raw kernel record. Buffers read
+ * straight into an array of these and the accessors decode the fields on
+ * demand so that only the events actually returned by the kernel are touched.
+ */
 struct gpiod_edge_event {
-	enum gpiod_edge_event_type event_type;
-	uint64_t timestamp;
-	unsigned int line_offset;
-	unsigned long global_seqno;
-	unsigned long line_seqno;
+	struct gpio_v2_line_event data;
 };
 
+#define RECORD_FIELD_MATCHES(rec, uapi) \
+	(offsetof(struct gpiod_edge_event_record, rec) == \
+	 offsetof(struct gpio_v2_line_event, uapi))
+
+/* The public records are the kernel records reinterpreted. */
+typedef char record_layout_matches_uapi[
+	(sizeof(struct gpiod_edge_event_record) ==
+			sizeof(struct gpio_v2_line_event) &&
+	 RECORD_FIELD_MATCHES(timestamp_ns, timestamp_ns) &&
+	 RECORD_FIELD_MATCHES(event_type, id) &&
+	 RECORD_FIELD_MATCHES(line_offset, offset) &&
+	 RECORD_FIELD_MATCHES(global_seqno, seqno) &&
+	 RECORD_FIELD_MATCHES(line_seqno, line_seqno) &&
+	 (int)GPIO_V2_LINE_EVENT_RISING_EDGE ==
+			(int)GPIOD_EDGE_EVENT_RISING_EDGE &&
+	 (int)GPIO_V2_LINE_EVENT_FALLING_EDGE ==
+			(int)GPIOD_EDGE_EVENT_FALLING_EDGE) ? 1 : -1];
+
 struct gpiod_edge_event_buffer {
 	size_t capacity;
+	/* Set for buffers created with gpiod_edge_event_buffer_new_adaptive(). */
+	bool adaptive;
+	/* The last read filled the buffer, grow it before the next one. */
+	bool grow;
 	size_t num_events;
+	/* Events the kernel dropped before those stored in the buffer. */
+	size_t num_dropped;
 	struct gpiod_edge_event *events;
-	struct gpio_v2_line_event *event_data;
+	/*
+	 * Column-wise copies of the most used fields, allocated and decoded
+	 * on first access after each read.
+	 */
+	size_t columns_capacity;
+	bool columns_valid;
+	uint64_t *timestamps;
+	unsigned int *offsets;
+	enum gpiod_edge_event_type *types;
 };
 
 GPIOD_API void gpiod_edge_event_free(struct gpiod_edge_event *event)
 {
-	free(event);
+	gpiod_free(event);
 }
 
 GPIOD_API struct gpiod_edge_event *
@@ -40,7 +85,7 @@ gpiod_edge_event_copy(struct gpiod_edge_event *event)
 
 	assert(event);
 
-	copy = malloc(sizeof(*event));
+	copy = gpiod_malloc(sizeof(*event));
 	if (!copy)
 		return NULL;
 
@@ -54,7 +99,9 @@ gpiod_edge_event_get_event_type(struct gpiod_edge_event *event)
 {
 	assert(event);
 
-	return event->event_type;
+	return event->data.id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
+			GPIOD_EDGE_EVENT_RISING_EDGE :
+			GPIOD_EDGE_EVENT_FALLING_EDGE;
 }
 
 GPIOD_API uint64_t
@@ -62,7 +109,7 @@ gpiod_edge_event_get_timestamp_ns(struct gpiod_edge_event *event)
 {
 	assert(event);
 
-	return event->timestamp;
+	return event->data.timestamp_ns;
 }
 
 GPIOD_API unsigned int
@@ -70,7 +117,7 @@ gpiod_edge_event_get_line_offset(struct gpiod_edge_event *event)
 {
 	assert(event);
 
-	return event->line_offset;
+	return event->data.offset;
 }
 
 GPIOD_API unsigned long
@@ -78,7 +125,7 @@ gpiod_edge_event_get_global_seqno(struct gpiod_edge_event *event)
 {
 	assert(event);
 
-	return event->global_seqno;
+	return event->data.seqno;
 }
 
 GPIOD_API unsigned long
@@ -86,7 +133,43 @@ gpiod_edge_event_get_line_seqno(struct gpiod_edge_event *event)
 {
 	assert(event);
 
-	return event->line_seqno;
+	return event->data.line_seqno;
+}
+
+static size_t clamp_capacity(size_t capacity, size_t fallback)
+{
+	if (capacity == 0)
+		return fallback;
+	if (capacity > EVENT_BUFFER_MAX_CAPACITY)
+		return EVENT_BUFFER_MAX_CAPACITY;
+
+	return capacity;
+}
+
+GPIOD_API void gpiod_set_default_event_buffer_capacity(size_t capacity)
+{
+	__atomic_store_n(&default_capacity,
+			 clamp_capacity(capacity,
+					EVENT_BUFFER_DEFAULT_CAPACITY),
+			 __ATOMIC_RELAXED);
+}
+
+GPIOD_API size_t gpiod_get_default_event_buffer_capacity(void)
+{
+	return __atomic_load_n(&default_capacity, __ATOMIC_RELAXED);
+}
+
+GPIOD_API void gpiod_set_max_event_buffer_capacity(size_t capacity)
+{
+	__atomic_store_n(&default_max_capacity,
+			 clamp_capacity(capacity,
+					EVENT_BUFFER_DEFAULT_MAX_CAPACITY),
+			 __ATOMIC_RELAXED);
+}
+
+GPIOD_API size_t gpiod_get_max_event_buffer_capacity(void)
+{
+	return __atomic_load_n(&default_max_capacity, __ATOMIC_RELAXED);
 }
 
 GPIOD_API struct gpiod_edge_event_buffer *
@@ -94,30 +177,33 @@ gpiod_edge_event_buffer_new(size_t capacity)
 {
 	struct gpiod_edge_event_buffer *buf;
 
-	if (capacity == 0)
-		capacity = 64;
-	if (capacity > EVENT_BUFFER_MAX_CAPACITY)
-		capacity = EVENT_BUFFER_MAX_CAPACITY;
+	capacity = clamp_capacity(capacity,
+				  gpiod_get_default_event_buffer_capacity());
 
-	buf = malloc(sizeof(*buf));
+	buf = gpiod_malloc(sizeof(*buf));
 	if (!buf)
 		return NULL;
 
 	memset(buf, 0, sizeof(*buf));
 	buf->capacity = capacity;
 
-	buf->events = calloc(capacity, sizeof(*buf->events));
+	buf->events = gpiod_calloc(capacity, sizeof(*buf->events));
 	if (!buf->events) {
-		free(buf);
+		gpiod_free(buf);
 		return NULL;
 	}
 
-	buf->event_data = calloc(capacity, sizeof(*buf->event_data));
-	if (!buf->event_data) {
-		free(buf->events);
-		free(buf);
-		return NULL;
-	}
+	return buf;
+}
+
+GPIOD_API struct gpiod_edge_event_buffer *
+gpiod_edge_event_buffer_new_adaptive(void)
+{
+	struct gpiod_edge_event_buffer *buf;
+
+	buf = gpiod_edge_event_buffer_new(0);
+	if (buf)
+		buf->adaptive = true;
 
 	return buf;
 }
@@ -136,9 +222,11 @@ gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer)
 	if (!buffer)
 		return;
 
-	free(buffer->events);
-	free(buffer->event_data);
-	free(buffer);
+	gpiod_free(buffer->types);
+	gpiod_free(buffer->offsets);
+	gpiod_free(buffer->timestamps);
+	gpiod_free(buffer->events);
+	gpiod_free(buffer);
 }
 
 GPIOD_API struct gpiod_edge_event *
@@ -163,13 +251,195 @@ gpiod_edge_event_buffer_get_num_events(struct gpiod_edge_event_buffer *buffer)
 	return buffer->num_events;
 }
 
+GPIOD_API size_t
+gpiod_edge_event_buffer_get_num_dropped(struct gpiod_edge_event_buffer *buffer)
+{
+	assert(buffer);
+
+	return buffer->num_dropped;
+}
+
+static int alloc_columns(struct gpiod_edge_event_buffer *buffer)
+{
+	enum gpiod_edge_event_type *types;
+	unsigned int *offsets;
+	uint64_t *timestamps;
+
+	timestamps = gpiod_calloc(buffer->capacity, sizeof(*timestamps));
+	offsets = gpiod_calloc(buffer->capacity, sizeof(*offsets));
+	types = gpiod_calloc(buffer->capacity, sizeof(*types));
+	if (!timestamps || !offsets || !types) {
+		gpiod_free(types);
+		gpiod_free(offsets);
+		gpiod_free(timestamps);
+		return -1;
+	}
+
+	gpiod_free(buffer->types);
+	gpiod_free(buffer->offsets);
+	gpiod_free(buffer->timestamps);
+
+	buffer->timestamps = timestamps;
+	buffer->offsets = offsets;
+	buffer->types = types;
+	buffer->columns_capacity = buffer->capacity;
+
+	return 0;
+}
+
+/*
+ * Each column is written in its own pass so that the loops are simple
+ * strided loads the compiler is free to vectorize.
+ */
+static int decode_columns(struct gpiod_edge_event_buffer *buffer)
+{
+	const struct gpiod_edge_event *events = buffer->events;
+	size_t i, num_events = buffer->num_events;
+	int ret;
+
+	if (buffer->columns_valid)
+		return 0;
+
+	if (buffer->columns_capacity < buffer->capacity) {
+		ret = alloc_columns(buffer);
+		if (ret)
+			return -1;
+	}
+
+	for (i = 0; i < num_events; i++)
+		buffer->timestamps[i] = events[i].data.timestamp_ns;
+
+	for (i = 0; i < num_events; i++)
+		buffer->offsets[i] = events[i].data.offset;
+
+	for (i = 0; i < num_events; i++)
+		buffer->types[i] =
+			events[i].data.id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
+				GPIOD_EDGE_EVENT_RISING_EDGE :
+				GPIOD_EDGE_EVENT_FALLING_EDGE;
+
+	buffer->columns_valid = true;
+
+	return 0;
+}
+
+GPIOD_API const uint64_t *
+gpiod_edge_event_buffer_get_timestamps_ns(
+		struct gpiod_edge_event_buffer *buffer)
+{
+	assert(buffer);
+
+	if (decode_columns(buffer))
+		return NULL;
+
+	return buffer->timestamps;
+}
+
+GPIOD_API const unsigned int *
+gpiod_edge_event_buffer_get_line_offsets(struct gpiod_edge_event_buffer *buffer)
+{
+	assert(buffer);
+
+	if (decode_columns(buffer))
+		return NULL;
+
+	return buffer->offsets;
+}
+
+GPIOD_API const enum gpiod_edge_event_type *
+gpiod_edge_event_buffer_get_event_types(struct gpiod_edge_event_buffer *buffer)
+{
+	assert(buffer);
+
+	if (decode_columns(buffer))
+		return NULL;
+
+	return buffer->types;
+}
+
+GPIOD_API const struct gpiod_edge_event_record *
+gpiod_edge_event_buffer_get_records(struct gpiod_edge_event_buffer *buffer)
+{
+	assert(buffer);
+
+	return (const struct gpiod_edge_event_record *)buffer->events;
+}
+
+/*
+ * The events array has the layout of an array of raw kernel records so that
+ * it can be filled directly by asynchronous reads.
+ */
+void *gpiod_edge_event_buffer_get_data(struct gpiod_edge_event_buffer *buffer)
+{
+	return buffer->events;
+}
+
+void gpiod_edge_event_buffer_set_num_events(
+		struct gpiod_edge_event_buffer *buffer, size_t num_events)
+{
+	buffer->num_events = num_events;
+	buffer->num_dropped = 0;
+	buffer->columns_valid = false;
+}
+
+int gpiod_edge_event_buffer_reserve(struct gpiod_edge_event_buffer *buffer,
+				    size_t capacity)
+{
+	struct gpiod_edge_event *events;
+
+	if (capacity <= buffer->capacity)
+		return 0;
+
+	events = gpiod_realloc(buffer->events,
+			       buffer->capacity * sizeof(*events),
+			       capacity * sizeof(*events));
+	if (!events)
+		return -1;
+
+	buffer->events = events;
+	buffer->capacity = capacity;
+
+	return 0;
+}
+
+void gpiod_edge_event_buffer_set_num_dropped(
+		struct gpiod_edge_event_buffer *buffer, size_t num_dropped)
+{
+	buffer->num_dropped = num_dropped;
+}
+
+void gpiod_edge_event_buffer_account_read(
+		struct gpiod_edge_event_buffer *buffer, bool full)
+{
+	if (buffer->adaptive && full)
+		buffer->grow = true;
+}
+
+/*
+ * Growing moves the events so it's only done once the caller no longer holds
+ * pointers into the buffer, right before the next read.
+ */
+void gpiod_edge_event_buffer_adapt(struct gpiod_edge_event_buffer *buffer)
+{
+	size_t max = gpiod_get_max_event_buffer_capacity();
+
+	if (!buffer->grow)
+		return;
+
+	buffer->grow = false;
+
+	/* Keep the old capacity if the allocation fails and try again later. */
+	if (buffer->capacity < max)
+		gpiod_edge_event_buffer_reserve(buffer,
+				buffer->capacity * 2 < max ?
+					buffer->capacity * 2 : max);
+}
+
 int gpiod_edge_event_buffer_read_fd(int fd,
 				    struct gpiod_edge_event_buffer *buffer,
 				    size_t max_events)
 {
-	struct gpio_v2_line_event *curr;
-	struct gpiod_edge_event *event;
-	size_t i;
+	bool unlimited;
 	ssize_t rd;
 
 	if (!buffer) {
@@ -177,36 +447,34 @@ int gpiod_edge_event_buffer_read_fd(int fd,
 		return -1;
 	}
 
-	memset(buffer->event_data, 0,
-	       sizeof(*buffer->event_data) * buffer->capacity);
-	memset(buffer->events, 0, sizeof(*buffer->events) * buffer->capacity);
+	/*
+	 * A read limited by the caller says nothing about the size of the
+	 * batches the kernel has queued. Callers passing the capacity they
+	 * got before the buffer grew aren't limiting it.
+	 */
+	unlimited = max_events >= buffer->capacity;
+
+	gpiod_edge_event_buffer_adapt(buffer);
 
 	if (max_events > buffer->capacity)
 		max_events = buffer->capacity;
 
-	rd = read(fd, buffer->event_data,
-		  max_events * sizeof(*buffer->event_data));
+	buffer->num_events = 0;
+	buffer->num_dropped = 0;
+	buffer->columns_valid = false;
+
+	rd = gpiod_sys_read(fd, buffer->events,
+			    max_events * sizeof(*buffer->events));
 	if (rd < 0) {
 		return -1;
-	} else if ((unsigned int)rd < sizeof(*buffer->event_data)) {
+	} else if ((unsigned int)rd < sizeof(*buffer->events)) {
 		errno = EIO;
 		return -1;
 	}
 
-	buffer->num_events = rd / sizeof(*buffer->event_data);
-
-	for (i = 0; i < buffer->num_events; i++) {
-		curr = &buffer->event_data[i];
-		event = &buffer->events[i];
+	buffer->num_events = rd / sizeof(*buffer->events);
+	gpiod_edge_event_buffer_account_read(buffer,
+			unlimited && buffer->num_events == max_events);
 
-		event->line_offset = curr->offset;
-		event->event_type = curr->id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
-					    GPIOD_EDGE_EVENT_RISING_EDGE :
-					    GPIOD_EDGE_EVENT_FALLING_EDGE;
-		event->timestamp = curr->timestamp_ns;
-		event->global_seqno = curr->seqno;
-		event->line_seqno = curr->line_seqno;
-	}
-
-	return i;
+	return buffer->num_events;
 }
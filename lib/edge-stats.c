@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* Intervals are bucketed by their power of two - 2^63 ns is plenty. */
+#define NUM_BUCKETS	64
+/* Weight of a new interval in the moving average is 1 / 2^EWMA_SHIFT. */
+#define EWMA_SHIFT	3
+
+struct gpiod_edge_stats {
+	uint64_t counts[NUM_BUCKETS];
+	uint64_t num_rising;
+	uint64_t num_falling;
+	uint64_t last_ts_ns;
+	/* Exponentially weighted moving average of the intervals. */
+	uint64_t avg_interval_ns;
+	uint64_t min_interval_ns;
+};
+
+static unsigned int interval_to_bucket(uint64_t interval_ns)
+{
+	return interval_ns ? 63 - __builtin_clzll(interval_ns) : 0;
+}
+
+struct gpiod_edge_stats *gpiod_edge_stats_array_new(size_t num)
+{
+	struct gpiod_edge_stats *array;
+	size_t i;
+
+	array = gpiod_calloc(num, sizeof(*array));
+	if (!array)
+		return NULL;
+
+	for (i = 0; i < num; i++)
+		gpiod_edge_stats_reset(&array[i]);
+
+	return array;
+}
+
+struct gpiod_edge_stats *
+gpiod_edge_stats_array_get(struct gpiod_edge_stats *array, size_t index)
+{
+	return &array[index];
+}
+
+struct gpiod_edge_stats *gpiod_edge_stats_copy(struct gpiod_edge_stats *stats)
+{
+	struct gpiod_edge_stats *copy;
+
+	copy = gpiod_malloc(sizeof(*copy));
+	if (!copy)
+		return NULL;
+
+	memcpy(copy, stats, sizeof(*copy));
+
+	return copy;
+}
+
+void gpiod_edge_stats_reset(struct gpiod_edge_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->min_interval_ns = UINT64_MAX;
+}
+
+void gpiod_edge_stats_add(struct gpiod_edge_stats *stats, bool rising,
+			  uint64_t timestamp_ns)
+{
+	uint64_t interval, num_events;
+
+	num_events = stats->num_rising + stats->num_falling;
+
+	if (rising)
+		stats->num_rising++;
+	else
+		stats->num_falling++;
+
+	if (num_events) {
+		/* The realtime clock may have been stepped back since. */
+		interval = timestamp_ns > stats->last_ts_ns ?
+				timestamp_ns - stats->last_ts_ns : 0;
+
+		stats->counts[interval_to_bucket(interval)]++;
+
+		if (interval < stats->min_interval_ns)
+			stats->min_interval_ns = interval;
+
+		/* The first interval seeds the average. */
+		if (num_events == 1)
+			stats->avg_interval_ns = interval;
+		else if (interval > stats->avg_interval_ns)
+			stats->avg_interval_ns +=
+				(interval - stats->avg_interval_ns) >>
+								EWMA_SHIFT;
+		else
+			stats->avg_interval_ns -=
+				(stats->avg_interval_ns - interval) >>
+								EWMA_SHIFT;
+	}
+
+	stats->last_ts_ns = timestamp_ns;
+}
+
+GPIOD_API void gpiod_edge_stats_free(struct gpiod_edge_stats *stats)
+{
+	gpiod_free(stats);
+}
+
+GPIOD_API uint64_t
+gpiod_edge_stats_get_num_rising(struct gpiod_edge_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_rising;
+}
+
+GPIOD_API uint64_t
+gpiod_edge_stats_get_num_falling(struct gpiod_edge_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_falling;
+}
+
+GPIOD_API uint64_t
+gpiod_edge_stats_get_num_intervals(struct gpiod_edge_stats *stats)
+{
+	uint64_t num_events;
+
+	assert(stats);
+
+	num_events = stats->num_rising + stats->num_falling;
+
+	return num_events ? num_events - 1 : 0;
+}
+
+GPIOD_API uint64_t
+gpiod_edge_stats_get_min_interval_ns(struct gpiod_edge_stats *stats)
+{
+	assert(stats);
+
+	return gpiod_edge_stats_get_num_intervals(stats) ?
+						stats->min_interval_ns : 0;
+}
+
+GPIOD_API uint64_t
+gpiod_edge_stats_get_avg_interval_ns(struct gpiod_edge_stats *stats)
+{
+	assert(stats);
+
+	return stats->avg_interval_ns;
+}
+
+GPIOD_API double gpiod_edge_stats_get_rate(struct gpiod_edge_stats *stats)
+{
+	assert(stats);
+
+	if (!gpiod_edge_stats_get_num_intervals(stats))
+		return 0.0;
+
+	/* Events closer than a nanosecond apart - report one per ns. */
+	if (!stats->avg_interval_ns)
+		return 1000000000.0;
+
+	return 1000000000.0 / stats->avg_interval_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_edge_stats_get_interval_count(struct gpiod_edge_stats *stats,
+				    unsigned int bucket)
+{
+	assert(stats);
+
+	if (bucket >= NUM_BUCKETS)
+		return 0;
+
+	return stats->counts[bucket];
+}
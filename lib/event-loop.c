@@ -0,0 +1,1085 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/* Max number of ready file descriptors handled per wakeup. */
+#define EVENT_LOOP_MAX_READY	64
+/* Size of the io_uring submission queue. */
+#define EVENT_LOOP_RING_SIZE	128
+/* user_data of io_uring requests whose completions we ignore. */
+#define EVENT_LOOP_NO_SOURCE	0
+
+enum {
+	SOURCE_REQUEST = 1,
+	SOURCE_CHIP,
+};
+
+struct reflex {
+	int id;
+	unsigned int offset;
+	bool rising;
+	bool falling;
+	struct gpiod_line_request *output;
+	uint64_t mask;
+	uint64_t values;
+	/* Clock of the input line's timestamps, unless it's the HTE. */
+	clockid_t clock;
+	bool measure;
+	struct gpiod_latency_histogram *latency;
+	struct reflex *next;
+};
+
+struct event_source {
+	int type;
+	int fd;
+	union {
+		struct gpiod_line_request *request;
+		struct gpiod_chip *chip;
+	};
+	union {
+		gpiod_event_loop_edge_cb edge_cb;
+		gpiod_event_loop_info_cb info_cb;
+		gpiod_event_loop_info_batch_cb info_batch_cb;
+	};
+	void *user_data;
+	bool removed;
+	/* Reflexes triggered by the edge events of a request. */
+	struct reflex *reflexes;
+	/* The request's fd is replaced when its event buffer grows. */
+	unsigned int fd_generation;
+	struct event_source *next;
+	/* Set for chips registered with gpiod_event_loop_add_chip_batched(). */
+	struct gpiod_info_event_buffer *info_buffer;
+	/* Used by the io_uring backend only. */
+	struct gpiod_edge_event_buffer *buffer;
+	struct gpio_v2_line_info_changed info;
+	bool in_flight;
+};
+
+struct gpiod_event_loop {
+	enum gpiod_event_loop_backend backend;
+	int epfd;
+	struct gpiod_uring *ring;
+	size_t event_buffer_size;
+	struct gpiod_edge_event_buffer *buffer;
+	struct event_source *sources;
+	size_t num_sources;
+	bool dispatching;
+	int next_reflex_id;
+	struct gpiod_thread_attr *thread_attr;
+	/* Thread the attributes were last applied to. */
+	pthread_t attr_thread;
+	bool attr_applied;
+};
+
+/* Without an explicit size, the buffers follow the size of the batches. */
+static struct gpiod_edge_event_buffer *new_edge_buffer(size_t size)
+{
+	return size ? gpiod_edge_event_buffer_new(size) :
+		      gpiod_edge_event_buffer_new_adaptive();
+}
+
+GPIOD_API struct gpiod_event_loop *
+gpiod_event_loop_new_with_backend(size_t event_buffer_size,
+				  enum gpiod_event_loop_backend backend)
+{
+	struct gpiod_event_loop *loop;
+
+	if (backend != GPIOD_EVENT_LOOP_BACKEND_AUTO &&
+	    backend != GPIOD_EVENT_LOOP_BACKEND_EPOLL &&
+	    backend != GPIOD_EVENT_LOOP_BACKEND_IO_URING) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	loop = gpiod_malloc(sizeof(*loop));
+	if (!loop)
+		return NULL;
+
+	memset(loop, 0, sizeof(*loop));
+	loop->epfd = -1;
+	loop->event_buffer_size = event_buffer_size;
+
+	if (backend != GPIOD_EVENT_LOOP_BACKEND_EPOLL) {
+		/*
+		 * io_uring may be missing at build time, not supported by the
+		 * running kernel or disabled by the system policy.
+		 */
+		loop->ring = gpiod_uring_new(EVENT_LOOP_RING_SIZE);
+		if (loop->ring) {
+			loop->backend = GPIOD_EVENT_LOOP_BACKEND_IO_URING;
+			return loop;
+		}
+
+		if (backend == GPIOD_EVENT_LOOP_BACKEND_IO_URING) {
+			errno = ENOTSUP;
+			goto err_free_loop;
+		}
+	}
+
+	loop->backend = GPIOD_EVENT_LOOP_BACKEND_EPOLL;
+
+	loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epfd < 0)
+		goto err_free_loop;
+
+	loop->buffer = new_edge_buffer(event_buffer_size);
+	if (!loop->buffer)
+		goto err_close_epfd;
+
+	return loop;
+
+err_close_epfd:
+	close(loop->epfd);
+err_free_loop:
+	gpiod_free(loop);
+
+	return NULL;
+}
+
+GPIOD_API struct gpiod_event_loop *gpiod_event_loop_new(size_t event_buffer_size)
+{
+	return gpiod_event_loop_new_with_backend(event_buffer_size,
+						 GPIOD_EVENT_LOOP_BACKEND_EPOLL);
+}
+
+static void free_reflex(struct reflex *reflex)
+{
+	gpiod_latency_histogram_free(reflex->latency);
+	gpiod_free(reflex);
+}
+
+static void free_source(struct event_source *source)
+{
+	struct reflex *reflex, *next;
+
+	for (reflex = source->reflexes; reflex; reflex = next) {
+		next = reflex->next;
+		free_reflex(reflex);
+	}
+
+	gpiod_info_event_buffer_free(source->info_buffer);
+	gpiod_edge_event_buffer_free(source->buffer);
+	gpiod_free(source);
+}
+
+static bool sources_in_flight(struct gpiod_event_loop *loop)
+{
+	struct event_source *source;
+
+	for (source = loop->sources; source; source = source->next) {
+		if (source->in_flight)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * The kernel writes into the source buffers until the queued reads complete.
+ * Cancel them and wait for the completions before freeing the memory.
+ */
+static void drain_ring(struct gpiod_event_loop *loop)
+{
+	struct event_source *source;
+	uint64_t user_data;
+	int res;
+
+	for (source = loop->sources; source; source = source->next) {
+		if (source->in_flight)
+			gpiod_uring_queue_cancel(loop->ring,
+						 (uintptr_t)source,
+						 EVENT_LOOP_NO_SOURCE);
+	}
+
+	while (sources_in_flight(loop)) {
+		if (gpiod_uring_wait(loop->ring, 100000000) <= 0)
+			break;
+
+		while (gpiod_uring_reap(loop->ring, &user_data, &res)) {
+			if (user_data == EVENT_LOOP_NO_SOURCE)
+				continue;
+
+			source = (struct event_source *)(uintptr_t)user_data;
+			source->in_flight = false;
+		}
+	}
+}
+
+GPIOD_API void gpiod_event_loop_free(struct gpiod_event_loop *loop)
+{
+	struct event_source *source, *next;
+
+	if (!loop)
+		return;
+
+	if (loop->ring) {
+		drain_ring(loop);
+		gpiod_uring_free(loop->ring);
+	}
+
+	for (source = loop->sources; source; source = next) {
+		next = source->next;
+		free_source(source);
+	}
+
+	gpiod_thread_attr_free(loop->thread_attr);
+	gpiod_edge_event_buffer_free(loop->buffer);
+	if (loop->epfd >= 0)
+		close(loop->epfd);
+	gpiod_free(loop);
+}
+
+GPIOD_API enum gpiod_event_loop_backend
+gpiod_event_loop_get_backend(struct gpiod_event_loop *loop)
+{
+	assert(loop);
+
+	return loop->backend;
+}
+
+static struct event_source *find_source(struct gpiod_event_loop *loop,
+					void *obj)
+{
+	struct event_source *source;
+
+	for (source = loop->sources; source; source = source->next) {
+		if (!source->removed && source->request == obj)
+			return source;
+	}
+
+	return NULL;
+}
+
+static int queue_read(struct gpiod_event_loop *loop,
+		      struct event_source *source)
+{
+	void *buf;
+	size_t len;
+	int ret;
+
+	if (source->type == SOURCE_REQUEST) {
+		/* The buffer may only grow while no read is queued into it. */
+		gpiod_edge_event_buffer_adapt(source->buffer);
+		buf = gpiod_edge_event_buffer_get_data(source->buffer);
+		len = gpiod_edge_event_buffer_get_capacity(source->buffer) *
+		      sizeof(struct gpio_v2_line_event);
+	} else if (source->info_buffer) {
+		buf = gpiod_info_event_buffer_get_data(source->info_buffer);
+		len = gpiod_info_event_buffer_get_capacity(source->info_buffer) *
+		      sizeof(struct gpio_v2_line_info_changed);
+	} else {
+		buf = &source->info;
+		len = sizeof(source->info);
+	}
+
+	ret = gpiod_uring_queue_read(loop->ring, source->fd, buf, len,
+				     (uintptr_t)source);
+	if (ret)
+		return -1;
+
+	source->in_flight = true;
+
+	return 0;
+}
+
+static int add_ring_source(struct gpiod_event_loop *loop,
+			   struct event_source *source)
+{
+	int ret;
+
+	if (source->type == SOURCE_REQUEST) {
+		source->buffer = new_edge_buffer(loop->event_buffer_size);
+		if (!source->buffer)
+			goto err_free_source;
+	}
+
+	ret = queue_read(loop, source);
+	if (ret)
+		goto err_free_source;
+
+	source->next = loop->sources;
+	loop->sources = source;
+	loop->num_sources++;
+
+	return 0;
+
+err_free_source:
+	free_source(source);
+
+	return -1;
+}
+
+static int add_source(struct gpiod_event_loop *loop,
+		      struct event_source *source)
+{
+	struct epoll_event ev;
+	int ret;
+
+	if (loop->ring)
+		return add_ring_source(loop, source);
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLPRI;
+	ev.data.ptr = source;
+
+	ret = epoll_ctl(loop->epfd, EPOLL_CTL_ADD, source->fd, &ev);
+	if (ret) {
+		free_source(source);
+		return -1;
+	}
+
+	source->next = loop->sources;
+	loop->sources = source;
+	loop->num_sources++;
+
+	return 0;
+}
+
+static struct event_source *alloc_source(struct gpiod_event_loop *loop,
+					 void *obj, void *user_data)
+{
+	struct event_source *source;
+
+	if (find_source(loop, obj)) {
+		errno = EEXIST;
+		return NULL;
+	}
+
+	source = gpiod_malloc(sizeof(*source));
+	if (!source)
+		return NULL;
+
+	memset(source, 0, sizeof(*source));
+	source->user_data = user_data;
+
+	return source;
+}
+
+GPIOD_API int gpiod_event_loop_add_request(struct gpiod_event_loop *loop,
+					   struct gpiod_line_request *request,
+					   gpiod_event_loop_edge_cb cb,
+					   void *user_data)
+{
+	struct event_source *source;
+
+	assert(loop);
+
+	if (!request || !cb) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	source = alloc_source(loop, request, user_data);
+	if (!source)
+		return -1;
+
+	source->type = SOURCE_REQUEST;
+	source->fd = gpiod_line_request_get_fd(request);
+	source->request = request;
+	source->fd_generation = gpiod_line_request_get_fd_generation(request);
+	source->edge_cb = cb;
+
+	return add_source(loop, source);
+}
+
+GPIOD_API int gpiod_event_loop_add_chip(struct gpiod_event_loop *loop,
+					struct gpiod_chip *chip,
+					gpiod_event_loop_info_cb cb,
+					void *user_data)
+{
+	struct event_source *source;
+
+	assert(loop);
+
+	if (!chip || !cb) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	source = alloc_source(loop, chip, user_data);
+	if (!source)
+		return -1;
+
+	source->type = SOURCE_CHIP;
+	source->fd = gpiod_chip_get_fd(chip);
+	source->chip = chip;
+	source->info_cb = cb;
+
+	return add_source(loop, source);
+}
+
+GPIOD_API int
+gpiod_event_loop_add_chip_batched(struct gpiod_event_loop *loop,
+				  struct gpiod_chip *chip,
+				  gpiod_event_loop_info_batch_cb cb,
+				  void *user_data)
+{
+	struct event_source *source;
+
+	assert(loop);
+
+	if (!chip || !cb) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	source = alloc_source(loop, chip, user_data);
+	if (!source)
+		return -1;
+
+	source->info_buffer = gpiod_info_event_buffer_new(0);
+	if (!source->info_buffer) {
+		free_source(source);
+		return -1;
+	}
+
+	source->type = SOURCE_CHIP;
+	source->fd = gpiod_chip_get_fd(chip);
+	source->chip = chip;
+	source->info_batch_cb = cb;
+
+	return add_source(loop, source);
+}
+
+static void free_removed_sources(struct gpiod_event_loop *loop)
+{
+	struct event_source **prev, *source;
+
+	prev = &loop->sources;
+	while ((source = *prev)) {
+		if (source->removed && !source->in_flight) {
+			*prev = source->next;
+			free_source(source);
+		} else {
+			prev = &source->next;
+		}
+	}
+}
+
+static int remove_source(struct gpiod_event_loop *loop, void *obj)
+{
+	struct event_source *source;
+	int ret;
+
+	source = find_source(loop, obj);
+	if (!source) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	if (loop->ring) {
+		/*
+		 * The completion of the cancelled read will still reference
+		 * the source. It's freed once that completion is reaped.
+		 */
+		if (source->in_flight) {
+			ret = gpiod_uring_queue_cancel(loop->ring,
+						       (uintptr_t)source,
+						       EVENT_LOOP_NO_SOURCE);
+			if (ret)
+				return -1;
+		}
+	} else {
+		ret = epoll_ctl(loop->epfd, EPOLL_CTL_DEL, source->fd, NULL);
+		if (ret)
+			return -1;
+	}
+
+	/*
+	 * The source may still be referenced by the batch being dispatched
+	 * so only free it once the dispatch is done.
+	 */
+	source->removed = true;
+	loop->num_sources--;
+
+	if (!loop->dispatching)
+		free_removed_sources(loop);
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_event_loop_remove_request(struct gpiod_event_loop *loop,
+				struct gpiod_line_request *request)
+{
+	assert(loop);
+
+	return remove_source(loop, request);
+}
+
+GPIOD_API int gpiod_event_loop_remove_chip(struct gpiod_event_loop *loop,
+					   struct gpiod_chip *chip)
+{
+	assert(loop);
+
+	return remove_source(loop, chip);
+}
+
+static bool reflex_mask_valid(struct gpiod_line_request *output, uint64_t mask)
+{
+	size_t num_lines = gpiod_line_request_get_num_requested_lines(output);
+
+	if (!mask)
+		return false;
+
+	return num_lines >= 64 || !(mask >> num_lines);
+}
+
+/* Everything needed to react to an event is worked out here, not per event. */
+static int setup_reflex(struct reflex *reflex,
+			struct gpiod_line_request *input, unsigned int offset)
+{
+	struct gpiod_line_settings *settings;
+	enum gpiod_line_clock clock;
+
+	settings = gpiod_line_config_get_line_settings(
+			gpiod_line_request_get_line_config(input), offset);
+	if (!settings) {
+		if (errno == ENOENT)
+			errno = EINVAL;
+		return -1;
+	}
+
+	clock = gpiod_line_settings_get_event_clock(settings);
+	gpiod_line_settings_free(settings);
+
+	reflex->measure = clock != GPIOD_LINE_CLOCK_HTE;
+	reflex->clock = clock == GPIOD_LINE_CLOCK_REALTIME ?
+				CLOCK_REALTIME : CLOCK_MONOTONIC;
+
+	reflex->latency = gpiod_latency_histogram_array_new(1);
+	if (!reflex->latency)
+		return -1;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_event_loop_add_reflex(struct gpiod_event_loop *loop,
+					  struct gpiod_line_request *input,
+					  unsigned int offset,
+					  enum gpiod_line_edge edge,
+					  struct gpiod_line_request *output,
+					  uint64_t mask, uint64_t values)
+{
+	struct reflex *reflex, **tail;
+	struct event_source *source;
+
+	assert(loop);
+
+	if (!input || !output || !reflex_mask_valid(output, mask) ||
+	    (edge != GPIOD_LINE_EDGE_RISING &&
+	     edge != GPIOD_LINE_EDGE_FALLING &&
+	     edge != GPIOD_LINE_EDGE_BOTH)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	source = find_source(loop, input);
+	if (!source || source->type != SOURCE_REQUEST) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	reflex = gpiod_malloc(sizeof(*reflex));
+	if (!reflex)
+		return -1;
+
+	memset(reflex, 0, sizeof(*reflex));
+
+	if (setup_reflex(reflex, input, offset)) {
+		free_reflex(reflex);
+		return -1;
+	}
+
+	reflex->id = loop->next_reflex_id++;
+	reflex->offset = offset;
+	reflex->rising = edge != GPIOD_LINE_EDGE_FALLING;
+	reflex->falling = edge != GPIOD_LINE_EDGE_RISING;
+	reflex->output = output;
+	reflex->mask = mask;
+	reflex->values = values & mask;
+
+	/* Reflexes fire in the order they were added in. */
+	for (tail = &source->reflexes; *tail; tail = &(*tail)->next)
+		;
+	*tail = reflex;
+
+	return reflex->id;
+}
+
+static struct reflex **find_reflex(struct gpiod_event_loop *loop, int id)
+{
+	struct event_source *source;
+	struct reflex **reflex;
+
+	for (source = loop->sources; source; source = source->next) {
+		if (source->removed)
+			continue;
+
+		for (reflex = &source->reflexes; *reflex;
+		     reflex = &(*reflex)->next) {
+			if ((*reflex)->id == id)
+				return reflex;
+		}
+	}
+
+	errno = ENOENT;
+	return NULL;
+}
+
+GPIOD_API int gpiod_event_loop_remove_reflex(struct gpiod_event_loop *loop,
+					     int id)
+{
+	struct reflex **prev, *reflex;
+
+	assert(loop);
+
+	prev = find_reflex(loop, id);
+	if (!prev)
+		return -1;
+
+	reflex = *prev;
+	*prev = reflex->next;
+	free_reflex(reflex);
+
+	return 0;
+}
+
+GPIOD_API struct gpiod_latency_histogram *
+gpiod_event_loop_get_reflex_latency_histogram(struct gpiod_event_loop *loop,
+					      int id)
+{
+	struct reflex **reflex;
+
+	assert(loop);
+
+	reflex = find_reflex(loop, id);
+	if (!reflex)
+		return NULL;
+
+	return gpiod_latency_histogram_copy((*reflex)->latency);
+}
+
+GPIOD_API size_t gpiod_event_loop_get_num_sources(struct gpiod_event_loop *loop)
+{
+	assert(loop);
+
+	return loop->num_sources;
+}
+
+GPIOD_API int gpiod_event_loop_get_fd(struct gpiod_event_loop *loop)
+{
+	assert(loop);
+
+	return loop->ring ? gpiod_uring_get_fd(loop->ring) : loop->epfd;
+}
+
+/*
+ * The file description behind the fd changed and the old one was dropped
+ * from the epoll set when it was closed.
+ */
+static int readd_resized_request(struct gpiod_event_loop *loop,
+				 struct event_source *source)
+{
+	unsigned int generation;
+	struct epoll_event ev;
+
+	generation = gpiod_line_request_get_fd_generation(source->request);
+	if (generation == source->fd_generation)
+		return 0;
+
+	source->fd_generation = generation;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLPRI;
+	ev.data.ptr = source;
+
+	return epoll_ctl(loop->epfd, EPOLL_CTL_ADD, source->fd, &ev);
+}
+
+static uint64_t reflex_now(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Fire the reflexes matching the events before anything else is done with
+ * them. Returns 0 or the errno of the first failed write.
+ */
+static int run_reflexes(struct event_source *source,
+			const struct gpio_v2_line_event *events,
+			size_t num_events)
+{
+	const struct gpio_v2_line_event *event;
+	struct reflex *reflex;
+	int ret, error = 0;
+	uint64_t now;
+	size_t i;
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		for (reflex = source->reflexes; reflex; reflex = reflex->next) {
+			if (reflex->offset != event->offset)
+				continue;
+
+			if (!(event->id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
+					reflex->rising : reflex->falling))
+				continue;
+
+			ret = gpiod_line_request_set_values_mask(reflex->output,
+								 reflex->mask,
+								 reflex->values);
+			if (ret) {
+				if (!error)
+					error = errno;
+				continue;
+			}
+
+			if (!reflex->measure)
+				continue;
+
+			/* The realtime clock may have been stepped back since. */
+			now = reflex_now(reflex->clock);
+			gpiod_latency_histogram_add(reflex->latency,
+					now > event->timestamp_ns ?
+						now - event->timestamp_ns : 0);
+		}
+	}
+
+	return error;
+}
+
+static int dispatch_edge_events(struct event_source *source,
+				struct gpiod_edge_event_buffer *buffer,
+				size_t num_events)
+{
+	int ret, error = 0;
+
+	if (source->reflexes)
+		error = run_reflexes(source,
+				gpiod_edge_event_buffer_get_data(buffer),
+				num_events);
+
+	ret = source->edge_cb(source->request, buffer, num_events,
+			      source->user_data);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+
+	return ret;
+}
+
+static int dispatch_source(struct gpiod_event_loop *loop,
+			   struct event_source *source)
+{
+	struct gpiod_info_event *info_event;
+	int ret;
+
+	if (source->type == SOURCE_REQUEST) {
+		ret = gpiod_line_request_read_edge_events(source->request,
+				loop->buffer,
+				gpiod_edge_event_buffer_get_capacity(
+							loop->buffer));
+		if (ret < 0)
+			return -1;
+
+		if (readd_resized_request(loop, source))
+			return -1;
+
+		/*
+		 * Non-blocking requests may have nothing to read after all and
+		 * the software debounce or the edge event filter may have
+		 * discarded every event.
+		 */
+		if (ret == 0)
+			return 0;
+
+		return dispatch_edge_events(source, loop->buffer, ret);
+	}
+
+	if (source->info_buffer) {
+		ret = gpiod_chip_read_info_events(source->chip,
+				source->info_buffer,
+				gpiod_info_event_buffer_get_capacity(
+						source->info_buffer));
+		if (ret < 0)
+			return -1;
+
+		return source->info_batch_cb(source->chip, source->info_buffer,
+					     ret, source->user_data);
+	}
+
+	info_event = gpiod_chip_read_info_event(source->chip);
+	if (!info_event)
+		return -1;
+
+	ret = source->info_cb(source->chip, info_event, source->user_data);
+	gpiod_info_event_free(info_event);
+
+	return ret;
+}
+
+static int handle_completion(struct event_source *source, int res)
+{
+	struct gpiod_info_event *info_event;
+	size_t num_events, dropped;
+	int ret;
+
+	if (res < 0) {
+		errno = -res;
+		return -1;
+	}
+
+	if (source->type == SOURCE_REQUEST) {
+		num_events = res / sizeof(struct gpio_v2_line_event);
+		gpiod_edge_event_buffer_account_read(source->buffer,
+				num_events == gpiod_edge_event_buffer_get_capacity(
+							source->buffer));
+
+		/* Reads bypassed the request - account for them here. */
+		dropped = gpiod_line_request_account_events(source->request,
+				gpiod_edge_event_buffer_get_data(source->buffer),
+				num_events);
+		num_events = gpiod_line_request_debounce_events(source->request,
+				gpiod_edge_event_buffer_get_data(source->buffer),
+				num_events);
+		num_events = gpiod_line_request_filter_events(source->request,
+				gpiod_edge_event_buffer_get_data(source->buffer),
+				num_events);
+		gpiod_edge_event_buffer_set_num_events(source->buffer,
+						       num_events);
+		gpiod_edge_event_buffer_set_num_dropped(source->buffer, dropped);
+
+		ret = num_events ? dispatch_edge_events(source, source->buffer,
+							num_events) : 0;
+	} else if (source->info_buffer) {
+		if ((size_t)res < sizeof(struct gpio_v2_line_info_changed)) {
+			errno = EIO;
+			return -1;
+		}
+
+		ret = gpiod_info_event_buffer_decode(source->info_buffer, res);
+		if (ret < 0)
+			return -1;
+
+		ret = source->info_batch_cb(source->chip, source->info_buffer,
+					    ret, source->user_data);
+	} else {
+		if ((size_t)res < sizeof(source->info)) {
+			errno = EIO;
+			return -1;
+		}
+
+		info_event = gpiod_info_event_from_uapi(&source->info);
+		if (!info_event)
+			return -1;
+
+		ret = source->info_cb(source->chip, info_event,
+				      source->user_data);
+		gpiod_info_event_free(info_event);
+	}
+
+	return ret;
+}
+
+static int dispatch_completion(struct gpiod_event_loop *loop,
+			       struct event_source *source, int res)
+{
+	int ret, error;
+
+	ret = handle_completion(source, res);
+	error = errno;
+
+	/*
+	 * The buffer is no longer in use - queue the next read into it, even
+	 * if the read or the callback failed. Like a level-triggered fd with
+	 * epoll, the source must stay armed.
+	 */
+	if (!source->removed && loop->ring && queue_read(loop, source))
+		return -1;
+
+	if (ret < 0)
+		errno = error;
+
+	return ret;
+}
+
+static int wait_ring(struct gpiod_event_loop *loop, int64_t timeout_ns)
+{
+	struct event_source *source;
+	int ret = 0, dispatched = 0;
+	uint64_t user_data;
+	int res;
+
+	ret = gpiod_uring_wait(loop->ring, timeout_ns);
+	if (ret <= 0)
+		return ret;
+
+	loop->dispatching = true;
+
+	while (gpiod_uring_reap(loop->ring, &user_data, &res)) {
+		if (user_data == EVENT_LOOP_NO_SOURCE)
+			continue;
+
+		source = (struct event_source *)(uintptr_t)user_data;
+		source->in_flight = false;
+		if (source->removed)
+			continue;
+
+		ret = dispatch_completion(loop, source, res);
+		if (ret < 0)
+			break;
+
+		dispatched++;
+
+		if (ret)
+			break;
+	}
+
+	loop->dispatching = false;
+	free_removed_sources(loop);
+
+	if (ret < 0)
+		return -1;
+
+	return dispatched;
+}
+
+GPIOD_API int
+gpiod_event_loop_set_thread_attr(struct gpiod_event_loop *loop,
+				 struct gpiod_thread_attr *attr)
+{
+	struct gpiod_thread_attr *copy = NULL;
+
+	assert(loop);
+
+	if (attr) {
+		copy = gpiod_thread_attr_copy(attr);
+		if (!copy)
+			return -1;
+	}
+
+	gpiod_thread_attr_free(loop->thread_attr);
+	loop->thread_attr = copy;
+	loop->attr_applied = false;
+
+	return 0;
+}
+
+/* Apply the thread attributes once per waiting thread. */
+static int apply_thread_attr(struct gpiod_event_loop *loop)
+{
+	if (!loop->thread_attr ||
+	    (loop->attr_applied &&
+	     pthread_equal(loop->attr_thread, pthread_self())))
+		return 0;
+
+	if (gpiod_thread_attr_apply(loop->thread_attr))
+		return -1;
+
+	loop->attr_thread = pthread_self();
+	loop->attr_applied = true;
+
+	return 0;
+}
+
+/*
+ * Move the sources with reflexes to the front, keeping the order otherwise,
+ * so that their outputs are set before any callback runs.
+ */
+static void prioritize_reflexes(struct epoll_event *events, int num_ready)
+{
+	struct epoll_event tmp[EVENT_LOOP_MAX_READY];
+	struct event_source *source;
+	int i, num_first = 0, num_rest = 0;
+
+	for (i = 0; i < num_ready; i++) {
+		source = events[i].data.ptr;
+		if (source->reflexes)
+			events[num_first++] = events[i];
+		else
+			tmp[num_rest++] = events[i];
+	}
+
+	if (num_first && num_rest)
+		memcpy(&events[num_first], tmp, sizeof(*tmp) * num_rest);
+}
+
+GPIOD_API int gpiod_event_loop_wait(struct gpiod_event_loop *loop,
+				    int64_t timeout_ns)
+{
+	struct epoll_event events[EVENT_LOOP_MAX_READY];
+	struct event_source *source;
+	int num_ready, timeout_ms, i, ret, dispatched = 0;
+
+	assert(loop);
+
+	if (apply_thread_attr(loop))
+		return -1;
+
+	if (loop->ring)
+		return wait_ring(loop, timeout_ns);
+
+	if (timeout_ns < 0)
+		timeout_ms = -1;
+	else if (timeout_ns / 1000000 >= INT_MAX)
+		/* Longer than epoll can wait - time out early instead. */
+		timeout_ms = INT_MAX;
+	else
+		/* Round up so that we never return before the timeout. */
+		timeout_ms = timeout_ns / 1000000 +
+			     (timeout_ns % 1000000 ? 1 : 0);
+
+	num_ready = epoll_wait(loop->epfd, events, EVENT_LOOP_MAX_READY,
+			       timeout_ms);
+	if (num_ready < 0)
+		return -1;
+
+	if (loop->next_reflex_id)
+		prioritize_reflexes(events, num_ready);
+
+	loop->dispatching = true;
+
+	for (i = 0, ret = 0; i < num_ready; i++) {
+		source = events[i].data.ptr;
+		if (source->removed)
+			continue;
+
+		ret = dispatch_source(loop, source);
+		if (ret < 0)
+			break;
+
+		dispatched++;
+
+		if (ret)
+			/* The callback asked us to stop. */
+			break;
+	}
+
+	loop->dispatching = false;
+	free_removed_sources(loop);
+
+	if (ret < 0)
+		return -1;
+
+	return dispatched;
+}
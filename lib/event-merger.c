@@ -0,0 +1,605 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/param.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/* Same as the max capacity of an edge event buffer. */
+#define MERGER_MAX_READ		(GPIO_V2_LINES_MAX * 16)
+#define MERGER_DEFAULT_CAPACITY	1024
+/* Max number of events read from a source in one go. */
+#define MERGER_READ_CHUNK	64
+#define MERGER_MAX_READY	64
+
+struct merger_source {
+	struct gpiod_line_request *request;
+	int fd;
+	struct merger_source *next;
+};
+
+struct staged_event {
+	struct gpio_v2_line_event data;
+	/* Keeps events with equal timestamps in arrival order. */
+	uint64_t seq;
+	struct gpiod_line_request *request;
+};
+
+struct gpiod_event_merger {
+	clockid_t clock;
+	bool has_clock;
+	uint64_t window_ns;
+	/* Min-heap of staged events ordered by timestamp. */
+	struct staged_event *heap;
+	size_t capacity;
+	size_t num_staged;
+	uint64_t seq;
+	/* Highest timestamp staged so far. */
+	uint64_t watermark;
+	/* Timestamp of the last event returned to the user. */
+	uint64_t last_ts;
+	unsigned long num_late;
+	struct merger_source *sources;
+	int epfd;
+	int timerfd;
+	struct gpio_v2_line_event chunk[MERGER_READ_CHUNK];
+	/* Requests the events of the last read came from. */
+	struct gpiod_line_request *read_requests[MERGER_MAX_READ];
+	size_t num_read;
+};
+
+static bool event_before(const struct staged_event *left,
+			 const struct staged_event *right)
+{
+	if (left->data.timestamp_ns != right->data.timestamp_ns)
+		return left->data.timestamp_ns < right->data.timestamp_ns;
+
+	return left->seq < right->seq;
+}
+
+static void swap_events(struct staged_event *left, struct staged_event *right)
+{
+	struct staged_event tmp = *left;
+
+	*left = *right;
+	*right = tmp;
+}
+
+static void sift_up(struct gpiod_event_merger *merger, size_t pos)
+{
+	size_t parent;
+
+	while (pos) {
+		parent = (pos - 1) / 2;
+		if (!event_before(&merger->heap[pos], &merger->heap[parent]))
+			break;
+
+		swap_events(&merger->heap[pos], &merger->heap[parent]);
+		pos = parent;
+	}
+}
+
+static void sift_down(struct gpiod_event_merger *merger, size_t pos)
+{
+	size_t child, min;
+
+	for (;;) {
+		min = pos;
+
+		for (child = 2 * pos + 1; child <= 2 * pos + 2; child++) {
+			if (child < merger->num_staged &&
+			    event_before(&merger->heap[child],
+					 &merger->heap[min]))
+				min = child;
+		}
+
+		if (min == pos)
+			break;
+
+		swap_events(&merger->heap[pos], &merger->heap[min]);
+		pos = min;
+	}
+}
+
+static void push_event(struct gpiod_event_merger *merger,
+		       struct gpio_v2_line_event *data,
+		       struct gpiod_line_request *request)
+{
+	struct staged_event *staged = &merger->heap[merger->num_staged];
+
+	staged->data = *data;
+	staged->seq = merger->seq++;
+	staged->request = request;
+
+	if (data->timestamp_ns < merger->last_ts)
+		merger->num_late++;
+	if (data->timestamp_ns > merger->watermark)
+		merger->watermark = data->timestamp_ns;
+
+	sift_up(merger, merger->num_staged++);
+}
+
+static void pop_event(struct gpiod_event_merger *merger)
+{
+	merger->heap[0] = merger->heap[--merger->num_staged];
+	sift_down(merger, 0);
+}
+
+GPIOD_API struct gpiod_event_merger *
+gpiod_event_merger_new(enum gpiod_line_clock clock, uint64_t window_ns,
+		       size_t capacity)
+{
+	struct gpiod_event_merger *merger;
+	struct epoll_event ev;
+	int ret;
+
+	merger = gpiod_malloc(sizeof(*merger));
+	if (!merger)
+		return NULL;
+
+	memset(merger, 0, sizeof(*merger));
+	merger->window_ns = window_ns;
+	merger->capacity = capacity ? capacity : MERGER_DEFAULT_CAPACITY;
+	merger->epfd = -1;
+	merger->timerfd = -1;
+
+	switch (clock) {
+	case GPIOD_LINE_CLOCK_MONOTONIC:
+		merger->clock = CLOCK_MONOTONIC;
+		merger->has_clock = true;
+		break;
+	case GPIOD_LINE_CLOCK_REALTIME:
+		merger->clock = CLOCK_REALTIME;
+		merger->has_clock = true;
+		break;
+	case GPIOD_LINE_CLOCK_HTE:
+		/* No system clock to compare against, see is_due(). */
+		break;
+	default:
+		errno = EINVAL;
+		goto err_free_merger;
+	}
+
+	merger->heap = gpiod_calloc(merger->capacity, sizeof(*merger->heap));
+	if (!merger->heap)
+		goto err_free_merger;
+
+	merger->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (merger->epfd < 0)
+		goto err_free_merger;
+
+	if (merger->has_clock) {
+		merger->timerfd = timerfd_create(merger->clock,
+						 TFD_CLOEXEC | TFD_NONBLOCK);
+		if (merger->timerfd < 0)
+			goto err_free_merger;
+
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.ptr = NULL;
+
+		ret = epoll_ctl(merger->epfd, EPOLL_CTL_ADD, merger->timerfd,
+				&ev);
+		if (ret)
+			goto err_free_merger;
+	}
+
+	return merger;
+
+err_free_merger:
+	gpiod_event_merger_free(merger);
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_event_merger_free(struct gpiod_event_merger *merger)
+{
+	struct merger_source *source, *next;
+
+	if (!merger)
+		return;
+
+	for (source = merger->sources; source; source = next) {
+		next = source->next;
+		gpiod_free(source);
+	}
+
+	if (merger->timerfd >= 0)
+		close(merger->timerfd);
+	if (merger->epfd >= 0)
+		close(merger->epfd);
+	gpiod_free(merger->heap);
+	gpiod_free(merger);
+}
+
+GPIOD_API int gpiod_event_merger_add_request(struct gpiod_event_merger *merger,
+					     struct gpiod_line_request *request)
+{
+	struct merger_source *source;
+	struct epoll_event ev;
+	int ret;
+
+	assert(merger);
+
+	if (!request) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (source = merger->sources; source; source = source->next) {
+		if (source->request == request) {
+			errno = EEXIST;
+			return -1;
+		}
+	}
+
+	source = gpiod_malloc(sizeof(*source));
+	if (!source)
+		return -1;
+
+	memset(source, 0, sizeof(*source));
+	source->request = request;
+	source->fd = gpiod_line_request_get_fd(request);
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLPRI;
+	ev.data.ptr = source;
+
+	ret = epoll_ctl(merger->epfd, EPOLL_CTL_ADD, source->fd, &ev);
+	if (ret) {
+		gpiod_free(source);
+		return -1;
+	}
+
+	source->next = merger->sources;
+	merger->sources = source;
+
+	return 0;
+}
+
+static void drop_staged_events(struct gpiod_event_merger *merger,
+			       struct gpiod_line_request *request)
+{
+	size_t i, kept = 0;
+
+	for (i = 0; i < merger->num_staged; i++) {
+		if (merger->heap[i].request != request)
+			merger->heap[kept++] = merger->heap[i];
+	}
+
+	merger->num_staged = kept;
+
+	/* Restore the heap property bottom-up. */
+	for (i = merger->num_staged / 2; i-- > 0;)
+		sift_down(merger, i);
+}
+
+GPIOD_API int
+gpiod_event_merger_remove_request(struct gpiod_event_merger *merger,
+				  struct gpiod_line_request *request)
+{
+	struct merger_source **prev, *source;
+	size_t i;
+	int ret;
+
+	assert(merger);
+
+	for (prev = &merger->sources; (source = *prev); prev = &source->next) {
+		if (source->request == request)
+			break;
+	}
+
+	if (!source) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	ret = epoll_ctl(merger->epfd, EPOLL_CTL_DEL, source->fd, NULL);
+	if (ret)
+		return -1;
+
+	*prev = source->next;
+	gpiod_free(source);
+
+	drop_staged_events(merger, request);
+
+	for (i = 0; i < merger->num_read; i++) {
+		if (merger->read_requests[i] == request)
+			merger->read_requests[i] = NULL;
+	}
+
+	return 0;
+}
+
+GPIOD_API int gpiod_event_merger_get_fd(struct gpiod_event_merger *merger)
+{
+	assert(merger);
+
+	return merger->epfd;
+}
+
+GPIOD_API size_t
+gpiod_event_merger_get_num_staged_events(struct gpiod_event_merger *merger)
+{
+	assert(merger);
+
+	return merger->num_staged;
+}
+
+GPIOD_API unsigned long
+gpiod_event_merger_get_num_late_events(struct gpiod_event_merger *merger)
+{
+	assert(merger);
+
+	return merger->num_late;
+}
+
+static uint64_t clock_now(struct gpiod_event_merger *merger)
+{
+	struct timespec ts;
+
+	clock_gettime(merger->clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t due_time(struct gpiod_event_merger *merger)
+{
+	return merger->heap[0].data.timestamp_ns + merger->window_ns;
+}
+
+/*
+ * The oldest staged event is due once the reorder window has passed since it
+ * occurred. Without a system clock matching the event timestamps, time is
+ * only known to have passed when newer events arrive. When the staging area
+ * is full, events are released early to make room.
+ */
+static bool is_due(struct gpiod_event_merger *merger, uint64_t now)
+{
+	if (!merger->num_staged)
+		return false;
+
+	if (merger->num_staged == merger->capacity)
+		return true;
+
+	if (!merger->has_clock)
+		now = merger->watermark;
+
+	return due_time(merger) <= now;
+}
+
+static int arm_timer(struct gpiod_event_merger *merger)
+{
+	struct itimerspec its;
+	uint64_t expiry;
+	uint64_t val;
+	ssize_t rd;
+
+	if (!merger->has_clock)
+		return 0;
+
+	/* Clear a previous expiry so that the fd isn't readable anymore. */
+	rd = read(merger->timerfd, &val, sizeof(val));
+	if (rd < 0 && errno != EAGAIN)
+		return -1;
+
+	memset(&its, 0, sizeof(its));
+
+	if (merger->num_staged) {
+		expiry = due_time(merger);
+		/* A zero it_value would disarm the timer. */
+		if (!expiry)
+			expiry = 1;
+
+		its.it_value.tv_sec = expiry / 1000000000ULL;
+		its.it_value.tv_nsec = expiry % 1000000000ULL;
+	}
+
+	return timerfd_settime(merger->timerfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static int stage_source(struct gpiod_event_merger *merger,
+			struct merger_source *source)
+{
+	size_t num_events, i;
+	ssize_t rd;
+
+	num_events = MIN(MERGER_READ_CHUNK,
+			 merger->capacity - merger->num_staged);
+	if (!num_events)
+		return 0;
+
+	rd = gpiod_sys_read(source->fd, merger->chunk,
+			    num_events * sizeof(*merger->chunk));
+	if (rd < 0) {
+		return errno == EAGAIN ? 0 : -1;
+	} else if ((size_t)rd < sizeof(*merger->chunk)) {
+		errno = EIO;
+		return -1;
+	}
+
+	num_events = rd / sizeof(*merger->chunk);
+	gpiod_line_request_account_events(source->request, merger->chunk,
+					  num_events);
+	num_events = gpiod_line_request_debounce_events(source->request,
+							merger->chunk,
+							num_events);
+	num_events = gpiod_line_request_filter_events(source->request,
+						      merger->chunk,
+						      num_events);
+
+	for (i = 0; i < num_events; i++)
+		push_event(merger, &merger->chunk[i], source->request);
+
+	return 0;
+}
+
+/* Move all events pending on the sources into the staging area. */
+static int stage_pending(struct gpiod_event_merger *merger)
+{
+	struct epoll_event events[MERGER_MAX_READY];
+	int num_ready, i, ret;
+
+	num_ready = epoll_wait(merger->epfd, events, MERGER_MAX_READY, 0);
+	if (num_ready < 0)
+		return -1;
+
+	for (i = 0; i < num_ready; i++) {
+		/* The timer only serves to wake up pollers. */
+		if (!events[i].data.ptr)
+			continue;
+
+		ret = stage_source(merger, events[i].data.ptr);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+static uint64_t monotonic_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+GPIOD_API int
+gpiod_event_merger_wait_edge_events(struct gpiod_event_merger *merger,
+				    int64_t timeout_ns)
+{
+	struct epoll_event events[MERGER_MAX_READY];
+	uint64_t deadline = 0, now;
+	int64_t remaining;
+	int ret, timeout_ms;
+
+	assert(merger);
+
+	if (timeout_ns > 0)
+		deadline = monotonic_now() + timeout_ns;
+
+	for (;;) {
+		ret = stage_pending(merger);
+		if (ret)
+			return -1;
+
+		if (is_due(merger, merger->has_clock ? clock_now(merger) : 0))
+			return 1;
+
+		ret = arm_timer(merger);
+		if (ret)
+			return -1;
+
+		if (timeout_ns < 0) {
+			timeout_ms = -1;
+		} else {
+			now = monotonic_now();
+			remaining = deadline > now ? (int64_t)(deadline - now) :
+						     0;
+			if (!remaining)
+				return 0;
+
+			/* Round up so that we never return before the timeout. */
+			timeout_ms = (remaining + 999999) / 1000000;
+		}
+
+		ret = epoll_wait(merger->epfd, events, MERGER_MAX_READY,
+				 timeout_ms);
+		if (ret < 0)
+			return -1;
+		if (ret == 0 && timeout_ns >= 0)
+			return 0;
+	}
+}
+
+static int read_events(struct gpiod_event_merger *merger,
+		       struct gpiod_edge_event_buffer *buffer,
+		       size_t max_events, bool flush)
+{
+	struct gpio_v2_line_event *events;
+	uint64_t now = 0;
+	size_t num_events = 0;
+	int ret;
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	max_events = MIN(max_events,
+			 gpiod_edge_event_buffer_get_capacity(buffer));
+	max_events = MIN(max_events, MERGER_MAX_READ);
+	events = gpiod_edge_event_buffer_get_data(buffer);
+	merger->num_read = 0;
+
+	ret = stage_pending(merger);
+	if (ret)
+		return -1;
+
+	if (merger->has_clock)
+		now = clock_now(merger);
+
+	while (num_events < max_events &&
+	       (flush ? merger->num_staged > 0 : is_due(merger, now))) {
+		events[num_events] = merger->heap[0].data;
+		merger->read_requests[num_events] = merger->heap[0].request;
+		if (merger->heap[0].data.timestamp_ns > merger->last_ts)
+			merger->last_ts = merger->heap[0].data.timestamp_ns;
+		num_events++;
+		pop_event(merger);
+	}
+
+	merger->num_read = num_events;
+	gpiod_edge_event_buffer_set_num_events(buffer, num_events);
+
+	ret = arm_timer(merger);
+	if (ret)
+		return -1;
+
+	return num_events;
+}
+
+GPIOD_API int
+gpiod_event_merger_read_edge_events(struct gpiod_event_merger *merger,
+				    struct gpiod_edge_event_buffer *buffer,
+				    size_t max_events)
+{
+	assert(merger);
+
+	return read_events(merger, buffer, max_events, false);
+}
+
+GPIOD_API int
+gpiod_event_merger_flush_edge_events(struct gpiod_event_merger *merger,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events)
+{
+	assert(merger);
+
+	return read_events(merger, buffer, max_events, true);
+}
+
+GPIOD_API struct gpiod_line_request *
+gpiod_event_merger_get_event_request(struct gpiod_event_merger *merger,
+				     unsigned long index)
+{
+	assert(merger);
+
+	if (index >= merger->num_read || !merger->read_requests[index]) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return merger->read_requests[index];
+}
@@ -0,0 +1,433 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define RING_MAGIC		0x47504552 /* "GPER" */
+#define RING_VERSION		1
+#define RING_DEFAULT_CAPACITY	1024
+#define RING_MAX_CAPACITY	(1UL << 24)
+
+/*
+ * Layout of the shared file. The producer is the only writer, readers map
+ * the file read-only and keep their cursors to themselves.
+ *
+ * Each slot carries a sequence number: 2n + 1 while event n is being written
+ * into it and 2n + 2 once it's complete. A reader expecting event n copies
+ * the slot only if the number reads 2n + 2 both before and after the copy,
+ * otherwise the producer lapped it and the event is counted as overrun.
+ */
+struct ring_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t capacity;
+	/* Number of events published so far. */
+	uint64_t head;
+	uint32_t closed;
+	uint32_t padding[9];
+};
+
+struct ring_slot {
+	uint64_t seq;
+	uint64_t timestamp_ns;
+	uint32_t id;
+	uint32_t offset;
+	uint32_t seqno;
+	uint32_t line_seqno;
+};
+
+struct ring_map {
+	struct ring_header *hdr;
+	struct ring_slot *slots;
+	size_t size;
+};
+
+struct gpiod_event_ring {
+	struct ring_map map;
+	char *path;
+};
+
+struct gpiod_event_ring_reader {
+	struct ring_map map;
+	uint64_t capacity;
+	uint64_t cursor;
+	unsigned long num_overruns;
+};
+
+static size_t ring_size(uint64_t capacity)
+{
+	return sizeof(struct ring_header) + capacity * sizeof(struct ring_slot);
+}
+
+static void ring_map_set(struct ring_map *map, void *addr, size_t size)
+{
+	map->hdr = addr;
+	map->slots = (struct ring_slot *)(map->hdr + 1);
+	map->size = size;
+}
+
+static size_t round_up_pow2(size_t capacity)
+{
+	size_t pow2 = 1;
+
+	while (pow2 < capacity)
+		pow2 <<= 1;
+
+	return pow2;
+}
+
+GPIOD_API struct gpiod_event_ring *gpiod_event_ring_create(const char *path,
+							   size_t capacity)
+{
+	struct gpiod_event_ring *ring;
+	char tmp[PATH_MAX];
+	void *addr;
+	size_t size;
+	int fd;
+
+	if (!path) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if (capacity == 0)
+		capacity = RING_DEFAULT_CAPACITY;
+	if (capacity > RING_MAX_CAPACITY) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	capacity = round_up_pow2(capacity);
+	size = ring_size(capacity);
+
+	if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= PATH_MAX) {
+		errno = ENAMETOOLONG;
+		return NULL;
+	}
+
+	ring = gpiod_malloc(sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	memset(ring, 0, sizeof(*ring));
+
+	ring->path = gpiod_strdup(path);
+	if (!ring->path)
+		goto err_free_ring;
+
+	/*
+	 * Set the ring up under a temporary name and move it in place once
+	 * it's complete: readers never see a half-initialized header and
+	 * readers of a previous ring keep their mapping of the old file.
+	 */
+	fd = mkostemp(tmp, O_CLOEXEC);
+	if (fd < 0)
+		goto err_free_path;
+
+	if (fchmod(fd, 0644) || ftruncate(fd, size))
+		goto err_unlink;
+
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED)
+		goto err_unlink;
+
+	close(fd);
+	fd = -1;
+
+	ring_map_set(&ring->map, addr, size);
+	ring->map.hdr->magic = RING_MAGIC;
+	ring->map.hdr->version = RING_VERSION;
+	ring->map.hdr->capacity = capacity;
+
+	if (rename(tmp, path))
+		goto err_unmap;
+
+	return ring;
+
+err_unmap:
+	munmap(addr, size);
+err_unlink:
+	if (fd >= 0)
+		close(fd);
+	unlink(tmp);
+err_free_path:
+	gpiod_free(ring->path);
+err_free_ring:
+	gpiod_free(ring);
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_event_ring_free(struct gpiod_event_ring *ring)
+{
+	if (!ring)
+		return;
+
+	__atomic_store_n(&ring->map.hdr->closed, 1, __ATOMIC_RELEASE);
+	munmap(ring->map.hdr, ring->map.size);
+	unlink(ring->path);
+	gpiod_free(ring->path);
+	gpiod_free(ring);
+}
+
+GPIOD_API size_t gpiod_event_ring_get_capacity(struct gpiod_event_ring *ring)
+{
+	assert(ring);
+
+	return ring->map.hdr->capacity;
+}
+
+static void publish_event(struct ring_map *map, uint64_t n,
+			  struct gpio_v2_line_event *event)
+{
+	struct ring_slot *slot = &map->slots[n & (map->hdr->capacity - 1)];
+
+	__atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&slot->timestamp_ns, event->timestamp_ns,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->id, event->id, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->offset, event->offset, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->seqno, event->seqno, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->line_seqno, event->line_seqno,
+			 __ATOMIC_RELAXED);
+
+	__atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+	__atomic_store_n(&map->hdr->head, n + 1, __ATOMIC_RELEASE);
+}
+
+GPIOD_API int gpiod_event_ring_publish(struct gpiod_event_ring *ring,
+				       struct gpiod_edge_event_buffer *buffer)
+{
+	struct gpio_v2_line_event *events;
+	size_t num_events, i;
+	uint64_t head;
+
+	assert(ring);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	events = gpiod_edge_event_buffer_get_data(buffer);
+	num_events = gpiod_edge_event_buffer_get_num_events(buffer);
+	/* Only the producer writes the head, no need to load it atomically. */
+	head = ring->map.hdr->head;
+
+	for (i = 0; i < num_events; i++)
+		publish_event(&ring->map, head + i, &events[i]);
+
+	return num_events;
+}
+
+GPIOD_API int
+gpiod_event_ring_publish_request(struct gpiod_event_ring *ring,
+				 struct gpiod_line_request *request,
+				 struct gpiod_edge_event_buffer *buffer,
+				 size_t max_events)
+{
+	int ret;
+
+	assert(ring);
+
+	if (!request || !buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, max_events);
+	if (ret <= 0)
+		return ret;
+
+	return gpiod_event_ring_publish(ring, buffer);
+}
+
+GPIOD_API struct gpiod_event_ring_reader *
+gpiod_event_ring_reader_open(const char *path)
+{
+	struct gpiod_event_ring_reader *reader;
+	struct ring_header *hdr;
+	struct stat st;
+	void *addr;
+	int fd;
+
+	if (!path) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st))
+		goto err_close;
+
+	if ((size_t)st.st_size < sizeof(*hdr)) {
+		errno = EINVAL;
+		goto err_close;
+	}
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED)
+		goto err_close;
+
+	close(fd);
+
+	hdr = addr;
+	if (hdr->magic != RING_MAGIC || hdr->version != RING_VERSION ||
+	    !hdr->capacity || hdr->capacity > RING_MAX_CAPACITY ||
+	    (hdr->capacity & (hdr->capacity - 1)) ||
+	    (size_t)st.st_size < ring_size(hdr->capacity)) {
+		errno = EINVAL;
+		goto err_unmap;
+	}
+
+	reader = gpiod_malloc(sizeof(*reader));
+	if (!reader)
+		goto err_unmap;
+
+	memset(reader, 0, sizeof(*reader));
+	ring_map_set(&reader->map, addr, st.st_size);
+	reader->capacity = hdr->capacity;
+	/* Only events published from now on are of interest. */
+	reader->cursor = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+
+	return reader;
+
+err_unmap:
+	munmap(addr, st.st_size);
+
+	return NULL;
+
+err_close:
+	close(fd);
+
+	return NULL;
+}
+
+GPIOD_API void
+gpiod_event_ring_reader_close(struct gpiod_event_ring_reader *reader)
+{
+	if (!reader)
+		return;
+
+	munmap(reader->map.hdr, reader->map.size);
+	gpiod_free(reader);
+}
+
+static bool read_slot(struct gpiod_event_ring_reader *reader,
+		      struct gpio_v2_line_event *event)
+{
+	struct ring_slot *slot;
+	uint64_t seq;
+
+	slot = &reader->map.slots[reader->cursor & (reader->capacity - 1)];
+
+	seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+	if (seq != 2 * reader->cursor + 2)
+		return false;
+
+	memset(event, 0, sizeof(*event));
+	event->timestamp_ns = __atomic_load_n(&slot->timestamp_ns,
+					      __ATOMIC_RELAXED);
+	event->id = __atomic_load_n(&slot->id, __ATOMIC_RELAXED);
+	event->offset = __atomic_load_n(&slot->offset, __ATOMIC_RELAXED);
+	event->seqno = __atomic_load_n(&slot->seqno, __ATOMIC_RELAXED);
+	event->line_seqno = __atomic_load_n(&slot->line_seqno,
+					    __ATOMIC_RELAXED);
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
+
+GPIOD_API int
+gpiod_event_ring_reader_read(struct gpiod_event_ring_reader *reader,
+			     struct gpiod_edge_event_buffer *buffer,
+			     size_t max_events)
+{
+	struct gpio_v2_line_event *events;
+	size_t num_events = 0, capacity;
+	uint64_t head, dropped = 0;
+
+	assert(reader);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	capacity = gpiod_edge_event_buffer_get_capacity(buffer);
+	if (max_events == 0 || max_events > capacity)
+		max_events = capacity;
+
+	events = gpiod_edge_event_buffer_get_data(buffer);
+	head = __atomic_load_n(&reader->map.hdr->head, __ATOMIC_ACQUIRE);
+
+	while (num_events < max_events && reader->cursor < head) {
+		if (head - reader->cursor > reader->capacity) {
+			dropped += head - reader->capacity - reader->cursor;
+			reader->cursor = head - reader->capacity;
+		}
+
+		if (read_slot(reader, &events[num_events])) {
+			num_events++;
+		} else {
+			/* Overwritten under our feet, see how far we're behind. */
+			dropped++;
+			head = __atomic_load_n(&reader->map.hdr->head,
+					       __ATOMIC_ACQUIRE);
+		}
+
+		reader->cursor++;
+	}
+
+	gpiod_edge_event_buffer_set_num_events(buffer, num_events);
+	gpiod_edge_event_buffer_set_num_dropped(buffer, dropped);
+	reader->num_overruns += dropped;
+
+	return num_events;
+}
+
+GPIOD_API size_t
+gpiod_event_ring_reader_get_num_pending(struct gpiod_event_ring_reader *reader)
+{
+	uint64_t head;
+
+	assert(reader);
+
+	head = __atomic_load_n(&reader->map.hdr->head, __ATOMIC_ACQUIRE);
+
+	return head - reader->cursor;
+}
+
+GPIOD_API unsigned long
+gpiod_event_ring_reader_get_num_overruns(struct gpiod_event_ring_reader *reader)
+{
+	assert(reader);
+
+	return reader->num_overruns;
+}
+
+GPIOD_API bool
+gpiod_event_ring_reader_is_closed(struct gpiod_event_ring_reader *reader)
+{
+	assert(reader);
+
+	return __atomic_load_n(&reader->map.hdr->closed, __ATOMIC_ACQUIRE);
+}
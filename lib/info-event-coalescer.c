@@ -0,0 +1,426 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/param.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/* Same as the max capacity of an info event buffer. */
+#define COALESCER_MAX_READ	32
+/* Number of info events consumed with a single read(). */
+#define COALESCER_READ_BATCH	16
+
+struct coalesced_line {
+	/* Last merged event, with the type replaced by the net change. */
+	struct gpio_v2_line_info_changed latest;
+	/* Type of the event which opened the window. */
+	uint32_t first_type;
+	uint64_t first_ts;
+	unsigned long num_merged;
+	bool pending;
+};
+
+struct gpiod_info_event_coalescer {
+	struct gpiod_chip *chip;
+	uint64_t window_ns;
+	struct coalesced_line *lines;
+	size_t num_lines;
+	/*
+	 * Offsets of the pending lines in the order their windows were opened.
+	 * A line is queued at most once so the queue never overflows.
+	 */
+	unsigned int *queue;
+	size_t queue_head;
+	size_t num_queued;
+	unsigned long num_suppressed;
+	int epfd;
+	int timerfd;
+	struct gpiod_info_event_buffer *chunk;
+	/* Number of merged events of every event returned by the last read. */
+	unsigned long read_merged[COALESCER_MAX_READ];
+	size_t num_read;
+};
+
+GPIOD_API struct gpiod_info_event_coalescer *
+gpiod_info_event_coalescer_new(struct gpiod_chip *chip, uint64_t window_ns)
+{
+	struct gpiod_info_event_coalescer *coalescer;
+	struct gpiod_chip_info *info;
+	struct epoll_event ev;
+	int ret;
+
+	assert(chip);
+
+	info = gpiod_chip_get_info(chip);
+	if (!info)
+		return NULL;
+
+	coalescer = gpiod_malloc(sizeof(*coalescer));
+	if (!coalescer)
+		goto err_free_info;
+
+	memset(coalescer, 0, sizeof(*coalescer));
+	coalescer->chip = chip;
+	coalescer->window_ns = window_ns;
+	coalescer->num_lines = gpiod_chip_info_get_num_lines(info);
+	coalescer->epfd = -1;
+	coalescer->timerfd = -1;
+
+	coalescer->lines = gpiod_calloc(MAX(coalescer->num_lines, 1),
+					sizeof(*coalescer->lines));
+	if (!coalescer->lines)
+		goto err_free_coalescer;
+
+	coalescer->queue = gpiod_calloc(MAX(coalescer->num_lines, 1),
+					sizeof(*coalescer->queue));
+	if (!coalescer->queue)
+		goto err_free_coalescer;
+
+	coalescer->chunk = gpiod_info_event_buffer_new(COALESCER_READ_BATCH);
+	if (!coalescer->chunk)
+		goto err_free_coalescer;
+
+	coalescer->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (coalescer->epfd < 0)
+		goto err_free_coalescer;
+
+	/* Info event timestamps are always read from the monotonic clock. */
+	coalescer->timerfd = timerfd_create(CLOCK_MONOTONIC,
+					    TFD_CLOEXEC | TFD_NONBLOCK);
+	if (coalescer->timerfd < 0)
+		goto err_free_coalescer;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+
+	ret = epoll_ctl(coalescer->epfd, EPOLL_CTL_ADD, coalescer->timerfd,
+			&ev);
+	if (ret)
+		goto err_free_coalescer;
+
+	ret = epoll_ctl(coalescer->epfd, EPOLL_CTL_ADD,
+			gpiod_chip_get_fd(chip), &ev);
+	if (ret)
+		goto err_free_coalescer;
+
+	gpiod_chip_info_free(info);
+
+	return coalescer;
+
+err_free_coalescer:
+	gpiod_info_event_coalescer_free(coalescer);
+err_free_info:
+	gpiod_chip_info_free(info);
+
+	return NULL;
+}
+
+GPIOD_API void
+gpiod_info_event_coalescer_free(struct gpiod_info_event_coalescer *coalescer)
+{
+	if (!coalescer)
+		return;
+
+	if (coalescer->timerfd >= 0)
+		close(coalescer->timerfd);
+	if (coalescer->epfd >= 0)
+		close(coalescer->epfd);
+	gpiod_info_event_buffer_free(coalescer->chunk);
+	gpiod_free(coalescer->queue);
+	gpiod_free(coalescer->lines);
+	gpiod_free(coalescer);
+}
+
+GPIOD_API int
+gpiod_info_event_coalescer_get_fd(struct gpiod_info_event_coalescer *coalescer)
+{
+	assert(coalescer);
+
+	return coalescer->epfd;
+}
+
+GPIOD_API unsigned long gpiod_info_event_coalescer_get_num_merged(
+		struct gpiod_info_event_coalescer *coalescer,
+		unsigned long index)
+{
+	assert(coalescer);
+
+	if (index >= coalescer->num_read)
+		return 0;
+
+	return coalescer->read_merged[index];
+}
+
+GPIOD_API unsigned long gpiod_info_event_coalescer_get_num_suppressed(
+		struct gpiod_info_event_coalescer *coalescer)
+{
+	assert(coalescer);
+
+	return coalescer->num_suppressed;
+}
+
+static struct coalesced_line *
+queue_head(struct gpiod_info_event_coalescer *coalescer)
+{
+	return &coalescer->lines[coalescer->queue[coalescer->queue_head]];
+}
+
+static void merge_event(struct gpiod_info_event_coalescer *coalescer,
+			struct gpio_v2_line_info_changed *event)
+{
+	struct coalesced_line *line;
+	size_t tail;
+
+	/* Can't happen unless there's a bug in the kernel. */
+	if (event->info.offset >= coalescer->num_lines)
+		return;
+
+	line = &coalescer->lines[event->info.offset];
+
+	if (!line->pending) {
+		line->pending = true;
+		line->first_type = event->event_type;
+		line->first_ts = event->timestamp_ns;
+		line->num_merged = 0;
+
+		tail = (coalescer->queue_head + coalescer->num_queued) %
+		       coalescer->num_lines;
+		coalescer->queue[tail] = event->info.offset;
+		coalescer->num_queued++;
+	}
+
+	line->latest = *event;
+	line->num_merged++;
+}
+
+/* Move all info events pending on the chip into the per-line slots. */
+static int stage_pending(struct gpiod_info_event_coalescer *coalescer)
+{
+	struct gpio_v2_line_info_changed *events;
+	int ret, i;
+
+	events = gpiod_info_event_buffer_get_data(coalescer->chunk);
+
+	for (;;) {
+		ret = gpiod_poll_fd(gpiod_chip_get_fd(coalescer->chip), 0);
+		if (ret <= 0)
+			return ret;
+
+		ret = gpiod_chip_read_info_events(coalescer->chip,
+						  coalescer->chunk,
+						  COALESCER_READ_BATCH);
+		if (ret < 0)
+			return -1;
+
+		for (i = 0; i < ret; i++)
+			merge_event(coalescer, &events[i]);
+	}
+}
+
+static uint64_t monotonic_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool is_due(struct gpiod_info_event_coalescer *coalescer, uint64_t now)
+{
+	if (!coalescer->num_queued)
+		return false;
+
+	return queue_head(coalescer)->first_ts + coalescer->window_ns <= now;
+}
+
+static int arm_timer(struct gpiod_info_event_coalescer *coalescer)
+{
+	struct itimerspec its;
+	uint64_t expiry;
+	uint64_t val;
+	ssize_t rd;
+
+	/* Clear a previous expiry so that the fd isn't readable anymore. */
+	rd = read(coalescer->timerfd, &val, sizeof(val));
+	if (rd < 0 && errno != EAGAIN)
+		return -1;
+
+	memset(&its, 0, sizeof(its));
+
+	if (coalescer->num_queued) {
+		expiry = queue_head(coalescer)->first_ts + coalescer->window_ns;
+		/* A zero it_value would disarm the timer. */
+		if (!expiry)
+			expiry = 1;
+
+		its.it_value.tv_sec = expiry / 1000000000ULL;
+		its.it_value.tv_nsec = expiry % 1000000000ULL;
+	}
+
+	return timerfd_settime(coalescer->timerfd, TFD_TIMER_ABSTIME, &its,
+			       NULL);
+}
+
+/*
+ * Whether the line was requested before the burst follows from the type of
+ * its first event and whether it's requested after it from the last one.
+ */
+static bool net_change(struct coalesced_line *line, uint32_t *type)
+{
+	bool was_requested, is_requested;
+
+	if (line->num_merged == 1) {
+		*type = line->latest.event_type;
+		return true;
+	}
+
+	was_requested = line->first_type != GPIOLINE_CHANGED_REQUESTED;
+	is_requested = line->latest.event_type != GPIOLINE_CHANGED_RELEASED;
+
+	if (was_requested && is_requested)
+		*type = GPIOLINE_CHANGED_CONFIG;
+	else if (is_requested)
+		*type = GPIOLINE_CHANGED_REQUESTED;
+	else if (was_requested)
+		*type = GPIOLINE_CHANGED_RELEASED;
+	else
+		return false;
+
+	return true;
+}
+
+static int read_events(struct gpiod_info_event_coalescer *coalescer,
+		       struct gpiod_info_event_buffer *buffer,
+		       size_t max_events, bool flush)
+{
+	struct gpio_v2_line_info_changed *events;
+	struct coalesced_line *line;
+	size_t num_events = 0;
+	uint64_t now;
+	uint32_t type;
+	int ret;
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	max_events = MIN(max_events,
+			 gpiod_info_event_buffer_get_capacity(buffer));
+	max_events = MIN(max_events, COALESCER_MAX_READ);
+	events = gpiod_info_event_buffer_get_data(buffer);
+	coalescer->num_read = 0;
+
+	ret = stage_pending(coalescer);
+	if (ret)
+		return -1;
+
+	now = monotonic_now();
+
+	while (num_events < max_events &&
+	       (flush ? coalescer->num_queued > 0 : is_due(coalescer, now))) {
+		line = queue_head(coalescer);
+		line->pending = false;
+		coalescer->queue_head = (coalescer->queue_head + 1) %
+					coalescer->num_lines;
+		coalescer->num_queued--;
+
+		if (!net_change(line, &type)) {
+			coalescer->num_suppressed += line->num_merged;
+			continue;
+		}
+
+		events[num_events] = line->latest;
+		events[num_events].event_type = type;
+		coalescer->read_merged[num_events] = line->num_merged;
+		num_events++;
+	}
+
+	ret = gpiod_info_event_buffer_decode(buffer,
+					     num_events * sizeof(*events));
+	if (ret < 0)
+		return -1;
+
+	coalescer->num_read = num_events;
+
+	ret = arm_timer(coalescer);
+	if (ret)
+		return -1;
+
+	return num_events;
+}
+
+GPIOD_API int gpiod_info_event_coalescer_wait_info_events(
+		struct gpiod_info_event_coalescer *coalescer,
+		int64_t timeout_ns)
+{
+	struct epoll_event event;
+	uint64_t deadline = 0, now;
+	int64_t remaining;
+	int ret, timeout_ms;
+
+	assert(coalescer);
+
+	if (timeout_ns > 0)
+		deadline = monotonic_now() + timeout_ns;
+
+	for (;;) {
+		ret = stage_pending(coalescer);
+		if (ret)
+			return -1;
+
+		if (is_due(coalescer, monotonic_now()))
+			return 1;
+
+		ret = arm_timer(coalescer);
+		if (ret)
+			return -1;
+
+		if (timeout_ns < 0) {
+			timeout_ms = -1;
+		} else {
+			now = monotonic_now();
+			remaining = deadline > now ? (int64_t)(deadline - now) :
+						     0;
+			if (!remaining)
+				return 0;
+
+			/* Round up so that we never return before the timeout. */
+			timeout_ms = (remaining + 999999) / 1000000;
+		}
+
+		ret = epoll_wait(coalescer->epfd, &event, 1, timeout_ms);
+		if (ret < 0)
+			return -1;
+		if (ret == 0 && timeout_ns >= 0)
+			return 0;
+	}
+}
+
+GPIOD_API int gpiod_info_event_coalescer_read_info_events(
+		struct gpiod_info_event_coalescer *coalescer,
+		struct gpiod_info_event_buffer *buffer, size_t max_events)
+{
+	assert(coalescer);
+
+	return read_events(coalescer, buffer, max_events, false);
+}
+
+GPIOD_API int gpiod_info_event_coalescer_flush_info_events(
+		struct gpiod_info_event_coalescer *coalescer,
+		struct gpiod_info_event_buffer *buffer, size_t max_events)
+{
+	assert(coalescer);
+
+	return read_events(coalescer, buffer, max_events, true);
+}
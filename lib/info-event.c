@@ -15,16 +15,20 @@ struct gpiod_info_event {
 	struct gpiod_line_info *info;
 };
 
-struct gpiod_info_event *
-gpiod_info_event_from_uapi(struct gpio_v2_line_info_changed *uapi_evt)
-{
-	struct gpiod_info_event *event;
+/* As defined in the kernel. */
+#define INFO_EVENT_BUFFER_MAX_CAPACITY 32
 
-	event = malloc(sizeof(*event));
-	if (!event)
-		return NULL;
+struct gpiod_info_event_buffer {
+	size_t capacity;
+	size_t num_events;
+	struct gpio_v2_line_info_changed *data;
+	struct gpiod_info_event *events;
+	struct gpiod_line_info *infos;
+};
 
-	memset(event, 0, sizeof(*event));
+static int info_event_decode(struct gpiod_info_event *event,
+			     struct gpio_v2_line_info_changed *uapi_evt)
+{
 	event->timestamp = uapi_evt->timestamp_ns;
 
 	switch (uapi_evt->event_type) {
@@ -40,13 +44,33 @@ gpiod_info_event_from_uapi(struct gpio_v2_line_info_changed *uapi_evt)
 	default:
 		/* Can't happen unless there's a bug in the kernel. */
 		errno = ENOMSG;
-		free(event);
+		return -1;
+	}
+
+	return 0;
+}
+
+struct gpiod_info_event *
+gpiod_info_event_from_uapi(struct gpio_v2_line_info_changed *uapi_evt)
+{
+	struct gpiod_info_event *event;
+	int ret;
+
+	event = gpiod_malloc(sizeof(*event));
+	if (!event)
+		return NULL;
+
+	memset(event, 0, sizeof(*event));
+
+	ret = info_event_decode(event, uapi_evt);
+	if (ret) {
+		gpiod_free(event);
 		return NULL;
 	}
 
 	event->info = gpiod_line_info_from_uapi(&uapi_evt->info);
 	if (!event->info) {
-		free(event);
+		gpiod_free(event);
 		return NULL;
 	}
 
@@ -59,7 +83,7 @@ GPIOD_API void gpiod_info_event_free(struct gpiod_info_event *event)
 		return;
 
 	gpiod_line_info_free(event->info);
-	free(event);
+	gpiod_free(event);
 }
 
 GPIOD_API enum gpiod_info_event_type
@@ -103,3 +127,143 @@ struct gpiod_info_event *gpiod_info_event_read_fd(int fd)
 
 	return gpiod_info_event_from_uapi(&uapi_evt);
 }
+
+GPIOD_API struct gpiod_info_event_buffer *
+gpiod_info_event_buffer_new(size_t capacity)
+{
+	struct gpiod_info_event_buffer *buf;
+	size_t i;
+
+	if (capacity == 0 || capacity > INFO_EVENT_BUFFER_MAX_CAPACITY)
+		capacity = INFO_EVENT_BUFFER_MAX_CAPACITY;
+
+	buf = gpiod_malloc(sizeof(*buf));
+	if (!buf)
+		return NULL;
+
+	memset(buf, 0, sizeof(*buf));
+	buf->capacity = capacity;
+
+	buf->data = gpiod_calloc(capacity, sizeof(*buf->data));
+	if (!buf->data)
+		goto err_free_buf;
+
+	buf->events = gpiod_calloc(capacity, sizeof(*buf->events));
+	if (!buf->events)
+		goto err_free_data;
+
+	buf->infos = gpiod_line_info_array_new(capacity);
+	if (!buf->infos)
+		goto err_free_events;
+
+	for (i = 0; i < capacity; i++)
+		buf->events[i].info = gpiod_line_info_array_get(buf->infos, i);
+
+	return buf;
+
+err_free_events:
+	gpiod_free(buf->events);
+err_free_data:
+	gpiod_free(buf->data);
+err_free_buf:
+	gpiod_free(buf);
+
+	return NULL;
+}
+
+GPIOD_API size_t
+gpiod_info_event_buffer_get_capacity(struct gpiod_info_event_buffer *buffer)
+{
+	assert(buffer);
+
+	return buffer->capacity;
+}
+
+GPIOD_API void
+gpiod_info_event_buffer_free(struct gpiod_info_event_buffer *buffer)
+{
+	if (!buffer)
+		return;
+
+	gpiod_free(buffer->infos);
+	gpiod_free(buffer->events);
+	gpiod_free(buffer->data);
+	gpiod_free(buffer);
+}
+
+GPIOD_API struct gpiod_info_event *
+gpiod_info_event_buffer_get_event(struct gpiod_info_event_buffer *buffer,
+				  unsigned long index)
+{
+	assert(buffer);
+
+	if (index >= buffer->num_events) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return &buffer->events[index];
+}
+
+GPIOD_API size_t
+gpiod_info_event_buffer_get_num_events(struct gpiod_info_event_buffer *buffer)
+{
+	assert(buffer);
+
+	return buffer->num_events;
+}
+
+void *gpiod_info_event_buffer_get_data(struct gpiod_info_event_buffer *buffer)
+{
+	return buffer->data;
+}
+
+int gpiod_info_event_buffer_decode(struct gpiod_info_event_buffer *buffer,
+				   size_t num_bytes)
+{
+	size_t num_events, i;
+	int ret;
+
+	buffer->num_events = 0;
+	num_events = num_bytes / sizeof(*buffer->data);
+
+	for (i = 0; i < num_events; i++) {
+		ret = info_event_decode(&buffer->events[i], &buffer->data[i]);
+		if (ret)
+			return -1;
+
+		gpiod_line_info_fill_from_uapi(buffer->events[i].info,
+					       &buffer->data[i].info);
+	}
+
+	buffer->num_events = num_events;
+
+	return num_events;
+}
+
+int gpiod_info_event_buffer_read_fd(int fd,
+				    struct gpiod_info_event_buffer *buffer,
+				    size_t max_events)
+{
+	ssize_t rd;
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (max_events > buffer->capacity)
+		max_events = buffer->capacity;
+
+	buffer->num_events = 0;
+
+	rd = read(fd, buffer->data, max_events * sizeof(*buffer->data));
+	if (rd < 0) {
+		return -1;
+	} else if ((size_t)rd < sizeof(*buffer->data)) {
+		errno = EIO;
+		return -1;
+	}
+
+	return gpiod_info_event_buffer_decode(buffer, rd);
+}
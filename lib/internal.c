@@ -26,6 +26,11 @@ bool gpiod_check_gpiochip_device(const char *path, bool set_errno)
 		goto out;
 	}
 
+#ifdef GPIOD_WITH_MOCK
+	if (gpiod_mock_has_chip(path))
+		return true;
+#endif
+
 	rv = lstat(path, &statbuf);
 	if (rv)
 		goto out;
@@ -132,3 +137,27 @@ void gpiod_line_mask_assign_bit(uint64_t *mask, unsigned int nr, bool value)
 	else
 		*mask &= ~(1ULL << nr);
 }
+
+uint64_t gpiod_line_mask_load(const uint64_t *mask)
+{
+	return __atomic_load_n(mask, __ATOMIC_RELAXED);
+}
+
+void gpiod_line_mask_store(uint64_t *mask, uint64_t value)
+{
+	__atomic_store_n(mask, value, __ATOMIC_RELAXED);
+}
+
+void gpiod_line_mask_update(uint64_t *mask, uint64_t bits, uint64_t values)
+{
+	/*
+	 * Bits are only cleared by the first and only set by the second
+	 * operation. Updates of disjoint bits from different threads don't
+	 * overwrite each other and no bit is ever seen at a value it was
+	 * neither at before nor after.
+	 */
+	if (bits & ~values)
+		__atomic_fetch_and(mask, ~(bits & ~values), __ATOMIC_RELAXED);
+	if (bits & values)
+		__atomic_fetch_or(mask, bits & values, __ATOMIC_RELAXED);
+}
@@ -5,8 +5,10 @@
 #define __LIBGPIOD_GPIOD_INTERNAL_H__
 
 #include <gpiod.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 #include "uapi/gpio.h"
 
@@ -14,32 +16,208 @@
 
 #define GPIOD_API	__attribute__((visibility("default")))
 #define GPIOD_BIT(nr)	(1UL << (nr))
+#define GPIOD_UNUSED	__attribute__((unused))
+
+/*
+ * Static tracepoints are compiled in with --enable-tracing and listed in the
+ * TRACING section of the README. When disabled they expand to nothing and
+ * their arguments are not evaluated.
+ */
+#ifdef GPIOD_WITH_TRACING
+#include <sys/sdt.h>
+#define gpiod_trace(name, ...)	STAP_PROBEV(libgpiod, name, ##__VA_ARGS__)
+#else
+#define gpiod_trace(name, ...)	do { } while (0)
+#endif
+
+/*
+ * With --enable-mock-backend, the system calls issued on the character device
+ * go through the mock backend which serves the file descriptors of mock chips
+ * and their requests itself and passes all others to the kernel.
+ */
+#ifdef GPIOD_WITH_MOCK
+bool gpiod_mock_has_chip(const char *path);
+bool gpiod_mock_owns_fd(int fd);
+int gpiod_mock_open(const char *path, int flags);
+int gpiod_mock_close(int fd);
+int gpiod_mock_ioctl(int fd, unsigned long cmd, void *arg);
+ssize_t gpiod_mock_read(int fd, void *buf, size_t count);
+#define gpiod_sys_open(path, flags)	gpiod_mock_open(path, flags)
+#define gpiod_sys_close(fd)		gpiod_mock_close(fd)
+#define gpiod_sys_ioctl(fd, cmd, arg)	gpiod_mock_ioctl(fd, cmd, arg)
+#define gpiod_sys_read(fd, buf, count)	gpiod_mock_read(fd, buf, count)
+#else
+#define gpiod_sys_open(path, flags)	open(path, flags)
+#define gpiod_sys_close(fd)		close(fd)
+#define gpiod_sys_ioctl(fd, cmd, arg)	ioctl(fd, cmd, arg)
+#define gpiod_sys_read(fd, buf, count)	read(fd, buf, count)
+#endif
 
 bool gpiod_check_gpiochip_device(const char *path, bool set_errno);
 
+void *gpiod_malloc(size_t size);
+void *gpiod_calloc(size_t nmemb, size_t size);
+void *gpiod_realloc(void *ptr, size_t old_size, size_t new_size);
+char *gpiod_strdup(const char *str);
+void gpiod_free(void *ptr);
+
 struct gpiod_chip_info *
 gpiod_chip_info_from_uapi(struct gpiochip_info *uapi_info);
+int gpiod_chip_read_line_info(struct gpiod_chip *chip, unsigned int offset,
+			      struct gpio_v2_line_info *info);
 struct gpiod_line_info *
 gpiod_line_info_from_uapi(struct gpio_v2_line_info *uapi_info);
+void gpiod_line_info_fill_from_uapi(struct gpiod_line_info *info,
+				    struct gpio_v2_line_info *uapi_info);
+void gpiod_line_info_fill_compact(struct gpiod_line_info *info,
+				  struct gpio_v2_line_info *uapi_info,
+				  const char *name, const char *consumer);
+size_t gpiod_line_info_compact_size(void);
+struct gpiod_line_info *gpiod_line_info_array_new(size_t num);
+struct gpiod_line_info *
+gpiod_line_info_array_get(struct gpiod_line_info *array, size_t index);
 void gpiod_request_config_to_uapi(struct gpiod_request_config *config,
 				  struct gpio_v2_line_request *uapi_req);
+struct gpiod_request_config *
+gpiod_request_config_copy(struct gpiod_request_config *config);
+void gpiod_request_template_get_uapi(struct gpiod_request_template *tmpl,
+				     struct gpio_v2_line_request *uapi_req);
+struct gpiod_request_config *
+gpiod_request_template_get_request_config(struct gpiod_request_template *tmpl);
+struct gpiod_line_config *
+gpiod_request_template_get_line_config(struct gpiod_request_template *tmpl);
+bool gpiod_line_settings_equal(struct gpiod_line_settings *left,
+			       struct gpiod_line_settings *right);
 int gpiod_line_config_to_uapi(struct gpiod_line_config *config,
 			      struct gpio_v2_line_request *uapi_cfg);
+struct gpiod_line_config *gpiod_line_config_copy(struct gpiod_line_config *config);
+int gpiod_line_config_merge(struct gpiod_line_config *dst,
+			    struct gpiod_line_config *src);
+int gpiod_line_config_set_line_output_value(struct gpiod_line_config *config,
+					    unsigned int offset,
+					    enum gpiod_line_value value);
 struct gpiod_line_request *
-gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req);
+gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req,
+			     struct gpiod_line_config *line_cfg,
+			     bool output_shadow);
 int gpiod_edge_event_buffer_read_fd(int fd,
 				    struct gpiod_edge_event_buffer *buffer,
 				    size_t max_events);
+void *gpiod_edge_event_buffer_get_data(struct gpiod_edge_event_buffer *buffer);
+void gpiod_edge_event_buffer_set_num_events(
+		struct gpiod_edge_event_buffer *buffer, size_t num_events);
+int gpiod_edge_event_buffer_reserve(struct gpiod_edge_event_buffer *buffer,
+				    size_t capacity);
+void gpiod_edge_event_buffer_set_num_dropped(
+		struct gpiod_edge_event_buffer *buffer, size_t num_dropped);
+void gpiod_edge_event_buffer_account_read(
+		struct gpiod_edge_event_buffer *buffer, bool full);
+void gpiod_edge_event_buffer_adapt(struct gpiod_edge_event_buffer *buffer);
+int gpiod_line_request_enable_adaptive_buffer(
+		struct gpiod_line_request *request, int chip_fd,
+		const char *consumer, size_t max_size);
+int gpiod_line_request_enable_input_shadow(struct gpiod_line_request *request);
+int gpiod_line_request_enable_latency_histogram(
+		struct gpiod_line_request *request);
+int gpiod_line_request_enable_edge_stats(struct gpiod_line_request *request);
+int gpiod_line_request_set_nonblocking(struct gpiod_line_request *request);
+unsigned int
+gpiod_line_request_get_fd_generation(struct gpiod_line_request *request);
+struct gpiod_line_config *
+gpiod_line_request_get_line_config(struct gpiod_line_request *request);
+void gpiod_line_request_get_request_config(struct gpiod_line_request *request,
+					   struct gpiod_request_config *req_cfg);
+size_t gpiod_line_request_account_events(struct gpiod_line_request *request,
+					 const struct gpio_v2_line_event *events,
+					 size_t num_events);
+size_t gpiod_line_request_debounce_events(struct gpiod_line_request *request,
+					  struct gpio_v2_line_event *events,
+					  size_t num_events);
+size_t gpiod_line_request_filter_events(struct gpiod_line_request *request,
+					struct gpio_v2_line_event *events,
+					size_t num_events);
+void gpiod_pulse_decoder_add_uapi_events(struct gpiod_pulse_decoder *decoder,
+					 const struct gpio_v2_line_event *events,
+					 size_t num_events);
 struct gpiod_info_event *
 gpiod_info_event_from_uapi(struct gpio_v2_line_info_changed *uapi_evt);
 struct gpiod_info_event *gpiod_info_event_read_fd(int fd);
+void *gpiod_info_event_buffer_get_data(struct gpiod_info_event_buffer *buffer);
+int gpiod_info_event_buffer_decode(struct gpiod_info_event_buffer *buffer,
+				   size_t num_bytes);
+int gpiod_info_event_buffer_read_fd(int fd,
+				    struct gpiod_info_event_buffer *buffer,
+				    size_t max_events);
+
+struct gpiod_thread_attr *
+gpiod_thread_attr_copy(struct gpiod_thread_attr *attr);
+int gpiod_thread_attr_to_pthread(struct gpiod_thread_attr *attr,
+				 pthread_attr_t *pattr);
+struct gpiod_thread_state *gpiod_thread_state_save(void);
+void gpiod_thread_state_restore(struct gpiod_thread_state *state);
 
 int gpiod_poll_fd(int fd, int64_t timeout);
+int gpiod_poll_fd_cancellable(int fd, int64_t timeout_ns,
+			      struct gpiod_wait_cancel *cancel);
+
+struct gpiod_uring;
+
+struct gpiod_uring *gpiod_uring_new(unsigned int entries);
+void gpiod_uring_free(struct gpiod_uring *ring);
+int gpiod_uring_get_fd(struct gpiod_uring *ring);
+int gpiod_uring_queue_read(struct gpiod_uring *ring, int fd, void *buf,
+			   size_t len, uint64_t user_data);
+int gpiod_uring_queue_cancel(struct gpiod_uring *ring, uint64_t target,
+			     uint64_t user_data);
+int gpiod_uring_wait(struct gpiod_uring *ring, int64_t timeout_ns);
+bool gpiod_uring_reap(struct gpiod_uring *ring, uint64_t *user_data, int *res);
+
+enum gpiod_stats_ioctl_type {
+	GPIOD_STATS_IOCTL_GET = 0,
+	GPIOD_STATS_IOCTL_SET,
+	GPIOD_STATS_IOCTL_CONFIG,
+	GPIOD_STATS_IOCTL_INFO,
+	GPIOD_STATS_IOCTL_NUM_TYPES
+};
+
+struct gpiod_stats *gpiod_stats_new(void);
+struct gpiod_stats *gpiod_stats_copy(struct gpiod_stats *stats);
+void gpiod_stats_reset(struct gpiod_stats *stats);
+uint64_t gpiod_stats_now(void);
+int gpiod_stats_ioctl(struct gpiod_stats *stats,
+		      enum gpiod_stats_ioctl_type type, int fd,
+		      unsigned long cmd, void *arg);
+void gpiod_stats_add_read(struct gpiod_stats *stats, size_t num_bytes,
+			  size_t num_events);
+void gpiod_stats_add_wait(struct gpiod_stats *stats, uint64_t start_ns);
+uint64_t gpiod_stats_get_last_ioctl_time_ns(struct gpiod_stats *stats);
+
+struct gpiod_latency_histogram *gpiod_latency_histogram_array_new(size_t num);
+struct gpiod_latency_histogram *
+gpiod_latency_histogram_array_get(struct gpiod_latency_histogram *array,
+				  size_t index);
+struct gpiod_latency_histogram *
+gpiod_latency_histogram_copy(struct gpiod_latency_histogram *hist);
+void gpiod_latency_histogram_reset(struct gpiod_latency_histogram *hist);
+void gpiod_latency_histogram_add(struct gpiod_latency_histogram *hist,
+				 uint64_t latency_ns);
+
+struct gpiod_edge_stats *gpiod_edge_stats_array_new(size_t num);
+struct gpiod_edge_stats *
+gpiod_edge_stats_array_get(struct gpiod_edge_stats *array, size_t index);
+struct gpiod_edge_stats *gpiod_edge_stats_copy(struct gpiod_edge_stats *stats);
+void gpiod_edge_stats_reset(struct gpiod_edge_stats *stats);
+void gpiod_edge_stats_add(struct gpiod_edge_stats *stats, bool rising,
+			  uint64_t timestamp_ns);
 
 void gpiod_line_mask_zero(uint64_t *mask);
 void gpiod_line_mask_fill(uint64_t *mask);
 bool gpiod_line_mask_test_bit(const uint64_t *mask, int nr);
 void gpiod_line_mask_set_bit(uint64_t *mask, unsigned int nr);
 void gpiod_line_mask_assign_bit(uint64_t *mask, unsigned int nr, bool value);
+/* Atomic accessors for masks shared by threads using the same request. */
+uint64_t gpiod_line_mask_load(const uint64_t *mask);
+void gpiod_line_mask_store(uint64_t *mask, uint64_t value);
+void gpiod_line_mask_update(uint64_t *mask, uint64_t bits, uint64_t values);
 
 #endif /* __LIBGPIOD_GPIOD_INTERNAL_H__ */
@@ -0,0 +1,1197 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/param.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define SHARD_NUM_LINES		GPIO_V2_LINES_MAX
+/* Number of edge events staged per shard for merging. */
+#define SHARD_BUFFER_SIZE	64
+/* epoll data identifying the eventfd signalling staged events. */
+#define STAGED_EVENTS_ID	((uint32_t)-1)
+/* Slot of a line that isn't held by any shard. */
+#define NO_SHARD		UINT_MAX
+
+struct shard {
+	struct gpiod_line_request *request;
+	/* Config the shard was requested with, NULL for the defaults. */
+	struct gpiod_request_config *req_cfg;
+	struct gpio_v2_line_event *events;
+	/* Grows past SHARD_BUFFER_SIZE when carrying events over. */
+	size_t capacity;
+	size_t num_events;
+	size_t head;
+	/* The last read filled the staging buffer, more may be pending. */
+	bool full;
+	/* Scratch masks used when fanning out operations on values. */
+	uint64_t mask;
+	uint64_t values;
+};
+
+struct offset_index {
+	unsigned int offset;
+	unsigned int index;
+};
+
+/* Where a line lives - its shard and its bit in the shard's request. */
+struct line_slot {
+	unsigned int shard;
+	unsigned int bit;
+};
+
+struct gpiod_large_request {
+	struct shard *shards;
+	size_t num_shards;
+	unsigned int *offsets;
+	struct line_slot *slots;
+	size_t num_lines;
+	/* Number of lines the three per-line arrays have room for. */
+	size_t lines_capacity;
+	/* Line offsets sorted for lookups, see find_line(). */
+	struct offset_index *index;
+	int epfd;
+	int evfd;
+	bool evfd_signalled;
+	size_t num_staged;
+	unsigned long seqno;
+};
+
+static int offset_index_cmp(const void *p1, const void *p2)
+{
+	const struct offset_index *i1 = p1, *i2 = p2;
+
+	if (i1->offset < i2->offset)
+		return -1;
+
+	return i1->offset > i2->offset;
+}
+
+static int find_line(struct gpiod_large_request *request, unsigned int offset)
+{
+	struct offset_index key, *entry;
+
+	key.offset = offset;
+
+	entry = bsearch(&key, request->index, request->num_lines,
+			sizeof(*request->index), offset_index_cmp);
+	if (!entry) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return entry->index;
+}
+
+static struct shard *line_shard(struct gpiod_large_request *request,
+				unsigned int index)
+{
+	return &request->shards[request->slots[index].shard];
+}
+
+static uint64_t line_bit(struct gpiod_large_request *request,
+			 unsigned int index)
+{
+	return 1ULL << request->slots[index].bit;
+}
+
+/* Make room for this many lines in the per-line arrays. */
+static int reserve_lines(struct gpiod_large_request *request, size_t num_lines)
+{
+	size_t old = request->lines_capacity;
+	struct offset_index *index;
+	struct line_slot *slots;
+	unsigned int *offsets;
+
+	if (num_lines <= old)
+		return 0;
+
+	offsets = gpiod_realloc(request->offsets, old * sizeof(*offsets),
+				num_lines * sizeof(*offsets));
+	if (!offsets)
+		return -1;
+	request->offsets = offsets;
+
+	slots = gpiod_realloc(request->slots, old * sizeof(*slots),
+			      num_lines * sizeof(*slots));
+	if (!slots)
+		return -1;
+	request->slots = slots;
+
+	index = gpiod_realloc(request->index, old * sizeof(*index),
+			      num_lines * sizeof(*index));
+	if (!index)
+		return -1;
+	request->index = index;
+
+	request->lines_capacity = num_lines;
+
+	return 0;
+}
+
+static int build_index(struct gpiod_large_request *request)
+{
+	size_t i;
+
+	for (i = 0; i < request->num_lines; i++) {
+		request->index[i].offset = request->offsets[i];
+		request->index[i].index = i;
+	}
+
+	qsort(request->index, request->num_lines, sizeof(*request->index),
+	      offset_index_cmp);
+
+	for (i = 1; i < request->num_lines; i++) {
+		if (request->index[i].offset == request->index[i - 1].offset) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Locate every line in the shards - their requests hold them in bit order.
+ * Lines not found in any shard are left with NO_SHARD.
+ */
+static void assign_slots(struct gpiod_large_request *request)
+{
+	unsigned int offsets[SHARD_NUM_LINES];
+	size_t i, num_offsets;
+	unsigned int bit;
+	int index;
+
+	for (i = 0; i < request->num_lines; i++)
+		request->slots[i].shard = NO_SHARD;
+
+	for (i = 0; i < request->num_shards; i++) {
+		num_offsets = gpiod_line_request_get_requested_offsets(
+				request->shards[i].request, offsets,
+				SHARD_NUM_LINES);
+
+		for (bit = 0; bit < num_offsets; bit++) {
+			index = find_line(request, offsets[bit]);
+			assert(index >= 0);
+
+			request->slots[index].shard = i;
+			request->slots[index].bit = bit;
+		}
+	}
+}
+
+/* Drop the lines no longer held by any shard, keeping the others in order. */
+static void compact_lines(struct gpiod_large_request *request)
+{
+	size_t i, num_lines = 0;
+	int ret;
+
+	assign_slots(request);
+
+	for (i = 0; i < request->num_lines; i++) {
+		if (request->slots[i].shard == NO_SHARD)
+			continue;
+
+		request->offsets[num_lines] = request->offsets[i];
+		request->slots[num_lines] = request->slots[i];
+		num_lines++;
+	}
+
+	request->num_lines = num_lines;
+
+	/* Can't fail - the remaining offsets were unique already. */
+	ret = build_index(request);
+	assert(!ret);
+	(void)ret;
+}
+
+static struct gpiod_line_request *
+request_shard(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg,
+	      const unsigned int *offsets, size_t num_offsets,
+	      struct gpiod_line_settings **settings)
+{
+	struct gpiod_line_request *request = NULL;
+	struct gpiod_line_config *line_cfg;
+	size_t i;
+	int ret;
+
+	line_cfg = gpiod_line_config_new();
+	if (!line_cfg)
+		return NULL;
+
+	for (i = 0; i < num_offsets; i++) {
+		ret = gpiod_line_config_add_line_settings(line_cfg, &offsets[i],
+							  1, settings ?
+							  settings[i] : NULL);
+		if (ret)
+			goto out;
+	}
+
+	request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+
+out:
+	gpiod_line_config_free(line_cfg);
+
+	return request;
+}
+
+static int watch_fd(struct gpiod_large_request *request, int op, int fd,
+		    uint32_t id)
+{
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLPRI;
+	ev.data.u32 = id;
+
+	return epoll_ctl(request->epfd, op, fd, &ev);
+}
+
+static int watch_shard(struct gpiod_large_request *request, int op,
+		       unsigned int idx)
+{
+	return watch_fd(request, op,
+			gpiod_line_request_get_fd(request->shards[idx].request),
+			idx);
+}
+
+/* Request the lines of a shard. The shard must be zeroed. */
+static int open_shard(struct gpiod_large_request *request, unsigned int idx,
+		      struct gpiod_chip *chip,
+		      struct gpiod_request_config *req_cfg,
+		      const unsigned int *offsets, size_t num_offsets,
+		      struct gpiod_line_settings **settings)
+{
+	struct shard *shard = &request->shards[idx];
+
+	shard->capacity = SHARD_BUFFER_SIZE;
+	shard->events = gpiod_calloc(shard->capacity, sizeof(*shard->events));
+	if (!shard->events)
+		return -1;
+
+	if (req_cfg) {
+		shard->req_cfg = gpiod_request_config_copy(req_cfg);
+		if (!shard->req_cfg)
+			return -1;
+	}
+
+	shard->request = request_shard(chip, req_cfg, offsets, num_offsets,
+				       settings);
+	if (!shard->request)
+		return -1;
+
+	return watch_shard(request, EPOLL_CTL_ADD, idx);
+}
+
+/* Release the lines of a shard and drop the events staged for them. */
+static void close_shard(struct gpiod_large_request *request, unsigned int idx)
+{
+	struct shard *shard = &request->shards[idx];
+
+	request->num_staged -= shard->num_events - shard->head;
+	gpiod_line_request_release(shard->request);
+	gpiod_request_config_free(shard->req_cfg);
+	gpiod_free(shard->events);
+	memset(shard, 0, sizeof(*shard));
+}
+
+static void release_shards(struct gpiod_large_request *request)
+{
+	size_t i;
+
+	for (i = 0; i < request->num_shards; i++)
+		close_shard(request, i);
+}
+
+GPIOD_API struct gpiod_large_request *
+gpiod_chip_request_large(struct gpiod_chip *chip,
+			 struct gpiod_request_config *req_cfg,
+			 const unsigned int *offsets, size_t num_offsets,
+			 struct gpiod_line_settings **settings)
+{
+	struct gpiod_large_request *request;
+	size_t i, first, num;
+	int ret, errsv;
+
+	assert(chip);
+
+	if (!offsets || !num_offsets) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	request = gpiod_malloc(sizeof(*request));
+	if (!request)
+		return NULL;
+
+	memset(request, 0, sizeof(*request));
+	request->epfd = -1;
+	request->evfd = -1;
+	request->num_lines = num_offsets;
+	request->num_shards = (num_offsets + SHARD_NUM_LINES - 1) /
+			      SHARD_NUM_LINES;
+
+	ret = reserve_lines(request, num_offsets);
+	if (ret)
+		goto err_free_request;
+
+	memcpy(request->offsets, offsets, num_offsets * sizeof(*offsets));
+
+	ret = build_index(request);
+	if (ret)
+		goto err_free_request;
+
+	request->shards = gpiod_calloc(request->num_shards,
+				       sizeof(*request->shards));
+	if (!request->shards)
+		goto err_free_request;
+
+	request->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (request->epfd < 0)
+		goto err_free_request;
+
+	request->evfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (request->evfd < 0)
+		goto err_free_request;
+
+	ret = watch_fd(request, EPOLL_CTL_ADD, request->evfd,
+		       STAGED_EVENTS_ID);
+	if (ret)
+		goto err_free_request;
+
+	for (i = 0; i < request->num_shards; i++) {
+		first = i * SHARD_NUM_LINES;
+		num = MIN(SHARD_NUM_LINES, num_offsets - first);
+
+		ret = open_shard(request, i, chip, req_cfg, &offsets[first],
+				 num, settings ? &settings[first] : NULL);
+		if (ret)
+			goto err_free_request;
+	}
+
+	assign_slots(request);
+
+	return request;
+
+err_free_request:
+	errsv = errno;
+	gpiod_large_request_release(request);
+	errno = errsv;
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_large_request_release(struct gpiod_large_request *request)
+{
+	if (!request)
+		return;
+
+	if (request->shards)
+		release_shards(request);
+	if (request->evfd >= 0)
+		close(request->evfd);
+	if (request->epfd >= 0)
+		close(request->epfd);
+	gpiod_free(request->shards);
+	gpiod_free(request->slots);
+	gpiod_free(request->index);
+	gpiod_free(request->offsets);
+	gpiod_free(request);
+}
+
+GPIOD_API size_t
+gpiod_large_request_get_num_requested_lines(struct gpiod_large_request *request)
+{
+	assert(request);
+
+	return request->num_lines;
+}
+
+GPIOD_API size_t
+gpiod_large_request_get_requested_offsets(struct gpiod_large_request *request,
+					  unsigned int *offsets,
+					  size_t max_offsets)
+{
+	size_t num_offsets;
+
+	assert(request);
+
+	if (!offsets || !max_offsets)
+		return 0;
+
+	num_offsets = MIN(request->num_lines, max_offsets);
+
+	memcpy(offsets, request->offsets, sizeof(*offsets) * num_offsets);
+
+	return num_offsets;
+}
+
+GPIOD_API size_t
+gpiod_large_request_get_num_shards(struct gpiod_large_request *request)
+{
+	assert(request);
+
+	return request->num_shards;
+}
+
+GPIOD_API enum gpiod_line_value
+gpiod_large_request_get_value(struct gpiod_large_request *request,
+			      unsigned int offset)
+{
+	int index;
+
+	assert(request);
+
+	index = find_line(request, offset);
+	if (index < 0)
+		return GPIOD_LINE_VALUE_ERROR;
+
+	return gpiod_line_request_get_value(line_shard(request, index)->request,
+					    offset);
+}
+
+GPIOD_API int
+gpiod_large_request_set_value(struct gpiod_large_request *request,
+			      unsigned int offset, enum gpiod_line_value value)
+{
+	int index;
+
+	assert(request);
+
+	index = find_line(request, offset);
+	if (index < 0)
+		return -1;
+
+	return gpiod_line_request_set_value(line_shard(request, index)->request,
+					    offset, value);
+}
+
+static int get_shard_values(struct gpiod_large_request *request)
+{
+	struct shard *shard;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < request->num_shards; i++) {
+		shard = &request->shards[i];
+		if (!shard->mask)
+			continue;
+
+		ret = gpiod_line_request_get_values_mask(shard->request,
+							 shard->mask,
+							 &shard->values);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int set_shard_values(struct gpiod_large_request *request)
+{
+	struct shard *shard;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < request->num_shards; i++) {
+		shard = &request->shards[i];
+		if (!shard->mask)
+			continue;
+
+		ret = gpiod_line_request_set_values_mask(shard->request,
+							 shard->mask,
+							 shard->values);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+static void clear_shard_masks(struct gpiod_large_request *request)
+{
+	size_t i;
+
+	for (i = 0; i < request->num_shards; i++) {
+		request->shards[i].mask = 0;
+		request->shards[i].values = 0;
+	}
+}
+
+static void fill_all_shard_masks(struct gpiod_large_request *request)
+{
+	size_t i;
+
+	for (i = 0; i < request->num_lines; i++)
+		line_shard(request, i)->mask |= line_bit(request, i);
+}
+
+static enum gpiod_line_value shard_value(struct gpiod_large_request *request,
+					 unsigned int index)
+{
+	return line_shard(request, index)->values & line_bit(request, index) ?
+			GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+}
+
+static void set_shard_value(struct gpiod_large_request *request,
+			    unsigned int index, enum gpiod_line_value value)
+{
+	struct shard *shard = line_shard(request, index);
+
+	shard->mask |= line_bit(request, index);
+	if (value)
+		shard->values |= line_bit(request, index);
+	else
+		shard->values &= ~line_bit(request, index);
+}
+
+static int map_offsets(struct gpiod_large_request *request, size_t num_values,
+		       const unsigned int *offsets)
+{
+	size_t i;
+	int index;
+
+	clear_shard_masks(request);
+
+	for (i = 0; i < num_values; i++) {
+		index = find_line(request, offsets[i]);
+		if (index < 0)
+			return -1;
+
+		line_shard(request, index)->mask |= line_bit(request, index);
+	}
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_large_request_get_values_subset(struct gpiod_large_request *request,
+				      size_t num_values,
+				      const unsigned int *offsets,
+				      enum gpiod_line_value *values)
+{
+	size_t i;
+	int ret;
+
+	assert(request);
+
+	if (!offsets || !values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = map_offsets(request, num_values, offsets);
+	if (ret)
+		return -1;
+
+	ret = get_shard_values(request);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < num_values; i++)
+		values[i] = shard_value(request,
+					find_line(request, offsets[i]));
+
+	return 0;
+}
+
+GPIOD_API int gpiod_large_request_get_values(struct gpiod_large_request *request,
+					     enum gpiod_line_value *values)
+{
+	size_t i;
+	int ret;
+
+	assert(request);
+
+	if (!values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	clear_shard_masks(request);
+	fill_all_shard_masks(request);
+
+	ret = get_shard_values(request);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < request->num_lines; i++)
+		values[i] = shard_value(request, i);
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_large_request_set_values_subset(struct gpiod_large_request *request,
+				      size_t num_values,
+				      const unsigned int *offsets,
+				      const enum gpiod_line_value *values)
+{
+	size_t i;
+	int ret;
+
+	assert(request);
+
+	if (!offsets || !values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = map_offsets(request, num_values, offsets);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < num_values; i++)
+		set_shard_value(request, find_line(request, offsets[i]),
+				values[i]);
+
+	return set_shard_values(request);
+}
+
+GPIOD_API int gpiod_large_request_set_values(struct gpiod_large_request *request,
+					     const enum gpiod_line_value *values)
+{
+	size_t i;
+
+	assert(request);
+
+	if (!values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	clear_shard_masks(request);
+
+	for (i = 0; i < request->num_lines; i++)
+		set_shard_value(request, i, values[i]);
+
+	return set_shard_values(request);
+}
+
+GPIOD_API int gpiod_large_request_get_fd(struct gpiod_large_request *request)
+{
+	assert(request);
+
+	return request->epfd;
+}
+
+GPIOD_API int
+gpiod_large_request_wait_edge_events(struct gpiod_large_request *request,
+				     int64_t timeout_ns)
+{
+	assert(request);
+
+	if (request->num_staged)
+		return 1;
+
+	return gpiod_poll_fd(request->epfd, timeout_ns);
+}
+
+static int stage_events(struct gpiod_large_request *request,
+			struct shard *shard)
+{
+	int fd = gpiod_line_request_get_fd(shard->request);
+	ssize_t rd;
+
+	rd = gpiod_sys_read(fd, shard->events,
+			    shard->capacity * sizeof(*shard->events));
+	if (rd < 0) {
+		return -1;
+	} else if ((size_t)rd < sizeof(*shard->events)) {
+		errno = EIO;
+		return -1;
+	}
+
+	shard->head = 0;
+	shard->num_events = rd / sizeof(*shard->events);
+	gpiod_line_request_account_events(shard->request, shard->events,
+					  shard->num_events);
+	shard->full = shard->num_events == shard->capacity;
+	request->num_staged += shard->num_events;
+
+	return 0;
+}
+
+/*
+ * Stage the pending events of every shard whose staging buffer is empty.
+ * Shards still holding staged events are left alone until they're drained
+ * so that the events of a single shard are always merged in order.
+ */
+static int refill_shards(struct gpiod_large_request *request, int timeout_ms)
+{
+	struct epoll_event events[SHARD_NUM_LINES];
+	struct shard *shard;
+	int num_ready, i, ret;
+
+	num_ready = epoll_wait(request->epfd, events, SHARD_NUM_LINES,
+			       timeout_ms);
+	if (num_ready < 0)
+		return -1;
+
+	for (i = 0; i < num_ready; i++) {
+		if (events[i].data.u32 == STAGED_EVENTS_ID)
+			continue;
+
+		shard = &request->shards[events[i].data.u32];
+		if (shard->head < shard->num_events)
+			continue;
+
+		ret = stage_events(request, shard);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * A shard which had more events queued than it could stage must be refilled
+ * before it's taken out of the merge, otherwise its remaining events would be
+ * emitted after newer events of other shards.
+ */
+static int refill_drained_shard(struct gpiod_large_request *request,
+				struct shard *shard)
+{
+	int ret;
+
+	if (!shard->full)
+		return 0;
+
+	shard->full = false;
+
+	ret = gpiod_poll_fd(gpiod_line_request_get_fd(shard->request), 0);
+	if (ret <= 0)
+		return ret;
+
+	return stage_events(request, shard);
+}
+
+static struct shard *oldest_shard(struct gpiod_large_request *request)
+{
+	struct shard *shard, *oldest = NULL;
+	size_t i;
+
+	for (i = 0; i < request->num_shards; i++) {
+		shard = &request->shards[i];
+		if (shard->head == shard->num_events)
+			continue;
+
+		if (!oldest || shard->events[shard->head].timestamp_ns <
+			       oldest->events[oldest->head].timestamp_ns)
+			oldest = shard;
+	}
+
+	return oldest;
+}
+
+static void update_staged_signal(struct gpiod_large_request *request)
+{
+	uint64_t val = 1;
+	ssize_t ret;
+
+	if (request->num_staged && !request->evfd_signalled) {
+		ret = write(request->evfd, &val, sizeof(val));
+		request->evfd_signalled = ret == sizeof(val);
+	} else if (!request->num_staged && request->evfd_signalled) {
+		ret = read(request->evfd, &val, sizeof(val));
+		request->evfd_signalled = ret != sizeof(val);
+	}
+}
+
+GPIOD_API int
+gpiod_large_request_read_edge_events(struct gpiod_large_request *request,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events)
+{
+	struct gpio_v2_line_event *events;
+	size_t num_events = 0;
+	struct shard *shard;
+	int ret;
+
+	assert(request);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	max_events = MIN(max_events,
+			 gpiod_edge_event_buffer_get_capacity(buffer));
+	events = gpiod_edge_event_buffer_get_data(buffer);
+	gpiod_edge_event_buffer_set_num_events(buffer, 0);
+
+	ret = refill_shards(request, 0);
+	if (ret)
+		return -1;
+
+	/* Block like a regular request if there's nothing to read yet. */
+	while (!request->num_staged) {
+		ret = refill_shards(request, -1);
+		if (ret)
+			return -1;
+	}
+
+	while (num_events < max_events) {
+		shard = oldest_shard(request);
+		if (!shard)
+			break;
+
+		events[num_events] = shard->events[shard->head++];
+		/* Per-shard sequence numbers mean nothing in the merged stream. */
+		events[num_events].seqno = ++request->seqno;
+		num_events++;
+		request->num_staged--;
+
+		if (shard->head == shard->num_events) {
+			ret = refill_drained_shard(request, shard);
+			if (ret)
+				break;
+		}
+	}
+
+	update_staged_signal(request);
+	gpiod_edge_event_buffer_set_num_events(buffer, num_events);
+
+	return num_events ? (int)num_events : ret;
+}
+
+GPIOD_API int
+gpiod_large_request_add_lines(struct gpiod_large_request *request,
+			      struct gpiod_chip *chip,
+			      struct gpiod_request_config *req_cfg,
+			      const unsigned int *offsets, size_t num_offsets,
+			      struct gpiod_line_settings **settings)
+{
+	size_t i, first, num, num_lines, num_shards, num_new;
+	struct shard *shards;
+	int ret, errsv;
+
+	assert(request);
+	assert(chip);
+
+	if (!offsets || !num_offsets) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	num_lines = request->num_lines;
+	num_shards = request->num_shards;
+	num_new = (num_offsets + SHARD_NUM_LINES - 1) / SHARD_NUM_LINES;
+
+	ret = reserve_lines(request, num_lines + num_offsets);
+	if (ret)
+		return -1;
+
+	shards = gpiod_realloc(request->shards, num_shards * sizeof(*shards),
+			       (num_shards + num_new) * sizeof(*shards));
+	if (!shards)
+		return -1;
+
+	request->shards = shards;
+	memset(&shards[num_shards], 0, num_new * sizeof(*shards));
+
+	memcpy(&request->offsets[num_lines], offsets,
+	       num_offsets * sizeof(*offsets));
+	request->num_lines += num_offsets;
+
+	/* Also catches lines that are already part of the request. */
+	ret = build_index(request);
+	if (ret)
+		goto err_restore;
+
+	/* The new lines get shards of their own, existing ones are kept. */
+	for (i = 0; i < num_new; i++) {
+		first = i * SHARD_NUM_LINES;
+		num = MIN(SHARD_NUM_LINES, num_offsets - first);
+
+		request->num_shards++;
+		ret = open_shard(request, num_shards + i, chip, req_cfg,
+				 &offsets[first], num,
+				 settings ? &settings[first] : NULL);
+		if (ret)
+			goto err_restore;
+	}
+
+	assign_slots(request);
+
+	return 0;
+
+err_restore:
+	errsv = errno;
+
+	while (request->num_shards > num_shards)
+		close_shard(request, --request->num_shards);
+
+	request->num_lines = num_lines;
+	build_index(request);
+
+	errno = errsv;
+
+	return -1;
+}
+
+static uint64_t shard_lines_mask(struct shard *shard)
+{
+	size_t num_lines;
+
+	num_lines = gpiod_line_request_get_num_requested_lines(shard->request);
+
+	return num_lines == SHARD_NUM_LINES ? UINT64_MAX :
+					      (1ULL << num_lines) - 1;
+}
+
+static int remove_shard(struct gpiod_large_request *request, unsigned int idx)
+{
+	unsigned int i;
+	int ret;
+
+	close_shard(request, idx);
+	memmove(&request->shards[idx], &request->shards[idx + 1],
+		(request->num_shards - idx - 1) * sizeof(*request->shards));
+	request->num_shards--;
+
+	/* The shards are identified by their index in epoll events. */
+	for (i = idx; i < request->num_shards; i++) {
+		ret = watch_shard(request, EPOLL_CTL_MOD, i);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Stage whatever the kernel still has queued for the shard so that it isn't
+ * lost together with its file descriptor.
+ */
+static void carry_over_events(struct gpiod_large_request *request,
+			      struct shard *shard)
+{
+	int fd = gpiod_line_request_get_fd(shard->request);
+	struct gpio_v2_line_event *events;
+	size_t num_read;
+	ssize_t rd;
+
+	shard->num_events -= shard->head;
+	memmove(shard->events, &shard->events[shard->head],
+		shard->num_events * sizeof(*shard->events));
+	shard->head = 0;
+	shard->full = false;
+
+	while (gpiod_poll_fd(fd, 0) > 0) {
+		if (shard->num_events == shard->capacity) {
+			events = gpiod_realloc(shard->events,
+				shard->capacity * sizeof(*events),
+				shard->capacity * 2 * sizeof(*events));
+			if (!events)
+				return;
+
+			shard->events = events;
+			shard->capacity *= 2;
+		}
+
+		rd = gpiod_sys_read(fd, &shard->events[shard->num_events],
+				    (shard->capacity - shard->num_events) *
+						sizeof(*shard->events));
+		if (rd < (ssize_t)sizeof(*shard->events))
+			return;
+
+		num_read = rd / sizeof(*shard->events);
+		gpiod_line_request_account_events(shard->request,
+				&shard->events[shard->num_events], num_read);
+		shard->num_events += num_read;
+		request->num_staged += num_read;
+	}
+}
+
+/* Forget the staged events of the lines marked in the shard's mask. */
+static void drop_removed_events(struct gpiod_large_request *request,
+				struct shard *shard)
+{
+	size_t i, num_events = 0;
+	int index;
+
+	for (i = shard->head; i < shard->num_events; i++) {
+		index = find_line(request, shard->events[i].offset);
+		if (index >= 0 && (shard->mask & line_bit(request, index)))
+			continue;
+
+		shard->events[num_events++] = shard->events[i];
+	}
+
+	request->num_staged -= shard->num_events - shard->head - num_events;
+	shard->head = 0;
+	shard->num_events = num_events;
+}
+
+static struct gpiod_line_config *
+shard_line_config(struct gpiod_line_request *request, uint64_t keep,
+		  uint64_t values)
+{
+	struct gpiod_line_config *applied, *line_cfg;
+	struct gpiod_line_settings *settings;
+	unsigned int offsets[SHARD_NUM_LINES];
+	size_t num_offsets, bit;
+	int ret;
+
+	line_cfg = gpiod_line_config_new();
+	if (!line_cfg)
+		return NULL;
+
+	applied = gpiod_line_request_get_line_config(request);
+	num_offsets = gpiod_line_request_get_requested_offsets(request, offsets,
+							       SHARD_NUM_LINES);
+
+	for (bit = 0; bit < num_offsets; bit++) {
+		if (!(keep & (1ULL << bit)))
+			continue;
+
+		settings = gpiod_line_config_get_line_settings(applied,
+							       offsets[bit]);
+		if (!settings)
+			goto err_free_line_cfg;
+
+		/* Keep driving the outputs with the values they have now. */
+		if (gpiod_line_settings_get_direction(settings) ==
+		    GPIOD_LINE_DIRECTION_OUTPUT)
+			gpiod_line_settings_set_output_value(settings,
+				values & (1ULL << bit) ?
+					GPIOD_LINE_VALUE_ACTIVE :
+					GPIOD_LINE_VALUE_INACTIVE);
+
+		ret = gpiod_line_config_add_line_settings(line_cfg,
+							  &offsets[bit], 1,
+							  settings);
+		gpiod_line_settings_free(settings);
+		if (ret)
+			goto err_free_line_cfg;
+	}
+
+	return line_cfg;
+
+err_free_line_cfg:
+	gpiod_line_config_free(line_cfg);
+
+	return NULL;
+}
+
+/*
+ * The kernel can't release some of the lines of a request - request the
+ * lines staying in the shard anew. If that fails, try to get all of them
+ * back. A shard that can't be restored either is removed.
+ */
+static int rerequest_shard(struct gpiod_large_request *request,
+			   unsigned int idx, struct gpiod_chip *chip)
+{
+	struct gpiod_line_config *kept_cfg = NULL, *all_cfg = NULL;
+	struct shard *shard = &request->shards[idx];
+	uint64_t all, values;
+	int ret = -1, errsv;
+
+	all = shard_lines_mask(shard);
+
+	if (gpiod_line_request_get_values_mask(shard->request, all, &values))
+		return -1;
+
+	kept_cfg = shard_line_config(shard->request, all & ~shard->mask,
+				     values);
+	all_cfg = shard_line_config(shard->request, all, values);
+	if (!kept_cfg || !all_cfg)
+		goto out;
+
+	carry_over_events(request, shard);
+	gpiod_line_request_release(shard->request);
+
+	shard->request = gpiod_chip_request_lines(chip, shard->req_cfg,
+						  kept_cfg);
+	if (shard->request) {
+		drop_removed_events(request, shard);
+		ret = 0;
+	} else {
+		errsv = errno;
+		shard->request = gpiod_chip_request_lines(chip, shard->req_cfg,
+							  all_cfg);
+		errno = errsv;
+	}
+
+	if (shard->request) {
+		if (watch_shard(request, EPOLL_CTL_ADD, idx))
+			ret = -1;
+	} else {
+		errsv = errno;
+		remove_shard(request, idx);
+		errno = errsv;
+	}
+
+out:
+	gpiod_line_config_free(kept_cfg);
+	gpiod_line_config_free(all_cfg);
+
+	return ret;
+}
+
+GPIOD_API int
+gpiod_large_request_remove_lines(struct gpiod_large_request *request,
+				 struct gpiod_chip *chip,
+				 const unsigned int *offsets,
+				 size_t num_offsets)
+{
+	struct shard *shard;
+	int index, ret = 0;
+	uint64_t bit;
+	size_t i;
+
+	assert(request);
+	assert(chip);
+
+	/* At least one line must stay - release the request otherwise. */
+	if (!offsets || !num_offsets || num_offsets >= request->num_lines) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	clear_shard_masks(request);
+
+	for (i = 0; i < num_offsets; i++) {
+		index = find_line(request, offsets[i]);
+		if (index < 0)
+			return -1;
+
+		shard = line_shard(request, index);
+		bit = line_bit(request, index);
+		if (shard->mask & bit) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		shard->mask |= bit;
+	}
+
+	/* Go backwards so that removing a shard doesn't move the next one. */
+	for (i = request->num_shards; i-- > 0;) {
+		shard = &request->shards[i];
+		if (!shard->mask)
+			continue;
+
+		if (shard->mask == shard_lines_mask(shard))
+			ret = remove_shard(request, i);
+		else
+			ret = rerequest_shard(request, i, chip);
+		if (ret)
+			break;
+	}
+
+	compact_lines(request);
+	update_staged_signal(request);
+
+	return ret;
+}
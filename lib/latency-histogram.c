@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+/*
+ * Latencies are bucketed by their power of two, each power split into
+ * SUB_BUCKETS linear steps. This keeps the relative error of the reported
+ * values below 1 / SUB_BUCKETS over the whole range at a fixed size.
+ */
+#define SUB_BUCKET_BITS	2
+#define SUB_BUCKETS	(1U << SUB_BUCKET_BITS)
+/* Anything above 2^40 ns (about 18 minutes) ends up in the last bucket. */
+#define MAX_EXPONENT	40
+#define NUM_BUCKETS	(SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * \
+			 SUB_BUCKETS)
+
+struct gpiod_latency_histogram {
+	uint64_t counts[NUM_BUCKETS];
+	uint64_t num_samples;
+	uint64_t min_ns;
+	uint64_t max_ns;
+	uint64_t sum_ns;
+};
+
+static unsigned int log2_floor(uint64_t val)
+{
+	return 63 - __builtin_clzll(val);
+}
+
+static size_t latency_to_bucket(uint64_t latency_ns)
+{
+	unsigned int exp;
+	size_t bucket;
+
+	if (latency_ns < SUB_BUCKETS)
+		return latency_ns;
+
+	exp = log2_floor(latency_ns);
+	if (exp > MAX_EXPONENT)
+		return NUM_BUCKETS - 1;
+
+	bucket = SUB_BUCKETS + (exp - SUB_BUCKET_BITS) * SUB_BUCKETS;
+	bucket += (latency_ns >> (exp - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+	return bucket;
+}
+
+/* Largest latency falling into the bucket. */
+static uint64_t bucket_limit(size_t bucket)
+{
+	unsigned int exp, sub;
+
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+
+	if (bucket == NUM_BUCKETS - 1)
+		return UINT64_MAX;
+
+	bucket -= SUB_BUCKETS;
+	exp = bucket / SUB_BUCKETS;
+	sub = bucket % SUB_BUCKETS;
+
+	return ((uint64_t)(SUB_BUCKETS + sub + 1) << exp) - 1;
+}
+
+struct gpiod_latency_histogram *gpiod_latency_histogram_array_new(size_t num)
+{
+	struct gpiod_latency_histogram *array;
+	size_t i;
+
+	array = gpiod_calloc(num, sizeof(*array));
+	if (!array)
+		return NULL;
+
+	for (i = 0; i < num; i++)
+		gpiod_latency_histogram_reset(&array[i]);
+
+	return array;
+}
+
+struct gpiod_latency_histogram *
+gpiod_latency_histogram_array_get(struct gpiod_latency_histogram *array,
+				  size_t index)
+{
+	return &array[index];
+}
+
+struct gpiod_latency_histogram *
+gpiod_latency_histogram_copy(struct gpiod_latency_histogram *hist)
+{
+	struct gpiod_latency_histogram *copy;
+
+	copy = gpiod_malloc(sizeof(*copy));
+	if (!copy)
+		return NULL;
+
+	memcpy(copy, hist, sizeof(*copy));
+
+	return copy;
+}
+
+void gpiod_latency_histogram_reset(struct gpiod_latency_histogram *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+	hist->min_ns = UINT64_MAX;
+}
+
+void gpiod_latency_histogram_add(struct gpiod_latency_histogram *hist,
+				 uint64_t latency_ns)
+{
+	hist->counts[latency_to_bucket(latency_ns)]++;
+	hist->num_samples++;
+	hist->sum_ns += latency_ns;
+
+	if (latency_ns < hist->min_ns)
+		hist->min_ns = latency_ns;
+	if (latency_ns > hist->max_ns)
+		hist->max_ns = latency_ns;
+}
+
+GPIOD_API void
+gpiod_latency_histogram_free(struct gpiod_latency_histogram *hist)
+{
+	gpiod_free(hist);
+}
+
+GPIOD_API uint64_t
+gpiod_latency_histogram_get_num_samples(struct gpiod_latency_histogram *hist)
+{
+	assert(hist);
+
+	return hist->num_samples;
+}
+
+GPIOD_API uint64_t
+gpiod_latency_histogram_get_min_ns(struct gpiod_latency_histogram *hist)
+{
+	assert(hist);
+
+	return hist->num_samples ? hist->min_ns : 0;
+}
+
+GPIOD_API uint64_t
+gpiod_latency_histogram_get_max_ns(struct gpiod_latency_histogram *hist)
+{
+	assert(hist);
+
+	return hist->max_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_latency_histogram_get_mean_ns(struct gpiod_latency_histogram *hist)
+{
+	assert(hist);
+
+	return hist->num_samples ? hist->sum_ns / hist->num_samples : 0;
+}
+
+GPIOD_API uint64_t
+gpiod_latency_histogram_get_percentile_ns(struct gpiod_latency_histogram *hist,
+					  double percentile)
+{
+	uint64_t rank, seen = 0, limit;
+	size_t i;
+
+	assert(hist);
+
+	if (!hist->num_samples)
+		return 0;
+
+	if (percentile <= 0.0)
+		return hist->min_ns;
+	if (percentile >= 100.0)
+		return hist->max_ns;
+
+	/* Nearest-rank: the smallest sample covering the percentile. */
+	rank = (uint64_t)(percentile * hist->num_samples / 100.0);
+	if ((double)rank * 100.0 < percentile * hist->num_samples)
+		rank++;
+	if (!rank)
+		rank = 1;
+
+	for (i = 0; i < NUM_BUCKETS; i++) {
+		seen += hist->counts[i];
+		if (seen >= rank)
+			break;
+	}
+
+	limit = bucket_limit(i);
+	if (limit > hist->max_ns)
+		limit = hist->max_ns;
+	if (limit < hist->min_ns)
+		limit = hist->min_ns;
+
+	return limit;
+}
@@ -11,48 +11,98 @@
 #include "internal.h"
 
 #define LINES_MAX (GPIO_V2_LINES_MAX)
-
-struct settings_node {
-	struct settings_node *next;
+/*
+ * Every line references one settings slot. Adding settings for lines that
+ * are all already in use by distinct settings temporarily needs one more.
+ */
+#define SETTINGS_MAX (LINES_MAX + 1)
+#define NUM_SLOTS(config) ((config)->max_lines + 1)
+/* Open-addressing offset lookup table, kept at most half full. */
+#define OFFSET_TABLE_SIZE(config) ((config)->max_lines * 2)
+#define NO_SLOT (-1)
+
+struct settings_slot {
 	struct gpiod_line_settings *settings;
+	unsigned int refcount;
 };
 
 struct per_line_config {
 	unsigned int offset;
-	struct settings_node *node;
+	int slot;
 };
 
 struct gpiod_line_config {
-	struct per_line_config line_configs[LINES_MAX];
+	/*
+	 * Number of lines the config has room for. The arrays below point
+	 * into the storage allocated along with the config and are sized to
+	 * it - user configs can hold as many lines as the kernel allows while
+	 * the copies kept by requests only hold the lines they configure.
+	 */
+	size_t max_lines;
+	/* Lines in the order in which they were first added. */
+	struct per_line_config *line_configs;
 	size_t num_configs;
-	enum gpiod_line_value output_values[LINES_MAX];
+	/* Maps offsets to indexes in line_configs plus one, 0 if empty. */
+	unsigned char *offset_table;
+	/* Deduplicated settings shared by all lines that use them. */
+	struct settings_slot *slots;
+	enum gpiod_line_value *output_values;
 	size_t num_output_values;
-	struct settings_node *sref_list;
+	/*
+	 * Translated kernel config, reused until the line config is modified.
+	 * Only num_lines, offsets and config are filled in.
+	 */
+	struct gpio_v2_line_request uapi_cache;
+	bool uapi_cache_valid;
 };
 
-GPIOD_API struct gpiod_line_config *gpiod_line_config_new(void)
+static size_t config_size(size_t max_lines)
+{
+	return sizeof(struct gpiod_line_config) +
+	       (max_lines + 1) * sizeof(struct settings_slot) +
+	       max_lines * (sizeof(struct per_line_config) +
+			    sizeof(enum gpiod_line_value) + 2);
+}
+
+/* Zeroes the config and lays its arrays out in the trailing storage. */
+static void config_init(struct gpiod_line_config *config, size_t max_lines)
+{
+	memset(config, 0, config_size(max_lines));
+
+	config->max_lines = max_lines;
+	config->slots = (struct settings_slot *)(config + 1);
+	config->line_configs =
+		(struct per_line_config *)(config->slots + max_lines + 1);
+	config->output_values =
+		(enum gpiod_line_value *)(config->line_configs + max_lines);
+	config->offset_table =
+		(unsigned char *)(config->output_values + max_lines);
+}
+
+static struct gpiod_line_config *config_alloc(size_t max_lines)
 {
 	struct gpiod_line_config *config;
 
-	config = malloc(sizeof(*config));
+	config = gpiod_malloc(config_size(max_lines));
 	if (!config)
 		return NULL;
 
-	memset(config, 0, sizeof(*config));
+	config_init(config, max_lines);
 
 	return config;
 }
 
-static void free_refs(struct gpiod_line_config *config)
+GPIOD_API struct gpiod_line_config *gpiod_line_config_new(void)
 {
-	struct settings_node *node, *tmp;
+	return config_alloc(LINES_MAX);
+}
 
-	for (node = config->sref_list; node;) {
-		tmp = node->next;
-		gpiod_line_settings_free(node->settings);
-		free(node);
-		node = tmp;
-	}
+static void free_slots(struct gpiod_line_config *config)
+{
+	size_t i;
+
+	for (i = 0; i < NUM_SLOTS(config); i++)
+		gpiod_line_settings_free(config->slots[i].settings);
 }
 
 GPIOD_API void gpiod_line_config_free(struct gpiod_line_config *config)
@@ -60,32 +110,126 @@ GPIOD_API void gpiod_line_config_free(struct gpiod_line_config *config)
 	if (!config)
 		return;
 
-	free_refs(config);
-	free(config);
+	free_slots(config);
+	gpiod_free(config);
 }
 
 GPIOD_API void gpiod_line_config_reset(struct gpiod_line_config *config)
 {
 	assert(config);
 
-	free_refs(config);
-	memset(config, 0, sizeof(*config));
+	free_slots(config);
+	config_init(config, config->max_lines);
 }
 
-static struct per_line_config *find_config(struct gpiod_line_config *config,
-					   unsigned int offset)
+static size_t offset_hash(unsigned int offset, size_t table_size)
+{
+	/* Fibonacci hashing - spreads consecutive offsets across the table. */
+	return (offset * 2654435761U) % table_size;
+}
+
+/*
+ * Returns the position in the lookup table holding the offset or the empty
+ * position where it should be inserted.
+ */
+static size_t offset_table_pos(struct gpiod_line_config *config,
+			       unsigned int offset)
+{
+	size_t pos = offset_hash(offset, OFFSET_TABLE_SIZE(config));
+	unsigned char idx;
+
+	for (;;) {
+		idx = config->offset_table[pos];
+		if (!idx || config->line_configs[idx - 1].offset == offset)
+			return pos;
+
+		pos = (pos + 1) % OFFSET_TABLE_SIZE(config);
+	}
+}
+
+static int find_line(struct gpiod_line_config *config, unsigned int offset)
+{
+	return (int)config->offset_table[offset_table_pos(config,
+							  offset)] - 1;
+}
+
+static void rebuild_offset_table(struct gpiod_line_config *config)
 {
-	struct per_line_config *per_line;
 	size_t i;
 
-	for (i = 0; i < config->num_configs; i++) {
-		per_line = &config->line_configs[i];
+	memset(config->offset_table, 0, OFFSET_TABLE_SIZE(config));
+
+	for (i = 0; i < config->num_configs; i++)
+		config->offset_table[offset_table_pos(config,
+			config->line_configs[i].offset)] = i + 1;
+}
+
+static void put_slot(struct gpiod_line_config *config, int slot)
+{
+	if (--config->slots[slot].refcount)
+		return;
+
+	gpiod_line_settings_free(config->slots[slot].settings);
+	config->slots[slot].settings = NULL;
+}
+
+/*
+ * Returns the index of a slot holding settings equal to the ones passed or
+ * of a newly populated slot. The slot's reference count is not changed.
+ */
+static int get_slot(struct gpiod_line_config *config,
+		    struct gpiod_line_settings *settings)
+{
+	struct gpiod_line_settings *defaults = NULL;
+	int i, free_slot = NO_SLOT;
+
+	if (!settings) {
+		defaults = gpiod_line_settings_new();
+		if (!defaults)
+			return NO_SLOT;
 
-		if (offset == per_line->offset)
-			return per_line;
+		settings = defaults;
 	}
 
-	return &config->line_configs[config->num_configs++];
+	for (i = 0; i < (int)NUM_SLOTS(config); i++) {
+		if (!config->slots[i].settings) {
+			if (free_slot == NO_SLOT)
+				free_slot = i;
+			continue;
+		}
+
+		if (gpiod_line_settings_equal(config->slots[i].settings,
+					      settings)) {
+			gpiod_line_settings_free(defaults);
+			return i;
+		}
+	}
+
+	/* Can't happen - there's always one more slot than lines. */
+	assert(free_slot != NO_SLOT);
+
+	if (!defaults) {
+		settings = gpiod_line_settings_copy(settings);
+		if (!settings)
+			return NO_SLOT;
+	}
+
+	config->slots[free_slot].settings = settings;
+
+	config->slots[free_slot].refcount = 0;
+
+	return free_slot;
+}
+
+static void assign_slot(struct gpiod_line_config *config, int idx, int slot)
+{
+	struct per_line_config *per_line = &config->line_configs[idx];
+
+	/* Take the new reference first in case it's the same slot. */
+	config->slots[slot].refcount++;
+	if (per_line->slot != NO_SLOT)
+		put_slot(config, per_line->slot);
+	per_line->slot = slot;
 }
 
 GPIOD_API int gpiod_line_config_add_line_settings(
@@ -93,8 +237,8 @@ GPIOD_API int gpiod_line_config_add_line_settings(
 	size_t num_offsets, struct gpiod_line_settings *settings)
 {
 	struct per_line_config *per_line;
-	struct settings_node *node;
-	size_t i;
+	size_t i, num_configs, pos;
+	int slot;
 
 	assert(config);
 
@@ -103,77 +247,118 @@ GPIOD_API int gpiod_line_config_add_line_settings(
 		return -1;
 	}
 
-	if ((config->num_configs + num_offsets) > LINES_MAX) {
+	if (num_offsets > LINES_MAX) {
 		errno = E2BIG;
 		return -1;
 	}
 
-	node = malloc(sizeof(*node));
-	if (!node)
+	slot = get_slot(config, settings);
+	if (slot == NO_SLOT)
 		return -1;
 
-	if (!settings)
-		node->settings = gpiod_line_settings_new();
-	else
-		node->settings = gpiod_line_settings_copy(settings);
-	if (!node->settings) {
-		free(node);
-		return -1;
-	}
+	/* Add the lines that are not configured yet. */
+	num_configs = config->num_configs;
+	for (i = 0; i < num_offsets; i++) {
+		pos = offset_table_pos(config, offsets[i]);
+		if (config->offset_table[pos])
+			continue;
 
-	node->next = config->sref_list;
-	config->sref_list = node;
+		if (config->num_configs == config->max_lines) {
+			config->num_configs = num_configs;
+			rebuild_offset_table(config);
 
-	for (i = 0; i < num_offsets; i++) {
-		per_line = find_config(config, offsets[i]);
+			if (!config->slots[slot].refcount) {
+				gpiod_line_settings_free(
+					config->slots[slot].settings);
+				config->slots[slot].settings = NULL;
+			}
+
+			errno = E2BIG;
+			return -1;
+		}
 
+		per_line = &config->line_configs[config->num_configs++];
 		per_line->offset = offsets[i];
-		per_line->node = node;
+		per_line->slot = NO_SLOT;
+		config->offset_table[pos] = config->num_configs;
 	}
 
+	for (i = 0; i < num_offsets; i++)
+		assign_slot(config, find_line(config, offsets[i]), slot);
+
+	config->uapi_cache_valid = false;
+
 	return 0;
 }
 
+static struct gpiod_line_settings *
+line_settings(struct gpiod_line_config *config, size_t idx)
+{
+	return config->slots[config->line_configs[idx].slot].settings;
+}
+
+static int set_line_output_value(struct gpiod_line_config *config, int idx,
+				 enum gpiod_line_value value)
+{
+	struct gpiod_line_settings *settings;
+	int slot, ret;
+
+	if (gpiod_line_settings_get_output_value(line_settings(config, idx)) ==
+	    value)
+		return 0;
+
+	settings = gpiod_line_settings_copy(line_settings(config, idx));
+	if (!settings)
+		return -1;
+
+	ret = gpiod_line_settings_set_output_value(settings, value);
+	if (!ret) {
+		slot = get_slot(config, settings);
+		if (slot == NO_SLOT)
+			ret = -1;
+		else
+			assign_slot(config, idx, slot);
+	}
+
+	gpiod_line_settings_free(settings);
+	config->uapi_cache_valid = false;
+
+	return ret;
+}
+
 GPIOD_API struct gpiod_line_settings *
 gpiod_line_config_get_line_settings(struct gpiod_line_config *config,
 				    unsigned int offset)
 {
 	struct gpiod_line_settings *settings;
-	struct per_line_config *per_line;
-	size_t i;
-	int ret;
+	int idx, ret;
 
 	assert(config);
 
-	for (i = 0; i < config->num_configs; i++) {
-		per_line = &config->line_configs[i];
-
-		if (per_line->offset == offset) {
-			settings = gpiod_line_settings_copy(
-					per_line->node->settings);
-			if (!settings)
-				return NULL;
-
-			/*
-			 * If a global output value was set for this line - use
-			 * it and override the one stored in settings.
-			 */
-			if (config->num_output_values > i) {
-				ret = gpiod_line_settings_set_output_value(
-						settings,
-						config->output_values[i]);
-				if (ret) {
-					gpiod_line_settings_free(settings);
-					return NULL;
-				}
-			}
+	idx = find_line(config, offset);
+	if (idx < 0) {
+		errno = ENOENT;
+		return NULL;
+	}
+
+	settings = gpiod_line_settings_copy(line_settings(config, idx));
+	if (!settings)
+		return NULL;
 
-			return settings;
+	/*
+	 * If a global output value was set for this line - use it and
+	 * override the one stored in settings.
+	 */
+	if (config->num_output_values > (size_t)idx) {
+		ret = gpiod_line_settings_set_output_value(
+				settings, config->output_values[idx]);
+		if (ret) {
+			gpiod_line_settings_free(settings);
+			return NULL;
 		}
 	}
 
-	errno = ENOENT;
-	return NULL;
+	return settings;
 }
 
 GPIOD_API int
@@ -181,13 +366,14 @@ gpiod_line_config_set_output_values(struct gpiod_line_config *config,
 				    const enum gpiod_line_value *values,
 				    size_t num_values)
 {
-	if (num_values > LINES_MAX) {
+	if (num_values > config->max_lines) {
 		errno = EINVAL;
 		return -1;
 	}
 
 	memcpy(config->output_values, values, num_values * sizeof(*values));
 	config->num_output_values = num_values;
+	config->uapi_cache_valid = false;
 
 	return 0;
 }
@@ -236,8 +422,7 @@ static bool has_at_least_one_output_direction(struct gpiod_line_config *config)
 	size_t i;
 
 	for (i = 0; i < config->num_configs; i++) {
-		if (gpiod_line_settings_get_direction(
-			    config->line_configs[i].node->settings) ==
+		if (gpiod_line_settings_get_direction(line_settings(config, i)) ==
 		    GPIOD_LINE_DIRECTION_OUTPUT)
 			return true;
 	}
@@ -255,7 +440,7 @@ static void set_output_value(uint64_t *vals, size_t bit,
 static void set_kernel_output_values(uint64_t *mask, uint64_t *vals,
 				     struct gpiod_line_config *config)
 {
-	struct per_line_config *per_line;
+	struct gpiod_line_settings *settings;
 	enum gpiod_line_value value;
 	size_t i;
 
@@ -263,16 +448,14 @@ static void set_kernel_output_values(uint64_t *mask, uint64_t *vals,
 	gpiod_line_mask_zero(vals);
 
 	for (i = 0; i < config->num_configs; i++) {
-		per_line = &config->line_configs[i];
+		settings = line_settings(config, i);
 
-		if (gpiod_line_settings_get_direction(
-			    per_line->node->settings) !=
+		if (gpiod_line_settings_get_direction(settings) !=
 		    GPIOD_LINE_DIRECTION_OUTPUT)
 			continue;
 
 		gpiod_line_mask_set_bit(mask, i);
-		value = gpiod_line_settings_get_output_value(
-			per_line->node->settings);
+		value = gpiod_line_settings_get_output_value(settings);
 		set_output_value(vals, i, value);
 	}
 
@@ -301,49 +484,64 @@ static void set_output_values(struct gpiod_line_config *config,
 	attr->mask = mask;
 }
 
-static int set_debounce_periods(struct gpiod_line_config *config,
-				struct gpio_v2_line_config *uapi_cfg,
-				unsigned int *attr_idx)
+/*
+ * Attributes are built in a single pass over the lines: each line is added
+ * to the mask of the attribute already carrying its value or opens a new
+ * one. There are at most GPIO_V2_LINE_NUM_ATTRS_MAX attributes to look
+ * through for every line.
+ */
+static struct gpio_v2_line_config_attribute *
+find_attr(struct gpio_v2_line_config *uapi_cfg, unsigned int first,
+	  unsigned int last, uint32_t id, uint64_t value)
 {
 	struct gpio_v2_line_config_attribute *attr;
-	unsigned long period_i, period_j;
-	uint64_t done, mask;
-	size_t i, j;
+	unsigned int i;
 
-	gpiod_line_mask_zero(&done);
+	for (i = first; i < last; i++) {
+		attr = &uapi_cfg->attrs[i];
 
-	for (i = 0; i < config->num_configs; i++) {
-		if (gpiod_line_mask_test_bit(&done, i))
+		if (attr->attr.id != id)
 			continue;
 
-		gpiod_line_mask_set_bit(&done, i);
-		gpiod_line_mask_zero(&mask);
+		if (id == GPIO_V2_LINE_ATTR_ID_FLAGS ?
+		    attr->attr.flags == value :
+		    attr->attr.debounce_period_us == value)
+			return attr;
+	}
 
-		period_i = gpiod_line_settings_get_debounce_period_us(
-				config->line_configs[i].node->settings);
-		if (!period_i)
-			continue;
+	return NULL;
+}
 
-		if (*attr_idx == GPIO_V2_LINE_NUM_ATTRS_MAX) {
-			errno = E2BIG;
-			return -1;
-		}
+static int set_debounce_periods(struct gpiod_line_config *config,
+				struct gpio_v2_line_config *uapi_cfg,
+				unsigned int *attr_idx)
+{
+	struct gpio_v2_line_config_attribute *attr;
+	unsigned int first = *attr_idx;
+	unsigned long period;
+	size_t i;
+
+	for (i = 0; i < config->num_configs; i++) {
+		period = gpiod_line_settings_get_debounce_period_us(
+				line_settings(config, i));
+		if (!period)
+			continue;
 
-		attr = &uapi_cfg->attrs[(*attr_idx)++];
-		attr->attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
-		attr->attr.debounce_period_us = period_i;
-		gpiod_line_mask_set_bit(&mask, i);
-
-		for (j = i; j < config->num_configs; j++) {
-			period_j = gpiod_line_settings_get_debounce_period_us(
-					config->line_configs[j].node->settings);
-			if (period_i == period_j) {
-				gpiod_line_mask_set_bit(&mask, j);
-				gpiod_line_mask_set_bit(&done, j);
+		attr = find_attr(uapi_cfg, first, *attr_idx,
+				 GPIO_V2_LINE_ATTR_ID_DEBOUNCE, period);
+		if (!attr) {
+			if (*attr_idx == GPIO_V2_LINE_NUM_ATTRS_MAX) {
+				errno = E2BIG;
+				return -1;
 			}
+
+			attr = &uapi_cfg->attrs[(*attr_idx)++];
+			attr->attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+			attr->attr.debounce_period_us = period;
+			attr->mask = 0;
 		}
 
-		attr->mask = mask;
+		attr->mask |= 1ULL << i;
 	}
 
 	return 0;
@@ -427,70 +625,37 @@ static uint64_t make_kernel_flags(struct gpiod_line_settings *settings)
 	return flags;
 }
 
-static bool settings_equal(struct gpiod_line_settings *left,
-			   struct gpiod_line_settings *right)
-{
-	if (gpiod_line_settings_get_direction(left) !=
-	    gpiod_line_settings_get_direction(right))
-		return false;
-
-	if (gpiod_line_settings_get_edge_detection(left) !=
-	    gpiod_line_settings_get_edge_detection(right))
-		return false;
-
-	if (gpiod_line_settings_get_bias(left) !=
-	    gpiod_line_settings_get_bias(right))
-		return false;
-
-	if (gpiod_line_settings_get_drive(left) !=
-	    gpiod_line_settings_get_drive(right))
-		return false;
-
-	if (gpiod_line_settings_get_active_low(left) !=
-	    gpiod_line_settings_get_active_low(right))
-		return false;
-
-	if (gpiod_line_settings_get_event_clock(left) !=
-	    gpiod_line_settings_get_event_clock(right))
-		return false;
-
-	return true;
-}
-
 static int set_flags(struct gpiod_line_config *config,
 		     struct gpio_v2_line_config *uapi_cfg,
 		     unsigned int *attr_idx)
 {
-	struct gpiod_line_settings *settings_i, *settings_j;
+	uint64_t slot_flags[SETTINGS_MAX], flags;
 	struct gpio_v2_line_config_attribute *attr;
-	bool globals_taken = false;
-	uint64_t done, mask;
-	size_t i, j;
+	unsigned int first = *attr_idx;
+	size_t i;
 
-	gpiod_line_mask_zero(&done);
+	/* Translate each distinct settings object only once. */
+	for (i = 0; i < NUM_SLOTS(config); i++) {
+		if (config->slots[i].settings)
+			slot_flags[i] = make_kernel_flags(
+						config->slots[i].settings);
+	}
 
 	for (i = 0; i < config->num_configs; i++) {
-		if (gpiod_line_mask_test_bit(&done, i))
-			continue;
-
-		gpiod_line_mask_set_bit(&done, i);
-
-		settings_i = config->line_configs[i].node->settings;
+		flags = slot_flags[config->line_configs[i].slot];
 
-		if (!globals_taken) {
-			globals_taken = true;
-			uapi_cfg->flags = make_kernel_flags(settings_i);
+		/* The first line's flags become the request-wide default. */
+		if (i == 0) {
+			uapi_cfg->flags = flags;
+			continue;
+		}
 
-			for (j = i; j < config->num_configs; j++) {
-				settings_j =
-					config->line_configs[j].node->settings;
-				if (settings_equal(settings_i, settings_j))
-					gpiod_line_mask_set_bit(&done, j);
-			}
-		} else {
-			gpiod_line_mask_zero(&mask);
-			gpiod_line_mask_set_bit(&mask, i);
+		if (flags == uapi_cfg->flags)
+			continue;
 
+		attr = find_attr(uapi_cfg, first, *attr_idx,
+				 GPIO_V2_LINE_ATTR_ID_FLAGS, flags);
+		if (!attr) {
 			if (*attr_idx == GPIO_V2_LINE_NUM_ATTRS_MAX) {
 				errno = E2BIG;
 				return -1;
@@ -498,26 +663,18 @@ static int set_flags(struct gpiod_line_config *config,
 
 			attr = &uapi_cfg->attrs[(*attr_idx)++];
 			attr->attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
-			attr->attr.flags = make_kernel_flags(settings_i);
-
-			for (j = i; j < config->num_configs; j++) {
-				settings_j =
-					config->line_configs[j].node->settings;
-				if (settings_equal(settings_i, settings_j)) {
-					gpiod_line_mask_set_bit(&done, j);
-					gpiod_line_mask_set_bit(&mask, j);
-				}
-			}
-
-			attr->mask = mask;
+			attr->attr.flags = flags;
+			attr->mask = 0;
 		}
+
+		attr->mask |= 1ULL << i;
 	}
 
 	return 0;
 }
 
-int gpiod_line_config_to_uapi(struct gpiod_line_config *config,
-			      struct gpio_v2_line_request *uapi_cfg)
+static int translate_config(struct gpiod_line_config *config,
+			    struct gpio_v2_line_request *uapi_cfg)
 {
 	unsigned int attr_idx = 0;
 	int ret;
@@ -537,3 +694,134 @@ int gpiod_line_config_to_uapi(struct gpiod_line_config *config,
 
 	return 0;
 }
+
+int gpiod_line_config_to_uapi(struct gpiod_line_config *config,
+			      struct gpio_v2_line_request *uapi_cfg)
+{
+	struct gpio_v2_line_request *cache = &config->uapi_cache;
+	int ret;
+
+	if (!config->uapi_cache_valid) {
+		memset(cache, 0, sizeof(*cache));
+
+		ret = translate_config(config, cache);
+		if (ret)
+			return -1;
+
+		config->uapi_cache_valid = true;
+	}
+
+	uapi_cfg->num_lines = cache->num_lines;
+	memcpy(uapi_cfg->offsets, cache->offsets,
+	       cache->num_lines * sizeof(*cache->offsets));
+	memcpy(&uapi_cfg->config, &cache->config, sizeof(cache->config));
+
+	return 0;
+}
+
+/*
+ * The copy only has room for the lines already configured - it's what the
+ * requests keep around and they can't gain lines once made.
+ */
+struct gpiod_line_config *gpiod_line_config_copy(struct gpiod_line_config *config)
+{
+	int slot_map[SETTINGS_MAX], old_slot, new_slot, num_slots = 0;
+	struct gpiod_line_config *copy;
+	size_t i;
+	int ret;
+
+	copy = config_alloc(MAX(config->num_configs, 1));
+	if (!copy)
+		return NULL;
+
+	for (i = 0; i < NUM_SLOTS(config); i++)
+		slot_map[i] = NO_SLOT;
+
+	/* Renumber the slots in use so that they fit the smaller table. */
+	for (i = 0; i < config->num_configs; i++) {
+		old_slot = config->line_configs[i].slot;
+		new_slot = slot_map[old_slot];
+
+		if (new_slot == NO_SLOT) {
+			new_slot = slot_map[old_slot] = num_slots++;
+			copy->slots[new_slot].settings =
+				gpiod_line_settings_copy(
+					config->slots[old_slot].settings);
+			if (!copy->slots[new_slot].settings)
+				goto err_free_copy;
+		}
+
+		copy->slots[new_slot].refcount++;
+		copy->line_configs[i].offset = config->line_configs[i].offset;
+		copy->line_configs[i].slot = new_slot;
+		copy->num_configs++;
+	}
+
+	rebuild_offset_table(copy);
+
+	/* Fold the global output values into the per-line settings. */
+	for (i = 0; i < MIN(config->num_output_values, copy->num_configs); i++) {
+		ret = set_line_output_value(copy, i, config->output_values[i]);
+		if (ret)
+			goto err_free_copy;
+	}
+
+	copy->uapi_cache_valid = false;
+
+	return copy;
+
+err_free_copy:
+	gpiod_line_config_free(copy);
+
+	return NULL;
+}
+
+int gpiod_line_config_merge(struct gpiod_line_config *dst,
+			    struct gpiod_line_config *src)
+{
+	size_t i;
+	int idx, slot, ret;
+
+	for (i = 0; i < src->num_configs; i++) {
+		if (find_line(dst, src->line_configs[i].offset) < 0) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	for (i = 0; i < src->num_configs; i++) {
+		idx = find_line(dst, src->line_configs[i].offset);
+
+		slot = get_slot(dst, line_settings(src, i));
+		if (slot == NO_SLOT)
+			return -1;
+
+		assign_slot(dst, idx, slot);
+
+		if (src->num_output_values > i) {
+			ret = set_line_output_value(dst, idx,
+						    src->output_values[i]);
+			if (ret)
+				return -1;
+		}
+	}
+
+	dst->uapi_cache_valid = false;
+
+	return 0;
+}
+
+int gpiod_line_config_set_line_output_value(struct gpiod_line_config *config,
+					    unsigned int offset,
+					    enum gpiod_line_value value)
+{
+	int idx;
+
+	idx = find_line(config, offset);
+	if (idx < 0) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	return set_line_output_value(config, idx, value);
+}
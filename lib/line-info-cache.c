@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+/* Number of info events consumed with a single read(). */
+#define LINE_INFO_CACHE_READ_BATCH	16
+
+struct gpiod_line_info_cache {
+	struct gpiod_chip *chip;
+	struct gpiod_line_info **lines;
+	size_t num_lines;
+	uint64_t generation;
+};
+
+static void unwatch_lines(struct gpiod_line_info_cache *cache)
+{
+	unsigned int offset;
+
+	gpiod_chip_unwatch_line_infos(cache->chip, NULL, 0);
+
+	for (offset = 0; offset < cache->num_lines; offset++)
+		gpiod_line_info_free(cache->lines[offset]);
+}
+
+GPIOD_API struct gpiod_line_info_cache *
+gpiod_line_info_cache_new(struct gpiod_chip *chip)
+{
+	struct gpiod_line_info_cache *cache;
+	struct gpiod_chip_info *info;
+	int ret;
+
+	assert(chip);
+
+	info = gpiod_chip_get_info(chip);
+	if (!info)
+		return NULL;
+
+	cache = gpiod_malloc(sizeof(*cache));
+	if (!cache)
+		goto err_free_info;
+
+	memset(cache, 0, sizeof(*cache));
+	cache->chip = chip;
+	cache->num_lines = gpiod_chip_info_get_num_lines(info);
+
+	cache->lines = gpiod_calloc(cache->num_lines > 0 ? cache->num_lines : 1,
+				    sizeof(*cache->lines));
+	if (!cache->lines)
+		goto err_free_cache;
+
+	/*
+	 * The watch ioctl returns the line's current state and starts the
+	 * event stream in a single step so no change can be lost between
+	 * loading the line and watching it.
+	 */
+	ret = gpiod_chip_watch_line_infos(chip, NULL, 0, cache->lines);
+	if (ret < 0)
+		goto err_free_lines;
+
+	gpiod_chip_info_free(info);
+
+	return cache;
+
+err_free_lines:
+	gpiod_free(cache->lines);
+err_free_cache:
+	gpiod_free(cache);
+err_free_info:
+	gpiod_chip_info_free(info);
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_line_info_cache_free(struct gpiod_line_info_cache *cache)
+{
+	if (!cache)
+		return;
+
+	unwatch_lines(cache);
+	gpiod_free(cache->lines);
+	gpiod_free(cache);
+}
+
+GPIOD_API size_t
+gpiod_line_info_cache_get_num_lines(struct gpiod_line_info_cache *cache)
+{
+	assert(cache);
+
+	return cache->num_lines;
+}
+
+GPIOD_API uint64_t
+gpiod_line_info_cache_get_generation(struct gpiod_line_info_cache *cache)
+{
+	assert(cache);
+
+	return cache->generation;
+}
+
+GPIOD_API struct gpiod_line_info *
+gpiod_line_info_cache_get_line_info(struct gpiod_line_info_cache *cache,
+				    unsigned int offset)
+{
+	assert(cache);
+
+	if (offset >= cache->num_lines) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return gpiod_line_info_copy(cache->lines[offset]);
+}
+
+GPIOD_API int gpiod_line_info_cache_get_fd(struct gpiod_line_info_cache *cache)
+{
+	assert(cache);
+
+	return gpiod_chip_get_fd(cache->chip);
+}
+
+static int replace_line_info(struct gpiod_line_info_cache *cache,
+			     struct gpio_v2_line_info *uapi_info)
+{
+	struct gpiod_line_info *info;
+
+	/* Can't happen unless there's a bug in the kernel. */
+	if (uapi_info->offset >= cache->num_lines) {
+		errno = ENOMSG;
+		return -1;
+	}
+
+	info = gpiod_line_info_from_uapi(uapi_info);
+	if (!info)
+		return -1;
+
+	gpiod_line_info_free(cache->lines[uapi_info->offset]);
+	cache->lines[uapi_info->offset] = info;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_line_info_cache_update(struct gpiod_line_info_cache *cache)
+{
+	struct gpio_v2_line_info_changed events[LINE_INFO_CACHE_READ_BATCH];
+	size_t num_events, i;
+	int ret, fd, total;
+	ssize_t rd;
+
+	assert(cache);
+
+	fd = gpiod_chip_get_fd(cache->chip);
+
+	for (total = 0;;) {
+		ret = gpiod_poll_fd(fd, 0);
+		if (ret < 0)
+			return -1;
+		if (ret == 0)
+			break;
+
+		rd = read(fd, events, sizeof(events));
+		if (rd < 0) {
+			if (errno == EAGAIN)
+				break;
+
+			return -1;
+		} else if (rd == 0 || (size_t)rd % sizeof(*events)) {
+			errno = EIO;
+			return -1;
+		}
+
+		num_events = rd / sizeof(*events);
+		for (i = 0; i < num_events; i++) {
+			ret = replace_line_info(cache, &events[i].info);
+			if (ret)
+				return -1;
+		}
+
+		cache->generation++;
+		total += num_events;
+	}
+
+	return total;
+}
+
+GPIOD_API int gpiod_line_info_cache_reload(struct gpiod_line_info_cache *cache)
+{
+	struct gpiod_line_info **lines;
+	unsigned int offset;
+	int ret;
+
+	assert(cache);
+
+	/*
+	 * Drain the event stream first so that the fresh snapshot isn't
+	 * overwritten by stale events queued before it was taken.
+	 */
+	ret = gpiod_line_info_cache_update(cache);
+	if (ret < 0)
+		return -1;
+
+	lines = gpiod_calloc(cache->num_lines > 0 ? cache->num_lines : 1,
+			     sizeof(*lines));
+	if (!lines)
+		return -1;
+
+	for (offset = 0; offset < cache->num_lines; offset++) {
+		lines[offset] = gpiod_chip_get_line_info(cache->chip, offset);
+		if (!lines[offset])
+			goto err_free_lines;
+	}
+
+	for (offset = 0; offset < cache->num_lines; offset++) {
+		gpiod_line_info_free(cache->lines[offset]);
+		cache->lines[offset] = lines[offset];
+	}
+
+	gpiod_free(lines);
+	cache->generation++;
+
+	return 0;
+
+err_free_lines:
+	while (offset--)
+		gpiod_line_info_free(lines[offset]);
+	gpiod_free(lines);
+
+	return -1;
+}
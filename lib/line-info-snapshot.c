@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* Reference of a line without a name or consumer. */
+#define NO_STRING	UINT32_MAX
+
+struct gpiod_line_info_snapshot {
+	size_t num_lines;
+	size_t size;
+	/* Packed line infos followed by the interned strings. */
+	char data[];
+};
+
+/* Interned strings collected while reading the lines. */
+struct string_pool {
+	char *data;
+	size_t len;
+	/* Open-addressing hash table of pool offsets plus one, 0 if free. */
+	uint32_t *slots;
+	size_t num_slots;
+};
+
+static uint32_t hash_string(const char *str)
+{
+	uint32_t hash = 2166136261U;
+
+	while (*str)
+		hash = (hash ^ (unsigned char)*str++) * 16777619U;
+
+	return hash;
+}
+
+/* Returns the offset of the string in the pool, adding it if needed. */
+static uint32_t intern_string(struct string_pool *pool, const char *str)
+{
+	size_t idx, len;
+	uint32_t off;
+
+	if (str[0] == '\0')
+		return NO_STRING;
+
+	idx = hash_string(str) & (pool->num_slots - 1);
+
+	while (pool->slots[idx]) {
+		off = pool->slots[idx] - 1;
+		if (strcmp(pool->data + off, str) == 0)
+			return off;
+
+		idx = (idx + 1) & (pool->num_slots - 1);
+	}
+
+	off = pool->len;
+	len = strlen(str) + 1;
+	memcpy(pool->data + off, str, len);
+	pool->len += len;
+	pool->slots[idx] = off + 1;
+
+	return off;
+}
+
+static size_t chip_num_lines(struct gpiod_chip *chip)
+{
+	struct gpiod_chip_info *info;
+	size_t num_lines;
+
+	info = gpiod_chip_get_info(chip);
+	if (!info)
+		return SIZE_MAX;
+
+	num_lines = gpiod_chip_info_get_num_lines(info);
+	gpiod_chip_info_free(info);
+
+	return num_lines;
+}
+
+static const char *pool_string(struct gpiod_line_info_snapshot *snapshot,
+			       uint32_t off)
+{
+	if (off == NO_STRING)
+		return NULL;
+
+	return snapshot->data +
+	       snapshot->num_lines * gpiod_line_info_compact_size() + off;
+}
+
+GPIOD_API struct gpiod_line_info_snapshot *
+gpiod_line_info_snapshot_new(struct gpiod_chip *chip)
+{
+	struct gpiod_line_info_snapshot *snapshot = NULL;
+	struct gpio_v2_line_info *uapi_infos;
+	struct string_pool pool;
+	size_t num_lines, i, size;
+	uint32_t *refs = NULL;
+	int ret;
+
+	assert(chip);
+
+	num_lines = chip_num_lines(chip);
+	if (num_lines == SIZE_MAX)
+		return NULL;
+
+	memset(&pool, 0, sizeof(pool));
+
+	uapi_infos = gpiod_calloc(num_lines ?: 1, sizeof(*uapi_infos));
+	if (!uapi_infos)
+		return NULL;
+
+	/* Two strings per line at most, keep the table at most half full. */
+	for (pool.num_slots = 4; pool.num_slots < 4 * num_lines;)
+		pool.num_slots *= 2;
+
+	pool.slots = gpiod_calloc(pool.num_slots, sizeof(*pool.slots));
+	pool.data = gpiod_malloc((num_lines ?: 1) * 2 * GPIO_MAX_NAME_SIZE);
+	refs = gpiod_calloc((num_lines ?: 1) * 2, sizeof(*refs));
+	if (!pool.slots || !pool.data || !refs)
+		goto out;
+
+	for (i = 0; i < num_lines; i++) {
+		ret = gpiod_chip_read_line_info(chip, i, &uapi_infos[i]);
+		if (ret)
+			goto out;
+
+		/* Don't trust the kernel to terminate the strings. */
+		uapi_infos[i].name[GPIO_MAX_NAME_SIZE - 1] = '\0';
+		uapi_infos[i].consumer[GPIO_MAX_NAME_SIZE - 1] = '\0';
+
+		refs[2 * i] = intern_string(&pool, uapi_infos[i].name);
+		refs[2 * i + 1] = intern_string(&pool, uapi_infos[i].consumer);
+	}
+
+	size = sizeof(*snapshot) + num_lines * gpiod_line_info_compact_size() +
+	       pool.len;
+
+	snapshot = gpiod_malloc(size);
+	if (!snapshot)
+		goto out;
+
+	snapshot->num_lines = num_lines;
+	snapshot->size = size;
+	memcpy(snapshot->data + num_lines * gpiod_line_info_compact_size(),
+	       pool.data, pool.len);
+
+	for (i = 0; i < num_lines; i++)
+		gpiod_line_info_fill_compact(
+			gpiod_line_info_snapshot_get_line_info(snapshot, i),
+			&uapi_infos[i], pool_string(snapshot, refs[2 * i]),
+			pool_string(snapshot, refs[2 * i + 1]));
+
+out:
+	gpiod_free(refs);
+	gpiod_free(pool.data);
+	gpiod_free(pool.slots);
+	gpiod_free(uapi_infos);
+
+	return snapshot;
+}
+
+GPIOD_API void
+gpiod_line_info_snapshot_free(struct gpiod_line_info_snapshot *snapshot)
+{
+	gpiod_free(snapshot);
+}
+
+GPIOD_API size_t
+gpiod_line_info_snapshot_get_num_lines(struct gpiod_line_info_snapshot *snapshot)
+{
+	assert(snapshot);
+
+	return snapshot->num_lines;
+}
+
+GPIOD_API struct gpiod_line_info *
+gpiod_line_info_snapshot_get_line_info(
+		struct gpiod_line_info_snapshot *snapshot, unsigned int offset)
+{
+	assert(snapshot);
+
+	if (offset >= snapshot->num_lines) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return (struct gpiod_line_info *)(snapshot->data +
+				offset * gpiod_line_info_compact_size());
+}
+
+GPIOD_API size_t
+gpiod_line_info_snapshot_get_size(struct gpiod_line_info_snapshot *snapshot)
+{
+	assert(snapshot);
+
+	return snapshot->size;
+}
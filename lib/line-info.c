@@ -8,24 +8,69 @@
 
 #include "internal.h"
 
+/*
+ * The strings are referenced rather than embedded so that snapshots can pack
+ * the infos of a chip tightly and share the strings between them.
+ *
+ * Standalone objects keep the raw kernel info in the trailing storage and
+ * reference the strings in place. The flags are only decoded by the getters
+ * so that users looking at a few fields don't pay for decoding all of them.
+ * The attributes are scanned once on construction - the getters never write
+ * to the object, so it can be read from multiple threads concurrently.
+ */
 struct gpiod_line_info {
 	unsigned int offset;
-	char name[GPIO_MAX_NAME_SIZE];
-	bool used;
-	char consumer[GPIO_MAX_NAME_SIZE];
-	enum gpiod_line_direction direction;
-	bool active_low;
-	enum gpiod_line_bias bias;
-	enum gpiod_line_drive drive;
-	enum gpiod_line_edge edge;
-	enum gpiod_line_clock event_clock;
+	uint32_t debounce_period_us;
+	/* Raw uAPI flags, decoded on access. */
+	uint64_t flags;
 	bool debounced;
-	unsigned long debounce_period_us;
+	/* NULL if the kernel reported an empty string. */
+	const char *name;
+	const char *consumer;
+	char storage[];
 };
 
+/* Size of a standalone object with room for the raw info. */
+#define LINE_INFO_STANDALONE_SIZE \
+	(sizeof(struct gpiod_line_info) + sizeof(struct gpio_v2_line_info))
+
+static const char *store_string(char *storage, const char *str)
+{
+	size_t len;
+
+	if (!str || str[0] == '\0')
+		return NULL;
+
+	len = strnlen(str, GPIO_MAX_NAME_SIZE - 1);
+	memcpy(storage, str, len);
+	storage[len] = '\0';
+
+	return storage;
+}
+
+static void decode_attrs(struct gpiod_line_info *info,
+			 struct gpio_v2_line_info *uapi_info)
+{
+	struct gpio_v2_line_attribute *attr;
+	size_t i;
+
+	/*
+	 * We assume that the kernel returns correct configuration and that no
+	 * attributes repeat.
+	 */
+	for (i = 0; i < uapi_info->num_attrs; i++) {
+		attr = &uapi_info->attrs[i];
+
+		if (attr->id == GPIO_V2_LINE_ATTR_ID_DEBOUNCE) {
+			info->debounced = true;
+			info->debounce_period_us = attr->debounce_period_us;
+		}
+	}
+}
+
 GPIOD_API void gpiod_line_info_free(struct gpiod_line_info *info)
 {
-	free(info);
+	gpiod_free(info);
 }
 
 GPIOD_API struct gpiod_line_info *
@@ -35,11 +80,14 @@ gpiod_line_info_copy(struct gpiod_line_info *info)
 
 	assert(info);
 
-	copy = malloc(sizeof(*info));
+	copy = gpiod_malloc(LINE_INFO_STANDALONE_SIZE);
 	if (!copy)
 		return NULL;
 
 	memcpy(copy, info, sizeof(*info));
+	copy->name = store_string(copy->storage, info->name);
+	copy->consumer = store_string(copy->storage + GPIO_MAX_NAME_SIZE,
+				      info->consumer);
 
 	return copy;
 }
@@ -55,21 +103,21 @@ GPIOD_API const char *gpiod_line_info_get_name(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->name[0] == '\0' ? NULL : info->name;
+	return info->name;
 }
 
 GPIOD_API bool gpiod_line_info_is_used(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->used;
+	return info->flags & GPIO_V2_LINE_FLAG_USED;
 }
 
 GPIOD_API const char *gpiod_line_info_get_consumer(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->consumer[0] == '\0' ? NULL : info->consumer;
+	return info->consumer;
 }
 
 GPIOD_API enum gpiod_line_direction
@@ -77,14 +125,17 @@ gpiod_line_info_get_direction(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->direction;
+	if (info->flags & GPIO_V2_LINE_FLAG_OUTPUT)
+		return GPIOD_LINE_DIRECTION_OUTPUT;
+
+	return GPIOD_LINE_DIRECTION_INPUT;
 }
 
 GPIOD_API bool gpiod_line_info_is_active_low(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->active_low;
+	return info->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW;
 }
 
 GPIOD_API enum gpiod_line_bias
@@ -92,7 +143,14 @@ gpiod_line_info_get_bias(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->bias;
+	if (info->flags & GPIO_V2_LINE_FLAG_BIAS_PULL_UP)
+		return GPIOD_LINE_BIAS_PULL_UP;
+	if (info->flags & GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN)
+		return GPIOD_LINE_BIAS_PULL_DOWN;
+	if (info->flags & GPIO_V2_LINE_FLAG_BIAS_DISABLED)
+		return GPIOD_LINE_BIAS_DISABLED;
+
+	return GPIOD_LINE_BIAS_UNKNOWN;
 }
 
 GPIOD_API enum gpiod_line_drive
@@ -100,7 +158,12 @@ gpiod_line_info_get_drive(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->drive;
+	if (info->flags & GPIO_V2_LINE_FLAG_OPEN_DRAIN)
+		return GPIOD_LINE_DRIVE_OPEN_DRAIN;
+	if (info->flags & GPIO_V2_LINE_FLAG_OPEN_SOURCE)
+		return GPIOD_LINE_DRIVE_OPEN_SOURCE;
+
+	return GPIOD_LINE_DRIVE_PUSH_PULL;
 }
 
 GPIOD_API enum gpiod_line_edge
@@ -108,7 +171,15 @@ gpiod_line_info_get_edge_detection(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->edge;
+	if ((info->flags & GPIO_V2_LINE_FLAG_EDGE_RISING) &&
+	    (info->flags & GPIO_V2_LINE_FLAG_EDGE_FALLING))
+		return GPIOD_LINE_EDGE_BOTH;
+	if (info->flags & GPIO_V2_LINE_FLAG_EDGE_RISING)
+		return GPIOD_LINE_EDGE_RISING;
+	if (info->flags & GPIO_V2_LINE_FLAG_EDGE_FALLING)
+		return GPIOD_LINE_EDGE_FALLING;
+
+	return GPIOD_LINE_EDGE_NONE;
 }
 
 GPIOD_API enum gpiod_line_clock
@@ -116,7 +187,12 @@ gpiod_line_info_get_event_clock(struct gpiod_line_info *info)
 {
 	assert(info);
 
-	return info->event_clock;
+	if (info->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME)
+		return GPIOD_LINE_CLOCK_REALTIME;
+	if (info->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE)
+		return GPIOD_LINE_CLOCK_HTE;
+
+	return GPIOD_LINE_CLOCK_MONOTONIC;
 }
 
 GPIOD_API bool gpiod_line_info_is_debounced(struct gpiod_line_info *info)
@@ -134,78 +210,78 @@ gpiod_line_info_get_debounce_period_us(struct gpiod_line_info *info)
 	return info->debounce_period_us;
 }
 
+void gpiod_line_info_fill_compact(struct gpiod_line_info *info,
+				  struct gpio_v2_line_info *uapi_info,
+				  const char *name, const char *consumer)
+{
+	memset(info, 0, sizeof(*info));
+
+	info->offset = uapi_info->offset;
+	info->flags = uapi_info->flags;
+	info->name = name;
+	info->consumer = consumer;
+
+	/* The kernel info doesn't outlive the call. */
+	decode_attrs(info, uapi_info);
+}
+
+static const char *raw_string(char *str)
+{
+	/* Don't trust the kernel to terminate the strings. */
+	str[GPIO_MAX_NAME_SIZE - 1] = '\0';
+
+	return str[0] ? str : NULL;
+}
+
+/* The object must have been allocated with room for the raw info. */
+void gpiod_line_info_fill_from_uapi(struct gpiod_line_info *info,
+				    struct gpio_v2_line_info *uapi_info)
+{
+	struct gpio_v2_line_info *raw = (struct gpio_v2_line_info *)info->storage;
+
+	memcpy(raw, uapi_info, sizeof(*raw));
+
+	memset(info, 0, sizeof(*info));
+	info->offset = raw->offset;
+	info->flags = raw->flags;
+	info->name = raw_string(raw->name);
+	info->consumer = raw_string(raw->consumer);
+
+	decode_attrs(info, raw);
+}
+
 struct gpiod_line_info *
 gpiod_line_info_from_uapi(struct gpio_v2_line_info *uapi_info)
 {
-	struct gpio_v2_line_attribute *attr;
 	struct gpiod_line_info *info;
-	size_t i;
 
-	info = malloc(sizeof(*info));
+	info = gpiod_malloc(LINE_INFO_STANDALONE_SIZE);
 	if (!info)
 		return NULL;
 
-	memset(info, 0, sizeof(*info));
+	gpiod_line_info_fill_from_uapi(info, uapi_info);
 
-	info->offset = uapi_info->offset;
-	strncpy(info->name, uapi_info->name, GPIO_MAX_NAME_SIZE);
-
-	info->used = !!(uapi_info->flags & GPIO_V2_LINE_FLAG_USED);
-	strncpy(info->consumer, uapi_info->consumer, GPIO_MAX_NAME_SIZE);
-
-	if (uapi_info->flags & GPIO_V2_LINE_FLAG_OUTPUT)
-		info->direction = GPIOD_LINE_DIRECTION_OUTPUT;
-	else
-		info->direction = GPIOD_LINE_DIRECTION_INPUT;
-
-	if (uapi_info->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
-		info->active_low = true;
-
-	if (uapi_info->flags & GPIO_V2_LINE_FLAG_BIAS_PULL_UP)
-		info->bias = GPIOD_LINE_BIAS_PULL_UP;
-	else if (uapi_info->flags & GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN)
-		info->bias = GPIOD_LINE_BIAS_PULL_DOWN;
-	else if (uapi_info->flags & GPIO_V2_LINE_FLAG_BIAS_DISABLED)
-		info->bias = GPIOD_LINE_BIAS_DISABLED;
-	else
-		info->bias = GPIOD_LINE_BIAS_UNKNOWN;
-
-	if (uapi_info->flags & GPIO_V2_LINE_FLAG_OPEN_DRAIN)
-		info->drive = GPIOD_LINE_DRIVE_OPEN_DRAIN;
-	else if (uapi_info->flags & GPIO_V2_LINE_FLAG_OPEN_SOURCE)
-		info->drive = GPIOD_LINE_DRIVE_OPEN_SOURCE;
-	else
-		info->drive = GPIOD_LINE_DRIVE_PUSH_PULL;
-
-	if ((uapi_info->flags & GPIO_V2_LINE_FLAG_EDGE_RISING) &&
-	    (uapi_info->flags & GPIO_V2_LINE_FLAG_EDGE_FALLING))
-		info->edge = GPIOD_LINE_EDGE_BOTH;
-	else if (uapi_info->flags & GPIO_V2_LINE_FLAG_EDGE_RISING)
-		info->edge = GPIOD_LINE_EDGE_RISING;
-	else if (uapi_info->flags & GPIO_V2_LINE_FLAG_EDGE_FALLING)
-		info->edge = GPIOD_LINE_EDGE_FALLING;
-	else
-		info->edge = GPIOD_LINE_EDGE_NONE;
-
-	if (uapi_info->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME)
-		info->event_clock = GPIOD_LINE_CLOCK_REALTIME;
-	else if (uapi_info->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE)
-		info->event_clock = GPIOD_LINE_CLOCK_HTE;
-	else
-		info->event_clock = GPIOD_LINE_CLOCK_MONOTONIC;
+	return info;
+}
 
-	/*
-	 * We assume that the kernel returns correct configuration and that no
-	 * attributes repeat.
-	 */
-	for (i = 0; i < uapi_info->num_attrs; i++) {
-		attr = &uapi_info->attrs[i];
+/*
+ * Used by containers that preallocate line-info storage. The array must be
+ * freed with gpiod_free().
+ */
+struct gpiod_line_info *gpiod_line_info_array_new(size_t num)
+{
+	return gpiod_calloc(num, LINE_INFO_STANDALONE_SIZE);
+}
 
-		if (attr->id == GPIO_V2_LINE_ATTR_ID_DEBOUNCE) {
-			info->debounced = true;
-			info->debounce_period_us = attr->debounce_period_us;
-		}
-	}
+struct gpiod_line_info *
+gpiod_line_info_array_get(struct gpiod_line_info *array, size_t index)
+{
+	return (struct gpiod_line_info *)((char *)array +
+					  index * LINE_INFO_STANDALONE_SIZE);
+}
 
-	return info;
+/* Size of an info without the string storage, as packed in snapshots. */
+size_t gpiod_line_info_compact_size(void)
+{
+	return sizeof(struct gpiod_line_info);
 }
@@ -0,0 +1,691 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC		1000000000ULL
+/* The rate of the changes is evaluated over at least this many periods. */
+#define WINDOW_PERIODS		16
+/* Sampled lines changing less often than once per this many periods. */
+#define SAMPLED_IDLE_PERIODS	4
+
+struct monitored_line {
+	unsigned int offset;
+	enum gpiod_line_monitor_mode mode;
+	/* The chip can't detect the edges of the line. */
+	bool pinned;
+	bool active;
+	/* Changes seen in the current window. */
+	unsigned int num_changes;
+};
+
+struct gpiod_line_monitor {
+	struct gpiod_line_request *request;
+	struct gpiod_line_settings *settings;
+	struct gpiod_line_config *line_cfg;
+	struct gpiod_edge_event_buffer *buffer;
+	/* Indexed by the request bits of the lines. */
+	struct monitored_line lines[GPIO_V2_LINES_MAX];
+	size_t num_lines;
+	uint64_t sampled_mask;
+	uint64_t sample_period_ns;
+	uint64_t window_start_ns;
+	bool timer_armed;
+	unsigned int fd_generation;
+	int epfd;
+	int timerfd;
+	struct gpiod_line_monitor_change *ring;
+	size_t ring_size;
+	size_t head;
+	size_t num_changes;
+	uint64_t num_switches;
+	uint64_t num_overruns;
+};
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static int build_line_config(struct gpiod_line_monitor *monitor)
+{
+	enum gpiod_line_edge edge;
+	unsigned int offset;
+	size_t i;
+	int ret;
+
+	gpiod_line_config_reset(monitor->line_cfg);
+
+	for (i = 0; i < monitor->num_lines; i++) {
+		edge = monitor->lines[i].mode == GPIOD_LINE_MONITOR_MODE_EVENTS ?
+			GPIOD_LINE_EDGE_BOTH : GPIOD_LINE_EDGE_NONE;
+		offset = monitor->lines[i].offset;
+
+		gpiod_line_settings_set_edge_detection(monitor->settings, edge);
+		ret = gpiod_line_config_add_line_settings(monitor->line_cfg,
+							  &offset, 1,
+							  monitor->settings);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+static bool edges_unsupported(int err)
+{
+	return err == ENODEV || err == ENXIO || err == ENOTSUP;
+}
+
+static int set_mode(struct gpiod_line_monitor *monitor, size_t bit,
+		    enum gpiod_line_monitor_mode mode)
+{
+	monitor->lines[bit].mode = mode;
+	gpiod_line_mask_assign_bit(&monitor->sampled_mask, bit,
+				   mode == GPIOD_LINE_MONITOR_MODE_SAMPLING);
+
+	return build_line_config(monitor);
+}
+
+/*
+ * The chip refused edge detection for some of the lines. Start with all lines
+ * sampled and enable the edges of one line at a time, the lines for which
+ * this fails stay sampled for good.
+ */
+static int probe_edges(struct gpiod_line_monitor *monitor)
+{
+	size_t i;
+	int ret;
+
+	for (i = 0; i < monitor->num_lines; i++) {
+		ret = set_mode(monitor, i, GPIOD_LINE_MONITOR_MODE_EVENTS);
+		if (ret)
+			return -1;
+
+		ret = gpiod_line_request_reconfigure_lines(monitor->request,
+							   monitor->line_cfg);
+		if (ret == 0)
+			continue;
+
+		if (!edges_unsupported(errno))
+			return -1;
+
+		monitor->lines[i].pinned = true;
+		ret = set_mode(monitor, i, GPIOD_LINE_MONITOR_MODE_SAMPLING);
+		if (ret)
+			return -1;
+	}
+
+	/* Leave the request configured like the last successful attempt. */
+	return gpiod_line_request_reconfigure_lines(monitor->request,
+						    monitor->line_cfg);
+}
+
+static int request_lines(struct gpiod_line_monitor *monitor,
+			 struct gpiod_chip *chip,
+			 struct gpiod_request_config *req_cfg,
+			 const unsigned int *offsets, size_t num_offsets)
+{
+	unsigned int requested[GPIO_V2_LINES_MAX];
+	bool probe = false;
+	size_t i;
+	int ret;
+
+	ret = gpiod_line_config_add_line_settings(monitor->line_cfg, offsets,
+						  num_offsets,
+						  monitor->settings);
+	if (ret)
+		return -1;
+
+	monitor->request = gpiod_chip_request_lines(chip, req_cfg,
+						    monitor->line_cfg);
+	if (!monitor->request) {
+		if (!edges_unsupported(errno))
+			return -1;
+
+		gpiod_line_settings_set_edge_detection(monitor->settings,
+						       GPIOD_LINE_EDGE_NONE);
+		gpiod_line_config_reset(monitor->line_cfg);
+		ret = gpiod_line_config_add_line_settings(monitor->line_cfg,
+							  offsets, num_offsets,
+							  monitor->settings);
+		if (ret)
+			return -1;
+
+		monitor->request = gpiod_chip_request_lines(chip, req_cfg,
+							    monitor->line_cfg);
+		if (!monitor->request)
+			return -1;
+
+		probe = true;
+	}
+
+	monitor->num_lines = gpiod_line_request_get_requested_offsets(
+					monitor->request, requested,
+					GPIO_V2_LINES_MAX);
+
+	for (i = 0; i < monitor->num_lines; i++) {
+		ret = gpiod_line_request_get_offset_bit(monitor->request,
+							requested[i]);
+		if (ret < 0)
+			return -1;
+
+		monitor->lines[ret].offset = requested[i];
+		monitor->lines[ret].mode = GPIOD_LINE_MONITOR_MODE_EVENTS;
+	}
+
+	if (probe) {
+		for (i = 0; i < monitor->num_lines; i++) {
+			monitor->lines[i].mode =
+					GPIOD_LINE_MONITOR_MODE_SAMPLING;
+			gpiod_line_mask_set_bit(&monitor->sampled_mask, i);
+		}
+
+		return probe_edges(monitor);
+	}
+
+	return 0;
+}
+
+static uint64_t all_lines_mask(struct gpiod_line_monitor *monitor)
+{
+	if (monitor->num_lines == GPIO_V2_LINES_MAX)
+		return UINT64_MAX;
+
+	return (1ULL << monitor->num_lines) - 1;
+}
+
+static int read_levels(struct gpiod_line_monitor *monitor, uint64_t mask,
+		       uint64_t *values)
+{
+	if (!mask) {
+		*values = 0;
+		return 0;
+	}
+
+	return gpiod_line_request_get_values_mask(monitor->request, mask,
+						  values);
+}
+
+static int arm_timer(struct gpiod_line_monitor *monitor)
+{
+	struct itimerspec its;
+	bool arm = monitor->sampled_mask != 0;
+	int ret;
+
+	if (arm == monitor->timer_armed)
+		return 0;
+
+	memset(&its, 0, sizeof(its));
+
+	if (arm) {
+		its.it_interval.tv_sec = monitor->sample_period_ns /
+					 NSEC_PER_SEC;
+		its.it_interval.tv_nsec = monitor->sample_period_ns %
+					  NSEC_PER_SEC;
+		its.it_value = its.it_interval;
+	}
+
+	ret = timerfd_settime(monitor->timerfd, 0, &its, NULL);
+	if (ret)
+		return -1;
+
+	monitor->timer_armed = arm;
+
+	return 0;
+}
+
+static int watch_request(struct gpiod_line_monitor *monitor)
+{
+	struct epoll_event ev;
+
+	monitor->fd_generation =
+		gpiod_line_request_get_fd_generation(monitor->request);
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLPRI;
+
+	return epoll_ctl(monitor->epfd, EPOLL_CTL_ADD,
+			 gpiod_line_request_get_fd(monitor->request), &ev);
+}
+
+static int setup_fds(struct gpiod_line_monitor *monitor)
+{
+	struct epoll_event ev;
+	int ret;
+
+	monitor->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (monitor->epfd < 0)
+		return -1;
+
+	monitor->timerfd = timerfd_create(CLOCK_MONOTONIC,
+					  TFD_CLOEXEC | TFD_NONBLOCK);
+	if (monitor->timerfd < 0)
+		return -1;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+
+	ret = epoll_ctl(monitor->epfd, EPOLL_CTL_ADD, monitor->timerfd, &ev);
+	if (ret)
+		return -1;
+
+	return watch_request(monitor);
+}
+
+GPIOD_API struct gpiod_line_monitor *
+gpiod_chip_request_line_monitor(struct gpiod_chip *chip,
+				struct gpiod_request_config *req_cfg,
+				struct gpiod_line_settings *settings,
+				const unsigned int *offsets, size_t num_offsets,
+				uint64_t sample_period_ns, size_t ring_size)
+{
+	struct gpiod_line_monitor *monitor;
+	uint64_t values;
+	size_t i;
+	int errsv, ret;
+
+	assert(chip);
+
+	if (!offsets || !num_offsets || num_offsets > GPIO_V2_LINES_MAX ||
+	    !sample_period_ns || !ring_size) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	monitor = gpiod_malloc(sizeof(*monitor));
+	if (!monitor)
+		return NULL;
+
+	memset(monitor, 0, sizeof(*monitor));
+	monitor->sample_period_ns = sample_period_ns;
+	monitor->ring_size = ring_size;
+	monitor->epfd = -1;
+	monitor->timerfd = -1;
+
+	monitor->ring = gpiod_calloc(ring_size, sizeof(*monitor->ring));
+	if (!monitor->ring)
+		goto err_release;
+
+	monitor->settings = settings ? gpiod_line_settings_copy(settings) :
+				       gpiod_line_settings_new();
+	monitor->line_cfg = gpiod_line_config_new();
+	if (!monitor->settings || !monitor->line_cfg)
+		goto err_release;
+
+	/* Sampled changes are timestamped with the monotonic clock too. */
+	gpiod_line_settings_set_direction(monitor->settings,
+					  GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(monitor->settings,
+					       GPIOD_LINE_EDGE_BOTH);
+	gpiod_line_settings_set_event_clock(monitor->settings,
+					    GPIOD_LINE_CLOCK_MONOTONIC);
+
+	ret = request_lines(monitor, chip, req_cfg, offsets, num_offsets);
+	if (ret)
+		goto err_release;
+
+	monitor->buffer = gpiod_edge_event_buffer_new(
+		gpiod_line_request_get_event_buffer_size(monitor->request));
+	if (!monitor->buffer)
+		goto err_release;
+
+	ret = setup_fds(monitor);
+	if (ret)
+		goto err_release;
+
+	ret = read_levels(monitor, all_lines_mask(monitor), &values);
+	if (ret)
+		goto err_release;
+
+	for (i = 0; i < monitor->num_lines; i++)
+		monitor->lines[i].active = gpiod_line_mask_test_bit(&values, i);
+
+	ret = arm_timer(monitor);
+	if (ret)
+		goto err_release;
+
+	monitor->window_start_ns = monotonic_ns();
+
+	return monitor;
+
+err_release:
+	errsv = errno;
+	gpiod_line_monitor_release(monitor);
+	errno = errsv;
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_line_monitor_release(struct gpiod_line_monitor *monitor)
+{
+	if (!monitor)
+		return;
+
+	if (monitor->timerfd >= 0)
+		close(monitor->timerfd);
+	if (monitor->epfd >= 0)
+		close(monitor->epfd);
+	gpiod_line_request_release(monitor->request);
+	gpiod_edge_event_buffer_free(monitor->buffer);
+	gpiod_line_config_free(monitor->line_cfg);
+	gpiod_line_settings_free(monitor->settings);
+	gpiod_free(monitor->ring);
+	gpiod_free(monitor);
+}
+
+GPIOD_API int gpiod_line_monitor_get_fd(struct gpiod_line_monitor *monitor)
+{
+	assert(monitor);
+
+	return monitor->epfd;
+}
+
+GPIOD_API int gpiod_line_monitor_wait(struct gpiod_line_monitor *monitor,
+				      int64_t timeout_ns)
+{
+	assert(monitor);
+
+	return gpiod_poll_fd(monitor->epfd, timeout_ns);
+}
+
+static void push_change(struct gpiod_line_monitor *monitor, size_t bit,
+			bool active, uint64_t timestamp_ns)
+{
+	struct monitored_line *line = &monitor->lines[bit];
+	struct gpiod_line_monitor_change *change;
+	size_t pos;
+
+	line->active = active;
+	line->num_changes++;
+
+	/* Like the kernel event fifo, a full ring drops its oldest entry. */
+	if (monitor->num_changes == monitor->ring_size) {
+		monitor->head = (monitor->head + 1) % monitor->ring_size;
+		monitor->num_changes--;
+		monitor->num_overruns++;
+	}
+
+	pos = (monitor->head + monitor->num_changes) % monitor->ring_size;
+	change = &monitor->ring[pos];
+	memset(change, 0, sizeof(*change));
+	change->timestamp_ns = timestamp_ns;
+	change->offset = line->offset;
+	change->value = active ? GPIOD_LINE_VALUE_ACTIVE :
+				 GPIOD_LINE_VALUE_INACTIVE;
+	change->mode = line->mode;
+	monitor->num_changes++;
+}
+
+static int process_events(struct gpiod_line_monitor *monitor)
+{
+	const struct gpio_v2_line_event *events, *event;
+	size_t i, num_events;
+	bool active;
+	int ret, bit, num_pushed = 0;
+
+	ret = gpiod_line_request_wait_edge_events(monitor->request, 0);
+	if (ret <= 0)
+		return ret;
+
+	ret = gpiod_line_request_read_edge_events(monitor->request,
+			monitor->buffer,
+			gpiod_edge_event_buffer_get_capacity(monitor->buffer));
+	if (ret < 0)
+		return -1;
+
+	/* A grown kernel buffer comes with a new file description. */
+	if (gpiod_line_request_get_fd_generation(monitor->request) !=
+	    monitor->fd_generation) {
+		ret = watch_request(monitor);
+		if (ret)
+			return -1;
+	}
+
+	events = gpiod_edge_event_buffer_get_data(monitor->buffer);
+	num_events = gpiod_edge_event_buffer_get_num_events(monitor->buffer);
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		bit = gpiod_line_request_get_offset_bit(monitor->request,
+							event->offset);
+		/* Events queued before a line was switched are stale. */
+		if (bit < 0 || monitor->lines[bit].mode !=
+					GPIOD_LINE_MONITOR_MODE_EVENTS)
+			continue;
+
+		active = event->id == GPIO_V2_LINE_EVENT_RISING_EDGE;
+		if (active == monitor->lines[bit].active)
+			continue;
+
+		push_change(monitor, bit, active, event->timestamp_ns);
+		num_pushed++;
+	}
+
+	return num_pushed;
+}
+
+static int sample_lines(struct gpiod_line_monitor *monitor, uint64_t now_ns,
+			uint64_t mask)
+{
+	uint64_t values;
+	int ret, num_pushed = 0;
+	size_t i;
+	bool active;
+
+	ret = read_levels(monitor, mask, &values);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < monitor->num_lines; i++) {
+		if (!gpiod_line_mask_test_bit(&mask, i))
+			continue;
+
+		active = gpiod_line_mask_test_bit(&values, i);
+		if (active == monitor->lines[i].active)
+			continue;
+
+		push_change(monitor, i, active, now_ns);
+		num_pushed++;
+	}
+
+	return num_pushed;
+}
+
+static int process_timer(struct gpiod_line_monitor *monitor, uint64_t now_ns)
+{
+	uint64_t expirations;
+	ssize_t rd;
+
+	rd = read(monitor->timerfd, &expirations, sizeof(expirations));
+	if (rd < 0)
+		return errno == EAGAIN ? 0 : -1;
+
+	return sample_lines(monitor, now_ns, monitor->sampled_mask);
+}
+
+/*
+ * Decide which lines switch over at the end of every window. Lines watched
+ * with edge events only wake the monitor up when they change, so a window may
+ * have lasted much longer than planned and the changes are compared against
+ * the number of periods which actually elapsed.
+ */
+static int evaluate_window(struct gpiod_line_monitor *monitor, uint64_t now_ns,
+			   uint64_t num_periods)
+{
+	uint64_t to_events = 0;
+	struct monitored_line *line;
+	bool switched = false;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < monitor->num_lines; i++) {
+		line = &monitor->lines[i];
+
+		if (line->pinned) {
+			line->num_changes = 0;
+			continue;
+		}
+
+		if (line->mode == GPIOD_LINE_MONITOR_MODE_EVENTS &&
+		    line->num_changes > num_periods) {
+			line->mode = GPIOD_LINE_MONITOR_MODE_SAMPLING;
+			gpiod_line_mask_set_bit(&monitor->sampled_mask, i);
+			switched = true;
+		} else if (line->mode == GPIOD_LINE_MONITOR_MODE_SAMPLING &&
+			   line->num_changes * SAMPLED_IDLE_PERIODS <
+								num_periods) {
+			line->mode = GPIOD_LINE_MONITOR_MODE_EVENTS;
+			gpiod_line_mask_assign_bit(&monitor->sampled_mask, i,
+						   false);
+			gpiod_line_mask_set_bit(&to_events, i);
+			switched = true;
+		}
+
+		line->num_changes = 0;
+	}
+
+	monitor->window_start_ns = now_ns;
+
+	if (!switched)
+		return 0;
+
+	ret = build_line_config(monitor);
+	if (ret)
+		return -1;
+
+	ret = gpiod_line_request_reconfigure_lines(monitor->request,
+						   monitor->line_cfg);
+	if (ret)
+		return -1;
+
+	monitor->num_switches++;
+
+	ret = arm_timer(monitor);
+	if (ret)
+		return -1;
+
+	/* Catch the changes made while the edge detection was off. */
+	ret = sample_lines(monitor, monotonic_ns(), to_events);
+	if (ret < 0)
+		return -1;
+
+	/* The catch-up reads don't count towards the next window. */
+	for (i = 0; i < monitor->num_lines; i++) {
+		if (gpiod_line_mask_test_bit(&to_events, i))
+			monitor->lines[i].num_changes = 0;
+	}
+
+	return ret;
+}
+
+GPIOD_API int gpiod_line_monitor_process(struct gpiod_line_monitor *monitor)
+{
+	uint64_t now_ns, num_periods;
+	int ret, num_pushed;
+
+	assert(monitor);
+
+	num_pushed = process_events(monitor);
+	if (num_pushed < 0)
+		return -1;
+
+	now_ns = monotonic_ns();
+
+	ret = process_timer(monitor, now_ns);
+	if (ret < 0)
+		return -1;
+
+	num_pushed += ret;
+
+	num_periods = (now_ns - monitor->window_start_ns) /
+		      monitor->sample_period_ns;
+	if (num_periods >= WINDOW_PERIODS) {
+		ret = evaluate_window(monitor, now_ns, num_periods);
+		if (ret < 0)
+			return -1;
+
+		num_pushed += ret;
+	}
+
+	return num_pushed;
+}
+
+GPIOD_API size_t
+gpiod_line_monitor_get_num_changes(struct gpiod_line_monitor *monitor)
+{
+	assert(monitor);
+
+	return monitor->num_changes;
+}
+
+GPIOD_API size_t
+gpiod_line_monitor_read_changes(struct gpiod_line_monitor *monitor,
+				struct gpiod_line_monitor_change *changes,
+				size_t max_changes)
+{
+	size_t i;
+
+	assert(monitor);
+
+	if (max_changes > monitor->num_changes)
+		max_changes = monitor->num_changes;
+
+	for (i = 0; i < max_changes; i++) {
+		changes[i] = monitor->ring[monitor->head];
+		monitor->head = (monitor->head + 1) % monitor->ring_size;
+	}
+
+	monitor->num_changes -= max_changes;
+
+	return max_changes;
+}
+
+GPIOD_API int gpiod_line_monitor_get_mode(struct gpiod_line_monitor *monitor,
+					  unsigned int offset)
+{
+	int bit;
+
+	assert(monitor);
+
+	bit = gpiod_line_request_get_offset_bit(monitor->request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return monitor->lines[bit].mode;
+}
+
+GPIOD_API uint64_t
+gpiod_line_monitor_get_num_switches(struct gpiod_line_monitor *monitor)
+{
+	assert(monitor);
+
+	return monitor->num_switches;
+}
+
+GPIOD_API uint64_t
+gpiod_line_monitor_get_num_overruns(struct gpiod_line_monitor *monitor)
+{
+	assert(monitor);
+
+	return monitor->num_overruns;
+}
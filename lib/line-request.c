@@ -3,46 +3,453 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <gpiod.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/ioctl.h>
 #include <sys/param.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "internal.h"
 
+/*
+ * Open-addressed hash table mapping line offsets to their bit positions in the
+ * request. Twice the max number of lines keeps the probe sequences short.
+ */
+#define OFFSET_MAP_BITS		7
+#define OFFSET_MAP_SIZE		(1U << OFFSET_MAP_BITS)
+
+/* Edge events discarded with each read while waiting for values. */
+#define WAIT_FOR_VALUES_READ_BATCH	16
+
+/* As defined in the kernel. */
+#define EVENT_FIFO_DEFAULT_SIZE(num_lines)	((num_lines) * 16)
+#define EVENT_FIFO_MAX_SIZE			(GPIO_V2_LINES_MAX * 16)
+
 struct gpiod_line_request {
-	unsigned int offsets[GPIO_V2_LINES_MAX];
+	/* Points into the per-line storage allocated along with the request. */
+	unsigned int *offsets;
 	size_t num_lines;
 	int fd;
+	/* Bit index + 1 of the line whose offset hashed here, 0 if empty. */
+	unsigned char offset_map[OFFSET_MAP_SIZE];
+	/* Config currently applied to the lines, without global output values. */
+	struct gpiod_line_config *config;
+	bool output_shadow;
+	/* Lines whose current value is tracked in shadow_values. */
+	uint64_t shadow_mask;
+	uint64_t shadow_values;
+	/*
+	 * Inputs whose value is tracked in shadow_values from edge events and
+	 * those of them that must be read back after losing events.
+	 */
+	bool input_shadow;
+	uint64_t input_shadow_mask;
+	uint64_t input_stale_mask;
+	/*
+	 * Sequence numbers of the last events read. The kernel numbers events
+	 * starting at 1 so a gap means it had to drop events.
+	 */
+	uint32_t last_seqno;
+	uint32_t *last_line_seqno;
+	unsigned long num_dropped;
+	unsigned long *line_num_dropped;
+	/* Size of the kernel event fifo as adjusted by the kernel. */
+	size_t event_buffer_size;
+	/*
+	 * Adaptive event buffer sizing - the lines are requested anew from
+	 * the chip with a larger fifo. Disabled if chip_fd is -1.
+	 */
+	int chip_fd;
+	char consumer[GPIO_MAX_NAME_SIZE];
+	size_t max_event_buffer_size;
+	bool grow_pending;
+	unsigned int fd_generation;
+	/* Reads return no events instead of blocking. */
+	bool nonblocking;
+	/* The fd is in non-blocking mode - for draining or by request. */
+	bool fd_nonblocking;
+	/* Busy-poll budget of the wait and the time spent in each phase. */
+	uint64_t busy_poll_ns;
+	uint64_t spin_ns;
+	uint64_t sleep_ns;
+	/*
+	 * Software debounce - timestamp of the last edge seen on each line
+	 * and the line state resulting from the edges kept so far.
+	 */
+	uint64_t soft_debounce_mask;
+	uint64_t soft_debounce_seen;
+	uint64_t *soft_debounce_ns;
+	uint64_t *soft_debounce_ts;
+	uint32_t *soft_debounce_state;
+	/* Lines whose rising or falling edge events are discarded. */
+	uint64_t drop_rising_mask;
+	uint64_t drop_falling_mask;
+	/*
+	 * Rate limiting - the start of the current window of each line and
+	 * the number of events let through within it.
+	 */
+	uint64_t rate_limit_mask;
+	uint64_t rate_limit_keep_last_mask;
+	uint64_t rate_limit_seen;
+	uint64_t *rate_limit_ns;
+	uint64_t *rate_limit_start;
+	unsigned long *num_rate_limited;
+	uint32_t *rate_limit_max;
+	uint32_t *rate_limit_count;
+	struct gpiod_stats *stats;
+	/*
+	 * Edge event latency per line, NULL if disabled. Lines timestamped
+	 * by HTE aren't recorded - there's no clock to compare against.
+	 */
+	struct gpiod_latency_histogram *latency;
+	/* Edge counts, rates and intervals per line, NULL if disabled. */
+	struct gpiod_edge_stats *edge_stats;
+	uint64_t realtime_mask;
+	uint64_t hte_mask;
+	/*
+	 * Per-line state sized to the number of requested lines - the 64-bit
+	 * arrays come first so that every array is naturally aligned.
+	 */
+	uint64_t lines[];
 };
 
+/* Bytes of per-line storage needed by a request for this many lines. */
+static size_t per_line_size(size_t num_lines)
+{
+	return num_lines * (4 * sizeof(uint64_t) + 2 * sizeof(unsigned long) +
+			    4 * sizeof(uint32_t) + sizeof(unsigned int));
+}
+
+static void set_per_line_storage(struct gpiod_line_request *request)
+{
+	size_t num_lines = request->num_lines;
+
+	request->soft_debounce_ns = request->lines;
+	request->soft_debounce_ts = request->soft_debounce_ns + num_lines;
+	request->rate_limit_ns = request->soft_debounce_ts + num_lines;
+	request->rate_limit_start = request->rate_limit_ns + num_lines;
+	request->line_num_dropped =
+		(unsigned long *)(request->rate_limit_start + num_lines);
+	request->num_rate_limited = request->line_num_dropped + num_lines;
+	request->last_line_seqno =
+		(uint32_t *)(request->num_rate_limited + num_lines);
+	request->soft_debounce_state = request->last_line_seqno + num_lines;
+	request->rate_limit_max = request->soft_debounce_state + num_lines;
+	request->rate_limit_count = request->rate_limit_max + num_lines;
+	request->offsets =
+		(unsigned int *)(request->rate_limit_count + num_lines);
+}
+
+static unsigned int offset_hash(unsigned int offset)
+{
+	/* Knuth's multiplicative hash - use the top bits of the product. */
+	return ((uint32_t)(offset * 2654435761U)) >> (32 - OFFSET_MAP_BITS);
+}
+
+static void build_offset_map(struct gpiod_line_request *request)
+{
+	unsigned int slot;
+	size_t i;
+
+	memset(request->offset_map, 0, sizeof(request->offset_map));
+
+	for (i = 0; i < request->num_lines; i++) {
+		slot = offset_hash(request->offsets[i]);
+
+		while (request->offset_map[slot])
+			slot = (slot + 1) & (OFFSET_MAP_SIZE - 1);
+
+		request->offset_map[slot] = i + 1;
+	}
+}
+
+static int offset_to_bit(struct gpiod_line_request *request,
+			 unsigned int offset)
+{
+	unsigned int slot, bit;
+
+	slot = offset_hash(offset);
+
+	while (request->offset_map[slot]) {
+		bit = request->offset_map[slot] - 1;
+		if (request->offsets[bit] == offset)
+			return bit;
+
+		slot = (slot + 1) & (OFFSET_MAP_SIZE - 1);
+	}
+
+	return -1;
+}
+
+static uint64_t line_flags(const struct gpio_v2_line_config *cfg,
+			   unsigned int bit)
+{
+	const struct gpio_v2_line_config_attribute *attr;
+	size_t i;
+
+	for (i = 0; i < cfg->num_attrs; i++) {
+		attr = &cfg->attrs[i];
+
+		if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_FLAGS &&
+		    (attr->mask & (1ULL << bit)))
+			return attr->attr.flags;
+	}
+
+	return cfg->flags;
+}
+
+static bool line_output_value(const struct gpio_v2_line_config *cfg,
+			      unsigned int bit)
+{
+	const struct gpio_v2_line_config_attribute *attr;
+	size_t i;
+
+	for (i = 0; i < cfg->num_attrs; i++) {
+		attr = &cfg->attrs[i];
+
+		if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES &&
+		    (attr->mask & (1ULL << bit)))
+			return attr->attr.values & (1ULL << bit);
+	}
+
+	/* The kernel drives outputs low unless told otherwise. */
+	return false;
+}
+
+/*
+ * Resolve the configuration the kernel applied to each line the same way the
+ * kernel does and start tracking the values of push-pull outputs. Inputs and
+ * open-drain/open-source outputs can be driven by someone else so they are
+ * always read back from the hardware.
+ */
+static void reset_output_shadow(struct gpiod_line_request *request,
+				const struct gpio_v2_line_config *cfg)
+{
+	uint64_t flags;
+	size_t i;
+
+	request->shadow_mask = 0;
+	request->shadow_values = 0;
+
+	if (!request->output_shadow)
+		return;
+
+	for (i = 0; i < request->num_lines; i++) {
+		flags = line_flags(cfg, i);
+
+		if (!(flags & GPIO_V2_LINE_FLAG_OUTPUT) ||
+		    (flags & (GPIO_V2_LINE_FLAG_OPEN_DRAIN |
+			      GPIO_V2_LINE_FLAG_OPEN_SOURCE)))
+			continue;
+
+		gpiod_line_mask_set_bit(&request->shadow_mask, i);
+		gpiod_line_mask_assign_bit(&request->shadow_values, i,
+					   line_output_value(cfg, i));
+	}
+}
+
+/*
+ * Inputs with both edges detected can be tracked from their edge events. All
+ * of them start out stale and are read back on the next read of their values.
+ */
+static void reset_input_shadow(struct gpiod_line_request *request,
+			       const struct gpio_v2_line_config *cfg)
+{
+	uint64_t flags;
+	size_t i;
+
+	request->input_shadow_mask = 0;
+
+	if (!request->input_shadow)
+		return;
+
+	for (i = 0; i < request->num_lines; i++) {
+		flags = line_flags(cfg, i);
+
+		if ((flags & GPIO_V2_LINE_FLAG_INPUT) &&
+		    (flags & GPIO_V2_LINE_FLAG_EDGE_RISING) &&
+		    (flags & GPIO_V2_LINE_FLAG_EDGE_FALLING))
+			gpiod_line_mask_set_bit(&request->input_shadow_mask, i);
+	}
+
+	request->input_stale_mask = request->input_shadow_mask;
+}
+
+static void reset_event_clocks(struct gpiod_line_request *request,
+			       const struct gpio_v2_line_config *cfg)
+{
+	uint64_t flags;
+	size_t i;
+
+	request->realtime_mask = 0;
+	request->hte_mask = 0;
+
+	for (i = 0; i < request->num_lines; i++) {
+		flags = line_flags(cfg, i);
+
+		if (flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME)
+			gpiod_line_mask_set_bit(&request->realtime_mask, i);
+		else if (flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE)
+			gpiod_line_mask_set_bit(&request->hte_mask, i);
+	}
+}
+
 struct gpiod_line_request *
-gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req)
+gpiod_line_request_from_uapi(struct gpio_v2_line_request *uapi_req,
+			     struct gpiod_line_config *line_cfg,
+			     bool output_shadow)
 {
 	struct gpiod_line_request *request;
+	size_t size;
+
+	size = sizeof(*request) + per_line_size(uapi_req->num_lines);
 
-	request = malloc(sizeof(*request));
+	request = gpiod_malloc(size);
 	if (!request)
 		return NULL;
 
-	memset(request, 0, sizeof(*request));
+	memset(request, 0, size);
+
+	request->config = gpiod_line_config_copy(line_cfg);
+	if (!request->config) {
+		gpiod_free(request);
+		return NULL;
+	}
+
+	request->stats = gpiod_stats_new();
+	if (!request->stats) {
+		gpiod_line_config_free(request->config);
+		gpiod_free(request);
+		return NULL;
+	}
+
 	request->fd = uapi_req->fd;
 	request->num_lines = uapi_req->num_lines;
+	set_per_line_storage(request);
 	memcpy(request->offsets, uapi_req->offsets,
 	       sizeof(*request->offsets) * request->num_lines);
+	build_offset_map(request);
+	request->output_shadow = output_shadow;
+	reset_output_shadow(request, &uapi_req->config);
+	reset_event_clocks(request, &uapi_req->config);
+	request->chip_fd = -1;
+	memcpy(request->consumer, uapi_req->consumer, GPIO_MAX_NAME_SIZE - 1);
+
+	if (!uapi_req->event_buffer_size)
+		request->event_buffer_size =
+				EVENT_FIFO_DEFAULT_SIZE(request->num_lines);
+	else
+		request->event_buffer_size = MIN(uapi_req->event_buffer_size,
+						 EVENT_FIFO_MAX_SIZE);
 
 	return request;
 }
 
+int gpiod_line_request_enable_adaptive_buffer(
+		struct gpiod_line_request *request, int chip_fd,
+		const char *consumer, size_t max_size)
+{
+#ifdef GPIOD_WITH_MOCK
+	/* Resizing swaps the file descriptors behind the backend's back. */
+	if (gpiod_mock_owns_fd(chip_fd)) {
+		errno = ENOTSUP;
+		return -1;
+	}
+#endif
+
+	/* Keep the chip open for as long as the request may be resized. */
+	request->chip_fd = fcntl(chip_fd, F_DUPFD_CLOEXEC, 0);
+	if (request->chip_fd < 0)
+		return -1;
+
+	strncpy(request->consumer, consumer, GPIO_MAX_NAME_SIZE - 1);
+	request->max_event_buffer_size = MIN(max_size, EVENT_FIFO_MAX_SIZE);
+
+	return 0;
+}
+
+int gpiod_line_request_enable_input_shadow(struct gpiod_line_request *request)
+{
+	struct gpio_v2_line_request uapi_cfg;
+	uint64_t values;
+	int ret;
+
+	memset(&uapi_cfg, 0, sizeof(uapi_cfg));
+
+	ret = gpiod_line_config_to_uapi(request->config, &uapi_cfg);
+	if (ret)
+		return -1;
+
+	request->input_shadow = true;
+	reset_input_shadow(request, &uapi_cfg.config);
+
+	if (!request->input_shadow_mask)
+		return 0;
+
+	/* Seed the shadow before any events are read. */
+	return gpiod_line_request_get_values_mask(request,
+						  request->input_shadow_mask,
+						  &values);
+}
+
+int gpiod_line_request_enable_latency_histogram(
+		struct gpiod_line_request *request)
+{
+	request->latency = gpiod_latency_histogram_array_new(request->num_lines);
+
+	return request->latency ? 0 : -1;
+}
+
+int gpiod_line_request_enable_edge_stats(struct gpiod_line_request *request)
+{
+	request->edge_stats = gpiod_edge_stats_array_new(request->num_lines);
+
+	return request->edge_stats ? 0 : -1;
+}
+
+unsigned int
+gpiod_line_request_get_fd_generation(struct gpiod_line_request *request)
+{
+	return request->fd_generation;
+}
+
+struct gpiod_line_config *
+gpiod_line_request_get_line_config(struct gpiod_line_request *request)
+{
+	return request->config;
+}
+
+void gpiod_line_request_get_request_config(struct gpiod_line_request *request,
+					   struct gpiod_request_config *req_cfg)
+{
+	gpiod_request_config_set_consumer(req_cfg, request->consumer);
+	gpiod_request_config_set_event_buffer_size(req_cfg,
+						   request->event_buffer_size);
+	gpiod_request_config_set_max_event_buffer_size(req_cfg,
+			request->chip_fd >= 0 ? request->max_event_buffer_size : 0);
+	gpiod_request_config_set_output_shadow(req_cfg, request->output_shadow);
+	gpiod_request_config_set_input_shadow(req_cfg, request->input_shadow);
+	gpiod_request_config_set_nonblocking(req_cfg, request->nonblocking);
+	gpiod_request_config_set_latency_histogram(req_cfg, !!request->latency);
+	gpiod_request_config_set_edge_stats(req_cfg, !!request->edge_stats);
+}
+
 GPIOD_API void gpiod_line_request_release(struct gpiod_line_request *request)
 {
 	if (!request)
 		return;
 
-	close(request->fd);
-	free(request);
+	gpiod_sys_close(request->fd);
+	if (request->chip_fd >= 0)
+		close(request->chip_fd);
+	gpiod_line_config_free(request->config);
+	gpiod_stats_free(request->stats);
+	gpiod_free(request->latency);
+	gpiod_free(request->edge_stats);
+	gpiod_free(request);
 }
 
 GPIOD_API size_t
@@ -72,6 +479,52 @@ gpiod_line_request_get_requested_offsets(struct gpiod_line_request *request,
 	return num_offsets;
 }
 
+GPIOD_API int
+gpiod_line_request_get_offset_bit(struct gpiod_line_request *request,
+				  unsigned int offset)
+{
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0)
+		errno = EINVAL;
+
+	return bit;
+}
+
+GPIOD_API int
+gpiod_line_request_offsets_to_mask(struct gpiod_line_request *request,
+				   size_t num_offsets,
+				   const unsigned int *offsets, uint64_t *mask)
+{
+	uint64_t tmp = 0;
+	size_t i;
+	int bit;
+
+	assert(request);
+
+	if (!offsets || !mask) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < num_offsets; i++) {
+		bit = offset_to_bit(request, offsets[i]);
+		if (bit < 0) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		gpiod_line_mask_set_bit(&tmp, bit);
+	}
+
+	*mask = tmp;
+
+	return 0;
+}
+
 GPIOD_API enum gpiod_line_value
 gpiod_line_request_get_value(struct gpiod_line_request *request,
 			     unsigned int offset)
@@ -88,19 +541,62 @@ gpiod_line_request_get_value(struct gpiod_line_request *request,
 	return val;
 }
 
-static int offset_to_bit(struct gpiod_line_request *request,
-			 unsigned int offset)
+static bool mask_valid(struct gpiod_line_request *request, uint64_t mask)
 {
-	size_t i;
+	if (request->num_lines == GPIO_V2_LINES_MAX)
+		return true;
+
+	return !(mask & ~((1ULL << request->num_lines) - 1));
+}
+
+GPIOD_API int
+gpiod_line_request_get_values_mask(struct gpiod_line_request *request,
+				   uint64_t mask, uint64_t *values)
+{
+	struct gpio_v2_line_values uapi_values;
+	uint64_t cached, resynced, stale;
+	int ret;
 
 	assert(request);
 
-	for (i = 0; i < request->num_lines; i++) {
-		if (offset == request->offsets[i])
-			return i;
+	if (!values || !mask_valid(request, mask)) {
+		errno = EINVAL;
+		return -1;
 	}
 
-	return -1;
+	stale = gpiod_line_mask_load(&request->input_stale_mask);
+	cached = request->shadow_mask | (request->input_shadow_mask & ~stale);
+
+	/* Only ask the kernel about the lines the shadows don't cover. */
+	uapi_values.mask = mask & ~cached;
+	uapi_values.bits = 0;
+
+	if (uapi_values.mask) {
+		ret = gpiod_stats_ioctl(request->stats, GPIOD_STATS_IOCTL_GET,
+					request->fd,
+					GPIO_V2_LINE_GET_VALUES_IOCTL,
+					&uapi_values);
+		if (ret)
+			return -1;
+	}
+
+	/* Stale inputs that were read back are tracked again from here. */
+	resynced = uapi_values.mask & stale;
+	if (resynced) {
+		gpiod_line_mask_update(&request->shadow_values, resynced,
+				       uapi_values.bits);
+		gpiod_line_mask_update(&request->input_stale_mask, resynced, 0);
+	}
+
+	*values = ((uapi_values.bits & uapi_values.mask) |
+		   (gpiod_line_mask_load(&request->shadow_values) & cached)) &
+		  mask;
+
+	gpiod_trace(get_values, request->fd, mask, *values, uapi_values.mask,
+		    uapi_values.mask ?
+			gpiod_stats_get_last_ioctl_time_ns(request->stats) : 0);
+
+	return 0;
 }
 
 GPIOD_API int
@@ -109,7 +605,6 @@ gpiod_line_request_get_values_subset(struct gpiod_line_request *request,
 				     const unsigned int *offsets,
 				     enum gpiod_line_value *values)
 {
-	struct gpio_v2_line_values uapi_values;
 	uint64_t mask = 0, bits = 0;
 	size_t i;
 	int bit, ret;
@@ -121,8 +616,6 @@ gpiod_line_request_get_values_subset(struct gpiod_line_request *request,
 		return -1;
 	}
 
-	uapi_values.bits = 0;
-
 	for (i = 0; i < num_values; i++) {
 		bit = offset_to_bit(request, offsets[i]);
 		if (bit < 0) {
@@ -133,18 +626,15 @@ gpiod_line_request_get_values_subset(struct gpiod_line_request *request,
 		gpiod_line_mask_set_bit(&mask, bit);
 	}
 
-	uapi_values.mask = mask;
-
-	ret = ioctl(request->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &uapi_values);
+	ret = gpiod_line_request_get_values_mask(request, mask, &bits);
 	if (ret)
 		return -1;
 
-	bits = uapi_values.bits;
-	memset(values, 0, sizeof(*values) * num_values);
-
 	for (i = 0; i < num_values; i++) {
 		bit = offset_to_bit(request, offsets[i]);
-		values[i] = gpiod_line_mask_test_bit(&bits, bit) ? 1 : 0;
+		values[i] = gpiod_line_mask_test_bit(&bits, bit) ?
+				GPIOD_LINE_VALUE_ACTIVE :
+				GPIOD_LINE_VALUE_INACTIVE;
 	}
 
 	return 0;
@@ -167,13 +657,81 @@ GPIOD_API int gpiod_line_request_set_value(struct gpiod_line_request *request,
 						    &offset, &value);
 }
 
+GPIOD_API int
+gpiod_line_request_set_values_mask(struct gpiod_line_request *request,
+				   uint64_t mask, uint64_t values)
+{
+	struct gpio_v2_line_values uapi_values;
+	int ret;
+
+	assert(request);
+
+	if (!mask_valid(request, mask)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/*
+	 * Skip the lines already known to be at the requested value. Lines
+	 * not covered by the shadow are always passed on so that the kernel
+	 * can reject writes to inputs.
+	 */
+	mask &= ~request->shadow_mask |
+		(values ^ gpiod_line_mask_load(&request->shadow_values));
+	if (!mask) {
+		gpiod_trace(set_values, request->fd, mask, 0, 0);
+		return 0;
+	}
+
+	memset(&uapi_values, 0, sizeof(uapi_values));
+	uapi_values.mask = mask;
+	uapi_values.bits = values & mask;
+
+	ret = gpiod_stats_ioctl(request->stats, GPIOD_STATS_IOCTL_SET,
+				request->fd, GPIO_V2_LINE_SET_VALUES_IOCTL,
+				&uapi_values);
+	gpiod_trace(set_values, request->fd, mask, uapi_values.bits,
+		    gpiod_stats_get_last_ioctl_time_ns(request->stats));
+	if (ret)
+		return ret;
+
+	gpiod_line_mask_update(&request->shadow_values,
+			       mask & request->shadow_mask, values);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_line_request_set_bits(struct gpiod_line_request *request,
+					  uint64_t mask)
+{
+	return gpiod_line_request_set_values_mask(request, mask, mask);
+}
+
+GPIOD_API int gpiod_line_request_clear_bits(struct gpiod_line_request *request,
+					    uint64_t mask)
+{
+	return gpiod_line_request_set_values_mask(request, mask, 0);
+}
+
+GPIOD_API int gpiod_line_request_toggle_bits(struct gpiod_line_request *request,
+					     uint64_t mask)
+{
+	uint64_t values;
+	int ret;
+
+	ret = gpiod_line_request_get_values_mask(request, mask, &values);
+	if (ret)
+		return -1;
+
+	return gpiod_line_request_set_values_mask(request, mask, ~values);
+}
+
 GPIOD_API int
 gpiod_line_request_set_values_subset(struct gpiod_line_request *request,
 				     size_t num_values,
 				     const unsigned int *offsets,
 				     const enum gpiod_line_value *values)
 {
-	struct gpio_v2_line_values uapi_values;
 	uint64_t mask = 0, bits = 0;
 	size_t i;
 	int bit;
@@ -196,11 +754,7 @@ gpiod_line_request_set_values_subset(struct gpiod_line_request *request,
 		gpiod_line_mask_assign_bit(&bits, bit, values[i]);
 	}
 
-	memset(&uapi_values, 0, sizeof(uapi_values));
-	uapi_values.mask = mask;
-	uapi_values.bits = bits;
-
-	return ioctl(request->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &uapi_values);
+	return gpiod_line_request_set_values_mask(request, mask, bits);
 }
 
 GPIOD_API int gpiod_line_request_set_values(struct gpiod_line_request *request,
@@ -212,27 +766,171 @@ GPIOD_API int gpiod_line_request_set_values(struct gpiod_line_request *request,
 						    request->offsets, values);
 }
 
-static bool offsets_equal(struct gpiod_line_request *request,
-			  struct gpio_v2_line_request *uapi_cfg)
+struct gpiod_line_subset {
+	struct gpiod_line_request *request;
+	uint64_t mask;
+	size_t num_lines;
+	unsigned char bits[GPIO_V2_LINES_MAX];
+};
+
+GPIOD_API struct gpiod_line_subset *
+gpiod_line_request_prepare_subset(struct gpiod_line_request *request,
+				  size_t num_offsets,
+				  const unsigned int *offsets)
 {
+	struct gpiod_line_subset *subset;
 	size_t i;
+	int bit;
 
-	if (request->num_lines != uapi_cfg->num_lines)
-		return false;
+	assert(request);
 
-	for (i = 0; i < request->num_lines; i++) {
-		if (request->offsets[i] != uapi_cfg->offsets[i])
-			return false;
+	if (!offsets || !num_offsets) {
+		errno = EINVAL;
+		return NULL;
 	}
 
-	return true;
-}
-
+	if (num_offsets > GPIO_V2_LINES_MAX) {
+		errno = E2BIG;
+		return NULL;
+	}
+
+	subset = gpiod_malloc(sizeof(*subset));
+	if (!subset)
+		return NULL;
+
+	memset(subset, 0, sizeof(*subset));
+	subset->request = request;
+	subset->num_lines = num_offsets;
+
+	for (i = 0; i < num_offsets; i++) {
+		bit = offset_to_bit(request, offsets[i]);
+		if (bit < 0) {
+			gpiod_free(subset);
+			errno = EINVAL;
+			return NULL;
+		}
+
+		subset->bits[i] = bit;
+		gpiod_line_mask_set_bit(&subset->mask, bit);
+	}
+
+	return subset;
+}
+
+GPIOD_API void gpiod_line_subset_free(struct gpiod_line_subset *subset)
+{
+	gpiod_free(subset);
+}
+
+GPIOD_API size_t
+gpiod_line_subset_get_num_lines(struct gpiod_line_subset *subset)
+{
+	assert(subset);
+
+	return subset->num_lines;
+}
+
+GPIOD_API uint64_t gpiod_line_subset_get_mask(struct gpiod_line_subset *subset)
+{
+	assert(subset);
+
+	return subset->mask;
+}
+
+GPIOD_API int gpiod_line_subset_get_values(struct gpiod_line_subset *subset,
+					   enum gpiod_line_value *values)
+{
+	uint64_t bits;
+	size_t i;
+	int ret;
+
+	assert(subset);
+
+	if (!values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = gpiod_line_request_get_values_mask(subset->request,
+						 subset->mask, &bits);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < subset->num_lines; i++)
+		values[i] = (bits >> subset->bits[i]) & 1;
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_line_subset_set_values(struct gpiod_line_subset *subset,
+			     const enum gpiod_line_value *values)
+{
+	uint64_t bits = 0;
+	size_t i;
+
+	assert(subset);
+
+	if (!values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < subset->num_lines; i++)
+		gpiod_line_mask_assign_bit(&bits, subset->bits[i], values[i]);
+
+	return gpiod_line_request_set_values_mask(subset->request,
+						  subset->mask, bits);
+}
+
+static bool offsets_equal(struct gpiod_line_request *request,
+			  struct gpio_v2_line_request *uapi_cfg)
+{
+	size_t i;
+
+	if (request->num_lines != uapi_cfg->num_lines)
+		return false;
+
+	for (i = 0; i < request->num_lines; i++) {
+		if (request->offsets[i] != uapi_cfg->offsets[i])
+			return false;
+	}
+
+	return true;
+}
+
+static int apply_config(struct gpiod_line_request *request,
+			struct gpiod_line_config *config,
+			struct gpio_v2_line_request *uapi_cfg)
+{
+	int ret;
+
+	ret = gpiod_stats_ioctl(request->stats, GPIOD_STATS_IOCTL_CONFIG,
+				request->fd, GPIO_V2_LINE_SET_CONFIG_IOCTL,
+				&uapi_cfg->config);
+	gpiod_trace(reconfigure, request->fd, uapi_cfg->num_lines,
+		    uapi_cfg->offsets, ret,
+		    gpiod_stats_get_last_ioctl_time_ns(request->stats));
+	if (ret) {
+		gpiod_line_config_free(config);
+		return ret;
+	}
+
+	gpiod_line_config_free(request->config);
+	request->config = config;
+	reset_output_shadow(request, &uapi_cfg->config);
+	reset_input_shadow(request, &uapi_cfg->config);
+	reset_event_clocks(request, &uapi_cfg->config);
+
+	return 0;
+}
+
 GPIOD_API int
 gpiod_line_request_reconfigure_lines(struct gpiod_line_request *request,
 				     struct gpiod_line_config *config)
 {
 	struct gpio_v2_line_request uapi_cfg;
+	struct gpiod_line_config *applied;
 	int ret;
 
 	assert(request);
@@ -253,14 +951,122 @@ gpiod_line_request_reconfigure_lines(struct gpiod_line_request *request,
 		return -1;
 	}
 
-	ret = ioctl(request->fd, GPIO_V2_LINE_SET_CONFIG_IOCTL,
-		    &uapi_cfg.config);
+	applied = gpiod_line_config_copy(config);
+	if (!applied)
+		return -1;
+
+	return apply_config(request, applied, &uapi_cfg);
+}
+
+/*
+ * The kernel reconfigures every requested line on SET_CONFIG and drives
+ * outputs missing from the output values attribute low. Carry the current
+ * values of the outputs that aren't being changed over into the new config
+ * so that they keep their state.
+ */
+static int keep_output_values(struct gpiod_line_request *request,
+			      struct gpiod_line_config *config,
+			      uint64_t changed)
+{
+	struct gpio_v2_line_request uapi_cfg;
+	uint64_t keep = 0, values;
+	enum gpiod_line_value value;
+	size_t i;
+	int ret;
+
+	ret = gpiod_line_config_to_uapi(request->config, &uapi_cfg);
 	if (ret)
-		return ret;
+		return -1;
+
+	for (i = 0; i < request->num_lines; i++) {
+		if ((line_flags(&uapi_cfg.config, i) &
+		     GPIO_V2_LINE_FLAG_OUTPUT) && !(changed & (1ULL << i)))
+			keep |= 1ULL << i;
+	}
+
+	if (!keep)
+		return 0;
+
+	ret = gpiod_line_request_get_values_mask(request, keep, &values);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < request->num_lines; i++) {
+		if (!(keep & (1ULL << i)))
+			continue;
+
+		value = values & (1ULL << i) ? GPIOD_LINE_VALUE_ACTIVE :
+					       GPIOD_LINE_VALUE_INACTIVE;
+		ret = gpiod_line_config_set_line_output_value(
+				config, request->offsets[i], value);
+		if (ret)
+			return -1;
+	}
 
 	return 0;
 }
 
+GPIOD_API int
+gpiod_line_request_reconfigure_lines_partial(struct gpiod_line_request *request,
+					     struct gpiod_line_config *config)
+{
+	struct gpio_v2_line_request uapi_cfg;
+	struct gpiod_line_config *merged;
+	unsigned int offsets[GPIO_V2_LINES_MAX];
+	uint64_t changed = 0;
+	size_t num_offsets, i;
+	int ret, bit;
+
+	assert(request);
+
+	if (!config) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	num_offsets = gpiod_line_config_get_configured_offsets(
+				config, offsets, GPIO_V2_LINES_MAX);
+	if (!num_offsets) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < num_offsets; i++) {
+		bit = offset_to_bit(request, offsets[i]);
+		if (bit < 0) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		changed |= 1ULL << bit;
+	}
+
+	merged = gpiod_line_config_copy(request->config);
+	if (!merged)
+		return -1;
+
+	ret = gpiod_line_config_merge(merged, config);
+	if (ret)
+		goto err_free_merged;
+
+	ret = keep_output_values(request, merged, changed);
+	if (ret)
+		goto err_free_merged;
+
+	memset(&uapi_cfg, 0, sizeof(uapi_cfg));
+
+	ret = gpiod_line_config_to_uapi(merged, &uapi_cfg);
+	if (ret)
+		goto err_free_merged;
+
+	return apply_config(request, merged, &uapi_cfg);
+
+err_free_merged:
+	gpiod_line_config_free(merged);
+
+	return -1;
+}
+
 GPIOD_API int gpiod_line_request_get_fd(struct gpiod_line_request *request)
 {
 	assert(request);
@@ -268,21 +1074,1156 @@ GPIOD_API int gpiod_line_request_get_fd(struct gpiod_line_request *request)
 	return request->fd;
 }
 
+static uint64_t clock_now(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t monotonic_now(void)
+{
+	return clock_now(CLOCK_MONOTONIC);
+}
+
+GPIOD_API void
+gpiod_line_request_set_busy_poll(struct gpiod_line_request *request,
+				 uint64_t budget_ns)
+{
+	assert(request);
+
+	request->busy_poll_ns = budget_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_line_request_get_busy_poll(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return request->busy_poll_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_line_request_get_wait_spin_time_ns(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return request->spin_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_line_request_get_wait_sleep_time_ns(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return request->sleep_ns;
+}
+
+/*
+ * Polling with a zero timeout never puts the thread to sleep so there's no
+ * scheduler wakeup to pay for once an event arrives. Polling instead of
+ * reading keeps the events queued for the caller.
+ */
+static int busy_wait(struct gpiod_line_request *request, int64_t timeout_ns)
+{
+	uint64_t start, now, budget, spun;
+	int64_t remaining;
+	int ret;
+
+	budget = request->busy_poll_ns;
+	if (timeout_ns >= 0 && (uint64_t)timeout_ns < budget)
+		budget = timeout_ns;
+
+	start = monotonic_now();
+
+	do {
+		ret = gpiod_poll_fd(request->fd, 0);
+		now = monotonic_now();
+	} while (ret == 0 && now - start < budget);
+
+	spun = now - start;
+	request->spin_ns += spun;
+
+	if (ret != 0 || (timeout_ns >= 0 && spun >= (uint64_t)timeout_ns))
+		return ret;
+
+	remaining = timeout_ns < 0 ? -1 : timeout_ns - (int64_t)spun;
+
+	ret = gpiod_poll_fd(request->fd, remaining);
+	request->sleep_ns += monotonic_now() - now;
+
+	return ret;
+}
+
 GPIOD_API int
 gpiod_line_request_wait_edge_events(struct gpiod_line_request *request,
 				    int64_t timeout_ns)
 {
+	uint64_t start;
+	int ret;
+
 	assert(request);
 
-	return gpiod_poll_fd(request->fd, timeout_ns);
+	start = gpiod_stats_now();
+
+	if (request->busy_poll_ns)
+		ret = busy_wait(request, timeout_ns);
+	else
+		ret = gpiod_poll_fd(request->fd, timeout_ns);
+
+	gpiod_stats_add_wait(request->stats, start);
+
+	return ret;
 }
 
 GPIOD_API int
-gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
-				    struct gpiod_edge_event_buffer *buffer,
-				    size_t max_events)
+gpiod_line_request_wait_edge_events_cancellable(
+		struct gpiod_line_request *request, int64_t timeout_ns,
+		struct gpiod_wait_cancel *cancel)
 {
+	uint64_t start;
+	int ret;
+
+	assert(request);
+
+	start = gpiod_stats_now();
+	ret = gpiod_poll_fd_cancellable(request->fd, timeout_ns, cancel);
+	gpiod_stats_add_wait(request->stats, start);
+
+	return ret;
+}
+
+/*
+ * The clocks are read once per batch - the events were all seen by the user
+ * at the same time, no matter how long they were queued for.
+ */
+static void record_latency(struct gpiod_line_request *request,
+			   const struct gpio_v2_line_event *events,
+			   size_t num_events)
+{
+	uint64_t monotonic = 0, realtime = 0, now, latency;
+	const struct gpio_v2_line_event *event;
+	size_t i;
+	int bit;
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		bit = offset_to_bit(request, event->offset);
+		if (bit < 0 ||
+		    gpiod_line_mask_test_bit(&request->hte_mask, bit))
+			continue;
+
+		if (gpiod_line_mask_test_bit(&request->realtime_mask, bit)) {
+			if (!realtime)
+				realtime = clock_now(CLOCK_REALTIME);
+			now = realtime;
+		} else {
+			if (!monotonic)
+				monotonic = clock_now(CLOCK_MONOTONIC);
+			now = monotonic;
+		}
+
+		/* The realtime clock may have been stepped back since. */
+		latency = now > event->timestamp_ns ?
+				now - event->timestamp_ns : 0;
+
+		gpiod_latency_histogram_add(
+			gpiod_latency_histogram_array_get(request->latency, bit),
+			latency);
+	}
+}
+
+static void record_edge_stats(struct gpiod_line_request *request,
+			      const struct gpio_v2_line_event *events,
+			      size_t num_events)
+{
+	const struct gpio_v2_line_event *event;
+	size_t i;
+	int bit;
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		bit = offset_to_bit(request, event->offset);
+		if (bit < 0)
+			continue;
+
+		gpiod_edge_stats_add(
+			gpiod_edge_stats_array_get(request->edge_stats, bit),
+			event->id == GPIO_V2_LINE_EVENT_RISING_EDGE,
+			event->timestamp_ns);
+	}
+}
+
+size_t gpiod_line_request_account_events(struct gpiod_line_request *request,
+					 const struct gpio_v2_line_event *events,
+					 size_t num_events)
+{
+	const struct gpio_v2_line_event *event;
+	uint64_t tracked = 0, levels = 0;
+	size_t i, dropped = 0;
+	uint32_t gap;
+	int bit;
+
+	/* Counted as a single read - draining accounts for its other ones. */
+	if (num_events)
+		gpiod_stats_add_read(request->stats,
+				     num_events * sizeof(*events), num_events);
+
+	if (request->latency)
+		record_latency(request, events, num_events);
+
+	if (request->edge_stats)
+		record_edge_stats(request, events, num_events);
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		/* Unsigned arithmetic takes care of the counters wrapping. */
+		gap = event->seqno - request->last_seqno - 1;
+		request->last_seqno = event->seqno;
+		dropped += gap;
+
+		bit = offset_to_bit(request, event->offset);
+		if (bit < 0)
+			continue;
+
+		gap = event->line_seqno - request->last_line_seqno[bit] - 1;
+		request->last_line_seqno[bit] = event->line_seqno;
+		request->line_num_dropped[bit] += gap;
+
+		if (gpiod_line_mask_test_bit(&request->input_shadow_mask, bit)) {
+			gpiod_line_mask_set_bit(&tracked, bit);
+			gpiod_line_mask_assign_bit(&levels, bit,
+				event->id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+		}
+	}
+
+	/* The last edge of each line in the batch determines its level. */
+	if (tracked)
+		gpiod_line_mask_update(&request->shadow_values, tracked, levels);
+
+	/*
+	 * The lost events may have been the last ones of any line. Depending
+	 * on the kernel version, the newest events are dropped on overflow and
+	 * the gap only shows with the next event so a full fifo counts too.
+	 */
+	if (dropped || num_events >= request->event_buffer_size)
+		gpiod_line_mask_store(&request->input_stale_mask,
+				      request->input_shadow_mask);
+
+	request->num_dropped += dropped;
+
+	gpiod_trace(read_edge_events, request->fd, num_events, dropped);
+
+	return dropped;
+}
+
+GPIOD_API int
+gpiod_line_request_set_soft_debounce_period_us(
+		struct gpiod_line_request *request, unsigned int offset,
+		unsigned long period_us)
+{
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	request->soft_debounce_ns[bit] = (uint64_t)period_us * 1000;
+	request->soft_debounce_seen &= ~GPIOD_BIT(bit);
+	request->soft_debounce_state[bit] = 0;
+
+	if (period_us)
+		request->soft_debounce_mask |= GPIOD_BIT(bit);
+	else
+		request->soft_debounce_mask &= ~GPIOD_BIT(bit);
+
+	return 0;
+}
+
+GPIOD_API long
+gpiod_line_request_get_soft_debounce_period_us(
+		struct gpiod_line_request *request, unsigned int offset)
+{
+	int bit;
+
 	assert(request);
 
-	return gpiod_edge_event_buffer_read_fd(request->fd, buffer, max_events);
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return request->soft_debounce_ns[bit] / 1000;
+}
+
+/*
+ * Edges following each other on a line closer than its debounce period form
+ * a burst. Only the net change of the line state within a burst is kept,
+ * reported with the timestamp of the last edge making it, so a glitch that
+ * returns the line to where it was is dropped entirely. The state carries
+ * over between batches but a glitch split across two reads can't be taken
+ * back once its first edge was returned.
+ *
+ * Dropped events are marked with an invalid id and squeezed out in a single
+ * pass at the end so that the survivors keep their order.
+ */
+size_t gpiod_line_request_debounce_events(struct gpiod_line_request *request,
+					  struct gpio_v2_line_event *events,
+					  size_t num_events)
+{
+	uint32_t prev_state[GPIO_V2_LINES_MAX], *state;
+	long burst[GPIO_V2_LINES_MAX];
+	struct gpio_v2_line_event *event;
+	size_t i, num_kept;
+	bool in_burst;
+	int bit;
+
+	if (!request->soft_debounce_mask)
+		return num_events;
+
+	for (i = 0; i < request->num_lines; i++)
+		burst[i] = -1;
+
+	for (i = 0; i < num_events; i++) {
+		event = &events[i];
+
+		bit = offset_to_bit(request, event->offset);
+		if (bit < 0 || !(request->soft_debounce_mask & GPIOD_BIT(bit)))
+			continue;
+
+		state = &request->soft_debounce_state[bit];
+		in_burst = (request->soft_debounce_seen & GPIOD_BIT(bit)) &&
+			   event->timestamp_ns - request->soft_debounce_ts[bit] <
+					request->soft_debounce_ns[bit];
+		request->soft_debounce_ts[bit] = event->timestamp_ns;
+		request->soft_debounce_seen |= GPIOD_BIT(bit);
+
+		if (!in_burst || (burst[bit] < 0 && event->id != *state)) {
+			/* Keep the edge for now. */
+			burst[bit] = i;
+			prev_state[bit] = *state;
+			*state = event->id;
+			continue;
+		}
+
+		if (burst[bit] >= 0 && event->id != *state) {
+			/* The line is back where the burst started. */
+			events[burst[bit]].id = 0;
+			burst[bit] = -1;
+			*state = prev_state[bit];
+		}
+
+		event->id = 0;
+	}
+
+	for (i = 0, num_kept = 0; i < num_events; i++) {
+		if (!events[i].id)
+			continue;
+
+		if (i != num_kept)
+			events[num_kept] = events[i];
+		num_kept++;
+	}
+
+	return num_kept;
+}
+
+GPIOD_API int
+gpiod_line_request_set_edge_event_filter(struct gpiod_line_request *request,
+					 const unsigned int *offsets,
+					 size_t num_offsets,
+					 enum gpiod_line_edge edge)
+{
+	uint64_t mask = 0;
+	size_t i;
+	int bit;
+
+	assert(request);
+
+	if (edge < GPIOD_LINE_EDGE_NONE || edge > GPIOD_LINE_EDGE_BOTH ||
+	    (num_offsets && !offsets)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!num_offsets) {
+		mask = (request->num_lines == GPIO_V2_LINES_MAX) ?
+				UINT64_MAX : (1ULL << request->num_lines) - 1;
+	} else {
+		for (i = 0; i < num_offsets; i++) {
+			bit = offset_to_bit(request, offsets[i]);
+			if (bit < 0) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			mask |= GPIOD_BIT(bit);
+		}
+	}
+
+	if (edge == GPIOD_LINE_EDGE_RISING || edge == GPIOD_LINE_EDGE_BOTH)
+		request->drop_rising_mask &= ~mask;
+	else
+		request->drop_rising_mask |= mask;
+
+	if (edge == GPIOD_LINE_EDGE_FALLING || edge == GPIOD_LINE_EDGE_BOTH)
+		request->drop_falling_mask &= ~mask;
+	else
+		request->drop_falling_mask |= mask;
+
+	return 0;
+}
+
+GPIOD_API enum gpiod_line_edge
+gpiod_line_request_get_edge_event_filter(struct gpiod_line_request *request,
+					 unsigned int offset)
+{
+	bool rising, falling;
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return GPIOD_LINE_EDGE_NONE;
+	}
+
+	rising = !(request->drop_rising_mask & GPIOD_BIT(bit));
+	falling = !(request->drop_falling_mask & GPIOD_BIT(bit));
+
+	if (rising && falling)
+		return GPIOD_LINE_EDGE_BOTH;
+	if (rising)
+		return GPIOD_LINE_EDGE_RISING;
+	if (falling)
+		return GPIOD_LINE_EDGE_FALLING;
+
+	return GPIOD_LINE_EDGE_NONE;
+}
+
+GPIOD_API int
+gpiod_line_request_set_rate_limit(struct gpiod_line_request *request,
+				  unsigned int offset, unsigned int max_events,
+				  unsigned long window_us,
+				  enum gpiod_rate_limit_policy policy)
+{
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0 || (max_events && !window_us) ||
+	    (policy != GPIOD_RATE_LIMIT_KEEP_FIRST &&
+	     policy != GPIOD_RATE_LIMIT_KEEP_LAST)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	request->rate_limit_ns[bit] = max_events ? (uint64_t)window_us * 1000 : 0;
+	request->rate_limit_max[bit] = max_events;
+	request->rate_limit_count[bit] = 0;
+	request->rate_limit_seen &= ~GPIOD_BIT(bit);
+
+	if (max_events)
+		request->rate_limit_mask |= GPIOD_BIT(bit);
+	else
+		request->rate_limit_mask &= ~GPIOD_BIT(bit);
+
+	if (policy == GPIOD_RATE_LIMIT_KEEP_LAST)
+		request->rate_limit_keep_last_mask |= GPIOD_BIT(bit);
+	else
+		request->rate_limit_keep_last_mask &= ~GPIOD_BIT(bit);
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_line_request_get_rate_limit(struct gpiod_line_request *request,
+				  unsigned int offset, unsigned int *max_events,
+				  unsigned long *window_us,
+				  enum gpiod_rate_limit_policy *policy)
+{
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (max_events)
+		*max_events = request->rate_limit_max[bit];
+	if (window_us)
+		*window_us = request->rate_limit_ns[bit] / 1000;
+	if (policy)
+		*policy = (request->rate_limit_keep_last_mask & GPIOD_BIT(bit)) ?
+				GPIOD_RATE_LIMIT_KEEP_LAST :
+				GPIOD_RATE_LIMIT_KEEP_FIRST;
+
+	return 0;
+}
+
+GPIOD_API long
+gpiod_line_request_get_num_rate_limited_events(
+		struct gpiod_line_request *request, unsigned int offset)
+{
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return request->num_rate_limited[bit];
+}
+
+static void count_rate_limited(struct gpiod_line_request *request, int bit)
+{
+	request->num_rate_limited[bit]++;
+	request->line_num_dropped[bit]++;
+	request->num_dropped++;
+}
+
+/*
+ * Windows are fixed, each one starts with the first event past the end of the
+ * previous one. Over the budget, keep-last replaces the newest event of the
+ * line kept in this batch so that its latest edge is always reported - if it
+ * was already returned by an earlier read the new event is kept on top.
+ */
+static bool rate_limit_event(struct gpiod_line_request *request,
+			     struct gpio_v2_line_event *events, size_t idx,
+			     int bit, long *last_kept)
+{
+	uint64_t ts = events[idx].timestamp_ns;
+
+	if (!(request->rate_limit_seen & GPIOD_BIT(bit)) ||
+	    ts < request->rate_limit_start[bit] ||
+	    ts - request->rate_limit_start[bit] >= request->rate_limit_ns[bit]) {
+		request->rate_limit_start[bit] = ts;
+		request->rate_limit_count[bit] = 0;
+		request->rate_limit_seen |= GPIOD_BIT(bit);
+	}
+
+	if (request->rate_limit_count[bit] < request->rate_limit_max[bit]) {
+		request->rate_limit_count[bit]++;
+		last_kept[bit] = idx;
+		return true;
+	}
+
+	if (!(request->rate_limit_keep_last_mask & GPIOD_BIT(bit))) {
+		count_rate_limited(request, bit);
+		return false;
+	}
+
+	if (last_kept[bit] >= 0) {
+		events[last_kept[bit]].id = 0;
+		count_rate_limited(request, bit);
+	}
+
+	last_kept[bit] = idx;
+
+	return true;
+}
+
+/*
+ * Works on the raw kernel records right after the read so that discarded
+ * events are never decoded or handed over to the user. Runs after the
+ * software debounce which needs to see both edges to track the line state.
+ * Events discarded by the edge filter don't count against the rate limit.
+ */
+size_t gpiod_line_request_filter_events(struct gpiod_line_request *request,
+					struct gpio_v2_line_event *events,
+					size_t num_events)
+{
+	long last_kept[GPIO_V2_LINES_MAX];
+	size_t i, num_kept;
+	uint64_t drop;
+	int bit;
+
+	if (!(request->drop_rising_mask | request->drop_falling_mask |
+	      request->rate_limit_mask))
+		return num_events;
+
+	for (i = 0; i < request->num_lines; i++)
+		last_kept[i] = -1;
+
+	for (i = 0; i < num_events; i++) {
+		drop = events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE ?
+				request->drop_rising_mask :
+				request->drop_falling_mask;
+
+		bit = offset_to_bit(request, events[i].offset);
+		if (bit < 0)
+			continue;
+
+		if ((drop & GPIOD_BIT(bit)) ||
+		    ((request->rate_limit_mask & GPIOD_BIT(bit)) &&
+		     !rate_limit_event(request, events, i, bit, last_kept)))
+			events[i].id = 0;
+	}
+
+	for (i = 0, num_kept = 0; i < num_events; i++) {
+		if (!events[i].id)
+			continue;
+
+		if (i != num_kept)
+			events[num_kept] = events[i];
+		num_kept++;
+	}
+
+	return num_kept;
+}
+
+static int request_with_fifo_size(struct gpiod_line_request *request,
+				  struct gpiod_line_config *config, size_t size)
+{
+	struct gpio_v2_line_request uapi_req;
+	int ret;
+
+	memset(&uapi_req, 0, sizeof(uapi_req));
+	strcpy(uapi_req.consumer, request->consumer);
+	uapi_req.event_buffer_size = size;
+
+	ret = gpiod_line_config_to_uapi(config, &uapi_req);
+	if (ret)
+		return -1;
+
+	ret = gpiod_stats_ioctl(request->stats, GPIOD_STATS_IOCTL_CONFIG,
+				request->chip_fd, GPIO_V2_GET_LINE_IOCTL,
+				&uapi_req);
+	if (ret < 0)
+		return -1;
+
+	/* Move the new request into the place of the old one. */
+	ret = dup3(uapi_req.fd, request->fd, O_CLOEXEC);
+	close(uapi_req.fd);
+
+	return ret < 0 ? -1 : 0;
+}
+
+/*
+ * The size of the kernel fifo is fixed for the lifetime of the request so
+ * the lines need to be released and requested again. The file descriptor is
+ * first pointed at /dev/null which releases the lines but keeps the number
+ * reserved so that it stays valid for the user.
+ */
+static int grow_event_buffer(struct gpiod_line_request *request)
+{
+	struct gpiod_line_config *config;
+	int ret = -1, placeholder;
+	size_t size;
+
+	size = MIN(request->event_buffer_size * 2,
+		   request->max_event_buffer_size);
+
+	config = gpiod_line_config_copy(request->config);
+	if (!config)
+		return -1;
+
+	if (keep_output_values(request, config, 0))
+		goto out_free_config;
+
+	placeholder = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	if (placeholder < 0)
+		goto out_free_config;
+
+	ret = dup3(placeholder, request->fd, O_CLOEXEC);
+	close(placeholder);
+	if (ret < 0)
+		goto out_free_config;
+
+	ret = request_with_fifo_size(request, config, size);
+	if (ret) {
+		/* Try to get the lines back as they were. */
+		ret = request_with_fifo_size(request, config,
+					     request->event_buffer_size);
+		if (ret)
+			goto out_free_config;
+
+		request->max_event_buffer_size = request->event_buffer_size;
+	} else {
+		request->event_buffer_size = size;
+	}
+
+	/* The new file starts out in blocking mode. */
+	request->fd_nonblocking = false;
+	if (request->nonblocking)
+		gpiod_line_request_set_nonblocking(request);
+
+	/* The kernel numbers the events of the new request from 1. */
+	request->last_seqno = 0;
+	memset(request->last_line_seqno, 0,
+	       sizeof(*request->last_line_seqno) * request->num_lines);
+	/* Edges in between the requests were lost. */
+	gpiod_line_mask_store(&request->input_stale_mask,
+			      request->input_shadow_mask);
+	request->fd_generation++;
+
+out_free_config:
+	gpiod_line_config_free(config);
+
+	return ret;
+}
+
+static size_t handle_read_events(struct gpiod_line_request *request,
+				 struct gpiod_edge_event_buffer *buffer,
+				 size_t num_events)
+{
+	size_t dropped, num_kept;
+
+	dropped = gpiod_line_request_account_events(request,
+			gpiod_edge_event_buffer_get_data(buffer), num_events);
+	num_kept = gpiod_line_request_debounce_events(request,
+			gpiod_edge_event_buffer_get_data(buffer), num_events);
+	num_kept = gpiod_line_request_filter_events(request,
+			gpiod_edge_event_buffer_get_data(buffer), num_kept);
+	gpiod_edge_event_buffer_set_num_events(buffer, num_kept);
+	gpiod_edge_event_buffer_set_num_dropped(buffer, dropped);
+
+	if (request->chip_fd < 0)
+		return num_kept;
+
+	/* Events were lost or the fifo was full when it was read. */
+	if ((dropped || num_events >= request->event_buffer_size) &&
+	    request->event_buffer_size < request->max_event_buffer_size)
+		request->grow_pending = true;
+
+	/*
+	 * Events still queued would be lost when the lines are released - wait
+	 * until they've been read.
+	 */
+	if (request->grow_pending && gpiod_poll_fd(request->fd, 0) == 0) {
+		request->grow_pending = false;
+		/*
+		 * The events are in the buffer already. If the lines couldn't
+		 * be requested again, subsequent calls fail.
+		 */
+		grow_event_buffer(request);
+	}
+
+	return num_kept;
+}
+
+GPIOD_API int
+gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
+				    struct gpiod_edge_event_buffer *buffer,
+				    size_t max_events)
+{
+	int ret;
+
+	assert(request);
+
+	ret = gpiod_edge_event_buffer_read_fd(request->fd, buffer, max_events);
+	if (ret < 0 && errno == EAGAIN && request->nonblocking)
+		return 0;
+	if (ret < 0 && errno == EAGAIN && request->fd_nonblocking) {
+		/* Keep the blocking semantics after switching to drain mode. */
+		ret = gpiod_poll_fd(request->fd, -1);
+		if (ret < 0)
+			return -1;
+
+		ret = gpiod_edge_event_buffer_read_fd(request->fd, buffer,
+						      max_events);
+	}
+	if (ret < 0)
+		return -1;
+
+	return handle_read_events(request, buffer, ret);
+}
+
+static bool values_match(uint64_t current, uint64_t mask, uint64_t values,
+			 enum gpiod_line_match match)
+{
+	uint64_t matching = ~(current ^ values) & mask;
+
+	return match == GPIOD_LINE_MATCH_ALL ? matching == mask : matching != 0;
+}
+
+/*
+ * Waiting relies on the edge events to wake up so each line must report the
+ * edge leading to the value it's waited for.
+ */
+static int check_wait_edges(struct gpiod_line_request *request, uint64_t mask,
+			    uint64_t values)
+{
+	struct gpio_v2_line_request uapi_cfg;
+	uint64_t flags, edge;
+	size_t i;
+	int ret;
+
+	memset(&uapi_cfg, 0, sizeof(uapi_cfg));
+
+	ret = gpiod_line_config_to_uapi(request->config, &uapi_cfg);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < request->num_lines; i++) {
+		if (!gpiod_line_mask_test_bit(&mask, i))
+			continue;
+
+		flags = line_flags(&uapi_cfg.config, i);
+		edge = gpiod_line_mask_test_bit(&values, i) ?
+				GPIO_V2_LINE_FLAG_EDGE_RISING :
+				GPIO_V2_LINE_FLAG_EDGE_FALLING;
+		if (!(flags & edge)) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_line_request_wait_for_values_mask(struct gpiod_line_request *request,
+					uint64_t mask, uint64_t values,
+					enum gpiod_line_match match,
+					int64_t timeout_ns)
+{
+	struct gpiod_edge_event_buffer *buffer;
+	uint64_t current, deadline = 0, now;
+	int64_t remaining = timeout_ns;
+	int ret;
+
+	assert(request);
+
+	if (!mask || !mask_valid(request, mask) ||
+	    (match != GPIOD_LINE_MATCH_ALL && match != GPIOD_LINE_MATCH_ANY)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = check_wait_edges(request, mask, values);
+	if (ret)
+		return -1;
+
+	buffer = gpiod_edge_event_buffer_new(WAIT_FOR_VALUES_READ_BATCH);
+	if (!buffer)
+		return -1;
+
+	if (timeout_ns > 0)
+		deadline = monotonic_now() + timeout_ns;
+
+	/*
+	 * Any change after the values are read queues an edge event which ends
+	 * the wait, so no change can slip in between the read and the wait.
+	 */
+	for (;;) {
+		ret = gpiod_line_request_get_values_mask(request, mask,
+							 &current);
+		if (ret)
+			break;
+
+		if (values_match(current, mask, values, match)) {
+			ret = 1;
+			break;
+		}
+
+		if (timeout_ns > 0) {
+			now = monotonic_now();
+			if (now >= deadline) {
+				ret = 0;
+				break;
+			}
+
+			remaining = deadline - now;
+		}
+
+		ret = gpiod_line_request_wait_edge_events(request, remaining);
+		if (ret <= 0)
+			break;
+
+		ret = gpiod_line_request_read_edge_events(request, buffer,
+						WAIT_FOR_VALUES_READ_BATCH);
+		if (ret < 0)
+			break;
+	}
+
+	gpiod_edge_event_buffer_free(buffer);
+
+	return ret;
+}
+
+GPIOD_API int
+gpiod_line_request_wait_for_values_subset(struct gpiod_line_request *request,
+					  size_t num_values,
+					  const unsigned int *offsets,
+					  const enum gpiod_line_value *values,
+					  enum gpiod_line_match match,
+					  int64_t timeout_ns)
+{
+	uint64_t mask = 0, bits = 0;
+	size_t i;
+	int bit;
+
+	assert(request);
+
+	if (!offsets || !values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < num_values; i++) {
+		bit = offset_to_bit(request, offsets[i]);
+		if (bit < 0 || (values[i] != GPIOD_LINE_VALUE_ACTIVE &&
+				values[i] != GPIOD_LINE_VALUE_INACTIVE)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		gpiod_line_mask_set_bit(&mask, bit);
+		gpiod_line_mask_assign_bit(&bits, bit,
+					   values[i] == GPIOD_LINE_VALUE_ACTIVE);
+	}
+
+	return gpiod_line_request_wait_for_values_mask(request, mask, bits,
+						       match, timeout_ns);
+}
+
+GPIOD_API int
+gpiod_line_request_wait_for_value(struct gpiod_line_request *request,
+				  unsigned int offset,
+				  enum gpiod_line_value value,
+				  int64_t timeout_ns)
+{
+	return gpiod_line_request_wait_for_values_subset(request, 1, &offset,
+							 &value,
+							 GPIOD_LINE_MATCH_ALL,
+							 timeout_ns);
+}
+
+static int set_fd_nonblocking(struct gpiod_line_request *request)
+{
+	int flags, ret;
+
+	if (request->fd_nonblocking)
+		return 0;
+
+	flags = fcntl(request->fd, F_GETFL);
+	if (flags < 0)
+		return -1;
+
+	ret = fcntl(request->fd, F_SETFL, flags | O_NONBLOCK);
+	if (ret < 0)
+		return -1;
+
+	request->fd_nonblocking = true;
+
+	return 0;
+}
+
+int gpiod_line_request_set_nonblocking(struct gpiod_line_request *request)
+{
+	request->nonblocking = true;
+
+	return set_fd_nonblocking(request);
+}
+
+GPIOD_API int
+gpiod_line_request_drain_edge_events(struct gpiod_line_request *request,
+				     struct gpiod_edge_event_buffer *buffer,
+				     size_t max_events, int64_t max_time_ns)
+{
+	struct gpio_v2_line_event *events;
+	size_t num_events = 0, room, capacity;
+	uint64_t deadline = 0;
+	ssize_t rd;
+	int ret;
+
+	assert(request);
+
+	if (!buffer || max_events > INT_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!max_events)
+		max_events = INT_MAX;
+
+	ret = set_fd_nonblocking(request);
+	if (ret)
+		return -1;
+
+	gpiod_edge_event_buffer_set_num_events(buffer, 0);
+
+	if (max_time_ns > 0)
+		deadline = monotonic_now() + max_time_ns;
+
+	while (num_events < max_events) {
+		capacity = gpiod_edge_event_buffer_get_capacity(buffer);
+		if (num_events == capacity) {
+			ret = gpiod_edge_event_buffer_reserve(buffer,
+					MIN(capacity * 2, max_events));
+			if (ret)
+				return -1;
+
+			capacity = gpiod_edge_event_buffer_get_capacity(buffer);
+		}
+
+		events = gpiod_edge_event_buffer_get_data(buffer);
+		room = MIN(capacity, max_events) - num_events;
+
+		rd = gpiod_sys_read(request->fd, &events[num_events],
+				    room * sizeof(*events));
+		if (rd < 0) {
+			if (errno == EAGAIN)
+				break;
+
+			return -1;
+		} else if ((size_t)rd < sizeof(*events)) {
+			errno = EIO;
+			return -1;
+		}
+
+		/* The events of all reads are accounted for together. */
+		if (num_events)
+			gpiod_stats_add_read(request->stats, 0, 0);
+
+		num_events += rd / sizeof(*events);
+
+		if (deadline && monotonic_now() >= deadline)
+			break;
+	}
+
+	return handle_read_events(request, buffer, num_events);
+}
+
+GPIOD_API size_t
+gpiod_line_request_get_event_buffer_size(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return request->event_buffer_size;
+}
+
+GPIOD_API struct gpiod_stats *
+gpiod_line_request_get_stats(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return gpiod_stats_copy(request->stats);
+}
+
+GPIOD_API void gpiod_line_request_reset_stats(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	gpiod_stats_reset(request->stats);
+}
+
+GPIOD_API struct gpiod_latency_histogram *
+gpiod_line_request_get_latency_histogram(struct gpiod_line_request *request,
+					 unsigned int offset)
+{
+	int bit;
+
+	assert(request);
+
+	if (!request->latency) {
+		errno = ENOTSUP;
+		return NULL;
+	}
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return gpiod_latency_histogram_copy(
+		gpiod_latency_histogram_array_get(request->latency, bit));
+}
+
+GPIOD_API void
+gpiod_line_request_reset_latency_histograms(struct gpiod_line_request *request)
+{
+	size_t i;
+
+	assert(request);
+
+	if (!request->latency)
+		return;
+
+	for (i = 0; i < request->num_lines; i++)
+		gpiod_latency_histogram_reset(
+			gpiod_latency_histogram_array_get(request->latency, i));
+}
+
+GPIOD_API struct gpiod_edge_stats *
+gpiod_line_request_get_edge_stats(struct gpiod_line_request *request,
+				  unsigned int offset)
+{
+	int bit;
+
+	assert(request);
+
+	if (!request->edge_stats) {
+		errno = ENOTSUP;
+		return NULL;
+	}
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return gpiod_edge_stats_copy(
+		gpiod_edge_stats_array_get(request->edge_stats, bit));
+}
+
+GPIOD_API void
+gpiod_line_request_reset_edge_stats(struct gpiod_line_request *request)
+{
+	size_t i;
+
+	assert(request);
+
+	if (!request->edge_stats)
+		return;
+
+	for (i = 0; i < request->num_lines; i++)
+		gpiod_edge_stats_reset(
+			gpiod_edge_stats_array_get(request->edge_stats, i));
+}
+
+GPIOD_API unsigned long
+gpiod_line_request_get_num_dropped_events(struct gpiod_line_request *request)
+{
+	assert(request);
+
+	return request->num_dropped;
+}
+
+GPIOD_API long
+gpiod_line_request_get_num_dropped_line_events(
+		struct gpiod_line_request *request, unsigned int offset)
+{
+	int bit;
+
+	assert(request);
+
+	bit = offset_to_bit(request, offset);
+	if (bit < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return request->line_num_dropped[bit];
 }
@@ -24,7 +24,7 @@ GPIOD_API struct gpiod_line_settings *gpiod_line_settings_new(void)
 {
 	struct gpiod_line_settings *settings;
 
-	settings = malloc(sizeof(*settings));
+	settings = gpiod_malloc(sizeof(*settings));
 	if (!settings)
 		return NULL;
 
@@ -35,7 +35,7 @@ GPIOD_API struct gpiod_line_settings *gpiod_line_settings_new(void)
 
 GPIOD_API void gpiod_line_settings_free(struct gpiod_line_settings *settings)
 {
-	free(settings);
+	gpiod_free(settings);
 }
 
 GPIOD_API void gpiod_line_settings_reset(struct gpiod_line_settings *settings)
@@ -59,7 +59,7 @@ gpiod_line_settings_copy(struct gpiod_line_settings *settings)
 
 	struct gpiod_line_settings *copy;
 
-	copy = malloc(sizeof(*copy));
+	copy = gpiod_malloc(sizeof(*copy));
 	if (!copy)
 		return NULL;
 
@@ -68,6 +68,19 @@ gpiod_line_settings_copy(struct gpiod_line_settings *settings)
 	return copy;
 }
 
+bool gpiod_line_settings_equal(struct gpiod_line_settings *left,
+			       struct gpiod_line_settings *right)
+{
+	return left->direction == right->direction &&
+	       left->edge_detection == right->edge_detection &&
+	       left->drive == right->drive &&
+	       left->bias == right->bias &&
+	       left->active_low == right->active_low &&
+	       left->event_clock == right->event_clock &&
+	       left->debounce_period_us == right->debounce_period_us &&
+	       left->output_value == right->output_value;
+}
+
 GPIOD_API int
 gpiod_line_settings_set_direction(struct gpiod_line_settings *settings,
 				  enum gpiod_line_direction direction)
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "internal.h"
+
+#define MIN_PHASES	4
+
+struct phase {
+	uint64_t mask;
+	uint64_t values;
+};
+
+struct gpiod_line_transaction {
+	struct gpiod_line_request *request;
+	uint64_t valid_mask;
+	/* The last phase is the one being staged, it's always there. */
+	struct phase *phases;
+	size_t num_phases;
+	size_t max_phases;
+};
+
+GPIOD_API struct gpiod_line_transaction *
+gpiod_line_request_begin_transaction(struct gpiod_line_request *request)
+{
+	struct gpiod_line_transaction *tx;
+	size_t num_lines;
+
+	assert(request);
+
+	tx = gpiod_malloc(sizeof(*tx));
+	if (!tx)
+		return NULL;
+
+	memset(tx, 0, sizeof(*tx));
+
+	tx->phases = gpiod_calloc(MIN_PHASES, sizeof(*tx->phases));
+	if (!tx->phases) {
+		gpiod_free(tx);
+		return NULL;
+	}
+
+	num_lines = gpiod_line_request_get_num_requested_lines(request);
+
+	tx->request = request;
+	tx->valid_mask = num_lines == GPIO_V2_LINES_MAX ?
+				UINT64_MAX : (1ULL << num_lines) - 1;
+	tx->num_phases = 1;
+	tx->max_phases = MIN_PHASES;
+
+	return tx;
+}
+
+GPIOD_API void gpiod_line_transaction_free(struct gpiod_line_transaction *tx)
+{
+	if (!tx)
+		return;
+
+	gpiod_free(tx->phases);
+	gpiod_free(tx);
+}
+
+static struct phase *current_phase(struct gpiod_line_transaction *tx)
+{
+	return &tx->phases[tx->num_phases - 1];
+}
+
+GPIOD_API int
+gpiod_line_transaction_set_values_mask(struct gpiod_line_transaction *tx,
+				       uint64_t mask, uint64_t values)
+{
+	struct phase *phase;
+
+	assert(tx);
+
+	if (mask & ~tx->valid_mask) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Within a phase, the last value staged for a line wins. */
+	phase = current_phase(tx);
+	phase->values = (phase->values & ~mask) | (values & mask);
+	phase->mask |= mask;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_line_transaction_set_bits(struct gpiod_line_transaction *tx,
+					      uint64_t mask)
+{
+	return gpiod_line_transaction_set_values_mask(tx, mask, mask);
+}
+
+GPIOD_API int
+gpiod_line_transaction_clear_bits(struct gpiod_line_transaction *tx,
+				  uint64_t mask)
+{
+	return gpiod_line_transaction_set_values_mask(tx, mask, 0);
+}
+
+GPIOD_API int
+gpiod_line_transaction_set_value(struct gpiod_line_transaction *tx,
+				 unsigned int offset,
+				 enum gpiod_line_value value)
+{
+	return gpiod_line_transaction_set_values_subset(tx, 1, &offset, &value);
+}
+
+GPIOD_API int
+gpiod_line_transaction_set_values_subset(struct gpiod_line_transaction *tx,
+					 size_t num_values,
+					 const unsigned int *offsets,
+					 const enum gpiod_line_value *values)
+{
+	uint64_t mask = 0, bits = 0;
+	size_t i;
+	int bit;
+
+	assert(tx);
+
+	if (!offsets || !values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Nothing is staged unless all offsets are valid. */
+	for (i = 0; i < num_values; i++) {
+		bit = gpiod_line_request_get_offset_bit(tx->request,
+							offsets[i]);
+		if (bit < 0)
+			return -1;
+
+		gpiod_line_mask_set_bit(&mask, bit);
+		gpiod_line_mask_assign_bit(&bits, bit, values[i]);
+	}
+
+	return gpiod_line_transaction_set_values_mask(tx, mask, bits);
+}
+
+GPIOD_API int
+gpiod_line_transaction_next_phase(struct gpiod_line_transaction *tx)
+{
+	struct phase *phases;
+	size_t max_phases;
+
+	assert(tx);
+
+	/* Empty phases would only cost an ioctl with nothing to set. */
+	if (!current_phase(tx)->mask)
+		return 0;
+
+	if (tx->num_phases == tx->max_phases) {
+		max_phases = tx->max_phases * 2;
+
+		phases = gpiod_realloc(tx->phases,
+				       tx->max_phases * sizeof(*phases),
+				       max_phases * sizeof(*phases));
+		if (!phases)
+			return -1;
+
+		tx->phases = phases;
+		tx->max_phases = max_phases;
+	}
+
+	memset(&tx->phases[tx->num_phases], 0, sizeof(*tx->phases));
+	tx->num_phases++;
+
+	return 0;
+}
+
+GPIOD_API size_t
+gpiod_line_transaction_get_num_phases(struct gpiod_line_transaction *tx)
+{
+	assert(tx);
+
+	return current_phase(tx)->mask ? tx->num_phases : tx->num_phases - 1;
+}
+
+GPIOD_API void gpiod_line_transaction_discard(struct gpiod_line_transaction *tx)
+{
+	assert(tx);
+
+	memset(tx->phases, 0, sizeof(*tx->phases));
+	tx->num_phases = 1;
+}
+
+GPIOD_API int gpiod_line_transaction_commit(struct gpiod_line_transaction *tx)
+{
+	struct phase *phase;
+	size_t i;
+	int ret;
+
+	assert(tx);
+
+	for (i = 0; i < tx->num_phases; i++) {
+		phase = &tx->phases[i];
+		if (!phase->mask)
+			continue;
+
+		/*
+		 * Lines already at their staged values are skipped by the
+		 * request so a phase not changing anything costs no ioctl.
+		 */
+		ret = gpiod_line_request_set_values_mask(tx->request,
+							 phase->mask,
+							 phase->values);
+		if (ret) {
+			/* Keep the failed phase and the ones after it. */
+			memmove(tx->phases, phase,
+				(tx->num_phases - i) * sizeof(*phase));
+			tx->num_phases -= i;
+			return -1;
+		}
+	}
+
+	gpiod_line_transaction_discard(tx);
+
+	return 0;
+}
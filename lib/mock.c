@@ -0,0 +1,1113 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * In-process stand-in for the GPIO character device. Built with
+ * --enable-mock-backend, the open, close, ioctl and read calls issued by the
+ * library on the file descriptors of mock chips and their requests are
+ * served here, all other file descriptors are passed to the kernel.
+ *
+ * Chip file descriptors are eventfds which never become readable. Request
+ * file descriptors are timerfds armed for the next edge event due so that
+ * polling them works as expected. The edges are not generated by a thread:
+ * every line with an event rate toggles at fixed times since the rate was
+ * set and its events are computed from the clock when the request is read.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#if defined(GPIOD_WITH_MOCK)
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define MOCK_PATH_FMT		"gpiod-mock:%u"
+#define MOCK_NAME_FMT		"gpiomock%u"
+#define MOCK_LABEL		"gpiod-mock"
+#define NSEC_PER_SEC		1000000000ULL
+/* The kernel's default size of the edge event fifo per requested line. */
+#define EVENTS_PER_LINE		16
+
+struct mock_request;
+
+struct mock_line {
+	/* Physical level at epoch_ns, held while driven. */
+	bool value;
+	bool driven;
+	/* Interval between toggles, 0 if the level doesn't change. */
+	uint64_t period_ns;
+	uint64_t epoch_ns;
+	/* Bumped whenever the toggles are rescheduled. */
+	unsigned int generation;
+	struct mock_request *request;
+	unsigned int request_index;
+};
+
+struct gpiod_mock_chip {
+	unsigned int id;
+	char path[32];
+	size_t num_lines;
+	/* The user's reference and one per open file descriptor. */
+	unsigned int refcount;
+	struct mock_line *lines;
+};
+
+struct mock_request_line {
+	unsigned int offset;
+	uint64_t flags;
+	unsigned int generation;
+	/* Number of the next toggle since the epoch of the line. */
+	uint64_t next_toggle;
+	uint32_t line_seqno;
+};
+
+struct mock_request {
+	struct gpiod_mock_chip *chip;
+	int fd;
+	char consumer[GPIO_MAX_NAME_SIZE];
+	uint32_t seqno;
+	size_t event_buffer_size;
+	unsigned int num_lines;
+	struct mock_request_line lines[GPIO_V2_LINES_MAX];
+};
+
+enum {
+	MOCK_FD_CHIP,
+	MOCK_FD_REQUEST,
+};
+
+struct mock_fd {
+	int fd;
+	int type;
+	union {
+		struct gpiod_mock_chip *chip;
+		struct mock_request *request;
+	};
+};
+
+static pthread_mutex_t mock_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct gpiod_mock_chip **mock_chips;
+static size_t num_mock_chips;
+static unsigned int next_mock_id;
+static struct mock_fd *mock_fds;
+static size_t mock_fds_capacity;
+/* Read without the lock so that programs using no mocks pay nothing. */
+static size_t num_mock_fds;
+
+static struct gpiod_mock_chip *find_chip(const char *path)
+{
+	size_t i;
+
+	for (i = 0; i < num_mock_chips; i++) {
+		if (strcmp(mock_chips[i]->path, path) == 0)
+			return mock_chips[i];
+	}
+
+	return NULL;
+}
+
+static struct mock_fd *find_fd(int fd)
+{
+	size_t i;
+
+	for (i = 0; i < num_mock_fds; i++) {
+		if (mock_fds[i].fd == fd)
+			return &mock_fds[i];
+	}
+
+	return NULL;
+}
+
+static struct mock_fd *add_fd(int fd, int type)
+{
+	struct mock_fd *fds;
+	size_t capacity;
+
+	if (num_mock_fds == mock_fds_capacity) {
+		capacity = mock_fds_capacity ? mock_fds_capacity * 2 : 8;
+		fds = gpiod_realloc(mock_fds,
+				    mock_fds_capacity * sizeof(*fds),
+				    capacity * sizeof(*fds));
+		if (!fds)
+			return NULL;
+
+		mock_fds = fds;
+		mock_fds_capacity = capacity;
+	}
+
+	mock_fds[num_mock_fds].fd = fd;
+	mock_fds[num_mock_fds].type = type;
+	__atomic_store_n(&num_mock_fds, num_mock_fds + 1, __ATOMIC_RELAXED);
+
+	return &mock_fds[num_mock_fds - 1];
+}
+
+static void remove_fd(struct mock_fd *entry)
+{
+	*entry = mock_fds[num_mock_fds - 1];
+	__atomic_store_n(&num_mock_fds, num_mock_fds - 1, __ATOMIC_RELAXED);
+}
+
+static bool have_mock_fds(void)
+{
+	return __atomic_load_n(&num_mock_fds, __ATOMIC_RELAXED) != 0;
+}
+
+static void chip_unref(struct gpiod_mock_chip *chip)
+{
+	if (--chip->refcount)
+		return;
+
+	gpiod_free(chip->lines);
+	gpiod_free(chip);
+}
+
+static bool line_level(struct mock_line *line, uint64_t now)
+{
+	if (line->driven || !line->period_ns || now < line->epoch_ns)
+		return line->value;
+
+	return line->value ^ (((now - line->epoch_ns) / line->period_ns) & 1);
+}
+
+/* Restarts the toggles of the line from its current level. */
+static void reschedule_line(struct mock_line *line, uint64_t now)
+{
+	line->value = line_level(line, now);
+	line->epoch_ns = now;
+	line->generation++;
+}
+
+static bool edge_wanted(struct mock_request_line *rline,
+			struct mock_line *line, uint64_t toggle)
+{
+	bool rising = line->value ^ (toggle & 1);
+
+	if (rline->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+		rising = !rising;
+
+	return rline->flags & (rising ? GPIO_V2_LINE_FLAG_EDGE_RISING :
+					GPIO_V2_LINE_FLAG_EDGE_FALLING);
+}
+
+static bool line_has_events(struct mock_request_line *rline,
+			    struct mock_line *line)
+{
+	return !line->driven && line->period_ns &&
+	       (rline->flags & (GPIO_V2_LINE_FLAG_EDGE_RISING |
+				GPIO_V2_LINE_FLAG_EDGE_FALLING));
+}
+
+/*
+ * Returns the time of the next event of the line, toggles not reported due
+ * to the edge detection settings are skipped.
+ */
+static uint64_t next_event_time(struct mock_request_line *rline,
+				struct mock_line *line, uint64_t now)
+{
+	if (rline->generation != line->generation) {
+		rline->generation = line->generation;
+		rline->next_toggle = now >= line->epoch_ns ?
+			(now - line->epoch_ns) / line->period_ns + 1 : 1;
+	}
+
+	if (!edge_wanted(rline, line, rline->next_toggle))
+		rline->next_toggle++;
+
+	return line->epoch_ns + rline->next_toggle * line->period_ns;
+}
+
+/*
+ * The kernel drops the events which don't fit into the fifo. Approximate it
+ * per line by giving up the events older than a fifo's worth of them.
+ */
+static void drop_stale_events(struct mock_request *request,
+			      struct mock_request_line *rline,
+			      struct mock_line *line, uint64_t now)
+{
+	uint64_t ts, behind, step;
+
+	ts = next_event_time(rline, line, now);
+	if (ts > now)
+		return;
+
+	step = (rline->flags & GPIO_V2_LINE_FLAG_EDGE_RISING) &&
+	       (rline->flags & GPIO_V2_LINE_FLAG_EDGE_FALLING) ? 1 : 2;
+	behind = (now - ts) / (line->period_ns * step);
+	if (behind < request->event_buffer_size)
+		return;
+
+	behind -= request->event_buffer_size - 1;
+	rline->next_toggle += behind * step;
+	rline->line_seqno += behind;
+	request->seqno += behind;
+}
+
+static void arm_timer(struct mock_request *request, uint64_t now)
+{
+	struct mock_request_line *rline;
+	struct itimerspec its;
+	struct mock_line *line;
+	uint64_t ts, next = 0;
+	unsigned int i;
+
+	for (i = 0; i < request->num_lines; i++) {
+		rline = &request->lines[i];
+		line = &request->chip->lines[rline->offset];
+
+		if (!line_has_events(rline, line))
+			continue;
+
+		ts = next_event_time(rline, line, now);
+		if (!next || ts < next)
+			next = ts;
+	}
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = next / NSEC_PER_SEC;
+	its.it_value.tv_nsec = next % NSEC_PER_SEC;
+
+	timerfd_settime(request->fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void drain_timer(int fd)
+{
+	struct pollfd pfd;
+	uint64_t expirations;
+	ssize_t rd GPIOD_UNUSED;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+
+	if (poll(&pfd, 1, 0) == 1)
+		rd = read(fd, &expirations, sizeof(expirations));
+}
+
+static uint64_t realtime_offset(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec -
+	       gpiod_stats_now();
+}
+
+static size_t read_events(struct mock_request *request,
+			  struct gpio_v2_line_event *events, size_t max_events)
+{
+	struct mock_request_line *rline, *best;
+	uint64_t now, ts, best_ts = 0;
+	struct gpio_v2_line_event *event;
+	struct mock_line *line;
+	size_t num_events = 0;
+	unsigned int i;
+	bool rising;
+
+	now = gpiod_stats_now();
+
+	for (i = 0; i < request->num_lines; i++) {
+		rline = &request->lines[i];
+		line = &request->chip->lines[rline->offset];
+
+		if (line_has_events(rline, line))
+			drop_stale_events(request, rline, line, now);
+	}
+
+	while (num_events < max_events) {
+		best = NULL;
+
+		for (i = 0; i < request->num_lines; i++) {
+			rline = &request->lines[i];
+			line = &request->chip->lines[rline->offset];
+
+			if (!line_has_events(rline, line))
+				continue;
+
+			ts = next_event_time(rline, line, now);
+			if (ts <= now && (!best || ts < best_ts)) {
+				best = rline;
+				best_ts = ts;
+			}
+		}
+
+		if (!best)
+			break;
+
+		line = &request->chip->lines[best->offset];
+		rising = line->value ^ (best->next_toggle & 1);
+		if (best->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+			rising = !rising;
+
+		event = &events[num_events++];
+		memset(event, 0, sizeof(*event));
+		event->timestamp_ns = best_ts;
+		if (best->flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME)
+			event->timestamp_ns += realtime_offset();
+		event->id = rising ? GPIO_V2_LINE_EVENT_RISING_EDGE :
+				     GPIO_V2_LINE_EVENT_FALLING_EDGE;
+		event->offset = best->offset;
+		event->seqno = ++request->seqno;
+		event->line_seqno = ++best->line_seqno;
+
+		best->next_toggle++;
+	}
+
+	arm_timer(request, now);
+
+	return num_events;
+}
+
+static uint64_t line_flags(struct gpio_v2_line_config *config,
+			   unsigned int index)
+{
+	struct gpio_v2_line_config_attribute *attr;
+	uint64_t flags = config->flags;
+	unsigned int i;
+
+	for (i = 0; i < config->num_attrs && i < GPIO_V2_LINE_NUM_ATTRS_MAX;
+	     i++) {
+		attr = &config->attrs[i];
+
+		if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_FLAGS &&
+		    (attr->mask & GPIOD_BIT(index)))
+			flags = attr->attr.flags;
+	}
+
+	return flags;
+}
+
+static int output_value(struct gpio_v2_line_config *config,
+			unsigned int index)
+{
+	struct gpio_v2_line_config_attribute *attr;
+	unsigned int i;
+
+	for (i = 0; i < config->num_attrs && i < GPIO_V2_LINE_NUM_ATTRS_MAX;
+	     i++) {
+		attr = &config->attrs[i];
+
+		if (attr->attr.id == GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES &&
+		    (attr->mask & GPIOD_BIT(index)))
+			return !!(attr->attr.values & GPIOD_BIT(index));
+	}
+
+	return 0;
+}
+
+static int check_config(struct gpio_v2_line_config *config,
+			unsigned int num_lines)
+{
+	uint64_t flags;
+	unsigned int i;
+
+	if (config->num_attrs > GPIO_V2_LINE_NUM_ATTRS_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < num_lines; i++) {
+		flags = line_flags(config, i);
+
+		if (flags & GPIO_V2_LINE_FLAG_EVENT_CLOCK_HTE) {
+			errno = EOPNOTSUPP;
+			return -1;
+		}
+
+		if (((flags & GPIO_V2_LINE_FLAG_INPUT) &&
+		     (flags & GPIO_V2_LINE_FLAG_OUTPUT)) ||
+		    ((flags & (GPIO_V2_LINE_FLAG_EDGE_RISING |
+			       GPIO_V2_LINE_FLAG_EDGE_FALLING)) &&
+		     !(flags & GPIO_V2_LINE_FLAG_INPUT))) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void apply_config(struct mock_request *request,
+			 struct gpio_v2_line_config *config, uint64_t now)
+{
+	struct mock_request_line *rline;
+	struct mock_line *line;
+	unsigned int i;
+	bool value;
+
+	for (i = 0; i < request->num_lines; i++) {
+		rline = &request->lines[i];
+		line = &request->chip->lines[rline->offset];
+
+		rline->flags = line_flags(config, i);
+
+		if (rline->flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+			value = output_value(config, i);
+			if (rline->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+				value = !value;
+
+			line->value = value;
+			line->driven = true;
+		} else if (line->driven) {
+			line->driven = false;
+			reschedule_line(line, now);
+		}
+
+		/* Events of the past don't show up after reconfiguring. */
+		rline->generation = line->generation - 1;
+	}
+}
+
+static void release_request(struct mock_request *request)
+{
+	struct mock_line *line;
+	uint64_t now;
+	unsigned int i;
+
+	now = gpiod_stats_now();
+
+	for (i = 0; i < request->num_lines; i++) {
+		line = &request->chip->lines[request->lines[i].offset];
+
+		line->request = NULL;
+		if (line->driven) {
+			line->driven = false;
+			reschedule_line(line, now);
+		}
+	}
+
+	chip_unref(request->chip);
+	gpiod_free(request);
+}
+
+static int get_line(struct gpiod_mock_chip *chip,
+		    struct gpio_v2_line_request *uapi_req)
+{
+	struct mock_request *request;
+	struct mock_line *line;
+	struct mock_fd *entry;
+	unsigned int i, j;
+	uint64_t now;
+	int fd;
+
+	if (!uapi_req->num_lines || uapi_req->num_lines > GPIO_V2_LINES_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (check_config(&uapi_req->config, uapi_req->num_lines))
+		return -1;
+
+	for (i = 0; i < uapi_req->num_lines; i++) {
+		if (uapi_req->offsets[i] >= chip->num_lines) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		for (j = 0; j < i; j++) {
+			if (uapi_req->offsets[j] == uapi_req->offsets[i]) {
+				errno = EINVAL;
+				return -1;
+			}
+		}
+
+		if (chip->lines[uapi_req->offsets[i]].request) {
+			errno = EBUSY;
+			return -1;
+		}
+	}
+
+	request = gpiod_malloc(sizeof(*request));
+	if (!request)
+		return -1;
+
+	memset(request, 0, sizeof(*request));
+
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (fd < 0)
+		goto err_free_request;
+
+	entry = add_fd(fd, MOCK_FD_REQUEST);
+	if (!entry)
+		goto err_close_fd;
+
+	entry->request = request;
+	request->chip = chip;
+	request->fd = fd;
+	request->num_lines = uapi_req->num_lines;
+	request->event_buffer_size = uapi_req->event_buffer_size;
+	if (!request->event_buffer_size)
+		request->event_buffer_size = request->num_lines *
+					     EVENTS_PER_LINE;
+	memcpy(request->consumer, uapi_req->consumer,
+	       sizeof(request->consumer) - 1);
+
+	for (i = 0; i < request->num_lines; i++) {
+		line = &chip->lines[uapi_req->offsets[i]];
+
+		line->request = request;
+		line->request_index = i;
+		request->lines[i].offset = uapi_req->offsets[i];
+	}
+
+	chip->refcount++;
+
+	now = gpiod_stats_now();
+	apply_config(request, &uapi_req->config, now);
+	arm_timer(request, now);
+
+	uapi_req->fd = fd;
+
+	return 0;
+
+err_close_fd:
+	close(fd);
+err_free_request:
+	gpiod_free(request);
+
+	return -1;
+}
+
+static int get_line_info(struct gpiod_mock_chip *chip,
+			 struct gpio_v2_line_info *info)
+{
+	struct mock_request *request;
+	struct mock_line *line;
+	unsigned int offset;
+
+	offset = info->offset;
+	if (offset >= chip->num_lines) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memset(info, 0, sizeof(*info));
+	info->offset = offset;
+
+	line = &chip->lines[offset];
+	request = line->request;
+	if (!request) {
+		info->flags = GPIO_V2_LINE_FLAG_INPUT;
+		return 0;
+	}
+
+	info->flags = request->lines[line->request_index].flags |
+		      GPIO_V2_LINE_FLAG_USED;
+	if (!(info->flags & GPIO_V2_LINE_FLAG_OUTPUT))
+		info->flags |= GPIO_V2_LINE_FLAG_INPUT;
+	memcpy(info->consumer, request->consumer, sizeof(info->consumer));
+
+	return 0;
+}
+
+static int chip_ioctl(struct gpiod_mock_chip *chip, unsigned long cmd,
+		      void *arg)
+{
+	struct gpiochip_info *info;
+
+	/* Like the kernel, only look at the lower 32 bits of the command. */
+	switch ((unsigned int)cmd) {
+	case GPIO_GET_CHIPINFO_IOCTL:
+		info = arg;
+		memset(info, 0, sizeof(*info));
+		snprintf(info->name, sizeof(info->name), MOCK_NAME_FMT,
+			 chip->id);
+		strcpy(info->label, MOCK_LABEL);
+		info->lines = chip->num_lines;
+		return 0;
+	case GPIO_V2_GET_LINEINFO_IOCTL:
+		return get_line_info(chip, arg);
+	case GPIO_V2_GET_LINE_IOCTL:
+		return get_line(chip, arg);
+	case GPIO_V2_GET_LINEINFO_WATCH_IOCTL:
+	case GPIO_GET_LINEINFO_UNWATCH_IOCTL:
+		errno = ENOTSUP;
+		return -1;
+	default:
+		errno = ENOTTY;
+		return -1;
+	}
+}
+
+static int get_values(struct mock_request *request,
+		      struct gpio_v2_line_values *values)
+{
+	struct mock_request_line *rline;
+	uint64_t now, bits = 0;
+	unsigned int i;
+	bool value;
+
+	now = gpiod_stats_now();
+
+	for (i = 0; i < request->num_lines; i++) {
+		if (!(values->mask & GPIOD_BIT(i)))
+			continue;
+
+		rline = &request->lines[i];
+		value = line_level(&request->chip->lines[rline->offset], now);
+		if (rline->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+			value = !value;
+
+		if (value)
+			bits |= GPIOD_BIT(i);
+	}
+
+	values->bits = bits;
+
+	return 0;
+}
+
+static int set_values(struct mock_request *request,
+		      struct gpio_v2_line_values *values)
+{
+	struct mock_request_line *rline;
+	unsigned int i;
+	bool value;
+
+	for (i = 0; i < request->num_lines; i++) {
+		if ((values->mask & GPIOD_BIT(i)) &&
+		    !(request->lines[i].flags & GPIO_V2_LINE_FLAG_OUTPUT)) {
+			errno = EPERM;
+			return -1;
+		}
+	}
+
+	for (i = 0; i < request->num_lines; i++) {
+		if (!(values->mask & GPIOD_BIT(i)))
+			continue;
+
+		rline = &request->lines[i];
+		value = !!(values->bits & GPIOD_BIT(i));
+		if (rline->flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW)
+			value = !value;
+
+		request->chip->lines[rline->offset].value = value;
+	}
+
+	return 0;
+}
+
+static int request_ioctl(struct mock_request *request, unsigned long cmd,
+			 void *arg)
+{
+	uint64_t now;
+
+	switch ((unsigned int)cmd) {
+	case GPIO_V2_LINE_GET_VALUES_IOCTL:
+		return get_values(request, arg);
+	case GPIO_V2_LINE_SET_VALUES_IOCTL:
+		return set_values(request, arg);
+	case GPIO_V2_LINE_SET_CONFIG_IOCTL:
+		if (check_config(arg, request->num_lines))
+			return -1;
+
+		now = gpiod_stats_now();
+		apply_config(request, arg, now);
+		arm_timer(request, now);
+		return 0;
+	default:
+		errno = ENOTTY;
+		return -1;
+	}
+}
+
+bool gpiod_mock_has_chip(const char *path)
+{
+	bool found;
+
+	pthread_mutex_lock(&mock_lock);
+	found = !!find_chip(path);
+	pthread_mutex_unlock(&mock_lock);
+
+	return found;
+}
+
+bool gpiod_mock_owns_fd(int fd)
+{
+	bool found;
+
+	if (!have_mock_fds())
+		return false;
+
+	pthread_mutex_lock(&mock_lock);
+	found = !!find_fd(fd);
+	pthread_mutex_unlock(&mock_lock);
+
+	return found;
+}
+
+int gpiod_mock_open(const char *path, int flags)
+{
+	struct gpiod_mock_chip *chip;
+	struct mock_fd *entry;
+	int fd;
+
+	pthread_mutex_lock(&mock_lock);
+
+	chip = find_chip(path);
+	if (!chip) {
+		pthread_mutex_unlock(&mock_lock);
+		return open(path, flags);
+	}
+
+	fd = eventfd(0, EFD_CLOEXEC | (flags & O_NONBLOCK ? EFD_NONBLOCK : 0));
+	if (fd < 0)
+		goto out_unlock;
+
+	entry = add_fd(fd, MOCK_FD_CHIP);
+	if (!entry) {
+		close(fd);
+		fd = -1;
+		goto out_unlock;
+	}
+
+	entry->chip = chip;
+	chip->refcount++;
+
+out_unlock:
+	pthread_mutex_unlock(&mock_lock);
+
+	return fd;
+}
+
+int gpiod_mock_close(int fd)
+{
+	struct mock_fd *entry;
+
+	if (!have_mock_fds())
+		return close(fd);
+
+	pthread_mutex_lock(&mock_lock);
+
+	entry = find_fd(fd);
+	if (entry) {
+		if (entry->type == MOCK_FD_CHIP)
+			chip_unref(entry->chip);
+		else
+			release_request(entry->request);
+
+		remove_fd(entry);
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return close(fd);
+}
+
+int gpiod_mock_ioctl(int fd, unsigned long cmd, void *arg)
+{
+	struct mock_fd *entry;
+	int ret;
+
+	if (!have_mock_fds())
+		return ioctl(fd, cmd, arg);
+
+	pthread_mutex_lock(&mock_lock);
+
+	entry = find_fd(fd);
+	if (!entry) {
+		pthread_mutex_unlock(&mock_lock);
+		return ioctl(fd, cmd, arg);
+	}
+
+	if (entry->type == MOCK_FD_CHIP)
+		ret = chip_ioctl(entry->chip, cmd, arg);
+	else
+		ret = request_ioctl(entry->request, cmd, arg);
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+ssize_t gpiod_mock_read(int fd, void *buf, size_t count)
+{
+	size_t max_events, num_events;
+	struct mock_fd *entry;
+	struct pollfd pfd;
+	int flags;
+
+	if (!have_mock_fds())
+		return read(fd, buf, count);
+
+	pthread_mutex_lock(&mock_lock);
+
+	entry = find_fd(fd);
+	if (!entry || entry->type != MOCK_FD_REQUEST) {
+		pthread_mutex_unlock(&mock_lock);
+		return read(fd, buf, count);
+	}
+
+	max_events = count / sizeof(struct gpio_v2_line_event);
+	if (!max_events) {
+		pthread_mutex_unlock(&mock_lock);
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (;;) {
+		drain_timer(fd);
+
+		num_events = read_events(entry->request, buf, max_events);
+		pthread_mutex_unlock(&mock_lock);
+		if (num_events)
+			break;
+
+		flags = fcntl(fd, F_GETFL);
+		if (flags < 0)
+			return -1;
+
+		if (flags & O_NONBLOCK) {
+			errno = EAGAIN;
+			return -1;
+		}
+
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, -1) < 0)
+			return -1;
+
+		pthread_mutex_lock(&mock_lock);
+
+		/* Closed by another thread while we were waiting. */
+		entry = find_fd(fd);
+		if (!entry || entry->type != MOCK_FD_REQUEST) {
+			pthread_mutex_unlock(&mock_lock);
+			errno = EBADF;
+			return -1;
+		}
+	}
+
+	return num_events * sizeof(struct gpio_v2_line_event);
+}
+
+static struct mock_line *get_mock_line(struct gpiod_mock_chip *chip,
+				       unsigned int offset)
+{
+	if (offset >= chip->num_lines) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return &chip->lines[offset];
+}
+
+GPIOD_API struct gpiod_mock_chip *gpiod_mock_chip_new(size_t num_lines)
+{
+	struct gpiod_mock_chip *chip, **chips;
+
+	if (!num_lines || num_lines > UINT32_MAX) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	chip = gpiod_malloc(sizeof(*chip));
+	if (!chip)
+		return NULL;
+
+	memset(chip, 0, sizeof(*chip));
+
+	chip->lines = gpiod_calloc(num_lines, sizeof(*chip->lines));
+	if (!chip->lines)
+		goto err_free_chip;
+
+	pthread_mutex_lock(&mock_lock);
+
+	chips = gpiod_realloc(mock_chips, num_mock_chips * sizeof(*chips),
+			      (num_mock_chips + 1) * sizeof(*chips));
+	if (!chips) {
+		pthread_mutex_unlock(&mock_lock);
+		goto err_free_lines;
+	}
+
+	chip->id = next_mock_id++;
+	snprintf(chip->path, sizeof(chip->path), MOCK_PATH_FMT, chip->id);
+	chip->num_lines = num_lines;
+	chip->refcount = 1;
+
+	mock_chips = chips;
+	mock_chips[num_mock_chips++] = chip;
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return chip;
+
+err_free_lines:
+	gpiod_free(chip->lines);
+err_free_chip:
+	gpiod_free(chip);
+
+	return NULL;
+}
+
+GPIOD_API void gpiod_mock_chip_free(struct gpiod_mock_chip *chip)
+{
+	size_t i;
+
+	if (!chip)
+		return;
+
+	pthread_mutex_lock(&mock_lock);
+
+	for (i = 0; i < num_mock_chips; i++) {
+		if (mock_chips[i] == chip) {
+			mock_chips[i] = mock_chips[--num_mock_chips];
+			break;
+		}
+	}
+
+	chip_unref(chip);
+
+	pthread_mutex_unlock(&mock_lock);
+}
+
+GPIOD_API const char *gpiod_mock_chip_get_path(struct gpiod_mock_chip *chip)
+{
+	return chip->path;
+}
+
+GPIOD_API int gpiod_mock_chip_set_value(struct gpiod_mock_chip *chip,
+					unsigned int offset, int value)
+{
+	struct mock_line *line;
+	uint64_t now;
+	int ret = -1;
+
+	if (value != 0 && value != 1) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&mock_lock);
+
+	line = get_mock_line(chip, offset);
+	if (!line)
+		goto out_unlock;
+
+	if (line->driven) {
+		errno = EBUSY;
+		goto out_unlock;
+	}
+
+	now = gpiod_stats_now();
+	reschedule_line(line, now);
+	line->value = value;
+	if (line->request)
+		arm_timer(line->request, now);
+
+	ret = 0;
+
+out_unlock:
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+GPIOD_API int gpiod_mock_chip_get_value(struct gpiod_mock_chip *chip,
+					unsigned int offset)
+{
+	struct mock_line *line;
+	int ret = -1;
+
+	pthread_mutex_lock(&mock_lock);
+
+	line = get_mock_line(chip, offset);
+	if (line)
+		ret = line_level(line, gpiod_stats_now());
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+GPIOD_API int gpiod_mock_chip_set_event_rate(struct gpiod_mock_chip *chip,
+					     unsigned int offset,
+					     unsigned int rate_hz)
+{
+	struct mock_line *line;
+	uint64_t now;
+	int ret = -1;
+
+	if (rate_hz > NSEC_PER_SEC) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&mock_lock);
+
+	line = get_mock_line(chip, offset);
+	if (!line)
+		goto out_unlock;
+
+	now = gpiod_stats_now();
+	reschedule_line(line, now);
+	line->period_ns = rate_hz ? NSEC_PER_SEC / rate_hz : 0;
+	if (line->request)
+		arm_timer(line->request, now);
+
+	ret = 0;
+
+out_unlock:
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+#else /* GPIOD_WITH_MOCK */
+
+GPIOD_API struct gpiod_mock_chip *
+gpiod_mock_chip_new(size_t num_lines GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return NULL;
+}
+
+GPIOD_API void gpiod_mock_chip_free(struct gpiod_mock_chip *chip GPIOD_UNUSED)
+{
+
+}
+
+GPIOD_API const char *
+gpiod_mock_chip_get_path(struct gpiod_mock_chip *chip GPIOD_UNUSED)
+{
+	return NULL;
+}
+
+GPIOD_API int
+gpiod_mock_chip_set_value(struct gpiod_mock_chip *chip GPIOD_UNUSED,
+			  unsigned int offset GPIOD_UNUSED,
+			  int value GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+GPIOD_API int
+gpiod_mock_chip_get_value(struct gpiod_mock_chip *chip GPIOD_UNUSED,
+			  unsigned int offset GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+GPIOD_API int
+gpiod_mock_chip_set_event_rate(struct gpiod_mock_chip *chip GPIOD_UNUSED,
+			       unsigned int offset GPIOD_UNUSED,
+			       unsigned int rate_hz GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+#endif /* GPIOD_WITH_MOCK */
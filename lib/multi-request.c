@@ -0,0 +1,741 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+enum multi_op {
+	MULTI_OP_GET = 1,
+	MULTI_OP_SET,
+};
+
+struct member {
+	struct gpiod_multi_request *parent;
+	struct gpiod_line_request *request;
+	/* Staged operation. */
+	uint64_t mask;
+	uint64_t values;
+	uint64_t start_ns;
+	uint64_t end_ns;
+	int ret;
+	int error;
+	pthread_t thread;
+	unsigned long generation;
+};
+
+struct multi_line {
+	unsigned int member;
+	unsigned int offset;
+	unsigned int bit;
+	char *name;
+};
+
+struct gpiod_multi_request {
+	struct member *members;
+	size_t num_members;
+	struct multi_line *lines;
+	size_t num_lines;
+	enum multi_op op;
+	uint64_t last_skew_ns;
+	/*
+	 * Workers wait for the generation to change and are all woken at once.
+	 * This is a barrier but unlike pthread_barrier_t it can be torn down
+	 * when only some of the workers could be started.
+	 */
+	pthread_mutex_t lock;
+	pthread_cond_t start_cond;
+	pthread_cond_t done_cond;
+	unsigned long generation;
+	size_t num_pending;
+	size_t num_workers;
+	bool stop;
+};
+
+struct gpiod_multi_request_snapshot {
+	size_t max_samples;
+	size_t num_samples;
+	uint64_t first_ns;
+	uint64_t last_ns;
+	struct gpiod_multi_request_sample samples[];
+};
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+GPIOD_API struct gpiod_multi_request *gpiod_multi_request_new(void)
+{
+	struct gpiod_multi_request *mreq;
+
+	mreq = gpiod_malloc(sizeof(*mreq));
+	if (!mreq)
+		return NULL;
+
+	memset(mreq, 0, sizeof(*mreq));
+
+	pthread_mutex_init(&mreq->lock, NULL);
+	pthread_cond_init(&mreq->start_cond, NULL);
+	pthread_cond_init(&mreq->done_cond, NULL);
+
+	return mreq;
+}
+
+GPIOD_API void gpiod_multi_request_free(struct gpiod_multi_request *mreq)
+{
+	size_t i;
+
+	if (!mreq)
+		return;
+
+	if (mreq->num_workers)
+		gpiod_multi_request_stop_workers(mreq);
+
+	for (i = 0; i < mreq->num_lines; i++)
+		gpiod_free(mreq->lines[i].name);
+
+	pthread_cond_destroy(&mreq->done_cond);
+	pthread_cond_destroy(&mreq->start_cond);
+	pthread_mutex_destroy(&mreq->lock);
+	gpiod_free(mreq->lines);
+	gpiod_free(mreq->members);
+	gpiod_free(mreq);
+}
+
+static int add_line(struct gpiod_multi_request *mreq, struct gpiod_chip *chip,
+		    unsigned int member, unsigned int offset, unsigned int bit)
+{
+	struct multi_line *line = &mreq->lines[mreq->num_lines];
+	struct gpiod_line_info *info;
+	const char *name;
+
+	line->member = member;
+	line->offset = offset;
+	line->bit = bit;
+	line->name = NULL;
+
+	if (chip) {
+		info = gpiod_chip_get_line_info(chip, offset);
+		if (!info)
+			return -1;
+
+		name = gpiod_line_info_get_name(info);
+		if (name) {
+			line->name = gpiod_strdup(name);
+			if (!line->name) {
+				gpiod_line_info_free(info);
+				return -1;
+			}
+		}
+
+		gpiod_line_info_free(info);
+	}
+
+	mreq->num_lines++;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_multi_request_add_request(struct gpiod_multi_request *mreq,
+					      struct gpiod_chip *chip,
+					      struct gpiod_line_request *request)
+{
+	unsigned int offsets[GPIO_V2_LINES_MAX];
+	size_t num_lines, num_old_lines, i;
+	struct multi_line *lines;
+	struct member *members;
+	int ret;
+
+	assert(mreq);
+
+	if (mreq->num_workers) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!request) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < mreq->num_members; i++) {
+		if (mreq->members[i].request == request) {
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	num_lines = gpiod_line_request_get_requested_offsets(request, offsets,
+							     GPIO_V2_LINES_MAX);
+
+	members = gpiod_realloc(mreq->members,
+				sizeof(*members) * mreq->num_members,
+				sizeof(*members) * (mreq->num_members + 1));
+	if (!members)
+		return -1;
+
+	mreq->members = members;
+
+	lines = gpiod_realloc(mreq->lines, sizeof(*lines) * mreq->num_lines,
+			      sizeof(*lines) * (mreq->num_lines + num_lines));
+	if (!lines)
+		return -1;
+
+	mreq->lines = lines;
+	num_old_lines = mreq->num_lines;
+
+	for (i = 0; i < num_lines; i++) {
+		ret = add_line(mreq, chip, mreq->num_members, offsets[i], i);
+		if (ret)
+			goto err_drop_lines;
+	}
+
+	memset(&members[mreq->num_members], 0, sizeof(*members));
+	members[mreq->num_members].parent = mreq;
+	members[mreq->num_members].request = request;
+
+	return mreq->num_members++;
+
+err_drop_lines:
+	while (mreq->num_lines > num_old_lines)
+		gpiod_free(mreq->lines[--mreq->num_lines].name);
+
+	return -1;
+}
+
+GPIOD_API size_t
+gpiod_multi_request_get_num_members(struct gpiod_multi_request *mreq)
+{
+	assert(mreq);
+
+	return mreq->num_members;
+}
+
+GPIOD_API struct gpiod_line_request *
+gpiod_multi_request_get_member(struct gpiod_multi_request *mreq,
+			       unsigned int member)
+{
+	assert(mreq);
+
+	if (member >= mreq->num_members) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return mreq->members[member].request;
+}
+
+GPIOD_API size_t
+gpiod_multi_request_get_num_lines(struct gpiod_multi_request *mreq)
+{
+	assert(mreq);
+
+	return mreq->num_lines;
+}
+
+GPIOD_API int gpiod_multi_request_find_line(struct gpiod_multi_request *mreq,
+					    unsigned int member,
+					    unsigned int offset)
+{
+	size_t i;
+
+	assert(mreq);
+
+	for (i = 0; i < mreq->num_lines; i++) {
+		if (mreq->lines[i].member == member &&
+		    mreq->lines[i].offset == offset)
+			return i;
+	}
+
+	errno = EINVAL;
+	return -1;
+}
+
+GPIOD_API int
+gpiod_multi_request_find_line_by_name(struct gpiod_multi_request *mreq,
+				      const char *name)
+{
+	size_t i;
+
+	assert(mreq);
+
+	if (!name) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < mreq->num_lines; i++) {
+		if (mreq->lines[i].name && strcmp(mreq->lines[i].name, name) == 0)
+			return i;
+	}
+
+	errno = ENOENT;
+	return -1;
+}
+
+static void run_member(struct member *member, enum multi_op op)
+{
+	member->start_ns = monotonic_ns();
+
+	if (op == MULTI_OP_SET)
+		member->ret = gpiod_line_request_set_values_mask(
+				member->request, member->mask, member->values);
+	else
+		member->ret = gpiod_line_request_get_values_mask(
+				member->request, member->mask, &member->values);
+
+	member->error = member->ret ? errno : 0;
+	member->end_ns = monotonic_ns();
+}
+
+static void *worker_func(void *data)
+{
+	struct member *member = data;
+	struct gpiod_multi_request *mreq = member->parent;
+
+	for (;;) {
+		pthread_mutex_lock(&mreq->lock);
+
+		while (member->generation == mreq->generation && !mreq->stop)
+			pthread_cond_wait(&mreq->start_cond, &mreq->lock);
+
+		if (mreq->stop) {
+			pthread_mutex_unlock(&mreq->lock);
+			break;
+		}
+
+		member->generation = mreq->generation;
+		pthread_mutex_unlock(&mreq->lock);
+
+		if (member->mask)
+			run_member(member, mreq->op);
+
+		pthread_mutex_lock(&mreq->lock);
+		if (--mreq->num_pending == 0)
+			pthread_cond_signal(&mreq->done_cond);
+		pthread_mutex_unlock(&mreq->lock);
+	}
+
+	return NULL;
+}
+
+static void join_workers(struct gpiod_multi_request *mreq)
+{
+	size_t i;
+
+	pthread_mutex_lock(&mreq->lock);
+	mreq->stop = true;
+	pthread_cond_broadcast(&mreq->start_cond);
+	pthread_mutex_unlock(&mreq->lock);
+
+	for (i = 0; i < mreq->num_workers; i++)
+		pthread_join(mreq->members[i].thread, NULL);
+
+	mreq->num_workers = 0;
+}
+
+GPIOD_API int gpiod_multi_request_start_workers(struct gpiod_multi_request *mreq,
+						const int *cpus)
+{
+	pthread_attr_t attr;
+	cpu_set_t cpuset;
+	size_t i;
+	int ret;
+
+	assert(mreq);
+
+	if (mreq->num_workers) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!mreq->num_members) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	mreq->stop = false;
+
+	for (i = 0; i < mreq->num_members; i++) {
+		mreq->members[i].generation = mreq->generation;
+
+		pthread_attr_init(&attr);
+
+		if (cpus && cpus[i] >= 0) {
+			CPU_ZERO(&cpuset);
+			CPU_SET(cpus[i], &cpuset);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpuset),
+						    &cpuset);
+		}
+
+		ret = pthread_create(&mreq->members[i].thread, &attr,
+				     worker_func, &mreq->members[i]);
+		pthread_attr_destroy(&attr);
+		if (ret) {
+			join_workers(mreq);
+			errno = ret;
+			return -1;
+		}
+
+		mreq->num_workers++;
+	}
+
+	return 0;
+}
+
+GPIOD_API int gpiod_multi_request_stop_workers(struct gpiod_multi_request *mreq)
+{
+	assert(mreq);
+
+	if (!mreq->num_workers) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	join_workers(mreq);
+
+	return 0;
+}
+
+GPIOD_API bool
+gpiod_multi_request_workers_running(struct gpiod_multi_request *mreq)
+{
+	assert(mreq);
+
+	return mreq->num_workers;
+}
+
+static int dispatch(struct gpiod_multi_request *mreq, enum multi_op op)
+{
+	uint64_t first_ns = UINT64_MAX, last_ns = 0;
+	struct member *member;
+	size_t i;
+
+	mreq->op = op;
+
+	if (mreq->num_workers) {
+		pthread_mutex_lock(&mreq->lock);
+		mreq->num_pending = mreq->num_workers;
+		mreq->generation++;
+		pthread_cond_broadcast(&mreq->start_cond);
+
+		while (mreq->num_pending)
+			pthread_cond_wait(&mreq->done_cond, &mreq->lock);
+		pthread_mutex_unlock(&mreq->lock);
+	} else {
+		for (i = 0; i < mreq->num_members; i++) {
+			if (mreq->members[i].mask)
+				run_member(&mreq->members[i], op);
+		}
+	}
+
+	for (i = 0; i < mreq->num_members; i++) {
+		member = &mreq->members[i];
+		if (!member->mask)
+			continue;
+
+		first_ns = MIN(first_ns, member->start_ns);
+		last_ns = MAX(last_ns, member->start_ns);
+	}
+
+	mreq->last_skew_ns = last_ns >= first_ns ? last_ns - first_ns : 0;
+
+	for (i = 0; i < mreq->num_members; i++) {
+		member = &mreq->members[i];
+		if (member->mask && member->ret) {
+			errno = member->error;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void clear_staged(struct gpiod_multi_request *mreq)
+{
+	size_t i;
+
+	for (i = 0; i < mreq->num_members; i++) {
+		mreq->members[i].mask = 0;
+		mreq->members[i].values = 0;
+	}
+}
+
+static void stage_line(struct gpiod_multi_request *mreq, unsigned int index,
+		       enum gpiod_line_value value)
+{
+	struct multi_line *line = &mreq->lines[index];
+	struct member *member = &mreq->members[line->member];
+
+	member->mask |= 1ULL << line->bit;
+	if (value == GPIOD_LINE_VALUE_ACTIVE)
+		member->values |= 1ULL << line->bit;
+}
+
+static int stage_lines(struct gpiod_multi_request *mreq, size_t num_lines,
+		       const unsigned int *lines,
+		       const enum gpiod_line_value *values)
+{
+	size_t i;
+
+	clear_staged(mreq);
+
+	for (i = 0; i < num_lines; i++) {
+		if (lines[i] >= mreq->num_lines) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		stage_line(mreq, lines[i],
+			   values ? values[i] : GPIOD_LINE_VALUE_INACTIVE);
+	}
+
+	return 0;
+}
+
+static void stage_all_lines(struct gpiod_multi_request *mreq,
+			    const enum gpiod_line_value *values)
+{
+	size_t i;
+
+	clear_staged(mreq);
+
+	for (i = 0; i < mreq->num_lines; i++)
+		stage_line(mreq, i,
+			   values ? values[i] : GPIOD_LINE_VALUE_INACTIVE);
+}
+
+static enum gpiod_line_value line_value(struct gpiod_multi_request *mreq,
+					unsigned int index)
+{
+	struct multi_line *line = &mreq->lines[index];
+
+	return mreq->members[line->member].values & (1ULL << line->bit) ?
+		GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+}
+
+GPIOD_API int
+gpiod_multi_request_get_values_subset(struct gpiod_multi_request *mreq,
+				      size_t num_lines,
+				      const unsigned int *lines,
+				      enum gpiod_line_value *values)
+{
+	size_t i;
+	int ret;
+
+	assert(mreq);
+
+	if (!lines || !values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = stage_lines(mreq, num_lines, lines, NULL);
+	if (ret)
+		return -1;
+
+	ret = dispatch(mreq, MULTI_OP_GET);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < num_lines; i++)
+		values[i] = line_value(mreq, lines[i]);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_multi_request_get_values(struct gpiod_multi_request *mreq,
+					     enum gpiod_line_value *values)
+{
+	size_t i;
+	int ret;
+
+	assert(mreq);
+
+	if (!values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	stage_all_lines(mreq, NULL);
+
+	ret = dispatch(mreq, MULTI_OP_GET);
+	if (ret)
+		return -1;
+
+	for (i = 0; i < mreq->num_lines; i++)
+		values[i] = line_value(mreq, i);
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_multi_request_set_values_subset(struct gpiod_multi_request *mreq,
+				      size_t num_lines,
+				      const unsigned int *lines,
+				      const enum gpiod_line_value *values)
+{
+	int ret;
+
+	assert(mreq);
+
+	if (!lines || !values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = stage_lines(mreq, num_lines, lines, values);
+	if (ret)
+		return -1;
+
+	return dispatch(mreq, MULTI_OP_SET);
+}
+
+GPIOD_API int gpiod_multi_request_set_values(struct gpiod_multi_request *mreq,
+					     const enum gpiod_line_value *values)
+{
+	assert(mreq);
+
+	if (!values) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	stage_all_lines(mreq, values);
+
+	return dispatch(mreq, MULTI_OP_SET);
+}
+
+GPIOD_API uint64_t
+gpiod_multi_request_get_last_skew_ns(struct gpiod_multi_request *mreq)
+{
+	assert(mreq);
+
+	return mreq->last_skew_ns;
+}
+
+GPIOD_API struct gpiod_multi_request_snapshot *
+gpiod_multi_request_snapshot_new(struct gpiod_multi_request *mreq)
+{
+	struct gpiod_multi_request_snapshot *snapshot;
+	size_t size;
+
+	assert(mreq);
+
+	size = sizeof(*snapshot) +
+	       sizeof(snapshot->samples[0]) * mreq->num_members;
+
+	snapshot = gpiod_malloc(size);
+	if (!snapshot)
+		return NULL;
+
+	memset(snapshot, 0, size);
+	snapshot->max_samples = mreq->num_members;
+
+	return snapshot;
+}
+
+GPIOD_API void
+gpiod_multi_request_snapshot_free(struct gpiod_multi_request_snapshot *snapshot)
+{
+	gpiod_free(snapshot);
+}
+
+GPIOD_API int
+gpiod_multi_request_take_snapshot(struct gpiod_multi_request *mreq,
+				  struct gpiod_multi_request_snapshot *snapshot)
+{
+	struct gpiod_multi_request_sample *sample;
+	struct member *member;
+	size_t i;
+	int ret;
+
+	assert(mreq);
+
+	if (!snapshot) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (mreq->num_members > snapshot->max_samples) {
+		errno = E2BIG;
+		return -1;
+	}
+
+	stage_all_lines(mreq, NULL);
+
+	ret = dispatch(mreq, MULTI_OP_GET);
+
+	snapshot->num_samples = mreq->num_members;
+	snapshot->first_ns = UINT64_MAX;
+	snapshot->last_ns = 0;
+
+	for (i = 0; i < mreq->num_members; i++) {
+		member = &mreq->members[i];
+		sample = &snapshot->samples[i];
+
+		sample->before_ns = member->start_ns;
+		sample->after_ns = member->end_ns;
+		sample->mask = member->mask;
+		sample->values = member->ret ? 0 : member->values;
+		sample->error = member->error;
+		sample->reserved = 0;
+
+		snapshot->first_ns = MIN(snapshot->first_ns, member->start_ns);
+		snapshot->last_ns = MAX(snapshot->last_ns, member->end_ns);
+	}
+
+	if (!snapshot->num_samples)
+		snapshot->first_ns = 0;
+
+	return ret;
+}
+
+GPIOD_API size_t gpiod_multi_request_snapshot_get_num_samples(
+		struct gpiod_multi_request_snapshot *snapshot)
+{
+	assert(snapshot);
+
+	return snapshot->num_samples;
+}
+
+GPIOD_API const struct gpiod_multi_request_sample *
+gpiod_multi_request_snapshot_get_samples(
+		struct gpiod_multi_request_snapshot *snapshot)
+{
+	assert(snapshot);
+
+	return snapshot->samples;
+}
+
+GPIOD_API uint64_t gpiod_multi_request_snapshot_get_timestamp_ns(
+		struct gpiod_multi_request_snapshot *snapshot)
+{
+	assert(snapshot);
+
+	return snapshot->first_ns +
+	       (snapshot->last_ns - snapshot->first_ns) / 2;
+}
+
+GPIOD_API uint64_t gpiod_multi_request_snapshot_get_window_ns(
+		struct gpiod_multi_request_snapshot *snapshot)
+{
+	assert(snapshot);
+
+	return snapshot->last_ns - snapshot->first_ns;
+}
@@ -0,0 +1,633 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+struct sched_entry {
+	uint64_t deadline_ns;
+	uint64_t id;
+	struct gpiod_line_request *request;
+	uint64_t mask;
+	uint64_t values;
+	/* Write the entry was merged into. */
+	size_t write;
+};
+
+/* Lines of a single request set in one tick. */
+struct sched_write {
+	struct gpiod_line_request *request;
+	uint64_t mask;
+	uint64_t values;
+	uint64_t lateness_ns;
+	int error;
+};
+
+struct sched_result {
+	uint64_t id;
+	uint64_t lateness_ns;
+	int error;
+};
+
+struct gpiod_output_scheduler {
+	enum gpiod_line_clock clock;
+	clockid_t clockid;
+	/* Min-heap of pending entries ordered by deadline and id. */
+	struct sched_entry *heap;
+	size_t num_pending;
+	size_t capacity;
+	/* Entries due at the current tick, sized along with the heap. */
+	struct sched_entry *due;
+	struct sched_write *writes;
+	uint64_t next_id;
+	struct sched_result results[GPIOD_OUTPUT_SCHEDULER_MAX_RESULTS];
+	size_t first_result;
+	size_t num_results;
+	unsigned long num_lost_results;
+	uint64_t max_lateness_ns;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool running;
+	bool stop;
+	struct gpiod_thread_attr *thread_attr;
+};
+
+static int line_clock_to_clockid(enum gpiod_line_clock clock, clockid_t *id)
+{
+	switch (clock) {
+	case GPIOD_LINE_CLOCK_MONOTONIC:
+		*id = CLOCK_MONOTONIC;
+		return 0;
+	case GPIOD_LINE_CLOCK_REALTIME:
+		*id = CLOCK_REALTIME;
+		return 0;
+	case GPIOD_LINE_CLOCK_HTE:
+		/* The timestamp engine can't be slept on. */
+		errno = ENOTSUP;
+		return -1;
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+static uint64_t read_clock(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+GPIOD_API struct gpiod_output_scheduler *
+gpiod_output_scheduler_new(enum gpiod_line_clock clock)
+{
+	struct gpiod_output_scheduler *sched;
+	pthread_condattr_t attr;
+	clockid_t clockid;
+
+	if (line_clock_to_clockid(clock, &clockid))
+		return NULL;
+
+	sched = gpiod_malloc(sizeof(*sched));
+	if (!sched)
+		return NULL;
+
+	memset(sched, 0, sizeof(*sched));
+	sched->clock = clock;
+	sched->clockid = clockid;
+	sched->next_id = 1;
+
+	/* The timer thread waits for absolute deadlines on the event clock. */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, clockid);
+	pthread_cond_init(&sched->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&sched->lock, NULL);
+
+	return sched;
+}
+
+GPIOD_API void gpiod_output_scheduler_free(struct gpiod_output_scheduler *sched)
+{
+	if (!sched)
+		return;
+
+	if (sched->running)
+		gpiod_output_scheduler_stop(sched);
+
+	pthread_cond_destroy(&sched->cond);
+	pthread_mutex_destroy(&sched->lock);
+	gpiod_thread_attr_free(sched->thread_attr);
+	gpiod_free(sched->heap);
+	gpiod_free(sched->due);
+	gpiod_free(sched->writes);
+	gpiod_free(sched);
+}
+
+GPIOD_API enum gpiod_line_clock
+gpiod_output_scheduler_get_clock(struct gpiod_output_scheduler *sched)
+{
+	assert(sched);
+
+	return sched->clock;
+}
+
+GPIOD_API uint64_t
+gpiod_output_scheduler_now_ns(struct gpiod_output_scheduler *sched)
+{
+	assert(sched);
+
+	return read_clock(sched->clockid);
+}
+
+static bool entry_before(const struct sched_entry *a,
+			 const struct sched_entry *b)
+{
+	if (a->deadline_ns != b->deadline_ns)
+		return a->deadline_ns < b->deadline_ns;
+
+	/* Entries with equal deadlines run in the order they were queued. */
+	return a->id < b->id;
+}
+
+static void heap_swap(struct gpiod_output_scheduler *sched, size_t i, size_t j)
+{
+	struct sched_entry tmp = sched->heap[i];
+
+	sched->heap[i] = sched->heap[j];
+	sched->heap[j] = tmp;
+}
+
+static void heap_sift_up(struct gpiod_output_scheduler *sched, size_t i)
+{
+	size_t parent;
+
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (!entry_before(&sched->heap[i], &sched->heap[parent]))
+			break;
+
+		heap_swap(sched, i, parent);
+		i = parent;
+	}
+}
+
+static void heap_sift_down(struct gpiod_output_scheduler *sched, size_t i)
+{
+	size_t child, min;
+
+	for (;;) {
+		min = i;
+
+		for (child = 2 * i + 1;
+		     child <= 2 * i + 2 && child < sched->num_pending; child++) {
+			if (entry_before(&sched->heap[child], &sched->heap[min]))
+				min = child;
+		}
+
+		if (min == i)
+			break;
+
+		heap_swap(sched, i, min);
+		i = min;
+	}
+}
+
+static void heap_remove(struct gpiod_output_scheduler *sched, size_t i)
+{
+	sched->num_pending--;
+	if (i == sched->num_pending)
+		return;
+
+	sched->heap[i] = sched->heap[sched->num_pending];
+	heap_sift_up(sched, i);
+	heap_sift_down(sched, i);
+}
+
+/* Called with the lock held so that the timer thread never sees a resize. */
+static int grow(struct gpiod_output_scheduler *sched)
+{
+	size_t capacity = sched->capacity ? sched->capacity * 2 : 16;
+	struct sched_write *writes;
+	struct sched_entry *entries;
+
+	entries = gpiod_realloc(sched->heap, sizeof(*entries) * sched->capacity,
+				sizeof(*entries) * capacity);
+	if (!entries)
+		return -1;
+
+	sched->heap = entries;
+
+	entries = gpiod_realloc(sched->due, sizeof(*entries) * sched->capacity,
+				sizeof(*entries) * capacity);
+	if (!entries)
+		return -1;
+
+	sched->due = entries;
+
+	writes = gpiod_realloc(sched->writes,
+			       sizeof(*writes) * sched->capacity,
+			       sizeof(*writes) * capacity);
+	if (!writes)
+		return -1;
+
+	sched->writes = writes;
+	sched->capacity = capacity;
+
+	return 0;
+}
+
+static bool mask_valid(struct gpiod_line_request *request, uint64_t mask)
+{
+	size_t num_lines = gpiod_line_request_get_num_requested_lines(request);
+
+	if (!mask)
+		return false;
+
+	return num_lines >= 64 || !(mask >> num_lines);
+}
+
+GPIOD_API int
+gpiod_output_scheduler_schedule(struct gpiod_output_scheduler *sched,
+				struct gpiod_line_request *request,
+				uint64_t deadline_ns, uint64_t mask,
+				uint64_t values, uint64_t *id)
+{
+	struct sched_entry *entry;
+	uint64_t new_id;
+
+	assert(sched);
+
+	if (!request || !mask_valid(request, mask)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&sched->lock);
+
+	if (sched->num_pending == sched->capacity && grow(sched)) {
+		pthread_mutex_unlock(&sched->lock);
+		return -1;
+	}
+
+	entry = &sched->heap[sched->num_pending];
+	entry->deadline_ns = deadline_ns;
+	entry->id = new_id = sched->next_id++;
+	entry->request = request;
+	entry->mask = mask;
+	entry->values = values & mask;
+
+	if (id)
+		*id = new_id;
+
+	heap_sift_up(sched, sched->num_pending++);
+
+	/* The timer thread only needs waking up for a new earliest deadline. */
+	if (sched->heap[0].id == new_id)
+		pthread_cond_signal(&sched->cond);
+
+	pthread_mutex_unlock(&sched->lock);
+
+	return 0;
+}
+
+GPIOD_API int gpiod_output_scheduler_cancel(struct gpiod_output_scheduler *sched,
+					    uint64_t id)
+{
+	size_t i;
+
+	assert(sched);
+
+	pthread_mutex_lock(&sched->lock);
+
+	for (i = 0; i < sched->num_pending; i++) {
+		if (sched->heap[i].id == id) {
+			heap_remove(sched, i);
+			pthread_mutex_unlock(&sched->lock);
+			return 0;
+		}
+	}
+
+	pthread_mutex_unlock(&sched->lock);
+
+	errno = ENOENT;
+	return -1;
+}
+
+GPIOD_API size_t
+gpiod_output_scheduler_cancel_request(struct gpiod_output_scheduler *sched,
+				      struct gpiod_line_request *request)
+{
+	size_t i, num_cancelled = 0;
+
+	assert(sched);
+
+	pthread_mutex_lock(&sched->lock);
+
+	/* Removal moves the last entry into the slot, look at it again. */
+	for (i = 0; i < sched->num_pending;) {
+		if (sched->heap[i].request == request) {
+			heap_remove(sched, i);
+			num_cancelled++;
+		} else {
+			i++;
+		}
+	}
+
+	pthread_mutex_unlock(&sched->lock);
+
+	return num_cancelled;
+}
+
+GPIOD_API size_t
+gpiod_output_scheduler_get_num_pending(struct gpiod_output_scheduler *sched)
+{
+	size_t num_pending;
+
+	assert(sched);
+
+	pthread_mutex_lock(&sched->lock);
+	num_pending = sched->num_pending;
+	pthread_mutex_unlock(&sched->lock);
+
+	return num_pending;
+}
+
+static void queue_result(struct gpiod_output_scheduler *sched, uint64_t id,
+			 uint64_t lateness_ns, int error)
+{
+	struct sched_result *result;
+
+	if (lateness_ns > sched->max_lateness_ns)
+		sched->max_lateness_ns = lateness_ns;
+
+	if (sched->num_results == GPIOD_OUTPUT_SCHEDULER_MAX_RESULTS) {
+		sched->num_lost_results++;
+		return;
+	}
+
+	result = &sched->results[(sched->first_result + sched->num_results) %
+				 GPIOD_OUTPUT_SCHEDULER_MAX_RESULTS];
+	result->id = id;
+	result->lateness_ns = lateness_ns;
+	result->error = error;
+	sched->num_results++;
+}
+
+static size_t merge_write(struct gpiod_output_scheduler *sched,
+			  size_t *num_writes, struct sched_entry *entry)
+{
+	struct sched_write *write;
+	size_t i;
+
+	for (i = 0; i < *num_writes; i++) {
+		if (sched->writes[i].request == entry->request)
+			break;
+	}
+
+	write = &sched->writes[i];
+	if (i == *num_writes) {
+		memset(write, 0, sizeof(*write));
+		write->request = entry->request;
+		(*num_writes)++;
+	}
+
+	/* Entries are merged by deadline, the later ones take precedence. */
+	write->mask |= entry->mask;
+	write->values = (write->values & ~entry->mask) | entry->values;
+
+	return i;
+}
+
+/* Run all entries due at the time now, called with the lock held. */
+static void run_due(struct gpiod_output_scheduler *sched, uint64_t now)
+{
+	size_t i, num_due = 0, num_writes = 0;
+	struct sched_write *write;
+	struct sched_entry *entry;
+	uint64_t done;
+	int ret;
+
+	while (sched->num_pending && sched->heap[0].deadline_ns <= now) {
+		entry = &sched->due[num_due++];
+		*entry = sched->heap[0];
+		heap_remove(sched, 0);
+		entry->write = merge_write(sched, &num_writes, entry);
+	}
+
+	for (i = 0; i < num_writes; i++) {
+		write = &sched->writes[i];
+
+		ret = gpiod_line_request_set_values_mask(write->request,
+							 write->mask,
+							 write->values);
+		write->error = ret ? errno : 0;
+		done = read_clock(sched->clockid);
+		/*
+		 * Timestamped after the write returned: an upper bound of the
+		 * time the lines changed. Deadlines are shared by all entries
+		 * merged into the write but not the lateness.
+		 */
+		write->lateness_ns = done;
+	}
+
+	for (i = 0; i < num_due; i++) {
+		entry = &sched->due[i];
+		write = &sched->writes[entry->write];
+		done = write->lateness_ns;
+
+		queue_result(sched, entry->id,
+			     done > entry->deadline_ns ?
+					done - entry->deadline_ns : 0,
+			     write->error);
+	}
+}
+
+static void *sched_thread_func(void *data)
+{
+	struct gpiod_output_scheduler *sched = data;
+	uint64_t now, deadline;
+	struct timespec ts;
+
+	pthread_mutex_lock(&sched->lock);
+
+	while (!sched->stop) {
+		if (!sched->num_pending) {
+			pthread_cond_wait(&sched->cond, &sched->lock);
+			continue;
+		}
+
+		deadline = sched->heap[0].deadline_ns;
+		now = read_clock(sched->clockid);
+
+		if (deadline > now) {
+			ts.tv_sec = deadline / NSEC_PER_SEC;
+			ts.tv_nsec = deadline % NSEC_PER_SEC;
+
+			/*
+			 * Woken up early by a new entry, a cancellation or the
+			 * stop flag - look at the heap again in any case.
+			 */
+			pthread_cond_timedwait(&sched->cond, &sched->lock, &ts);
+			continue;
+		}
+
+		run_due(sched, now);
+	}
+
+	pthread_mutex_unlock(&sched->lock);
+
+	return NULL;
+}
+
+GPIOD_API int
+gpiod_output_scheduler_set_thread_attr(struct gpiod_output_scheduler *sched,
+				       struct gpiod_thread_attr *attr)
+{
+	struct gpiod_thread_attr *copy = NULL;
+
+	assert(sched);
+
+	if (sched->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (attr) {
+		copy = gpiod_thread_attr_copy(attr);
+		if (!copy)
+			return -1;
+	}
+
+	gpiod_thread_attr_free(sched->thread_attr);
+	sched->thread_attr = copy;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_output_scheduler_start(struct gpiod_output_scheduler *sched)
+{
+	pthread_attr_t attr;
+	int ret;
+
+	assert(sched);
+
+	if (sched->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	sched->stop = false;
+
+	pthread_attr_init(&attr);
+
+	if (sched->thread_attr &&
+	    gpiod_thread_attr_to_pthread(sched->thread_attr, &attr)) {
+		pthread_attr_destroy(&attr);
+		return -1;
+	}
+
+	ret = pthread_create(&sched->thread, &attr, sched_thread_func, sched);
+	pthread_attr_destroy(&attr);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	sched->running = true;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_output_scheduler_stop(struct gpiod_output_scheduler *sched)
+{
+	assert(sched);
+
+	if (!sched->running) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&sched->lock);
+	sched->stop = true;
+	pthread_cond_signal(&sched->cond);
+	pthread_mutex_unlock(&sched->lock);
+
+	pthread_join(sched->thread, NULL);
+	sched->running = false;
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_output_scheduler_read_result(struct gpiod_output_scheduler *sched,
+				   uint64_t *id, uint64_t *lateness_ns,
+				   int *error)
+{
+	struct sched_result *result;
+
+	assert(sched);
+
+	pthread_mutex_lock(&sched->lock);
+
+	if (!sched->num_results) {
+		pthread_mutex_unlock(&sched->lock);
+		return 0;
+	}
+
+	result = &sched->results[sched->first_result];
+	if (id)
+		*id = result->id;
+	if (lateness_ns)
+		*lateness_ns = result->lateness_ns;
+	if (error)
+		*error = result->error;
+
+	sched->first_result = (sched->first_result + 1) %
+			      GPIOD_OUTPUT_SCHEDULER_MAX_RESULTS;
+	sched->num_results--;
+
+	pthread_mutex_unlock(&sched->lock);
+
+	return 1;
+}
+
+GPIOD_API unsigned long
+gpiod_output_scheduler_get_num_lost_results(struct gpiod_output_scheduler *sched)
+{
+	unsigned long num_lost;
+
+	assert(sched);
+
+	pthread_mutex_lock(&sched->lock);
+	num_lost = sched->num_lost_results;
+	pthread_mutex_unlock(&sched->lock);
+
+	return num_lost;
+}
+
+GPIOD_API uint64_t
+gpiod_output_scheduler_get_max_lateness_ns(struct gpiod_output_scheduler *sched)
+{
+	uint64_t max_lateness;
+
+	assert(sched);
+
+	pthread_mutex_lock(&sched->lock);
+	max_lateness = sched->max_lateness_ns;
+	pthread_mutex_unlock(&sched->lock);
+
+	return max_lateness;
+}
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* Wiegand allows up to 20 ms between pulses of a frame. */
+#define DEFAULT_FRAME_GAP_NS	25000000ULL
+/* Frames decoded but not read yet - the oldest ones are dropped past this. */
+#define FRAME_QUEUE_SIZE	32
+#define MAX_FRAME_BITS		64
+
+struct decoder_line {
+	unsigned int offset;
+	bool active;
+	uint64_t lead_ts;
+};
+
+struct pulse_frame {
+	uint64_t data;
+	unsigned int num_bits;
+	int errors;
+	uint64_t timestamp_ns;
+};
+
+struct gpiod_pulse_decoder {
+	/* Wiegand decoders have two lines, pulse width decoders one. */
+	struct decoder_line lines[2];
+	size_t num_lines;
+	uint64_t one_min_ns;
+	uint64_t frame_gap_ns;
+	uint64_t min_width_ns;
+	uint64_t max_width_ns;
+	uint64_t min_interval_ns;
+	/* Frame being assembled. */
+	bool in_frame;
+	bool have_pulse;
+	struct pulse_frame frame;
+	uint64_t last_lead_ts;
+	uint64_t last_edge_ts;
+	/* Ring of complete frames. */
+	struct pulse_frame queue[FRAME_QUEUE_SIZE];
+	size_t queue_head;
+	size_t num_queued;
+	unsigned long num_lost_frames;
+};
+
+static struct gpiod_pulse_decoder *decoder_new(size_t num_lines)
+{
+	struct gpiod_pulse_decoder *decoder;
+
+	decoder = gpiod_malloc(sizeof(*decoder));
+	if (!decoder)
+		return NULL;
+
+	memset(decoder, 0, sizeof(*decoder));
+	decoder->num_lines = num_lines;
+	decoder->frame_gap_ns = DEFAULT_FRAME_GAP_NS;
+	decoder->max_width_ns = UINT64_MAX;
+
+	return decoder;
+}
+
+GPIOD_API struct gpiod_pulse_decoder *
+gpiod_pulse_decoder_new_wiegand(unsigned int data0_offset,
+				unsigned int data1_offset)
+{
+	struct gpiod_pulse_decoder *decoder;
+
+	if (data0_offset == data1_offset) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	decoder = decoder_new(2);
+	if (!decoder)
+		return NULL;
+
+	decoder->lines[0].offset = data0_offset;
+	decoder->lines[1].offset = data1_offset;
+
+	return decoder;
+}
+
+GPIOD_API struct gpiod_pulse_decoder *
+gpiod_pulse_decoder_new_pulse_width(unsigned int offset, uint64_t one_min_ns)
+{
+	struct gpiod_pulse_decoder *decoder;
+
+	if (!one_min_ns) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	decoder = decoder_new(1);
+	if (!decoder)
+		return NULL;
+
+	decoder->lines[0].offset = offset;
+	decoder->one_min_ns = one_min_ns;
+
+	return decoder;
+}
+
+GPIOD_API void gpiod_pulse_decoder_free(struct gpiod_pulse_decoder *decoder)
+{
+	gpiod_free(decoder);
+}
+
+GPIOD_API void gpiod_pulse_decoder_reset(struct gpiod_pulse_decoder *decoder)
+{
+	size_t i;
+
+	assert(decoder);
+
+	for (i = 0; i < decoder->num_lines; i++)
+		decoder->lines[i].active = false;
+
+	decoder->in_frame = false;
+	decoder->num_queued = 0;
+	decoder->num_lost_frames = 0;
+}
+
+GPIOD_API void
+gpiod_pulse_decoder_set_frame_gap_ns(struct gpiod_pulse_decoder *decoder,
+				     uint64_t gap_ns)
+{
+	assert(decoder);
+
+	decoder->frame_gap_ns = gap_ns;
+}
+
+GPIOD_API int
+gpiod_pulse_decoder_set_pulse_width_limits(struct gpiod_pulse_decoder *decoder,
+					   uint64_t min_ns, uint64_t max_ns)
+{
+	assert(decoder);
+
+	if (min_ns > max_ns) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	decoder->min_width_ns = min_ns;
+	decoder->max_width_ns = max_ns;
+
+	return 0;
+}
+
+GPIOD_API void
+gpiod_pulse_decoder_set_min_interval_ns(struct gpiod_pulse_decoder *decoder,
+					uint64_t interval_ns)
+{
+	assert(decoder);
+
+	decoder->min_interval_ns = interval_ns;
+}
+
+/* Timestamps of different lines aren't guaranteed to be in order. */
+static uint64_t elapsed(uint64_t ts, uint64_t since)
+{
+	return ts > since ? ts - since : 0;
+}
+
+static void close_frame(struct gpiod_pulse_decoder *decoder)
+{
+	size_t tail;
+
+	decoder->in_frame = false;
+
+	if (decoder->num_queued == FRAME_QUEUE_SIZE) {
+		decoder->queue_head = (decoder->queue_head + 1) %
+				      FRAME_QUEUE_SIZE;
+		decoder->num_queued--;
+		decoder->num_lost_frames++;
+	}
+
+	tail = (decoder->queue_head + decoder->num_queued) % FRAME_QUEUE_SIZE;
+	decoder->queue[tail] = decoder->frame;
+	decoder->num_queued++;
+}
+
+static void add_bit(struct gpiod_pulse_decoder *decoder, bool bit)
+{
+	struct pulse_frame *frame = &decoder->frame;
+
+	if (frame->num_bits == MAX_FRAME_BITS) {
+		frame->errors |= GPIOD_PULSE_FRAME_ERR_OVERFLOW;
+		return;
+	}
+
+	/* The first bit on the wire ends up as the most significant one. */
+	frame->data = (frame->data << 1) | bit;
+	frame->num_bits++;
+}
+
+static void leading_edge(struct gpiod_pulse_decoder *decoder,
+			 struct decoder_line *line, uint64_t ts)
+{
+	struct pulse_frame *frame = &decoder->frame;
+	size_t i;
+
+	if (decoder->in_frame &&
+	    elapsed(ts, decoder->last_edge_ts) >= decoder->frame_gap_ns)
+		close_frame(decoder);
+
+	if (!decoder->in_frame) {
+		memset(frame, 0, sizeof(*frame));
+		frame->timestamp_ns = ts;
+		decoder->in_frame = true;
+		decoder->have_pulse = false;
+	}
+
+	/* The trailing edge of the previous pulse went missing. */
+	if (line->active)
+		frame->errors |= GPIOD_PULSE_FRAME_ERR_LOST_EDGE;
+
+	if (decoder->have_pulse &&
+	    elapsed(ts, decoder->last_lead_ts) < decoder->min_interval_ns)
+		frame->errors |= GPIOD_PULSE_FRAME_ERR_INTERVAL;
+
+	for (i = 0; i < decoder->num_lines; i++) {
+		if (&decoder->lines[i] != line && decoder->lines[i].active)
+			frame->errors |= GPIOD_PULSE_FRAME_ERR_OVERLAP;
+	}
+
+	/* Wiegand bits are known straight away, the width needs to wait. */
+	if (!decoder->one_min_ns)
+		add_bit(decoder, line == &decoder->lines[1]);
+
+	line->active = true;
+	line->lead_ts = ts;
+	decoder->have_pulse = true;
+	decoder->last_lead_ts = ts;
+}
+
+static void trailing_edge(struct gpiod_pulse_decoder *decoder,
+			  struct decoder_line *line, uint64_t ts)
+{
+	struct pulse_frame *frame = &decoder->frame;
+	uint64_t width;
+
+	/* A line already active when first seen isn't an error. */
+	if (!line->active) {
+		if (decoder->in_frame)
+			frame->errors |= GPIOD_PULSE_FRAME_ERR_LOST_EDGE;
+		return;
+	}
+
+	line->active = false;
+	width = elapsed(ts, line->lead_ts);
+
+	if (width < decoder->min_width_ns || width > decoder->max_width_ns)
+		frame->errors |= GPIOD_PULSE_FRAME_ERR_WIDTH;
+
+	if (decoder->one_min_ns)
+		add_bit(decoder, width >= decoder->one_min_ns);
+}
+
+void gpiod_pulse_decoder_add_uapi_events(struct gpiod_pulse_decoder *decoder,
+					 const struct gpio_v2_line_event *events,
+					 size_t num_events)
+{
+	struct decoder_line *line;
+	size_t i, j;
+
+	for (i = 0; i < num_events; i++) {
+		for (j = 0, line = NULL; j < decoder->num_lines; j++) {
+			if (decoder->lines[j].offset == events[i].offset)
+				line = &decoder->lines[j];
+		}
+
+		if (!line)
+			continue;
+
+		if (events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE)
+			leading_edge(decoder, line, events[i].timestamp_ns);
+		else
+			trailing_edge(decoder, line, events[i].timestamp_ns);
+
+		decoder->last_edge_ts = events[i].timestamp_ns;
+	}
+}
+
+GPIOD_API int
+gpiod_pulse_decoder_add_events(struct gpiod_pulse_decoder *decoder,
+			       struct gpiod_edge_event_buffer *buffer)
+{
+	assert(decoder);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	gpiod_pulse_decoder_add_uapi_events(decoder,
+				gpiod_edge_event_buffer_get_data(buffer),
+				gpiod_edge_event_buffer_get_num_events(buffer));
+
+	return decoder->num_queued;
+}
+
+GPIOD_API int gpiod_pulse_decoder_flush(struct gpiod_pulse_decoder *decoder,
+					uint64_t now_ns)
+{
+	assert(decoder);
+
+	if (decoder->in_frame &&
+	    elapsed(now_ns, decoder->last_edge_ts) >= decoder->frame_gap_ns)
+		close_frame(decoder);
+
+	return decoder->num_queued;
+}
+
+GPIOD_API size_t
+gpiod_pulse_decoder_get_num_frames(struct gpiod_pulse_decoder *decoder)
+{
+	assert(decoder);
+
+	return decoder->num_queued;
+}
+
+GPIOD_API int
+gpiod_pulse_decoder_read_frame(struct gpiod_pulse_decoder *decoder,
+			       uint64_t *data, unsigned int *num_bits,
+			       int *errors, uint64_t *timestamp_ns)
+{
+	struct pulse_frame *frame;
+
+	assert(decoder);
+
+	if (!decoder->num_queued)
+		return 0;
+
+	frame = &decoder->queue[decoder->queue_head];
+	decoder->queue_head = (decoder->queue_head + 1) % FRAME_QUEUE_SIZE;
+	decoder->num_queued--;
+
+	if (data)
+		*data = frame->data;
+	if (num_bits)
+		*num_bits = frame->num_bits;
+	if (errors)
+		*errors = frame->errors;
+	if (timestamp_ns)
+		*timestamp_ns = frame->timestamp_ns;
+
+	return 1;
+}
+
+GPIOD_API unsigned long
+gpiod_pulse_decoder_get_num_lost_frames(struct gpiod_pulse_decoder *decoder)
+{
+	assert(decoder);
+
+	return decoder->num_lost_frames;
+}
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+/* Open addressing map of offsets to lines, same as in line requests. */
+#define LINE_MAP_BITS		7
+#define LINE_MAP_SIZE		(1U << LINE_MAP_BITS)
+
+struct pulse_stats {
+	/* Rising edges. */
+	uint64_t num_pulses;
+	/* Sums of the intervals completed within the window and their count. */
+	uint64_t period_sum;
+	uint64_t num_periods;
+	uint64_t high_sum;
+	uint64_t num_high;
+	uint64_t low_sum;
+	uint64_t num_low;
+};
+
+struct pulse_line {
+	unsigned int offset;
+	bool seen;
+	uint32_t last_id;
+	uint64_t last_ts;
+	uint64_t last_rise_ts;
+	bool have_rise;
+	uint64_t window_start;
+	/* Statistics of the window in progress and of the last one closed. */
+	struct pulse_stats acc;
+	struct pulse_stats done;
+};
+
+struct gpiod_pulse_meter {
+	uint64_t window_ns;
+	struct pulse_line lines[GPIO_V2_LINES_MAX];
+	size_t num_lines;
+	/* Line index + 1 of the offset hashed here, 0 if empty. */
+	unsigned char line_map[LINE_MAP_SIZE];
+};
+
+GPIOD_API struct gpiod_pulse_meter *gpiod_pulse_meter_new(uint64_t window_ns)
+{
+	struct gpiod_pulse_meter *meter;
+
+	meter = gpiod_malloc(sizeof(*meter));
+	if (!meter)
+		return NULL;
+
+	memset(meter, 0, sizeof(*meter));
+	meter->window_ns = window_ns;
+
+	return meter;
+}
+
+GPIOD_API void gpiod_pulse_meter_free(struct gpiod_pulse_meter *meter)
+{
+	gpiod_free(meter);
+}
+
+GPIOD_API void gpiod_pulse_meter_reset(struct gpiod_pulse_meter *meter)
+{
+	assert(meter);
+
+	meter->num_lines = 0;
+	memset(meter->line_map, 0, sizeof(meter->line_map));
+}
+
+static unsigned int offset_hash(unsigned int offset)
+{
+	return ((uint32_t)(offset * 2654435761U)) >> (32 - LINE_MAP_BITS);
+}
+
+static struct pulse_line *find_line(struct gpiod_pulse_meter *meter,
+				    unsigned int offset, bool create)
+{
+	struct pulse_line *line;
+	unsigned int slot;
+
+	slot = offset_hash(offset);
+
+	while (meter->line_map[slot]) {
+		line = &meter->lines[meter->line_map[slot] - 1];
+		if (line->offset == offset)
+			return line;
+
+		slot = (slot + 1) & (LINE_MAP_SIZE - 1);
+	}
+
+	if (!create)
+		return NULL;
+
+	if (meter->num_lines == GPIO_V2_LINES_MAX) {
+		errno = E2BIG;
+		return NULL;
+	}
+
+	line = &meter->lines[meter->num_lines++];
+	memset(line, 0, sizeof(*line));
+	line->offset = offset;
+	meter->line_map[slot] = meter->num_lines;
+
+	return line;
+}
+
+/* Close the window in progress if \p ts is past its end. */
+static void close_window(struct gpiod_pulse_meter *meter,
+			 struct pulse_line *line, uint64_t ts)
+{
+	uint64_t elapsed;
+
+	if (!meter->window_ns || ts < line->window_start + meter->window_ns)
+		return;
+
+	elapsed = (ts - line->window_start) / meter->window_ns;
+
+	/* Nothing happened in the last window if more than one went by. */
+	if (elapsed == 1)
+		line->done = line->acc;
+	else
+		memset(&line->done, 0, sizeof(line->done));
+
+	memset(&line->acc, 0, sizeof(line->acc));
+	line->window_start += elapsed * meter->window_ns;
+}
+
+static void add_event(struct gpiod_pulse_meter *meter, struct pulse_line *line,
+		      const struct gpio_v2_line_event *event)
+{
+	uint64_t ts = event->timestamp_ns;
+	struct pulse_stats *acc = &line->acc;
+	bool rising;
+
+	if (!line->seen) {
+		line->seen = true;
+		line->window_start = ts;
+	}
+
+	close_window(meter, line, ts);
+
+	rising = event->id == GPIO_V2_LINE_EVENT_RISING_EDGE;
+
+	/*
+	 * Two edges of the same type in a row mean events were lost or only
+	 * one edge is detected - the level time between them is unknown.
+	 */
+	if (line->last_id && line->last_id != event->id) {
+		if (rising) {
+			acc->low_sum += ts - line->last_ts;
+			acc->num_low++;
+		} else {
+			acc->high_sum += ts - line->last_ts;
+			acc->num_high++;
+		}
+	}
+
+	if (rising) {
+		if (line->have_rise) {
+			acc->period_sum += ts - line->last_rise_ts;
+			acc->num_periods++;
+		}
+
+		acc->num_pulses++;
+		line->last_rise_ts = ts;
+		line->have_rise = true;
+	}
+
+	line->last_id = event->id;
+	line->last_ts = ts;
+}
+
+GPIOD_API int
+gpiod_pulse_meter_add_events(struct gpiod_pulse_meter *meter,
+			     struct gpiod_edge_event_buffer *buffer)
+{
+	const struct gpio_v2_line_event *events;
+	struct pulse_line *line = NULL;
+	size_t i, num_events;
+
+	assert(meter);
+
+	if (!buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	events = gpiod_edge_event_buffer_get_data(buffer);
+	num_events = gpiod_edge_event_buffer_get_num_events(buffer);
+
+	for (i = 0; i < num_events; i++) {
+		/* Batches often hold runs of events of the same line. */
+		if (!line || line->offset != events[i].offset) {
+			line = find_line(meter, events[i].offset, true);
+			if (!line)
+				return -1;
+		}
+
+		add_event(meter, line, &events[i]);
+	}
+
+	return 0;
+}
+
+GPIOD_API void gpiod_pulse_meter_flush(struct gpiod_pulse_meter *meter,
+				       uint64_t now_ns)
+{
+	size_t i;
+
+	assert(meter);
+
+	for (i = 0; i < meter->num_lines; i++)
+		close_window(meter, &meter->lines[i], now_ns);
+}
+
+static const struct pulse_stats *get_stats(struct gpiod_pulse_meter *meter,
+					   unsigned int offset)
+{
+	static const struct pulse_stats empty;
+	struct pulse_line *line;
+
+	assert(meter);
+
+	line = find_line(meter, offset, false);
+	if (!line)
+		return &empty;
+
+	return meter->window_ns ? &line->done : &line->acc;
+}
+
+GPIOD_API uint64_t
+gpiod_pulse_meter_get_num_pulses(struct gpiod_pulse_meter *meter,
+				 unsigned int offset)
+{
+	return get_stats(meter, offset)->num_pulses;
+}
+
+GPIOD_API uint64_t
+gpiod_pulse_meter_get_period_ns(struct gpiod_pulse_meter *meter,
+				unsigned int offset)
+{
+	const struct pulse_stats *stats = get_stats(meter, offset);
+
+	return stats->num_periods ? stats->period_sum / stats->num_periods : 0;
+}
+
+GPIOD_API uint64_t
+gpiod_pulse_meter_get_frequency_millihz(struct gpiod_pulse_meter *meter,
+					unsigned int offset)
+{
+	const struct pulse_stats *stats = get_stats(meter, offset);
+
+	if (!stats->period_sum)
+		return 0;
+
+	/* The product can't fit in 64 bits for long-running counts. */
+	return (uint64_t)((double)stats->num_periods * 1e12 /
+			  (double)stats->period_sum);
+}
+
+GPIOD_API uint64_t
+gpiod_pulse_meter_get_high_time_ns(struct gpiod_pulse_meter *meter,
+				   unsigned int offset)
+{
+	const struct pulse_stats *stats = get_stats(meter, offset);
+
+	return stats->num_high ? stats->high_sum / stats->num_high : 0;
+}
+
+GPIOD_API uint64_t
+gpiod_pulse_meter_get_low_time_ns(struct gpiod_pulse_meter *meter,
+				  unsigned int offset)
+{
+	const struct pulse_stats *stats = get_stats(meter, offset);
+
+	return stats->num_low ? stats->low_sum / stats->num_low : 0;
+}
@@ -0,0 +1,427 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+struct pwm_channel {
+	struct gpiod_line_request *request;
+	unsigned int bit;
+	uint64_t period_ns;
+	uint64_t duty_ns;
+	/* Settings to apply at the start of the next period. */
+	uint64_t new_period_ns;
+	uint64_t new_duty_ns;
+	uint64_t period_start_ns;
+	uint64_t next_ns;
+	bool falling;
+	bool value;
+};
+
+/* Lines of a single request updated in one tick. */
+struct pwm_write {
+	struct gpiod_line_request *request;
+	uint64_t mask;
+	uint64_t values;
+};
+
+struct gpiod_pwm {
+	struct pwm_channel *channels;
+	struct pwm_write *writes;
+	size_t num_channels;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool running;
+	bool stop;
+	int error;
+	struct gpiod_thread_attr *thread_attr;
+};
+
+GPIOD_API struct gpiod_pwm *gpiod_pwm_new(void)
+{
+	struct gpiod_pwm *pwm;
+	pthread_condattr_t attr;
+
+	pwm = gpiod_malloc(sizeof(*pwm));
+	if (!pwm)
+		return NULL;
+
+	memset(pwm, 0, sizeof(*pwm));
+
+	/* The timer thread waits for absolute deadlines on CLOCK_MONOTONIC. */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&pwm->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&pwm->lock, NULL);
+
+	return pwm;
+}
+
+GPIOD_API void gpiod_pwm_free(struct gpiod_pwm *pwm)
+{
+	if (!pwm)
+		return;
+
+	if (pwm->running)
+		gpiod_pwm_stop(pwm);
+
+	pthread_cond_destroy(&pwm->cond);
+	pthread_mutex_destroy(&pwm->lock);
+	gpiod_thread_attr_free(pwm->thread_attr);
+	gpiod_free(pwm->channels);
+	gpiod_free(pwm->writes);
+	gpiod_free(pwm);
+}
+
+static bool duty_cycle_valid(uint64_t period_ns, uint64_t duty_ns)
+{
+	return period_ns && duty_ns <= period_ns;
+}
+
+GPIOD_API int gpiod_pwm_add_line(struct gpiod_pwm *pwm,
+				 struct gpiod_line_request *request,
+				 unsigned int offset, uint64_t period_ns,
+				 uint64_t duty_ns)
+{
+	struct pwm_channel *channels, *channel;
+	struct pwm_write *writes;
+	int bit;
+
+	assert(pwm);
+
+	if (pwm->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!request || !duty_cycle_valid(period_ns, duty_ns)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	bit = gpiod_line_request_get_offset_bit(request, offset);
+	if (bit < 0)
+		return -1;
+
+	channels = gpiod_realloc(pwm->channels,
+				 sizeof(*channels) * pwm->num_channels,
+				 sizeof(*channels) * (pwm->num_channels + 1));
+	if (!channels)
+		return -1;
+
+	pwm->channels = channels;
+
+	writes = gpiod_realloc(pwm->writes,
+			       sizeof(*writes) * pwm->num_channels,
+			       sizeof(*writes) * (pwm->num_channels + 1));
+	if (!writes)
+		return -1;
+
+	pwm->writes = writes;
+
+	channel = &pwm->channels[pwm->num_channels];
+	memset(channel, 0, sizeof(*channel));
+	channel->request = request;
+	channel->bit = bit;
+	channel->new_period_ns = period_ns;
+	channel->new_duty_ns = duty_ns;
+
+	return pwm->num_channels++;
+}
+
+GPIOD_API size_t gpiod_pwm_get_num_lines(struct gpiod_pwm *pwm)
+{
+	assert(pwm);
+
+	return pwm->num_channels;
+}
+
+GPIOD_API int gpiod_pwm_set_duty_cycle(struct gpiod_pwm *pwm,
+				       unsigned int channel,
+				       uint64_t period_ns, uint64_t duty_ns)
+{
+	assert(pwm);
+
+	if (channel >= pwm->num_channels ||
+	    !duty_cycle_valid(period_ns, duty_ns)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&pwm->lock);
+	pwm->channels[channel].new_period_ns = period_ns;
+	pwm->channels[channel].new_duty_ns = duty_ns;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return 0;
+}
+
+static void channel_start_period(struct pwm_channel *channel,
+				 uint64_t start_ns)
+{
+	channel->period_ns = channel->new_period_ns;
+	channel->duty_ns = channel->new_duty_ns;
+	channel->period_start_ns = start_ns;
+
+	if (channel->duty_ns == 0 || channel->duty_ns == channel->period_ns) {
+		/* No transition within this period. */
+		channel->value = channel->duty_ns != 0;
+		channel->falling = false;
+		channel->next_ns = start_ns + channel->period_ns;
+	} else {
+		channel->value = true;
+		channel->falling = true;
+		channel->next_ns = start_ns + channel->duty_ns;
+	}
+}
+
+static void channel_advance(struct pwm_channel *channel)
+{
+	if (channel->falling) {
+		channel->value = false;
+		channel->falling = false;
+		channel->next_ns = channel->period_start_ns +
+				   channel->period_ns;
+	} else {
+		channel_start_period(channel, channel->next_ns);
+	}
+}
+
+static void queue_write(struct gpiod_pwm *pwm, size_t *num_writes,
+			struct pwm_channel *channel)
+{
+	struct pwm_write *write;
+	size_t i;
+
+	for (i = 0; i < *num_writes; i++) {
+		if (pwm->writes[i].request == channel->request)
+			break;
+	}
+
+	write = &pwm->writes[i];
+	if (i == *num_writes) {
+		write->request = channel->request;
+		write->mask = 0;
+		write->values = 0;
+		(*num_writes)++;
+	}
+
+	write->mask |= 1ULL << channel->bit;
+	if (channel->value)
+		write->values |= 1ULL << channel->bit;
+}
+
+static int flush_writes(struct gpiod_pwm *pwm, size_t num_writes)
+{
+	struct pwm_write *write;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < num_writes; i++) {
+		write = &pwm->writes[i];
+
+		ret = gpiod_line_request_set_values_mask(write->request,
+							 write->mask,
+							 write->values);
+		if (ret)
+			return -1;
+	}
+
+	return 0;
+}
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void *pwm_thread_func(void *data)
+{
+	struct gpiod_pwm *pwm = data;
+	struct pwm_channel *channel;
+	uint64_t now, next_ns;
+	size_t i, num_writes;
+	struct timespec ts;
+	bool old_value;
+
+	pthread_mutex_lock(&pwm->lock);
+
+	now = monotonic_ns();
+	num_writes = 0;
+
+	for (i = 0; i < pwm->num_channels; i++) {
+		channel = &pwm->channels[i];
+		channel_start_period(channel, now);
+		queue_write(pwm, &num_writes, channel);
+	}
+
+	if (flush_writes(pwm, num_writes))
+		goto err;
+
+	while (!pwm->stop) {
+		next_ns = UINT64_MAX;
+
+		for (i = 0; i < pwm->num_channels; i++) {
+			if (pwm->channels[i].next_ns < next_ns)
+				next_ns = pwm->channels[i].next_ns;
+		}
+
+		ts.tv_sec = next_ns / NSEC_PER_SEC;
+		ts.tv_nsec = next_ns % NSEC_PER_SEC;
+
+		if (pthread_cond_timedwait(&pwm->cond, &pwm->lock, &ts) == 0)
+			/* Woken up early - check the stop flag. */
+			continue;
+
+		/*
+		 * Merge all transitions that are due now into a single write
+		 * per request, no matter how many lines they concern.
+		 */
+		now = monotonic_ns();
+		num_writes = 0;
+
+		for (i = 0; i < pwm->num_channels; i++) {
+			channel = &pwm->channels[i];
+
+			if (channel->next_ns > now)
+				continue;
+
+			old_value = channel->value;
+			channel_advance(channel);
+
+			if (channel->value != old_value)
+				queue_write(pwm, &num_writes, channel);
+		}
+
+		if (flush_writes(pwm, num_writes))
+			goto err;
+	}
+
+	pthread_mutex_unlock(&pwm->lock);
+
+	return NULL;
+
+err:
+	pwm->error = errno;
+	pthread_mutex_unlock(&pwm->lock);
+
+	return NULL;
+}
+
+GPIOD_API int gpiod_pwm_set_thread_attr(struct gpiod_pwm *pwm,
+					struct gpiod_thread_attr *attr)
+{
+	struct gpiod_thread_attr *copy = NULL;
+
+	assert(pwm);
+
+	if (pwm->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (attr) {
+		copy = gpiod_thread_attr_copy(attr);
+		if (!copy)
+			return -1;
+	}
+
+	gpiod_thread_attr_free(pwm->thread_attr);
+	pwm->thread_attr = copy;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_pwm_start(struct gpiod_pwm *pwm)
+{
+	pthread_attr_t attr;
+	int ret;
+
+	assert(pwm);
+
+	if (pwm->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!pwm->num_channels) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pwm->stop = false;
+	pwm->error = 0;
+
+	pthread_attr_init(&attr);
+
+	if (pwm->thread_attr &&
+	    gpiod_thread_attr_to_pthread(pwm->thread_attr, &attr)) {
+		pthread_attr_destroy(&attr);
+		return -1;
+	}
+
+	ret = pthread_create(&pwm->thread, &attr, pwm_thread_func, pwm);
+	pthread_attr_destroy(&attr);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	pwm->running = true;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_pwm_stop(struct gpiod_pwm *pwm)
+{
+	struct pwm_channel *channel;
+	size_t i, num_writes = 0;
+	int ret;
+
+	assert(pwm);
+
+	if (!pwm->running) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	pthread_mutex_lock(&pwm->lock);
+	pwm->stop = true;
+	pthread_cond_signal(&pwm->cond);
+	pthread_mutex_unlock(&pwm->lock);
+
+	pthread_join(pwm->thread, NULL);
+	pwm->running = false;
+
+	if (pwm->error) {
+		errno = pwm->error;
+		return -1;
+	}
+
+	for (i = 0; i < pwm->num_channels; i++) {
+		channel = &pwm->channels[i];
+		channel->value = false;
+		queue_write(pwm, &num_writes, channel);
+	}
+
+	ret = flush_writes(pwm, num_writes);
+	if (ret)
+		return -1;
+
+	return 0;
+}
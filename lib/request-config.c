@@ -12,13 +12,19 @@
 struct gpiod_request_config {
 	char consumer[GPIO_MAX_NAME_SIZE];
 	size_t event_buffer_size;
+	size_t max_event_buffer_size;
+	bool output_shadow;
+	bool input_shadow;
+	bool nonblocking;
+	bool latency_histogram;
+	bool edge_stats;
 };
 
 GPIOD_API struct gpiod_request_config *gpiod_request_config_new(void)
 {
 	struct gpiod_request_config *config;
 
-	config = malloc(sizeof(*config));
+	config = gpiod_malloc(sizeof(*config));
 	if (!config)
 		return NULL;
 
@@ -29,7 +35,21 @@ GPIOD_API struct gpiod_request_config *gpiod_request_config_new(void)
 
 GPIOD_API void gpiod_request_config_free(struct gpiod_request_config *config)
 {
-	free(config);
+	gpiod_free(config);
+}
+
+struct gpiod_request_config *
+gpiod_request_config_copy(struct gpiod_request_config *config)
+{
+	struct gpiod_request_config *copy;
+
+	copy = gpiod_malloc(sizeof(*copy));
+	if (!copy)
+		return NULL;
+
+	memcpy(copy, config, sizeof(*copy));
+
+	return copy;
 }
 
 GPIOD_API void
@@ -71,9 +91,112 @@ gpiod_request_config_get_event_buffer_size(struct gpiod_request_config *config)
 	return config->event_buffer_size;
 }
 
+GPIOD_API void
+gpiod_request_config_set_max_event_buffer_size(
+		struct gpiod_request_config *config, size_t max_size)
+{
+	assert(config);
+
+	config->max_event_buffer_size = max_size;
+}
+
+GPIOD_API size_t
+gpiod_request_config_get_max_event_buffer_size(
+		struct gpiod_request_config *config)
+{
+	assert(config);
+
+	return config->max_event_buffer_size;
+}
+
+GPIOD_API void
+gpiod_request_config_set_output_shadow(struct gpiod_request_config *config,
+				       bool enabled)
+{
+	assert(config);
+
+	config->output_shadow = enabled;
+}
+
+GPIOD_API bool
+gpiod_request_config_get_output_shadow(struct gpiod_request_config *config)
+{
+	assert(config);
+
+	return config->output_shadow;
+}
+
+GPIOD_API void
+gpiod_request_config_set_input_shadow(struct gpiod_request_config *config,
+				      bool enabled)
+{
+	assert(config);
+
+	config->input_shadow = enabled;
+}
+
+GPIOD_API bool
+gpiod_request_config_get_input_shadow(struct gpiod_request_config *config)
+{
+	assert(config);
+
+	return config->input_shadow;
+}
+
+GPIOD_API void
+gpiod_request_config_set_nonblocking(struct gpiod_request_config *config,
+				     bool enabled)
+{
+	assert(config);
+
+	config->nonblocking = enabled;
+}
+
+GPIOD_API bool
+gpiod_request_config_get_nonblocking(struct gpiod_request_config *config)
+{
+	assert(config);
+
+	return config->nonblocking;
+}
+
 void gpiod_request_config_to_uapi(struct gpiod_request_config *config,
 				  struct gpio_v2_line_request *uapi_req)
 {
 	strcpy(uapi_req->consumer, config->consumer);
 	uapi_req->event_buffer_size = config->event_buffer_size;
 }
+
+GPIOD_API void
+gpiod_request_config_set_latency_histogram(struct gpiod_request_config *config,
+					   bool enabled)
+{
+	assert(config);
+
+	config->latency_histogram = enabled;
+}
+
+GPIOD_API bool
+gpiod_request_config_get_latency_histogram(struct gpiod_request_config *config)
+{
+	assert(config);
+
+	return config->latency_histogram;
+}
+
+GPIOD_API void
+gpiod_request_config_set_edge_stats(struct gpiod_request_config *config,
+				    bool enabled)
+{
+	assert(config);
+
+	config->edge_stats = enabled;
+}
+
+GPIOD_API bool
+gpiod_request_config_get_edge_stats(struct gpiod_request_config *config)
+{
+	assert(config);
+
+	return config->edge_stats;
+}
@@ -0,0 +1,387 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+#define STATE_MAGIC		0x47505253 /* "GPRS" */
+#define STATE_VERSION		1
+
+#define STATE_OUTPUT_SHADOW	(1 << 0)
+#define STATE_INPUT_SHADOW	(1 << 1)
+#define STATE_NONBLOCKING	(1 << 2)
+#define STATE_LATENCY_HISTOGRAM	(1 << 3)
+#define STATE_EDGE_STATS	(1 << 4)
+
+/*
+ * The state is the header followed by the distinct line settings, the offsets
+ * of the lines and, for each line, the index of its settings. All fields are
+ * in host byte order.
+ */
+struct state_header {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t flags;
+	/* Size of the whole state. */
+	uint32_t size;
+	uint32_t event_buffer_size;
+	uint32_t max_event_buffer_size;
+	uint8_t num_lines;
+	uint8_t num_settings;
+	uint16_t padding;
+	char consumer[GPIO_MAX_NAME_SIZE];
+};
+
+struct state_settings {
+	uint32_t debounce_period_us;
+	uint8_t direction;
+	uint8_t edge_detection;
+	uint8_t bias;
+	uint8_t drive;
+	uint8_t event_clock;
+	uint8_t active_low;
+	uint8_t output_value;
+	uint8_t padding;
+};
+
+static size_t state_size(size_t num_lines, size_t num_settings)
+{
+	return sizeof(struct state_header) +
+	       num_settings * sizeof(struct state_settings) +
+	       num_lines * (sizeof(uint32_t) + sizeof(uint8_t));
+}
+
+static void pack_settings(struct state_settings *packed,
+			  struct gpiod_line_settings *settings)
+{
+	memset(packed, 0, sizeof(*packed));
+	packed->debounce_period_us =
+		gpiod_line_settings_get_debounce_period_us(settings);
+	packed->direction = gpiod_line_settings_get_direction(settings);
+	packed->edge_detection =
+		gpiod_line_settings_get_edge_detection(settings);
+	packed->bias = gpiod_line_settings_get_bias(settings);
+	packed->drive = gpiod_line_settings_get_drive(settings);
+	packed->event_clock = gpiod_line_settings_get_event_clock(settings);
+	packed->active_low = gpiod_line_settings_get_active_low(settings);
+	packed->output_value = gpiod_line_settings_get_output_value(settings);
+}
+
+static int unpack_settings(struct gpiod_line_settings *settings,
+			   const struct state_settings *packed)
+{
+	gpiod_line_settings_reset(settings);
+
+	if (gpiod_line_settings_set_direction(settings, packed->direction) ||
+	    gpiod_line_settings_set_edge_detection(settings,
+						   packed->edge_detection) ||
+	    gpiod_line_settings_set_bias(settings, packed->bias) ||
+	    gpiod_line_settings_set_drive(settings, packed->drive) ||
+	    gpiod_line_settings_set_event_clock(settings,
+						packed->event_clock) ||
+	    gpiod_line_settings_set_output_value(settings,
+						 packed->output_value) ||
+	    packed->active_low > 1) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	gpiod_line_settings_set_debounce_period_us(settings,
+						   packed->debounce_period_us);
+	gpiod_line_settings_set_active_low(settings, packed->active_low);
+
+	return 0;
+}
+
+static uint16_t request_config_flags(struct gpiod_request_config *req_cfg)
+{
+	uint16_t flags = 0;
+
+	if (gpiod_request_config_get_output_shadow(req_cfg))
+		flags |= STATE_OUTPUT_SHADOW;
+	if (gpiod_request_config_get_input_shadow(req_cfg))
+		flags |= STATE_INPUT_SHADOW;
+	if (gpiod_request_config_get_nonblocking(req_cfg))
+		flags |= STATE_NONBLOCKING;
+	if (gpiod_request_config_get_latency_histogram(req_cfg))
+		flags |= STATE_LATENCY_HISTOGRAM;
+	if (gpiod_request_config_get_edge_stats(req_cfg))
+		flags |= STATE_EDGE_STATS;
+
+	return flags;
+}
+
+/*
+ * Collect the settings of every line with outputs set to the values the lines
+ * are driven with right now. Lines with equal settings share them.
+ */
+static int collect_settings(struct gpiod_line_request *request,
+			    const unsigned int *offsets, size_t num_lines,
+			    struct state_settings *settings,
+			    size_t *num_settings, uint8_t *line_settings)
+{
+	struct gpiod_line_config *line_cfg;
+	struct gpiod_line_settings *line;
+	uint64_t outputs = 0, values = 0;
+	struct state_settings packed;
+	size_t i, j;
+	int ret;
+
+	line_cfg = gpiod_line_request_get_line_config(request);
+	*num_settings = 0;
+
+	for (i = 0; i < num_lines; i++) {
+		line = gpiod_line_config_get_line_settings(line_cfg,
+							   offsets[i]);
+		if (!line)
+			return -1;
+
+		if (gpiod_line_settings_get_direction(line) ==
+		    GPIOD_LINE_DIRECTION_OUTPUT)
+			outputs |= 1ULL << i;
+
+		gpiod_line_settings_free(line);
+	}
+
+	/* Served from the output shadow without a system call if enabled. */
+	if (outputs) {
+		ret = gpiod_line_request_get_values_mask(request, outputs,
+							 &values);
+		if (ret)
+			return -1;
+	}
+
+	for (i = 0; i < num_lines; i++) {
+		line = gpiod_line_config_get_line_settings(line_cfg,
+							   offsets[i]);
+		if (!line)
+			return -1;
+
+		if (outputs & (1ULL << i))
+			gpiod_line_settings_set_output_value(line,
+					values & (1ULL << i) ?
+						GPIOD_LINE_VALUE_ACTIVE :
+						GPIOD_LINE_VALUE_INACTIVE);
+
+		pack_settings(&packed, line);
+		gpiod_line_settings_free(line);
+
+		for (j = 0; j < *num_settings; j++) {
+			if (!memcmp(&settings[j], &packed, sizeof(packed)))
+				break;
+		}
+
+		if (j == *num_settings)
+			settings[(*num_settings)++] = packed;
+
+		line_settings[i] = j;
+	}
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_line_request_save_state(struct gpiod_line_request *request, void *buf,
+			      size_t size)
+{
+	struct state_settings settings[GPIO_V2_LINES_MAX];
+	uint8_t line_settings[GPIO_V2_LINES_MAX];
+	unsigned int offsets[GPIO_V2_LINES_MAX];
+	struct gpiod_request_config *req_cfg;
+	size_t num_lines, num_settings, i;
+	struct state_header hdr;
+	const char *consumer;
+	uint32_t offset;
+	char *pos = buf;
+	int ret;
+
+	assert(request);
+
+	num_lines = gpiod_line_request_get_requested_offsets(request, offsets,
+							     GPIO_V2_LINES_MAX);
+
+	ret = collect_settings(request, offsets, num_lines, settings,
+			       &num_settings, line_settings);
+	if (ret)
+		return -1;
+
+	req_cfg = gpiod_request_config_new();
+	if (!req_cfg)
+		return -1;
+
+	gpiod_line_request_get_request_config(request, req_cfg);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = STATE_MAGIC;
+	hdr.version = STATE_VERSION;
+	hdr.flags = request_config_flags(req_cfg);
+	hdr.size = state_size(num_lines, num_settings);
+	hdr.event_buffer_size =
+		gpiod_request_config_get_event_buffer_size(req_cfg);
+	hdr.max_event_buffer_size =
+		gpiod_request_config_get_max_event_buffer_size(req_cfg);
+	hdr.num_lines = num_lines;
+	hdr.num_settings = num_settings;
+
+	consumer = gpiod_request_config_get_consumer(req_cfg);
+	if (consumer)
+		memcpy(hdr.consumer, consumer, strlen(consumer));
+
+	gpiod_request_config_free(req_cfg);
+
+	if (!buf || size < hdr.size)
+		return hdr.size;
+
+	memcpy(pos, &hdr, sizeof(hdr));
+	pos += sizeof(hdr);
+	memcpy(pos, settings, num_settings * sizeof(*settings));
+	pos += num_settings * sizeof(*settings);
+
+	for (i = 0; i < num_lines; i++) {
+		offset = offsets[i];
+		memcpy(pos, &offset, sizeof(offset));
+		pos += sizeof(offset);
+	}
+
+	memcpy(pos, line_settings, num_lines);
+
+	return hdr.size;
+}
+
+static void load_request_config(const struct state_header *hdr,
+				struct gpiod_request_config *req_cfg)
+{
+	char consumer[GPIO_MAX_NAME_SIZE];
+
+	memcpy(consumer, hdr->consumer, sizeof(consumer));
+	consumer[GPIO_MAX_NAME_SIZE - 1] = '\0';
+
+	gpiod_request_config_set_consumer(req_cfg,
+					  consumer[0] ? consumer : NULL);
+	gpiod_request_config_set_event_buffer_size(req_cfg,
+						   hdr->event_buffer_size);
+	gpiod_request_config_set_max_event_buffer_size(
+				req_cfg, hdr->max_event_buffer_size);
+	gpiod_request_config_set_output_shadow(req_cfg,
+				hdr->flags & STATE_OUTPUT_SHADOW);
+	gpiod_request_config_set_input_shadow(req_cfg,
+				hdr->flags & STATE_INPUT_SHADOW);
+	gpiod_request_config_set_nonblocking(req_cfg,
+				hdr->flags & STATE_NONBLOCKING);
+	gpiod_request_config_set_latency_histogram(req_cfg,
+				hdr->flags & STATE_LATENCY_HISTOGRAM);
+	gpiod_request_config_set_edge_stats(req_cfg,
+				hdr->flags & STATE_EDGE_STATS);
+}
+
+static int load_line_config(const struct state_header *hdr, const char *data,
+			    struct gpiod_line_config *line_cfg)
+{
+	const char *offsets, *line_settings;
+	struct state_settings packed;
+	struct gpiod_line_settings *settings;
+	uint32_t offset;
+	size_t i;
+	int ret = -1;
+
+	offsets = data + hdr->num_settings * sizeof(packed);
+	line_settings = offsets + hdr->num_lines * sizeof(offset);
+
+	settings = gpiod_line_settings_new();
+	if (!settings)
+		return -1;
+
+	gpiod_line_config_reset(line_cfg);
+
+	for (i = 0; i < hdr->num_lines; i++) {
+		if ((uint8_t)line_settings[i] >= hdr->num_settings) {
+			errno = EINVAL;
+			goto out;
+		}
+
+		memcpy(&packed, data + (uint8_t)line_settings[i] *
+							sizeof(packed),
+		       sizeof(packed));
+		memcpy(&offset, offsets + i * sizeof(offset), sizeof(offset));
+
+		if (unpack_settings(settings, &packed))
+			goto out;
+
+		if (gpiod_line_config_add_line_settings(line_cfg, &offset, 1,
+							settings))
+			goto out;
+	}
+
+	ret = 0;
+
+out:
+	gpiod_line_settings_free(settings);
+
+	return ret;
+}
+
+GPIOD_API int gpiod_request_state_load(const void *buf, size_t size,
+				       struct gpiod_request_config *req_cfg,
+				       struct gpiod_line_config *line_cfg)
+{
+	struct state_header hdr;
+
+	assert(line_cfg);
+
+	if (!buf || size < sizeof(hdr)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memcpy(&hdr, buf, sizeof(hdr));
+
+	if (hdr.magic != STATE_MAGIC || hdr.version != STATE_VERSION ||
+	    !hdr.num_lines || hdr.num_lines > GPIO_V2_LINES_MAX ||
+	    !hdr.num_settings || hdr.num_settings > hdr.num_lines ||
+	    hdr.size != state_size(hdr.num_lines, hdr.num_settings) ||
+	    size < hdr.size) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (load_line_config(&hdr, (const char *)buf + sizeof(hdr), line_cfg))
+		return -1;
+
+	if (req_cfg)
+		load_request_config(&hdr, req_cfg);
+
+	return 0;
+}
+
+GPIOD_API struct gpiod_line_request *
+gpiod_chip_request_lines_from_state(struct gpiod_chip *chip, const void *buf,
+				    size_t size)
+{
+	struct gpiod_line_request *request = NULL;
+	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_config *line_cfg;
+
+	assert(chip);
+
+	req_cfg = gpiod_request_config_new();
+	line_cfg = gpiod_line_config_new();
+	if (!req_cfg || !line_cfg)
+		goto out;
+
+	if (gpiod_request_state_load(buf, size, req_cfg, line_cfg))
+		goto out;
+
+	request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+
+out:
+	gpiod_line_config_free(line_cfg);
+	gpiod_request_config_free(req_cfg);
+
+	return request;
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+
+struct gpiod_request_template {
+	struct gpio_v2_line_request uapi_req;
+	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_config *line_cfg;
+};
+
+GPIOD_API struct gpiod_request_template *
+gpiod_request_template_new(struct gpiod_request_config *req_cfg,
+			   struct gpiod_line_config *line_cfg)
+{
+	struct gpiod_request_template *tmpl;
+	int ret;
+
+	if (!line_cfg) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	tmpl = gpiod_malloc(sizeof(*tmpl));
+	if (!tmpl)
+		return NULL;
+
+	memset(tmpl, 0, sizeof(*tmpl));
+
+	if (req_cfg)
+		gpiod_request_config_to_uapi(req_cfg, &tmpl->uapi_req);
+
+	ret = gpiod_line_config_to_uapi(line_cfg, &tmpl->uapi_req);
+	if (ret)
+		goto err_free_tmpl;
+
+	if (!tmpl->uapi_req.num_lines) {
+		errno = EINVAL;
+		goto err_free_tmpl;
+	}
+
+	/* Still needed to set up the request objects. */
+	tmpl->line_cfg = gpiod_line_config_copy(line_cfg);
+	if (!tmpl->line_cfg)
+		goto err_free_tmpl;
+
+	if (req_cfg) {
+		tmpl->req_cfg = gpiod_request_config_copy(req_cfg);
+		if (!tmpl->req_cfg)
+			goto err_free_line_cfg;
+	}
+
+	return tmpl;
+
+err_free_line_cfg:
+	gpiod_line_config_free(tmpl->line_cfg);
+err_free_tmpl:
+	gpiod_free(tmpl);
+	return NULL;
+}
+
+GPIOD_API void gpiod_request_template_free(struct gpiod_request_template *tmpl)
+{
+	if (!tmpl)
+		return;
+
+	gpiod_request_config_free(tmpl->req_cfg);
+	gpiod_line_config_free(tmpl->line_cfg);
+	gpiod_free(tmpl);
+}
+
+GPIOD_API size_t
+gpiod_request_template_get_num_lines(struct gpiod_request_template *tmpl)
+{
+	assert(tmpl);
+
+	return tmpl->uapi_req.num_lines;
+}
+
+void gpiod_request_template_get_uapi(struct gpiod_request_template *tmpl,
+				     struct gpio_v2_line_request *uapi_req)
+{
+	memcpy(uapi_req, &tmpl->uapi_req, sizeof(*uapi_req));
+}
+
+struct gpiod_request_config *
+gpiod_request_template_get_request_config(struct gpiod_request_template *tmpl)
+{
+	return tmpl->req_cfg;
+}
+
+struct gpiod_line_config *
+gpiod_request_template_get_line_config(struct gpiod_request_template *tmpl)
+{
+	return tmpl->line_cfg;
+}
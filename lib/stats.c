@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+
+#include "internal.h"
+
+struct gpiod_stats {
+	uint64_t num_ioctls[GPIOD_STATS_IOCTL_NUM_TYPES];
+	uint64_t num_reads;
+	uint64_t num_events_read;
+	uint64_t num_bytes_read;
+	uint64_t ioctl_time_ns;
+	uint64_t max_ioctl_time_ns;
+	uint64_t wait_time_ns;
+	/* Only kept for the tracepoints of the callers. */
+	uint64_t last_ioctl_time_ns;
+};
+
+static void stat_add(uint64_t *stat, uint64_t val)
+{
+	__atomic_fetch_add(stat, val, __ATOMIC_RELAXED);
+}
+
+static void stat_max(uint64_t *stat, uint64_t val)
+{
+	uint64_t cur = __atomic_load_n(stat, __ATOMIC_RELAXED);
+
+	while (val > cur &&
+	       !__atomic_compare_exchange_n(stat, &cur, val, true,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+struct gpiod_stats *gpiod_stats_new(void)
+{
+	struct gpiod_stats *stats;
+
+	stats = gpiod_malloc(sizeof(*stats));
+	if (!stats)
+		return NULL;
+
+	gpiod_stats_reset(stats);
+
+	return stats;
+}
+
+struct gpiod_stats *gpiod_stats_copy(struct gpiod_stats *stats)
+{
+	struct gpiod_stats *copy;
+
+	copy = gpiod_malloc(sizeof(*copy));
+	if (!copy)
+		return NULL;
+
+	memcpy(copy, stats, sizeof(*copy));
+
+	return copy;
+}
+
+void gpiod_stats_reset(struct gpiod_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
+
+uint64_t gpiod_stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int gpiod_stats_ioctl(struct gpiod_stats *stats,
+		      enum gpiod_stats_ioctl_type type, int fd,
+		      unsigned long cmd, void *arg)
+{
+	uint64_t start, elapsed;
+	int ret, errsv;
+
+	start = gpiod_stats_now();
+	ret = gpiod_sys_ioctl(fd, cmd, arg);
+	errsv = errno;
+	elapsed = gpiod_stats_now() - start;
+
+	/*
+	 * Failed calls cost the same round trip into the kernel. Threads
+	 * sharing a request update the counters concurrently.
+	 */
+	stat_add(&stats->num_ioctls[type], 1);
+	stat_add(&stats->ioctl_time_ns, elapsed);
+	stat_max(&stats->max_ioctl_time_ns, elapsed);
+	__atomic_store_n(&stats->last_ioctl_time_ns, elapsed, __ATOMIC_RELAXED);
+
+	gpiod_trace(ioctl, fd, type, cmd, ret, elapsed);
+
+	errno = errsv;
+
+	return ret;
+}
+
+void gpiod_stats_add_read(struct gpiod_stats *stats, size_t num_bytes,
+			  size_t num_events)
+{
+	stat_add(&stats->num_reads, 1);
+	stat_add(&stats->num_bytes_read, num_bytes);
+	stat_add(&stats->num_events_read, num_events);
+}
+
+void gpiod_stats_add_wait(struct gpiod_stats *stats, uint64_t start_ns)
+{
+	stat_add(&stats->wait_time_ns, gpiod_stats_now() - start_ns);
+}
+
+uint64_t gpiod_stats_get_last_ioctl_time_ns(struct gpiod_stats *stats)
+{
+	return __atomic_load_n(&stats->last_ioctl_time_ns, __ATOMIC_RELAXED);
+}
+
+GPIOD_API void gpiod_stats_free(struct gpiod_stats *stats)
+{
+	gpiod_free(stats);
+}
+
+GPIOD_API uint64_t gpiod_stats_get_num_get_ioctls(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_ioctls[GPIOD_STATS_IOCTL_GET];
+}
+
+GPIOD_API uint64_t gpiod_stats_get_num_set_ioctls(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_ioctls[GPIOD_STATS_IOCTL_SET];
+}
+
+GPIOD_API uint64_t
+gpiod_stats_get_num_config_ioctls(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_ioctls[GPIOD_STATS_IOCTL_CONFIG];
+}
+
+GPIOD_API uint64_t gpiod_stats_get_num_info_ioctls(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_ioctls[GPIOD_STATS_IOCTL_INFO];
+}
+
+GPIOD_API uint64_t gpiod_stats_get_num_reads(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_reads;
+}
+
+GPIOD_API uint64_t gpiod_stats_get_num_events_read(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_events_read;
+}
+
+GPIOD_API uint64_t gpiod_stats_get_num_bytes_read(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->num_bytes_read;
+}
+
+GPIOD_API uint64_t gpiod_stats_get_ioctl_time_ns(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->ioctl_time_ns;
+}
+
+GPIOD_API uint64_t
+gpiod_stats_get_max_ioctl_time_ns(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->max_ioctl_time_ns;
+}
+
+GPIOD_API uint64_t gpiod_stats_get_wait_time_ns(struct gpiod_stats *stats)
+{
+	assert(stats);
+
+	return stats->wait_time_ns;
+}
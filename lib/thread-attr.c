@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "internal.h"
+
+struct gpiod_thread_attr {
+	int priority;
+	int cpu;
+	bool lock_memory;
+};
+
+struct gpiod_thread_state {
+	int policy;
+	struct sched_param param;
+	cpu_set_t cpus;
+};
+
+GPIOD_API struct gpiod_thread_attr *gpiod_thread_attr_new(void)
+{
+	struct gpiod_thread_attr *attr;
+
+	attr = gpiod_malloc(sizeof(*attr));
+	if (!attr)
+		return NULL;
+
+	memset(attr, 0, sizeof(*attr));
+	attr->cpu = -1;
+
+	return attr;
+}
+
+GPIOD_API void gpiod_thread_attr_free(struct gpiod_thread_attr *attr)
+{
+	gpiod_free(attr);
+}
+
+GPIOD_API int gpiod_thread_attr_set_realtime(struct gpiod_thread_attr *attr,
+					     int priority)
+{
+	assert(attr);
+
+	if (priority &&
+	    (priority < sched_get_priority_min(SCHED_FIFO) ||
+	     priority > sched_get_priority_max(SCHED_FIFO))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	attr->priority = priority;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_thread_attr_get_realtime(struct gpiod_thread_attr *attr)
+{
+	assert(attr);
+
+	return attr->priority;
+}
+
+GPIOD_API int gpiod_thread_attr_set_cpu(struct gpiod_thread_attr *attr,
+					int cpu)
+{
+	assert(attr);
+
+	if (cpu >= CPU_SETSIZE) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	attr->cpu = cpu < 0 ? -1 : cpu;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_thread_attr_get_cpu(struct gpiod_thread_attr *attr)
+{
+	assert(attr);
+
+	return attr->cpu;
+}
+
+GPIOD_API void gpiod_thread_attr_set_lock_memory(struct gpiod_thread_attr *attr,
+						 bool lock)
+{
+	assert(attr);
+
+	attr->lock_memory = lock;
+}
+
+GPIOD_API bool
+gpiod_thread_attr_get_lock_memory(struct gpiod_thread_attr *attr)
+{
+	assert(attr);
+
+	return attr->lock_memory;
+}
+
+static int lock_memory(struct gpiod_thread_attr *attr)
+{
+	if (attr->lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE))
+		return -1;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_thread_attr_apply(struct gpiod_thread_attr *attr)
+{
+	struct sched_param param;
+	cpu_set_t cpus;
+	int ret;
+
+	assert(attr);
+
+	if (lock_memory(attr))
+		return -1;
+
+	if (attr->cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(attr->cpu, &cpus);
+
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus),
+					     &cpus);
+		if (ret) {
+			errno = ret;
+			return -1;
+		}
+	}
+
+	if (attr->priority) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = attr->priority;
+
+		ret = pthread_setschedparam(pthread_self(), SCHED_FIFO,
+					    &param);
+		if (ret) {
+			errno = ret;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+struct gpiod_thread_attr *
+gpiod_thread_attr_copy(struct gpiod_thread_attr *attr)
+{
+	struct gpiod_thread_attr *copy;
+
+	copy = gpiod_malloc(sizeof(*copy));
+	if (!copy)
+		return NULL;
+
+	memcpy(copy, attr, sizeof(*copy));
+
+	return copy;
+}
+
+int gpiod_thread_attr_to_pthread(struct gpiod_thread_attr *attr,
+				 pthread_attr_t *pattr)
+{
+	struct sched_param param;
+	cpu_set_t cpus;
+	int ret;
+
+	if (lock_memory(attr))
+		return -1;
+
+	if (attr->cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(attr->cpu, &cpus);
+
+		ret = pthread_attr_setaffinity_np(pattr, sizeof(cpus), &cpus);
+		if (ret)
+			goto err;
+	}
+
+	if (attr->priority) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = attr->priority;
+
+		ret = pthread_attr_setinheritsched(pattr,
+						   PTHREAD_EXPLICIT_SCHED);
+		if (!ret)
+			ret = pthread_attr_setschedpolicy(pattr, SCHED_FIFO);
+		if (!ret)
+			ret = pthread_attr_setschedparam(pattr, &param);
+		if (ret)
+			goto err;
+	}
+
+	return 0;
+
+err:
+	errno = ret;
+	return -1;
+}
+
+struct gpiod_thread_state *gpiod_thread_state_save(void)
+{
+	struct gpiod_thread_state *state;
+	int ret;
+
+	state = gpiod_malloc(sizeof(*state));
+	if (!state)
+		return NULL;
+
+	ret = pthread_getschedparam(pthread_self(), &state->policy,
+				    &state->param);
+	if (!ret)
+		ret = pthread_getaffinity_np(pthread_self(),
+					     sizeof(state->cpus), &state->cpus);
+	if (ret) {
+		gpiod_free(state);
+		errno = ret;
+		return NULL;
+	}
+
+	return state;
+}
+
+void gpiod_thread_state_restore(struct gpiod_thread_state *state)
+{
+	/* Best effort - the caller's own error is more interesting. */
+	pthread_setschedparam(pthread_self(), state->policy, &state->param);
+	pthread_setaffinity_np(pthread_self(), sizeof(state->cpus),
+			       &state->cpus);
+	gpiod_free(state);
+}
@@ -0,0 +1,353 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * Minimal io_uring wrapper using raw system calls. We only need a tiny subset
+ * of the interface - queueing reads and cancellations and reaping their
+ * completions - which doesn't justify a dependency on liburing.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#endif
+
+#if defined(IORING_FEAT_EXT_ARG)
+
+struct gpiod_uring {
+	int fd;
+	unsigned int to_submit;
+
+	void *sq_ring;
+	size_t sq_ring_size;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_entries;
+	unsigned int *sq_array;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+
+	void *cq_ring;
+	size_t cq_ring_size;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+};
+
+static void *ring_ptr(void *ring, unsigned int offset)
+{
+	return (char *)ring + offset;
+}
+
+struct gpiod_uring *gpiod_uring_new(unsigned int entries)
+{
+	struct io_uring_params params;
+	struct gpiod_uring *ring;
+
+	ring = gpiod_malloc(sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	memset(ring, 0, sizeof(*ring));
+	memset(&params, 0, sizeof(params));
+
+	ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (ring->fd < 0)
+		goto err_free_ring;
+
+	fcntl(ring->fd, F_SETFD, FD_CLOEXEC);
+
+	/* We need the timeout argument to io_uring_enter(). */
+	if (!(params.features & IORING_FEAT_EXT_ARG)) {
+		errno = ENOTSUP;
+		goto err_close_fd;
+	}
+
+	ring->sq_ring_size = params.sq_off.array +
+			     params.sq_entries * sizeof(unsigned int);
+	ring->cq_ring_size = params.cq_off.cqes +
+			     params.cq_entries * sizeof(struct io_uring_cqe);
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_ring_size > ring->sq_ring_size)
+			ring->sq_ring_size = ring->cq_ring_size;
+		ring->cq_ring_size = 0;
+	}
+
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+			     MAP_SHARED | MAP_POPULATE, ring->fd,
+			     IORING_OFF_SQ_RING);
+	if (ring->sq_ring == MAP_FAILED)
+		goto err_close_fd;
+
+	if (ring->cq_ring_size) {
+		ring->cq_ring = mmap(NULL, ring->cq_ring_size,
+				     PROT_READ | PROT_WRITE,
+				     MAP_SHARED | MAP_POPULATE, ring->fd,
+				     IORING_OFF_CQ_RING);
+		if (ring->cq_ring == MAP_FAILED)
+			goto err_unmap_sq;
+	} else {
+		ring->cq_ring = ring->sq_ring;
+	}
+
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, ring->fd,
+			  IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED)
+		goto err_unmap_cq;
+
+	ring->sq_head = ring_ptr(ring->sq_ring, params.sq_off.head);
+	ring->sq_tail = ring_ptr(ring->sq_ring, params.sq_off.tail);
+	ring->sq_mask = ring_ptr(ring->sq_ring, params.sq_off.ring_mask);
+	ring->sq_entries = ring_ptr(ring->sq_ring, params.sq_off.ring_entries);
+	ring->sq_array = ring_ptr(ring->sq_ring, params.sq_off.array);
+
+	ring->cq_head = ring_ptr(ring->cq_ring, params.cq_off.head);
+	ring->cq_tail = ring_ptr(ring->cq_ring, params.cq_off.tail);
+	ring->cq_mask = ring_ptr(ring->cq_ring, params.cq_off.ring_mask);
+	ring->cqes = ring_ptr(ring->cq_ring, params.cq_off.cqes);
+
+	return ring;
+
+err_unmap_cq:
+	if (ring->cq_ring_size)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+err_unmap_sq:
+	munmap(ring->sq_ring, ring->sq_ring_size);
+err_close_fd:
+	close(ring->fd);
+err_free_ring:
+	gpiod_free(ring);
+
+	return NULL;
+}
+
+void gpiod_uring_free(struct gpiod_uring *ring)
+{
+	if (!ring)
+		return;
+
+	munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring_size)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	munmap(ring->sq_ring, ring->sq_ring_size);
+	close(ring->fd);
+	gpiod_free(ring);
+}
+
+int gpiod_uring_get_fd(struct gpiod_uring *ring)
+{
+	return ring->fd;
+}
+
+static int enter(struct gpiod_uring *ring, unsigned int min_complete,
+		 int64_t timeout_ns)
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	unsigned int flags = 0;
+	int ret;
+
+	memset(&arg, 0, sizeof(arg));
+	arg.sigmask_sz = _NSIG / 8;
+
+	if (min_complete) {
+		flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+
+		if (timeout_ns >= 0) {
+			ts.tv_sec = timeout_ns / 1000000000LL;
+			ts.tv_nsec = timeout_ns % 1000000000LL;
+			arg.ts = (uint64_t)(uintptr_t)&ts;
+		}
+	}
+
+	ret = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit,
+		      min_complete, flags, min_complete ? &arg : NULL,
+		      min_complete ? sizeof(arg) : 0);
+	if (ret < 0)
+		return -1;
+
+	ring->to_submit -= ret;
+
+	return 0;
+}
+
+static struct io_uring_sqe *get_sqe(struct gpiod_uring *ring)
+{
+	unsigned int head, tail;
+	int ret;
+
+	tail = *ring->sq_tail;
+	head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	if (tail - head >= *ring->sq_entries) {
+		/* Submission queue full - push what we have to the kernel. */
+		ret = enter(ring, 0, 0);
+		if (ret)
+			return NULL;
+
+		head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+		if (tail - head >= *ring->sq_entries) {
+			errno = EBUSY;
+			return NULL;
+		}
+	}
+
+	return &ring->sqes[tail & *ring->sq_mask];
+}
+
+static void commit_sqe(struct gpiod_uring *ring)
+{
+	unsigned int tail = *ring->sq_tail;
+
+	ring->sq_array[tail & *ring->sq_mask] = tail & *ring->sq_mask;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+}
+
+int gpiod_uring_queue_read(struct gpiod_uring *ring, int fd, void *buf,
+			   size_t len, uint64_t user_data)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = get_sqe(ring);
+	if (!sqe)
+		return -1;
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)buf;
+	sqe->len = len;
+	/* Character devices don't have a file position. */
+	sqe->off = (uint64_t)-1;
+	sqe->user_data = user_data;
+
+	commit_sqe(ring);
+
+	return 0;
+}
+
+int gpiod_uring_queue_cancel(struct gpiod_uring *ring, uint64_t target,
+			     uint64_t user_data)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = get_sqe(ring);
+	if (!sqe)
+		return -1;
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = target;
+	sqe->user_data = user_data;
+
+	commit_sqe(ring);
+
+	return 0;
+}
+
+static bool cq_ready(struct gpiod_uring *ring)
+{
+	return *ring->cq_head !=
+	       __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+}
+
+int gpiod_uring_wait(struct gpiod_uring *ring, int64_t timeout_ns)
+{
+	int ret;
+
+	/* Submit pending requests and only block if nothing completed yet. */
+	ret = enter(ring, cq_ready(ring) ? 0 : 1, timeout_ns);
+	if (ret) {
+		if (errno == ETIME)
+			return cq_ready(ring) ? 1 : 0;
+
+		return -1;
+	}
+
+	return cq_ready(ring) ? 1 : 0;
+}
+
+bool gpiod_uring_reap(struct gpiod_uring *ring, uint64_t *user_data, int *res)
+{
+	struct io_uring_cqe *cqe;
+	unsigned int head;
+
+	if (!cq_ready(ring))
+		return false;
+
+	head = *ring->cq_head;
+	cqe = &ring->cqes[head & *ring->cq_mask];
+	*user_data = cqe->user_data;
+	*res = cqe->res;
+
+	__atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+#else /* !IORING_FEAT_EXT_ARG */
+
+struct gpiod_uring *gpiod_uring_new(unsigned int entries GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return NULL;
+}
+
+void gpiod_uring_free(struct gpiod_uring *ring GPIOD_UNUSED)
+{
+
+}
+
+int gpiod_uring_get_fd(struct gpiod_uring *ring GPIOD_UNUSED)
+{
+	return -1;
+}
+
+int gpiod_uring_queue_read(struct gpiod_uring *ring GPIOD_UNUSED,
+			   int fd GPIOD_UNUSED, void *buf GPIOD_UNUSED,
+			   size_t len GPIOD_UNUSED,
+			   uint64_t user_data GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+int gpiod_uring_queue_cancel(struct gpiod_uring *ring GPIOD_UNUSED,
+			     uint64_t target GPIOD_UNUSED,
+			     uint64_t user_data GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+int gpiod_uring_wait(struct gpiod_uring *ring GPIOD_UNUSED,
+		     int64_t timeout_ns GPIOD_UNUSED)
+{
+	errno = ENOTSUP;
+	return -1;
+}
+
+bool gpiod_uring_reap(struct gpiod_uring *ring GPIOD_UNUSED,
+		      uint64_t *user_data GPIOD_UNUSED, int *res GPIOD_UNUSED)
+{
+	return false;
+}
+
+#endif /* IORING_FEAT_EXT_ARG */
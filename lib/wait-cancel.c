@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+struct gpiod_wait_cancel {
+	int fd;
+};
+
+GPIOD_API struct gpiod_wait_cancel *gpiod_wait_cancel_new(void)
+{
+	struct gpiod_wait_cancel *cancel;
+
+	cancel = gpiod_malloc(sizeof(*cancel));
+	if (!cancel)
+		return NULL;
+
+	cancel->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (cancel->fd < 0) {
+		gpiod_free(cancel);
+		return NULL;
+	}
+
+	return cancel;
+}
+
+GPIOD_API void gpiod_wait_cancel_free(struct gpiod_wait_cancel *cancel)
+{
+	if (!cancel)
+		return;
+
+	close(cancel->fd);
+	gpiod_free(cancel);
+}
+
+GPIOD_API int gpiod_wait_cancel_trigger(struct gpiod_wait_cancel *cancel)
+{
+	uint64_t val = 1;
+	ssize_t ret;
+
+	assert(cancel);
+
+	/*
+	 * The counter is only ever read back to zero so it can't overflow in
+	 * practice - EAGAIN would mean it's already triggered anyway.
+	 */
+	ret = write(cancel->fd, &val, sizeof(val));
+	if (ret < 0 && errno != EAGAIN)
+		return -1;
+
+	return 0;
+}
+
+GPIOD_API int gpiod_wait_cancel_reset(struct gpiod_wait_cancel *cancel)
+{
+	uint64_t val;
+	ssize_t ret;
+
+	assert(cancel);
+
+	ret = read(cancel->fd, &val, sizeof(val));
+	if (ret < 0 && errno != EAGAIN)
+		return -1;
+
+	return 0;
+}
+
+GPIOD_API bool gpiod_wait_cancel_is_triggered(struct gpiod_wait_cancel *cancel)
+{
+	assert(cancel);
+
+	return gpiod_poll_fd(cancel->fd, 0) > 0;
+}
+
+GPIOD_API int gpiod_wait_cancel_get_fd(struct gpiod_wait_cancel *cancel)
+{
+	assert(cancel);
+
+	return cancel->fd;
+}
+
+int gpiod_poll_fd_cancellable(int fd, int64_t timeout_ns,
+			      struct gpiod_wait_cancel *cancel)
+{
+	struct pollfd pfds[2];
+	struct timespec ts;
+	int ret;
+
+	if (!cancel) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memset(pfds, 0, sizeof(pfds));
+	pfds[0].fd = fd;
+	pfds[0].events = POLLIN | POLLPRI;
+	pfds[1].fd = cancel->fd;
+	pfds[1].events = POLLIN;
+
+	if (timeout_ns >= 0) {
+		ts.tv_sec = timeout_ns / 1000000000ULL;
+		ts.tv_nsec = timeout_ns % 1000000000ULL;
+	}
+
+	ret = ppoll(pfds, 2, timeout_ns < 0 ? NULL : &ts, NULL);
+	if (ret < 0)
+		return -1;
+	else if (ret == 0)
+		return 0;
+
+	/* Cancellation takes precedence over pending events. */
+	if (pfds[1].revents) {
+		errno = ECANCELED;
+		return -1;
+	}
+
+	return 1;
+}
@@ -0,0 +1,277 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+
+struct waveform_step {
+	struct gpiod_line_request *request;
+	uint64_t time_ns;
+	uint64_t mask;
+	uint64_t values;
+};
+
+struct gpiod_waveform {
+	struct waveform_step *steps;
+	size_t num_steps;
+	size_t max_steps;
+	uint64_t period_ns;
+	uint64_t num_cycles;
+	gpiod_waveform_step_cb step_cb;
+	void *step_cb_data;
+	struct gpiod_thread_attr *thread_attr;
+};
+
+GPIOD_API struct gpiod_waveform *gpiod_waveform_new(void)
+{
+	struct gpiod_waveform *waveform;
+
+	waveform = gpiod_malloc(sizeof(*waveform));
+	if (!waveform)
+		return NULL;
+
+	memset(waveform, 0, sizeof(*waveform));
+
+	return waveform;
+}
+
+GPIOD_API void gpiod_waveform_free(struct gpiod_waveform *waveform)
+{
+	if (!waveform)
+		return;
+
+	gpiod_thread_attr_free(waveform->thread_attr);
+	gpiod_free(waveform->steps);
+	gpiod_free(waveform);
+}
+
+GPIOD_API int gpiod_waveform_add_step(struct gpiod_waveform *waveform,
+				      struct gpiod_line_request *request,
+				      uint64_t time_ns, uint64_t mask,
+				      uint64_t values)
+{
+	struct waveform_step *steps, *step;
+	size_t max_steps;
+
+	assert(waveform);
+
+	if (!request || (waveform->num_steps &&
+	    time_ns < waveform->steps[waveform->num_steps - 1].time_ns)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (waveform->num_steps == waveform->max_steps) {
+		max_steps = waveform->max_steps ? waveform->max_steps * 2 : 16;
+
+		steps = gpiod_realloc(waveform->steps,
+				      sizeof(*steps) * waveform->max_steps,
+				      sizeof(*steps) * max_steps);
+		if (!steps)
+			return -1;
+
+		waveform->steps = steps;
+		waveform->max_steps = max_steps;
+	}
+
+	step = &waveform->steps[waveform->num_steps++];
+	step->request = request;
+	step->time_ns = time_ns;
+	step->mask = mask;
+	step->values = values;
+
+	return 0;
+}
+
+GPIOD_API size_t gpiod_waveform_get_num_steps(struct gpiod_waveform *waveform)
+{
+	assert(waveform);
+
+	return waveform->num_steps;
+}
+
+GPIOD_API void gpiod_waveform_set_period_ns(struct gpiod_waveform *waveform,
+					    uint64_t period_ns)
+{
+	assert(waveform);
+
+	waveform->period_ns = period_ns;
+}
+
+GPIOD_API uint64_t gpiod_waveform_get_period_ns(struct gpiod_waveform *waveform)
+{
+	assert(waveform);
+
+	return waveform->period_ns;
+}
+
+GPIOD_API void gpiod_waveform_set_num_cycles(struct gpiod_waveform *waveform,
+					     uint64_t num_cycles)
+{
+	assert(waveform);
+
+	waveform->num_cycles = num_cycles;
+}
+
+GPIOD_API uint64_t
+gpiod_waveform_get_num_cycles(struct gpiod_waveform *waveform)
+{
+	assert(waveform);
+
+	return waveform->num_cycles;
+}
+
+GPIOD_API void gpiod_waveform_set_step_callback(struct gpiod_waveform *waveform,
+						gpiod_waveform_step_cb cb,
+						void *user_data)
+{
+	assert(waveform);
+
+	waveform->step_cb = cb;
+	waveform->step_cb_data = user_data;
+}
+
+static uint64_t timespec_to_ns(const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static int sleep_until(uint64_t deadline_ns)
+{
+	struct timespec ts;
+	int ret;
+
+	ts.tv_sec = deadline_ns / NSEC_PER_SEC;
+	ts.tv_nsec = deadline_ns % NSEC_PER_SEC;
+
+	do {
+		ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+	} while (ret == EINTR);
+
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_API int
+gpiod_waveform_set_thread_attr(struct gpiod_waveform *waveform,
+			       struct gpiod_thread_attr *attr)
+{
+	struct gpiod_thread_attr *copy = NULL;
+
+	assert(waveform);
+
+	if (attr) {
+		copy = gpiod_thread_attr_copy(attr);
+		if (!copy)
+			return -1;
+	}
+
+	gpiod_thread_attr_free(waveform->thread_attr);
+	waveform->thread_attr = copy;
+
+	return 0;
+}
+
+static int play_waveform(struct gpiod_waveform *waveform)
+{
+	uint64_t start_ns, cycle_ns, deadline_ns, cycle;
+	struct waveform_step *step;
+	struct timespec now;
+	int64_t lateness;
+	size_t i;
+	int ret;
+
+	ret = clock_gettime(CLOCK_MONOTONIC, &now);
+	if (ret)
+		return -1;
+
+	start_ns = timespec_to_ns(&now);
+
+	for (cycle = 0; ; cycle++) {
+		/*
+		 * All deadlines are derived from the start time rather than
+		 * from the previous wake-up so that the error doesn't
+		 * accumulate over the run.
+		 */
+		cycle_ns = start_ns + cycle * waveform->period_ns;
+
+		for (i = 0; i < waveform->num_steps; i++) {
+			step = &waveform->steps[i];
+			deadline_ns = cycle_ns + step->time_ns;
+
+			ret = sleep_until(deadline_ns);
+			if (ret)
+				return -1;
+
+			ret = clock_gettime(CLOCK_MONOTONIC, &now);
+			if (ret)
+				return -1;
+
+			lateness = timespec_to_ns(&now) - deadline_ns;
+
+			ret = gpiod_line_request_set_values_mask(step->request,
+								 step->mask,
+								 step->values);
+			if (ret)
+				return -1;
+
+			if (waveform->step_cb &&
+			    waveform->step_cb(i, cycle, lateness,
+					      waveform->step_cb_data))
+				return 0;
+		}
+
+		if (!waveform->period_ns ||
+		    (waveform->num_cycles && cycle + 1 == waveform->num_cycles))
+			return 0;
+	}
+}
+
+GPIOD_API int gpiod_waveform_play(struct gpiod_waveform *waveform)
+{
+	struct gpiod_thread_state *state;
+	int ret, err;
+
+	assert(waveform);
+
+	if (!waveform->num_steps) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Each cycle must end no earlier than its last step. */
+	if (waveform->period_ns &&
+	    waveform->period_ns < waveform->steps[waveform->num_steps - 1].time_ns) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!waveform->thread_attr)
+		return play_waveform(waveform);
+
+	state = gpiod_thread_state_save();
+	if (!state)
+		return -1;
+
+	ret = gpiod_thread_attr_apply(waveform->thread_attr);
+	if (!ret)
+		ret = play_waveform(waveform);
+
+	err = errno;
+	gpiod_thread_state_restore(state);
+	errno = err;
+
+	return ret;
+}
@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <assert.h>
+#include <errno.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+
+#define NSEC_PER_SEC	1000000000ULL
+#define NSEC_PER_USEC	1000ULL
+
+/* Lives on the stack of the writer that opened it and flushes it. */
+struct batch {
+	uint64_t mask;
+	uint64_t values;
+	size_t num_writes;
+	size_t num_waiters;
+	bool done;
+	int ret;
+	int error;
+};
+
+struct gpiod_write_combiner {
+	struct gpiod_line_request *request;
+	uint64_t valid_mask;
+	uint64_t max_delay_ns;
+	size_t max_batch;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	/* Batch collecting writes, NULL if none. */
+	struct batch *open;
+	/* Set while a batch is being written to the kernel. */
+	bool flushing;
+	uint64_t num_writes;
+	uint64_t num_flushes;
+};
+
+GPIOD_API struct gpiod_write_combiner *
+gpiod_write_combiner_new(struct gpiod_line_request *request,
+			 unsigned long max_delay_us, size_t max_batch)
+{
+	struct gpiod_write_combiner *wc;
+	pthread_condattr_t attr;
+	size_t num_lines;
+
+	if (!request) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	wc = gpiod_malloc(sizeof(*wc));
+	if (!wc)
+		return NULL;
+
+	memset(wc, 0, sizeof(*wc));
+
+	num_lines = gpiod_line_request_get_num_requested_lines(request);
+
+	wc->request = request;
+	wc->valid_mask = num_lines == GPIO_V2_LINES_MAX ?
+				UINT64_MAX : (1ULL << num_lines) - 1;
+	wc->max_delay_ns = (uint64_t)max_delay_us * NSEC_PER_USEC;
+	wc->max_batch = max_batch;
+
+	/* Deadlines are not affected by changes of the wall clock. */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&wc->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&wc->lock, NULL);
+
+	return wc;
+}
+
+GPIOD_API void gpiod_write_combiner_free(struct gpiod_write_combiner *wc)
+{
+	if (!wc)
+		return;
+
+	pthread_cond_destroy(&wc->cond);
+	pthread_mutex_destroy(&wc->lock);
+	gpiod_free(wc);
+}
+
+static void batch_merge(struct batch *batch, uint64_t mask, uint64_t values)
+{
+	/* The last write of a line within the batch wins. */
+	batch->values = (batch->values & ~mask) | (values & mask);
+	batch->mask |= mask;
+	batch->num_writes++;
+}
+
+static bool batch_full(struct gpiod_write_combiner *wc, struct batch *batch)
+{
+	return wc->max_batch && batch->num_writes >= wc->max_batch;
+}
+
+static int batch_result(struct batch *batch)
+{
+	if (batch->ret)
+		errno = batch->error;
+
+	return batch->ret;
+}
+
+static int join_batch(struct gpiod_write_combiner *wc, struct batch *batch,
+		      uint64_t mask, uint64_t values)
+{
+	int ret;
+
+	batch_merge(batch, mask, values);
+	if (batch_full(wc, batch))
+		pthread_cond_broadcast(&wc->cond);
+
+	batch->num_waiters++;
+	while (!batch->done)
+		pthread_cond_wait(&wc->cond, &wc->lock);
+
+	ret = batch_result(batch);
+
+	/* The writer flushing the batch waits for us before it returns. */
+	if (--batch->num_waiters == 0)
+		pthread_cond_broadcast(&wc->cond);
+
+	pthread_mutex_unlock(&wc->lock);
+
+	return ret;
+}
+
+static void deadline_from_now(struct timespec *ts, uint64_t delay_ns)
+{
+	uint64_t nsec;
+
+	clock_gettime(CLOCK_MONOTONIC, ts);
+
+	nsec = ts->tv_nsec + delay_ns;
+	ts->tv_sec += nsec / NSEC_PER_SEC;
+	ts->tv_nsec = nsec % NSEC_PER_SEC;
+}
+
+static int lead_batch(struct gpiod_write_combiner *wc, uint64_t mask,
+		      uint64_t values)
+{
+	struct timespec deadline;
+	struct batch batch;
+	int ret;
+
+	memset(&batch, 0, sizeof(batch));
+	batch_merge(&batch, mask, values);
+	wc->open = &batch;
+
+	if (wc->max_delay_ns) {
+		deadline_from_now(&deadline, wc->max_delay_ns);
+
+		while (!batch_full(wc, &batch)) {
+			ret = pthread_cond_timedwait(&wc->cond, &wc->lock,
+						     &deadline);
+			if (ret == ETIMEDOUT)
+				break;
+		}
+	}
+
+	/*
+	 * Flushes are serialized so that writes of the same line reach the
+	 * kernel in order. Writers arriving meanwhile still join this batch.
+	 */
+	while (wc->flushing)
+		pthread_cond_wait(&wc->cond, &wc->lock);
+
+	wc->open = NULL;
+	wc->flushing = true;
+	wc->num_flushes++;
+	pthread_mutex_unlock(&wc->lock);
+
+	ret = gpiod_line_request_set_values_mask(wc->request, batch.mask,
+						 batch.values);
+
+	pthread_mutex_lock(&wc->lock);
+	batch.ret = ret;
+	batch.error = errno;
+	batch.done = true;
+	wc->flushing = false;
+	pthread_cond_broadcast(&wc->cond);
+
+	while (batch.num_waiters)
+		pthread_cond_wait(&wc->cond, &wc->lock);
+
+	pthread_mutex_unlock(&wc->lock);
+
+	return batch_result(&batch);
+}
+
+GPIOD_API int
+gpiod_write_combiner_set_values_mask(struct gpiod_write_combiner *wc,
+				     uint64_t mask, uint64_t values)
+{
+	assert(wc);
+
+	if (mask & ~wc->valid_mask) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!mask)
+		return 0;
+
+	pthread_mutex_lock(&wc->lock);
+
+	wc->num_writes++;
+
+	if (wc->open)
+		return join_batch(wc, wc->open, mask, values);
+
+	return lead_batch(wc, mask, values);
+}
+
+GPIOD_API int gpiod_write_combiner_set_value(struct gpiod_write_combiner *wc,
+					     unsigned int offset,
+					     enum gpiod_line_value value)
+{
+	uint64_t mask = 0, values = 0;
+	int bit;
+
+	assert(wc);
+
+	bit = gpiod_line_request_get_offset_bit(wc->request, offset);
+	if (bit < 0)
+		return -1;
+
+	gpiod_line_mask_set_bit(&mask, bit);
+	gpiod_line_mask_assign_bit(&values, bit, value);
+
+	return gpiod_write_combiner_set_values_mask(wc, mask, values);
+}
+
+GPIOD_API uint64_t
+gpiod_write_combiner_get_num_writes(struct gpiod_write_combiner *wc)
+{
+	uint64_t num_writes;
+
+	assert(wc);
+
+	pthread_mutex_lock(&wc->lock);
+	num_writes = wc->num_writes;
+	pthread_mutex_unlock(&wc->lock);
+
+	return num_writes;
+}
+
+GPIOD_API uint64_t
+gpiod_write_combiner_get_num_flushes(struct gpiod_write_combiner *wc)
+{
+	uint64_t num_flushes;
+
+	assert(wc);
+
+	pthread_mutex_lock(&wc->lock);
+	num_flushes = wc->num_flushes;
+	pthread_mutex_unlock(&wc->lock);
+
+	return num_flushes;
+}
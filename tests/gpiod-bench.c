@@ -0,0 +1,701 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * Microbenchmarks of the core library run against a gpio-sim chip or, with
+ * --mock, against a mock chip served by the library itself.
+ *
+ * Every result is printed to stdout as a single-line JSON object holding the
+ * name of the benchmark, the backend, its parameters, the number of
+ * iterations and the mean cost of an operation - or, for the footprint
+ * benchmark, the number of bytes of memory held by the measured objects.
+ * Passing a string as the last argument runs only the benchmarks whose names
+ * contain it.
+ */
+
+#include <errno.h>
+#include <gpiod.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpiosim.h"
+
+#define NUM_LINES		64
+#define NSEC_PER_SEC		1000000000ULL
+/* Size of the kernel's line info event queue. */
+#define INFO_EVENT_QUEUE_SIZE	32
+/* Largest edge event queue the kernel allows for a single line. */
+#define EDGE_EVENT_QUEUE_SIZE	1024
+
+struct bench {
+	struct gpiod_mock_chip *mock;
+	struct gpiosim_ctx *ctx;
+	struct gpiosim_dev *dev;
+	struct gpiosim_bank *bank;
+	struct gpiod_chip *chip;
+	const char *filter;
+};
+
+static const char *backend = "gpio-sim";
+
+static void die(const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	vfprintf(stderr, fmt, va);
+	va_end(va);
+
+	fprintf(stderr, ": %s\n", strerror(errno));
+
+	exit(EXIT_FAILURE);
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static int bench_enabled(struct bench *bench, const char *name)
+{
+	return !bench->filter || strstr(name, bench->filter);
+}
+
+static void report(const char *name, const char *params, uint64_t iterations,
+		   uint64_t elapsed_ns)
+{
+	double ns_per_op = (double)elapsed_ns / iterations;
+
+	printf("{\"benchmark\": \"%s\", \"backend\": \"%s\", \"params\": {%s}, "
+	       "\"iterations\": %llu, \"ns_per_op\": %.1f, "
+	       "\"ops_per_sec\": %.1f}\n",
+	       name, backend, params, (unsigned long long)iterations, ns_per_op,
+	       NSEC_PER_SEC / ns_per_op);
+	fflush(stdout);
+}
+
+static void report_footprint(const char *name, const char *params,
+			     size_t bytes)
+{
+	printf("{\"benchmark\": \"%s\", \"backend\": \"%s\", \"params\": {%s}, "
+	       "\"bytes\": %zu}\n", name, backend, params, bytes);
+	fflush(stdout);
+}
+
+/* Allocator keeping track of the number of bytes held by the library. */
+struct counting_allocator {
+	size_t bytes;
+};
+
+union counted_block {
+	size_t size;
+	max_align_t align;
+};
+
+static void *counting_alloc(size_t size, void *data)
+{
+	struct counting_allocator *allocator = data;
+	union counted_block *block;
+
+	block = malloc(sizeof(*block) + size);
+	if (!block)
+		return NULL;
+
+	block->size = size;
+	allocator->bytes += size;
+
+	return block + 1;
+}
+
+static void counting_free(void *ptr, void *data)
+{
+	struct counting_allocator *allocator = data;
+	union counted_block *block = (union counted_block *)ptr - 1;
+
+	allocator->bytes -= block->size;
+	free(block);
+}
+
+static void bench_init(struct bench *bench)
+{
+	int ret;
+
+	if (bench->mock) {
+		bench->chip = gpiod_chip_open(
+				gpiod_mock_chip_get_path(bench->mock));
+		if (!bench->chip)
+			die("unable to open the mock chip");
+
+		return;
+	}
+
+	bench->ctx = gpiosim_ctx_new();
+	if (!bench->ctx)
+		die("unable to create the gpio-sim context");
+
+	bench->dev = gpiosim_dev_new(bench->ctx);
+	if (!bench->dev)
+		die("unable to create a gpio-sim device");
+
+	bench->bank = gpiosim_bank_new(bench->dev);
+	if (!bench->bank)
+		die("unable to create a gpio-sim bank");
+
+	ret = gpiosim_bank_set_num_lines(bench->bank, NUM_LINES);
+	if (ret)
+		die("unable to set the number of lines");
+
+	ret = gpiosim_dev_enable(bench->dev);
+	if (ret)
+		die("unable to enable the gpio-sim device");
+
+	bench->chip = gpiod_chip_open(gpiosim_bank_get_dev_path(bench->bank));
+	if (!bench->chip)
+		die("unable to open the chip");
+}
+
+static void bench_cleanup(struct bench *bench)
+{
+	gpiod_chip_close(bench->chip);
+
+	if (bench->mock) {
+		gpiod_mock_chip_free(bench->mock);
+		return;
+	}
+
+	gpiosim_dev_disable(bench->dev);
+	gpiosim_bank_unref(bench->bank);
+	gpiosim_dev_unref(bench->dev);
+	gpiosim_ctx_unref(bench->ctx);
+}
+
+/*
+ * With distinct settings, every line gets a debounce period of its own so
+ * the request needs one attribute per line - as many as the kernel allows.
+ */
+static struct gpiod_line_config *
+make_line_config(size_t num_lines, enum gpiod_line_direction direction,
+		 enum gpiod_line_edge edge, enum gpiod_line_bias bias,
+		 int distinct)
+{
+	struct gpiod_line_settings *settings;
+	struct gpiod_line_config *config;
+	unsigned int offset;
+	int ret;
+
+	settings = gpiod_line_settings_new();
+	config = gpiod_line_config_new();
+	if (!settings || !config)
+		die("unable to allocate the line config");
+
+	gpiod_line_settings_set_direction(settings, direction);
+	gpiod_line_settings_set_edge_detection(settings, edge);
+	gpiod_line_settings_set_bias(settings, bias);
+
+	for (offset = 0; offset < num_lines; offset++) {
+		if (distinct)
+			gpiod_line_settings_set_debounce_period_us(settings,
+								   offset + 1);
+
+		ret = gpiod_line_config_add_line_settings(config, &offset, 1,
+							  settings);
+		if (ret)
+			die("unable to add line settings");
+	}
+
+	gpiod_line_settings_free(settings);
+
+	return config;
+}
+
+static struct gpiod_line_request *
+request_lines(struct bench *bench, struct gpiod_line_config *line_cfg,
+	      size_t event_buffer_size)
+{
+	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_request *request;
+
+	req_cfg = gpiod_request_config_new();
+	if (!req_cfg)
+		die("unable to allocate the request config");
+
+	gpiod_request_config_set_consumer(req_cfg, "gpiod-bench");
+	gpiod_request_config_set_event_buffer_size(req_cfg, event_buffer_size);
+
+	request = gpiod_chip_request_lines(bench->chip, req_cfg, line_cfg);
+	if (!request)
+		die("unable to request lines");
+
+	gpiod_request_config_free(req_cfg);
+
+	return request;
+}
+
+static void bench_request_setup(struct bench *bench)
+{
+	static const size_t line_counts[] = { 1, 8, 32, 64 };
+	static const unsigned int iterations = 200;
+
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+	uint64_t start, elapsed;
+	unsigned int i, distinct;
+	char params[128];
+	size_t j;
+
+	if (!bench_enabled(bench, "request_setup"))
+		return;
+
+	for (distinct = 0; distinct <= 1; distinct++) {
+		for (j = 0; j < sizeof(line_counts) / sizeof(*line_counts); j++) {
+			line_cfg = make_line_config(line_counts[j],
+						    GPIOD_LINE_DIRECTION_INPUT,
+						    GPIOD_LINE_EDGE_NONE,
+						    GPIOD_LINE_BIAS_AS_IS,
+						    distinct);
+
+			start = now_ns();
+			for (i = 0; i < iterations; i++) {
+				request = request_lines(bench, line_cfg, 0);
+				gpiod_line_request_release(request);
+			}
+			elapsed = now_ns() - start;
+
+			snprintf(params, sizeof(params),
+				 "\"num_lines\": %zu, \"distinct_settings\": %s",
+				 line_counts[j], distinct ? "true" : "false");
+			report("request_setup", params, iterations, elapsed);
+
+			gpiod_line_config_free(line_cfg);
+		}
+	}
+}
+
+static void bench_values(struct bench *bench)
+{
+	static const size_t line_counts[] = { 1, 64 };
+	static const unsigned int iterations = 100000;
+
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+	uint64_t start, elapsed, mask;
+	uint64_t values = 0;
+	char params[64];
+	unsigned int i;
+	size_t j;
+	int ret;
+
+	for (j = 0; j < sizeof(line_counts) / sizeof(*line_counts); j++) {
+		line_cfg = make_line_config(line_counts[j],
+					    GPIOD_LINE_DIRECTION_OUTPUT,
+					    GPIOD_LINE_EDGE_NONE,
+					    GPIOD_LINE_BIAS_AS_IS, 0);
+		request = request_lines(bench, line_cfg, 0);
+		mask = line_counts[j] == 64 ?
+				UINT64_MAX : (1ULL << line_counts[j]) - 1;
+
+		snprintf(params, sizeof(params), "\"num_lines\": %zu",
+			 line_counts[j]);
+
+		if (bench_enabled(bench, "get_values")) {
+			start = now_ns();
+			for (i = 0; i < iterations; i++) {
+				ret = gpiod_line_request_get_values_mask(
+						request, mask, &values);
+				if (ret)
+					die("unable to read values");
+			}
+			elapsed = now_ns() - start;
+
+			report("get_values", params, iterations, elapsed);
+		}
+
+		if (bench_enabled(bench, "set_values")) {
+			start = now_ns();
+			for (i = 0; i < iterations; i++) {
+				/* Change all lines every time. */
+				ret = gpiod_line_request_set_values_mask(
+						request, mask, i & 1 ? mask : 0);
+				if (ret)
+					die("unable to set values");
+			}
+			elapsed = now_ns() - start;
+
+			report("set_values", params, iterations, elapsed);
+		}
+
+		gpiod_line_request_release(request);
+		gpiod_line_config_free(line_cfg);
+	}
+}
+
+static void bench_reconfigure(struct bench *bench)
+{
+	static const size_t line_counts[] = { 1, 64 };
+	static const unsigned int iterations = 2000;
+
+	struct gpiod_line_config *pull_up, *pull_down;
+	struct gpiod_line_request *request;
+	uint64_t start, elapsed;
+	char params[64];
+	unsigned int i;
+	size_t j;
+	int ret;
+
+	if (!bench_enabled(bench, "reconfigure"))
+		return;
+
+	for (j = 0; j < sizeof(line_counts) / sizeof(*line_counts); j++) {
+		pull_up = make_line_config(line_counts[j],
+					   GPIOD_LINE_DIRECTION_INPUT,
+					   GPIOD_LINE_EDGE_NONE,
+					   GPIOD_LINE_BIAS_PULL_UP, 0);
+		pull_down = make_line_config(line_counts[j],
+					     GPIOD_LINE_DIRECTION_INPUT,
+					     GPIOD_LINE_EDGE_NONE,
+					     GPIOD_LINE_BIAS_PULL_DOWN, 0);
+		request = request_lines(bench, pull_up, 0);
+
+		start = now_ns();
+		for (i = 0; i < iterations; i++) {
+			ret = gpiod_line_request_reconfigure_lines(request,
+						i & 1 ? pull_up : pull_down);
+			if (ret)
+				die("unable to reconfigure lines");
+		}
+		elapsed = now_ns() - start;
+
+		snprintf(params, sizeof(params), "\"num_lines\": %zu",
+			 line_counts[j]);
+		report("reconfigure", params, iterations, elapsed);
+
+		gpiod_line_request_release(request);
+		gpiod_line_config_free(pull_up);
+		gpiod_line_config_free(pull_down);
+	}
+}
+
+/*
+ * Memory held by a line config and by a request for a given number of lines.
+ * Requests are measured once the config they were made from is freed. This
+ * includes the library's allocation headers but not the usage of the heap.
+ */
+static void bench_footprint(struct bench *bench)
+{
+	static const size_t line_counts[] = { 1, 8, 64 };
+
+	struct counting_allocator allocator;
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+	size_t config_bytes, j;
+	char params[64];
+	int ret;
+
+	if (!bench_enabled(bench, "footprint"))
+		return;
+
+	memset(&allocator, 0, sizeof(allocator));
+
+	ret = gpiod_set_allocator(counting_alloc, counting_free, &allocator);
+	if (ret)
+		die("unable to set the allocator");
+
+	for (j = 0; j < sizeof(line_counts) / sizeof(*line_counts); j++) {
+		line_cfg = make_line_config(line_counts[j],
+					    GPIOD_LINE_DIRECTION_INPUT,
+					    GPIOD_LINE_EDGE_NONE,
+					    GPIOD_LINE_BIAS_AS_IS, 0);
+		config_bytes = allocator.bytes;
+
+		request = request_lines(bench, line_cfg, 0);
+		gpiod_line_config_free(line_cfg);
+
+		snprintf(params, sizeof(params),
+			 "\"object\": \"line_config\", \"num_lines\": %zu",
+			 line_counts[j]);
+		report_footprint("footprint", params, config_bytes);
+
+		snprintf(params, sizeof(params),
+			 "\"object\": \"line_request\", \"num_lines\": %zu",
+			 line_counts[j]);
+		report_footprint("footprint", params, allocator.bytes);
+
+		gpiod_line_request_release(request);
+	}
+
+	gpiod_set_allocator(NULL, NULL, NULL);
+}
+
+/* A capacity of 0 stands for an adaptive buffer. */
+static struct gpiod_edge_event_buffer *make_edge_event_buffer(size_t capacity)
+{
+	struct gpiod_edge_event_buffer *buffer;
+
+	buffer = capacity ? gpiod_edge_event_buffer_new(capacity) :
+			    gpiod_edge_event_buffer_new_adaptive();
+	if (!buffer)
+		die("unable to allocate the edge event buffer");
+
+	return buffer;
+}
+
+static void format_buffer_params(char *params, size_t size, size_t capacity)
+{
+	if (capacity)
+		snprintf(params, size, "\"buffer_capacity\": %zu", capacity);
+	else
+		snprintf(params, size, "\"buffer_capacity\": \"adaptive\"");
+}
+
+static void bench_edge_events(struct bench *bench)
+{
+	static const size_t capacities[] = { 1, 16, 64, 1024, 0 };
+	static const unsigned int rounds = 8;
+
+	struct gpiod_edge_event_buffer *buffer;
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+	uint64_t start, elapsed, num_read;
+	struct gpiosim_edge_gen *gen;
+	unsigned int round, pending;
+	unsigned int offset = 0;
+	char params[64];
+	size_t j;
+	int ret;
+
+	if (!bench_enabled(bench, "edge_event_read"))
+		return;
+
+	line_cfg = make_line_config(1, GPIOD_LINE_DIRECTION_INPUT,
+				    GPIOD_LINE_EDGE_BOTH,
+				    GPIOD_LINE_BIAS_AS_IS, 0);
+
+	for (j = 0; j < sizeof(capacities) / sizeof(*capacities); j++) {
+		request = request_lines(bench, line_cfg, EDGE_EVENT_QUEUE_SIZE);
+		/* Picks up the pull left behind by the previous benchmarks. */
+		gen = gpiosim_edge_gen_new(bench->bank, &offset, 1);
+		if (!gen)
+			die("unable to create the edge generator");
+
+		buffer = make_edge_event_buffer(capacities[j]);
+
+		elapsed = num_read = 0;
+
+		/*
+		 * Only reading is timed, the events are queued in the kernel
+		 * beforehand. Generating them is orders of magnitude slower.
+		 */
+		for (round = 0; round < rounds; round++) {
+			ret = gpiosim_edge_gen_burst(gen,
+						     EDGE_EVENT_QUEUE_SIZE);
+			if (ret)
+				die("unable to generate edge events");
+
+			start = now_ns();
+			for (pending = EDGE_EVENT_QUEUE_SIZE; pending;
+			     pending -= ret) {
+				ret = gpiod_line_request_read_edge_events(
+					request, buffer,
+					gpiod_edge_event_buffer_get_capacity(
+								buffer));
+				if (ret <= 0)
+					die("unable to read edge events");
+			}
+			elapsed += now_ns() - start;
+			num_read += EDGE_EVENT_QUEUE_SIZE;
+		}
+
+		format_buffer_params(params, sizeof(params), capacities[j]);
+		report("edge_event_read", params, num_read, elapsed);
+
+		gpiosim_edge_gen_free(gen);
+		gpiod_edge_event_buffer_free(buffer);
+		gpiod_line_request_release(request);
+	}
+
+	gpiod_line_config_free(line_cfg);
+}
+
+/*
+ * With the line toggling every nanosecond, a fifo's worth of events is always
+ * due. The reads only measure the library and the mock backend.
+ */
+static void bench_mock_edge_events(struct bench *bench)
+{
+	static const size_t capacities[] = { 1, 16, 64, 1024, 0 };
+	static const uint64_t num_events = 1 << 20;
+
+	struct gpiod_edge_event_buffer *buffer;
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+	uint64_t start, elapsed, num_read;
+	char params[64];
+	size_t j;
+	int ret;
+
+	if (!bench_enabled(bench, "edge_event_read"))
+		return;
+
+	line_cfg = make_line_config(1, GPIOD_LINE_DIRECTION_INPUT,
+				    GPIOD_LINE_EDGE_BOTH,
+				    GPIOD_LINE_BIAS_AS_IS, 0);
+
+	for (j = 0; j < sizeof(capacities) / sizeof(*capacities); j++) {
+		request = request_lines(bench, line_cfg, EDGE_EVENT_QUEUE_SIZE);
+
+		buffer = make_edge_event_buffer(capacities[j]);
+
+		ret = gpiod_mock_chip_set_event_rate(bench->mock, 0,
+						     NSEC_PER_SEC);
+		if (ret)
+			die("unable to set the event rate");
+
+		start = now_ns();
+		for (num_read = 0; num_read < num_events; num_read += ret) {
+			ret = gpiod_line_request_read_edge_events(
+				request, buffer,
+				gpiod_edge_event_buffer_get_capacity(buffer));
+			if (ret <= 0)
+				die("unable to read edge events");
+		}
+		elapsed = now_ns() - start;
+
+		gpiod_mock_chip_set_event_rate(bench->mock, 0, 0);
+
+		format_buffer_params(params, sizeof(params), capacities[j]);
+		report("edge_event_read", params, num_read, elapsed);
+
+		gpiod_edge_event_buffer_free(buffer);
+		gpiod_line_request_release(request);
+	}
+
+	gpiod_line_config_free(line_cfg);
+}
+
+static void gen_info_events(struct bench *bench,
+			    struct gpiod_line_config *line_cfg)
+{
+	struct gpiod_line_request *request;
+	unsigned int i;
+
+	/* Every request and release is an event. */
+	for (i = 0; i < INFO_EVENT_QUEUE_SIZE / 2; i++) {
+		request = request_lines(bench, line_cfg, 0);
+		gpiod_line_request_release(request);
+	}
+}
+
+static void bench_info_events(struct bench *bench)
+{
+	static const size_t capacities[] = { 1, INFO_EVENT_QUEUE_SIZE };
+	static const unsigned int rounds = 32;
+
+	struct gpiod_info_event_buffer *buffer;
+	struct gpiod_line_config *line_cfg;
+	uint64_t start, elapsed, num_read;
+	unsigned int round, pending;
+	struct gpiod_line_info *info;
+	char params[64];
+	size_t j;
+	int ret;
+
+	if (!bench_enabled(bench, "info_event_read"))
+		return;
+
+	line_cfg = make_line_config(1, GPIOD_LINE_DIRECTION_INPUT,
+				    GPIOD_LINE_EDGE_NONE,
+				    GPIOD_LINE_BIAS_AS_IS, 0);
+
+	info = gpiod_chip_watch_line_info(bench->chip, 0);
+	if (!info)
+		die("unable to watch the line info");
+	gpiod_line_info_free(info);
+
+	for (j = 0; j < sizeof(capacities) / sizeof(*capacities); j++) {
+		buffer = gpiod_info_event_buffer_new(capacities[j]);
+		if (!buffer)
+			die("unable to allocate the info event buffer");
+
+		elapsed = num_read = 0;
+
+		for (round = 0; round < rounds; round++) {
+			gen_info_events(bench, line_cfg);
+
+			start = now_ns();
+			for (pending = INFO_EVENT_QUEUE_SIZE; pending;
+			     pending -= ret) {
+				ret = gpiod_chip_read_info_events(
+						bench->chip, buffer,
+						capacities[j]);
+				if (ret <= 0)
+					die("unable to read info events");
+			}
+			elapsed += now_ns() - start;
+			num_read += INFO_EVENT_QUEUE_SIZE;
+		}
+
+		snprintf(params, sizeof(params), "\"buffer_capacity\": %zu",
+			 capacities[j]);
+		report("info_event_read", params, num_read, elapsed);
+
+		gpiod_info_event_buffer_free(buffer);
+	}
+
+	gpiod_chip_unwatch_line_info(bench->chip, 0);
+	gpiod_line_config_free(line_cfg);
+}
+
+int main(int argc, char **argv)
+{
+	struct bench bench;
+	int mock;
+
+	mock = argc > 1 && strcmp(argv[1], "--mock") == 0;
+
+	if (argc > 2 + mock) {
+		fprintf(stderr, "usage: %s [--mock] [FILTER]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	memset(&bench, 0, sizeof(bench));
+	bench.filter = argc == 2 + mock ? argv[1 + mock] : NULL;
+
+	if (mock) {
+		bench.mock = gpiod_mock_chip_new(NUM_LINES);
+		if (!bench.mock)
+			die("unable to create the mock chip");
+
+		backend = "mock";
+	}
+
+	bench_init(&bench);
+
+	bench_request_setup(&bench);
+	bench_values(&bench);
+	bench_reconfigure(&bench);
+
+	/*
+	 * The mock backend's allocations would be counted as footprint and
+	 * mock chips don't emit info events.
+	 */
+	if (mock) {
+		bench_mock_edge_events(&bench);
+	} else {
+		bench_footprint(&bench);
+		bench_edge_events(&bench);
+		bench_info_events(&bench);
+	}
+
+	bench_cleanup(&bench);
+
+	return EXIT_SUCCESS;
+}
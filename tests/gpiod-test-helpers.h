@@ -21,12 +21,37 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_chip, gpiod_chip_close);
 typedef struct gpiod_chip_info struct_gpiod_chip_info;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_chip_info, gpiod_chip_info_free);
 
+typedef struct gpiod_chip_cache struct_gpiod_chip_cache;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_chip_cache, gpiod_chip_cache_free);
+
+typedef struct gpiod_thread_attr struct_gpiod_thread_attr;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_thread_attr, gpiod_thread_attr_free);
+
+typedef struct gpiod_chip_list struct_gpiod_chip_list;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_chip_list, gpiod_chip_list_free);
+
 typedef struct gpiod_line_info struct_gpiod_line_info;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_info, gpiod_line_info_free);
 
 typedef struct gpiod_info_event struct_gpiod_info_event;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_info_event, gpiod_info_event_free);
 
+typedef struct gpiod_info_event_buffer struct_gpiod_info_event_buffer;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_info_event_buffer,
+			      gpiod_info_event_buffer_free);
+
+typedef struct gpiod_line_info_cache struct_gpiod_line_info_cache;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_info_cache,
+			      gpiod_line_info_cache_free);
+
+typedef struct gpiod_line_info_snapshot struct_gpiod_line_info_snapshot;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_info_snapshot,
+			      gpiod_line_info_snapshot_free);
+
+typedef struct gpiod_info_event_coalescer struct_gpiod_info_event_coalescer;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_info_event_coalescer,
+			      gpiod_info_event_coalescer_free);
+
 typedef struct gpiod_line_config struct_gpiod_line_config;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_config, gpiod_line_config_free);
 
@@ -38,10 +63,38 @@ typedef struct gpiod_request_config struct_gpiod_request_config;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_request_config,
 			      gpiod_request_config_free);
 
+typedef struct gpiod_request_template struct_gpiod_request_template;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_request_template,
+			      gpiod_request_template_free);
+
 typedef struct gpiod_line_request struct_gpiod_line_request;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_request,
 			      gpiod_line_request_release);
 
+typedef struct gpiod_large_request struct_gpiod_large_request;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_large_request,
+			      gpiod_large_request_release);
+
+typedef struct gpiod_multi_request struct_gpiod_multi_request;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_multi_request,
+			      gpiod_multi_request_free);
+
+typedef struct gpiod_multi_request_snapshot
+struct_gpiod_multi_request_snapshot;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_multi_request_snapshot,
+			      gpiod_multi_request_snapshot_free);
+
+typedef struct gpiod_write_combiner struct_gpiod_write_combiner;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_write_combiner,
+			      gpiod_write_combiner_free);
+
+typedef struct gpiod_line_subset struct_gpiod_line_subset;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_subset, gpiod_line_subset_free);
+
+typedef struct gpiod_line_transaction struct_gpiod_line_transaction;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_transaction,
+			      gpiod_line_transaction_free);
+
 typedef struct gpiod_edge_event struct_gpiod_edge_event;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event, gpiod_edge_event_free);
 
@@ -49,6 +102,78 @@ typedef struct gpiod_edge_event_buffer struct_gpiod_edge_event_buffer;
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event_buffer,
 			      gpiod_edge_event_buffer_free);
 
+typedef struct gpiod_waveform struct_gpiod_waveform;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_waveform, gpiod_waveform_free);
+
+typedef struct gpiod_event_loop struct_gpiod_event_loop;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_loop, gpiod_event_loop_free);
+
+typedef struct gpiod_event_merger struct_gpiod_event_merger;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_merger,
+			      gpiod_event_merger_free);
+
+typedef struct gpiod_event_ring struct_gpiod_event_ring;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_ring, gpiod_event_ring_free);
+
+typedef struct gpiod_event_ring_reader struct_gpiod_event_ring_reader;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_event_ring_reader,
+			      gpiod_event_ring_reader_close);
+
+typedef struct gpiod_capture_reader struct_gpiod_capture_reader;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_capture_reader,
+			      gpiod_capture_reader_close);
+
+typedef struct gpiod_output_scheduler struct_gpiod_output_scheduler;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_output_scheduler,
+			      gpiod_output_scheduler_free);
+
+typedef struct gpiod_pwm struct_gpiod_pwm;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_pwm, gpiod_pwm_free);
+
+typedef struct gpiod_pulse_meter struct_gpiod_pulse_meter;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_pulse_meter,
+			      gpiod_pulse_meter_free);
+
+typedef struct gpiod_pulse_decoder struct_gpiod_pulse_decoder;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_pulse_decoder,
+			      gpiod_pulse_decoder_free);
+
+typedef struct gpiod_edge_event_pipeline struct_gpiod_edge_event_pipeline;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event_pipeline,
+			      gpiod_edge_event_pipeline_free);
+
+typedef struct gpiod_bitbang struct_gpiod_bitbang;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_bitbang, gpiod_bitbang_free);
+
+typedef struct gpiod_bus_sampler struct_gpiod_bus_sampler;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_bus_sampler,
+			      gpiod_bus_sampler_release);
+
+typedef struct gpiod_line_monitor struct_gpiod_line_monitor;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_line_monitor,
+			      gpiod_line_monitor_release);
+
+typedef struct gpiod_mock_chip struct_gpiod_mock_chip;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_mock_chip, gpiod_mock_chip_free);
+
+typedef struct gpiod_stats struct_gpiod_stats;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_stats, gpiod_stats_free);
+
+typedef struct gpiod_latency_histogram struct_gpiod_latency_histogram;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_latency_histogram,
+			      gpiod_latency_histogram_free);
+
+typedef struct gpiod_edge_stats struct_gpiod_edge_stats;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_stats, gpiod_edge_stats_free);
+
+typedef struct gpiod_clock_converter struct_gpiod_clock_converter;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_clock_converter,
+			      gpiod_clock_converter_free);
+
+typedef struct gpiod_wait_cancel struct_gpiod_wait_cancel;
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_wait_cancel,
+			      gpiod_wait_cancel_free);
+
 #define gpiod_test_return_if_failed() \
 	do { \
 		if (g_test_failed()) \
@@ -115,6 +240,15 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event_buffer,
 		_buffer; \
 	})
 
+#define gpiod_test_create_info_event_buffer_or_fail(_capacity) \
+	({ \
+		struct gpiod_info_event_buffer *_buffer = \
+				gpiod_info_event_buffer_new(_capacity); \
+		g_assert_nonnull(_buffer); \
+		gpiod_test_return_if_failed(); \
+		_buffer; \
+	})
+
 #define gpiod_test_line_config_add_line_settings_or_fail(_line_cfg, _offsets, \
 						_num_offsets, _settings) \
 	do { \
@@ -155,6 +289,140 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(struct_gpiod_edge_event_buffer,
 		_config; \
 	})
 
+#define gpiod_test_create_request_template_or_fail(_req_cfg, _line_cfg) \
+	({ \
+		struct gpiod_request_template *_tmpl = \
+			gpiod_request_template_new(_req_cfg, _line_cfg); \
+		g_assert_nonnull(_tmpl); \
+		gpiod_test_return_if_failed(); \
+		_tmpl; \
+	})
+
+#define gpiod_test_create_event_loop_or_fail(_event_buffer_size) \
+	({ \
+		struct gpiod_event_loop *_loop = \
+				gpiod_event_loop_new(_event_buffer_size); \
+		g_assert_nonnull(_loop); \
+		gpiod_test_return_if_failed(); \
+		_loop; \
+	})
+
+#define gpiod_test_create_event_merger_or_fail(_window_ns) \
+	({ \
+		struct gpiod_event_merger *_merger = \
+			gpiod_event_merger_new(GPIOD_LINE_CLOCK_MONOTONIC, \
+					       _window_ns, 0); \
+		g_assert_nonnull(_merger); \
+		gpiod_test_return_if_failed(); \
+		_merger; \
+	})
+
+#define gpiod_test_create_line_info_cache_or_fail(_chip) \
+	({ \
+		struct gpiod_line_info_cache *_cache = \
+				gpiod_line_info_cache_new(_chip); \
+		g_assert_nonnull(_cache); \
+		gpiod_test_return_if_failed(); \
+		_cache; \
+	})
+
+#define gpiod_test_create_line_info_snapshot_or_fail(_chip) \
+	({ \
+		struct gpiod_line_info_snapshot *_snapshot = \
+				gpiod_line_info_snapshot_new(_chip); \
+		g_assert_nonnull(_snapshot); \
+		gpiod_test_return_if_failed(); \
+		_snapshot; \
+	})
+
+#define gpiod_test_create_info_event_coalescer_or_fail(_chip, _window_ns) \
+	({ \
+		struct gpiod_info_event_coalescer *_coalescer = \
+			gpiod_info_event_coalescer_new(_chip, _window_ns); \
+		g_assert_nonnull(_coalescer); \
+		gpiod_test_return_if_failed(); \
+		_coalescer; \
+	})
+
+#define gpiod_test_create_pulse_meter_or_fail(_window_ns) \
+	({ \
+		struct gpiod_pulse_meter *_meter = \
+				gpiod_pulse_meter_new(_window_ns); \
+		g_assert_nonnull(_meter); \
+		gpiod_test_return_if_failed(); \
+		_meter; \
+	})
+
+#define gpiod_test_create_bitbang_or_fail(_request) \
+	({ \
+		struct gpiod_bitbang *_bb = gpiod_bitbang_new(_request); \
+		g_assert_nonnull(_bb); \
+		gpiod_test_return_if_failed(); \
+		_bb; \
+	})
+
+#define gpiod_test_begin_transaction_or_fail(_request) \
+	({ \
+		struct gpiod_line_transaction *_tx = \
+			gpiod_line_request_begin_transaction(_request); \
+		g_assert_nonnull(_tx); \
+		gpiod_test_return_if_failed(); \
+		_tx; \
+	})
+
+#define gpiod_test_create_multi_request_or_fail() \
+	({ \
+		struct gpiod_multi_request *_mreq = \
+				gpiod_multi_request_new(); \
+		g_assert_nonnull(_mreq); \
+		gpiod_test_return_if_failed(); \
+		_mreq; \
+	})
+
+#define gpiod_test_create_output_scheduler_or_fail(_clock) \
+	({ \
+		struct gpiod_output_scheduler *_sched = \
+				gpiod_output_scheduler_new(_clock); \
+		g_assert_nonnull(_sched); \
+		gpiod_test_return_if_failed(); \
+		_sched; \
+	})
+
+#define gpiod_test_create_pwm_or_fail() \
+	({ \
+		struct gpiod_pwm *_pwm = gpiod_pwm_new(); \
+		g_assert_nonnull(_pwm); \
+		gpiod_test_return_if_failed(); \
+		_pwm; \
+	})
+
+#define gpiod_test_create_waveform_or_fail() \
+	({ \
+		struct gpiod_waveform *_waveform = gpiod_waveform_new(); \
+		g_assert_nonnull(_waveform); \
+		gpiod_test_return_if_failed(); \
+		_waveform; \
+	})
+
+#define gpiod_test_create_wait_cancel_or_fail() \
+	({ \
+		struct gpiod_wait_cancel *_cancel = gpiod_wait_cancel_new(); \
+		g_assert_nonnull(_cancel); \
+		gpiod_test_return_if_failed(); \
+		_cancel; \
+	})
+
+#define gpiod_test_create_write_combiner_or_fail(_request, _max_delay_us, \
+						 _max_batch) \
+	({ \
+		struct gpiod_write_combiner *_wc = \
+			gpiod_write_combiner_new(_request, _max_delay_us, \
+						 _max_batch); \
+		g_assert_nonnull(_wc); \
+		gpiod_test_return_if_failed(); \
+		_wc; \
+	})
+
 #define gpiod_test_request_lines_or_fail(_chip, _req_cfg, _line_cfg) \
 	({ \
 		struct gpiod_line_request *_request = \
@@ -16,9 +16,12 @@ static const char *const line_names[] = {
 	"barfoo",
 };
 
+static const unsigned int gen_offsets[] = { 2, 3 };
+
 int main(int argc UNUSED, char **argv UNUSED)
 {
 	struct gpiosim_bank *bank0, *bank1;
+	struct gpiosim_edge_gen *gen;
 	struct gpiosim_dev *dev;
 	struct gpiosim_ctx *ctx;
 	int ret, i;
@@ -140,6 +143,47 @@ int main(int argc UNUSED, char **argv UNUSED)
 		return EXIT_FAILURE;
 	}
 
+	printf("Generating a burst of edges on two lines\n");
+
+	gen = gpiosim_edge_gen_new(bank0, gen_offsets, 2);
+	if (!gen) {
+		perror("Unable to create the edge generator");
+		return EXIT_FAILURE;
+	}
+
+	ret = gpiosim_edge_gen_burst(gen, 1000);
+	if (ret) {
+		perror("Unable to generate edges");
+		return EXIT_FAILURE;
+	}
+
+	if (gpiosim_edge_gen_get_num_edges(gen) != 2000) {
+		fprintf(stderr, "Invalid number of edges generated\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("Achieved %.0f edges per second\n",
+	       gpiosim_edge_gen_get_rate(gen));
+
+	printf("Generating a square wave from a thread\n");
+
+	ret = gpiosim_edge_gen_start(gen, 1000, 100);
+	if (ret) {
+		perror("Unable to start the edge generator");
+		return EXIT_FAILURE;
+	}
+
+	ret = gpiosim_edge_gen_wait(gen);
+	if (ret) {
+		perror("Error while generating edges");
+		return EXIT_FAILURE;
+	}
+
+	printf("Achieved %.0f edges per second\n",
+	       gpiosim_edge_gen_get_rate(gen));
+
+	gpiosim_edge_gen_free(gen);
+
 	printf("Disabling the GPIO device\n");
 
 	ret = gpiosim_dev_disable(dev);
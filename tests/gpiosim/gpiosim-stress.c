@@ -0,0 +1,399 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+/*
+ * Edge event load generator. Toggles the lines of a simulated chip from a
+ * helper thread while reading the resulting edge events through libgpiod and
+ * reports the throughput, the number of events the kernel dropped and the
+ * distribution of the delay between events being timestamped and read.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <gpiod.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpiosim.h"
+
+#define NORETURN		__attribute__((noreturn))
+#define NSEC_PER_SEC		1000000000ULL
+#define MAX_LINES		64
+/* Stop waiting for the rest of the events after this much silence. */
+#define IDLE_TIMEOUT_NS		NSEC_PER_SEC
+
+enum read_mode {
+	READ_MODE_POLL,
+	READ_MODE_BUSY,
+};
+
+struct config {
+	unsigned int num_lines;
+	unsigned long num_edges;
+	unsigned long rate;
+	size_t buffer_size;
+	size_t kernel_buffer_size;
+	enum read_mode read_mode;
+};
+
+static NORETURN void die(const char *fmt, ...)
+{
+	va_list va;
+
+	va_start(va, fmt);
+	fprintf(stderr, "gpiosim-stress: ");
+	vfprintf(stderr, fmt, va);
+	fprintf(stderr, "\n");
+	va_end(va);
+
+	exit(EXIT_FAILURE);
+}
+
+static NORETURN void die_perror(const char *msg)
+{
+	fprintf(stderr, "gpiosim-stress: %s: %s\n", msg, strerror(errno));
+
+	exit(EXIT_FAILURE);
+}
+
+static void print_help(void)
+{
+	printf("Usage: gpiosim-stress [OPTIONS]\n");
+	printf("\n");
+	printf("Toggle the lines of a simulated chip and consume the edge events.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("  -b, --buffer-size <num>\n");
+	printf("\t\t\tcapacity of the edge event buffer (default is 64)\n");
+	printf("  -e, --num-edges <num>\n");
+	printf("\t\t\tnumber of edges generated on each line (default is 10000)\n");
+	printf("  -h, --help\t\tdisplay this help and exit\n");
+	printf("  -k, --kernel-buffer-size <num>\n");
+	printf("\t\t\tsize of the kernel event queue (default is picked by the kernel)\n");
+	printf("  -m, --read-mode <mode>\n");
+	printf("\t\t\thow to wait for events\n");
+	printf("\t\t\tPossible values: 'poll', 'busy'.\n");
+	printf("\t\t\t(default is 'poll')\n");
+	printf("  -n, --num-lines <num>\n");
+	printf("\t\t\tnumber of simulated lines, at most %d (default is 8)\n",
+	       MAX_LINES);
+	printf("  -r, --rate <num>\tedges per second on each line, 0 toggles the\n");
+	printf("\t\t\tlines as fast as possible (default is 0)\n");
+}
+
+static unsigned long parse_ulong_or_die(const char *option, const char *name)
+{
+	unsigned long val;
+	char *end;
+
+	errno = 0;
+	val = strtoul(option, &end, 10);
+	if (errno || *end != '\0' || option[0] == '-')
+		die("invalid %s: %s", name, option);
+
+	return val;
+}
+
+static void parse_config(int argc, char **argv, struct config *cfg)
+{
+	static const struct option longopts[] = {
+		{ "buffer-size",	required_argument,	NULL,	'b' },
+		{ "help",		no_argument,		NULL,	'h' },
+		{ "kernel-buffer-size",	required_argument,	NULL,	'k' },
+		{ "num-edges",		required_argument,	NULL,	'e' },
+		{ "num-lines",		required_argument,	NULL,	'n' },
+		{ "rate",		required_argument,	NULL,	'r' },
+		{ "read-mode",		required_argument,	NULL,	'm' },
+		{ NULL,			0,			NULL,	0 },
+	};
+
+	static const char *const shortopts = "+b:e:hk:m:n:r:";
+
+	int opti, optc;
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->num_lines = 8;
+	cfg->num_edges = 10000;
+	cfg->buffer_size = 64;
+
+	for (;;) {
+		optc = getopt_long(argc, argv, shortopts, longopts, &opti);
+		if (optc < 0)
+			break;
+
+		switch (optc) {
+		case 'b':
+			cfg->buffer_size = parse_ulong_or_die(optarg,
+							      "buffer size");
+			if (!cfg->buffer_size)
+				die("buffer size must be positive");
+			break;
+		case 'e':
+			cfg->num_edges = parse_ulong_or_die(optarg,
+							    "number of edges");
+			if (!cfg->num_edges)
+				die("number of edges must be positive");
+			break;
+		case 'h':
+			print_help();
+			exit(EXIT_SUCCESS);
+		case 'k':
+			cfg->kernel_buffer_size = parse_ulong_or_die(optarg,
+							"kernel buffer size");
+			break;
+		case 'm':
+			if (strcmp(optarg, "poll") == 0)
+				cfg->read_mode = READ_MODE_POLL;
+			else if (strcmp(optarg, "busy") == 0)
+				cfg->read_mode = READ_MODE_BUSY;
+			else
+				die("invalid read mode: %s", optarg);
+			break;
+		case 'n':
+			cfg->num_lines = parse_ulong_or_die(optarg,
+							    "number of lines");
+			if (!cfg->num_lines || cfg->num_lines > MAX_LINES)
+				die("number of lines must be between 1 and %d",
+				    MAX_LINES);
+			break;
+		case 'r':
+			cfg->rate = parse_ulong_or_die(optarg, "rate");
+			break;
+		case '?':
+			die("try gpiosim-stress --help");
+		default:
+			abort();
+		}
+	}
+
+	if (optind != argc)
+		die("unexpected argument: %s", argv[optind]);
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static int compare_u64(const void *p1, const void *p2)
+{
+	uint64_t v1 = *(const uint64_t *)p1;
+	uint64_t v2 = *(const uint64_t *)p2;
+
+	return v1 < v2 ? -1 : v1 > v2;
+}
+
+static void print_latency(uint64_t *latencies, size_t num_samples)
+{
+	static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+	size_t i, index;
+
+	if (!num_samples) {
+		printf("latency: no samples\n");
+		return;
+	}
+
+	qsort(latencies, num_samples, sizeof(*latencies), compare_u64);
+
+	printf("latency: min=%" PRIu64, latencies[0]);
+
+	for (i = 0; i < sizeof(percentiles) / sizeof(*percentiles); i++) {
+		index = (size_t)(percentiles[i] / 100.0 * (num_samples - 1));
+		printf(" p%g=%" PRIu64, percentiles[i], latencies[index]);
+	}
+
+	printf(" max=%" PRIu64 " (ns)\n", latencies[num_samples - 1]);
+}
+
+static struct gpiod_line_request *
+request_lines(const char *path, struct config *cfg)
+{
+	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_settings *settings;
+	struct gpiod_line_config *line_cfg;
+	struct gpiod_line_request *request;
+	unsigned int offsets[MAX_LINES];
+	struct gpiod_chip *chip;
+	unsigned int i;
+	int ret;
+
+	chip = gpiod_chip_open(path);
+	if (!chip)
+		die_perror("unable to open the simulated chip");
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	req_cfg = gpiod_request_config_new();
+	if (!settings || !line_cfg || !req_cfg)
+		die_perror("unable to allocate the request configuration");
+
+	for (i = 0; i < cfg->num_lines; i++)
+		offsets[i] = i;
+
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	ret = gpiod_line_config_add_line_settings(line_cfg, offsets,
+						  cfg->num_lines, settings);
+	if (ret)
+		die_perror("unable to add line settings");
+
+	gpiod_request_config_set_consumer(req_cfg, "gpiosim-stress");
+	gpiod_request_config_set_event_buffer_size(req_cfg,
+						   cfg->kernel_buffer_size);
+	gpiod_request_config_set_nonblocking(req_cfg,
+					     cfg->read_mode == READ_MODE_BUSY);
+
+	request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+	if (!request)
+		die_perror("unable to request lines");
+
+	gpiod_request_config_free(req_cfg);
+	gpiod_line_config_free(line_cfg);
+	gpiod_line_settings_free(settings);
+	gpiod_chip_close(chip);
+
+	return request;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int offsets[MAX_LINES];
+	struct gpiod_edge_event_buffer *buffer;
+	uint64_t start, last_read, now, expected;
+	uint64_t num_read = 0, num_dropped = 0;
+	struct gpiod_line_request *request;
+	struct gpiod_edge_event *event;
+	struct gpiosim_edge_gen *gen;
+	struct gpiosim_bank *bank;
+	struct gpiosim_ctx *ctx;
+	struct gpiosim_dev *dev;
+	uint64_t *latencies;
+	struct config cfg;
+	unsigned int i;
+	int ret, j;
+
+	parse_config(argc, argv, &cfg);
+
+	ctx = gpiosim_ctx_new();
+	if (!ctx)
+		die_perror("unable to create the gpio-sim context");
+
+	dev = gpiosim_dev_new(ctx);
+	if (!dev)
+		die_perror("unable to create a gpio-sim device");
+
+	bank = gpiosim_bank_new(dev);
+	if (!bank)
+		die_perror("unable to create a gpio-sim bank");
+
+	ret = gpiosim_bank_set_num_lines(bank, cfg.num_lines);
+	if (ret)
+		die_perror("unable to set the number of lines");
+
+	ret = gpiosim_dev_enable(dev);
+	if (ret)
+		die_perror("unable to enable the gpio-sim device");
+
+	request = request_lines(gpiosim_bank_get_dev_path(bank), &cfg);
+
+	for (i = 0; i < cfg.num_lines; i++)
+		offsets[i] = i;
+
+	gen = gpiosim_edge_gen_new(bank, offsets, cfg.num_lines);
+	if (!gen)
+		die_perror("unable to create the edge generator");
+
+	buffer = gpiod_edge_event_buffer_new(cfg.buffer_size);
+	if (!buffer)
+		die_perror("unable to allocate the edge event buffer");
+
+	expected = (uint64_t)cfg.num_lines * cfg.num_edges;
+
+	latencies = malloc(sizeof(*latencies) * expected);
+	if (!latencies)
+		die_perror("unable to allocate memory for latency samples");
+
+	ret = gpiosim_edge_gen_start(gen, cfg.rate, cfg.num_edges);
+	if (ret)
+		die_perror("unable to start the edge generator");
+
+	start = last_read = now_ns();
+
+	while (num_read + num_dropped < expected) {
+		if (cfg.read_mode == READ_MODE_POLL) {
+			ret = gpiod_line_request_wait_edge_events(
+						request, IDLE_TIMEOUT_NS);
+			if (ret < 0)
+				die_perror("error waiting for edge events");
+			if (ret == 0)
+				break;
+		}
+
+		ret = gpiod_line_request_read_edge_events(request, buffer,
+							  cfg.buffer_size);
+		if (ret < 0)
+			die_perror("error reading edge events");
+
+		now = now_ns();
+
+		if (ret == 0) {
+			if (now - last_read > IDLE_TIMEOUT_NS)
+				break;
+
+			continue;
+		}
+
+		for (j = 0; j < ret && num_read < expected; j++) {
+			event = gpiod_edge_event_buffer_get_event(buffer, j);
+			latencies[num_read++] = now -
+				gpiod_edge_event_get_timestamp_ns(event);
+		}
+
+		last_read = now;
+		num_dropped = gpiod_line_request_get_num_dropped_events(
+								request);
+	}
+
+	ret = gpiosim_edge_gen_wait(gen);
+	if (ret)
+		die_perror("error generating edges");
+
+	/* Drops after the last event read leave no gap in the seqnos. */
+	if (num_read + num_dropped < expected)
+		num_dropped = expected - num_read;
+
+	printf("lines: %u, edges per line: %lu, buffer size: %zu, kernel buffer size: %zu, read mode: %s\n",
+	       cfg.num_lines, cfg.num_edges, cfg.buffer_size,
+	       gpiod_line_request_get_event_buffer_size(request),
+	       cfg.read_mode == READ_MODE_POLL ? "poll" : "busy");
+	printf("generated: %" PRIu64 " edges at %.0f edges/s\n",
+	       gpiosim_edge_gen_get_num_edges(gen),
+	       gpiosim_edge_gen_get_rate(gen));
+	printf("read: %" PRIu64 " events at %.0f events/s\n", num_read,
+	       last_read > start ?
+			(double)num_read * NSEC_PER_SEC / (last_read - start) :
+			0.0);
+	printf("dropped: %" PRIu64 "\n", num_dropped);
+	print_latency(latencies, num_read);
+
+	free(latencies);
+	gpiod_edge_event_buffer_free(buffer);
+	gpiosim_edge_gen_free(gen);
+	gpiod_line_request_release(request);
+	gpiosim_dev_disable(dev);
+	gpiosim_bank_unref(bank);
+	gpiosim_dev_unref(dev);
+	gpiosim_ctx_unref(ctx);
+
+	return EXIT_SUCCESS;
+}
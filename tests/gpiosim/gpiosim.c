@@ -18,6 +18,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "gpiosim.h"
@@ -25,6 +26,7 @@
 #define GPIOSIM_API		__attribute__((visibility("default")))
 #define ARRAY_SIZE(x)		(sizeof(x) / sizeof(*(x)))
 #define MIN_KERNEL_VERSION	KERNEL_VERSION(5, 17, 4)
+#define NSEC_PER_SEC		1000000000ULL
 
 static pthread_mutex_t id_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_once_t id_init_once = PTHREAD_ONCE_INIT;
@@ -1181,3 +1183,269 @@ gpiosim_bank_set_pull(struct gpiosim_bank *bank,
 
 	return open_write_close(bank->sysfs_dir_fd, where, what);
 }
+
+struct gpiosim_edge_gen {
+	struct gpiosim_bank *bank;
+	size_t num_lines;
+	int *fds;
+	bool *pulled_up;
+	pthread_t thread;
+	bool running;
+	bool stop;
+	unsigned long rate;
+	size_t max_edges;
+	uint64_t num_edges;
+	uint64_t elapsed_ns;
+	int error;
+};
+
+static uint64_t edge_gen_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+GPIOSIM_API struct gpiosim_edge_gen *
+gpiosim_edge_gen_new(struct gpiosim_bank *bank, const unsigned int *offsets,
+		     size_t num_offsets)
+{
+	struct gpiosim_edge_gen *gen;
+	enum gpiosim_pull pull;
+	char where[32];
+	size_t i;
+
+	if (!dev_check_live(bank->dev))
+		return NULL;
+
+	if (!num_offsets) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	gen = calloc(1, sizeof(*gen));
+	if (!gen)
+		return NULL;
+
+	gen->fds = malloc(sizeof(*gen->fds) * num_offsets);
+	gen->pulled_up = malloc(sizeof(*gen->pulled_up) * num_offsets);
+	if (!gen->fds || !gen->pulled_up)
+		goto err_free;
+
+	for (i = 0; i < num_offsets; i++) {
+		pull = gpiosim_bank_get_pull(bank, offsets[i]);
+		if (pull == GPIOSIM_PULL_ERROR)
+			goto err_close;
+
+		snprintf(where, sizeof(where), "sim_gpio%u/pull", offsets[i]);
+
+		gen->fds[i] = openat(bank->sysfs_dir_fd, where, O_WRONLY);
+		if (gen->fds[i] < 0)
+			goto err_close;
+
+		gen->pulled_up[i] = pull == GPIOSIM_PULL_UP;
+		gen->num_lines++;
+	}
+
+	gen->bank = gpiosim_bank_ref(bank);
+
+	return gen;
+
+err_close:
+	for (i = 0; i < gen->num_lines; i++)
+		close(gen->fds[i]);
+err_free:
+	free(gen->pulled_up);
+	free(gen->fds);
+	free(gen);
+
+	return NULL;
+}
+
+GPIOSIM_API void gpiosim_edge_gen_free(struct gpiosim_edge_gen *gen)
+{
+	size_t i;
+
+	if (!gen)
+		return;
+
+	gpiosim_edge_gen_stop(gen);
+
+	for (i = 0; i < gen->num_lines; i++)
+		close(gen->fds[i]);
+
+	gpiosim_bank_unref(gen->bank);
+	free(gen->pulled_up);
+	free(gen->fds);
+	free(gen);
+}
+
+/* Toggle the pull of every line once. */
+static int edge_gen_toggle(struct gpiosim_edge_gen *gen)
+{
+	const char *what;
+	ssize_t written;
+	size_t i, size;
+
+	for (i = 0; i < gen->num_lines; i++) {
+		what = gen->pulled_up[i] ? "pull-down" : "pull-up";
+		size = strlen(what) + 1;
+
+		written = pwrite(gen->fds[i], what, size, 0);
+		if (written < 0)
+			return -1;
+		if ((size_t)written != size) {
+			errno = EIO;
+			return -1;
+		}
+
+		gen->pulled_up[i] = !gen->pulled_up[i];
+		gen->num_edges++;
+	}
+
+	return 0;
+}
+
+static void edge_gen_reset(struct gpiosim_edge_gen *gen)
+{
+	gen->num_edges = 0;
+	gen->elapsed_ns = 0;
+	gen->error = 0;
+}
+
+GPIOSIM_API int gpiosim_edge_gen_burst(struct gpiosim_edge_gen *gen,
+				       size_t num_edges)
+{
+	uint64_t start;
+	size_t i;
+	int ret = 0;
+
+	if (gen->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	edge_gen_reset(gen);
+	start = edge_gen_now_ns();
+
+	for (i = 0; i < num_edges; i++) {
+		ret = edge_gen_toggle(gen);
+		if (ret)
+			break;
+	}
+
+	gen->elapsed_ns = edge_gen_now_ns() - start;
+
+	return ret;
+}
+
+static void timespec_add_ns(struct timespec *ts, uint64_t ns)
+{
+	ns += ts->tv_nsec;
+	ts->tv_sec += ns / NSEC_PER_SEC;
+	ts->tv_nsec = ns % NSEC_PER_SEC;
+}
+
+static void *edge_gen_thread_func(void *data)
+{
+	struct gpiosim_edge_gen *gen = data;
+	struct timespec next;
+	uint64_t start, period = 0;
+	size_t i;
+	int ret;
+
+	if (gen->rate)
+		period = NSEC_PER_SEC / gen->rate;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	start = edge_gen_now_ns();
+
+	for (i = 0; !gen->max_edges || i < gen->max_edges; i++) {
+		if (__atomic_load_n(&gen->stop, __ATOMIC_RELAXED))
+			break;
+
+		ret = edge_gen_toggle(gen);
+		if (ret) {
+			gen->error = errno;
+			break;
+		}
+
+		if (period) {
+			/*
+			 * Keep to the schedule rather than catch up in bursts
+			 * if a transition was late.
+			 */
+			timespec_add_ns(&next, period);
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+					&next, NULL);
+		}
+	}
+
+	gen->elapsed_ns = edge_gen_now_ns() - start;
+
+	return NULL;
+}
+
+GPIOSIM_API int gpiosim_edge_gen_start(struct gpiosim_edge_gen *gen,
+				       unsigned long rate, size_t num_edges)
+{
+	int ret;
+
+	if (gen->running) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	edge_gen_reset(gen);
+	gen->rate = rate;
+	gen->max_edges = num_edges;
+	gen->stop = false;
+
+	ret = pthread_create(&gen->thread, NULL, edge_gen_thread_func, gen);
+	if (ret) {
+		errno = ret;
+		return -1;
+	}
+
+	gen->running = true;
+
+	return 0;
+}
+
+GPIOSIM_API int gpiosim_edge_gen_wait(struct gpiosim_edge_gen *gen)
+{
+	if (!gen->running)
+		return 0;
+
+	pthread_join(gen->thread, NULL);
+	gen->running = false;
+
+	if (gen->error) {
+		errno = gen->error;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOSIM_API int gpiosim_edge_gen_stop(struct gpiosim_edge_gen *gen)
+{
+	__atomic_store_n(&gen->stop, true, __ATOMIC_RELAXED);
+
+	return gpiosim_edge_gen_wait(gen);
+}
+
+GPIOSIM_API uint64_t gpiosim_edge_gen_get_num_edges(struct gpiosim_edge_gen *gen)
+{
+	return gen->num_edges;
+}
+
+GPIOSIM_API double gpiosim_edge_gen_get_rate(struct gpiosim_edge_gen *gen)
+{
+	if (!gen->elapsed_ns)
+		return 0.0;
+
+	return (double)gen->num_edges * NSEC_PER_SEC / gen->elapsed_ns;
+}
@@ -6,6 +6,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +15,7 @@ extern "C" {
 struct gpiosim_ctx;
 struct gpiosim_dev;
 struct gpiosim_bank;
+struct gpiosim_edge_gen;
 
 enum gpiosim_value {
 	GPIOSIM_VALUE_ERROR = -1,
@@ -69,6 +71,27 @@ gpiosim_bank_get_pull(struct gpiosim_bank *bank, unsigned int offset);
 int gpiosim_bank_set_pull(struct gpiosim_bank *bank,
 			  unsigned int offset, enum gpiosim_pull pull);
 
+/*
+ * Edge generators toggle the pulls of a set of lines with one write() per
+ * transition - the sysfs attributes are opened only once - either as a
+ * synchronous burst or from a helper thread at a fixed rate. Pulls are read
+ * once at creation, they must not be changed otherwise while the generator
+ * exists. Rates and edge counts passed in apply to every line, 0 meaning as
+ * fast as possible and until stopped respectively. The reported count and rate
+ * cover all lines together.
+ */
+struct gpiosim_edge_gen *
+gpiosim_edge_gen_new(struct gpiosim_bank *bank, const unsigned int *offsets,
+		     size_t num_offsets);
+void gpiosim_edge_gen_free(struct gpiosim_edge_gen *gen);
+int gpiosim_edge_gen_burst(struct gpiosim_edge_gen *gen, size_t num_edges);
+int gpiosim_edge_gen_start(struct gpiosim_edge_gen *gen, unsigned long rate,
+			   size_t num_edges);
+int gpiosim_edge_gen_wait(struct gpiosim_edge_gen *gen);
+int gpiosim_edge_gen_stop(struct gpiosim_edge_gen *gen);
+uint64_t gpiosim_edge_gen_get_num_edges(struct gpiosim_edge_gen *gen);
+double gpiosim_edge_gen_get_rate(struct gpiosim_edge_gen *gen);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
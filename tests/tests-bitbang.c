@@ -0,0 +1,302 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "bitbang"
+
+#define CLOCK_OFFSET	0
+#define LATCH_OFFSET	1
+#define DATA_OFFSET	2
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, guint num_lines)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	guint offsets[8], i;
+
+	g_assert_cmpuint(num_lines, <=, G_N_ELEMENTS(offsets));
+
+	for (i = 0; i < num_lines; i++)
+		offsets[i] = i;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_lines,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(set_roles_with_invalid_arguments)
+{
+	static const guint dup_offsets[] = { 2, 3, 2 };
+	static const guint bad_offsets[] = { 2, 4 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_bitbang) bb = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, 4);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	bb = gpiod_test_create_bitbang_or_fail(request);
+
+	ret = gpiod_bitbang_set_clock(bb, 5, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_bitbang_set_clock(bb, CLOCK_OFFSET, GPIOD_LINE_VALUE_ERROR);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_bitbang_set_latch(bb, 6);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_bitbang_set_data_lines(bb, dup_offsets, 3);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_bitbang_set_data_lines(bb, bad_offsets, 2);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_bitbang_set_data_lines(bb, bad_offsets, 0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(write_requires_distinct_roles)
+{
+	static const guchar byte = 0xa5;
+	static const guint data_offset = DATA_OFFSET;
+	static const guint latch_offset = LATCH_OFFSET;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_bitbang) bb = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, 4);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	bb = gpiod_test_create_bitbang_or_fail(request);
+
+	/* No clock and no data lines. */
+	ret = gpiod_bitbang_write(bb, &byte, 1);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_bitbang_set_clock(bb, CLOCK_OFFSET,
+						GPIOD_LINE_VALUE_INACTIVE),
+			==, 0);
+	ret = gpiod_bitbang_write(bb, &byte, 1);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, &data_offset, 1),
+			==, 0);
+	g_assert_cmpint(gpiod_bitbang_set_latch(bb, DATA_OFFSET), ==, 0);
+	ret = gpiod_bitbang_write(bb, &byte, 1);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, &latch_offset, 1),
+			==, 0);
+	g_assert_cmpint(gpiod_bitbang_set_latch(bb, CLOCK_OFFSET), ==, 0);
+	ret = gpiod_bitbang_write(bb, &byte, 1);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	gpiod_bitbang_clear_latch(bb);
+	g_assert_cmpint(gpiod_bitbang_write(bb, &byte, 1), ==, 0);
+}
+
+GPIOD_TEST_CASE(num_writes)
+{
+	static const guint data_offsets[] = { 2, 3, 4 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_bitbang) bb = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, 5);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	bb = gpiod_test_create_bitbang_or_fail(request);
+
+	g_assert_cmpuint(gpiod_bitbang_get_num_writes(bb, 1), ==, 0);
+
+	g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, data_offsets, 1),
+			==, 0);
+	g_assert_cmpuint(gpiod_bitbang_get_num_writes(bb, 0), ==, 0);
+	g_assert_cmpuint(gpiod_bitbang_get_num_writes(bb, 2), ==, 33);
+
+	g_assert_cmpint(gpiod_bitbang_set_latch(bb, LATCH_OFFSET), ==, 0);
+	g_assert_cmpuint(gpiod_bitbang_get_num_writes(bb, 2), ==, 34);
+
+	/* 16 bits over 3 lines take 6 cycles, the last one padded. */
+	g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, data_offsets, 3),
+			==, 0);
+	g_assert_cmpuint(gpiod_bitbang_get_num_writes(bb, 2), ==, 14);
+}
+
+GPIOD_TEST_CASE(lines_are_left_idle_after_write)
+{
+	static const guchar byte = 0x01;
+	static const guint data_offset = DATA_OFFSET;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_bitbang) bb = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, 3);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	bb = gpiod_test_create_bitbang_or_fail(request);
+
+	g_assert_cmpint(gpiod_bitbang_set_clock(bb, CLOCK_OFFSET,
+						GPIOD_LINE_VALUE_ACTIVE),
+			==, 0);
+	g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, &data_offset, 1),
+			==, 0);
+	g_assert_cmpint(gpiod_bitbang_set_latch(bb, LATCH_OFFSET), ==, 0);
+
+	/* The last bit shifted out stays on the data line. */
+	g_assert_cmpint(gpiod_bitbang_write(bb, &byte, 1), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, CLOCK_OFFSET), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, LATCH_OFFSET), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, DATA_OFFSET), ==, 1);
+
+	gpiod_bitbang_set_lsb_first(bb, true);
+	g_assert_cmpint(gpiod_bitbang_write(bb, &byte, 1), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, CLOCK_OFFSET), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, LATCH_OFFSET), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, DATA_OFFSET), ==, 0);
+}
+
+GPIOD_TEST_CASE(edge_interval_is_respected)
+{
+	static const guint64 interval_ns = 1000000;
+	static const guint data_offset = DATA_OFFSET;
+	static const guchar byte = 0x5a;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_bitbang) bb = NULL;
+	gdouble elapsed;
+	gsize num_writes;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, 3);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	bb = gpiod_test_create_bitbang_or_fail(request);
+
+	g_assert_cmpint(gpiod_bitbang_set_clock(bb, CLOCK_OFFSET,
+						GPIOD_LINE_VALUE_INACTIVE),
+			==, 0);
+	g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, &data_offset, 1),
+			==, 0);
+	gpiod_bitbang_set_edge_interval_ns(bb, interval_ns);
+	g_assert_cmpuint(gpiod_bitbang_get_edge_interval_ns(bb), ==,
+			 interval_ns);
+
+	num_writes = gpiod_bitbang_get_num_writes(bb, 1);
+
+	g_test_timer_start();
+	g_assert_cmpint(gpiod_bitbang_write(bb, &byte, 1), ==, 0);
+	elapsed = g_test_timer_elapsed();
+
+	/* The first write happens right away. */
+	g_assert_cmpfloat(elapsed * 1000000000, >=,
+			  (num_writes - 1) * interval_ns);
+}
+
+#define BENCHMARK_BYTES 4096
+
+GPIOD_TEST_CASE(shift_out_throughput_benchmark)
+{
+	static const guint data_offsets[] = { 2, 3, 4, 5, 6, 7 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_bitbang) bb = NULL;
+	g_autofree guchar *data = NULL;
+	gdouble elapsed;
+	gsize num_data;
+	guint i;
+
+	if (!g_test_perf()) {
+		g_test_skip("benchmark - run with '-m perf' to enable");
+		return;
+	}
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, 8);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	bb = gpiod_test_create_bitbang_or_fail(request);
+
+	data = g_malloc(BENCHMARK_BYTES);
+	for (i = 0; i < BENCHMARK_BYTES; i++)
+		data[i] = g_test_rand_int_range(0, 256);
+
+	g_assert_cmpint(gpiod_bitbang_set_clock(bb, CLOCK_OFFSET,
+						GPIOD_LINE_VALUE_INACTIVE),
+			==, 0);
+	g_assert_cmpint(gpiod_bitbang_set_latch(bb, LATCH_OFFSET), ==, 0);
+
+	/* Serial and wider parallel transfers of the same stream. */
+	for (num_data = 1; num_data <= G_N_ELEMENTS(data_offsets);
+	     num_data *= 2) {
+		g_assert_cmpint(gpiod_bitbang_set_data_lines(bb, data_offsets,
+							     num_data),
+				==, 0);
+
+		g_test_timer_start();
+		g_assert_cmpint(gpiod_bitbang_write(bb, data, BENCHMARK_BYTES),
+				==, 0);
+		elapsed = g_test_timer_elapsed();
+		gpiod_test_return_if_failed();
+
+		g_test_maximized_result(BENCHMARK_BYTES / elapsed,
+			"shifting out over %zu data line(s): "
+			"%.0f bytes/s, %.2f us per write",
+			num_data, BENCHMARK_BYTES / elapsed,
+			elapsed * 1000000 /
+			gpiod_bitbang_get_num_writes(bb, BENCHMARK_BYTES));
+	}
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "bus-sampler"
+
+#define CLOCK_OFFSET	0
+
+static const guint data_offsets[] = { 1, 2, 3 };
+
+static void set_bus(GPIOSimChip *sim, guint word)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(data_offsets); i++)
+		g_gpiosim_chip_set_pull(sim, data_offsets[i],
+					word & (1 << i) ? G_GPIOSIM_PULL_UP :
+							  G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+}
+
+static void pulse_clock(GPIOSimChip *sim)
+{
+	g_gpiosim_chip_set_pull(sim, CLOCK_OFFSET, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, CLOCK_OFFSET, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+}
+
+static struct gpiod_bus_sampler *
+request_sampler(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg,
+		gsize ring_size)
+{
+	return gpiod_chip_request_bus_sampler(chip, req_cfg, NULL, CLOCK_OFFSET,
+					      GPIOD_LINE_EDGE_RISING,
+					      data_offsets,
+					      G_N_ELEMENTS(data_offsets),
+					      ring_size);
+}
+
+GPIOD_TEST_CASE(request_with_invalid_arguments)
+{
+	static const guint with_clock[] = { 1, CLOCK_OFFSET };
+	static const guint duplicated[] = { 1, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_bus_sampler *sampler;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	sampler = gpiod_chip_request_bus_sampler(chip, NULL, NULL,
+						 CLOCK_OFFSET,
+						 GPIOD_LINE_EDGE_RISING,
+						 with_clock, 2, 16);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+
+	sampler = gpiod_chip_request_bus_sampler(chip, NULL, NULL,
+						 CLOCK_OFFSET,
+						 GPIOD_LINE_EDGE_NONE,
+						 data_offsets, 3, 16);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+
+	sampler = gpiod_chip_request_bus_sampler(chip, NULL, NULL,
+						 CLOCK_OFFSET,
+						 GPIOD_LINE_EDGE_RISING,
+						 data_offsets, 0, 16);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+
+	sampler = gpiod_chip_request_bus_sampler(chip, NULL, NULL,
+						 CLOCK_OFFSET,
+						 GPIOD_LINE_EDGE_RISING,
+						 data_offsets, 3, 0);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+
+	sampler = gpiod_chip_request_bus_sampler(chip, NULL, NULL,
+						 CLOCK_OFFSET,
+						 GPIOD_LINE_EDGE_RISING,
+						 duplicated, 2, 16);
+	g_assert_null(sampler);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(sample_data_on_clock_edges)
+{
+	static const guint64 expected[] = { 0x5, 0x2, 0x7, 0x0 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_bus_sampler) sampler = NULL;
+	guint64 words[8];
+	gsize i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	/* The bus is sampled at the level it had before the request. */
+	set_bus(sim, 0x5);
+
+	sampler = request_sampler(chip, NULL, 16);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	pulse_clock(sim);
+
+	for (i = 1; i < G_N_ELEMENTS(expected); i++) {
+		set_bus(sim, expected[i]);
+		pulse_clock(sim);
+	}
+
+	/* Changes after the last clock edge are not sampled. */
+	set_bus(sim, 0x3);
+
+	ret = gpiod_bus_sampler_wait(sampler, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_bus_sampler_sample(sampler);
+	g_assert_cmpint(ret, ==, G_N_ELEMENTS(expected));
+	g_assert_cmpuint(gpiod_bus_sampler_get_num_words(sampler), ==,
+			 G_N_ELEMENTS(expected));
+
+	g_assert_cmpuint(gpiod_bus_sampler_read_words(sampler, words,
+						      G_N_ELEMENTS(words)),
+			 ==, G_N_ELEMENTS(expected));
+	for (i = 0; i < G_N_ELEMENTS(expected); i++)
+		g_assert_cmpuint(words[i], ==, expected[i]);
+
+	g_assert_cmpuint(gpiod_bus_sampler_get_num_words(sampler), ==, 0);
+	g_assert_cmpuint(gpiod_bus_sampler_get_num_missed_clocks(sampler),
+			 ==, 0);
+	g_assert_cmpuint(gpiod_bus_sampler_get_num_overruns(sampler), ==, 0);
+}
+
+GPIOD_TEST_CASE(full_ring_drops_oldest_words)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_bus_sampler) sampler = NULL;
+	guint64 words[4];
+	guint i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	sampler = request_sampler(chip, NULL, 2);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	for (i = 1; i <= 3; i++) {
+		set_bus(sim, i);
+		pulse_clock(sim);
+	}
+
+	ret = gpiod_bus_sampler_sample(sampler);
+	g_assert_cmpint(ret, ==, 3);
+	g_assert_cmpuint(gpiod_bus_sampler_get_num_overruns(sampler), ==, 1);
+
+	g_assert_cmpuint(gpiod_bus_sampler_read_words(sampler, words, 1),
+			 ==, 1);
+	g_assert_cmpuint(words[0], ==, 2);
+	g_assert_cmpuint(gpiod_bus_sampler_read_words(sampler, words,
+						      G_N_ELEMENTS(words)),
+			 ==, 1);
+	g_assert_cmpuint(words[0], ==, 3);
+}
+
+GPIOD_TEST_CASE(missed_clocks_are_counted)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_bus_sampler) sampler = NULL;
+	guint64 words[4];
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	gpiod_request_config_set_event_buffer_size(req_cfg, 2);
+
+	sampler = request_sampler(chip, req_cfg, 16);
+	g_assert_nonnull(sampler);
+	gpiod_test_return_if_failed();
+
+	/* The data lines don't change - the kernel only sees clock edges. */
+	for (i = 0; i < 6; i++)
+		pulse_clock(sim);
+
+	ret = gpiod_bus_sampler_sample(sampler);
+	g_assert_cmpint(ret, ==, 2);
+
+	/*
+	 * Depending on the kernel, either the oldest or the newest events are
+	 * dropped. The gap is visible by the next clock edge at the latest.
+	 */
+	pulse_clock(sim);
+
+	ret = gpiod_bus_sampler_sample(sampler);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_bus_sampler_get_num_missed_clocks(sampler),
+			 ==, 4);
+
+	g_assert_cmpuint(gpiod_bus_sampler_read_words(sampler, words,
+						      G_N_ELEMENTS(words)),
+			 ==, 3);
+	for (i = 0; i < 3; i++)
+		g_assert_cmpuint(words[i], ==, 0);
+}
@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+
+#define GPIOD_TEST_GROUP "capture-reader"
+
+#define CHECKPOINT_INTERVAL	1024
+
+/* Header of the capture files written by gpiomon, see tools-common.h. */
+struct capture_header {
+	char magic[8];
+	guint32 version;
+	guint32 record_size;
+	guint64 capacity;
+	guint64 head;
+	guint64 index_offset;
+	guint64 records_offset;
+	guint32 checkpoint_interval;
+	guint32 num_lines;
+	guint32 event_clock;
+	guint32 reserved;
+	struct gpiod_capture_line lines[64];
+};
+
+static gchar *capture_path(void)
+{
+	return g_strdup_printf("/tmp/gpiod-test-capture.%u", getpid());
+}
+
+/*
+ * Writes a capture of the given capacity as gpiomon would after recording
+ * num_written events, the timestamp of the n-th one being 10 * n.
+ */
+static void write_capture(const gchar *path, guint64 capacity,
+			  guint64 num_written)
+{
+	g_autofree struct gpiod_capture_record *records = NULL;
+	g_autofree guint64 *index = NULL;
+	struct capture_header hdr;
+	guint64 num_checkpoints, n, slot;
+	FILE *fp;
+
+	num_checkpoints = (capacity + CHECKPOINT_INTERVAL - 1) /
+			  CHECKPOINT_INTERVAL;
+	records = g_new0(struct gpiod_capture_record, capacity);
+	index = g_new0(guint64, num_checkpoints);
+
+	for (n = 0; n < num_written; n++) {
+		slot = n % capacity;
+
+		records[slot].timestamp_ns = 10 * n;
+		records[slot].offset = 4;
+		records[slot].event_type = n % 2 ?
+					GPIOD_EDGE_EVENT_FALLING_EDGE :
+					GPIOD_EDGE_EVENT_RISING_EDGE;
+		records[slot].global_seqno = n + 1;
+		records[slot].line_seqno = n + 1;
+
+		if (slot % CHECKPOINT_INTERVAL == 0)
+			index[slot / CHECKPOINT_INTERVAL] = 10 * n;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, "GPIOCAP", 8);
+	hdr.version = 2;
+	hdr.record_size = sizeof(struct gpiod_capture_record);
+	hdr.capacity = capacity;
+	hdr.head = num_written;
+	hdr.index_offset = sizeof(hdr);
+	hdr.records_offset = sizeof(hdr) + num_checkpoints * sizeof(guint64);
+	hdr.checkpoint_interval = CHECKPOINT_INTERVAL;
+	hdr.num_lines = 1;
+	hdr.event_clock = GPIOD_LINE_CLOCK_REALTIME;
+	hdr.lines[0].offset = 4;
+	strcpy(hdr.lines[0].chip_name, "gpiochip0");
+	/* Not terminated. */
+	memset(hdr.lines[0].line_name, 'x', GPIOD_CAPTURE_NAME_SIZE);
+
+	fp = fopen(path, "w");
+	g_assert_nonnull(fp);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(fwrite(&hdr, sizeof(hdr), 1, fp), ==, 1);
+	g_assert_cmpuint(fwrite(index, sizeof(*index), num_checkpoints, fp),
+			 ==, num_checkpoints);
+	g_assert_cmpuint(fwrite(records, sizeof(*records), capacity, fp), ==,
+			 capacity);
+	g_assert_cmpint(fclose(fp), ==, 0);
+}
+
+GPIOD_TEST_CASE(read_header)
+{
+	g_autoptr(struct_gpiod_capture_reader) reader = NULL;
+	g_autofree gchar *path = capture_path();
+	const struct gpiod_capture_line *line;
+
+	write_capture(path, 2048, 100);
+	gpiod_test_return_if_failed();
+
+	reader = gpiod_capture_reader_open(path);
+	unlink(path);
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_capture_reader_get_event_clock(reader), ==,
+			GPIOD_LINE_CLOCK_REALTIME);
+	g_assert_cmpuint(gpiod_capture_reader_get_num_lines(reader), ==, 1);
+	g_assert_cmpuint(gpiod_capture_reader_get_num_records(reader), ==, 100);
+	g_assert_cmpuint(gpiod_capture_reader_get_num_lost(reader), ==, 0);
+
+	line = gpiod_capture_reader_get_line(reader, 0);
+	g_assert_nonnull(line);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(line->offset, ==, 4);
+	g_assert_cmpstr(line->chip_name, ==, "gpiochip0");
+	g_assert_cmpuint(strlen(line->line_name), ==,
+			 GPIOD_CAPTURE_NAME_SIZE - 1);
+
+	g_assert_null(gpiod_capture_reader_get_line(reader, 1));
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_null(gpiod_capture_reader_get_record(reader, 100));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(iterate_wrapped_ring)
+{
+	g_autoptr(struct_gpiod_capture_reader) reader = NULL;
+	g_autofree gchar *path = capture_path();
+	const struct gpiod_capture_record *records;
+	guint64 index = 0, n;
+	guint num_spans = 0;
+	size_t num, i;
+
+	write_capture(path, 3000, 7500);
+	gpiod_test_return_if_failed();
+
+	reader = gpiod_capture_reader_open(path);
+	unlink(path);
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_capture_reader_get_num_records(reader), ==,
+			 3000);
+	g_assert_cmpuint(gpiod_capture_reader_get_num_lost(reader), ==, 4500);
+
+	while ((num = gpiod_capture_reader_get_records(reader, index,
+						       &records))) {
+		for (i = 0; i < num; i++) {
+			n = 4500 + index + i;
+			g_assert_cmpuint(records[i].timestamp_ns, ==, 10 * n);
+			g_assert_cmpuint(records[i].line_seqno, ==, n + 1);
+		}
+
+		index += num;
+		num_spans++;
+	}
+
+	g_assert_cmpuint(index, ==, 3000);
+	g_assert_cmpuint(num_spans, ==, 2);
+	g_assert_null(records);
+
+	g_assert_cmpuint(gpiod_capture_reader_get_record(reader,
+							  0)->timestamp_ns,
+			 ==, 45000);
+}
+
+GPIOD_TEST_CASE(find_timestamps)
+{
+	static const guint64 capacities[] = { 3000, 4096 };
+	static const guint64 num_written[] = { 100, 2500, 3000, 7500, 9000 };
+
+	g_autofree gchar *path = capture_path();
+	struct gpiod_capture_reader *reader;
+	guint64 first, num, ts, found;
+	guint i, j;
+
+	for (i = 0; i < G_N_ELEMENTS(capacities); i++) {
+		for (j = 0; j < G_N_ELEMENTS(num_written); j++) {
+			write_capture(path, capacities[i], num_written[j]);
+			gpiod_test_return_if_failed();
+
+			reader = gpiod_capture_reader_open(path);
+			g_assert_nonnull(reader);
+			gpiod_test_return_if_failed();
+
+			first = gpiod_capture_reader_get_num_lost(reader);
+			num = gpiod_capture_reader_get_num_records(reader);
+
+			g_assert_cmpuint(gpiod_capture_reader_find(reader, 0),
+					 ==, 0);
+			g_assert_cmpuint(gpiod_capture_reader_find(reader,
+						10 * (first + num)), ==, num);
+
+			for (ts = 10 * first; ts < 10 * (first + num);
+			     ts += 7) {
+				found = gpiod_capture_reader_find(reader, ts);
+				/* First record at or after ts. */
+				g_assert_cmpuint(found, ==,
+						 (ts + 9) / 10 - first);
+			}
+
+			gpiod_capture_reader_close(reader);
+		}
+	}
+
+	unlink(path);
+}
+
+GPIOD_TEST_CASE(reject_invalid_files)
+{
+	g_autofree gchar *path = capture_path();
+	struct gpiod_capture_reader *reader;
+	struct capture_header hdr;
+	gchar zeroes[8192] = { 0 };
+	FILE *fp;
+
+	reader = gpiod_capture_reader_open("/dev/null");
+	g_assert_null(reader);
+	gpiod_test_expect_errno(EINVAL);
+
+	fp = fopen(path, "w");
+	g_assert_nonnull(fp);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(fwrite(zeroes, sizeof(zeroes), 1, fp), ==, 1);
+	g_assert_cmpint(fclose(fp), ==, 0);
+
+	reader = gpiod_capture_reader_open(path);
+	g_assert_null(reader);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* A capture promising more records than the file holds. */
+	write_capture(path, 2048, 10);
+	gpiod_test_return_if_failed();
+
+	fp = fopen(path, "r+");
+	g_assert_nonnull(fp);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(fread(&hdr, sizeof(hdr), 1, fp), ==, 1);
+	hdr.capacity = 4096;
+	rewind(fp);
+	g_assert_cmpuint(fwrite(&hdr, sizeof(hdr), 1, fp), ==, 1);
+	g_assert_cmpint(fclose(fp), ==, 0);
+
+	reader = gpiod_capture_reader_open(path);
+	unlink(path);
+	g_assert_null(reader);
+	gpiod_test_expect_errno(EINVAL);
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "chip-cache"
+
+static struct gpiod_chip_cache *new_cache_or_fail(void)
+{
+	struct gpiod_chip_cache *cache = gpiod_chip_cache_new();
+
+	g_assert_nonnull(cache);
+
+	return cache;
+}
+
+GPIOD_TEST_CASE(same_path_returns_same_chip)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new(NULL);
+	g_autoptr(struct_gpiod_chip_cache) cache = NULL;
+	struct gpiod_chip *chip;
+
+	cache = new_cache_or_fail();
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_chip_cache_open(cache, g_gpiosim_chip_get_dev_path(sim));
+	g_assert_nonnull(chip);
+	gpiod_test_return_if_failed();
+
+	g_assert_true(gpiod_chip_cache_open(cache,
+				g_gpiosim_chip_get_dev_path(sim)) == chip);
+	g_assert_cmpuint(gpiod_chip_cache_get_num_chips(cache), ==, 1);
+	g_assert_cmpstr(gpiod_chip_get_path(chip), ==,
+			g_gpiosim_chip_get_dev_path(sim));
+}
+
+GPIOD_TEST_CASE(different_chips)
+{
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new(NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new(NULL);
+	g_autoptr(struct_gpiod_chip_cache) cache = NULL;
+	struct gpiod_chip *chip0, *chip1;
+
+	cache = new_cache_or_fail();
+	gpiod_test_return_if_failed();
+
+	chip0 = gpiod_chip_cache_open(cache,
+				      g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_chip_cache_open(cache,
+				      g_gpiosim_chip_get_dev_path(sim1));
+	g_assert_nonnull(chip0);
+	g_assert_nonnull(chip1);
+	g_assert_true(chip0 != chip1);
+	g_assert_cmpuint(gpiod_chip_cache_get_num_chips(cache), ==, 2);
+}
+
+GPIOD_TEST_CASE(close_chip)
+{
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new(NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new(NULL);
+	g_autoptr(struct_gpiod_chip_cache) cache = NULL;
+	struct gpiod_chip *chip;
+
+	cache = new_cache_or_fail();
+	gpiod_test_return_if_failed();
+
+	gpiod_chip_cache_open(cache, g_gpiosim_chip_get_dev_path(sim0));
+	chip = gpiod_chip_cache_open(cache, g_gpiosim_chip_get_dev_path(sim1));
+	g_assert_nonnull(chip);
+	gpiod_test_return_if_failed();
+
+	gpiod_chip_cache_close(cache, g_gpiosim_chip_get_dev_path(sim0));
+	g_assert_cmpuint(gpiod_chip_cache_get_num_chips(cache), ==, 1);
+
+	/* Closing a chip that isn't cached is a no-op. */
+	gpiod_chip_cache_close(cache, g_gpiosim_chip_get_dev_path(sim0));
+	g_assert_cmpuint(gpiod_chip_cache_get_num_chips(cache), ==, 1);
+
+	g_assert_true(gpiod_chip_cache_open(cache,
+				g_gpiosim_chip_get_dev_path(sim1)) == chip);
+}
+
+GPIOD_TEST_CASE(open_nonexistent)
+{
+	g_autoptr(struct_gpiod_chip_cache) cache = NULL;
+
+	cache = new_cache_or_fail();
+	gpiod_test_return_if_failed();
+
+	g_assert_null(gpiod_chip_cache_open(cache, "/dev/nonexistent"));
+	gpiod_test_expect_errno(ENOENT);
+	g_assert_cmpuint(gpiod_chip_cache_get_num_chips(cache), ==, 0);
+}
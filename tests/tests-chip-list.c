@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <string.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "chip-list"
+
+static gssize find_chip(struct gpiod_chip_list *list, const gchar *path)
+{
+	size_t i;
+
+	for (i = 0; i < gpiod_chip_list_get_num_chips(list); i++) {
+		if (strcmp(gpiod_chip_list_get_path(list, i), path) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+GPIOD_TEST_CASE(finds_chips)
+{
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new(NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new(NULL);
+	g_autoptr(struct_gpiod_chip_list) list = NULL;
+
+	list = gpiod_chip_list_new(0);
+	g_assert_nonnull(list);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(find_chip(list, g_gpiosim_chip_get_dev_path(sim0)),
+			>=, 0);
+	g_assert_cmpint(find_chip(list, g_gpiosim_chip_get_dev_path(sim1)),
+			>=, 0);
+}
+
+GPIOD_TEST_CASE(chips_are_sorted)
+{
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new(NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new(NULL);
+	g_autoptr(struct_gpiod_chip_list) list = NULL;
+	size_t i;
+
+	list = gpiod_chip_list_new(0);
+	g_assert_nonnull(list);
+	gpiod_test_return_if_failed();
+
+	for (i = 1; i < gpiod_chip_list_get_num_chips(list); i++)
+		g_assert_cmpstr(gpiod_chip_list_get_path(list, i - 1), <,
+				gpiod_chip_list_get_path(list, i));
+}
+
+GPIOD_TEST_CASE(get_info)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 16,
+							"label", "foobar",
+							NULL);
+	g_autoptr(struct_gpiod_chip_list) list = NULL;
+	g_autoptr(struct_gpiod_chip_info) info = NULL;
+	gssize index;
+
+	list = gpiod_chip_list_new(0);
+	g_assert_nonnull(list);
+	gpiod_test_return_if_failed();
+
+	index = find_chip(list, g_gpiosim_chip_get_dev_path(sim));
+	g_assert_cmpint(index, >=, 0);
+	gpiod_test_return_if_failed();
+
+	info = gpiod_chip_list_get_info(list, index);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpstr(gpiod_chip_info_get_name(info), ==,
+			g_gpiosim_chip_get_name(sim));
+	g_assert_cmpstr(gpiod_chip_info_get_label(info), ==, "foobar");
+	g_assert_cmpuint(gpiod_chip_info_get_num_lines(info), ==, 16);
+}
+
+GPIOD_TEST_CASE(trusted_paths)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new(NULL);
+	g_autoptr(struct_gpiod_chip_list) list = NULL;
+
+	list = gpiod_chip_list_new(GPIOD_CHIP_LIST_TRUSTED_PATHS);
+	g_assert_nonnull(list);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(find_chip(list, g_gpiosim_chip_get_dev_path(sim)),
+			>=, 0);
+}
+
+GPIOD_TEST_CASE(index_out_of_range)
+{
+	g_autoptr(struct_gpiod_chip_list) list = NULL;
+	size_t num_chips;
+
+	list = gpiod_chip_list_new(0);
+	g_assert_nonnull(list);
+	gpiod_test_return_if_failed();
+
+	num_chips = gpiod_chip_list_get_num_chips(list);
+
+	g_assert_null(gpiod_chip_list_get_path(list, num_chips));
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_null(gpiod_chip_list_get_info(list, num_chips));
+	gpiod_test_expect_errno(EINVAL);
+}
@@ -167,3 +167,115 @@ GPIOD_TEST_CASE(find_line_null_name)
 	g_assert_cmpint(ret, ==, -1);
 	gpiod_test_expect_errno(EINVAL);
 }
+
+GPIOD_TEST_CASE(find_line_with_name_index)
+{
+	static const struct gpiod_test_line_name names[] = {
+		{ .offset = 1, .name = "foo", },
+		{ .offset = 2, .name = "baz", },
+		{ .offset = 4, .name = "baz", },
+		{ .offset = 5, .name = "xyz", },
+		{ }
+	};
+
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(GVariant) vnames = gpiod_test_package_line_names(names);
+
+	sim = g_gpiosim_chip_new(
+			"num-lines", 8,
+			"line-names", vnames,
+			NULL);
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	g_assert_false(gpiod_chip_get_name_index(chip));
+	gpiod_chip_set_name_index(chip, true);
+	g_assert_true(gpiod_chip_get_name_index(chip));
+
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "xyz"),
+			==, 5);
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "foo"),
+			==, 1);
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "baz"),
+			==, 2);
+	g_assert_cmpint(
+		gpiod_chip_get_line_offset_from_name(chip,
+						     "nonexistent"), ==, -1);
+	gpiod_test_expect_errno(ENOENT);
+
+	gpiod_chip_set_name_index(chip, false);
+	g_assert_false(gpiod_chip_get_name_index(chip));
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "baz"),
+			==, 2);
+}
+
+GPIOD_TEST_CASE(refresh_and_invalidate_name_index)
+{
+	static const struct gpiod_test_line_name names[] = {
+		{ .offset = 0, .name = "foo", },
+		{ .offset = 3, .name = "bar", },
+		{ }
+	};
+
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(GVariant) vnames = gpiod_test_package_line_names(names);
+	gint ret;
+
+	sim = g_gpiosim_chip_new(
+			"num-lines", 4,
+			"line-names", vnames,
+			NULL);
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	ret = gpiod_chip_refresh_name_index(chip);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+	g_assert_true(gpiod_chip_get_name_index(chip));
+
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "bar"),
+			==, 3);
+
+	gpiod_chip_invalidate_name_index(chip);
+	g_assert_true(gpiod_chip_get_name_index(chip));
+	g_assert_cmpint(gpiod_chip_get_line_offset_from_name(chip, "foo"),
+			==, 0);
+}
+
+GPIOD_TEST_CASE(stats_count_info_and_request_ioctls)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_chip_info) info = NULL;
+	g_autoptr(struct_gpiod_line_info) line_info = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_stats) stats = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	info = gpiod_chip_get_info(chip);
+	g_assert_nonnull(info);
+	line_info = gpiod_chip_get_line_info(chip, offset);
+	g_assert_nonnull(line_info);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 NULL);
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_assert_cmpint(gpiod_chip_wait_info_event(chip, 1000000), ==, 0);
+
+	stats = gpiod_chip_get_stats(chip);
+	g_assert_nonnull(stats);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_stats_get_num_info_ioctls(stats), ==, 2);
+	g_assert_cmpuint(gpiod_stats_get_num_config_ioctls(stats), ==, 1);
+	g_assert_cmpuint(gpiod_stats_get_num_get_ioctls(stats), ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_num_reads(stats), ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_wait_time_ns(stats), >=, 1000000);
+}
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <time.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+
+#define GPIOD_TEST_GROUP "clock-converter"
+
+static guint64 read_clock(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+
+	return (guint64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+GPIOD_TEST_CASE(hte_cannot_be_converted)
+{
+	struct gpiod_clock_converter *conv;
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_HTE,
+					 GPIOD_LINE_CLOCK_REALTIME);
+	g_assert_null(conv);
+	gpiod_test_expect_errno(ENOTSUP);
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_MONOTONIC,
+					 GPIOD_LINE_CLOCK_HTE);
+	g_assert_null(conv);
+	gpiod_test_expect_errno(ENOTSUP);
+}
+
+GPIOD_TEST_CASE(same_clock_is_identity)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_MONOTONIC,
+					 GPIOD_LINE_CLOCK_MONOTONIC);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_clock_converter_get_offset_ns(conv), ==, 0);
+	g_assert_cmpuint(gpiod_clock_converter_get_error_ns(conv), ==, 0);
+	g_assert_cmpuint(gpiod_clock_converter_convert_one(conv, 1234), ==,
+			 1234);
+}
+
+GPIOD_TEST_CASE(default_refresh_interval)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_MONOTONIC,
+					 GPIOD_LINE_CLOCK_REALTIME);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_clock_converter_get_refresh_interval_ns(conv),
+			 ==, 1000000000);
+
+	gpiod_clock_converter_set_refresh_interval_ns(conv, 0);
+	g_assert_cmpuint(gpiod_clock_converter_get_refresh_interval_ns(conv),
+			 ==, 0);
+}
+
+GPIOD_TEST_CASE(monotonic_to_realtime)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+	guint64 before, after, mono, converted, error;
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_MONOTONIC,
+					 GPIOD_LINE_CLOCK_REALTIME);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	error = gpiod_clock_converter_get_error_ns(conv);
+	/* Even a busy machine reads the clock faster than this. */
+	g_assert_cmpuint(error, <, 10000000);
+
+	before = read_clock(CLOCK_REALTIME);
+	mono = read_clock(CLOCK_MONOTONIC);
+	after = read_clock(CLOCK_REALTIME);
+
+	converted = gpiod_clock_converter_convert_one(conv, mono);
+	g_assert_cmpuint(converted + error, >=, before);
+	g_assert_cmpuint(converted, <=, after + error);
+}
+
+GPIOD_TEST_CASE(convert_batch_in_place)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+	guint64 timestamps[37], orig[37], offset;
+	gsize i;
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_REALTIME,
+					 GPIOD_LINE_CLOCK_MONOTONIC);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	gpiod_clock_converter_set_refresh_interval_ns(conv, 0);
+	/* Realtime is ahead of monotonic so the offset is negative. */
+	g_assert_cmpint(gpiod_clock_converter_get_offset_ns(conv), <, 0);
+	offset = gpiod_clock_converter_get_offset_ns(conv);
+
+	for (i = 0; i < G_N_ELEMENTS(timestamps); i++)
+		timestamps[i] = orig[i] = read_clock(CLOCK_REALTIME) + i;
+
+	gpiod_clock_converter_convert(conv, timestamps, timestamps,
+				      G_N_ELEMENTS(timestamps));
+
+	for (i = 0; i < G_N_ELEMENTS(timestamps); i++)
+		g_assert_cmpuint(timestamps[i], ==, orig[i] + offset);
+}
+
+GPIOD_TEST_CASE(calibrated_hte_to_monotonic)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+
+	conv = gpiod_clock_converter_new_calibrated(GPIOD_LINE_CLOCK_HTE,
+						    GPIOD_LINE_CLOCK_MONOTONIC);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_clock_converter_get_num_pairs(conv), ==, 0);
+	g_assert_cmpuint(gpiod_clock_converter_get_refresh_interval_ns(conv),
+			 ==, 0);
+	g_assert_cmpint(gpiod_clock_converter_get_offset_ns(conv), ==, 0);
+
+	/* The monotonic timestamps are late by 300, 100 and 250ns. */
+	g_assert_cmpint(gpiod_clock_converter_add_pair(conv, 1000, 6300), ==, 0);
+	g_assert_cmpint(gpiod_clock_converter_add_pair(conv, 2000, 7100), ==, 0);
+	g_assert_cmpint(gpiod_clock_converter_add_pair(conv, 3000, 8250), ==, 0);
+
+	g_assert_cmpuint(gpiod_clock_converter_get_num_pairs(conv), ==, 3);
+	g_assert_cmpint(gpiod_clock_converter_get_offset_ns(conv), ==, 5100);
+	g_assert_cmpuint(gpiod_clock_converter_get_error_ns(conv), ==, 200);
+
+	/* Refreshing can't read the timestamp engine and keeps the offset. */
+	gpiod_clock_converter_refresh(conv);
+	g_assert_cmpuint(gpiod_clock_converter_convert_one(conv, 4000), ==,
+			 9100);
+}
+
+GPIOD_TEST_CASE(calibrated_negative_offset)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+
+	conv = gpiod_clock_converter_new_calibrated(GPIOD_LINE_CLOCK_REALTIME,
+						    GPIOD_LINE_CLOCK_HTE);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_clock_converter_add_pair(conv, 5000, 1000), ==, 0);
+	g_assert_cmpint(gpiod_clock_converter_get_offset_ns(conv), ==, -4000);
+	g_assert_cmpuint(gpiod_clock_converter_convert_one(conv, 6000), ==,
+			 2000);
+}
+
+GPIOD_TEST_CASE(add_pair_needs_calibrated_converter)
+{
+	g_autoptr(struct_gpiod_clock_converter) conv = NULL;
+
+	conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_MONOTONIC,
+					 GPIOD_LINE_CLOCK_REALTIME);
+	g_assert_nonnull(conv);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_clock_converter_add_pair(conv, 0, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpuint(gpiod_clock_converter_get_num_pairs(conv), ==, 0);
+
+	g_assert_null(gpiod_clock_converter_new_calibrated(0,
+						GPIOD_LINE_CLOCK_HTE));
+	gpiod_test_expect_errno(EINVAL);
+}
@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "edge-event-pipeline"
+
+static struct gpiod_line_request *
+request_both_edges(struct gpiod_chip *chip, const guint *offsets,
+		   gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+static void toggle_line(GPIOSimChip *sim, guint offset)
+{
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+}
+
+struct stage_data {
+	guint num_calls;
+	gsize num_seen;
+	guint drop_offset;
+};
+
+static gsize drop_line_stage(struct gpiod_edge_event_record *records,
+			     gsize num_events, gpointer user_data)
+{
+	struct stage_data *data = user_data;
+	gsize i, num_kept;
+
+	data->num_calls++;
+	data->num_seen += num_events;
+
+	for (i = 0, num_kept = 0; i < num_events; i++) {
+		if (records[i].line_offset != data->drop_offset)
+			records[num_kept++] = records[i];
+	}
+
+	return num_kept;
+}
+
+GPIOD_TEST_CASE(invalid_arguments)
+{
+	g_autoptr(struct_gpiod_edge_event_pipeline) pipeline = NULL;
+
+	pipeline = gpiod_edge_event_pipeline_new();
+	g_assert_nonnull(pipeline);
+
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_stage(pipeline, NULL,
+							     NULL),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_edge_filter(pipeline, 0,
+								   0),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_pulse_decoder(pipeline,
+								     NULL),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_edge_event_pipeline_process(pipeline, NULL),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_stages(pipeline),
+			 ==, 0);
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_dropped(pipeline,
+								    0),
+			 ==, 0);
+}
+
+GPIOD_TEST_CASE(stages_are_applied_in_order)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_edge_event_pipeline) pipeline = NULL;
+	struct stage_data data = { .drop_offset = 5 };
+	const struct gpiod_edge_event_record *records;
+	const unsigned int *line_offsets;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	pipeline = gpiod_edge_event_pipeline_new();
+	g_assert_nonnull(pipeline);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_edge_filter(pipeline, 2,
+						GPIOD_LINE_EDGE_RISING),
+			==, 0);
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_stage(pipeline,
+						drop_line_stage, &data),
+			==, 0);
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_stages(pipeline),
+			 ==, 2);
+
+	toggle_line(sim, 2);
+	toggle_line(sim, 5);
+	toggle_line(sim, 2);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 6);
+	gpiod_test_return_if_failed();
+
+	/* Columns decoded before processing must not be reused. */
+	g_assert_nonnull(gpiod_edge_event_buffer_get_line_offsets(buffer));
+
+	ret = gpiod_edge_event_pipeline_process(pipeline, buffer);
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_events(buffer), ==, 2);
+	gpiod_test_return_if_failed();
+
+	/* The second stage only sees what the first one kept. */
+	g_assert_cmpuint(data.num_calls, ==, 1);
+	g_assert_cmpuint(data.num_seen, ==, 4);
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_dropped(pipeline,
+								    0),
+			 ==, 2);
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_dropped(pipeline,
+								    1),
+			 ==, 2);
+
+	records = gpiod_edge_event_buffer_get_records(buffer);
+	line_offsets = gpiod_edge_event_buffer_get_line_offsets(buffer);
+	g_assert_nonnull(line_offsets);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(records[0].line_offset, ==, 2);
+	g_assert_cmpuint(records[0].event_type, ==,
+			 GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(records[0].global_seqno, ==, 1);
+	g_assert_cmpuint(records[1].line_offset, ==, 2);
+	g_assert_cmpuint(records[1].event_type, ==,
+			 GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(records[1].global_seqno, ==, 5);
+	g_assert_cmpuint(line_offsets[0], ==, 2);
+	g_assert_cmpuint(line_offsets[1], ==, 2);
+}
+
+GPIOD_TEST_CASE(min_interval_is_carried_across_batches)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_edge_event_pipeline) pipeline = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, &offset, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	pipeline = gpiod_edge_event_pipeline_new();
+	g_assert_nonnull(pipeline);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_min_interval(pipeline,
+						offset, 1000000000),
+			==, 0);
+
+	toggle_line(sim, offset);
+	toggle_line(sim, offset);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 4);
+	ret = gpiod_edge_event_pipeline_process(pipeline, buffer);
+	g_assert_cmpint(ret, ==, 1);
+
+	toggle_line(sim, offset);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 2);
+	ret = gpiod_edge_event_pipeline_process(pipeline, buffer);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_dropped(pipeline,
+								    0),
+			 ==, 5);
+
+	gpiod_edge_event_pipeline_reset(pipeline);
+	g_assert_cmpuint(gpiod_edge_event_pipeline_get_num_dropped(pipeline,
+								    0),
+			 ==, 0);
+
+	toggle_line(sim, offset);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 2);
+	ret = gpiod_edge_event_pipeline_process(pipeline, buffer);
+	g_assert_cmpint(ret, ==, 1);
+}
+
+GPIOD_TEST_CASE(pulse_decoder_stage)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_edge_event_pipeline) pipeline = NULL;
+	g_autoptr(struct_gpiod_pulse_decoder) decoder = NULL;
+	guint num_bits;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, &offset, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	pipeline = gpiod_edge_event_pipeline_new();
+	decoder = gpiod_pulse_decoder_new_pulse_width(offset, 100000000);
+	g_assert_nonnull(pipeline);
+	g_assert_nonnull(decoder);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_edge_event_pipeline_add_pulse_decoder(pipeline,
+								     decoder),
+			==, 0);
+
+	toggle_line(sim, offset);
+	toggle_line(sim, offset);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 4);
+
+	/* The decoder doesn't consume the events. */
+	ret = gpiod_edge_event_pipeline_process(pipeline, buffer);
+	g_assert_cmpint(ret, ==, 4);
+
+	g_assert_cmpint(gpiod_pulse_decoder_flush(decoder, UINT64_MAX), ==, 1);
+	g_assert_cmpint(gpiod_pulse_decoder_read_frame(decoder, NULL,
+						       &num_bits, NULL, NULL),
+			==, 1);
+	g_assert_cmpuint(num_bits, ==, 2);
+}
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 
+#include <fcntl.h>
 #include <glib.h>
 #include <gpiod.h>
 #include <poll.h>
@@ -30,6 +31,92 @@ GPIOD_TEST_CASE(edge_event_buffer_max_capacity)
 			 ==, 16 * 64);
 }
 
+GPIOD_TEST_CASE(edge_event_buffer_default_capacity)
+{
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+
+	g_assert_cmpuint(gpiod_get_default_event_buffer_capacity(), ==, 64);
+	g_assert_cmpuint(gpiod_get_max_event_buffer_capacity(), ==, 16 * 64);
+
+	gpiod_set_default_event_buffer_capacity(16);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(0);
+	gpiod_set_default_event_buffer_capacity(0);
+
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), ==, 16);
+	g_assert_cmpuint(gpiod_get_default_event_buffer_capacity(), ==, 64);
+}
+
+GPIOD_TEST_CASE(adaptive_edge_event_buffer_grows_when_filled)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_set_default_event_buffer_capacity(2);
+	buffer = gpiod_edge_event_buffer_new_adaptive();
+	gpiod_set_default_event_buffer_capacity(0);
+	g_assert_nonnull(buffer);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), ==, 2);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(500);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer,
+			gpiod_edge_event_buffer_get_capacity(buffer));
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	/*
+	 * The buffer grows before the next read, which is still limited to
+	 * the capacity the caller saw.
+	 */
+	ret = gpiod_line_request_read_edge_events(request, buffer,
+			gpiod_edge_event_buffer_get_capacity(buffer));
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), ==, 4);
+
+	/* That read was full too, but partial ones don't grow it further. */
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 4);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), ==, 8);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 8);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), ==, 8);
+}
+
 GPIOD_TEST_CASE(edge_event_wait_timeout)
 {
 	static const guint offset = 4;
@@ -639,3 +726,732 @@ GPIOD_TEST_CASE(null_buffer)
 	g_assert_cmpint(ret, ==, -1);
 	gpiod_test_expect_errno(EINVAL);
 }
+
+GPIOD_TEST_CASE(dropped_events_are_accounted)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gsize dropped;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_request_config_set_event_buffer_size(req_cfg, 2);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	g_assert_cmpuint(gpiod_line_request_get_num_dropped_events(request), ==,
+			 0);
+
+	for (i = 0; i < 6; i++) {
+		g_gpiosim_chip_set_pull(sim, 2, i % 2 ? G_GPIOSIM_PULL_DOWN :
+							G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+	dropped = gpiod_edge_event_buffer_get_num_dropped(buffer);
+
+	/*
+	 * Depending on the kernel version, either the oldest or the newest
+	 * events are dropped on overflow. In the latter case, the gap only
+	 * becomes visible with the next event.
+	 */
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+	dropped += gpiod_edge_event_buffer_get_num_dropped(buffer);
+
+	g_assert_cmpuint(dropped, ==, 4);
+	g_assert_cmpuint(gpiod_line_request_get_num_dropped_events(request), ==,
+			 4);
+	g_assert_cmpint(gpiod_line_request_get_num_dropped_line_events(request,
+								       offset),
+			==, 4);
+
+	ret = gpiod_line_request_get_num_dropped_line_events(request, 5);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(event_buffer_grows_when_events_are_dropped)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret, i, fd;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_request_config_set_consumer(req_cfg, "adaptive");
+	gpiod_request_config_set_event_buffer_size(req_cfg, 2);
+	gpiod_request_config_set_max_event_buffer_size(req_cfg, 4);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+	fd = gpiod_line_request_get_fd(request);
+
+	g_assert_cmpuint(gpiod_line_request_get_event_buffer_size(request), ==,
+			 2);
+
+	for (i = 0; i < 3; i++) {
+		g_gpiosim_chip_set_pull(sim, 2, i % 2 ? G_GPIOSIM_PULL_DOWN :
+							G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_line_request_get_event_buffer_size(request), ==,
+			 4);
+	g_assert_cmpint(gpiod_line_request_get_fd(request), ==, fd);
+
+	/* Already at the limit - the buffer doesn't grow past it. */
+	for (i = 0; i < 4; i++) {
+		g_gpiosim_chip_set_pull(sim, 2, i % 2 ? G_GPIOSIM_PULL_UP :
+							G_GPIOSIM_PULL_DOWN);
+		g_usleep(500);
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 4);
+	g_assert_cmpuint(gpiod_line_request_get_event_buffer_size(request), ==,
+			 4);
+}
+
+GPIOD_TEST_CASE(drain_edge_events)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(2);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 0, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	for (i = 0; i < 7; i++) {
+		g_gpiosim_chip_set_pull(sim, 2, i % 2 ? G_GPIOSIM_PULL_DOWN :
+							G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+	}
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 5, 0);
+	g_assert_cmpint(ret, ==, 5);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_capacity(buffer), >=, 5);
+
+	ret = gpiod_line_request_drain_edge_events(request, buffer, 0, 0);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 1);
+	g_assert_cmpuint(gpiod_edge_event_get_global_seqno(event), ==, 7);
+
+	ret = gpiod_line_request_wait_edge_events(request, 1000);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(nonblocking_request_returns_no_events)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_request_config_set_nonblocking(req_cfg, true);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	g_assert_true(fcntl(gpiod_line_request_get_fd(request), F_GETFL) &
+		      O_NONBLOCK);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_events(buffer), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(busy_poll_wait)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	guint64 spun, slept;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_assert_cmpuint(gpiod_line_request_get_busy_poll(request), ==, 0);
+	gpiod_line_request_set_busy_poll(request, 1000000);
+	g_assert_cmpuint(gpiod_line_request_get_busy_poll(request), ==,
+			 1000000);
+
+	/* Spin for the whole budget, then sleep for the rest of the timeout. */
+	ret = gpiod_line_request_wait_edge_events(request, 5000000);
+	g_assert_cmpint(ret, ==, 0);
+
+	spun = gpiod_line_request_get_wait_spin_time_ns(request);
+	slept = gpiod_line_request_get_wait_sleep_time_ns(request);
+	g_assert_cmpuint(spun, >=, 1000000);
+	g_assert_cmpuint(slept, >, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(500);
+
+	/* The event is already pending - no sleeping needed. */
+	ret = gpiod_line_request_wait_edge_events(request, 5000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_line_request_get_wait_sleep_time_ns(request), ==,
+			 slept);
+}
+
+GPIOD_TEST_CASE(soft_debounce)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_soft_debounce_period_us(request, 5, 1000);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_line_request_get_soft_debounce_period_us(request,
+								       offset),
+			==, 0);
+	ret = gpiod_line_request_set_soft_debounce_period_us(request, offset,
+							     1000000);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(gpiod_line_request_get_soft_debounce_period_us(request,
+								       offset),
+			==, 1000000);
+
+	/* A glitch within the period is dropped entirely. */
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_wait_edge_events(request, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_events(buffer), ==, 0);
+
+	/* A bounce settling in the new state is reported as a single edge. */
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 1);
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_nonnull(event);
+	gpiod_test_return_if_failed();
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==, offset);
+
+	/* With the filter disabled all edges come through again. */
+	ret = gpiod_line_request_set_soft_debounce_period_us(request, offset, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 2);
+}
+
+GPIOD_TEST_CASE(edge_event_filter)
+{
+	static const guint offsets[] = { 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	guint offset = 7;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_edge_event_filter(request, &offset, 1,
+						       GPIOD_LINE_EDGE_RISING);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_line_request_get_edge_event_filter(request, 2),
+			==, GPIOD_LINE_EDGE_BOTH);
+
+	offset = 2;
+	ret = gpiod_line_request_set_edge_event_filter(request, &offset, 1,
+						       GPIOD_LINE_EDGE_RISING);
+	g_assert_cmpint(ret, ==, 0);
+	offset = 3;
+	ret = gpiod_line_request_set_edge_event_filter(request, &offset, 1,
+						       GPIOD_LINE_EDGE_NONE);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(gpiod_line_request_get_edge_event_filter(request, 2),
+			==, GPIOD_LINE_EDGE_RISING);
+	g_assert_cmpint(gpiod_line_request_get_edge_event_filter(request, 3),
+			==, GPIOD_LINE_EDGE_NONE);
+
+	g_gpiosim_chip_set_pull(sim, 3, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 1);
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_nonnull(event);
+	gpiod_test_return_if_failed();
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==, 2);
+	/* The discarded events don't count as dropped by the kernel. */
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_dropped(buffer), ==,
+			 0);
+
+	/* Resetting the filter for all lines lets every event through. */
+	ret = gpiod_line_request_set_edge_event_filter(request, NULL, 0,
+						       GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 3, G_GPIOSIM_PULL_DOWN);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 2);
+}
+
+static struct gpiod_line_request *
+request_rate_limited_lines(struct gpiod_chip *chip, const guint *offsets,
+			   gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	struct gpiod_line_request *request;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	request = gpiod_chip_request_lines(chip, NULL, line_cfg);
+	g_assert_nonnull(request);
+
+	return request;
+}
+
+GPIOD_TEST_CASE(rate_limit_keep_first)
+{
+	static const guint offsets[] = { 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	enum gpiod_rate_limit_policy policy;
+	struct gpiod_edge_event *event;
+	unsigned long window_us;
+	guint max_events, i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	request = request_rate_limited_lines(chip, offsets, 2);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_line_request_set_rate_limit(request, 7, 2, 1000000,
+						GPIOD_RATE_LIMIT_KEEP_FIRST);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_line_request_set_rate_limit(request, 2, 2, 0,
+						GPIOD_RATE_LIMIT_KEEP_FIRST);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* An hour long window spans the whole test. */
+	ret = gpiod_line_request_set_rate_limit(request, 2, 2, 3600000000UL,
+						GPIOD_RATE_LIMIT_KEEP_FIRST);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_line_request_get_rate_limit(request, 2, &max_events,
+						&window_us, &policy);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(max_events, ==, 2);
+	g_assert_cmpuint(window_us, ==, 3600000000UL);
+	g_assert_cmpint(policy, ==, GPIOD_RATE_LIMIT_KEEP_FIRST);
+
+	for (i = 0; i < 3; i++) {
+		g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+		g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	}
+	g_gpiosim_chip_set_pull(sim, 3, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	/* The other line isn't limited. */
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 3);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	event = gpiod_edge_event_buffer_get_event(buffer, 1);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_FALLING_EDGE);
+	event = gpiod_edge_event_buffer_get_event(buffer, 2);
+	g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==, 3);
+
+	g_assert_cmpint(gpiod_line_request_get_num_rate_limited_events(request,
+								       2),
+			==, 4);
+	g_assert_cmpint(gpiod_line_request_get_num_rate_limited_events(request,
+								       3),
+			==, 0);
+	g_assert_cmpint(gpiod_line_request_get_num_dropped_line_events(request,
+								       2),
+			==, 4);
+	g_assert_cmpuint(gpiod_line_request_get_num_dropped_events(request),
+			 ==, 4);
+
+	ret = gpiod_line_request_set_rate_limit(request, 2, 0, 0,
+						GPIOD_RATE_LIMIT_KEEP_FIRST);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 3);
+}
+
+GPIOD_TEST_CASE(rate_limit_keep_last)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	guint i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	request = request_rate_limited_lines(chip, &offset, 1);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_line_request_set_rate_limit(request, offset, 1,
+						3600000000UL,
+						GPIOD_RATE_LIMIT_KEEP_LAST);
+	g_assert_cmpint(ret, ==, 0);
+
+	for (i = 0; i < 2; i++) {
+		g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+		g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	}
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	/* Only the latest edge is left. */
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_seqno(event), ==, 5);
+	g_assert_cmpint(gpiod_line_request_get_num_rate_limited_events(request,
+								       offset),
+			==, 4);
+}
+
+GPIOD_TEST_CASE(buffer_columns)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	const enum gpiod_edge_event_type *types;
+	const unsigned int *line_offsets;
+	struct gpiod_edge_event *event;
+	const guint64 *timestamps;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 3);
+	gpiod_test_return_if_failed();
+
+	timestamps = gpiod_edge_event_buffer_get_timestamps_ns(buffer);
+	line_offsets = gpiod_edge_event_buffer_get_line_offsets(buffer);
+	types = gpiod_edge_event_buffer_get_event_types(buffer);
+	g_assert_nonnull(timestamps);
+	g_assert_nonnull(line_offsets);
+	g_assert_nonnull(types);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < ret; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		g_assert_nonnull(event);
+		gpiod_test_return_if_failed();
+
+		g_assert_cmpuint(timestamps[i], ==,
+				 gpiod_edge_event_get_timestamp_ns(event));
+		g_assert_cmpuint(line_offsets[i], ==,
+				 gpiod_edge_event_get_line_offset(event));
+		g_assert_cmpint(types[i], ==,
+				gpiod_edge_event_get_event_type(event));
+	}
+
+	g_assert_cmpuint(line_offsets[0], ==, 2);
+	g_assert_cmpuint(line_offsets[1], ==, 5);
+	g_assert_cmpint(types[2], ==, GPIOD_EDGE_EVENT_FALLING_EDGE);
+
+	/* The columns follow the buffer contents after the next read. */
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 1);
+
+	line_offsets = gpiod_edge_event_buffer_get_line_offsets(buffer);
+	types = gpiod_edge_event_buffer_get_event_types(buffer);
+	g_assert_nonnull(line_offsets);
+	g_assert_nonnull(types);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(line_offsets[0], ==, 5);
+	g_assert_cmpint(types[0], ==, GPIOD_EDGE_EVENT_FALLING_EDGE);
+}
+
+GPIOD_TEST_CASE(buffer_records)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	const struct gpiod_edge_event_record *records;
+	struct gpiod_edge_event *event;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 3);
+	gpiod_test_return_if_failed();
+
+	records = gpiod_edge_event_buffer_get_records(buffer);
+	g_assert_nonnull(records);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < ret; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		g_assert_nonnull(event);
+		gpiod_test_return_if_failed();
+
+		g_assert_cmpuint(records[i].timestamp_ns, ==,
+				 gpiod_edge_event_get_timestamp_ns(event));
+		g_assert_cmpint(records[i].event_type, ==,
+				gpiod_edge_event_get_event_type(event));
+		g_assert_cmpuint(records[i].line_offset, ==,
+				 gpiod_edge_event_get_line_offset(event));
+		g_assert_cmpuint(records[i].global_seqno, ==,
+				 gpiod_edge_event_get_global_seqno(event));
+		g_assert_cmpuint(records[i].line_seqno, ==,
+				 gpiod_edge_event_get_line_seqno(event));
+	}
+
+	g_assert_cmpuint(records[1].line_offset, ==, 5);
+	g_assert_cmpint(records[2].event_type, ==,
+			GPIOD_EDGE_EVENT_FALLING_EDGE);
+}
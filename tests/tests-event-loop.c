@@ -0,0 +1,713 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "event-loop"
+
+static struct gpiod_line_request *
+request_line_with_edges(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+struct edge_ctx {
+	guint num_calls;
+	guint num_events;
+	struct gpiod_line_request *last_request;
+	enum gpiod_edge_event_type last_type;
+	guint last_offset;
+};
+
+static int count_edge_events(struct gpiod_line_request *request,
+			     struct gpiod_edge_event_buffer *buffer,
+			     size_t num_events, void *user_data)
+{
+	struct gpiod_edge_event *event;
+	struct edge_ctx *ctx = user_data;
+
+	ctx->num_calls++;
+	ctx->num_events += num_events;
+	ctx->last_request = request;
+
+	event = gpiod_edge_event_buffer_get_event(buffer, num_events - 1);
+	ctx->last_type = gpiod_edge_event_get_event_type(event);
+	ctx->last_offset = gpiod_edge_event_get_line_offset(event);
+
+	return 0;
+}
+
+GPIOD_TEST_CASE(wait_timeout)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx ctx = { 0 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	loop = gpiod_test_create_event_loop_or_fail(0);
+
+	ret = gpiod_event_loop_add_request(loop, request, count_edge_events,
+					   &ctx);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_event_loop_get_num_sources(loop), ==, 1);
+
+	ret = gpiod_event_loop_wait(loop, 1000000);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(ctx.num_calls, ==, 0);
+}
+
+GPIOD_TEST_CASE(register_request_twice)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx ctx = { 0 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	loop = gpiod_test_create_event_loop_or_fail(0);
+
+	ret = gpiod_event_loop_add_request(loop, request, count_edge_events,
+					   &ctx);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_event_loop_add_request(loop, request, count_edge_events,
+					   &ctx);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EEXIST);
+
+	ret = gpiod_event_loop_remove_request(loop, request);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_event_loop_get_num_sources(loop), ==, 0);
+
+	ret = gpiod_event_loop_remove_request(loop, request);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ENOENT);
+}
+
+GPIOD_TEST_CASE(dispatch_edge_events_from_multiple_requests)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx first_ctx = { 0 }, second_ctx = { 0 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	first = request_line_with_edges(chip, 2);
+	second = request_line_with_edges(chip, 5);
+	g_assert_nonnull(first);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	loop = gpiod_test_create_event_loop_or_fail(16);
+
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, first,
+						     count_edge_events,
+						     &first_ctx), ==, 0);
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, second,
+						     count_edge_events,
+						     &second_ctx), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(first_ctx.num_calls, ==, 0);
+	g_assert_cmpuint(second_ctx.num_calls, ==, 1);
+	g_assert_true(second_ctx.last_request == second);
+	g_assert_cmpuint(second_ctx.last_offset, ==, 5);
+	g_assert_cmpint(second_ctx.last_type, ==, GPIOD_EDGE_EVENT_RISING_EDGE);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpuint(first_ctx.num_events, ==, 1);
+	g_assert_cmpuint(second_ctx.num_events, ==, 2);
+	g_assert_cmpint(second_ctx.last_type, ==,
+			GPIOD_EDGE_EVENT_FALLING_EDGE);
+}
+
+struct info_ctx {
+	guint num_calls;
+	guint num_events;
+	enum gpiod_info_event_type last_type;
+};
+
+static int count_info_events(struct gpiod_chip *chip G_GNUC_UNUSED,
+			     struct gpiod_info_event *event, void *user_data)
+{
+	struct info_ctx *ctx = user_data;
+
+	ctx->num_calls++;
+	ctx->last_type = gpiod_info_event_get_event_type(event);
+
+	return 0;
+}
+
+GPIOD_TEST_CASE(dispatch_info_events)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct info_ctx ctx = { 0 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	loop = gpiod_test_create_event_loop_or_fail(0);
+
+	info = gpiod_chip_watch_line_info(chip, 3);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_event_loop_add_chip(loop, chip, count_info_events, &ctx);
+	g_assert_cmpint(ret, ==, 0);
+
+	request = request_line_with_edges(chip, 3);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(ctx.num_calls, ==, 1);
+	g_assert_cmpint(ctx.last_type, ==, GPIOD_INFO_EVENT_LINE_REQUESTED);
+
+	ret = gpiod_event_loop_remove_chip(loop, chip);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+static int count_info_event_batches(struct gpiod_chip *chip G_GNUC_UNUSED,
+				    struct gpiod_info_event_buffer *buffer,
+				    size_t num_events, void *user_data)
+{
+	struct gpiod_info_event *event;
+	struct info_ctx *ctx = user_data;
+
+	ctx->num_calls++;
+	ctx->num_events += num_events;
+
+	event = gpiod_info_event_buffer_get_event(buffer, num_events - 1);
+	ctx->last_type = gpiod_info_event_get_event_type(event);
+
+	return 0;
+}
+
+GPIOD_TEST_CASE(dispatch_info_events_batched)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct info_ctx ctx = { 0 };
+	gint ret;
+	guint i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	loop = gpiod_test_create_event_loop_or_fail(0);
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	for (i = 0; i < G_N_ELEMENTS(offsets); i++) {
+		g_autoptr(struct_gpiod_line_info) info = NULL;
+
+		info = gpiod_chip_watch_line_info(chip, offsets[i]);
+		g_assert_nonnull(info);
+		gpiod_test_return_if_failed();
+	}
+
+	ret = gpiod_event_loop_add_chip_batched(loop, chip,
+						count_info_event_batches, &ctx);
+	g_assert_cmpint(ret, ==, 0);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets,
+							 G_N_ELEMENTS(offsets),
+							 settings);
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	/* All events were queued by the time the request returned. */
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(ctx.num_calls, ==, 1);
+	g_assert_cmpuint(ctx.num_events, ==, G_N_ELEMENTS(offsets));
+	g_assert_cmpint(ctx.last_type, ==, GPIOD_INFO_EVENT_LINE_REQUESTED);
+
+	/* Registering the same chip twice isn't allowed in either way. */
+	ret = gpiod_event_loop_add_chip(loop, chip, count_info_events, &ctx);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EEXIST);
+
+	ret = gpiod_event_loop_remove_chip(loop, chip);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+static int remove_self(struct gpiod_line_request *request,
+		       struct gpiod_edge_event_buffer *buffer G_GNUC_UNUSED,
+		       size_t num_events G_GNUC_UNUSED, void *user_data)
+{
+	struct gpiod_event_loop *loop = user_data;
+
+	g_assert_cmpint(gpiod_event_loop_remove_request(loop, request), ==, 0);
+
+	return 1;
+}
+
+GPIOD_TEST_CASE(remove_request_from_callback)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	loop = gpiod_test_create_event_loop_or_fail(0);
+
+	ret = gpiod_event_loop_add_request(loop, request, remove_self, loop);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_event_loop_get_num_sources(loop), ==, 0);
+}
+
+GPIOD_TEST_CASE(backend_selection)
+{
+	g_autoptr(struct_gpiod_event_loop) epoll_loop = NULL;
+	g_autoptr(struct_gpiod_event_loop) auto_loop = NULL;
+	enum gpiod_event_loop_backend backend;
+
+	epoll_loop = gpiod_event_loop_new_with_backend(0,
+					GPIOD_EVENT_LOOP_BACKEND_EPOLL);
+	g_assert_nonnull(epoll_loop);
+	gpiod_test_return_if_failed();
+	g_assert_cmpint(gpiod_event_loop_get_backend(epoll_loop), ==,
+			GPIOD_EVENT_LOOP_BACKEND_EPOLL);
+
+	auto_loop = gpiod_event_loop_new_with_backend(0,
+					GPIOD_EVENT_LOOP_BACKEND_AUTO);
+	g_assert_nonnull(auto_loop);
+	gpiod_test_return_if_failed();
+
+	backend = gpiod_event_loop_get_backend(auto_loop);
+	g_assert_true(backend == GPIOD_EVENT_LOOP_BACKEND_EPOLL ||
+		      backend == GPIOD_EVENT_LOOP_BACKEND_IO_URING);
+
+	g_assert_null(gpiod_event_loop_new_with_backend(0, 0));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(io_uring_dispatch_edge_and_info_events)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx first_ctx = { 0 }, second_ctx = { 0 };
+	struct info_ctx info_ctx = { 0 };
+	gint ret, i;
+
+	loop = gpiod_event_loop_new_with_backend(16,
+					GPIOD_EVENT_LOOP_BACKEND_IO_URING);
+	if (!loop && errno == ENOTSUP) {
+		g_test_skip("io_uring not supported");
+		return;
+	}
+
+	g_assert_nonnull(loop);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	info = gpiod_chip_watch_line_info(chip, 5);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_loop_add_chip(loop, chip,
+						  count_info_events,
+						  &info_ctx), ==, 0);
+
+	first = request_line_with_edges(chip, 2);
+	second = request_line_with_edges(chip, 5);
+	g_assert_nonnull(first);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, first,
+						     count_edge_events,
+						     &first_ctx), ==, 0);
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, second,
+						     count_edge_events,
+						     &second_ctx), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_DOWN);
+
+	/* Reads may complete in separate batches. */
+	for (i = 0; i < 10; i++) {
+		if (first_ctx.num_events == 1 && second_ctx.num_events == 2 &&
+		    info_ctx.num_calls == 1)
+			break;
+
+		ret = gpiod_event_loop_wait(loop, 1000000000);
+		g_assert_cmpint(ret, >, 0);
+		gpiod_test_return_if_failed();
+	}
+
+	g_assert_cmpuint(first_ctx.num_events, ==, 1);
+	g_assert_cmpuint(second_ctx.num_events, ==, 2);
+	g_assert_cmpint(second_ctx.last_type, ==,
+			GPIOD_EDGE_EVENT_FALLING_EDGE);
+	g_assert_cmpuint(info_ctx.num_calls, ==, 1);
+	g_assert_cmpint(info_ctx.last_type, ==,
+			GPIOD_INFO_EVENT_LINE_REQUESTED);
+
+	g_assert_cmpint(gpiod_event_loop_remove_request(loop, first), ==, 0);
+	g_assert_cmpint(gpiod_event_loop_remove_request(loop, second), ==, 0);
+	g_assert_cmpint(gpiod_event_loop_remove_chip(loop, chip), ==, 0);
+}
+
+static int fail_first_call(struct gpiod_line_request *request,
+			   struct gpiod_edge_event_buffer *buffer,
+			   size_t num_events, void *user_data)
+{
+	struct edge_ctx *ctx = user_data;
+
+	count_edge_events(request, buffer, num_events, user_data);
+
+	if (ctx->num_calls == 1) {
+		errno = EIO;
+		return -1;
+	}
+
+	return 0;
+}
+
+GPIOD_TEST_CASE(io_uring_failed_callback_keeps_request_armed)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx ctx = { 0 };
+	gint ret;
+
+	loop = gpiod_event_loop_new_with_backend(0,
+					GPIOD_EVENT_LOOP_BACKEND_IO_URING);
+	if (!loop && errno == ENOTSUP) {
+		g_test_skip("io_uring not supported");
+		return;
+	}
+
+	g_assert_nonnull(loop);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, request,
+						     fail_first_call, &ctx),
+			==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EIO);
+	g_assert_cmpuint(ctx.num_calls, ==, 1);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(ctx.num_calls, ==, 2);
+	g_assert_cmpint(ctx.last_type, ==, GPIOD_EDGE_EVENT_FALLING_EDGE);
+}
+
+static struct gpiod_line_request *
+request_output_line(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_line_settings_set_output_value(settings,
+					     GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(add_reflex_with_invalid_arguments)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx ctx = { 0 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	input = request_line_with_edges(chip, 2);
+	output = request_output_line(chip, 6);
+	g_assert_nonnull(input);
+	g_assert_nonnull(output);
+	gpiod_test_return_if_failed();
+
+	loop = gpiod_test_create_event_loop_or_fail(0);
+
+	ret = gpiod_event_loop_add_reflex(loop, input, 2,
+					  GPIOD_LINE_EDGE_FALLING, output,
+					  0x1, 0x0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ENOENT);
+
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, input,
+						     count_edge_events, &ctx),
+			==, 0);
+
+	ret = gpiod_event_loop_add_reflex(loop, input, 3,
+					  GPIOD_LINE_EDGE_FALLING, output,
+					  0x1, 0x0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_event_loop_add_reflex(loop, input, 2, GPIOD_LINE_EDGE_NONE,
+					  output, 0x1, 0x0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_event_loop_add_reflex(loop, input, 2,
+					  GPIOD_LINE_EDGE_FALLING, output,
+					  0x2, 0x0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_event_loop_add_reflex(loop, input, 2,
+					  GPIOD_LINE_EDGE_FALLING, output,
+					  0x1, 0x0);
+	g_assert_cmpint(ret, >=, 0);
+
+	g_assert_cmpint(gpiod_event_loop_remove_reflex(loop, ret), ==, 0);
+	g_assert_cmpint(gpiod_event_loop_remove_reflex(loop, ret), ==, -1);
+	gpiod_test_expect_errno(ENOENT);
+}
+
+GPIOD_TEST_CASE(reflex_sets_output_on_edge)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	g_autoptr(struct_gpiod_latency_histogram) hist = NULL;
+	struct edge_ctx ctx = { 0 };
+	gint ret, id;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	input = request_line_with_edges(chip, 2);
+	output = request_output_line(chip, 6);
+	g_assert_nonnull(input);
+	g_assert_nonnull(output);
+	gpiod_test_return_if_failed();
+
+	loop = gpiod_test_create_event_loop_or_fail(0);
+
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, input,
+						     count_edge_events, &ctx),
+			==, 0);
+
+	id = gpiod_event_loop_add_reflex(loop, input, 2,
+					 GPIOD_LINE_EDGE_FALLING, output,
+					 0x1, 0x0);
+	g_assert_cmpint(id, >=, 0);
+	gpiod_test_return_if_failed();
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(ctx.num_events, ==, 2);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	hist = gpiod_event_loop_get_reflex_latency_histogram(loop, id);
+	g_assert_nonnull(hist);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_latency_histogram_get_num_samples(hist), ==, 1);
+
+	g_assert_cmpint(gpiod_event_loop_remove_request(loop, input), ==, 0);
+	g_assert_null(gpiod_event_loop_get_reflex_latency_histogram(loop, id));
+	gpiod_test_expect_errno(ENOENT);
+}
+
+static void reconfigure_direction(struct gpiod_line_request *request,
+				  guint offset,
+				  enum gpiod_line_direction direction)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, direction);
+	gpiod_line_settings_set_output_value(settings,
+					     GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+	g_assert_cmpint(gpiod_line_request_reconfigure_lines(request,
+							     line_cfg),
+			==, 0);
+}
+
+static void
+test_failed_reflex_write_keeps_input_armed(enum gpiod_event_loop_backend backend)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_event_loop) loop = NULL;
+	struct edge_ctx ctx = { 0 };
+	gint ret;
+
+	loop = gpiod_event_loop_new_with_backend(0, backend);
+	if (!loop && errno == ENOTSUP) {
+		g_test_skip("backend not supported");
+		return;
+	}
+
+	g_assert_nonnull(loop);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	input = request_line_with_edges(chip, 2);
+	output = request_output_line(chip, 6);
+	g_assert_nonnull(input);
+	g_assert_nonnull(output);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_event_loop_add_request(loop, input,
+						     count_edge_events, &ctx),
+			==, 0);
+	g_assert_cmpint(gpiod_event_loop_add_reflex(loop, input, 2,
+						    GPIOD_LINE_EDGE_RISING,
+						    output, 0x1, 0x0),
+			>=, 0);
+
+	/* The kernel rejects writes to inputs - make the reflex fail. */
+	reconfigure_direction(output, 6, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_return_if_failed();
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EPERM);
+	/* The callback still sees the edge. */
+	g_assert_cmpuint(ctx.num_calls, ==, 1);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(ctx.num_calls, ==, 2);
+
+	reconfigure_direction(output, 6, GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_return_if_failed();
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_event_loop_wait(loop, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(ctx.num_calls, ==, 3);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(failed_reflex_write_keeps_input_armed)
+{
+	test_failed_reflex_write_keeps_input_armed(
+					GPIOD_EVENT_LOOP_BACKEND_EPOLL);
+}
+
+GPIOD_TEST_CASE(io_uring_failed_reflex_write_keeps_input_armed)
+{
+	test_failed_reflex_write_keeps_input_armed(
+					GPIOD_EVENT_LOOP_BACKEND_IO_URING);
+}
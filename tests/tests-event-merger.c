@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "event-merger"
+
+/* 50 milliseconds */
+#define WINDOW_NS 50000000
+
+static struct gpiod_line_request *
+request_line_with_edges(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(add_request_twice)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	merger = gpiod_test_create_event_merger_or_fail(WINDOW_NS);
+
+	ret = gpiod_event_merger_add_request(merger, request);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_event_merger_add_request(merger, request);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EEXIST);
+
+	ret = gpiod_event_merger_remove_request(merger, request);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_event_merger_remove_request(merger, request);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ENOENT);
+}
+
+GPIOD_TEST_CASE(events_are_held_back_for_the_window)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	merger = gpiod_test_create_event_merger_or_fail(WINDOW_NS);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, request), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_event_merger_read_edge_events(merger, buffer, 16);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_event_merger_get_num_staged_events(merger), ==,
+			 1);
+
+	ret = gpiod_event_merger_wait_edge_events(merger, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_event_merger_read_edge_events(merger, buffer, 16);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_event_merger_get_num_staged_events(merger), ==,
+			 0);
+	g_assert_true(gpiod_event_merger_get_event_request(merger, 0) ==
+		      request);
+}
+
+GPIOD_TEST_CASE(events_from_multiple_chips_are_ordered)
+{
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	guint64 prev_ts = 0, ts;
+	gint ret, i;
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	first = request_line_with_edges(chip0, 2);
+	second = request_line_with_edges(chip1, 5);
+	g_assert_nonnull(first);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	merger = gpiod_test_create_event_merger_or_fail(WINDOW_NS);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	/*
+	 * Add the second request first so that its events are staged first -
+	 * the order of registration must not influence the result.
+	 */
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, second), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, first), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim0, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim1, 5, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim0, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim1, 5, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_event_merger_wait_edge_events(merger, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_usleep(WINDOW_NS / 1000);
+
+	ret = gpiod_event_merger_read_edge_events(merger, buffer, 16);
+	g_assert_cmpint(ret, ==, 4);
+
+	for (i = 0; i < 4; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		ts = gpiod_edge_event_get_timestamp_ns(event);
+		g_assert_cmpuint(ts, >=, prev_ts);
+		prev_ts = ts;
+
+		g_assert_true(gpiod_event_merger_get_event_request(merger, i) ==
+			      (i % 2 ? second : first));
+		g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==,
+				 i % 2 ? 5 : 2);
+	}
+
+	g_assert_cmpuint(gpiod_event_merger_get_num_late_events(merger), ==, 0);
+}
+
+GPIOD_TEST_CASE(flush_returns_events_inside_the_window)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	/* One second - long enough to never elapse during the test. */
+	merger = gpiod_test_create_event_merger_or_fail(1000000000);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, request), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+	g_usleep(1000);
+
+	ret = gpiod_event_merger_wait_edge_events(merger, 10000000);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_event_merger_flush_edge_events(merger, buffer, 16);
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(
+				gpiod_edge_event_buffer_get_event(buffer, 0)),
+			==, GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(
+				gpiod_edge_event_buffer_get_event(buffer, 1)),
+			==, GPIOD_EDGE_EVENT_FALLING_EDGE);
+}
+
+GPIOD_TEST_CASE(removing_request_discards_its_events)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	g_autoptr(struct_gpiod_event_merger) merger = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	first = request_line_with_edges(chip, 2);
+	second = request_line_with_edges(chip, 5);
+	g_assert_nonnull(first);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	merger = gpiod_test_create_event_merger_or_fail(1000000000);
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, first), ==, 0);
+	g_assert_cmpint(gpiod_event_merger_add_request(merger, second), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 5, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	ret = gpiod_event_merger_read_edge_events(merger, buffer, 16);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_event_merger_get_num_staged_events(merger), ==,
+			 2);
+
+	g_assert_cmpint(gpiod_event_merger_remove_request(merger, first), ==,
+			0);
+	g_assert_cmpuint(gpiod_event_merger_get_num_staged_events(merger), ==,
+			 1);
+
+	ret = gpiod_event_merger_flush_edge_events(merger, buffer, 16);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_true(gpiod_event_merger_get_event_request(merger, 0) ==
+		      second);
+	g_assert_null(gpiod_event_merger_get_event_request(merger, 1));
+	gpiod_test_expect_errno(EINVAL);
+}
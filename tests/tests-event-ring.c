@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "event-ring"
+
+static gchar *ring_path(void)
+{
+	return g_strdup_printf("/tmp/gpiod-test-ring.%u", getpid());
+}
+
+static struct gpiod_line_request *
+request_line_with_edges(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+/* Toggles the line and publishes the resulting events one by one. */
+static void toggle_and_publish(GPIOSimChip *sim, guint offset,
+			       struct gpiod_line_request *request,
+			       struct gpiod_event_ring *ring, guint num_toggles)
+{
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	guint i;
+	gint ret;
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(4);
+
+	for (i = 0; i < num_toggles; i++) {
+		g_gpiosim_chip_set_pull(sim, offset,
+					i % 2 ? G_GPIOSIM_PULL_DOWN :
+						G_GPIOSIM_PULL_UP);
+
+		ret = gpiod_event_ring_publish_request(ring, request, buffer,
+						       1);
+		g_assert_cmpint(ret, ==, 1);
+		gpiod_test_return_if_failed();
+	}
+}
+
+GPIOD_TEST_CASE(publish_and_read)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_ring) ring = NULL;
+	g_autoptr(struct_gpiod_event_ring_reader) reader = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autofree gchar *path = ring_path();
+	struct gpiod_edge_event *event;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 3);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ring = gpiod_event_ring_create(path, 16);
+	g_assert_nonnull(ring);
+	gpiod_test_return_if_failed();
+
+	reader = gpiod_event_ring_reader_open(path);
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	ret = gpiod_event_ring_reader_read(reader, buffer, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	toggle_and_publish(sim, 3, request, ring, 2);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_event_ring_reader_get_num_pending(reader), ==, 2);
+
+	ret = gpiod_event_ring_reader_read(reader, buffer, 0);
+	g_assert_cmpint(ret, ==, 2);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_dropped(buffer), ==, 0);
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_RISING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==, 3);
+	g_assert_cmpuint(gpiod_edge_event_get_line_seqno(event), ==, 1);
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 1);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+			GPIOD_EDGE_EVENT_FALLING_EDGE);
+	g_assert_cmpuint(gpiod_edge_event_get_line_seqno(event), ==, 2);
+
+	g_assert_cmpuint(gpiod_event_ring_reader_get_num_pending(reader), ==, 0);
+}
+
+GPIOD_TEST_CASE(readers_have_separate_cursors)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_ring) ring = NULL;
+	g_autoptr(struct_gpiod_event_ring_reader) first = NULL;
+	g_autoptr(struct_gpiod_event_ring_reader) second = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autofree gchar *path = ring_path();
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 0);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ring = gpiod_event_ring_create(path, 16);
+	g_assert_nonnull(ring);
+	gpiod_test_return_if_failed();
+
+	first = gpiod_event_ring_reader_open(path);
+	g_assert_nonnull(first);
+	gpiod_test_return_if_failed();
+
+	toggle_and_publish(sim, 0, request, ring, 1);
+	gpiod_test_return_if_failed();
+
+	/* A reader only sees the events published after it subscribed. */
+	second = gpiod_event_ring_reader_open(path);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	toggle_and_publish(sim, 0, request, ring, 1);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	g_assert_cmpint(gpiod_event_ring_reader_read(first, buffer, 0), ==, 2);
+	g_assert_cmpint(gpiod_event_ring_reader_read(second, buffer, 0), ==, 1);
+	g_assert_cmpint(gpiod_edge_event_get_event_type(
+				gpiod_edge_event_buffer_get_event(buffer, 0)),
+			==, GPIOD_EDGE_EVENT_FALLING_EDGE);
+}
+
+GPIOD_TEST_CASE(overrun)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_event_ring) ring = NULL;
+	g_autoptr(struct_gpiod_event_ring_reader) reader = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autofree gchar *path = ring_path();
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 0);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	/* Rounded up to 4. */
+	ring = gpiod_event_ring_create(path, 3);
+	g_assert_nonnull(ring);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_event_ring_get_capacity(ring), ==, 4);
+
+	reader = gpiod_event_ring_reader_open(path);
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	toggle_and_publish(sim, 0, request, ring, 6);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	ret = gpiod_event_ring_reader_read(reader, buffer, 0);
+	g_assert_cmpint(ret, ==, 4);
+	g_assert_cmpuint(gpiod_edge_event_buffer_get_num_dropped(buffer), ==, 2);
+	g_assert_cmpuint(gpiod_edge_event_get_line_seqno(
+				gpiod_edge_event_buffer_get_event(buffer, 0)),
+			 ==, 3);
+	g_assert_cmpuint(gpiod_event_ring_reader_get_num_overruns(reader), ==,
+			 2);
+}
+
+GPIOD_TEST_CASE(closed_by_producer)
+{
+	g_autoptr(struct_gpiod_event_ring_reader) reader = NULL;
+	g_autofree gchar *path = ring_path();
+	struct gpiod_event_ring *ring;
+
+	ring = gpiod_event_ring_create(path, 0);
+	g_assert_nonnull(ring);
+	gpiod_test_return_if_failed();
+
+	reader = gpiod_event_ring_reader_open(path);
+	g_assert_nonnull(reader);
+	gpiod_test_return_if_failed();
+
+	g_assert_false(gpiod_event_ring_reader_is_closed(reader));
+	gpiod_event_ring_free(ring);
+	g_assert_true(gpiod_event_ring_reader_is_closed(reader));
+
+	g_assert_null(gpiod_event_ring_reader_open(path));
+	gpiod_test_expect_errno(ENOENT);
+}
+
+GPIOD_TEST_CASE(open_invalid_ring)
+{
+	g_autofree gchar *path = ring_path();
+	FILE *fp;
+
+	fp = fopen(path, "w");
+	g_assert_nonnull(fp);
+	gpiod_test_return_if_failed();
+
+	fprintf(fp, "this is not an event ring, just some random text\n");
+	fclose(fp);
+
+	g_assert_null(gpiod_event_ring_reader_open(path));
+	gpiod_test_expect_errno(EINVAL);
+
+	unlink(path);
+}
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "info-event-coalescer"
+
+static struct gpiod_line_request *
+request_line(struct gpiod_chip *chip, guint offset,
+	     enum gpiod_line_direction direction)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	struct gpiod_line_request *request;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, direction);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	request = gpiod_chip_request_lines(chip, NULL, line_cfg);
+	g_assert_nonnull(request);
+
+	return request;
+}
+
+static void watch_line_or_fail(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+
+	info = gpiod_chip_watch_line_info(chip, offset);
+	g_assert_nonnull(info);
+}
+
+GPIOD_TEST_CASE(burst_is_merged_into_net_change)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_info_event_coalescer) coalescer = NULL;
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_info_event *event;
+	guint offset = 3;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	coalescer = gpiod_test_create_info_event_coalescer_or_fail(
+							chip, 1000000000);
+	buffer = gpiod_test_create_info_event_buffer_or_fail(8);
+
+	watch_line_or_fail(chip, offset);
+	gpiod_test_return_if_failed();
+
+	request = request_line(chip, offset, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_return_if_failed();
+
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+	gpiod_test_reconfigure_lines_or_fail(request, line_cfg);
+
+	/* The window hasn't elapsed yet. */
+	ret = gpiod_info_event_coalescer_read_info_events(coalescer, buffer, 8);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_info_event_coalescer_flush_info_events(coalescer, buffer,
+							   8);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_info_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_info_event_get_event_type(event), ==,
+			GPIOD_INFO_EVENT_LINE_REQUESTED);
+	g_assert_cmpint(gpiod_line_info_get_direction(
+				gpiod_info_event_get_line_info(event)),
+			==, GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpuint(gpiod_info_event_coalescer_get_num_merged(coalescer,
+								   0),
+			 ==, 2);
+	g_assert_cmpuint(gpiod_info_event_coalescer_get_num_merged(coalescer,
+								   1),
+			 ==, 0);
+}
+
+GPIOD_TEST_CASE(rerequest_is_reported_as_reconfigured)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_info_event_coalescer) coalescer = NULL;
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_info_event *event;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	coalescer = gpiod_test_create_info_event_coalescer_or_fail(
+							chip, 1000000000);
+	buffer = gpiod_test_create_info_event_buffer_or_fail(8);
+
+	watch_line_or_fail(chip, 2);
+	gpiod_test_return_if_failed();
+
+	request = request_line(chip, 2, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_info_event_coalescer_flush_info_events(coalescer, buffer,
+							   8);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_info_event_coalescer_get_num_merged(coalescer,
+								   0),
+			 ==, 1);
+
+	gpiod_line_request_release(request);
+	request = request_line(chip, 2, GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_info_event_coalescer_flush_info_events(coalescer, buffer,
+							   8);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_info_event_buffer_get_event(buffer, 0);
+	g_assert_cmpint(gpiod_info_event_get_event_type(event), ==,
+			GPIOD_INFO_EVENT_LINE_CONFIG_CHANGED);
+	g_assert_true(gpiod_line_info_is_used(
+				gpiod_info_event_get_line_info(event)));
+	g_assert_cmpuint(gpiod_info_event_coalescer_get_num_merged(coalescer,
+								   0),
+			 ==, 2);
+}
+
+GPIOD_TEST_CASE(request_and_release_is_suppressed)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_info_event_coalescer) coalescer = NULL;
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+	struct gpiod_line_request *request;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	coalescer = gpiod_test_create_info_event_coalescer_or_fail(
+							chip, 1000000000);
+	buffer = gpiod_test_create_info_event_buffer_or_fail(8);
+
+	watch_line_or_fail(chip, 5);
+	gpiod_test_return_if_failed();
+
+	request = request_line(chip, 5, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_return_if_failed();
+	gpiod_line_request_release(request);
+
+	ret = gpiod_info_event_coalescer_flush_info_events(coalescer, buffer,
+							   8);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_info_event_coalescer_get_num_suppressed(
+								coalescer),
+			 ==, 2);
+}
+
+GPIOD_TEST_CASE(lines_are_returned_in_order_of_first_event)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_info_event_coalescer) coalescer = NULL;
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	struct gpiod_info_event *event;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	coalescer = gpiod_test_create_info_event_coalescer_or_fail(
+							chip, 1000000000);
+	buffer = gpiod_test_create_info_event_buffer_or_fail(8);
+
+	watch_line_or_fail(chip, 6);
+	watch_line_or_fail(chip, 1);
+	gpiod_test_return_if_failed();
+
+	first = request_line(chip, 6, GPIOD_LINE_DIRECTION_INPUT);
+	second = request_line(chip, 1, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_info_event_coalescer_flush_info_events(coalescer, buffer,
+							   8);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_info_event_buffer_get_event(buffer, 0);
+	g_assert_cmpuint(gpiod_line_info_get_offset(
+				gpiod_info_event_get_line_info(event)),
+			 ==, 6);
+	event = gpiod_info_event_buffer_get_event(buffer, 1);
+	g_assert_cmpuint(gpiod_line_info_get_offset(
+				gpiod_info_event_get_line_info(event)),
+			 ==, 1);
+}
+
+GPIOD_TEST_CASE(wait_for_window_to_elapse)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_info_event_coalescer) coalescer = NULL;
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	coalescer = gpiod_test_create_info_event_coalescer_or_fail(chip,
+								   50000000);
+	buffer = gpiod_test_create_info_event_buffer_or_fail(8);
+
+	watch_line_or_fail(chip, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_info_event_coalescer_wait_info_events(coalescer, 10000000);
+	g_assert_cmpint(ret, ==, 0);
+
+	request = request_line(chip, 0, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_info_event_coalescer_wait_info_events(coalescer,
+							  1000000000);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_info_event_coalescer_read_info_events(coalescer, buffer, 8);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpint(gpiod_info_event_get_event_type(
+				gpiod_info_event_buffer_get_event(buffer, 0)),
+			==, GPIOD_INFO_EVENT_LINE_REQUESTED);
+}
@@ -302,3 +302,187 @@ GPIOD_TEST_CASE(unwatch_and_check_that_no_events_are_generated)
 	ret = gpiod_chip_wait_info_event(chip, 100000000);
 	g_assert_cmpint(ret, ==, 0);
 }
+
+GPIOD_TEST_CASE(info_event_buffer_capacity)
+{
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+
+	buffer = gpiod_test_create_info_event_buffer_or_fail(0);
+	g_assert_cmpuint(gpiod_info_event_buffer_get_capacity(buffer), ==, 32);
+	gpiod_info_event_buffer_free(buffer);
+
+	buffer = gpiod_test_create_info_event_buffer_or_fail(4);
+	g_assert_cmpuint(gpiod_info_event_buffer_get_capacity(buffer), ==, 4);
+	gpiod_info_event_buffer_free(buffer);
+
+	buffer = gpiod_test_create_info_event_buffer_or_fail(1024);
+	g_assert_cmpuint(gpiod_info_event_buffer_get_capacity(buffer), ==, 32);
+	g_assert_cmpuint(gpiod_info_event_buffer_get_num_events(buffer), ==, 0);
+	g_assert_null(gpiod_info_event_buffer_get_event(buffer, 0));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(read_multiple_info_events_into_buffer)
+{
+	static const guint offsets[] = { 1, 3, 4, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_info_event_buffer) buffer = NULL;
+	struct gpiod_line_info *info;
+	struct gpiod_info_event *event;
+	guint i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_info_event_buffer_or_fail(8);
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 4,
+							 NULL);
+
+	for (i = 0; i < G_N_ELEMENTS(offsets); i++) {
+		info = gpiod_chip_watch_line_info(chip, offsets[i]);
+		g_assert_nonnull(info);
+		gpiod_test_return_if_failed();
+		gpiod_line_info_free(info);
+	}
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_chip_wait_info_event(chip, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_chip_read_info_events(chip, buffer, 8);
+	g_assert_cmpint(ret, ==, 4);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_info_event_buffer_get_num_events(buffer), ==, 4);
+
+	for (i = 0; i < G_N_ELEMENTS(offsets); i++) {
+		event = gpiod_info_event_buffer_get_event(buffer, i);
+		g_assert_nonnull(event);
+		gpiod_test_return_if_failed();
+
+		g_assert_cmpint(gpiod_info_event_get_event_type(event), ==,
+				GPIOD_INFO_EVENT_LINE_REQUESTED);
+
+		info = gpiod_info_event_get_line_info(event);
+		g_assert_cmpuint(gpiod_line_info_get_offset(info), ==,
+				 offsets[i]);
+		g_assert_true(gpiod_line_info_is_used(info));
+	}
+
+	gpiod_line_request_release(request);
+	request = NULL;
+
+	ret = gpiod_chip_wait_info_event(chip, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_chip_read_info_events(chip, buffer, 2);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_info_event_buffer_get_event(buffer, 1);
+	g_assert_nonnull(event);
+	gpiod_test_return_if_failed();
+	g_assert_cmpint(gpiod_info_event_get_event_type(event), ==,
+			GPIOD_INFO_EVENT_LINE_RELEASED);
+	g_assert_false(
+		gpiod_line_info_is_used(gpiod_info_event_get_line_info(event)));
+	g_assert_null(gpiod_info_event_buffer_get_event(buffer, 2));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(watch_multiple_lines_at_once)
+{
+	static const guint offsets[] = { 6, 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_line_info *infos[3];
+	guint i;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	ret = gpiod_chip_watch_line_infos(chip, offsets, 3, infos);
+	g_assert_cmpint(ret, ==, 3);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < 3; i++) {
+		g_assert_cmpuint(gpiod_line_info_get_offset(infos[i]), ==,
+				 offsets[i]);
+		gpiod_line_info_free(infos[i]);
+	}
+
+	/* Already watched. */
+	ret = gpiod_chip_watch_line_infos(chip, offsets, 1, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+
+	ret = gpiod_chip_unwatch_line_infos(chip, offsets, 3);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(watch_all_lines)
+{
+	static const guint offset = 4;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 NULL);
+
+	/* No line-info objects are allocated if the caller passes NULL. */
+	ret = gpiod_chip_watch_line_infos(chip, NULL, 0, NULL);
+	g_assert_cmpint(ret, ==, 8);
+	gpiod_test_return_if_failed();
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_chip_wait_info_event(chip, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	gpiod_line_request_release(request);
+	request = NULL;
+
+	ret = gpiod_chip_unwatch_line_infos(chip, NULL, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	/* Unwatching all lines again is not an error. */
+	ret = gpiod_chip_unwatch_line_infos(chip, NULL, 0);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(watch_multiple_lines_is_all_or_nothing)
+{
+	static const guint offsets[] = { 1, 2, 9 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	struct gpiod_line_info *infos[3];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	ret = gpiod_chip_watch_line_infos(chip, offsets, 3, infos);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* Lines 1 and 2 must have been unwatched again. */
+	info = gpiod_chip_watch_line_info(chip, 2);
+	g_assert_nonnull(info);
+}
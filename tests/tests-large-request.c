@@ -0,0 +1,335 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "large-request"
+
+#define NUM_LINES 200
+
+static struct gpiod_large_request *
+request_all_lines(struct gpiod_chip *chip, struct gpiod_line_settings *settings)
+{
+	struct gpiod_line_settings *line_settings[NUM_LINES];
+	unsigned int offsets[NUM_LINES];
+	guint i;
+
+	for (i = 0; i < NUM_LINES; i++) {
+		offsets[i] = i;
+		line_settings[i] = settings;
+	}
+
+	return gpiod_chip_request_large(chip, NULL, offsets, NUM_LINES,
+					line_settings);
+}
+
+GPIOD_TEST_CASE(request_is_split_into_shards)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	unsigned int offsets[NUM_LINES];
+	gsize num_offsets;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	request = request_all_lines(chip, NULL);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_large_request_get_num_requested_lines(request),
+			 ==, NUM_LINES);
+	g_assert_cmpuint(gpiod_large_request_get_num_shards(request), ==, 4);
+
+	num_offsets = gpiod_large_request_get_requested_offsets(request, offsets,
+								NUM_LINES);
+	g_assert_cmpuint(num_offsets, ==, NUM_LINES);
+	g_assert_cmpuint(offsets[0], ==, 0);
+	g_assert_cmpuint(offsets[NUM_LINES - 1], ==, NUM_LINES - 1);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 150);
+	g_assert_true(gpiod_line_info_is_used(info));
+}
+
+GPIOD_TEST_CASE(duplicate_offsets)
+{
+	static const guint offsets[] = { 0, 100, 2, 100 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	request = gpiod_chip_request_large(chip, NULL, offsets, 4, NULL);
+	g_assert_null(request);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(set_and_get_values_across_shards)
+{
+	static const guint offsets[] = { 199, 3, 64, 130 };
+	static const enum gpiod_line_value set[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+	enum gpiod_line_value values[NUM_LINES];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+
+	request = request_all_lines(chip, settings);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_large_request_set_values_subset(request, 4, offsets, set);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 199), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 64), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 130), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 131), ==, 0);
+
+	ret = gpiod_large_request_set_value(request, 3,
+					    GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==, 1);
+
+	ret = gpiod_large_request_get_values(request, values);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(values[3], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(values[64], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(values[65], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[199], ==, GPIOD_LINE_VALUE_ACTIVE);
+
+	g_assert_cmpint(gpiod_large_request_get_value(request, 130), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(gpiod_large_request_get_value(request, NUM_LINES), ==,
+			GPIOD_LINE_VALUE_ERROR);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(edge_events_are_merged_in_order)
+{
+	static const guint toggled[] = { 150, 10, 70, 199 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	struct gpiod_edge_event *event;
+	guint64 prev_ts = 0;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(2);
+
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_RISING);
+
+	request = request_all_lines(chip, settings);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_large_request_wait_edge_events(request, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	for (i = 0; i < 4; i++) {
+		g_gpiosim_chip_set_pull(sim, toggled[i], G_GPIOSIM_PULL_UP);
+		g_usleep(1000);
+	}
+
+	ret = gpiod_large_request_wait_edge_events(request, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < 4; i++) {
+		/* Half of the events stay queued in the request each time. */
+		if (i % 2 == 0) {
+			ret = gpiod_large_request_read_edge_events(request,
+								   buffer, 2);
+			g_assert_cmpint(ret, ==, 2);
+			gpiod_test_return_if_failed();
+		}
+
+		event = gpiod_edge_event_buffer_get_event(buffer, i % 2);
+		g_assert_cmpuint(gpiod_edge_event_get_line_offset(event), ==,
+				 toggled[i]);
+		g_assert_cmpuint(gpiod_edge_event_get_global_seqno(event), ==,
+				 i + 1);
+		g_assert_cmpuint(gpiod_edge_event_get_timestamp_ns(event), >,
+				 prev_ts);
+		prev_ts = gpiod_edge_event_get_timestamp_ns(event);
+	}
+
+	ret = gpiod_large_request_wait_edge_events(request, 0);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(add_lines_to_live_request)
+{
+	static const guint first[] = { 0, 1, 2 };
+	static const guint added[] = { 150, 151 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	unsigned int offsets[5];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+
+	request = gpiod_chip_request_large(chip, NULL, first, 3, NULL);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_large_request_set_value(request, 1,
+					    GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_large_request_add_lines(request, chip, NULL, added, 2,
+					    NULL);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_large_request_get_num_requested_lines(request),
+			 ==, 5);
+	g_assert_cmpuint(gpiod_large_request_get_num_shards(request), ==, 2);
+	gpiod_large_request_get_requested_offsets(request, offsets, 5);
+	g_assert_cmpuint(offsets[3], ==, 150);
+	g_assert_cmpuint(offsets[4], ==, 151);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 151);
+	g_assert_true(gpiod_line_info_is_used(info));
+
+	/* Lines already in the request are left alone. */
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==, 1);
+
+	ret = gpiod_large_request_add_lines(request, chip, NULL, &first[2], 1,
+					    NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpuint(gpiod_large_request_get_num_requested_lines(request),
+			 ==, 5);
+}
+
+GPIOD_TEST_CASE(remove_lines_from_live_request)
+{
+	static const guint removed[] = { 64, 2 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	unsigned int offsets[NUM_LINES];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+
+	request = request_all_lines(chip, settings);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_large_request_set_value(request, 5,
+					    GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_large_request_remove_lines(request, chip, removed, 2);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_large_request_get_num_requested_lines(request),
+			 ==, NUM_LINES - 2);
+	gpiod_large_request_get_requested_offsets(request, offsets, NUM_LINES);
+	g_assert_cmpuint(offsets[2], ==, 3);
+	g_assert_cmpuint(offsets[63], ==, 65);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 2);
+	g_assert_false(gpiod_line_info_is_used(info));
+
+	/* The line re-requested with the rest of its shard kept its value. */
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 5), ==, 1);
+	g_assert_cmpint(gpiod_large_request_get_value(request, 5), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_large_request_set_value(request, 65,
+					    GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 65), ==, 1);
+
+	g_assert_cmpint(gpiod_large_request_get_value(request, 2), ==,
+			GPIOD_LINE_VALUE_ERROR);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(remove_added_lines_releases_their_shard)
+{
+	static const guint first[] = { 0, 1 };
+	static const guint added[] = { 10, 11 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", NUM_LINES,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_large_request) request = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	request = gpiod_chip_request_large(chip, NULL, first, 2, NULL);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_large_request_add_lines(request, chip, NULL, added, 2,
+					    NULL);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_large_request_get_num_shards(request), ==, 2);
+
+	ret = gpiod_large_request_remove_lines(request, chip, added, 2);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_large_request_get_num_shards(request), ==, 1);
+	g_assert_cmpuint(gpiod_large_request_get_num_requested_lines(request),
+			 ==, 2);
+
+	ret = gpiod_large_request_remove_lines(request, chip, first, 2);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
@@ -347,3 +347,152 @@ GPIOD_TEST_CASE(read_back_global_output_values)
 	g_assert_cmpint(gpiod_line_settings_get_output_value(retrieved), ==,
 			GPIOD_LINE_VALUE_INACTIVE);
 }
+
+GPIOD_TEST_CASE(modifying_config_after_use_takes_effect)
+{
+	static const guint offsets[] = { 0, 1 };
+	static const enum gpiod_line_value first[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+	};
+	static const enum gpiod_line_value second[] = {
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) config = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	config = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(config, offsets, 2,
+							 settings);
+	gpiod_test_line_config_set_output_values_or_fail(config, first, 2);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, config);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	/* The translated config is reused until the config is modified. */
+	gpiod_test_reconfigure_lines_or_fail(request, config);
+	gpiod_test_line_config_set_output_values_or_fail(config, second, 2);
+	gpiod_test_reconfigure_lines_or_fail(request, config);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(config, offsets, 2,
+							 settings);
+	gpiod_test_reconfigure_lines_or_fail(request, config);
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(reconfigure_offset_in_full_config)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_settings) retrieved = NULL;
+	g_autoptr(struct_gpiod_line_config) config = NULL;
+	guint offsets[64], i;
+
+	settings = gpiod_test_create_line_settings_or_fail();
+	config = gpiod_test_create_line_config_or_fail();
+
+	for (i = 0; i < 64; i++)
+		offsets[i] = i * 3;
+
+	gpiod_test_line_config_add_line_settings_or_fail(config, offsets, 64,
+							 settings);
+
+	/* Updating lines that are already configured must not hit the limit. */
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(config, &offsets[10],
+							 1, settings);
+	g_assert_cmpuint(gpiod_line_config_get_num_configured_offsets(config),
+			 ==, 64);
+
+	retrieved = gpiod_test_line_config_get_line_settings_or_fail(config,
+								     30);
+	g_assert_cmpint(gpiod_line_settings_get_direction(retrieved), ==,
+			GPIOD_LINE_DIRECTION_OUTPUT);
+
+	offsets[0] = 1000;
+	g_assert_cmpint(gpiod_line_config_add_line_settings(config, offsets, 1,
+							    settings),
+			==, -1);
+	gpiod_test_expect_errno(E2BIG);
+	g_assert_cmpuint(gpiod_line_config_get_num_configured_offsets(config),
+			 ==, 64);
+}
+
+#define BENCHMARK_ITERATIONS 10000
+
+GPIOD_TEST_CASE(build_64_line_configs_benchmark)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	struct gpiod_line_config *config;
+	guint offset, i, j;
+	gdouble elapsed;
+	gint ret;
+
+	if (!g_test_perf()) {
+		g_test_skip("benchmark - run with '-m perf' to enable");
+		return;
+	}
+
+	settings = gpiod_test_create_line_settings_or_fail();
+
+	g_test_timer_start();
+
+	for (i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		config = gpiod_line_config_new();
+		g_assert_nonnull(config);
+		gpiod_test_return_if_failed();
+
+		/* Every line gets distinct settings, added one at a time. */
+		for (j = 0; j < 64; j++) {
+			offset = j;
+
+			gpiod_line_settings_set_direction(settings,
+					j % 2 ? GPIOD_LINE_DIRECTION_OUTPUT :
+						GPIOD_LINE_DIRECTION_INPUT);
+			gpiod_line_settings_set_output_value(settings, j % 3 ?
+					GPIOD_LINE_VALUE_ACTIVE :
+					GPIOD_LINE_VALUE_INACTIVE);
+			gpiod_line_settings_set_debounce_period_us(settings, j);
+
+			ret = gpiod_line_config_add_line_settings(config,
+								  &offset, 1,
+								  settings);
+			g_assert_cmpint(ret, ==, 0);
+		}
+
+		g_assert_cmpuint(
+			gpiod_line_config_get_num_configured_offsets(config),
+			==, 64);
+		gpiod_line_config_free(config);
+		gpiod_test_return_if_failed();
+	}
+
+	elapsed = g_test_timer_elapsed();
+
+	g_test_minimized_result(elapsed * 1000000 / BENCHMARK_ITERATIONS,
+				"building a 64-line config: %.2f us",
+				elapsed * 1000000 / BENCHMARK_ITERATIONS);
+}
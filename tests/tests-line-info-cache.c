@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "line-info-cache"
+
+GPIOD_TEST_CASE(cache_loads_all_lines)
+{
+	static const struct gpiod_test_line_name names[] = {
+		{ .offset = 2, .name = "foo", },
+		{ .offset = 5, .name = "bar", },
+		{ }
+	};
+
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info_cache) cache = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	g_autoptr(GVariant) vnames = gpiod_test_package_line_names(names);
+
+	sim = g_gpiosim_chip_new("num-lines", 8, "line-names", vnames, NULL);
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	cache = gpiod_test_create_line_info_cache_or_fail(chip);
+
+	g_assert_cmpuint(gpiod_line_info_cache_get_num_lines(cache), ==, 8);
+	g_assert_cmpint(gpiod_line_info_cache_get_fd(cache), ==,
+			gpiod_chip_get_fd(chip));
+
+	info = gpiod_line_info_cache_get_line_info(cache, 5);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_line_info_get_offset(info), ==, 5);
+	g_assert_cmpstr(gpiod_line_info_get_name(info), ==, "bar");
+	g_assert_false(gpiod_line_info_is_used(info));
+}
+
+GPIOD_TEST_CASE(offset_out_of_range)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info_cache) cache = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	cache = gpiod_test_create_line_info_cache_or_fail(chip);
+
+	info = gpiod_line_info_cache_get_line_info(cache, 4);
+	g_assert_null(info);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(cache_fails_if_line_already_watched)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	struct gpiod_line_info_cache *cache;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	info = gpiod_chip_watch_line_info(chip, 2);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+
+	cache = gpiod_line_info_cache_new(chip);
+	g_assert_null(cache);
+	gpiod_test_expect_errno(EBUSY);
+}
+
+GPIOD_TEST_CASE(update_tracks_requests_and_bumps_generation)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info_cache) cache = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) before = NULL;
+	g_autoptr(struct_gpiod_line_info) after = NULL;
+	g_autoptr(struct_gpiod_line_info) released = NULL;
+	guint64 generation;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	cache = gpiod_test_create_line_info_cache_or_fail(chip);
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	generation = gpiod_line_info_cache_get_generation(cache);
+
+	ret = gpiod_line_info_cache_update(cache);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_line_info_cache_get_generation(cache), ==,
+			 generation);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	before = gpiod_line_info_cache_get_line_info(cache, offset);
+	g_assert_nonnull(before);
+	gpiod_test_return_if_failed();
+	g_assert_false(gpiod_line_info_is_used(before));
+
+	ret = gpiod_chip_wait_info_event(chip, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_line_info_cache_update(cache);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_line_info_cache_get_generation(cache), !=,
+			 generation);
+
+	after = gpiod_line_info_cache_get_line_info(cache, offset);
+	g_assert_nonnull(after);
+	gpiod_test_return_if_failed();
+	g_assert_true(gpiod_line_info_is_used(after));
+	g_assert_cmpint(gpiod_line_info_get_direction(after), ==,
+			GPIOD_LINE_DIRECTION_OUTPUT);
+
+	gpiod_line_request_release(request);
+	request = NULL;
+	generation = gpiod_line_info_cache_get_generation(cache);
+
+	ret = gpiod_chip_wait_info_event(chip, 1000000000);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_line_info_cache_update(cache);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_line_info_cache_get_generation(cache), !=,
+			 generation);
+
+	released = gpiod_line_info_cache_get_line_info(cache, offset);
+	g_assert_nonnull(released);
+	gpiod_test_return_if_failed();
+	g_assert_false(gpiod_line_info_is_used(released));
+}
+
+GPIOD_TEST_CASE(reload_resynchronizes_cache)
+{
+	static const guint offset = 1;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info_cache) cache = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	guint64 generation;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	cache = gpiod_test_create_line_info_cache_or_fail(chip);
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 NULL);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+	generation = gpiod_line_info_cache_get_generation(cache);
+
+	ret = gpiod_line_info_cache_reload(cache);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_line_info_cache_get_generation(cache), !=,
+			 generation);
+
+	info = gpiod_line_info_cache_get_line_info(cache, offset);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+	g_assert_true(gpiod_line_info_is_used(info));
+}
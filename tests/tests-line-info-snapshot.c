@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "line-info-snapshot"
+
+GPIOD_TEST_CASE(snapshot_holds_all_lines)
+{
+	static const struct gpiod_test_line_name names[] = {
+		{ .offset = 1, .name = "foo", },
+		{ .offset = 4, .name = "bar", },
+		{ }
+	};
+
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info_snapshot) snapshot = NULL;
+	g_autoptr(GVariant) vnames = gpiod_test_package_line_names(names);
+	struct gpiod_line_info *info;
+
+	sim = g_gpiosim_chip_new("num-lines", 8, "line-names", vnames, NULL);
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	snapshot = gpiod_test_create_line_info_snapshot_or_fail(chip);
+
+	g_assert_cmpuint(gpiod_line_info_snapshot_get_num_lines(snapshot), ==,
+			 8);
+	g_assert_cmpuint(gpiod_line_info_snapshot_get_size(snapshot), >, 0);
+
+	info = gpiod_line_info_snapshot_get_line_info(snapshot, 4);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_line_info_get_offset(info), ==, 4);
+	g_assert_cmpstr(gpiod_line_info_get_name(info), ==, "bar");
+	g_assert_false(gpiod_line_info_is_used(info));
+	g_assert_null(gpiod_line_info_get_consumer(info));
+
+	info = gpiod_line_info_snapshot_get_line_info(snapshot, 0);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+	g_assert_null(gpiod_line_info_get_name(info));
+
+	g_assert_null(gpiod_line_info_snapshot_get_line_info(snapshot, 8));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(snapshot_reflects_requested_lines)
+{
+	static const guint offsets[] = { 2, 5 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info_snapshot) snapshot = NULL;
+	struct gpiod_line_info *first, *second;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_line_settings_set_drive(settings, GPIOD_LINE_DRIVE_OPEN_DRAIN);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+	gpiod_request_config_set_consumer(req_cfg, "foobar");
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+	snapshot = gpiod_test_create_line_info_snapshot_or_fail(chip);
+
+	first = gpiod_line_info_snapshot_get_line_info(snapshot, 2);
+	second = gpiod_line_info_snapshot_get_line_info(snapshot, 5);
+	g_assert_nonnull(first);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	g_assert_true(gpiod_line_info_is_used(first));
+	g_assert_cmpstr(gpiod_line_info_get_consumer(first), ==, "foobar");
+	g_assert_cmpint(gpiod_line_info_get_direction(first), ==,
+			GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_info_get_drive(first), ==,
+			GPIOD_LINE_DRIVE_OPEN_DRAIN);
+
+	/* Identical strings are stored once. */
+	g_assert_true(gpiod_line_info_get_consumer(first) ==
+		      gpiod_line_info_get_consumer(second));
+
+	g_assert_false(gpiod_line_info_is_used(
+			gpiod_line_info_snapshot_get_line_info(snapshot, 3)));
+}
+
+GPIOD_TEST_CASE(copy_outlives_snapshot)
+{
+	static const struct gpiod_test_line_name names[] = {
+		{ .offset = 3, .name = "baz", },
+		{ }
+	};
+
+	g_autoptr(GPIOSimChip) sim = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) copy = NULL;
+	g_autoptr(GVariant) vnames = gpiod_test_package_line_names(names);
+	struct gpiod_line_info_snapshot *snapshot;
+
+	sim = g_gpiosim_chip_new("num-lines", 4, "line-names", vnames, NULL);
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	snapshot = gpiod_test_create_line_info_snapshot_or_fail(chip);
+
+	copy = gpiod_line_info_copy(
+			gpiod_line_info_snapshot_get_line_info(snapshot, 3));
+	gpiod_line_info_snapshot_free(snapshot);
+	g_assert_nonnull(copy);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_line_info_get_offset(copy), ==, 3);
+	g_assert_cmpstr(gpiod_line_info_get_name(copy), ==, "baz");
+}
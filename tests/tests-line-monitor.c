@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "line-monitor"
+
+#define SAMPLE_PERIOD_NS	5000000
+#define BUSY_OFFSET		3
+#define IDLE_OFFSET		5
+
+static const guint offsets[] = { BUSY_OFFSET, IDLE_OFFSET };
+
+static struct gpiod_line_monitor *request_monitor(struct gpiod_chip *chip)
+{
+	return gpiod_chip_request_line_monitor(chip, NULL, NULL, offsets,
+					       G_N_ELEMENTS(offsets),
+					       SAMPLE_PERIOD_NS, 256);
+}
+
+/* Process the monitor until the line reaches the mode or a second passed. */
+static gint wait_for_mode(struct gpiod_line_monitor *monitor, guint offset,
+			  enum gpiod_line_monitor_mode mode)
+{
+	gint64 deadline = g_get_monotonic_time() + 1000000;
+	gint mode_now;
+
+	for (;;) {
+		mode_now = gpiod_line_monitor_get_mode(monitor, offset);
+		if (mode_now == (gint)mode ||
+		    g_get_monotonic_time() > deadline)
+			return mode_now;
+
+		g_assert_cmpint(gpiod_line_monitor_wait(monitor,
+							SAMPLE_PERIOD_NS),
+				>=, 0);
+		g_assert_cmpint(gpiod_line_monitor_process(monitor), >=, 0);
+	}
+}
+
+GPIOD_TEST_CASE(request_with_invalid_arguments)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_line_monitor *monitor;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	monitor = gpiod_chip_request_line_monitor(chip, NULL, NULL, NULL, 1,
+						  SAMPLE_PERIOD_NS, 16);
+	g_assert_null(monitor);
+	gpiod_test_expect_errno(EINVAL);
+
+	monitor = gpiod_chip_request_line_monitor(chip, NULL, NULL, offsets, 0,
+						  SAMPLE_PERIOD_NS, 16);
+	g_assert_null(monitor);
+	gpiod_test_expect_errno(EINVAL);
+
+	monitor = gpiod_chip_request_line_monitor(chip, NULL, NULL, offsets, 2,
+						  0, 16);
+	g_assert_null(monitor);
+	gpiod_test_expect_errno(EINVAL);
+
+	monitor = gpiod_chip_request_line_monitor(chip, NULL, NULL, offsets, 2,
+						  SAMPLE_PERIOD_NS, 0);
+	g_assert_null(monitor);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(idle_lines_use_edge_events)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_monitor) monitor = NULL;
+	struct gpiod_line_monitor_change changes[4];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	monitor = request_monitor(chip);
+	g_assert_nonnull(monitor);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_monitor_get_mode(monitor, BUSY_OFFSET), ==,
+			GPIOD_LINE_MONITOR_MODE_EVENTS);
+	g_assert_cmpint(gpiod_line_monitor_get_mode(monitor, IDLE_OFFSET), ==,
+			GPIOD_LINE_MONITOR_MODE_EVENTS);
+	g_assert_cmpint(gpiod_line_monitor_get_mode(monitor, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* Nothing is pending while the lines are idle. */
+	g_assert_cmpint(gpiod_line_monitor_wait(monitor, 0), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, IDLE_OFFSET, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_line_monitor_wait(monitor, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_line_monitor_process(monitor);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(gpiod_line_monitor_get_num_changes(monitor), ==, 1);
+
+	g_assert_cmpuint(gpiod_line_monitor_read_changes(monitor, changes,
+							 G_N_ELEMENTS(changes)),
+			 ==, 1);
+	g_assert_cmpuint(changes[0].offset, ==, IDLE_OFFSET);
+	g_assert_cmpuint(changes[0].value, ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpuint(changes[0].mode, ==, GPIOD_LINE_MONITOR_MODE_EVENTS);
+	g_assert_cmpuint(changes[0].timestamp_ns, >, 0);
+	g_assert_cmpuint(gpiod_line_monitor_get_num_switches(monitor), ==, 0);
+}
+
+GPIOD_TEST_CASE(busy_line_is_sampled_until_it_settles)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_monitor) monitor = NULL;
+	struct gpiod_line_monitor_change change;
+	gboolean sampled = FALSE;
+	guint i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	monitor = request_monitor(chip);
+	g_assert_nonnull(monitor);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < 20; i++) {
+		g_gpiosim_chip_set_pull(sim, BUSY_OFFSET, G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+		g_gpiosim_chip_set_pull(sim, BUSY_OFFSET, G_GPIOSIM_PULL_DOWN);
+		g_usleep(500);
+	}
+
+	g_assert_cmpint(wait_for_mode(monitor, BUSY_OFFSET,
+				      GPIOD_LINE_MONITOR_MODE_SAMPLING),
+			==, GPIOD_LINE_MONITOR_MODE_SAMPLING);
+	g_assert_cmpint(gpiod_line_monitor_get_mode(monitor, IDLE_OFFSET), ==,
+			GPIOD_LINE_MONITOR_MODE_EVENTS);
+	g_assert_cmpuint(gpiod_line_monitor_get_num_switches(monitor), ==, 1);
+
+	while (gpiod_line_monitor_read_changes(monitor, &change, 1))
+		;
+
+	/* Changes of the sampled line are picked up by the reads. */
+	g_gpiosim_chip_set_pull(sim, BUSY_OFFSET, G_GPIOSIM_PULL_UP);
+
+	for (i = 0; i < 100 && !sampled; i++) {
+		g_assert_cmpint(gpiod_line_monitor_wait(monitor,
+							SAMPLE_PERIOD_NS),
+				>=, 0);
+		g_assert_cmpint(gpiod_line_monitor_process(monitor), >=, 0);
+
+		while (gpiod_line_monitor_read_changes(monitor, &change, 1)) {
+			g_assert_cmpuint(change.offset, ==, BUSY_OFFSET);
+			g_assert_cmpuint(change.value, ==,
+					 GPIOD_LINE_VALUE_ACTIVE);
+			g_assert_cmpuint(change.mode, ==,
+					 GPIOD_LINE_MONITOR_MODE_SAMPLING);
+			sampled = TRUE;
+		}
+	}
+
+	g_assert_true(sampled);
+
+	/* Once the line settles it goes back to edge events. */
+	g_assert_cmpint(wait_for_mode(monitor, BUSY_OFFSET,
+				      GPIOD_LINE_MONITOR_MODE_EVENTS),
+			==, GPIOD_LINE_MONITOR_MODE_EVENTS);
+	g_assert_cmpuint(gpiod_line_monitor_get_num_switches(monitor), ==, 2);
+
+	g_gpiosim_chip_set_pull(sim, BUSY_OFFSET, G_GPIOSIM_PULL_DOWN);
+
+	g_assert_cmpint(gpiod_line_monitor_wait(monitor, 1000000000), ==, 1);
+	g_assert_cmpint(gpiod_line_monitor_process(monitor), ==, 1);
+	g_assert_cmpuint(gpiod_line_monitor_read_changes(monitor, &change, 1),
+			 ==, 1);
+	g_assert_cmpuint(change.value, ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpuint(change.mode, ==, GPIOD_LINE_MONITOR_MODE_EVENTS);
+}
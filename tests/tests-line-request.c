@@ -507,6 +507,104 @@ GPIOD_TEST_CASE(reconfigure_lines)
 	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==, 1);
 }
 
+GPIOD_TEST_CASE(reconfigure_lines_partial)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	guint offset;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 4,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_values_mask(request, 0x0f, 0x0b);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	gpiod_line_config_reset(line_cfg);
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_PULL_UP);
+	offset = 1;
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	ret = gpiod_line_request_reconfigure_lines_partial(request, line_cfg);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	info = gpiod_test_get_line_info_or_fail(chip, 1);
+	g_assert_cmpint(gpiod_line_info_get_direction(info), ==,
+			GPIOD_LINE_DIRECTION_INPUT);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==, 1);
+
+	/* The lines that were not reconfigured keep driving their values. */
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==, 1);
+	gpiod_line_info_free(info);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 3);
+	g_assert_cmpint(gpiod_line_info_get_direction(info), ==,
+			GPIOD_LINE_DIRECTION_OUTPUT);
+}
+
+GPIOD_TEST_CASE(reconfigure_lines_partial_with_unrequested_line)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	guint reconf_offsets[] = { 1, 3 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 NULL);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	gpiod_line_config_reset(line_cfg);
+
+	ret = gpiod_line_request_reconfigure_lines_partial(request, line_cfg);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg,
+							 reconf_offsets, 2,
+							 settings);
+
+	ret = gpiod_line_request_reconfigure_lines_partial(request, line_cfg);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 1);
+	g_assert_cmpint(gpiod_line_info_get_direction(info), ==,
+			GPIOD_LINE_DIRECTION_INPUT);
+}
+
 GPIOD_TEST_CASE(request_lines_with_unordered_offsets)
 {
 	static const guint offsets[] = { 5, 1, 7, 2, 0, 6 };
@@ -619,3 +717,1154 @@ GPIOD_TEST_CASE(get_requested_offsets_less_and_more)
 	g_assert_cmpuint(retrieved[2], ==, 2);
 	g_assert_cmpuint(retrieved[3], ==, 3);
 }
+
+GPIOD_TEST_CASE(get_values_subset_with_sparse_offsets)
+{
+	/* Offsets sharing the low bits - make sure they don't get mixed up. */
+	static const guint offsets[] = { 384, 0, 256, 129, 128, 1 };
+	static const guint subset[] = { 1, 256, 384 };
+	static const gint pulls[] = { 1, 0, 1, 1, 0, 0 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 512,
+							NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	enum gpiod_line_value values[3];
+	gint ret;
+	guint i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 6,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	for (i = 0; i < 6; i++)
+		g_gpiosim_chip_set_pull(sim, offsets[i],
+					pulls[i] ? G_GPIOSIM_PULL_UP :
+						   G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_line_request_get_values_subset(request, 3, subset, values);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(values[0], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[1], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[2], ==, GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_line_request_get_value(request, 2);
+	g_assert_cmpint(ret, ==, GPIOD_LINE_VALUE_ERROR);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(offsets_to_mask)
+{
+	static const guint offsets[] = { 5, 1, 7, 2 };
+	static const guint subset[] = { 7, 5 };
+	static const guint bad_subset[] = { 7, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	guint64 mask;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 4,
+							 NULL);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	g_assert_cmpint(gpiod_line_request_get_offset_bit(request, 7), ==, 2);
+	g_assert_cmpint(gpiod_line_request_get_offset_bit(request, 5), ==, 0);
+	g_assert_cmpint(gpiod_line_request_get_offset_bit(request, 3), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_line_request_offsets_to_mask(request, 2, subset, &mask);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmphex(mask, ==, 0x5);
+
+	ret = gpiod_line_request_offsets_to_mask(request, 2, bad_subset, &mask);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(get_values_mask)
+{
+	static const guint offsets[] = { 0, 2, 4, 5, 7 };
+	static const gint pulls[] = { 0, 1, 0, 1, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	guint64 values;
+	gint ret;
+	guint i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 5,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	for (i = 0; i < 5; i++)
+		g_gpiosim_chip_set_pull(sim, offsets[i],
+					pulls[i] ? G_GPIOSIM_PULL_UP :
+						   G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_line_request_get_values_mask(request, 0x1f, &values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmphex(values, ==, 0x1a);
+
+	ret = gpiod_line_request_get_values_mask(request, 0x0c, &values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmphex(values, ==, 0x08);
+
+	ret = gpiod_line_request_get_values_mask(request, 0x20, &values);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(set_values_mask)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 4,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	/* Bit 1 is set in values but not in mask - must be ignored. */
+	ret = gpiod_line_request_set_values_mask(request, 0x0d, 0x0b);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_line_request_set_values_mask(request, 0x10, 0x10);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(prepared_subset_get_and_set_values)
+{
+	static const guint offsets[] = { 0, 1, 2, 3, 4, 5 };
+	static const guint subset_offsets[] = { 5, 0, 3 };
+	static const enum gpiod_line_value set_vals[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_subset) subset = NULL;
+	enum gpiod_line_value values[3];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_line_settings_set_output_value(settings,
+					     GPIOD_LINE_VALUE_INACTIVE);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 6,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	subset = gpiod_line_request_prepare_subset(request, 3, subset_offsets);
+	g_assert_nonnull(subset);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_line_subset_get_num_lines(subset), ==, 3);
+	g_assert_cmphex(gpiod_line_subset_get_mask(subset), ==, 0x29);
+
+	ret = gpiod_line_subset_set_values(subset, set_vals);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 5), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_line_subset_get_values(subset, values);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(values[0], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(values[1], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[2], ==, GPIOD_LINE_VALUE_ACTIVE);
+}
+
+GPIOD_TEST_CASE(prepare_subset_with_invalid_offset)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+	static const guint subset_offsets[] = { 1, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_subset) subset = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 4,
+							 NULL);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	subset = gpiod_line_request_prepare_subset(request, 2, subset_offsets);
+	g_assert_null(subset);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(output_shadow_with_mixed_directions)
+{
+	static const guint in_offsets[] = { 0, 2 };
+	static const guint out_offsets[] = { 1, 3 };
+	static const enum gpiod_line_value set_vals[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	enum gpiod_line_value values[4];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_request_config_set_output_shadow(req_cfg, true);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, in_offsets,
+							 2, settings);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, out_offsets,
+							 2, settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_line_request_get_values(request, values);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(values[0], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[1], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[2], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(values[3], ==, GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_line_request_set_values_subset(request, 2, out_offsets,
+						   set_vals);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	/* Writing the same values again must succeed without side effects. */
+	ret = gpiod_line_request_set_values_subset(request, 2, out_offsets,
+						   set_vals);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_line_request_get_values(request, values);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(values[0], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[1], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(values[2], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(values[3], ==, GPIOD_LINE_VALUE_ACTIVE);
+
+	/* Writing to inputs must still be rejected by the kernel. */
+	ret = gpiod_line_request_set_value(request, 0,
+					   GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EPERM);
+}
+
+GPIOD_TEST_CASE(output_shadow_is_reset_on_reconfigure)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_request_config_set_output_shadow(req_cfg, true);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	gpiod_line_settings_set_output_value(settings,
+					     GPIOD_LINE_VALUE_ACTIVE);
+	gpiod_line_config_reset(line_cfg);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	gpiod_test_reconfigure_lines_or_fail(request, line_cfg);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_config_reset(line_cfg);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	gpiod_test_reconfigure_lines_or_fail(request, line_cfg);
+
+	g_gpiosim_chip_set_pull(sim, 1, G_GPIOSIM_PULL_DOWN);
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(input_shadow_follows_edge_events)
+{
+	static const guint offsets[] = { 0, 1 };
+	static const guint rising_offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_request_config_set_input_shadow(req_cfg, true);
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+	gpiod_line_settings_set_edge_detection(settings,
+					       GPIOD_LINE_EDGE_RISING);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg,
+							 &rising_offset, 1,
+							 settings);
+
+	g_gpiosim_chip_set_pull(sim, 1, G_GPIOSIM_PULL_UP);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	/* Shadowed lines only change once their events have been read. */
+	g_gpiosim_chip_set_pull(sim, 0, G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, 1, G_GPIOSIM_PULL_DOWN);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	/* Lines without both edges detected are always read back. */
+	g_assert_cmpint(gpiod_line_request_get_value(request, 2), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_line_request_wait_edge_events(request, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 3);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(gpiod_line_request_get_value(request, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(input_shadow_is_resynced_after_lost_events)
+{
+	static const guint offset = 0;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_request_config_set_input_shadow(req_cfg, true);
+	gpiod_request_config_set_event_buffer_size(req_cfg, 2);
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	/* Overflow the kernel buffer so that events are lost. */
+	for (i = 0; i < 7; i++) {
+		g_gpiosim_chip_set_pull(sim, offset, i % 2 ? G_GPIOSIM_PULL_DOWN :
+							     G_GPIOSIM_PULL_UP);
+		g_usleep(500);
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, offset), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+}
+
+static gpointer pull_up_two_lines(gpointer data)
+{
+	GPIOSimChip *sim = data;
+
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, 1, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	return NULL;
+}
+
+GPIOD_TEST_CASE(wait_for_values)
+{
+	static const guint offsets[] = { 1, 2 };
+	static const guint falling_offset = 3;
+	static const enum gpiod_line_value vals[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(GThread) thread = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+	gpiod_line_settings_set_edge_detection(settings,
+					       GPIOD_LINE_EDGE_FALLING);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg,
+							 &falling_offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	/* The current value satisfies the wait right away. */
+	ret = gpiod_line_request_wait_for_value(request, 1,
+						GPIOD_LINE_VALUE_INACTIVE, 0);
+	g_assert_cmpint(ret, ==, 1);
+
+	ret = gpiod_line_request_wait_for_value(request, 1,
+						GPIOD_LINE_VALUE_ACTIVE,
+						10000000);
+	g_assert_cmpint(ret, ==, 0);
+
+	/* Waiting for a value needs the edge leading to it. */
+	ret = gpiod_line_request_wait_for_value(request, falling_offset,
+						GPIOD_LINE_VALUE_ACTIVE, 0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_line_request_wait_for_values_mask(request, 0, 0,
+						      GPIOD_LINE_MATCH_ALL, 0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	thread = g_thread_new("pull-up", pull_up_two_lines, sim);
+	g_thread_ref(thread);
+
+	ret = gpiod_line_request_wait_for_values_subset(request, 2, offsets,
+							vals,
+							GPIOD_LINE_MATCH_ANY,
+							1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	gpiod_test_join_thread_and_return_if_failed(thread);
+
+	ret = gpiod_line_request_wait_for_values_subset(request, 2, offsets,
+							vals,
+							GPIOD_LINE_MATCH_ALL,
+							1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	g_thread_join(thread);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_request_get_value(request, 2), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+}
+
+GPIOD_TEST_CASE(set_clear_and_toggle_bits)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 4,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_bits(request, 0x5);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_line_request_toggle_bits(request, 0x6);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_line_request_clear_bits(request, 0x3);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_line_request_toggle_bits(request, 0x10);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(toggle_bits_with_output_shadow)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_request_config_set_output_shadow(req_cfg, true);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	for (i = 0; i < 5; i++) {
+		ret = gpiod_line_request_toggle_bits(request, 0x2);
+		g_assert_cmpint(ret, ==, 0);
+		gpiod_test_return_if_failed();
+
+		g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+				GPIOD_LINE_VALUE_INACTIVE);
+		g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+				i % 2 ? GPIOD_LINE_VALUE_INACTIVE :
+					GPIOD_LINE_VALUE_ACTIVE);
+	}
+}
+
+#define CONCURRENT_NUM_THREADS	4
+#define CONCURRENT_NUM_WRITES	500
+
+struct concurrent_writer {
+	struct gpiod_line_request *request;
+	guint64 mask;
+	gint ret;
+};
+
+static gpointer write_values_concurrently(gpointer data)
+{
+	struct concurrent_writer *writer = data;
+	gint i;
+
+	for (i = 0; i < CONCURRENT_NUM_WRITES && !writer->ret; i++)
+		/* Every write changes the value, the shadow never skips one. */
+		writer->ret = gpiod_line_request_set_values_mask(writer->request,
+						writer->mask,
+						i % 2 ? 0 : writer->mask);
+
+	return NULL;
+}
+
+GPIOD_TEST_CASE(set_values_from_many_threads)
+{
+	static const guint offsets[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_stats) stats = NULL;
+	struct concurrent_writer writers[CONCURRENT_NUM_THREADS];
+	GThread *threads[CONCURRENT_NUM_THREADS];
+	guint64 values;
+	gint ret, i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_request_config_set_output_shadow(req_cfg, true);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 8,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	/* Each thread drives a disjoint pair of lines. */
+	for (i = 0; i < CONCURRENT_NUM_THREADS; i++) {
+		writers[i].request = request;
+		writers[i].mask = 0x3ULL << (i * 2);
+		writers[i].ret = 0;
+		threads[i] = g_thread_new("writer", write_values_concurrently,
+					  &writers[i]);
+	}
+
+	for (i = 0; i < CONCURRENT_NUM_THREADS; i++) {
+		g_thread_join(threads[i]);
+		g_assert_cmpint(writers[i].ret, ==, 0);
+	}
+
+	/* The last write of every thread drove its lines low. */
+	for (i = 0; i < 8; i++)
+		g_assert_cmpint(g_gpiosim_chip_get_value(sim, i), ==,
+				GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_line_request_get_values_mask(request, 0xff, &values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(values, ==, 0);
+
+	stats = gpiod_line_request_get_stats(request);
+	g_assert_nonnull(stats);
+	gpiod_test_return_if_failed();
+
+	/* No update of the shadow or of the counters was lost. */
+	g_assert_cmpuint(gpiod_stats_get_num_set_ioctls(stats), ==,
+			 CONCURRENT_NUM_THREADS * CONCURRENT_NUM_WRITES);
+	g_assert_cmpuint(gpiod_stats_get_num_get_ioctls(stats), ==, 0);
+}
+
+GPIOD_TEST_CASE(stats_count_calls_into_the_kernel)
+{
+	static const guint offsets[] = { 0, 1 };
+	static const enum gpiod_line_value values[] = {
+		GPIOD_LINE_VALUE_ACTIVE, GPIOD_LINE_VALUE_INACTIVE
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_stats) stats = NULL;
+	g_autoptr(struct_gpiod_stats) reset = NULL;
+	enum gpiod_line_value read_values[2];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[0],
+							 1, settings);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[1],
+							 1, settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	ret = gpiod_line_request_set_value(request, 0, values[0]);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_line_request_set_value(request, 0, values[1]);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_line_request_get_values(request, read_values);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_gpiosim_chip_set_pull(sim, 1, G_GPIOSIM_PULL_UP);
+	g_usleep(1000);
+	g_gpiosim_chip_set_pull(sim, 1, G_GPIOSIM_PULL_DOWN);
+
+	ret = gpiod_line_request_wait_edge_events(request, 1000000000);
+	g_assert_cmpint(ret, ==, 1);
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 2);
+	gpiod_test_return_if_failed();
+
+	stats = gpiod_line_request_get_stats(request);
+	g_assert_nonnull(stats);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_stats_get_num_set_ioctls(stats), ==, 2);
+	g_assert_cmpuint(gpiod_stats_get_num_get_ioctls(stats), ==, 1);
+	g_assert_cmpuint(gpiod_stats_get_num_config_ioctls(stats), ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_num_reads(stats), ==, 1);
+	g_assert_cmpuint(gpiod_stats_get_num_events_read(stats), ==, 2);
+	g_assert_cmpuint(gpiod_stats_get_num_bytes_read(stats), >, 0);
+	g_assert_cmpuint(gpiod_stats_get_ioctl_time_ns(stats), >=,
+			 gpiod_stats_get_max_ioctl_time_ns(stats));
+	g_assert_cmpuint(gpiod_stats_get_max_ioctl_time_ns(stats), >, 0);
+
+	/* Snapshots don't change. */
+	ret = gpiod_line_request_set_value(request, 0, values[0]);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_num_set_ioctls(stats), ==, 2);
+
+	gpiod_line_request_reset_stats(request);
+	reset = gpiod_line_request_get_stats(request);
+	g_assert_nonnull(reset);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_stats_get_num_set_ioctls(reset), ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_num_events_read(reset), ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_ioctl_time_ns(reset), ==, 0);
+	g_assert_cmpuint(gpiod_stats_get_wait_time_ns(reset), ==, 0);
+}
+
+GPIOD_TEST_CASE(latency_histogram_needs_enabling)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	struct gpiod_latency_histogram *hist;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 NULL);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	hist = gpiod_line_request_get_latency_histogram(request, offset);
+	g_assert_null(hist);
+	gpiod_test_expect_errno(ENOTSUP);
+}
+
+GPIOD_TEST_CASE(latency_histogram_uses_the_event_clock_of_each_line)
+{
+	static const guint offsets[] = { 1, 2 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_latency_histogram) reset = NULL;
+	struct gpiod_latency_histogram *hist;
+	gint ret;
+	gsize i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[0],
+							 1, settings);
+	gpiod_line_settings_set_event_clock(settings,
+					    GPIOD_LINE_CLOCK_REALTIME);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offsets[1],
+							 1, settings);
+	gpiod_request_config_set_latency_histogram(req_cfg, true);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	for (i = 0; i < G_N_ELEMENTS(offsets); i++) {
+		g_gpiosim_chip_set_pull(sim, offsets[i], G_GPIOSIM_PULL_UP);
+		g_usleep(1000);
+		g_gpiosim_chip_set_pull(sim, offsets[i], G_GPIOSIM_PULL_DOWN);
+		g_usleep(1000);
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 4);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < G_N_ELEMENTS(offsets); i++) {
+		hist = gpiod_line_request_get_latency_histogram(request,
+								offsets[i]);
+		g_assert_nonnull(hist);
+		gpiod_test_return_if_failed();
+
+		g_assert_cmpuint(gpiod_latency_histogram_get_num_samples(hist),
+				 ==, 2);
+		/*
+		 * Every event waited at least until the edges that followed it.
+		 * Comparing against the wrong clock would be off by years.
+		 */
+		g_assert_cmpuint(gpiod_latency_histogram_get_min_ns(hist), >,
+				 0);
+		g_assert_cmpuint(gpiod_latency_histogram_get_max_ns(hist), <,
+				 60 * G_GUINT64_CONSTANT(1000000000));
+		g_assert_cmpuint(
+			gpiod_latency_histogram_get_percentile_ns(hist, 50.0),
+			>=, gpiod_latency_histogram_get_min_ns(hist));
+		g_assert_cmpuint(
+			gpiod_latency_histogram_get_percentile_ns(hist, 50.0),
+			<=, gpiod_latency_histogram_get_max_ns(hist));
+		g_assert_cmpuint(
+			gpiod_latency_histogram_get_percentile_ns(hist, 100.0),
+			==, gpiod_latency_histogram_get_max_ns(hist));
+
+		gpiod_latency_histogram_free(hist);
+	}
+
+	gpiod_line_request_reset_latency_histograms(request);
+
+	reset = gpiod_line_request_get_latency_histogram(request, offsets[0]);
+	g_assert_nonnull(reset);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_latency_histogram_get_num_samples(reset), ==, 0);
+	g_assert_cmpuint(gpiod_latency_histogram_get_percentile_ns(reset, 99.0),
+			 ==, 0);
+}
+
+GPIOD_TEST_CASE(edge_stats_count_edges_and_intervals)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_edge_stats) stats = NULL;
+	g_autoptr(struct_gpiod_edge_stats) reset = NULL;
+	guint64 num_intervals = 0;
+	guint bucket;
+	gint ret;
+	gsize i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(16);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+	gpiod_request_config_set_edge_stats(req_cfg, true);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	for (i = 0; i < 3; i++) {
+		g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+		g_usleep(1000);
+		g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+		g_usleep(1000);
+	}
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 16);
+	g_assert_cmpint(ret, ==, 6);
+	gpiod_test_return_if_failed();
+
+	stats = gpiod_line_request_get_edge_stats(request, offset);
+	g_assert_nonnull(stats);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_edge_stats_get_num_rising(stats), ==, 3);
+	g_assert_cmpuint(gpiod_edge_stats_get_num_falling(stats), ==, 3);
+	g_assert_cmpuint(gpiod_edge_stats_get_num_intervals(stats), ==, 5);
+	/* The pull was changed every millisecond at the earliest. */
+	g_assert_cmpuint(gpiod_edge_stats_get_min_interval_ns(stats), >=,
+			 1000000);
+	g_assert_cmpuint(gpiod_edge_stats_get_avg_interval_ns(stats), >=,
+			 gpiod_edge_stats_get_min_interval_ns(stats));
+	g_assert_cmpfloat(gpiod_edge_stats_get_rate(stats), >, 0.0);
+	g_assert_cmpfloat(gpiod_edge_stats_get_rate(stats), <=, 1000.0);
+
+	for (bucket = 0; bucket < 64; bucket++)
+		num_intervals += gpiod_edge_stats_get_interval_count(stats,
+								     bucket);
+	g_assert_cmpuint(num_intervals, ==, 5);
+	g_assert_cmpuint(gpiod_edge_stats_get_interval_count(stats, 0), ==, 0);
+
+	gpiod_line_request_reset_edge_stats(request);
+
+	reset = gpiod_line_request_get_edge_stats(request, offset);
+	g_assert_nonnull(reset);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_edge_stats_get_num_rising(reset), ==, 0);
+	g_assert_cmpuint(gpiod_edge_stats_get_num_intervals(reset), ==, 0);
+	g_assert_cmpfloat(gpiod_edge_stats_get_rate(reset), ==, 0.0);
+}
+
+GPIOD_TEST_CASE(request_lines_in_batch)
+{
+	static const guint offsets[] = { 0, 2, 5 };
+	static const gchar *const consumers[] = { "foo", "bar", "baz" };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_request_config *req_cfgs[3];
+	struct gpiod_line_config *line_cfgs[3];
+	struct gpiod_line_request *requests[3];
+	struct gpiod_line_info *info;
+	guint i, offset;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+
+	for (i = 0; i < 3; i++) {
+		req_cfgs[i] = gpiod_test_create_request_config_or_fail();
+		line_cfgs[i] = gpiod_test_create_line_config_or_fail();
+		gpiod_request_config_set_consumer(req_cfgs[i], consumers[i]);
+		gpiod_test_line_config_add_line_settings_or_fail(
+					line_cfgs[i], &offsets[i], 1, NULL);
+	}
+
+	ret = gpiod_chip_request_lines_batch(chip, req_cfgs, line_cfgs, 3,
+					     requests);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < 3; i++) {
+		g_assert_cmpuint(gpiod_line_request_get_num_requested_lines(
+							requests[i]), ==, 1);
+		gpiod_line_request_get_requested_offsets(requests[i], &offset,
+							 1);
+		g_assert_cmpuint(offset, ==, offsets[i]);
+
+		info = gpiod_chip_get_line_info(chip, offsets[i]);
+		g_assert_nonnull(info);
+		g_assert_cmpstr(gpiod_line_info_get_consumer(info), ==,
+				consumers[i]);
+		gpiod_line_info_free(info);
+	}
+
+	g_assert_cmpint(gpiod_line_request_get_fd(requests[0]), !=,
+			gpiod_line_request_get_fd(requests[1]));
+
+	for (i = 0; i < 3; i++) {
+		gpiod_line_request_release(requests[i]);
+		gpiod_line_config_free(line_cfgs[i]);
+		gpiod_request_config_free(req_cfgs[i]);
+	}
+}
+
+GPIOD_TEST_CASE(batch_with_overlapping_lines_requests_nothing)
+{
+	static const guint first[] = { 1, 2 };
+	static const guint second[] = { 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) first_cfg = NULL;
+	g_autoptr(struct_gpiod_line_config) second_cfg = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	struct gpiod_line_config *line_cfgs[2];
+	struct gpiod_line_request *requests[2];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	first_cfg = gpiod_test_create_line_config_or_fail();
+	second_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(first_cfg, first, 2,
+							 NULL);
+	gpiod_test_line_config_add_line_settings_or_fail(second_cfg, second, 2,
+							 NULL);
+
+	line_cfgs[0] = first_cfg;
+	line_cfgs[1] = second_cfg;
+
+	ret = gpiod_chip_request_lines_batch(chip, NULL, line_cfgs, 2,
+					     requests);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 1);
+	g_assert_false(gpiod_line_info_is_used(info));
+}
+
+GPIOD_TEST_CASE(failed_batch_releases_the_requests_made)
+{
+	static const guint first = 1, second = 9;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) first_cfg = NULL;
+	g_autoptr(struct_gpiod_line_config) second_cfg = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	struct gpiod_line_config *line_cfgs[2];
+	struct gpiod_line_request *requests[2];
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	first_cfg = gpiod_test_create_line_config_or_fail();
+	second_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(first_cfg, &first, 1,
+							 NULL);
+	gpiod_test_line_config_add_line_settings_or_fail(second_cfg, &second,
+							 1, NULL);
+
+	line_cfgs[0] = first_cfg;
+	line_cfgs[1] = second_cfg;
+
+	/* The second line is out of range - only the kernel can tell. */
+	ret = gpiod_chip_request_lines_batch(chip, NULL, line_cfgs, 2,
+					     requests);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	info = gpiod_test_get_line_info_or_fail(chip, first);
+	g_assert_false(gpiod_line_info_is_used(info));
+}
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "line-transaction"
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, const guint *offsets,
+		     gsize num_offsets, gboolean output_shadow)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	req_cfg = gpiod_request_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+	g_assert_nonnull(req_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+	gpiod_request_config_set_output_shadow(req_cfg, output_shadow);
+
+	return gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+}
+
+static guint64 num_set_ioctls(struct gpiod_line_request *request)
+{
+	g_autoptr(struct_gpiod_stats) stats = NULL;
+
+	stats = gpiod_line_request_get_stats(request);
+	g_assert_nonnull(stats);
+
+	return gpiod_stats_get_num_set_ioctls(stats);
+}
+
+GPIOD_TEST_CASE(commit_phases_in_order)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_transaction) tx = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 4, FALSE);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	tx = gpiod_test_begin_transaction_or_fail(request);
+	g_assert_cmpuint(gpiod_line_transaction_get_num_phases(tx), ==, 0);
+
+	/* Enables. */
+	g_assert_cmpint(gpiod_line_transaction_set_bits(tx, 0x1), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_next_phase(tx), ==, 0);
+	/* Data, staged twice - the last value wins. */
+	g_assert_cmpint(gpiod_line_transaction_set_value(tx, 1,
+						GPIOD_LINE_VALUE_ACTIVE),
+			==, 0);
+	g_assert_cmpint(gpiod_line_transaction_set_values_mask(tx, 0x6, 0x4),
+			==, 0);
+	g_assert_cmpint(gpiod_line_transaction_next_phase(tx), ==, 0);
+	/* Empty phases are not kept. */
+	g_assert_cmpint(gpiod_line_transaction_next_phase(tx), ==, 0);
+	/* Strobe. */
+	g_assert_cmpint(gpiod_line_transaction_set_bits(tx, 0x8), ==, 0);
+
+	g_assert_cmpuint(gpiod_line_transaction_get_num_phases(tx), ==, 3);
+
+	/* Nothing is written before the commit. */
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==, 0);
+	g_assert_cmpuint(num_set_ioctls(request), ==, 0);
+
+	ret = gpiod_line_transaction_commit(tx);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==, 1);
+	g_assert_cmpuint(num_set_ioctls(request), ==, 3);
+
+	/* The transaction is empty and can be reused. */
+	g_assert_cmpuint(gpiod_line_transaction_get_num_phases(tx), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_clear_bits(tx, 0x8), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_commit(tx), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 3), ==, 0);
+}
+
+GPIOD_TEST_CASE(phases_not_changing_values_are_skipped)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 2, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_transaction) tx = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2, TRUE);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	tx = gpiod_test_begin_transaction_or_fail(request);
+
+	g_assert_cmpint(gpiod_line_transaction_set_bits(tx, 0x1), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_next_phase(tx), ==, 0);
+	/* Already inactive. */
+	g_assert_cmpint(gpiod_line_transaction_clear_bits(tx, 0x2), ==, 0);
+
+	g_assert_cmpint(gpiod_line_transaction_commit(tx), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==, 1);
+	g_assert_cmpuint(num_set_ioctls(request), ==, 1);
+}
+
+GPIOD_TEST_CASE(discard)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 2, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_transaction) tx = NULL;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2, FALSE);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	tx = gpiod_test_begin_transaction_or_fail(request);
+
+	g_assert_cmpint(gpiod_line_transaction_set_bits(tx, 0x3), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_next_phase(tx), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_clear_bits(tx, 0x1), ==, 0);
+	gpiod_line_transaction_discard(tx);
+
+	g_assert_cmpuint(gpiod_line_transaction_get_num_phases(tx), ==, 0);
+	g_assert_cmpint(gpiod_line_transaction_commit(tx), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==, 0);
+	g_assert_cmpuint(num_set_ioctls(request), ==, 0);
+}
+
+GPIOD_TEST_CASE(invalid_lines)
+{
+	static const guint offsets[] = { 0, 1 };
+	static const guint bad_offsets[] = { 0, 3 };
+	static const enum gpiod_line_value values[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_transaction) tx = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2, FALSE);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	tx = gpiod_test_begin_transaction_or_fail(request);
+
+	ret = gpiod_line_transaction_set_value(tx, 3, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_line_transaction_set_values_mask(tx, 0x4, 0x4);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* Nothing is staged if any of the offsets is invalid. */
+	ret = gpiod_line_transaction_set_values_subset(tx, 2, bad_offsets,
+						       values);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_line_transaction_get_num_phases(tx), ==, 0);
+}
@@ -4,6 +4,7 @@
 #include <errno.h>
 #include <glib.h>
 #include <gpiod.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "gpiod-test.h"
@@ -97,3 +98,134 @@ GPIOD_TEST_CASE(version_string)
 	g_assert_no_error(err);
 	g_assert_false(g_match_info_matches(match));
 }
+
+struct alloc_stats {
+	guint num_allocs;
+	guint num_frees;
+};
+
+static void *counting_alloc(size_t size, void *data)
+{
+	struct alloc_stats *stats = data;
+
+	stats->num_allocs++;
+
+	return malloc(size);
+}
+
+static void counting_free(void *ptr, void *data)
+{
+	struct alloc_stats *stats = data;
+
+	stats->num_frees++;
+	free(ptr);
+}
+
+GPIOD_TEST_CASE(set_allocator_bad_callbacks)
+{
+	gint ret;
+
+	ret = gpiod_set_allocator(counting_alloc, NULL, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_set_allocator(NULL, counting_free, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(user_allocator_is_used_and_hot_path_does_not_allocate)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	struct gpiod_line_settings *settings;
+	struct gpiod_line_request *request;
+	struct gpiod_line_config *line_cfg;
+	struct alloc_stats stats = { 0 };
+	struct gpiod_chip *chip;
+	guint num_allocs, i;
+	gint ret;
+
+	ret = gpiod_set_allocator(counting_alloc, counting_free, &stats);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	chip = gpiod_chip_open(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(chip);
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	ret = gpiod_line_config_add_line_settings(line_cfg, &offset, 1,
+						  settings);
+	g_assert_cmpint(ret, ==, 0);
+
+	request = gpiod_chip_request_lines(chip, NULL, line_cfg);
+	g_assert_nonnull(request);
+
+	g_assert_cmpuint(stats.num_allocs, >, 0);
+	num_allocs = stats.num_allocs;
+
+	for (i = 0; request && i < 8; i++) {
+		ret = gpiod_line_request_set_value(request, offset,
+						   i % 2 ? GPIOD_LINE_VALUE_ACTIVE :
+						   GPIOD_LINE_VALUE_INACTIVE);
+		g_assert_cmpint(ret, ==, 0);
+		g_assert_cmpint(gpiod_line_request_get_value(request, offset),
+				==, i % 2);
+	}
+
+	g_assert_cmpuint(stats.num_allocs, ==, num_allocs);
+
+	gpiod_line_request_release(request);
+	gpiod_line_config_free(line_cfg);
+	gpiod_line_settings_free(settings);
+	gpiod_chip_close(chip);
+
+	g_assert_cmpuint(stats.num_frees, ==, stats.num_allocs);
+
+	ret = gpiod_set_allocator(NULL, NULL, NULL);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+static gpointer create_settings_func(gpointer data G_GNUC_UNUSED)
+{
+	return gpiod_line_settings_new();
+}
+
+GPIOD_TEST_CASE(thread_allocator_is_local_and_owns_its_objects)
+{
+	struct gpiod_line_settings *settings, *other;
+	struct alloc_stats stats = { 0 };
+	GThread *thread;
+	gint ret;
+
+	ret = gpiod_set_thread_allocator(counting_alloc, NULL, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_set_thread_allocator(counting_alloc, counting_free, &stats);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	settings = gpiod_line_settings_new();
+	g_assert_nonnull(settings);
+	g_assert_cmpuint(stats.num_allocs, >, 0);
+
+	/* Other threads keep using the process-wide allocator. */
+	thread = g_thread_new("create-settings", create_settings_func, NULL);
+	other = g_thread_join(thread);
+	g_assert_nonnull(other);
+
+	ret = gpiod_set_thread_allocator(NULL, NULL, NULL);
+	g_assert_cmpint(ret, ==, 0);
+
+	/* Objects are released by the allocator they came from. */
+	gpiod_line_settings_free(settings);
+	gpiod_line_settings_free(other);
+	g_assert_cmpuint(stats.num_frees, ==, stats.num_allocs);
+}
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+
+#define GPIOD_TEST_GROUP "mock"
+
+static struct gpiod_mock_chip *create_mock_chip(size_t num_lines)
+{
+	struct gpiod_mock_chip *mock;
+
+	mock = gpiod_mock_chip_new(num_lines);
+	if (!mock && errno == ENOTSUP)
+		g_test_skip("mock backend not built in");
+	else
+		g_assert_nonnull(mock);
+
+	return mock;
+}
+
+static struct gpiod_line_request *
+request_line(struct gpiod_chip *chip, unsigned int offset,
+	     enum gpiod_line_direction direction, enum gpiod_line_edge edge)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	struct gpiod_line_request *request;
+	gint ret;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, direction);
+	gpiod_line_settings_set_edge_detection(settings, edge);
+	ret = gpiod_line_config_add_line_settings(line_cfg, &offset, 1,
+						  settings);
+	g_assert_cmpint(ret, ==, 0);
+
+	request = gpiod_chip_request_lines(chip, NULL, line_cfg);
+	g_assert_nonnull(request);
+
+	return request;
+}
+
+GPIOD_TEST_CASE(opened_by_path)
+{
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_chip_info) info = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+
+	mock = create_mock_chip(8);
+	if (!mock)
+		return;
+
+	g_assert_true(gpiod_is_gpiochip_device(gpiod_mock_chip_get_path(mock)));
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	info = gpiod_chip_get_info(chip);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(gpiod_chip_info_get_num_lines(info), ==, 8);
+	g_assert_cmpstr(gpiod_chip_info_get_label(info), ==, "gpiod-mock");
+
+	/* The path is gone once freed, open chips keep working. */
+	g_clear_pointer(&mock, gpiod_mock_chip_free);
+	g_assert_false(gpiod_is_gpiochip_device(
+			gpiod_chip_get_path(chip)));
+	g_clear_pointer(&info, gpiod_chip_info_free);
+	info = gpiod_chip_get_info(chip);
+	g_assert_nonnull(info);
+}
+
+GPIOD_TEST_CASE(values_are_passed_through)
+{
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_line_request) input = NULL;
+	g_autoptr(struct_gpiod_line_request) output = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+
+	mock = create_mock_chip(8);
+	if (!mock)
+		return;
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	input = request_line(chip, 2, GPIOD_LINE_DIRECTION_INPUT,
+			     GPIOD_LINE_EDGE_NONE);
+	output = request_line(chip, 5, GPIOD_LINE_DIRECTION_OUTPUT,
+			      GPIOD_LINE_EDGE_NONE);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_request_get_value(input, 2), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(gpiod_mock_chip_set_value(mock, 2, 1), ==, 0);
+	g_assert_cmpint(gpiod_line_request_get_value(input, 2), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	g_assert_cmpint(gpiod_line_request_set_value(output, 5,
+						     GPIOD_LINE_VALUE_ACTIVE),
+			==, 0);
+	g_assert_cmpint(gpiod_mock_chip_get_value(mock, 5), ==, 1);
+
+	g_assert_cmpint(gpiod_mock_chip_set_value(mock, 5, 0), ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+	g_assert_cmpint(gpiod_mock_chip_set_value(mock, 8, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_line_request_set_value(input, 2,
+						     GPIOD_LINE_VALUE_ACTIVE),
+			==, -1);
+	gpiod_test_expect_errno(EPERM);
+}
+
+GPIOD_TEST_CASE(events_are_generated_at_rate)
+{
+	static const size_t num_events = 16;
+
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_edge_event *event;
+	guint64 last_ts = 0;
+	size_t i, j, num_read = 0;
+	gint ret;
+
+	mock = create_mock_chip(4);
+	if (!mock)
+		return;
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	request = request_line(chip, 3, GPIOD_LINE_DIRECTION_INPUT,
+			       GPIOD_LINE_EDGE_BOTH);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(num_events);
+
+	ret = gpiod_line_request_wait_edge_events(request, 0);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_assert_cmpint(gpiod_mock_chip_set_event_rate(mock, 3, 100), ==, 0);
+
+	while (num_read < num_events) {
+		ret = gpiod_line_request_wait_edge_events(request,
+							  100000000);
+		g_assert_cmpint(ret, ==, 1);
+		gpiod_test_return_if_failed();
+
+		ret = gpiod_line_request_read_edge_events(request, buffer,
+							  num_events);
+		g_assert_cmpint(ret, >, 0);
+		gpiod_test_return_if_failed();
+
+		for (i = 0; i < (size_t)ret && num_read < num_events; i++) {
+			j = num_read++;
+			event = gpiod_edge_event_buffer_get_event(buffer, i);
+
+			/* The line starts low. */
+			g_assert_cmpint(gpiod_edge_event_get_event_type(event),
+					==, j % 2 ?
+					GPIOD_EDGE_EVENT_FALLING_EDGE :
+					GPIOD_EDGE_EVENT_RISING_EDGE);
+			g_assert_cmpuint(gpiod_edge_event_get_line_offset(event),
+					 ==, 3);
+			g_assert_cmpuint(
+				gpiod_edge_event_get_line_seqno(event), ==,
+				j + 1);
+			g_assert_cmpuint(
+				gpiod_edge_event_get_timestamp_ns(event), >,
+				last_ts);
+			last_ts = gpiod_edge_event_get_timestamp_ns(event);
+		}
+	}
+
+	g_assert_cmpint(gpiod_mock_chip_set_event_rate(mock, 3, 0), ==, 0);
+	g_assert_cmpint(gpiod_line_request_wait_edge_events(request, 0), ==,
+			0);
+}
+
+GPIOD_TEST_CASE(unwanted_edges_are_skipped)
+{
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_mock_chip) mock = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	struct gpiod_edge_event *event;
+	gint ret, i;
+
+	mock = create_mock_chip(4);
+	if (!mock)
+		return;
+
+	chip = gpiod_test_open_chip_or_fail(gpiod_mock_chip_get_path(mock));
+	request = request_line(chip, 0, GPIOD_LINE_DIRECTION_INPUT,
+			       GPIOD_LINE_EDGE_FALLING);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(8);
+
+	g_assert_cmpint(gpiod_mock_chip_set_event_rate(mock, 0, 10000), ==, 0);
+	g_usleep(2000);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 8);
+	g_assert_cmpint(ret, >, 0);
+	gpiod_test_return_if_failed();
+
+	for (i = 0; i < ret; i++) {
+		event = gpiod_edge_event_buffer_get_event(buffer, i);
+		g_assert_cmpint(gpiod_edge_event_get_event_type(event), ==,
+				GPIOD_EDGE_EVENT_FALLING_EDGE);
+	}
+}
@@ -0,0 +1,386 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "multi-request"
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, const guint *offsets,
+		     gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(add_request_with_invalid_arguments)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_multi_request) mreq = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	mreq = gpiod_test_create_multi_request_or_fail();
+
+	ret = gpiod_multi_request_add_request(mreq, chip, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_multi_request_add_request(mreq, chip, request);
+	g_assert_cmpint(ret, ==, 0);
+
+	/* The same request can't be added twice. */
+	ret = gpiod_multi_request_add_request(mreq, chip, request);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_multi_request_get_num_members(mreq), ==, 1);
+	g_assert_true(gpiod_multi_request_get_member(mreq, 0) == request);
+	g_assert_null(gpiod_multi_request_get_member(mreq, 1));
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(find_lines)
+{
+	static const struct gpiod_test_line_name names[] = {
+		{ .offset = 1, .name = "foo", },
+		{ .offset = 3, .name = "bar", },
+		{ }
+	};
+	static const guint offsets0[] = { 0, 1 };
+	static const guint offsets1[] = { 3, 1 };
+
+	g_autoptr(GVariant) vnames0 = gpiod_test_package_line_names(names);
+	g_autoptr(GVariant) vnames1 = gpiod_test_package_line_names(names);
+	g_autoptr(GPIOSimChip) sim0 = NULL;
+	g_autoptr(GPIOSimChip) sim1 = NULL;
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_multi_request) mreq = NULL;
+
+	sim0 = g_gpiosim_chip_new("num-lines", 4, "line-names", vnames0, NULL);
+	sim1 = g_gpiosim_chip_new("num-lines", 4, "line-names", vnames1, NULL);
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	request0 = request_output_lines(chip0, offsets0, 2);
+	request1 = request_output_lines(chip1, offsets1, 2);
+	g_assert_nonnull(request0);
+	g_assert_nonnull(request1);
+	gpiod_test_return_if_failed();
+
+	mreq = gpiod_test_create_multi_request_or_fail();
+
+	g_assert_cmpint(gpiod_multi_request_add_request(mreq, chip0, request0),
+			==, 0);
+	g_assert_cmpint(gpiod_multi_request_add_request(mreq, chip1, request1),
+			==, 1);
+
+	g_assert_cmpuint(gpiod_multi_request_get_num_lines(mreq), ==, 4);
+	g_assert_cmpint(gpiod_multi_request_find_line(mreq, 0, 1), ==, 1);
+	g_assert_cmpint(gpiod_multi_request_find_line(mreq, 1, 3), ==, 2);
+	g_assert_cmpint(gpiod_multi_request_find_line(mreq, 1, 0), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	/* The first line with the name wins. */
+	g_assert_cmpint(gpiod_multi_request_find_line_by_name(mreq, "foo"),
+			==, 1);
+	g_assert_cmpint(gpiod_multi_request_find_line_by_name(mreq, "bar"),
+			==, 2);
+	g_assert_cmpint(gpiod_multi_request_find_line_by_name(mreq, "baz"),
+			==, -1);
+	gpiod_test_expect_errno(ENOENT);
+}
+
+static void set_and_read_back(gboolean with_workers)
+{
+	static const guint offsets[] = { 0, 2 };
+	static const enum gpiod_line_value values[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+	static const guint subset[] = { 5, 0 };
+	static const enum gpiod_line_value subset_values[] = {
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(GPIOSimChip) sim2 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_chip) chip2 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request2 = NULL;
+	g_autoptr(struct_gpiod_multi_request) mreq = NULL;
+	enum gpiod_line_value read_values[6];
+	gint ret;
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	chip2 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim2));
+	request0 = request_output_lines(chip0, offsets, 2);
+	request1 = request_output_lines(chip1, offsets, 2);
+	request2 = request_output_lines(chip2, offsets, 2);
+	g_assert_nonnull(request0);
+	g_assert_nonnull(request1);
+	g_assert_nonnull(request2);
+	gpiod_test_return_if_failed();
+
+	mreq = gpiod_test_create_multi_request_or_fail();
+	gpiod_multi_request_add_request(mreq, NULL, request0);
+	gpiod_multi_request_add_request(mreq, NULL, request1);
+	gpiod_multi_request_add_request(mreq, NULL, request2);
+
+	if (with_workers) {
+		ret = gpiod_multi_request_start_workers(mreq, NULL);
+		g_assert_cmpint(ret, ==, 0);
+		gpiod_test_return_if_failed();
+		g_assert_true(gpiod_multi_request_workers_running(mreq));
+
+		ret = gpiod_multi_request_start_workers(mreq, NULL);
+		g_assert_cmpint(ret, ==, -1);
+		gpiod_test_expect_errno(EBUSY);
+
+		ret = gpiod_multi_request_add_request(mreq, NULL, request0);
+		g_assert_cmpint(ret, ==, -1);
+		gpiod_test_expect_errno(EBUSY);
+	}
+
+	ret = gpiod_multi_request_set_values(mreq, values);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 0), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 2), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim1, 0), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim1, 2), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim2, 0), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim2, 2), ==, 1);
+
+	ret = gpiod_multi_request_set_values_subset(mreq, 2, subset,
+						    subset_values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 0), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim2, 2), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim2, 0), ==, 1);
+
+	ret = gpiod_multi_request_get_values(mreq, read_values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(read_values[0], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(read_values[3], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(read_values[4], ==, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(read_values[5], ==, GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_multi_request_get_values_subset(mreq, 2, subset,
+						    read_values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpint(read_values[0], ==, GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(read_values[1], ==, GPIOD_LINE_VALUE_INACTIVE);
+
+	/* Only a single member was touched. */
+	ret = gpiod_multi_request_set_values_subset(mreq, 1, subset,
+						    subset_values);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_multi_request_get_last_skew_ns(mreq), ==, 0);
+
+	if (with_workers) {
+		ret = gpiod_multi_request_stop_workers(mreq);
+		g_assert_cmpint(ret, ==, 0);
+		g_assert_false(gpiod_multi_request_workers_running(mreq));
+	}
+
+	ret = gpiod_multi_request_stop_workers(mreq);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(set_and_get_values_sequentially)
+{
+	set_and_read_back(FALSE);
+}
+
+GPIOD_TEST_CASE(set_and_get_values_from_workers)
+{
+	set_and_read_back(TRUE);
+}
+
+GPIOD_TEST_CASE(subset_with_invalid_line)
+{
+	static const guint offset = 0;
+	static const guint lines[] = { 0, 1 };
+	static const enum gpiod_line_value values[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_multi_request) mreq = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, &offset, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	mreq = gpiod_test_create_multi_request_or_fail();
+	gpiod_multi_request_add_request(mreq, chip, request);
+
+	ret = gpiod_multi_request_set_values_subset(mreq, 2, lines, values);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+static void snapshot_values(gboolean with_workers)
+{
+	static const guint offsets[] = { 0, 2 };
+	static const enum gpiod_line_value values[] = {
+		GPIOD_LINE_VALUE_ACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_INACTIVE,
+		GPIOD_LINE_VALUE_ACTIVE,
+	};
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_multi_request) mreq = NULL;
+	g_autoptr(struct_gpiod_multi_request_snapshot) snapshot = NULL;
+	const struct gpiod_multi_request_sample *samples;
+	guint64 timestamp, window;
+	gsize i;
+	gint ret;
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	request0 = request_output_lines(chip0, offsets, 2);
+	request1 = request_output_lines(chip1, offsets, 2);
+	g_assert_nonnull(request0);
+	g_assert_nonnull(request1);
+	gpiod_test_return_if_failed();
+
+	mreq = gpiod_test_create_multi_request_or_fail();
+	gpiod_multi_request_add_request(mreq, NULL, request0);
+	gpiod_multi_request_add_request(mreq, NULL, request1);
+
+	snapshot = gpiod_multi_request_snapshot_new(mreq);
+	g_assert_nonnull(snapshot);
+	gpiod_test_return_if_failed();
+	g_assert_cmpuint(gpiod_multi_request_snapshot_get_num_samples(snapshot),
+			 ==, 0);
+
+	if (with_workers) {
+		ret = gpiod_multi_request_start_workers(mreq, NULL);
+		g_assert_cmpint(ret, ==, 0);
+		gpiod_test_return_if_failed();
+	}
+
+	ret = gpiod_multi_request_set_values(mreq, values);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_multi_request_take_snapshot(mreq, snapshot);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_multi_request_snapshot_get_num_samples(snapshot),
+			 ==, 2);
+	gpiod_test_return_if_failed();
+
+	samples = gpiod_multi_request_snapshot_get_samples(snapshot);
+	g_assert_cmpuint(samples[0].mask, ==, 0x3);
+	g_assert_cmpuint(samples[0].values, ==, 0x1);
+	g_assert_cmpuint(samples[1].mask, ==, 0x3);
+	g_assert_cmpuint(samples[1].values, ==, 0x2);
+
+	timestamp = gpiod_multi_request_snapshot_get_timestamp_ns(snapshot);
+	window = gpiod_multi_request_snapshot_get_window_ns(snapshot);
+
+	for (i = 0; i < 2; i++) {
+		g_assert_cmpint(samples[i].error, ==, 0);
+		g_assert_cmpuint(samples[i].before_ns, <=, samples[i].after_ns);
+		g_assert_cmpuint(samples[i].before_ns, >=, timestamp - window);
+		g_assert_cmpuint(samples[i].after_ns, <=, timestamp + window);
+	}
+
+	if (with_workers) {
+		ret = gpiod_multi_request_stop_workers(mreq);
+		g_assert_cmpint(ret, ==, 0);
+	}
+}
+
+GPIOD_TEST_CASE(snapshot_values_sequentially)
+{
+	snapshot_values(FALSE);
+}
+
+GPIOD_TEST_CASE(snapshot_values_from_workers)
+{
+	snapshot_values(TRUE);
+}
+
+GPIOD_TEST_CASE(snapshot_sized_for_fewer_members)
+{
+	static const guint offset = 0;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_multi_request) mreq = NULL;
+	g_autoptr(struct_gpiod_multi_request_snapshot) snapshot = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, &offset, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	mreq = gpiod_test_create_multi_request_or_fail();
+	snapshot = gpiod_multi_request_snapshot_new(mreq);
+	g_assert_nonnull(snapshot);
+	gpiod_test_return_if_failed();
+
+	gpiod_multi_request_add_request(mreq, chip, request);
+
+	ret = gpiod_multi_request_take_snapshot(mreq, snapshot);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(E2BIG);
+	g_assert_cmpuint(gpiod_multi_request_snapshot_get_num_samples(snapshot),
+			 ==, 0);
+}
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "output-scheduler"
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, const guint *offsets,
+		     gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(hte_clock_not_supported)
+{
+	struct gpiod_output_scheduler *sched;
+
+	sched = gpiod_output_scheduler_new(GPIOD_LINE_CLOCK_HTE);
+	g_assert_null(sched);
+	gpiod_test_expect_errno(ENOTSUP);
+}
+
+GPIOD_TEST_CASE(schedule_with_invalid_arguments)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_output_scheduler) sched = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	sched = gpiod_test_create_output_scheduler_or_fail(
+					GPIOD_LINE_CLOCK_MONOTONIC);
+
+	ret = gpiod_output_scheduler_schedule(sched, NULL, 0, 0x1, 0x1, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_output_scheduler_schedule(sched, request, 0, 0, 0, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_output_scheduler_schedule(sched, request, 0, 0x4, 0x4,
+					      NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_output_scheduler_get_num_pending(sched), ==, 0);
+}
+
+GPIOD_TEST_CASE(run_entries_in_deadline_order)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_output_scheduler) sched = NULL;
+	guint64 now, first, second, id, lateness;
+	gint ret, error;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	sched = gpiod_test_create_output_scheduler_or_fail(
+					GPIOD_LINE_CLOCK_MONOTONIC);
+	now = gpiod_output_scheduler_now_ns(sched);
+
+	/* Queued out of order, the later deadline drives line 0 low again. */
+	ret = gpiod_output_scheduler_schedule(sched, request, now + 4000000,
+					      0x1, 0x0, &second);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_output_scheduler_schedule(sched, request, now + 2000000,
+					      0x3, 0x3, &first);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_output_scheduler_get_num_pending(sched), ==, 2);
+
+	ret = gpiod_output_scheduler_start(sched);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_output_scheduler_set_thread_attr(sched, NULL);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+
+	g_usleep(20000);
+
+	g_assert_cmpuint(gpiod_output_scheduler_get_num_pending(sched), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	g_assert_cmpint(gpiod_output_scheduler_read_result(sched, &id,
+							   &lateness, &error),
+			==, 1);
+	g_assert_cmpuint(id, ==, first);
+	g_assert_cmpint(error, ==, 0);
+	g_assert_cmpint(gpiod_output_scheduler_read_result(sched, &id,
+							   &lateness, &error),
+			==, 1);
+	g_assert_cmpuint(id, ==, second);
+	g_assert_cmpint(gpiod_output_scheduler_read_result(sched, NULL, NULL,
+							   NULL),
+			==, 0);
+	g_assert_cmpuint(gpiod_output_scheduler_get_max_lateness_ns(sched),
+			 >=, lateness);
+
+	ret = gpiod_output_scheduler_stop(sched);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(cancel_entries)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_output_scheduler) sched = NULL;
+	guint64 now, id;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	sched = gpiod_test_create_output_scheduler_or_fail(
+					GPIOD_LINE_CLOCK_MONOTONIC);
+	now = gpiod_output_scheduler_now_ns(sched);
+
+	ret = gpiod_output_scheduler_schedule(sched, request, now + 2000000,
+					      0x1, 0x1, &id);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_output_scheduler_schedule(sched, request, now + 3000000,
+					      0x2, 0x2, NULL);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_output_scheduler_schedule(sched, request, now + 4000000,
+					      0x2, 0x2, NULL);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_assert_cmpint(gpiod_output_scheduler_cancel(sched, id), ==, 0);
+	g_assert_cmpint(gpiod_output_scheduler_cancel(sched, id), ==, -1);
+	gpiod_test_expect_errno(ENOENT);
+
+	g_assert_cmpuint(gpiod_output_scheduler_cancel_request(sched, request),
+			 ==, 2);
+	g_assert_cmpuint(gpiod_output_scheduler_get_num_pending(sched), ==, 0);
+
+	ret = gpiod_output_scheduler_start(sched);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_usleep(10000);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(gpiod_output_scheduler_read_result(sched, NULL, NULL,
+							   NULL),
+			==, 0);
+
+	ret = gpiod_output_scheduler_stop(sched);
+	g_assert_cmpint(ret, ==, 0);
+}
+
+GPIOD_TEST_CASE(stop_keeps_pending_entries)
+{
+	static const guint offsets[] = { 0 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_output_scheduler) sched = NULL;
+	guint64 now;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	sched = gpiod_test_create_output_scheduler_or_fail(
+					GPIOD_LINE_CLOCK_MONOTONIC);
+
+	ret = gpiod_output_scheduler_start(sched);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	now = gpiod_output_scheduler_now_ns(sched);
+	ret = gpiod_output_scheduler_schedule(sched, request,
+					      now + 1000000000ULL, 0x1, 0x1,
+					      NULL);
+	g_assert_cmpint(ret, ==, 0);
+
+	ret = gpiod_output_scheduler_stop(sched);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_output_scheduler_get_num_pending(sched), ==, 1);
+
+	ret = gpiod_output_scheduler_stop(sched);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
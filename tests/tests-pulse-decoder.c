@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "pulse-decoder"
+
+#define PULSE_US	1000
+
+static struct gpiod_line_request *
+request_both_edges(struct gpiod_chip *chip, const guint *offsets,
+		   gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+static void send_pulse(GPIOSimChip *sim, guint offset, gulong width_us)
+{
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+	g_usleep(width_us);
+	g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+	g_usleep(PULSE_US);
+}
+
+GPIOD_TEST_CASE(invalid_arguments)
+{
+	struct gpiod_pulse_decoder *decoder;
+
+	decoder = gpiod_pulse_decoder_new_wiegand(3, 3);
+	g_assert_null(decoder);
+	gpiod_test_expect_errno(EINVAL);
+
+	decoder = gpiod_pulse_decoder_new_pulse_width(3, 0);
+	g_assert_null(decoder);
+	gpiod_test_expect_errno(EINVAL);
+
+	decoder = gpiod_pulse_decoder_new_wiegand(2, 3);
+	g_assert_nonnull(decoder);
+	g_assert_cmpint(gpiod_pulse_decoder_set_pulse_width_limits(decoder,
+								   10, 5),
+			==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_pulse_decoder_read_frame(decoder, NULL, NULL,
+						       NULL, NULL),
+			==, 0);
+	gpiod_pulse_decoder_free(decoder);
+}
+
+GPIOD_TEST_CASE(decode_wiegand_frames)
+{
+	static const guint offsets[] = { 2, 5 };
+	static const guint bits[] = { 1, 0, 1, 1, 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_pulse_decoder) decoder = NULL;
+	guint64 data, timestamp;
+	guint num_bits, i;
+	gint ret, errors;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	decoder = gpiod_pulse_decoder_new_wiegand(offsets[0], offsets[1]);
+	g_assert_nonnull(decoder);
+	gpiod_test_return_if_failed();
+
+	gpiod_pulse_decoder_set_frame_gap_ns(decoder, 1000000000);
+
+	for (i = 0; i < G_N_ELEMENTS(bits); i++)
+		send_pulse(sim, offsets[bits[i]], PULSE_US);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 2 * G_N_ELEMENTS(bits));
+	gpiod_test_return_if_failed();
+
+	/* The frame isn't over until the gap has passed. */
+	g_assert_cmpint(gpiod_pulse_decoder_add_events(decoder, buffer), ==, 0);
+	g_assert_cmpint(gpiod_pulse_decoder_flush(decoder,
+				gpiod_edge_event_get_timestamp_ns(
+					gpiod_edge_event_buffer_get_event(
+						buffer, ret - 1)) + 1000),
+			==, 0);
+	g_assert_cmpint(gpiod_pulse_decoder_flush(decoder, UINT64_MAX), ==, 1);
+
+	ret = gpiod_pulse_decoder_read_frame(decoder, &data, &num_bits,
+					     &errors, &timestamp);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(num_bits, ==, G_N_ELEMENTS(bits));
+	g_assert_cmphex(data, ==, 0x2d);
+	g_assert_cmpint(errors, ==, 0);
+	g_assert_cmpuint(timestamp, ==,
+			 gpiod_edge_event_get_timestamp_ns(
+				gpiod_edge_event_buffer_get_event(buffer, 0)));
+	g_assert_cmpuint(gpiod_pulse_decoder_get_num_frames(decoder), ==, 0);
+}
+
+GPIOD_TEST_CASE(timing_errors_are_flagged)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_pulse_decoder) decoder = NULL;
+	guint num_bits;
+	gint ret, errors;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	decoder = gpiod_pulse_decoder_new_wiegand(offsets[0], offsets[1]);
+	g_assert_nonnull(decoder);
+	gpiod_test_return_if_failed();
+
+	/* Every pulse of the test is too long. */
+	ret = gpiod_pulse_decoder_set_pulse_width_limits(decoder, 0, 100);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, offsets[0], G_GPIOSIM_PULL_UP);
+	g_gpiosim_chip_set_pull(sim, offsets[1], G_GPIOSIM_PULL_UP);
+	g_usleep(PULSE_US);
+	g_gpiosim_chip_set_pull(sim, offsets[0], G_GPIOSIM_PULL_DOWN);
+	g_gpiosim_chip_set_pull(sim, offsets[1], G_GPIOSIM_PULL_DOWN);
+	g_usleep(PULSE_US);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 4);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pulse_decoder_add_events(decoder, buffer), ==, 0);
+	g_assert_cmpint(gpiod_pulse_decoder_flush(decoder, UINT64_MAX), ==, 1);
+
+	ret = gpiod_pulse_decoder_read_frame(decoder, NULL, &num_bits, &errors,
+					     NULL);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(num_bits, ==, 2);
+	g_assert_cmpint(errors, ==,
+			GPIOD_PULSE_FRAME_ERR_WIDTH |
+			GPIOD_PULSE_FRAME_ERR_OVERLAP);
+}
+
+GPIOD_TEST_CASE(decode_pulse_widths)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_pulse_decoder) decoder = NULL;
+	guint64 data;
+	guint num_bits;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, &offset, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	decoder = gpiod_pulse_decoder_new_pulse_width(offset,
+						      5 * PULSE_US * 1000);
+	g_assert_nonnull(decoder);
+	gpiod_test_return_if_failed();
+
+	send_pulse(sim, offset, 10 * PULSE_US);
+	send_pulse(sim, offset, 0);
+	send_pulse(sim, offset, 10 * PULSE_US);
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, 6);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pulse_decoder_add_events(decoder, buffer), ==, 0);
+	g_assert_cmpint(gpiod_pulse_decoder_flush(decoder, UINT64_MAX), ==, 1);
+
+	ret = gpiod_pulse_decoder_read_frame(decoder, &data, &num_bits, NULL,
+					     NULL);
+	g_assert_cmpint(ret, ==, 1);
+	g_assert_cmpuint(num_bits, ==, 3);
+	g_assert_cmphex(data, ==, 0x5);
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "pulse-meter"
+
+#define HALF_PERIOD_US	10000
+#define NUM_PULSES	4
+
+static struct gpiod_line_request *
+request_both_edges(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+static void generate_pulses(GPIOSimChip *sim, guint offset)
+{
+	gint i;
+
+	for (i = 0; i < NUM_PULSES; i++) {
+		g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_UP);
+		g_usleep(HALF_PERIOD_US);
+		g_gpiosim_chip_set_pull(sim, offset, G_GPIOSIM_PULL_DOWN);
+		g_usleep(HALF_PERIOD_US);
+	}
+}
+
+static void read_pulses(struct gpiod_line_request *request,
+			struct gpiod_edge_event_buffer *buffer)
+{
+	gint ret;
+
+	ret = gpiod_line_request_read_edge_events(request, buffer, 64);
+	g_assert_cmpint(ret, ==, NUM_PULSES * 2);
+}
+
+GPIOD_TEST_CASE(unseen_line_reads_zero)
+{
+	g_autoptr(struct_gpiod_pulse_meter) meter = NULL;
+
+	meter = gpiod_test_create_pulse_meter_or_fail(0);
+
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, 3), ==, 0);
+	g_assert_cmpuint(gpiod_pulse_meter_get_period_ns(meter, 3), ==, 0);
+	g_assert_cmpuint(gpiod_pulse_meter_get_frequency_millihz(meter, 3),
+			 ==, 0);
+	g_assert_cmpuint(gpiod_pulse_meter_get_high_time_ns(meter, 3), ==, 0);
+	g_assert_cmpuint(gpiod_pulse_meter_get_low_time_ns(meter, 3), ==, 0);
+}
+
+GPIOD_TEST_CASE(measure_square_wave)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_pulse_meter) meter = NULL;
+	guint64 period, high, low, freq;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, offset);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	meter = gpiod_test_create_pulse_meter_or_fail(0);
+
+	generate_pulses(sim, offset);
+	read_pulses(request, buffer);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_pulse_meter_add_events(meter, buffer), ==, 0);
+
+	period = gpiod_pulse_meter_get_period_ns(meter, offset);
+	high = gpiod_pulse_meter_get_high_time_ns(meter, offset);
+	low = gpiod_pulse_meter_get_low_time_ns(meter, offset);
+	freq = gpiod_pulse_meter_get_frequency_millihz(meter, offset);
+
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, offset),
+			 ==, NUM_PULSES);
+	g_assert_cmpuint(period, >=, 2 * HALF_PERIOD_US * 1000);
+	g_assert_cmpuint(high, >=, HALF_PERIOD_US * 1000);
+	g_assert_cmpuint(low, >=, HALF_PERIOD_US * 1000);
+	g_assert_cmpuint(freq, >, 0);
+	g_assert_cmpuint(freq, <=, 1000000000 / (2 * HALF_PERIOD_US));
+
+	/* Other lines are unaffected. */
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, 1), ==, 0);
+
+	gpiod_pulse_meter_reset(meter);
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, offset),
+			 ==, 0);
+	g_assert_cmpuint(gpiod_pulse_meter_get_period_ns(meter, offset), ==, 0);
+}
+
+GPIOD_TEST_CASE(windows_are_closed_by_flush)
+{
+	static const guint64 window = 3600ULL * 1000000000ULL;
+	static const guint offset = 1;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_edge_event_buffer) buffer = NULL;
+	g_autoptr(struct_gpiod_pulse_meter) meter = NULL;
+	struct gpiod_edge_event *event;
+	guint64 start;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_both_edges(chip, offset);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	buffer = gpiod_test_create_edge_event_buffer_or_fail(64);
+	meter = gpiod_test_create_pulse_meter_or_fail(window);
+
+	generate_pulses(sim, offset);
+	read_pulses(request, buffer);
+	gpiod_test_return_if_failed();
+
+	event = gpiod_edge_event_buffer_get_event(buffer, 0);
+	g_assert_nonnull(event);
+	gpiod_test_return_if_failed();
+	start = gpiod_edge_event_get_timestamp_ns(event);
+
+	g_assert_cmpint(gpiod_pulse_meter_add_events(meter, buffer), ==, 0);
+
+	/* Nothing is reported until the first window is closed. */
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, offset),
+			 ==, 0);
+
+	gpiod_pulse_meter_flush(meter, start + window - 1);
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, offset),
+			 ==, 0);
+
+	gpiod_pulse_meter_flush(meter, start + window);
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, offset),
+			 ==, NUM_PULSES);
+	g_assert_cmpuint(gpiod_pulse_meter_get_period_ns(meter, offset),
+			 >=, 2 * HALF_PERIOD_US * 1000);
+
+	/* A window without events reads as zero. */
+	gpiod_pulse_meter_flush(meter, start + 2 * window);
+	g_assert_cmpuint(gpiod_pulse_meter_get_num_pulses(meter, offset),
+			 ==, 0);
+	g_assert_cmpuint(gpiod_pulse_meter_get_period_ns(meter, offset), ==, 0);
+}
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "pwm"
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, const guint *offsets,
+		     gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(add_line_with_invalid_arguments)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	pwm = gpiod_test_create_pwm_or_fail();
+
+	ret = gpiod_pwm_add_line(pwm, request, 3, 1000000, 500000);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_pwm_add_line(pwm, request, 0, 0, 0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_pwm_add_line(pwm, request, 0, 1000000, 2000000);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 0, 1000000, 0), ==, 0);
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 1, 1000000, 0), ==, 1);
+	g_assert_cmpuint(gpiod_pwm_get_num_lines(pwm), ==, 2);
+
+	ret = gpiod_pwm_set_duty_cycle(pwm, 2, 1000000, 0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(start_without_lines)
+{
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+	gint ret;
+
+	pwm = gpiod_test_create_pwm_or_fail();
+
+	ret = gpiod_pwm_start(pwm);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(constant_duty_cycles)
+{
+	static const guint offsets[] = { 0, 1, 2 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 3);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	pwm = gpiod_test_create_pwm_or_fail();
+
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 0, 1000000, 1000000),
+			==, 0);
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 1, 1000000, 0),
+			==, 1);
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 2, 2000000, 2000000),
+			==, 2);
+
+	ret = gpiod_pwm_start(pwm);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_pwm_add_line(pwm, request, 3, 1000000, 0);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EBUSY);
+
+	g_usleep(10000);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_pwm_stop(pwm);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(change_duty_cycle_while_running)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_pwm) pwm = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	pwm = gpiod_test_create_pwm_or_fail();
+
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 0, 1000000, 0),
+			==, 0);
+	g_assert_cmpint(gpiod_pwm_add_line(pwm, request, 1, 500000, 250000),
+			==, 1);
+
+	ret = gpiod_pwm_start(pwm);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_usleep(5000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	ret = gpiod_pwm_set_duty_cycle(pwm, 0, 1000000, 1000000);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_usleep(5000);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+
+	ret = gpiod_pwm_stop(pwm);
+	g_assert_cmpint(ret, ==, 0);
+}
@@ -18,6 +18,13 @@ GPIOD_TEST_CASE(default_config)
 	g_assert_null(gpiod_request_config_get_consumer(config));
 	g_assert_cmpuint(gpiod_request_config_get_event_buffer_size(config), ==,
 			 0);
+	g_assert_cmpuint(gpiod_request_config_get_max_event_buffer_size(config),
+			 ==, 0);
+	g_assert_false(gpiod_request_config_get_output_shadow(config));
+	g_assert_false(gpiod_request_config_get_input_shadow(config));
+	g_assert_false(gpiod_request_config_get_nonblocking(config));
+	g_assert_false(gpiod_request_config_get_latency_histogram(config));
+	g_assert_false(gpiod_request_config_get_edge_stats(config));
 }
 
 GPIOD_TEST_CASE(set_consumer)
@@ -41,3 +48,74 @@ GPIOD_TEST_CASE(set_event_buffer_size)
 	g_assert_cmpuint(gpiod_request_config_get_event_buffer_size(config), ==,
 			 128);
 }
+
+GPIOD_TEST_CASE(set_max_event_buffer_size)
+{
+	g_autoptr(struct_gpiod_request_config) config = NULL;
+
+	config = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_max_event_buffer_size(config, 512);
+	g_assert_cmpuint(gpiod_request_config_get_max_event_buffer_size(config),
+			 ==, 512);
+}
+
+GPIOD_TEST_CASE(set_output_shadow)
+{
+	g_autoptr(struct_gpiod_request_config) config = NULL;
+
+	config = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_output_shadow(config, true);
+	g_assert_true(gpiod_request_config_get_output_shadow(config));
+	gpiod_request_config_set_output_shadow(config, false);
+	g_assert_false(gpiod_request_config_get_output_shadow(config));
+}
+
+GPIOD_TEST_CASE(set_input_shadow)
+{
+	g_autoptr(struct_gpiod_request_config) config = NULL;
+
+	config = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_input_shadow(config, true);
+	g_assert_true(gpiod_request_config_get_input_shadow(config));
+	gpiod_request_config_set_input_shadow(config, false);
+	g_assert_false(gpiod_request_config_get_input_shadow(config));
+}
+
+GPIOD_TEST_CASE(set_nonblocking)
+{
+	g_autoptr(struct_gpiod_request_config) config = NULL;
+
+	config = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_nonblocking(config, true);
+	g_assert_true(gpiod_request_config_get_nonblocking(config));
+	gpiod_request_config_set_nonblocking(config, false);
+	g_assert_false(gpiod_request_config_get_nonblocking(config));
+}
+
+GPIOD_TEST_CASE(set_latency_histogram)
+{
+	g_autoptr(struct_gpiod_request_config) config = NULL;
+
+	config = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_latency_histogram(config, true);
+	g_assert_true(gpiod_request_config_get_latency_histogram(config));
+	gpiod_request_config_set_latency_histogram(config, false);
+	g_assert_false(gpiod_request_config_get_latency_histogram(config));
+}
+
+GPIOD_TEST_CASE(set_edge_stats)
+{
+	g_autoptr(struct_gpiod_request_config) config = NULL;
+
+	config = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_edge_stats(config, true);
+	g_assert_true(gpiod_request_config_get_edge_stats(config));
+	gpiod_request_config_set_edge_stats(config, false);
+	g_assert_false(gpiod_request_config_get_edge_stats(config));
+}
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "request-state"
+
+static gint save_state_or_fail(struct gpiod_line_request *request,
+			       guint8 *buf, gsize size)
+{
+	gint ret;
+
+	ret = gpiod_line_request_save_state(request, buf, size);
+	g_assert_cmpint(ret, >, 0);
+	g_assert_cmpint(ret, <=, size);
+
+	return ret;
+}
+
+GPIOD_TEST_CASE(restore_outputs_and_request_config)
+{
+	static const guint offsets[] = { 1, 4, 6 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	guint8 state[1024];
+	gint size, ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+
+	gpiod_request_config_set_consumer(req_cfg, "warm-restart");
+	gpiod_request_config_set_output_shadow(req_cfg, true);
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 3,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, req_cfg, line_cfg);
+
+	ret = gpiod_line_request_set_value(request, 4,
+					   GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+
+	size = save_state_or_fail(request, state, sizeof(state));
+	gpiod_test_return_if_failed();
+
+	gpiod_line_request_release(request);
+	request = gpiod_chip_request_lines_from_state(chip, state, size);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 4), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 6), ==, 0);
+	g_assert_cmpuint(gpiod_line_request_get_num_requested_lines(request),
+			 ==, 3);
+
+	info = gpiod_test_get_line_info_or_fail(chip, 6);
+	g_assert_cmpstr(gpiod_line_info_get_consumer(info), ==,
+			"warm-restart");
+	g_assert_cmpint(gpiod_line_info_get_direction(info), ==,
+			GPIOD_LINE_DIRECTION_OUTPUT);
+}
+
+GPIOD_TEST_CASE(load_state_into_configs)
+{
+	static const guint offset = 3;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_config) loaded_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) loaded_req_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_line_settings) loaded = NULL;
+	guint8 state[1024];
+	gint size, ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	loaded_cfg = gpiod_test_create_line_config_or_fail();
+	loaded_req_cfg = gpiod_test_create_request_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_PULL_UP);
+	gpiod_line_settings_set_active_low(settings, true);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 settings);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	size = gpiod_line_request_save_state(request, NULL, 0);
+	g_assert_cmpint(size, >, 0);
+	ret = save_state_or_fail(request, state, sizeof(state));
+	g_assert_cmpint(ret, ==, size);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_request_state_load(state, size, loaded_req_cfg,
+				       loaded_cfg);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	loaded = gpiod_line_config_get_line_settings(loaded_cfg, offset);
+	g_assert_nonnull(loaded);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_line_settings_get_edge_detection(loaded), ==,
+			GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_settings_get_bias(loaded), ==,
+			GPIOD_LINE_BIAS_PULL_UP);
+	g_assert_true(gpiod_line_settings_get_active_low(loaded));
+	g_assert_null(gpiod_request_config_get_consumer(loaded_req_cfg));
+}
+
+GPIOD_TEST_CASE(corrupted_state_is_rejected)
+{
+	static const guint offset = 0;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	guint8 state[1024];
+	gint size, ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 NULL);
+
+	request = gpiod_test_request_lines_or_fail(chip, NULL, line_cfg);
+
+	size = save_state_or_fail(request, state, sizeof(state));
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_request_state_load(state, size - 1, NULL, line_cfg);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	state[0] ^= 0xff;
+	ret = gpiod_request_state_load(state, size, NULL, line_cfg);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
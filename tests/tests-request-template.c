@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "request-template"
+
+GPIOD_TEST_CASE(template_needs_line_config)
+{
+	g_autoptr(struct_gpiod_request_template) tmpl = NULL;
+
+	tmpl = gpiod_request_template_new(NULL, NULL);
+	g_assert_null(tmpl);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(template_fails_with_no_offsets)
+{
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_template) tmpl = NULL;
+
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	tmpl = gpiod_request_template_new(NULL, line_cfg);
+	g_assert_null(tmpl);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(request_many_chips_from_template)
+{
+	static const guint offsets[] = { 1, 3 };
+	static const gchar *const consumer = "foobar";
+
+	g_autoptr(GPIOSimChip) sim0 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(GPIOSimChip) sim1 = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip0 = NULL;
+	g_autoptr(struct_gpiod_chip) chip1 = NULL;
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_config) req_cfg = NULL;
+	g_autoptr(struct_gpiod_request_template) tmpl = NULL;
+	g_autoptr(struct_gpiod_line_request) request0 = NULL;
+	g_autoptr(struct_gpiod_line_request) request1 = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+
+	chip0 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim0));
+	chip1 = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim1));
+	settings = gpiod_test_create_line_settings_or_fail();
+	line_cfg = gpiod_test_create_line_config_or_fail();
+	req_cfg = gpiod_test_create_request_config_or_fail();
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	gpiod_line_settings_set_output_value(settings,
+					     GPIOD_LINE_VALUE_ACTIVE);
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, offsets, 2,
+							 settings);
+	gpiod_request_config_set_consumer(req_cfg, consumer);
+
+	tmpl = gpiod_test_create_request_template_or_fail(req_cfg, line_cfg);
+	g_assert_cmpuint(gpiod_request_template_get_num_lines(tmpl), ==, 2);
+
+	/* The template doesn't depend on the config objects. */
+	gpiod_line_config_reset(line_cfg);
+	gpiod_request_config_set_consumer(req_cfg, NULL);
+
+	request0 = gpiod_chip_request_lines_from_template(chip0, tmpl);
+	g_assert_nonnull(request0);
+	request1 = gpiod_chip_request_lines_from_template(chip1, tmpl);
+	g_assert_nonnull(request1);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim1, 3), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim1, 2), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+
+	info = gpiod_test_get_line_info_or_fail(chip1, 3);
+	g_assert_cmpstr(gpiod_line_info_get_consumer(info), ==, consumer);
+
+	g_assert_cmpint(gpiod_line_request_set_value(request0, 3,
+						     GPIOD_LINE_VALUE_INACTIVE),
+			==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim0, 3), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(template_can_be_reapplied_after_release)
+{
+	static const guint offset = 2;
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+	g_autoptr(struct_gpiod_request_template) tmpl = NULL;
+	struct gpiod_line_request *request;
+	guint i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	line_cfg = gpiod_test_create_line_config_or_fail();
+
+	gpiod_test_line_config_add_line_settings_or_fail(line_cfg, &offset, 1,
+							 NULL);
+
+	tmpl = gpiod_test_create_request_template_or_fail(NULL, line_cfg);
+
+	for (i = 0; i < 3; i++) {
+		request = gpiod_chip_request_lines_from_template(chip, tmpl);
+		g_assert_nonnull(request);
+		gpiod_test_return_if_failed();
+
+		/* Requesting the same line twice must still fail. */
+		g_assert_null(gpiod_chip_request_lines_from_template(chip,
+								     tmpl));
+		gpiod_test_expect_errno(EBUSY);
+
+		gpiod_line_request_release(request);
+	}
+}
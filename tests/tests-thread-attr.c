@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+
+#define GPIOD_TEST_GROUP "thread-attr"
+
+GPIOD_TEST_CASE(default_values)
+{
+	g_autoptr(struct_gpiod_thread_attr) attr = NULL;
+
+	attr = gpiod_thread_attr_new();
+	g_assert_nonnull(attr);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_thread_attr_get_realtime(attr), ==, 0);
+	g_assert_cmpint(gpiod_thread_attr_get_cpu(attr), ==, -1);
+	g_assert_false(gpiod_thread_attr_get_lock_memory(attr));
+
+	/* Nothing to change. */
+	g_assert_cmpint(gpiod_thread_attr_apply(attr), ==, 0);
+}
+
+GPIOD_TEST_CASE(set_and_get)
+{
+	g_autoptr(struct_gpiod_thread_attr) attr = NULL;
+
+	attr = gpiod_thread_attr_new();
+	g_assert_nonnull(attr);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_thread_attr_set_realtime(attr, 10), ==, 0);
+	g_assert_cmpint(gpiod_thread_attr_get_realtime(attr), ==, 10);
+	g_assert_cmpint(gpiod_thread_attr_set_cpu(attr, 0), ==, 0);
+	g_assert_cmpint(gpiod_thread_attr_get_cpu(attr), ==, 0);
+	g_assert_cmpint(gpiod_thread_attr_set_cpu(attr, -5), ==, 0);
+	g_assert_cmpint(gpiod_thread_attr_get_cpu(attr), ==, -1);
+	gpiod_thread_attr_set_lock_memory(attr, true);
+	g_assert_true(gpiod_thread_attr_get_lock_memory(attr));
+}
+
+GPIOD_TEST_CASE(invalid_values)
+{
+	g_autoptr(struct_gpiod_thread_attr) attr = NULL;
+
+	attr = gpiod_thread_attr_new();
+	g_assert_nonnull(attr);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(gpiod_thread_attr_set_realtime(attr,
+			sched_get_priority_max(SCHED_FIFO) + 1), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+	g_assert_cmpint(gpiod_thread_attr_set_cpu(attr, CPU_SETSIZE), ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpint(gpiod_thread_attr_get_realtime(attr), ==, 0);
+	g_assert_cmpint(gpiod_thread_attr_get_cpu(attr), ==, -1);
+}
+
+static gpointer apply_attr(gpointer data)
+{
+	struct gpiod_thread_attr *attr = data;
+	struct sched_param param;
+	cpu_set_t cpus;
+	int policy;
+
+	/* Run in a thread of its own to not affect the other tests. */
+	g_assert_cmpint(gpiod_thread_attr_apply(attr), ==, 0);
+
+	g_assert_cmpint(pthread_getschedparam(pthread_self(), &policy, &param),
+			==, 0);
+	g_assert_cmpint(policy, ==, SCHED_FIFO);
+	g_assert_cmpint(param.sched_priority, ==, 10);
+
+	g_assert_cmpint(pthread_getaffinity_np(pthread_self(), sizeof(cpus),
+					       &cpus), ==, 0);
+	g_assert_cmpint(CPU_COUNT(&cpus), ==, 1);
+	g_assert_true(CPU_ISSET(0, &cpus));
+
+	return NULL;
+}
+
+GPIOD_TEST_CASE(apply_to_thread)
+{
+	g_autoptr(struct_gpiod_thread_attr) attr = NULL;
+	GThread *thread;
+
+	attr = gpiod_thread_attr_new();
+	g_assert_nonnull(attr);
+	gpiod_test_return_if_failed();
+
+	gpiod_thread_attr_set_realtime(attr, 10);
+	gpiod_thread_attr_set_cpu(attr, 0);
+
+	thread = g_thread_new("apply-attr", apply_attr, attr);
+	g_thread_join(thread);
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "wait-cancel"
+
+static struct gpiod_line_request *
+request_line_with_edges(struct gpiod_chip *chip, guint offset)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, &offset,
+							     1, settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(trigger_and_reset)
+{
+	g_autoptr(struct_gpiod_wait_cancel) cancel = NULL;
+
+	cancel = gpiod_test_create_wait_cancel_or_fail();
+
+	g_assert_cmpint(gpiod_wait_cancel_get_fd(cancel), >=, 0);
+	g_assert_false(gpiod_wait_cancel_is_triggered(cancel));
+
+	g_assert_cmpint(gpiod_wait_cancel_trigger(cancel), ==, 0);
+	g_assert_true(gpiod_wait_cancel_is_triggered(cancel));
+	/* Triggering twice is not an error and doesn't need two resets. */
+	g_assert_cmpint(gpiod_wait_cancel_trigger(cancel), ==, 0);
+	g_assert_true(gpiod_wait_cancel_is_triggered(cancel));
+
+	g_assert_cmpint(gpiod_wait_cancel_reset(cancel), ==, 0);
+	g_assert_false(gpiod_wait_cancel_is_triggered(cancel));
+	/* Resetting an untriggered object is a no-op. */
+	g_assert_cmpint(gpiod_wait_cancel_reset(cancel), ==, 0);
+	g_assert_false(gpiod_wait_cancel_is_triggered(cancel));
+}
+
+static gpointer trigger_cancel(gpointer data)
+{
+	struct gpiod_wait_cancel *cancel = data;
+
+	g_usleep(1000);
+	gpiod_wait_cancel_trigger(cancel);
+
+	return NULL;
+}
+
+GPIOD_TEST_CASE(cancel_edge_event_wait)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_wait_cancel) cancel = NULL;
+	g_autoptr(GThread) thread = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_line_with_edges(chip, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	cancel = gpiod_test_create_wait_cancel_or_fail();
+
+	ret = gpiod_line_request_wait_edge_events_cancellable(request, 1000000,
+							      cancel);
+	g_assert_cmpint(ret, ==, 0);
+
+	thread = g_thread_new("trigger-cancel", trigger_cancel, cancel);
+	g_thread_ref(thread);
+
+	ret = gpiod_line_request_wait_edge_events_cancellable(request, -1,
+							      cancel);
+	g_thread_join(thread);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ECANCELED);
+
+	/* The object stays triggered until reset. */
+	ret = gpiod_line_request_wait_edge_events_cancellable(request, 0,
+							      cancel);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ECANCELED);
+
+	g_assert_cmpint(gpiod_wait_cancel_reset(cancel), ==, 0);
+
+	g_gpiosim_chip_set_pull(sim, 2, G_GPIOSIM_PULL_UP);
+
+	ret = gpiod_line_request_wait_edge_events_cancellable(request,
+							      1000000000,
+							      cancel);
+	g_assert_cmpint(ret, ==, 1);
+}
+
+GPIOD_TEST_CASE(cancel_info_event_wait)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_info) info = NULL;
+	g_autoptr(struct_gpiod_wait_cancel) cancel = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	cancel = gpiod_test_create_wait_cancel_or_fail();
+
+	info = gpiod_chip_watch_line_info(chip, 3);
+	g_assert_nonnull(info);
+	gpiod_test_return_if_failed();
+
+	ret = gpiod_chip_wait_info_event_cancellable(chip, 1000000, cancel);
+	g_assert_cmpint(ret, ==, 0);
+
+	g_assert_cmpint(gpiod_wait_cancel_trigger(cancel), ==, 0);
+
+	ret = gpiod_chip_wait_info_event_cancellable(chip, -1, cancel);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ECANCELED);
+}
+
+GPIOD_TEST_CASE(shared_between_waits)
+{
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 8, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) first = NULL;
+	g_autoptr(struct_gpiod_line_request) second = NULL;
+	g_autoptr(struct_gpiod_wait_cancel) cancel = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	first = request_line_with_edges(chip, 0);
+	second = request_line_with_edges(chip, 1);
+	g_assert_nonnull(first);
+	g_assert_nonnull(second);
+	gpiod_test_return_if_failed();
+
+	cancel = gpiod_test_create_wait_cancel_or_fail();
+	g_assert_cmpint(gpiod_wait_cancel_trigger(cancel), ==, 0);
+
+	ret = gpiod_line_request_wait_edge_events_cancellable(first, -1,
+							      cancel);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ECANCELED);
+
+	ret = gpiod_line_request_wait_edge_events_cancellable(second, -1,
+							      cancel);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(ECANCELED);
+}
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "waveform"
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, const guint *offsets,
+		     gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(default_settings)
+{
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	g_assert_cmpuint(gpiod_waveform_get_num_steps(waveform), ==, 0);
+	g_assert_cmpuint(gpiod_waveform_get_period_ns(waveform), ==, 0);
+	g_assert_cmpuint(gpiod_waveform_get_num_cycles(waveform), ==, 0);
+}
+
+GPIOD_TEST_CASE(steps_must_be_ordered)
+{
+	static const guint offsets[] = { 0 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	ret = gpiod_waveform_add_step(waveform, request, 1000, 0x1, 0x1);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_waveform_add_step(waveform, request, 1000, 0x1, 0x0);
+	g_assert_cmpint(ret, ==, 0);
+	ret = gpiod_waveform_add_step(waveform, request, 999, 0x1, 0x1);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_waveform_get_num_steps(waveform), ==, 2);
+}
+
+GPIOD_TEST_CASE(play_empty_waveform)
+{
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+	gint ret;
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	ret = gpiod_waveform_play(waveform);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(period_shorter_than_steps)
+{
+	static const guint offsets[] = { 0 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 2000000,
+						0x1, 0x1), ==, 0);
+	gpiod_waveform_set_period_ns(waveform, 1000000);
+
+	ret = gpiod_waveform_play(waveform);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+}
+
+GPIOD_TEST_CASE(play_once)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+	gint64 start;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 0,
+						0x3, 0x1), ==, 0);
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 20000000,
+						0x3, 0x2), ==, 0);
+
+	start = g_get_monotonic_time();
+
+	ret = gpiod_waveform_play(waveform);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	/* Microseconds. */
+	g_assert_cmpint(g_get_monotonic_time() - start, >=, 20000);
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+}
+
+struct step_counter {
+	guint num_steps;
+	guint64 last_cycle;
+	guint stop_after;
+};
+
+static int count_steps(size_t step G_GNUC_UNUSED, uint64_t cycle,
+		       int64_t lateness_ns, void *user_data)
+{
+	struct step_counter *counter = user_data;
+
+	g_assert_cmpint(lateness_ns, >=, 0);
+
+	counter->num_steps++;
+	counter->last_cycle = cycle;
+
+	return counter->stop_after && counter->num_steps == counter->stop_after;
+}
+
+GPIOD_TEST_CASE(play_num_cycles)
+{
+	static const guint offsets[] = { 2 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+	struct step_counter counter = { };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 0,
+						0x1, 0x1), ==, 0);
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 1000000,
+						0x1, 0x0), ==, 0);
+	gpiod_waveform_set_period_ns(waveform, 2000000);
+	gpiod_waveform_set_num_cycles(waveform, 3);
+	gpiod_waveform_set_step_callback(waveform, count_steps, &counter);
+
+	ret = gpiod_waveform_play(waveform);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(counter.num_steps, ==, 6);
+	g_assert_cmpuint(counter.last_cycle, ==, 2);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_INACTIVE);
+}
+
+GPIOD_TEST_CASE(stop_from_callback)
+{
+	static const guint offsets[] = { 2 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_waveform) waveform = NULL;
+	struct step_counter counter = { .stop_after = 5 };
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 1);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	waveform = gpiod_test_create_waveform_or_fail();
+
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 0,
+						0x1, 0x1), ==, 0);
+	g_assert_cmpint(gpiod_waveform_add_step(waveform, request, 500000,
+						0x1, 0x0), ==, 0);
+	gpiod_waveform_set_period_ns(waveform, 1000000);
+	gpiod_waveform_set_step_callback(waveform, count_steps, &counter);
+
+	ret = gpiod_waveform_play(waveform);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpuint(counter.num_steps, ==, 5);
+	g_assert_cmpuint(counter.last_cycle, ==, 2);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==,
+			GPIOD_LINE_VALUE_ACTIVE);
+}
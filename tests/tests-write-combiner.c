@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <glib.h>
+#include <gpiod.h>
+
+#include "gpiod-test.h"
+#include "gpiod-test-helpers.h"
+#include "gpiod-test-sim.h"
+
+#define GPIOD_TEST_GROUP "write-combiner"
+
+#define NUM_WRITERS 4
+
+struct writer {
+	struct gpiod_write_combiner *wc;
+	guint offset;
+	gint ret;
+};
+
+static gpointer write_line(gpointer data)
+{
+	struct writer *writer = data;
+
+	writer->ret = gpiod_write_combiner_set_value(writer->wc, writer->offset,
+						     GPIOD_LINE_VALUE_ACTIVE);
+
+	return NULL;
+}
+
+static struct gpiod_line_request *
+request_output_lines(struct gpiod_chip *chip, const guint *offsets,
+		     gsize num_offsets)
+{
+	g_autoptr(struct_gpiod_line_settings) settings = NULL;
+	g_autoptr(struct_gpiod_line_config) line_cfg = NULL;
+
+	settings = gpiod_line_settings_new();
+	line_cfg = gpiod_line_config_new();
+	g_assert_nonnull(settings);
+	g_assert_nonnull(line_cfg);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+	g_assert_cmpint(gpiod_line_config_add_line_settings(line_cfg, offsets,
+							     num_offsets,
+							     settings),
+			==, 0);
+
+	return gpiod_chip_request_lines(chip, NULL, line_cfg);
+}
+
+GPIOD_TEST_CASE(single_write_is_flushed_on_deadline)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_write_combiner) wc = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 4);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	wc = gpiod_test_create_write_combiner_or_fail(request, 1000, 0);
+
+	ret = gpiod_write_combiner_set_value(wc, 2, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==, 1);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 1), ==, 0);
+	g_assert_cmpuint(gpiod_write_combiner_get_num_writes(wc), ==, 1);
+	g_assert_cmpuint(gpiod_write_combiner_get_num_flushes(wc), ==, 1);
+}
+
+GPIOD_TEST_CASE(concurrent_writes_are_combined)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_write_combiner) wc = NULL;
+	struct writer writers[NUM_WRITERS];
+	GThread *threads[NUM_WRITERS];
+	guint i;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 4);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	/*
+	 * The deadline is far enough for the batch to only be flushed once all
+	 * writers joined it.
+	 */
+	wc = gpiod_test_create_write_combiner_or_fail(request, 10000000,
+						      NUM_WRITERS);
+
+	for (i = 0; i < NUM_WRITERS; i++) {
+		writers[i].wc = wc;
+		writers[i].offset = offsets[i];
+		writers[i].ret = -1;
+		threads[i] = g_thread_new("writer", write_line, &writers[i]);
+	}
+
+	for (i = 0; i < NUM_WRITERS; i++)
+		g_thread_join(threads[i]);
+
+	for (i = 0; i < NUM_WRITERS; i++) {
+		g_assert_cmpint(writers[i].ret, ==, 0);
+		g_assert_cmpint(g_gpiosim_chip_get_value(sim, offsets[i]), ==,
+				1);
+	}
+
+	g_assert_cmpuint(gpiod_write_combiner_get_num_writes(wc), ==,
+			 NUM_WRITERS);
+	g_assert_cmpuint(gpiod_write_combiner_get_num_flushes(wc), ==, 1);
+}
+
+GPIOD_TEST_CASE(set_values_mask)
+{
+	static const guint offsets[] = { 0, 1, 2, 3 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_write_combiner) wc = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 4);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	wc = gpiod_test_create_write_combiner_or_fail(request, 0, 0);
+
+	ret = gpiod_write_combiner_set_values_mask(wc, 0x5, 0x4);
+	g_assert_cmpint(ret, ==, 0);
+	gpiod_test_return_if_failed();
+
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 0), ==, 0);
+	g_assert_cmpint(g_gpiosim_chip_get_value(sim, 2), ==, 1);
+
+	/* Empty writes don't reach the kernel. */
+	ret = gpiod_write_combiner_set_values_mask(wc, 0, 0);
+	g_assert_cmpint(ret, ==, 0);
+	g_assert_cmpuint(gpiod_write_combiner_get_num_flushes(wc), ==, 1);
+}
+
+GPIOD_TEST_CASE(invalid_lines)
+{
+	static const guint offsets[] = { 0, 1 };
+
+	g_autoptr(GPIOSimChip) sim = g_gpiosim_chip_new("num-lines", 4, NULL);
+	g_autoptr(struct_gpiod_chip) chip = NULL;
+	g_autoptr(struct_gpiod_line_request) request = NULL;
+	g_autoptr(struct_gpiod_write_combiner) wc = NULL;
+	gint ret;
+
+	chip = gpiod_test_open_chip_or_fail(g_gpiosim_chip_get_dev_path(sim));
+	request = request_output_lines(chip, offsets, 2);
+	g_assert_nonnull(request);
+	gpiod_test_return_if_failed();
+
+	wc = gpiod_test_create_write_combiner_or_fail(request, 0, 0);
+
+	ret = gpiod_write_combiner_set_value(wc, 3, GPIOD_LINE_VALUE_ACTIVE);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	ret = gpiod_write_combiner_set_values_mask(wc, 0x4, 0x4);
+	g_assert_cmpint(ret, ==, -1);
+	gpiod_test_expect_errno(EINVAL);
+
+	g_assert_cmpuint(gpiod_write_combiner_get_num_writes(wc), ==, 0);
+	g_assert_null(gpiod_write_combiner_new(NULL, 0, 0));
+	gpiod_test_expect_errno(EINVAL);
+}
@@ -1126,6 +1126,15 @@ request_release_line() {
 	status_is 1
 }
 
+@test "gpioget: with invalid real-time priority" {
+	gpiosim_chip sim0 num_lines=8
+
+	run_tool gpioget --realtime=0 --chip ${GPIOSIM_CHIP_NAME[sim0]} 0 1
+
+	output_regex_match ".*real-time priority must be positive"
+	status_is 1
+}
+
 @test "gpioget: with invalid hold-period" {
 	gpiosim_chip sim0 num_lines=8
 
@@ -1135,6 +1144,95 @@ request_release_line() {
 	status_is 1
 }
 
+@test "gpioget: with line name cache" {
+	gpiosim_chip sim0 num_lines=8 line_name=3:foo
+	gpiosim_chip sim1 num_lines=4 line_name=1:bar
+
+	local cache=$(mktemp -u)
+
+	gpiosim_set_pull sim0 3 pull-up
+
+	GPIOD_NAME_CACHE=$cache run_tool gpioget foo bar
+
+	status_is 0
+	output_is "\"foo\"=active \"bar\"=inactive"
+
+	run grep -c "^line 3 foo$" $cache
+	output_is "1"
+
+	# resolved from the cache
+	GPIOD_NAME_CACHE=$cache run_tool gpioget foo bar
+
+	status_is 0
+	output_is "\"foo\"=active \"bar\"=inactive"
+
+	# stale entries are detected when reading the line info
+	sed -i "s/^line 3 foo$/line 2 foo/" $cache
+	GPIOD_NAME_CACHE=$cache run_tool gpioget foo
+
+	status_is 0
+	output_is "\"foo\"=active"
+
+	run grep -c "^line 3 foo$" $cache
+	output_is "1"
+
+	rm -f $cache
+}
+
+@test "gpioget: with sample rate" {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	gpiosim_set_pull sim0 1 pull-up
+
+	run_tool gpioget --sample-rate=100 --count=3 --chip $sim0 foo 2
+
+	status_is 0
+	output_is "\"foo\"=active \"2\"=inactive
+\"foo\"=active \"2\"=inactive
+\"foo\"=active \"2\"=inactive"
+}
+
+@test "gpioget: with sample rate and binary output" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	gpiosim_set_pull sim0 3 pull-up
+
+	dut_run_redirect gpioget --sample-rate=1000 --count=2 --binary \
+		--chip $sim0 2 3
+
+	dut_wait
+	status_is 0
+
+	# two 16-byte records: timestamp and a bitmap of the values
+	# (decoded with host endianness, the test assumes a little-endian host)
+	output=$(od -An -v -tu8 -w16 $DUT_OUTPUT)
+	local ORIG_IFS="$IFS"
+	IFS=$'\n' lines=($output)
+	IFS="$ORIG_IFS"
+
+	regex_matches "^ *[0-9]+ +2$" "${lines[0]}"
+	regex_matches "^ *[0-9]+ +2$" "${lines[1]}"
+	num_lines_is 2
+}
+
+@test "gpioget: with count but no sample rate" {
+	run_tool gpioget --count=3 --chip foo 0
+
+	output_regex_match ".*--binary and --count require --sample-rate"
+	status_is 1
+}
+
+@test "gpioget: with invalid sample rate" {
+	run_tool gpioget --sample-rate=0 --chip foo 0
+
+	output_regex_match ".*sample rate must be positive"
+	status_is 1
+}
+
 #
 # gpioset test cases
 #
@@ -1784,6 +1882,65 @@ request_release_line() {
 	status_is 1
 }
 
+@test "gpioset: with script" {
+	gpiosim_chip sim0 num_lines=8 line_name=3:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_tool gpioset --script --chip $sim0 1=0 foo=0 < <(printf '%s\n' \
+		"# comment" \
+		"set 1=1" \
+		"" \
+		"toggle foo" \
+		"get" \
+		"sleep 10ms" \
+		"toggle" \
+		"get foo" \
+		"set \"foo\"=active 1=off" \
+		"get 1 foo" \
+		"exit" \
+		"set 1=bad")
+
+	status_is 0
+	num_lines_is 3
+	output_regex_match "\"1\"=active \"foo\"=active"
+	output_regex_match "\"foo\"=inactive"
+	output_regex_match "\"1\"=inactive \"foo\"=active"
+}
+
+@test "gpioset: with script and unknown command" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_tool gpioset --script --chip $sim0 1=0 < <(printf 'set 1=1\nfoo\n')
+
+	output_regex_match ".*line 2: unknown command: 'foo'"
+	status_is 1
+}
+
+@test "gpioset: with script and unknown line" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_tool gpioset --script --chip $sim0 1=0 < <(printf 'toggle 2\n')
+
+	output_regex_match ".*line 1: unknown line: '2'"
+	status_is 1
+}
+
+@test "gpioset: with script and toggle" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_tool gpioset --script --toggle 1s --chip $sim0 0=1
+
+	output_regex_match ".*can't combine script with toggle or daemonize"
+	status_is 1
+}
+
 @test "gpioset: with nonexistent line" {
 	run_tool gpioset nonexistent-line=0
 
@@ -2072,6 +2229,146 @@ request_release_line() {
 	num_lines_is 4
 }
 
+@test "gpiomon: with latency" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	# redirect, as gpiomon exits after 2 events
+	dut_run_redirect gpiomon --latency --num-events=2 --chip $sim0 4
+
+	gpiosim_set_pull sim0 4 pull-up
+	gpiosim_set_pull sim0 4 pull-down
+
+	dut_wait
+	status_is 0
+	dut_read_redirect
+
+	regex_matches "[0-9]+\.[0-9]+\\s+rising\\s+$sim0 4" "${lines[0]}"
+	regex_matches "[0-9]+\.[0-9]+\\s+falling\\s+$sim0 4" "${lines[1]}"
+	regex_matches "$sim0 4\\s+samples=2 min=[0-9]+ p50=[0-9]+ p90=[0-9]+ p99=[0-9]+ p99.9=[0-9]+ max=[0-9]+ \\(ns\\)" \
+		"${lines[2]}"
+	num_lines_is 3
+}
+
+@test "gpiomon: with binary output" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	# redirect, as gpiomon exits after 2 events
+	dut_run_redirect gpiomon --binary --num-events=2 --chip $sim0 4
+
+	gpiosim_set_pull sim0 4 pull-up
+	gpiosim_set_pull sim0 4 pull-down
+
+	dut_wait
+	status_is 0
+
+	# two 32-byte records: timestamp, chip, offset, type, seqnos, reserved
+	# (decoded with host endianness, the test assumes a little-endian host)
+	output=$(od -An -v -tu4 -w32 $DUT_OUTPUT)
+	local ORIG_IFS="$IFS"
+	IFS=$'\n' lines=($output)
+	IFS="$ORIG_IFS"
+
+	regex_matches "^ *[0-9]+ +[0-9]+ +0 +4 +1 +1 +1 +0$" "${lines[0]}"
+	regex_matches "^ *[0-9]+ +[0-9]+ +0 +4 +2 +2 +2 +0$" "${lines[1]}"
+	num_lines_is 2
+}
+
+@test "gpiomon: with binary output and format" {
+	run_tool gpiomon --binary --format=%o --chip foo 4
+
+	status_is 1
+	output_regex_match ".*--binary can't be combined with --banner, --format or --latency"
+}
+
+@test "gpiomon: with capture file" {
+	gpiosim_chip sim0 num_lines=8 line_name=4:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local capture=$(mktemp)
+
+	dut_run_redirect gpiomon --capture=$capture --size=4 --quiet \
+		--num-events=6 --chip $sim0 4
+
+	for i in 1 2 3
+	do
+		gpiosim_set_pull sim0 4 pull-up
+		gpiosim_set_pull sim0 4 pull-down
+	done
+
+	dut_wait
+	status_is 0
+
+	run head -c 7 $capture
+	output_is "GPIOCAP"
+
+	# capacity and head
+	run od -An -tu8 -j16 -N16 $capture
+	regex_matches "^ *4 +6$" "$output"
+
+	# version and event clock
+	run od -An -tu4 -j8 -N4 $capture
+	regex_matches "^ *2$" "$output"
+	run od -An -tu4 -j56 -N4 $capture
+	regex_matches "^ *1$" "$output"
+
+	rm -f $capture
+}
+
+@test "gpiomon: with statistics" {
+	gpiosim_chip sim0 num_lines=8 line_name=4:foo
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	# the period is longer than the test, only the summary on exit is printed
+	dut_run_redirect gpiomon --stats=10s --num-events=4 --chip $sim0 4 5
+
+	gpiosim_set_pull sim0 4 pull-up
+	gpiosim_set_pull sim0 4 pull-down
+	gpiosim_set_pull sim0 4 pull-up
+	gpiosim_set_pull sim0 4 pull-down
+
+	dut_wait
+	status_is 0
+	dut_read_redirect
+
+	regex_matches \
+"[0-9]+\.[0-9]+[[:space:]]$sim0 4 \"foo\"[[:space:]]rising=2 falling=2 rate=[0-9.]+ min=[1-9][0-9]* max=[1-9][0-9]* dropped=0" \
+		"${lines[0]}"
+	regex_matches \
+"[0-9]+\.[0-9]+[[:space:]]$sim0 5[[:space:]]rising=0 falling=0 rate=0.0 min=0 max=0 dropped=0" \
+		"${lines[1]}"
+	num_lines_is 2
+}
+
+@test "gpiomon: with statistics and binary output" {
+	run_tool gpiomon --stats --binary --chip foo 4
+
+	status_is 1
+	output_regex_match ".*--stats can't be combined with --binary or --format"
+}
+
+@test "gpiomon: jitter with event clock" {
+	run_tool gpiomon --jitter --event-clock=hte --chip foo 4 5
+
+	status_is 1
+	output_regex_match ".*--jitter can't be combined with --binary, --capture, --event-clock, --format or --stats"
+}
+
+@test "gpiomon: jitter with a single line" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	run_tool gpiomon --jitter --chip $sim0 4
+
+	status_is 1
+	output_regex_match ".*--jitter requires exactly two lines"
+}
+
 @test "gpiomon: multiple lines" {
 	gpiosim_chip sim0 num_lines=8
 
@@ -2125,6 +2422,24 @@ request_release_line() {
 	assert_fail dut_readable
 }
 
+@test "gpiomon: multiple chips with reorder window" {
+	gpiosim_chip sim0 num_lines=4 line_name=1:foo
+	gpiosim_chip sim1 num_lines=8 line_name=0:baz
+
+	dut_run gpiomon --banner --reorder-window=100ms --format=%l-%E foo baz
+	dut_regex_match "Monitoring lines .*"
+
+	gpiosim_set_pull sim1 0 pull-up
+	gpiosim_set_pull sim0 1 pull-up
+	gpiosim_set_pull sim1 0 pull-down
+
+	dut_regex_match "baz-rising"
+	dut_regex_match "foo-rising"
+	dut_regex_match "baz-falling"
+
+	assert_fail dut_readable
+}
+
 @test "gpiomon: exit after SIGINT" {
 	gpiosim_chip sim0 num_lines=8
 
@@ -2947,3 +3262,294 @@ request_release_line() {
 	dut_read
 	output_is "%x"
 }
+
+@test "gpionotify: with coalesce" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+
+	dut_run gpionotify --banner --coalesce=200ms "--format=%E %o %n" \
+		-c $sim0 3 4
+	dut_flush
+
+	# Requested and released within the window - nothing to report.
+	request_release_line $sim0 3
+	request_release_line $sim0 3
+
+	$BATS_TEST_DIRNAME/gpioset -c $sim0 4=1 &
+	local setpid=$!
+
+	sleep 0.4
+	dut_read
+	output_is "requested 4 1"
+
+	kill $setpid
+	wait $setpid || true
+
+	sleep 0.4
+	dut_read
+	output_is "released 4 1"
+}
+
+@test "gpionotify: with invalid coalesce period" {
+	gpiosim_chip sim0 num_lines=8
+
+	run_tool gpionotify --coalesce=0 -c ${GPIOSIM_CHIP_NAME[sim0]} 4
+
+	output_regex_match ".*coalescing period must be positive"
+	status_is 1
+}
+
+#
+# gpioreplay test cases
+#
+
+@test "gpioreplay: binary records" {
+	gpiosim_chip sim0 num_lines=8
+	gpiosim_chip sim1 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local sim1=${GPIOSIM_CHIP_NAME[sim1]}
+	local records=$(mktemp)
+
+	dut_run_redirect gpiomon --binary --num-events=2 --chip $sim0 4
+
+	gpiosim_set_pull sim0 4 pull-up
+	gpiosim_set_pull sim0 4 pull-down
+
+	dut_wait
+	status_is 0
+	cp $DUT_OUTPUT $records
+
+	run_tool gpioreplay --chip $sim1 $records 4=2
+
+	status_is 0
+	output_regex_match \
+"steps=2 min=-?[0-9]+ p50=-?[0-9]+ p90=-?[0-9]+ p99=-?[0-9]+ p99.9=-?[0-9]+ max=-?[0-9]+ \\(ns\\)"
+	num_lines_is 1
+
+	rm -f $records
+}
+
+@test "gpioreplay: from wrapped capture file by line name" {
+	gpiosim_chip sim0 num_lines=8 line_name=4:foo
+	gpiosim_chip sim1 num_lines=8 line_name=3:bar
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local capture=$(mktemp)
+
+	dut_run_redirect gpiomon --capture=$capture --size=4 --quiet \
+		--num-events=6 --chip $sim0 4
+
+	for i in 1 2 3
+	do
+		gpiosim_set_pull sim0 4 pull-up
+		gpiosim_set_pull sim0 4 pull-down
+	done
+
+	dut_wait
+	status_is 0
+
+	# only the last four events are left in the ring
+	run_tool gpioreplay $capture foo=bar
+
+	status_is 0
+	output_regex_match "steps=4 .* \\(ns\\)"
+
+	rm -f $capture
+}
+
+@test "gpioreplay: quiet" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local records=$(mktemp)
+
+	dut_run_redirect gpiomon --binary --num-events=1 --chip $sim0 4
+
+	gpiosim_set_pull sim0 4 pull-up
+
+	dut_wait
+	status_is 0
+	cp $DUT_OUTPUT $records
+
+	run_tool gpioreplay --quiet --chip $sim0 $records 0:4=5
+
+	status_is 0
+	output_is ""
+
+	rm -f $records
+}
+
+@test "gpioreplay: no events for mapped lines" {
+	gpiosim_chip sim0 num_lines=8
+
+	local sim0=${GPIOSIM_CHIP_NAME[sim0]}
+	local records=$(mktemp)
+
+	dut_run_redirect gpiomon --binary --num-events=1 --chip $sim0 4
+
+	gpiosim_set_pull sim0 4 pull-up
+
+	dut_wait
+	status_is 0
+	cp $DUT_OUTPUT $records
+
+	run_tool gpioreplay --chip $sim0 $records 1:4=5
+
+	status_is 1
+	output_regex_match ".*no events recorded for the mapped lines"
+
+	rm -f $records
+}
+
+@test "gpioreplay: invalid mapping" {
+	local records=$(mktemp)
+
+	head -c 32 /dev/zero > $records
+
+	run_tool gpioreplay $records 4
+
+	status_is 1
+	output_regex_match ".*invalid mapping: 4"
+
+	rm -f $records
+}
+
+@test "gpioreplay: not a recording" {
+	local records=$(mktemp)
+
+	echo foobar > $records
+
+	run_tool gpioreplay $records 4=5
+
+	status_is 1
+	output_regex_match ".*is neither a capture file nor a stream of binary records"
+
+	rm -f $records
+}
+
+@test "gpioreplay: without mappings" {
+	run_tool gpioreplay foo
+
+	status_is 1
+	output_regex_match ".*at least one line mapping must be specified"
+}
+
+#
+# gpiodaemon and gpioclient test cases
+#
+
+@test "gpiodaemon: serve inputs and outputs" {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+	local sock=$BATS_TMPDIR/gpiodaemon.sock
+
+	gpiosim_set_pull sim0 1 pull-up
+
+	dut_run gpiodaemon --banner --socket=$sock foo bar=1
+	dut_regex_match "Serving 2 lines on $sock"
+
+	gpiosim_check_value sim0 4 1
+
+	run_tool gpioclient --socket=$sock get foo bar
+	output_is "\"foo\"=active \"bar\"=active"
+	status_is 0
+
+	run_tool gpioclient --socket=$sock set bar=0
+	status_is 0
+	gpiosim_check_value sim0 4 0
+
+	run_tool gpioclient --socket=$sock --numeric get bar foo
+	output_is "0 1"
+	status_is 0
+
+	run_tool gpioclient --socket=$sock set foo=1
+	output_regex_match ".*unable to set the values: Operation not permitted"
+	status_is 1
+
+	run_tool gpioclient --socket=$sock get baz
+	output_regex_match ".*cannot find line 'baz'"
+	status_is 1
+}
+
+@test "gpiodaemon: value page" {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+	local sock=$BATS_TMPDIR/gpiodaemon.sock
+	local page=$BATS_TMPDIR/gpiodaemon.page
+
+	dut_run gpiodaemon --banner --socket=$sock --page=$page foo bar=0
+	dut_regex_match "Serving 2 lines on $sock"
+
+	run_tool gpioclient --page=$page get foo bar
+	output_is "\"foo\"=inactive \"bar\"=inactive"
+	status_is 0
+
+	# Inputs are kept current using edge detection.
+	gpiosim_set_pull sim0 1 pull-up
+	sleep 0.1
+
+	run_tool gpioclient --socket=$sock set bar=1
+	status_is 0
+
+	run_tool gpioclient --page=$page --unquoted get foo bar
+	output_is "foo=active bar=active"
+	status_is 0
+
+	dut_kill
+	dut_wait
+
+	test ! -e $page
+	test ! -e $sock
+}
+
+@test "gpiodaemon: monitor through the daemon" {
+	gpiosim_chip sim0 num_lines=8 line_name=1:foo line_name=4:bar
+	local sock=$BATS_TMPDIR/gpiodaemon.sock
+
+	dut_run gpiodaemon --banner --socket=$sock foo bar=1
+	dut_regex_match "Serving 2 lines on $sock"
+
+	run_tool gpioclient --socket=$sock monitor bar
+	output_regex_match ".*unable to subscribe: Operation not permitted"
+	status_is 1
+
+	(sleep 0.2 && gpiosim_set_pull sim0 1 pull-up &&
+	 sleep 0.1 && gpiosim_set_pull sim0 1 pull-down) > /dev/null 2>&1 &
+
+	run_tool gpioclient --socket=$sock --num-events=2 monitor foo
+	output_regex_match \
+"[0-9]+\.[0-9]+\s+rising\s+\"foo\"
+[0-9]+\.[0-9]+\s+falling\s+\"foo\""
+	status_is 0
+
+	(sleep 0.2 && gpiosim_set_pull sim0 1 pull-up &&
+	 sleep 0.1 && gpiosim_set_pull sim0 1 pull-down &&
+	 sleep 0.1 && gpiosim_set_pull sim0 1 pull-up) > /dev/null 2>&1 &
+
+	run_tool gpioclient --socket=$sock --edges=falling --num-events=1 \
+		monitor foo
+	output_regex_match "[0-9]+\.[0-9]+\s+falling\s+\"foo\""
+	status_is 0
+	wait
+}
+
+@test "gpioclient: monitor with invalid rate limit" {
+	run_tool gpioclient --rate-limit=0 monitor foo
+
+	output_regex_match ".*rate limit period must be positive"
+	status_is 1
+}
+
+@test "gpioclient: without daemon" {
+	run_tool gpioclient --socket=$BATS_TMPDIR/nonexistent.sock get foo
+
+	output_regex_match ".*unable to connect to .*"
+	status_is 1
+}
+
+@test "gpioclient: with unknown command" {
+	run_tool gpioclient foo bar
+
+	output_regex_match ".*unknown command: 'foo'"
+	status_is 1
+}
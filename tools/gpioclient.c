@@ -0,0 +1,531 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <gpiod.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "gpiodaemon.h"
+#include "tools-common.h"
+
+struct config {
+	bool numeric;
+	bool unquoted;
+	uint8_t edges;
+	uint8_t mode;
+	unsigned int interval_us;
+	int events_wanted;
+	const char *socket_path;
+	const char *page_path;
+};
+
+static void print_help(void)
+{
+	printf("Usage: %s [OPTIONS] <command> <args>...\n", get_progname());
+	printf("\n");
+	printf("Get and set values of GPIO lines held by gpiodaemon.\n");
+	printf("\n");
+	printf("Lines are specified as given on the command line of the daemon.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("      --coalesce\tonly report the latest event of each line of every\n");
+	printf("\t\t\tbatch the daemon reads (monitor only)\n");
+	printf("  -e, --edges <edges>\tspecify the edges to monitor\n");
+	printf("\t\t\tPossible values: 'falling', 'rising', 'both'.\n");
+	printf("\t\t\t(default is 'both')\n");
+	printf("  -h, --help\t\tdisplay this help and exit\n");
+	printf("  -m, --page <path>\tread the values from the daemon's value page instead\n");
+	printf("\t\t\tof asking the daemon (get only)\n");
+	printf("  -n, --num-events <num>\n");
+	printf("\t\t\texit after receiving num events (monitor only)\n");
+	printf("      --numeric\t\tdisplay line values as '0' (inactive) or '1' (active)\n");
+	printf("  -r, --rate-limit <period>\n");
+	printf("\t\t\treport the latest event of each line at most once per\n");
+	printf("\t\t\tperiod (monitor only)\n");
+	printf("  -S, --socket <path>\tconnect to the given unix socket\n");
+	printf("\t\t\t(default is '%s')\n", GPIODAEMON_DEFAULT_SOCKET);
+	printf("      --unquoted\tdon't quote line names\n");
+	printf("  -v, --version\t\toutput version information and exit\n");
+	printf("\n");
+	printf("Commands:\n");
+	printf("  get <line>...\t\tprint the values of the lines\n");
+	printf("  set <line=value>...\tset the values of the output lines, all at once\n");
+	printf("  monitor <line>...\twait for edge events on the input lines\n");
+	print_period_help();
+	printf("\n");
+	printf("Monitoring:\n");
+	printf("  The daemon filters the events it reads for every client and sends them in\n");
+	printf("  batches. Events a client doesn't read fast enough are dropped by the daemon\n");
+	printf("  and their number is reported.\n");
+}
+
+static uint8_t parse_edges_or_die(const char *option)
+{
+	if (strcmp(option, "rising") == 0)
+		return GPIODAEMON_EDGE_RISING;
+	if (strcmp(option, "falling") == 0)
+		return GPIODAEMON_EDGE_FALLING;
+	if (strcmp(option, "both") != 0)
+		die("invalid edges: %s", option);
+
+	return GPIODAEMON_EDGE_RISING | GPIODAEMON_EDGE_FALLING;
+}
+
+static int parse_config(int argc, char **argv, struct config *cfg)
+{
+	static const struct option longopts[] = {
+		{ "coalesce",	no_argument,		NULL,	'L' },
+		{ "edges",	required_argument,	NULL,	'e' },
+		{ "help",	no_argument,		NULL,	'h' },
+		{ "num-events",	required_argument,	NULL,	'n' },
+		{ "numeric",	no_argument,		NULL,	'N' },
+		{ "page",	required_argument,	NULL,	'm' },
+		{ "rate-limit",	required_argument,	NULL,	'r' },
+		{ "socket",	required_argument,	NULL,	'S' },
+		{ "unquoted",	no_argument,		NULL,	'Q' },
+		{ "version",	no_argument,		NULL,	'v' },
+		{ GETOPT_NULL_LONGOPT },
+	};
+
+	static const char *const shortopts = "+e:hm:n:r:S:v";
+
+	int opti, optc;
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->edges = GPIODAEMON_EDGE_RISING | GPIODAEMON_EDGE_FALLING;
+	cfg->socket_path = GPIODAEMON_DEFAULT_SOCKET;
+
+	for (;;) {
+		optc = getopt_long(argc, argv, shortopts, longopts, &opti);
+		if (optc < 0)
+			break;
+
+		switch (optc) {
+		case 'e':
+			cfg->edges = parse_edges_or_die(optarg);
+			break;
+		case 'L':
+			cfg->mode = GPIODAEMON_DELIVER_COALESCED;
+			break;
+		case 'm':
+			cfg->page_path = optarg;
+			break;
+		case 'n':
+			cfg->events_wanted = parse_uint_or_die(optarg);
+			break;
+		case 'r':
+			cfg->mode = GPIODAEMON_DELIVER_RATE_LIMITED;
+			cfg->interval_us = parse_period_or_die(optarg);
+			if (!cfg->interval_us)
+				die("rate limit period must be positive");
+			break;
+		case 'N':
+			cfg->numeric = true;
+			break;
+		case 'Q':
+			cfg->unquoted = true;
+			break;
+		case 'S':
+			cfg->socket_path = optarg;
+			break;
+		case 'h':
+			print_help();
+			exit(EXIT_SUCCESS);
+		case 'v':
+			print_version();
+			exit(EXIT_SUCCESS);
+		case '?':
+			die("try %s --help", get_progname());
+		case 0:
+			break;
+		default:
+			abort();
+		}
+	}
+
+	return optind;
+}
+
+static int connect_or_die(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path))
+		die("socket path too long: %s", path);
+	strcpy(addr.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		die_perror("unable to create the socket");
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)))
+		die_perror("unable to connect to %s", path);
+
+	return fd;
+}
+
+/*
+ * Send a command and wait for its reply. Returns the reply payload, which is
+ * valid until the next call.
+ */
+static void *transact_or_die(int fd, uint16_t cmd_id, unsigned int num,
+			     const void *payload, size_t len,
+			     const char *errmsg)
+{
+	static uint32_t msg[GPIODAEMON_MAX_MSG_SIZE / 4];
+	struct gpiodaemon_reply *reply = (struct gpiodaemon_reply *)msg;
+	struct gpiodaemon_cmd *cmd = (struct gpiodaemon_cmd *)msg;
+	ssize_t rd;
+
+	if (sizeof(*cmd) + len > sizeof(msg))
+		die("too many lines given");
+
+	cmd->cmd = cmd_id;
+	cmd->num = num;
+	memcpy(cmd + 1, payload, len);
+
+	if (send(fd, msg, sizeof(*cmd) + len, MSG_NOSIGNAL) < 0)
+		die_perror("unable to send the command");
+
+	rd = recv(fd, msg, sizeof(msg), 0);
+	if (rd < 0)
+		die_perror("unable to read the reply");
+	if ((size_t)rd < sizeof(*reply))
+		die("daemon closed the connection");
+
+	if (reply->status) {
+		errno = -reply->status;
+		die_perror("%s", errmsg);
+	}
+
+	return reply + 1;
+}
+
+static void lookup_lines_or_die(int fd, int num_lines, char **lines,
+				uint16_t *indices)
+{
+	char names[GPIODAEMON_MAX_MSG_SIZE] = { 0 };
+	size_t len = 0, name_len;
+	uint16_t *found;
+	int i;
+
+	if (num_lines > GPIODAEMON_MAX_LINES)
+		die("too many lines given");
+
+	for (i = 0; i < num_lines; i++) {
+		name_len = strlen(lines[i]) + 1;
+		if (len + name_len > sizeof(names))
+			die("too many lines given");
+
+		memcpy(names + len, lines[i], name_len);
+		len += name_len;
+	}
+
+	found = transact_or_die(fd, GPIODAEMON_CMD_LOOKUP, num_lines, names,
+				len, "unable to look up the lines");
+
+	for (i = 0; i < num_lines; i++) {
+		if (found[i] == GPIODAEMON_NO_LINE)
+			die("cannot find line '%s'", lines[i]);
+
+		indices[i] = found[i];
+	}
+}
+
+static struct gpiodaemon_page *map_page_or_die(const char *path, size_t *size)
+{
+	struct gpiodaemon_page *page;
+	struct stat st;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		die_perror("unable to open the value page %s", path);
+
+	if (fstat(fd, &st))
+		die_perror("unable to stat the value page");
+
+	if ((size_t)st.st_size < sizeof(*page))
+		die("%s is not a value page", path);
+
+	page = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (page == MAP_FAILED)
+		die_perror("unable to map the value page");
+
+	close(fd);
+
+	if (page->magic != GPIODAEMON_PAGE_MAGIC ||
+	    page->version != GPIODAEMON_PAGE_VERSION ||
+	    (size_t)st.st_size < sizeof(*page) +
+				 page->num_lines * sizeof(*page->lines))
+		die("%s is not a value page", path);
+
+	*size = st.st_size;
+
+	return page;
+}
+
+static void get_from_page_or_die(struct config *cfg, int num_lines,
+				 char **lines, uint8_t *values)
+{
+	struct gpiodaemon_page *page;
+	unsigned int *indices, j;
+	uint32_t seq;
+	size_t size;
+	int i;
+
+	page = map_page_or_die(cfg->page_path, &size);
+
+	indices = calloc(num_lines, sizeof(*indices));
+	if (!indices)
+		die("out of memory");
+
+	/* The names never change, only the values need the sequence. */
+	for (i = 0; i < num_lines; i++) {
+		for (j = 0; j < page->num_lines; j++) {
+			if (strncmp(page->lines[j].name, lines[i],
+				    GPIODAEMON_PAGE_NAME_SIZE - 1) == 0)
+				break;
+		}
+
+		if (j == page->num_lines)
+			die("cannot find line '%s'", lines[i]);
+
+		indices[i] = j;
+	}
+
+	do {
+		do {
+			seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+		} while (seq & 1);
+
+		for (i = 0; i < num_lines; i++)
+			values[i] = __atomic_load_n(
+					&page->lines[indices[i]].value,
+					__ATOMIC_RELAXED);
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) != seq);
+
+	free(indices);
+	munmap(page, size);
+}
+
+static void print_values(struct config *cfg, int num_lines, char **lines,
+			 uint8_t *values)
+{
+	const char *fmt = cfg->unquoted ? "%s=%s" : "\"%s\"=%s";
+	int i;
+
+	for (i = 0; i < num_lines; i++) {
+		if (cfg->numeric)
+			printf("%d", values[i]);
+		else
+			printf(fmt, lines[i],
+			       values[i] ? "active" : "inactive");
+
+		if (i != num_lines - 1)
+			printf(" ");
+	}
+	printf("\n");
+}
+
+static void cmd_get(struct config *cfg, int num_lines, char **lines)
+{
+	uint16_t *indices;
+	uint8_t *values;
+	int fd;
+
+	values = calloc(num_lines, sizeof(*values));
+	indices = calloc(num_lines, sizeof(*indices));
+	if (!values || !indices)
+		die("out of memory");
+
+	if (cfg->page_path) {
+		get_from_page_or_die(cfg, num_lines, lines, values);
+	} else {
+		fd = connect_or_die(cfg->socket_path);
+		lookup_lines_or_die(fd, num_lines, lines, indices);
+		memcpy(values,
+		       transact_or_die(fd, GPIODAEMON_CMD_GET, num_lines,
+				       indices, num_lines * sizeof(*indices),
+				       "unable to get the values"),
+		       num_lines);
+		close(fd);
+	}
+
+	print_values(cfg, num_lines, lines, values);
+
+	free(indices);
+	free(values);
+}
+
+static void cmd_set(struct config *cfg, int num_lines, char **args)
+{
+	struct gpiodaemon_set *sets;
+	enum gpiod_line_value value;
+	uint16_t *indices;
+	char *sep;
+	int fd, i;
+
+	if (cfg->page_path)
+		die("the value page is read-only");
+
+	sets = calloc(num_lines, sizeof(*sets));
+	indices = calloc(num_lines, sizeof(*indices));
+	if (!sets || !indices)
+		die("out of memory");
+
+	for (i = 0; i < num_lines; i++) {
+		sep = strrchr(args[i], '=');
+		if (!sep)
+			die("invalid line value: '%s'", args[i]);
+
+		*sep = '\0';
+		value = parse_line_value(sep + 1);
+		if (value == GPIOD_LINE_VALUE_ERROR)
+			die("invalid line value: '%s'", sep + 1);
+
+		sets[i].value = value;
+	}
+
+	fd = connect_or_die(cfg->socket_path);
+	lookup_lines_or_die(fd, num_lines, args, indices);
+
+	for (i = 0; i < num_lines; i++)
+		sets[i].line = indices[i];
+
+	transact_or_die(fd, GPIODAEMON_CMD_SET, num_lines, sets,
+			num_lines * sizeof(*sets),
+			"unable to set the values");
+	close(fd);
+
+	free(indices);
+	free(sets);
+}
+
+static int line_position(const uint16_t *indices, int num_lines,
+			 unsigned int index)
+{
+	int i;
+
+	for (i = 0; i < num_lines; i++) {
+		if (indices[i] == index)
+			return i;
+	}
+
+	die("daemon sent an event for an unknown line");
+}
+
+static void cmd_monitor(struct config *cfg, int num_lines, char **lines)
+{
+	uint32_t msg[GPIODAEMON_MAX_MSG_SIZE / 4];
+	struct gpiodaemon_subscribe *sub;
+	struct gpiodaemon_events *hdr;
+	struct gpiodaemon_event *event;
+	int fd, events_done = 0;
+	uint16_t *indices;
+	unsigned int i;
+	ssize_t rd;
+
+	if (cfg->page_path)
+		die("the value page doesn't carry events");
+
+	indices = calloc(num_lines, sizeof(*indices));
+	if (!indices)
+		die("out of memory");
+
+	fd = connect_or_die(cfg->socket_path);
+	lookup_lines_or_die(fd, num_lines, lines, indices);
+
+	sub = (struct gpiodaemon_subscribe *)msg;
+	memset(sub, 0, sizeof(*sub));
+	sub->edges = cfg->edges;
+	sub->mode = cfg->mode;
+	sub->interval_us = cfg->interval_us;
+	memcpy(sub + 1, indices, num_lines * sizeof(*indices));
+
+	transact_or_die(fd, GPIODAEMON_CMD_SUBSCRIBE, num_lines, msg,
+			sizeof(*sub) + num_lines * sizeof(*indices),
+			"unable to subscribe");
+
+	hdr = (struct gpiodaemon_events *)msg;
+	event = (struct gpiodaemon_event *)(hdr + 1);
+
+	for (;;) {
+		fflush(stdout);
+
+		rd = recv(fd, msg, sizeof(msg), 0);
+		if (rd < 0)
+			die_perror("error reading events");
+		if ((size_t)rd < sizeof(*hdr) ||
+		    (size_t)rd < sizeof(*hdr) + hdr->num * sizeof(*event))
+			die("daemon closed the connection");
+
+		if (hdr->dropped)
+			print_error("%" PRIu32 " events dropped", hdr->dropped);
+
+		for (i = 0; i < hdr->num; i++) {
+			print_event_time(event[i].timestamp_ns, 0);
+			fputs(event[i].edge == GPIODAEMON_EDGE_RISING ?
+					"\trising\t" : "\tfalling\t", stdout);
+			printf(cfg->unquoted ? "%s\n" : "\"%s\"\n",
+			       lines[line_position(indices, num_lines,
+						   event[i].line)]);
+
+			events_done++;
+			if (cfg->events_wanted &&
+			    events_done >= cfg->events_wanted)
+				goto out;
+		}
+	}
+
+out:
+	close(fd);
+	free(indices);
+}
+
+int main(int argc, char **argv)
+{
+	struct config cfg;
+	const char *cmd;
+	int i;
+
+	i = parse_config(argc, argv, &cfg);
+	argc -= i;
+	argv += i;
+
+	if (argc < 1)
+		die("a command must be specified");
+
+	cmd = argv[0];
+	argc--;
+	argv++;
+
+	if (argc < 1)
+		die("at least one GPIO line must be specified");
+
+	if (strcmp(cmd, "get") == 0)
+		cmd_get(&cfg, argc, argv);
+	else if (strcmp(cmd, "set") == 0)
+		cmd_set(&cfg, argc, argv);
+	else if (strcmp(cmd, "monitor") == 0)
+		cmd_monitor(&cfg, argc, argv);
+	else
+		die("unknown command: '%s'", cmd);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,1115 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <gpiod.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gpiodaemon.h"
+#include "tools-common.h"
+
+#define MAX_CLIENTS	32
+
+#define NSEC_PER_SEC	1000000000ULL
+
+#define EVENTS_PER_PACKET \
+	((GPIODAEMON_MAX_MSG_SIZE - sizeof(struct gpiodaemon_events)) / \
+	 sizeof(struct gpiodaemon_event))
+
+struct config {
+	bool active_low;
+	bool banner;
+	bool by_name;
+	bool strict;
+	enum gpiod_line_bias bias;
+	const char *chip_id;
+	const char *consumer;
+	const char *socket_path;
+	const char *page_path;
+	struct rt_config rt;
+};
+
+struct subscriber {
+	uint8_t edges;
+	uint8_t mode;
+	uint64_t interval_ns;
+	/* earliest time of the next rate-limited delivery */
+	uint64_t next_ns;
+	/* filter, indexed by line */
+	bool *lines;
+	/* latest undelivered event of every line when coalescing */
+	struct gpiodaemon_event *latest;
+	bool *pending;
+	unsigned int num_pending;
+	/* events lost since the last packet the subscriber received */
+	uint32_t dropped;
+};
+
+struct daemon {
+	struct line_resolver *resolver;
+	struct gpiod_line_request **requests;
+	struct gpiod_edge_event_buffer *events;
+	/* lines given as line=value, the rest are inputs */
+	bool *outputs;
+	struct gpiodaemon_page *page;
+	size_t page_size;
+	/* listening socket, one request per chip, then the clients */
+	struct pollfd *fds;
+	int num_fds;
+	/* subscription of every client, NULL for the others */
+	struct subscriber **subs;
+	/* events of the last read, decoded once for all subscribers */
+	struct gpiodaemon_event *batch;
+	/* packet being sent to a subscriber */
+	uint32_t packet[GPIODAEMON_MAX_MSG_SIZE / 4];
+	/* scratch pads, one entry per line */
+	unsigned int *offsets;
+	enum gpiod_line_value *values;
+	unsigned int *positions;
+};
+
+static void print_help(void)
+{
+	printf("Usage: %s [OPTIONS] <line[=value]>...\n", get_progname());
+	printf("\n");
+	printf("Keep GPIO lines requested and serve their values to clients.\n");
+	printf("\n");
+	printf("Lines are specified by name, or optionally by offset if the chip option\n");
+	printf("is provided. Lines given with a value are requested as outputs and driven to\n");
+	printf("that value, the others are requested as inputs. The lines stay requested\n");
+	printf("until the daemon exits, regardless of the clients coming and going.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("      --banner\t\tdisplay a banner once ready to serve clients\n");
+	print_bias_help();
+	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
+	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
+	printf("  -C, --consumer <name>\tconsumer name applied to requested lines (default is 'gpiodaemon')\n");
+	printf("  -h, --help\t\tdisplay this help and exit\n");
+	printf("  -l, --active-low\ttreat the line as active low\n");
+	printf("  -m, --page <path>\texpose the line values in a file mapped into memory,\n");
+	printf("\t\t\ttypically in /dev/shm\n");
+	printf("  -S, --socket <path>\tlisten on the given unix socket\n");
+	printf("\t\t\t(default is '%s')\n", GPIODAEMON_DEFAULT_SOCKET);
+	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
+	printf("  -v, --version\t\toutput version information and exit\n");
+	print_rt_help();
+	print_chip_help();
+	printf("\n");
+	printf("Clients:\n");
+	printf("  Use gpioclient to get and set the values. Local readers may also map the\n");
+	printf("  value page to read the values without talking to the daemon at all. Values\n");
+	printf("  of inputs in the page are kept current using edge detection.\n");
+	printf("\n");
+	printf("  Clients may also subscribe to the edge events of the inputs, filtered by\n");
+	printf("  line and edge, and receive every event, the latest event of every line or\n");
+	printf("  the latest event at most once per period. Every batch of events read from\n");
+	printf("  a chip is filtered for all subscribers at once.\n");
+}
+
+static int parse_config(int argc, char **argv, struct config *cfg)
+{
+	static const struct option longopts[] = {
+		{ "active-low",	no_argument,		NULL,	'l' },
+		{ "banner",	no_argument,		NULL,	'-' },
+		{ "bias",	required_argument,	NULL,	'b' },
+		{ "by-name",	no_argument,		NULL,	'B' },
+		{ "chip",	required_argument,	NULL,	'c' },
+		{ "consumer",	required_argument,	NULL,	'C' },
+		{ "help",	no_argument,		NULL,	'h' },
+		{ "page",	required_argument,	NULL,	'm' },
+		{ "socket",	required_argument,	NULL,	'S' },
+		{ "strict",	no_argument,		NULL,	's' },
+		{ "version",	no_argument,		NULL,	'v' },
+		RT_LONGOPTS,
+		{ GETOPT_NULL_LONGOPT },
+	};
+
+	static const char *const shortopts = "+b:c:C:hlm:S:sv";
+
+	int opti, optc;
+
+	memset(cfg, 0, sizeof(*cfg));
+	rt_config_init(&cfg->rt);
+	cfg->consumer = "gpiodaemon";
+	cfg->socket_path = GPIODAEMON_DEFAULT_SOCKET;
+
+	for (;;) {
+		optc = getopt_long(argc, argv, shortopts, longopts, &opti);
+		if (optc < 0)
+			break;
+
+		if (parse_rt_option(optc, optarg, &cfg->rt))
+			continue;
+
+		switch (optc) {
+		case '-':
+			cfg->banner = true;
+			break;
+		case 'b':
+			cfg->bias = parse_bias_or_die(optarg);
+			break;
+		case 'B':
+			cfg->by_name = true;
+			break;
+		case 'c':
+			cfg->chip_id = optarg;
+			break;
+		case 'C':
+			cfg->consumer = optarg;
+			break;
+		case 'l':
+			cfg->active_low = true;
+			break;
+		case 'm':
+			cfg->page_path = optarg;
+			break;
+		case 'S':
+			cfg->socket_path = optarg;
+			break;
+		case 's':
+			cfg->strict = true;
+			break;
+		case 'h':
+			print_help();
+			exit(EXIT_SUCCESS);
+		case 'v':
+			print_version();
+			exit(EXIT_SUCCESS);
+		case '?':
+			die("try %s --help", get_progname());
+		case 0:
+			break;
+		default:
+			abort();
+		}
+	}
+
+	return optind;
+}
+
+static volatile sig_atomic_t interrupted;
+
+static void handle_signal(int signum UNUSED)
+{
+	interrupted = 1;
+}
+
+/* Clean up the socket and the page on the first signal. */
+static void catch_signals(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_signal;
+	sa.sa_flags = SA_RESETHAND;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(SIGINT, &sa, NULL) || sigaction(SIGTERM, &sa, NULL))
+		die_perror("unable to install signal handlers");
+}
+
+/*
+ * Split 'line=value' arguments. Lines without a value are inputs and keep the
+ * argument as is.
+ */
+static void parse_lines_or_die(int num_lines, char **args, bool *outputs,
+			       enum gpiod_line_value *values)
+{
+	char *value;
+	int i;
+
+	for (i = 0; i < num_lines; i++) {
+		value = strrchr(args[i], '=');
+		if (!value)
+			continue;
+
+		*value = '\0';
+		values[i] = parse_line_value(value + 1);
+		if (values[i] == GPIOD_LINE_VALUE_ERROR)
+			die("invalid line value: '%s'", value + 1);
+
+		outputs[i] = true;
+	}
+}
+
+static void page_begin_update(struct daemon *dmn)
+{
+	if (!dmn->page)
+		return;
+
+	__atomic_store_n(&dmn->page->seq, dmn->page->seq + 1,
+			 __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void page_set_value(struct daemon *dmn, int line,
+			   enum gpiod_line_value value)
+{
+	if (dmn->page)
+		__atomic_store_n(&dmn->page->lines[line].value, value,
+				 __ATOMIC_RELAXED);
+}
+
+static void page_end_update(struct daemon *dmn)
+{
+	if (dmn->page)
+		__atomic_store_n(&dmn->page->seq, dmn->page->seq + 1,
+				 __ATOMIC_RELEASE);
+}
+
+/*
+ * The page is set up under a temporary name and moved in place once complete
+ * so that readers never see it half-initialized.
+ */
+static void create_page_or_die(struct daemon *dmn, const char *path)
+{
+	struct line_resolver *resolver = dmn->resolver;
+	struct gpiodaemon_page_line *line;
+	char tmp[PATH_MAX];
+	int fd, i;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= PATH_MAX)
+		die("page path too long: %s", path);
+
+	fd = mkostemp(tmp, O_CLOEXEC);
+	if (fd < 0)
+		die_perror("unable to create the value page");
+
+	dmn->page_size = sizeof(*dmn->page) +
+			 resolver->num_lines * sizeof(*dmn->page->lines);
+
+	if (fchmod(fd, 0644) || ftruncate(fd, dmn->page_size))
+		die_perror("unable to size the value page");
+
+	dmn->page = mmap(NULL, dmn->page_size, PROT_READ | PROT_WRITE,
+			 MAP_SHARED, fd, 0);
+	if (dmn->page == MAP_FAILED)
+		die_perror("unable to map the value page");
+
+	close(fd);
+
+	dmn->page->magic = GPIODAEMON_PAGE_MAGIC;
+	dmn->page->version = GPIODAEMON_PAGE_VERSION;
+	dmn->page->num_lines = resolver->num_lines;
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		line = &dmn->page->lines[i];
+		strncpy(line->name, resolver->lines[i].id,
+			sizeof(line->name) - 1);
+		line->value = resolver->lines[i].value;
+		line->output = dmn->outputs[i];
+	}
+
+	if (rename(tmp, path))
+		die_perror("unable to create the value page");
+}
+
+static void request_lines_or_die(struct daemon *dmn, struct config *cfg)
+{
+	struct line_resolver *resolver = dmn->resolver;
+	struct gpiod_line_settings *settings;
+	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_config *line_cfg;
+	struct resolved_line *line;
+	int i, j, num_lines, ret;
+
+	settings = gpiod_line_settings_new();
+	req_cfg = gpiod_request_config_new();
+	line_cfg = gpiod_line_config_new();
+	if (!settings || !req_cfg || !line_cfg)
+		die_perror("unable to allocate the request configuration");
+
+	gpiod_request_config_set_consumer(req_cfg, cfg->consumer);
+	/* We're the only ones driving the outputs for as long as we run. */
+	gpiod_request_config_set_output_shadow(req_cfg, true);
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		gpiod_line_config_reset(line_cfg);
+
+		for (j = 0; j < resolver->num_lines; j++) {
+			line = &resolver->lines[j];
+			if (line->chip_num != i)
+				continue;
+
+			gpiod_line_settings_reset(settings);
+			gpiod_line_settings_set_active_low(settings,
+							   cfg->active_low);
+
+			if (dmn->outputs[j]) {
+				gpiod_line_settings_set_direction(settings,
+						GPIOD_LINE_DIRECTION_OUTPUT);
+				gpiod_line_settings_set_output_value(settings,
+								line->value);
+			} else {
+				gpiod_line_settings_set_direction(settings,
+						GPIOD_LINE_DIRECTION_INPUT);
+				gpiod_line_settings_set_edge_detection(settings,
+						GPIOD_LINE_EDGE_BOTH);
+				if (cfg->bias)
+					gpiod_line_settings_set_bias(settings,
+								     cfg->bias);
+			}
+
+			ret = gpiod_line_config_add_line_settings(line_cfg,
+							&line->offset, 1,
+							settings);
+			if (ret)
+				die_perror("unable to add line settings");
+		}
+
+		dmn->requests[i] = gpiod_chip_request_lines(
+				resolver->chips[i].chip, req_cfg, line_cfg);
+		if (!dmn->requests[i])
+			die_perror("unable to request lines on chip %s",
+				   resolver->chips[i].path);
+
+		num_lines = get_line_offsets_and_values(resolver, i,
+							dmn->offsets, NULL);
+		ret = gpiod_line_request_get_values_subset(dmn->requests[i],
+							   num_lines,
+							   dmn->offsets,
+							   dmn->values);
+		if (ret)
+			die_perror("unable to read GPIO line values");
+
+		set_line_values(resolver, i, dmn->values);
+	}
+
+	gpiod_request_config_free(req_cfg);
+	gpiod_line_config_free(line_cfg);
+	gpiod_line_settings_free(settings);
+}
+
+static int listen_or_die(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path))
+		die("socket path too long: %s", path);
+	strcpy(addr.sun_path, path);
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		die_perror("unable to create the socket");
+
+	/* A socket left behind by a previous instance that didn't exit. */
+	unlink(path);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(fd, MAX_CLIENTS))
+		die_perror("unable to listen on %s", path);
+
+	return fd;
+}
+
+/*
+ * Fill positions with the indices into lines of the entries on the chip,
+ * and offsets with their offsets, in the order given.
+ */
+static int gather_chip_lines(struct daemon *dmn, int chip_num,
+			     const uint16_t *lines, size_t stride,
+			     unsigned int num)
+{
+	struct resolved_line *line;
+	unsigned int i, idx;
+	int num_lines = 0;
+
+	for (i = 0; i < num; i++) {
+		idx = *(const uint16_t *)((const char *)lines + i * stride);
+		line = &dmn->resolver->lines[idx];
+		if (line->chip_num != chip_num)
+			continue;
+
+		dmn->offsets[num_lines] = line->offset;
+		dmn->positions[num_lines] = i;
+		num_lines++;
+	}
+
+	return num_lines;
+}
+
+static int check_lines(struct daemon *dmn, const uint16_t *lines,
+		       size_t stride, unsigned int num, bool outputs_only)
+{
+	unsigned int i, idx;
+
+	for (i = 0; i < num; i++) {
+		idx = *(const uint16_t *)((const char *)lines + i * stride);
+		if (idx >= (unsigned int)dmn->resolver->num_lines)
+			return -EINVAL;
+		if (outputs_only && !dmn->outputs[idx])
+			return -EPERM;
+	}
+
+	return 0;
+}
+
+static int handle_lookup(struct daemon *dmn, const char *names, size_t len,
+			 unsigned int num, uint16_t *indices)
+{
+	const char *end = names + len;
+	struct resolved_line *line;
+	unsigned int i;
+	size_t name_len;
+	int j;
+
+	for (i = 0; i < num; i++) {
+		name_len = strnlen(names, end - names);
+		if (names + name_len == end)
+			return -EINVAL;
+
+		indices[i] = GPIODAEMON_NO_LINE;
+
+		for (j = 0; j < dmn->resolver->num_lines; j++) {
+			line = &dmn->resolver->lines[j];
+			if (strcmp(line->id, names) == 0) {
+				indices[i] = j;
+				break;
+			}
+		}
+
+		names += name_len + 1;
+	}
+
+	return 0;
+}
+
+static int handle_get(struct daemon *dmn, const uint16_t *lines,
+		      unsigned int num, uint8_t *values)
+{
+	int i, j, num_lines, ret;
+	uint16_t idx;
+
+	ret = check_lines(dmn, lines, sizeof(*lines), num, false);
+	if (ret)
+		return ret;
+
+	page_begin_update(dmn);
+
+	for (i = 0; i < dmn->resolver->num_chips; i++) {
+		num_lines = gather_chip_lines(dmn, i, lines, sizeof(*lines),
+					      num);
+		if (!num_lines)
+			continue;
+
+		ret = gpiod_line_request_get_values_subset(dmn->requests[i],
+							   num_lines,
+							   dmn->offsets,
+							   dmn->values);
+		if (ret) {
+			ret = -errno;
+			break;
+		}
+
+		for (j = 0; j < num_lines; j++) {
+			idx = lines[dmn->positions[j]];
+			values[dmn->positions[j]] = dmn->values[j];
+			dmn->resolver->lines[idx].value = dmn->values[j];
+			page_set_value(dmn, idx, dmn->values[j]);
+		}
+	}
+
+	page_end_update(dmn);
+
+	return ret;
+}
+
+static int handle_set(struct daemon *dmn, const struct gpiodaemon_set *sets,
+		      unsigned int num)
+{
+	int i, j, num_lines, ret;
+	unsigned int pos;
+
+	ret = check_lines(dmn, &sets->line, sizeof(*sets), num, true);
+	if (ret)
+		return ret;
+
+	page_begin_update(dmn);
+
+	for (i = 0; i < dmn->resolver->num_chips; i++) {
+		num_lines = gather_chip_lines(dmn, i, &sets->line,
+					      sizeof(*sets), num);
+		if (!num_lines)
+			continue;
+
+		for (j = 0; j < num_lines; j++)
+			dmn->values[j] = sets[dmn->positions[j]].value ?
+						GPIOD_LINE_VALUE_ACTIVE :
+						GPIOD_LINE_VALUE_INACTIVE;
+
+		ret = gpiod_line_request_set_values_subset(dmn->requests[i],
+							   num_lines,
+							   dmn->offsets,
+							   dmn->values);
+		if (ret) {
+			ret = -errno;
+			break;
+		}
+
+		for (j = 0; j < num_lines; j++) {
+			pos = dmn->positions[j];
+			dmn->resolver->lines[sets[pos].line].value =
+							dmn->values[j];
+			page_set_value(dmn, sets[pos].line, dmn->values[j]);
+		}
+	}
+
+	page_end_update(dmn);
+
+	return ret;
+}
+
+static void free_subscriber(struct subscriber *sub)
+{
+	if (!sub)
+		return;
+
+	free(sub->lines);
+	free(sub->latest);
+	free(sub->pending);
+	free(sub);
+}
+
+static int handle_subscribe(struct daemon *dmn, int slot, const void *payload,
+			    size_t len, unsigned int num)
+{
+	const struct gpiodaemon_subscribe *req = payload;
+	int num_lines = dmn->resolver->num_lines;
+	const uint16_t *lines;
+	struct subscriber *sub;
+	unsigned int i;
+	int ret;
+
+	if (len != sizeof(*req) + num * sizeof(*lines))
+		return -EINVAL;
+
+	if (!req->edges ||
+	    (req->edges & ~(GPIODAEMON_EDGE_RISING | GPIODAEMON_EDGE_FALLING)))
+		return -EINVAL;
+
+	if (req->mode > GPIODAEMON_DELIVER_RATE_LIMITED ||
+	    (req->mode == GPIODAEMON_DELIVER_RATE_LIMITED &&
+	     !req->interval_us))
+		return -EINVAL;
+
+	lines = (const uint16_t *)(req + 1);
+	ret = check_lines(dmn, lines, sizeof(*lines), num, false);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < num; i++) {
+		/* Outputs don't produce any events. */
+		if (dmn->outputs[lines[i]])
+			return -EPERM;
+	}
+
+	sub = calloc(1, sizeof(*sub));
+	if (!sub)
+		return -ENOMEM;
+
+	sub->lines = calloc(num_lines, sizeof(*sub->lines));
+	sub->latest = calloc(num_lines, sizeof(*sub->latest));
+	sub->pending = calloc(num_lines, sizeof(*sub->pending));
+	if (!sub->lines || !sub->latest || !sub->pending) {
+		free_subscriber(sub);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < (unsigned int)num_lines; i++)
+		sub->lines[i] = !num && !dmn->outputs[i];
+	for (i = 0; i < num; i++)
+		sub->lines[lines[i]] = true;
+
+	sub->edges = req->edges;
+	sub->mode = req->mode;
+	sub->interval_ns = (uint64_t)req->interval_us * 1000;
+	dmn->subs[slot] = sub;
+
+	return 0;
+}
+
+/* Returns false if the client should be disconnected. */
+static bool handle_client(struct daemon *dmn, int slot)
+{
+	/* Word-sized to keep the headers and payloads aligned. */
+	uint32_t msg[GPIODAEMON_MAX_MSG_SIZE / 4];
+	uint32_t rep[GPIODAEMON_MAX_MSG_SIZE / 4];
+	struct gpiodaemon_reply *reply = (struct gpiodaemon_reply *)rep;
+	struct gpiodaemon_cmd *cmd = (struct gpiodaemon_cmd *)msg;
+	void *payload = cmd + 1, *rep_payload = reply + 1;
+	int fd = dmn->fds[slot].fd;
+	size_t len, rep_len = 0;
+	ssize_t rd;
+
+	rd = recv(fd, msg, sizeof(msg), 0);
+	if (rd < 0)
+		return errno == EAGAIN || errno == EINTR;
+	if (rd == 0)
+		return false;
+
+	/* Subscribers only get events, anything they send is ignored. */
+	if (dmn->subs[slot])
+		return true;
+
+	if ((size_t)rd < sizeof(*cmd))
+		return false;
+
+	len = rd - sizeof(*cmd);
+	memset(reply, 0, sizeof(*reply));
+
+	if (cmd->num > GPIODAEMON_MAX_LINES) {
+		reply->status = -E2BIG;
+		goto out;
+	}
+
+	switch (cmd->cmd) {
+	case GPIODAEMON_CMD_LOOKUP:
+		reply->status = handle_lookup(dmn, payload, len, cmd->num,
+					      rep_payload);
+		rep_len = cmd->num * sizeof(uint16_t);
+		break;
+	case GPIODAEMON_CMD_GET:
+		if (len != cmd->num * sizeof(uint16_t)) {
+			reply->status = -EINVAL;
+			break;
+		}
+
+		reply->status = handle_get(dmn, payload, cmd->num,
+					   rep_payload);
+		rep_len = cmd->num;
+		break;
+	case GPIODAEMON_CMD_SET:
+		if (len != cmd->num * sizeof(struct gpiodaemon_set)) {
+			reply->status = -EINVAL;
+			break;
+		}
+
+		reply->status = handle_set(dmn, payload, cmd->num);
+		break;
+	case GPIODAEMON_CMD_SUBSCRIBE:
+		reply->status = handle_subscribe(dmn, slot, payload, len,
+						 cmd->num);
+		break;
+	default:
+		reply->status = -EOPNOTSUPP;
+		break;
+	}
+
+out:
+	if (reply->status)
+		rep_len = 0;
+
+	reply->num = reply->status ? 0 : cmd->num;
+
+	/*
+	 * Clients are non-blocking, one which doesn't read its replies is
+	 * dropped rather than stalling everyone else.
+	 */
+	return send(fd, reply, sizeof(*reply) + rep_len, MSG_NOSIGNAL) >= 0;
+}
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/*
+ * Send the events packed in dmn->packet. A subscriber that doesn't keep up
+ * loses the events, which are reported with the next packet that gets
+ * through. Returns false if the subscriber should be disconnected.
+ */
+static bool send_packet(struct daemon *dmn, int slot, unsigned int num)
+{
+	struct gpiodaemon_events *hdr = (struct gpiodaemon_events *)dmn->packet;
+	struct subscriber *sub = dmn->subs[slot];
+	ssize_t ret;
+
+	hdr->num = num;
+	hdr->dropped = sub->dropped;
+
+	ret = send(dmn->fds[slot].fd, hdr, sizeof(*hdr) +
+		   num * sizeof(struct gpiodaemon_event), MSG_NOSIGNAL);
+	if (ret < 0) {
+		if (errno != EAGAIN && errno != ENOBUFS)
+			return false;
+
+		sub->dropped += num;
+		return true;
+	}
+
+	sub->dropped = 0;
+
+	return true;
+}
+
+static struct gpiodaemon_event *packet_events(struct daemon *dmn)
+{
+	return (struct gpiodaemon_event *)
+			((struct gpiodaemon_events *)dmn->packet + 1);
+}
+
+static bool flush_pending(struct daemon *dmn, int slot, uint64_t now)
+{
+	struct gpiodaemon_event *events = packet_events(dmn);
+	struct subscriber *sub = dmn->subs[slot];
+	unsigned int num = 0;
+	int i;
+
+	for (i = 0; i < dmn->resolver->num_lines && sub->num_pending; i++) {
+		if (!sub->pending[i])
+			continue;
+
+		events[num++] = sub->latest[i];
+		sub->pending[i] = false;
+		sub->num_pending--;
+
+		if (num == EVENTS_PER_PACKET) {
+			if (!send_packet(dmn, slot, num))
+				return false;
+
+			num = 0;
+		}
+	}
+
+	sub->next_ns = now + sub->interval_ns;
+
+	return !num || send_packet(dmn, slot, num);
+}
+
+/* Deliver the events decoded into dmn->batch to a subscriber. */
+static bool deliver_batch(struct daemon *dmn, int slot, unsigned int num,
+			  uint64_t now)
+{
+	struct gpiodaemon_event *events = packet_events(dmn), *event;
+	struct subscriber *sub = dmn->subs[slot];
+	unsigned int i, num_packed = 0;
+
+	for (i = 0; i < num; i++) {
+		event = &dmn->batch[i];
+		if (!sub->lines[event->line] || !(sub->edges & event->edge))
+			continue;
+
+		if (sub->mode != GPIODAEMON_DELIVER_ALL) {
+			if (!sub->pending[event->line]) {
+				sub->pending[event->line] = true;
+				sub->num_pending++;
+			}
+
+			sub->latest[event->line] = *event;
+			continue;
+		}
+
+		events[num_packed++] = *event;
+		if (num_packed == EVENTS_PER_PACKET) {
+			if (!send_packet(dmn, slot, num_packed))
+				return false;
+
+			num_packed = 0;
+		}
+	}
+
+	if (sub->mode == GPIODAEMON_DELIVER_ALL)
+		return !num_packed || send_packet(dmn, slot, num_packed);
+
+	if (!sub->num_pending ||
+	    (sub->mode == GPIODAEMON_DELIVER_RATE_LIMITED &&
+	     now < sub->next_ns))
+		return true;
+
+	return flush_pending(dmn, slot, now);
+}
+
+static void drop_client(struct daemon *dmn, int slot)
+{
+	close(dmn->fds[slot].fd);
+	dmn->fds[slot].fd = -1;
+	free_subscriber(dmn->subs[slot]);
+	dmn->subs[slot] = NULL;
+}
+
+/*
+ * Read a batch of events, decode it once and hand it to every subscriber, so
+ * the cost of the kernel read doesn't depend on the number of subscribers.
+ */
+static void handle_edge_events(struct daemon *dmn, int chip_num)
+{
+	struct gpiodaemon_event *decoded;
+	struct gpiod_edge_event *event;
+	struct resolved_line *line;
+	enum gpiod_line_value value;
+	unsigned int offset, num = 0;
+	int i, j, ret;
+	uint64_t now;
+
+	ret = gpiod_line_request_read_edge_events(dmn->requests[chip_num],
+					dmn->events,
+					gpiod_edge_event_buffer_get_capacity(
+							dmn->events));
+	if (ret < 0)
+		die_perror("error reading edge events");
+
+	page_begin_update(dmn);
+
+	for (i = 0; i < ret; i++) {
+		event = gpiod_edge_event_buffer_get_event(dmn->events, i);
+		offset = gpiod_edge_event_get_line_offset(event);
+		value = gpiod_edge_event_get_event_type(event) ==
+					GPIOD_EDGE_EVENT_RISING_EDGE ?
+				GPIOD_LINE_VALUE_ACTIVE :
+				GPIOD_LINE_VALUE_INACTIVE;
+
+		for (j = 0; j < dmn->resolver->num_lines; j++) {
+			line = &dmn->resolver->lines[j];
+			if (line->chip_num != chip_num ||
+			    line->offset != offset)
+				continue;
+
+			line->value = value;
+			page_set_value(dmn, j, value);
+
+			decoded = &dmn->batch[num++];
+			memset(decoded, 0, sizeof(*decoded));
+			decoded->timestamp_ns =
+				gpiod_edge_event_get_timestamp_ns(event);
+			decoded->line = j;
+			decoded->edge = value == GPIOD_LINE_VALUE_ACTIVE ?
+						GPIODAEMON_EDGE_RISING :
+						GPIODAEMON_EDGE_FALLING;
+			decoded->line_seqno =
+				gpiod_edge_event_get_line_seqno(event);
+			break;
+		}
+	}
+
+	page_end_update(dmn);
+
+	if (!num)
+		return;
+
+	now = monotonic_ns();
+
+	for (i = dmn->resolver->num_chips + 1; i < dmn->num_fds; i++) {
+		if (dmn->subs[i] && !deliver_batch(dmn, i, num, now))
+			drop_client(dmn, i);
+	}
+}
+
+/* Deliver the rate-limited events whose interval elapsed. */
+static int flush_rate_limited(struct daemon *dmn)
+{
+	uint64_t now = monotonic_ns(), next = UINT64_MAX;
+	struct subscriber *sub;
+	int i;
+
+	for (i = dmn->resolver->num_chips + 1; i < dmn->num_fds; i++) {
+		sub = dmn->subs[i];
+		if (!sub || !sub->num_pending)
+			continue;
+
+		if (now >= sub->next_ns && !flush_pending(dmn, i, now)) {
+			drop_client(dmn, i);
+			continue;
+		}
+
+		if (sub->num_pending && sub->next_ns < next)
+			next = sub->next_ns;
+	}
+
+	if (next == UINT64_MAX)
+		return -1;
+
+	/* Poll timeout in milliseconds, rounded up. */
+	return (next - now + 999999) / 1000000;
+}
+
+static void accept_client(struct daemon *dmn)
+{
+	int fd, i;
+
+	fd = accept4(dmn->fds[0].fd, NULL, NULL,
+		     SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+		return;
+
+	for (i = dmn->resolver->num_chips + 1; i < dmn->num_fds; i++) {
+		if (dmn->fds[i].fd < 0) {
+			dmn->fds[i].fd = fd;
+			dmn->fds[i].events = POLLIN;
+			return;
+		}
+	}
+
+	/* Too many clients. */
+	close(fd);
+}
+
+static void serve(struct daemon *dmn)
+{
+	int i, ret, timeout = -1, num_chips = dmn->resolver->num_chips;
+
+	while (!interrupted) {
+		ret = poll(dmn->fds, dmn->num_fds, timeout);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+
+			die_perror("error waiting for clients");
+		}
+
+		for (i = 1; i <= num_chips; i++) {
+			if (dmn->fds[i].revents)
+				handle_edge_events(dmn, i - 1);
+		}
+
+		for (i = num_chips + 1; i < dmn->num_fds; i++) {
+			if (dmn->fds[i].fd >= 0 && dmn->fds[i].revents &&
+			    !handle_client(dmn, i))
+				drop_client(dmn, i);
+		}
+
+		if (dmn->fds[0].revents)
+			accept_client(dmn);
+
+		timeout = flush_rate_limited(dmn);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	enum gpiod_line_value *values;
+	struct daemon dmn;
+	struct config cfg;
+	int i, j;
+
+	i = parse_config(argc, argv, &cfg);
+	argc -= i;
+	argv += i;
+
+	if (argc < 1)
+		die("at least one GPIO line must be specified");
+
+	memset(&dmn, 0, sizeof(dmn));
+
+	dmn.outputs = calloc(argc, sizeof(*dmn.outputs));
+	values = calloc(argc, sizeof(*values));
+	if (!dmn.outputs || !values)
+		die("out of memory");
+
+	parse_lines_or_die(argc, argv, dmn.outputs, values);
+
+	dmn.resolver = resolve_lines(argc, argv, cfg.chip_id, cfg.strict,
+				     cfg.by_name);
+	validate_resolution(dmn.resolver, cfg.chip_id);
+	for (i = 0; i < argc; i++)
+		dmn.resolver->lines[i].value = values[i];
+	free(values);
+
+	dmn.requests = calloc(dmn.resolver->num_chips, sizeof(*dmn.requests));
+	dmn.offsets = calloc(argc, sizeof(*dmn.offsets));
+	dmn.values = calloc(argc, sizeof(*dmn.values));
+	dmn.positions = calloc(argc, sizeof(*dmn.positions));
+	dmn.num_fds = 1 + dmn.resolver->num_chips + MAX_CLIENTS;
+	dmn.fds = calloc(dmn.num_fds, sizeof(*dmn.fds));
+	dmn.subs = calloc(dmn.num_fds, sizeof(*dmn.subs));
+	if (!dmn.requests || !dmn.offsets || !dmn.values || !dmn.positions ||
+	    !dmn.fds || !dmn.subs)
+		die("out of memory");
+
+	dmn.events = gpiod_edge_event_buffer_new(0);
+	if (!dmn.events)
+		die_perror("unable to allocate the edge event buffer");
+
+	dmn.batch = calloc(gpiod_edge_event_buffer_get_capacity(dmn.events),
+			   sizeof(*dmn.batch));
+	if (!dmn.batch)
+		die("out of memory");
+
+	request_lines_or_die(&dmn, &cfg);
+
+	if (cfg.page_path)
+		create_page_or_die(&dmn, cfg.page_path);
+
+	catch_signals();
+
+	dmn.fds[0].fd = listen_or_die(cfg.socket_path);
+	dmn.fds[0].events = POLLIN;
+
+	for (i = 0; i < dmn.resolver->num_chips; i++) {
+		dmn.fds[i + 1].fd = -1;
+
+		/* Only inputs produce edge events. */
+		for (j = 0; j < dmn.resolver->num_lines; j++) {
+			if (dmn.resolver->lines[j].chip_num == i &&
+			    !dmn.outputs[j]) {
+				dmn.fds[i + 1].fd = gpiod_line_request_get_fd(
+							dmn.requests[i]);
+				dmn.fds[i + 1].events = POLLIN;
+				break;
+			}
+		}
+	}
+
+	for (i = dmn.resolver->num_chips + 1; i < dmn.num_fds; i++)
+		dmn.fds[i].fd = -1;
+
+	apply_rt_config(&cfg.rt);
+
+	if (cfg.banner) {
+		printf("Serving %d line%s on %s\n", dmn.resolver->num_lines,
+		       dmn.resolver->num_lines > 1 ? "s" : "",
+		       cfg.socket_path);
+		fflush(stdout);
+	}
+
+	serve(&dmn);
+
+	for (i = dmn.resolver->num_chips + 1; i < dmn.num_fds; i++) {
+		if (dmn.fds[i].fd >= 0)
+			drop_client(&dmn, i);
+	}
+
+	close(dmn.fds[0].fd);
+	unlink(cfg.socket_path);
+
+	if (dmn.page) {
+		munmap(dmn.page, dmn.page_size);
+		unlink(cfg.page_path);
+	}
+
+	for (i = 0; i < dmn.resolver->num_chips; i++)
+		gpiod_line_request_release(dmn.requests[i]);
+
+	gpiod_edge_event_buffer_free(dmn.events);
+	free(dmn.batch);
+	free(dmn.subs);
+	free(dmn.positions);
+	free(dmn.values);
+	free(dmn.offsets);
+	free(dmn.requests);
+	free(dmn.fds);
+	free(dmn.outputs);
+	free_line_resolver(dmn.resolver);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/* SPDX-FileCopyrightText: 2022 Bartosz Golaszewski <brgl@bgdev.pl> */
+
+#ifndef __GPIOD_TOOLS_GPIODAEMON_H__
+#define __GPIOD_TOOLS_GPIODAEMON_H__
+
+#include <stdint.h>
+
+/*
+ * Protocol spoken between gpiodaemon and its clients.
+ *
+ * Clients connect to a SOCK_SEQPACKET unix socket and send one command per
+ * packet. Every command is answered with exactly one reply packet, in order,
+ * so a client may send several commands before reading the replies. Lines are
+ * referred to by their index in the daemon's command line, LOOKUP translates
+ * names to indices. All fields are in the native byte order.
+ *
+ * Once SUBSCRIBE succeeds, the connection carries edge events of the input
+ * lines instead: the daemon sends packets made of struct gpiodaemon_events
+ * followed by the events and ignores any further commands. The events read
+ * from a chip in one go are filtered for all subscribers at once and each
+ * subscriber gets them packed into as few packets as possible.
+ *
+ * NOTE: Like the rest of the tools, this is not a stable interface.
+ */
+
+#define GPIODAEMON_DEFAULT_SOCKET	"/run/gpiodaemon.sock"
+/* Max size of a command or reply packet. */
+#define GPIODAEMON_MAX_MSG_SIZE		4096
+/* Max number of lines a single command may refer to. */
+#define GPIODAEMON_MAX_LINES		512
+/* Index returned by LOOKUP for names the daemon doesn't know. */
+#define GPIODAEMON_NO_LINE		0xffff
+
+enum {
+	/* Payload: num NUL-terminated names. Reply: uint16_t indices[num]. */
+	GPIODAEMON_CMD_LOOKUP = 1,
+	/* Payload: uint16_t indices[num]. Reply: uint8_t values[num]. */
+	GPIODAEMON_CMD_GET,
+	/* Payload: struct gpiodaemon_set[num]. Reply: no payload. */
+	GPIODAEMON_CMD_SET,
+	/*
+	 * Payload: struct gpiodaemon_subscribe then uint16_t indices[num], all
+	 * inputs if num is 0. Reply: no payload, then the event stream.
+	 */
+	GPIODAEMON_CMD_SUBSCRIBE,
+};
+
+/* Edges a subscriber is interested in. */
+#define GPIODAEMON_EDGE_RISING		0x01
+#define GPIODAEMON_EDGE_FALLING		0x02
+
+enum {
+	/* Every event, in order. */
+	GPIODAEMON_DELIVER_ALL = 0,
+	/* Only the latest event per line of every batch. */
+	GPIODAEMON_DELIVER_COALESCED,
+	/* The latest event per line, at most once per interval. */
+	GPIODAEMON_DELIVER_RATE_LIMITED,
+};
+
+struct gpiodaemon_cmd {
+	uint16_t cmd;
+	uint16_t num;
+};
+
+struct gpiodaemon_set {
+	uint16_t line;
+	uint8_t value;
+	uint8_t padding;
+};
+
+struct gpiodaemon_subscribe {
+	uint8_t edges;
+	uint8_t mode;
+	uint16_t padding;
+	/* Min time between deliveries for GPIODAEMON_DELIVER_RATE_LIMITED. */
+	uint32_t interval_us;
+};
+
+struct gpiodaemon_events {
+	uint32_t num;
+	/* Events not delivered since the previous packet. */
+	uint32_t dropped;
+};
+
+struct gpiodaemon_event {
+	uint64_t timestamp_ns;
+	uint16_t line;
+	/* GPIODAEMON_EDGE_RISING or GPIODAEMON_EDGE_FALLING */
+	uint8_t edge;
+	uint8_t padding;
+	uint32_t line_seqno;
+};
+
+struct gpiodaemon_reply {
+	/* 0 on success or a negative errno value. */
+	int32_t status;
+	uint16_t num;
+	uint16_t padding;
+};
+
+/*
+ * Layout of the optional value page, a file the daemon maps read-write and
+ * readers map read-only. It holds the value last driven on every output and
+ * the value last seen on every input, updated from edge events, so readers
+ * get current values without talking to the daemon.
+ *
+ * Updates are bracketed by seq: it's odd while the daemon writes the page.
+ * Readers copy what they need and retry if seq was odd or changed meanwhile.
+ */
+
+#define GPIODAEMON_PAGE_MAGIC		0x47504456 /* "GPDV" */
+#define GPIODAEMON_PAGE_VERSION		1
+/* Names longer than that are truncated in the page. */
+#define GPIODAEMON_PAGE_NAME_SIZE	32
+
+struct gpiodaemon_page_line {
+	char name[GPIODAEMON_PAGE_NAME_SIZE];
+	uint8_t value;
+	uint8_t output;
+	uint8_t padding[6];
+};
+
+struct gpiodaemon_page {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_lines;
+	uint32_t seq;
+	struct gpiodaemon_page_line lines[];
+};
+
+#endif /* __GPIOD_TOOLS_GPIODAEMON_H__ */
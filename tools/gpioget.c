@@ -2,17 +2,29 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <endian.h>
+#include <errno.h>
 #include <getopt.h>
 #include <gpiod.h>
+#include <inttypes.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "tools-common.h"
 
+/* Samples are written out once this many are collected or after 100ms. */
+#define SAMPLE_BATCH_SIZE	256
+#define SAMPLE_FLUSH_NS		100000000ULL
+
+#define NSEC_PER_SEC		1000000000ULL
+
 struct config {
 	bool active_low;
+	bool binary;
 	bool by_name;
 	bool numeric;
 	bool strict;
@@ -20,8 +32,11 @@ struct config {
 	enum gpiod_line_bias bias;
 	enum gpiod_line_direction direction;
 	unsigned int hold_period_us;
+	unsigned int sample_rate;
+	unsigned int count;
 	const char *chip_id;
 	const char *consumer;
+	struct rt_config rt;
 };
 
 static void print_help(void)
@@ -36,19 +51,36 @@ static void print_help(void)
 	printf("Options:\n");
 	printf("  -a, --as-is\t\tleave the line direction unchanged, not forced to input\n");
 	print_bias_help();
+	printf("      --binary\t\twrite samples as fixed-size binary records (see below)\n");
 	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
 	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
 	printf("  -C, --consumer <name>\tconsumer name applied to requested lines (default is 'gpioget')\n");
+	printf("      --count <num>\texit after taking num samples\n");
 	printf("  -h, --help\t\tdisplay this help and exit\n");
 	printf("  -l, --active-low\ttreat the line as active low\n");
 	printf("  -p, --hold-period <period>\n");
 	printf("\t\t\twait between requesting the lines and reading the values\n");
 	printf("      --numeric\t\tdisplay line values as '0' (inactive) or '1' (active)\n");
+	printf("      --sample-rate <hz>\n");
+	printf("\t\t\tkeep the lines requested and read their values hz times\n");
+	printf("\t\t\tper second, printing a line of values for every sample\n");
 	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
 	printf("      --unquoted\tdon't quote line names\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
+	print_rt_help();
 	print_chip_help();
 	print_period_help();
+	printf("\n");
+	printf("Sampling:\n");
+	printf("  Samples are taken at fixed deadlines derived from the start of sampling,\n");
+	printf("  so the timing error doesn't accumulate. If gpioget falls behind by more than\n");
+	printf("  a sample period, the samples missed are skipped and their number is reported\n");
+	printf("  on exit. Samples are written out in batches.\n");
+	printf("\n");
+	printf("Binary records:\n");
+	printf("  Every sample is a 16-byte record of little-endian fields: the time at which\n");
+	printf("  the sample was taken in nanoseconds on CLOCK_MONOTONIC and a bitmap of the\n");
+	printf("  line values, bit N set if the Nth line given is active (64 bits each).\n");
 }
 
 static int parse_config(int argc, char **argv, struct config *cfg)
@@ -57,15 +89,19 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		{ "active-low",	no_argument,		NULL,	'l' },
 		{ "as-is",	no_argument,		NULL,	'a' },
 		{ "bias",	required_argument,	NULL,	'b' },
+		{ "binary",	no_argument,		NULL,	'R' },
 		{ "by-name",	no_argument,		NULL,	'B' },
 		{ "chip",	required_argument,	NULL,	'c' },
 		{ "consumer",	required_argument,	NULL,	'C' },
+		{ "count",	required_argument,	NULL,	'n' },
 		{ "help",	no_argument,		NULL,	'h' },
 		{ "hold-period", required_argument,	NULL,	'p' },
 		{ "numeric",	no_argument,		NULL,	'N' },
+		{ "sample-rate", required_argument,	NULL,	'S' },
 		{ "strict",	no_argument,		NULL,	's' },
 		{ "unquoted",	no_argument,		NULL,	'Q' },
 		{ "version",	no_argument,		NULL,	'v' },
+		RT_LONGOPTS,
 		{ GETOPT_NULL_LONGOPT },
 	};
 
@@ -74,6 +110,7 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 	int opti, optc;
 
 	memset(cfg, 0, sizeof(*cfg));
+	rt_config_init(&cfg->rt);
 	cfg->direction = GPIOD_LINE_DIRECTION_INPUT;
 	cfg->consumer = "gpioget";
 
@@ -82,6 +119,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		if (optc < 0)
 			break;
 
+		if (parse_rt_option(optc, optarg, &cfg->rt))
+			continue;
+
 		switch (optc) {
 		case 'a':
 			cfg->direction = GPIOD_LINE_DIRECTION_AS_IS;
@@ -92,6 +132,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'B':
 			cfg->by_name = true;
 			break;
+		case 'R':
+			cfg->binary = true;
+			break;
 		case 'c':
 			cfg->chip_id = optarg;
 			break;
@@ -101,6 +144,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'l':
 			cfg->active_low = true;
 			break;
+		case 'n':
+			cfg->count = parse_uint_or_die(optarg);
+			break;
 		case 'N':
 			cfg->numeric = true;
 			break;
@@ -113,6 +159,11 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 's':
 			cfg->strict = true;
 			break;
+		case 'S':
+			cfg->sample_rate = parse_uint_or_die(optarg);
+			if (!cfg->sample_rate)
+				die("sample rate must be positive");
+			break;
 		case 'h':
 			print_help();
 			exit(EXIT_SUCCESS);
@@ -128,13 +179,228 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		}
 	}
 
+	if ((cfg->binary || cfg->count) && !cfg->sample_rate)
+		die("--binary and --count require --sample-rate");
+
 	return optind;
 }
 
+static volatile sig_atomic_t interrupted;
+
+static void handle_signal(int signum UNUSED)
+{
+	interrupted = 1;
+}
+
+/* Stop sampling on the first signal, a second one terminates as usual. */
+static void catch_signals(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_signal;
+	sa.sa_flags = SA_RESETHAND;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(SIGINT, &sa, NULL) || sigaction(SIGTERM, &sa, NULL))
+		die_perror("unable to install signal handlers");
+}
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/* Layout of the samples written in binary mode, all fields are little-endian. */
+struct sample_record {
+	uint64_t timestamp_ns;
+	uint64_t values;
+};
+
+struct sampler {
+	struct gpiod_line_request **requests;
+	struct line_resolver *resolver;
+	struct config *cfg;
+	/* Mask of all lines of every request. */
+	uint64_t *masks;
+	/* Bit of the resolver line of every request-relative bit. */
+	int (*bits)[64];
+	struct output_buffer out;
+	size_t batched;
+	uint64_t last_flush_ns;
+};
+
+/* Time of the sample at index from the start of sampling, without overflow. */
+static uint64_t sample_deadline(uint64_t start_ns, uint64_t index,
+				unsigned int rate)
+{
+	return start_ns + index / rate * NSEC_PER_SEC +
+	       index % rate * NSEC_PER_SEC / rate;
+}
+
+static void sample_put(struct sampler *sampler, uint64_t timestamp_ns,
+		       uint64_t values)
+{
+	struct line_resolver *resolver = sampler->resolver;
+	struct sample_record rec;
+	const char *id;
+	int i;
+
+	if (sampler->cfg->binary) {
+		rec.timestamp_ns = htole64(timestamp_ns);
+		rec.values = htole64(values);
+		output_write(&sampler->out, (const char *)&rec, sizeof(rec));
+		return;
+	}
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		if (i)
+			output_putc(&sampler->out, ' ');
+
+		if (sampler->cfg->numeric) {
+			output_putc(&sampler->out, values & (1ULL << i) ?
+								'1' : '0');
+			continue;
+		}
+
+		id = resolver->lines[i].id;
+		if (sampler->cfg->unquoted) {
+			output_puts(&sampler->out, id);
+		} else {
+			output_putc(&sampler->out, '"');
+			output_puts(&sampler->out, id);
+			output_putc(&sampler->out, '"');
+		}
+
+		output_puts(&sampler->out, values & (1ULL << i) ?
+						"=active" : "=inactive");
+	}
+
+	output_putc(&sampler->out, '\n');
+}
+
+static void sample_take(struct sampler *sampler)
+{
+	uint64_t timestamp_ns, values = 0, bits;
+	int i, j;
+
+	timestamp_ns = monotonic_ns();
+
+	for (i = 0; i < sampler->resolver->num_chips; i++) {
+		if (gpiod_line_request_get_values_mask(sampler->requests[i],
+						       sampler->masks[i],
+						       &bits))
+			die_perror("unable to read GPIO line values");
+
+		for (j = 0; bits; j++, bits >>= 1)
+			if (bits & 1)
+				values |= 1ULL << sampler->bits[i][j];
+	}
+
+	sample_put(sampler, timestamp_ns, values);
+	sampler->batched++;
+
+	if (sampler->batched == SAMPLE_BATCH_SIZE ||
+	    timestamp_ns - sampler->last_flush_ns >= SAMPLE_FLUSH_NS) {
+		output_flush(&sampler->out);
+		sampler->batched = 0;
+		sampler->last_flush_ns = timestamp_ns;
+	}
+}
+
+static void sample_lines(struct gpiod_line_request **requests,
+			 struct line_resolver *resolver, struct config *cfg)
+{
+	uint64_t start_ns, now_ns, deadline_ns, index, slot, missed = 0;
+	unsigned int taken = 0;
+	struct sampler *sampler;
+	int i, num_bits;
+	struct timespec ts;
+	int ret;
+
+	sampler = calloc(1, sizeof(*sampler));
+	if (!sampler)
+		die("out of memory");
+
+	sampler->masks = calloc(resolver->num_chips, sizeof(*sampler->masks));
+	sampler->bits = calloc(resolver->num_chips, sizeof(*sampler->bits));
+	if (!sampler->masks || !sampler->bits)
+		die("out of memory");
+
+	sampler->requests = requests;
+	sampler->resolver = resolver;
+	sampler->cfg = cfg;
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		num_bits = __builtin_popcountll(
+				sampler->masks[resolver->lines[i].chip_num]);
+		sampler->bits[resolver->lines[i].chip_num][num_bits] = i;
+		sampler->masks[resolver->lines[i].chip_num] |=
+							1ULL << num_bits;
+	}
+
+	catch_signals();
+
+	start_ns = sampler->last_flush_ns = monotonic_ns();
+
+	for (index = 0; !interrupted; index++) {
+		deadline_ns = sample_deadline(start_ns, index,
+					      cfg->sample_rate);
+		ts.tv_sec = deadline_ns / NSEC_PER_SEC;
+		ts.tv_nsec = deadline_ns % NSEC_PER_SEC;
+
+		do {
+			ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+					      &ts, NULL);
+		} while (ret == EINTR && !interrupted);
+
+		if (interrupted)
+			break;
+		if (ret) {
+			errno = ret;
+			die_perror("unable to wait for the next sample");
+		}
+
+		sample_take(sampler);
+
+		if (cfg->count && ++taken == cfg->count)
+			break;
+
+		/*
+		 * Being late for a single deadline is caught up with by
+		 * sampling right away. Deadlines passed entirely before
+		 * the next one are skipped.
+		 */
+		now_ns = monotonic_ns();
+		slot = (now_ns - start_ns) / NSEC_PER_SEC * cfg->sample_rate +
+		       (now_ns - start_ns) % NSEC_PER_SEC * cfg->sample_rate /
+								NSEC_PER_SEC;
+		if (slot > index + 1) {
+			missed += slot - index - 1;
+			index = slot - 1;
+		}
+	}
+
+	output_flush(&sampler->out);
+
+	if (missed)
+		print_error("unable to keep up with the sample rate, %" PRIu64
+			    " sample(s) missed", missed);
+
+	free(sampler->masks);
+	free(sampler->bits);
+	free(sampler);
+}
+
 int main(int argc, char **argv)
 {
 	struct gpiod_line_settings *settings;
 	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_request **requests;
 	struct gpiod_line_request *request;
 	struct gpiod_line_config *line_cfg;
 	struct line_resolver *resolver;
@@ -157,9 +423,14 @@ int main(int argc, char **argv)
 				 cfg.by_name);
 	validate_resolution(resolver, cfg.chip_id);
 
+	/* Samples are bitmaps of the values of all lines. */
+	if (cfg.sample_rate && resolver->num_lines > 64)
+		die("too many lines given");
+
 	offsets = calloc(resolver->num_lines, sizeof(*offsets));
 	values = calloc(resolver->num_lines, sizeof(*values));
-	if (!offsets || !values)
+	requests = calloc(resolver->num_chips, sizeof(*requests));
+	if (!offsets || !values || !requests)
 		die("out of memory");
 
 	settings = gpiod_line_settings_new();
@@ -174,6 +445,8 @@ int main(int argc, char **argv)
 	if (cfg.active_low)
 		gpiod_line_settings_set_active_low(settings, true);
 
+	apply_rt_config(&cfg.rt);
+
 	req_cfg = gpiod_request_config_new();
 	if (!req_cfg)
 		die_perror("unable to allocate the request config structure");
@@ -185,10 +458,7 @@ int main(int argc, char **argv)
 	gpiod_request_config_set_consumer(req_cfg, cfg.consumer);
 
 	for (i = 0; i < resolver->num_chips; i++) {
-		chip = gpiod_chip_open(resolver->chips[i].path);
-		if (!chip)
-			die_perror("unable to open chip '%s'",
-				   resolver->chips[i].path);
+		chip = resolver->chips[i].chip;
 
 		num_lines = get_line_offsets_and_values(resolver, i, offsets,
 							NULL);
@@ -203,6 +473,11 @@ int main(int argc, char **argv)
 		if (!request)
 			die_perror("unable to request lines");
 
+		if (cfg.sample_rate) {
+			requests[i] = request;
+			continue;
+		}
+
 		if (cfg.hold_period_us)
 			usleep(cfg.hold_period_us);
 
@@ -213,7 +488,18 @@ int main(int argc, char **argv)
 		set_line_values(resolver, i, values);
 
 		gpiod_line_request_release(request);
-		gpiod_chip_close(chip);
+	}
+
+	if (cfg.sample_rate) {
+		if (cfg.hold_period_us)
+			usleep(cfg.hold_period_us);
+
+		sample_lines(requests, resolver, &cfg);
+
+		for (i = 0; i < resolver->num_chips; i++)
+			gpiod_line_request_release(requests[i]);
+
+		goto out;
 	}
 
 	fmt = cfg.unquoted ? "%s=%s" : "\"%s\"=%s";
@@ -231,10 +517,12 @@ int main(int argc, char **argv)
 	}
 	printf("\n");
 
+out:
 	free_line_resolver(resolver);
 	gpiod_request_config_free(req_cfg);
 	gpiod_line_config_free(line_cfg);
 	gpiod_line_settings_free(settings);
+	free(requests);
 	free(offsets);
 	free(values);
 
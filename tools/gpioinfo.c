@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <errno.h>
 #include <getopt.h>
 #include <gpiod.h>
 #include <stdarg.h>
@@ -169,17 +170,18 @@ static void print_line_info(struct gpiod_line_info *info, bool unquoted_strings)
  * based on resolve_lines, but prints lines immediately rather than collecting
  * details in the resolver.
  */
-static void list_lines(struct line_resolver *resolver, struct gpiod_chip *chip,
+static void list_lines(struct line_resolver *resolver,
+		       struct chip_snapshot *snapshot, const char *path,
 		       int chip_num, struct config *cfg)
 {
-	struct gpiod_chip_info *chip_info;
+	struct gpiod_chip_info *chip_info = snapshot->info;
 	struct gpiod_line_info *info;
 	int offset, num_lines;
 
-	chip_info = gpiod_chip_get_info(chip);
-	if (!chip_info)
-		die_perror("unable to read info from chip %s",
-			   gpiod_chip_get_path(chip));
+	if (!chip_info) {
+		errno = snapshot->err;
+		die_perror("unable to read info from chip %s", path);
+	}
 
 	num_lines = gpiod_chip_info_get_num_lines(chip_info);
 
@@ -189,10 +191,14 @@ static void list_lines(struct line_resolver *resolver, struct gpiod_chip *chip,
 	for (offset = 0; ((offset < num_lines) &&
 			  !(resolver->num_lines && resolve_done(resolver)));
 	     offset++) {
-		info = gpiod_chip_get_line_info(chip, offset);
-		if (!info)
+		if ((unsigned int)offset >= snapshot->num_lines_read) {
+			errno = snapshot->err;
 			die_perror("unable to read info for line %d from %s",
 				   offset, gpiod_chip_info_get_name(chip_info));
+		}
+
+		info = gpiod_line_info_snapshot_get_line_info(snapshot->lines,
+							      offset);
 
 		if (resolver->num_lines &&
 		    !resolve_line(resolver, info, chip_num))
@@ -213,18 +219,15 @@ static void list_lines(struct line_resolver *resolver, struct gpiod_chip *chip,
 		fputc('\t', stdout);
 		print_line_info(info, cfg->unquoted_strings);
 		fputc('\n', stdout);
-		gpiod_line_info_free(info);
 		resolver->num_found++;
 	}
-
-	gpiod_chip_info_free(chip_info);
 }
 
 int main(int argc, char **argv)
 {
 	struct line_resolver *resolver = NULL;
 	int num_chips, i, ret = EXIT_SUCCESS;
-	struct gpiod_chip *chip;
+	struct chip_snapshot *snapshots;
 	struct config cfg;
 	char **paths;
 
@@ -242,12 +245,18 @@ int main(int argc, char **argv)
 	resolver = resolver_init(argc, argv, num_chips, cfg.strict,
 				 cfg.by_name);
 
+	/* Read all chips in parallel, then print them in order. */
+	snapshots = calloc(num_chips ?: 1, sizeof(*snapshots));
+	if (!snapshots)
+		die("out of memory");
+
+	read_chips(num_chips, paths, NULL, snapshots);
+
 	for (i = 0; i < num_chips; i++) {
-		chip = gpiod_chip_open(paths[i]);
-		if (chip) {
-			list_lines(resolver, chip, i, &cfg);
-			gpiod_chip_close(chip);
+		if (snapshots[i].chip) {
+			list_lines(resolver, &snapshots[i], paths[i], i, &cfg);
 		} else {
+			errno = snapshots[i].err;
 			print_perror("unable to open chip '%s'", paths[i]);
 
 			if (cfg.chip_id)
@@ -255,8 +264,10 @@ int main(int argc, char **argv)
 
 			ret = EXIT_FAILURE;
 		}
+		free_chip_snapshot(&snapshots[i]);
 		free(paths[i]);
 	}
+	free(snapshots);
 	free(paths);
 
 	validate_resolution(resolver, cfg.chip_id);
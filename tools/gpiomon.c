@@ -2,34 +2,56 @@
 // SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <gpiod.h>
 #include <inttypes.h>
-#include <poll.h>
+#include <math.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "tools-common.h"
 
-#define EVENT_BUF_SIZE 32
+/* Binary records are converted and written out in chunks of this many. */
+#define BINARY_BATCH_SIZE 32
+#define CAPTURE_DEFAULT_SIZE (1024 * 1024)
+#define STATS_DEFAULT_INTERVAL_US 1000000
+/* Edges a line may be ahead of the other before its timestamps are lost. */
+#define JITTER_PENDING 1024
 
 struct config {
 	bool active_low;
 	bool banner;
+	bool binary;
 	bool by_name;
+	bool jitter;
+	bool latency;
 	bool quiet;
+	bool stats;
 	bool strict;
 	bool unquoted;
 	enum gpiod_line_bias bias;
 	enum gpiod_line_edge edges;
 	int events_wanted;
 	unsigned int debounce_period_us;
+	unsigned int reorder_window_us;
+	unsigned int capture_size;
+	unsigned int stats_interval_us;
+	const char *capture_path;
 	const char *chip_id;
 	const char *consumer;
 	const char *fmt;
+	struct output_format *format;
 	enum gpiod_line_clock event_clock;
 	int timestamp_fmt;
+	struct rt_config rt;
 };
 
 static void print_help(void)
@@ -43,8 +65,12 @@ static void print_help(void)
 	printf("\n");
 	printf("Options:\n");
 	printf("      --banner\t\tdisplay a banner on successful startup\n");
+	printf("      --binary\t\twrite events as fixed-size binary records, one write\n");
+	printf("\t\t\tper batch of events (see below)\n");
 	print_bias_help();
 	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
+	printf("      --capture <file>\tstore events in a ring of binary records in a\n");
+	printf("\t\t\tpreallocated, memory-mapped file\n");
 	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
 	printf("  -C, --consumer <name>\tconsumer name applied to requested lines (default is 'gpiomon')\n");
 	printf("  -e, --edges <edges>\tspecify the edges to monitor\n");
@@ -57,18 +83,34 @@ static void print_help(void)
 	printf("\t\t\tBy default 'realtime' is formatted as UTC, others as raw u64.\n");
 	printf("  -h, --help\t\tdisplay this help and exit\n");
 	printf("  -F, --format <fmt>\tspecify a custom output format\n");
+	printf("      --jitter\t\tcompare the 'hte' timestamps of the first line with\n");
+	printf("\t\t\tthe 'monotonic' ones of the second, both fed the same\n");
+	printf("\t\t\tsignal, and print the results on exit (see below)\n");
 	printf("  -l, --active-low\ttreat the line as active low, flipping the sense of\n");
 	printf("\t\t\trising and falling edges\n");
+	printf("      --latency\t\tprint percentiles of the delay between the kernel\n");
+	printf("\t\t\ttimestamping events and gpiomon reading them per line\n");
+	printf("\t\t\ton exit - after num events or when interrupted\n");
 	printf("      --localtime\tformat event timestamps as local time\n");
 	printf("  -n, --num-events <num>\n");
 	printf("\t\t\texit after processing num events\n");
 	printf("  -p, --debounce-period <period>\n");
 	printf("\t\t\tdebounce the line(s) with the specified period\n");
 	printf("  -q, --quiet\t\tdon't generate any output\n");
+	printf("      --size <num>\tnumber of events the capture file holds\n");
+	printf("\t\t\t(default is %d)\n", CAPTURE_DEFAULT_SIZE);
+	printf("      --stats[=<period>]\n");
+	printf("\t\t\tprint statistics of the events on each line once per\n");
+	printf("\t\t\tperiod instead of the events themselves (see below)\n");
+	printf("\t\t\t(default period is 1s)\n");
 	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
 	printf("      --unquoted\tdon't quote line or consumer names\n");
 	printf("      --utc\t\tformat event timestamps as UTC (default for 'realtime')\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
+	printf("  -w, --reorder-window <period>\n");
+	printf("\t\t\tdelay events by up to period to print events from\n");
+	printf("\t\t\tmultiple chips in timestamp order\n");
+	print_rt_help();
 	print_chip_help();
 	print_period_help();
 	printf("\n");
@@ -81,6 +123,28 @@ static void print_help(void)
 	printf("  %%S   event timestamp as seconds\n");
 	printf("  %%U   event timestamp as UTC\n");
 	printf("  %%L   event timestamp as local time\n");
+	printf("\n");
+	printf("Binary records:\n");
+	printf("  Every event is a 32-byte record of little-endian fields: timestamp in\n");
+	printf("  nanoseconds (64 bits), chip index, line offset, numeric edge event type,\n");
+	printf("  global and line sequence numbers and a reserved zero (32 bits each).\n");
+	printf("  Chips holding the requested lines are indexed in the order of their paths.\n");
+	printf("  Capture files hold the same records, see tools-common.h for their layout.\n");
+	printf("\n");
+	printf("Statistics:\n");
+	printf("  For every line and period: the number of rising and falling edges, the\n");
+	printf("  event rate per second, the minimum and maximum interval between edges in\n");
+	printf("  nanoseconds (0 until two edges were seen) and the number of events dropped\n");
+	printf("  by the kernel, as detected from gaps in the line sequence numbers.\n");
+	printf("  The statistics of the last, partial period are printed on exit.\n");
+	printf("\n");
+	printf("Jitter:\n");
+	printf("  Edges of the two lines are paired by their line sequence numbers. Printed\n");
+	printf("  are the number of pairs, the offset from the 'hte' to the 'monotonic'\n");
+	printf("  clock taken from the pair with the least latency, the mean, standard\n");
+	printf("  deviation and maximum of the latency of the 'monotonic' timestamps on top\n");
+	printf("  of it, the number of edges left unpaired and of timestamps going backwards,\n");
+	printf("  all in nanoseconds.\n");
 }
 
 static int parse_edges_or_die(const char *option)
@@ -99,7 +163,7 @@ static int parse_event_clock_or_die(const char *option)
 {
 	if (strcmp(option, "realtime") == 0)
 		return GPIOD_LINE_CLOCK_REALTIME;
-	if (strcmp(option, "hte") != 0)
+	if (strcmp(option, "hte") == 0)
 		return GPIOD_LINE_CLOCK_HTE;
 	if (strcmp(option, "monotonic") != 0)
 		die("invalid event clock: %s", option);
@@ -109,13 +173,15 @@ static int parse_event_clock_or_die(const char *option)
 
 static int parse_config(int argc, char **argv, struct config *cfg)
 {
-	static const char *const shortopts = "+b:c:C:e:E:hF:ln:p:qshv";
+	static const char *const shortopts = "+b:c:C:e:E:hF:ln:p:qshvw:";
 
 	const struct option longopts[] = {
 		{ "active-low",	no_argument,	NULL,		'l' },
 		{ "banner",	no_argument,	NULL,		'-'},
+		{ "binary",	no_argument,	NULL,		'R'},
 		{ "bias",	required_argument, NULL,	'b' },
 		{ "by-name",	no_argument,	NULL,		'B'},
+		{ "capture",	required_argument, NULL,	'K' },
 		{ "chip",	required_argument, NULL,	'c' },
 		{ "consumer",	required_argument, NULL,	'C' },
 		{ "debounce-period", required_argument, NULL,	'p' },
@@ -123,20 +189,27 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		{ "event-clock", required_argument, NULL,	'E' },
 		{ "format",	required_argument, NULL,	'F' },
 		{ "help",	no_argument,	NULL,		'h' },
+		{ "jitter",	no_argument,	NULL,		'J' },
+		{ "latency",	no_argument,	NULL,		'L' },
 		{ "localtime",	no_argument,	&cfg->timestamp_fmt,	2 },
 		{ "num-events",	required_argument, NULL,	'n' },
 		{ "quiet",	no_argument,	NULL,		'q' },
+		{ "reorder-window", required_argument, NULL,	'w' },
 		{ "silent",	no_argument,	NULL,		'q' },
+		{ "size",	required_argument, NULL,	'Z' },
+		{ "stats",	optional_argument, NULL,	'S' },
 		{ "strict",	no_argument,	NULL,		's' },
 		{ "unquoted",	no_argument,	NULL,		'Q' },
 		{ "utc",	no_argument,	&cfg->timestamp_fmt,	1 },
 		{ "version",	no_argument,	NULL,		'v' },
+		RT_LONGOPTS,
 		{ GETOPT_NULL_LONGOPT },
 	};
 
 	int opti, optc;
 
 	memset(cfg, 0, sizeof(*cfg));
+	rt_config_init(&cfg->rt);
 	cfg->edges = GPIOD_LINE_EDGE_BOTH;
 	cfg->consumer = "gpiomon";
 
@@ -145,10 +218,32 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		if (optc < 0)
 			break;
 
+		if (parse_rt_option(optc, optarg, &cfg->rt))
+			continue;
+
 		switch (optc) {
 		case '-':
 			cfg->banner = true;
 			break;
+		case 'R':
+			cfg->binary = true;
+			break;
+		case 'K':
+			cfg->capture_path = optarg;
+			break;
+		case 'S':
+			cfg->stats = true;
+			cfg->stats_interval_us = optarg ?
+					parse_period_or_die(optarg) :
+					STATS_DEFAULT_INTERVAL_US;
+			if (!cfg->stats_interval_us)
+				die("statistics period must be positive");
+			break;
+		case 'Z':
+			cfg->capture_size = parse_uint_or_die(optarg);
+			if (!cfg->capture_size)
+				die("capture size must be positive");
+			break;
 		case 'b':
 			cfg->bias = parse_bias_or_die(optarg);
 			break;
@@ -170,9 +265,15 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'F':
 			cfg->fmt = optarg;
 			break;
+		case 'J':
+			cfg->jitter = true;
+			break;
 		case 'l':
 			cfg->active_low = true;
 			break;
+		case 'L':
+			cfg->latency = true;
+			break;
 		case 'n':
 			cfg->events_wanted = parse_uint_or_die(optarg);
 			break;
@@ -194,6 +295,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'v':
 			print_version();
 			exit(EXIT_SUCCESS);
+		case 'w':
+			cfg->reorder_window_us = parse_period_or_die(optarg);
+			break;
 		case '?':
 			die("try %s --help", get_progname());
 		case 0:
@@ -203,6 +307,24 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		}
 	}
 
+	/* Anything else printed would corrupt the stream of records. */
+	if (cfg->binary && (cfg->banner || cfg->fmt || cfg->latency))
+		die("--binary can't be combined with --banner, --format or --latency");
+
+	if (cfg->stats && (cfg->binary || cfg->fmt))
+		die("--stats can't be combined with --binary or --format");
+
+	/* The clocks are chosen per line and no events are printed. */
+	if (cfg->jitter && (cfg->binary || cfg->capture_path ||
+			    cfg->event_clock || cfg->fmt || cfg->stats))
+		die("--jitter can't be combined with --binary, --capture, --event-clock, --format or --stats");
+
+	if (cfg->capture_size && !cfg->capture_path)
+		die("--size requires --capture");
+
+	if (cfg->fmt)
+		cfg->format = parse_format(cfg->fmt, "ceElLoSU");
+
 	/* setup default clock/format combinations, where not overridden */
 	if (cfg->event_clock == 0) {
 		if (cfg->timestamp_fmt)
@@ -233,80 +355,65 @@ static void print_banner(int num_lines, char **lines)
 	}
 }
 
+/* Formatted events are collected here and written out once per batch. */
+static struct output_buffer output;
+
 static void event_print_formatted(struct gpiod_edge_event *event,
 				  struct line_resolver *resolver, int chip_num,
 				  struct config *cfg)
 {
-	const char *lname, *prev, *curr;
+	struct format_op *op;
 	unsigned int offset;
+	const char *lname;
 	uint64_t evtime;
 	int evtype;
-	char fmt;
+	size_t i;
 
 	offset = gpiod_edge_event_get_line_offset(event);
 	evtime = gpiod_edge_event_get_timestamp_ns(event);
 	evtype = gpiod_edge_event_get_event_type(event);
 
-	for (prev = curr = cfg->fmt;;) {
-		curr = strchr(curr, '%');
-		if (!curr) {
-			fputs(prev, stdout);
-			break;
-		}
-
-		if (prev != curr)
-			fwrite(prev, curr - prev, 1, stdout);
+	for (i = 0; i < cfg->format->num_ops; i++) {
+		op = &cfg->format->ops[i];
 
-		fmt = *(curr + 1);
-
-		switch (fmt) {
+		switch (op->spec) {
 		case 'c':
-			fputs(get_chip_name(resolver, chip_num), stdout);
+			output_puts(&output, get_chip_name(resolver, chip_num));
 			break;
 		case 'e':
-			printf("%d", evtype);
+			output_put_uint(&output, evtype);
 			break;
 		case 'E':
 			if (evtype == GPIOD_EDGE_EVENT_RISING_EDGE)
-				fputs("rising", stdout);
+				output_puts(&output, "rising");
 			else
-				fputs("falling", stdout);
+				output_puts(&output, "falling");
 			break;
 		case 'l':
 			lname = get_line_name(resolver, chip_num, offset);
 			if (!lname)
 				lname = "unnamed";
-			fputs(lname, stdout);
+			output_puts(&output, lname);
 			break;
 		case 'L':
-			print_event_time(evtime, 2);
+			output_put_event_time(&output, evtime, 2);
 			break;
 		case 'o':
-			printf("%u", offset);
+			output_put_uint(&output, offset);
 			break;
 		case 'S':
-			print_event_time(evtime, 0);
+			output_put_event_time(&output, evtime, 0);
 			break;
 		case 'U':
-			print_event_time(evtime, 1);
-			break;
-		case '%':
-			fputc('%', stdout);
+			output_put_event_time(&output, evtime, 1);
 			break;
-		case '\0':
-			fputc('%', stdout);
-			goto end;
 		default:
-			fwrite(curr, 2, 1, stdout);
+			output_write(&output, op->text, op->len);
 			break;
 		}
-
-		curr += 2;
-		prev = curr;
 	}
 
-end:
-	fputc('\n', stdout);
+	output_putc(&output, '\n');
 }
 
 static void event_print_human_readable(struct gpiod_edge_event *event,
@@ -344,20 +451,756 @@ static void event_print(struct gpiod_edge_event *event,
 		event_print_human_readable(event, resolver, chip_num, cfg);
 }
 
+static void binary_record_fill(struct binary_record *out,
+			       const struct gpiod_edge_event_record *rec,
+			       int chip_num)
+{
+	out->timestamp_ns = htole64(rec->timestamp_ns);
+	out->chip_num = htole32(chip_num);
+	out->offset = htole32(rec->line_offset);
+	out->event_type = htole32(rec->event_type);
+	out->global_seqno = htole32(rec->global_seqno);
+	out->line_seqno = htole32(rec->line_seqno);
+	out->reserved = 0;
+}
+
+static void binary_write(const struct binary_record *records, size_t num,
+			 struct config *cfg)
+{
+	const char *pos = (const char *)records;
+	size_t left = num * sizeof(*records);
+	ssize_t written;
+
+	if (cfg->quiet)
+		return;
+
+	while (left) {
+		written = write(STDOUT_FILENO, pos, left);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+
+			die_perror("unable to write events");
+		}
+
+		pos += written;
+		left -= written;
+	}
+}
+
+struct capture {
+	struct capture_header *hdr;
+	uint64_t *index;
+	struct binary_record *records;
+	uint64_t capacity;
+	uint64_t head;
+	size_t map_size;
+};
+
+static void capture_copy_name(char *dst, const char *src)
+{
+	strncpy(dst, src ?: "", CAPTURE_NAME_SIZE - 1);
+	dst[CAPTURE_NAME_SIZE - 1] = '\0';
+}
+
+static struct capture *capture_open(const char *path, uint64_t capacity,
+				    struct line_resolver *resolver,
+				    enum gpiod_line_clock event_clock)
+{
+	uint64_t index_offset, records_offset, num_checkpoints;
+	struct resolved_line *line;
+	struct capture_line *cline;
+	struct capture *cap;
+	long page_size;
+	void *map;
+	int fd, ret, i;
+
+	page_size = sysconf(_SC_PAGESIZE);
+	num_checkpoints = (capacity + CAPTURE_CHECKPOINT_INTERVAL - 1) /
+			  CAPTURE_CHECKPOINT_INTERVAL;
+	index_offset = sizeof(struct capture_header);
+	records_offset = index_offset + num_checkpoints * sizeof(uint64_t);
+	records_offset = (records_offset + page_size - 1) / page_size *
+			 page_size;
+
+	cap = calloc(1, sizeof(*cap));
+	if (!cap)
+		die("out of memory");
+
+	cap->capacity = capacity;
+	cap->map_size = records_offset +
+			capacity * sizeof(struct binary_record);
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+		die_perror("unable to open the capture file %s", path);
+
+	/* Reserve the disk space so that the capture can't run out of it. */
+	ret = posix_fallocate(fd, 0, cap->map_size);
+	if (ret) {
+		errno = ret;
+		die_perror("unable to allocate the capture file %s", path);
+	}
+
+	map = mmap(NULL, cap->map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		   fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		die_perror("unable to map the capture file %s", path);
+
+	cap->hdr = map;
+	cap->index = (uint64_t *)((char *)map + index_offset);
+	cap->records = (struct binary_record *)((char *)map + records_offset);
+
+	memcpy(cap->hdr->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+	cap->hdr->version = htole32(CAPTURE_VERSION);
+	cap->hdr->record_size = htole32(sizeof(struct binary_record));
+	cap->hdr->capacity = htole64(capacity);
+	cap->hdr->index_offset = htole64(index_offset);
+	cap->hdr->records_offset = htole64(records_offset);
+	cap->hdr->checkpoint_interval = htole32(CAPTURE_CHECKPOINT_INTERVAL);
+	cap->hdr->num_lines = htole32(resolver->num_lines);
+	cap->hdr->event_clock = htole32(event_clock);
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		line = &resolver->lines[i];
+		cline = &cap->hdr->lines[i];
+
+		cline->chip_num = htole32(line->chip_num);
+		cline->offset = htole32(line->offset);
+		capture_copy_name(cline->chip_name,
+				  get_chip_name(resolver, line->chip_num));
+		capture_copy_name(cline->line_name,
+				  gpiod_line_info_get_name(line->info));
+	}
+
+	return cap;
+}
+
+static void capture_add(struct capture *cap,
+			const struct gpiod_edge_event_record *rec, int chip_num)
+{
+	uint64_t slot = cap->head % cap->capacity;
+
+	binary_record_fill(&cap->records[slot], rec, chip_num);
+
+	if (slot % CAPTURE_CHECKPOINT_INTERVAL == 0)
+		cap->index[slot / CAPTURE_CHECKPOINT_INTERVAL] =
+						htole64(rec->timestamp_ns);
+
+	cap->head++;
+}
+
+static void capture_commit(struct capture *cap)
+{
+	cap->hdr->head = htole64(cap->head);
+}
+
+static void capture_close(struct capture *cap)
+{
+	capture_commit(cap);
+
+	if (msync(cap->hdr, cap->map_size, MS_SYNC))
+		die_perror("unable to sync the capture file");
+
+	munmap(cap->hdr, cap->map_size);
+	free(cap);
+}
+
+/* Events of a single line aggregated over the current statistics period. */
+struct line_stats {
+	uint64_t rising;
+	uint64_t falling;
+	uint64_t min_interval_ns;
+	uint64_t max_interval_ns;
+	uint64_t dropped;
+	/* Kept across periods to measure the intervals spanning them. */
+	uint64_t last_timestamp_ns;
+	unsigned long last_seqno;
+	bool seen;
+};
+
+struct stats {
+	struct line_resolver *resolver;
+	struct config *cfg;
+	/* Indexed like the lines of the resolver. */
+	struct line_stats *lines;
+	uint64_t interval_ns;
+	uint64_t start_ns;
+	uint64_t period_start_ns;
+	uint64_t deadline_ns;
+	bool pending;
+};
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static struct stats *stats_new(struct line_resolver *resolver,
+			       struct config *cfg)
+{
+	struct stats *stats;
+
+	stats = calloc(1, sizeof(*stats));
+	if (!stats)
+		die("out of memory");
+
+	stats->lines = calloc(resolver->num_lines, sizeof(*stats->lines));
+	if (!stats->lines)
+		die("out of memory");
+
+	stats->resolver = resolver;
+	stats->cfg = cfg;
+	stats->interval_ns = (uint64_t)cfg->stats_interval_us * 1000;
+	stats->start_ns = stats->period_start_ns = monotonic_ns();
+	stats->deadline_ns = stats->start_ns + stats->interval_ns;
+
+	return stats;
+}
+
+static void stats_free(struct stats *stats)
+{
+	free(stats->lines);
+	free(stats);
+}
+
+static void stats_add(struct stats *stats,
+		      const struct gpiod_edge_event_record *rec, int chip_num)
+{
+	struct resolved_line *line;
+	struct line_stats *ls;
+	uint64_t interval;
+	int i;
+
+	for (i = 0; i < stats->resolver->num_lines; i++) {
+		line = &stats->resolver->lines[i];
+		if (line->chip_num == chip_num &&
+		    line->offset == rec->line_offset)
+			break;
+	}
+
+	if (i == stats->resolver->num_lines)
+		return;
+
+	ls = &stats->lines[i];
+
+	if (rec->event_type == GPIOD_EDGE_EVENT_RISING_EDGE)
+		ls->rising++;
+	else
+		ls->falling++;
+
+	if (ls->seen) {
+		interval = rec->timestamp_ns - ls->last_timestamp_ns;
+		if (!ls->min_interval_ns || interval < ls->min_interval_ns)
+			ls->min_interval_ns = interval;
+		if (interval > ls->max_interval_ns)
+			ls->max_interval_ns = interval;
+
+		if (rec->line_seqno > ls->last_seqno + 1)
+			ls->dropped += rec->line_seqno - ls->last_seqno - 1;
+	}
+
+	ls->last_timestamp_ns = rec->timestamp_ns;
+	ls->last_seqno = rec->line_seqno;
+	ls->seen = true;
+	stats->pending = true;
+}
+
+static void stats_print(struct stats *stats, uint64_t now_ns)
+{
+	double elapsed = (now_ns - stats->period_start_ns) / 1e9;
+	struct resolved_line *line;
+	struct line_stats *ls;
+	int i;
+
+	for (i = 0; i < stats->resolver->num_lines; i++) {
+		line = &stats->resolver->lines[i];
+		ls = &stats->lines[i];
+
+		if (!stats->cfg->quiet) {
+			printf("%.3f\t", (now_ns - stats->start_ns) / 1e9);
+			print_line_id(stats->resolver, line->chip_num,
+				      line->offset, stats->cfg->chip_id,
+				      stats->cfg->unquoted);
+			printf("\trising=%" PRIu64 " falling=%" PRIu64
+			       " rate=%.1f min=%" PRIu64 " max=%" PRIu64
+			       " dropped=%" PRIu64 "\n",
+			       ls->rising, ls->falling,
+			       elapsed > 0 ?
+					(ls->rising + ls->falling) / elapsed :
+					0.0,
+			       ls->min_interval_ns, ls->max_interval_ns,
+			       ls->dropped);
+		}
+
+		ls->rising = ls->falling = ls->dropped = 0;
+		ls->min_interval_ns = ls->max_interval_ns = 0;
+	}
+
+	stats->period_start_ns = now_ns;
+	stats->pending = false;
+}
+
+/* Timeout for waiting for events, bounded by the end of the period. */
+static int64_t stats_timeout(struct stats *stats)
+{
+	uint64_t now_ns;
+
+	if (!stats)
+		return -1;
+
+	now_ns = monotonic_ns();
+
+	return stats->deadline_ns > now_ns ? stats->deadline_ns - now_ns : 0;
+}
+
+static void stats_tick(struct stats *stats)
+{
+	uint64_t now_ns;
+
+	if (!stats)
+		return;
+
+	now_ns = monotonic_ns();
+	if (now_ns < stats->deadline_ns)
+		return;
+
+	stats_print(stats, now_ns);
+
+	/* Skip the periods missed, e.g. while the process was stopped. */
+	while (stats->deadline_ns <= now_ns)
+		stats->deadline_ns += stats->interval_ns;
+}
+
+/* Timestamp of an edge of one line waiting for the same edge of the other. */
+struct jitter_edge {
+	uint64_t timestamp_ns;
+	unsigned long seqno;
+	bool pending;
+};
+
+struct jitter_line {
+	struct jitter_edge pending[JITTER_PENDING];
+	uint64_t last_timestamp_ns;
+	uint64_t backwards;
+	bool seen;
+};
+
+/*
+ * The first line is timestamped by the hardware timestamp engine and serves as
+ * the reference, the second one with the monotonic clock.
+ */
+struct jitter {
+	struct line_resolver *resolver;
+	struct gpiod_clock_converter *conv;
+	struct jitter_line lines[2];
+	uint64_t unpaired;
+	/* Running mean and sum of squared deviations of the differences. */
+	double mean_ns;
+	double m2_ns;
+};
+
+static struct jitter *jitter_new(struct line_resolver *resolver)
+{
+	struct jitter *jitter;
+
+	if (resolver->num_lines != 2)
+		die("--jitter requires exactly two lines");
+
+	jitter = calloc(1, sizeof(*jitter));
+	if (!jitter)
+		die("out of memory");
+
+	jitter->resolver = resolver;
+	jitter->conv = gpiod_clock_converter_new_calibrated(
+					GPIOD_LINE_CLOCK_HTE,
+					GPIOD_LINE_CLOCK_MONOTONIC);
+	if (!jitter->conv)
+		die_perror("unable to create the clock converter");
+
+	return jitter;
+}
+
+static void jitter_free(struct jitter *jitter)
+{
+	gpiod_clock_converter_free(jitter->conv);
+	free(jitter);
+}
+
+static bool is_jitter_reference(struct line_resolver *resolver, int chip_num,
+				unsigned int offset)
+{
+	return resolver->lines[0].chip_num == chip_num &&
+	       resolver->lines[0].offset == offset;
+}
+
+static void jitter_pair(struct jitter *jitter, uint64_t hte_ns, uint64_t mono_ns)
+{
+	uint64_t num_pairs;
+	double delta;
+
+	gpiod_clock_converter_add_pair(jitter->conv, hte_ns, mono_ns);
+
+	num_pairs = gpiod_clock_converter_get_num_pairs(jitter->conv);
+	delta = (double)(int64_t)(mono_ns - hte_ns) - jitter->mean_ns;
+	jitter->mean_ns += delta / num_pairs;
+	jitter->m2_ns += delta * ((double)(int64_t)(mono_ns - hte_ns) -
+				  jitter->mean_ns);
+}
+
+static void jitter_add(struct jitter *jitter,
+		       const struct gpiod_edge_event_record *rec, int chip_num)
+{
+	struct jitter_edge *edge, *other;
+	struct jitter_line *line;
+	int this;
+
+	this = is_jitter_reference(jitter->resolver, chip_num,
+				   rec->line_offset) ? 0 : 1;
+	line = &jitter->lines[this];
+
+	if (line->seen && rec->timestamp_ns < line->last_timestamp_ns)
+		line->backwards++;
+
+	line->last_timestamp_ns = rec->timestamp_ns;
+	line->seen = true;
+
+	/* Both lines see the same edges so their sequence numbers match. */
+	other = &jitter->lines[!this].pending[rec->line_seqno % JITTER_PENDING];
+	if (other->pending && other->seqno == rec->line_seqno) {
+		other->pending = false;
+
+		if (this == 0)
+			jitter_pair(jitter, rec->timestamp_ns,
+				    other->timestamp_ns);
+		else
+			jitter_pair(jitter, other->timestamp_ns,
+				    rec->timestamp_ns);
+
+		return;
+	}
+
+	edge = &line->pending[rec->line_seqno % JITTER_PENDING];
+	if (edge->pending)
+		jitter->unpaired++;
+
+	edge->timestamp_ns = rec->timestamp_ns;
+	edge->seqno = rec->line_seqno;
+	edge->pending = true;
+}
+
+static void jitter_print(struct jitter *jitter)
+{
+	uint64_t num_pairs, unpaired = jitter->unpaired;
+	int i, j;
+
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < JITTER_PENDING; j++)
+			unpaired += jitter->lines[i].pending[j].pending;
+	}
+
+	num_pairs = gpiod_clock_converter_get_num_pairs(jitter->conv);
+
+	printf("pairs=%" PRIu64 " offset=%" PRId64
+	       " mean=%.1f stddev=%.1f max=%" PRIu64 " unpaired=%" PRIu64
+	       " backwards=%" PRIu64 "/%" PRIu64 " (ns)\n",
+	       num_pairs, gpiod_clock_converter_get_offset_ns(jitter->conv),
+	       num_pairs ? jitter->mean_ns -
+			(double)gpiod_clock_converter_get_offset_ns(
+					jitter->conv) :
+			0.0,
+	       num_pairs > 1 ? sqrt(jitter->m2_ns / (num_pairs - 1)) : 0.0,
+	       gpiod_clock_converter_get_error_ns(jitter->conv), unpaired,
+	       jitter->lines[0].backwards, jitter->lines[1].backwards);
+}
+
+static volatile sig_atomic_t interrupted;
+
+static void handle_signal(int signum UNUSED)
+{
+	interrupted = 1;
+}
+
+/* Stop monitoring on the first signal, a second one terminates as usual. */
+static void catch_signals(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_signal;
+	sa.sa_flags = SA_RESETHAND;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(SIGINT, &sa, NULL) || sigaction(SIGTERM, &sa, NULL))
+		die_perror("unable to install signal handlers");
+}
+
+static bool wait_interrupted(int ret)
+{
+	return ret < 0 && errno == EINTR && interrupted;
+}
+
+static void print_latency(struct gpiod_line_request *request,
+			  struct line_resolver *resolver, int chip_num,
+			  unsigned int *offsets, struct config *cfg)
+{
+	static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+	struct gpiod_latency_histogram *hist;
+	int num_lines, i;
+	size_t j;
+
+	num_lines = get_line_offsets_and_values(resolver, chip_num, offsets,
+						NULL);
+
+	for (i = 0; i < num_lines; i++) {
+		hist = gpiod_line_request_get_latency_histogram(request,
+								offsets[i]);
+		if (!hist)
+			die_perror("unable to retrieve the latency histogram");
+
+		print_line_id(resolver, chip_num, offsets[i], cfg->chip_id,
+			      cfg->unquoted);
+		printf("\tsamples=%" PRIu64,
+		       gpiod_latency_histogram_get_num_samples(hist));
+		printf(" min=%" PRIu64,
+		       gpiod_latency_histogram_get_min_ns(hist));
+
+		for (j = 0; j < sizeof(percentiles) / sizeof(*percentiles); j++)
+			printf(" p%g=%" PRIu64, percentiles[j],
+			       gpiod_latency_histogram_get_percentile_ns(
+					hist, percentiles[j]));
+
+		printf(" max=%" PRIu64 " (ns)\n",
+		       gpiod_latency_histogram_get_max_ns(hist));
+
+		gpiod_latency_histogram_free(hist);
+	}
+}
+
+struct monitor {
+	struct line_resolver *resolver;
+	struct config *cfg;
+	struct capture *capture;
+	struct stats *stats;
+	struct jitter *jitter;
+	int events_done;
+	bool done;
+};
+
+/* Per-request context passed to the event loop callback. */
+struct monitored_chip {
+	struct monitor *mon;
+	int chip_num;
+};
+
+static int handle_edge_events(struct gpiod_line_request *request UNUSED,
+			      struct gpiod_edge_event_buffer *buffer,
+			      size_t num_events, void *user_data)
+{
+	struct monitored_chip *mchip = user_data;
+	const struct gpiod_edge_event_record *records;
+	struct binary_record batch[BINARY_BATCH_SIZE];
+	struct monitor *mon = mchip->mon;
+	struct gpiod_edge_event *event;
+	size_t i, num_batched = 0;
+
+	if (mon->cfg->events_wanted &&
+	    num_events > (size_t)(mon->cfg->events_wanted - mon->events_done))
+		num_events = mon->cfg->events_wanted - mon->events_done;
+
+	records = gpiod_edge_event_buffer_get_records(buffer);
+
+	if (mon->capture) {
+		for (i = 0; i < num_events; i++)
+			capture_add(mon->capture, &records[i],
+				    mchip->chip_num);
+
+		capture_commit(mon->capture);
+	}
+
+	if (mon->stats) {
+		for (i = 0; i < num_events; i++)
+			stats_add(mon->stats, &records[i], mchip->chip_num);
+	} else if (mon->jitter) {
+		for (i = 0; i < num_events; i++)
+			jitter_add(mon->jitter, &records[i], mchip->chip_num);
+	} else if (mon->cfg->binary) {
+		/* The loop's buffer grows with the batches read from the chip. */
+		for (i = 0; i < num_events; i++) {
+			binary_record_fill(&batch[num_batched++], &records[i],
+					   mchip->chip_num);
+
+			if (num_batched == BINARY_BATCH_SIZE) {
+				binary_write(batch, num_batched, mon->cfg);
+				num_batched = 0;
+			}
+		}
+
+		if (num_batched)
+			binary_write(batch, num_batched, mon->cfg);
+	} else {
+		for (i = 0; i < num_events; i++) {
+			event = gpiod_edge_event_buffer_get_event(buffer, i);
+			if (!event)
+				die_perror("unable to retrieve event from buffer");
+
+			event_print(event, mon->resolver, mchip->chip_num,
+				    mon->cfg);
+		}
+
+		output_flush(&output);
+	}
+
+	mon->events_done += num_events;
+
+	if (mon->cfg->events_wanted &&
+	    mon->events_done >= mon->cfg->events_wanted)
+		mon->done = true;
+
+	return mon->done ? 1 : 0;
+}
+
+static int chip_num_of_request(struct gpiod_line_request **requests,
+			       int num_chips,
+			       struct gpiod_line_request *request)
+{
+	int i;
+
+	for (i = 0; i < num_chips; i++) {
+		if (requests[i] == request)
+			return i;
+	}
+
+	die("event from unknown request");
+}
+
+/*
+ * Events from different chips are read in the order in which the chips become
+ * readable. Route them through a merger to print them in timestamp order.
+ */
+static void monitor_merged(struct monitor *mon,
+			   struct gpiod_line_request **requests, int num_chips)
+{
+	const struct gpiod_edge_event_record *records;
+	struct binary_record batch[BINARY_BATCH_SIZE];
+	int ret, i, num_events, chip_num, num_batched;
+	struct gpiod_edge_event_buffer *buffer;
+	struct gpiod_event_merger *merger;
+	struct gpiod_line_request *request;
+	struct gpiod_edge_event *event;
+
+	merger = gpiod_event_merger_new(mon->cfg->event_clock,
+					(uint64_t)mon->cfg->reorder_window_us *
+						1000,
+					0);
+	if (!merger)
+		die_perror("unable to create the event merger");
+
+	buffer = gpiod_edge_event_buffer_new(0);
+	if (!buffer)
+		die_perror("unable to allocate the line event buffer");
+
+	for (i = 0; i < num_chips; i++) {
+		ret = gpiod_event_merger_add_request(merger, requests[i]);
+		if (ret)
+			die_perror("unable to merge events of chip %s",
+				   mon->resolver->chips[i].path);
+	}
+
+	while (!mon->done) {
+		fflush(stdout);
+
+		ret = gpiod_event_merger_wait_edge_events(
+					merger, stats_timeout(mon->stats));
+		if (wait_interrupted(ret))
+			break;
+		if (ret < 0)
+			die_perror("error waiting for events");
+
+		stats_tick(mon->stats);
+		if (ret == 0)
+			continue;
+
+		num_events = gpiod_event_merger_read_edge_events(
+				merger, buffer,
+				gpiod_edge_event_buffer_get_capacity(buffer));
+		if (num_events < 0)
+			die_perror("error reading edge events");
+
+		records = gpiod_edge_event_buffer_get_records(buffer);
+		num_batched = 0;
+
+		for (i = 0; i < num_events && !mon->done; i++) {
+			event = gpiod_edge_event_buffer_get_event(buffer, i);
+			request = gpiod_event_merger_get_event_request(merger,
+								       i);
+			if (!event || !request)
+				die_perror("unable to retrieve merged event");
+
+			chip_num = chip_num_of_request(requests, num_chips,
+						       request);
+
+			if (mon->capture)
+				capture_add(mon->capture, &records[i],
+					    chip_num);
+
+			if (mon->stats)
+				stats_add(mon->stats, &records[i], chip_num);
+			else if (mon->jitter)
+				jitter_add(mon->jitter, &records[i], chip_num);
+			else if (mon->cfg->binary)
+				binary_record_fill(&batch[num_batched++],
+						   &records[i], chip_num);
+			else
+				event_print(event, mon->resolver, chip_num,
+					    mon->cfg);
+
+			mon->events_done++;
+
+			if (num_batched == BINARY_BATCH_SIZE) {
+				binary_write(batch, num_batched, mon->cfg);
+				num_batched = 0;
+			}
+
+			if (mon->cfg->events_wanted &&
+			    mon->events_done >= mon->cfg->events_wanted)
+				mon->done = true;
+		}
+
+		if (mon->capture)
+			capture_commit(mon->capture);
+
+		if (mon->cfg->binary) {
+			if (num_batched)
+				binary_write(batch, num_batched, mon->cfg);
+		} else if (!mon->stats && !mon->jitter) {
+			output_flush(&output);
+		}
+	}
+
+	gpiod_edge_event_buffer_free(buffer);
+	gpiod_event_merger_free(merger);
+}
+
 int main(int argc, char **argv)
 {
-	struct gpiod_edge_event_buffer *event_buffer;
 	struct gpiod_line_settings *settings;
 	struct gpiod_request_config *req_cfg;
 	struct gpiod_line_request **requests;
 	struct gpiod_line_config *line_cfg;
-	int num_lines, events_done = 0;
-	struct gpiod_edge_event *event;
+	struct monitored_chip *mchips;
+	struct gpiod_event_loop *loop;
 	struct line_resolver *resolver;
+	struct monitor mon = { 0 };
 	struct gpiod_chip *chip;
-	struct pollfd *pollfds;
 	unsigned int *offsets;
 	struct config cfg;
+	int num_lines;
 	int ret, i, j;
 
 	i = parse_config(argc, argv, &cfg);
@@ -396,90 +1239,138 @@ int main(int argc, char **argv)
 		die_perror("unable to allocate the request config structure");
 
 	gpiod_request_config_set_consumer(req_cfg, cfg.consumer);
+	gpiod_request_config_set_latency_histogram(req_cfg, cfg.latency);
 
-	event_buffer = gpiod_edge_event_buffer_new(EVENT_BUF_SIZE);
-	if (!event_buffer)
-		die_perror("unable to allocate the line event buffer");
+	loop = gpiod_event_loop_new(0);
+	if (!loop)
+		die_perror("unable to create the event loop");
 
 	resolver = resolve_lines(argc, argv, cfg.chip_id, cfg.strict,
 				 cfg.by_name);
 	validate_resolution(resolver, cfg.chip_id);
 	requests = calloc(resolver->num_chips, sizeof(*requests));
-	pollfds = calloc(resolver->num_chips, sizeof(*pollfds));
+	mchips = calloc(resolver->num_chips, sizeof(*mchips));
 	offsets = calloc(resolver->num_lines, sizeof(*offsets));
-	if (!requests || !pollfds || !offsets)
+	if (!requests || !mchips || !offsets)
 		die("out of memory");
 
+	mon.resolver = resolver;
+	mon.cfg = &cfg;
+
+	if (cfg.stats)
+		mon.stats = stats_new(resolver, &cfg);
+
+	if (cfg.jitter)
+		mon.jitter = jitter_new(resolver);
+
+	if (cfg.capture_path)
+		mon.capture = capture_open(cfg.capture_path,
+					   cfg.capture_size ?:
+						CAPTURE_DEFAULT_SIZE,
+					   resolver, cfg.event_clock);
+
 	for (i = 0; i < resolver->num_chips; i++) {
 		num_lines = get_line_offsets_and_values(resolver, i, offsets,
 							NULL);
 		gpiod_line_config_reset(line_cfg);
-		ret = gpiod_line_config_add_line_settings(line_cfg, offsets,
-							  num_lines, settings);
-		if (ret)
-			die_perror("unable to add line settings");
 
-		chip = gpiod_chip_open(resolver->chips[i].path);
-		if (!chip)
-			die_perror("unable to open chip '%s'",
-				   resolver->chips[i].path);
+		for (j = 0; mon.jitter && j < num_lines; j++) {
+			gpiod_line_settings_set_event_clock(settings,
+				is_jitter_reference(resolver, i, offsets[j]) ?
+					GPIOD_LINE_CLOCK_HTE :
+					GPIOD_LINE_CLOCK_MONOTONIC);
+			ret = gpiod_line_config_add_line_settings(
+					line_cfg, &offsets[j], 1, settings);
+			if (ret)
+				die_perror("unable to add line settings");
+		}
+
+		if (!mon.jitter) {
+			ret = gpiod_line_config_add_line_settings(
+					line_cfg, offsets, num_lines, settings);
+			if (ret)
+				die_perror("unable to add line settings");
+		}
+
+		chip = resolver->chips[i].chip;
 
 		requests[i] = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
 		if (!requests[i])
 			die_perror("unable to request lines on chip %s",
 				   resolver->chips[i].path);
 
-		pollfds[i].fd = gpiod_line_request_get_fd(requests[i]);
-		pollfds[i].events = POLLIN;
-		gpiod_chip_close(chip);
+		mchips[i].mon = &mon;
+		mchips[i].chip_num = i;
+
+		if (!cfg.reorder_window_us) {
+			ret = gpiod_event_loop_add_request(loop, requests[i],
+							   handle_edge_events,
+							   &mchips[i]);
+			if (ret)
+				die_perror("unable to watch lines on chip %s",
+					   resolver->chips[i].path);
+		}
 	}
 
 	gpiod_request_config_free(req_cfg);
 	gpiod_line_config_free(line_cfg);
 	gpiod_line_settings_free(settings);
 
+	/* Captures are synced to disk and statistics printed on exit. */
+	if (cfg.latency || cfg.capture_path || cfg.stats || cfg.jitter)
+		catch_signals();
+
+	apply_rt_config(&cfg.rt);
+
 	if (cfg.banner)
 		print_banner(argc, argv);
 
-	for (;;) {
+	if (cfg.reorder_window_us)
+		monitor_merged(&mon, requests, resolver->num_chips);
+
+	while (!mon.done && !interrupted) {
 		fflush(stdout);
 
-		if (poll(pollfds, resolver->num_chips, -1) < 0)
-			die_perror("error polling for events");
+		ret = gpiod_event_loop_wait(loop, stats_timeout(mon.stats));
+		if (wait_interrupted(ret))
+			break;
+		if (ret < 0)
+			die_perror("error waiting for events");
 
-		for (i = 0; i < resolver->num_chips; i++) {
-			if (pollfds[i].revents == 0)
-				continue;
+		stats_tick(mon.stats);
+	}
 
-			ret = gpiod_line_request_read_edge_events(requests[i],
-					 event_buffer, EVENT_BUF_SIZE);
-			if (ret < 0)
-				die_perror("error reading line events");
+	if (mon.stats) {
+		if (mon.stats->pending)
+			stats_print(mon.stats, monotonic_ns());
 
-			for (j = 0; j < ret; j++) {
-				event = gpiod_edge_event_buffer_get_event(
-						event_buffer, j);
-				if (!event)
-					die_perror("unable to retrieve event from buffer");
+		stats_free(mon.stats);
+	}
 
-				event_print(event, resolver, i, &cfg);
+	if (mon.jitter) {
+		if (!cfg.quiet)
+			jitter_print(mon.jitter);
 
-				events_done++;
+		jitter_free(mon.jitter);
+	}
 
-				if (cfg.events_wanted &&
-				    events_done >= cfg.events_wanted)
-					goto done;
-			}
-		}
+	if (cfg.latency) {
+		for (i = 0; i < resolver->num_chips; i++)
+			print_latency(requests[i], resolver, i, offsets, &cfg);
 	}
 
-done:
+	if (mon.capture)
+		capture_close(mon.capture);
+
+	gpiod_event_loop_free(loop);
+	free_format(cfg.format);
+
 	for (i = 0; i < resolver->num_chips; i++)
 		gpiod_line_request_release(requests[i]);
 
 	free(requests);
+	free(mchips);
 	free_line_resolver(resolver);
-	gpiod_edge_event_buffer_free(event_buffer);
 	free(offsets);
 
 	return EXIT_SUCCESS;
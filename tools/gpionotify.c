@@ -22,7 +22,9 @@ struct config {
 	int events_wanted;
 	const char *chip_id;
 	const char *fmt;
+	struct output_format *format;
 	int timestamp_fmt;
+	unsigned int coalesce_us;
 };
 
 static void print_help(void)
@@ -38,6 +40,9 @@ static void print_help(void)
 	printf("      --banner\t\tdisplay a banner on successful startup\n");
 	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
 	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
+	printf("      --coalesce <period>\n");
+	printf("\t\t\tmerge the events of every line occurring within period\n");
+	printf("\t\t\tof its first one and only report the net change\n");
 	printf("  -e, --event <event>\tspecify the events to monitor\n");
 	printf("\t\t\tPossible values: 'requested', 'released', 'reconfigured'.\n");
 	printf("\t\t\t(default is all events)\n");
@@ -52,6 +57,7 @@ static void print_help(void)
 	printf("      --utc\t\tconvert event timestamps to UTC\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
 	print_chip_help();
+	print_period_help();
 	printf("\n");
 	printf("Format specifiers:\n");
 	printf("  %%o   GPIO line offset\n");
@@ -64,6 +70,7 @@ static void print_help(void)
 	printf("  %%S   event timestamp as seconds\n");
 	printf("  %%U   event timestamp as UTC\n");
 	printf("  %%L   event timestamp as local time\n");
+	printf("  %%n   number of events merged into the event (always '1' without --coalesce)\n");
 }
 
 static int parse_event_type_or_die(const char *option)
@@ -86,6 +93,7 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		{ "banner",	no_argument,	NULL,		'-'},
 		{ "by-name",	no_argument,	NULL,		'B'},
 		{ "chip",	required_argument, NULL,	'c' },
+		{ "coalesce",	required_argument, NULL,	'W' },
 		{ "event",	required_argument, NULL,	'e' },
 		{ "format",	required_argument, NULL,	'F' },
 		{ "help",	no_argument,	NULL,		'h' },
@@ -119,6 +127,11 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 'c':
 			cfg->chip_id = optarg;
 			break;
+		case 'W':
+			cfg->coalesce_us = parse_period_or_die(optarg);
+			if (!cfg->coalesce_us)
+				die("coalescing period must be positive");
+			break;
 		case 'e':
 			cfg->event_type = parse_event_type_or_die(optarg);
 			break;
@@ -152,6 +165,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		}
 	}
 
+	if (cfg->fmt)
+		cfg->format = parse_format(cfg->fmt, "acCeElLnoSU");
+
 	return optind;
 }
 
@@ -171,21 +187,17 @@ static void print_banner(int num_lines, char **lines)
 	}
 }
 
-static void print_event_type(int evtype)
+static const char *event_type_name(int evtype)
 {
 	switch (evtype) {
 	case GPIOD_INFO_EVENT_LINE_REQUESTED:
-		fputs("requested", stdout);
-		break;
+		return "requested";
 	case GPIOD_INFO_EVENT_LINE_RELEASED:
-		fputs("released", stdout);
-		break;
+		return "released";
 	case GPIOD_INFO_EVENT_LINE_CONFIG_CHANGED:
-		fputs("reconfigured", stdout);
-		break;
+		return "reconfigured";
 	default:
-		fputs("unknown", stdout);
-		break;
+		return "unknown";
 	}
 }
 
@@ -193,68 +205,61 @@ static void print_event_type(int evtype)
  * A convenience function to map clock monotonic to realtime, as uAPI only
  * supports CLOCK_MONOTONIC.
  *
- * Samples the realtime clock on either side of a monotonic sample and averages
- * the realtime samples to estimate the offset between the two clocks.
- * Any time shifts between the two realtime samples will result in the
- * monotonic time being mapped to the average of the before and after, so
- * half way between the old and new times.
+ * The offset between the clocks is measured once and reused until it's a
+ * second old, so clock steps show up in the output with at most that delay.
  *
  * Any CPU suspension between the event being generated and converted will
  * result in the returned time being shifted by the period of suspension.
  */
 static uint64_t monotonic_to_realtime(uint64_t evtime)
 {
-	uint64_t before, after, mono;
-	struct timespec ts;
-
-	clock_gettime(CLOCK_REALTIME, &ts);
-	before = ts.tv_nsec + ((uint64_t)ts.tv_sec) * 1000000000;
-
-	clock_gettime(CLOCK_MONOTONIC, &ts);
-	mono = ts.tv_nsec + ((uint64_t)ts.tv_sec) * 1000000000;
+	static struct gpiod_clock_converter *conv;
 
-	clock_gettime(CLOCK_REALTIME, &ts);
-	after = ts.tv_nsec + ((uint64_t)ts.tv_sec) * 1000000000;
-
-	evtime += (after / 2 - mono + before / 2);
+	if (!conv) {
+		conv = gpiod_clock_converter_new(GPIOD_LINE_CLOCK_MONOTONIC,
+						 GPIOD_LINE_CLOCK_REALTIME);
+		if (!conv)
+			die_perror("unable to create clock converter");
+	}
 
-	return evtime;
+	return gpiod_clock_converter_convert_one(conv, evtime);
 }
 
+/* Formatted events are collected here and written out once per batch. */
+static struct output_buffer output;
+
 static void event_print_formatted(struct gpiod_info_event *event,
+				  unsigned long num_merged,
 				  struct line_resolver *resolver, int chip_num,
 				  struct config *cfg)
 {
-	const char *lname, *prev, *curr, *consumer;
+	const char *lname, *consumer;
 	struct gpiod_line_info *info;
+	struct format_op *op;
 	unsigned int offset;
 	uint64_t evtime;
 	int evtype;
-	char fmt;
+	size_t i;
 
 	info = gpiod_info_event_get_line_info(event);
 	evtime = gpiod_info_event_get_timestamp_ns(event);
 	evtype = gpiod_info_event_get_event_type(event);
 	offset = gpiod_line_info_get_offset(info);
 
-	for (prev = curr = cfg->fmt;;) {
-		curr = strchr(curr, '%');
-		if (!curr) {
-			fputs(prev, stdout);
-			break;
-		}
-
-		if (prev != curr)
-			fwrite(prev, curr - prev, 1, stdout);
+	for (i = 0; i < cfg->format->num_ops; i++) {
+		op = &cfg->format->ops[i];
 
-		fmt = *(curr + 1);
-
-		switch (fmt) {
+		switch (op->spec) {
 		case 'a':
+			/*
+			 * Attributes are printed through stdio, which
+			 * output_flush() drains first, to keep the order.
+			 */
+			output_flush(&output);
 			print_line_attributes(info, cfg->unquoted);
 			break;
 		case 'c':
-			fputs(get_chip_name(resolver, chip_num), stdout);
+			output_puts(&output, get_chip_name(resolver, chip_num));
 			break;
 		case 'C':
 			if (!gpiod_line_info_is_used(info)) {
@@ -264,52 +269,48 @@ static void event_print_formatted(struct gpiod_info_event *event,
 				if (!consumer)
 					consumer = "kernel";
 			}
-			fputs(consumer, stdout);
+			output_puts(&output, consumer);
 			break;
 		case 'e':
-			printf("%d", evtype);
+			output_put_uint(&output, evtype);
 			break;
 		case 'E':
-			print_event_type(evtype);
+			output_puts(&output, event_type_name(evtype));
 			break;
 		case 'l':
 			lname = gpiod_line_info_get_name(info);
 			if (!lname)
 				lname = "unnamed";
-			fputs(lname, stdout);
+			output_puts(&output, lname);
 			break;
 		case 'L':
-			print_event_time(monotonic_to_realtime(evtime), 2);
+			output_put_event_time(&output,
+					      monotonic_to_realtime(evtime), 2);
+			break;
+		case 'n':
+			output_put_uint(&output, num_merged);
 			break;
 		case 'o':
-			printf("%u", offset);
+			output_put_uint(&output, offset);
 			break;
 		case 'S':
-			print_event_time(evtime, 0);
+			output_put_event_time(&output, evtime, 0);
 			break;
 		case 'U':
-			print_event_time(monotonic_to_realtime(evtime), 1);
+			output_put_event_time(&output,
+					      monotonic_to_realtime(evtime), 1);
 			break;
-		case '%':
-			fputc('%', stdout);
-			break;
-		case '\0':
-			fputc('%', stdout);
-			goto end;
 		default:
-			fwrite(curr, 2, 1, stdout);
+			output_write(&output, op->text, op->len);
 			break;
 		}
-
-		curr += 2;
-		prev = curr;
 	}
 
-end:
-	fputc('\n', stdout);
+	output_putc(&output, '\n');
 }
 
 static void event_print_human_readable(struct gpiod_info_event *event,
+				       unsigned long num_merged,
 				       struct line_resolver *resolver,
 				       int chip_num, struct config *cfg)
 {
@@ -344,10 +345,13 @@ static void event_print_human_readable(struct gpiod_info_event *event,
 	print_event_time(evtime, cfg->timestamp_fmt);
 	printf("\t%s\t", evname);
 	print_line_id(resolver, chip_num, offset, cfg->chip_id, cfg->unquoted);
+	if (num_merged > 1)
+		printf("\t(%lu events)", num_merged);
 	fputc('\n', stdout);
 }
 
 static void event_print(struct gpiod_info_event *event,
+			unsigned long num_merged,
 			struct line_resolver *resolver, int chip_num,
 			struct config *cfg)
 {
@@ -355,20 +359,152 @@ static void event_print(struct gpiod_info_event *event,
 		return;
 
 	if (cfg->fmt)
-		event_print_formatted(event, resolver, chip_num, cfg);
+		event_print_formatted(event, num_merged, resolver, chip_num,
+				      cfg);
 	else
-		event_print_human_readable(event, resolver, chip_num, cfg);
+		event_print_human_readable(event, num_merged, resolver,
+					   chip_num, cfg);
+}
+
+struct notifier {
+	struct line_resolver *resolver;
+	struct config *cfg;
+	int events_done;
+	bool done;
+};
+
+/* Per-chip context passed to the event loop callback. */
+struct watched_chip {
+	struct notifier *notifier;
+	int chip_num;
+};
+
+/* Returns true once the wanted number of events has been processed. */
+static bool handle_info_event(struct notifier *notifier, int chip_num,
+			      struct gpiod_info_event *event,
+			      unsigned long num_merged)
+{
+	struct config *cfg = notifier->cfg;
+	int evtype;
+
+	if (cfg->event_type) {
+		evtype = gpiod_info_event_get_event_type(event);
+		if (evtype != cfg->event_type)
+			return false;
+	}
+
+	event_print(event, num_merged, notifier->resolver, chip_num, cfg);
+
+	notifier->events_done++;
+
+	if (cfg->events_wanted &&
+	    notifier->events_done >= cfg->events_wanted)
+		notifier->done = true;
+
+	return notifier->done;
+}
+
+static int handle_info_events(struct gpiod_chip *chip UNUSED,
+			      struct gpiod_info_event_buffer *buffer,
+			      size_t num_events, void *user_data)
+{
+	struct watched_chip *wchip = user_data;
+	struct gpiod_info_event *event;
+	size_t i;
+
+	for (i = 0; i < num_events; i++) {
+		event = gpiod_info_event_buffer_get_event(buffer, i);
+		if (!event)
+			die_perror("unable to retrieve event from buffer");
+
+		if (handle_info_event(wchip->notifier, wchip->chip_num, event,
+				      1))
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * With --coalesce, the events of every chip go through a coalescer instead of
+ * the event loop, which also wakes us up when the window of a line elapses.
+ */
+static void watch_coalesced(struct notifier *notifier)
+{
+	struct gpiod_info_event_coalescer **coalescers;
+	struct line_resolver *resolver = notifier->resolver;
+	struct gpiod_info_event_buffer *buffer;
+	struct gpiod_info_event *event;
+	struct pollfd *pollfds;
+	int i, j, ret;
+
+	coalescers = calloc(resolver->num_chips, sizeof(*coalescers));
+	pollfds = calloc(resolver->num_chips, sizeof(*pollfds));
+	if (!coalescers || !pollfds)
+		die("out of memory");
+
+	buffer = gpiod_info_event_buffer_new(0);
+	if (!buffer)
+		die_perror("unable to allocate the info event buffer");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		coalescers[i] = gpiod_info_event_coalescer_new(
+				resolver->chips[i].chip,
+				(uint64_t)notifier->cfg->coalesce_us * 1000);
+		if (!coalescers[i])
+			die_perror("unable to coalesce events of chip '%s'",
+				   resolver->chips[i].path);
+
+		pollfds[i].fd = gpiod_info_event_coalescer_get_fd(
+							coalescers[i]);
+		pollfds[i].events = POLLIN;
+	}
+
+	while (!notifier->done) {
+		output_flush(&output);
+
+		ret = poll(pollfds, resolver->num_chips, -1);
+		if (ret < 0)
+			die_perror("error waiting for events");
+
+		for (i = 0; i < resolver->num_chips && !notifier->done; i++) {
+			if (!pollfds[i].revents)
+				continue;
+
+			ret = gpiod_info_event_coalescer_read_info_events(
+					coalescers[i], buffer,
+					gpiod_info_event_buffer_get_capacity(
+								buffer));
+			if (ret < 0)
+				die_perror("error reading info events");
+
+			for (j = 0; j < ret; j++) {
+				event = gpiod_info_event_buffer_get_event(
+								buffer, j);
+				if (handle_info_event(notifier, i, event,
+					gpiod_info_event_coalescer_get_num_merged(
+							coalescers[i], j)))
+					break;
+			}
+		}
+	}
+
+	for (i = 0; i < resolver->num_chips; i++)
+		gpiod_info_event_coalescer_free(coalescers[i]);
+	gpiod_info_event_buffer_free(buffer);
+	free(pollfds);
+	free(coalescers);
 }
 
 int main(int argc, char **argv)
 {
-	int i, j, events_done = 0, evtype;
 	struct line_resolver *resolver;
-	struct gpiod_info_event *event;
-	struct gpiod_chip **chips;
+	struct notifier notifier = { 0 };
+	struct watched_chip *wchips;
+	struct gpiod_event_loop *loop;
 	struct gpiod_chip *chip;
-	struct pollfd *pollfds;
 	struct config cfg;
+	int i, j, ret;
 
 	i = parse_config(argc, argv, &cfg);
 	argc -= optind;
@@ -380,19 +516,22 @@ int main(int argc, char **argv)
 	if (argc > 64)
 		die("too many lines given");
 
+	loop = gpiod_event_loop_new(0);
+	if (!loop)
+		die_perror("unable to create the event loop");
+
 	resolver = resolve_lines(argc, argv, cfg.chip_id, cfg.strict,
 				 cfg.by_name);
 	validate_resolution(resolver, cfg.chip_id);
-	chips = calloc(resolver->num_chips, sizeof(*chips));
-	pollfds = calloc(resolver->num_chips, sizeof(*pollfds));
-	if (!pollfds)
+	wchips = calloc(resolver->num_chips, sizeof(*wchips));
+	if (!wchips)
 		die("out of memory");
 
+	notifier.resolver = resolver;
+	notifier.cfg = &cfg;
+
 	for (i = 0; i < resolver->num_chips; i++) {
-		chip = gpiod_chip_open(resolver->chips[i].path);
-		if (!chip)
-			die_perror("unable to open chip '%s'",
-				   resolver->chips[i].path);
+		chip = resolver->chips[i].chip;
 
 		for (j = 0; j < resolver->num_lines; j++)
 			if ((resolver->lines[j].chip_num == i) &&
@@ -401,49 +540,41 @@ int main(int argc, char **argv)
 				die_perror("unable to watch line on chip '%s'",
 					   resolver->chips[i].path);
 
-		chips[i] = chip;
-		pollfds[i].fd = gpiod_chip_get_fd(chip);
-		pollfds[i].events = POLLIN;
+		if (cfg.coalesce_us)
+			continue;
+
+		wchips[i].notifier = &notifier;
+		wchips[i].chip_num = i;
+
+		ret = gpiod_event_loop_add_chip_batched(loop, chip,
+							handle_info_events,
+							&wchips[i]);
+		if (ret)
+			die_perror("unable to watch chip '%s'",
+				   resolver->chips[i].path);
 	}
 
 	if (cfg.banner)
 		print_banner(argc, argv);
 
-	for (;;) {
-		fflush(stdout);
-
-		if (poll(pollfds, resolver->num_chips, -1) < 0)
-			die_perror("error polling for events");
-
-		for (i = 0; i < resolver->num_chips; i++) {
-			if (pollfds[i].revents == 0)
-				continue;
-
-			event = gpiod_chip_read_info_event(chips[i]);
-			if (!event)
-				die_perror("unable to retrieve chip event");
+	if (cfg.coalesce_us)
+		watch_coalesced(&notifier);
 
-			if (cfg.event_type) {
-				evtype = gpiod_info_event_get_event_type(event);
-				if (evtype != cfg.event_type)
-					continue;
-			}
+	/* Events of all ready chips are printed with a single write. */
+	while (!notifier.done) {
+		output_flush(&output);
 
-			event_print(event, resolver, i, &cfg);
-
-			events_done++;
-
-			if (cfg.events_wanted &&
-			    events_done >= cfg.events_wanted)
-				goto done;
-		}
+		ret = gpiod_event_loop_wait(loop, -1);
+		if (ret < 0)
+			die_perror("error waiting for events");
 	}
-done:
-	for (i = 0; i < resolver->num_chips; i++)
-		gpiod_chip_close(chips[i]);
 
-	free(chips);
+	output_flush(&output);
+
+	gpiod_event_loop_free(loop);
+	free(wchips);
 	free_line_resolver(resolver);
+	free_format(cfg.format);
 
 	return EXIT_SUCCESS;
 }
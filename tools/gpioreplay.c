@@ -0,0 +1,686 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// SPDX-FileCopyrightText: 2017-2021 Bartosz Golaszewski <bartekgola@gmail.com>
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <gpiod.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tools-common.h"
+
+struct config {
+	bool active_low;
+	bool banner;
+	bool by_name;
+	bool quiet;
+	bool strict;
+	enum gpiod_line_drive drive;
+	const char *chip_id;
+	const char *consumer;
+};
+
+static void print_help(void)
+{
+	printf("Usage: %s [OPTIONS] <file> <source=line>...\n", get_progname());
+	printf("\n");
+	printf("Replay edge events recorded by gpiomon onto GPIO output lines.\n");
+	printf("\n");
+	printf("The file holds either binary records written with 'gpiomon --binary' or is\n");
+	printf("a capture file written with 'gpiomon --capture'. Each source is a recorded\n");
+	printf("line given as [chip index:]offset, the chip index defaults to 0. Lines\n");
+	printf("recorded in capture files may also be given by name. Recorded lines which\n");
+	printf("are not mapped are ignored.\n");
+	printf("\n");
+	printf("Output lines are specified by name, or optionally by offset if the chip\n");
+	printf("option is provided. Rising edges set the line active, falling edges\n");
+	printf("inactive. The relative timing of the events is reproduced and the error\n");
+	printf("achieved is reported when the replay completes.\n");
+	printf("\n");
+	printf("Options:\n");
+	printf("      --banner\t\tdisplay a banner on successful startup\n");
+	printf("      --by-name\t\ttreat lines as names even if they would parse as an offset\n");
+	printf("  -c, --chip <chip>\trestrict scope to a particular chip\n");
+	printf("  -C, --consumer <name>\tconsumer name applied to requested lines (default is 'gpioreplay')\n");
+	printf("  -d, --drive <drive>\tspecify the line drive mode\n");
+	printf("\t\t\tPossible values: 'push-pull', 'open-drain', 'open-source'.\n");
+	printf("\t\t\t(default is 'push-pull')\n");
+	printf("  -h, --help\t\tdisplay this help and exit\n");
+	printf("  -l, --active-low\ttreat the line as active low\n");
+	printf("  -q, --quiet\t\tdon't report the timing error\n");
+	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
+	printf("  -v, --version\t\toutput version information and exit\n");
+	print_chip_help();
+	printf("\n");
+	printf("Timing error:\n");
+	printf("  The delay by which each step of the replay missed its deadline, as the\n");
+	printf("  number of steps and the minimum, percentiles and maximum in nanoseconds.\n");
+	printf("  Events recorded at the same time on lines of the same chip are applied\n");
+	printf("  in a single step.\n");
+}
+
+static int parse_drive_or_die(const char *option)
+{
+	if (strcmp(option, "open-drain") == 0)
+		return GPIOD_LINE_DRIVE_OPEN_DRAIN;
+	if (strcmp(option, "open-source") == 0)
+		return GPIOD_LINE_DRIVE_OPEN_SOURCE;
+	if (strcmp(option, "push-pull") != 0)
+		die("invalid drive: %s", option);
+
+	return 0;
+}
+
+static int parse_config(int argc, char **argv, struct config *cfg)
+{
+	static const struct option longopts[] = {
+		{ "active-low",	no_argument,		NULL,	'l' },
+		{ "banner",	no_argument,		NULL,	'-'},
+		{ "by-name",	no_argument,		NULL,	'B' },
+		{ "chip",	required_argument,	NULL,	'c' },
+		{ "consumer",	required_argument,	NULL,	'C' },
+		{ "drive",	required_argument,	NULL,	'd' },
+		{ "help",	no_argument,		NULL,	'h' },
+		{ "quiet",	no_argument,		NULL,	'q' },
+		{ "silent",	no_argument,		NULL,	'q' },
+		{ "strict",	no_argument,		NULL,	's' },
+		{ "version",	no_argument,		NULL,	'v' },
+		{ GETOPT_NULL_LONGOPT },
+	};
+
+	static const char *const shortopts = "+c:C:d:hlqsv";
+
+	int opti, optc;
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->consumer = "gpioreplay";
+
+	for (;;) {
+		optc = getopt_long(argc, argv, shortopts, longopts, &opti);
+		if (optc < 0)
+			break;
+
+		switch (optc) {
+		case '-':
+			cfg->banner = true;
+			break;
+		case 'B':
+			cfg->by_name = true;
+			break;
+		case 'c':
+			cfg->chip_id = optarg;
+			break;
+		case 'C':
+			cfg->consumer = optarg;
+			break;
+		case 'd':
+			cfg->drive = parse_drive_or_die(optarg);
+			break;
+		case 'l':
+			cfg->active_low = true;
+			break;
+		case 'q':
+			cfg->quiet = true;
+			break;
+		case 's':
+			cfg->strict = true;
+			break;
+		case 'h':
+			print_help();
+			exit(EXIT_SUCCESS);
+		case 'v':
+			print_version();
+			exit(EXIT_SUCCESS);
+		case '?':
+			die("try %s --help", get_progname());
+		case 0:
+			break;
+		default:
+			abort();
+		}
+	}
+
+	return optind;
+}
+
+/* Recorded events in the order of the file, capture rings already unwrapped. */
+struct recording {
+	struct binary_record *records;
+	size_t num_records;
+	/* Recorded lines, only known for capture files. */
+	struct capture_line *lines;
+	unsigned int num_lines;
+	void *map;
+	size_t map_size;
+};
+
+static void load_capture(struct recording *rec, const char *path)
+{
+	const struct capture_header *hdr = rec->map;
+	uint64_t capacity, head, first, records_offset, i;
+	const struct binary_record *ring;
+
+	if (rec->map_size < sizeof(*hdr) ||
+	    le32toh(hdr->version) != CAPTURE_VERSION ||
+	    le32toh(hdr->record_size) != sizeof(struct binary_record))
+		die("unsupported capture file: %s", path);
+
+	capacity = le64toh(hdr->capacity);
+	head = le64toh(hdr->head);
+	records_offset = le64toh(hdr->records_offset);
+
+	if (!capacity || records_offset > rec->map_size ||
+	    (rec->map_size - records_offset) / sizeof(*ring) < capacity)
+		die("truncated capture file: %s", path);
+
+	/* Only the relative timing is replayed, any clock domain will do. */
+	rec->num_lines = le32toh(hdr->num_lines);
+	if (rec->num_lines > CAPTURE_MAX_LINES ||
+	    le32toh(hdr->event_clock) < GPIOD_LINE_CLOCK_MONOTONIC ||
+	    le32toh(hdr->event_clock) > GPIOD_LINE_CLOCK_HTE)
+		die("corrupted capture file: %s", path);
+
+	rec->lines = calloc(rec->num_lines ?: 1, sizeof(*rec->lines));
+	if (!rec->lines)
+		die("out of memory");
+
+	memcpy(rec->lines, hdr->lines, rec->num_lines * sizeof(*rec->lines));
+
+	/* Once the ring wrapped, the oldest record is in the slot at head. */
+	first = head > capacity ? head - capacity : 0;
+	rec->num_records = head - first;
+	rec->records = calloc(rec->num_records ?: 1, sizeof(*rec->records));
+	if (!rec->records)
+		die("out of memory");
+
+	ring = (const struct binary_record *)((char *)rec->map +
+					      records_offset);
+	for (i = first; i < head; i++)
+		rec->records[i - first] = ring[i % capacity];
+}
+
+static void load_recording(struct recording *rec, const char *path)
+{
+	struct stat st;
+	int fd;
+
+	memset(rec, 0, sizeof(*rec));
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		die_perror("unable to open %s", path);
+
+	if (fstat(fd, &st))
+		die_perror("unable to stat %s", path);
+
+	if (!st.st_size)
+		die("no events recorded in %s", path);
+
+	rec->map_size = st.st_size;
+	rec->map = mmap(NULL, rec->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (rec->map == MAP_FAILED)
+		die_perror("unable to map %s", path);
+
+	if (rec->map_size >= sizeof(CAPTURE_MAGIC) &&
+	    memcmp(rec->map, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0) {
+		load_capture(rec, path);
+		return;
+	}
+
+	if (rec->map_size % sizeof(struct binary_record))
+		die("%s is neither a capture file nor a stream of binary records",
+		    path);
+
+	rec->num_records = rec->map_size / sizeof(struct binary_record);
+	rec->records = calloc(rec->num_records, sizeof(*rec->records));
+	if (!rec->records)
+		die("out of memory");
+
+	memcpy(rec->records, rec->map, rec->map_size);
+}
+
+static void free_recording(struct recording *rec)
+{
+	munmap(rec->map, rec->map_size);
+	free(rec->records);
+	free(rec->lines);
+}
+
+/* Recorded line driving one of the output lines. */
+struct source {
+	unsigned int chip_num;
+	unsigned int offset;
+};
+
+static void parse_source_or_die(const char *id, struct recording *rec,
+				struct source *src)
+{
+	const char *sep;
+	unsigned int i;
+	char *num;
+	int val;
+
+	for (i = 0; i < rec->num_lines; i++) {
+		if (strncmp(rec->lines[i].line_name, id,
+			    CAPTURE_NAME_SIZE) == 0) {
+			src->chip_num = le32toh(rec->lines[i].chip_num);
+			src->offset = le32toh(rec->lines[i].offset);
+			return;
+		}
+	}
+
+	sep = strchr(id, ':');
+	if (!sep) {
+		src->chip_num = 0;
+		val = parse_uint(id);
+	} else {
+		num = strndup(id, sep - id);
+		if (!num)
+			die("out of memory");
+
+		val = parse_uint(num);
+		free(num);
+		if (val < 0)
+			die("invalid recorded line: %s", id);
+
+		src->chip_num = val;
+		val = parse_uint(sep + 1);
+	}
+
+	if (val < 0)
+		die("invalid recorded line: %s", id);
+
+	src->offset = val;
+}
+
+static void parse_mappings_or_die(int num_mappings, char **mappings,
+				  struct recording *rec, char **lines,
+				  struct source *sources)
+{
+	char *line;
+	int i;
+
+	for (i = 0; i < num_mappings; i++) {
+		line = strchr(mappings[i], '=');
+		if (!line || line == mappings[i] || line[1] == '\0')
+			die("invalid mapping: %s", mappings[i]);
+
+		*line = '\0';
+		lines[i] = line + 1;
+		parse_source_or_die(mappings[i], rec, &sources[i]);
+	}
+}
+
+/* Recorded event of one of the mapped lines. */
+struct replay_event {
+	uint64_t timestamp_ns;
+	/* Position in the file, keeps the sort stable. */
+	size_t seqno;
+	/* Index of the output line in the resolver. */
+	int line;
+	bool rising;
+};
+
+static int replay_event_cmp(const void *p1, const void *p2)
+{
+	const struct replay_event *ev1 = p1, *ev2 = p2;
+
+	if (ev1->timestamp_ns != ev2->timestamp_ns)
+		return ev1->timestamp_ns < ev2->timestamp_ns ? -1 : 1;
+
+	return ev1->seqno < ev2->seqno ? -1 : ev1->seqno > ev2->seqno;
+}
+
+/*
+ * Pick the events of the mapped lines and sort them by timestamp. Events of
+ * lines on different chips are written by gpiomon a batch at a time, so they
+ * need not be in order in the file.
+ */
+static size_t collect_events(struct recording *rec, struct source *sources,
+			     int num_sources, struct replay_event **events_ptr)
+{
+	size_t i, num_events = 0, max_events = 0;
+	const struct binary_record *record;
+	struct replay_event *events = NULL;
+	int j;
+
+	for (i = 0; i < rec->num_records; i++) {
+		record = &rec->records[i];
+
+		/* A recorded line may drive more than one output line. */
+		for (j = 0; j < num_sources; j++) {
+			if (sources[j].chip_num != le32toh(record->chip_num) ||
+			    sources[j].offset != le32toh(record->offset))
+				continue;
+
+			if (num_events == max_events) {
+				max_events = max_events ? max_events * 2 : 1024;
+				events = realloc(events,
+						 max_events * sizeof(*events));
+				if (!events)
+					die("out of memory");
+			}
+
+			events[num_events].timestamp_ns =
+					le64toh(record->timestamp_ns);
+			events[num_events].seqno = i;
+			events[num_events].line = j;
+			events[num_events].rising =
+				le32toh(record->event_type) ==
+					GPIOD_EDGE_EVENT_RISING_EDGE;
+			num_events++;
+		}
+	}
+
+	qsort(events, num_events, sizeof(*events), replay_event_cmp);
+	*events_ptr = events;
+
+	return num_events;
+}
+
+/*
+ * Start every line in the state preceding its first event, so that the first
+ * event recorded is also the first transition replayed.
+ */
+static void set_initial_values(struct line_resolver *resolver,
+			       struct replay_event *events, size_t num_events)
+{
+	bool *seen;
+	size_t i;
+
+	seen = calloc(resolver->num_lines, sizeof(*seen));
+	if (!seen)
+		die("out of memory");
+
+	for (i = 0; i < (size_t)resolver->num_lines; i++)
+		resolver->lines[i].value = GPIOD_LINE_VALUE_INACTIVE;
+
+	for (i = 0; i < num_events; i++) {
+		if (seen[events[i].line])
+			continue;
+
+		seen[events[i].line] = true;
+		resolver->lines[events[i].line].value =
+			events[i].rising ? GPIOD_LINE_VALUE_INACTIVE :
+					   GPIOD_LINE_VALUE_ACTIVE;
+	}
+
+	free(seen);
+}
+
+/* Bit of the line in the request-relative bitmasks of its chip's request. */
+static uint64_t line_mask(struct line_resolver *resolver, int line)
+{
+	int i, bit = 0;
+
+	for (i = 0; i < line; i++)
+		if (resolver->lines[i].chip_num ==
+		    resolver->lines[line].chip_num)
+			bit++;
+
+	return 1ULL << bit;
+}
+
+static struct gpiod_waveform *
+build_waveform(struct line_resolver *resolver,
+	       struct gpiod_line_request **requests,
+	       struct replay_event *events, size_t num_events)
+{
+	uint64_t start_ns, time_ns = 0, mask = 0, values = 0, bit;
+	struct gpiod_waveform *waveform;
+	int chip_num = -1, line_chip;
+	size_t i;
+
+	waveform = gpiod_waveform_new();
+	if (!waveform)
+		die_perror("unable to allocate the waveform");
+
+	start_ns = events[0].timestamp_ns;
+
+	for (i = 0; i < num_events; i++) {
+		line_chip = resolver->lines[events[i].line].chip_num;
+
+		/* Merge events of the same request falling due together. */
+		if (mask && (events[i].timestamp_ns - start_ns != time_ns ||
+			     line_chip != chip_num)) {
+			if (gpiod_waveform_add_step(waveform,
+						    requests[chip_num],
+						    time_ns, mask, values))
+				die_perror("unable to add a waveform step");
+
+			mask = values = 0;
+		}
+
+		time_ns = events[i].timestamp_ns - start_ns;
+		chip_num = line_chip;
+		bit = line_mask(resolver, events[i].line);
+		mask |= bit;
+		if (events[i].rising)
+			values |= bit;
+		else
+			values &= ~bit;
+	}
+
+	if (gpiod_waveform_add_step(waveform, requests[chip_num], time_ns,
+				    mask, values))
+		die_perror("unable to add a waveform step");
+
+	return waveform;
+}
+
+struct timing {
+	int64_t *lateness_ns;
+	size_t num_steps;
+};
+
+static int record_lateness(size_t step, uint64_t cycle UNUSED,
+			   int64_t lateness_ns, void *user_data)
+{
+	struct timing *timing = user_data;
+
+	timing->lateness_ns[step] = lateness_ns;
+	timing->num_steps = step + 1;
+
+	return 0;
+}
+
+static int lateness_cmp(const void *p1, const void *p2)
+{
+	int64_t l1 = *(const int64_t *)p1, l2 = *(const int64_t *)p2;
+
+	return l1 < l2 ? -1 : l1 > l2;
+}
+
+static void print_timing(struct timing *timing)
+{
+	static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+	size_t i, idx;
+
+	qsort(timing->lateness_ns, timing->num_steps,
+	      sizeof(*timing->lateness_ns), lateness_cmp);
+
+	printf("steps=%zu min=%" PRId64, timing->num_steps,
+	       timing->lateness_ns[0]);
+
+	for (i = 0; i < ARRAY_SIZE(percentiles); i++) {
+		idx = (size_t)(percentiles[i] / 100.0 *
+			       (timing->num_steps - 1) + 0.5);
+		printf(" p%g=%" PRId64, percentiles[i],
+		       timing->lateness_ns[idx]);
+	}
+
+	printf(" max=%" PRId64 " (ns)\n",
+	       timing->lateness_ns[timing->num_steps - 1]);
+}
+
+static void print_banner(int num_lines, char **lines)
+{
+	int i;
+
+	if (num_lines > 1) {
+		printf("Replaying onto lines ");
+
+		for (i = 0; i < num_lines - 1; i++)
+			printf("'%s', ", lines[i]);
+
+		printf("and '%s'...\n", lines[i]);
+	} else {
+		printf("Replaying onto line '%s'...\n", lines[0]);
+	}
+
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	struct gpiod_line_settings *settings;
+	struct gpiod_request_config *req_cfg;
+	struct gpiod_line_request **requests;
+	struct gpiod_line_config *line_cfg;
+	struct line_resolver *resolver;
+	struct gpiod_waveform *waveform;
+	struct replay_event *events;
+	enum gpiod_line_value *values;
+	struct recording recording;
+	struct source *sources;
+	struct timing timing;
+	struct gpiod_chip *chip;
+	int i, num_lines, ret;
+	unsigned int *offsets;
+	struct config cfg;
+	size_t num_events;
+	char **lines;
+
+	i = parse_config(argc, argv, &cfg);
+	argc -= i;
+	argv += i;
+
+	if (argc < 1)
+		die("the recorded event file must be specified");
+
+	if (argc < 2)
+		die("at least one line mapping must be specified");
+
+	load_recording(&recording, argv[0]);
+	argc--;
+	argv++;
+
+	num_lines = argc;
+
+	lines = calloc(num_lines, sizeof(*lines));
+	sources = calloc(num_lines, sizeof(*sources));
+	if (!lines || !sources)
+		die("out of memory");
+
+	parse_mappings_or_die(argc, argv, &recording, lines, sources);
+
+	num_events = collect_events(&recording, sources, num_lines, &events);
+	if (!num_events)
+		die("no events recorded for the mapped lines");
+
+	resolver = resolve_lines(num_lines, lines, cfg.chip_id, cfg.strict,
+				 cfg.by_name);
+	validate_resolution(resolver, cfg.chip_id);
+	set_initial_values(resolver, events, num_events);
+
+	settings = gpiod_line_settings_new();
+	if (!settings)
+		die_perror("unable to allocate line settings");
+
+	if (cfg.drive)
+		gpiod_line_settings_set_drive(settings, cfg.drive);
+
+	if (cfg.active_low)
+		gpiod_line_settings_set_active_low(settings, true);
+
+	gpiod_line_settings_set_direction(settings,
+					  GPIOD_LINE_DIRECTION_OUTPUT);
+
+	req_cfg = gpiod_request_config_new();
+	if (!req_cfg)
+		die_perror("unable to allocate the request config structure");
+
+	gpiod_request_config_set_consumer(req_cfg, cfg.consumer);
+
+	requests = calloc(resolver->num_chips, sizeof(*requests));
+	offsets = calloc(num_lines, sizeof(*offsets));
+	values = calloc(num_lines, sizeof(*values));
+	if (!requests || !offsets || !values)
+		die("out of memory");
+
+	line_cfg = gpiod_line_config_new();
+	if (!line_cfg)
+		die_perror("unable to allocate the line config structure");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		num_lines = get_line_offsets_and_values(resolver, i, offsets,
+							values);
+
+		gpiod_line_config_reset(line_cfg);
+
+		ret = gpiod_line_config_add_line_settings(line_cfg, offsets,
+							  num_lines, settings);
+		if (ret)
+			die_perror("unable to add line settings");
+
+		ret = gpiod_line_config_set_output_values(line_cfg,
+							  values, num_lines);
+		if (ret)
+			die_perror("unable to set output values");
+
+		chip = resolver->chips[i].chip;
+
+		requests[i] = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+		if (!requests[i])
+			die_perror("unable to request lines on chip '%s'",
+				   resolver->chips[i].path);
+	}
+
+	gpiod_request_config_free(req_cfg);
+	gpiod_line_config_free(line_cfg);
+	gpiod_line_settings_free(settings);
+
+	waveform = build_waveform(resolver, requests, events, num_events);
+
+	timing.num_steps = 0;
+	timing.lateness_ns = calloc(gpiod_waveform_get_num_steps(waveform),
+				    sizeof(*timing.lateness_ns));
+	if (!timing.lateness_ns)
+		die("out of memory");
+
+	gpiod_waveform_set_step_callback(waveform, record_lateness, &timing);
+
+	if (cfg.banner)
+		print_banner(resolver->num_lines, lines);
+
+	if (gpiod_waveform_play(waveform))
+		die_perror("unable to replay the events");
+
+	if (!cfg.quiet && timing.num_steps)
+		print_timing(&timing);
+
+	gpiod_waveform_free(waveform);
+
+	for (i = 0; i < resolver->num_chips; i++)
+		gpiod_line_request_release(requests[i]);
+
+	free(timing.lateness_ns);
+	free(requests);
+	free(offsets);
+	free(values);
+	free(events);
+	free_line_resolver(resolver);
+	free(sources);
+	free(lines);
+	free_recording(&recording);
+
+	return EXIT_SUCCESS;
+}
@@ -3,6 +3,7 @@
 // SPDX-FileCopyrightText: 2022 Kent Gibson <warthog618@gmail.com>
 
 #include <ctype.h>
+#include <errno.h>
 #include <gpiod.h>
 #include <getopt.h>
 #include <limits.h>
@@ -10,6 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #ifdef GPIOSET_INTERACTIVE
 #include <editline/readline.h>
@@ -23,6 +25,7 @@ struct config {
 	bool by_name;
 	bool daemonize;
 	bool interactive;
+	bool script;
 	bool strict;
 	bool unquoted;
 	enum gpiod_line_bias bias;
@@ -32,6 +35,7 @@ struct config {
 	unsigned int hold_period_us;
 	const char *chip_id;
 	const char *consumer;
+	struct rt_config rt;
 };
 
 static void print_help(void)
@@ -65,6 +69,8 @@ static void print_help(void)
 	printf("  -l, --active-low\ttreat the line as active low\n");
 	printf("  -p, --hold-period <period>\n");
 	printf("\t\t\tthe minimum time period to hold lines at the requested values\n");
+	printf("      --script\t\tset the lines then read commands from standard input\n");
+	printf("\t\t\tuntil the end of input, without line editing (see below)\n");
 	printf("  -s, --strict\t\tabort if requested line names are not unique\n");
 	printf("  -t, --toggle <period>[,period]...\n");
 	printf("\t\t\ttoggle the line(s) after the specified period(s)\n");
@@ -72,9 +78,22 @@ static void print_help(void)
 	printf("      --unquoted\tdon't quote line names\n");
 	printf("  -v, --version\t\toutput version information and exit\n");
 	printf("  -z, --daemonize\tset values then detach from the controlling terminal\n");
+	print_rt_help();
 	print_chip_help();
 	print_period_help();
 	printf("\n");
+	printf("Script commands:\n");
+	printf("  One command per line, empty lines and lines starting with '#' are ignored.\n");
+	printf("    set <line=value>...\tupdate the output values of the given lines\n");
+	printf("    toggle [line]...\ttoggle the given lines, or all lines if none given\n");
+	printf("    sleep <period>\twait for the period since the end of the previous sleep\n");
+	printf("    get [line]...\tprint the values of the given lines, or of all lines\n");
+	printf("    exit\t\tstop reading commands\n");
+	printf("  Values set by consecutive commands are applied together, using a single\n");
+	printf("  request per chip, before sleeping, printing values or waiting for more\n");
+	printf("  input. Periods of consecutive sleeps add up without drifting. Any invalid\n");
+	printf("  command aborts the script.\n");
+	printf("\n");
 	printf("*Note*\n");
 	printf("    The state of a GPIO line controlled over the character device reverts to default\n");
 	printf("    when the last process referencing the file descriptor representing the device file exits.\n");
@@ -139,10 +158,12 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 #ifdef GPIOSET_INTERACTIVE
 		{ "interactive", no_argument,		NULL,	'i' },
 #endif
+		{ "script",	no_argument,		NULL,	'S' },
 		{ "strict",	no_argument,		NULL,	's' },
 		{ "toggle",	required_argument,	NULL,	't' },
 		{ "unquoted",	no_argument,		NULL,	'Q' },
 		{ "version",	no_argument,		NULL,	'v' },
+		RT_LONGOPTS,
 		{ GETOPT_NULL_LONGOPT },
 	};
 
@@ -155,6 +176,7 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 	int opti, optc;
 
 	memset(cfg, 0, sizeof(*cfg));
+	rt_config_init(&cfg->rt);
 	cfg->consumer = "gpioset";
 
 	for (;;) {
@@ -162,6 +184,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		if (optc < 0)
 			break;
 
+		if (parse_rt_option(optc, optarg, &cfg->rt))
+			continue;
+
 		switch (optc) {
 		case '-':
 			cfg->banner = true;
@@ -198,6 +223,9 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 		case 's':
 			cfg->strict = true;
 			break;
+		case 'S':
+			cfg->script = true;
+			break;
 		case 't':
 			cfg->toggles = parse_periods_or_die(optarg,
 						 &cfg->toggle_periods);
@@ -223,31 +251,15 @@ static int parse_config(int argc, char **argv, struct config *cfg)
 #ifdef GPIOSET_INTERACTIVE
 	if (cfg->toggles && cfg->interactive)
 		die("can't combine interactive with toggle");
-#endif
 
-	return optind;
-}
+	if (cfg->script && cfg->interactive)
+		die("can't combine script with interactive");
+#endif
 
-static enum gpiod_line_value parse_value(const char *option)
-{
-	if (strcmp(option, "0") == 0)
-		return GPIOD_LINE_VALUE_INACTIVE;
-	if (strcmp(option, "1") == 0)
-		return GPIOD_LINE_VALUE_ACTIVE;
-	if (strcmp(option, "inactive") == 0)
-		return GPIOD_LINE_VALUE_INACTIVE;
-	if (strcmp(option, "active") == 0)
-		return GPIOD_LINE_VALUE_ACTIVE;
-	if (strcmp(option, "off") == 0)
-		return GPIOD_LINE_VALUE_INACTIVE;
-	if (strcmp(option, "on") == 0)
-		return GPIOD_LINE_VALUE_ACTIVE;
-	if (strcmp(option, "false") == 0)
-		return GPIOD_LINE_VALUE_INACTIVE;
-	if (strcmp(option, "true") == 0)
-		return GPIOD_LINE_VALUE_ACTIVE;
+	if (cfg->script && (cfg->toggles || cfg->daemonize))
+		die("can't combine script with toggle or daemonize");
 
-	return GPIOD_LINE_VALUE_ERROR;
+	return optind;
 }
 
 /*
@@ -290,7 +302,7 @@ static bool parse_line_values(int num_lines, char **lvs, char **lines,
 
 		*value = '\0';
 		value++;
-		values[i] = parse_value(value);
+		values[i] = parse_line_value(value);
 
 		if (values[i] == GPIOD_LINE_VALUE_ERROR) {
 			if (interactive)
@@ -345,6 +357,414 @@ static void wait_fd(int fd)
 		die_perror("error waiting on request");
 }
 
+/*
+ * Toggle the resolved lines as specified by the toggle_periods.
+ *
+ * The toggles are played back as a waveform so that the timing doesn't drift
+ * regardless of how long the sequence runs.
+ * offset and values are scratch pads for working.
+ */
+static void toggle_sequence(int toggles, unsigned int *toggle_periods,
+			    struct gpiod_line_request **requests,
+			    struct line_resolver *resolver,
+			    unsigned int *offsets,
+			    enum gpiod_line_value *values)
+{
+	int i, j, num_lines, num_toggles;
+	struct gpiod_waveform *waveform;
+	uint64_t *masks, *bits, time_ns;
+	bool repeat;
+
+	repeat = toggle_periods[toggles - 1] != 0;
+	num_toggles = repeat ? toggles : toggles - 1;
+	if (!num_toggles)
+		return;
+
+	/*
+	 * An odd number of toggles leaves the lines inverted at the end of
+	 * the sequence so a repeating cycle needs to cover it twice.
+	 */
+	if (repeat && (num_toggles % 2))
+		num_toggles *= 2;
+
+	masks = calloc(resolver->num_chips, sizeof(*masks));
+	bits = calloc(resolver->num_chips, sizeof(*bits));
+	if (!masks || !bits)
+		die("out of memory");
+
+	for (i = 0; i < resolver->num_chips; i++) {
+		num_lines = get_line_offsets_and_values(resolver, i, offsets,
+							values);
+
+		for (j = 0; j < num_lines; j++) {
+			masks[i] |= 1ULL << j;
+			if (values[j])
+				bits[i] |= 1ULL << j;
+		}
+	}
+
+	waveform = gpiod_waveform_new();
+	if (!waveform)
+		die_perror("unable to allocate the waveform");
+
+	for (i = 0, time_ns = 0; i < num_toggles; i++) {
+		time_ns += toggle_periods[i % toggles] * 1000ULL;
+
+		for (j = 0; j < resolver->num_chips; j++) {
+			bits[j] ^= masks[j];
+
+			if (gpiod_waveform_add_step(waveform, requests[j],
+						    time_ns, masks[j], bits[j]))
+				die_perror("unable to add waveform step");
+		}
+	}
+
+	if (repeat)
+		gpiod_waveform_set_period_ns(waveform, time_ns);
+
+	if (gpiod_waveform_play(waveform))
+		die_perror("unable to toggle lines");
+
+	gpiod_waveform_free(waveform);
+	free(masks);
+	free(bits);
+}
+
+/* Size of the buffer holding script input, limits the length of commands. */
+#define SCRIPT_BUF_SIZE		4096
+
+#define NSEC_PER_SEC		1000000000ULL
+
+/* Lines driven by commands read from standard input. */
+struct script {
+	struct gpiod_line_request **requests;
+	struct line_resolver *resolver;
+	bool unquoted;
+	/* Request-relative bit of every line of the resolver. */
+	uint64_t *line_bits;
+	/* Per request: lines changed since last applied and their values. */
+	uint64_t *pending;
+	uint64_t *values;
+	/* End of the previous sleep, if no input was waited for since. */
+	uint64_t deadline_ns;
+	bool deadline_valid;
+	unsigned int lineno;
+};
+
+static void script_init(struct script *script,
+			struct gpiod_line_request **requests,
+			struct line_resolver *resolver, bool unquoted)
+{
+	struct resolved_line *line;
+	uint64_t *next_bit;
+	int i;
+
+	memset(script, 0, sizeof(*script));
+	script->requests = requests;
+	script->resolver = resolver;
+	script->unquoted = unquoted;
+
+	script->line_bits = calloc(resolver->num_lines,
+				   sizeof(*script->line_bits));
+	script->pending = calloc(resolver->num_chips,
+				 sizeof(*script->pending));
+	script->values = calloc(resolver->num_chips, sizeof(*script->values));
+	next_bit = calloc(resolver->num_chips, sizeof(*next_bit));
+	if (!script->line_bits || !script->pending || !script->values ||
+	    !next_bit)
+		die("out of memory");
+
+	/* Lines of a request are in the order of the resolver. */
+	for (i = 0; i < resolver->num_lines; i++) {
+		line = &resolver->lines[i];
+		script->line_bits[i] = 1ULL << next_bit[line->chip_num]++;
+		if (line->value)
+			script->values[line->chip_num] |= script->line_bits[i];
+	}
+
+	free(next_bit);
+}
+
+static void script_free(struct script *script)
+{
+	free(script->line_bits);
+	free(script->pending);
+	free(script->values);
+}
+
+static void script_apply(struct script *script)
+{
+	int i;
+
+	for (i = 0; i < script->resolver->num_chips; i++) {
+		if (!script->pending[i])
+			continue;
+
+		if (gpiod_line_request_set_values_mask(script->requests[i],
+						       script->pending[i],
+						       script->values[i]))
+			die_perror("unable to set values on '%s'",
+				   get_chip_name(script->resolver, i));
+
+		script->pending[i] = 0;
+	}
+}
+
+static void script_set(struct script *script, int idx,
+		       enum gpiod_line_value value)
+{
+	struct resolved_line *line = &script->resolver->lines[idx];
+
+	line->value = value;
+	script->pending[line->chip_num] |= script->line_bits[idx];
+	if (value)
+		script->values[line->chip_num] |= script->line_bits[idx];
+	else
+		script->values[line->chip_num] &= ~script->line_bits[idx];
+}
+
+/*
+ * Split the next word off the command, in place. Quoted parts of the word may
+ * contain spaces.
+ */
+static char *script_next_word(char **cmd)
+{
+	bool in_quotes = false;
+	char *pos = *cmd, *word;
+
+	while (isspace(*pos))
+		pos++;
+
+	if (*pos == '\0')
+		return NULL;
+
+	for (word = pos; *pos != '\0'; pos++) {
+		if (*pos == '"')
+			in_quotes = !in_quotes;
+		else if (!in_quotes && isspace(*pos))
+			break;
+	}
+
+	if (*pos != '\0')
+		*pos++ = '\0';
+
+	*cmd = pos;
+
+	return word;
+}
+
+static int script_find_line(struct script *script, char *id)
+{
+	size_t len = strlen(id);
+	int i;
+
+	if (*id == '"') {
+		if (len < 2 || id[len - 1] != '"')
+			die("line %u: invalid line id: '%s'", script->lineno,
+			    id);
+
+		id[len - 1] = '\0';
+		id++;
+	}
+
+	for (i = 0; i < script->resolver->num_lines; i++)
+		if (strcmp(id, script->resolver->lines[i].id) == 0)
+			return i;
+
+	die("line %u: unknown line: '%s'", script->lineno, id);
+}
+
+static void script_sleep(struct script *script, const char *period)
+{
+	int period_us = parse_period(period);
+	struct timespec ts;
+	uint64_t now_ns;
+	int ret;
+
+	if (period_us < 0)
+		die("line %u: invalid period: '%s'", script->lineno, period);
+
+	script_apply(script);
+
+	if (!script->deadline_valid) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		now_ns = (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+		script->deadline_ns = now_ns;
+		script->deadline_valid = true;
+	}
+
+	script->deadline_ns += period_us * 1000ULL;
+	ts.tv_sec = script->deadline_ns / NSEC_PER_SEC;
+	ts.tv_nsec = script->deadline_ns % NSEC_PER_SEC;
+
+	do {
+		ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+				      NULL);
+	} while (ret == EINTR);
+}
+
+static void script_print_value(struct script *script, int idx, bool first)
+{
+	struct resolved_line *line = &script->resolver->lines[idx];
+
+	printf(script->unquoted ? "%s%s=%s" : "%s\"%s\"=%s", first ? "" : " ",
+	       line->id, line->value ? "active" : "inactive");
+}
+
+static void script_get(struct script *script, char *args)
+{
+	char *word;
+	int i;
+
+	script_apply(script);
+
+	word = script_next_word(&args);
+	if (!word) {
+		for (i = 0; i < script->resolver->num_lines; i++)
+			script_print_value(script, i, i == 0);
+	} else {
+		for (i = 0; word; i++, word = script_next_word(&args))
+			script_print_value(script,
+					   script_find_line(script, word),
+					   i == 0);
+	}
+
+	printf("\n");
+}
+
+/* Execute a single command, returns false once the script is over. */
+static bool script_command(struct script *script, char *cmd)
+{
+	enum gpiod_line_value value;
+	char *word, *line;
+	int i;
+
+	word = script_next_word(&cmd);
+	if (!word || *word == '#')
+		return true;
+
+	if (strcmp(word, "set") == 0) {
+		word = script_next_word(&cmd);
+		if (!word)
+			die("line %u: at least one GPIO line value must be specified",
+			    script->lineno);
+
+		for (; word; word = script_next_word(&cmd)) {
+			if (!parse_line_values(1, &word, &line, &value, false))
+				die("line %u: invalid command", script->lineno);
+
+			script_set(script, script_find_line(script, line),
+				   value);
+		}
+	} else if (strcmp(word, "toggle") == 0) {
+		word = script_next_word(&cmd);
+		if (!word) {
+			for (i = 0; i < script->resolver->num_lines; i++)
+				script_set(script, i,
+					   !script->resolver->lines[i].value);
+		}
+
+		for (; word; word = script_next_word(&cmd)) {
+			i = script_find_line(script, word);
+			script_set(script, i,
+				   !script->resolver->lines[i].value);
+		}
+	} else if (strcmp(word, "sleep") == 0) {
+		word = script_next_word(&cmd);
+		if (!word)
+			die("line %u: a period must be specified",
+			    script->lineno);
+		if (script_next_word(&cmd))
+			die("line %u: only one period can be specified",
+			    script->lineno);
+
+		script_sleep(script, word);
+	} else if (strcmp(word, "get") == 0) {
+		script_get(script, cmd);
+	} else if (strcmp(word, "exit") == 0) {
+		return false;
+	} else {
+		die("line %u: unknown command: '%s'", script->lineno, word);
+	}
+
+	return true;
+}
+
+/*
+ * Read commands from standard input and execute them. Input is read in large
+ * chunks and commands are parsed in place, so nothing is allocated per
+ * command. Values set are applied once the commands already read are
+ * exhausted, or earlier if a command depends on them.
+ */
+static void run_script(struct gpiod_line_request **requests,
+		       struct line_resolver *resolver, bool unquoted)
+{
+	static char buf[SCRIPT_BUF_SIZE + 1];
+	size_t len = 0, start = 0;
+	struct script script;
+	bool running = true;
+	struct pollfd pfd;
+	char *end;
+	ssize_t rd;
+
+	script_init(&script, requests, resolver, unquoted);
+
+	while (running) {
+		end = memchr(buf + start, '\n', len - start);
+		if (end) {
+			*end = '\0';
+			script.lineno++;
+			running = script_command(&script, buf + start);
+			start = end - buf + 1;
+			continue;
+		}
+
+		/* Out of complete commands, apply them before waiting. */
+		script_apply(&script);
+		fflush(stdout);
+
+		memmove(buf, buf + start, len - start);
+		len -= start;
+		start = 0;
+
+		if (len == SCRIPT_BUF_SIZE)
+			die("line %u: command too long", script.lineno + 1);
+
+		/* The timing of sleeps restarts once input is waited for. */
+		pfd.fd = STDIN_FILENO;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, 0) == 0)
+			script.deadline_valid = false;
+
+		rd = read(STDIN_FILENO, buf + len, SCRIPT_BUF_SIZE - len);
+		if (rd < 0) {
+			if (errno == EINTR)
+				continue;
+
+			die_perror("unable to read commands");
+		}
+
+		if (rd == 0) {
+			/* Last command without a trailing newline. */
+			if (len) {
+				buf[len] = '\0';
+				script.lineno++;
+				script_command(&script, buf);
+			}
+
+			break;
+		}
+
+		len += rd;
+	}
+
+	script_apply(&script);
+	fflush(stdout);
+	script_free(&script);
+}
+
+#ifdef GPIOSET_INTERACTIVE
+
 /*
  * Apply values from the resolver to the requests.
  * offset and values are scratch pads for working.
@@ -372,38 +792,6 @@ static void toggle_all_lines(struct line_resolver *resolver)
 		resolver->lines[i].value = !resolver->lines[i].value;
 }
 
-/*
- * Toggle the resolved lines as specified by the toggle_periods,
- * and apply the values to the requests.
- * offset and values are scratch pads for working.
- */
-static void toggle_sequence(int toggles, unsigned int *toggle_periods,
-			    struct gpiod_line_request **requests,
-			    struct line_resolver *resolver,
-			    unsigned int *offsets,
-			    enum gpiod_line_value *values)
-{
-	int i = 0;
-
-	if ((toggles == 1) && (toggle_periods[0] == 0))
-		return;
-
-	for (;;) {
-		usleep(toggle_periods[i]);
-		toggle_all_lines(resolver);
-		apply_values(requests, resolver, offsets, values);
-
-		i++;
-		if ((i == toggles - 1) && (toggle_periods[i] == 0))
-			return;
-
-		if (i == toggles)
-			i = 0;
-	}
-}
-
-#ifdef GPIOSET_INTERACTIVE
-
 /*
  * Parse line id from words into lines.
  *
@@ -913,6 +1301,8 @@ int main(int argc, char **argv)
 		die_perror("unable to allocate the request config structure");
 
 	gpiod_request_config_set_consumer(req_cfg, cfg.consumer);
+	/* We are the only ones driving the lines for as long as we run. */
+	gpiod_request_config_set_output_shadow(req_cfg, true);
 	resolver = resolve_lines(num_lines, lines, cfg.chip_id, cfg.strict,
 				 cfg.by_name);
 	validate_resolution(resolver, cfg.chip_id);
@@ -944,17 +1334,12 @@ int main(int argc, char **argv)
 		if (ret)
 			die_perror("unable to set output values");
 
-		chip = gpiod_chip_open(resolver->chips[i].path);
-		if (!chip)
-			die_perror("unable to open chip '%s'",
-				   resolver->chips[i].path);
+		chip = resolver->chips[i].chip;
 
 		requests[i] = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
 		if (!requests[i])
 			die_perror("unable to request lines on chip '%s'",
 				   resolver->chips[i].path);
-
-		gpiod_chip_close(chip);
 	}
 
 	gpiod_request_config_free(req_cfg);
@@ -968,6 +1353,9 @@ int main(int argc, char **argv)
 		if (daemon(0, cfg.interactive) < 0)
 			die_perror("unable to daemonize");
 
+	/* Memory locks aren't inherited by the daemonized child. */
+	apply_rt_config(&cfg.rt);
+
 	if (cfg.toggles) {
 		for (i = 0; i < cfg.toggles; i++)
 			if ((cfg.hold_period_us > cfg.toggle_periods[i]) &&
@@ -983,16 +1371,15 @@ int main(int argc, char **argv)
 	if (cfg.hold_period_us)
 		usleep(cfg.hold_period_us);
 
+	if (cfg.script)
+		run_script(requests, resolver, cfg.unquoted);
 #ifdef GPIOSET_INTERACTIVE
-	if (cfg.interactive)
+	else if (cfg.interactive)
 		interact(requests, resolver, lines, offsets, values,
 			 cfg.unquoted);
+#endif
 	else if (!cfg.toggles)
 		wait_fd(gpiod_line_request_get_fd(requests[0]));
-#else
-	if (!cfg.toggles)
-		wait_fd(gpiod_line_request_get_fd(requests[0]));
-#endif
 
 	for (i = 0; i < resolver->num_chips; i++)
 		gpiod_line_request_release(requests[i]);
@@ -5,18 +5,21 @@
 /* Common code for GPIO tools. */
 
 #include <ctype.h>
-#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <gpiod.h>
 #include <inttypes.h>
 #include <libgen.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/types.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "tools-common.h"
 
@@ -168,6 +171,28 @@ unsigned int parse_uint_or_die(const char *option)
 	return i;
 }
 
+enum gpiod_line_value parse_line_value(const char *option)
+{
+	if (strcmp(option, "0") == 0)
+		return GPIOD_LINE_VALUE_INACTIVE;
+	if (strcmp(option, "1") == 0)
+		return GPIOD_LINE_VALUE_ACTIVE;
+	if (strcmp(option, "inactive") == 0)
+		return GPIOD_LINE_VALUE_INACTIVE;
+	if (strcmp(option, "active") == 0)
+		return GPIOD_LINE_VALUE_ACTIVE;
+	if (strcmp(option, "off") == 0)
+		return GPIOD_LINE_VALUE_INACTIVE;
+	if (strcmp(option, "on") == 0)
+		return GPIOD_LINE_VALUE_ACTIVE;
+	if (strcmp(option, "false") == 0)
+		return GPIOD_LINE_VALUE_INACTIVE;
+	if (strcmp(option, "true") == 0)
+		return GPIOD_LINE_VALUE_ACTIVE;
+
+	return GPIOD_LINE_VALUE_ERROR;
+}
+
 void print_bias_help(void)
 {
 	printf("  -b, --bias <bias>\tspecify the line bias\n");
@@ -175,6 +200,69 @@ void print_bias_help(void)
 	printf("\t\t\t(default is to leave bias unchanged)\n");
 }
 
+void rt_config_init(struct rt_config *rt)
+{
+	rt->priority = 0;
+	rt->cpu = -1;
+	rt->lock_memory = false;
+}
+
+/* Returns false if optc isn't one of RT_LONGOPTS. */
+bool parse_rt_option(int optc, const char *arg, struct rt_config *rt)
+{
+	switch (optc) {
+	case RT_OPT_REALTIME:
+		rt->priority = arg ? parse_uint_or_die(arg) :
+				     RT_DEFAULT_PRIORITY;
+		if (!rt->priority)
+			die("real-time priority must be positive");
+		return true;
+	case RT_OPT_CPU:
+		rt->cpu = parse_uint_or_die(arg);
+		return true;
+	case RT_OPT_MLOCK:
+		rt->lock_memory = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Applies the settings to the calling thread. */
+void apply_rt_config(struct rt_config *rt)
+{
+	struct gpiod_thread_attr *attr;
+
+	if (!rt->priority && rt->cpu < 0 && !rt->lock_memory)
+		return;
+
+	attr = gpiod_thread_attr_new();
+	if (!attr)
+		die_perror("unable to allocate the thread attributes");
+
+	if (gpiod_thread_attr_set_realtime(attr, rt->priority))
+		die("invalid real-time priority: %d", rt->priority);
+
+	if (gpiod_thread_attr_set_cpu(attr, rt->cpu))
+		die("invalid CPU: %d", rt->cpu);
+
+	gpiod_thread_attr_set_lock_memory(attr, rt->lock_memory);
+
+	if (gpiod_thread_attr_apply(attr))
+		die_perror("unable to apply the real-time settings");
+
+	gpiod_thread_attr_free(attr);
+}
+
+void print_rt_help(void)
+{
+	printf("      --cpu <cpu>\tpin the process to the given CPU\n");
+	printf("      --mlock\t\tlock the process memory to avoid page faults\n");
+	printf("      --realtime[=prio]\n");
+	printf("\t\t\trun with the SCHED_FIFO policy at priority prio\n");
+	printf("\t\t\t(default is %d)\n", RT_DEFAULT_PRIORITY);
+}
+
 void print_chip_help(void)
 {
 	printf("\nChips:\n");
@@ -221,6 +309,173 @@ void print_event_time(uint64_t evtime, int format)
 	}
 }
 
+struct output_format *parse_format(const char *fmt, const char *specs)
+{
+	struct output_format *format;
+	const char *curr, *prev;
+	struct format_op *op;
+
+	/* Every specifier may be preceded by literal text. */
+	format = malloc(sizeof(*format) +
+			sizeof(*op) * (strlen(fmt) + 1));
+	if (!format)
+		die("out of memory");
+
+	format->num_ops = 0;
+
+	for (prev = curr = fmt;;) {
+		curr = strchr(curr, '%');
+		if (!curr)
+			curr = prev + strlen(prev);
+
+		if (prev != curr) {
+			op = &format->ops[format->num_ops++];
+			op->spec = '\0';
+			op->text = prev;
+			op->len = curr - prev;
+		}
+
+		if (*curr == '\0')
+			break;
+
+		op = &format->ops[format->num_ops++];
+		op->spec = '\0';
+		op->text = curr;
+
+		if (curr[1] == '\0') {
+			/* A trailing '%' is printed as is. */
+			op->len = 1;
+			break;
+		} else if (curr[1] == '%') {
+			op->len = 1;
+		} else if (strchr(specs, curr[1])) {
+			op->spec = curr[1];
+		} else {
+			/* Unknown specifiers are printed verbatim. */
+			op->len = 2;
+		}
+
+		curr += 2;
+		prev = curr;
+	}
+
+	return format;
+}
+
+void free_format(struct output_format *format)
+{
+	free(format);
+}
+
+static void write_all(const char *data, size_t len)
+{
+	ssize_t written;
+
+	while (len) {
+		written = write(STDOUT_FILENO, data, len);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+
+			die_perror("unable to write output");
+		}
+
+		data += written;
+		len -= written;
+	}
+}
+
+void output_flush(struct output_buffer *out)
+{
+	/* Anything printed through stdio goes out first. */
+	fflush(stdout);
+
+	write_all(out->data, out->len);
+	out->len = 0;
+}
+
+void output_write(struct output_buffer *out, const char *data, size_t len)
+{
+	if (len > sizeof(out->data) - out->len) {
+		output_flush(out);
+
+		if (len > sizeof(out->data)) {
+			write_all(data, len);
+			return;
+		}
+	}
+
+	memcpy(out->data + out->len, data, len);
+	out->len += len;
+}
+
+void output_puts(struct output_buffer *out, const char *str)
+{
+	output_write(out, str, strlen(str));
+}
+
+void output_putc(struct output_buffer *out, char c)
+{
+	output_write(out, &c, 1);
+}
+
+/* Write val zero-padded to at least the given number of digits. */
+static void output_put_padded(struct output_buffer *out, uint64_t val,
+			      int min_digits)
+{
+	char buf[20];
+	int i = sizeof(buf);
+
+	do {
+		buf[--i] = '0' + val % 10;
+		val /= 10;
+	} while (val || (int)sizeof(buf) - i < min_digits);
+
+	output_write(out, buf + i, sizeof(buf) - i);
+}
+
+void output_put_uint(struct output_buffer *out, uint64_t val)
+{
+	output_put_padded(out, val, 1);
+}
+
+void output_put_event_time(struct output_buffer *out, uint64_t evtime,
+			   int format)
+{
+	/* Consecutive events mostly fall into the same second. */
+	static char tbuf[TIME_BUFFER_SIZE];
+	static int last_format = -1;
+	static time_t last_sec;
+	time_t evtsec;
+	struct tm t;
+
+	if (!format) {
+		output_put_uint(out, evtime / 1000000000);
+		output_putc(out, '.');
+		output_put_padded(out, evtime % 1000000000, 9);
+		return;
+	}
+
+	evtsec = evtime / 1000000000;
+	if (format != last_format || evtsec != last_sec) {
+		if (format == 2)
+			localtime_r(&evtsec, &t);
+		else
+			gmtime_r(&evtsec, &t);
+
+		strftime(tbuf, TIME_BUFFER_SIZE, "%FT%T", &t);
+		last_format = format;
+		last_sec = evtsec;
+	}
+
+	output_puts(out, tbuf);
+	output_putc(out, '.');
+	output_put_padded(out, evtime % 1000000000, 9);
+
+	if (format != 2)
+		output_putc(out, 'Z');
+}
+
 static void print_bias(struct gpiod_line_info *info)
 {
 	const char *name;
@@ -371,24 +626,6 @@ void print_line_id(struct line_resolver *resolver, int chip_num,
 	printf(fmt, lname);
 }
 
-static int chip_dir_filter(const struct dirent *entry)
-{
-	struct stat sb;
-	int ret = 0;
-	char *path;
-
-	if (asprintf(&path, "/dev/%s", entry->d_name) < 0)
-		return 0;
-
-	if ((lstat(path, &sb) == 0) && (!S_ISLNK(sb.st_mode)) &&
-	    gpiod_is_gpiochip_device(path))
-		ret = 1;
-
-	free(path);
-
-	return ret;
-}
-
 static bool isuint(const char *str)
 {
 	for (; *str && isdigit(*str); str++)
@@ -448,36 +685,137 @@ int chip_paths(const char *id, char ***paths_ptr)
 
 int all_chip_paths(char ***paths_ptr)
 {
-	int i, j, num_chips, ret = 0;
-	struct dirent **entries;
+	struct gpiod_chip_list *list;
+	int i, num_chips;
 	char **paths;
 
-	num_chips = scandir("/dev/", &entries, chip_dir_filter, alphasort);
-	if (num_chips < 0)
-		die_perror("unable to scan /dev");
+	list = gpiod_chip_list_new(0);
+	if (!list)
+		die_perror("unable to find GPIO chips");
+
+	num_chips = gpiod_chip_list_get_num_chips(list);
 
-	paths = calloc(num_chips, sizeof(*paths));
+	paths = calloc(num_chips ?: 1, sizeof(*paths));
 	if (paths == NULL)
 		die("out of memory");
 
 	for (i = 0; i < num_chips; i++) {
-		if (asprintf(&paths[i], "/dev/%s", entries[i]->d_name) < 0) {
-			for (j = 0; j < i; j++)
-				free(paths[j]);
-
-			free(paths);
-			return 0;
-		}
+		paths[i] = strdup(gpiod_chip_list_get_path(list, i));
+		if (!paths[i])
+			die("out of memory");
 	}
 
+	gpiod_chip_list_free(list);
 	*paths_ptr = paths;
-	ret = num_chips;
+
+	return num_chips;
+}
+
+/*
+ * Opening a chip and reading its info may take a while, e.g. for chips behind
+ * slow buses, so the chips are read by a small pool of threads. Each thread
+ * takes the next chip not read yet, the results are stored by chip index so
+ * the order in which they complete doesn't matter.
+ */
+#define READ_CHIPS_MAX_THREADS	8
+
+struct chip_reader {
+	int num_chips;
+	char **paths;
+	const bool *wanted;
+	struct chip_snapshot *snapshots;
+	int next;
+};
+
+static void read_chip(const char *path, struct chip_snapshot *snapshot)
+{
+	struct gpiod_chip *chip;
+
+	memset(snapshot, 0, sizeof(*snapshot));
+
+	chip = gpiod_chip_open(path);
+	if (!chip) {
+		snapshot->err = errno;
+		return;
+	}
+
+	snapshot->chip = chip;
+
+	snapshot->info = gpiod_chip_get_info(chip);
+	if (!snapshot->info) {
+		snapshot->err = errno;
+		return;
+	}
+
+	snapshot->lines = gpiod_line_info_snapshot_new(chip);
+	if (!snapshot->lines) {
+		snapshot->err = errno;
+		return;
+	}
+
+	snapshot->num_lines_read =
+		gpiod_line_info_snapshot_get_num_lines(snapshot->lines);
+}
+
+static void *chip_reader_thread(void *data)
+{
+	struct chip_reader *reader = data;
+	int i;
+
+	for (;;) {
+		i = __atomic_fetch_add(&reader->next, 1, __ATOMIC_RELAXED);
+		if (i >= reader->num_chips)
+			break;
+
+		if (!reader->wanted || reader->wanted[i])
+			read_chip(reader->paths[i], &reader->snapshots[i]);
+	}
+
+	return NULL;
+}
+
+void read_chips(int num_chips, char **paths, const bool *wanted,
+		struct chip_snapshot *snapshots)
+{
+	pthread_t threads[READ_CHIPS_MAX_THREADS];
+	int i, num_wanted = 0, num_threads;
+	struct chip_reader reader;
+
+	memset(snapshots, 0, num_chips * sizeof(*snapshots));
 
 	for (i = 0; i < num_chips; i++)
-		free(entries[i]);
+		if (!wanted || wanted[i])
+			num_wanted++;
 
-	free(entries);
-	return ret;
+	reader.num_chips = num_chips;
+	reader.paths = paths;
+	reader.wanted = wanted;
+	reader.snapshots = snapshots;
+	reader.next = 0;
+
+	num_threads = num_wanted < READ_CHIPS_MAX_THREADS ?
+			num_wanted : READ_CHIPS_MAX_THREADS;
+
+	/* The calling thread takes part, failing to spawn more is fine. */
+	for (i = 0; i < num_threads - 1; i++)
+		if (pthread_create(&threads[i], NULL, chip_reader_thread,
+				   &reader))
+			break;
+
+	num_threads = i;
+	chip_reader_thread(&reader);
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+}
+
+void free_chip_snapshot(struct chip_snapshot *snapshot)
+{
+	gpiod_line_info_snapshot_free(snapshot->lines);
+	gpiod_chip_info_free(snapshot->info);
+	if (snapshot->chip)
+		gpiod_chip_close(snapshot->chip);
+	memset(snapshot, 0, sizeof(*snapshot));
 }
 
 static bool resolve_line(struct line_resolver *resolver,
@@ -519,6 +857,440 @@ static bool resolve_line(struct line_resolver *resolver,
 	return resolved;
 }
 
+/*
+ * Cache of the line names of GPIO chips, so that lines can be resolved by name
+ * without reading the info of every line of every chip.
+ *
+ * An entry is only trusted if the device node is still the same one - same
+ * device number, inode and change time - and once the chip is opened, if its
+ * label and number of lines match. The names of the lines actually resolved
+ * are always checked against the line info read from the chip, any mismatch
+ * falls back to scanning the chip. Updating the cache is best-effort, users
+ * without write access to it just don't update it.
+ */
+
+#define NAME_CACHE_DEFAULT_PATH	"/run/gpiod/line-names"
+#define NAME_CACHE_HEADER	"# gpiod line name cache v1\n"
+#define NAME_CACHE_MAX_LINES	65536
+
+struct cached_chip {
+	char *path;
+	dev_t rdev;
+	ino_t ino;
+	struct timespec ctime;
+	char *label;
+	unsigned int num_lines;
+	/* Name of every line, NULL for unnamed lines. */
+	char **names;
+};
+
+struct name_cache {
+	const char *path;
+	struct cached_chip *chips;
+	int num_chips;
+	bool dirty;
+};
+
+static void cached_chip_free(struct cached_chip *cchip)
+{
+	unsigned int i;
+
+	for (i = 0; i < cchip->num_lines; i++)
+		free(cchip->names[i]);
+
+	free(cchip->names);
+	free(cchip->label);
+	free(cchip->path);
+	memset(cchip, 0, sizeof(*cchip));
+}
+
+static struct cached_chip *name_cache_add(struct name_cache *cache)
+{
+	struct cached_chip *chips;
+
+	chips = realloc(cache->chips,
+			(cache->num_chips + 1) * sizeof(*chips));
+	if (!chips)
+		die("out of memory");
+
+	cache->chips = chips;
+	memset(&chips[cache->num_chips], 0, sizeof(*chips));
+
+	return &chips[cache->num_chips++];
+}
+
+static void strip_newline(char *str)
+{
+	size_t len = strlen(str);
+
+	if (len && str[len - 1] == '\n')
+		str[len - 1] = '\0';
+}
+
+/* Returns false if the file is malformed. */
+static bool name_cache_parse(struct name_cache *cache, FILE *fp)
+{
+	struct cached_chip *cchip = NULL;
+	uintmax_t rdev, ino;
+	intmax_t sec;
+	size_t size = 0;
+	unsigned int num;
+	char *buf = NULL;
+	bool ret = false;
+	long nsec;
+	int pos;
+
+	if (getline(&buf, &size, fp) < 0 || strcmp(buf, NAME_CACHE_HEADER))
+		goto out;
+
+	while (getline(&buf, &size, fp) > 0) {
+		strip_newline(buf);
+
+		if (strncmp(buf, "chip ", 5) == 0) {
+			cchip = name_cache_add(cache);
+			pos = 0;
+			if (sscanf(buf, "chip %ms %ju %ju %jd %ld %u %n",
+				   &cchip->path, &rdev, &ino, &sec, &nsec,
+				   &num, &pos) != 6 || !pos ||
+			    num > NAME_CACHE_MAX_LINES)
+				goto out;
+
+			cchip->rdev = rdev;
+			cchip->ino = ino;
+			cchip->ctime.tv_sec = sec;
+			cchip->ctime.tv_nsec = nsec;
+			cchip->label = strdup(buf + pos);
+			cchip->names = calloc(num ?: 1, sizeof(*cchip->names));
+			if (!cchip->label || !cchip->names)
+				die("out of memory");
+
+			cchip->num_lines = num;
+		} else if (strncmp(buf, "line ", 5) == 0) {
+			pos = 0;
+			if (!cchip ||
+			    sscanf(buf, "line %u %n", &num, &pos) != 1 ||
+			    !pos || num >= cchip->num_lines ||
+			    cchip->names[num])
+				goto out;
+
+			cchip->names[num] = strdup(buf + pos);
+			if (!cchip->names[num])
+				die("out of memory");
+		} else {
+			goto out;
+		}
+	}
+
+	ret = true;
+
+out:
+	free(buf);
+	return ret;
+}
+
+static struct name_cache *name_cache_load(void)
+{
+	struct name_cache *cache;
+	const char *path;
+	FILE *fp;
+	int i;
+
+	path = getenv("GPIOD_NAME_CACHE");
+	if (!path)
+		path = NAME_CACHE_DEFAULT_PATH;
+	else if (*path == '\0')
+		return NULL;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		die("out of memory");
+
+	cache->path = path;
+
+	fp = fopen(path, "re");
+	if (!fp)
+		return cache;
+
+	/* A corrupted cache is rebuilt from scratch. */
+	if (!name_cache_parse(cache, fp)) {
+		for (i = 0; i < cache->num_chips; i++)
+			cached_chip_free(&cache->chips[i]);
+
+		cache->num_chips = 0;
+		cache->dirty = true;
+	}
+
+	fclose(fp);
+
+	return cache;
+}
+
+static void name_cache_write(struct name_cache *cache, FILE *fp)
+{
+	struct cached_chip *cchip;
+	unsigned int offset;
+	int i;
+
+	fputs(NAME_CACHE_HEADER, fp);
+
+	for (i = 0; i < cache->num_chips; i++) {
+		cchip = &cache->chips[i];
+		if (!cchip->path)
+			continue;
+
+		fprintf(fp, "chip %s %ju %ju %jd %ld %u %s\n", cchip->path,
+			(uintmax_t)cchip->rdev, (uintmax_t)cchip->ino,
+			(intmax_t)cchip->ctime.tv_sec, cchip->ctime.tv_nsec,
+			cchip->num_lines, cchip->label);
+
+		for (offset = 0; offset < cchip->num_lines; offset++)
+			if (cchip->names[offset])
+				fprintf(fp, "line %u %s\n", offset,
+					cchip->names[offset]);
+	}
+}
+
+/* Replace the cache atomically, so that concurrent readers never see a part. */
+static void name_cache_save(struct name_cache *cache)
+{
+	char *tmp, *dir;
+	FILE *fp;
+	int fd;
+
+	if (strcmp(cache->path, NAME_CACHE_DEFAULT_PATH) == 0) {
+		dir = strdup(cache->path);
+		if (!dir)
+			die("out of memory");
+
+		mkdir(dirname(dir), 0755);
+		free(dir);
+	}
+
+	if (asprintf(&tmp, "%s.XXXXXX", cache->path) < 0)
+		die("out of memory");
+
+	fd = mkostemp(tmp, O_CLOEXEC);
+	if (fd < 0) {
+		free(tmp);
+		return;
+	}
+
+	fchmod(fd, 0644);
+
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		unlink(tmp);
+		free(tmp);
+		return;
+	}
+
+	name_cache_write(cache, fp);
+
+	if (fclose(fp) || rename(tmp, cache->path))
+		unlink(tmp);
+
+	free(tmp);
+}
+
+static void name_cache_free(struct name_cache *cache)
+{
+	int i;
+
+	if (!cache)
+		return;
+
+	if (cache->dirty)
+		name_cache_save(cache);
+
+	for (i = 0; i < cache->num_chips; i++)
+		cached_chip_free(&cache->chips[i]);
+
+	free(cache->chips);
+	free(cache);
+}
+
+static struct cached_chip *name_cache_find(struct name_cache *cache,
+					   const char *path)
+{
+	int i;
+
+	for (i = 0; i < cache->num_chips; i++)
+		if (cache->chips[i].path &&
+		    strcmp(cache->chips[i].path, path) == 0)
+			return &cache->chips[i];
+
+	return NULL;
+}
+
+/* Look up the entry of a chip, if it describes the current device node. */
+static struct cached_chip *name_cache_lookup(struct name_cache *cache,
+					     const char *path)
+{
+	struct cached_chip *cchip;
+	struct stat st;
+
+	if (!cache)
+		return NULL;
+
+	cchip = name_cache_find(cache, path);
+	if (!cchip)
+		return NULL;
+
+	if (stat(path, &st) || st.st_rdev != cchip->rdev ||
+	    st.st_ino != cchip->ino ||
+	    st.st_ctim.tv_sec != cchip->ctime.tv_sec ||
+	    st.st_ctim.tv_nsec != cchip->ctime.tv_nsec)
+		return NULL;
+
+	return cchip;
+}
+
+static bool cached_chip_matches(struct cached_chip *cchip,
+				struct gpiod_chip_info *info)
+{
+	return cchip->num_lines == gpiod_chip_info_get_num_lines(info) &&
+	       strcmp(cchip->label, gpiod_chip_info_get_label(info)) == 0;
+}
+
+/* Start collecting the names of a chip being scanned. */
+static struct cached_chip *name_cache_update(struct name_cache *cache,
+					     const char *path,
+					     struct gpiod_chip_info *info)
+{
+	struct cached_chip *cchip;
+	struct stat st;
+
+	if (!cache || stat(path, &st))
+		return NULL;
+
+	cchip = name_cache_find(cache, path);
+	if (cchip)
+		cached_chip_free(cchip);
+	else
+		cchip = name_cache_add(cache);
+
+	cchip->path = strdup(path);
+	cchip->label = strdup(gpiod_chip_info_get_label(info));
+	cchip->num_lines = gpiod_chip_info_get_num_lines(info);
+	cchip->names = calloc(cchip->num_lines ?: 1, sizeof(*cchip->names));
+	if (!cchip->path || !cchip->label || !cchip->names)
+		die("out of memory");
+
+	cchip->rdev = st.st_rdev;
+	cchip->ino = st.st_ino;
+	cchip->ctime = st.st_ctim;
+	cache->dirty = true;
+
+	return cchip;
+}
+
+static void cached_chip_set_name(struct cached_chip *cchip,
+				 unsigned int offset, const char *name)
+{
+	if (!name || !*name || strchr(name, '\n'))
+		return;
+
+	cchip->names[offset] = strdup(name);
+	if (!cchip->names[offset])
+		die("out of memory");
+}
+
+/* Check if the info of the line is needed to resolve the requested lines. */
+static bool cached_line_wanted(struct line_resolver *resolver,
+			       struct cached_chip *cchip, int chip_num,
+			       unsigned int offset)
+{
+	const char *name = cchip->names[offset];
+	struct resolved_line *line;
+	int i;
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		line = &resolver->lines[i];
+
+		if (line->resolved && !line->info && line->offset == offset &&
+		    line->chip_num == chip_num)
+			return true;
+
+		if (line->resolved && !resolver->strict)
+			continue;
+
+		if (name && strcmp(line->id, name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Check if any of the requested lines may be found on the chip, without
+ * opening it.
+ */
+static bool cached_chip_wanted(struct line_resolver *resolver,
+			       struct cached_chip *cchip, int chip_num)
+{
+	unsigned int offset;
+
+	for (offset = 0; offset < cchip->num_lines; offset++)
+		if (cached_line_wanted(resolver, cchip, chip_num, offset))
+			return true;
+
+	return false;
+}
+
+/*
+ * Resolve lines using the cached names, reading only the info of the lines
+ * wanted. Returns false if the cache turned out to be stale, in which case
+ * nothing was resolved.
+ */
+static bool resolve_cached_lines(struct line_resolver *resolver,
+				 struct cached_chip *cchip,
+				 struct gpiod_chip *chip, int chip_num,
+				 bool *chip_used)
+{
+	struct gpiod_line_info **infos;
+	unsigned int offset, i, num_infos = 0;
+	const char *name;
+	bool ret = false;
+
+	infos = calloc(cchip->num_lines ?: 1, sizeof(*infos));
+	if (!infos)
+		die("out of memory");
+
+	for (offset = 0; offset < cchip->num_lines; offset++) {
+		if (!cached_line_wanted(resolver, cchip, chip_num, offset))
+			continue;
+
+		infos[num_infos] = gpiod_chip_get_line_info(chip, offset);
+		if (!infos[num_infos])
+			die_perror("unable to read the info for line %u from %s",
+				   offset, cchip->path);
+
+		name = gpiod_line_info_get_name(infos[num_infos]);
+		if (cchip->names[offset] &&
+		    (!name || strcmp(name, cchip->names[offset])))
+			goto out;
+
+		num_infos++;
+	}
+
+	for (i = 0; i < num_infos; i++) {
+		if (resolve_line(resolver, infos[i], chip_num)) {
+			*chip_used = true;
+			infos[i] = NULL;
+		}
+	}
+
+	ret = true;
+
+out:
+	for (i = 0; i <= num_infos && i < cchip->num_lines; i++)
+		gpiod_line_info_free(infos[i]);
+
+	free(infos);
+	return ret;
+}
+
 /*
  * check for lines that can be identified by offset
  *
@@ -583,16 +1355,54 @@ struct line_resolver *resolver_init(int num_lines, char **lines, int num_chips,
 	return resolver;
 }
 
+/*
+ * Get the info of a line from the snapshot, or read it from the chip. Infos
+ * from the snapshot are only borrowed.
+ */
+static struct gpiod_line_info *get_line_info(struct gpiod_chip *chip,
+					     struct chip_snapshot *snapshot,
+					     unsigned int offset)
+{
+	if (!snapshot)
+		return gpiod_chip_get_line_info(chip, offset);
+
+	if (offset >= snapshot->num_lines_read) {
+		errno = snapshot->err;
+		return NULL;
+	}
+
+	return gpiod_line_info_snapshot_get_line_info(snapshot->lines, offset);
+}
+
+/* Replace the references to a borrowed info kept by the resolver by copies. */
+static void own_line_info(struct line_resolver *resolver,
+			  struct gpiod_line_info *info)
+{
+	int i;
+
+	for (i = 0; i < resolver->num_lines; i++) {
+		if (resolver->lines[i].info != info)
+			continue;
+
+		resolver->lines[i].info = gpiod_line_info_copy(info);
+		if (!resolver->lines[i].info)
+			die("out of memory");
+	}
+}
+
 struct line_resolver *resolve_lines(int num_lines, char **lines,
 				    const char *chip_id, bool strict,
 				    bool by_name)
 {
+	struct chip_snapshot *snapshots = NULL, *snapshot;
+	struct cached_chip *cchip, *update;
 	struct gpiod_chip_info *chip_info;
 	struct gpiod_line_info *line_info;
 	struct line_resolver *resolver;
+	struct gpiod_chip *chip = NULL;
 	int num_chips, i, offset;
-	struct gpiod_chip *chip;
-	bool chip_used;
+	struct name_cache *cache;
+	bool chip_used, *wanted;
 	char **paths;
 
 	if (chip_id == NULL)
@@ -604,9 +1414,49 @@ struct line_resolver *resolve_lines(int num_lines, char **lines,
 
 	resolver = resolver_init(num_lines, lines, num_chips, strict, by_name);
 
+	/* Lines looked up by offset only need no names. */
+	cache = by_name ? name_cache_load() : NULL;
+
+	/*
+	 * Searching all chips for names, read the chips not covered by the
+	 * cache in parallel up front.
+	 */
+	if (!chip_id && num_chips > 1) {
+		snapshots = calloc(num_chips, sizeof(*snapshots));
+		wanted = calloc(num_chips, sizeof(*wanted));
+		if (!snapshots || !wanted)
+			die("out of memory");
+
+		for (i = 0; i < num_chips; i++)
+			wanted[i] = !name_cache_lookup(cache, paths[i]);
+
+		read_chips(num_chips, paths, wanted, snapshots);
+		free(wanted);
+	}
+
 	for (i = 0; (i < num_chips) && !resolve_done(resolver); i++) {
 		chip_used = false;
-		chip = gpiod_chip_open(paths[i]);
+		update = NULL;
+
+		/* Chips known not to hold any of the lines aren't opened. */
+		cchip = name_cache_lookup(cache, paths[i]);
+		if (cchip && !cached_chip_wanted(resolver, cchip, i)) {
+			free(paths[i]);
+			continue;
+		}
+
+		snapshot = snapshots && !cchip ? &snapshots[i] : NULL;
+		if (snapshot) {
+			errno = snapshot->err;
+			chip = snapshot->chip;
+			chip_info = snapshot->info;
+			snapshot->chip = NULL;
+			snapshot->info = NULL;
+		} else {
+			chip = gpiod_chip_open(paths[i]);
+			chip_info = chip ? gpiod_chip_get_info(chip) : NULL;
+		}
+
 		if (!chip) {
 			if ((errno == EACCES) && (chip_id == NULL)) {
 				free(paths[i]);
@@ -616,7 +1466,6 @@ struct line_resolver *resolve_lines(int num_lines, char **lines,
 			die_perror("unable to open chip '%s'", paths[i]);
 		}
 
-		chip_info = gpiod_chip_get_info(chip);
 		if (!chip_info)
 			die_perror("unable to get info for '%s'", paths[i]);
 
@@ -625,34 +1474,62 @@ struct line_resolver *resolve_lines(int num_lines, char **lines,
 		if (i == 0 && chip_id && !by_name)
 			chip_used = resolve_lines_by_offset(resolver, num_lines);
 
+		if (cchip && cached_chip_matches(cchip, chip_info) &&
+		    resolve_cached_lines(resolver, cchip, chip, i,
+					 &chip_used))
+			goto chip_done;
+
+		/* Scan the whole chip to record all names in the cache. */
+		update = name_cache_update(cache, paths[i], chip_info);
+
 		for (offset = 0;
-		     (offset < num_lines) && !resolve_done(resolver);
+		     (offset < num_lines) &&
+		     (update || !resolve_done(resolver));
 		     offset++) {
-			line_info = gpiod_chip_get_line_info(chip, offset);
+			line_info = get_line_info(chip, snapshot, offset);
 			if (!line_info)
 				die_perror("unable to read the info for line %d from %s",
 					   offset,
 					   gpiod_chip_info_get_name(chip_info));
 
-			if (resolve_line(resolver, line_info, i))
+			if (update)
+				cached_chip_set_name(update, offset,
+					gpiod_line_info_get_name(line_info));
+
+			if (!resolve_done(resolver) &&
+			    resolve_line(resolver, line_info, i)) {
 				chip_used = true;
-			else
+				if (snapshot)
+					own_line_info(resolver, line_info);
+			} else if (!snapshot) {
 				gpiod_line_info_free(line_info);
+			}
 
 		}
 
-		gpiod_chip_close(chip);
-
+chip_done:
+		/* Keep the chip open, the lines will be requested from it. */
 		if (chip_used) {
+			resolver->chips[resolver->num_chips].chip = chip;
 			resolver->chips[resolver->num_chips].info = chip_info;
 			resolver->chips[resolver->num_chips].path = paths[i];
 			resolver->num_chips++;
 		} else {
+			gpiod_chip_close(chip);
 			gpiod_chip_info_free(chip_info);
 			free(paths[i]);
 		}
 	}
+
+	if (snapshots) {
+		for (i = 0; i < num_chips; i++)
+			free_chip_snapshot(&snapshots[i]);
+
+		free(snapshots);
+	}
+
 	free(paths);
+	name_cache_free(cache);
 
 	return resolver;
 }
@@ -701,6 +1578,7 @@ void free_line_resolver(struct line_resolver *resolver)
 		gpiod_line_info_free(resolver->lines[i].info);
 
 	for (i = 0; i < resolver->num_chips; i++) {
+		gpiod_chip_close(resolver->chips[i].chip);
 		gpiod_chip_info_free(resolver->chips[i].info);
 		free(resolver->chips[i].path);
 	}
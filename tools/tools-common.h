@@ -21,6 +21,110 @@
 
 #define GETOPT_NULL_LONGOPT	NULL, 0, NULL, 0
 
+/* Real-time options shared by gpioget, gpioset and gpiomon. */
+#define RT_OPT_REALTIME		0x100
+#define RT_OPT_CPU		0x101
+#define RT_OPT_MLOCK		0x102
+
+#define RT_LONGOPTS \
+	{ "cpu",	required_argument,	NULL,	RT_OPT_CPU }, \
+	{ "mlock",	no_argument,		NULL,	RT_OPT_MLOCK }, \
+	{ "realtime",	optional_argument,	NULL,	RT_OPT_REALTIME }
+
+#define RT_DEFAULT_PRIORITY	50
+
+struct rt_config {
+	/* SCHED_FIFO priority, 0 to keep the scheduling policy */
+	int priority;
+
+	/* CPU to pin to, -1 to keep the affinity */
+	int cpu;
+
+	/* lock the process memory */
+	bool lock_memory;
+};
+
+/* Element of a --format string parsed by parse_format(). */
+struct format_op {
+	/* format specifier or '\0' for literal text */
+	char spec;
+
+	/* literal text, not null-terminated */
+	const char *text;
+	size_t len;
+};
+
+struct output_format {
+	size_t num_ops;
+	struct format_op ops[];
+};
+
+#define OUTPUT_BUFFER_SIZE	65536
+
+/* Output collected in user space and written to stdout in large chunks. */
+struct output_buffer {
+	size_t len;
+	char data[OUTPUT_BUFFER_SIZE];
+};
+
+/* Layout of the events written in binary mode, all fields are little-endian. */
+struct binary_record {
+	uint64_t timestamp_ns;
+	uint32_t chip_num;
+	uint32_t offset;
+	uint32_t event_type;
+	uint32_t global_seqno;
+	uint32_t line_seqno;
+	uint32_t reserved;
+};
+
+/*
+ * Capture files are rings of binary records preceded by a header and an index
+ * of checkpoints, all fields little-endian. The file is allocated up front and
+ * memory-mapped so recording events needs no system calls. Once the ring is
+ * full the oldest records are overwritten.
+ */
+#define CAPTURE_MAGIC			"GPIOCAP"
+#define CAPTURE_VERSION			2
+#define CAPTURE_NAME_SIZE		32
+#define CAPTURE_MAX_LINES		64
+/* One checkpoint for every this many records. */
+#define CAPTURE_CHECKPOINT_INTERVAL	1024
+
+struct capture_line {
+	uint32_t chip_num;
+	uint32_t offset;
+	char chip_name[CAPTURE_NAME_SIZE];
+	char line_name[CAPTURE_NAME_SIZE];
+};
+
+struct capture_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	/* Number of records the ring holds. */
+	uint64_t capacity;
+	/*
+	 * Number of records written so far, the next one goes into slot
+	 * head % capacity. Updated after every batch.
+	 */
+	uint64_t head;
+	/*
+	 * File offset of the checkpoints: the timestamps of the records in
+	 * every CAPTURE_CHECKPOINT_INTERVAL-th slot of the ring, each written
+	 * together with its record.
+	 */
+	uint64_t index_offset;
+	/* File offset of the ring, page-aligned. */
+	uint64_t records_offset;
+	uint32_t checkpoint_interval;
+	uint32_t num_lines;
+	/* Clock domain of the timestamps, an enum gpiod_line_clock value. */
+	uint32_t event_clock;
+	uint32_t reserved;
+	struct capture_line lines[CAPTURE_MAX_LINES];
+};
+
 struct resolved_line {
 	/* from the command line */
 	const char *id;
@@ -50,6 +154,9 @@ struct resolved_line {
 };
 
 struct resolved_chip {
+	/* the open chip, the lines are requested from it */
+	struct gpiod_chip *chip;
+
 	/* info of the relevant chips */
 	struct gpiod_chip_info *info;
 
@@ -57,6 +164,22 @@ struct resolved_chip {
 	char *path;
 };
 
+/* Info of a chip and all its lines, read ahead of time by read_chips(). */
+struct chip_snapshot {
+	/* the open chip, NULL if it couldn't be opened */
+	struct gpiod_chip *chip;
+
+	/* errno of the first failure, 0 if all info was read */
+	int err;
+
+	/* info of the chip, NULL if it couldn't be read */
+	struct gpiod_chip_info *info;
+
+	/* info of the lines, NULL if they couldn't be read */
+	struct gpiod_line_info_snapshot *lines;
+	unsigned int num_lines_read;
+};
+
 /* a resolver from requested line names/offsets to lines on the system */
 struct line_resolver {
 	/*
@@ -91,14 +214,31 @@ int parse_period(const char *option);
 unsigned int parse_period_or_die(const char *option);
 int parse_uint(const char *option);
 unsigned int parse_uint_or_die(const char *option);
+enum gpiod_line_value parse_line_value(const char *option);
 void print_bias_help(void);
+void rt_config_init(struct rt_config *rt);
+bool parse_rt_option(int optc, const char *arg, struct rt_config *rt);
+void apply_rt_config(struct rt_config *rt);
+void print_rt_help(void);
 void print_chip_help(void);
 void print_period_help(void);
 void print_event_time(uint64_t evtime, int format);
+struct output_format *parse_format(const char *fmt, const char *specs);
+void free_format(struct output_format *format);
+void output_write(struct output_buffer *out, const char *data, size_t len);
+void output_puts(struct output_buffer *out, const char *str);
+void output_putc(struct output_buffer *out, char c);
+void output_put_uint(struct output_buffer *out, uint64_t val);
+void output_put_event_time(struct output_buffer *out, uint64_t evtime,
+			   int format);
+void output_flush(struct output_buffer *out);
 void print_line_attributes(struct gpiod_line_info *info, bool unquoted_strings);
 void print_line_id(struct line_resolver *resolver, int chip_num,
 		   unsigned int offset, const char *chip_id, bool unquoted);
 bool chip_path_lookup(const char *id, char **path_ptr);
+void read_chips(int num_chips, char **paths, const bool *wanted,
+		struct chip_snapshot *snapshots);
+void free_chip_snapshot(struct chip_snapshot *snapshot);
 int chip_paths(const char *id, char ***paths_ptr);
 int all_chip_paths(char ***paths_ptr);
 struct line_resolver *resolve_lines(int num_lines, char **lines,